@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# Copyright (C) 2019-2024 Zilliz. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+# with the License. You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software distributed under the License
+# is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+# or implied. See the License for the specific language governing permissions and limitations under the License
+
+"""Compares the results of a benchmark run with the ones of a baseline run, and flags the regressions.
+
+The results are the *_qps.json files written by benchmark_float_qps. A result of the current run is compared with
+the baseline result of the same index (type, build params and data type), mode, expected recall and number of
+threads or of clients and target QPS. A regression is flagged when
+  - the QPS dropped by more than qps_drop (relative),
+  - the recall dropped by more than recall_drop (absolute),
+  - the P99 latency grew by more than p99_rise (relative), for the concurrent clients.
+The thresholds are read from a json file, in which the thresholds of an index file name (a config) override the ones
+of its index type, which override the default ones, e.g.
+  {"default": {"qps_drop": 0.1}, "HNSW": {"qps_drop": 0.15}, "sift-128-euclidean_HNSW_16_100_fp32.index": {...}}
+
+Exits with 1 if any regression is flagged, with 0 otherwise.
+"""
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+DEFAULT_THRESHOLDS = {"qps_drop": 0.10, "recall_drop": 0.01, "p99_rise": 0.20}
+
+
+def load_results(path):
+    files = sorted(glob.glob(os.path.join(path, "*_qps.json"))) if os.path.isdir(path) else [path]
+    results = {}
+    for file in files:
+        with open(file) as f:
+            for result in json.load(f):
+                results[result_key(result)] = result
+    return results
+
+
+def result_key(result):
+    return (
+        result["dataset"],
+        result.get("index") or result["index_type"],
+        result["data_type"],
+        result.get("mode", "concurrent"),
+        round(result.get("expected_recall", 0.0), 4),
+        result.get("threads", 0),
+        result.get("clients", 0),
+        result.get("target_qps", 0),
+    )
+
+
+def describe(key):
+    dataset, index, data_type, mode, expected_recall, threads, clients, target_qps = key
+    desc = f"{index} ({dataset}, {data_type}) {mode} R@{expected_recall}"
+    if mode == "threads":
+        return f"{desc} threads={threads}"
+    return f"{desc} clients={clients} target_qps={target_qps}"
+
+
+def thresholds_of(thresholds, result):
+    merged = dict(DEFAULT_THRESHOLDS)
+    merged.update(thresholds.get("default", {}))
+    merged.update(thresholds.get(result["index_type"], {}))
+    merged.update(thresholds.get(result.get("index", ""), {}))
+    return merged
+
+
+def compare(baseline, current, thresholds):
+    regressions = []
+    for key, result in sorted(current.items()):
+        base = baseline.get(key)
+        if base is None:
+            continue
+        limits = thresholds_of(thresholds, result)
+        if base["qps"] > 0 and result["qps"] < base["qps"] * (1 - limits["qps_drop"]):
+            regressions.append((key, "qps", base["qps"], result["qps"]))
+        if result["recall"] < base["recall"] - limits["recall_drop"]:
+            regressions.append((key, "recall", base["recall"], result["recall"]))
+        base_p99 = base.get("latency_us", {}).get("p99")
+        p99 = result.get("latency_us", {}).get("p99")
+        if base_p99 and p99 is not None and p99 > base_p99 * (1 + limits["p99_rise"]):
+            regressions.append((key, "p99_us", base_p99, p99))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baseline", required=True, help="the results of the baseline run, a file or a directory")
+    parser.add_argument("--current", required=True, help="the results of the current run, a file or a directory")
+    parser.add_argument("--thresholds", help="the json file of the thresholds")
+    args = parser.parse_args()
+
+    thresholds = {}
+    if args.thresholds:
+        with open(args.thresholds) as f:
+            thresholds = json.load(f)
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+
+    matched = [key for key in current if key in baseline]
+    for key in sorted(set(current) - set(baseline)):
+        print(f"no baseline: {describe(key)}")
+    regressions = compare(baseline, current, thresholds)
+    for key, metric, base, value in regressions:
+        change = (value - base) / base * 100 if base else 0.0
+        print(f"REGRESSION: {describe(key)}: {metric} {base:.4f} -> {value:.4f} ({change:+.1f}%)")
+    print(f"{len(matched)} results compared, {len(regressions)} regressions")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
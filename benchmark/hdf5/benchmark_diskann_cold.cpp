@@ -0,0 +1,337 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_knowhere.h"
+#include "filemanager/FileManager.h"
+#include "filemanager/impl/LocalFileManager.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/dataset.h"
+
+// Benchmarks the disk indexes (DiskANN, AiSAQ) cold, for SSD provisioning: the node cache budget is swept from 0, and
+// the index files are dropped from the page cache before every run. The nodes are read with O_DIRECT by the indexes
+// already, so that with no node cache every node read of every query goes to the device. For every beamwidth, search
+// list size and number of concurrent clients, reports the IOs and the bytes read per query, the QPS and the latency
+// percentiles, as measured and as modeled on a slower device that adds a synthetic latency to every round of reads
+// of a query. The results are also written as json.
+class Benchmark_diskann_cold : public Benchmark_knowhere, public ::testing::Test {
+ public:
+    // the cost of a run of the queries
+    struct RunCost {
+        LatencyHistogram histogram;
+        // the latencies modeled for each of DEVICE_LATENCY_USs_
+        std::vector<LatencyHistogram> modeled_histograms;
+        uint64_t io_count = 0;
+        uint64_t graph_hops = 0;
+        uint64_t cache_hits = 0;
+        uint64_t bytes_read = 0;
+        double elapse_s = 0;
+    };
+
+    // Drops the files of dir from the page cache, and all the clean caches if the process may (as root). Linux only.
+    static bool
+    drop_caches(const std::string& dir) {
+        sync();
+        for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            const int fd = open(entry.path().c_str(), O_RDONLY);
+            if (fd < 0) {
+                continue;
+            }
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+        std::ofstream drop("/proc/sys/vm/drop_caches");
+        if (!drop) {
+            return false;
+        }
+        drop << "3" << std::endl;
+        return drop.good();
+    }
+
+    // the bytes that the process read from the storage, the O_DIRECT reads included. Linux only.
+    static uint64_t
+    storage_read_bytes() {
+        std::ifstream io("/proc/self/io");
+        std::string key;
+        uint64_t value = 0;
+        while (io >> key >> value) {
+            if (key == "read_bytes:") {
+                return value;
+            }
+        }
+        return 0;
+    }
+
+    template <typename T>
+    void
+    test_cold(const knowhere::Json& cfg) {
+        std::string data_type_str = get_data_type_name<T>();
+        for (auto cache_budget_gb : CACHE_BUDGET_GBs_) {
+            auto load_conf = cfg;
+            load_conf[knowhere::indexparam::SEARCH_CACHE_BUDGET_GB] = cache_budget_gb;
+            load_index(load_conf);
+
+            for (auto beamwidth : BEAMWIDTHs_) {
+                for (auto search_list_size : SEARCH_LISTs_) {
+                    auto conf = load_conf;
+                    conf[knowhere::meta::TOPK] = topk_;
+                    conf[knowhere::meta::SEARCH_STATS] = true;
+                    conf[knowhere::indexparam::BEAMWIDTH] = beamwidth;
+                    conf[knowhere::indexparam::SEARCH_LIST_SIZE] = search_list_size;
+
+                    printf("\n[%0.3f s] %s | %s(%s) | cache=%.3fGB, beamwidth=%d, search_list_size=%d, k=%d\n",
+                           get_time_diff(), ann_test_name_.c_str(), index_type_.c_str(), data_type_str.c_str(),
+                           cache_budget_gb, beamwidth, search_list_size, topk_);
+                    printf("================================================================================\n");
+                    for (auto client_num : CLIENT_NUMs_) {
+                        const bool dropped_all = drop_caches(kDir);
+                        std::vector<int64_t> ids((int64_t)nq_ * topk_, -1);
+                        auto cost = run<T>(conf, client_num, ids);
+                        report(conf, cache_budget_gb, client_num, dropped_all, CalcRecall(ids.data(), nq_, topk_),
+                               cost);
+                    }
+                    printf("================================================================================\n");
+                }
+            }
+        }
+        printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+    }
+
+ private:
+    void
+    load_index(const knowhere::Json& conf) {
+        std::shared_ptr<milvus::FileManager> file_manager = std::make_shared<milvus::LocalFileManager>();
+        auto diskann_index_pack = knowhere::Pack(file_manager);
+        index_ = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(
+            index_type_, knowhere::Version::GetCurrentVersion().VersionNumber(), diskann_index_pack);
+        knowhere::BinarySet binset;
+        ASSERT_EQ(index_.value().Deserialize(binset, conf), knowhere::Status::success);
+    }
+
+    // Runs the queries from client_num closed-loop clients, one query at a time each. The modeled latency of a query
+    // adds the device latency once per round of reads, that is once per hop, the reads of a round being issued
+    // together.
+    template <typename T>
+    RunCost
+    run(const knowhere::Json& conf, int32_t client_num, std::vector<int64_t>& ids) {
+        using clock = std::chrono::steady_clock;
+        RunCost cost;
+        cost.modeled_histograms.resize(DEVICE_LATENCY_USs_.size());
+        std::atomic<int32_t> next_query{0};
+        std::mutex cost_mutex;
+
+        auto client = [&]() {
+            RunCost local;
+            local.modeled_histograms.resize(DEVICE_LATENCY_USs_.size());
+            for (int32_t i = next_query++; i < nq_; i = next_query++) {
+                auto ds_ptr = knowhere::GenDataSet(1, dim_, (const float*)xq_ + (int64_t)i * dim_);
+                auto query = knowhere::ConvertToDataTypeIfNeeded<T>(ds_ptr);
+                const auto begin = clock::now();
+                auto result = index_.value().Search(query, conf, nullptr);
+                const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - begin);
+                if (!result.has_value()) {
+                    continue;
+                }
+                std::copy_n(result.value()->GetIds(), topk_, ids.data() + (int64_t)i * topk_);
+                local.histogram.record(latency.count());
+                uint64_t hops = 0;
+                if (auto stats = result.value()->GetSearchStats(); stats != nullptr && !stats->empty()) {
+                    hops = (*stats)[0].graph_hops;
+                    local.io_count += (*stats)[0].io_count;
+                    local.graph_hops += hops;
+                    local.cache_hits += (*stats)[0].cache_hits;
+                }
+                for (size_t j = 0; j < DEVICE_LATENCY_USs_.size(); j++) {
+                    local.modeled_histograms[j].record(latency.count() + hops * DEVICE_LATENCY_USs_[j]);
+                }
+            }
+            std::lock_guard<std::mutex> lock(cost_mutex);
+            cost.histogram.merge(local.histogram);
+            for (size_t j = 0; j < DEVICE_LATENCY_USs_.size(); j++) {
+                cost.modeled_histograms[j].merge(local.modeled_histograms[j]);
+            }
+            cost.io_count += local.io_count;
+            cost.graph_hops += local.graph_hops;
+            cost.cache_hits += local.cache_hits;
+        };
+
+        const auto read_bytes_begin = storage_read_bytes();
+        const auto begin = clock::now();
+        std::vector<std::thread> clients;
+        clients.reserve(client_num);
+        for (int32_t i = 0; i < client_num; i++) {
+            clients.emplace_back(client);
+        }
+        for (auto& t : clients) {
+            t.join();
+        }
+        cost.elapse_s = std::chrono::duration<double>(clock::now() - begin).count();
+        cost.bytes_read = storage_read_bytes() - read_bytes_begin;
+        return cost;
+    }
+
+    void
+    report(const knowhere::Json& conf, float cache_budget_gb, int32_t client_num, bool dropped_all, float recall,
+           const RunCost& cost) {
+        const auto queries = std::max<uint64_t>(cost.histogram.count(), 1);
+        const double qps = cost.histogram.count() / cost.elapse_s;
+        printf(
+            "  clients = %2d, QPS = %9.3f, R@=%.4f, IOs/q = %7.2f, KB/q = %8.2f, hops/q = %6.2f, cache hits/q = %6.2f, "
+            "P50 = %7lu, P99 = %7lu us\n",
+            client_num, qps, recall, (double)cost.io_count / queries, (double)cost.bytes_read / queries / 1024,
+            (double)cost.graph_hops / queries, (double)cost.cache_hits / queries, cost.histogram.percentile(50),
+            cost.histogram.percentile(99));
+
+        knowhere::Json result;
+        result["dataset"] = ann_test_name_;
+        result["index_type"] = index_type_;
+        result["config"] = conf;
+        result["cache_budget_gb"] = cache_budget_gb;
+        result["clients"] = client_num;
+        // the whole page cache was dropped rather than the index files only
+        result["dropped_all_caches"] = dropped_all;
+        result["recall"] = recall;
+        result["qps"] = qps;
+        result["ios_per_query"] = (double)cost.io_count / queries;
+        result["bytes_read_per_query"] = (double)cost.bytes_read / queries;
+        result["hops_per_query"] = (double)cost.graph_hops / queries;
+        result["cache_hits_per_query"] = (double)cost.cache_hits / queries;
+        result["latency_us"]["p50"] = cost.histogram.percentile(50);
+        result["latency_us"]["p99"] = cost.histogram.percentile(99);
+        result["latency_us"]["max"] = cost.histogram.max();
+        result["latency_us"]["mean"] = cost.histogram.mean();
+
+        // the closed-loop clients are modeled to each run a query after the other
+        result["modeled"] = knowhere::Json::array();
+        for (size_t j = 0; j < DEVICE_LATENCY_USs_.size(); j++) {
+            const auto& histogram = cost.modeled_histograms[j];
+            const double modeled_qps = histogram.mean() > 0 ? client_num * 1e6 / histogram.mean() : 0;
+            printf("    + %5d us per read round: QPS = %9.3f, P50 = %7lu, P99 = %7lu us\n", DEVICE_LATENCY_USs_[j],
+                   std::min(qps, modeled_qps), histogram.percentile(50), histogram.percentile(99));
+            knowhere::Json modeled;
+            modeled["device_latency_us"] = DEVICE_LATENCY_USs_[j];
+            modeled["qps"] = std::min(qps, modeled_qps);
+            modeled["latency_us"]["p50"] = histogram.percentile(50);
+            modeled["latency_us"]["p99"] = histogram.percentile(99);
+            modeled["latency_us"]["mean"] = histogram.mean();
+            result["modeled"].push_back(std::move(modeled));
+        }
+        std::fflush(stdout);
+        results_.push_back(std::move(result));
+    }
+
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        set_ann_test_name("sift-128-euclidean");
+        parse_ann_test_name();
+        load_hdf5_data<knowhere::fp32>();
+
+        cfg_[knowhere::meta::METRIC_TYPE] = metric_type_;
+        knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AVX2);
+        knowhere::KnowhereConfig::SetBuildThreadPoolSize(default_build_thread_num);
+        // every concurrent query has a thread to wait for its reads
+        knowhere::KnowhereConfig::SetSearchThreadPoolSize(
+            std::max<int32_t>(default_search_thread_num, *std::max_element(CLIENT_NUMs_.begin(), CLIENT_NUMs_.end())));
+    }
+
+    void
+    TearDown() override {
+        if (!results_.empty()) {
+            const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+            std::ofstream out(ann_test_name_ + "_" + test_info->name() + "_cold.json");
+            out << results_.dump(2) << std::endl;
+        }
+        free_all();
+    }
+
+    // builds the index of index_type_ from the raw data on the disk
+    void
+    build_index(const knowhere::Json& conf) {
+        fs::create_directory(kDir);
+        fs::create_directory(kL2IndexDir);
+        fs::create_directory(kIPIndexDir);
+        WriteRawDataToDisk(kRawDataPath, (const float*)xb_, (const uint32_t)nb_, (const uint32_t)dim_);
+
+        std::shared_ptr<milvus::FileManager> file_manager = std::make_shared<milvus::LocalFileManager>();
+        auto diskann_index_pack = knowhere::Pack(file_manager);
+        index_ = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(
+            index_type_, knowhere::Version::GetCurrentVersion().VersionNumber(), diskann_index_pack);
+        printf("[%.3f s] Building all on %d vectors\n", get_time_diff(), nb_);
+        knowhere::DataSetPtr ds_ptr = nullptr;
+        ASSERT_EQ(index_.value().Build(ds_ptr, conf), knowhere::Status::success);
+    }
+
+    knowhere::Json
+    disk_build_conf() const {
+        knowhere::Json conf = cfg_;
+        conf[knowhere::meta::INDEX_PREFIX] = (metric_type_ == knowhere::metric::L2 ? kL2IndexPrefix : kIPIndexPrefix);
+        conf[knowhere::meta::DATA_PATH] = kRawDataPath;
+        conf[knowhere::indexparam::MAX_DEGREE] = 56;
+        conf[knowhere::indexparam::PQ_CODE_BUDGET_GB] = sizeof(float) * dim_ * nb_ * 0.125 / (1024 * 1024 * 1024);
+        conf[knowhere::indexparam::BUILD_DRAM_BUDGET_GB] = 32.0;
+        conf[knowhere::indexparam::SEARCH_CACHE_BUDGET_GB] = 0;
+        return conf;
+    }
+
+ protected:
+    const int32_t topk_ = 10;
+
+    // the node cache budgets the index is loaded with, from none
+    const std::vector<float> CACHE_BUDGET_GBs_ = {0.0f, 0.05f, 0.2f};
+    const std::vector<int32_t> BEAMWIDTHs_ = {2, 4, 8, 16};
+    const std::vector<int32_t> SEARCH_LISTs_ = {20, 50, 100};
+    const std::vector<int32_t> CLIENT_NUMs_ = {1, 8, 32};
+    // the synthetic latencies added to every round of reads, for the devices slower than the one measured
+    const std::vector<int32_t> DEVICE_LATENCY_USs_ = {0, 100, 500, 1000};
+
+    knowhere::Json results_ = knowhere::Json::array();
+};
+
+#ifdef KNOWHERE_WITH_DISKANN
+TEST_F(Benchmark_diskann_cold, TEST_DISKANN) {
+    index_type_ = knowhere::IndexEnum::INDEX_DISKANN;
+
+    auto conf = disk_build_conf();
+    build_index(conf);
+    test_cold<knowhere::fp32>(conf);
+}
+
+TEST_F(Benchmark_diskann_cold, TEST_AISAQ) {
+    index_type_ = knowhere::IndexEnum::INDEX_AISAQ;
+
+    auto conf = disk_build_conf();
+    conf["rearrange"] = true;
+    conf["inline_pq"] = 0;
+    conf["pq_cache_size"] = 0;
+    conf["num_entry_points"] = 100;
+    conf["vectors_beamwidth"] = 4;
+    build_index(conf);
+    test_cold<knowhere::fp32>(conf);
+}
+#endif
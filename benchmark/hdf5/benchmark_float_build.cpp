@@ -0,0 +1,267 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_knowhere.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/dataset.h"
+
+// Samples the resident set size of the process from /proc every period while it is running, and keeps the peak, so
+// that the peak of a phase is measured even after its memory is released. Linux only.
+class RssSampler {
+ public:
+    explicit RssSampler(std::chrono::milliseconds period = std::chrono::milliseconds(5))
+        : peak_(current_rss()), thread_([this, period]() {
+              while (!stop_.load(std::memory_order_relaxed)) {
+                  peak_ = std::max(peak_.load(), current_rss());
+                  std::this_thread::sleep_for(period);
+              }
+          }) {
+    }
+
+    ~RssSampler() {
+        stop();
+    }
+
+    // stops the sampling, returns the peak rss in bytes
+    size_t
+    stop() {
+        if (!stop_.exchange(true)) {
+            thread_.join();
+            peak_ = std::max(peak_.load(), current_rss());
+        }
+        return peak_;
+    }
+
+    static size_t
+    current_rss() {
+        std::ifstream statm("/proc/self/statm");
+        size_t total_pages = 0, rss_pages = 0;
+        statm >> total_pages >> rss_pages;
+        return rss_pages * sysconf(_SC_PAGESIZE);
+    }
+
+ private:
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> peak_;
+    std::thread thread_;
+};
+
+// Measures the Train, Add, Build and Serialize phases of the index types on the datasets, for every size of the build
+// thread pool: the wall time, the cpu time of the process, the peak rss above the rss before the phase, and for Build
+// the scaling efficiency against a single thread. The results are also written as json.
+class Benchmark_float_build : public Benchmark_knowhere, public ::testing::Test {
+ public:
+    struct PhaseCost {
+        double wall_s = 0;
+        double cpu_s = 0;
+        size_t peak_rss_bytes = 0;
+    };
+
+    static double
+    cpu_time() {
+        struct timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    static PhaseCost
+    measure(const std::function<void()>& phase) {
+        PhaseCost cost;
+        const size_t base_rss = RssSampler::current_rss();
+        RssSampler sampler;
+        const double cpu_start = cpu_time();
+        const double wall_start = elapsed();
+        phase();
+        cost.wall_s = elapsed() - wall_start;
+        cost.cpu_s = cpu_time() - cpu_start;
+        const size_t peak_rss = sampler.stop();
+        cost.peak_rss_bytes = peak_rss > base_rss ? peak_rss - base_rss : 0;
+        return cost;
+    }
+
+    void
+    test_build(const knowhere::Json& cfg) {
+        auto conf = cfg;
+        auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+        auto base = knowhere::GenDataSet(nb_, dim_, xb_);
+
+        printf("\n[%0.3f s] %s | %s | %s\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str(),
+               conf.dump().c_str());
+        printf("================================================================================\n");
+        double single_thread_build_s = 0;
+        for (auto thread_num : THREAD_NUMs_) {
+            knowhere::KnowhereConfig::SetBuildThreadPoolSize(thread_num);
+            std::map<std::string, PhaseCost> costs;
+
+            {
+                auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type_, version).value();
+                costs["train"] = measure([&]() { ASSERT_EQ(index.Train(base, conf), knowhere::Status::success); });
+                costs["add"] = measure([&]() { ASSERT_EQ(index.Add(base, conf), knowhere::Status::success); });
+            }
+            auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type_, version).value();
+            costs["build"] = measure([&]() { ASSERT_EQ(index.Build(base, conf), knowhere::Status::success); });
+            knowhere::BinarySet binset;
+            costs["serialize"] = measure([&]() { ASSERT_EQ(index.Serialize(binset), knowhere::Status::success); });
+
+            if (thread_num == THREAD_NUMs_.front()) {
+                single_thread_build_s = costs["build"].wall_s * thread_num;
+            }
+            const double efficiency = single_thread_build_s / (thread_num * costs["build"].wall_s);
+
+            knowhere::Json point;
+            point["dataset"] = ann_test_name_;
+            point["index_type"] = index_type_;
+            point["config"] = conf;
+            point["threads"] = thread_num;
+            point["rows"] = nb_;
+            point["index_size_bytes"] = index.Size();
+            point["build_scaling_efficiency"] = efficiency;
+            for (const auto& [phase, cost] : costs) {
+                printf("  thread_num = %2d, %-9s wall = %8.3fs, cpu = %8.3fs, peak rss = %8.1f MB\n", thread_num,
+                       phase.c_str(), cost.wall_s, cost.cpu_s, cost.peak_rss_bytes / (1024.0 * 1024.0));
+                point[phase]["wall_s"] = cost.wall_s;
+                point[phase]["cpu_s"] = cost.cpu_s;
+                point[phase]["peak_rss_bytes"] = cost.peak_rss_bytes;
+            }
+            printf("  thread_num = %2d, build rows/s = %.1f, scaling efficiency = %.3f\n", thread_num,
+                   nb_ / costs["build"].wall_s, efficiency);
+            std::fflush(stdout);
+            results_.push_back(std::move(point));
+        }
+        printf("================================================================================\n");
+        printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+    }
+
+    // runs test_build for every dataset, with the config that set_conf gives
+    void
+    test_datasets(const std::function<void(knowhere::Json&)>& set_conf) {
+        for (const auto& name : ANN_TEST_NAMEs_) {
+            set_ann_test_name(name.c_str());
+            parse_ann_test_name();
+            load_hdf5_data<knowhere::fp32>();
+
+            knowhere::Json conf;
+            conf[knowhere::meta::METRIC_TYPE] = metric_type_;
+            set_conf(conf);
+            test_build(conf);
+
+            free_all();
+            xb_ = xq_ = nullptr;
+            gt_radius_ = nullptr;
+            gt_lims_ = nullptr;
+            gt_ids_ = nullptr;
+            gt_dist_ = nullptr;
+        }
+    }
+
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AVX2);
+        knowhere::KnowhereConfig::SetSearchThreadPoolSize(default_search_thread_num);
+    }
+
+    void
+    TearDown() override {
+        if (!results_.empty()) {
+            const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+            std::ofstream out(std::string(test_info->name()) + "_build.json");
+            out << results_.dump(2) << std::endl;
+        }
+        free_all();
+        knowhere::KnowhereConfig::SetBuildThreadPoolSize(default_build_thread_num);
+    }
+
+ protected:
+    const std::vector<std::string> ANN_TEST_NAMEs_ = {"sift-128-euclidean"};
+    const std::vector<int32_t> THREAD_NUMs_ = {1, 2, 4, 8, 16};
+
+    // IVF index params
+    const int32_t NLIST_ = 1024;
+    const int32_t M_ = 16;
+    const int32_t NBITS_ = 8;
+
+    // HNSW index params
+    const int32_t HNSW_M_ = 16;
+    const int32_t EFCON_ = 200;
+
+    knowhere::Json results_ = knowhere::Json::array();
+};
+
+TEST_F(Benchmark_float_build, TEST_IVF_FLAT) {
+    index_type_ = knowhere::IndexEnum::INDEX_FAISS_IVFFLAT;
+    test_datasets([&](knowhere::Json& conf) { conf[knowhere::indexparam::NLIST] = NLIST_; });
+}
+
+TEST_F(Benchmark_float_build, TEST_IVF_SQ8) {
+    index_type_ = knowhere::IndexEnum::INDEX_FAISS_IVFSQ8;
+    test_datasets([&](knowhere::Json& conf) { conf[knowhere::indexparam::NLIST] = NLIST_; });
+}
+
+TEST_F(Benchmark_float_build, TEST_IVF_PQ) {
+    index_type_ = knowhere::IndexEnum::INDEX_FAISS_IVFPQ;
+    test_datasets([&](knowhere::Json& conf) {
+        conf[knowhere::indexparam::NLIST] = NLIST_;
+        conf[knowhere::indexparam::M] = M_;
+        conf[knowhere::indexparam::NBITS] = NBITS_;
+    });
+}
+
+TEST_F(Benchmark_float_build, TEST_SCANN) {
+    index_type_ = knowhere::IndexEnum::INDEX_FAISS_SCANN;
+    test_datasets([&](knowhere::Json& conf) {
+        conf[knowhere::indexparam::NLIST] = NLIST_;
+        conf[knowhere::indexparam::WITH_RAW_DATA] = true;
+    });
+}
+
+TEST_F(Benchmark_float_build, TEST_HNSW) {
+    index_type_ = knowhere::IndexEnum::INDEX_HNSW;
+    test_datasets([&](knowhere::Json& conf) {
+        conf[knowhere::indexparam::HNSW_M] = HNSW_M_;
+        conf[knowhere::indexparam::EFCONSTRUCTION] = EFCON_;
+    });
+}
+
+TEST_F(Benchmark_float_build, TEST_HNSW_SQ) {
+    index_type_ = knowhere::IndexEnum::INDEX_HNSW_SQ;
+    test_datasets([&](knowhere::Json& conf) {
+        conf[knowhere::indexparam::HNSW_M] = HNSW_M_;
+        conf[knowhere::indexparam::EFCONSTRUCTION] = EFCON_;
+        conf[knowhere::indexparam::SQ_TYPE] = "SQ8";
+    });
+}
+
+TEST_F(Benchmark_float_build, TEST_HNSW_PQ) {
+    index_type_ = knowhere::IndexEnum::INDEX_HNSW_PQ;
+    test_datasets([&](knowhere::Json& conf) {
+        conf[knowhere::indexparam::HNSW_M] = HNSW_M_;
+        conf[knowhere::indexparam::EFCONSTRUCTION] = EFCON_;
+        conf[knowhere::indexparam::M] = M_;
+        conf[knowhere::indexparam::NBITS] = NBITS_;
+    });
+}
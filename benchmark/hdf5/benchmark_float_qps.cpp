@@ -11,6 +11,10 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -37,12 +41,9 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
         printf("\n[%0.3f s] %s | %s(%s) | k=%d, R@=%.4f\n", get_time_diff(), ann_test_name_.c_str(),
                index_type_.c_str(), data_type_str.c_str(), topk_, expected_recall);
         printf("================================================================================\n");
-        for (auto thread_num : THREAD_NUMs_) {
-            CALC_TIME_SPAN(task<T>(conf, thread_num, nq_));
-            printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, TDIFF_, nq_ / TDIFF_);
-            std::fflush(stdout);
-        }
+        test_threads<T>(conf, expected_recall, expected_recall);
         printf("================================================================================\n");
+        test_concurrent_clients<T>(conf, expected_recall);
         printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
     }
 
@@ -91,12 +92,9 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
             printf("\n[%0.3f s] %s | %s(%s) | nlist=%d, nprobe=%d, k=%d, R@=%.4f\n", get_time_diff(),
                    ann_test_name_.c_str(), index_type_.c_str(), data_type_str.c_str(), nlist, nprobe, topk_, recall);
             printf("================================================================================\n");
-            for (auto thread_num : THREAD_NUMs_) {
-                CALC_TIME_SPAN(task<T>(conf, thread_num, nq_));
-                printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, TDIFF_, nq_ / TDIFF_);
-                std::fflush(stdout);
-            }
+            test_threads<T>(conf, expected_recall, recall);
             printf("================================================================================\n");
+            test_concurrent_clients<T>(conf, expected_recall);
             printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
         }
     }
@@ -146,12 +144,9 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
             printf("\n[%0.3f s] %s | %s(%s) | k=%d, R@=%.4f\n", get_time_diff(), ann_test_name_.c_str(),
                    index_type_.c_str(), data_type_str.c_str(), topk_, recall);
             printf("================================================================================\n");
-            for (auto thread_num : THREAD_NUMs_) {
-                CALC_TIME_SPAN(task<T>(conf, thread_num, nq_));
-                printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, TDIFF_, nq_ / TDIFF_);
-                std::fflush(stdout);
-            }
+            test_threads<T>(conf, expected_recall, recall);
             printf("================================================================================\n");
+            test_concurrent_clients<T>(conf, expected_recall);
             printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
         }
     }
@@ -203,12 +198,9 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
                    ann_test_name_.c_str(), index_type_.c_str(), data_type_str.c_str(), M, efConstruction, ef, topk_,
                    recall);
             printf("================================================================================\n");
-            for (auto thread_num : THREAD_NUMs_) {
-                CALC_TIME_SPAN(task<T>(conf, thread_num, nq_));
-                printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, TDIFF_, nq_ / TDIFF_);
-                std::fflush(stdout);
-            }
+            test_threads<T>(conf, expected_recall, recall);
             printf("================================================================================\n");
+            test_concurrent_clients<T>(conf, expected_recall);
             printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
         }
     }
@@ -264,12 +256,9 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
                    get_time_diff(), ann_test_name_.c_str(), index_type_.c_str(), data_type_str.c_str(), nlist, nprobe,
                    reorder_k, with_raw_data ? 1 : 0, topk_, recall);
             printf("================================================================================\n");
-            for (auto thread_num : THREAD_NUMs_) {
-                CALC_TIME_SPAN(task<T>(conf, thread_num, nq_));
-                printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, TDIFF_, nq_ / TDIFF_);
-                std::fflush(stdout);
-            }
+            test_threads<T>(conf, expected_recall, recall);
             printf("================================================================================\n");
+            test_concurrent_clients<T>(conf, expected_recall);
             printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
         }
     }
@@ -320,18 +309,125 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
             printf("\n[%0.3f s] %s | %s(%s) | search_list_size=%d, k=%d, R@=%.4f\n", get_time_diff(),
                    ann_test_name_.c_str(), index_type_.c_str(), data_type_str.c_str(), search_list_size, topk_, recall);
             printf("================================================================================\n");
-            for (auto thread_num : THREAD_NUMs_) {
-                CALC_TIME_SPAN(task<T>(conf, thread_num, nq_));
-                printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, TDIFF_, nq_ / TDIFF_);
-                std::fflush(stdout);
-            }
+            test_threads<T>(conf, expected_recall, recall);
             printf("================================================================================\n");
+            test_concurrent_clients<T>(conf, expected_recall);
             printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
         }
     }
 #endif
 
  private:
+    // Runs the queries from thread_num threads for every size of THREAD_NUMs_, and reports the QPS. The params were
+    // tuned for expected_recall, and give recall.
+    template <typename T>
+    void
+    test_threads(const knowhere::Json& conf, float expected_recall, float recall) {
+        for (auto thread_num : THREAD_NUMs_) {
+            CALC_TIME_SPAN(task<T>(conf, thread_num, nq_));
+            printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, TDIFF_, nq_ / TDIFF_);
+            std::fflush(stdout);
+
+            auto result = new_result<T>(conf, "threads", expected_recall);
+            result["threads"] = thread_num;
+            result["qps"] = nq_ / TDIFF_;
+            result["recall"] = recall;
+            results_.push_back(std::move(result));
+        }
+    }
+
+    // a result of the index under test, to be compared with the same one of another run by compare_results.py: the
+    // results of the same index, mode and expected recall are compared, along with their threads or clients
+    template <typename T>
+    knowhere::Json
+    new_result(const knowhere::Json& conf, const std::string& mode, float expected_recall) {
+        knowhere::Json result;
+        result["dataset"] = ann_test_name_;
+        result["index_type"] = index_type_;
+        result["index"] = index_file_name_;
+        result["data_type"] = get_data_type_name<T>();
+        result["config"] = conf;
+        result["mode"] = mode;
+        result["expected_recall"] = expected_recall;
+        return result;
+    }
+
+    // Runs the queries from client_num concurrent clients with open-loop arrivals at target_qps, and reports the
+    // latency percentiles and the recall. Every client takes the next query when it is free and starts it at its
+    // scheduled arrival time, and the latency of a query is measured from that time, so that the queueing of the
+    // queries that arrive while all the clients are busy is counted as well (no coordinated omission).
+    template <typename T>
+    void
+    test_concurrent_clients(const knowhere::Json& conf, float expected_recall) {
+        printf("  concurrent clients, open-loop arrivals, latencies in us\n");
+        for (auto client_num : CLIENT_NUMs_) {
+            for (auto target_qps : TARGET_QPSs_) {
+                LatencyHistogram histogram;
+                std::vector<int64_t> ids((int64_t)nq_ * topk_, -1);
+                CALC_TIME_SPAN(task_concurrent<T>(conf, client_num, target_qps, histogram, ids));
+                const float recall = CalcRecall(ids.data(), nq_, topk_);
+                printf(
+                    "  clients = %2d, target QPS = %6d, QPS = %9.3f, R@=%.4f, P50 = %7lu, P95 = %7lu, P99 = %7lu, "
+                    "P999 = %7lu, max = %7lu\n",
+                    client_num, target_qps, nq_ / TDIFF_, recall, histogram.percentile(50), histogram.percentile(95),
+                    histogram.percentile(99), histogram.percentile(99.9), histogram.max());
+                std::fflush(stdout);
+
+                auto result = new_result<T>(conf, "concurrent", expected_recall);
+                result["clients"] = client_num;
+                result["target_qps"] = target_qps;
+                result["qps"] = nq_ / TDIFF_;
+                result["recall"] = recall;
+                result["latency_us"]["p50"] = histogram.percentile(50);
+                result["latency_us"]["p95"] = histogram.percentile(95);
+                result["latency_us"]["p99"] = histogram.percentile(99);
+                result["latency_us"]["p999"] = histogram.percentile(99.9);
+                result["latency_us"]["max"] = histogram.max();
+                result["latency_us"]["mean"] = histogram.mean();
+                results_.push_back(std::move(result));
+            }
+        }
+        printf("================================================================================\n");
+    }
+
+    template <typename T>
+    void
+    task_concurrent(const knowhere::Json& conf, int32_t client_num, int32_t target_qps, LatencyHistogram& histogram,
+                    std::vector<int64_t>& ids) {
+        using clock = std::chrono::steady_clock;
+        const auto interval = std::chrono::nanoseconds(1000000000LL / target_qps);
+        const auto start = clock::now();
+        std::atomic<int32_t> next_query{0};
+        std::mutex histogram_mutex;
+
+        auto client = [&]() {
+            LatencyHistogram local_histogram;
+            for (int32_t i = next_query++; i < nq_; i = next_query++) {
+                const auto arrival = start + interval * i;
+                std::this_thread::sleep_until(arrival);
+                auto ds_ptr = knowhere::GenDataSet(1, dim_, (const float*)xq_ + (int64_t)i * dim_);
+                auto query = knowhere::ConvertToDataTypeIfNeeded<T>(ds_ptr);
+                auto result = index_.value().Search(query, conf, nullptr);
+                const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - arrival);
+                local_histogram.record(latency.count());
+                if (result.has_value()) {
+                    std::copy_n(result.value()->GetIds(), topk_, ids.data() + (int64_t)i * topk_);
+                }
+            }
+            std::lock_guard<std::mutex> lock(histogram_mutex);
+            histogram.merge(local_histogram);
+        };
+
+        std::vector<std::thread> clients;
+        clients.reserve(client_num);
+        for (int32_t i = 0; i < client_num; i++) {
+            clients.emplace_back(client);
+        }
+        for (auto& t : clients) {
+            t.join();
+        }
+    }
+
     template <typename T>
     void
     task(const knowhere::Json& conf, int32_t worker_num, int32_t nq_total) {
@@ -383,6 +479,12 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
 
     void
     TearDown() override {
+        // the results are kept for regression tracking, see compare_results.py
+        if (!results_.empty()) {
+            const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+            std::ofstream out(ann_test_name_ + "_" + test_info->name() + "_qps.json");
+            out << results_.dump(2) << std::endl;
+        }
         free_all();
 #ifdef KNOWHERE_WITH_GPU
         knowhere::KnowhereConfig::FreeGPUResource();
@@ -394,6 +496,13 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
     const std::vector<float> EXPECTED_RECALLs_ = {0.8, 0.95};
     const std::vector<int32_t> THREAD_NUMs_ = {1, 2, 4, 8};
 
+    // concurrent clients params
+    const std::vector<int32_t> CLIENT_NUMs_ = {1, 4, 16};
+    const std::vector<int32_t> TARGET_QPSs_ = {500, 2000, 8000};
+
+    // the results of the runs, of the threads and of the concurrent clients
+    knowhere::Json results_ = knowhere::Json::array();
+
     // IVF index params
     const std::vector<int32_t> NLISTs_ = {1024};
 
@@ -525,6 +634,7 @@ TEST_F(Benchmark_float_qps, TEST_SCANN) {
 #ifdef KNOWHERE_WITH_DISKANN
 TEST_F(Benchmark_float_qps, TEST_DISKANN) {
     index_type_ = knowhere::IndexEnum::INDEX_DISKANN;
+    index_file_name_ = get_index_name<knowhere::fp32>(std::vector<int32_t>{56});
 
     knowhere::Json conf = cfg_;
 
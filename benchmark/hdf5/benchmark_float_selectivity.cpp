@@ -0,0 +1,358 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "benchmark_knowhere.h"
+#include "filemanager/FileManager.h"
+#include "filemanager/impl/LocalFileManager.h"
+#include "index/hnsw/impl/IndexConditionalWrapper.h"
+#include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/dataset.h"
+#include "knowhere/sparse_utils.h"
+
+// Sweeps the selectivity of the filter (the fraction of the rows that pass it) from 0.1% to 99%, for filters whose
+// passing rows are random, clustered in the id space, or correlated with the vectors, and reports the QPS, the recall
+// and the execution strategy that the thresholds of the index pick for every point. The results are also written as
+// json, for the tuning of the thresholds and for regression tracking.
+class Benchmark_float_selectivity : public Benchmark_knowhere, public ::testing::Test {
+ public:
+    // the execution strategy of a search with k results and filter_ratio of the rows filtered out
+    using StrategyFunc = std::function<std::string(float filter_ratio, int32_t k)>;
+
+    enum class FilterDistribution { RANDOM, CLUSTERED, CORRELATED };
+
+    template <typename T>
+    void
+    test_selectivity(const knowhere::Json& cfg, const StrategyFunc& strategy) {
+        auto conf = cfg;
+        conf[knowhere::meta::TOPK] = topk_;
+
+        std::string data_type_str = get_data_type_name<T>();
+        printf("\n[%0.3f s] %s | %s(%s) | k=%d\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str(),
+               data_type_str.c_str(), topk_);
+        printf("================================================================================\n");
+        auto ds_ptr = knowhere::GenDataSet(nq_, dim_, xq_);
+        auto query = knowhere::ConvertToDataTypeIfNeeded<T>(ds_ptr);
+        for (auto distribution : DISTRIBUTIONs_) {
+            for (auto selectivity : SELECTIVITIES_) {
+                const size_t nbits_set = nb_ - std::max<size_t>(1, nb_ * selectivity);
+                auto bitset_data = gen_filter(distribution, nbits_set);
+                knowhere::BitsetView bitset(bitset_data.data(), nb_, nbits_set);
+                const float filter_ratio = (float)nbits_set / nb_;
+
+                auto g_result = golden_search(conf, bitset);
+                CALC_TIME_SPAN(auto result = index_.value().Search(query, conf, bitset));
+                const float recall = CalcRecall(g_result.value()->GetIds(), result.value()->GetIds(), nq_, topk_);
+                const auto strategy_str = strategy(filter_ratio, topk_);
+                printf("  filter = %10s, selectivity = %6.2f%%, strategy = %-20s, QPS = %9.3f, R@ = %.4f\n",
+                       distribution_name(distribution).c_str(), selectivity * 100, strategy_str.c_str(), nq_ / TDIFF_,
+                       recall);
+                std::fflush(stdout);
+
+                knowhere::Json point;
+                point["dataset"] = ann_test_name_;
+                point["index_type"] = index_type_;
+                point["data_type"] = data_type_str;
+                point["config"] = conf;
+                point["filter"] = distribution_name(distribution);
+                point["selectivity"] = selectivity;
+                point["strategy"] = strategy_str;
+                point["qps"] = nq_ / TDIFF_;
+                point["recall"] = recall;
+                results_.push_back(std::move(point));
+            }
+        }
+        printf("================================================================================\n");
+        printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+    }
+
+    // the strategies follow the thresholds of the indexes, see WhetherPerformBruteForceSearch() of faiss hnsw and its
+    // copy in hnswlib, which has no two-hop traversal
+    static StrategyFunc
+    hnsw_strategy(int64_t nb, bool two_hop) {
+        return [nb, two_hop](float filter_ratio, int32_t k) -> std::string {
+            const float num_valid = nb * (1.0f - filter_ratio);
+            if (k >= nb * knowhere::HnswSearchThresholds::kHnswSearchBFTopkThreshold ||
+                filter_ratio >= knowhere::HnswSearchThresholds::kHnswSearchKnnBFFilterThreshold ||
+                k >= num_valid * knowhere::HnswSearchThresholds::kHnswSearchBFTopkThreshold) {
+                return "brute force";
+            }
+            if (two_hop && filter_ratio >= knowhere::HnswSearchThresholds::kHnswSearchTwoHopFilterThreshold) {
+                return "graph, two-hop";
+            }
+            return "graph";
+        };
+    }
+
+    // see the default filter threshold of PQFlashIndex::cached_beam_search()
+    static StrategyFunc
+    diskann_strategy(int64_t nb) {
+        return [nb](float filter_ratio, int32_t k) -> std::string {
+            constexpr float kFilterThreshold = 0.93f;
+            if (filter_ratio >= kFilterThreshold || k > 0.5f * nb * (1.0f - filter_ratio)) {
+                return "brute force";
+            }
+            return "beam search";
+        };
+    }
+
+    static StrategyFunc
+    fixed_strategy(const std::string& name) {
+        return [name](float, int32_t) -> std::string { return name; };
+    }
+
+ protected:
+    std::vector<uint8_t>
+    gen_filter(FilterDistribution distribution, size_t nbits_set) {
+        switch (distribution) {
+            case FilterDistribution::CLUSTERED:
+                return GenClusteredBitset(nb_, nbits_set);
+            case FilterDistribution::CORRELATED: {
+                // the rows along the mean of the queries pass, so that the neighbors of the queries tend to pass
+                std::vector<float> direction(dim_, 0.0f);
+                for (int32_t i = 0; i < nq_; i++) {
+                    for (int32_t j = 0; j < dim_; j++) {
+                        direction[j] += ((const float*)xq_)[(int64_t)i * dim_ + j];
+                    }
+                }
+                return GenCorrelatedBitset((const float*)xb_, nb_, dim_, nbits_set, direction);
+            }
+            default:
+                return GenRandomBitset(nb_, nbits_set);
+        }
+    }
+
+    static std::string
+    distribution_name(FilterDistribution distribution) {
+        switch (distribution) {
+            case FilterDistribution::CLUSTERED:
+                return "clustered";
+            case FilterDistribution::CORRELATED:
+                return "correlated";
+            default:
+                return "random";
+        }
+    }
+
+    knowhere::expected<knowhere::DataSetPtr>
+    golden_search(const knowhere::Json& conf, const knowhere::BitsetView& bitset) {
+        if (sparse_base_ != nullptr) {
+            return knowhere::BruteForce::SearchSparse(sparse_base_, sparse_query_, conf, bitset);
+        }
+        return golden_index_.value().Search(knowhere::GenDataSet(nq_, dim_, xq_), conf, bitset);
+    }
+
+    // the sift vectors have many zero dimensions, their non-zero ones make the rows of a sparse dataset
+    static knowhere::DataSetPtr
+    to_sparse(const float* x, int32_t rows, int32_t dim) {
+        auto tensor = std::make_unique<knowhere::sparse::SparseRow<float>[]>(rows);
+        for (int32_t i = 0; i < rows; i++) {
+            std::vector<std::pair<knowhere::sparse::table_t, float>> row;
+            for (int32_t j = 0; j < dim; j++) {
+                if (x[(int64_t)i * dim + j] != 0.0f) {
+                    row.emplace_back(j, x[(int64_t)i * dim + j]);
+                }
+            }
+            tensor[i] = knowhere::sparse::SparseRow<float>(row);
+        }
+        auto ds = knowhere::GenDataSet(rows, dim, tensor.release());
+        ds->SetIsOwner(true);
+        ds->SetIsSparse(true);
+        return ds;
+    }
+
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        set_ann_test_name("sift-128-euclidean");
+        parse_ann_test_name();
+        load_hdf5_data<knowhere::fp32>();
+
+        cfg_[knowhere::meta::METRIC_TYPE] = metric_type_;
+        knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AVX2);
+        knowhere::KnowhereConfig::SetBuildThreadPoolSize(default_build_thread_num);
+        knowhere::KnowhereConfig::SetSearchThreadPoolSize(default_search_thread_num);
+        printf("faiss::distance_compute_blas_threshold: %ld\n", knowhere::KnowhereConfig::GetBlasThreshold());
+
+        create_golden_index(cfg_);
+    }
+
+    void
+    TearDown() override {
+        if (!results_.empty()) {
+            const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+            std::ofstream out(ann_test_name_ + "_" + test_info->name() + "_selectivity.json");
+            out << results_.dump(2) << std::endl;
+        }
+        free_all();
+    }
+
+ protected:
+    const int32_t topk_ = 100;
+    const std::vector<float> SELECTIVITIES_ = {0.001, 0.005, 0.01, 0.02, 0.05, 0.07, 0.1, 0.2, 0.5, 0.8, 0.9, 0.99};
+    const std::vector<FilterDistribution> DISTRIBUTIONs_ = {FilterDistribution::RANDOM, FilterDistribution::CLUSTERED,
+                                                            FilterDistribution::CORRELATED};
+
+    // HNSW index params
+    const int32_t HNSW_M_ = 16;
+    const int32_t EFCON_ = 200;
+    const int32_t EF_ = 128;
+
+    // IVF index params
+    const int32_t NLIST_ = 1024;
+    const int32_t NPROBE_ = 32;
+
+    knowhere::DataSetPtr sparse_base_ = nullptr;
+    knowhere::DataSetPtr sparse_query_ = nullptr;
+    knowhere::Json results_ = knowhere::Json::array();
+};
+
+#define TEST_INDEX(T, X, STRATEGY)          \
+    index_file_name = get_index_name<T>(X); \
+    create_index<T>(index_file_name, conf); \
+    test_selectivity<T>(conf, STRATEGY)
+
+TEST_F(Benchmark_float_selectivity, TEST_HNSW) {
+    index_type_ = knowhere::IndexEnum::INDEX_HNSW;
+
+    std::string index_file_name;
+    knowhere::Json conf = cfg_;
+    conf[knowhere::indexparam::HNSW_M] = HNSW_M_;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = EFCON_;
+    conf[knowhere::indexparam::EF] = EF_;
+    std::vector<int32_t> params = {HNSW_M_, EFCON_};
+
+    TEST_INDEX(knowhere::fp32, params, hnsw_strategy(nb_, true));
+}
+
+// the indexes of the versions before the faiss hnsw are searched by hnswlib
+TEST_F(Benchmark_float_selectivity, TEST_HNSW_FALLBACK) {
+    index_type_ = knowhere::IndexEnum::INDEX_HNSW;
+
+    knowhere::Json conf = cfg_;
+    conf[knowhere::indexparam::HNSW_M] = HNSW_M_;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = EFCON_;
+    conf[knowhere::indexparam::EF] = EF_;
+
+    auto version = knowhere::Version::GetMinimalVersion().VersionNumber();
+    index_ = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type_, version);
+    printf("[%.3f s] Building hnswlib index all on %d vectors\n", get_time_diff(), nb_);
+    index_.value().Build(knowhere::GenDataSet(nb_, dim_, xb_), conf);
+
+    test_selectivity<knowhere::fp32>(conf, hnsw_strategy(nb_, false));
+}
+
+TEST_F(Benchmark_float_selectivity, TEST_IVF_FLAT) {
+    index_type_ = knowhere::IndexEnum::INDEX_FAISS_IVFFLAT;
+
+    std::string index_file_name;
+    knowhere::Json conf = cfg_;
+    conf[knowhere::indexparam::NLIST] = NLIST_;
+    conf[knowhere::indexparam::NPROBE] = NPROBE_;
+    std::vector<int32_t> params = {NLIST_};
+
+    TEST_INDEX(knowhere::fp32, params, fixed_strategy("list scan"));
+}
+
+TEST_F(Benchmark_float_selectivity, TEST_SPARSE_INVERTED_INDEX) {
+    index_type_ = knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX;
+
+    knowhere::Json conf = cfg_;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::IP;
+    conf[knowhere::indexparam::DROP_RATIO_SEARCH] = 0.0f;
+    conf[knowhere::indexparam::INVERTED_INDEX_ALGO] = "DAAT_MAXSCORE";
+
+    sparse_base_ = to_sparse((const float*)xb_, nb_, dim_);
+    sparse_query_ = to_sparse((const float*)xq_, nq_, dim_);
+
+    auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+    index_ = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type_, version);
+    printf("[%.3f s] Building sparse index all on %d vectors\n", get_time_diff(), nb_);
+    index_.value().Build(sparse_base_, conf);
+
+    // the sparse queries replace the dense ones
+    auto conf_sparse = conf;
+    conf_sparse[knowhere::meta::TOPK] = topk_;
+    printf("\n[%0.3f s] %s | %s | k=%d\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str(), topk_);
+    printf("================================================================================\n");
+    for (auto distribution : DISTRIBUTIONs_) {
+        for (auto selectivity : SELECTIVITIES_) {
+            const size_t nbits_set = nb_ - std::max<size_t>(1, nb_ * selectivity);
+            auto bitset_data = gen_filter(distribution, nbits_set);
+            knowhere::BitsetView bitset(bitset_data.data(), nb_, nbits_set);
+
+            auto g_result = golden_search(conf_sparse, bitset);
+            CALC_TIME_SPAN(auto result = index_.value().Search(sparse_query_, conf_sparse, bitset));
+            const float recall = CalcRecall(g_result.value()->GetIds(), result.value()->GetIds(), nq_, topk_);
+            printf("  filter = %10s, selectivity = %6.2f%%, strategy = %-20s, QPS = %9.3f, R@ = %.4f\n",
+                   distribution_name(distribution).c_str(), selectivity * 100, "DAAT_MAXSCORE", nq_ / TDIFF_, recall);
+            std::fflush(stdout);
+
+            knowhere::Json point;
+            point["dataset"] = ann_test_name_;
+            point["index_type"] = index_type_;
+            point["config"] = conf_sparse;
+            point["filter"] = distribution_name(distribution);
+            point["selectivity"] = selectivity;
+            point["strategy"] = "DAAT_MAXSCORE";
+            point["qps"] = nq_ / TDIFF_;
+            point["recall"] = recall;
+            results_.push_back(std::move(point));
+        }
+    }
+    printf("================================================================================\n");
+}
+
+#ifdef KNOWHERE_WITH_DISKANN
+TEST_F(Benchmark_float_selectivity, TEST_DISKANN) {
+    index_type_ = knowhere::IndexEnum::INDEX_DISKANN;
+
+    knowhere::Json conf = cfg_;
+
+    conf[knowhere::meta::INDEX_PREFIX] = (metric_type_ == knowhere::metric::L2 ? kL2IndexPrefix : kIPIndexPrefix);
+    conf[knowhere::meta::DATA_PATH] = kRawDataPath;
+    conf[knowhere::indexparam::MAX_DEGREE] = 56;
+    conf[knowhere::indexparam::PQ_CODE_BUDGET_GB] = sizeof(float) * dim_ * nb_ * 0.125 / (1024 * 1024 * 1024);
+    conf[knowhere::indexparam::BUILD_DRAM_BUDGET_GB] = 32.0;
+    conf[knowhere::indexparam::SEARCH_CACHE_BUDGET_GB] = 0;
+    conf[knowhere::indexparam::BEAMWIDTH] = 8;
+    conf[knowhere::indexparam::SEARCH_LIST_SIZE] = 2 * topk_;
+
+    fs::create_directory(kDir);
+    fs::create_directory(kL2IndexDir);
+    fs::create_directory(kIPIndexDir);
+
+    WriteRawDataToDisk(kRawDataPath, (const float*)xb_, (const uint32_t)nb_, (const uint32_t)dim_);
+
+    std::shared_ptr<milvus::FileManager> file_manager = std::make_shared<milvus::LocalFileManager>();
+    auto diskann_index_pack = knowhere::Pack(file_manager);
+
+    auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+    index_ = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type_, version, diskann_index_pack);
+    printf("[%.3f s] Building all on %d vectors\n", get_time_diff(), nb_);
+    knowhere::DataSetPtr ds_ptr = nullptr;
+    index_.value().Build(ds_ptr, conf);
+
+    knowhere::BinarySet binset;
+    index_.value().Serialize(binset);
+    index_.value().Deserialize(binset, conf);
+
+    test_selectivity<knowhere::fp32>(conf, diskann_strategy(nb_));
+}
+#endif
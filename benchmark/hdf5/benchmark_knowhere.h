@@ -185,6 +185,7 @@ class Benchmark_knowhere : public Benchmark_hdf5 {
     template <typename T>
     knowhere::Index<knowhere::IndexNode>
     create_index(const std::string& index_file_name, const knowhere::Json& conf) {
+        index_file_name_ = index_file_name;
         auto idx = this->create_index<T>(index_type_, index_file_name, knowhere::GenDataSet(nb_, dim_, xb_), conf);
         index_ = idx;
         return idx;
@@ -214,6 +215,8 @@ class Benchmark_knowhere : public Benchmark_hdf5 {
     std::string index_type_;
     knowhere::Json cfg_;
     knowhere::expected<knowhere::Index<knowhere::IndexNode>> index_;
+    // the file name of the index under test, that names its type, build params and data type
+    std::string index_file_name_;
 
     std::string golden_index_type_;
     knowhere::Json golden_cfg_;
@@ -0,0 +1,577 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/config.h"
+#include "knowhere/operands.h"
+#include "src/simd/hook.h"
+
+// The inputs of the kernels for a dim: kNy base vectors of every type, a query, and the auxiliary arrays.
+struct KernelData {
+    static constexpr size_t kNy = 1024;
+
+    explicit KernelData(size_t d) : d(d) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> real(-1.0f, 1.0f);
+        std::uniform_int_distribution<int> byte(0, 255);
+        xq.resize(d);
+        xb.resize(kNy * d);
+        for (auto& v : xq) {
+            v = real(rng);
+        }
+        for (auto& v : xb) {
+            v = real(rng);
+        }
+        convert(xq, xq_fp16, xq_bf16, xq_int8);
+        convert(xb, xb_fp16, xb_bf16, xb_int8);
+        // the codes of the binary, minhash, hash and pq kernels, of up to 8 * d bytes a vector
+        bytes_q.resize(8 * d);
+        bytes_b.resize(kNy * 8 * d);
+        for (auto& v : bytes_q) {
+            v = byte(rng);
+        }
+        for (auto& v : bytes_b) {
+            v = byte(rng);
+        }
+        xb_transposed.resize(kNy * d);
+        y_sqlen.resize(kNy);
+        for (size_t i = 0; i < kNy; i++) {
+            y_sqlen[i] = faiss::fvec_norm_L2sqr(xb.data() + i * d, d);
+            for (size_t j = 0; j < d; j++) {
+                xb_transposed[j * kNy + i] = xb[i * d + j];
+            }
+        }
+        sorted_u64.resize(d);
+        sorted_u32.resize(d);
+        for (size_t i = 0; i < d; i++) {
+            sorted_u64[i] = i * 7;
+            sorted_u32[i] = i * 7;
+        }
+        // the sparse rows hold d / 4 (id, value) pairs with ids spread over 2 * d
+        for (size_t i = 0; i < d / 4; i++) {
+            sparse_q.push_back({(uint32_t)(i * 8), real(rng)});
+            sparse_b.push_back({(uint32_t)(i * 8 + (i % 2) * 4), real(rng)});
+        }
+        lut.resize(256 * d);
+        for (auto& v : lut) {
+            v = real(rng);
+        }
+        out.resize(kNy * d);
+    }
+
+    static void
+    convert(const std::vector<float>& src, std::vector<knowhere::fp16>& fp16, std::vector<knowhere::bf16>& bf16,
+            std::vector<int8_t>& int8) {
+        fp16.assign(src.begin(), src.end());
+        bf16.assign(src.begin(), src.end());
+        int8.resize(src.size());
+        for (size_t i = 0; i < src.size(); i++) {
+            int8[i] = (int8_t)(src[i] * 127);
+        }
+    }
+
+    struct SparsePair {
+        uint32_t id;
+        float val;
+    };
+
+    size_t d;
+    std::vector<float> xq, xb, xb_transposed, y_sqlen, lut, out;
+    std::vector<knowhere::fp16> xq_fp16, xb_fp16;
+    std::vector<knowhere::bf16> xq_bf16, xb_bf16;
+    std::vector<int8_t> xq_int8, xb_int8;
+    std::vector<uint8_t> bytes_q, bytes_b;
+    std::vector<uint64_t> sorted_u64;
+    std::vector<uint32_t> sorted_u32;
+    std::vector<SparsePair> sparse_q, sparse_b;
+};
+
+// A kernel of the hooks: runs it over the kNy base vectors once, and returns a checksum so that the calls are kept.
+struct KernelCase {
+    std::string name;
+    // the bytes of a base vector that a call reads
+    std::function<size_t(size_t d)> bytes_per_vector;
+    std::function<float(KernelData&)> run;
+};
+
+namespace {
+
+constexpr size_t kNy = KernelData::kNy;
+
+// runs fn(x, y0, y1, y2, y3, dis0, dis1, dis2, dis3) over the base vectors of type T, 4 at a time
+template <typename T, typename Dis, typename Fn>
+float
+run_batch_4(const T* x, const T* y, size_t stride, Fn fn) {
+    float sum = 0;
+    for (size_t i = 0; i < kNy; i += 4) {
+        Dis dis0, dis1, dis2, dis3;
+        fn(x, y + i * stride, y + (i + 1) * stride, y + (i + 2) * stride, y + (i + 3) * stride, dis0, dis1, dis2, dis3);
+        sum += dis0 + dis1 + dis2 + dis3;
+    }
+    return sum;
+}
+
+template <typename T, typename Fn>
+float
+run_each(const T* y, size_t stride, Fn fn) {
+    float sum = 0;
+    for (size_t i = 0; i < kNy; i++) {
+        sum += fn(y + i * stride);
+    }
+    return sum;
+}
+
+std::vector<KernelCase>
+kernel_cases() {
+    auto fp32_bytes = [](size_t d) { return d * sizeof(float); };
+    auto half_bytes = [](size_t d) { return d * sizeof(uint16_t); };
+    auto int8_bytes = [](size_t d) { return d; };
+    auto bit_bytes = [](size_t d) { return d / 8; };
+
+    std::vector<KernelCase> cases = {
+        // fp32
+        {"fvec_inner_product", fp32_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb.data(), k.d, [&](auto y) { return faiss::fvec_inner_product(k.xq.data(), y, k.d); });
+         }},
+        {"fvec_L2sqr", fp32_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb.data(), k.d, [&](auto y) { return faiss::fvec_L2sqr(k.xq.data(), y, k.d); });
+         }},
+        {"fvec_L1", fp32_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb.data(), k.d, [&](auto y) { return faiss::fvec_L1(k.xq.data(), y, k.d); });
+         }},
+        {"fvec_Linf", fp32_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb.data(), k.d, [&](auto y) { return faiss::fvec_Linf(k.xq.data(), y, k.d); });
+         }},
+        {"fvec_norm_L2sqr", fp32_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb.data(), k.d, [&](auto y) { return faiss::fvec_norm_L2sqr(y, k.d); });
+         }},
+        {"fvec_inner_product_batch_4", fp32_bytes,
+         [](KernelData& k) {
+             return run_batch_4<float, float>(k.xq.data(), k.xb.data(), k.d,
+                                              [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1,
+                                                  float& d2, float& d3) {
+                                                  faiss::fvec_inner_product_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2,
+                                                                                    d3);
+                                              });
+         }},
+        {"fvec_L2sqr_batch_4", fp32_bytes,
+         [](KernelData& k) {
+             return run_batch_4<float, float>(k.xq.data(), k.xb.data(), k.d,
+                                              [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1,
+                                                  float& d2, float& d3) {
+                                                  faiss::fvec_L2sqr_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2, d3);
+                                              });
+         }},
+        {"fvec_inner_product_batch_8", fp32_bytes,
+         [](KernelData& k) {
+             float sum = 0;
+             const float* y = k.xb.data();
+             for (size_t i = 0; i < kNy; i += 8) {
+                 float dis[8];
+                 faiss::fvec_inner_product_batch_8(k.xq.data(), y + i * k.d, y + (i + 1) * k.d, y + (i + 2) * k.d,
+                                                   y + (i + 3) * k.d, y + (i + 4) * k.d, y + (i + 5) * k.d,
+                                                   y + (i + 6) * k.d, y + (i + 7) * k.d, k.d, dis[0], dis[1], dis[2],
+                                                   dis[3], dis[4], dis[5], dis[6], dis[7]);
+                 sum += dis[0] + dis[7];
+             }
+             return sum;
+         }},
+        {"fvec_inner_products_ny", fp32_bytes,
+         [](KernelData& k) {
+             faiss::fvec_inner_products_ny(k.out.data(), k.xq.data(), k.xb.data(), k.d, kNy);
+             return k.out[0];
+         }},
+        {"fvec_L2sqr_ny", fp32_bytes,
+         [](KernelData& k) {
+             faiss::fvec_L2sqr_ny(k.out.data(), k.xq.data(), k.xb.data(), k.d, kNy);
+             return k.out[0];
+         }},
+        {"fvec_L2sqr_ny_transposed", fp32_bytes,
+         [](KernelData& k) {
+             faiss::fvec_L2sqr_ny_transposed(k.out.data(), k.xq.data(), k.xb_transposed.data(), k.y_sqlen.data(), k.d,
+                                             kNy, kNy);
+             return k.out[0];
+         }},
+        {"fvec_L2sqr_ny_nearest", fp32_bytes,
+         [](KernelData& k) {
+             return (float)faiss::fvec_L2sqr_ny_nearest(k.out.data(), k.xq.data(), k.xb.data(), k.d, kNy);
+         }},
+        {"fvec_L2sqr_ny_nearest_y_transposed", fp32_bytes,
+         [](KernelData& k) {
+             return (float)faiss::fvec_L2sqr_ny_nearest_y_transposed(k.out.data(), k.xq.data(), k.xb_transposed.data(),
+                                                                     k.y_sqlen.data(), k.d, kNy, kNy);
+         }},
+        {"fvec_madd", fp32_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb.data(), k.d, [&](auto y) {
+                 faiss::fvec_madd(k.d, k.xq.data(), 0.5f, y, k.out.data());
+                 return k.out[0];
+             });
+         }},
+        {"fvec_madd_and_argmin", fp32_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb.data(), k.d, [&](auto y) {
+                 return (float)faiss::fvec_madd_and_argmin(k.d, k.xq.data(), 0.5f, y, k.out.data());
+             });
+         }},
+        // fp16
+        {"fp16_vec_inner_product", half_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_fp16.data(), k.d,
+                             [&](auto y) { return faiss::fp16_vec_inner_product(k.xq_fp16.data(), y, k.d); });
+         }},
+        {"fp16_vec_L2sqr", half_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_fp16.data(), k.d,
+                             [&](auto y) { return faiss::fp16_vec_L2sqr(k.xq_fp16.data(), y, k.d); });
+         }},
+        {"fp16_vec_norm_L2sqr", half_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_fp16.data(), k.d, [&](auto y) { return faiss::fp16_vec_norm_L2sqr(y, k.d); });
+         }},
+        {"fp16_vec_inner_product_batch_4", half_bytes,
+         [](KernelData& k) {
+             return run_batch_4<knowhere::fp16, float>(
+                 k.xq_fp16.data(), k.xb_fp16.data(), k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::fp16_vec_inner_product_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2, d3);
+                 });
+         }},
+        {"fp16_vec_L2sqr_batch_4", half_bytes,
+         [](KernelData& k) {
+             return run_batch_4<knowhere::fp16, float>(
+                 k.xq_fp16.data(), k.xb_fp16.data(), k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::fp16_vec_L2sqr_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2, d3);
+                 });
+         }},
+        // bf16
+        {"bf16_vec_inner_product", half_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_bf16.data(), k.d,
+                             [&](auto y) { return faiss::bf16_vec_inner_product(k.xq_bf16.data(), y, k.d); });
+         }},
+        {"bf16_vec_L2sqr", half_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_bf16.data(), k.d,
+                             [&](auto y) { return faiss::bf16_vec_L2sqr(k.xq_bf16.data(), y, k.d); });
+         }},
+        {"bf16_vec_norm_L2sqr", half_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_bf16.data(), k.d, [&](auto y) { return faiss::bf16_vec_norm_L2sqr(y, k.d); });
+         }},
+        {"bf16_vec_inner_product_batch_4", half_bytes,
+         [](KernelData& k) {
+             return run_batch_4<knowhere::bf16, float>(
+                 k.xq_bf16.data(), k.xb_bf16.data(), k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::bf16_vec_inner_product_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2, d3);
+                 });
+         }},
+        {"bf16_vec_L2sqr_batch_4", half_bytes,
+         [](KernelData& k) {
+             return run_batch_4<knowhere::bf16, float>(
+                 k.xq_bf16.data(), k.xb_bf16.data(), k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::bf16_vec_L2sqr_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2, d3);
+                 });
+         }},
+        // int8
+        {"ivec_inner_product", int8_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_int8.data(), k.d,
+                             [&](auto y) { return (float)faiss::ivec_inner_product(k.xq_int8.data(), y, k.d); });
+         }},
+        {"ivec_L2sqr", int8_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_int8.data(), k.d,
+                             [&](auto y) { return (float)faiss::ivec_L2sqr(k.xq_int8.data(), y, k.d); });
+         }},
+        {"int8_vec_inner_product", int8_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_int8.data(), k.d,
+                             [&](auto y) { return faiss::int8_vec_inner_product(k.xq_int8.data(), y, k.d); });
+         }},
+        {"int8_vec_L2sqr", int8_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_int8.data(), k.d,
+                             [&](auto y) { return faiss::int8_vec_L2sqr(k.xq_int8.data(), y, k.d); });
+         }},
+        {"int8_vec_norm_L2sqr", int8_bytes,
+         [](KernelData& k) {
+             return run_each(k.xb_int8.data(), k.d, [&](auto y) { return faiss::int8_vec_norm_L2sqr(y, k.d); });
+         }},
+        {"int8_vec_inner_product_batch_4", int8_bytes,
+         [](KernelData& k) {
+             return run_batch_4<int8_t, float>(
+                 k.xq_int8.data(), k.xb_int8.data(), k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::int8_vec_inner_product_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2, d3);
+                 });
+         }},
+        {"int8_vec_L2sqr_batch_4", int8_bytes,
+         [](KernelData& k) {
+             return run_batch_4<int8_t, float>(
+                 k.xq_int8.data(), k.xb_int8.data(), k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::int8_vec_L2sqr_batch_4(x, y0, y1, y2, y3, k.d, d0, d1, d2, d3);
+                 });
+         }},
+        // rabitq, d bits per vector
+        {"fvec_masked_sum", bit_bytes,
+         [](KernelData& k) {
+             return run_each(k.bytes_b.data(), k.d / 8,
+                             [&](auto x) { return faiss::fvec_masked_sum(k.xq.data(), x, k.d); });
+         }},
+        {"rabitq_dp_popcnt", bit_bytes,
+         [](KernelData& k) {
+             // a query of 4 bit planes
+             return run_each(k.bytes_b.data(), k.d / 8,
+                             [&](auto x) { return (float)faiss::rabitq_dp_popcnt(k.bytes_q.data(), x, k.d, 4); });
+         }},
+        // binary, d bits per vector
+        {"bvec_hamming_distance", bit_bytes,
+         [](KernelData& k) {
+             return run_each(k.bytes_b.data(), k.d / 8,
+                             [&](auto y) { return (float)faiss::bvec_hamming_distance(k.bytes_q.data(), y, k.d / 8); });
+         }},
+        {"bvec_hamming_distance_batch_4", bit_bytes,
+         [](KernelData& k) {
+             return run_batch_4<uint8_t, int>(
+                 k.bytes_q.data(), k.bytes_b.data(), k.d / 8,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, int& d0, int& d1, int& d2, int& d3) {
+                     faiss::bvec_hamming_distance_batch_4(x, y0, y1, y2, y3, k.d / 8, d0, d1, d2, d3);
+                 });
+         }},
+        {"bvec_jaccard_distance", bit_bytes,
+         [](KernelData& k) {
+             return run_each(k.bytes_b.data(), k.d / 8,
+                             [&](auto y) { return faiss::bvec_jaccard_distance(k.bytes_q.data(), y, k.d / 8); });
+         }},
+        {"bvec_jaccard_distance_batch_4", bit_bytes,
+         [](KernelData& k) {
+             return run_batch_4<uint8_t, float>(
+                 k.bytes_q.data(), k.bytes_b.data(), k.d / 8,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::bvec_jaccard_distance_batch_4(x, y0, y1, y2, y3, k.d / 8, d0, d1, d2, d3);
+                 });
+         }},
+        // minhash jaccard, d elements per vector
+        {"u32_jaccard_distance", [](size_t d) { return d * sizeof(uint32_t); },
+         [](KernelData& k) {
+             return run_each(k.bytes_b.data(), 4 * k.d, [&](auto y) {
+                 return faiss::u32_jaccard_distance((const char*)k.bytes_q.data(), (const char*)y, k.d, 4);
+             });
+         }},
+        {"u32_jaccard_distance_batch_4", [](size_t d) { return d * sizeof(uint32_t); },
+         [](KernelData& k) {
+             return run_batch_4<uint8_t, float>(
+                 k.bytes_q.data(), k.bytes_b.data(), 4 * k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::u32_jaccard_distance_batch_4((const char*)x, (const char*)y0, (const char*)y1,
+                                                         (const char*)y2, (const char*)y3, k.d, 4, d0, d1, d2, d3);
+                 });
+         }},
+        {"u32_jaccard_distance_batch_16", [](size_t d) { return d * sizeof(uint32_t); },
+         [](KernelData& k) {
+             float sum = 0;
+             for (size_t i = 0; i < kNy; i += 16) {
+                 const char* y[16];
+                 float dis[16];
+                 for (size_t j = 0; j < 16; j++) {
+                     y[j] = (const char*)k.bytes_b.data() + (i + j) * 4 * k.d;
+                 }
+                 faiss::u32_jaccard_distance_batch_16((const char*)k.bytes_q.data(), y, k.d, 4, dis);
+                 sum += dis[0];
+             }
+             return sum;
+         }},
+        {"u64_jaccard_distance", [](size_t d) { return d * sizeof(uint64_t); },
+         [](KernelData& k) {
+             return run_each(k.bytes_b.data(), 8 * k.d, [&](auto y) {
+                 return faiss::u64_jaccard_distance((const char*)k.bytes_q.data(), (const char*)y, k.d, 8);
+             });
+         }},
+        {"u64_jaccard_distance_batch_4", [](size_t d) { return d * sizeof(uint64_t); },
+         [](KernelData& k) {
+             return run_batch_4<uint8_t, float>(
+                 k.bytes_q.data(), k.bytes_b.data(), 8 * k.d,
+                 [&](auto x, auto y0, auto y1, auto y2, auto y3, float& d0, float& d1, float& d2, float& d3) {
+                     faiss::u64_jaccard_distance_batch_4((const char*)x, (const char*)y0, (const char*)y1,
+                                                         (const char*)y2, (const char*)y3, k.d, 8, d0, d1, d2, d3);
+                 });
+         }},
+        {"u64_jaccard_distance_batch_16", [](size_t d) { return d * sizeof(uint64_t); },
+         [](KernelData& k) {
+             float sum = 0;
+             for (size_t i = 0; i < kNy; i += 16) {
+                 const char* y[16];
+                 float dis[16];
+                 for (size_t j = 0; j < 16; j++) {
+                     y[j] = (const char*)k.bytes_b.data() + (i + j) * 8 * k.d;
+                 }
+                 faiss::u64_jaccard_distance_batch_16((const char*)k.bytes_q.data(), y, k.d, 8, dis);
+                 sum += dis[0];
+             }
+             return sum;
+         }},
+        // hash of 4 * d bytes
+        {"calculate_hash", [](size_t d) { return d * sizeof(uint32_t); },
+         [](KernelData& k) {
+             return run_each(k.bytes_b.data(), 4 * k.d,
+                             [&](auto y) { return (float)(faiss::calculate_hash((const char*)y, 4 * k.d) & 0xff); });
+         }},
+        // binary searches in sorted arrays of d elements
+        {"u64_binary_search_eq", [](size_t d) { return d * sizeof(uint64_t); },
+         [](KernelData& k) {
+             float sum = 0;
+             for (size_t i = 0; i < kNy; i++) {
+                 sum += faiss::u64_binary_search_eq(k.sorted_u64.data(), k.d, (i * 13) % (k.d * 7));
+             }
+             return sum;
+         }},
+        {"u64_binary_search_ge", [](size_t d) { return d * sizeof(uint64_t); },
+         [](KernelData& k) {
+             float sum = 0;
+             for (size_t i = 0; i < kNy; i++) {
+                 sum += faiss::u64_binary_search_ge(k.sorted_u64.data(), k.d, (i * 13) % (k.d * 7));
+             }
+             return sum;
+         }},
+        {"u32_lower_bound", [](size_t d) { return d * sizeof(uint32_t); },
+         [](KernelData& k) {
+             float sum = 0;
+             for (size_t i = 0; i < kNy; i++) {
+                 sum += faiss::u32_lower_bound(k.sorted_u32.data(), k.d, (i * 13) % (k.d * 7));
+             }
+             return sum;
+         }},
+        // sparse rows of d / 4 pairs
+        {"sparse_ip", [](size_t d) { return d / 4 * sizeof(KernelData::SparsePair); },
+         [](KernelData& k) {
+             float sum = 0;
+             for (size_t i = 0; i < kNy; i++) {
+                 sum += faiss::sparse_ip(k.sparse_q.data(), k.sparse_q.size(), k.sparse_b.data(), k.sparse_b.size());
+             }
+             return sum;
+         }},
+        {"fvec_scatter_madd", [](size_t d) { return d / 4 * sizeof(KernelData::SparsePair); },
+         [](KernelData& k) {
+             std::vector<uint32_t> ids(k.d / 4);
+             std::vector<float> vals(k.d / 4);
+             for (size_t i = 0; i < ids.size(); i++) {
+                 ids[i] = k.sparse_b[i].id;
+                 vals[i] = k.sparse_b[i].val;
+             }
+             for (size_t i = 0; i < kNy; i++) {
+                 faiss::fvec_scatter_madd(k.out.data(), ids.data(), vals.data(), ids.size(), 0.5f, 0);
+             }
+             return k.out[0];
+         }},
+        // pq codes of d / 4 chunks of 8 bits
+        {"pq8_lut_sum", [](size_t d) { return d / 4; },
+         [](KernelData& k) {
+             faiss::pq8_lut_sum(k.bytes_b.data(), kNy, k.d / 4, k.lut.data(), k.out.data());
+             return k.out[0];
+         }},
+    };
+    return cases;
+}
+
+}  // namespace
+
+// Times every kernel of the hooks for the common dims, with every SIMD level that SetSimdType selects (on the other
+// platforms than x86, fvec_hook picks the best of NEON, SVE, RVV or PowerPC that is compiled and supported), and
+// reports the ns per base vector and the GB/s of the base vectors read. The results are also written as json.
+class Benchmark_simd_kernels : public ::testing::Test {
+ protected:
+    static double
+    time_kernel(const KernelCase& kernel, KernelData& data, float& checksum) {
+        using clock = std::chrono::steady_clock;
+        // warm up, then repeat until kMinDuration has passed
+        checksum += kernel.run(data);
+        size_t reps = 0;
+        const auto start = clock::now();
+        auto now = start;
+        do {
+            checksum += kernel.run(data);
+            reps++;
+            now = clock::now();
+        } while (now - start < kMinDuration);
+        return std::chrono::duration<double, std::nano>(now - start).count() / (reps * kNy);
+    }
+
+    const std::vector<size_t> DIMs_ = {32, 64, 128, 256, 384, 512, 768, 1024, 1536};
+#if defined(__x86_64__)
+    const std::vector<knowhere::KnowhereConfig::SimdType> SIMD_TYPEs_ = {
+        knowhere::KnowhereConfig::SimdType::GENERIC, knowhere::KnowhereConfig::SimdType::SSE4_2,
+        knowhere::KnowhereConfig::SimdType::AVX2, knowhere::KnowhereConfig::SimdType::AVX512};
+#else
+    const std::vector<knowhere::KnowhereConfig::SimdType> SIMD_TYPEs_ = {knowhere::KnowhereConfig::SimdType::AUTO};
+#endif
+    static constexpr std::chrono::milliseconds kMinDuration{20};
+};
+
+TEST_F(Benchmark_simd_kernels, TEST_ALL_KERNELS) {
+    auto cases = kernel_cases();
+    knowhere::Json results = knowhere::Json::array();
+    std::set<std::string> simd_strs;
+    float checksum = 0;
+    for (auto simd_type : SIMD_TYPEs_) {
+        std::string simd_str = knowhere::KnowhereConfig::SetSimdType(simd_type);
+        // a level that the cpu does not support falls back to one that was timed already
+        if (!simd_strs.insert(simd_str).second) {
+            continue;
+        }
+        printf("\nsimd = %s\n", simd_str.c_str());
+        printf("================================================================================\n");
+        for (auto d : DIMs_) {
+            KernelData data(d);
+            for (const auto& kernel : cases) {
+                const double ns = time_kernel(kernel, data, checksum);
+                const double gbps = kernel.bytes_per_vector(d) / ns;
+                printf("  %-36s d = %5zu, %10.2f ns/vector, %8.2f GB/s\n", kernel.name.c_str(), d, ns, gbps);
+
+                knowhere::Json point;
+                point["simd"] = simd_str;
+                point["kernel"] = kernel.name;
+                point["dim"] = d;
+                point["ns_per_vector"] = ns;
+                point["gb_per_s"] = gbps;
+                results.push_back(std::move(point));
+            }
+            std::fflush(stdout);
+        }
+        printf("================================================================================\n");
+    }
+    knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO);
+    printf("checksum: %f\n", checksum);
+
+    std::ofstream out("simd_kernels.json");
+    out << results.dump(2) << std::endl;
+}
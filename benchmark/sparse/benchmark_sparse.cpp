@@ -0,0 +1,221 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark_base.h"
+#include "benchmark/utils.h"
+#include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/dataset.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/sparse_utils.h"
+#include "knowhere/version.h"
+
+/*****************************************************************************************
+ * The datasets are in the CSR format of the sparse track of big-ann-benchmarks:
+ *   int64 nrow, int64 ncol, int64 nnz, int64 indptr[nrow + 1], int32 indices[nnz],
+ *   float data[nnz]
+ * e.g. the MS MARCO SPLADE embeddings (base_small.csr, queries.dev.csr) from
+ *   https://github.com/harsha-simhadri/big-ann-benchmarks
+ * For BM25, the rows of the base are the term frequencies of the tokenized documents and
+ *   the rows of the queries are the term weights (e.g. 1 per distinct term).
+ * The datasets whose files are missing are skipped.
+ *****************************************************************************************/
+struct SparseDatasetFiles {
+    std::string name;
+    std::string base_path;
+    std::string query_path;
+    std::string metric_type;
+};
+
+static const std::vector<SparseDatasetFiles> SPARSE_DATASETS = {
+    {"msmarco-splade", "data/sparse/base_small.csr", "data/sparse/queries.dev.csr", knowhere::metric::IP},
+    {"msmarco-bm25", "data/sparse/bm25_base.csr", "data/sparse/bm25_queries.csr", knowhere::metric::BM25},
+};
+
+static const size_t default_build_thread_num = 8;
+static const size_t default_search_thread_num = 8;
+
+class Benchmark_sparse : public Benchmark_base, public ::testing::Test {
+ public:
+    static knowhere::DataSetPtr
+    load_csr(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        int64_t nrow, ncol, nnz;
+        in.read((char*)&nrow, sizeof(int64_t));
+        in.read((char*)&ncol, sizeof(int64_t));
+        in.read((char*)&nnz, sizeof(int64_t));
+        std::vector<int64_t> indptr(nrow + 1);
+        std::vector<int32_t> indices(nnz);
+        std::vector<float> data(nnz);
+        in.read((char*)indptr.data(), (nrow + 1) * sizeof(int64_t));
+        in.read((char*)indices.data(), nnz * sizeof(int32_t));
+        in.read((char*)data.data(), nnz * sizeof(float));
+
+        auto tensor = std::make_unique<knowhere::sparse::SparseRow<float>[]>(nrow);
+        for (int64_t i = 0; i < nrow; i++) {
+            knowhere::sparse::SparseRow<float> row(indptr[i + 1] - indptr[i]);
+            for (int64_t j = indptr[i]; j < indptr[i + 1]; j++) {
+                row.set_at(j - indptr[i], indices[j], data[j]);
+            }
+            tensor[i] = std::move(row);
+        }
+        auto ds = knowhere::GenDataSet(nrow, ncol, tensor.release());
+        ds->SetIsOwner(true);
+        ds->SetIsSparse(true);
+        return ds;
+    }
+
+    void
+    test_sparse(const SparseDatasetFiles& files) {
+        if (!std::filesystem::exists(files.base_path) || !std::filesystem::exists(files.query_path)) {
+            printf("[%.3f s] Dataset '%s' not found, skipped\n", get_time_diff(), files.name.c_str());
+            return;
+        }
+        printf("[%.3f s] Loading dataset '%s'\n", get_time_diff(), files.name.c_str());
+        auto base = load_csr(files.base_path);
+        auto query = load_csr(files.query_path);
+        nb_ = base->GetRows();
+        nq_ = query->GetRows();
+
+        knowhere::Json conf;
+        conf[knowhere::meta::METRIC_TYPE] = files.metric_type;
+        conf[knowhere::meta::TOPK] = topk_;
+        if (files.metric_type == knowhere::metric::BM25) {
+            // the length of a document is the sum of its term frequencies
+            double sum = 0.0;
+            auto rows = (const knowhere::sparse::SparseRow<float>*)base->GetTensor();
+            for (int32_t i = 0; i < nb_; i++) {
+                for (size_t j = 0; j < rows[i].size(); j++) {
+                    sum += rows[i][j].val;
+                }
+            }
+            conf[knowhere::meta::BM25_K1] = 1.2;
+            conf[knowhere::meta::BM25_B] = 0.75;
+            conf[knowhere::meta::BM25_AVGDL] = sum / std::max(nb_, 1);
+        }
+
+        printf("[%.3f s] Brute force search of %d queries on %d rows\n", get_time_diff(), nq_, nb_);
+        auto gt = knowhere::BruteForce::SearchSparse(base, query, conf, nullptr);
+        ASSERT_TRUE(gt.has_value());
+
+        for (const auto& index_type : INDEX_TYPEs_) {
+            for (const auto& algo : INVERTED_INDEX_ALGOs_) {
+                auto build_conf = conf;
+                build_conf[knowhere::indexparam::INVERTED_INDEX_ALGO] = algo;
+
+                auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+                auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version);
+                ASSERT_TRUE(index.has_value());
+                CALC_TIME_SPAN(auto status = index.value().Build(base, build_conf));
+                ASSERT_EQ(status, knowhere::Status::success);
+                const double build_time = TDIFF_;
+                const int64_t index_size = index.value().Size();
+
+                printf("\n[%0.3f s] %s | %s | %s | build = %.3fs, size = %.1f MB, k=%d\n", get_time_diff(),
+                       files.name.c_str(), index_type.c_str(), algo.c_str(), build_time,
+                       index_size / (1024.0 * 1024.0), topk_);
+                printf("================================================================================\n");
+                for (auto drop_ratio : DROP_RATIO_SEARCHs_) {
+                    auto search_conf = build_conf;
+                    search_conf[knowhere::indexparam::DROP_RATIO_SEARCH] = drop_ratio;
+
+                    // the QPS of the batched queries
+                    CALC_TIME_SPAN(auto result = index.value().Search(query, search_conf, nullptr));
+                    ASSERT_TRUE(result.has_value());
+                    const double qps = nq_ / TDIFF_;
+                    const float recall = CalcRecall(gt.value()->GetIds(), result.value()->GetIds(), nq_, topk_);
+
+                    // the latencies of the single queries
+                    LatencyHistogram histogram;
+                    auto query_rows = (const knowhere::sparse::SparseRow<float>*)query->GetTensor();
+                    for (int32_t i = 0; i < nq_; i++) {
+                        auto single = knowhere::GenDataSet(1, query->GetDim(), query_rows + i);
+                        single->SetIsSparse(true);
+                        const auto start = std::chrono::steady_clock::now();
+                        index.value().Search(single, search_conf, nullptr);
+                        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start);
+                        histogram.record(latency.count());
+                    }
+
+                    printf(
+                        "  drop_ratio_search = %.2f, QPS = %9.3f, R@ = %.4f, latency (us) P50 = %6lu, P99 = %6lu, "
+                        "P999 = %6lu\n",
+                        drop_ratio, qps, recall, histogram.percentile(50), histogram.percentile(99),
+                        histogram.percentile(99.9));
+                    std::fflush(stdout);
+
+                    knowhere::Json point;
+                    point["dataset"] = files.name;
+                    point["index_type"] = index_type;
+                    point["inverted_index_algo"] = algo;
+                    point["drop_ratio_search"] = drop_ratio;
+                    point["build_time_s"] = build_time;
+                    point["index_size_bytes"] = index_size;
+                    point["qps"] = qps;
+                    point["recall"] = recall;
+                    point["latency_us"]["p50"] = histogram.percentile(50);
+                    point["latency_us"]["p95"] = histogram.percentile(95);
+                    point["latency_us"]["p99"] = histogram.percentile(99);
+                    point["latency_us"]["p999"] = histogram.percentile(99.9);
+                    point["latency_us"]["max"] = histogram.max();
+                    results_.push_back(std::move(point));
+                }
+                printf("================================================================================\n");
+            }
+        }
+        printf("[%.3f s] Test '%s' done\n\n", get_time_diff(), files.name.c_str());
+    }
+
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        knowhere::KnowhereConfig::SetBuildThreadPoolSize(default_build_thread_num);
+        knowhere::KnowhereConfig::SetSearchThreadPoolSize(default_search_thread_num);
+    }
+
+    void
+    TearDown() override {
+        if (!results_.empty()) {
+            const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+            std::ofstream out(std::string(test_info->name()) + "_sparse.json");
+            out << results_.dump(2) << std::endl;
+        }
+    }
+
+ protected:
+    const int32_t topk_ = 10;
+    const std::vector<std::string> INDEX_TYPEs_ = {
+        knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, knowhere::IndexEnum::INDEX_SPARSE_WAND,
+        knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX_CC, knowhere::IndexEnum::INDEX_SPARSE_WAND_CC};
+    const std::vector<std::string> INVERTED_INDEX_ALGOs_ = {"TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE", "DAAT_BMW"};
+    const std::vector<float> DROP_RATIO_SEARCHs_ = {0.0, 0.1, 0.2, 0.4};
+
+    knowhere::Json results_ = knowhere::Json::array();
+};
+
+TEST_F(Benchmark_sparse, TEST_SPLADE) {
+    test_sparse(SPARSE_DATASETS[0]);
+}
+
+TEST_F(Benchmark_sparse, TEST_BM25) {
+    test_sparse(SPARSE_DATASETS[1]);
+}
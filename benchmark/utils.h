@@ -13,12 +13,15 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 struct FileIOWriter {
@@ -85,3 +88,138 @@ GenRandomBitset(size_t n, size_t t) {
     }
     return data;
 }
+
+// Return a n-bits bitset data with t bits set to true, whose unset bits form num_runs contiguous runs of ids, one at a
+// random offset in each of num_runs equal segments of the ids, as the filters on the scalars that follow the insertion
+// order (e.g. timestamps) do
+inline std::vector<uint8_t>
+GenClusteredBitset(size_t n, size_t t, size_t num_runs = 16) {
+    assert(t <= n && num_runs > 0);
+    std::vector<uint8_t> data((n + 8 - 1) / 8, 0xff);
+    const size_t num_valid = n - t;
+    std::mt19937 g(42);
+    for (size_t r = 0; r < num_runs; ++r) {
+        const size_t seg_begin = n * r / num_runs;
+        const size_t seg_end = n * (r + 1) / num_runs;
+        const size_t run_len = std::min(num_valid * (r + 1) / num_runs - num_valid * r / num_runs, seg_end - seg_begin);
+        std::uniform_int_distribution<size_t> offset(0, seg_end - seg_begin - run_len);
+        const size_t run_begin = seg_begin + offset(g);
+        for (size_t i = run_begin; i < run_begin + run_len; ++i) {
+            data[i >> 3] &= ~(0x1 << (i & 0x7));
+        }
+    }
+    return data;
+}
+
+// Return a n-bits bitset data with t bits set to true, whose unset bits are the rows of xb with the largest projections
+// on direction, so that the filter is correlated with the vectors
+inline std::vector<uint8_t>
+GenCorrelatedBitset(const float* xb, size_t n, size_t dim, size_t t, const std::vector<float>& direction) {
+    assert(t <= n && direction.size() == dim);
+    std::vector<std::pair<float, size_t>> projections(n);
+    for (size_t i = 0; i < n; ++i) {
+        float projection = 0.0f;
+        for (size_t j = 0; j < dim; ++j) {
+            projection += xb[i * dim + j] * direction[j];
+        }
+        projections[i] = {projection, i};
+    }
+    std::vector<uint8_t> data((n + 8 - 1) / 8, 0xff);
+    const size_t num_valid = n - t;
+    std::nth_element(projections.begin(), projections.begin() + num_valid, projections.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < num_valid; ++i) {
+        const size_t id = projections[i].second;
+        data[id >> 3] &= ~(0x1 << (id & 0x7));
+    }
+    return data;
+}
+
+// A latency histogram in the manner of HdrHistogram: the values are counted exactly below kSubBuckets, and above in
+// exponentially growing ranges that are split into kSubBuckets / 2 linear sub-buckets each, so that every value is
+// kept with a relative error below 2 / kSubBuckets whatever its magnitude, in a fixed amount of memory.
+class LatencyHistogram {
+ public:
+    static constexpr int kSubBucketBits = 8;
+    static constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBucketBits;
+
+    LatencyHistogram() : counts_(kSubBuckets + (64 - kSubBucketBits) * (kSubBuckets / 2), 0) {
+    }
+
+    void
+    record(uint64_t value) {
+        counts_[index_of(value)]++;
+        total_++;
+        sum_ += value;
+        max_ = std::max(max_, value);
+    }
+
+    void
+    merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); i++) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    // the highest value that is equivalent to the one at the percentile p (in [0, 100]) of the recorded values
+    uint64_t
+    percentile(double p) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(p / 100.0 * total_));
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < counts_.size(); i++) {
+            cumulative += counts_[i];
+            if (cumulative >= rank) {
+                return std::min(highest_equivalent_value(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    uint64_t
+    count() const {
+        return total_;
+    }
+
+    uint64_t
+    max() const {
+        return max_;
+    }
+
+    double
+    mean() const {
+        return total_ == 0 ? 0.0 : (double)sum_ / total_;
+    }
+
+ private:
+    static size_t
+    index_of(uint64_t value) {
+        if (value < kSubBuckets) {
+            return value;
+        }
+        // the sub-bucket keeps the kSubBucketBits highest bits of value, its highest one is always set
+        const int shift = 63 - __builtin_clzll(value) - kSubBucketBits + 1;
+        const uint64_t sub = value >> shift;
+        return kSubBuckets + (shift - 1) * (kSubBuckets / 2) + (sub - kSubBuckets / 2);
+    }
+
+    static uint64_t
+    highest_equivalent_value(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        const int shift = (index - kSubBuckets) / (kSubBuckets / 2) + 1;
+        const uint64_t sub = (index - kSubBuckets) % (kSubBuckets / 2) + kSubBuckets / 2;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+};
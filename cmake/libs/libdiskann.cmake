@@ -3,6 +3,11 @@ find_package(Boost REQUIRED COMPONENTS program_options)
 include_directories(${Boost_INCLUDE_DIR})
 find_package(aio REQUIRED)
 include_directories(${AIO_INCLUDE})
+if(WITH_IO_URING)
+  add_definitions(-DKNOWHERE_WITH_IO_URING)
+  find_package(uring REQUIRED)
+  include_directories(${URING_INCLUDE_DIR})
+endif()
 include_directories(thirdparty/DiskANN/include)
 
 find_package(double-conversion REQUIRED)
@@ -12,6 +17,7 @@ set(DISKANN_SOURCES
     thirdparty/DiskANN/src/ann_exception.cpp
     thirdparty/DiskANN/src/aux_utils.cpp
     thirdparty/DiskANN/src/distance.cpp
+    thirdparty/DiskANN/src/dynamic_node_cache.cpp
     thirdparty/DiskANN/src/index.cpp
     thirdparty/DiskANN/src/linux_aligned_file_reader.cpp
     thirdparty/DiskANN/src/math_utils.cpp
@@ -22,7 +28,12 @@ set(DISKANN_SOURCES
     thirdparty/DiskANN/src/aisaq_utils.cpp
     thirdparty/DiskANN/src/aisaq_pq_reader.cpp
     thirdparty/DiskANN/src/logger.cpp
+    thirdparty/DiskANN/src/tiered_aligned_file_reader.cpp
     thirdparty/DiskANN/src/utils.cpp)
+if(WITH_IO_URING)
+  list(APPEND DISKANN_SOURCES
+       thirdparty/DiskANN/src/linux_uring_aligned_file_reader.cpp)
+endif()
 
 find_package(folly REQUIRED)
 
@@ -30,6 +41,7 @@ add_library(diskann STATIC ${DISKANN_SOURCES})
 target_link_libraries(
   diskann
   PUBLIC ${AIO_LIBRARIES}
+         ${URING_LIBRARIES}
          ${DISKANN_BOOST_PROGRAM_OPTIONS_LIB}
          nlohmann_json::nlohmann_json
          Folly::folly
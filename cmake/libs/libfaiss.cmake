@@ -29,16 +29,22 @@ knowhere_file_glob(GLOB FAISS_RHNSW_SRCS thirdparty/faiss/faiss/impl/RHNSW.cpp)
 list(REMOVE_ITEM FAISS_SRCS ${FAISS_RHNSW_SRCS})
 
 if(__X86_64)
-  set(UTILS_SRC src/simd/distances_ref.cc src/simd/hook.cc)
+  set(UTILS_SRC src/simd/distances_ref.cc src/simd/hook.cc src/simd/calibration.cc)
   set(UTILS_SSE_SRC src/simd/distances_sse.cc)
   set(UTILS_AVX_SRC src/simd/distances_avx.cc)
   set(UTILS_AVX512_SRC src/simd/distances_avx512.cc)
   set(UTILS_AVX512ICX_SRC src/simd/distances_avx512icx.cc)
+  set(UTILS_AVX512BF16_SRC src/simd/distances_avx512bf16.cc)
+  set(UTILS_AVX512VNNI_SRC src/simd/distances_avx512vnni.cc)
+  set(UTILS_AVXVNNI_SRC src/simd/distances_avxvnni.cc)
 
   add_library(utils_sse OBJECT ${UTILS_SSE_SRC})
   add_library(utils_avx OBJECT ${UTILS_AVX_SRC})
   add_library(utils_avx512 OBJECT ${UTILS_AVX512_SRC})
   add_library(utils_avx512icx OBJECT ${UTILS_AVX512ICX_SRC})
+  add_library(utils_avx512bf16 OBJECT ${UTILS_AVX512BF16_SRC})
+  add_library(utils_avx512vnni OBJECT ${UTILS_AVX512VNNI_SRC})
+  add_library(utils_avxvnni OBJECT ${UTILS_AVXVNNI_SRC})
 
   target_compile_options(utils_sse PRIVATE -msse4.2 -mpopcnt)
   target_compile_options(utils_avx PRIVATE -mfma -mf16c -mavx2 -mpopcnt)
@@ -46,11 +52,18 @@ if(__X86_64)
                                               -mavx512bw -mpopcnt -mavx512vl)
   target_compile_options(utils_avx512icx PRIVATE -mfma -mf16c -mavx512f -mavx512dq
                                               -mavx512bw -mpopcnt -mavx512vl -mavx512vpopcntdq)
+  target_compile_options(utils_avx512bf16 PRIVATE -mfma -mf16c -mavx512f -mavx512dq
+                                               -mavx512bw -mpopcnt -mavx512vl -mavx512bf16)
+  target_compile_options(utils_avx512vnni PRIVATE -mfma -mf16c -mavx512f -mavx512dq
+                                               -mavx512bw -mpopcnt -mavx512vl -mavx512vnni)
+  target_compile_options(utils_avxvnni PRIVATE -mfma -mf16c -mavx2 -mpopcnt -mavxvnni)
 
   add_library(
     knowhere_utils STATIC
     ${UTILS_SRC} $<TARGET_OBJECTS:utils_sse> $<TARGET_OBJECTS:utils_avx>
-    $<TARGET_OBJECTS:utils_avx512> $<TARGET_OBJECTS:utils_avx512icx>)
+    $<TARGET_OBJECTS:utils_avx512> $<TARGET_OBJECTS:utils_avx512icx>
+    $<TARGET_OBJECTS:utils_avx512bf16> $<TARGET_OBJECTS:utils_avx512vnni>
+    $<TARGET_OBJECTS:utils_avxvnni>)
   target_link_libraries(knowhere_utils PUBLIC glog::glog)
   target_link_libraries(knowhere_utils PUBLIC xxHash::xxhash)
 endif()
@@ -58,7 +71,7 @@ endif()
 if(__AARCH64)
 
   set(UTILS_SRC src/simd/distances_ref.cc src/simd/distances_neon.cc)
-  set(UTILS_SVE_SRC src/simd/hook.cc src/simd/distances_sve.cc)
+  set(UTILS_SVE_SRC src/simd/hook.cc src/simd/calibration.cc src/simd/distances_sve.cc)
   set(ALL_UTILS_SRC ${UTILS_SRC} ${UTILS_SVE_SRC})
 
   add_library(
@@ -133,7 +146,7 @@ if(__AARCH64)
 endif()
 
 if(__RISCV64)
-  set(UTILS_SRC src/simd/hook.cc src/simd/distances_ref.cc src/simd/distances_rvv.cc)
+  set(UTILS_SRC src/simd/hook.cc src/simd/calibration.cc src/simd/distances_ref.cc src/simd/distances_rvv.cc)
   add_library(knowhere_utils STATIC ${UTILS_SRC})
   target_link_libraries(knowhere_utils PUBLIC glog::glog)
   target_link_libraries(knowhere_utils PUBLIC xxHash::xxhash)
@@ -145,7 +158,8 @@ endif()
 
 # ToDo: Add distances_vsx.cc for powerpc64 SIMD acceleration
 if(__PPC64)
-  set(UTILS_SRC src/simd/hook.cc src/simd/distances_ref.cc src/simd/distances_powerpc.cc)
+  set(UTILS_SRC src/simd/hook.cc src/simd/calibration.cc src/simd/distances_ref.cc
+                src/simd/distances_powerpc.cc)
   add_library(knowhere_utils STATIC ${UTILS_SRC})
   target_link_libraries(knowhere_utils PUBLIC glog::glog)
   target_link_libraries(knowhere_utils PUBLIC xxHash::xxhash)
@@ -0,0 +1,14 @@
+# * Find io_uring
+#
+# URING_INCLUDE - Where to find liburing.h URING_LIBRARIES - List of libraries
+# when using io_uring. URING_FOUND - True if io_uring found.
+
+find_path(URING_INCLUDE_DIR liburing.h HINTS $ENV{URING_ROOT}/include)
+
+find_library(URING_LIBRARIES uring HINTS $ENV{URING_ROOT}/lib)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(uring DEFAULT_MSG URING_LIBRARIES
+                                  URING_INCLUDE_DIR)
+
+mark_as_advanced(URING_INCLUDE_DIR URING_LIBRARIES)
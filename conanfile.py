@@ -27,6 +27,8 @@ class KnowhereConan(ConanFile):
         "with_cuvs": [True, False],
         "with_asan": [True, False],
         "with_diskann": [True, False],
+        "with_io_uring": [True, False],
+        "with_coroutines": [True, False],
         "with_cardinal": [True, False],
         "with_profiler": [True, False],
         "with_ut": [True, False],
@@ -42,6 +44,8 @@ class KnowhereConan(ConanFile):
         "with_cuvs": False,
         "with_asan": False,
         "with_diskann": False,
+        "with_io_uring": False,
+        "with_coroutines": False,
         "with_cardinal": False,
         "with_profiler": False,
         "with_ut": False,
@@ -111,6 +115,7 @@ class KnowhereConan(ConanFile):
         self.requires("libcurl/8.2.1")
         self.requires("simde/0.8.2")
         self.requires("xxhash/0.8.3")
+        self.requires("zstd/1.5.5")
         if self.settings.os == "Android":
             self.requires("openblas/0.3.27")
         if not self.options.with_light:
@@ -176,6 +181,8 @@ class KnowhereConan(ConanFile):
             tc.variables["MSVC_USE_STATIC_RUNTIME"] = "MT" in msvc_runtime_flag(self)
         tc.variables["WITH_ASAN"] = self.options.with_asan
         tc.variables["WITH_DISKANN"] = self.options.with_diskann
+        tc.variables["WITH_IO_URING"] = self.options.with_io_uring
+        tc.variables["WITH_COROUTINES"] = self.options.with_coroutines
         tc.variables["WITH_CARDINAL"] = self.options.with_cardinal
         tc.variables["WITH_CUVS"] = self.options.with_cuvs
         tc.variables["WITH_PROFILER"] = self.options.with_profiler
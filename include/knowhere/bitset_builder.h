@@ -0,0 +1,91 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_BITSET_BUILDER_H
+#define KNOWHERE_BITSET_BUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "knowhere/bitsetview.h"
+#include "knowhere/comp/result_buffer_pool.h"
+
+namespace knowhere {
+
+// Builds the bitmap of a filter, a set bit being a filtered out id, 64 bits at a time in a buffer of the
+// ResultBufferPool, and counts its filtered out bits as it goes, so that neither the caller nor the search has to
+// pass over the bitmap again to get them. The view() of a builder is valid as long as the builder.
+//
+// The ids of the id lists are written a word at a time, which is cheapest for sorted ids, although any order gives
+// the same bitmap; a range [first, second) covers its ids whole words at a time. The ranges and the ids may overlap,
+// and are below num_bits. A roaring bitmap is given by its array containers as ids and its run containers as ranges.
+class BitsetBuilder {
+ public:
+    using Range = std::pair<uint32_t, uint32_t>;
+
+    // the ids filtered out, all the others pass
+    static BitsetBuilder
+    FromFilteredOutIds(const uint32_t* ids, size_t num_ids, size_t num_bits);
+
+    // the ids that pass, all the others are filtered out
+    static BitsetBuilder
+    FromValidIds(const uint32_t* ids, size_t num_ids, size_t num_bits);
+
+    static BitsetBuilder
+    FromFilteredOutRanges(const Range* ranges, size_t num_ranges, size_t num_bits);
+
+    static BitsetBuilder
+    FromValidRanges(const Range* ranges, size_t num_ranges, size_t num_bits);
+
+    // The combinators work on the bits, of two views of the same size without id mapping, given by their bitmaps or
+    // their valid ids: And() filters out the ids that both filter out, so it passes those that either passes, Or()
+    // filters out those that either filters out, and Not() passes what a filters out.
+    static BitsetBuilder
+    And(const BitsetView& a, const BitsetView& b);
+
+    static BitsetBuilder
+    Or(const BitsetView& a, const BitsetView& b);
+
+    static BitsetBuilder
+    Not(const BitsetView& a);
+
+    BitsetView
+    view() const {
+        return BitsetView(reinterpret_cast<const uint8_t*>(words_.get()), num_bits_, num_filtered_out_bits_);
+    }
+
+    size_t
+    num_filtered_out_bits() const {
+        return num_filtered_out_bits_;
+    }
+
+ private:
+    // num_bits bits, all set if filled
+    BitsetBuilder(size_t num_bits, bool filled);
+
+    // loads the bitmap of a view in the words, and clears the bits past its size
+    void
+    Load(const BitsetView& view);
+
+    // replaces every word w of the bitmap with op(w, the same word of b), and counts the filtered out bits
+    template <typename Op>
+    void
+    Combine(const BitsetView& b, Op op);
+
+    ResultBuffer<uint64_t> words_;
+    size_t num_bits_ = 0;
+    size_t num_filtered_out_bits_ = 0;
+};
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_BITSET_BUILDER_H */
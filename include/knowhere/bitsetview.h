@@ -12,8 +12,10 @@
 #ifndef BITSET_H
 #define BITSET_H
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <string>
 
@@ -30,6 +32,18 @@ class BitsetView {
     BitsetView(const std::nullptr_t) : BitsetView() {
     }
 
+    // a filter of num_bits bits given by the sorted ids that pass it rather than by a bitmap, for the selective
+    // filters of large segments: no bitmap has to be built for them, the ids are tested by a binary search and the
+    // valid ones are iterated directly.
+    static BitsetView
+    from_valid_ids(const uint32_t* valid_ids, size_t num_valid_ids, size_t num_bits) {
+        BitsetView view(nullptr, num_bits, num_bits - num_valid_ids);
+        view.has_valid_ids_ = true;
+        view.valid_ids_ = valid_ids;
+        view.num_valid_ids_ = num_valid_ids;
+        return view;
+    }
+
     bool
     empty() const {
         return num_bits_ == 0;
@@ -58,11 +72,43 @@ class BitsetView {
         return (num_bits_ + 8 - 1) >> 3;
     }
 
+    // return the bitmap, or nullptr if the bitset is given by its valid ids.
     const uint8_t*
     data() const {
         return bits_;
     }
 
+    bool
+    has_valid_ids() const {
+        return has_valid_ids_;
+    }
+
+    const uint32_t*
+    valid_ids_data() const {
+        return valid_ids_;
+    }
+
+    size_t
+    num_valid_ids() const {
+        return num_valid_ids_;
+    }
+
+    // write the bitmap of the bitset, byte_size() bytes, whatever its representation.
+    void
+    copy_bits_to(uint8_t* bits) const {
+        if (!has_valid_ids_) {
+            std::memcpy(bits, bits_, byte_size());
+            return;
+        }
+        std::memset(bits, 0xFF, byte_size());
+        if (num_bits_ % 8 != 0) {
+            bits[byte_size() - 1] = (0x1 << (num_bits_ % 8)) - 1;
+        }
+        for (size_t i = 0; i < num_valid_ids_; i++) {
+            bits[valid_ids_[i] >> 3] &= ~(0x1 << (valid_ids_[i] & 0x7));
+        }
+    }
+
     bool
     has_out_ids() const {
         return out_ids_ != nullptr;
@@ -93,6 +139,11 @@ class BitsetView {
         id_offset_ = id_offset;
     }
 
+    size_t
+    id_offset() const {
+        return id_offset_;
+    }
+
     bool
     test(int64_t index) const {
         int64_t out_id = index + id_offset_;
@@ -100,8 +151,46 @@ class BitsetView {
             out_id = out_ids_[out_id];
         }
         // when index is larger than the max_offset, ignore it
-        return (out_id >= static_cast<int64_t>(num_bits_)) || (bits_[out_id >> 3] & (0x1 << (out_id & 0x7)));
+        if (out_id >= static_cast<int64_t>(num_bits_)) {
+            return true;
+        }
+        if (has_valid_ids_) {
+            return !std::binary_search(valid_ids_, valid_ids_ + num_valid_ids_, static_cast<uint32_t>(out_id));
+        }
+        return bits_[out_id >> 3] & (0x1 << (out_id & 0x7));
+    }
+    // return a mask with bit j set if ids[j] is filtered out, for n <= 64 ids. the bits of all the ids are gathered
+    // without a branch per id, so that their loads are independent of each other.
+    template <typename T>
+    uint64_t
+    test_batch(const T* ids, size_t n) const {
+        uint64_t mask = 0;
+        if (out_ids_ != nullptr || has_valid_ids_) {
+            for (size_t j = 0; j < n; j++) {
+                mask |= uint64_t(test(ids[j])) << j;
+            }
+            return mask;
+        }
+        for (size_t j = 0; j < n; j++) {
+            const uint64_t out_id = static_cast<uint64_t>(ids[j]) + id_offset_;
+            // when index is larger than the max_offset, ignore it
+            const uint64_t bit = out_id < num_bits_ ? (bits_[out_id >> 3] >> (out_id & 0x7)) & 0x1 : 0x1;
+            mask |= bit << j;
+        }
+        return mask;
+    }
+
+    // write the bits of the ids [0, size()) as test() sees them, (size() + 7) / 8 bytes. with id mapping, this resolves
+    // the mapping once for all the tests of a search.
+    void
+    copy_internal_bits_to(uint8_t* bits) const {
+        const size_t n = size();
+        std::memset(bits, 0, (n + 7) >> 3);
+        for (size_t i = 0; i < n; i++) {
+            bits[i >> 3] |= uint8_t(test(i)) << (i & 0x7);
+        }
     }
+
     // return the filtered ratio. if with id mapping, calculated by internal_ids rather than bits.
     float
     filter_ratio() const {
@@ -123,6 +212,9 @@ class BitsetView {
             }
             return count;
         }
+        if (has_valid_ids_) {
+            return num_bits_ - num_valid_ids_;
+        }
         // if without id mapping, use a better algorithm to calculate the number of filtered out bits.
         size_t ret = 0;
         auto len_uint8 = byte_size();
@@ -163,6 +255,9 @@ class BitsetView {
             }
             return num_internal_ids_;
         }
+        if (has_valid_ids_) {
+            return num_valid_ids_ > 0 ? valid_ids_[0] : num_bits_;
+        }
         // if without id mapping, use a better algorithm to find the first valid index.
         size_t ret = 0;
         auto len_uint8 = byte_size();
@@ -194,6 +289,24 @@ class BitsetView {
         return num_bits_;
     }
 
+    // return the first valid idx that is not smaller than from, or size() if there is none. if with id mapping, the
+    // ids are tested one by one.
+    size_t
+    get_next_valid_index(size_t from) const {
+        if (out_ids_ != nullptr) {
+            // if with id mapping, there is no optimization for the traversal.
+            for (size_t i = from; i < size(); i++) {
+                if (!test(i)) {
+                    return i;
+                }
+            }
+            return size();
+        }
+        // if without id mapping, skip filtered out bits 64 at a time.
+        const size_t bit = get_next_valid_bit_(from + id_offset_);
+        return bit >= num_bits_ ? num_bits_ : bit - id_offset_;
+    }
+
     std::string
     to_string(size_t from, size_t to) const {
         if (empty()) {
@@ -208,10 +321,49 @@ class BitsetView {
     }
 
  private:
+    // return the first unset bit that is not smaller than from, or a value >= num_bits_ if there is none. the valid ids
+    // are searched rather than scanned.
+    size_t
+    get_next_valid_bit_(size_t from) const {
+        if (from >= num_bits_) {
+            return num_bits_;
+        }
+        if (has_valid_ids_) {
+            const auto it = std::lower_bound(valid_ids_, valid_ids_ + num_valid_ids_, static_cast<uint32_t>(from));
+            return it == valid_ids_ + num_valid_ids_ ? num_bits_ : *it;
+        }
+        auto len_uint8 = byte_size();
+        size_t byte_idx = from >> 3;
+        uint8_t first_value = (~bits_[byte_idx]) & (0xFF << (from & 0x7));
+        if (first_value != 0) {
+            return byte_idx * 8 + __builtin_ctz(first_value);
+        }
+        for (++byte_idx; byte_idx + 8 <= len_uint8; byte_idx += 8) {
+            uint64_t value;
+            std::memcpy(&value, bits_ + byte_idx, sizeof(uint64_t));
+            value = ~value;
+            if (value != 0) {
+                return byte_idx * 8 + __builtin_ctzll(value);
+            }
+        }
+        for (; byte_idx < len_uint8; byte_idx++) {
+            uint8_t value = ~bits_[byte_idx];
+            if (value != 0) {
+                return byte_idx * 8 + __builtin_ctz(value);
+            }
+        }
+        return num_bits_;
+    }
+
     const uint8_t* bits_ = nullptr;
     size_t num_bits_ = 0;
     size_t num_filtered_out_bits_ = 0;
 
+    // optional. the sorted ids that pass the filter, instead of bits_. there may be none of them.
+    bool has_valid_ids_ = false;
+    const uint32_t* valid_ids_ = nullptr;
+    size_t num_valid_ids_ = 0;
+
     // optional. many indexes will share one bitset, requiring offset to distinguish between them.
     //  like multi-chunk brute-force in /src/common/comp/brute_force.cc, or mv-only in /src/index/hnsw/faiss_hnsw.cc
     size_t id_offset_ = 0;  // offset of the internal ids
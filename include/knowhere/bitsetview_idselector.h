@@ -13,6 +13,9 @@
 
 #include <faiss/impl/IDSelector.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "knowhere/bitsetview.h"
 
 namespace knowhere {
@@ -28,6 +31,55 @@ struct BitsetViewIDSelector final : faiss::IDSelector {
         // it is by design that bitset_view.empty() is not tested here
         return (!bitset_view.test(id));
     }
+
+    inline uint64_t
+    is_member_batch(size_t n, const faiss::idx_t* ids) const override final {
+        const uint64_t all = n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+        return ~bitset_view.test_batch(ids, n) & all;
+    }
+};
+
+// The ids below n that pass a selective filter, as the IDSelectorArray that the brute force searches compute one by
+// one rather than testing every bit for every query. The list is extracted once for all the queries, skipping the
+// filtered out bits 64 at a time, or taken from the valid ids of the bitset.
+struct BitsetViewIDList {
+    // the filter ratio from which the list pays off
+    static constexpr float kMinFilterRatio = 0.95f;
+
+    std::vector<faiss::idx_t> ids;
+    faiss::IDSelectorArray selector{0, nullptr};
+
+    BitsetViewIDList(const BitsetView& bitset_view, const size_t n) {
+        // get_next_valid_index returns the size past the last valid index
+        const size_t end = std::min(n, bitset_view.size());
+        if (bitset_view.has_valid_ids() && !bitset_view.has_out_ids()) {
+            // the valid ids are the list already, shifted by the id offset and cut off at the end
+            const size_t offset = bitset_view.id_offset();
+            const auto valid_ids_end = bitset_view.valid_ids_data() + bitset_view.num_valid_ids();
+            const auto first = std::lower_bound(bitset_view.valid_ids_data(), valid_ids_end, offset);
+            const auto last = std::lower_bound(first, valid_ids_end, offset + end);
+            ids.reserve(last - first);
+            for (auto it = first; it != last; ++it) {
+                ids.push_back(*it - offset);
+            }
+            selector = faiss::IDSelectorArray(ids.size(), ids.data());
+            return;
+        }
+        ids.reserve(std::min(end, bitset_view.size() - bitset_view.count()));
+        for (size_t i = bitset_view.get_next_valid_index(0); i < end; i = bitset_view.get_next_valid_index(i + 1)) {
+            ids.push_back(i);
+        }
+        selector = faiss::IDSelectorArray(ids.size(), ids.data());
+    }
+
+    BitsetViewIDList(const BitsetViewIDList&) = delete;
+    BitsetViewIDList&
+    operator=(const BitsetViewIDList&) = delete;
+
+    static bool
+    pays_off(const BitsetView& bitset_view) {
+        return !bitset_view.empty() && bitset_view.filter_ratio() >= kMinFilterRatio;
+    }
 };
 
 }  // namespace knowhere
@@ -122,9 +122,15 @@ class Cluster {
     expected<DataSetPtr>
     Assign(const DataSet& dataset);
 
+    expected<DataSetPtr>
+    AssignTopM(const DataSet& dataset, const int64_t m);
+
     expected<DataSetPtr>
     GetCentroids() const;
 
+    Status
+    SetCentroids(const DataSet& centroids);
+
     std::string
     Type() const;
 
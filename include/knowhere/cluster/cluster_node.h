@@ -33,11 +33,25 @@ class ClusterNode : public Object {
     virtual expected<DataSetPtr>
     Assign(const DataSet& dataset) = 0;
 
+    // cluster assign to the m nearest centroids, nearest first, for a soft assignment
+    // (rows, m, int64_t* ids, float* distances)
+    virtual expected<DataSetPtr>
+    AssignTopM(const DataSet& dataset, const int64_t m) {
+        return expected<DataSetPtr>::Err(Status::not_implemented, "top-m assign is not supported");
+    }
+
     // return centroids, must be called after trained
     // (rows, dim, centroid_vector_list)
     virtual expected<DataSetPtr>
     GetCentroids() const = 0;
 
+    // set the centroids that the next train starts from
+    // (rows, dim, centroid_vector_list)
+    virtual Status
+    SetCentroids(const DataSet& centroids) {
+        return Status::not_implemented;
+    }
+
     virtual std::unique_ptr<Config>
     CreateConfig() const = 0;
 
@@ -9,12 +9,22 @@
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 #ifndef KNOWHERE_KNOWHERE_H
 #define KNOWHERE_KNOWHERE_H
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <functional>
+#include <memory>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "io/memory_io.h"
 #include "knowhere/bitsetview.h"
 #include "knowhere/utils.h"
@@ -28,27 +38,39 @@ class BloomFilter {
         k = static_cast<int>(m / n * log(2));
         m = std::max<size_t>(m, 1);
         k = std::max(k, 1);
-        bits.resize(m, false);
+        reset_bits();
     }
 
+    // thread-safe, the elements of an index are added by the threads of the build pool at load
     void
     add(const T& element) {
         size_t glb_hash = hash((const char*)&element, sizeof(element), 0);
         for (int i = 0; i < k; ++i) {
             size_t pos = (glb_hash + i) % m;
-            bits[pos] = true;
+            bits[pos / 64].fetch_or(uint64_t{1} << (pos % 64), std::memory_order_relaxed);
         }
     }
 
     bool
     contains(const T& element) const {
-        size_t glb_hash = hash((const char*)&element, sizeof(element), 0);
-        for (int i = 0; i < k; ++i) {
-            size_t pos = (glb_hash + i) % m;
-            if (!bits[pos])
-                return false;
+        return contains_hash(hash((const char*)&element, sizeof(element), 0));
+    }
+
+    // out[i] is whether elements[i] may have been added. The elements are hashed a group at a time and the words of
+    // their first bits prefetched before any of them is tested, for the cache misses of a group to overlap.
+    void
+    contains_batch(const T* elements, size_t num, uint8_t* out) const {
+        size_t hashes[batch_group];
+        for (size_t beg = 0; beg < num; beg += batch_group) {
+            const size_t group = std::min(batch_group, num - beg);
+            for (size_t i = 0; i < group; ++i) {
+                hashes[i] = hash((const char*)&elements[beg + i], sizeof(T), 0);
+                __builtin_prefetch(&bits[hashes[i] / 64]);
+            }
+            for (size_t i = 0; i < group; ++i) {
+                out[beg + i] = contains_hash(hashes[i]);
+            }
         }
-        return true;
     }
 
     void
@@ -60,7 +82,7 @@ class BloomFilter {
         auto bytes_num = (m + 8 - 1) / 8;
         std::vector<char> buffer(bytes_num, 0);
         for (size_t i = 0; i < m; ++i) {
-            if (bits[i]) {
+            if (test(i)) {
                 buffer[i / 8] |= (1 << (i % 8));
             }
         }
@@ -73,14 +95,14 @@ class BloomFilter {
         readBinaryPOD(reader, k);
         readBinaryPOD(reader, n);
         readBinaryPOD(reader, p);
-        bits.clear();
-        bits.resize(m);
+        reset_bits();
         auto bytes_num = (m + 8 - 1) / 8;
         std::vector<char> buffer(bytes_num);
         reader.read(buffer.data(), bytes_num);
         for (size_t i = 0; i < m; ++i) {
-            bool bit = (buffer[i / 8] >> (i % 8)) & 1;
-            bits.push_back(bit);
+            if ((buffer[i / 8] >> (i % 8)) & 1) {
+                bits[i / 64].fetch_or(uint64_t{1} << (i % 64), std::memory_order_relaxed);
+            }
         }
     }
     size_t
@@ -98,12 +120,34 @@ class BloomFilter {
 
  private:
     static constexpr size_t multiplier = 31;
-    std::vector<bool> bits;
+    static constexpr size_t batch_group = 16;
+    // m bits in words
+    std::unique_ptr<std::atomic<uint64_t>[]> bits;
     size_t n = 0;
     double p = 0.0;
     size_t m = 0;
     int k = 0;
 
+    void
+    reset_bits() {
+        bits = std::make_unique<std::atomic<uint64_t>[]>((m + 63) / 64);
+    }
+
+    bool
+    contains_hash(size_t glb_hash) const {
+        for (int i = 0; i < k; ++i) {
+            size_t pos = (glb_hash + i) % m;
+            if (!test(pos))
+                return false;
+        }
+        return true;
+    }
+
+    bool
+    test(size_t pos) const {
+        return (bits[pos / 64].load(std::memory_order_relaxed) >> (pos % 64)) & 1;
+    }
+
     size_t
     hash(const char* data, size_t length, size_t bucket_i) const {
         if (data == nullptr) {
@@ -116,5 +160,123 @@ class BloomFilter {
         return (result + bucket_i) % m;
     }
 };
+
+// A split block Bloom filter: an element sets one bit in each of the 8 words of a single 256-bit block, so that a
+// lookup reads one cache line rather than k bits of its own, and the 8 words are probed at once with AVX2 or NEON.
+// For the same memory its false positive rate is a little higher than that of BloomFilter. The elements are expected
+// to be hashes already, e.g. the band keys of MinHash, and are only mixed.
+template <typename T>
+class SplitBlockBloomFilter {
+    static_assert(sizeof(T) <= sizeof(uint64_t), "the elements of a split block bloom filter are up to 64 bits");
+
+ public:
+    explicit SplitBlockBloomFilter(size_t expected_elements, double false_positive_prob) {
+        const double bits = -(std::max<size_t>(expected_elements, 1) * log(false_positive_prob)) / (log(2) * log(2));
+        num_blocks = std::max<size_t>(static_cast<size_t>(bits / block_bits) + 1, 1);
+        blocks = std::unique_ptr<Block[]>(new Block[num_blocks]());
+    }
+
+    // thread-safe, the elements of an index are added by the threads of the build pool at load
+    void
+    add(const T& element) {
+        const uint64_t h = hash(element);
+        auto& block = blocks[block_index(h)];
+        for (size_t i = 0; i < block_words; ++i) {
+            __atomic_fetch_or(&block.words[i], uint32_t{1} << ((static_cast<uint32_t>(h) * salts[i]) >> 27),
+                              __ATOMIC_RELAXED);
+        }
+    }
+
+    bool
+    contains(const T& element) const {
+        const uint64_t h = hash(element);
+        return block_contains(blocks[block_index(h)], static_cast<uint32_t>(h));
+    }
+
+    // out[i] is whether elements[i] may have been added. The blocks of a group of elements are prefetched before any
+    // of them is probed, for the cache misses of a group to overlap.
+    void
+    contains_batch(const T* elements, size_t num, uint8_t* out) const {
+        uint64_t hashes[batch_group];
+        for (size_t beg = 0; beg < num; beg += batch_group) {
+            const size_t group = std::min(batch_group, num - beg);
+            for (size_t i = 0; i < group; ++i) {
+                hashes[i] = hash(elements[beg + i]);
+                __builtin_prefetch(&blocks[block_index(hashes[i])]);
+            }
+            for (size_t i = 0; i < group; ++i) {
+                out[beg + i] = block_contains(blocks[block_index(hashes[i])], static_cast<uint32_t>(hashes[i]));
+            }
+        }
+    }
+
+    size_t
+    memory_usage() const {
+        return num_blocks * sizeof(Block);
+    }
+
+ private:
+    static constexpr size_t block_words = 8;
+    static constexpr size_t block_bits = block_words * 32;
+    static constexpr size_t batch_group = 16;
+    // odd constants that spread the bits of an element over the words of its block
+    static constexpr uint32_t salts[block_words] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+    struct alignas(32) Block {
+        uint32_t words[block_words];
+    };
+
+    std::unique_ptr<Block[]> blocks;
+    size_t num_blocks = 0;
+
+    static uint64_t
+    hash(const T& element) {
+        uint64_t x = 0;
+        std::memcpy(&x, &element, sizeof(T));
+        // the finalizer of MurmurHash3
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    size_t
+    block_index(uint64_t h) const {
+        return ((h >> 32) * num_blocks) >> 32;
+    }
+
+    static bool
+    block_contains(const Block& block, uint32_t key) {
+#if defined(__AVX2__)
+        const __m256i salt = _mm256_setr_epi32(salts[0], salts[1], salts[2], salts[3], salts[4], salts[5], salts[6],
+                                               salts[7]);
+        const __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salt), 27);
+        const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+        const __m256i words = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.words));
+        // all the bits of the mask are set in the words
+        return _mm256_testc_si256(words, mask);
+#elif defined(__aarch64__)
+        const uint32x4_t key4 = vdupq_n_u32(key);
+        const uint32x4_t one = vdupq_n_u32(1);
+        uint32x4_t missing = vdupq_n_u32(0);
+        for (size_t i = 0; i < block_words; i += 4) {
+            const uint32x4_t shifts = vshrq_n_u32(vmulq_u32(key4, vld1q_u32(salts + i)), 27);
+            const uint32x4_t mask = vshlq_u32(one, vreinterpretq_s32_u32(shifts));
+            missing = vorrq_u32(missing, vbicq_u32(mask, vld1q_u32(block.words + i)));
+        }
+        return vmaxvq_u32(missing) == 0;
+#else
+        for (size_t i = 0; i < block_words; ++i) {
+            if (!(block.words[i] & (uint32_t{1} << ((key * salts[i]) >> 27)))) {
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
+};
 }  // namespace knowhere
 #endif
@@ -34,6 +34,15 @@ class BruteForce {
     SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_dataset, int64_t* ids, float* dis,
                   const Json& config, const BitsetView& bitset);
 
+    // Searches a base made of chunks as one, with a top-k per query shared by all the chunks. The ids of a chunk
+    // start from its tensor begin id, which also offsets the bitset for the chunk, so the bitset covers the ids of
+    // the whole base. The chunks are not concatenated. Not for emb lists nor the SUBSTRUCTURE and SUPERSTRUCTURE
+    // metrics.
+    template <typename DataType>
+    static expected<DataSetPtr>
+    SearchChunks(const std::vector<DataSetPtr>& base_chunks, const DataSetPtr query_dataset, const Json& config,
+                 const BitsetView& bitset);
+
     template <typename DataType>
     static expected<DataSetPtr>
     RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_dataset, const Json& config,
@@ -0,0 +1,121 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_BUILD_SCHEDULER_H
+#define KNOWHERE_COMP_BUILD_SCHEDULER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "folly/futures/Future.h"
+
+namespace knowhere {
+
+class BuildScheduler;
+
+// The memory and the build threads of an admitted build, which it holds until it is done.
+class BuildReservation {
+ public:
+    ~BuildReservation();
+
+    BuildReservation(const BuildReservation&) = delete;
+    BuildReservation&
+    operator=(const BuildReservation&) = delete;
+
+    int64_t
+    Bytes() const {
+        return bytes_;
+    }
+
+    // the build pool threads of the build, its fair share among the builds running when it was admitted
+    int32_t
+    NumThreads() const {
+        return num_threads_;
+    }
+
+ private:
+    friend class BuildScheduler;
+
+    BuildReservation(BuildScheduler* scheduler, int64_t bytes, int32_t num_threads)
+        : scheduler_(scheduler), bytes_(bytes), num_threads_(num_threads) {
+    }
+
+    BuildScheduler* scheduler_;
+    int64_t bytes_;
+    int32_t num_threads_;
+};
+
+// Admits the builds of Index::Build and Index::BuildAsync in their arrival order, as long as the estimated peak memory
+// of the running builds fits in the memory budget. A build larger than the whole budget runs alone.
+class BuildScheduler {
+ public:
+    static BuildScheduler&
+    GetInstance();
+
+    // 0 for no budget (the default)
+    void
+    SetMemoryBudget(int64_t bytes);
+
+    int64_t
+    GetMemoryBudget() const;
+
+    int64_t
+    GetReservedMemory() const;
+
+    size_t
+    GetRunningBuilds() const;
+
+    // Completes with the reservation of a build of `bytes` once it is admitted. The continuations of a build waiting
+    // for admission do not hold a thread.
+    folly::SemiFuture<std::shared_ptr<BuildReservation>>
+    AdmitAsync(int64_t bytes);
+
+    std::shared_ptr<BuildReservation>
+    Admit(int64_t bytes) {
+        return AdmitAsync(bytes).get();
+    }
+
+ private:
+    friend class BuildReservation;
+
+    struct Waiter {
+        int64_t bytes;
+        folly::Promise<std::shared_ptr<BuildReservation>> promise;
+    };
+
+    BuildScheduler() = default;
+
+    void
+    Release(int64_t bytes);
+
+    // admits the waiters at the head of the queue that fit, to be fulfilled out of the lock
+    std::deque<std::pair<Waiter, std::shared_ptr<BuildReservation>>>
+    AdmitWaiters();
+
+    bool
+    Fits(int64_t bytes) const;
+
+    std::shared_ptr<BuildReservation>
+    Reserve(int64_t bytes);
+
+    mutable std::mutex mutex_;
+    int64_t budget_ = 0;
+    int64_t reserved_ = 0;
+    size_t running_ = 0;
+    std::deque<Waiter> waiters_;
+};
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_BUILD_SCHEDULER_H */
@@ -0,0 +1,86 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_HUGE_PAGE_H
+#define KNOWHERE_COMP_HUGE_PAGE_H
+
+#include <cstddef>
+#include <memory>
+
+namespace knowhere {
+
+// How the large buffers of the loaded indexes are backed with huge pages, so that the random accesses of the searches
+// to them miss the TLB less.
+enum class HugePagePolicy {
+    // regular pages (the default)
+    NONE = 0,
+    // transparent huge pages, that the kernel backs the buffers with as it can (MADV_HUGEPAGE)
+    TRANSPARENT = 1,
+    // pages of the hugetlb pool (MAP_HUGETLB), that must be reserved, then transparent huge pages once it runs out
+    EXPLICIT = 2,
+};
+
+void
+SetHugePagePolicy(HugePagePolicy policy);
+
+HugePagePolicy
+GetHugePagePolicy();
+
+// The buffers smaller than a huge page stay on regular pages.
+size_t
+HugePageSize();
+
+// A buffer backed with huge pages according to the policy, that owns its mapping.
+class HugePageBuffer {
+ public:
+    // nullptr if the policy is NONE, or the size is less than a huge page, or no memory could be mapped
+    static std::unique_ptr<HugePageBuffer>
+    Allocate(size_t size);
+
+    ~HugePageBuffer();
+
+    HugePageBuffer(const HugePageBuffer&) = delete;
+    HugePageBuffer&
+    operator=(const HugePageBuffer&) = delete;
+
+    void*
+    data() const {
+        return data_;
+    }
+
+    size_t
+    size() const {
+        return size_;
+    }
+
+    // whether the buffer is of the hugetlb pool
+    bool
+    explicit_pages() const {
+        return explicit_pages_;
+    }
+
+ private:
+    HugePageBuffer(void* data, size_t size, size_t mapped_size, bool explicit_pages);
+
+    void* data_;
+    size_t size_;
+    size_t mapped_size_;
+    bool explicit_pages_;
+};
+
+// Advises the kernel to back the pages of size bytes at data, allocated or mapped from a file, with transparent huge
+// pages, unless the policy is NONE. The file mappings get them if the file system supports it.
+void
+AdviseHugePages(const void* data, size_t size);
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_HUGE_PAGE_H */
@@ -26,6 +26,7 @@ constexpr const char* INDEX_FAISS_BIN_IDMAP = "BIN_FLAT";
 constexpr const char* INDEX_FAISS_BIN_IVFFLAT = "BIN_IVF_FLAT";
 
 constexpr const char* INDEX_FAISS_IDMAP = "FLAT";
+constexpr const char* INDEX_FAISS_IDMAP_SQ = "FLAT_SQ";
 constexpr const char* INDEX_FAISS_IVFFLAT = "IVF_FLAT";
 constexpr const char* INDEX_FAISS_IVFFLAT_CC = "IVF_FLAT_CC";
 constexpr const char* INDEX_FAISS_IVFPQ = "IVF_PQ";
@@ -34,6 +35,7 @@ constexpr const char* INDEX_FAISS_SCANN_DVR = "SCANN_DVR";
 constexpr const char* INDEX_FAISS_IVFSQ8 = "IVF_SQ8";
 constexpr const char* INDEX_FAISS_IVFSQ_CC = "IVF_SQ_CC";
 constexpr const char* INDEX_FAISS_IVFRABITQ = "IVF_RABITQ";
+constexpr const char* INDEX_FAISS_IVFPQ_FASTSCAN = "IVF_PQ_FASTSCAN";
 
 constexpr const char* INDEX_FAISS_GPU_IDMAP = "GPU_FAISS_FLAT";
 constexpr const char* INDEX_FAISS_GPU_IVFFLAT = "GPU_FAISS_IVF_FLAT";
@@ -54,21 +56,31 @@ constexpr const char* INDEX_HNSW = "HNSW";
 constexpr const char* INDEX_HNSW_SQ = "HNSW_SQ";
 constexpr const char* INDEX_HNSW_PQ = "HNSW_PQ";
 constexpr const char* INDEX_HNSW_PRQ = "HNSW_PRQ";
+constexpr const char* INDEX_HNSW_RABITQ = "HNSW_RABITQ";
+constexpr const char* INDEX_HNSW_CC = "HNSW_CC";
+constexpr const char* INDEX_BIN_HNSW = "BIN_HNSW";
 
 constexpr const char* INDEX_DISKANN = "DISKANN";
 constexpr const char* INDEX_AISAQ = "AISAQ";
 constexpr const char* INDEX_MINHASH_LSH = "MINHASH_LSH";
 
 constexpr const char* INDEX_EMB_LIST_HNSW = "EMB_LIST_HNSW";
+constexpr const char* INDEX_EMB_LIST_HNSW_PQ = "EMB_LIST_HNSW_PQ";
+constexpr const char* INDEX_EMB_LIST_IVF_SQ8 = "EMB_LIST_IVF_SQ8";
+constexpr const char* INDEX_EMB_LIST_DISKANN = "EMB_LIST_DISKANN";
+constexpr const char* INDEX_EMB_LIST_PLAID = "EMB_LIST_PLAID";
 
 constexpr const char* INDEX_SPARSE_INVERTED_INDEX = "SPARSE_INVERTED_INDEX";
 constexpr const char* INDEX_SPARSE_WAND = "SPARSE_WAND";
 constexpr const char* INDEX_SPARSE_INVERTED_INDEX_CC = "SPARSE_INVERTED_INDEX_CC";
 constexpr const char* INDEX_SPARSE_WAND_CC = "SPARSE_WAND_CC";
+constexpr const char* INDEX_SPARSE_CLUSTERED = "SPARSE_CLUSTERED";
 }  // namespace IndexEnum
 
 namespace ClusterEnum {
 constexpr const char* CLUSTER_KMEANS = "KMEANS";
+constexpr const char* CLUSTER_MINIBATCH_KMEANS = "MINIBATCH_KMEANS";
+constexpr const char* CLUSTER_HIERARCHICAL_KMEANS = "HIERARCHICAL_KMEANS";
 }  // namespace ClusterEnum
 
 namespace meta {
@@ -88,6 +100,7 @@ constexpr const char* LIMS = "lims";
 constexpr const char* TOPK = "k";
 constexpr const char* RANGE_SEARCH_K = "range_search_k";
 constexpr const char* RETAIN_ITERATOR_ORDER = "retain_iterator_order";
+constexpr const char* ITERATOR_BATCH_INIT = "iterator_batch_init";
 constexpr const char* RADIUS = "radius";
 constexpr const char* RANGE_FILTER = "range_filter";
 constexpr const char* INPUT_IDS = "input_ids";
@@ -98,6 +111,10 @@ constexpr const char* NUM_BUILD_THREAD = "num_build_thread";
 constexpr const char* TRACE_VISIT = "trace_visit";
 constexpr const char* JSON_INFO = "json_info";
 constexpr const char* JSON_ID_SET = "json_id_set";
+constexpr const char* SEARCH_STATS = "search_stats";
+constexpr const char* GROUP_SIZE = "group_size";
+constexpr const char* SEARCH_PRIORITY = "search_priority";
+constexpr const char* SEARCH_TIMEOUT_MS = "search_timeout_ms";
 constexpr const char* TRACE_ID = "trace_id";
 constexpr const char* SPAN_ID = "span_id";
 constexpr const char* TRACE_FLAGS = "trace_flags";
@@ -110,6 +127,12 @@ constexpr const char* BM25_B = "bm25_b";
 // average document length
 constexpr const char* BM25_AVGDL = "bm25_avgdl";
 constexpr const char* DIM_MAX_SCORE_RATIO = "dim_max_score_ratio";
+// hybrid search params
+constexpr const char* HYBRID_FUSION = "hybrid_fusion";
+constexpr const char* HYBRID_CANDIDATES = "hybrid_candidates";
+constexpr const char* RRF_K = "rrf_k";
+constexpr const char* DENSE_WEIGHT = "dense_weight";
+constexpr const char* SPARSE_WEIGHT = "sparse_weight";
 };  // namespace meta
 
 namespace indexparam {
@@ -128,6 +151,15 @@ constexpr const char* RAW_DATA_STORE_PREFIX = "raw_data_store_prefix";
 constexpr const char* SUB_DIM = "sub_dim";
 constexpr const char* REFINE_TYPE = "refine_type";
 constexpr const char* REFINE_WITH_QUANT = "refine_with_quant";
+constexpr const char* REFINE_BATCH_ORDER = "refine_batch_order";
+constexpr const char* QUANTIZER_TYPE = "quantizer_type";  // coarse quantizer of IVF, flat or hnsw
+constexpr const char* QUANTIZER_HNSW_M = "quantizer_hnsw_m";
+constexpr const char* QUANTIZER_EF_CONSTRUCTION = "quantizer_ef_construction";
+constexpr const char* QUANTIZER_EF = "quantizer_ef";
+constexpr const char* ADAPTIVE_NPROBE_RATIO = "adaptive_nprobe_ratio";  // IVF lists skipped by distance, 0 is off
+constexpr const char* HIERARCHICAL_KMEANS = "hierarchical_kmeans";  // IVF centroids by balanced two-level k-means
+constexpr const char* KMEANS_MAX_BALANCE = "kmeans_max_balance";
+constexpr const char* SQ_QUANTIZED_QUERY = "quantized_query";  // IVF_SQ8 IP codes scored against an int8 query
 
 // cuVS Params
 constexpr const char* REFINE_RATIO = "refine_ratio";
@@ -161,35 +193,72 @@ constexpr const char* HASHMAP_MIN_BITLEN = "hashmap_min_bitlen";
 constexpr const char* HASHMAP_MAX_FILL_RATE = "hashmap_max_fill_rate";
 constexpr const char* NN_DESCENT_NITER = "nn_descent_niter";
 constexpr const char* ADAPT_FOR_CPU = "adapt_for_cpu";
+constexpr const char* EXPORT_TO_HNSW = "export_to_hnsw";
+constexpr const char* NUM_SHARDS = "num_shards";
+constexpr const char* REPLICATE = "replicate";
+constexpr const char* CO_SEARCH = "co_search";
 
 // HNSW Params
 constexpr const char* EFCONSTRUCTION = "efConstruction";
 constexpr const char* HNSW_M = "M";
 constexpr const char* EF = "ef";
 constexpr const char* OVERVIEW_LEVELS = "overview_levels";
+constexpr const char* BUFFER_ROWS = "buffer_rows";  // HNSW_CC
 
 // DISKANN Params
 constexpr const char* MAX_DEGREE = "max_degree";
 constexpr const char* PQ_CODE_BUDGET_GB = "pq_code_budget_gb";
 constexpr const char* BUILD_DRAM_BUDGET_GB = "build_dram_budget_gb";
 constexpr const char* BEAMWIDTH = "beamwidth";
+constexpr const char* MIN_BEAMWIDTH = "min_beamwidth";
 constexpr const char* SEARCH_CACHE_BUDGET_GB = "search_cache_budget_gb";
 constexpr const char* SEARCH_LIST_SIZE = "search_list_size";
+constexpr const char* RERANK_TIER = "rerank_tier";
+constexpr const char* RERANK_TIER_BUDGET_GB = "rerank_tier_budget_gb";
+constexpr const char* EXACT_RERANK = "exact_rerank";
+constexpr const char* MERGE_THRESHOLD = "merge_threshold";
 
 // FAISS additional Params
 constexpr const char* HNSW_REFINE = "refine";
 constexpr const char* HNSW_REFINE_K = "refine_k";
 constexpr const char* HNSW_REFINE_TYPE = "refine_type";
+constexpr const char* HNSW_REFINE_CASCADE_TYPE = "refine_cascade_type";
+constexpr const char* HNSW_REFINE_CASCADE_K = "refine_cascade_k";
 constexpr const char* SQ_TYPE = "sq_type";  // for IVF_SQ and HNSW_SQ
 constexpr const char* PRQ_NUM = "nrq";      // for PRQ, number of redisual quantizers
+constexpr const char* PQ_ROTATION = "pq_rotation";  // for HNSW_PQ, the rotation ahead of the codes
+constexpr const char* PREFIX_DIM = "prefix_dim";    // the dimensions that the base index of a refine is built on
+constexpr const char* GRAPH_REORDERING = "graph_reordering";
+constexpr const char* HNSW_BULK_BUILD = "bulk_build";
+constexpr const char* HNSW_INLINE_LAYOUT = "inline_layout";
+constexpr const char* HNSW_LAZY_LOAD = "lazy_load";
+constexpr const char* HNSW_TOMBSTONE_COMPACTION_RATIO = "tombstone_compaction_ratio";
+constexpr const char* HNSW_SHARDS = "shards";
+constexpr const char* HNSW_SHARD_TYPE = "shard_type";
+constexpr const char* HNSW_EARLY_TERMINATION_PATIENCE = "early_termination_patience";
+constexpr const char* HNSW_ENTRY_POINTS = "entry_points";
+constexpr const char* HNSW_SEARCH_STRATEGY = "search_strategy";
 
 // Sparse Inverted Index Params
 constexpr const char* INVERTED_INDEX_ALGO = "inverted_index_algo";
 constexpr const char* DROP_RATIO_BUILD = "drop_ratio_build";
 constexpr const char* DROP_RATIO_SEARCH = "drop_ratio_search";
+constexpr const char* POSTING_LIST_COMPRESSION = "posting_list_compression";
+constexpr const char* DOC_ID_REORDERING = "doc_id_reordering";
+constexpr const char* BM25_PRECOMPUTE_IMPACTS = "bm25_precompute_impacts";
+constexpr const char* TERM_PRUNING_RATIO = "term_pruning_ratio";
+
+// Sparse Clustered Index Params
+constexpr const char* POSTING_LIST_LENGTH = "posting_list_length";
+constexpr const char* CENTROID_FRACTION = "centroid_fraction";
+constexpr const char* SUMMARY_ENERGY = "summary_energy";
+constexpr const char* QUERY_CUT = "query_cut";
+constexpr const char* HEAP_FACTOR = "heap_factor";
+constexpr const char* BLOCK_BUDGET = "block_budget";
 
 // RaBitQ Params
 constexpr const char* RABITQ_QUERY_BITS = "rbq_bits_query";
+constexpr const char* RABITQ_DATA_BITS = "rbq_bits_data";
 
 // minhash meta Params
 constexpr const char* MH_ELEMENT_BIT_WIDTH = "mh_element_bit_width";
@@ -197,14 +266,21 @@ constexpr const char* MH_LSH_SEARCH_WITH_JACCARD = "mh_search_with_jaccard";
 // minhash lsh index params
 constexpr const char* MH_LSH_ALIGNED_BLOCK_SIZE = "mh_lsh_aligned_block_size";
 constexpr const char* MH_LSH_BAND = "mh_lsh_band";
+constexpr const char* MH_LSH_BAND_LAYOUT = "mh_lsh_band_layout";
 constexpr const char* MH_LSH_SHARED_BLOOM_FILTER = "mh_lsh_shared_bloom_filter";
 constexpr const char* MH_LSH_BLOOM_FALSE_POSITIVE_RPOB = "mh_lsh_bloom_false_positive_prob";
+constexpr const char* MH_LSH_BLOOM_FILTER_TYPE = "mh_lsh_bloom_filter_type";
 constexpr const char* MH_LSH_HASH_CODE_IN_MEM = "mh_lsh_code_in_mem";
 constexpr const char* MH_LSH_REFINE_K = "refine_k";
+constexpr const char* MH_LSH_REFINE_BITS = "mh_lsh_refine_bits";
 constexpr const char* MH_LSH_BATCH_SEARCH = "mh_lsh_batch_search";
 
 // Emb List Index Params
 constexpr const char* RETRIEVAL_ANN_RATIO = "retrieval_ann_ratio";
+constexpr const char* CENTROID_CANDIDATE_RATIO = "centroid_candidate_ratio";
+constexpr const char* EMB_LIST_RESIDUAL_BITS = "residual_bits";
+constexpr const char* EMB_LIST_REFINE = "refine";
+constexpr const char* EMB_LIST_REFINE_K = "refine_k";
 }  // namespace indexparam
 
 using MetricType = std::string;
@@ -240,6 +316,10 @@ enum RefineType {
     UINT8_QUANT,
     FLOAT16_QUANT,
     BFLOAT16_QUANT,
+    // int8 with a symmetric scale per dimension, scored with int8 inner products
+    INT8_QUANT,
+    // 4 bits per dimension over the range of every dimension
+    SQ4_QUANT,
 };
 
 }  // namespace knowhere
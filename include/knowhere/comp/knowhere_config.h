@@ -12,12 +12,15 @@
 #ifndef COMP_KNOWHERE_CONFIG_H
 #define COMP_KNOWHERE_CONFIG_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #ifdef KNOWHERE_WITH_DISKANN
 #include "diskann/aio_context_pool.h"
+#include "diskann/range_reader.h"
 #endif
+#include "knowhere/comp/huge_page.h"
 
 namespace knowhere {
 
@@ -40,6 +43,15 @@ class KnowhereConfig {
     static std::string
     SetSimdType(const SimdType simd_type);
 
+    /**
+     * Opt-in: micro-benchmarks the distance kernels the cpu and the SIMD type allow for each function and dim bucket,
+     * and installs the fastest ones in place of the CPUID based choice. Takes tens of milliseconds; call it after
+     * SetSimdType, which undoes it, and before EnablePatchForComputeFP32AsBF16. The choices are logged and exported
+     * as the simd_kernel_latency metric. Returns them as "function:max_dim=kernel" items separated by spaces.
+     */
+    static std::string
+    CalibrateSimdKernels();
+
     /**
      *The purpose of this interface is: part of the sealed indexes default to using bf16 as the base data to achieve
      *higher capacity; to ensure consistency in computation between growing and sealed, it is necessary to maintain the
@@ -85,6 +97,29 @@ class KnowhereConfig {
     static void
     SetClusteringType(const ClusteringType clustering_type);
 
+    /**
+     * set Clustering mini-batch size
+     *   If > 0, each K-means iteration assigns a batch of that many training vectors only and moves the centroids
+     *   towards it, instead of assigning the whole training set. It trades a little quality for much faster IVF
+     *   training with large nlist. And if mini_batch_size = 0, K-means runs on the whole training set
+     */
+    static void
+    SetClusteringMiniBatchSize(const size_t mini_batch_size);
+
+    static size_t
+    GetClusteringMiniBatchSize();
+
+    /**
+     * set Clustering time budget in seconds
+     *   K-means stops iterating once it is spent, after at least one iteration
+     *   And if time_budget = 0, there is no limit
+     */
+    static void
+    SetClusteringTimeBudget(const double time_budget);
+
+    static double
+    GetClusteringTimeBudget();
+
     /**
      * The numebr of maximum parallel disk reads per thread.
      * On Linux, the default limit of `aio-max-nr` is 65536, so the product of `num_threads` and `max_events` (default
@@ -95,16 +130,92 @@ class KnowhereConfig {
     static bool
     SetAioContextPool(size_t num_ctx);
 
+    /**
+     * The maximum number of IO contexts (aio contexts or io_uring rings) a disk index holds at once, out of the
+     * `num_ctx` set by SetAioContextPool that all the disk indexes of the process share, so that a heavily searched
+     * index does not starve the others. While indexes wait for a context, a free one goes to the index of the highest
+     * `io_priority` first and, among those, to the one holding the fewest. And if quota = 0, there is no limit.
+     */
+    static void
+    SetDiskIOQuota(size_t quota);
+
+    static size_t
+    GetDiskIOQuota();
+
+#ifdef KNOWHERE_WITH_DISKANN
+    /**
+     * The reader of byte ranges of the stored disk index files, for the indexes deserialized with `tiered_load`: they
+     * read their index file through it while it is downloaded, instead of waiting for the file manager to load it. And
+     * if reader = nullptr, the tiered load is not available.
+     */
+    static void
+    SetDiskRangeReader(std::shared_ptr<RangeReader> reader);
+#endif
+
     static void
     SetBuildThreadPoolSize(size_t num_threads);
     static size_t
     GetBuildThreadPoolSize();
 
+    /**
+     * The builds of Index::Build and Index::BuildAsync are admitted as long as their estimated peak memory fits in
+     * `bytes` along with the running builds, 0 for no budget (the default). The builds running at once share the
+     * build thread pool, unless they set num_build_thread.
+     */
+    static void
+    SetBuildMemoryBudget(int64_t bytes);
+
     static void
     SetSearchThreadPoolSize(size_t num_threads);
     static size_t
     GetSearchThreadPoolSize();
 
+    /**
+     * NUMA mode: the indexes deserialized with a `numa_node` have their data allocated on that node, and their search
+     * tasks run on a search thread pool of that node, whose threads are pinned to its cpus. Each node pool has the
+     * node's share of the search thread pool size.
+     */
+    static void
+    SetNumaMode(bool enable);
+
+    static bool
+    IsNumaModeEnabled();
+
+    /**
+     * Huge pages: the large buffers of the FLAT, IVF and HNSW indexes deserialized afterwards (codes, graphs, inverted
+     * list arenas) are moved to buffers of transparent huge pages, or of the reserved hugetlb pool, according to
+     * `policy`. The buffers of the mapped index files and of the mmapped sparse indexes are advised to be backed with
+     * transparent huge pages in place. NONE, the default, keeps regular pages.
+     */
+    static void
+    SetHugePagePolicy(HugePagePolicy policy);
+
+    /**
+     * Admission control of the searches: the searches of a `search_priority` (-1 low, 0 normal, 1 high) are shed once
+     * `limit` search pool tasks of that priority wait for a thread, 0 for no limit (the default). The shed searches
+     * fail with Status::resource_exhausted, or if `wait`, wait for room in the queue up to their deadline.
+     */
+    static void
+    SetSearchQueueLimit(int32_t priority, size_t limit);
+
+    static void
+    SetSearchAdmissionWait(bool wait);
+
+    /**
+     * Observe one in `every` of the search stage timings of each thread in the search_stage_latency histograms, 0 for
+     * none. The default is 16.
+     */
+    static void
+    SetSearchStageSampling(uint32_t every);
+
+    /**
+     * Serialize the FLAT, IVF and HNSW indexes of version 9 or later into binaries whose data is zstd compressed at
+     * `level`, 0 for uncompressed (the default). The compressed binaries are recognized and decompressed chunk by chunk
+     * at deserialization, whatever the level in effect.
+     */
+    static void
+    SetBinaryCompressionLevel(int level);
+
     /**
      * init GPU Resource
      */
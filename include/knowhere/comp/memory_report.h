@@ -0,0 +1,115 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_MEMORY_REPORT_H
+#define KNOWHERE_COMP_MEMORY_REPORT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace knowhere {
+
+// The parts of an index that IndexNode::GetMemoryReport() accounts the memory of.
+enum class MemoryComponent {
+    // the HNSW and DiskANN graphs, their levels and offsets
+    GRAPH = 0,
+    // the quantized or compressed vectors, the posting lists of the sparse indexes
+    CODES = 1,
+    // the vectors as they were added, from which they can be reconstructed as is
+    RAW_DATA = 2,
+    // the codes of the refine index, that the results of the base index are re-ranked with
+    REFINE_DATA = 3,
+    // the ids of the inverted lists, the id maps and the labels of the materialized views
+    ID_MAP = 4,
+    // the IVF centroids, the PQ pivots of DiskANN
+    CENTROIDS = 5,
+    // the caches of the searches, the node cache of DiskANN
+    CACHE = 6,
+    // the scratch buffers that the index keeps between the searches
+    SCRATCH = 7,
+    // the rest: the transforms, the tombstones, the indexes that are only reported as a whole
+    OTHER = 8,
+};
+
+constexpr size_t kNumMemoryComponents = 9;
+
+const char*
+MemoryComponentName(MemoryComponent component);
+
+struct MemoryUsage {
+    // the anonymous memory that the index allocated, all of it resident
+    size_t heap_bytes = 0;
+    // the memory that the index maps from its files
+    size_t mapped_bytes = 0;
+    // the part of mapped_bytes that is in the page cache, for now
+    size_t mapped_resident_bytes = 0;
+
+    MemoryUsage&
+    operator+=(const MemoryUsage& other) {
+        heap_bytes += other.heap_bytes;
+        mapped_bytes += other.mapped_bytes;
+        mapped_resident_bytes += other.mapped_resident_bytes;
+        return *this;
+    }
+};
+
+// The memory of an index, component by component. The bytes are exact unless noted by the index: those of the
+// buffers that it holds, without the overhead of the allocator.
+class MemoryReport {
+ public:
+    void
+    AddHeap(MemoryComponent component, size_t bytes) {
+        usages_[static_cast<size_t>(component)].heap_bytes += bytes;
+    }
+
+    // the pages of the range that are resident are counted with mincore()
+    void
+    AddMapped(MemoryComponent component, const void* data, size_t bytes);
+
+    void
+    Add(const MemoryReport& other) {
+        for (size_t i = 0; i < kNumMemoryComponents; ++i) {
+            usages_[i] += other.usages_[i];
+        }
+    }
+
+    const MemoryUsage&
+    Get(MemoryComponent component) const {
+        return usages_[static_cast<size_t>(component)];
+    }
+
+    MemoryUsage
+    Total() const {
+        MemoryUsage total;
+        for (const auto& usage : usages_) {
+            total += usage;
+        }
+        return total;
+    }
+
+ private:
+    std::array<MemoryUsage, kNumMemoryComponents> usages_{};
+};
+
+// Sets the gauges index_memory_bytes{index_id, component, kind} to the report, kind being heap, mapped or
+// mapped_resident. A no-op in the builds without Prometheus.
+void
+ExportMemoryReport(const std::string& index_id, const MemoryReport& report);
+
+// Removes the gauges that ExportMemoryReport() set for the index, once it is released.
+void
+RemoveMemoryReport(const std::string& index_id);
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_MEMORY_REPORT_H */
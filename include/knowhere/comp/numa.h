@@ -0,0 +1,105 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_NUMA_H
+#define KNOWHERE_COMP_NUMA_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "knowhere/comp/task.h"
+#include "knowhere/thread_pool.h"
+
+namespace knowhere {
+
+// The number of NUMA nodes of the machine, 1 if it is not a NUMA machine.
+int
+NumaNodeCount();
+
+// The cpus of a NUMA node, empty if the node does not exist.
+std::vector<int>
+NumaNodeCpus(int node);
+
+// When enabled, the search tasks of an index with a home NUMA node run on the search pool of that node.
+void
+SetNumaMode(bool enable);
+
+bool
+IsNumaModeEnabled();
+
+// The search pool of a NUMA node, with the node's share of the global search pool size. The tasks pushed with
+// PushSearchTask pin the threads they run on to the cpus of the node.
+std::shared_ptr<ThreadPool>
+GetNumaSearchThreadPool(int node);
+
+// Pins the calling thread to the cpus of a NUMA node. Cheap when the thread is pinned to that node already.
+void
+BindCurrentThreadToNumaNode(int node);
+
+// Sets the home NUMA node of the searches of the calling thread until the setter goes out of scope, -1 for none.
+class ScopedNumaNode {
+ public:
+    explicit ScopedNumaNode(int node);
+    ~ScopedNumaNode();
+
+    ScopedNumaNode(const ScopedNumaNode&) = delete;
+    ScopedNumaNode&
+    operator=(const ScopedNumaNode&) = delete;
+
+ private:
+    int prev_node_;
+};
+
+int
+GetCurrentNumaNode();
+
+// Allocates the pages the calling thread first touches on a NUMA node, preferably, until the binding goes out of
+// scope. Index data loaded under it (graphs, inverted lists, posting lists) lives on that node.
+class ScopedNumaMemoryBinding {
+ public:
+    explicit ScopedNumaMemoryBinding(int node);
+    ~ScopedNumaMemoryBinding();
+
+    ScopedNumaMemoryBinding(const ScopedNumaMemoryBinding&) = delete;
+    ScopedNumaMemoryBinding&
+    operator=(const ScopedNumaMemoryBinding&) = delete;
+
+ private:
+    bool bound_ = false;
+};
+
+// Pushes a search task to `pool`, or to the pool of the home NUMA node of the calling thread in NUMA mode. The task
+// runs with the search deadline, the stage times and the fault counter of the calling thread, and counts in the search
+// queue of its priority.
+template <typename Func>
+auto
+PushSearchTask(const std::shared_ptr<ThreadPool>& pool, Func&& func) {
+    const int node = IsNumaModeEnabled() ? GetCurrentNumaNode() : -1;
+    return (node < 0 ? pool : GetNumaSearchThreadPool(node))
+        ->push([node, deadline = GetSearchDeadline(), stage_times = GetSearchStageTimes(), faults = GetSearchFaults(),
+                account = std::make_shared<SearchTaskAccount>(), func = std::forward<Func>(func)]() mutable {
+            ScopedSearchStageTimes stage_times_setter(stage_times);
+            ScopedSearchFaults faults_setter(faults);
+            account->Start();
+            if (node >= 0) {
+                BindCurrentThreadToNumaNode(node);
+            }
+            ScopedNumaNode numa_setter(node);
+            ScopedSearchDeadline deadline_setter(deadline);
+            ScopedSearchThreadPoolTask task_marker;
+            return func();
+        });
+}
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_NUMA_H */
@@ -0,0 +1,71 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_RESULT_BUFFER_POOL_H
+#define KNOWHERE_COMP_RESULT_BUFFER_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace knowhere {
+
+// The pool of the buffers of the search results (ids, distances), which are allocated for every search and released
+// with its result DataSet. A thread keeps the released buffers in free lists of power-of-two size classes, from
+// kMinBytes to kMaxBytes, up to kCachedBytesPerClass per class and kMaxCachedBytes in all, and hands them out to its
+// next allocations of the same class; the larger buffers and the excess go to the heap. A buffer may be released by
+// another thread than the one that allocated it, it then joins the free lists of the releasing thread within the same
+// caps. The buffers come from ::operator new[], so that those of a DataSet that does not own its results (@see
+// DataSet::SetIsOwner) can be delete[]d by whoever takes them over.
+class ResultBufferPool {
+ public:
+    static constexpr size_t kMinBytes = 64;
+    static constexpr size_t kMaxBytes = 16UL << 20;
+    static constexpr size_t kCachedBytesPerClass = 4UL << 20;
+    static constexpr size_t kMaxCachedBytes = 16UL << 20;
+
+    // bytes uninitialized bytes, to be released with Release and the same bytes
+    static void*
+    Allocate(size_t bytes);
+
+    static void
+    Release(void* p, size_t bytes);
+
+    // the bytes of the free lists of the calling thread
+    static size_t
+    CachedBytes();
+};
+
+struct ResultBufferDeleter {
+    size_t bytes = 0;
+
+    void
+    operator()(void* p) const {
+        ResultBufferPool::Release(p, bytes);
+    }
+};
+
+// a buffer of the pool, handed over to a result DataSet (@see DataSet::SetIds, DataSet::SetDistance)
+template <typename T>
+using ResultBuffer = std::unique_ptr<T[], ResultBufferDeleter>;
+
+// n uninitialized values from the pool
+template <typename T>
+inline ResultBuffer<T>
+AllocateResultBuffer(size_t n) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    const size_t bytes = n * sizeof(T);
+    return ResultBuffer<T>(static_cast<T*>(ResultBufferPool::Allocate(bytes)), ResultBufferDeleter{bytes});
+}
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_RESULT_BUFFER_POOL_H */
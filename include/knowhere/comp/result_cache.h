@@ -0,0 +1,92 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_RESULT_CACHE_H
+#define KNOWHERE_COMP_RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "knowhere/bitsetview.h"
+#include "knowhere/operands.h"
+
+namespace knowhere {
+
+// A bounded LRU cache of the top-k results of the single queries of an index (@see Index::EnableResultCache), keyed
+// by the hash of the query vector salted with the hash of the rest of its search: its config and its bitset. The
+// fp32 queries may be keyed by their elements rounded to multiples of key_step, for the nearly identical queries to
+// share their results. An entry keeps the keyed form of its query (@see QueryBytes), which a lookup compares, so that
+// two queries whose keys collide do not share their results.
+class SearchResultCache {
+ public:
+    SearchResultCache(size_t capacity, DataFormatEnum data_format, float key_step);
+
+    SearchResultCache(const SearchResultCache&) = delete;
+    SearchResultCache&
+    operator=(const SearchResultCache&) = delete;
+
+    // the bytes of a query vector of dim dimensions
+    size_t
+    RowBytes(int64_t dim) const;
+
+    // the key of the query row of tensor, salted with salt (@see SearchSalt)
+    uint64_t
+    QueryKey(const void* tensor, int64_t row, int64_t dim, uint64_t salt) const;
+
+    // the form of the query row of tensor that is keyed: its elements rounded to multiples of key_step, or its bytes
+    std::string
+    QueryBytes(const void* tensor, int64_t row, int64_t dim) const;
+
+    // the salt of the query keys of the searches with the config config and the bitset bitset
+    static uint64_t
+    SearchSalt(const std::string& config, const BitsetView& bitset);
+
+    // copies the k results of key into ids and distances, returns false if they are not cached or are those of
+    // another query than query (@see QueryBytes)
+    bool
+    Lookup(uint64_t key, const std::string& query, int64_t k, int64_t* ids, float* distances);
+
+    void
+    Insert(uint64_t key, const std::string& query, int64_t k, const int64_t* ids, const float* distances);
+
+    // drops all the results, once the index changed
+    void
+    Clear();
+
+    size_t
+    Size() const;
+
+ private:
+    struct Entry {
+        uint64_t key;
+        std::string query;
+        std::vector<int64_t> ids;
+        std::vector<float> distances;
+    };
+
+    const size_t capacity_;
+    const DataFormatEnum data_format_;
+    const float key_step_;
+
+    mutable std::mutex mutex_;
+    // the most recently used first
+    std::list<Entry> lru_;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> entries_;
+};
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_RESULT_CACHE_H */
@@ -0,0 +1,90 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_SEARCH_PLANNER_H
+#define KNOWHERE_COMP_SEARCH_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace knowhere {
+
+// The strategies a k-NN search of a graph index can be executed with. They are bits, those a query was executed with
+// are returned in QuerySearchStats::strategies.
+enum class SearchStrategy : uint32_t {
+    // the traversal of the graph, which goes through the filtered out nodes as through the others
+    GRAPH = 1,
+    // the traversal that goes through the filtered out neighbors of a node to their own neighbors
+    GRAPH_TWO_HOP = 2,
+    // the scan of the rows that pass the filter
+    BRUTE_FORCE = 4,
+};
+
+// What the planner knows of an index and of a search of it.
+struct SearchProfile {
+    size_t num_rows = 0;
+    // the rows that pass the filter, num_rows without a filter
+    size_t num_valid_rows = 0;
+    size_t k = 0;
+    // the candidates the graph traversal keeps, at least k
+    size_t ef = 0;
+    size_t nq = 1;
+    // the bytes a distance computation reads from the storage of the index
+    size_t code_size = 0;
+    // the neighbors of a node on the bottom layer of the graph
+    size_t graph_degree = 0;
+    // whether the index is mmapped, a node of the graph that is not in the page cache costs a page fault
+    bool mmapped = false;
+    // whether a brute force has to resolve the id mapping of the filter first, once per search
+    bool resolves_out_ids = false;
+};
+
+// The strategy of a search and the costs it was chosen from, estimated per query in bytes read: a distance of the scan
+// reads its code sequentially, a distance of the graph traversal also misses the cache on the node it reaches.
+struct SearchPlan {
+    SearchStrategy strategy = SearchStrategy::GRAPH;
+    // the cost of the chosen strategy
+    double cost = 0;
+    double graph_cost = 0;
+    double two_hop_cost = 0;
+    double brute_force_cost = 0;
+};
+
+// The constants of the cost model of PlanSearch().
+struct SearchCostModel {
+    // the cost of a cache miss on a node of the graph, as the bytes that a scan streams meanwhile
+    static constexpr double kRandomAccessBytes = 512;
+    // the cost of a miss of an mmapped graph, relative to one of an index in memory
+    static constexpr double kMmappedRandomAccessFactor = 4;
+    // the cost of testing the filter bit of a row, and of resolving the id mapping of a row
+    static constexpr double kFilterTestBytes = 0.125;
+    static constexpr double kResolveOutIdBytes = 4;
+    // a search without a filter goes through the graph unless k is at least this fraction of the rows
+    static constexpr double kUnfilteredBruteForceTopkRatio = 0.5;
+};
+
+constexpr uint32_t kAllSearchStrategies = 7;
+
+// Chooses the cheapest of the allowed strategies (SearchStrategy bits) of a k-NN search from their estimated costs.
+// The graph traversal computes the distances to the neighbors of the nodes it expands; it expands ef / p nodes to
+// collect ef of them out of a fraction p that pass the filter, plus those of the descent to the bottom layer,
+// log2(num_rows). The two-hop traversal expands only the nodes that pass, and computes the distances to those of
+// their neighbors and of the neighbors of the others that pass. The brute force computes the distances to the rows
+// that pass and tests the filter of every row.
+//
+// A search without a filter is not planned from the costs: the graph is what the index is built for, and the
+// brute force is kept for the k that are a large fraction of the rows.
+SearchPlan
+PlanSearch(const SearchProfile& profile, uint32_t allowed = kAllSearchStrategies);
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_SEARCH_PLANNER_H */
@@ -0,0 +1,130 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_SEARCH_STAGE_H
+#define KNOWHERE_COMP_SEARCH_STAGE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace knowhere {
+
+// The stages of a search whose latencies are broken out. The stages run on the threads of the search pool are timed
+// per task, so the time of a stage of a search is summed over its threads. The IO wait of DiskANN is part of its
+// graph traversal.
+enum class SearchStage : uint8_t {
+    CONFIG_PARSE,
+    QUEUE_WAIT,
+    COARSE_QUANTIZATION,
+    LIST_SCAN,
+    GRAPH_TRAVERSAL,
+    REFINE,
+    IO_WAIT,
+    RESULT_ASSEMBLY,
+};
+
+constexpr size_t kNumSearchStages = 8;
+
+const char*
+SearchStageName(SearchStage stage);
+
+// One in `every` of the stage timings of each thread is observed in the search_stage_latency histograms, 0 for none.
+// The stages of a traced search are timed regardless, for its span.
+void
+SetSearchStageSampling(uint32_t every);
+
+uint32_t
+GetSearchStageSampling();
+
+// The stage times of a traced search, summed over the threads that run it.
+struct SearchStageTimes {
+    std::array<std::atomic<uint64_t>, kNumSearchStages> ns{};
+
+    double
+    Ms(SearchStage stage) const {
+        return ns[static_cast<size_t>(stage)].load(std::memory_order_relaxed) * 1e-6;
+    }
+};
+
+// Collects the stage times of the searches of the calling thread until the setter goes out of scope, nullptr for
+// none. The tasks submitted by ExecOverSearchThreadPool and PushSearchTask collect into the times of the submitting
+// thread.
+class ScopedSearchStageTimes {
+ public:
+    explicit ScopedSearchStageTimes(std::shared_ptr<SearchStageTimes> times);
+    ~ScopedSearchStageTimes();
+
+    ScopedSearchStageTimes(const ScopedSearchStageTimes&) = delete;
+    ScopedSearchStageTimes&
+    operator=(const ScopedSearchStageTimes&) = delete;
+
+ private:
+    std::shared_ptr<SearchStageTimes> prev_times_;
+};
+
+const std::shared_ptr<SearchStageTimes>&
+GetSearchStageTimes();
+
+// Records a stage that took ms, timed by the caller.
+void
+RecordSearchStage(SearchStage stage, double ms);
+
+// Times a stage of a search until it goes out of scope, if the timing is sampled or the search is traced. Costs a
+// thread-local counter otherwise.
+class ScopedSearchStage {
+ public:
+    explicit ScopedSearchStage(SearchStage stage);
+    ~ScopedSearchStage();
+
+    ScopedSearchStage(const ScopedSearchStage&) = delete;
+    ScopedSearchStage&
+    operator=(const ScopedSearchStage&) = delete;
+
+ private:
+    SearchStage stage_;
+    bool sampled_;
+    bool timed_;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// The major page faults of a search, summed over the threads that run it: the pages of the mmapped indexes that it
+// read from the disk.
+using SearchFaults = std::atomic<uint64_t>;
+
+// Counts the major page faults of the calling thread into faults until the setter goes out of scope, nullptr for
+// none. The tasks submitted by ExecOverSearchThreadPool and PushSearchTask count into the faults of the submitting
+// thread.
+class ScopedSearchFaults {
+ public:
+    explicit ScopedSearchFaults(std::shared_ptr<SearchFaults> faults);
+    ~ScopedSearchFaults();
+
+    ScopedSearchFaults(const ScopedSearchFaults&) = delete;
+    ScopedSearchFaults&
+    operator=(const ScopedSearchFaults&) = delete;
+
+ private:
+    std::shared_ptr<SearchFaults> prev_faults_;
+    // whether this setter counts, not an enclosing one of the same faults on this thread
+    bool counting_ = false;
+    uint64_t begin_ = 0;
+};
+
+const std::shared_ptr<SearchFaults>&
+GetSearchFaults();
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_SEARCH_STAGE_H */
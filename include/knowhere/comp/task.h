@@ -9,23 +9,204 @@
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 #ifndef KNOWHERE_COMP_TASK_H
 #define KNOWHERE_COMP_TASK_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <vector>
 
+#include "folly/Executor.h"
 #include "folly/executors/CPUThreadPoolExecutor.h"
+#include "folly/futures/Future.h"
+#include "knowhere/comp/search_stage.h"
 #include "knowhere/expected.h"
 #include "knowhere/thread_pool.h"
 
 namespace knowhere {
 
+// Priority of the tasks that ExecOverSearchThreadPool submits, in folly executor priorities: queued tasks of a higher
+// priority are dequeued first, so small interactive searches are not stuck behind large batch ones.
+enum class SearchPriority : int8_t {
+    LOW = folly::Executor::LO_PRI,
+    NORMAL = folly::Executor::MID_PRI,
+    HIGH = folly::Executor::HI_PRI,
+};
+
+// Sets the search priority of the calling thread until the setter goes out of scope. The tasks submitted by
+// ExecOverSearchThreadPool run with the priority of the submitting thread, so nested submissions inherit it.
+class ScopedSearchPriority {
+ public:
+    explicit ScopedSearchPriority(SearchPriority priority);
+    ~ScopedSearchPriority();
+
+    ScopedSearchPriority(const ScopedSearchPriority&) = delete;
+    ScopedSearchPriority&
+    operator=(const ScopedSearchPriority&) = delete;
+
+ private:
+    SearchPriority prev_priority_;
+};
+
+SearchPriority
+GetSearchPriority();
+
+// the search priority of a `search_priority` config value: negative for low, positive for high
+inline SearchPriority
+ToSearchPriority(const int32_t priority) {
+    return priority < 0 ? SearchPriority::LOW : (priority > 0 ? SearchPriority::HIGH : SearchPriority::NORMAL);
+}
+
+// The deadline and the cancellation flag of a search, which its loops check between queries or blocks of work to
+// skip the rest once it is interrupted. `interrupted` records that work was skipped and the results are partial. A
+// caller cancels its searches by running them under a ScopedSearchDeadline whose `cancelled` flag it sets later.
+struct SearchDeadline {
+    std::chrono::steady_clock::time_point time = std::chrono::steady_clock::time_point::max();
+    std::shared_ptr<const std::atomic<bool>> cancelled = nullptr;
+    std::shared_ptr<std::atomic<bool>> interrupted = nullptr;
+
+    bool
+    WasInterrupted() const {
+        return interrupted != nullptr && interrupted->load();
+    }
+};
+
+// The deadline of a search of timeout_ms (0 for none), no later than the deadline of the calling thread, whose
+// cancellation flag it keeps.
+SearchDeadline
+MakeSearchDeadline(int32_t timeout_ms);
+
+// Sets the search deadline of the calling thread until the setter goes out of scope. The tasks submitted by
+// ExecOverSearchThreadPool and PushSearchTask run with the deadline of the submitting thread.
+class ScopedSearchDeadline {
+ public:
+    explicit ScopedSearchDeadline(SearchDeadline deadline);
+    ~ScopedSearchDeadline();
+
+    ScopedSearchDeadline(const ScopedSearchDeadline&) = delete;
+    ScopedSearchDeadline&
+    operator=(const ScopedSearchDeadline&) = delete;
+
+ private:
+    SearchDeadline prev_deadline_;
+};
+
+const SearchDeadline&
+GetSearchDeadline();
+
+// Whether the search of the calling thread is past its deadline or cancelled, in which case it is recorded as
+// interrupted. Cheap enough to be called per query.
+bool
+SearchInterrupted();
+
+// Admission control: a search is admitted while fewer than the queue limit of its priority of search pool tasks of
+// that priority wait for a thread, 0 for no limit (the default). A search whose queue is full is rejected with
+// Status::resource_exhausted, or with the WAIT policy, held back until the queue has room or its deadline passes.
+enum class SearchAdmissionPolicy {
+    REJECT,
+    WAIT,
+};
+
+void
+SetSearchQueueLimit(SearchPriority priority, size_t limit);
+
+size_t
+GetSearchQueueLimit(SearchPriority priority);
+
+void
+SetSearchAdmissionPolicy(SearchAdmissionPolicy policy);
+
+SearchAdmissionPolicy
+GetSearchAdmissionPolicy();
+
+// The search pool tasks of a priority waiting for a thread.
+size_t
+GetSearchQueueDepth(SearchPriority priority);
+
+// Admits a search with the priority and the deadline of the calling thread. The searches nested in a search pool task
+// are admitted already.
+Status
+AdmitSearch();
+
+// Accounts a search pool task with the priority of the calling thread in the queue depths and the pool metrics, from
+// its submission until it is destroyed.
+class SearchTaskAccount {
+ public:
+    SearchTaskAccount();
+    ~SearchTaskAccount();
+
+    SearchTaskAccount(const SearchTaskAccount&) = delete;
+    SearchTaskAccount&
+    operator=(const SearchTaskAccount&) = delete;
+
+    // the task starts running on a thread of the pool
+    void
+    Start();
+
+ private:
+    size_t priority_class_;
+    bool started_ = false;
+    std::chrono::steady_clock::time_point time_;
+};
+
+// Marks the calling thread as running a search pool task until the marker goes out of scope. RunOnSearchThreadPool
+// runs the work of such a thread inline instead of waiting on the pool for it, which deadlocks once all the threads
+// of the pool wait.
+class ScopedSearchThreadPoolTask {
+ public:
+    ScopedSearchThreadPoolTask();
+    ~ScopedSearchThreadPoolTask();
+
+    ScopedSearchThreadPoolTask(const ScopedSearchThreadPoolTask&) = delete;
+    ScopedSearchThreadPoolTask&
+    operator=(const ScopedSearchThreadPoolTask&) = delete;
+
+ private:
+    bool prev_in_task_;
+};
+
+bool
+IsSearchThreadPoolTask();
+
 void
 ExecOverSearchThreadPool(std::vector<std::function<void()>>& tasks);
+
+// Submits a task to the search thread pool, with the priority, the NUMA node and the deadline of the calling thread,
+// without waiting for it. A coroutine co_awaits the returned future to suspend until the task is done rather than
+// block its thread, so that a few threads drive the searches of many concurrent queries.
+folly::SemiFuture<folly::Unit>
+SubmitToSearchThreadPool(std::function<void()> task);
+
+// Runs a task on the search thread pool and waits for it, or runs it inline on a thread that runs a search pool task
+// already.
+void
+RunOnSearchThreadPool(const std::function<void()>& task);
+
+// Runs func(begin, end) over chunks of the items [0, n) on the search thread pool, with the priority, the NUMA node
+// and the deadline of the calling thread. The workers claim chunks from a shared counter, each a share of the
+// remaining items (guided scheduling) but no less than the items worth kParallelForMinChunkCost, so that cheap items
+// are batched instead of paying a task each and expensive ones are spread over the whole pool. item_cost is an
+// estimate of the work of an item, e.g. the vector components it scans. Once the search is interrupted, the
+// remaining chunks are passed to skip instead, for their results to be marked as missing.
+constexpr size_t kParallelForMinChunkCost = 1 << 16;
+void
+ParallelForOverSearchThreadPool(size_t n, size_t item_cost, const std::function<void(size_t, size_t)>& func,
+                                const std::function<void(size_t, size_t)>& skip = nullptr);
 void
 ExecOverBuildThreadPool(std::vector<std::function<void()>>& tasks);
+// Runs func(begin, end) over chunks of the items [0, n) on the build thread pool, chunked the same way, e.g. for the
+// load-time work of an index. The loops nested in func run inline.
+void
+ParallelForOverBuildThreadPool(size_t n, size_t item_cost, const std::function<void(size_t, size_t)>& func);
 void
 InitBuildThreadPool(uint32_t num_threads);
 void
 InitSearchThreadPool(uint32_t num_threads);
+// Feeds the thread pool metrics (threads, active threads, queue length, task wait and run times, labelled by pool)
+// from the tasks of the global search and build pools, and refreshes their gauges. Called when the pools are set up
+// or resized, and by the first search and build tasks.
+void
+InstrumentThreadPools();
 size_t
 GetSearchThreadPoolSize();
 size_t
@@ -0,0 +1,69 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_WARMUP_H
+#define KNOWHERE_COMP_WARMUP_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "knowhere/expected.h"
+
+namespace knowhere {
+
+// How much of an index IndexNode::Warmup() loads.
+enum class WarmupLevel {
+    // the structures that every search goes through: the HNSW graphs, the IVF centroids and list ids, a FLAT index
+    HOT = 0,
+    // all the data of the index
+    FULL = 1,
+};
+
+// Called with the work done so far and the work to do in all, from one thread at a time: bytes for the mapped
+// indexes, sample queries for DiskANN. Called once with (0, 0) when there is nothing to warm up.
+using WarmupProgress = std::function<void(size_t done, size_t total)>;
+
+struct MemoryRange {
+    const void* data;
+    size_t size;
+};
+
+// Loads the pages of file mappings: the kernel is advised to read them ahead (MADV_WILLNEED), and the tasks of the
+// build thread pool touch them in parallel, chunk by chunk, reporting the progress after each chunk.
+Status
+WarmupRanges(const std::vector<MemoryRange>& ranges, const WarmupProgress& progress);
+
+// Releases the pages of file mappings, that are read back from their files when accessed again (MADV_PAGEOUT, or
+// MADV_DONTNEED on the kernels without it). The ranges must not be anonymous memory.
+Status
+CooldownRanges(const std::vector<MemoryRange>& ranges);
+
+// How the searches read a file mapping, for the kernel to read it ahead accordingly. Mappings are MADV_RANDOM when
+// faiss maps them.
+enum class MmapAccess {
+    // only the page that faults is read: the HNSW graphs and the vectors that the graph walks fetch
+    RANDOM = 0,
+    // the pages after the one that faults are read ahead, aggressively: the IVF lists and the FLAT codes, which the
+    // searches scan through
+    SEQUENTIAL = 1,
+    // the pages are read ahead at once: the data that most searches go through, the IVF centroids, the posting lists
+    // of the hot dimensions of the sparse indexes
+    WILLNEED = 2,
+};
+
+// Advises the kernel of the access pattern of the ranges, on the pages that they overlap.
+void
+AdviseMmapAccess(const std::vector<MemoryRange>& ranges, MmapAccess access);
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_WARMUP_H */
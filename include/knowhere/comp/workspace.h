@@ -0,0 +1,130 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KNOWHERE_COMP_WORKSPACE_H
+#define KNOWHERE_COMP_WORKSPACE_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+// The scratch memory of the searches of a thread: the per-query buffers of the index searches (copies of the query,
+// score arrays, coarse assignments) are carved from it instead of the heap. A query opens a SearchWorkspace::Scope,
+// whose buffers are released when it closes, nested scopes stack. The workspace keeps the high-water mark of its
+// queries as one buffer, up to kMaxRetainedBytes, so once warm the queries of a thread do not allocate.
+//
+// A scope must not outlive the synchronous part of the query that opened it, e.g. span a coroutine suspension point,
+// since the rest of the query may resume on another thread.
+class SearchWorkspace {
+ public:
+    static constexpr size_t kAlignment = 64;
+    static constexpr size_t kMaxRetainedBytes = 64UL << 20;
+
+    // the workspace of the calling thread
+    static SearchWorkspace&
+    ThreadLocal();
+
+    class Scope {
+     public:
+        Scope() : Scope(ThreadLocal()) {
+        }
+
+        explicit Scope(SearchWorkspace& workspace)
+            : workspace_(workspace), used_(workspace.used_), overflow_(workspace.overflow_.size()) {
+            workspace_.depth_++;
+        }
+
+        ~Scope() {
+            workspace_.Release(used_, overflow_);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope&
+        operator=(const Scope&) = delete;
+
+        // n uninitialized values, valid until the scope closes
+        template <typename T>
+        T*
+        Alloc(size_t n) {
+            static_assert(std::is_trivially_destructible_v<T> && alignof(T) <= kAlignment);
+            return static_cast<T*>(workspace_.Allocate(n * sizeof(T)));
+        }
+
+        template <typename T>
+        T*
+        AllocZeroed(size_t n) {
+            auto data = Alloc<T>(n);
+            std::memset(static_cast<void*>(data), 0, n * sizeof(T));
+            return data;
+        }
+
+     private:
+        SearchWorkspace& workspace_;
+        size_t used_;
+        size_t overflow_;
+    };
+
+    size_t
+    Capacity() const {
+        return capacity_;
+    }
+
+    size_t
+    HighWater() const {
+        return high_water_;
+    }
+
+ private:
+    struct FreeDeleter {
+        void
+        operator()(void* p) const {
+            std::free(p);
+        }
+    };
+    using Buffer = std::unique_ptr<char, FreeDeleter>;
+
+    void*
+    Allocate(size_t bytes);
+
+    void
+    Release(size_t used, size_t overflow);
+
+    Buffer buffer_;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    // the allocations that did not fit in the buffer, which cannot grow while its allocations are live
+    std::vector<std::pair<Buffer, size_t>> overflow_;
+    size_t overflow_bytes_ = 0;
+    size_t high_water_ = 0;
+    size_t depth_ = 0;
+};
+
+// the query of dim values normalized in a buffer of the scope, for the cosine searches
+template <typename DataType>
+inline const DataType*
+NormalizedQuery(SearchWorkspace::Scope& scope, const DataType* query, int32_t dim) {
+    auto copy = scope.Alloc<DataType>(dim);
+    std::memcpy(copy, query, dim * sizeof(DataType));
+    NormalizeVec(copy, dim);
+    return copy;
+}
+
+}  // namespace knowhere
+
+#endif /* KNOWHERE_COMP_WORKSPACE_H */
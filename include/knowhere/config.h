@@ -17,6 +17,7 @@
 #include <iostream>
 #include <limits>
 #include <list>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <thread>
@@ -550,9 +551,25 @@ class Config {
         return cfg.CheckAndAdjust(type, err_msg);
     }
 
+    Config() = default;
+
+    // a copy holds the values of the params only, its __DICT__ is empty: it is read by the index nodes, not loaded
+    Config(const Config&) {
+    }
+
+    // the params are assigned by the derived configs, the __DICT__ keeps referring to them
+    Config&
+    operator=(const Config&) {
+        return *this;
+    }
+
     virtual ~Config() {
     }
 
+    // a copy of the config with its type, see the copy constructor
+    virtual std::unique_ptr<Config>
+    Clone() const = 0;
+
     using VarEntry = std::variant<Entry<CFG_STRING>, Entry<CFG_FLOAT>, Entry<CFG_INT>, Entry<CFG_INT64>,
                                   Entry<CFG_BOOL>, Entry<CFG_MATERIALIZED_VIEW_SEARCH_INFO_TYPE>>;
     std::unordered_map<std::string, VarEntry> __DICT__;
@@ -573,7 +590,11 @@ class Config {
     }
 };
 
-#define KNOHWERE_DECLARE_CONFIG(CONFIG) CONFIG()
+#define KNOHWERE_DECLARE_CONFIG(CONFIG)                         \
+    std::unique_ptr<knowhere::Config> Clone() const override { \
+        return std::make_unique<CONFIG>(*this);                 \
+    }                                                           \
+    CONFIG()
 
 #define KNOWHERE_CONFIG_DECLARE_FIELD(PARAM)                                                                     \
     __DICT__[#PARAM] = knowhere::Config::VarEntry(std::in_place_type<knowhere::Entry<decltype(PARAM)>>, &PARAM); \
@@ -602,15 +623,24 @@ class BaseConfig : public Config {
     CFG_FLOAT range_search_level;
     CFG_BOOL retain_iterator_order;
     CFG_BOOL trace_visit;
+    CFG_BOOL search_stats;
+    // the hits returned per group by a group-by search, k being the number of groups
+    CFG_INT group_size;
     CFG_BOOL enable_mmap;
     CFG_BOOL enable_mmap_pop;
+    CFG_BOOL enable_zero_copy;
+    CFG_INT numa_node;
     CFG_BOOL shuffle_build;
     CFG_STRING trace_id;
     CFG_STRING span_id;
     CFG_INT trace_flags;
+    CFG_INT search_priority;
+    CFG_INT search_timeout_ms;
     CFG_MATERIALIZED_VIEW_SEARCH_INFO_TYPE materialized_view_search_info;
     CFG_STRING opt_fields_path;
     CFG_FLOAT iterator_refine_ratio;
+    // runs the initial searches of the iterators of all the queries when they are created, in one parallel pass
+    CFG_BOOL iterator_batch_init;
     /**
      * k1, b, avgdl are used by BM25 metric only.
      * - k1, b, avgdl must be provided at load time.
@@ -630,9 +660,13 @@ class BaseConfig : public Config {
      *    UINT8_QUANT, keep data as uint8 vector in memory in refiner
      * - refine_with_quant, search parameter, whether to use quantized data to refine, faster but lost a little
      * precision
+     * - refine_batch_order, search parameter, whether to refine the candidates of all the queries of a search at once
+     * in the order of their ids, reading the raw vector of a candidate once for all the queries, rather than query by
+     * query
      */
     CFG_INT refine_type;
     CFG_BOOL refine_with_quant;
+    CFG_BOOL refine_batch_order;
     /*
      * mh_lsh_band is a special parameters of BF search and MinHash index node train.
      */
@@ -700,6 +734,15 @@ class BaseConfig : public Config {
             .description("trace visit for feder")
             .for_search()
             .for_range_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_stats)
+            .set_default(false)
+            .description("return the search stats of every query in the result")
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(group_size)
+            .set_default(1)
+            .description("the hits returned per group by a group-by search")
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
         KNOWHERE_CONFIG_DECLARE_FIELD(enable_mmap)
             .set_default(false)
             .description("enable mmap for load index")
@@ -711,6 +754,16 @@ class BaseConfig : public Config {
             .description("enable map_populate option for mmap")
             .for_deserialize()
             .for_deserialize_from_file();
+        KNOWHERE_CONFIG_DECLARE_FIELD(enable_zero_copy)
+            .set_default(false)
+            .description("load the index as views of the binary set instead of copies, the index keeps it alive")
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(numa_node)
+            .set_default(-1)
+            .description("the NUMA node to load the index data on and run its searches on, -1 for none")
+            .set_range(-1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_deserialize()
+            .for_deserialize_from_file();
         KNOWHERE_CONFIG_DECLARE_FIELD(shuffle_build)
             .set_default(true)
             .description("shuffle ids before index building")
@@ -730,6 +783,18 @@ class BaseConfig : public Config {
             .description("trace flags")
             .for_search()
             .for_range_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_priority)
+            .set_default(0)
+            .description("priority of the search tasks in the search thread pool, -1 low, 0 normal, 1 high")
+            .set_range(-1, 1)
+            .for_search()
+            .for_range_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_timeout_ms)
+            .set_default(0)
+            .description("the search stops with partial results and a timeout after this many ms, 0 for no limit")
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search()
+            .for_range_search();
         KNOWHERE_CONFIG_DECLARE_FIELD(materialized_view_search_info)
             .description("materialized view search info")
             .allow_empty_without_default()
@@ -745,6 +810,10 @@ class BaseConfig : public Config {
             .description("refine ratio for iterator")
             .for_iterator()
             .for_range_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(iterator_batch_init)
+            .set_default(false)
+            .description("whether to run the initial searches of all the iterators at their creation, in parallel")
+            .for_iterator();
         KNOWHERE_CONFIG_DECLARE_FIELD(retain_iterator_order)
             .set_default(false)
             .description("whether the result of iterator monotonically ordered")
@@ -787,6 +856,10 @@ class BaseConfig : public Config {
             .for_search()
             .for_range_search()
             .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_batch_order)
+            .description("search parameters, whether refine the candidates of all the queries in the order of the ids")
+            .set_default(false)
+            .for_search();
         KNOWHERE_CONFIG_DECLARE_FIELD(mh_lsh_band)
             .description("param of MinHashLSH")
             .set_default(1)
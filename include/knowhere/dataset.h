@@ -19,9 +19,12 @@
 #include <shared_mutex>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "comp/index_param.h"
+#include "knowhere/comp/result_buffer_pool.h"
 #include "knowhere/range_util.h"
+#include "knowhere/search_stats.h"
 #include "knowhere/sparse_utils.h"
 
 namespace knowhere {
@@ -32,24 +35,28 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
     DataSet() = default;
     ~DataSet() {
         if (!is_owner) {
+            // the buffers of the pool are the caller's as well, to be delete[]d (@see ResultBufferPool)
             return;
         }
+        for (auto&& [ptr, bytes] : this->pooled_) {
+            ResultBufferPool::Release(const_cast<void*>(ptr), bytes);
+        }
         for (auto&& x : this->data_) {
             {
                 auto ptr = std::get_if<0>(&x.second);
-                if (ptr != nullptr) {
+                if (ptr != nullptr && !IsPooled(*ptr)) {
                     delete[] * ptr;
                 }
             }
             {
                 auto ptr = std::get_if<1>(&x.second);
-                if (ptr != nullptr) {
+                if (ptr != nullptr && !IsPooled(*ptr)) {
                     delete[] * ptr;
                 }
             }
             {
                 auto ptr = std::get_if<2>(&x.second);
-                if (ptr != nullptr) {
+                if (ptr != nullptr && !IsPooled(*ptr)) {
                     delete[] * ptr;
                 }
             }
@@ -78,6 +85,13 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
         this->data_[meta::DISTANCE] = Var(std::in_place_index<0>, dis.release());
     }
 
+    void
+    SetDistance(ResultBuffer<float>&& dis) {
+        std::unique_lock lock(mutex_);
+        this->pooled_.emplace_back(dis.get(), dis.get_deleter().bytes);
+        this->data_[meta::DISTANCE] = Var(std::in_place_index<0>, dis.release());
+    }
+
     void
     SetLims(const size_t* lims) {
         std::unique_lock lock(mutex_);
@@ -112,6 +126,13 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
         this->data_[meta::IDS] = Var(std::in_place_index<2>, reinterpret_cast<int64_t*>(ids.release()));
     }
 
+    void
+    SetIds(ResultBuffer<int64_t>&& ids) {
+        std::unique_lock lock(mutex_);
+        this->pooled_.emplace_back(ids.get(), ids.get_deleter().bytes);
+        this->data_[meta::IDS] = Var(std::in_place_index<2>, ids.release());
+    }
+
     /**
      * For dense float vector, tensor is a rows * dim float array
      * For sparse float vector, tensor is pointer to sparse::Sparse<float>*
@@ -160,6 +181,12 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
         this->data_[meta::JSON_ID_SET] = Var(std::in_place_index<5>, idset);
     }
 
+    void
+    SetSearchStats(SearchStats&& stats) {
+        std::unique_lock lock(mutex_);
+        this->data_[meta::SEARCH_STATS] = Var(std::in_place_type<std::any>, std::move(stats));
+    }
+
     const float*
     GetDistance() const {
         std::shared_lock lock(mutex_);
@@ -248,6 +275,17 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
         return "";
     }
 
+    // the stats of the queries of the search that returned this result, nullptr if the search did not collect them
+    const SearchStats*
+    GetSearchStats() const {
+        std::shared_lock lock(mutex_);
+        auto it = this->data_.find(meta::SEARCH_STATS);
+        if (it != this->data_.end()) {
+            return std::any_cast<SearchStats>(std::get_if<std::any>(&it->second));
+        }
+        return nullptr;
+    }
+
     void
     SetIsOwner(bool is_owner) {
         std::unique_lock lock(mutex_);
@@ -297,8 +335,20 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
     }
 
  private:
+    bool
+    IsPooled(const void* ptr) const {
+        for (auto&& pooled : this->pooled_) {
+            if (pooled.first == ptr) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     mutable std::shared_mutex mutex_;
     std::map<std::string, Var> data_;
+    // the buffers of the ResultBufferPool and their bytes, released to the pool instead of deleted
+    std::vector<std::pair<const void*, size_t>> pooled_;
     bool is_owner = true;
     bool is_sparse = false;
 };
@@ -395,6 +445,17 @@ GenResultDataSet(const int64_t nq, const int64_t topk, std::unique_ptr<long long
     return ret_ds;
 }
 
+inline DataSetPtr
+GenResultDataSet(const int64_t nq, const int64_t topk, ResultBuffer<int64_t>&& ids, ResultBuffer<float>&& distance) {
+    auto ret_ds = std::make_shared<DataSet>();
+    ret_ds->SetRows(nq);
+    ret_ds->SetDim(topk);
+    ret_ds->SetIds(std::move(ids));
+    ret_ds->SetDistance(std::move(distance));
+    ret_ds->SetIsOwner(true);
+    return ret_ds;
+}
+
 inline DataSetPtr
 #ifdef NOT_COMPILE_FOR_SWIG
 GenResultDataSet(const int64_t nq, const int64_t* ids, const float* distance, const size_t* lims) {
@@ -52,6 +52,7 @@ enum class Status {
     brute_force_inner_error = 30,
     emb_list_inner_error = 31,
     aisaq_error = 32,
+    resource_exhausted = 33,
 };
 
 inline std::string
@@ -111,6 +112,8 @@ Status2String(knowhere::Status status) {
             return "brute_force inner error";
         case knowhere::Status::aisaq_error:
             return "internal AiSAQ error";
+        case knowhere::Status::resource_exhausted:
+            return "resource exhausted";
         default:
             return "unexpected status";
     }
@@ -0,0 +1,48 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace knowhere {
+
+// The group of every row of an index for a group-by search (@see Index::GroupBySearch), looked up by the id of the
+// row: either an array of the group ids of the rows, or a callback for the columns that are not stored as one. The
+// array and whatever the callback refers to must outlive the search.
+class GroupByColumn {
+ public:
+    GroupByColumn(const int64_t* group_ids, const int64_t rows) : group_ids_(group_ids), rows_(rows) {
+    }
+
+    explicit GroupByColumn(std::function<int64_t(int64_t)> accessor) : accessor_(std::move(accessor)) {
+    }
+
+    int64_t
+    operator()(const int64_t id) const {
+        return (group_ids_ != nullptr) ? group_ids_[id] : accessor_(id);
+    }
+
+    // whether the column covers the rows [0, rows), which a callback is assumed to do
+    bool
+    Covers(const int64_t rows) const {
+        return (group_ids_ != nullptr) ? rows_ >= rows : static_cast<bool>(accessor_);
+    }
+
+ private:
+    const int64_t* group_ids_ = nullptr;
+    int64_t rows_ = 0;
+    std::function<int64_t(int64_t)> accessor_;
+};
+
+}  // namespace knowhere
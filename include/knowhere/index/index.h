@@ -13,6 +13,7 @@
 #define INDEX_H
 
 #include "knowhere/binaryset.h"
+#include "knowhere/comp/result_cache.h"
 #include "knowhere/config.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
@@ -20,6 +21,31 @@
 #include "knowhere/index/interrupt.h"
 namespace knowhere {
 
+// A search config loaded and checked once, for the searches of an index type that repeat the same params. It is
+// immutable and may be shared by the threads that search with it, each search works on a copy of it.
+class PreparedSearchConfig {
+ public:
+    PreparedSearchConfig(std::string index_type, std::unique_ptr<BaseConfig> cfg)
+        : index_type_(std::move(index_type)), cfg_(std::move(cfg)) {
+    }
+
+    const std::string&
+    IndexType() const {
+        return index_type_;
+    }
+
+    const BaseConfig&
+    Get() const {
+        return *cfg_;
+    }
+
+ private:
+    std::string index_type_;
+    std::unique_ptr<BaseConfig> cfg_;
+};
+
+using PreparedSearchConfigPtr = std::shared_ptr<const PreparedSearchConfig>;
+
 template <typename T1>
 class Index {
  public:
@@ -157,9 +183,68 @@ class Index {
     Status
     Add(const DataSetPtr dataset, const Json& json, bool use_knowhere_build_pool = true);
 
+    Status
+    Delete(const DataSetPtr dataset, const Json& json, bool use_knowhere_build_pool = true);
+
+    // merges the rows of other into this index, except those of bitset (@see IndexNode::Merge)
+    Status
+    Merge(const Index<T1>& other, const BitsetView& bitset, const Json& json, bool use_knowhere_build_pool = true);
+
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const;
 
+    // searches into buffers of nq * k ids and distances owned by the caller, the result refers to them
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, const Json& json, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const;
+
+    // Loads and checks the search params of json once for this index type, to be reused by the searches below
+    // rather than parsing the same json for every search.
+    expected<PreparedSearchConfigPtr>
+    PrepareSearchConfig(const Json& json) const;
+
+    // Searches with a prepared config. k overrides the k of the config when it is > 0: it may not exceed the k the
+    // config was prepared with, the params that depend on k (e.g. ef) being checked against it.
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, const PreparedSearchConfig& cfg, const BitsetView& bitset, int32_t k = 0) const;
+
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, const PreparedSearchConfig& cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances, int32_t k = 0) const;
+
+    // an index of a fan-out search, with the bitset of its rows and the offset added to its ids in the result
+    struct SearchTarget {
+        Index<T1> index;
+        BitsetView bitset;
+        int64_t id_offset = 0;
+    };
+
+    // Searches all the targets with the same queries and config, and returns a single top-k per query over all of
+    // them. The targets are searched concurrently rather than one after another, and the results are merged into
+    // one dataset. The targets are to share the metric type, the first error of a target is returned.
+    static expected<DataSetPtr>
+    SearchFanOut(const std::vector<SearchTarget>& targets, const DataSetPtr dataset, const Json& json);
+
+    // an index of a hybrid search, with its queries and the json of their search
+    struct HybridTarget {
+        Index<T1> index;
+        DataSetPtr dataset;
+        Json json;
+    };
+
+    // Searches a dense and a sparse index over the same rows at once, with their own queries and json and the same
+    // bitset, and fuses their results into a single top-k per query, of the fused scores from the highest one. The
+    // fusion is set by json: k, hybrid_fusion (RRF or WEIGHTED), hybrid_candidates (the results fetched from each
+    // search, k by default), rrf_k, dense_weight and sparse_weight.
+    static expected<DataSetPtr>
+    HybridSearch(const HybridTarget& dense, const HybridTarget& sparse, const Json& json, const BitsetView& bitset);
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+    // the index and the data behind the bitset must outlive the returned future
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchAsync(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const;
+#endif
+
     expected<std::vector<IndexNode::IteratorPtr>>
     AnnIterator(const DataSetPtr dataset, const Json& json, const BitsetView& bitset,
                 bool use_knowhere_search_pool = true) const;
@@ -167,9 +252,36 @@ class Index {
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const;
 
+    // Searches the k groups of column with the nearest rows to each query, with up to group_size (of json) nearest
+    // rows each: k * group_size results per query, the groups from the nearest one, the missing rows as -1. column
+    // has to cover all the rows of the index.
+    expected<DataSetPtr>
+    GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column, const Json& json,
+                  const BitsetView& bitset) const;
+
     expected<DataSetPtr>
     GetVectorByIds(const DataSetPtr dataset) const;
 
+    // Caches the top-k results of up to capacity queries of Search(dataset, json, bitset), keyed by the query vector,
+    // the json and the bitset, for the repeated queries to skip their search. The cache is dropped on Build, Train,
+    // Add, Delete and Deserialize. The fp32 queries are keyed by their elements rounded to multiples of key_step if it
+    // is > 0, for the nearly identical queries to share their results. A capacity of 0 disables the cache. The
+    // searches asking for search stats, and those of sparse and embedding list queries, are not cached.
+    template <typename DataType>
+    Status
+    EnableResultCache(size_t capacity, float key_step = 0.0f) {
+        if (node == nullptr) {
+            return Status::empty_index;
+        }
+        if (key_step < 0.0f || (key_step > 0.0f && !std::is_same_v<DataType, fp32>)) {
+            return Status::invalid_args;
+        }
+        node->SetResultCache(capacity == 0 ? nullptr
+                                           : std::make_shared<SearchResultCache>(capacity, datatype_v<DataType>,
+                                                                                 key_step));
+        return Status::success;
+    }
+
     bool
     HasRawData(const std::string& metric_type) const;
 
@@ -182,18 +294,34 @@ class Index {
     Status
     Serialize(BinarySet& binset) const;
 
+    Status
+    SerializeToFile(const std::string& filename) const;
+
     Status
     Deserialize(const BinarySet& binset, const Json& json = {});
 
     Status
     DeserializeFromFile(const std::string& filename, const Json& json = {});
 
+    Status
+    Warmup(WarmupLevel level = WarmupLevel::FULL, const WarmupProgress& progress = nullptr);
+
+    Status
+    Cooldown();
+
     int64_t
     Dim() const;
 
     int64_t
     Size() const;
 
+    expected<MemoryReport>
+    GetMemoryReport() const;
+
+    // exports the memory report of the index as the gauges of index_id (@see ExportMemoryReport)
+    Status
+    ExportMemoryReport(const std::string& index_id) const;
+
     int64_t
     Count() const;
 
@@ -218,6 +346,30 @@ class Index {
         static_assert(std::is_base_of<IndexNode, T1>::value);
     }
 
+    // builds the index once the build is admitted by the build scheduler
+    Status
+    BuildAdmitted(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool);
+
+    // the copy of a prepared config for a search, with its k overridden
+    expected<std::unique_ptr<BaseConfig>>
+    CopyPreparedSearchConfig(const PreparedSearchConfig& cfg, int32_t k) const;
+
+    // searches the queries missed by the result cache, and caches their results
+    expected<DataSetPtr>
+    SearchCached(SearchResultCache& cache, const DataSetPtr dataset, const Json& json, std::unique_ptr<BaseConfig> cfg,
+                 const BitsetView& bitset) const;
+
+    void
+    ClearResultCache() const;
+
+    // searches with a loaded config
+    expected<DataSetPtr>
+    SearchLoaded(const DataSetPtr dataset, std::unique_ptr<BaseConfig> cfg, const BitsetView& bitset) const;
+
+    expected<DataSetPtr>
+    SearchWithBufLoaded(const DataSetPtr dataset, std::unique_ptr<BaseConfig> cfg, const BitsetView& bitset,
+                        int64_t* ids, float* distances) const;
+
     T1* node;
 };
 
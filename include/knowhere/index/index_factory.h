@@ -49,6 +49,14 @@ class IndexFactory {
     static GlobalIndexTable&
     StaticIndexTableInstance();
 
+    // queues a registrar of the registration macros, returns true for the macros to initialize a global with
+    static bool
+    Defer(void (*registrar)());
+
+    // runs the registrars queued so far, called by the lookups of the factory and of IndexStaticFaced
+    static void
+    RunDeferred();
+
  private:
     struct FunMapValueBase {
         virtual ~FunMapValueBase() = default;
@@ -70,17 +78,55 @@ class IndexFactory {
     static FeatureMap&
     FeatureMapInstance();
 };
+// The data types left out of the build by KNOWHERE_DISABLE_<DATA TYPE> (see the KNOWHERE_DATA_TYPES build option):
+// their registrations expand to nothing, so that the index nodes of these types are not even instantiated.
+#ifdef KNOWHERE_DISABLE_FP32
+#define KNOWHERE_IF_DATA_TYPE_fp32(...)
+#else
+#define KNOWHERE_IF_DATA_TYPE_fp32(...) __VA_ARGS__
+#endif
+#ifdef KNOWHERE_DISABLE_FP16
+#define KNOWHERE_IF_DATA_TYPE_fp16(...)
+#else
+#define KNOWHERE_IF_DATA_TYPE_fp16(...) __VA_ARGS__
+#endif
+#ifdef KNOWHERE_DISABLE_BF16
+#define KNOWHERE_IF_DATA_TYPE_bf16(...)
+#else
+#define KNOWHERE_IF_DATA_TYPE_bf16(...) __VA_ARGS__
+#endif
+#ifdef KNOWHERE_DISABLE_BIN1
+#define KNOWHERE_IF_DATA_TYPE_bin1(...)
+#else
+#define KNOWHERE_IF_DATA_TYPE_bin1(...) __VA_ARGS__
+#endif
+#ifdef KNOWHERE_DISABLE_INT8
+#define KNOWHERE_IF_DATA_TYPE_int8(...)
+#else
+#define KNOWHERE_IF_DATA_TYPE_int8(...) __VA_ARGS__
+#endif
+#define KNOWHERE_IF_DATA_TYPE(data_type, ...) KNOWHERE_IF_DATA_TYPE_##data_type(__VA_ARGS__)
+
+// The registrations are lazy: at static init, a registration only queues its registrar, and the queued registrars run
+// on the first lookup of an index type (@see IndexFactory::RunDeferred).
+
 // register the index adapter corresponding to indexType
 #define KNOWHERE_FACTOR_CONCAT(x, y) index_factory_ref_##x##y
-#define KNOWHERE_REGISTER_GLOBAL(name, func, data_type, condition, features) \
-    const IndexFactory& KNOWHERE_FACTOR_CONCAT(name, data_type) =            \
-        condition ? IndexFactory::Instance().Register<data_type>(#name, func, features) : IndexFactory::Instance();
+#define KNOWHERE_REGISTER_GLOBAL(name, func, data_type, condition, features)                             \
+    KNOWHERE_IF_DATA_TYPE(data_type,                                                                     \
+                          const bool KNOWHERE_FACTOR_CONCAT(name, data_type) = IndexFactory::Defer([]() { \
+                              if (condition) {                                                           \
+                                  IndexFactory::Instance().Register<data_type>(#name, func, features);   \
+                              }                                                                          \
+                          });)
 
 // register some static methods that are bound to indexType
 #define KNOWHERE_STATIC_CONCAT(x, y) index_static_ref_##x##y
-#define KNOWHERE_REGISTER_STATIC(name, index_node, data_type, ...)               \
-    const IndexStaticFaced<data_type>& KNOWHERE_STATIC_CONCAT(name, data_type) = \
-        IndexStaticFaced<data_type>::Instance().RegisterStaticFunc<index_node<data_type, ##__VA_ARGS__>>(#name);
+#define KNOWHERE_REGISTER_STATIC(name, index_node, data_type, ...)                                               \
+    KNOWHERE_IF_DATA_TYPE(                                                                                       \
+        data_type, const bool KNOWHERE_STATIC_CONCAT(name, data_type) = IndexFactory::Defer([]() {               \
+            IndexStaticFaced<data_type>::Instance().RegisterStaticFunc<index_node<data_type, ##__VA_ARGS__>>(#name); \
+        });)
 
 // register the index implementation along with its associated features. Please carefully check the types and features
 // supported by the index—both need to be consistent, otherwise the registration will be skipped
@@ -12,16 +12,24 @@
 #ifndef INDEX_NODE_H
 #define INDEX_NODE_H
 
+#include <algorithm>
+#include <cstdio>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <queue>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "knowhere/binaryset.h"
 #include "knowhere/bitsetview.h"
+#include "knowhere/comp/memory_report.h"
+#include "knowhere/comp/warmup.h"
 #include "knowhere/config.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
+#include "knowhere/group_by.h"
 #include "knowhere/object.h"
 #include "knowhere/operands.h"
 #include "knowhere/range_util.h"
@@ -29,12 +37,19 @@
 #include "knowhere/version.h"
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+#include "folly/futures/Future.h"
 #include "knowhere/comp/task.h"
 #endif
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT) && defined(KNOWHERE_WITH_COROUTINES)
+#include "folly/experimental/coro/BlockingWait.h"
+#include "folly/experimental/coro/Collect.h"
+#include "folly/experimental/coro/Task.h"
+#endif
 
 namespace knowhere {
 
 class Interrupt;
+class SearchResultCache;
 
 class IndexNode : public Object {
  public:
@@ -83,6 +98,20 @@ class IndexNode : public Object {
     }
 #endif
 
+    /**
+     * @brief Estimates the peak memory of building the index on the dataset, for the admission of the build under
+     * the build memory budget (@see KnowhereConfig::SetBuildMemoryBudget).
+     *
+     * @param dataset Dataset to build the index from.
+     * @param cfg The loaded build config.
+     * @return The estimated bytes. By default, twice the bytes of the float vectors, the data and a copy of it.
+     * @note This method doesn't have to be very accurate, but should rather overestimate.
+     */
+    virtual int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const {
+        return 2 * DataSetBytes<fp32>(dataset);
+    }
+
     /**
      * @brief Trains the index model using the provided dataset and configuration.
      *
@@ -120,6 +149,48 @@ class IndexNode : public Object {
     virtual Status
     Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool = true) = 0;
 
+    /**
+     * @brief Deletes rows from the index.
+     *
+     * @param dataset The ids of the rows to delete (@see DataSet::GetIds), as many as @see DataSet::GetRows.
+     * @param cfg
+     * @return Status
+     *
+     * @note
+     * 1. The deleted rows are no longer returned by @see Search, @see RangeSearch and @see AnnIterator, the ids of the
+     * other rows do not change. Deleting a row twice has no effect.
+     * 2. This interface is only available for the indexes that support it, the others return
+     * Status::not_implemented.
+     * 3. Unlike @see Add, this method is not thread safe when called with the search methods.
+     */
+    virtual Status
+    Delete(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool = true) {
+        return Status::not_implemented;
+    }
+
+    /**
+     * @brief Merges the rows of another index of the same type into this index, as an alternative to building the
+     * index of their union, e.g. to compact two sealed segments.
+     *
+     * @param other The index to merge, which is not modified.
+     * @param bitset The rows to drop, by the ids of this index followed by the ones of other shifted by @see Count.
+     * @param cfg
+     * @return Status
+     *
+     * @note
+     * 1. The remaining rows of this index keep their order, followed by the remaining rows of other, and are
+     * renumbered from 0.
+     * 2. This interface is only available for the indexes that support it, the others return
+     * Status::not_implemented, and so do the indexes that can not be merged, e.g. with different parameters. The
+     * index of the union is to be built instead.
+     * 3. Like @see Delete, this method is not thread safe when called with the search methods.
+     */
+    virtual Status
+    Merge(const IndexNode& other, const BitsetView& bitset, std::shared_ptr<Config> cfg,
+          bool use_knowhere_build_pool = true) {
+        return Status::not_implemented;
+    }
+
     /**
      * @brief Performs a search operation on the index.
      *
@@ -133,6 +204,55 @@ class IndexNode : public Object {
     virtual expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const = 0;
 
+    /**
+     * @brief Performs a search operation on the index, writing the results into buffers owned by the caller.
+     *
+     * @param dataset Query vectors.
+     * @param cfg
+     * @param bitset A BitsetView object for filtering results.
+     * @param ids Buffer of nq * k ids, filled with the results.
+     * @param distances Buffer of nq * k distances, filled with the results.
+     * @return An expected<> object containing a result dataset that refers to the buffers without owning them, or
+     * an error.
+     * @note The default implementation runs @see Search and copies its results into the buffers, the indexes that
+     * search into the buffers directly override it, and implement @see Search with @see SearchWithNewBuf.
+     */
+    virtual expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const {
+        auto res = Search(dataset, std::move(cfg), bitset);
+        if (!res.has_value()) {
+            return res;
+        }
+        const auto len = res.value()->GetRows() * res.value()->GetDim();
+        std::copy_n(res.value()->GetIds(), len, ids);
+        std::copy_n(res.value()->GetDistance(), len, distances);
+        auto buf_res = GenResultDataSet(res.value()->GetRows(), res.value()->GetDim(), ids, distances);
+        buf_res->SetIsOwner(false);
+        if (const auto stats = res.value()->GetSearchStats(); stats != nullptr) {
+            buf_res->SetSearchStats(SearchStats(*stats));
+        }
+        return buf_res;
+    }
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+    /**
+     * @brief Performs a search operation on the index without blocking the calling thread.
+     *
+     * @param dataset Query vectors.
+     * @param cfg
+     * @param bitset A BitsetView object for filtering results.
+     * @return A future of the search results or an error, which completes once all the queries are done.
+     * @note The index and the data behind the bitset must outlive the future. The default implementation runs @see
+     * Search on the calling thread and returns a completed future, the disk indexes run the queries on the search
+     * thread pool instead.
+     */
+    virtual folly::SemiFuture<expected<DataSetPtr>>
+    SearchAsync(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const {
+        return folly::makeSemiFuture(Search(dataset, std::move(cfg), bitset));
+    }
+#endif
+
     /**
      * @brief Performs a brute-force search operation on the index for given labels. (for emb-list based index)
      *
@@ -148,6 +268,25 @@ class IndexNode : public Object {
                                          "BruteForceByIDs not supported for current index type");
     };
 
+    /**
+     * @brief Performs a group-by search: the k groups with the nearest rows to each query, with up to group_size of
+     * their nearest rows each, the group of a row being looked up through column.
+     *
+     * @param dataset Query vectors.
+     * @param column The group of every row of the index, by its id.
+     * @param cfg
+     * @param bitset A BitsetView object for filtering results.
+     * @return An expected<> object containing k * group_size results per query or an error. The results of a query
+     * are ordered by group, from the group of the nearest row, and within a group from the nearest row. The slots of
+     * the missing rows hold id -1.
+     */
+    virtual expected<DataSetPtr>
+    GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column, std::unique_ptr<Config> cfg,
+                  const BitsetView& bitset) const {
+        return expected<DataSetPtr>::Err(Status::not_implemented,
+                                         "group-by search not supported for current index type");
+    }
+
     // not thread safe.
     class iterator {
      public:
@@ -155,11 +294,122 @@ class IndexNode : public Object {
         Next() = 0;
         [[nodiscard]] virtual bool
         HasNext() = 0;
+        // Writes up to n next results to ids and dists, in the order Next() would return them, and returns the
+        //   number of written results. A value smaller than n means that the iterator is exhausted.
+        virtual size_t
+        NextBatch(size_t n, int64_t* ids, float* dists) {
+            size_t i = 0;
+            for (; i < n && HasNext(); i++) {
+                std::tie(ids[i], dists[i]) = Next();
+            }
+            return i;
+        }
+        // Runs the initial search of the iterator now rather than on the first call of Next(), HasNext() or
+        //   NextBatch(), e.g. to seed the iterators of all the queries in one parallel pass. Does nothing for an
+        //   iterator that is initialized already or has no initial search.
+        virtual void
+        Initialize() {
+        }
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT) && defined(KNOWHERE_WITH_COROUTINES)
+        // A coroutine version of NextBatch(), which runs it on the search thread pool and suspends the awaiting
+        //   coroutine rather than blocking its thread. The work the iterator schedules on the search pool itself runs
+        //   inline in that task.
+        virtual folly::coro::Task<size_t>
+        NextBatchAsync(size_t n, int64_t* ids, float* dists) {
+            size_t res = 0;
+            co_await SubmitToSearchThreadPool([&]() { res = NextBatch(n, ids, dists); });
+            co_return res;
+        }
+#endif
         virtual ~iterator() {
         }
     };
     using IteratorPtr = std::shared_ptr<iterator>;
 
+    // Reads the results of an iterator one by one, fetching them with NextBatch() in batches of growing size, so that
+    //   a consumer that stops early does not make the iterator expand its search much further than needed.
+    class IteratorBatchReader {
+     public:
+        static constexpr size_t kMinBatchSize = 16;
+        static constexpr size_t kMaxBatchSize = 512;
+
+        explicit IteratorBatchReader(iterator* it) : it_(it) {
+        }
+
+        // the next batches will not fetch more than n results
+        void
+        limit(size_t n) {
+            limit_ = n;
+        }
+
+        bool
+        next(int64_t& id, float& dist) {
+            if (pos_ == size_) {
+                const size_t n = prepare_batch();
+                if (n == 0 || !finish_batch(n, it_->NextBatch(n, ids_.data(), dists_.data()))) {
+                    return false;
+                }
+            }
+            id = ids_[pos_];
+            dist = dists_[pos_];
+            pos_++;
+            return true;
+        }
+
+        // whether next() returns a result without fetching a batch
+        bool
+        buffered() const {
+            return pos_ < size_;
+        }
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT) && defined(KNOWHERE_WITH_COROUTINES)
+        // fetches the next batch with NextBatchAsync(), returns whether next() has a result to return
+        folly::coro::Task<bool>
+        co_fetch() {
+            if (buffered()) {
+                co_return true;
+            }
+            const size_t n = prepare_batch();
+            if (n == 0) {
+                co_return false;
+            }
+            const size_t size = co_await it_->NextBatchAsync(n, ids_.data(), dists_.data());
+            co_return finish_batch(n, size);
+        }
+#endif
+
+     private:
+        // returns the size of the next batch, 0 if there is none
+        size_t
+        prepare_batch() {
+            const size_t n = std::min(batch_size_, limit_);
+            if (exhausted_ || n == 0) {
+                return 0;
+            }
+            ids_.resize(n);
+            dists_.resize(n);
+            return n;
+        }
+
+        bool
+        finish_batch(size_t n, size_t size) {
+            size_ = size;
+            pos_ = 0;
+            exhausted_ = (size_ < n);
+            batch_size_ = std::min(batch_size_ * 2, kMaxBatchSize);
+            return size_ != 0;
+        }
+
+        iterator* it_;
+        std::vector<int64_t> ids_;
+        std::vector<float> dists_;
+        size_t pos_ = 0;
+        size_t size_ = 0;
+        size_t batch_size_ = kMinBatchSize;
+        size_t limit_ = std::numeric_limits<size_t>::max();
+        bool exhausted_ = false;
+    };
+
     virtual expected<std::vector<IteratorPtr>>
     AnnIterator(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset,
                 bool use_knowhere_search_pool = true) const {
@@ -211,17 +461,14 @@ class IndexNode : public Object {
         LOG_KNOWHERE_DEBUG_ << "range_search_k: " << range_search_k;
         if (range_search_k == 0) {
             auto nq = dataset->GetRows();
-            std::vector<std::vector<int64_t>> result_id_array(nq);
-            std::vector<std::vector<float>> result_dist_array(nq);
-            auto range_search_result = GetRangeSearchResult(result_dist_array, result_id_array, the_larger_the_closer,
-                                                            nq, further_bound, closer_bound);
-            return GenResultDataSet(nq, std::move(range_search_result));
+            return GenResultDataSet(nq, RangeSearchResultArena(nq).Finish());
         }
 
-        // The range_search function has utilized the search_pool to concurrently handle various queries.
-        // To prevent potential deadlocks, the iterator for a single query no longer requires additional thread
-        //   control over the next() call.
-        auto its_or = AnnIterator(dataset, std::move(cfg), bitset, false);
+        // The queries read their iterators concurrently. With coroutines, each batch of results runs as a task of its
+        //   own on the search pool, awaited by a coroutine of the calling thread that filters the results. Otherwise
+        //   each query runs as a task, in which the iterator runs its work inline. Either way no thread of the pool
+        //   waits on another one.
+        auto its_or = AnnIterator(dataset, std::move(cfg), bitset);
         if (!its_or.has_value()) {
             return expected<DataSetPtr>::Err(its_or.error(),
                                              "RangeSearch failed due to AnnIterator failure: " + its_or.what());
@@ -229,33 +476,40 @@ class IndexNode : public Object {
 
         const auto its = its_or.value();
         const auto nq = its.size();
-        std::vector<std::vector<int64_t>> result_id_array(nq);
-        std::vector<std::vector<float>> result_dist_array(nq);
+        RangeSearchResultArena arena(nq);
 
         const bool retain_iterator_order = base_cfg.retain_iterator_order.value();
         LOG_KNOWHERE_DEBUG_ << "retain_iterator_order: " << retain_iterator_order;
 
+        // a consumer of the results of a query, which returns whether to read more of them
+        using Consumer = std::function<bool(RangeSearchResultArena::Writer&, int64_t, float)>;
+
         /**
          * use ordered iterator (retain_iterator_order == true)
          * - terminate iterator if next distance exceeds `further_bound`.
          * - terminate iterator if get enough results. (`range_search_k`)
          * */
-        auto task_with_ordered_iterator = [&](size_t idx) {
-            auto it = its[idx];
-            while (it->HasNext()) {
-                auto [id, dist] = it->Next();
+        auto ordered_consumer = [&](IteratorBatchReader& reader) -> Consumer {
+            if (range_search_k >= 0) {
+                // do not read results past the last one that may be needed
+                reader.limit(static_cast<size_t>(range_search_k));
+            }
+            return [&](RangeSearchResultArena::Writer& writer, int64_t id, float dist) {
                 if (has_closer_bound && too_close(dist)) {
-                    continue;
+                    return true;
                 }
                 if (same_or_too_far(dist)) {
-                    break;
+                    return false;
                 }
-                result_id_array[idx].push_back(id);
-                result_dist_array[idx].push_back(dist);
-                if (range_search_k >= 0 && static_cast<int32_t>(result_id_array[idx].size()) >= range_search_k) {
-                    break;
+                writer.Add(id, dist);
+                if (range_search_k >= 0) {
+                    if (static_cast<int32_t>(writer.Size()) >= range_search_k) {
+                        return false;
+                    }
+                    reader.limit(static_cast<size_t>(range_search_k) - writer.Size());
                 }
-            }
+                return true;
+            };
         };
 
         /**
@@ -265,30 +519,21 @@ class IndexNode : public Object {
          * */
         const auto range_search_level = base_cfg.range_search_level.value();  // from 0 to 0.5
         LOG_KNOWHERE_DEBUG_ << "range_search_level: " << range_search_level;
-        auto task_with_unordered_iterator = [&](size_t idx) {
+        auto unordered_consumer = [&]() -> Consumer {
             // max-heap, use top (the current kth-furthest dist) as the further_bound if size == range_search_k
             std::priority_queue<float, std::vector<float>, decltype(is_first_closer)> early_stop_further_bounds(
                 is_first_closer);
-            auto it = its[idx];
-            size_t num_next = 0;
-            size_t num_consecutive_over_further_bound = 0;
-            float tighter_further_bound = base_cfg.radius.value();
-            auto same_or_too_far = [&is_first_closer, &tighter_further_bound](float dist) {
-                return !is_first_closer(dist, tighter_further_bound);
-            };
-            while (it->HasNext()) {
-                auto [id, dist] = it->Next();
+            return [&, early_stop_further_bounds = std::move(early_stop_further_bounds), num_next = size_t(0),
+                    num_consecutive_over_further_bound = size_t(0), tighter_further_bound = base_cfg.radius.value()](
+                       RangeSearchResultArena::Writer& writer, int64_t id, float dist) mutable {
                 num_next++;
                 if (has_closer_bound && too_close(dist)) {
-                    continue;
+                    return true;
                 }
-                if (same_or_too_far(dist)) {
+                if (!is_first_closer(dist, tighter_further_bound)) {
                     num_consecutive_over_further_bound++;
-                    if (num_consecutive_over_further_bound >
-                        static_cast<size_t>(std::ceil(num_next * range_search_level))) {
-                        break;
-                    }
-                    continue;
+                    return num_consecutive_over_further_bound <=
+                           static_cast<size_t>(std::ceil(num_next * range_search_level));
                 }
                 if (range_search_k > 0) {
                     if (static_cast<int32_t>(early_stop_further_bounds.size()) < range_search_k) {
@@ -300,44 +545,65 @@ class IndexNode : public Object {
                     }
                 }
                 num_consecutive_over_further_bound = 0;
-                result_id_array[idx].push_back(id);
-                result_dist_array[idx].push_back(dist);
+                writer.Add(id, dist);
+                return true;
+            };
+        };
+        auto make_consumer = [&](IteratorBatchReader& reader) {
+            return retain_iterator_order ? ordered_consumer(reader) : unordered_consumer();
+        };
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT) && defined(KNOWHERE_WITH_COROUTINES)
+        auto read_query = [&](size_t idx) -> folly::coro::Task<void> {
+            IteratorBatchReader reader(its[idx].get());
+            auto consume = make_consumer(reader);
+            auto writer = arena.GetWriter(idx);
+            int64_t id;
+            float dist;
+            bool more = true;
+            while (more && co_await reader.co_fetch()) {
+                while (more && reader.buffered()) {
+                    reader.next(id, dist);
+                    more = consume(writer, id, dist);
+                }
+            }
+        };
+        std::vector<folly::coro::Task<void>> tasks;
+        tasks.reserve(nq);
+        for (size_t i = 0; i < nq; i++) {
+            tasks.emplace_back(read_query(i));
+        }
+        // every query in flight holds a writer, and the chunks of its results, open
+        const size_t max_queries_in_flight = 2 * std::max<size_t>(1, GetSearchThreadPoolSize());
+        folly::coro::blockingWait(folly::coro::collectAllWindowed(std::move(tasks), max_queries_in_flight));
+#else
+        auto read_query = [&](size_t idx) {
+            IteratorBatchReader reader(its[idx].get());
+            auto consume = make_consumer(reader);
+            auto writer = arena.GetWriter(idx);
+            int64_t id;
+            float dist;
+            while (reader.next(id, dist) && consume(writer, id, dist)) {
             }
         };
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
-        std::vector<folly::Future<folly::Unit>> futs;
+        // the iterators run their work inline in the tasks of the search pool
+        std::vector<folly::SemiFuture<folly::Unit>> futs;
         futs.reserve(nq);
-        if (retain_iterator_order) {
-            for (size_t i = 0; i < nq; i++) {
-                futs.emplace_back(ThreadPool::GetGlobalSearchThreadPool()->push([&, idx = i]() {
-                    ThreadPool::ScopedSearchOmpSetter setter(1);
-                    task_with_ordered_iterator(idx);
-                }));
-            }
-        } else {
-            for (size_t i = 0; i < nq; i++) {
-                futs.emplace_back(ThreadPool::GetGlobalSearchThreadPool()->push([&, idx = i]() {
-                    ThreadPool::ScopedSearchOmpSetter setter(1);
-                    task_with_unordered_iterator(idx);
-                }));
-            }
+        for (size_t i = 0; i < nq; i++) {
+            futs.emplace_back(SubmitToSearchThreadPool([&, idx = i]() { read_query(idx); }));
+        }
+        for (auto& result : folly::collectAll(futs.begin(), futs.end()).get()) {
+            result.throwUnlessValue();
         }
-        WaitAllSuccess(futs);
 #else
-        if (retain_iterator_order) {
-            for (size_t i = 0; i < nq; i++) {
-                task_with_ordered_iterator(i);
-            }
-        } else {
-            for (size_t i = 0; i < nq; i++) {
-                task_with_unordered_iterator(i);
-            }
+        for (size_t i = 0; i < nq; i++) {
+            read_query(i);
         }
+#endif
 #endif
 
-        auto range_search_result = GetRangeSearchResult(result_dist_array, result_id_array, the_larger_the_closer, nq,
-                                                        further_bound, closer_bound);
-        return GenResultDataSet(nq, std::move(range_search_result));
+        ScopedSearchStage stage(SearchStage::RESULT_ASSEMBLY);
+        return GenResultDataSet(nq, arena.Finish());
     }
 
     /**
@@ -386,6 +652,34 @@ class IndexNode : public Object {
     virtual Status
     Serialize(BinarySet& binset) const = 0;
 
+    /**
+     * @brief Serializes the index to a file that DeserializeFromFile() loads.
+     *
+     * The default implementation writes the binary of Serialize(), for the indexes of a single binary. The indexes
+     * that override it stream their serialized data to the file through a bounded buffer, without holding all of it
+     * in memory.
+     *
+     * @param filename Path to the file to write.
+     * @return Status indicating success or failure of the serialization.
+     */
+    virtual Status
+    SerializeToFile(const std::string& filename) const {
+        BinarySet binset;
+        RETURN_IF_ERROR(Serialize(binset));
+        auto binary = binset.GetByName(Type());
+        if (binary == nullptr || binset.binary_map_.size() != 1) {
+            LOG_KNOWHERE_ERROR_ << Type() << " does not support SerializeToFile";
+            return Status::not_implemented;
+        }
+        std::unique_ptr<FILE, decltype(&std::fclose)> file(std::fopen(filename.c_str(), "wb"), &std::fclose);
+        if (file == nullptr || std::fwrite(binary->data.get(), 1, binary->size, file.get()) != binary->size ||
+            std::fclose(file.release()) != 0) {
+            LOG_KNOWHERE_ERROR_ << "Failed to write " << filename;
+            return Status::disk_file_error;
+        }
+        return Status::success;
+    }
+
     /**
      * @brief Deserializes the index from a binary set.
      *
@@ -415,6 +709,33 @@ class IndexNode : public Object {
     virtual Status
     DeserializeFromFile(const std::string& filename, std::shared_ptr<Config> config) = 0;
 
+    /**
+     * @brief Loads the data of a deserialized index into memory before it serves searches, so that the first searches
+     * do not fault it in.
+     *
+     * The indexes mapped from files prefetch their mapped data in parallel over the build thread pool. The data of the
+     * indexes loaded in memory is resident already.
+     *
+     * @param level HOT for the structures that every search goes through, FULL for all the data.
+     * @param progress Called with the bytes warmed up so far and in all, may be empty.
+     * @return Status::not_implemented if the index does not support warming up.
+     */
+    virtual Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) {
+        return Status::not_implemented;
+    }
+
+    /**
+     * @brief Releases the memory of the data that the index maps from files, which is read back from them as the
+     * searches access it. The data of the indexes loaded in memory stays.
+     *
+     * @return Status::not_implemented if the index does not support cooling down.
+     */
+    virtual Status
+    Cooldown() {
+        return Status::not_implemented;
+    }
+
     virtual std::unique_ptr<BaseConfig>
     CreateConfig() const = 0;
 
@@ -437,6 +758,19 @@ class IndexNode : public Object {
     virtual int64_t
     Size() const = 0;
 
+    /**
+     * @brief Gets the memory of the index by component: the bytes that it allocated and the bytes that it maps from
+     * files, of which the resident ones, for the capacity planning and the eviction of the indexes.
+     *
+     * @return The memory report. By default, Size() as the heap bytes of MemoryComponent::OTHER, an estimate.
+     */
+    virtual expected<MemoryReport>
+    GetMemoryReport() const {
+        MemoryReport report;
+        report.AddHeap(MemoryComponent::OTHER, std::max<int64_t>(Size(), 0));
+        return report;
+    }
+
     /**
      * @brief Gets the number of vectors in the index.
      *
@@ -475,11 +809,50 @@ class IndexNode : public Object {
         return false;
     }
 
+    // The home NUMA node of the index, where its data was loaded and its searches run in NUMA mode, -1 for none.
+    int
+    NumaNode() const {
+        return numa_node_;
+    }
+
+    void
+    SetNumaNode(int node) {
+        numa_node_ = node;
+    }
+
+    // The cache of the search results of the index, nullptr if disabled (@see Index::EnableResultCache).
+    std::shared_ptr<SearchResultCache>
+    ResultCache() const {
+        return std::atomic_load(&result_cache_);
+    }
+
+    void
+    SetResultCache(std::shared_ptr<SearchResultCache> cache) {
+        std::atomic_store(&result_cache_, std::move(cache));
+    }
+
     virtual ~IndexNode() {
     }
 
  protected:
+    // Search for the indexes that override SearchWithBuf, into buffers that are handed over to the result.
+    expected<DataSetPtr>
+    SearchWithNewBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const {
+        const auto len = dataset->GetRows() * static_cast<const BaseConfig&>(*cfg).k.value();
+        auto ids = AllocateResultBuffer<int64_t>(len);
+        auto distances = AllocateResultBuffer<float>(len);
+        auto res = SearchWithBuf(dataset, std::move(cfg), bitset, ids.get(), distances.get());
+        if (res.has_value()) {
+            res.value()->SetIds(std::move(ids));
+            res.value()->SetDistance(std::move(distances));
+            res.value()->SetIsOwner(true);
+        }
+        return res;
+    }
+
     Version version_;
+    int numa_node_ = -1;
+    std::shared_ptr<SearchResultCache> result_cache_;
 };
 
 // Common superclass for iterators that expand search range as needed. Subclasses need
@@ -488,7 +861,7 @@ class IndexNode : public Object {
 // Internally, this structure uses the same priority queue class, but may multiply all
 //   incoming distances to (-1) value in order to turn max priority queue into a min one.
 // If use_knowhere_search_pool is True (the default), the iterator->Next() will be scheduled by the
-//   knowhere_search_thread_pool.
+//   knowhere_search_thread_pool, or run inline when it is called from a task of that pool already.
 //   If False, will Not involve thread scheduling internally, so please take caution.
 class IndexIterator : public IndexNode::iterator {
  public:
@@ -506,46 +879,27 @@ class IndexIterator : public IndexNode::iterator {
         if (!initialized_) {
             initialize();
         }
-        auto& q = refined_res_.empty() ? res_ : refined_res_;
-        if (q.empty()) {
+        if (!HasNext()) {
             throw std::runtime_error("No more elements");
         }
-        auto ret = q.top();
-        q.pop();
+        std::pair<int64_t, float> ret;
+        RunOnSearchPool([&]() { ret = PopNext(); });
+        return ret;
+    }
 
-        auto update_next_func = [&]() {
-            UpdateNext();
-            if (retain_iterator_order_) {
-                while (HasNext()) {
-                    auto& q = refined_res_.empty() ? res_ : refined_res_;
-                    auto next_ret = q.top();
-                    // with the help of `sign_`, both `res_` and `refine_res` are min-heap.
-                    //   such as `COSINE`, `-dist` will be inserted to `res_` or `refine_res`.
-                    // just make sure that the next value is greater than or equal to the current value.
-                    if (next_ret.val >= ret.val) {
-                        break;
-                    }
-                    q.pop();
-                    UpdateNext();
-                }
-            }
-        };
-        if (use_knowhere_search_pool_) {
-#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
-            std::vector<folly::Future<folly::Unit>> futs;
-            futs.emplace_back(ThreadPool::GetGlobalSearchThreadPool()->push([&]() {
-                ThreadPool::ScopedSearchOmpSetter setter(1);
-                update_next_func();
-            }));
-            WaitAllSuccess(futs);
-#else
-            update_next_func();
-#endif
-        } else {
-            update_next_func();
+    // Unlike n calls to Next(), schedules a single task on the search pool.
+    size_t
+    NextBatch(size_t n, int64_t* ids, float* dists) override {
+        if (!initialized_) {
+            initialize();
         }
-
-        return std::make_pair(ret.id, ret.val * sign_);
+        size_t i = 0;
+        RunOnSearchPool([&]() {
+            for (; i < n && HasNext(); i++) {
+                std::tie(ids[i], dists[i]) = PopNext();
+            }
+        });
+        return i;
     }
 
     [[nodiscard]] bool
@@ -556,6 +910,13 @@ class IndexIterator : public IndexNode::iterator {
         return !res_.empty() || !refined_res_.empty();
     }
 
+    void
+    Initialize() override {
+        if (!initialized_) {
+            initialize();
+        }
+    }
+
     virtual void
     initialize() {
         if (initialized_) {
@@ -584,6 +945,13 @@ class IndexIterator : public IndexNode::iterator {
         }
         throw std::runtime_error("raw_distance not implemented");
     }
+    // will be called only if refine_ratio_ is not 0, with all the ids that a batch refines at once.
+    virtual void
+    raw_distances(const int64_t* ids, size_t n, float* dists) {
+        for (size_t i = 0; i < n; i++) {
+            dists[i] = raw_distance(ids[i]);
+        }
+    }
 
     const float refine_ratio_;
     const bool refine_;
@@ -596,6 +964,46 @@ class IndexIterator : public IndexNode::iterator {
     std::priority_queue<DistId, std::vector<DistId>, std::greater<DistId>> refined_res_;
 
  private:
+    template <typename Func>
+    void
+    RunOnSearchPool(Func&& func) {
+        if (use_knowhere_search_pool_) {
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+            RunOnSearchThreadPool(func);
+#else
+            func();
+#endif
+        } else {
+            func();
+        }
+    }
+
+    // pops the closest result and expands the search for the following ones, HasNext() must be true
+    std::pair<int64_t, float>
+    PopNext() {
+        auto& q = refined_res_.empty() ? res_ : refined_res_;
+        auto ret = q.top();
+        q.pop();
+
+        UpdateNext();
+        if (retain_iterator_order_) {
+            while (HasNext()) {
+                auto& q = refined_res_.empty() ? res_ : refined_res_;
+                auto next_ret = q.top();
+                // with the help of `sign_`, both `res_` and `refine_res` are min-heap.
+                //   such as `COSINE`, `-dist` will be inserted to `res_` or `refine_res`.
+                // just make sure that the next value is greater than or equal to the current value.
+                if (next_ret.val >= ret.val) {
+                    break;
+                }
+                q.pop();
+                UpdateNext();
+            }
+        }
+
+        return std::make_pair(ret.id, ret.val * sign_);
+    }
+
     void
     UpdateNext() {
         auto batch_handler = [this](const std::vector<DistId>& batch) {
@@ -606,16 +1014,27 @@ class IndexIterator : public IndexNode::iterator {
                 res_.emplace(dist_id.id, dist_id.val * sign_);
             }
             if (refine_) {
-                while (!res_.empty() && (refined_res_.empty() || refined_res_.size() < min_refine_size())) {
-                    auto pair = res_.top();
+                // pop all the results to refine first, so that their raw distances are computed in one call
+                refine_ids_.clear();
+                while (!res_.empty() &&
+                       (refined_res_.size() + refine_ids_.size() == 0 ||
+                        refined_res_.size() + refine_ids_.size() < min_refine_size())) {
+                    refine_ids_.push_back(res_.top().id);
                     res_.pop();
-                    refined_res_.emplace(pair.id, raw_distance(pair.id) * sign_);
+                }
+                refine_dists_.resize(refine_ids_.size());
+                raw_distances(refine_ids_.data(), refine_ids_.size(), refine_dists_.data());
+                for (size_t i = 0; i < refine_ids_.size(); i++) {
+                    refined_res_.emplace(refine_ids_[i], refine_dists_[i] * sign_);
                 }
             }
         };
         next_batch(batch_handler);
     }
 
+    // unused if refine_ is false
+    std::vector<int64_t> refine_ids_;
+    std::vector<float> refine_dists_;
     bool use_knowhere_search_pool_ = true;
 };
 
@@ -638,24 +1057,29 @@ class PrecomputedDistanceIterator : public IndexNode::iterator {
         if (!initialized_) {
             initialize();
         }
-        if (use_knowhere_search_pool_) {
-#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
-            std::vector<folly::Future<folly::Unit>> futs;
-            futs.emplace_back(ThreadPool::GetGlobalSearchThreadPool()->push([&]() {
-                ThreadPool::ScopedSearchOmpSetter setter(1);
-                sort_next();
-            }));
-            WaitAllSuccess(futs);
-#else
-            sort_next();
-#endif
-        } else {
-            sort_next();
-        }
+        RunOnSearchPool([&]() { sort_next(); });
         auto& result = results_[next_++];
         return std::make_pair(result.id, result.val);
     }
 
+    size_t
+    NextBatch(size_t n, int64_t* ids, float* dists) override {
+        if (!initialized_) {
+            initialize();
+        }
+        size_t i = 0;
+        auto next_batch_func = [&]() {
+            for (; i < n && HasNext(); i++) {
+                sort_next();
+                ids[i] = results_[next_].id;
+                dists[i] = results_[next_].val;
+                next_++;
+            }
+        };
+        RunOnSearchPool(next_batch_func);
+        return i;
+    }
+
     [[nodiscard]] bool
     HasNext() override {
         if (!initialized_) {
@@ -664,31 +1088,39 @@ class PrecomputedDistanceIterator : public IndexNode::iterator {
         return next_ < results_.size() && results_[next_].id != -1;
     }
 
+    void
+    Initialize() override {
+        if (!initialized_) {
+            initialize();
+        }
+    }
+
     void
     initialize() {
         if (initialized_) {
             throw std::runtime_error("initialize should not be called twice");
         }
+        RunOnSearchPool([&]() { results_ = compute_dist_func_(); });
+        sort_size_ = get_sort_size(results_.size());
+        sort_next();
+        initialized_ = true;
+    }
+
+ private:
+    template <typename Func>
+    void
+    RunOnSearchPool(Func&& func) {
         if (use_knowhere_search_pool_) {
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
-            std::vector<folly::Future<folly::Unit>> futs;
-            futs.emplace_back(ThreadPool::GetGlobalSearchThreadPool()->push([&]() {
-                ThreadPool::ScopedSearchOmpSetter setter(1);
-                results_ = compute_dist_func_();
-            }));
-            WaitAllSuccess(futs);
+            RunOnSearchThreadPool(func);
 #else
-            results_ = compute_dist_func_();
+            func();
 #endif
         } else {
-            results_ = compute_dist_func_();
+            func();
         }
-        sort_size_ = get_sort_size(results_.size());
-        sort_next();
-        initialized_ = true;
     }
 
- private:
     static inline size_t
     get_sort_size(size_t rows) {
         return std::max((size_t)50000, rows / 10);
@@ -722,6 +1154,155 @@ class PrecomputedDistanceIterator : public IndexNode::iterator {
     size_t sort_size_ = 0;
 };
 
+// An iterator over distances that are computed block by block, which keeps only a bounded buffer of results rather
+//   than the distances of all the rows. A pass over the blocks selects the closest `buffer_size` results that follow
+//   the ones already returned. When the consumer drains the buffer, the next pass selects the following results into a
+//   buffer twice as large, so that draining all the rows takes a logarithmic number of passes.
+// As for PrecomputedDistanceIterator, the first pass is deferred until the first call to 'Iterator->Next()'.
+class BlockedDistanceIterator : public IndexNode::iterator {
+ public:
+    // fills `out`, of size `end - begin`, with the distances and the ids of the rows [begin, end). `out` comes filled
+    //   with an id of -1, which is to be kept for the rows that are filtered out.
+    using ComputeBlockFunc = std::function<void(size_t begin, size_t end, std::vector<DistId>& out)>;
+
+    static constexpr size_t kBlockSize = 4096;
+    static constexpr size_t kInitialBufferSize = 8192;
+
+    BlockedDistanceIterator(ComputeBlockFunc compute_block_func, size_t rows, bool larger_is_closer,
+                            bool use_knowhere_search_pool = true, size_t buffer_size = kInitialBufferSize)
+        : compute_block_func_(std::move(compute_block_func)),
+          rows_(rows),
+          sign_(larger_is_closer ? -1.0f : 1.0f),
+          use_knowhere_search_pool_(use_knowhere_search_pool),
+          buffer_size_(std::max(buffer_size, (size_t)1)) {
+    }
+
+    std::pair<int64_t, float>
+    Next() override {
+        if (!initialized_) {
+            initialize();
+        }
+        if (!HasNext()) {
+            throw std::runtime_error("No more elements");
+        }
+        std::pair<int64_t, float> ret;
+        RunOnSearchPool([&]() { ret = PopNext(); });
+        return ret;
+    }
+
+    size_t
+    NextBatch(size_t n, int64_t* ids, float* dists) override {
+        if (!initialized_) {
+            initialize();
+        }
+        size_t i = 0;
+        RunOnSearchPool([&]() {
+            for (; i < n && HasNext(); i++) {
+                std::tie(ids[i], dists[i]) = PopNext();
+            }
+        });
+        return i;
+    }
+
+    [[nodiscard]] bool
+    HasNext() override {
+        if (!initialized_) {
+            initialize();
+        }
+        return next_ < buffer_.size();
+    }
+
+    void
+    Initialize() override {
+        if (!initialized_) {
+            initialize();
+        }
+    }
+
+    void
+    initialize() {
+        if (initialized_) {
+            throw std::runtime_error("initialize should not be called twice");
+        }
+        RunOnSearchPool([&]() { Refill(); });
+        initialized_ = true;
+    }
+
+ private:
+    template <typename Func>
+    void
+    RunOnSearchPool(Func&& func) {
+        if (use_knowhere_search_pool_) {
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+            RunOnSearchThreadPool(func);
+#else
+            func();
+#endif
+        } else {
+            func();
+        }
+    }
+
+    // pops the closest result, and selects the following ones once the buffer is drained. HasNext() must be true
+    std::pair<int64_t, float>
+    PopNext() {
+        const auto& ret = buffer_[next_++];
+        auto res = std::make_pair(ret.id, ret.val * sign_);
+        if (next_ == buffer_.size() && !exhausted_) {
+            Refill();
+        }
+        return res;
+    }
+
+    // selects the closest buffer_size_ results after the last one of the buffer into the buffer. With `sign_`, the
+    //   closer results are the smaller ones, ties being broken by the ids.
+    void
+    Refill() {
+        const bool has_last = !buffer_.empty();
+        const DistId last = has_last ? buffer_.back() : DistId();
+        std::vector<DistId> heap;
+        heap.reserve(std::min(buffer_size_, rows_));
+        std::vector<DistId> block;
+        for (size_t begin = 0; begin < rows_; begin += kBlockSize) {
+            const size_t end = std::min(rows_, begin + kBlockSize);
+            block.assign(end - begin, DistId(-1, 0.0f));
+            compute_block_func_(begin, end, block);
+            for (const auto& dist_id : block) {
+                if (dist_id.id == -1) {
+                    continue;
+                }
+                const DistId key(dist_id.id, dist_id.val * sign_);
+                if (has_last && !(last < key)) {
+                    continue;
+                }
+                if (heap.size() < buffer_size_) {
+                    heap.push_back(key);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (key < heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = key;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+        }
+        exhausted_ = heap.size() < buffer_size_;
+        std::sort_heap(heap.begin(), heap.end());
+        buffer_ = std::move(heap);
+        next_ = 0;
+        buffer_size_ *= 2;
+    }
+
+    ComputeBlockFunc compute_block_func_;
+    const size_t rows_;
+    const float sign_;
+    bool use_knowhere_search_pool_ = true;
+    bool initialized_ = false;
+    bool exhausted_ = false;
+    size_t buffer_size_;
+    std::vector<DistId> buffer_;
+    size_t next_ = 0;
+};
+
 }  // namespace knowhere
 
 #endif /* INDEX_NODE_H */
@@ -26,6 +26,13 @@ class IndexNodeDataMockWrapper : public IndexNode {
         }
     }
 
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        // the wrapped index builds on a converted copy of the data
+        return index_node_->EstimateBuildMemory(dataset, cfg) +
+               DataSetBytes<typename MockData<DataType>::type>(dataset);
+    }
+
     Status
     Build(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
 
@@ -35,9 +42,26 @@ class IndexNodeDataMockWrapper : public IndexNode {
     Status
     Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
 
+    Status
+    Delete(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        return index_node_->Delete(dataset, std::move(cfg), use_knowhere_build_pool);
+    }
+
+    Status
+    Merge(const IndexNode& other, const BitsetView& bitset, std::shared_ptr<Config> cfg,
+          bool use_knowhere_build_pool) override {
+        auto other_wrapper = dynamic_cast<const IndexNodeDataMockWrapper*>(&other);
+        return index_node_->Merge(other_wrapper != nullptr ? *other_wrapper->index_node_ : other, bitset,
+                                  std::move(cfg), use_knowhere_build_pool);
+    }
+
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
 
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override;
+
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
 
@@ -45,6 +69,10 @@ class IndexNodeDataMockWrapper : public IndexNode {
     AnnIterator(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset,
                 bool use_knowhere_search_pool) const override;
 
+    expected<DataSetPtr>
+    GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column, std::unique_ptr<Config> cfg,
+                  const BitsetView& bitset) const override;
+
     expected<DataSetPtr>
     GetVectorByIds(const DataSetPtr dataset) const override;
 
@@ -63,6 +91,11 @@ class IndexNodeDataMockWrapper : public IndexNode {
         return index_node_->Serialize(binset);
     }
 
+    Status
+    SerializeToFile(const std::string& filename) const override {
+        return index_node_->SerializeToFile(filename);
+    }
+
     Status
     Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) override {
         return index_node_->Deserialize(binset, std::move(cfg));
@@ -73,6 +106,16 @@ class IndexNodeDataMockWrapper : public IndexNode {
         return index_node_->DeserializeFromFile(filename, std::move(cfg));
     }
 
+    Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) override {
+        return index_node_->Warmup(level, progress);
+    }
+
+    Status
+    Cooldown() override {
+        return index_node_->Cooldown();
+    }
+
     std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         return index_node_->CreateConfig();
@@ -88,6 +131,11 @@ class IndexNodeDataMockWrapper : public IndexNode {
         return index_node_->Size();
     }
 
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        return index_node_->GetMemoryReport();
+    }
+
     int64_t
     Count() const override {
         return index_node_->Count();
@@ -23,6 +23,11 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
 
     IndexNodeThreadPoolWrapper(std::unique_ptr<IndexNode> index_node, std::shared_ptr<ThreadPool> thread_pool);
 
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        return index_node_->EstimateBuildMemory(dataset, cfg);
+    }
+
     Status
     Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
         return index_node_->Train(dataset, std::move(cfg), use_knowhere_build_pool);
@@ -33,9 +38,26 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
         return index_node_->Add(dataset, std::move(cfg), use_knowhere_build_pool);
     }
 
+    Status
+    Delete(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        return index_node_->Delete(dataset, std::move(cfg), use_knowhere_build_pool);
+    }
+
+    Status
+    Merge(const IndexNode& other, const BitsetView& bitset, std::shared_ptr<Config> cfg,
+          bool use_knowhere_build_pool) override {
+        auto other_wrapper = dynamic_cast<const IndexNodeThreadPoolWrapper*>(&other);
+        return index_node_->Merge(other_wrapper != nullptr ? *other_wrapper->index_node_ : other, bitset,
+                                  std::move(cfg), use_knowhere_build_pool);
+    }
+
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
 
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override;
+
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
 
@@ -59,6 +81,11 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
         return index_node_->Serialize(binset);
     }
 
+    Status
+    SerializeToFile(const std::string& filename) const override {
+        return index_node_->SerializeToFile(filename);
+    }
+
     Status
     Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) override {
         return index_node_->Deserialize(binset, std::move(cfg));
@@ -69,6 +96,16 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
         return index_node_->DeserializeFromFile(filename, move(cfg));
     }
 
+    Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) override {
+        return index_node_->Warmup(level, progress);
+    }
+
+    Status
+    Cooldown() override {
+        return index_node_->Cooldown();
+    }
+
     std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         return index_node_->CreateConfig();
@@ -84,6 +121,11 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
         return index_node_->Size();
     }
 
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        return index_node_->GetMemoryReport();
+    }
+
     int64_t
     Count() const override {
         return index_node_->Count();
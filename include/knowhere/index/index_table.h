@@ -27,6 +27,9 @@ static std::set<std::pair<std::string, VecType>> legal_knowhere_index = {
     {IndexEnum::INDEX_FAISS_IDMAP, VecType::VECTOR_FLOAT16},
     {IndexEnum::INDEX_FAISS_IDMAP, VecType::VECTOR_BFLOAT16},
     // {IndexEnum::INDEX_FAISS_IDMAP, VecType::VECTOR_INT8},
+    {IndexEnum::INDEX_FAISS_IDMAP_SQ, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_FAISS_IDMAP_SQ, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_FAISS_IDMAP_SQ, VecType::VECTOR_BFLOAT16},
 
     {IndexEnum::INDEX_FAISS_IVFFLAT, VecType::VECTOR_FLOAT},
     {IndexEnum::INDEX_FAISS_IVFFLAT, VecType::VECTOR_FLOAT16},
@@ -62,6 +65,10 @@ static std::set<std::pair<std::string, VecType>> legal_knowhere_index = {
     {IndexEnum::INDEX_FAISS_IVFRABITQ, VecType::VECTOR_FLOAT16},
     {IndexEnum::INDEX_FAISS_IVFRABITQ, VecType::VECTOR_BFLOAT16},
 
+    {IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, VecType::VECTOR_BFLOAT16},
+
     // gpu index
     {IndexEnum::INDEX_GPU_BRUTEFORCE, VecType::VECTOR_FLOAT},
     {IndexEnum::INDEX_GPU_BRUTEFORCE, VecType::VECTOR_FLOAT16},
@@ -97,6 +104,11 @@ static std::set<std::pair<std::string, VecType>> legal_knowhere_index = {
     {IndexEnum::INDEX_HNSW_PRQ, VecType::VECTOR_BFLOAT16},
     {IndexEnum::INDEX_HNSW_PRQ, VecType::VECTOR_INT8},
 
+    {IndexEnum::INDEX_HNSW_RABITQ, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_HNSW_RABITQ, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_HNSW_RABITQ, VecType::VECTOR_BFLOAT16},
+    {IndexEnum::INDEX_HNSW_RABITQ, VecType::VECTOR_INT8},
+
     // diskann
     {IndexEnum::INDEX_DISKANN, VecType::VECTOR_FLOAT},
     {IndexEnum::INDEX_DISKANN, VecType::VECTOR_FLOAT16},
@@ -110,6 +122,7 @@ static std::set<std::pair<std::string, VecType>> legal_knowhere_index = {
     // sparse index
     {IndexEnum::INDEX_SPARSE_INVERTED_INDEX, VecType::VECTOR_SPARSE_FLOAT},
     {IndexEnum::INDEX_SPARSE_WAND, VecType::VECTOR_SPARSE_FLOAT},
+    {IndexEnum::INDEX_SPARSE_CLUSTERED, VecType::VECTOR_SPARSE_FLOAT},
     //  minhash index
     {IndexEnum::INDEX_MINHASH_LSH, VecType::VECTOR_BINARY},
 
@@ -118,6 +131,22 @@ static std::set<std::pair<std::string, VecType>> legal_knowhere_index = {
     {IndexEnum::INDEX_EMB_LIST_HNSW, VecType::VECTOR_FLOAT16},
     {IndexEnum::INDEX_EMB_LIST_HNSW, VecType::VECTOR_BFLOAT16},
     {IndexEnum::INDEX_EMB_LIST_HNSW, VecType::VECTOR_INT8},
+
+    // emb list over the compressed and disk-based indexes
+    {IndexEnum::INDEX_EMB_LIST_HNSW_PQ, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_EMB_LIST_HNSW_PQ, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_EMB_LIST_HNSW_PQ, VecType::VECTOR_BFLOAT16},
+    {IndexEnum::INDEX_EMB_LIST_IVF_SQ8, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_EMB_LIST_IVF_SQ8, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_EMB_LIST_IVF_SQ8, VecType::VECTOR_BFLOAT16},
+    {IndexEnum::INDEX_EMB_LIST_DISKANN, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_EMB_LIST_DISKANN, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_EMB_LIST_DISKANN, VecType::VECTOR_BFLOAT16},
+
+    // emb list plaid
+    {IndexEnum::INDEX_EMB_LIST_PLAID, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_EMB_LIST_PLAID, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_EMB_LIST_PLAID, VecType::VECTOR_BFLOAT16},
 };
 
 static std::set<std::string> legal_support_mmap_knowhere_index = {
@@ -127,29 +156,38 @@ static std::set<std::string> legal_support_mmap_knowhere_index = {
 
     // faiss index
     IndexEnum::INDEX_FAISS_IDMAP,
+    IndexEnum::INDEX_FAISS_IDMAP_SQ,
     IndexEnum::INDEX_FAISS_IVFFLAT,
     IndexEnum::INDEX_FAISS_IVFPQ,
     IndexEnum::INDEX_FAISS_SCANN,
     IndexEnum::INDEX_FAISS_IVFSQ8,
     IndexEnum::INDEX_FAISS_IVFSQ_CC,
     IndexEnum::INDEX_FAISS_IVFRABITQ,
+    IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN,
 
     // hnsw
     IndexEnum::INDEX_HNSW,
     IndexEnum::INDEX_HNSW_SQ,
     IndexEnum::INDEX_HNSW_PQ,
     IndexEnum::INDEX_HNSW_PRQ,
+    IndexEnum::INDEX_HNSW_RABITQ,
 
     // sparse index
     IndexEnum::INDEX_SPARSE_INVERTED_INDEX,
     IndexEnum::INDEX_SPARSE_WAND,
 
-    // emb list hnsw
+    // emb list
     IndexEnum::INDEX_EMB_LIST_HNSW,
+    IndexEnum::INDEX_EMB_LIST_HNSW_PQ,
+    IndexEnum::INDEX_EMB_LIST_IVF_SQ8,
 };
 
 static std::set<std::string> legal_support_emb_list_knowhere_index = {
     IndexEnum::INDEX_EMB_LIST_HNSW,
+    IndexEnum::INDEX_EMB_LIST_HNSW_PQ,
+    IndexEnum::INDEX_EMB_LIST_IVF_SQ8,
+    IndexEnum::INDEX_EMB_LIST_DISKANN,
+    IndexEnum::INDEX_EMB_LIST_PLAID,
 };
 
 KNOWHERE_SET_STATIC_GLOBAL_INDEX_TABLE(0, KNOWHERE_STATIC_INDEX, legal_knowhere_index)
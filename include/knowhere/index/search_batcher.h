@@ -0,0 +1,230 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SEARCH_BATCHER_H
+#define SEARCH_BATCHER_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "folly/futures/Future.h"
+#include "knowhere/index/index.h"
+#include "knowhere/operands.h"
+
+namespace knowhere {
+
+// Coalesces the concurrent small searches of an index into batched searches. The searches with the same config and
+// bitset that arrive within `window` of the first of them are searched as one, up to `max_batch_rows` queries, so
+// they are parsed and scheduled once and run over the batch kernels of the index (the query blocks of HNSW, the
+// shared list scans of IVF, the batched sparse search). Each caller gets the rows of its queries.
+//
+// The searches that cannot be batched are run directly on the calling thread: sparse queries, configs without a
+// top-k, and searches of max_batch_rows queries or more. The batched results carry the ids and distances only. The
+// batches are run one after another by the thread of the batcher, each over the search pool.
+template <typename DataType>
+class SearchBatcher {
+ public:
+    SearchBatcher(Index<IndexNode> index, std::chrono::microseconds window, int64_t max_batch_rows = 256)
+        : index_(std::move(index)), window_(window), max_batch_rows_(max_batch_rows) {
+        flusher_ = std::thread([this]() { Run(); });
+    }
+
+    // the pending searches are run before the batcher goes away
+    ~SearchBatcher() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        flusher_.join();
+    }
+
+    SearchBatcher(const SearchBatcher&) = delete;
+    SearchBatcher&
+    operator=(const SearchBatcher&) = delete;
+
+    // the data behind the dataset and the bitset must outlive the returned future
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchAsync(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) {
+        const auto rows = dataset->GetRows();
+        if (window_.count() <= 0 || dataset->GetIsSparse() || rows >= max_batch_rows_ || !json.contains(meta::TOPK) ||
+            !json[meta::TOPK].is_number_integer() || json[meta::TOPK].get<int64_t>() <= 0) {
+            return folly::makeSemiFuture(index_.Search(dataset, json, bitset));
+        }
+
+        // the key is built before the lock, the dump of the json and the count of the bitset may take a while
+        const void* bits = bitset.has_valid_ids() ? static_cast<const void*>(bitset.valid_ids_data()) : bitset.data();
+        const Key key{json.dump(), bits, bitset.size(), bitset.count(), dataset->GetDim()};
+        auto [promise, future] = folly::makePromiseContract<expected<DataSetPtr>>();
+        {
+            std::lock_guard lock(mutex_);
+            auto it = open_.find(key);
+            if (it != open_.end() && it->second.rows + rows > max_batch_rows_) {
+                ready_.push_back(std::move(it->second));
+                open_.erase(it);
+                it = open_.end();
+            }
+            if (it == open_.end()) {
+                Batch batch;
+                batch.json = json;
+                batch.bitset = bitset;
+                batch.k = json[meta::TOPK].get<int64_t>();
+                batch.dim = dataset->GetDim();
+                batch.flush_at = std::chrono::steady_clock::now() + window_;
+                it = open_.emplace(key, std::move(batch)).first;
+            }
+            it->second.rows += rows;
+            it->second.requests.push_back({dataset, std::move(promise)});
+            if (it->second.rows >= max_batch_rows_) {
+                ready_.push_back(std::move(it->second));
+                open_.erase(it);
+            }
+        }
+        cv_.notify_one();
+        return std::move(future);
+    }
+
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) {
+        return SearchAsync(dataset, json, bitset).get();
+    }
+
+ private:
+    struct Request {
+        DataSetPtr dataset;
+        folly::Promise<expected<DataSetPtr>> promise;
+    };
+
+    struct Batch {
+        Json json;
+        BitsetView bitset;
+        int64_t k = 0;
+        int64_t dim = 0;
+        int64_t rows = 0;
+        std::vector<Request> requests;
+        std::chrono::steady_clock::time_point flush_at;
+    };
+
+    // the config, the bitset and the dim of the searches of a batch
+    using Key = std::tuple<std::string, const void*, size_t, size_t, int64_t>;
+
+    void
+    Run() {
+        std::unique_lock lock(mutex_);
+        while (true) {
+            auto next_flush = std::chrono::steady_clock::time_point::max();
+            const auto now = std::chrono::steady_clock::now();
+            for (auto it = open_.begin(); it != open_.end();) {
+                if (stop_ || it->second.flush_at <= now) {
+                    ready_.push_back(std::move(it->second));
+                    it = open_.erase(it);
+                } else {
+                    next_flush = std::min(next_flush, it->second.flush_at);
+                    ++it;
+                }
+            }
+            if (!ready_.empty()) {
+                auto batches = std::move(ready_);
+                ready_.clear();
+                lock.unlock();
+                for (auto& batch : batches) {
+                    try {
+                        Execute(batch);
+                    } catch (const std::exception& e) {
+                        for (auto& request : batch.requests) {
+                            if (!request.promise.isFulfilled()) {
+                                request.promise.setValue(expected<DataSetPtr>::Err(Status::internal_error, e.what()));
+                            }
+                        }
+                    }
+                }
+                lock.lock();
+                continue;
+            }
+            if (stop_) {
+                return;
+            }
+            if (next_flush == std::chrono::steady_clock::time_point::max()) {
+                cv_.wait(lock);
+            } else {
+                cv_.wait_until(lock, next_flush);
+            }
+        }
+    }
+
+    void
+    Execute(Batch& batch) {
+        if (batch.requests.size() == 1) {
+            auto& request = batch.requests.front();
+            request.promise.setValue(index_.Search(request.dataset, batch.json, batch.bitset));
+            return;
+        }
+
+        const size_t row_bytes =
+            datatype_v<DataType> == DataFormatEnum::bin1 ? (batch.dim + 7) / 8 : batch.dim * sizeof(DataType);
+        std::vector<uint8_t> queries(batch.rows * row_bytes);
+        int64_t offset = 0;
+        for (const auto& request : batch.requests) {
+            const auto rows = request.dataset->GetRows();
+            std::memcpy(queries.data() + offset * row_bytes, request.dataset->GetTensor(), rows * row_bytes);
+            offset += rows;
+        }
+        std::vector<int64_t> ids(batch.rows * batch.k);
+        std::vector<float> distances(batch.rows * batch.k);
+        const auto res = index_.SearchWithBuf(GenDataSet(batch.rows, batch.dim, queries.data()), batch.json,
+                                              batch.bitset, ids.data(), distances.data());
+        if (!res.has_value()) {
+            for (auto& request : batch.requests) {
+                request.promise.setValue(expected<DataSetPtr>::Err(res.error(), res.what()));
+            }
+            return;
+        }
+
+        offset = 0;
+        for (auto& request : batch.requests) {
+            const auto size = request.dataset->GetRows() * batch.k;
+            auto request_ids = AllocateResultBuffer<int64_t>(size);
+            auto request_distances = AllocateResultBuffer<float>(size);
+            std::copy_n(ids.data() + offset, size, request_ids.get());
+            std::copy_n(distances.data() + offset, size, request_distances.get());
+            request.promise.setValue(GenResultDataSet(request.dataset->GetRows(), batch.k, std::move(request_ids),
+                                                      std::move(request_distances)));
+            offset += size;
+        }
+    }
+
+    Index<IndexNode> index_;
+    const std::chrono::microseconds window_;
+    const int64_t max_batch_rows_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // the batches that take searches, and the ones to run
+    std::map<Key, Batch> open_;
+    std::vector<Batch> ready_;
+    bool stop_ = false;
+    std::thread flusher_;
+};
+
+}  // namespace knowhere
+
+#endif /* SEARCH_BATCHER_H */
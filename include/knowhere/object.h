@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -76,13 +77,26 @@ class Object {
 
 using ViewDataOp = std::function<const void*(size_t)>;
 
+// Copies the vectors of the n ids into out, n contiguous rows, and hints that the next_n ids at next_ids are read next,
+// for the host to start fetching them asynchronously; next_ids is nullptr for the last batch. A data view over chunked
+// storage serves a batch with a call per chunk instead of a call per id.
+using ViewDataBatchOp =
+    std::function<void(const int64_t* ids, size_t n, void* out, const int64_t* next_ids, size_t next_n)>;
+
+// the accessors of a data view, view_data_batch may be empty
+struct DataViewOps {
+    ViewDataOp view_data;
+    ViewDataBatchOp view_data_batch;
+};
+
 template <typename T>
 class Pack : public Object {
     // Currently, DataViewIndex and DiskIndex are mutually exclusive, they can share one object.
     // todo: pack can hold more object
-    static_assert(std::is_same_v<T, knowhere::ViewDataOp> || std::is_same_v<T, std::shared_ptr<milvus::FileManager>>,
-                  "IndexPack only support std::shared_ptr<milvus::FileManager> or ViewDataOp == std::function<const "
-                  "void*(size_t)> by far.");
+    static_assert(std::is_same_v<T, knowhere::ViewDataOp> || std::is_same_v<T, knowhere::DataViewOps> ||
+                      std::is_same_v<T, std::shared_ptr<milvus::FileManager>>,
+                  "IndexPack only support std::shared_ptr<milvus::FileManager>, ViewDataOp == std::function<const "
+                  "void*(size_t)> or DataViewOps by far.");
 
  public:
     Pack() {
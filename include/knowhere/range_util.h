@@ -12,7 +12,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "knowhere/bitsetview.h"
@@ -39,4 +41,110 @@ GetRangeSearchResult(const std::vector<std::vector<float>>& result_distances,
                      const std::vector<std::vector<int64_t>>& result_labels, const bool is_ip, const int64_t nq,
                      const float radius, const float range_filter);
 
+// The results of the queries of a range search, gathered without a vector per query. The writer of a query appends to
+// the chunks of a lane that no other writer holds meanwhile, so the threads of a search do not share a buffer and a
+// lane is reused by the queries that run one after the other. Finish takes the counts of the queries for the lims and
+// copies every result once. The chunks go back to a free list with the arena and are reused by the next searches.
+class RangeSearchResultArena {
+ public:
+    // in entries
+    static constexpr size_t kChunkSize = 16384;
+
+ private:
+    struct Chunk {
+        std::unique_ptr<int64_t[]> labels;
+        std::unique_ptr<float[]> distances;
+    };
+
+    // the results of a query in one chunk
+    struct Piece {
+        size_t qno;
+        const int64_t* labels;
+        const float* distances;
+        size_t n;
+    };
+
+    struct Lane {
+        std::vector<Chunk> chunks;
+        // the write pointer in the last chunk
+        size_t wp = kChunkSize;
+        std::vector<Piece> pieces;
+    };
+
+ public:
+    // appends the results of one query, there is one writer per query
+    class Writer {
+     public:
+        Writer(const Writer&) = delete;
+        Writer&
+        operator=(const Writer&) = delete;
+
+        ~Writer();
+
+        void
+        Add(const int64_t label, const float distance) {
+            if (lane_->wp == kChunkSize) {
+                NextChunk();
+            }
+            auto& chunk = lane_->chunks.back();
+            chunk.labels[lane_->wp] = label;
+            chunk.distances[lane_->wp] = distance;
+            lane_->wp++;
+            size_++;
+        }
+
+        size_t
+        Size() const {
+            return size_;
+        }
+
+     private:
+        friend class RangeSearchResultArena;
+
+        Writer(RangeSearchResultArena* arena, const size_t qno, Lane* lane)
+            : arena_(arena), qno_(qno), lane_(lane), piece_begin_(lane->wp) {
+        }
+
+        void
+        ClosePiece();
+
+        void
+        NextChunk();
+
+        RangeSearchResultArena* arena_;
+        size_t qno_;
+        Lane* lane_;
+        size_t piece_begin_;
+        size_t size_ = 0;
+    };
+
+    explicit RangeSearchResultArena(const size_t nq) : counts_(nq, 0) {
+    }
+
+    RangeSearchResultArena(const RangeSearchResultArena&) = delete;
+    RangeSearchResultArena&
+    operator=(const RangeSearchResultArena&) = delete;
+
+    ~RangeSearchResultArena();
+
+    // thread safe, the writer is to be destroyed before Finish
+    Writer
+    GetWriter(const size_t qno);
+
+    RangeSearchResult
+    Finish();
+
+ private:
+    static Chunk
+    TakeChunk();
+
+    static void
+    ReturnChunks(std::vector<Chunk>& chunks);
+
+    std::vector<size_t> counts_;
+    std::mutex lanes_mutex_;
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::vector<Lane*> free_lanes_;
+};
+
 }  // namespace knowhere
@@ -0,0 +1,58 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace knowhere {
+
+// The cost of the search of a query, returned in the result DataSet of a search with search_stats set. The counters
+// that an index type has no notion of stay 0.
+struct QuerySearchStats {
+    // the distances computed to the vectors: by the graph traversal, the scan of the lists, the brute force fallback
+    // and the refine. For the sparse indexes, the postings visited, a bound of those scored by the DAAT algorithms.
+    uint64_t distance_computations = 0;
+    // the nodes whose neighbors were visited (HNSW, DiskANN)
+    uint64_t graph_hops = 0;
+    // the inverted lists scanned (IVF), the posting lists of the query terms kept after the drop (sparse)
+    uint64_t lists_probed = 0;
+    // the reads issued to the disk (DiskANN)
+    uint64_t io_count = 0;
+    // the nodes read from the node cache instead of the disk (DiskANN)
+    uint64_t cache_hits = 0;
+    // the candidates reranked by the refine, over all its stages
+    uint64_t refine_candidates = 0;
+    // the strategies the query was executed with, as SearchStrategy bits (@see PlanSearch): the planned one, and the
+    // brute force of a graph search that fell short of k results
+    uint32_t strategies = 0;
+    // the cost of the planned strategy as estimated by the planner, in bytes read
+    double estimated_cost = 0;
+
+    QuerySearchStats&
+    operator+=(const QuerySearchStats& other) {
+        distance_computations += other.distance_computations;
+        graph_hops += other.graph_hops;
+        lists_probed += other.lists_probed;
+        io_count += other.io_count;
+        cache_hits += other.cache_hits;
+        refine_candidates += other.refine_candidates;
+        strategies |= other.strategies;
+        estimated_cost += other.estimated_cost;
+        return *this;
+    }
+};
+
+// The stats of the queries of a search, in the order of the queries.
+using SearchStats = std::vector<QuerySearchStats>;
+
+}  // namespace knowhere
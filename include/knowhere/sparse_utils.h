@@ -14,12 +14,19 @@
 
 #pragma once
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <boost/iterator/iterator_facade.hpp>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -455,4 +462,214 @@ class GrowableVectorView {
     size_type mmap_element_count_ = 0;
 };
 
+// A std::vector like container that can only be appended at the end, whose elements are stored in fixed-size
+// chunks mmapped from a backing file. Once a chunk is full, a new chunk is appended to the file and mapped on its
+// own: the chunks are never remapped nor copied, so the addresses of the elements stay stable while it grows and an
+// append costs at most the extension of the file by a chunk, instead of the remap and copy of all the elements.
+//
+// The backing file is unlinked as soon as it is created, it goes away with the container.
+template <typename T>
+class ChunkedGrowableVector {
+    static_assert(std::is_trivially_copyable_v<T>, "ChunkedGrowableVector only holds trivially copyable types");
+
+ public:
+    using value_type = T;
+    using size_type = size_t;
+
+    static constexpr size_type default_chunk_elements = 1 << 16;
+
+    // chunk_elements is rounded up to a power of 2, for the element lookups to be a shift and a mask.
+    explicit ChunkedGrowableVector(const std::string& filename, size_type chunk_elements = default_chunk_elements) {
+        chunk_shift_ = 0;
+        while ((size_type{1} << chunk_shift_) < std::max<size_type>(chunk_elements, 1)) {
+            ++chunk_shift_;
+        }
+        const size_type page_size = sysconf(_SC_PAGESIZE);
+        chunk_stride_ = (chunk_size() * sizeof(T) + page_size - 1) / page_size * page_size;
+        fd_ = open(filename.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (fd_ == -1) {
+            throw std::runtime_error("failed to create " + filename + ": " + strerror(errno));
+        }
+        unlink(filename.c_str());
+    }
+
+    ChunkedGrowableVector(const ChunkedGrowableVector&) = delete;
+    ChunkedGrowableVector&
+    operator=(const ChunkedGrowableVector&) = delete;
+
+    ~ChunkedGrowableVector() {
+        for (auto* chunk : chunks_) {
+            munmap(chunk, chunk_stride_);
+        }
+        if (fd_ != -1) {
+            close(fd_);
+        }
+    }
+
+    // the elements of a chunk
+    [[nodiscard]] size_type
+    chunk_size() const {
+        return size_type{1} << chunk_shift_;
+    }
+
+    [[nodiscard]] size_type
+    num_chunks() const {
+        return chunks_.size();
+    }
+
+    [[nodiscard]] size_type
+    capacity() const {
+        return chunks_.size() << chunk_shift_;
+    }
+
+    [[nodiscard]] size_type
+    size() const {
+        return size_;
+    }
+
+    template <typename... Args>
+    T&
+    emplace_back(Args&&... args) {
+        if (size_ == capacity()) {
+            add_chunk();
+        }
+        auto* elem = chunks_.back() + (size_ & (chunk_size() - 1));
+        ++size_;
+        return *new (elem) T(std::forward<Args>(args)...);
+    }
+
+    T&
+    operator[](size_type i) {
+        return chunks_[i >> chunk_shift_][i & (chunk_size() - 1)];
+    }
+
+    const T&
+    operator[](size_type i) const {
+        return chunks_[i >> chunk_shift_][i & (chunk_size() - 1)];
+    }
+
+    const T&
+    at(size_type i) const {
+        if (i >= size_) {
+            throw std::out_of_range("ChunkedGrowableVector index out of range");
+        }
+        return (*this)[i];
+    }
+
+    // the elements [i * chunk_size(), i * chunk_size() + chunk_elements(i)) are contiguous from chunk(i).
+    const T*
+    chunk(size_type i) const {
+        return chunks_[i];
+    }
+
+    [[nodiscard]] size_type
+    chunk_elements(size_type i) const {
+        return std::min(chunk_size(), size_ - (i << chunk_shift_));
+    }
+
+    // calls f(data, n) for each run of n contiguous elements, in order.
+    template <typename F>
+    void
+    for_each_chunk(F&& f) const {
+        for (size_type i = 0; i < chunks_.size() && (i << chunk_shift_) < size_; ++i) {
+            f(static_cast<const T*>(chunks_[i]), chunk_elements(i));
+        }
+    }
+
+    // steps through the elements of a chunk with a pointer, and looks up the next chunk only at its end.
+    class iterator : public boost::iterator_facade<iterator, const T, boost::random_access_traversal_tag> {
+     public:
+        iterator() = default;
+        iterator(const ChunkedGrowableVector* vec, size_type i) : vec_(vec) {
+            seek(i);
+        }
+
+     private:
+        friend class boost::iterator_core_access;
+
+        const T&
+        dereference() const {
+            return *ptr_;
+        }
+
+        void
+        increment() {
+            ++i_;
+            ++ptr_;
+            if (ptr_ == chunk_end_) {
+                seek(i_);
+            }
+        }
+
+        void
+        decrement() {
+            seek(i_ - 1);
+        }
+
+        void
+        advance(std::ptrdiff_t n) {
+            seek(i_ + n);
+        }
+
+        std::ptrdiff_t
+        distance_to(const iterator& other) const {
+            return static_cast<std::ptrdiff_t>(other.i_) - static_cast<std::ptrdiff_t>(i_);
+        }
+
+        bool
+        equal(const iterator& other) const {
+            return i_ == other.i_;
+        }
+
+        void
+        seek(size_type i) {
+            i_ = i;
+            const auto c = i >> vec_->chunk_shift_;
+            if (i < vec_->size_ && c < vec_->chunks_.size()) {
+                ptr_ = vec_->chunks_[c] + (i & (vec_->chunk_size() - 1));
+                chunk_end_ = vec_->chunks_[c] + vec_->chunk_elements(c);
+            } else {
+                ptr_ = nullptr;
+                chunk_end_ = nullptr;
+            }
+        }
+
+        const ChunkedGrowableVector* vec_ = nullptr;
+        size_type i_ = 0;
+        const T* ptr_ = nullptr;
+        const T* chunk_end_ = nullptr;
+    };
+
+    iterator
+    begin() const {
+        return iterator(this, 0);
+    }
+
+    iterator
+    end() const {
+        return iterator(this, size_);
+    }
+
+ private:
+    void
+    add_chunk() {
+        const auto offset = static_cast<off_t>(chunks_.size() * chunk_stride_);
+        if (ftruncate(fd_, offset + chunk_stride_) != 0) {
+            throw std::runtime_error(std::string("failed to grow ChunkedGrowableVector: ") + strerror(errno));
+        }
+        auto* chunk = mmap(nullptr, chunk_stride_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+        if (chunk == MAP_FAILED) {
+            throw std::runtime_error(std::string("failed to map ChunkedGrowableVector chunk: ") + strerror(errno));
+        }
+        chunks_.push_back(static_cast<T*>(chunk));
+    }
+
+    int fd_ = -1;
+    size_type chunk_shift_ = 0;
+    // bytes between the chunks in the file, a multiple of the page size.
+    size_type chunk_stride_ = 0;
+    std::vector<T*> chunks_;
+    size_type size_ = 0;
+};
+
 }  // namespace knowhere::sparse
@@ -15,6 +15,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <vector>
 
 #include "knowhere/binaryset.h"
@@ -224,6 +225,34 @@ round_down(const T value, const T align) {
     return value / align * align;
 }
 
+// marks the top-k results of the queries [begin, end) as missing, for the queries an interrupted search skipped
+template <typename DistType>
+inline void
+MarkMissingResults(int64_t* ids, DistType* distances, const int64_t k, const size_t begin, const size_t end) {
+    std::fill(ids + k * begin, ids + k * end, -1);
+    std::fill(distances + k * begin, distances + k * end, std::numeric_limits<DistType>::max());
+}
+
+// the bytes of the vectors of a dataset of DataType, or of its sparse rows
+template <typename DataType>
+inline int64_t
+DataSetBytes(const DataSetPtr& dataset) {
+    const auto rows = dataset->GetRows();
+    if (dataset->GetIsSparse()) {
+        auto data = static_cast<const sparse::SparseRow<float>*>(dataset->GetTensor());
+        int64_t bytes = 0;
+        for (int64_t i = 0; data != nullptr && i < rows; ++i) {
+            bytes += data[i].data_byte_size();
+        }
+        return bytes;
+    }
+    if constexpr (std::is_same_v<DataType, bin1>) {
+        return rows * ((dataset->GetDim() + 7) / 8);
+    } else {
+        return rows * dataset->GetDim() * static_cast<int64_t>(sizeof(DataType));
+    }
+}
+
 bool
 UseDiskLoad(const std::string& index_type, const int32_t& /*version*/);
 
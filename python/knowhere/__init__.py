@@ -48,6 +48,40 @@ def BruteForceRangeSearch(type=np.float32, *args):
         return BruteForceRangeSearchBin(*args)
 
 
+class SearchBatch:
+    """
+    Searches of several indexes run together: add() queues a search, run() runs all the queued ones concurrently,
+    each writing its results to its own output arrays.
+    """
+
+    def __init__(self, num_threads=0):
+        self.batch = swigknowhere.SearchBatch(num_threads)
+        # the objects the queued searches refer to, kept alive until they ran
+        self.refs = []
+
+    def add(self, index, dataset, json, bitset, k, dis=None, ids=None):
+        """
+        Queues a search of dataset in index and returns the (dis, ids) arrays of shape (nq, k) its results are
+        written to, the given ones if any.
+        """
+        rows = swigknowhere.DataSet_Rows(dataset)
+        if dis is None:
+            dis = np.zeros([rows, k], dtype=np.float32)
+        if ids is None:
+            ids = np.zeros([rows, k], dtype=np.int64)
+        index.SearchAsync(self.batch, dataset, json, bitset, dis, ids)
+        self.refs.append((index, dataset, bitset, dis, ids))
+        return dis, ids
+
+    def run(self):
+        """
+        Runs the queued searches and returns their statuses, in the order they were queued.
+        """
+        statuses = self.batch.Run()
+        self.refs = []
+        return [Status(status) for status in statuses]
+
+
 def GetCurrentVersion():
     return swigknowhere.CurrentVersion()
 
@@ -86,12 +120,12 @@ def ArrayToDataSet(arr):
             return swigknowhere.Array2DataSetI(arr)
         if arr.dtype == np.float32:
             return swigknowhere.Array2DataSetF(arr)
+        # the half precision rows are wrapped as they are through uint16 views, arr must be C contiguous and
+        # outlive the dataset
         if arr.dtype == np.float16:
-            arr = arr.astype(np.float32)
-            return swigknowhere.Array2DataSetFP16(arr)
+            return swigknowhere.Array2DataSetFP16(arr.view(np.uint16))
         if arr.dtype == bfloat16:
-            arr = arr.astype(np.float32)
-            return swigknowhere.Array2DataSetBF16(arr)
+            return swigknowhere.Array2DataSetBF16(arr.view(np.uint16))
     raise ValueError(
         """
         ArrayToDataSet only support numpy array dtype float32,uint8,float16 and bfloat16.
@@ -38,8 +38,12 @@ typedef uint64_t size_t;
 #include <knowhere/comp/knowhere_config.h>
 #include <filemanager/impl/LocalFileManager.h>
 #include <knowhere/comp/index_param.h>
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <string>
+#include <thread>
+#include <vector>
 using namespace knowhere;
 %}
 
@@ -78,6 +82,9 @@ import_array();
 %apply (uint8_t* INPLACE_ARRAY2, int DIM1, int DIM2) {(uint8_t *data, int rows, int dim)}
 %apply (int8_t* IN_ARRAY2, int DIM1, int DIM2) {(int8_t* xb, int nb, int dim)}
 %apply (int8_t* INPLACE_ARRAY2, int DIM1, int DIM2) {(int8_t *data, int rows, int dim)}
+// fp16 and bf16 rows come as uint16 views of their arrays, wrapped without a conversion nor a copy, so the arrays
+// must already be contiguous
+%apply (uint16_t* INPLACE_ARRAY2, int DIM1, int DIM2) {(uint16_t* xb, int nb, int dim)}
 %apply (int *IN_ARRAY1, int DIM1) {(int *lims, int len)}
 %apply (int *IN_ARRAY1, int DIM1) {(int *ids, int len)}
 %apply (float *IN_ARRAY1, int DIM1) {(float *dis, int len)}
@@ -86,6 +93,7 @@ import_array();
 %apply (int64_t *IN_ARRAY1, int DIM1) {(int64_t* indptr, int nb3)}
 %apply (float* INPLACE_ARRAY2, int DIM1, int DIM2){(float *dis,int nq_1,int k_1)}
 %apply (int *INPLACE_ARRAY2, int DIM1, int DIM2){(int *ids,int nq_2,int k_2)}
+%apply (int64_t *INPLACE_ARRAY2, int DIM1, int DIM2){(int64_t *ids,int nq_2,int k_2)}
 %apply (float* INPLACE_ARRAY2, int DIM1, int DIM2){(float *data,int rows,int dim)}
 %apply (int32_t *INPLACE_ARRAY2, int DIM1, int DIM2){(int32_t *data,int rows,int dim)}
 
@@ -151,6 +159,53 @@ class AnnIteratorWrap {
     std::shared_ptr<IndexNode::iterator> it_;
 };
 
+// Searches queued to run together by Run, with the GIL released, as many at a time as there are threads. Each
+// search writes its results to the numpy arrays it was queued with. The indexes, datasets, bitsets and arrays of the
+// queued searches must stay alive until Run returns.
+class SearchBatch {
+ public:
+    // 0 threads for one per core
+    SearchBatch(const int num_threads = 0) : num_threads_(num_threads) {
+    }
+
+    size_t
+    Size() {
+        return searches_.size();
+    }
+
+    // runs the queued searches and returns their statuses, in the order they were queued
+    std::vector<int>
+    Run() {
+        GILReleaser rel;
+        std::vector<int> statuses(searches_.size());
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next++; i < searches_.size(); i = next++) {
+                statuses[i] = static_cast<int>(searches_[i]());
+            }
+        };
+        const size_t num_threads =
+            num_threads_ > 0 ? static_cast<size_t>(num_threads_) : std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < std::min(num_threads, searches_.size()); ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        searches_.clear();
+        return statuses;
+    }
+
+ private:
+    template <typename T>
+    friend class IndexWrap;
+
+    int num_threads_;
+    std::vector<std::function<knowhere::Status()>> searches_;
+};
+
 template<typename T>
 class IndexWrap {
  public:
@@ -197,6 +252,22 @@ class IndexWrap {
         }
     }
 
+    // queues a search whose nq * k results are written straight to dis and ids by batch.Run()
+    void
+    SearchAsync(SearchBatch& batch, knowhere::DataSetPtr dataset, const std::string& json,
+                const knowhere::BitsetView& bitset, float* dis, int nq_1, int k_1, int64_t* ids, int nq_2, int k_2) {
+        auto cfg = knowhere::Json::parse(json);
+        if (nq_1 != nq_2 || k_1 != k_2 || nq_1 != dataset->GetRows() || !cfg.contains(knowhere::meta::TOPK) ||
+            cfg[knowhere::meta::TOPK].get<int>() != k_1) {
+            batch.searches_.emplace_back([]() { return knowhere::Status::invalid_args; });
+            return;
+        }
+        batch.searches_.emplace_back([this, dataset, cfg = std::move(cfg), bitset, dis, ids]() {
+            auto res = idx.value().SearchWithBuf(dataset, cfg, bitset, ids, dis);
+            return res.has_value() ? knowhere::Status::success : res.error();
+        });
+    }
+
     std::vector<AnnIteratorWrap>
     GetAnnIterator(knowhere::DataSetPtr dataset, const std::string& json, const knowhere::BitsetView& bitset, knowhere::Status& status) {
         GILReleaser rel;
@@ -324,38 +395,24 @@ Array2DataSetF(float* xb, int nb, int dim) {
 };
 
 knowhere::DataSetPtr
-Array2DataSetFP16(float* xb, int nb, int dim) {
+Array2DataSetFP16(uint16_t* xb, int nb, int dim) {
     auto ds = std::make_shared<DataSet>();
-    ds->SetIsOwner(true);
+    ds->SetIsOwner(false);
     ds->SetRows(nb);
     ds->SetDim(dim);
-    // float to fp16
-    auto fp16_data = new knowhere::fp16[nb * dim];
-    for (int i = 0; i < nb * dim; ++i) {
-        fp16_data[i] = knowhere::fp16(xb[i]);
-    }
-    ds->SetTensor(fp16_data);
+    ds->SetTensor(reinterpret_cast<const knowhere::fp16*>(xb));
     return ds;
 };
 
-#pragma GCC push_options
-#pragma GCC optimize("O0")
 knowhere::DataSetPtr
-Array2DataSetBF16(float* xb, int nb, int dim) {
-    using bf16 = knowhere::bf16;
+Array2DataSetBF16(uint16_t* xb, int nb, int dim) {
     auto ds = std::make_shared<DataSet>();
-    ds->SetIsOwner(true);
+    ds->SetIsOwner(false);
     ds->SetRows(nb);
     ds->SetDim(dim);
-    bf16* bf16_data = new bf16[nb * dim];
-    for (int i = 0; i < nb * dim; ++i) {
-        bf16_data[i] = knowhere::bf16(xb[i]);
-    }
-
-    ds->SetTensor(bf16_data);
+    ds->SetTensor(reinterpret_cast<const knowhere::bf16*>(xb));
     return ds;
 };
-#pragma GCC pop_options
 
 int32_t
 CurrentVersion() {
@@ -701,6 +758,7 @@ SetSearchThreadPool(uint32_t num_threads) {
 %}
 
 %template(AnnIteratorWrapVector) std::vector<AnnIteratorWrap>;
+%template(IntVector) std::vector<int>;
 
 %template(IndexWrapFloat) IndexWrap<float>;
 %template(IndexWrapFP16) IndexWrap<knowhere::fp16>;
@@ -51,12 +51,24 @@ Cluster<T>::Assign(const DataSet& dataset) {
     return this->node->Assign(dataset);
 }
 
+template <typename T>
+inline expected<DataSetPtr>
+Cluster<T>::AssignTopM(const DataSet& dataset, const int64_t m) {
+    return this->node->AssignTopM(dataset, m);
+}
+
 template <typename T>
 inline expected<DataSetPtr>
 Cluster<T>::GetCentroids() const {
     return this->node->GetCentroids();
 }
 
+template <typename T>
+inline Status
+Cluster<T>::SetCentroids(const DataSet& centroids) {
+    return this->node->SetCentroids(centroids);
+}
+
 template <typename T>
 inline std::string
 Cluster<T>::Type() const {
@@ -0,0 +1,101 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef CLUSTER_ASSIGN_H
+#define CLUSTER_ASSIGN_H
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "faiss/utils/distances.h"
+#include "knowhere/comp/task.h"
+#include "knowhere/dataset.h"
+#include "knowhere/expected.h"
+#include "knowhere/log.h"
+#include "knowhere/operands.h"
+
+namespace knowhere {
+
+// the rows of a tile of the assignment, whose distances to the centroids are a GEMM
+constexpr int64_t kClusterAssignTileRows = 1024;
+
+// Finds the m nearest centroids of every row of the dataset in L2, nearest first, as (rows, m, ids, distances). The
+// tiles of rows are spread over the build pool, converted to fp32 if needed, and their distances to all the centroids
+// are computed with BLAS, which is much faster than a search per row once there are many centroids.
+template <typename DataType>
+inline expected<DataSetPtr>
+AssignTopM(const DataSet& dataset, const float* centroids, const int64_t num_centroids, const int64_t dim,
+           const int64_t m) {
+    const auto rows = dataset.GetRows();
+    if (dataset.GetDim() != dim || dataset.GetTensor() == nullptr) {
+        return expected<DataSetPtr>::Err(Status::invalid_args, "dim differs from that of the centroids");
+    }
+    if (m <= 0 || m > num_centroids) {
+        return expected<DataSetPtr>::Err(Status::invalid_args, "m should be in [1, num_clusters]");
+    }
+    std::vector<float> centroid_norms(num_centroids);
+    faiss::fvec_norms_L2sqr(centroid_norms.data(), centroids, dim, num_centroids);
+
+    auto ids = std::make_unique<int64_t[]>(rows * m);
+    auto distances = std::make_unique<float[]>(rows * m);
+    const auto data = static_cast<const DataType*>(dataset.GetTensor());
+    const size_t num_tiles = (rows + kClusterAssignTileRows - 1) / kClusterAssignTileRows;
+    try {
+        ParallelForOverBuildThreadPool(
+            num_tiles, kClusterAssignTileRows * num_centroids * dim, [&](size_t begin, size_t end) {
+                std::vector<float> tile;
+                for (size_t t = begin; t < end; ++t) {
+                    const int64_t row_begin = t * kClusterAssignTileRows;
+                    const int64_t tile_rows = std::min(kClusterAssignTileRows, rows - row_begin);
+                    const float* x = nullptr;
+                    if constexpr (std::is_same_v<DataType, fp32>) {
+                        x = data + row_begin * dim;
+                    } else {
+                        tile.resize(tile_rows * dim);
+                        for (int64_t i = 0; i < tile_rows * dim; ++i) {
+                            tile[i] = static_cast<float>(data[row_begin * dim + i]);
+                        }
+                        x = tile.data();
+                    }
+                    faiss::knn_L2sqr_blas(x, centroids, dim, tile_rows, num_centroids, m,
+                                          distances.get() + row_begin * m, ids.get() + row_begin * m,
+                                          centroid_norms.data());
+                }
+            });
+    } catch (const std::exception& e) {
+        LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+        return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+    }
+    return GenResultDataSet(rows, m, std::move(ids), std::move(distances));
+}
+
+// the nearest centroid of every row, as the (rows, uint32_t* id_mapping) of ClusterNode::Assign
+template <typename DataType>
+inline expected<DataSetPtr>
+AssignNearest(const DataSet& dataset, const float* centroids, const int64_t num_centroids, const int64_t dim) {
+    auto res = AssignTopM<DataType>(dataset, centroids, num_centroids, dim, 1);
+    if (!res.has_value()) {
+        return res;
+    }
+    const auto rows = dataset.GetRows();
+    const auto ids = res.value()->GetIds();
+    auto id_mapping = std::make_unique<uint32_t[]>(rows);
+    for (int64_t i = 0; i < rows; ++i) {
+        id_mapping[i] = static_cast<uint32_t>(ids[i]);
+    }
+    return GenResultDataSet(rows, 1, std::move(id_mapping));
+}
+
+}  // namespace knowhere
+
+#endif /* CLUSTER_ASSIGN_H */
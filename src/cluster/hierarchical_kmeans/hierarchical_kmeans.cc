@@ -0,0 +1,123 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "cluster/cluster_assign.h"
+#include "cluster/hierarchical_kmeans/hierarchical_kmeans_config.h"
+#include "faiss/Clustering.h"
+#include "knowhere/cluster/cluster_factory.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/log.h"
+#include "knowhere/thread_pool.h"
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+// Two-level balanced k-means for a large number of clusters: about sqrt(k) coarse clusters are split into fine
+// clusters in proportion to their sizes, and the sizes of the fine clusters are capped, see
+// faiss::hierarchical_balanced_kmeans. Train returns the balanced assignment of the training rows, Assign the nearest
+// centroid of every row.
+template <typename DataType>
+class HierarchicalKmeansClusterNode : public ClusterNode {
+ public:
+    HierarchicalKmeansClusterNode(const Object& object) {
+    }
+
+    expected<DataSetPtr>
+    Train(const DataSet& dataset, const Config& cfg) override {
+        const auto& kmeans_cfg = static_cast<const HierarchicalKmeansConfig&>(cfg);
+        const auto rows = dataset.GetRows();
+        const auto dim = dataset.GetDim();
+        const auto k = kmeans_cfg.num_clusters.value();
+        if (rows <= 0 || dim <= 0 || dataset.GetTensor() == nullptr) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "empty dataset");
+        }
+        if (rows < k) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "the dataset has fewer rows than num_clusters");
+        }
+        auto data_ds = ConvertFromDataTypeIfNeeded<DataType>(GenDataSet(rows, dim, dataset.GetTensor()));
+        const auto data = static_cast<const float*>(data_ds->GetTensor());
+
+        ThreadPool::ScopedBuildOmpSetter setter;
+        faiss::ClusteringParameters cp;
+        cp.niter = kmeans_cfg.max_iter.value();
+        cp.seed = kmeans_cfg.seed.value();
+        std::vector<float> centroids(k * dim);
+        std::vector<faiss::idx_t> assign(rows);
+        try {
+            faiss::hierarchical_balanced_kmeans(dim, rows, k, data, centroids.data(), cp,
+                                                kmeans_cfg.max_balance.value(), assign.data());
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        }
+
+        centroids_ = std::move(centroids);
+        num_clusters_ = k;
+        dim_ = dim;
+
+        auto id_mapping = std::make_unique<uint32_t[]>(rows);
+        for (int64_t i = 0; i < rows; ++i) {
+            id_mapping[i] = static_cast<uint32_t>(assign[i]);
+        }
+        return GenResultDataSet(rows, 1, std::move(id_mapping));
+    }
+
+    expected<DataSetPtr>
+    Assign(const DataSet& dataset) override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "cluster not trained");
+        }
+        return AssignNearest<DataType>(dataset, centroids_.data(), num_clusters_, dim_);
+    }
+
+    expected<DataSetPtr>
+    AssignTopM(const DataSet& dataset, const int64_t m) override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "cluster not trained");
+        }
+        return knowhere::AssignTopM<DataType>(dataset, centroids_.data(), num_clusters_, dim_, m);
+    }
+
+    expected<DataSetPtr>
+    GetCentroids() const override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "cluster not trained");
+        }
+        auto centroids = std::make_unique<float[]>(centroids_.size());
+        std::memcpy(centroids.get(), centroids_.data(), centroids_.size() * sizeof(float));
+        return GenResultDataSet(num_clusters_, dim_, std::move(centroids));
+    }
+
+    std::unique_ptr<Config>
+    CreateConfig() const override {
+        return std::make_unique<HierarchicalKmeansConfig>();
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::ClusterEnum::CLUSTER_HIERARCHICAL_KMEANS;
+    }
+
+ private:
+    std::vector<float> centroids_;
+    int64_t num_clusters_ = 0;
+    int64_t dim_ = 0;
+};
+
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(HIERARCHICAL_KMEANS, HierarchicalKmeansClusterNode, fp32);
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(HIERARCHICAL_KMEANS, HierarchicalKmeansClusterNode, fp16);
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(HIERARCHICAL_KMEANS, HierarchicalKmeansClusterNode, bf16);
+
+}  // namespace knowhere
@@ -0,0 +1,50 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef HIERARCHICAL_KMEANS_CONFIG_H
+#define HIERARCHICAL_KMEANS_CONFIG_H
+
+#include "knowhere/config.h"
+
+namespace knowhere {
+
+class HierarchicalKmeansConfig : public BaseConfig {
+ public:
+    CFG_INT num_clusters;
+    CFG_INT max_iter;
+    // A cluster holds at most max_balance times the mean size of the clusters of its coarse cluster.
+    CFG_FLOAT max_balance;
+    CFG_INT seed;
+    KNOHWERE_DECLARE_CONFIG(HierarchicalKmeansConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(num_clusters)
+            .description("the number of clusters.")
+            .set_range(1, std::numeric_limits<int32_t>::max())
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(max_iter)
+            .description("the number of k-means iterations of the coarse and of the fine clusterings.")
+            .set_default(10)
+            .set_range(1, 1024)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(max_balance)
+            .description("the bound on the size of a cluster over the mean size, at least 1.")
+            .set_default(1.2f)
+            .set_range(1.0f, 16.0f)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(seed)
+            .description("the seed of the clusterings.")
+            .set_default(1234)
+            .for_cluster();
+    }
+};
+
+}  // namespace knowhere
+
+#endif /* HIERARCHICAL_KMEANS_CONFIG_H */
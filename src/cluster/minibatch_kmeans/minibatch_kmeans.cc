@@ -0,0 +1,181 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "cluster/cluster_assign.h"
+#include "cluster/minibatch_kmeans/minibatch_kmeans_config.h"
+#include "knowhere/cluster/cluster_factory.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/log.h"
+#include "knowhere/thread_pool.h"
+#include "knowhere/utils.h"
+#include "simd/hook.h"
+
+namespace knowhere {
+
+// Mini-batch k-means (Sculley, "Web-scale k-means clustering"), for data that is streamed in chunks: every Train call
+// consumes one chunk, and with warm_start the centroids of the previous calls are updated instead of trained again.
+// A centroid moves towards every row of a mini-batch that is assigned to it with a learning rate of 1 / (the number of
+// rows assigned to it so far), so that it is the running mean of its rows over all the chunks.
+template <typename DataType>
+class MiniBatchKmeansClusterNode : public ClusterNode {
+ public:
+    MiniBatchKmeansClusterNode(const Object& object) {
+    }
+
+    expected<DataSetPtr>
+    Train(const DataSet& dataset, const Config& cfg) override {
+        const auto& kmeans_cfg = static_cast<const MiniBatchKmeansConfig&>(cfg);
+        const auto rows = dataset.GetRows();
+        const auto dim = dataset.GetDim();
+        const auto k = kmeans_cfg.num_clusters.value();
+        if (rows <= 0 || dim <= 0 || dataset.GetTensor() == nullptr) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "empty dataset");
+        }
+        auto data_ds = ConvertFromDataTypeIfNeeded<DataType>(GenDataSet(rows, dim, dataset.GetTensor()));
+        const auto data = static_cast<const float*>(data_ds->GetTensor());
+
+        std::mt19937 rng(kmeans_cfg.seed.value());
+        if (!kmeans_cfg.warm_start.value() || centroids_.empty()) {
+            if (rows < k) {
+                return expected<DataSetPtr>::Err(Status::invalid_args,
+                                                 "the first chunk has fewer rows than num_clusters");
+            }
+            InitCentroids(data, rows, dim, k, rng);
+        } else if (dim != dim_ || k != num_clusters_) {
+            return expected<DataSetPtr>::Err(Status::invalid_args,
+                                             "the dim or num_clusters differ from those of the current centroids");
+        }
+
+        ThreadPool::ScopedBuildOmpSetter setter;
+        const int64_t batch_size = std::min<int64_t>(kmeans_cfg.batch_size.value(), rows);
+        std::vector<int64_t> order(rows);
+        std::vector<uint32_t> batch_assign(batch_size);
+        for (int iter = 0; iter < kmeans_cfg.max_iter.value(); ++iter) {
+            std::iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), rng);
+            for (int64_t begin = 0; begin < rows; begin += batch_size) {
+                const int64_t end = std::min(begin + batch_size, rows);
+                // the assignment of a mini-batch is against the centroids from before its update
+#pragma omp parallel
+                {
+                    std::vector<float> distances_tmp(num_clusters_);
+#pragma omp for
+                    for (int64_t i = begin; i < end; ++i) {
+                        batch_assign[i - begin] = faiss::fvec_L2sqr_ny_nearest(
+                            distances_tmp.data(), data + order[i] * dim_, centroids_.data(), dim_, num_clusters_);
+                    }
+                }
+                for (int64_t i = begin; i < end; ++i) {
+                    const auto c = batch_assign[i - begin];
+                    const float* x = data + order[i] * dim_;
+                    float* centroid = centroids_.data() + c * dim_;
+                    const float eta = 1.0f / static_cast<float>(++counts_[c]);
+                    for (int64_t j = 0; j < dim_; ++j) {
+                        centroid[j] += eta * (x[j] - centroid[j]);
+                    }
+                }
+            }
+        }
+
+        return AssignNearest<DataType>(dataset, centroids_.data(), num_clusters_, dim_);
+    }
+
+    expected<DataSetPtr>
+    Assign(const DataSet& dataset) override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "cluster not trained");
+        }
+        return AssignNearest<DataType>(dataset, centroids_.data(), num_clusters_, dim_);
+    }
+
+    expected<DataSetPtr>
+    AssignTopM(const DataSet& dataset, const int64_t m) override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "cluster not trained");
+        }
+        return knowhere::AssignTopM<DataType>(dataset, centroids_.data(), num_clusters_, dim_, m);
+    }
+
+    expected<DataSetPtr>
+    GetCentroids() const override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "cluster not trained");
+        }
+        auto centroids = std::make_unique<float[]>(centroids_.size());
+        std::memcpy(centroids.get(), centroids_.data(), centroids_.size() * sizeof(float));
+        return GenResultDataSet(num_clusters_, dim_, std::move(centroids));
+    }
+
+    Status
+    SetCentroids(const DataSet& centroids) override {
+        const auto k = centroids.GetRows();
+        const auto dim = centroids.GetDim();
+        if (k <= 0 || dim <= 0 || centroids.GetTensor() == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "empty centroids";
+            return Status::invalid_args;
+        }
+        // the centroids are fp32, as those of GetCentroids
+        const auto data = static_cast<const float*>(centroids.GetTensor());
+        centroids_.assign(data, data + k * dim);
+        counts_.assign(k, 0);
+        num_clusters_ = k;
+        dim_ = dim;
+        return Status::success;
+    }
+
+    std::unique_ptr<Config>
+    CreateConfig() const override {
+        return std::make_unique<MiniBatchKmeansConfig>();
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::ClusterEnum::CLUSTER_MINIBATCH_KMEANS;
+    }
+
+ private:
+    void
+    InitCentroids(const float* data, const int64_t rows, const int64_t dim, const int64_t k, std::mt19937& rng) {
+        std::vector<int64_t> perm(rows);
+        std::iota(perm.begin(), perm.end(), 0);
+        // a partial shuffle picks k distinct rows
+        for (int64_t i = 0; i < k; ++i) {
+            std::uniform_int_distribution<int64_t> dist(i, rows - 1);
+            std::swap(perm[i], perm[dist(rng)]);
+        }
+        centroids_.resize(k * dim);
+        for (int64_t i = 0; i < k; ++i) {
+            std::memcpy(centroids_.data() + i * dim, data + perm[i] * dim, dim * sizeof(float));
+        }
+        counts_.assign(k, 0);
+        num_clusters_ = k;
+        dim_ = dim;
+    }
+
+    std::vector<float> centroids_;
+    // the number of rows assigned to every centroid over all the Train calls
+    std::vector<int64_t> counts_;
+    int64_t num_clusters_ = 0;
+    int64_t dim_ = 0;
+};
+
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(MINIBATCH_KMEANS, MiniBatchKmeansClusterNode, fp32);
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(MINIBATCH_KMEANS, MiniBatchKmeansClusterNode, fp16);
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(MINIBATCH_KMEANS, MiniBatchKmeansClusterNode, bf16);
+
+}  // namespace knowhere
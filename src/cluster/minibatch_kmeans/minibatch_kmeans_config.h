@@ -0,0 +1,58 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef MINIBATCH_KMEANS_CONFIG_H
+#define MINIBATCH_KMEANS_CONFIG_H
+
+#include "knowhere/config.h"
+
+namespace knowhere {
+
+class MiniBatchKmeansConfig : public BaseConfig {
+ public:
+    CFG_INT num_clusters;
+    // The rows of a chunk that every centroid update is computed from.
+    CFG_INT batch_size;
+    // The passes over the chunk of a Train call.
+    CFG_INT max_iter;
+    // If set, a Train call continues from the centroids of the previous calls, or of SetCentroids, so that the data
+    // can be streamed in chunks; otherwise the centroids are initialized again from the rows of the chunk.
+    CFG_BOOL warm_start;
+    CFG_INT seed;
+    KNOHWERE_DECLARE_CONFIG(MiniBatchKmeansConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(num_clusters)
+            .description("the number of clusters.")
+            .set_range(1, 65536)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(batch_size)
+            .description("the number of rows of a mini-batch.")
+            .set_default(1024)
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(max_iter)
+            .description("the number of passes over the rows of a Train call.")
+            .set_default(1)
+            .set_range(1, 1024)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(warm_start)
+            .description("continue from the current centroids instead of initializing them again.")
+            .set_default(true)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(seed)
+            .description("the seed of the centroid initialization and of the mini-batch sampling.")
+            .set_default(1234)
+            .for_cluster();
+    }
+};
+
+}  // namespace knowhere
+
+#endif /* MINIBATCH_KMEANS_CONFIG_H */
@@ -0,0 +1,195 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/bitset_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace knowhere {
+
+namespace {
+
+constexpr size_t kWordBits = 64;
+
+size_t
+NumWords(size_t num_bits) {
+    return (num_bits + kWordBits - 1) / kWordBits;
+}
+
+// the bits of the last word that are in a bitset of num_bits bits
+uint64_t
+TailMask(size_t num_bits) {
+    const size_t rem = num_bits % kWordBits;
+    return rem == 0 ? ~uint64_t(0) : (uint64_t(1) << rem) - 1;
+}
+
+// the bits [lo, hi) of a word, 0 <= lo < hi <= 64
+uint64_t
+WordMask(size_t lo, size_t hi) {
+    const uint64_t below_hi = hi == kWordBits ? ~uint64_t(0) : (uint64_t(1) << hi) - 1;
+    return below_hi & ~((uint64_t(1) << lo) - 1);
+}
+
+// sets (or clears) the bits of mask in a word, returns the number of the bits that changed
+template <bool kSet>
+size_t
+Apply(uint64_t& word, uint64_t mask) {
+    const uint64_t changed = kSet ? (mask & ~word) : (mask & word);
+    word = kSet ? (word | mask) : (word & ~mask);
+    return __builtin_popcountll(changed);
+}
+
+// the ids of a word are gathered into one mask before it is written
+template <bool kSet>
+size_t
+ApplyIds(uint64_t* words, const uint32_t* ids, size_t num_ids, size_t num_bits) {
+    size_t changed = 0;
+    size_t i = 0;
+    while (i < num_ids) {
+        const size_t w = ids[i] / kWordBits;
+        uint64_t mask = 0;
+        for (; i < num_ids && ids[i] / kWordBits == w; i++) {
+            assert(ids[i] < num_bits);
+            mask |= uint64_t(1) << (ids[i] % kWordBits);
+        }
+        changed += Apply<kSet>(words[w], mask);
+    }
+    return changed;
+}
+
+template <bool kSet>
+size_t
+ApplyRanges(uint64_t* words, const BitsetBuilder::Range* ranges, size_t num_ranges, size_t num_bits) {
+    size_t changed = 0;
+    for (size_t r = 0; r < num_ranges; r++) {
+        size_t begin = ranges[r].first;
+        const size_t end = std::min<size_t>(ranges[r].second, num_bits);
+        while (begin < end) {
+            const size_t w = begin / kWordBits;
+            const size_t word_begin = w * kWordBits;
+            changed += Apply<kSet>(words[w], WordMask(begin - word_begin, std::min(end - word_begin, kWordBits)));
+            begin = word_begin + kWordBits;
+        }
+    }
+    return changed;
+}
+
+// the w-th word of a bitmap of num_bytes bytes, which does not have to be a whole number of words
+uint64_t
+LoadWord(const uint8_t* bytes, size_t num_bytes, size_t w) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes + w * sizeof(uint64_t), std::min(sizeof(uint64_t), num_bytes - w * sizeof(uint64_t)));
+    return word;
+}
+
+}  // namespace
+
+BitsetBuilder::BitsetBuilder(size_t num_bits, bool filled)
+    : words_(AllocateResultBuffer<uint64_t>(std::max<size_t>(NumWords(num_bits), 1))),
+      num_bits_(num_bits),
+      num_filtered_out_bits_(filled ? num_bits : 0) {
+    const size_t num_words = NumWords(num_bits);
+    std::fill_n(words_.get(), num_words, filled ? ~uint64_t(0) : 0);
+    if (filled && num_words > 0) {
+        words_[num_words - 1] &= TailMask(num_bits);
+    }
+}
+
+void
+BitsetBuilder::Load(const BitsetView& view) {
+    assert(!view.has_out_ids() && view.size() == num_bits_);
+    const size_t num_words = NumWords(num_bits_);
+    if (num_words == 0) {
+        return;
+    }
+    words_[num_words - 1] = 0;
+    view.copy_bits_to(reinterpret_cast<uint8_t*>(words_.get()));
+    words_[num_words - 1] &= TailMask(num_bits_);
+}
+
+template <typename Op>
+void
+BitsetBuilder::Combine(const BitsetView& b, Op op) {
+    assert(!b.has_out_ids() && b.size() == num_bits_);
+    // a bitset given by its valid ids is expanded first
+    ResultBuffer<uint8_t> expanded;
+    const uint8_t* b_bits = b.data();
+    if (b.has_valid_ids()) {
+        expanded = AllocateResultBuffer<uint8_t>(std::max<size_t>(b.byte_size(), 1));
+        b.copy_bits_to(expanded.get());
+        b_bits = expanded.get();
+    }
+    const size_t num_words = NumWords(num_bits_);
+    size_t count = 0;
+    for (size_t w = 0; w < num_words; w++) {
+        words_[w] = op(words_[w], LoadWord(b_bits, b.byte_size(), w));
+        if (w + 1 == num_words) {
+            words_[w] &= TailMask(num_bits_);
+        }
+        count += __builtin_popcountll(words_[w]);
+    }
+    num_filtered_out_bits_ = count;
+}
+
+BitsetBuilder
+BitsetBuilder::FromFilteredOutIds(const uint32_t* ids, size_t num_ids, size_t num_bits) {
+    BitsetBuilder res(num_bits, false);
+    res.num_filtered_out_bits_ += ApplyIds<true>(res.words_.get(), ids, num_ids, num_bits);
+    return res;
+}
+
+BitsetBuilder
+BitsetBuilder::FromValidIds(const uint32_t* ids, size_t num_ids, size_t num_bits) {
+    BitsetBuilder res(num_bits, true);
+    res.num_filtered_out_bits_ -= ApplyIds<false>(res.words_.get(), ids, num_ids, num_bits);
+    return res;
+}
+
+BitsetBuilder
+BitsetBuilder::FromFilteredOutRanges(const Range* ranges, size_t num_ranges, size_t num_bits) {
+    BitsetBuilder res(num_bits, false);
+    res.num_filtered_out_bits_ += ApplyRanges<true>(res.words_.get(), ranges, num_ranges, num_bits);
+    return res;
+}
+
+BitsetBuilder
+BitsetBuilder::FromValidRanges(const Range* ranges, size_t num_ranges, size_t num_bits) {
+    BitsetBuilder res(num_bits, true);
+    res.num_filtered_out_bits_ -= ApplyRanges<false>(res.words_.get(), ranges, num_ranges, num_bits);
+    return res;
+}
+
+BitsetBuilder
+BitsetBuilder::And(const BitsetView& a, const BitsetView& b) {
+    BitsetBuilder res(a.size(), false);
+    res.Load(a);
+    res.Combine(b, [](uint64_t x, uint64_t y) { return x & y; });
+    return res;
+}
+
+BitsetBuilder
+BitsetBuilder::Or(const BitsetView& a, const BitsetView& b) {
+    BitsetBuilder res(a.size(), false);
+    res.Load(a);
+    res.Combine(b, [](uint64_t x, uint64_t y) { return x | y; });
+    return res;
+}
+
+BitsetBuilder
+BitsetBuilder::Not(const BitsetView& a) {
+    BitsetBuilder res(a.size(), false);
+    res.Combine(a, [](uint64_t, uint64_t y) { return ~y; });
+    return res;
+}
+
+}  // namespace knowhere
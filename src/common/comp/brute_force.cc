@@ -11,15 +11,18 @@
 
 #include "knowhere/comp/brute_force.h"
 
+#include <mutex>
 #include <vector>
 
 #include "common/metric.h"
 #include "faiss/MetricType.h"
+#include "faiss/utils/Heap.h"
 #include "faiss/utils/binary_distances.h"
 #include "faiss/utils/distances.h"
 #include "faiss/utils/distances_typed.h"
 #include "index/minhash/minhash_util.h"
 #include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/numa.h"
 #include "knowhere/comp/task.h"
 #include "knowhere/config.h"
 #include "knowhere/emb_list_utils.h"
@@ -41,10 +44,17 @@ namespace knowhere {
 /* If the ids of base_dataset does not start from 0, the BF functions will filter based on the real ids and return the
  * real ids.*/
 
-class BruteForceConfig : public BaseConfig {};
+class BruteForceConfig : public BaseConfig {
+ public:
+    KNOHWERE_DECLARE_CONFIG(BruteForceConfig) {
+    }
+};
 
 namespace {
 
+// the iterators over bases of at least this many rows keep a bounded buffer of results rather than all the distances
+constexpr int64_t kBlockedIteratorMinRows = 65536;
+
 template <typename T>
 expected<sparse::DocValueComputer<T>>
 GetDocValueComputer(const BruteForceConfig& cfg) {
@@ -66,9 +76,10 @@ GetDocValueComputer(const BruteForceConfig& cfg) {
     }
 }
 
+// the inverse norms of the base vectors, which the cosine kernels multiply the inner products with
 template <typename DataType>
 std::unique_ptr<float[]>
-GetVecNorms(const DataSetPtr& base) {
+GetVecInverseNorms(const DataSetPtr& base) {
     using NormComputer = float (*)(const DataType*, size_t);
     NormComputer norm_computer;
     if constexpr (std::is_same_v<DataType, knowhere::fp32>) {
@@ -83,7 +94,7 @@ GetVecNorms(const DataSetPtr& base) {
     auto xb = (DataType*)base->GetTensor();
     auto nb = base->GetRows();
     auto dim = base->GetDim();
-    auto norms = std::make_unique<float[]>(nb);
+    auto inverse_norms = std::make_unique<float[]>(nb);
 
     // use build thread pool to compute norms
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
@@ -95,12 +106,47 @@ GetVecNorms(const DataSetPtr& base) {
         auto last = std::min(i + chunk_size, nb);
         futs.emplace_back(pool->push([&, beg_id = i, end_id = last] {
             for (auto j = beg_id; j < end_id; j++) {
-                norms[j] = std::sqrt(norm_computer(xb + j * dim, dim));
+                const float norm = std::sqrt(norm_computer(xb + j * dim, dim));
+                inverse_norms[j] = (norm == 0.0f) ? 1.0f : (1.0f / norm);
             }
         }));
     }
     WaitAllSuccess(futs);
-    return norms;
+    return inverse_norms;
+}
+
+// merges the top-k of a chunk into the heaps of the queries. The results of a chunk are sorted, the merge of a query
+// stops at the first one its heap rejects.
+template <class C>
+void
+MergeChunkResults(const int64_t nq, const int64_t topk, const float* chunk_dis, const int64_t* chunk_ids,
+                  float* heap_dis, int64_t* heap_ids) {
+    for (int64_t i = 0; i < nq; i++) {
+        auto cur_heap_dis = heap_dis + i * topk;
+        auto cur_heap_ids = heap_ids + i * topk;
+        for (int64_t j = i * topk; j < (i + 1) * topk; j++) {
+            if (chunk_ids[j] == -1 || !C::cmp(cur_heap_dis[0], chunk_dis[j])) {
+                break;
+            }
+            faiss::heap_replace_top<C>(topk, cur_heap_dis, cur_heap_ids, chunk_dis[j], chunk_ids[j]);
+        }
+    }
+}
+
+template <class C>
+void
+HeapifyQueries(const int64_t nq, const int64_t topk, float* heap_dis, int64_t* heap_ids) {
+    for (int64_t i = 0; i < nq; i++) {
+        faiss::heap_heapify<C>(topk, heap_dis + i * topk, heap_ids + i * topk);
+    }
+}
+
+template <class C>
+void
+ReorderQueries(const int64_t nq, const int64_t topk, float* heap_dis, int64_t* heap_ids) {
+    for (int64_t i = 0; i < nq; i++) {
+        faiss::heap_reorder<C>(topk, heap_dis + i * topk, heap_ids + i * topk);
+    }
 }
 }  // namespace
 
@@ -116,19 +162,90 @@ BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset
     }
     auto nq = query_dataset->GetRows();
     int topk = cfg.k.value();
-    auto labels = std::make_unique<int64_t[]>(nq * topk);
-    auto distances = std::make_unique<float[]>(nq * topk);
+    auto labels = AllocateResultBuffer<int64_t>(nq * topk);
+    auto distances = AllocateResultBuffer<float>(nq * topk);
 
     auto search_status =
         SearchWithBuf<DataType>(base_dataset, query_dataset, labels.get(), distances.get(), config, bitset_);
-    if (search_status != Status::success) {
+    if (search_status != Status::success && search_status != Status::timeout) {
         return expected<DataSetPtr>::Err(search_status, "search with buf failed");
     }
-    auto res = GenResultDataSet(nq, cfg.k.value(), std::move(labels), std::move(distances));
+    expected<DataSetPtr> res = GenResultDataSet(nq, cfg.k.value(), std::move(labels), std::move(distances));
+    // an interrupted search returns its partial results along with the timeout
+    if (search_status == Status::timeout) {
+        res = Status::timeout;
+        res << "the search was interrupted, the results are partial";
+    }
 
     return res;
 }
 
+template <typename DataType>
+expected<DataSetPtr>
+BruteForce::SearchChunks(const std::vector<DataSetPtr>& base_chunks, const DataSetPtr query_dataset,
+                         const Json& config, const BitsetView& bitset) {
+    BruteForceConfig cfg;
+    std::string msg;
+    auto status = Config::Load(cfg, config, knowhere::SEARCH, &msg);
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, msg);
+    }
+    std::string metric_str = cfg.metric_type.value();
+    if (IsMetricType(metric_str, metric::SUBSTRUCTURE) || IsMetricType(metric_str, metric::SUPERSTRUCTURE)) {
+        return expected<DataSetPtr>::Err(Status::invalid_metric_type,
+                                         "metric type not supported for chunks: " + metric_str);
+    }
+    if (query_dataset->GetLims() != nullptr) {
+        return expected<DataSetPtr>::Err(Status::invalid_args, "emb_list not supported for chunks");
+    }
+    for (const auto& chunk : base_chunks) {
+        if (chunk->GetLims() != nullptr) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "emb_list not supported for chunks");
+        }
+    }
+    const bool the_larger_the_closer = IsMetricType(metric_str, metric::IP) ||
+                                       IsMetricType(metric_str, metric::COSINE) ||
+                                       IsMetricType(metric_str, metric::MHJACCARD);
+
+    auto nq = query_dataset->GetRows();
+    int topk = cfg.k.value();
+    auto labels = AllocateResultBuffer<int64_t>(nq * topk);
+    auto distances = AllocateResultBuffer<float>(nq * topk);
+    // each chunk is searched on the pool into a scratch buffer, which is merged into the heaps of the queries
+    auto chunk_labels = AllocateResultBuffer<int64_t>(nq * topk);
+    auto chunk_distances = AllocateResultBuffer<float>(nq * topk);
+
+    if (the_larger_the_closer) {
+        HeapifyQueries<faiss::CMin<float, int64_t>>(nq, topk, distances.get(), labels.get());
+    } else {
+        HeapifyQueries<faiss::CMax<float, int64_t>>(nq, topk, distances.get(), labels.get());
+    }
+    for (const auto& chunk : base_chunks) {
+        if (chunk->GetRows() == 0) {
+            continue;
+        }
+        auto search_status =
+            SearchWithBuf<DataType>(chunk, query_dataset, chunk_labels.get(), chunk_distances.get(), config, bitset);
+        if (search_status != Status::success) {
+            return expected<DataSetPtr>::Err(search_status, "search with buf failed");
+        }
+        if (the_larger_the_closer) {
+            MergeChunkResults<faiss::CMin<float, int64_t>>(nq, topk, chunk_distances.get(), chunk_labels.get(),
+                                                           distances.get(), labels.get());
+        } else {
+            MergeChunkResults<faiss::CMax<float, int64_t>>(nq, topk, chunk_distances.get(), chunk_labels.get(),
+                                                           distances.get(), labels.get());
+        }
+    }
+    if (the_larger_the_closer) {
+        ReorderQueries<faiss::CMin<float, int64_t>>(nq, topk, distances.get(), labels.get());
+    } else {
+        ReorderQueries<faiss::CMax<float, int64_t>>(nq, topk, distances.get(), labels.get());
+    }
+
+    return GenResultDataSet(nq, topk, std::move(labels), std::move(distances));
+}
+
 template <typename DataType>
 Status
 BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_dataset, int64_t* ids, float* dis,
@@ -151,6 +268,8 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
 
     BruteForceConfig cfg;
     RETURN_IF_ERROR(Config::Load(cfg, config, knowhere::SEARCH));
+    const auto deadline = MakeSearchDeadline(cfg.search_timeout_ms.value());
+    ScopedSearchDeadline deadline_setter(deadline);
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     // LCOV_EXCL_START
@@ -269,18 +388,45 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
             }
         }
 
-        std::unique_ptr<float[]> norms = is_cosine ? GetVecNorms<DataType>(base_dataset) : nullptr;
+        std::unique_ptr<float[]> inverse_norms = is_cosine ? GetVecInverseNorms<DataType>(base_dataset) : nullptr;
         auto pool = ThreadPool::GetGlobalSearchThreadPool();
+        // the low precision types split the queries among the threads when every thread gets enough of them for
+        // the typed knn functions to compute its block with blas on the vectors converted to fp32
+        int64_t query_bs = 1;
+        if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
+            if (faiss_metric_type == faiss::METRIC_L2 || faiss_metric_type == faiss::METRIC_INNER_PRODUCT) {
+                int64_t num_threads = std::max<int64_t>(pool->size(), 1);
+                int64_t bs = (nq + num_threads - 1) / num_threads;
+                if (bs >= faiss::distance_compute_typed_blas_threshold) {
+                    query_bs = bs;
+                }
+            }
+        }
+        // a selective filter is turned into the list of the ids that pass it, for the queries to compute only them
+        std::unique_ptr<BitsetViewIDList> id_list = nullptr;
+        if constexpr (std::is_same_v<DataType, knowhere::fp32> || KnowhereLowPrecisionTypeCheck<DataType>::value) {
+            if ((faiss_metric_type == faiss::METRIC_L2 || faiss_metric_type == faiss::METRIC_INNER_PRODUCT) &&
+                BitsetViewIDList::pays_off(bitset)) {
+                id_list = std::make_unique<BitsetViewIDList>(bitset, nb);
+            }
+        }
         std::vector<folly::Future<Status>> futs;
-        futs.reserve(nq);
-        for (int i = 0; i < nq; ++i) {
-            futs.emplace_back(pool->push([&, index = i] {
+        futs.reserve((nq + query_bs - 1) / query_bs);
+        for (int64_t i = 0; i < nq; i += query_bs) {
+            futs.emplace_back(PushSearchTask(pool, [&, index = i, cur_nq = std::min(query_bs, nq - i)] {
                 ThreadPool::ScopedSearchOmpSetter setter(1);
                 auto cur_labels = labels + topk * index;
                 auto cur_distances = distances + topk * index;
+                if (SearchInterrupted()) {
+                    MarkMissingResults(labels, distances, topk, index, index + cur_nq);
+                    return Status::success;
+                }
 
                 BitsetViewIDSelector bw_idselector(bitset);
                 faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+                if (id_list != nullptr) {
+                    id_selector = &id_list->selector;
+                }
                 switch (faiss_metric_type) {
                     case faiss::METRIC_L2: {
                         [[maybe_unused]] auto cur_query = (const DataType*)xq + dim * index;
@@ -288,7 +434,7 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
                             faiss::knn_L2sqr(cur_query, (const float*)xb, dim, 1, nb, topk, cur_distances, cur_labels,
                                              nullptr, id_selector);
                         } else if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
-                            faiss::knn_L2sqr_typed(cur_query, (const DataType*)xb, dim, 1, nb, topk, cur_distances,
+                            faiss::knn_L2sqr_typed(cur_query, (const DataType*)xb, dim, cur_nq, nb, topk, cur_distances,
                                                    cur_labels, nullptr, id_selector);
                         } else {
                             LOG_KNOWHERE_ERROR_ << "Metric L2 not supported for current vector type";
@@ -301,13 +447,13 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
                         if (is_cosine) {
                             if constexpr (std::is_same_v<DataType, knowhere::fp32>) {
                                 auto copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                                faiss::knn_cosine(copied_query.get(), (const float*)xb, norms.get(), dim, 1, nb, topk,
-                                                  cur_distances, cur_labels, id_selector);
+                                faiss::knn_cosine(copied_query.get(), (const float*)xb, inverse_norms.get(), dim, 1,
+                                                  nb, topk, cur_distances, cur_labels, id_selector);
                             } else if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
                                 // normalize query vector may cause precision loss, so div query norms in apply
                                 // function
-                                faiss::knn_cosine_typed(cur_query, (const DataType*)xb, norms.get(), dim, 1, nb, topk,
-                                                        cur_distances, cur_labels, id_selector);
+                                faiss::knn_cosine_typed(cur_query, (const DataType*)xb, inverse_norms.get(), dim,
+                                                        cur_nq, nb, topk, cur_distances, cur_labels, id_selector);
                             } else {
                                 LOG_KNOWHERE_ERROR_ << "Metric COSINE not supported for current vector type";
                                 return Status::faiss_inner_error;
@@ -317,7 +463,7 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
                                 faiss::knn_inner_product(cur_query, (const float*)xb, dim, 1, nb, topk, cur_distances,
                                                          cur_labels, id_selector);
                             } else if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
-                                faiss::knn_inner_product_typed(cur_query, (const DataType*)xb, dim, 1, nb, topk,
+                                faiss::knn_inner_product_typed(cur_query, (const DataType*)xb, dim, cur_nq, nb, topk,
                                                                cur_distances, cur_labels, id_selector);
                             } else {
                                 LOG_KNOWHERE_ERROR_ << "Metric IP not supported for current vector type";
@@ -394,7 +540,7 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
     // LCOV_EXCL_STOP
 #endif
 
-    return Status::success;
+    return deadline.WasInterrupted() ? Status::timeout : Status::success;
 }
 
 /** knowhere wrapper API to call faiss brute force range search for all metric types
@@ -419,6 +565,8 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
     if (status != Status::success) {
         return expected<DataSetPtr>::Err(status, std::move(msg));
     }
+    const auto deadline = MakeSearchDeadline(cfg.search_timeout_ms.value());
+    ScopedSearchDeadline deadline_setter(deadline);
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     // LCOV_EXCL_START
@@ -462,9 +610,6 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
 
     bool is_cosine = IsMetricType(metric_str, metric::COSINE);
 
-    const bool the_larger_the_closer = IsMetricType(metric_str, metric::IP) ||
-                                       IsMetricType(metric_str, metric::COSINE) ||
-                                       IsMetricType(metric_str, metric::BM25);
     auto radius = cfg.radius.value();
     float range_filter = cfg.range_filter.value();
 
@@ -474,14 +619,18 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
         return expected<DataSetPtr>::Err(Status::not_implemented, "minhash not support range search.");
     }
 
-    std::vector<std::vector<int64_t>> result_id_array(nq);
-    std::vector<std::vector<float>> result_dist_array(nq);
+    RangeSearchResultArena arena(nq);
+    const bool has_range_filter = (range_filter != defaultRangeFilter);
 
-    std::unique_ptr<float[]> norms = is_cosine ? GetVecNorms<DataType>(base_dataset) : nullptr;
+    std::unique_ptr<float[]> inverse_norms = is_cosine ? GetVecInverseNorms<DataType>(base_dataset) : nullptr;
     std::vector<folly::Future<Status>> futs;
     futs.reserve(nq);
     for (int i = 0; i < nq; ++i) {
-        futs.emplace_back(pool->push([&, index = i] {
+        futs.emplace_back(PushSearchTask(pool, [&, index = i] {
+            // an interrupted search leaves the results of the remaining queries empty
+            if (SearchInterrupted()) {
+                return Status::success;
+            }
             if constexpr (std::is_same_v<DataType, knowhere::sparse::SparseRow<float>>) {
                 auto cur_query = (const sparse::SparseRow<float>*)xq + index;
                 auto xb_sparse = (const sparse::SparseRow<float>*)xb;
@@ -492,23 +641,26 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
                     if (!bitset.empty() && bitset.test(j)) {
                         continue;
                     }
-                    float row_sum = 0;
+                    float dist;
                     if (is_bm25) {
+                        float row_sum = 0;
                         for (size_t k = 0; k < xb_sparse[j].size(); ++k) {
                             auto [d, v] = xb_sparse[j][k];
                             row_sum += v;
                         }
+                        dist = cur_query->dot(xb_sparse[j], sparse_computer, row_sum);
+                    } else {
+                        // ip leaves the doc values as they are, the simd kernel multiplies the rows directly
+                        dist = faiss::sparse_ip(cur_query->data(), cur_query->size(), xb_sparse[j].data(),
+                                                xb_sparse[j].size());
                     }
-                    auto dist = cur_query->dot(xb_sparse[j], sparse_computer, row_sum);
                     if (dist > radius && dist <= range_filter) {
                         result.insert({dist, xid});
                     }
                 }
-                result_id_array[index].reserve(result.size());
-                result_dist_array[index].reserve(result.size());
+                auto writer = arena.GetWriter(index);
                 for (auto& [dist, id] : result) {
-                    result_id_array[index].push_back(id);
-                    result_dist_array[index].push_back(dist);
+                    writer.Add(id, dist);
                 }
                 return Status::success;
             } else {
@@ -538,12 +690,12 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
                         if (is_cosine) {
                             if constexpr (std::is_same_v<DataType, knowhere::fp32>) {
                                 auto copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                                faiss::range_search_cosine(copied_query.get(), (const float*)xb, norms.get(), dim, 1,
-                                                           nb, radius, &res, id_selector);
+                                faiss::range_search_cosine(copied_query.get(), (const float*)xb, inverse_norms.get(),
+                                                           dim, 1, nb, radius, &res, id_selector);
                             } else if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
                                 // normalize query vector may cause precision loss, so div query norms in apply function
-                                faiss::range_search_cosine_typed(cur_query, (const DataType*)xb, norms.get(), dim, 1,
-                                                                 nb, radius, &res, id_selector);
+                                faiss::range_search_cosine_typed(cur_query, (const DataType*)xb, inverse_norms.get(),
+                                                                 dim, 1, nb, radius, &res, id_selector);
                             } else {
                                 LOG_KNOWHERE_ERROR_ << "Metric COSINE not supported for current vector type";
                                 return Status::faiss_inner_error;
@@ -581,17 +733,12 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
                         return Status::invalid_metric_type;
                     }
                 }
-                auto elem_cnt = res.lims[1];
-                result_dist_array[index].resize(elem_cnt);
-                result_id_array[index].resize(elem_cnt);
-                for (size_t j = 0; j < elem_cnt; j++) {
-                    result_dist_array[index][j] = res.distances[j];
-                    result_id_array[index][j] = res.labels[j] + xb_id_offset;
-                }
-                if (cfg.range_filter.value() != defaultRangeFilter) {
-                    FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index],
-                                                    faiss_metric_type == faiss::METRIC_INNER_PRODUCT, radius,
-                                                    range_filter);
+                const bool is_ip = (faiss_metric_type == faiss::METRIC_INNER_PRODUCT);
+                auto writer = arena.GetWriter(index);
+                for (size_t j = 0; j < res.lims[1]; j++) {
+                    if (!has_range_filter || distance_in_range(res.distances[j], radius, range_filter, is_ip)) {
+                        writer.Add(res.labels[j] + xb_id_offset, res.distances[j]);
+                    }
                 }
                 return Status::success;
             }
@@ -602,9 +749,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
         return expected<DataSetPtr>::Err(ret, "failed to brute force search");
     }
 
-    auto range_search_result =
-        GetRangeSearchResult(result_dist_array, result_id_array, the_larger_the_closer, nq, radius, range_filter);
-    auto res = GenResultDataSet(nq, std::move(range_search_result));
+    expected<DataSetPtr> res = GenResultDataSet(nq, arena.Finish());
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     // LCOV_EXCL_START
@@ -614,6 +759,10 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
     // LCOV_EXCL_STOP
 #endif
 
+    if (deadline.WasInterrupted()) {
+        res = Status::timeout;
+        res << "the search was interrupted, the results are partial";
+    }
     return res;
 }
 
@@ -667,45 +816,124 @@ BruteForce::SearchSparseWithBuf(const DataSetPtr base_dataset, const DataSetPtr
     std::fill(distances, distances + nq * topk, std::numeric_limits<float>::quiet_NaN());
     std::fill(labels, labels + nq * topk, -1);
 
-    auto pool = ThreadPool::GetGlobalSearchThreadPool();
-    std::vector<folly::Future<folly::Unit>> futs;
-    futs.reserve(nq);
-    for (int64_t i = 0; i < nq; ++i) {
-        futs.emplace_back(pool->push([&, index = i] {
-            auto cur_labels = labels + topk * index;
-            auto cur_distances = distances + topk * index;
+    // the doc lengths of the base rows are shared by all the queries
+    std::vector<float> row_sums(is_bm25 ? rows : 0);
+    if (is_bm25) {
+        ParallelForOverSearchThreadPool(rows, 1, [&](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) {
+                float row_sum = 0;
+                for (size_t k = 0; k < base[j].size(); ++k) {
+                    row_sum += base[j][k].val;
+                }
+                row_sums[j] = row_sum;
+            }
+        });
+    }
 
-            const auto& row = xq[index];
-            if (row.size() == 0) {
-                return;
+    // The values of a query are scattered into a dense vector, so that a base row is scored by gathering the query
+    // values at its ids instead of merging it with the query. Queries with too large ids are merged with the rows.
+    constexpr size_t max_dense_query_dim = 1 << 20;
+    auto densify = [](const sparse::SparseRow<float>& row, std::vector<float>& dense) {
+        size_t dim = 0;
+        for (size_t k = 0; k < row.size(); ++k) {
+            dim = std::max<size_t>(dim, row[k].id + 1);
+        }
+        if (dim > max_dense_query_dim) {
+            dense.clear();
+            return;
+        }
+        dense.assign(dim, 0.0f);
+        for (size_t k = 0; k < row.size(); ++k) {
+            dense[row[k].id] += row[k].val;
+        }
+    };
+    // pushes the scores of the base rows [begin, end) against the query row into heap.
+    auto search_rows = [&](const sparse::SparseRow<float>& row, const std::vector<float>& dense, int64_t begin,
+                           int64_t end, sparse::MaxMinHeap<float>& heap) {
+        for (int64_t j = begin; j < end; ++j) {
+            auto x_id = j + xb_id_offset;
+            if (!bitset.empty() && bitset.test(x_id)) {
+                continue;
             }
-            sparse::MaxMinHeap<float> heap(topk);
-            for (int64_t j = 0; j < rows; ++j) {
-                auto x_id = j + xb_id_offset;
-                if (!bitset.empty() && bitset.test(x_id)) {
-                    continue;
-                }
-                float row_sum = 0;
-                if (is_bm25) {
+            float dist = 0.0f;
+            if (is_bm25) {
+                if (dense.empty()) {
+                    dist = row.dot(base[j], computer, row_sums[j]);
+                } else {
                     for (size_t k = 0; k < base[j].size(); ++k) {
                         auto [d, v] = base[j][k];
-                        row_sum += v;
+                        if (d < dense.size() && dense[d] != 0) {
+                            dist += dense[d] * computer(v, row_sums[j]);
+                        }
                     }
                 }
-                float dist = row.dot(base[j], computer, row_sum);
-                if (dist > 0) {
-                    heap.push(x_id, dist);
-                }
+            } else if (dense.empty()) {
+                dist = faiss::sparse_ip(row.data(), row.size(), base[j].data(), base[j].size());
+            } else {
+                dist = faiss::sparse_dense_ip(base[j].data(), base[j].size(), dense.data(), dense.size());
             }
-            int result_size = heap.size();
-            for (int j = result_size - 1; j >= 0; --j) {
-                cur_labels[j] = heap.top().id;
-                cur_distances[j] = heap.top().val;
-                heap.pop();
+            if (dist > 0) {
+                heap.push(x_id, dist);
             }
-        }));
+        }
+    };
+    auto collect = [&](sparse::MaxMinHeap<float>& heap, int64_t index) {
+        auto cur_labels = labels + topk * index;
+        auto cur_distances = distances + topk * index;
+        int result_size = heap.size();
+        for (int j = result_size - 1; j >= 0; --j) {
+            cur_labels[j] = heap.top().id;
+            cur_distances[j] = heap.top().val;
+            heap.pop();
+        }
+    };
+
+    if (nq >= static_cast<int64_t>(GetSearchThreadPoolSize())) {
+        // enough queries to keep all search threads busy, a query per task
+        auto pool = ThreadPool::GetGlobalSearchThreadPool();
+        std::vector<folly::Future<folly::Unit>> futs;
+        futs.reserve(nq);
+        for (int64_t i = 0; i < nq; ++i) {
+            futs.emplace_back(pool->push([&, index = i] {
+                const auto& row = xq[index];
+                if (row.size() == 0) {
+                    return;
+                }
+                std::vector<float> dense;
+                densify(row, dense);
+                sparse::MaxMinHeap<float> heap(topk);
+                search_rows(row, dense, 0, rows, heap);
+                collect(heap, index);
+            }));
+        }
+        WaitAllSuccess(futs);
+    } else {
+        // the base rows of each query are split among the search threads, whose heaps are merged.
+        size_t avg_nnz = 1;
+        if (rows > 0) {
+            avg_nnz = std::max<size_t>(1, (base[0].size() + base[rows - 1].size() + base[rows / 2].size()) / 3);
+        }
+        for (int64_t index = 0; index < nq; ++index) {
+            const auto& row = xq[index];
+            if (row.size() == 0) {
+                continue;
+            }
+            std::vector<float> dense;
+            densify(row, dense);
+            sparse::MaxMinHeap<float> heap(topk);
+            std::mutex heap_mutex;
+            ParallelForOverSearchThreadPool(rows, avg_nnz, [&](size_t begin, size_t end) {
+                sparse::MaxMinHeap<float> chunk_heap(topk);
+                search_rows(row, dense, begin, end, chunk_heap);
+                std::lock_guard lock(heap_mutex);
+                while (chunk_heap.size() > 0) {
+                    heap.push(chunk_heap.top().id, chunk_heap.top().val);
+                    chunk_heap.pop();
+                }
+            });
+            collect(heap, index);
+        }
     }
-    WaitAllSuccess(futs);
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     // LCOV_EXCL_START
@@ -782,30 +1010,30 @@ BruteForce::AnnIterator(const DataSetPtr base_dataset, const DataSetPtr query_da
     bool is_cosine = IsMetricType(metric_str, metric::COSINE);
     auto larger_is_closer = faiss::is_similarity_metric(faiss_metric_type) || is_cosine;
     auto vec = std::vector<IndexNode::IteratorPtr>(nq, nullptr);
-    std::shared_ptr<float[]> norms = GetVecNorms<DataType>(base_dataset);
+    std::shared_ptr<float[]> inverse_norms = is_cosine ? GetVecInverseNorms<DataType>(base_dataset) : nullptr;
 
     try {
         for (int i = 0; i < nq; ++i) {
-            // Heavy computations with `compute_dist_func` will be deferred until the first call to 'Iterator->Next()'.
-            auto compute_dist_func = [=]() -> std::vector<DistId> {
-                auto xb = base_dataset->GetTensor();
+            // fills the distances and the ids of the rows [begin, end) of the base
+            auto compute_block_func = [=](size_t begin, size_t end, std::vector<DistId>& distances_ids) {
+                auto xb = (const DataType*)base_dataset->GetTensor() + dim * begin;
                 auto xq = query_dataset->GetTensor();
                 auto xb_id_offset = base_dataset->GetTensorBeginId();
+                auto block_nb = end - begin;
                 BitsetView bitset = bitset_;
-                bitset.set_id_offset(xb_id_offset);
+                bitset.set_id_offset(xb_id_offset + begin);
                 BitsetViewIDSelector bw_idselector(bitset);
                 [[maybe_unused]] faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
-                auto max_dis =
-                    larger_is_closer ? std::numeric_limits<float>::lowest() : std::numeric_limits<float>::max();
-                std::vector<DistId> distances_ids(nb, {-1, max_dis});
+                [[maybe_unused]] auto block_inverse_norms =
+                    (inverse_norms == nullptr) ? nullptr : inverse_norms.get() + begin;
                 [[maybe_unused]] auto cur_query = (const DataType*)xq + dim * i;
                 switch (faiss_metric_type) {
                     case faiss::METRIC_L2: {
                         if constexpr (std::is_same_v<DataType, knowhere::fp32>) {
-                            faiss::all_L2sqr(cur_query, (const float*)xb, dim, 1, nb, distances_ids, nullptr,
+                            faiss::all_L2sqr(cur_query, (const float*)xb, dim, 1, block_nb, distances_ids, nullptr,
                                              id_selector);
                         } else if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
-                            faiss::all_L2sqr_typed(cur_query, (const DataType*)xb, dim, 1, nb, distances_ids, nullptr,
+                            faiss::all_L2sqr_typed(cur_query, xb, dim, 1, block_nb, distances_ids, nullptr,
                                                    id_selector);
                         } else {
                             std::string err_msg = "Metric L2 not supported for current vector type";
@@ -818,11 +1046,11 @@ BruteForce::AnnIterator(const DataSetPtr base_dataset, const DataSetPtr query_da
                         if (is_cosine) {
                             if constexpr (std::is_same_v<DataType, knowhere::fp32>) {
                                 auto copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                                faiss::all_cosine(copied_query.get(), (const float*)xb, norms.get(), dim, 1, nb,
-                                                  distances_ids, id_selector);
+                                faiss::all_cosine(copied_query.get(), (const float*)xb, block_inverse_norms, dim, 1,
+                                                  block_nb, distances_ids, id_selector);
                             } else if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
                                 // normalize query vector may cause precision loss, so div query norms in apply function
-                                faiss::all_cosine_typed(cur_query, (const DataType*)xb, norms.get(), dim, 1, nb,
+                                faiss::all_cosine_typed(cur_query, xb, block_inverse_norms, dim, 1, block_nb,
                                                         distances_ids, id_selector);
                             } else {
                                 std::string err_msg = "Metric COSINE not supported for current vector type";
@@ -831,11 +1059,11 @@ BruteForce::AnnIterator(const DataSetPtr base_dataset, const DataSetPtr query_da
                             }
                         } else {
                             if constexpr (std::is_same_v<DataType, knowhere::fp32>) {
-                                faiss::all_inner_product(cur_query, (const float*)xb, dim, 1, nb, distances_ids,
+                                faiss::all_inner_product(cur_query, (const float*)xb, dim, 1, block_nb, distances_ids,
                                                          id_selector);
                             } else if constexpr (KnowhereLowPrecisionTypeCheck<DataType>::value) {
-                                faiss::all_inner_product_typed(cur_query, (const DataType*)xb, dim, 1, nb,
-                                                               distances_ids, id_selector);
+                                faiss::all_inner_product_typed(cur_query, xb, dim, 1, block_nb, distances_ids,
+                                                               id_selector);
                             } else {
                                 std::string err_msg = "Metric IP not supported for current vector type";
                                 LOG_KNOWHERE_ERROR_ << err_msg;
@@ -850,15 +1078,30 @@ BruteForce::AnnIterator(const DataSetPtr base_dataset, const DataSetPtr query_da
                         KNOWHERE_THROW_MSG(err_msg);
                     }
                 }
-                if (xb_id_offset != 0) {
+                const int64_t id_offset = xb_id_offset + begin;
+                if (id_offset != 0) {
                     for (auto& distances_id : distances_ids) {
-                        distances_id.id = distances_id.id == -1 ? -1 : distances_id.id + xb_id_offset;
+                        distances_id.id = distances_id.id == -1 ? -1 : distances_id.id + id_offset;
                     }
                 }
-                return distances_ids;
             };
-            vec[i] = std::make_shared<PrecomputedDistanceIterator>(compute_dist_func, larger_is_closer,
+            if (nb >= kBlockedIteratorMinRows) {
+                // large bases are not materialized, the distances are computed again for each batch of results
+                vec[i] = std::make_shared<BlockedDistanceIterator>(compute_block_func, nb, larger_is_closer,
                                                                    use_knowhere_search_pool);
+            } else {
+                // Heavy computations with `compute_dist_func` will be deferred until the first call to
+                // 'Iterator->Next()'.
+                auto compute_dist_func = [=]() -> std::vector<DistId> {
+                    auto max_dis =
+                        larger_is_closer ? std::numeric_limits<float>::lowest() : std::numeric_limits<float>::max();
+                    std::vector<DistId> distances_ids(nb, {-1, max_dis});
+                    compute_block_func(0, nb, distances_ids);
+                    return distances_ids;
+                };
+                vec[i] = std::make_shared<PrecomputedDistanceIterator>(compute_dist_func, larger_is_closer,
+                                                                       use_knowhere_search_pool);
+            }
         }
     } catch (const std::exception& e) {
         return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::brute_force_inner_error, e.what());
@@ -935,14 +1178,17 @@ BruteForce::AnnIterator<knowhere::sparse::SparseRow<float>>(const DataSetPtr bas
                         if (!bitset.empty() && bitset.test(xb_id)) {
                             continue;
                         }
-                        float row_sum = 0;
+                        float dist;
                         if (is_bm25) {
+                            float row_sum = 0;
                             for (size_t k = 0; k < base[j].size(); ++k) {
                                 auto [d, v] = base[j][k];
                                 row_sum += v;
                             }
+                            dist = row.dot(base[j], computer, row_sum);
+                        } else {
+                            dist = faiss::sparse_ip(row.data(), row.size(), base[j].data(), base[j].size());
                         }
-                        auto dist = row.dot(base[j], computer, row_sum);
                         if (dist > 0) {
                             distances_ids.emplace_back(xb_id, dist);
                         }
@@ -989,6 +1235,27 @@ knowhere::BruteForce::Search<knowhere::bin1>(const knowhere::DataSetPtr base_dat
                                              const knowhere::DataSetPtr query_dataset, const knowhere::Json& config,
                                              const knowhere::BitsetView& bitset);
 
+template knowhere::expected<knowhere::DataSetPtr>
+knowhere::BruteForce::SearchChunks<knowhere::fp32>(const std::vector<knowhere::DataSetPtr>& base_chunks,
+                                                   const knowhere::DataSetPtr query_dataset,
+                                                   const knowhere::Json& config, const knowhere::BitsetView& bitset);
+template knowhere::expected<knowhere::DataSetPtr>
+knowhere::BruteForce::SearchChunks<knowhere::fp16>(const std::vector<knowhere::DataSetPtr>& base_chunks,
+                                                   const knowhere::DataSetPtr query_dataset,
+                                                   const knowhere::Json& config, const knowhere::BitsetView& bitset);
+template knowhere::expected<knowhere::DataSetPtr>
+knowhere::BruteForce::SearchChunks<knowhere::bf16>(const std::vector<knowhere::DataSetPtr>& base_chunks,
+                                                   const knowhere::DataSetPtr query_dataset,
+                                                   const knowhere::Json& config, const knowhere::BitsetView& bitset);
+template knowhere::expected<knowhere::DataSetPtr>
+knowhere::BruteForce::SearchChunks<knowhere::int8>(const std::vector<knowhere::DataSetPtr>& base_chunks,
+                                                   const knowhere::DataSetPtr query_dataset,
+                                                   const knowhere::Json& config, const knowhere::BitsetView& bitset);
+template knowhere::expected<knowhere::DataSetPtr>
+knowhere::BruteForce::SearchChunks<knowhere::bin1>(const std::vector<knowhere::DataSetPtr>& base_chunks,
+                                                   const knowhere::DataSetPtr query_dataset,
+                                                   const knowhere::Json& config, const knowhere::BitsetView& bitset);
+
 template knowhere::Status
 knowhere::BruteForce::SearchWithBuf<knowhere::fp32>(const knowhere::DataSetPtr base_dataset,
                                                     const knowhere::DataSetPtr query_dataset, int64_t* ids, float* dis,
@@ -0,0 +1,115 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/build_scheduler.h"
+
+#include <algorithm>
+
+#include "knowhere/log.h"
+#include "knowhere/thread_pool.h"
+
+namespace knowhere {
+
+BuildReservation::~BuildReservation() {
+    scheduler_->Release(bytes_);
+}
+
+BuildScheduler&
+BuildScheduler::GetInstance() {
+    static BuildScheduler scheduler;
+    return scheduler;
+}
+
+void
+BuildScheduler::SetMemoryBudget(int64_t bytes) {
+    decltype(AdmitWaiters()) admitted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_ = std::max<int64_t>(0, bytes);
+        admitted = AdmitWaiters();
+    }
+    for (auto& [waiter, reservation] : admitted) {
+        waiter.promise.setValue(std::move(reservation));
+    }
+}
+
+int64_t
+BuildScheduler::GetMemoryBudget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+int64_t
+BuildScheduler::GetReservedMemory() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reserved_;
+}
+
+size_t
+BuildScheduler::GetRunningBuilds() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+folly::SemiFuture<std::shared_ptr<BuildReservation>>
+BuildScheduler::AdmitAsync(int64_t bytes) {
+    bytes = std::max<int64_t>(0, bytes);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (waiters_.empty() && Fits(bytes)) {
+        return folly::makeSemiFuture(Reserve(bytes));
+    }
+    LOG_KNOWHERE_INFO_ << "Build of " << bytes << " bytes waits for admission, " << reserved_ << " of " << budget_
+                       << " bytes reserved by " << running_ << " builds";
+    waiters_.push_back(Waiter{bytes, folly::Promise<std::shared_ptr<BuildReservation>>()});
+    return waiters_.back().promise.getSemiFuture();
+}
+
+void
+BuildScheduler::Release(int64_t bytes) {
+    decltype(AdmitWaiters()) admitted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reserved_ -= bytes;
+        running_--;
+        admitted = AdmitWaiters();
+    }
+    for (auto& [waiter, reservation] : admitted) {
+        waiter.promise.setValue(std::move(reservation));
+    }
+}
+
+std::deque<std::pair<BuildScheduler::Waiter, std::shared_ptr<BuildReservation>>>
+BuildScheduler::AdmitWaiters() {
+    std::deque<std::pair<Waiter, std::shared_ptr<BuildReservation>>> admitted;
+    // strictly in arrival order, so a large build is not starved by the small ones behind it
+    while (!waiters_.empty() && Fits(waiters_.front().bytes)) {
+        auto reservation = Reserve(waiters_.front().bytes);
+        admitted.emplace_back(std::move(waiters_.front()), std::move(reservation));
+        waiters_.pop_front();
+    }
+    return admitted;
+}
+
+bool
+BuildScheduler::Fits(int64_t bytes) const {
+    return budget_ == 0 || running_ == 0 || reserved_ + bytes <= budget_;
+}
+
+std::shared_ptr<BuildReservation>
+BuildScheduler::Reserve(int64_t bytes) {
+    reserved_ += bytes;
+    running_++;
+    const auto pool_size = static_cast<int64_t>(ThreadPool::GetGlobalBuildThreadPoolSize());
+    const auto num_threads = static_cast<int32_t>(std::max<int64_t>(1, pool_size / static_cast<int64_t>(running_)));
+    return std::shared_ptr<BuildReservation>(new BuildReservation(this, bytes, num_threads));
+}
+
+}  // namespace knowhere
@@ -0,0 +1,147 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "knowhere/comp/huge_page.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+namespace {
+
+std::atomic<HugePagePolicy> huge_page_policy{HugePagePolicy::NONE};
+// whether the hugetlb pool ran out, logged once
+std::atomic<bool> hugetlb_exhausted{false};
+
+constexpr size_t kDefaultHugePageSize = 2UL << 20;
+
+// the default huge page size of the kernel, that of the transparent huge pages and of MAP_HUGETLB
+size_t
+ReadHugePageSize() {
+    std::ifstream in("/proc/meminfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("Hugepagesize:", 0) == 0) {
+            const size_t kb = std::strtoull(line.c_str() + std::strlen("Hugepagesize:"), nullptr, 10);
+            return kb != 0 ? kb << 10 : kDefaultHugePageSize;
+        }
+    }
+    return kDefaultHugePageSize;
+}
+
+size_t
+RoundUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+void
+SetHugePagePolicy(HugePagePolicy policy) {
+    huge_page_policy.store(policy);
+    hugetlb_exhausted.store(false);
+}
+
+HugePagePolicy
+GetHugePagePolicy() {
+    return huge_page_policy.load();
+}
+
+size_t
+HugePageSize() {
+    static const size_t size = ReadHugePageSize();
+    return size;
+}
+
+std::unique_ptr<HugePageBuffer>
+HugePageBuffer::Allocate(size_t size) {
+#ifdef __linux__
+    const auto policy = GetHugePagePolicy();
+    const size_t page = HugePageSize();
+    if (policy == HugePagePolicy::NONE || size < page) {
+        return nullptr;
+    }
+    const size_t mapped_size = RoundUp(size, page);
+    if (policy == HugePagePolicy::EXPLICIT) {
+        void* data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                          -1, 0);
+        if (data != MAP_FAILED) {
+            return std::unique_ptr<HugePageBuffer>(new HugePageBuffer(data, size, mapped_size, true));
+        }
+        if (!hugetlb_exhausted.exchange(true)) {
+            LOG_KNOWHERE_WARNING_ << "Failed to map " << mapped_size << " bytes of hugetlb pages, falling back to "
+                                  << "transparent huge pages: " << strerror(errno);
+        }
+    }
+
+    // over-maps by a huge page to align the buffer on one, for the kernel to back all of it with huge pages
+    void* mapped = mmap(nullptr, mapped_size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        LOG_KNOWHERE_WARNING_ << "Failed to map " << mapped_size << " bytes for huge pages: " << strerror(errno);
+        return nullptr;
+    }
+    const auto begin = reinterpret_cast<uintptr_t>(mapped);
+    const auto aligned = RoundUp(begin, page);
+    if (aligned != begin) {
+        munmap(mapped, aligned - begin);
+    }
+    munmap(reinterpret_cast<void*>(aligned + mapped_size), begin + page - aligned);
+    void* data = reinterpret_cast<void*>(aligned);
+    // advised before it is first touched, so that its faults allocate huge pages right away
+    if (madvise(data, mapped_size, MADV_HUGEPAGE) != 0) {
+        LOG_KNOWHERE_WARNING_ << "Failed to advise transparent huge pages: " << strerror(errno);
+    }
+    return std::unique_ptr<HugePageBuffer>(new HugePageBuffer(data, size, mapped_size, false));
+#else
+    return nullptr;
+#endif
+}
+
+HugePageBuffer::HugePageBuffer(void* data, size_t size, size_t mapped_size, bool explicit_pages)
+    : data_(data), size_(size), mapped_size_(mapped_size), explicit_pages_(explicit_pages) {
+}
+
+HugePageBuffer::~HugePageBuffer() {
+#ifdef __linux__
+    munmap(data_, mapped_size_);
+#endif
+}
+
+void
+AdviseHugePages(const void* data, size_t size) {
+#ifdef __linux__
+    const size_t page = HugePageSize();
+    if (GetHugePagePolicy() == HugePagePolicy::NONE || size < page) {
+        return;
+    }
+    // only the huge pages that the range covers entirely can back it
+    const auto begin = RoundUp(reinterpret_cast<uintptr_t>(data), page);
+    const auto end = (reinterpret_cast<uintptr_t>(data) + size) / page * page;
+    if (begin < end && madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE) != 0) {
+        LOG_KNOWHERE_DEBUG_ << "Failed to advise transparent huge pages: " << strerror(errno);
+    }
+#endif
+}
+
+}  // namespace knowhere
@@ -11,14 +11,25 @@
 
 #include "knowhere/comp/knowhere_config.h"
 
+#include <limits>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #ifdef KNOWHERE_WITH_DISKANN
 #include "diskann/aio_context_pool.h"
+#include "diskann/io_scheduler.h"
+#include "diskann/range_reader.h"
 #endif
 #include "faiss/Clustering.h"
 #include "faiss/utils/distances.h"
+#include "io/compressed_io.h"
+#include "knowhere/comp/build_scheduler.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/search_stage.h"
+#include "knowhere/comp/task.h"
 #include "knowhere/log.h"
+#include "knowhere/prometheus_client.h"
 #include "knowhere/thread_pool.h"
 #ifdef KNOWHERE_WITH_GPU
 #include "index/gpu/gpu_res_mgr.h"
@@ -27,6 +38,7 @@
 #include "common/cuvs/integration/raft_initialization.hpp"
 #include "cuda_runtime_api.h"
 #endif
+#include "simd/calibration.h"
 #include "simd/hook.h"
 
 namespace knowhere {
@@ -90,6 +102,36 @@ KnowhereConfig::SetSimdType(const SimdType simd_type) {
     return simd_str;
 }
 
+std::string
+KnowhereConfig::CalibrateSimdKernels() {
+    // the gauges of the previous calibration, its kernels may not be installed anymore
+    static std::mutex gauges_mutex;
+    static std::vector<prometheus::Gauge*> gauges;
+
+    const auto choices = faiss::fvec_calibrate();
+    std::lock_guard<std::mutex> lock(gauges_mutex);
+    for (auto gauge : gauges) {
+        simd_kernel_latency_family.Remove(gauge);
+    }
+    gauges.clear();
+    std::string res;
+    for (const auto& choice : choices) {
+        const std::string max_dim =
+            choice.max_dim == std::numeric_limits<size_t>::max() ? "inf" : std::to_string(choice.max_dim);
+        LOG_KNOWHERE_INFO_ << "Calibrated " << choice.function << " up to dim " << max_dim << ": " << choice.kernel
+                           << ", " << choice.ns_per_call << " ns";
+        auto& gauge = simd_kernel_latency_family.Add(
+            {{"function", choice.function}, {"max_dim", max_dim}, {"kernel", choice.kernel}});
+        gauge.Set(choice.ns_per_call);
+        gauges.push_back(&gauge);
+        res += (res.empty() ? "" : " ") + choice.function + ":" + max_dim + "=" + choice.kernel;
+    }
+    if (choices.empty()) {
+        LOG_KNOWHERE_INFO_ << "No simd kernels to calibrate, keep the FAISS hook";
+    }
+    return res;
+}
+
 void
 KnowhereConfig::EnablePatchForComputeFP32AsBF16() {
     LOG_KNOWHERE_INFO_ << "Enable patch for compute fp32 as bf16";
@@ -138,6 +180,28 @@ KnowhereConfig::SetClusteringType(const ClusteringType clustering_type) {
     }
 }
 
+void
+KnowhereConfig::SetClusteringMiniBatchSize(const size_t mini_batch_size) {
+    LOG_KNOWHERE_INFO_ << "Set faiss::kmeans_minibatch_size to " << mini_batch_size;
+    faiss::kmeans_minibatch_size = mini_batch_size;
+}
+
+size_t
+KnowhereConfig::GetClusteringMiniBatchSize() {
+    return faiss::kmeans_minibatch_size;
+}
+
+void
+KnowhereConfig::SetClusteringTimeBudget(const double time_budget) {
+    LOG_KNOWHERE_INFO_ << "Set faiss::kmeans_time_budget to " << time_budget;
+    faiss::kmeans_time_budget = time_budget;
+}
+
+double
+KnowhereConfig::GetClusteringTimeBudget() {
+    return faiss::kmeans_time_budget;
+}
+
 bool
 KnowhereConfig::SetAioContextPool(size_t num_ctx) {
 #ifdef KNOWHERE_WITH_DISKANN
@@ -146,9 +210,34 @@ KnowhereConfig::SetAioContextPool(size_t num_ctx) {
     return true;
 }
 
+void
+KnowhereConfig::SetDiskIOQuota(size_t quota) {
+#ifdef KNOWHERE_WITH_DISKANN
+    LOG_KNOWHERE_INFO_ << "Set the disk IO quota of an index to " << quota;
+    IOScheduler::SetQuota(quota);
+#endif
+}
+
+size_t
+KnowhereConfig::GetDiskIOQuota() {
+#ifdef KNOWHERE_WITH_DISKANN
+    return IOScheduler::GetQuota();
+#endif
+    return 0;
+}
+
+#ifdef KNOWHERE_WITH_DISKANN
+void
+KnowhereConfig::SetDiskRangeReader(std::shared_ptr<RangeReader> reader) {
+    LOG_KNOWHERE_INFO_ << (reader != nullptr ? "Set" : "Unset") << " the disk range reader";
+    RangeReader::SetGlobalRangeReader(std::move(reader));
+}
+#endif
+
 void
 KnowhereConfig::SetBuildThreadPoolSize(size_t num_threads) {
     knowhere::ThreadPool::SetGlobalBuildThreadPoolSize(num_threads);
+    InstrumentThreadPools();
 }
 
 size_t
@@ -156,9 +245,16 @@ KnowhereConfig::GetBuildThreadPoolSize() {
     return knowhere::ThreadPool::GetGlobalBuildThreadPoolSize();
 }
 
+void
+KnowhereConfig::SetBuildMemoryBudget(int64_t bytes) {
+    LOG_KNOWHERE_INFO_ << "Set the build memory budget to " << bytes << " bytes";
+    BuildScheduler::GetInstance().SetMemoryBudget(bytes);
+}
+
 void
 KnowhereConfig::SetSearchThreadPoolSize(size_t num_threads) {
     knowhere::ThreadPool::SetGlobalSearchThreadPoolSize(num_threads);
+    InstrumentThreadPools();
 }
 
 size_t
@@ -166,6 +262,47 @@ KnowhereConfig::GetSearchThreadPoolSize() {
     return knowhere::ThreadPool::GetGlobalSearchThreadPoolSize();
 }
 
+void
+KnowhereConfig::SetNumaMode(bool enable) {
+    LOG_KNOWHERE_INFO_ << "Set NUMA mode to " << enable;
+    knowhere::SetNumaMode(enable);
+}
+
+bool
+KnowhereConfig::IsNumaModeEnabled() {
+    return knowhere::IsNumaModeEnabled();
+}
+
+void
+KnowhereConfig::SetHugePagePolicy(HugePagePolicy policy) {
+    LOG_KNOWHERE_INFO_ << "Set the huge page policy to " << static_cast<int>(policy);
+    knowhere::SetHugePagePolicy(policy);
+}
+
+void
+KnowhereConfig::SetSearchQueueLimit(int32_t priority, size_t limit) {
+    LOG_KNOWHERE_INFO_ << "Set the search queue limit of priority " << priority << " to " << limit;
+    knowhere::SetSearchQueueLimit(ToSearchPriority(priority), limit);
+}
+
+void
+KnowhereConfig::SetSearchAdmissionWait(bool wait) {
+    LOG_KNOWHERE_INFO_ << "Set the shed searches to " << (wait ? "wait" : "fail");
+    knowhere::SetSearchAdmissionPolicy(wait ? SearchAdmissionPolicy::WAIT : SearchAdmissionPolicy::REJECT);
+}
+
+void
+KnowhereConfig::SetSearchStageSampling(uint32_t every) {
+    LOG_KNOWHERE_INFO_ << "Set the search stage sampling to 1 in " << every;
+    knowhere::SetSearchStageSampling(every);
+}
+
+void
+KnowhereConfig::SetBinaryCompressionLevel(int level) {
+    LOG_KNOWHERE_INFO_ << "Set the binary compression level to " << level;
+    knowhere::SetBinaryCompressionLevel(level);
+}
+
 void
 KnowhereConfig::InitGPUResource(int64_t gpu_id, int64_t res_num) {
 #ifdef KNOWHERE_WITH_GPU
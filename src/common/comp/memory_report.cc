@@ -0,0 +1,123 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "knowhere/comp/memory_report.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "knowhere/log.h"
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+#include "knowhere/prometheus_client.h"
+#endif
+
+namespace knowhere {
+
+namespace {
+
+constexpr const char* kMemoryComponentNames[kNumMemoryComponents] = {
+    "graph", "codes", "raw_data", "refine_data", "id_map", "centroids", "cache", "scratch", "other"};
+
+// the pages of the range that are in memory
+size_t
+ResidentBytes(const void* data, size_t bytes) {
+    static const size_t page = sysconf(_SC_PAGESIZE);
+    const auto begin = reinterpret_cast<uintptr_t>(data) / page * page;
+    const auto end = reinterpret_cast<uintptr_t>(data) + bytes;
+    std::vector<unsigned char> pages((end - begin + page - 1) / page);
+    if (mincore(reinterpret_cast<void*>(begin), end - begin, pages.data()) != 0) {
+        LOG_KNOWHERE_DEBUG_ << "Failed to count the resident pages of " << bytes << " bytes: " << strerror(errno);
+        return 0;
+    }
+    size_t resident = 0;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i] & 1) {
+            // the first and the last pages may be shared with the neighbouring data
+            const auto page_begin = std::max<uintptr_t>(begin + i * page, reinterpret_cast<uintptr_t>(data));
+            const auto page_end = std::min<uintptr_t>(begin + (i + 1) * page, end);
+            resident += page_end - page_begin;
+        }
+    }
+    return resident;
+}
+
+}  // namespace
+
+const char*
+MemoryComponentName(MemoryComponent component) {
+    return kMemoryComponentNames[static_cast<size_t>(component)];
+}
+
+void
+MemoryReport::AddMapped(MemoryComponent component, const void* data, size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    auto& usage = usages_[static_cast<size_t>(component)];
+    usage.mapped_bytes += bytes;
+    usage.mapped_resident_bytes += ResidentBytes(data, bytes);
+}
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+namespace {
+
+template <typename Func>
+void
+ForEachMemoryGauge(const std::string& index_id, Func&& func) {
+    for (size_t i = 0; i < kNumMemoryComponents; ++i) {
+        const auto component = static_cast<MemoryComponent>(i);
+        for (const char* kind : {"heap", "mapped", "mapped_resident"}) {
+            auto& gauge = index_memory_bytes_family.Add(
+                {{"index_id", index_id}, {"component", MemoryComponentName(component)}, {"kind", kind}});
+            func(gauge, component, std::string(kind));
+        }
+    }
+}
+
+}  // namespace
+
+void
+ExportMemoryReport(const std::string& index_id, const MemoryReport& report) {
+    ForEachMemoryGauge(index_id, [&](prometheus::Gauge& gauge, MemoryComponent component, const std::string& kind) {
+        const auto& usage = report.Get(component);
+        if (kind == "heap") {
+            gauge.Set(usage.heap_bytes);
+        } else if (kind == "mapped") {
+            gauge.Set(usage.mapped_bytes);
+        } else {
+            gauge.Set(usage.mapped_resident_bytes);
+        }
+    });
+}
+
+void
+RemoveMemoryReport(const std::string& index_id) {
+    ForEachMemoryGauge(index_id, [&](prometheus::Gauge& gauge, MemoryComponent, const std::string&) {
+        index_memory_bytes_family.Remove(&gauge);
+    });
+}
+#else
+void
+ExportMemoryReport(const std::string& /*index_id*/, const MemoryReport& /*report*/) {
+}
+
+void
+RemoveMemoryReport(const std::string& /*index_id*/) {
+}
+#endif
+
+}  // namespace knowhere
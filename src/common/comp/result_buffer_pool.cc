@@ -0,0 +1,150 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/result_buffer_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <new>
+#include <vector>
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+#include "knowhere/prometheus_client.h"
+#endif
+
+namespace knowhere {
+
+namespace {
+
+constexpr size_t kMinShift = 6;
+constexpr size_t kMaxShift = 24;
+constexpr size_t kNumClasses = kMaxShift - kMinShift + 1;
+static_assert(ResultBufferPool::kMinBytes == 1UL << kMinShift && ResultBufferPool::kMaxBytes == 1UL << kMaxShift);
+
+// the hits and misses are counted per thread and added to the shared counters in batches
+constexpr size_t kMetricsBatch = 256;
+
+size_t
+SizeClass(size_t bytes) {
+    size_t shift = kMinShift;
+    while ((1UL << shift) < bytes) {
+        shift++;
+    }
+    return shift - kMinShift;
+}
+
+size_t
+ClassBytes(size_t size_class) {
+    return 1UL << (size_class + kMinShift);
+}
+
+struct ThreadCache {
+    std::array<std::vector<void*>, kNumClasses> free_lists;
+    size_t cached_bytes = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    void
+    FlushMetrics() {
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+        knowhere_result_buffer_pool_hits.Increment(hits);
+        knowhere_result_buffer_pool_misses.Increment(misses);
+#endif
+        hits = 0;
+        misses = 0;
+    }
+
+    void
+    Count(bool hit) {
+        (hit ? hits : misses)++;
+        if (hits + misses >= kMetricsBatch) {
+            FlushMetrics();
+        }
+    }
+
+    ~ThreadCache();
+};
+
+// set once the cache of the thread is destroyed, the buffers released at thread exit after it go to the heap
+thread_local bool cache_destroyed = false;
+
+ThreadCache::~ThreadCache() {
+    cache_destroyed = true;
+    for (auto& free_list : free_lists) {
+        for (auto p : free_list) {
+            ::operator delete[](p);
+        }
+    }
+    FlushMetrics();
+}
+
+ThreadCache*
+LocalCache() {
+    if (cache_destroyed) {
+        return nullptr;
+    }
+    thread_local ThreadCache cache;
+    return &cache;
+}
+
+}  // namespace
+
+void*
+ResultBufferPool::Allocate(size_t bytes) {
+    auto cache = LocalCache();
+    if (bytes > kMaxBytes || cache == nullptr) {
+        if (cache != nullptr) {
+            cache->Count(false);
+        }
+        return ::operator new[](std::max<size_t>(bytes, 1));
+    }
+    const size_t size_class = SizeClass(bytes);
+    auto& free_list = cache->free_lists[size_class];
+    if (free_list.empty()) {
+        cache->Count(false);
+        return ::operator new[](ClassBytes(size_class));
+    }
+    cache->Count(true);
+    auto p = free_list.back();
+    free_list.pop_back();
+    cache->cached_bytes -= ClassBytes(size_class);
+    return p;
+}
+
+void
+ResultBufferPool::Release(void* p, size_t bytes) {
+    if (p == nullptr) {
+        return;
+    }
+    auto cache = LocalCache();
+    if (bytes > kMaxBytes || cache == nullptr) {
+        ::operator delete[](p);
+        return;
+    }
+    const size_t size_class = SizeClass(bytes);
+    auto& free_list = cache->free_lists[size_class];
+    // a class keeps at least one buffer, as long as the thread is within its total
+    if (free_list.size() >= std::max<size_t>(kCachedBytesPerClass / ClassBytes(size_class), 1) ||
+        cache->cached_bytes + ClassBytes(size_class) > kMaxCachedBytes) {
+        ::operator delete[](p);
+        return;
+    }
+    free_list.push_back(p);
+    cache->cached_bytes += ClassBytes(size_class);
+}
+
+size_t
+ResultBufferPool::CachedBytes() {
+    auto cache = LocalCache();
+    return cache == nullptr ? 0 : cache->cached_bytes;
+}
+
+}  // namespace knowhere
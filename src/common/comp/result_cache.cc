@@ -0,0 +1,169 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "knowhere/comp/result_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+namespace {
+
+inline uint64_t
+HashCombine(uint64_t h, uint64_t v) {
+    return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+inline uint64_t
+HashBytes(const uint8_t* x, size_t len) {
+    uint64_t h = seed;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, x + i, sizeof(word));
+        h = h * 13331 + word;
+    }
+    for (; i < len; ++i) {
+        h = h * 13331 + x[i];
+    }
+    return h;
+}
+
+}  // namespace
+
+SearchResultCache::SearchResultCache(size_t capacity, DataFormatEnum data_format, float key_step)
+    : capacity_(capacity), data_format_(data_format), key_step_(key_step) {
+}
+
+size_t
+SearchResultCache::RowBytes(int64_t dim) const {
+    switch (data_format_) {
+        case DataFormatEnum::fp32:
+            return dim * sizeof(float);
+        case DataFormatEnum::fp16:
+        case DataFormatEnum::bf16:
+            return dim * sizeof(uint16_t);
+        case DataFormatEnum::int8:
+            return dim;
+        case DataFormatEnum::bin1:
+            return (dim + 7) / 8;
+    }
+    return 0;
+}
+
+uint64_t
+SearchResultCache::QueryKey(const void* tensor, int64_t row, int64_t dim, uint64_t salt) const {
+    const auto* x = static_cast<const uint8_t*>(tensor) + row * RowBytes(dim);
+    uint64_t h = seed;
+    switch (data_format_) {
+        case DataFormatEnum::fp32:
+            if (key_step_ > 0.0f) {
+                const auto* v = reinterpret_cast<const float*>(x);
+                for (int64_t i = 0; i < dim; ++i) {
+                    h = h * 13331 + static_cast<uint64_t>(std::llround(v[i] / key_step_));
+                }
+            } else {
+                h = hash_vec(reinterpret_cast<const float*>(x), dim);
+            }
+            break;
+        case DataFormatEnum::fp16:
+        case DataFormatEnum::bf16:
+            h = hash_half_precision_float(x, dim);
+            break;
+        case DataFormatEnum::int8:
+            h = hash_u8_vec(x, dim);
+            break;
+        case DataFormatEnum::bin1:
+            h = hash_binary_vec(x, dim);
+            break;
+    }
+    return HashCombine(HashCombine(h, dim), salt);
+}
+
+std::string
+SearchResultCache::QueryBytes(const void* tensor, int64_t row, int64_t dim) const {
+    const auto row_bytes = RowBytes(dim);
+    const auto* x = static_cast<const char*>(tensor) + row * row_bytes;
+    if (data_format_ != DataFormatEnum::fp32 || key_step_ <= 0.0f) {
+        return std::string(x, row_bytes);
+    }
+    const auto* v = reinterpret_cast<const float*>(x);
+    std::string res(dim * sizeof(int64_t), '\0');
+    for (int64_t i = 0; i < dim; ++i) {
+        const int64_t rounded = std::llround(v[i] / key_step_);
+        std::memcpy(res.data() + i * sizeof(int64_t), &rounded, sizeof(rounded));
+    }
+    return res;
+}
+
+uint64_t
+SearchResultCache::SearchSalt(const std::string& config, const BitsetView& bitset) {
+    uint64_t h = std::hash<std::string>{}(config);
+    if (bitset.empty()) {
+        return h;
+    }
+    h = HashCombine(h, bitset.size());
+    if (bitset.has_valid_ids()) {
+        return HashCombine(h, HashBytes(reinterpret_cast<const uint8_t*>(bitset.valid_ids_data()),
+                                        bitset.num_valid_ids() * sizeof(uint32_t)));
+    }
+    return HashCombine(h, HashBytes(bitset.data(), bitset.byte_size()));
+}
+
+bool
+SearchResultCache::Lookup(uint64_t key, const std::string& query, int64_t k, int64_t* ids, float* distances) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || static_cast<int64_t>(it->second->ids.size()) != k || it->second->query != query) {
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    std::copy(it->second->ids.begin(), it->second->ids.end(), ids);
+    std::copy(it->second->distances.begin(), it->second->distances.end(), distances);
+    return true;
+}
+
+void
+SearchResultCache::Insert(uint64_t key, const std::string& query, int64_t k, const int64_t* ids,
+                          const float* distances) {
+    std::lock_guard lock(mutex_);
+    if (auto it = entries_.find(key); it != entries_.end()) {
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+    lru_.push_front(
+        Entry{key, query, std::vector<int64_t>(ids, ids + k), std::vector<float>(distances, distances + k)});
+    entries_[key] = lru_.begin();
+    while (entries_.size() > capacity_) {
+        entries_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+}
+
+void
+SearchResultCache::Clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+}
+
+size_t
+SearchResultCache::Size() const {
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+}  // namespace knowhere
@@ -0,0 +1,89 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/search_planner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knowhere {
+
+namespace {
+
+bool
+Allows(uint32_t allowed, SearchStrategy strategy) {
+    return (allowed & static_cast<uint32_t>(strategy)) != 0;
+}
+
+}  // namespace
+
+SearchPlan
+PlanSearch(const SearchProfile& profile, uint32_t allowed) {
+    if ((allowed & kAllSearchStrategies) == 0) {
+        allowed = kAllSearchStrategies;
+    }
+
+    const double num_rows = profile.num_rows;
+    const double num_valid_rows = std::min(profile.num_valid_rows, profile.num_rows);
+    const bool filtered = profile.num_valid_rows < profile.num_rows;
+    const double p = num_rows > 0 ? num_valid_rows / num_rows : 1.0;
+    const double ef = std::max(profile.ef, profile.k);
+    const double degree = profile.graph_degree;
+    const double descent = std::log2(std::max<double>(num_rows, 2));
+    const double random_access = SearchCostModel::kRandomAccessBytes *
+                                 (profile.mmapped ? SearchCostModel::kMmappedRandomAccessFactor : 1.0);
+    const double graph_distance_cost = profile.code_size + random_access;
+
+    SearchPlan plan;
+
+    // the traversal computes the distances to the filtered out neighbors as to the others
+    const double graph_distances = p > 0 ? std::min((ef / p + descent) * degree, num_rows) : num_rows;
+    plan.graph_cost = graph_distances * graph_distance_cost;
+
+    // the two-hop traversal reads the neighbor lists of the filtered out neighbors without computing their distances
+    const double expanded = ef + descent;
+    const double two_hop_distances = std::min(expanded * degree * p * (1 + (1 - p) * degree), num_valid_rows);
+    plan.two_hop_cost = two_hop_distances * graph_distance_cost + expanded * degree * (1 - p) * random_access;
+
+    plan.brute_force_cost = num_valid_rows * profile.code_size;
+    if (filtered) {
+        plan.brute_force_cost += num_rows * SearchCostModel::kFilterTestBytes;
+    }
+    if (profile.resolves_out_ids) {
+        plan.brute_force_cost += num_rows * SearchCostModel::kResolveOutIdBytes / std::max<size_t>(profile.nq, 1);
+    }
+
+    if (!filtered) {
+        const bool brute_force =
+            !Allows(allowed, SearchStrategy::GRAPH) ||
+            (Allows(allowed, SearchStrategy::BRUTE_FORCE) &&
+             profile.k >= num_rows * SearchCostModel::kUnfilteredBruteForceTopkRatio);
+        plan.strategy = brute_force ? SearchStrategy::BRUTE_FORCE : SearchStrategy::GRAPH;
+        plan.cost = brute_force ? plan.brute_force_cost : plan.graph_cost;
+        return plan;
+    }
+
+    // the cheapest allowed one, the graph strategies first on a tie
+    bool chosen = false;
+    auto consider = [&](SearchStrategy strategy, double cost) {
+        if (Allows(allowed, strategy) && (!chosen || cost < plan.cost)) {
+            plan.strategy = strategy;
+            plan.cost = cost;
+            chosen = true;
+        }
+    };
+    consider(SearchStrategy::GRAPH, plan.graph_cost);
+    consider(SearchStrategy::GRAPH_TWO_HOP, plan.two_hop_cost);
+    consider(SearchStrategy::BRUTE_FORCE, plan.brute_force_cost);
+    return plan;
+}
+
+}  // namespace knowhere
@@ -0,0 +1,165 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/search_stage.h"
+
+#include <sys/resource.h>
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "knowhere/prometheus_client.h"
+
+namespace knowhere {
+
+namespace {
+
+constexpr uint32_t kDefaultSearchStageSampling = 16;
+
+std::atomic<uint32_t> search_stage_sampling{kDefaultSearchStageSampling};
+thread_local uint32_t search_stage_counter = 0;
+thread_local std::shared_ptr<SearchStageTimes> search_stage_times = nullptr;
+thread_local std::shared_ptr<SearchFaults> search_faults = nullptr;
+
+// the stages take from microseconds to seconds
+const prometheus::Histogram::BucketBoundaries searchStageBuckets = {0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1,    2,    5,
+                                                                    10,   20,   50,   100, 200, 500, 1000, 2000, 5000};
+
+prometheus::Histogram&
+SearchStageHistogram(SearchStage stage) {
+    static const auto histograms = [] {
+        std::array<prometheus::Histogram*, kNumSearchStages> res;
+        for (size_t i = 0; i < kNumSearchStages; i++) {
+            const std::map<std::string, std::string> labels = {{"module", "knowhere"},
+                                                               {"stage", SearchStageName(static_cast<SearchStage>(i))}};
+            res[i] = &search_stage_latency_family.Add(labels, searchStageBuckets);
+        }
+        return res;
+    }();
+    return *histograms[static_cast<size_t>(stage)];
+}
+
+bool
+SampleSearchStage() {
+    const auto every = search_stage_sampling.load(std::memory_order_relaxed);
+    return every != 0 && ++search_stage_counter % every == 0;
+}
+
+void
+Record(SearchStage stage, double ms, bool sampled) {
+    if (sampled) {
+        SearchStageHistogram(stage).Observe(ms);
+    }
+    if (search_stage_times != nullptr) {
+        search_stage_times->ns[static_cast<size_t>(stage)].fetch_add(static_cast<uint64_t>(ms * 1e6),
+                                                                     std::memory_order_relaxed);
+    }
+}
+
+uint64_t
+ThreadMajorFaults() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_majflt;
+}
+
+}  // namespace
+
+const char*
+SearchStageName(SearchStage stage) {
+    switch (stage) {
+        case SearchStage::CONFIG_PARSE:
+            return "config_parse";
+        case SearchStage::QUEUE_WAIT:
+            return "queue_wait";
+        case SearchStage::COARSE_QUANTIZATION:
+            return "coarse_quantization";
+        case SearchStage::LIST_SCAN:
+            return "list_scan";
+        case SearchStage::GRAPH_TRAVERSAL:
+            return "graph_traversal";
+        case SearchStage::REFINE:
+            return "refine";
+        case SearchStage::IO_WAIT:
+            return "io_wait";
+        case SearchStage::RESULT_ASSEMBLY:
+            return "result_assembly";
+    }
+    return "unknown";
+}
+
+void
+SetSearchStageSampling(uint32_t every) {
+    search_stage_sampling.store(every);
+}
+
+uint32_t
+GetSearchStageSampling() {
+    return search_stage_sampling.load();
+}
+
+ScopedSearchStageTimes::ScopedSearchStageTimes(std::shared_ptr<SearchStageTimes> times)
+    : prev_times_(std::move(search_stage_times)) {
+    search_stage_times = std::move(times);
+}
+
+ScopedSearchStageTimes::~ScopedSearchStageTimes() {
+    search_stage_times = std::move(prev_times_);
+}
+
+const std::shared_ptr<SearchStageTimes>&
+GetSearchStageTimes() {
+    return search_stage_times;
+}
+
+void
+RecordSearchStage(SearchStage stage, double ms) {
+    Record(stage, ms, SampleSearchStage());
+}
+
+ScopedSearchFaults::ScopedSearchFaults(std::shared_ptr<SearchFaults> faults)
+    : prev_faults_(std::move(search_faults)), counting_(faults != nullptr && faults != prev_faults_) {
+    search_faults = std::move(faults);
+    if (counting_) {
+        begin_ = ThreadMajorFaults();
+    }
+}
+
+ScopedSearchFaults::~ScopedSearchFaults() {
+    if (counting_) {
+        search_faults->fetch_add(ThreadMajorFaults() - begin_, std::memory_order_relaxed);
+    }
+    search_faults = std::move(prev_faults_);
+}
+
+const std::shared_ptr<SearchFaults>&
+GetSearchFaults() {
+    return search_faults;
+}
+
+ScopedSearchStage::ScopedSearchStage(SearchStage stage)
+    : stage_(stage), sampled_(SampleSearchStage()), timed_(sampled_ || search_stage_times != nullptr) {
+    if (timed_) {
+        begin_ = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedSearchStage::~ScopedSearchStage() {
+    if (timed_) {
+        const auto end = std::chrono::steady_clock::now();
+        Record(stage_, std::chrono::duration<double, std::milli>(end - begin_).count(), sampled_);
+    }
+}
+
+}  // namespace knowhere
@@ -0,0 +1,140 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "knowhere/comp/warmup.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#include "knowhere/comp/task.h"
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+namespace {
+
+// the bytes that a task of the build pool touches at once, between two progress reports
+constexpr size_t kWarmupChunkSize = 4UL << 20;
+
+size_t
+PageSize() {
+    static const size_t size = sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+struct Chunk {
+    uintptr_t begin;
+    size_t size;
+};
+
+}  // namespace
+
+Status
+WarmupRanges(const std::vector<MemoryRange>& ranges, const WarmupProgress& progress) {
+    const size_t page = PageSize();
+    std::vector<Chunk> chunks;
+    size_t total = 0;
+    for (const auto& range : ranges) {
+        if (range.size == 0) {
+            continue;
+        }
+        // the advice covers the whole pages of the range
+        const auto begin = reinterpret_cast<uintptr_t>(range.data) / page * page;
+        const auto end = reinterpret_cast<uintptr_t>(range.data) + range.size;
+        if (madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED) != 0) {
+            LOG_KNOWHERE_WARNING_ << "Failed to advise the warmup of " << range.size << " bytes: " << strerror(errno);
+        }
+        for (uintptr_t p = begin; p < end; p += kWarmupChunkSize) {
+            chunks.push_back({p, std::min<size_t>(kWarmupChunkSize, end - p)});
+        }
+        total += end - begin;
+    }
+    if (chunks.empty()) {
+        if (progress) {
+            progress(0, 0);
+        }
+        return Status::success;
+    }
+
+    std::mutex progress_mutex;
+    size_t done = 0;
+    // every chunk is worth a task of its own
+    ParallelForOverBuildThreadPool(chunks.size(), kParallelForMinChunkCost, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const auto& chunk = chunks[i];
+            for (uintptr_t p = chunk.begin; p < chunk.begin + chunk.size; p += page) {
+                [[maybe_unused]] volatile uint8_t value = *reinterpret_cast<const volatile uint8_t*>(p);
+            }
+            if (progress) {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                done += chunk.size;
+                progress(done, total);
+            }
+        }
+    });
+    LOG_KNOWHERE_INFO_ << "Warmed up " << total << " bytes in " << chunks.size() << " chunks";
+    return Status::success;
+}
+
+void
+AdviseMmapAccess(const std::vector<MemoryRange>& ranges, MmapAccess access) {
+    const size_t page = PageSize();
+    int advice = MADV_RANDOM;
+    if (access == MmapAccess::SEQUENTIAL) {
+        advice = MADV_SEQUENTIAL;
+    } else if (access == MmapAccess::WILLNEED) {
+        advice = MADV_WILLNEED;
+    }
+    for (const auto& range : ranges) {
+        if (range.size == 0) {
+            continue;
+        }
+        const auto begin = reinterpret_cast<uintptr_t>(range.data) / page * page;
+        const auto end = reinterpret_cast<uintptr_t>(range.data) + range.size;
+        if (madvise(reinterpret_cast<void*>(begin), end - begin, advice) != 0) {
+            LOG_KNOWHERE_WARNING_ << "Failed to advise the access of " << range.size << " bytes: " << strerror(errno);
+        }
+    }
+}
+
+Status
+CooldownRanges(const std::vector<MemoryRange>& ranges) {
+    const size_t page = PageSize();
+    size_t released = 0;
+    for (const auto& range : ranges) {
+        // the pages that the range covers entirely, not to release the neighbouring data
+        const auto begin = (reinterpret_cast<uintptr_t>(range.data) + page - 1) / page * page;
+        const auto end = (reinterpret_cast<uintptr_t>(range.data) + range.size) / page * page;
+        if (begin >= end) {
+            continue;
+        }
+        void* addr = reinterpret_cast<void*>(begin);
+        int res = -1;
+#ifdef MADV_PAGEOUT
+        res = madvise(addr, end - begin, MADV_PAGEOUT);
+#endif
+        if (res != 0 && madvise(addr, end - begin, MADV_DONTNEED) != 0) {
+            LOG_KNOWHERE_WARNING_ << "Failed to cool down " << range.size << " bytes: " << strerror(errno);
+            return Status::disk_file_error;
+        }
+        released += end - begin;
+    }
+    LOG_KNOWHERE_INFO_ << "Cooled down " << released << " bytes";
+    return Status::success;
+}
+
+}  // namespace knowhere
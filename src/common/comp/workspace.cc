@@ -0,0 +1,78 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/workspace.h"
+
+#include <algorithm>
+#include <new>
+
+namespace knowhere {
+
+namespace {
+
+size_t
+AlignUp(size_t bytes) {
+    return (bytes + SearchWorkspace::kAlignment - 1) / SearchWorkspace::kAlignment * SearchWorkspace::kAlignment;
+}
+
+char*
+AllocateAligned(size_t bytes) {
+    const size_t size = std::max(AlignUp(bytes), SearchWorkspace::kAlignment);
+    auto p = static_cast<char*>(std::aligned_alloc(SearchWorkspace::kAlignment, size));
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+}  // namespace
+
+SearchWorkspace&
+SearchWorkspace::ThreadLocal() {
+    thread_local SearchWorkspace workspace;
+    return workspace;
+}
+
+void*
+SearchWorkspace::Allocate(size_t bytes) {
+    bytes = AlignUp(bytes);
+    void* p = nullptr;
+    if (used_ + bytes <= capacity_) {
+        p = buffer_.get() + used_;
+        used_ += bytes;
+    } else {
+        overflow_.emplace_back(Buffer(AllocateAligned(bytes)), bytes);
+        overflow_bytes_ += bytes;
+        p = overflow_.back().first.get();
+    }
+    high_water_ = std::max(high_water_, used_ + overflow_bytes_);
+    return p;
+}
+
+void
+SearchWorkspace::Release(size_t used, size_t overflow) {
+    used_ = used;
+    while (overflow_.size() > overflow) {
+        overflow_bytes_ -= overflow_.back().second;
+        overflow_.pop_back();
+    }
+    if (--depth_ > 0) {
+        return;
+    }
+    // no buffer is live, the next queries get one buffer of the high-water mark
+    const size_t target = std::min(high_water_, kMaxRetainedBytes);
+    if (target > capacity_) {
+        buffer_.reset(AllocateAligned(target));
+        capacity_ = AlignUp(target);
+    }
+}
+
+}  // namespace knowhere
@@ -15,7 +15,12 @@
  * limitations under the License.
  */
 #pragma once
+#include <cuda_runtime_api.h>
+
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cuvs/core/bitset.hpp>
 #include <cuvs/distance/distance.hpp>
@@ -23,6 +28,8 @@
 #include <cuvs/neighbors/ivf_pq.hpp>
 #include <istream>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <raft/core/copy.cuh>
 #include <raft/core/device_resources_manager.hpp>
@@ -31,6 +38,8 @@
 #include <raft/core/resource/thrust_policy.hpp>
 #include <raft/core/serialize.hpp>
 #include <raft/linalg/normalize.cuh>
+#include <rmm/cuda_stream_pool.hpp>
+#include <rmm/cuda_stream_view.hpp>
 #include <tuple>
 #include <type_traits>
 
@@ -362,19 +371,90 @@ get_device_resources_without_mempool(int device_id = raft::device_setter::get_cu
 }
 
 inline auto
-select_device_id() {
+get_device_count() {
     auto static device_count = []() {
         auto result = 0;
         RAFT_CUDA_TRY(cudaGetDeviceCount(&result));
         RAFT_EXPECTS(result != 0, "No CUDA devices found");
         return result;
     }();
+    return device_count;
+}
+
+inline auto
+select_device_id() {
     auto static index_counter = std::atomic<int>{0};
     // Use round-robin assignment to distribute indexes across devices
-    auto result = index_counter.fetch_add(1) % device_count;
+    auto result = index_counter.fetch_add(1) % get_device_count();
     return result;
 }
 
+// Page-locked host memory that the search batches are staged through, so that their copies between the host and the
+// device are asynchronous. The buffer only grows, and is reused by the searches of a thread.
+class pinned_host_buffer {
+ public:
+    pinned_host_buffer() = default;
+    pinned_host_buffer(pinned_host_buffer const&) = delete;
+    pinned_host_buffer&
+    operator=(pinned_host_buffer const&) = delete;
+    ~pinned_host_buffer() {
+        if (data_ != nullptr) {
+            RAFT_CUDA_TRY_NO_THROW(cudaFreeHost(data_));
+        }
+    }
+
+    template <typename T>
+    T*
+    get(std::size_t count) {
+        auto bytes = count * sizeof(T);
+        if (bytes > size_) {
+            if (data_ != nullptr) {
+                RAFT_CUDA_TRY(cudaFreeHost(data_));
+                data_ = nullptr;
+                size_ = 0;
+            }
+            // portable, as the threads search indexes on all the devices
+            RAFT_CUDA_TRY(cudaHostAlloc(&data_, bytes, cudaHostAllocPortable));
+            size_ = bytes;
+        }
+        return static_cast<T*>(data_);
+    }
+
+ private:
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+class cuda_event {
+ public:
+    cuda_event() {
+        RAFT_CUDA_TRY(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
+    }
+    cuda_event(cuda_event const&) = delete;
+    cuda_event&
+    operator=(cuda_event const&) = delete;
+    ~cuda_event() {
+        RAFT_CUDA_TRY_NO_THROW(cudaEventDestroy(event_));
+    }
+
+    void
+    record(rmm::cuda_stream_view stream) {
+        RAFT_CUDA_TRY(cudaEventRecord(event_, stream.value()));
+    }
+    // the work queued on the stream from now on waits for the work recorded by this event
+    void
+    wait(rmm::cuda_stream_view stream) const {
+        RAFT_CUDA_TRY(cudaStreamWaitEvent(stream.value(), event_, 0));
+    }
+    void
+    synchronize() const {
+        RAFT_CUDA_TRY(cudaEventSynchronize(event_));
+    }
+
+ private:
+    cudaEvent_t event_;
+};
+
 // This struct is used to connect knowhere to a cuVS index. The implementation
 // is provided here, but this header should never be directly included in
 // another knowhere header. This ensures that cuVS symbols are not exposed in
@@ -390,6 +470,9 @@ struct cuvs_knowhere_index<IndexKind, DataType>::impl {
     impl() {
     }
 
+    explicit impl(int new_device_id) : device_id{new_device_id} {
+    }
+
     auto
     is_trained() const {
         return index_.has_value();
@@ -460,19 +543,11 @@ struct cuvs_knowhere_index<IndexKind, DataType>::impl {
         }
         auto scoped_device = raft::device_setter{device_id};
         auto const& res = raft::device_resources_manager::get_device_resources();
+        auto compute_stream = raft::resource::get_cuda_stream(res);
+        auto copy_stream = search_copy_streams().get_stream();
         auto k = knowhere_indexing_type(config.k);
         auto search_params = config_to_search_params<index_kind>(config);
-
-        auto host_data = raft::make_host_matrix_view(data, row_count, feature_count);
-        auto device_data_storage =
-            raft::make_device_matrix<data_type, input_indexing_type>(res, row_count, feature_count);
-        raft::copy(res, device_data_storage.view(), host_data);
-
-        if (config.metric_type == knowhere::metric::COSINE) {
-            auto device_data_view = device_data_storage.view();
-            raft::linalg::row_normalize(res, raft::make_const_mdspan(device_data_view), device_data_view,
-                                        raft::linalg::NormType::L2Norm);
-        }
+        RAFT_EXPECTS(index_, "Index has not yet been trained");
 
         auto device_bitset = std::optional<
             cuvs::core::bitset<knowhere_bitset_internal_data_type, knowhere_bitset_internal_indexing_type>>{};
@@ -488,70 +563,123 @@ struct cuvs_knowhere_index<IndexKind, DataType>::impl {
                 device_bitset->flip(res);
             }
         }
-
-        auto output_size = row_count * k;
-        auto ids = std::unique_ptr<knowhere_indexing_type[]>(new knowhere_indexing_type[output_size]);
-        auto distances = std::unique_ptr<knowhere_distance_type[]>(new knowhere_distance_type[output_size]);
-
-        auto host_ids = raft::make_host_matrix_view(ids.get(), row_count, k);
-        auto host_distances = raft::make_host_matrix_view(distances.get(), row_count, k);
-
-        auto device_ids_storage = raft::make_device_matrix<indexing_type, input_indexing_type>(res, row_count, k);
-        auto device_distances_storage =
-            raft::make_device_matrix<knowhere_distance_type, input_indexing_type>(res, row_count, k);
-        auto device_ids = device_ids_storage.view();
-        auto device_distances = device_distances_storage.view();
-
-        RAFT_EXPECTS(index_, "Index has not yet been trained");
         auto dataset_view = device_dataset_storage
                                 ? std::make_optional(device_dataset_storage->view())
                                 : std::optional<raft::device_matrix_view<const data_type, input_indexing_type>>{};
 
-        if (device_bitset) {
-            // cuVS is using uint32_t as filter datatype. Set the original nbits to knowhere's bitset data
-            // type to make them compatible.
-            auto bitset_view = device_bitset->view();
-            bitset_view.set_original_nbits(sizeof(knowhere_bitset_data_type) * 8);
-            cuvs_index_type::search(
-                res, *index_, search_params, raft::make_const_mdspan(device_data_storage.view()), device_ids,
-                device_distances, config.refine_ratio, input_indexing_type{}, dataset_view,
-                cuvs::neighbors::filtering::bitset_filter<knowhere_bitset_internal_data_type,
-                                                          knowhere_bitset_internal_indexing_type>{bitset_view});
-        } else {
-            cuvs_index_type::search(res, *index_, search_params, raft::make_const_mdspan(device_data_storage.view()),
-                                    device_ids, device_distances, config.refine_ratio, input_indexing_type{},
-                                    dataset_view);
-        }
+        auto output_size = row_count * k;
+        auto ids = std::unique_ptr<knowhere_indexing_type[]>(new knowhere_indexing_type[output_size]);
+        auto distances = std::unique_ptr<knowhere_distance_type[]>(new knowhere_distance_type[output_size]);
 
-        auto device_knowhere_ids_storage =
-            std::optional<raft::device_matrix<knowhere_indexing_type, input_indexing_type>>{};
-        auto device_knowhere_ids = [&device_knowhere_ids_storage, &res, row_count, k, device_ids]() {
-            if constexpr (std::is_signed_v<indexing_type>) {
-                return device_ids;
-            } else {
-                device_knowhere_ids_storage =
-                    raft::make_device_matrix<knowhere_indexing_type, input_indexing_type>(res, row_count, k);
-                raft::copy(res, device_knowhere_ids_storage->view(), device_ids);
-                return device_knowhere_ids_storage->view();
+        // The queries are searched in batches on the compute stream, while the queries of the next batch and the
+        // results of the previous one are copied on the copy stream. Two slots of buffers alternate between the
+        // batches, so that a slot is only reused once its previous batch has been copied back to the host.
+        auto batch_rows = std::max(std::min(row_count, search_batch_rows), knowhere_indexing_type{1});
+        auto thread_local staging = std::array<search_staging, 2>{};
+        search_slot slots[2] = {{res, batch_rows, feature_count, k}, {res, batch_rows, feature_count, k}};
+        // the copy stream may only use the buffers of the slots once they are allocated on the compute stream
+        auto allocated = cuda_event{};
+        allocated.record(compute_stream);
+        allocated.wait(copy_stream);
+
+        auto download = [copy_stream, k](search_slot& slot, search_staging& stage) {
+            slot.searched.wait(copy_stream);
+            RAFT_CUDA_TRY(cudaMemcpyAsync(stage.ids.get<knowhere_indexing_type>(slot.rows * k),
+                                          slot.knowhere_ids_data(), slot.rows * k * sizeof(knowhere_indexing_type),
+                                          cudaMemcpyDeviceToHost, copy_stream.value()));
+            RAFT_CUDA_TRY(cudaMemcpyAsync(stage.distances.get<knowhere_distance_type>(slot.rows * k),
+                                          slot.distances.data_handle(), slot.rows * k * sizeof(knowhere_distance_type),
+                                          cudaMemcpyDeviceToHost, copy_stream.value()));
+            slot.downloaded.record(copy_stream);
+        };
+        auto finish = [&ids, &distances, k](search_slot& slot, search_staging& stage) {
+            if (slot.rows == 0) {
+                return;
             }
-        }();
+            slot.downloaded.synchronize();
+            std::copy_n(stage.ids.get<knowhere_indexing_type>(slot.rows * k), slot.rows * k,
+                        ids.get() + slot.begin * k);
+            std::copy_n(stage.distances.get<knowhere_distance_type>(slot.rows * k), slot.rows * k,
+                        distances.get() + slot.begin * k);
+            slot.rows = 0;
+        };
 
         auto max_distance =
             std::nextafter(std::numeric_limits<knowhere_distance_type>::max(), knowhere_distance_type{0});
         auto device_post_process = detail::check_valid_entry<knowhere_distance_type, knowhere_indexing_type>{
             max_distance, knowhere_indexing_type(size())};
-        thrust::transform(
-            raft::resource::get_thrust_policy(res),
-            thrust::device_ptr<knowhere_indexing_type>(device_knowhere_ids.data_handle()),
-            thrust::device_ptr<knowhere_indexing_type>(device_knowhere_ids.data_handle() + device_knowhere_ids.size()),
-            thrust::device_ptr<knowhere_distance_type>(device_distances.data_handle()),
-            thrust::make_zip_iterator(
-                thrust::make_tuple(thrust::device_ptr<knowhere_indexing_type>(device_knowhere_ids.data_handle()),
-                                   thrust::device_ptr<knowhere_distance_type>(device_distances.data_handle()))),
-            device_post_process);
-
-        raft::copy(res, host_ids, device_knowhere_ids);
-        raft::copy(res, host_distances, device_distances);
+        auto previous = static_cast<std::size_t>(1);
+        for (auto begin = knowhere_indexing_type{}; begin < row_count; begin += batch_rows) {
+            auto current = 1 - previous;
+            auto& slot = slots[current];
+            auto& stage = staging[current];
+            finish(slot, stage);
+            slot.begin = begin;
+            slot.rows = std::min(batch_rows, row_count - begin);
+
+            auto host_queries = stage.queries.get<data_type>(slot.rows * feature_count);
+            std::copy_n(data + begin * feature_count, slot.rows * feature_count, host_queries);
+            RAFT_CUDA_TRY(cudaMemcpyAsync(slot.queries.data_handle(), host_queries,
+                                          slot.rows * feature_count * sizeof(data_type), cudaMemcpyHostToDevice,
+                                          copy_stream.value()));
+            slot.uploaded.record(copy_stream);
+            // the results of the previous batch are queued behind the queries of this one, which are thus copied
+            // while the previous batch is searched
+            if (slots[previous].rows != 0) {
+                download(slots[previous], staging[previous]);
+            }
+
+            slot.uploaded.wait(compute_stream);
+            auto device_queries =
+                raft::make_device_matrix_view<data_type, input_indexing_type>(slot.queries.data_handle(), slot.rows,
+                                                                              feature_count);
+            if (config.metric_type == knowhere::metric::COSINE) {
+                raft::linalg::row_normalize(res, raft::make_const_mdspan(device_queries), device_queries,
+                                            raft::linalg::NormType::L2Norm);
+            }
+            auto device_ids =
+                raft::make_device_matrix_view<indexing_type, input_indexing_type>(slot.ids.data_handle(), slot.rows, k);
+            auto device_distances = raft::make_device_matrix_view<knowhere_distance_type, input_indexing_type>(
+                slot.distances.data_handle(), slot.rows, k);
+            if (device_bitset) {
+                // cuVS is using uint32_t as filter datatype. Set the original nbits to knowhere's bitset data
+                // type to make them compatible.
+                auto bitset_view = device_bitset->view();
+                bitset_view.set_original_nbits(sizeof(knowhere_bitset_data_type) * 8);
+                cuvs_index_type::search(
+                    res, *index_, search_params, raft::make_const_mdspan(device_queries), device_ids,
+                    device_distances, config.refine_ratio, input_indexing_type{}, dataset_view,
+                    cuvs::neighbors::filtering::bitset_filter<knowhere_bitset_internal_data_type,
+                                                              knowhere_bitset_internal_indexing_type>{bitset_view});
+            } else {
+                cuvs_index_type::search(res, *index_, search_params, raft::make_const_mdspan(device_queries),
+                                        device_ids, device_distances, config.refine_ratio, input_indexing_type{},
+                                        dataset_view);
+            }
+
+            auto device_knowhere_ids = slot.knowhere_ids_data();
+            if constexpr (!std::is_signed_v<indexing_type>) {
+                raft::copy(res,
+                           raft::make_device_matrix_view<knowhere_indexing_type, input_indexing_type>(
+                               device_knowhere_ids, slot.rows, k),
+                           raft::make_const_mdspan(device_ids));
+            }
+            thrust::transform(
+                raft::resource::get_thrust_policy(res), thrust::device_ptr<knowhere_indexing_type>(device_knowhere_ids),
+                thrust::device_ptr<knowhere_indexing_type>(device_knowhere_ids + slot.rows * k),
+                thrust::device_ptr<knowhere_distance_type>(device_distances.data_handle()),
+                thrust::make_zip_iterator(
+                    thrust::make_tuple(thrust::device_ptr<knowhere_indexing_type>(device_knowhere_ids),
+                                       thrust::device_ptr<knowhere_distance_type>(device_distances.data_handle()))),
+                device_post_process);
+            slot.searched.record(compute_stream);
+            previous = current;
+        }
+        if (slots[previous].rows != 0) {
+            download(slots[previous], staging[previous]);
+        }
+        finish(slots[0], staging[0]);
+        finish(slots[1], staging[1]);
         return std::make_tuple(ids.release(), distances.release());
     }
     void
@@ -590,25 +718,22 @@ struct cuvs_knowhere_index<IndexKind, DataType>::impl {
         }
     }
 
-    auto static deserialize(std::istream& is) {
-        auto static device_count = []() {
-            auto result = 0;
-            RAFT_CUDA_TRY(cudaGetDeviceCount(&result));
-            RAFT_EXPECTS(result != 0, "No CUDA devices found");
-            return result;
-        }();
-        // The lazy allocation mode cannot completely eliminate uneven distribution, but it can alleviate it well.
-        int new_device_id = 0;
-        size_t free, total;
-        size_t max_free = 0;
-        for (int i = 0; i < device_count; ++i) {
-            auto scoped_device = raft::device_setter{i};
-            RAFT_CUDA_TRY(cudaMemGetInfo(&free, &total));
-            if (max_free < free) {
-                max_free = free;
-                new_device_id = i;
+    auto static deserialize(std::istream& is, int new_device_id = -1) {
+        if (new_device_id < 0) {
+            // The lazy allocation mode cannot completely eliminate uneven distribution, but it can alleviate it well.
+            new_device_id = 0;
+            size_t free, total;
+            size_t max_free = 0;
+            for (int i = 0; i < get_device_count(); ++i) {
+                auto scoped_device = raft::device_setter{i};
+                RAFT_CUDA_TRY(cudaMemGetInfo(&free, &total));
+                if (max_free < free) {
+                    max_free = free;
+                    new_device_id = i;
+                }
             }
         }
+        RAFT_EXPECTS(new_device_id < get_device_count(), "Invalid CUDA device id");
         auto scoped_device = raft::device_setter{new_device_id};
         auto const& res = get_device_resources_without_mempool();
         auto des_index = cuvs_index_type::template deserialize<data_type, indexing_type>(res, is);
@@ -646,9 +771,65 @@ struct cuvs_knowhere_index<IndexKind, DataType>::impl {
     }
 
  private:
+    // The query rows of a search batch.
+    auto static constexpr search_batch_rows = knowhere_indexing_type{4096};
+    // The copy streams of an index, which its concurrent searches are spread over.
+    auto static constexpr search_copy_stream_count = std::size_t{4};
+
+    // The pinned host buffers of a slot of the search pipeline.
+    struct search_staging {
+        pinned_host_buffer queries;
+        pinned_host_buffer ids;
+        pinned_host_buffer distances;
+    };
+
+    // The device buffers of a slot of the search pipeline, and the events of the batch it holds.
+    struct search_slot {
+        search_slot(raft::device_resources const& res, knowhere_indexing_type rows,
+                    knowhere_indexing_type feature_count, knowhere_indexing_type k)
+            : queries{raft::make_device_matrix<data_type, input_indexing_type>(res, rows, feature_count)},
+              ids{raft::make_device_matrix<indexing_type, input_indexing_type>(res, rows, k)},
+              distances{raft::make_device_matrix<knowhere_distance_type, input_indexing_type>(res, rows, k)} {
+            if constexpr (!std::is_signed_v<indexing_type>) {
+                knowhere_ids = raft::make_device_matrix<knowhere_indexing_type, input_indexing_type>(res, rows, k);
+            }
+        }
+
+        knowhere_indexing_type*
+        knowhere_ids_data() {
+            if constexpr (std::is_signed_v<indexing_type>) {
+                return ids.data_handle();
+            } else {
+                return knowhere_ids->data_handle();
+            }
+        }
+
+        raft::device_matrix<data_type, input_indexing_type> queries;
+        raft::device_matrix<indexing_type, input_indexing_type> ids;
+        std::optional<raft::device_matrix<knowhere_indexing_type, input_indexing_type>> knowhere_ids = std::nullopt;
+        raft::device_matrix<knowhere_distance_type, input_indexing_type> distances;
+        cuda_event uploaded;
+        cuda_event searched;
+        cuda_event downloaded;
+        knowhere_indexing_type begin = 0;
+        // zero once the results of the batch are copied out of the slot
+        knowhere_indexing_type rows = 0;
+    };
+
+    // The streams are created on the device of the index by its first search.
+    rmm::cuda_stream_pool const&
+    search_copy_streams() const {
+        std::call_once(search_copy_streams_flag, [this]() {
+            search_copy_streams_ = std::make_unique<rmm::cuda_stream_pool>(search_copy_stream_count);
+        });
+        return *search_copy_streams_;
+    }
+
     std::optional<cuvs_index_type> index_ = std::nullopt;
     int device_id = select_device_id();
     std::optional<raft::device_matrix<data_type, input_indexing_type>> device_dataset_storage = std::nullopt;
+    mutable std::once_flag search_copy_streams_flag;
+    mutable std::unique_ptr<rmm::cuda_stream_pool> search_copy_streams_;
 };
 
 template <cuvs_proto::cuvs_index_kind IndexKind, typename DataType>
@@ -656,6 +837,12 @@ cuvs_knowhere_index<IndexKind, DataType>::cuvs_knowhere_index()
     : pimpl{new cuvs_knowhere_index<IndexKind, DataType>::impl()} {
 }
 
+template <cuvs_proto::cuvs_index_kind IndexKind, typename DataType>
+cuvs_knowhere_index<IndexKind, DataType>::cuvs_knowhere_index(int device_id)
+    : pimpl{new cuvs_knowhere_index<IndexKind, DataType>::impl(device_id)} {
+    RAFT_EXPECTS(device_id >= 0 && device_id < get_device_count(), "Invalid CUDA device id");
+}
+
 template <cuvs_proto::cuvs_index_kind IndexKind, typename DataType>
 cuvs_knowhere_index<IndexKind, DataType>::~cuvs_knowhere_index<IndexKind, DataType>() = default;
 
@@ -737,6 +924,19 @@ cuvs_knowhere_index<IndexKind, DataType>::deserialize(std::istream& is) {
     return cuvs_knowhere_index<IndexKind, DataType>(cuvs_knowhere_index<IndexKind, DataType>::impl::deserialize(is));
 }
 
+template <cuvs_proto::cuvs_index_kind IndexKind, typename DataType>
+cuvs_knowhere_index<IndexKind, DataType>
+cuvs_knowhere_index<IndexKind, DataType>::deserialize(std::istream& is, int device_id) {
+    return cuvs_knowhere_index<IndexKind, DataType>(
+        cuvs_knowhere_index<IndexKind, DataType>::impl::deserialize(is, device_id));
+}
+
+template <cuvs_proto::cuvs_index_kind IndexKind, typename DataType>
+int
+cuvs_knowhere_index<IndexKind, DataType>::device_count() {
+    return get_device_count();
+}
+
 template <cuvs_proto::cuvs_index_kind IndexKind, typename DataType>
 void
 cuvs_knowhere_index<IndexKind, DataType>::synchronize(bool is_without_mempool) const {
@@ -34,6 +34,8 @@ struct cuvs_knowhere_index {
     using input_indexing_type = cuvs_input_indexing_t<index_kind>;
 
     cuvs_knowhere_index();
+    // The index is placed on the given device, instead of one picked round-robin.
+    explicit cuvs_knowhere_index(int device_id);
     ~cuvs_knowhere_index();
 
     cuvs_knowhere_index(cuvs_knowhere_index&& other);
@@ -63,6 +65,11 @@ struct cuvs_knowhere_index {
     serialize_to_hnswlib(std::ostream& os) const;
     static cuvs_knowhere_index<IndexKind, DataType>
     deserialize(std::istream& is);
+    // The index is loaded on the given device, instead of the one with the most free memory.
+    static cuvs_knowhere_index<IndexKind, DataType>
+    deserialize(std::istream& is, int device_id);
+    static int
+    device_count();
     void
     synchronize(bool is_without_mempool = false) const;
 
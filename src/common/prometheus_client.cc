@@ -66,17 +66,25 @@ DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(raw_compute_cnt, "raw compute cnt per request
 DEFINE_PROMETHEUS_HISTOGRAM(raw_compute_cnt, PROMETHEUS_LABEL_CARDINAL)
 
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(cache_hit_cnt, "cache hit cnt per request")
+DEFINE_PROMETHEUS_HISTOGRAM(cache_hit_cnt, PROMETHEUS_LABEL_KNOWHERE)
 DEFINE_PROMETHEUS_HISTOGRAM(cache_hit_cnt, PROMETHEUS_LABEL_CARDINAL)
 
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(io_cnt, "io cnt per request")
 DEFINE_PROMETHEUS_HISTOGRAM(io_cnt, PROMETHEUS_LABEL_CARDINAL)
 
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(queue_latency, "queue latency per request")
+DEFINE_PROMETHEUS_HISTOGRAM(queue_latency, PROMETHEUS_LABEL_KNOWHERE)
 DEFINE_PROMETHEUS_HISTOGRAM(queue_latency, PROMETHEUS_LABEL_CARDINAL)
 
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(exec_latency, "execute latency per request")
+DEFINE_PROMETHEUS_HISTOGRAM(exec_latency, PROMETHEUS_LABEL_KNOWHERE)
 DEFINE_PROMETHEUS_HISTOGRAM(exec_latency, PROMETHEUS_LABEL_CARDINAL)
 
+const prometheus::Histogram::BucketBoundaries majorFaultBuckets = {0,  1,   2,   4,   8,    16,  32,
+                                                                   64, 128, 256, 512, 1024, 4096};
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(search_major_faults, "major page faults per search, mmapped pages read from disk")
+DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(search_major_faults, PROMETHEUS_LABEL_KNOWHERE, majorFaultBuckets)
+
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(graph_search_cnt, "number of graph search per request")
 DEFINE_PROMETHEUS_HISTOGRAM(graph_search_cnt, PROMETHEUS_LABEL_CARDINAL)
 
@@ -90,6 +98,7 @@ DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(re_search_cnt, "number of fallback search per
 DEFINE_PROMETHEUS_HISTOGRAM(re_search_cnt, PROMETHEUS_LABEL_CARDINAL)
 
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(filter_connectivity_ratio, "avg connectivity ratio set under filtering per request")
+DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(filter_connectivity_ratio, PROMETHEUS_LABEL_KNOWHERE, ratioBuckets)
 DEFINE_PROMETHEUS_HISTOGRAM(filter_connectivity_ratio, PROMETHEUS_LABEL_CARDINAL)
 
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(filter_mv_only_cnt, "mv only cnt per request")
@@ -111,12 +120,23 @@ DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(hnsw_bitset_ratio, PROMETHEUS_LABEL_KNO
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(hnsw_search_hops, "HNSW search hops in layer 0")
 DEFINE_PROMETHEUS_HISTOGRAM(hnsw_search_hops, PROMETHEUS_LABEL_KNOWHERE)
 
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(hnsw_refine_candidates, "HNSW candidates per query reranked by the first refine")
+DEFINE_PROMETHEUS_HISTOGRAM(hnsw_refine_candidates, PROMETHEUS_LABEL_KNOWHERE)
+
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(hnsw_refine_cascade_candidates,
+                                   "HNSW candidates per query reranked by the last stage of a refine cascade")
+DEFINE_PROMETHEUS_HISTOGRAM(hnsw_refine_cascade_candidates, PROMETHEUS_LABEL_KNOWHERE)
+
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(diskann_bitset_ratio, "DISKANN bitset ratio for search and range search")
 DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(diskann_bitset_ratio, PROMETHEUS_LABEL_KNOWHERE, ratioBuckets)
 
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(diskann_search_hops, "DISKANN search hops")
 DEFINE_PROMETHEUS_HISTOGRAM(diskann_search_hops, PROMETHEUS_LABEL_KNOWHERE)
 
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(diskann_speculative_hit_ratio,
+                                   "AISAQ ratio of the speculative node reads expanded by the search")
+DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(diskann_speculative_hit_ratio, PROMETHEUS_LABEL_KNOWHERE, ratioBuckets)
+
 const prometheus::Histogram::BucketBoundaries diskannRangeSearchIterBuckets = {2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22};
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(diskann_range_search_iters, "DISKANN range search iterations")
 DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(diskann_range_search_iters, PROMETHEUS_LABEL_KNOWHERE,
@@ -125,4 +145,28 @@ DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(diskann_range_search_iters, PROMETHEUS_
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(sparse_dataset_nnz_len, "sparse dataset nnz length")
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(sparse_inverted_index_posting_list_len, "sparse inverted index posting list length")
 DEFINE_PROMETHEUS_GAUGE_FAMILY(sparse_inverted_index_size, "sparse inverted index size (MB)")
+DEFINE_PROMETHEUS_GAUGE_FAMILY(index_memory_bytes, "index memory (bytes), per component and kind")
+
+DEFINE_PROMETHEUS_GAUGE_FAMILY(simd_kernel_latency, "latency of the calibrated simd kernels (ns)")
+
+DEFINE_PROMETHEUS_GAUGE_FAMILY(search_queue_depth, "search pool tasks waiting for a thread, per search priority")
+DEFINE_PROMETHEUS_GAUGE_FAMILY(search_busy_threads, "search pool threads running a task")
+DEFINE_PROMETHEUS_GAUGE(search_busy_threads, PROMETHEUS_LABEL_KNOWHERE)
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_rejected, "searches shed by the admission control, per search priority")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_result_cache_hits, "queries answered by the search result cache of an index")
+DEFINE_PROMETHEUS_COUNTER(search_result_cache_hits, PROMETHEUS_LABEL_KNOWHERE)
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_result_cache_misses, "queries missed by the search result cache of an index")
+DEFINE_PROMETHEUS_COUNTER(search_result_cache_misses, PROMETHEUS_LABEL_KNOWHERE)
+DEFINE_PROMETHEUS_COUNTER_FAMILY(result_buffer_pool_hits, "search result buffers reused from a free list")
+DEFINE_PROMETHEUS_COUNTER(result_buffer_pool_hits, PROMETHEUS_LABEL_KNOWHERE)
+DEFINE_PROMETHEUS_COUNTER_FAMILY(result_buffer_pool_misses, "search result buffers allocated from the heap")
+DEFINE_PROMETHEUS_COUNTER(result_buffer_pool_misses, PROMETHEUS_LABEL_KNOWHERE)
+
+DEFINE_PROMETHEUS_GAUGE_FAMILY(thread_pool_threads, "threads of the thread pool, per pool")
+DEFINE_PROMETHEUS_GAUGE_FAMILY(thread_pool_active_threads, "thread pool threads running a task, per pool")
+DEFINE_PROMETHEUS_GAUGE_FAMILY(thread_pool_queue_length, "thread pool tasks waiting for a thread, per pool")
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(thread_pool_task_wait_latency, "thread pool task queue wait (ms), per pool")
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(thread_pool_task_run_latency, "thread pool task run time (ms), per pool")
+
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(search_stage_latency, "sampled search latency (ms), per search stage")
 }  // namespace knowhere
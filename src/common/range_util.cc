@@ -15,6 +15,7 @@
 #include <cinttypes>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <vector>
 
@@ -81,4 +82,115 @@ GetRangeSearchResult(const std::vector<std::vector<float>>& result_distances,
     return RangeSearchResult{.distances = std::move(distances), .labels = std::move(labels), .lims = std::move(lims)};
 }
 
+namespace {
+
+// the chunks kept for the next searches, 12 MB
+constexpr size_t kMaxFreeRangeSearchChunks = 64;
+
+std::mutex free_range_search_chunks_mutex;
+std::vector<std::unique_ptr<int64_t[]>> free_range_search_labels;
+std::vector<std::unique_ptr<float[]>> free_range_search_distances;
+
+}  // namespace
+
+RangeSearchResultArena::Writer::~Writer() {
+    ClosePiece();
+    arena_->counts_[qno_] = size_;
+    std::lock_guard<std::mutex> lock(arena_->lanes_mutex_);
+    arena_->free_lanes_.push_back(lane_);
+}
+
+void
+RangeSearchResultArena::Writer::ClosePiece() {
+    if (lane_->wp > piece_begin_) {
+        const auto& chunk = lane_->chunks.back();
+        lane_->pieces.push_back({qno_, chunk.labels.get() + piece_begin_, chunk.distances.get() + piece_begin_,
+                                 lane_->wp - piece_begin_});
+    }
+}
+
+void
+RangeSearchResultArena::Writer::NextChunk() {
+    ClosePiece();
+    lane_->chunks.push_back(TakeChunk());
+    lane_->wp = 0;
+    piece_begin_ = 0;
+}
+
+RangeSearchResultArena::~RangeSearchResultArena() {
+    for (auto& lane : lanes_) {
+        ReturnChunks(lane->chunks);
+    }
+}
+
+RangeSearchResultArena::Writer
+RangeSearchResultArena::GetWriter(const size_t qno) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    if (free_lanes_.empty()) {
+        lanes_.push_back(std::make_unique<Lane>());
+        free_lanes_.push_back(lanes_.back().get());
+    }
+    auto lane = free_lanes_.back();
+    free_lanes_.pop_back();
+    return Writer(this, qno, lane);
+}
+
+RangeSearchResult
+RangeSearchResultArena::Finish() {
+    const size_t nq = counts_.size();
+    auto lims = std::make_unique<size_t[]>(nq + 1);
+    lims[0] = 0;
+    for (size_t i = 0; i < nq; i++) {
+        lims[i + 1] = lims[i] + counts_[i];
+    }
+
+    size_t total_valid = lims[nq];
+    LOG_KNOWHERE_DEBUG_ << "Range search: total result num " << total_valid << " in " << lanes_.size() << " lanes";
+    if (total_valid == 0) {
+        return RangeSearchResult{.distances = nullptr, .labels = nullptr, .lims = std::move(lims)};
+    }
+
+    auto distances = std::make_unique<float[]>(total_valid);
+    auto labels = std::make_unique<int64_t[]>(total_valid);
+    // the pieces of a query are in one lane, in the order they were written
+    std::vector<size_t> offsets(lims.get(), lims.get() + nq);
+    for (const auto& lane : lanes_) {
+        for (const auto& piece : lane->pieces) {
+            std::copy_n(piece.labels, piece.n, labels.get() + offsets[piece.qno]);
+            std::copy_n(piece.distances, piece.n, distances.get() + offsets[piece.qno]);
+            offsets[piece.qno] += piece.n;
+        }
+    }
+
+    return RangeSearchResult{.distances = std::move(distances), .labels = std::move(labels), .lims = std::move(lims)};
+}
+
+RangeSearchResultArena::Chunk
+RangeSearchResultArena::TakeChunk() {
+    {
+        std::lock_guard<std::mutex> lock(free_range_search_chunks_mutex);
+        if (!free_range_search_labels.empty()) {
+            Chunk chunk{std::move(free_range_search_labels.back()), std::move(free_range_search_distances.back())};
+            free_range_search_labels.pop_back();
+            free_range_search_distances.pop_back();
+            return chunk;
+        }
+    }
+    // left uninitialized, the writers fill what they read
+    return Chunk{std::unique_ptr<int64_t[]>(new int64_t[kChunkSize]), std::unique_ptr<float[]>(new float[kChunkSize])};
+}
+
+void
+RangeSearchResultArena::ReturnChunks(std::vector<Chunk>& chunks) {
+    std::lock_guard<std::mutex> lock(free_range_search_chunks_mutex);
+    for (auto& chunk : chunks) {
+        if (free_range_search_labels.size() >= kMaxFreeRangeSearchChunks) {
+            break;
+        }
+        free_range_search_labels.push_back(std::move(chunk.labels));
+        free_range_search_distances.push_back(std::move(chunk.distances));
+    }
+    chunks.clear();
+}
+
 }  // namespace knowhere
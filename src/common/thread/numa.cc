@@ -0,0 +1,172 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "knowhere/comp/numa.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+namespace {
+
+std::atomic<bool> numa_mode{false};
+thread_local int current_numa_node = -1;
+thread_local int bound_numa_node = -1;
+
+// parses a sysfs list such as "0-3,8,10-11"
+std::vector<int>
+ParseSysfsList(const std::string& path) {
+    std::vector<int> res;
+    std::ifstream in(path);
+    std::string list;
+    if (!in || !std::getline(in, list)) {
+        return res;
+    }
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        const auto dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int i = first; i <= last; i++) {
+            res.push_back(i);
+        }
+    }
+    return res;
+}
+
+}  // namespace
+
+int
+NumaNodeCount() {
+    static const int count = [] {
+        const auto nodes = ParseSysfsList("/sys/devices/system/node/online");
+        return nodes.empty() ? 1 : *std::max_element(nodes.begin(), nodes.end()) + 1;
+    }();
+    return count;
+}
+
+std::vector<int>
+NumaNodeCpus(int node) {
+    if (node < 0 || node >= NumaNodeCount()) {
+        return {};
+    }
+    return ParseSysfsList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+}
+
+void
+SetNumaMode(bool enable) {
+    numa_mode.store(enable);
+}
+
+bool
+IsNumaModeEnabled() {
+    return numa_mode.load();
+}
+
+std::shared_ptr<ThreadPool>
+GetNumaSearchThreadPool(int node) {
+    static std::once_flag init_flag;
+    static std::vector<std::shared_ptr<ThreadPool>> pools;
+    std::call_once(init_flag, [] {
+        const int count = NumaNodeCount();
+        const auto size = std::max<size_t>(1, ThreadPool::GetGlobalSearchThreadPoolSize() / count);
+        for (int i = 0; i < count; i++) {
+            pools.push_back(std::make_shared<ThreadPool>(size, "Knowhere_Search_Numa" + std::to_string(i)));
+        }
+        LOG_KNOWHERE_INFO_ << "Init " << count << " NUMA search thread pools of " << size << " threads";
+    });
+    if (node < 0 || node >= static_cast<int>(pools.size())) {
+        return ThreadPool::GetGlobalSearchThreadPool();
+    }
+    return pools[node];
+}
+
+void
+BindCurrentThreadToNumaNode(int node) {
+    if (bound_numa_node == node) {
+        return;
+    }
+#ifdef __linux__
+    const auto cpus = NumaNodeCpus(node);
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        LOG_KNOWHERE_WARNING_ << "Failed to bind the thread to NUMA node " << node;
+        return;
+    }
+#endif
+    bound_numa_node = node;
+}
+
+ScopedNumaNode::ScopedNumaNode(int node) : prev_node_(current_numa_node) {
+    current_numa_node = node;
+}
+
+ScopedNumaNode::~ScopedNumaNode() {
+    current_numa_node = prev_node_;
+}
+
+int
+GetCurrentNumaNode() {
+    return current_numa_node;
+}
+
+ScopedNumaMemoryBinding::ScopedNumaMemoryBinding(int node) {
+#ifdef __linux__
+    constexpr int max_node = sizeof(unsigned long) * 8;
+    if (node < 0 || node >= std::min(NumaNodeCount(), max_node)) {
+        return;
+    }
+    const unsigned long mask = 1UL << node;
+    // the kernel takes one more than the number of bits of the mask
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, max_node + 1) != 0) {
+        LOG_KNOWHERE_WARNING_ << "Failed to bind the memory of the thread to NUMA node " << node;
+        return;
+    }
+    bound_ = true;
+#endif
+}
+
+ScopedNumaMemoryBinding::~ScopedNumaMemoryBinding() {
+#ifdef __linux__
+    if (bound_) {
+        syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    }
+#endif
+}
+
+}  // namespace knowhere
@@ -12,35 +12,388 @@
 #include <omp.h>
 #include <sys/resource.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cerrno>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <string>
 #include <thread>
 #include <utility>
 
 #include "folly/executors/CPUThreadPoolExecutor.h"
+#include "folly/executors/ExecutorWithPriority.h"
+#include "knowhere/comp/numa.h"
 #include "knowhere/comp/task.h"
+#include "knowhere/prometheus_client.h"
 
 namespace knowhere {
 
+namespace {
+thread_local SearchPriority search_priority = SearchPriority::NORMAL;
+thread_local SearchDeadline search_deadline;
+thread_local bool in_search_pool_task = false;
+thread_local bool in_build_parallel_for = false;
+
+constexpr size_t kNumSearchPriorities = 3;
+std::array<std::atomic<size_t>, kNumSearchPriorities> search_queue_limits{};
+std::array<std::atomic<size_t>, kNumSearchPriorities> search_queue_depths{};
+std::atomic<SearchAdmissionPolicy> search_admission_policy{SearchAdmissionPolicy::REJECT};
+
+size_t
+PriorityClass(SearchPriority priority) {
+    switch (priority) {
+        case SearchPriority::LOW:
+            return 0;
+        case SearchPriority::HIGH:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+// the metrics of the priority classes
+struct SearchPriorityMetrics {
+    prometheus::Gauge* queue_depth;
+    prometheus::Counter* rejected;
+};
+
+const SearchPriorityMetrics&
+GetSearchPriorityMetrics(size_t priority_class) {
+    static const auto metrics = [] {
+        constexpr const char* names[kNumSearchPriorities] = {"low", "normal", "high"};
+        std::array<SearchPriorityMetrics, kNumSearchPriorities> res;
+        for (size_t i = 0; i < kNumSearchPriorities; i++) {
+            const std::map<std::string, std::string> labels = {{"module", "knowhere"}, {"priority", names[i]}};
+            res[i] = {&search_queue_depth_family.Add(labels), &search_rejected_family.Add(labels)};
+        }
+        return res;
+    }();
+    return metrics[priority_class];
+}
+
+double
+ElapsedMs(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// the gauges of a pool are refreshed by its tasks at most once per period, and by the task that leaves it idle
+constexpr auto kThreadPoolGaugePeriod = std::chrono::milliseconds(100);
+
+// the metrics of a global thread pool, fed by the task stats of its executor
+struct ThreadPoolMetrics {
+    explicit ThreadPoolMetrics(const char* pool) {
+        // the tasks of the search pool mostly take less than a millisecond
+        static const prometheus::Histogram::BucketBoundaries buckets = {
+            0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 60000};
+        const std::map<std::string, std::string> labels = {{"module", "knowhere"}, {"pool", pool}};
+        threads = &thread_pool_threads_family.Add(labels);
+        active_threads = &thread_pool_active_threads_family.Add(labels);
+        queue_length = &thread_pool_queue_length_family.Add(labels);
+        task_wait = &thread_pool_task_wait_latency_family.Add(labels, buckets);
+        task_run = &thread_pool_task_run_latency_family.Add(labels, buckets);
+    }
+
+    void
+    UpdateGauges(const folly::CPUThreadPoolExecutor& executor) {
+        const auto pool_stats = executor.getPoolStats();
+        threads->Set(pool_stats.threadCount);
+        active_threads->Set(pool_stats.activeThreadCount);
+        queue_length->Set(pool_stats.pendingTaskCount);
+    }
+
+    prometheus::Gauge* threads;
+    prometheus::Gauge* active_threads;
+    prometheus::Gauge* queue_length;
+    prometheus::Histogram* task_wait;
+    prometheus::Histogram* task_run;
+    // the executor whose tasks are observed
+    std::atomic<folly::CPUThreadPoolExecutor*> executor{nullptr};
+    std::atomic<int64_t> last_update_ns{0};
+};
+
+ThreadPoolMetrics&
+SearchThreadPoolMetrics() {
+    static ThreadPoolMetrics metrics("search");
+    return metrics;
+}
+
+ThreadPoolMetrics&
+BuildThreadPoolMetrics() {
+    static ThreadPoolMetrics metrics("build");
+    return metrics;
+}
+
+// subscribes the metrics to the task stats of the executor, once. Cheap when done already.
+void
+InstrumentThreadPool(ThreadPoolMetrics& metrics, folly::CPUThreadPoolExecutor& executor) {
+    auto instrumented = metrics.executor.load(std::memory_order_acquire);
+    if (instrumented == &executor || !metrics.executor.compare_exchange_strong(instrumented, &executor)) {
+        return;
+    }
+    // the global pools live as long as the process
+    executor.subscribeToTaskStats([&metrics, &executor](const folly::ThreadPoolExecutor::TaskStats& stats) {
+        metrics.task_wait->Observe(std::chrono::duration<double, std::milli>(stats.waitTime).count());
+        metrics.task_run->Observe(std::chrono::duration<double, std::milli>(stats.runTime).count());
+        const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        auto last = metrics.last_update_ns.load(std::memory_order_relaxed);
+        const bool period_elapsed =
+            now - last >= std::chrono::duration_cast<std::chrono::nanoseconds>(kThreadPoolGaugePeriod).count();
+        if ((period_elapsed || executor.getPendingTaskCount() == 0) &&
+            metrics.last_update_ns.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            metrics.UpdateGauges(executor);
+        }
+    });
+    metrics.UpdateGauges(executor);
+}
+
+// the executor of the search pool of the NUMA node, with the search priority of the calling thread
+folly::Executor::KeepAlive<>
+SearchExecutor(int numa_node) {
+    auto pool = numa_node >= 0 ? GetNumaSearchThreadPool(numa_node) : ThreadPool::GetGlobalSearchThreadPool();
+    if (numa_node < 0) {
+        InstrumentThreadPool(SearchThreadPoolMetrics(), pool->GetPool());
+    }
+    return folly::ExecutorWithPriority::create(folly::getKeepAliveToken(pool->GetPool()),
+                                               static_cast<int8_t>(GetSearchPriority()));
+}
+
+// wraps a task to run with the priority, the deadline, the stage times, the fault counter and the NUMA node of the
+// calling thread
+template <typename Func>
+auto
+WithSearchContext(Func func, int numa_node) {
+    return [func = std::move(func), priority = GetSearchPriority(), deadline = GetSearchDeadline(), numa_node,
+            stage_times = GetSearchStageTimes(), faults = GetSearchFaults(),
+            account = std::make_shared<SearchTaskAccount>()]() {
+        ThreadPool::ScopedSearchOmpSetter setter(1);
+        ScopedSearchPriority priority_setter(priority);
+        ScopedSearchDeadline deadline_setter(deadline);
+        ScopedSearchStageTimes stage_times_setter(stage_times);
+        ScopedSearchFaults faults_setter(faults);
+        if (numa_node >= 0) {
+            BindCurrentThreadToNumaNode(numa_node);
+        }
+        ScopedNumaNode numa_setter(numa_node);
+        account->Start();
+        ScopedSearchThreadPoolTask task_marker;
+        func();
+    };
+}
+}  // namespace
+
+ScopedSearchPriority::ScopedSearchPriority(SearchPriority priority) : prev_priority_(search_priority) {
+    search_priority = priority;
+}
+
+ScopedSearchPriority::~ScopedSearchPriority() {
+    search_priority = prev_priority_;
+}
+
+SearchPriority
+GetSearchPriority() {
+    return search_priority;
+}
+
+ScopedSearchDeadline::ScopedSearchDeadline(SearchDeadline deadline) : prev_deadline_(std::move(search_deadline)) {
+    search_deadline = std::move(deadline);
+}
+
+ScopedSearchDeadline::~ScopedSearchDeadline() {
+    search_deadline = std::move(prev_deadline_);
+}
+
+const SearchDeadline&
+GetSearchDeadline() {
+    return search_deadline;
+}
+
+SearchDeadline
+MakeSearchDeadline(int32_t timeout_ms) {
+    SearchDeadline deadline = GetSearchDeadline();
+    if (timeout_ms > 0) {
+        deadline.time =
+            std::min(deadline.time, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms));
+    }
+    if (deadline.time != std::chrono::steady_clock::time_point::max() || deadline.cancelled != nullptr) {
+        deadline.interrupted = std::make_shared<std::atomic<bool>>(false);
+    }
+    return deadline;
+}
+
+bool
+SearchInterrupted() {
+    const auto& deadline = search_deadline;
+    if (deadline.time == std::chrono::steady_clock::time_point::max() && deadline.cancelled == nullptr) {
+        return false;
+    }
+    if ((deadline.cancelled != nullptr && deadline.cancelled->load(std::memory_order_relaxed)) ||
+        std::chrono::steady_clock::now() >= deadline.time) {
+        if (deadline.interrupted != nullptr) {
+            deadline.interrupted->store(true, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;
+}
+
+void
+SetSearchQueueLimit(SearchPriority priority, size_t limit) {
+    search_queue_limits[PriorityClass(priority)].store(limit);
+}
+
+size_t
+GetSearchQueueLimit(SearchPriority priority) {
+    return search_queue_limits[PriorityClass(priority)].load();
+}
+
+void
+SetSearchAdmissionPolicy(SearchAdmissionPolicy policy) {
+    search_admission_policy.store(policy);
+}
+
+SearchAdmissionPolicy
+GetSearchAdmissionPolicy() {
+    return search_admission_policy.load();
+}
+
+size_t
+GetSearchQueueDepth(SearchPriority priority) {
+    return search_queue_depths[PriorityClass(priority)].load(std::memory_order_relaxed);
+}
+
+Status
+AdmitSearch() {
+    const size_t priority_class = PriorityClass(GetSearchPriority());
+    const size_t limit = search_queue_limits[priority_class].load(std::memory_order_relaxed);
+    if (limit == 0 || IsSearchThreadPoolTask()) {
+        return Status::success;
+    }
+    auto backoff = std::chrono::microseconds(50);
+    while (search_queue_depths[priority_class].load(std::memory_order_relaxed) >= limit) {
+        if (search_admission_policy.load(std::memory_order_relaxed) == SearchAdmissionPolicy::REJECT ||
+            SearchInterrupted()) {
+            GetSearchPriorityMetrics(priority_class).rejected->Increment();
+            return Status::resource_exhausted;
+        }
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(2 * backoff, std::chrono::microseconds(1000));
+    }
+    return Status::success;
+}
+
+SearchTaskAccount::SearchTaskAccount()
+    : priority_class_(PriorityClass(GetSearchPriority())), time_(std::chrono::steady_clock::now()) {
+    search_queue_depths[priority_class_].fetch_add(1, std::memory_order_relaxed);
+    GetSearchPriorityMetrics(priority_class_).queue_depth->Increment();
+}
+
+void
+SearchTaskAccount::Start() {
+    if (started_) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    search_queue_depths[priority_class_].fetch_sub(1, std::memory_order_relaxed);
+    GetSearchPriorityMetrics(priority_class_).queue_depth->Decrement();
+    knowhere_search_busy_threads.Increment();
+    const auto queue_ms = ElapsedMs(time_, now);
+    knowhere_queue_latency.Observe(queue_ms);
+    RecordSearchStage(SearchStage::QUEUE_WAIT, queue_ms);
+    started_ = true;
+    time_ = now;
+}
+
+SearchTaskAccount::~SearchTaskAccount() {
+    if (!started_) {
+        // the task was dropped without running
+        search_queue_depths[priority_class_].fetch_sub(1, std::memory_order_relaxed);
+        GetSearchPriorityMetrics(priority_class_).queue_depth->Decrement();
+        return;
+    }
+    knowhere_search_busy_threads.Decrement();
+    knowhere_exec_latency.Observe(ElapsedMs(time_, std::chrono::steady_clock::now()));
+}
+
+ScopedSearchThreadPoolTask::ScopedSearchThreadPoolTask() : prev_in_task_(in_search_pool_task) {
+    in_search_pool_task = true;
+}
+
+ScopedSearchThreadPoolTask::~ScopedSearchThreadPoolTask() {
+    in_search_pool_task = prev_in_task_;
+}
+
+bool
+IsSearchThreadPoolTask() {
+    return in_search_pool_task;
+}
+
 void
 ExecOverSearchThreadPool(std::vector<std::function<void()>>& tasks) {
-    auto pool = ThreadPool::GetGlobalSearchThreadPool();
+    const int numa_node = IsNumaModeEnabled() ? GetCurrentNumaNode() : -1;
+    auto executor = SearchExecutor(numa_node);
     std::vector<folly::Future<folly::Unit>> futures;
     futures.reserve(tasks.size());
     for (auto&& t : tasks) {
-        futures.emplace_back(pool->push([&t]() {
-            ThreadPool::ScopedSearchOmpSetter setter(1);
-            t();
-        }));
+        futures.emplace_back(folly::via(executor, WithSearchContext([&t]() { t(); }, numa_node)));
     }
     std::this_thread::yield();
     WaitAllSuccess(futures);
 }
 
+folly::SemiFuture<folly::Unit>
+SubmitToSearchThreadPool(std::function<void()> task) {
+    const int numa_node = IsNumaModeEnabled() ? GetCurrentNumaNode() : -1;
+    return folly::via(SearchExecutor(numa_node), WithSearchContext(std::move(task), numa_node)).semi();
+}
+
+void
+RunOnSearchThreadPool(const std::function<void()>& task) {
+    if (IsSearchThreadPoolTask()) {
+        task();
+        return;
+    }
+    SubmitToSearchThreadPool([&task]() { task(); }).get();
+}
+
+void
+ParallelForOverSearchThreadPool(size_t n, size_t item_cost, const std::function<void(size_t, size_t)>& func,
+                                const std::function<void(size_t, size_t)>& skip) {
+    if (n == 0) {
+        return;
+    }
+    const size_t min_chunk = std::max<size_t>(1, kParallelForMinChunkCost / std::max<size_t>(1, item_cost));
+    const size_t num_workers =
+        std::min(std::max<size_t>(1, ThreadPool::GetGlobalSearchThreadPool()->size()), (n + min_chunk - 1) / min_chunk);
+    std::atomic<size_t> next{0};
+    std::vector<std::function<void()>> tasks(num_workers, [&]() {
+        size_t begin = next.load(std::memory_order_relaxed);
+        while (begin < n) {
+            const size_t end = std::min(n, begin + std::max(min_chunk, (n - begin) / (2 * num_workers)));
+            if (next.compare_exchange_weak(begin, end, std::memory_order_relaxed)) {
+                if (!SearchInterrupted()) {
+                    func(begin, end);
+                } else if (skip != nullptr) {
+                    skip(begin, end);
+                }
+                begin = next.load(std::memory_order_relaxed);
+            }
+        }
+    });
+    if (IsSearchThreadPoolTask()) {
+        // a single worker claims all the chunks
+        tasks.front()();
+        return;
+    }
+    ExecOverSearchThreadPool(tasks);
+}
+
 void
 ExecOverBuildThreadPool(std::vector<std::function<void()>>& tasks) {
     auto pool = ThreadPool::GetGlobalBuildThreadPool();
+    InstrumentThreadPool(BuildThreadPoolMetrics(), pool->GetPool());
     std::vector<folly::Future<folly::Unit>> futures;
     futures.reserve(tasks.size());
     for (auto&& t : tasks) {
@@ -53,9 +406,45 @@ ExecOverBuildThreadPool(std::vector<std::function<void()>>& tasks) {
     WaitAllSuccess(futures);
 }
 
+void
+ParallelForOverBuildThreadPool(size_t n, size_t item_cost, const std::function<void(size_t, size_t)>& func) {
+    if (n == 0) {
+        return;
+    }
+    const size_t min_chunk = std::max<size_t>(1, kParallelForMinChunkCost / std::max<size_t>(1, item_cost));
+    const size_t num_workers =
+        std::min(std::max<size_t>(1, ThreadPool::GetGlobalBuildThreadPool()->size()), (n + min_chunk - 1) / min_chunk);
+    if (num_workers == 1 || in_build_parallel_for) {
+        // the nested loops run on the worker, the build pool may have no other thread to spare
+        func(0, n);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    std::vector<std::function<void()>> tasks(num_workers, [&]() {
+        struct InParallelFor {
+            InParallelFor() {
+                in_build_parallel_for = true;
+            }
+            ~InParallelFor() {
+                in_build_parallel_for = false;
+            }
+        } in_parallel_for;
+        size_t begin = next.load(std::memory_order_relaxed);
+        while (begin < n) {
+            const size_t end = std::min(n, begin + std::max(min_chunk, (n - begin) / (2 * num_workers)));
+            if (next.compare_exchange_weak(begin, end, std::memory_order_relaxed)) {
+                func(begin, end);
+                begin = next.load(std::memory_order_relaxed);
+            }
+        }
+    });
+    ExecOverBuildThreadPool(tasks);
+}
+
 void
 InitBuildThreadPool(uint32_t num_threads) {
     ThreadPool::InitGlobalBuildThreadPool(num_threads);
+    InstrumentThreadPools();
 }
 
 folly::CPUThreadPoolExecutor&
@@ -71,6 +460,19 @@ GetSearchThreadPool() {
 void
 InitSearchThreadPool(uint32_t num_threads) {
     ThreadPool::InitGlobalSearchThreadPool(num_threads);
+    InstrumentThreadPools();
+}
+
+void
+InstrumentThreadPools() {
+    auto& search_metrics = SearchThreadPoolMetrics();
+    auto& search_pool = ThreadPool::GetGlobalSearchThreadPool()->GetPool();
+    InstrumentThreadPool(search_metrics, search_pool);
+    search_metrics.UpdateGauges(search_pool);
+    auto& build_metrics = BuildThreadPoolMetrics();
+    auto& build_pool = ThreadPool::GetGlobalBuildThreadPool()->GetPool();
+    InstrumentThreadPool(build_metrics, build_pool);
+    build_metrics.UpdateGauges(build_pool);
 }
 
 size_t
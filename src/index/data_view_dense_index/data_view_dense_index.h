@@ -15,12 +15,15 @@
 #include <knowhere/bitsetview.h>
 #include <knowhere/range_util.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <tuple>
+#include <utility>
 
 #include "faiss/impl/AuxIndexStructures.h"
 #include "faiss/impl/ResultHandler.h"
@@ -28,6 +31,7 @@
 #include "index/data_view_dense_index/refine_computer.h"
 #include "knowhere/bitsetview_idselector.h"
 #include "knowhere/comp/task.h"
+#include "knowhere/comp/warmup.h"
 #include "knowhere/config.h"
 #include "knowhere/operands.h"
 #include "knowhere/range_util.h"
@@ -39,15 +43,17 @@ struct RangeSearchResult;
 DataViewIndexBase is is an index base class.
 This kind of index will not hold raw data by itself, and it will use ViewDataOp to access raw data.
 DataViewIndexBase only keep index meta and data codes(!= raw data) in memory.
+With a ViewDataBatchOp, the refine reads the raw data in batches, hinting the next batch to the data view.
 */
 class DataViewIndexBase {
  public:
     DataViewIndexBase(idx_t d, DataFormatEnum data_type, MetricType metric_type, ViewDataOp view, bool is_cosine,
-                      RefineType refine_type, std::optional<int> build_thread_num)
+                      RefineType refine_type, std::optional<int> build_thread_num, ViewDataBatchOp view_batch = nullptr)
         : d_(d),
           data_type_(data_type),
           metric_type_(metric_type),
           view_data_(view),
+          view_data_batch_(std::move(view_batch)),
           is_cosine_(is_cosine),
           refine_type_(refine_type),
           build_thread_num_(build_thread_num) {
@@ -96,11 +102,12 @@ class DataViewIndexBase {
      * @param k             topk
      * @param out_dist      result ids, size nx * topk
      * @param out_ids       result distances, size nx * topk
+     * @param batch_order   refine the ids of all the queries at once in storage order, reading each vector once
      */
     virtual void
     SearchWithIds(const idx_t n, const void* __restrict x, const idx_t* __restrict ids_num_lims,
                   const idx_t* __restrict ids, const idx_t k, float* __restrict out_dist, idx_t* __restrict out_ids,
-                  const bool use_quant) const = 0;
+                  const bool use_quant, const bool batch_order = false) const = 0;
 
     virtual RangeSearchResult
     RangeSearch(const idx_t n, const void* __restrict x, const float radius, const float range_filter,
@@ -158,6 +165,7 @@ class DataViewIndexBase {
     DataFormatEnum data_type_;
     MetricType metric_type_;
     ViewDataOp view_data_;
+    ViewDataBatchOp view_data_batch_;
     bool is_cosine_;
     int code_size_;
     std::atomic<idx_t> ntotal_ = 0;
@@ -169,8 +177,10 @@ class DataViewIndexBase {
 class DataViewIndexFlat : public DataViewIndexBase {
  public:
     DataViewIndexFlat(idx_t d, DataFormatEnum data_type, MetricType metric_type, ViewDataOp view, bool is_cosine,
-                      RefineType refine_type, std::optional<int> build_thread_num = std::nullopt)
-        : DataViewIndexBase(d, data_type, metric_type, view, is_cosine, refine_type, build_thread_num) {
+                      RefineType refine_type, std::optional<int> build_thread_num = std::nullopt,
+                      ViewDataBatchOp view_batch = nullptr)
+        : DataViewIndexBase(d, data_type, metric_type, view, is_cosine, refine_type, build_thread_num,
+                            std::move(view_batch)) {
         this->ntotal_.store(0);
     }
     void
@@ -247,7 +257,7 @@ class DataViewIndexFlat : public DataViewIndexBase {
     void
     SearchWithIds(const idx_t n, const void* __restrict x, const idx_t* __restrict ids_num_lims,
                   const idx_t* __restrict ids, const idx_t k, float* __restrict out_dist, idx_t* __restrict out_ids,
-                  const bool use_quant) const override;
+                  const bool use_quant, const bool batch_order = false) const override;
 
     RangeSearchResult
     RangeSearch(const idx_t n, const void* __restrict x, const float radius, const float range_filter,
@@ -286,6 +296,25 @@ class DataViewIndexFlat : public DataViewIndexBase {
     }
 
  protected:
+    // the refine distances of the valid ids with the raw data fetched in batches of kRefineBatchSize vectors, each
+    // fetch hinting the ids of the next batch to the data view while the current batch is scored
+    void
+    ComputeDistanceSubsetBatched(const void* __restrict x, const idx_t sub_y_n, float* __restrict x_y_distances,
+                                 const idx_t* __restrict x_y_labels) const;
+
+    // the refine distances of the ids of the n queries, in the order of the ids rather than query by query: the
+    // vector of an id that several queries refine is read once for all of them, and the pages of the vectors are
+    // advised to the kernel (MADV_WILLNEED) before they are read. distances is laid out as ids.
+    void
+    ComputeDistanceBatchInStorageOrder(const idx_t n, const void* __restrict x, const idx_t* __restrict ids_num_lims,
+                                       const idx_t* __restrict ids, float* __restrict distances) const;
+
+    static constexpr idx_t kRefineBatchSize = 64;
+    // the candidates that a task of the storage ordered refine scores
+    static constexpr idx_t kRefineTaskSize = 1024;
+    // the vectors closer than this in memory are advised as one range
+    static constexpr size_t kRefineAdviseGap = 4096;
+
     template <class SingleResultHandler, class SelectorHelper>
     void
     exhaustive_search_in_one_query_impl(const std::unique_ptr<faiss::DistanceComputer>& computer, size_t ny,
@@ -410,7 +439,13 @@ DataViewIndexFlat::Search(const idx_t n, const void* __restrict x, const idx_t k
 void
 DataViewIndexFlat::SearchWithIds(const idx_t n, const void* __restrict x, const idx_t* __restrict ids_num_lims,
                                  const idx_t* __restrict ids, const idx_t k, float* __restrict out_dist,
-                                 idx_t* __restrict out_ids, const bool use_quant) const {
+                                 idx_t* __restrict out_ids, const bool use_quant, const bool batch_order) const {
+    // the quantized data is in memory, the order of its reads does not matter
+    std::unique_ptr<float[]> batch_dist = nullptr;
+    if (batch_order && !use_quant) {
+        batch_dist = std::unique_ptr<float[]>(new float[ids_num_lims[n]]);
+        ComputeDistanceBatchInStorageOrder(n, x, ids_num_lims, ids, batch_dist.get());
+    }
     const auto& search_pool = ThreadPool::GetGlobalSearchThreadPool();
     std::vector<folly::Future<folly::Unit>> futs;
     futs.reserve(n);
@@ -428,7 +463,15 @@ DataViewIndexFlat::SearchWithIds(const idx_t n, const void* __restrict x, const
             auto x_i = (const char*)x + code_size_ * i;
 
             assert(base_n >= k);
-            ComputeDistanceSubset(x_i, base_n, base_dist.get(), base_ids, use_quant);
+            if (batch_dist != nullptr) {
+                for (auto j = 0; j < base_n; j++) {
+                    if (base_ids[j] >= 0) {
+                        base_dist[j] = batch_dist[ids_num_lims[i] + j];
+                    }
+                }
+            } else {
+                ComputeDistanceSubset(x_i, base_n, base_dist.get(), base_ids, use_quant);
+            }
             if (is_cosine_) {
                 std::shared_lock lock(norms_mutex_);
                 for (auto j = 0; j < base_n; j++) {
@@ -583,15 +626,199 @@ DataViewIndexFlat::RangeSearchWithIds(const idx_t n, const void* __restrict x, c
 void
 DataViewIndexFlat::ComputeDistanceSubset(const void* __restrict x, const idx_t sub_y_n, float* x_y_distances,
                                          const idx_t* __restrict x_y_labels, const bool use_quant) const {
+    if (!use_quant && view_data_batch_ != nullptr) {
+        ComputeDistanceSubsetBatched(x, sub_y_n, x_y_distances, x_y_labels);
+        return;
+    }
     auto computer =
         SelectDataViewComputer(view_data_, data_type_, metric_type_, d_, is_cosine_, use_quant ? quant_data_ : nullptr);
 
     computer->set_query((const float*)(x));
-    const idx_t* __restrict idsj = x_y_labels;
-    float* __restrict disj = x_y_distances;
+    if (use_quant) {
+        const idx_t* __restrict idsj = x_y_labels;
+        float* __restrict disj = x_y_distances;
+
+        auto filter = [=](const size_t i) { return (idsj[i] >= 0); };
+        auto apply = [=](const float dis, const size_t i) { disj[i] = dis; };
+        distance_compute_by_idx_if(idsj, sub_y_n, computer.get(), filter, apply);
+        return;
+    }
+    // the candidates come in the order of their base distances, the raw data is read in the order of the ids instead,
+    // that of the pages of a mapped file
+    std::vector<std::pair<idx_t, idx_t>> id_positions;
+    id_positions.reserve(sub_y_n);
+    for (idx_t i = 0; i < sub_y_n; i++) {
+        if (x_y_labels[i] >= 0) {
+            id_positions.emplace_back(x_y_labels[i], i);
+        }
+    }
+    std::sort(id_positions.begin(), id_positions.end());
+    const auto num_ids = static_cast<idx_t>(id_positions.size());
+    idx_t j = 0;
+    for (; j + 4 <= num_ids; j += 4) {
+        float dis0, dis1, dis2, dis3;
+        computer->distances_batch_4(id_positions[j].first, id_positions[j + 1].first, id_positions[j + 2].first,
+                                    id_positions[j + 3].first, dis0, dis1, dis2, dis3);
+        x_y_distances[id_positions[j].second] = dis0;
+        x_y_distances[id_positions[j + 1].second] = dis1;
+        x_y_distances[id_positions[j + 2].second] = dis2;
+        x_y_distances[id_positions[j + 3].second] = dis3;
+    }
+    for (; j < num_ids; j++) {
+        x_y_distances[id_positions[j].second] = (*computer)(id_positions[j].first);
+    }
+}
+
+void
+DataViewIndexFlat::ComputeDistanceSubsetBatched(const void* __restrict x, const idx_t sub_y_n,
+                                                float* __restrict x_y_distances,
+                                                const idx_t* __restrict x_y_labels) const {
+    std::vector<std::pair<idx_t, idx_t>> id_positions;
+    id_positions.reserve(sub_y_n);
+    for (idx_t i = 0; i < sub_y_n; i++) {
+        if (x_y_labels[i] >= 0) {
+            id_positions.emplace_back(x_y_labels[i], i);
+        }
+    }
+    // the batches are fetched in the order of the ids, for the data view to read its storage forward
+    std::sort(id_positions.begin(), id_positions.end());
+    std::vector<idx_t> ids;
+    std::vector<idx_t> positions;
+    ids.reserve(id_positions.size());
+    positions.reserve(id_positions.size());
+    for (const auto& [id, position] : id_positions) {
+        ids.push_back(id);
+        positions.push_back(position);
+    }
+    const auto num_ids = static_cast<idx_t>(ids.size());
+    auto buffer = std::make_unique<uint8_t[]>(kRefineBatchSize * code_size_);
+    // the computer reads the rows of the batch in the buffer
+    ViewDataOp batch_view = [data = buffer.get(), code_size = code_size_](size_t i) -> const void* {
+        return data + i * code_size;
+    };
+    auto computer = SelectDataViewComputer(batch_view, data_type_, metric_type_, d_, is_cosine_, nullptr);
+    computer->set_query((const float*)(x));
+    for (idx_t begin = 0; begin < num_ids; begin += kRefineBatchSize) {
+        const auto n = std::min(kRefineBatchSize, num_ids - begin);
+        const auto next_begin = begin + n;
+        const auto next_n = std::min(kRefineBatchSize, num_ids - next_begin);
+        view_data_batch_(ids.data() + begin, n, buffer.get(), next_n > 0 ? ids.data() + next_begin : nullptr,
+                         next_n);
+        idx_t j = 0;
+        for (; j + 4 <= n; j += 4) {
+            float dis0, dis1, dis2, dis3;
+            computer->distances_batch_4(j, j + 1, j + 2, j + 3, dis0, dis1, dis2, dis3);
+            x_y_distances[positions[begin + j]] = dis0;
+            x_y_distances[positions[begin + j + 1]] = dis1;
+            x_y_distances[positions[begin + j + 2]] = dis2;
+            x_y_distances[positions[begin + j + 3]] = dis3;
+        }
+        for (; j < n; j++) {
+            x_y_distances[positions[begin + j]] = (*computer)(j);
+        }
+    }
+}
+
+void
+DataViewIndexFlat::ComputeDistanceBatchInStorageOrder(const idx_t n, const void* __restrict x,
+                                                      const idx_t* __restrict ids_num_lims,
+                                                      const idx_t* __restrict ids, float* __restrict distances) const {
+    // (id, query, position in ids) of the candidates, sorted by id
+    std::vector<std::tuple<idx_t, idx_t, idx_t>> candidates;
+    candidates.reserve(ids_num_lims[n]);
+    for (idx_t i = 0; i < n; i++) {
+        for (idx_t j = ids_num_lims[i]; j < ids_num_lims[i + 1]; j++) {
+            if (ids[j] >= 0) {
+                candidates.emplace_back(ids[j], i, j);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    const auto num_candidates = static_cast<idx_t>(candidates.size());
+    // the tasks score consecutive ranges of candidates, the candidates of an id in the same task
+    std::vector<idx_t> task_begins;
+    for (idx_t begin = 0; begin < num_candidates;) {
+        task_begins.push_back(begin);
+        auto end = std::min(begin + kRefineTaskSize, num_candidates);
+        while (end < num_candidates && std::get<0>(candidates[end]) == std::get<0>(candidates[end - 1])) {
+            end++;
+        }
+        begin = end;
+    }
+    task_begins.push_back(num_candidates);
 
-    auto filter = [=](const size_t i) { return (idsj[i] >= 0); };
-    auto apply = [=](const float dis, const size_t i) { disj[i] = dis; };
-    distance_compute_by_idx_if(idsj, sub_y_n, computer.get(), filter, apply);
+    const auto& search_pool = ThreadPool::GetGlobalSearchThreadPool();
+    std::vector<folly::Future<folly::Unit>> futs;
+    futs.reserve(task_begins.size() - 1);
+    for (size_t t = 0; t + 1 < task_begins.size(); t++) {
+        futs.emplace_back(search_pool->push([&, begin = task_begins[t], end = task_begins[t + 1]] {
+            ThreadPool::ScopedSearchOmpSetter setter(1);
+            // the distinct ids of the task, and the range of their candidates
+            std::vector<idx_t> task_ids;
+            std::vector<idx_t> id_begins;
+            for (idx_t c = begin; c < end; c++) {
+                if (c == begin || std::get<0>(candidates[c]) != std::get<0>(candidates[c - 1])) {
+                    task_ids.push_back(std::get<0>(candidates[c]));
+                    id_begins.push_back(c);
+                }
+            }
+            id_begins.push_back(end);
+            const auto num_ids = static_cast<idx_t>(task_ids.size());
+
+            std::unique_ptr<uint8_t[]> buffer = nullptr;
+            ViewDataOp view = view_data_;
+            if (view_data_batch_ != nullptr) {
+                buffer = std::make_unique<uint8_t[]>(kRefineBatchSize * code_size_);
+                view = [data = buffer.get(), code_size = code_size_](size_t i) -> const void* {
+                    return data + i * code_size;
+                };
+            } else {
+                // the vectors on the same or on neighbouring pages are advised at once
+                std::vector<MemoryRange> ranges;
+                for (const auto id : task_ids) {
+                    const auto data = (const char*)view_data_(id);
+                    if (!ranges.empty()) {
+                        auto& last = ranges.back();
+                        const auto last_end = (const char*)last.data + last.size;
+                        if (data >= last_end && data <= last_end + kRefineAdviseGap) {
+                            last.size = data + code_size_ - (const char*)last.data;
+                            continue;
+                        }
+                    }
+                    ranges.push_back({data, (size_t)code_size_});
+                }
+                AdviseMmapAccess(ranges, MmapAccess::WILLNEED);
+            }
+            // a computer per query of the task, set up on its first candidate
+            std::vector<std::unique_ptr<faiss::DistanceComputer>> computers(n);
+            auto score = [&](const idx_t k, const idx_t view_idx) {
+                for (idx_t c = id_begins[k]; c < id_begins[k + 1]; c++) {
+                    const auto& [id, query, position] = candidates[c];
+                    auto& computer = computers[query];
+                    if (computer == nullptr) {
+                        computer = SelectDataViewComputer(view, data_type_, metric_type_, d_, is_cosine_, nullptr);
+                        computer->set_query((const float*)((const char*)x + code_size_ * query));
+                    }
+                    distances[position] = (*computer)(view_idx);
+                }
+            };
+            if (view_data_batch_ == nullptr) {
+                for (idx_t k = 0; k < num_ids; k++) {
+                    score(k, task_ids[k]);
+                }
+                return;
+            }
+            for (idx_t b = 0; b < num_ids; b += kRefineBatchSize) {
+                const auto nb = std::min(kRefineBatchSize, num_ids - b);
+                const auto next_n = std::min(kRefineBatchSize, num_ids - b - nb);
+                view_data_batch_(task_ids.data() + b, nb, buffer.get(), next_n > 0 ? task_ids.data() + b + nb : nullptr,
+                                 next_n);
+                for (idx_t k = 0; k < nb; k++) {
+                    score(b + k, k);
+                }
+            }
+        }));
+    }
+    WaitAllSuccess(futs);
 }
 }  // namespace knowhere
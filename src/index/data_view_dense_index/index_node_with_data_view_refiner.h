@@ -35,9 +35,14 @@ class IndexNodeWithDataViewRefiner : public IndexNode {
 
  public:
     IndexNodeWithDataViewRefiner(const int32_t& version, const Object& object) {
-        auto data_view_index_pack = dynamic_cast<const Pack<ViewDataOp>*>(&object);
-        assert(data_view_index_pack != nullptr);
-        view_data_op_ = data_view_index_pack->GetPack();
+        if (auto data_view_ops_pack = dynamic_cast<const Pack<DataViewOps>*>(&object)) {
+            view_data_op_ = data_view_ops_pack->GetPack().view_data;
+            view_data_batch_op_ = data_view_ops_pack->GetPack().view_data_batch;
+        } else {
+            auto data_view_index_pack = dynamic_cast<const Pack<ViewDataOp>*>(&object);
+            assert(data_view_index_pack != nullptr);
+            view_data_op_ = data_view_index_pack->GetPack();
+        }
         base_index_ = std::make_unique<BaseIndexNode>(version, nullptr);
         base_index_lock_ = std::make_unique<FairRWLock>();
     }
@@ -223,6 +228,17 @@ class IndexNodeWithDataViewRefiner : public IndexNode {
             }
         }
 
+        size_t
+        NextBatch(size_t n, int64_t* ids, float* dists) override {
+            if (!initialized_) {
+                initialize();
+            }
+            if (!refine_) {
+                return base_workspace_->NextBatch(n, ids, dists);
+            }
+            return IndexNode::iterator::NextBatch(n, ids, dists);
+        }
+
         void
         initialize() override {
             if (initialized_) {
@@ -252,9 +268,17 @@ class IndexNodeWithDataViewRefiner : public IndexNode {
             if (!base_workspace_->HasNext() || refine_ == false) {
                 return;
             }
-            while (base_workspace_->HasNext() && (refined_res_.empty() || refined_res_.size() < min_refine_size())) {
-                auto pair = base_workspace_->Next();
-                refined_res_.emplace(pair.first, raw_distance(pair.first) * sign_);
+            const size_t n_refine = std::max(min_refine_size(), (size_t)1);
+            if (refined_res_.size() >= n_refine) {
+                return;
+            }
+            // fetch all the results to refine from the base iterator at once
+            refine_ids_.resize(n_refine - refined_res_.size());
+            refine_dists_.resize(refine_ids_.size());
+            const size_t n_fetched =
+                base_workspace_->NextBatch(refine_ids_.size(), refine_ids_.data(), refine_dists_.data());
+            for (size_t i = 0; i < n_fetched; i++) {
+                refined_res_.emplace(refine_ids_[i], raw_distance(refine_ids_[i]) * sign_);
             }
         }
 
@@ -264,9 +288,12 @@ class IndexNodeWithDataViewRefiner : public IndexNode {
         std::unique_ptr<DataType[]> copied_query_ = nullptr;
         IndexNode::IteratorPtr base_workspace_ = nullptr;
         std::unique_ptr<faiss::DistanceComputer> refine_computer_ = nullptr;
+        std::vector<int64_t> refine_ids_;
+        std::vector<float> refine_dists_;
     };
     bool is_cosine_;
     ViewDataOp view_data_op_;
+    ViewDataBatchOp view_data_batch_op_;
     std::shared_ptr<DataViewIndexFlat>
         refine_offset_index_;                // a data view flat index to maintain raw data without extra memory
     std::unique_ptr<IndexNode> base_index_;  // base_index will hold data codes in memory, datatype is fp32
@@ -322,7 +349,8 @@ IndexNodeWithDataViewRefiner<DataType, BaseIndexNode>::Train(const DataSetPtr da
     auto [fp32_train_ds, _] =
         ConvertToBaseIndexFp32DataSet<DataType>(dataset, this->is_cosine_, 0, train_rows, base_index_dim);
     refine_offset_index_ = std::make_unique<DataViewIndexFlat>(
-        dim, datatype_v<DataType>, refine_metric, this->view_data_op_, is_cosine_, refine_type, build_thread_num);
+        dim, datatype_v<DataType>, refine_metric, this->view_data_op_, is_cosine_, refine_type, build_thread_num,
+        this->view_data_batch_op_);
     try {
         refine_offset_index_->Train(train_rows, data, use_knowhere_build_pool);
     } catch (const std::exception& e) {
@@ -378,6 +406,7 @@ IndexNodeWithDataViewRefiner<DataType, BaseIndexNode>::Search(const DataSetPtr d
     auto dim = dataset->GetDim();
     auto topk = base_cfg.k.value();
     auto refine_with_quant = base_cfg.refine_with_quant.value();
+    auto refine_batch_order = base_cfg.refine_batch_order.value();
     // basic search
     AdaptToBaseIndexConfig(cfg.get(), PARAM_TYPE::SEARCH, dim);
     auto base_index_ds = std::get<0>(
@@ -400,8 +429,9 @@ IndexNodeWithDataViewRefiner<DataType, BaseIndexNode>::Search(const DataSetPtr d
     auto labels = std::make_unique<int64_t[]>(nq * topk);
     auto distances = std::make_unique<float[]>(nq * topk);
     try {
+        ScopedSearchStage stage(SearchStage::REFINE);
         refine_offset_index_->SearchWithIds(nq, dataset->GetTensor(), queries_lims.data(), refine_ids, topk,
-                                            distances.get(), labels.get(), refine_with_quant);
+                                            distances.get(), labels.get(), refine_with_quant, refine_batch_order);
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "data view index inner error: " << e.what();
         return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
@@ -12,6 +12,12 @@
 // knowhere-specific indices
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include "faiss/impl/DistanceComputer.h"
 #include "faiss/impl/ScalarQuantizer.h"
 #include "faiss/invlists/InvertedLists.h"
@@ -47,13 +53,82 @@ convert_data(const void* in_data, float* out_data, const DataFormatEnum data_typ
     return false;
 }
 }  // namespace
+/*
+The int8 refine codes: every dimension is stored as an int8 with a symmetric scale per dimension, followed by the
+squared norm of the decoded vector for L2. The query is folded with the scales and quantized to int8 with a scale of
+its own, so that a distance is a single int8 inner product, with the VNNI kernels of simd/hook.h where available.
+ */
+struct Int8RefineDistanceComputer : faiss::ScalarQuantizer::SQDistanceComputer {
+    Int8RefineDistanceComputer(size_t d, const std::vector<float>& scales, faiss::MetricType metric)
+        : d(d), scales(scales), metric(metric), query_code(d) {
+        code_size = d + sizeof(float);
+    }
+
+    void
+    set_query(const float* x) override {
+        q = x;
+        std::vector<float> folded(d);
+        float max_abs = 0.0f;
+        for (size_t i = 0; i < d; i++) {
+            folded[i] = x[i] * scales[i];
+            max_abs = std::max(max_abs, std::abs(folded[i]));
+        }
+        query_scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+        for (size_t i = 0; i < d; i++) {
+            query_code[i] = static_cast<int8_t>(std::lround(folded[i] / query_scale));
+        }
+        query_norm = metric == faiss::MetricType::METRIC_L2 ? faiss::fvec_norm_L2sqr(x, d) : 0.0f;
+    }
+
+    float
+    query_to_code(const uint8_t* code) const override {
+        return ToDistance(faiss::int8_vec_inner_product(query_code.data(), (const int8_t*)code, d), code);
+    }
+
+    void
+    query_to_codes_batch_4(const uint8_t* __restrict code_0, const uint8_t* __restrict code_1,
+                           const uint8_t* __restrict code_2, const uint8_t* __restrict code_3, float& dis0, float& dis1,
+                           float& dis2, float& dis3) const override {
+        faiss::int8_vec_inner_product_batch_4(query_code.data(), (const int8_t*)code_0, (const int8_t*)code_1,
+                                              (const int8_t*)code_2, (const int8_t*)code_3, d, dis0, dis1, dis2, dis3);
+        dis0 = ToDistance(dis0, code_0);
+        dis1 = ToDistance(dis1, code_1);
+        dis2 = ToDistance(dis2, code_2);
+        dis3 = ToDistance(dis3, code_3);
+    }
+
+    float
+    symmetric_dis(idx_t i, idx_t j) override {
+        throw std::runtime_error("symmetric_dis() not support for Int8RefineDistanceComputer");
+    }
+
+ private:
+    float
+    ToDistance(float code_ip, const uint8_t* code) const {
+        const float ip = code_ip * query_scale;
+        if (metric == faiss::MetricType::METRIC_INNER_PRODUCT) {
+            return ip;
+        }
+        float code_norm;
+        std::memcpy(&code_norm, code + d, sizeof(float));
+        return query_norm - 2 * ip + code_norm;
+    }
+
+    size_t d;
+    const std::vector<float>& scales;
+    faiss::MetricType metric;
+    std::vector<int8_t> query_code;
+    float query_scale = 1.0f;
+    float query_norm = 0.0f;
+};
+
 /*
 Quantify the streaming data with a thread safe mode, only support fp32 vector
  */
 struct QuantRefine {
  public:
     QuantRefine(size_t d, DataFormatEnum data_type, RefineType refine_type, MetricType metric)
-        : origin_data_type(data_type), refine_type(refine_type) {
+        : dim(d), origin_data_type(data_type), refine_type(refine_type) {
         if (metric == metric::IP) {
             metric_type = faiss::MetricType::METRIC_INNER_PRODUCT;
         } else if (metric == metric::L2) {
@@ -71,37 +146,44 @@ struct QuantRefine {
             case RefineType::FLOAT16_QUANT:
                 quantizer = new faiss::ScalarQuantizer(d, faiss::ScalarQuantizer::QuantizerType::QT_fp16);
                 break;
+            case RefineType::SQ4_QUANT:
+                quantizer = new faiss::ScalarQuantizer(d, faiss::ScalarQuantizer::QuantizerType::QT_4bit);
+                break;
+            case RefineType::INT8_QUANT:
+                // the int8 codes are encoded by QuantRefine itself, see Int8RefineDistanceComputer
+                break;
             default:
                 throw std::runtime_error("Fail to generate quant for refiner if refine_type == RefineType::DATA_VIEW");
                 break;
         }
-        storage = new faiss::ConcurrentArrayInvertedLists(list_num, quantizer->code_size, segment_size, false);
+        code_size = quantizer != nullptr ? quantizer->code_size : d + sizeof(float);
+        storage = new faiss::ConcurrentArrayInvertedLists(list_num, code_size, segment_size, false);
     }
     void
     Train(const void* train_data, const size_t n) {
         if (origin_data_type == DataFormatEnum::fp32) {
-            quantizer->train(n, (const float*)train_data);
+            TrainFp32((const float*)train_data, n);
         } else {
-            auto fp32_x = std::unique_ptr<float[]>(new float[n * quantizer->d]);
-            if (convert_data(train_data, fp32_x.get(), origin_data_type, n, quantizer->d) != true) {
+            auto fp32_x = std::unique_ptr<float[]>(new float[n * dim]);
+            if (convert_data(train_data, fp32_x.get(), origin_data_type, n, dim) != true) {
                 throw std::runtime_error("fail to convert data to fp32 type.");
             }
-            quantizer->train(n, fp32_x.get());
+            TrainFp32(fp32_x.get(), n);
         }
     }
 
     void
     Add(const void* data, const idx_t* ids, const size_t n) {
-        auto codes = std::make_unique<uint8_t[]>(n * quantizer->code_size);
+        auto codes = std::make_unique<uint8_t[]>(n * code_size);
         if (origin_data_type == DataFormatEnum::fp32) {
-            quantizer->compute_codes((const float*)data, codes.get(), n);
+            ComputeCodes((const float*)data, codes.get(), n);
             storage->add_entries(key, n, ids, codes.get());
         } else {
-            auto fp32_x = std::unique_ptr<float[]>(new float[n * quantizer->d]);
-            if (convert_data(data, fp32_x.get(), origin_data_type, n, quantizer->d) != true) {
+            auto fp32_x = std::unique_ptr<float[]>(new float[n * dim]);
+            if (convert_data(data, fp32_x.get(), origin_data_type, n, dim) != true) {
                 throw std::runtime_error("fail to convert data to fp32 type.");
             }
-            quantizer->compute_codes(fp32_x.get(), codes.get(), n);
+            ComputeCodes(fp32_x.get(), codes.get(), n);
             storage->add_entries(key, n, ids, codes.get());
         }
     }
@@ -116,6 +198,9 @@ struct QuantRefine {
     }
     std::unique_ptr<faiss::ScalarQuantizer::SQDistanceComputer>
     GetQuantComputer() {
+        if (quantizer == nullptr) {
+            return std::make_unique<Int8RefineDistanceComputer>(dim, int8_scales, metric_type);
+        }
         return std::unique_ptr<faiss::ScalarQuantizer::SQDistanceComputer>(
             quantizer->get_distance_computer(metric_type));
     }
@@ -134,10 +219,49 @@ struct QuantRefine {
     }
 
  private:
+    void
+    TrainFp32(const float* x, const size_t n) {
+        if (quantizer != nullptr) {
+            quantizer->train(n, x);
+            return;
+        }
+        // the scale of a dimension maps its max absolute value to 127
+        int8_scales.assign(dim, 0.0f);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < dim; j++) {
+                int8_scales[j] = std::max(int8_scales[j], std::abs(x[i * dim + j]));
+            }
+        }
+        for (auto& scale : int8_scales) {
+            scale = scale > 0.0f ? scale / 127.0f : 1.0f;
+        }
+    }
+
+    void
+    ComputeCodes(const float* x, uint8_t* codes, const size_t n) const {
+        if (quantizer != nullptr) {
+            quantizer->compute_codes(x, codes, n);
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            auto code = (int8_t*)(codes + i * code_size);
+            float norm = 0.0f;
+            for (size_t j = 0; j < dim; j++) {
+                auto value = std::clamp<long>(std::lround(x[i * dim + j] / int8_scales[j]), -127, 127);
+                code[j] = static_cast<int8_t>(value);
+                norm += (value * int8_scales[j]) * (value * int8_scales[j]);
+            }
+            std::memcpy(code + dim, &norm, sizeof(float));
+        }
+    }
+
     static constexpr size_t key = 0;
     static constexpr size_t list_num = 1;
     static constexpr size_t segment_size = 48;
+    size_t dim;
+    size_t code_size;
     faiss::ScalarQuantizer* quantizer = nullptr;
+    std::vector<float> int8_scales;
     faiss::InvertedLists* storage = nullptr;
     faiss::MetricType metric_type;
     DataFormatEnum origin_data_type;
@@ -166,7 +290,7 @@ struct QuantDataDistanceComputer : faiss::DistanceComputer {
     void
     set_query(const float* x) override {
         if (quant_data->GetOriginDataType() == DataFormatEnum::fp32) {
-            qc->q = x;
+            qc->set_query(x);
             if constexpr (NeedNormalize) {
                 q_norm = GetL2Norm(x, dim);
             }
@@ -175,7 +299,7 @@ struct QuantDataDistanceComputer : faiss::DistanceComputer {
             if (convert_data(x, query_buf.data(), quant_data->GetOriginDataType(), 1, dim) != true) {
                 throw std::runtime_error("fail to convert data to fp32 type.");
             }
-            qc->q = query_buf.data();
+            qc->set_query(query_buf.data());
             if constexpr (NeedNormalize) {
                 q_norm = GetL2Norm(query_buf.data(), dim);
             }
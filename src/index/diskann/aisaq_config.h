@@ -27,6 +27,8 @@ class AisaqConfig : public DiskANNConfig {
     CFG_STRING pq_read_io_engine;
     // number of entry points valid only with aisaq option.
     CFG_INT num_entry_points;
+    // nodes read ahead of each hop among its best neighbours, default 0 (disabled)
+    CFG_INT speculative_reads;
 
     KNOHWERE_DECLARE_CONFIG(AisaqConfig) {
         // Block AiSAQ parameters
@@ -80,6 +82,12 @@ class AisaqConfig : public DiskANNConfig {
             .set_range(diskann::defaults::MIN_NUM_ENTRY_POINTS, diskann::defaults::MAX_NUM_ENTRY_POINTS)
             .description("number of entry points")
             .for_train();
+
+        KNOWHERE_CONFIG_DECLARE_FIELD(speculative_reads)
+            .set_default(0)
+            .set_range(0, 64)
+            .description("nodes read ahead of each hop among its best neighbours")
+            .for_search();
     }
 };
 }  // namespace knowhere
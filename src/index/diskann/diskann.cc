@@ -11,15 +11,21 @@
 
 #include "knowhere/feder/DiskANN.h"
 
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
 
 #include "diskann/aux_utils.h"
 #include "diskann/linux_aligned_file_reader.h"
+#include "diskann/linux_uring_aligned_file_reader.h"
 #include "diskann/pq_flash_index.h"
+#include "diskann/tiered_aligned_file_reader.h"
 #include "filemanager/FileManager.h"
 #include "fmt/core.h"
 #include "index/diskann/diskann_config.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/numa.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
 #include "knowhere/feature.h"
@@ -38,13 +44,23 @@ class DiskANNIndexNode : public IndexNode {
 
  public:
     using DistType = float;
-    DiskANNIndexNode(const int32_t& version, const Object& object) : is_prepared_(false), dim_(-1), count_(-1) {
+    DiskANNIndexNode(const int32_t& version, const Object& object)
+        : IndexNode(version), is_prepared_(false), dim_(-1), count_(-1) {
         assert(typeid(object) == typeid(Pack<std::shared_ptr<milvus::FileManager>>));
         auto diskann_index_pack = dynamic_cast<const Pack<std::shared_ptr<milvus::FileManager>>*>(&object);
         assert(diskann_index_pack != nullptr);
         file_manager_ = diskann_index_pack->GetPack();
     }
 
+    ~DiskANNIndexNode() override;
+
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        // the data is read from data_path, the build stays within its dram budget
+        const auto& build_conf = static_cast<const DiskANNConfig&>(cfg);
+        return static_cast<int64_t>(build_conf.build_dram_budget_gb.value_or(0) * (1LL << 30));
+    }
+
     Status
     Build(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
 
@@ -53,14 +69,25 @@ class DiskANNIndexNode : public IndexNode {
         return Status::not_implemented;
     }
 
+    // The rows added to a loaded index are indexed in memory until they are merged into the index on disk, with
+    // the ids that follow the ones of the index.
     Status
-    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
-        return Status::not_implemented;
-    }
+    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
+
+    // The deleted rows are filtered out of the searches until they are dropped by a merge.
+    Status
+    Delete(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
 
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
 
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchAsync(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
+
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override;
+
     expected<DataSetPtr>
     GetVectorByIds(const DataSetPtr dataset) const override;
 
@@ -98,6 +125,12 @@ class DiskANNIndexNode : public IndexNode {
         return Status::not_implemented;
     }
 
+    // The file of DiskANN is read with O_DIRECT, bypassing the page cache: the sample queries of the index are searched
+    // instead, for the node cache and the PQ data of the nodes that searches go through to be loaded. The progress is
+    // reported in queries.
+    Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) override;
+
     static std::unique_ptr<BaseConfig>
     StaticCreateConfig() {
         return std::make_unique<DiskANNConfig>();
@@ -129,11 +162,42 @@ class DiskANNIndexNode : public IndexNode {
 
     int64_t
     Size() const override {
-        if (!is_prepared_.load() || !pq_flash_index_) {
+        if (!is_prepared_.load()) {
             LOG_KNOWHERE_ERROR_ << "Diskann not loaded.";
             return 0;
         }
-        return pq_flash_index_->cal_size();
+        auto tiers = std::atomic_load(&tiers_);
+        int64_t size = tiers->disk->cal_size();
+        for (const auto& delta : tiers->deltas) {
+            size += delta->index.Size();
+        }
+        return size;
+    }
+
+    // the disk file is read with O_DIRECT, only the memory of the index is reported
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        if (!is_prepared_.load()) {
+            return expected<MemoryReport>::Err(Status::empty_index, "DiskANN not loaded");
+        }
+        auto tiers = std::atomic_load(&tiers_);
+        const auto mem = tiers->disk->cal_memory();
+        MemoryReport report;
+        report.AddHeap(MemoryComponent::SCRATCH, mem.scratch);
+        report.AddHeap(MemoryComponent::CACHE, mem.node_cache);
+        report.AddHeap(MemoryComponent::CODES, mem.pq_codes);
+        report.AddHeap(MemoryComponent::CENTROIDS, mem.pq_pivots);
+        int64_t disk_ids_size = 0;
+        if (tiers->disk_ids != nullptr) {
+            disk_ids_size = tiers->disk_ids->size() * sizeof(int64_t);
+        }
+        report.AddHeap(MemoryComponent::ID_MAP, mem.id_map + disk_ids_size);
+        int64_t deltas_size = 0;
+        for (const auto& delta : tiers->deltas) {
+            deltas_size += delta->index.Size();
+        }
+        report.AddHeap(MemoryComponent::OTHER, mem.other + deltas_size);
+        return report;
     }
 
     int64_t
@@ -158,8 +222,8 @@ class DiskANNIndexNode : public IndexNode {
     class iterator : public IndexIterator {
      public:
         iterator(const bool transform, const DataType* query_data, const uint64_t lsearch, const uint64_t beam_width,
-                 const float filter_ratio, const knowhere::BitsetView& bitset, diskann::PQFlashIndex<DataType>* index,
-                 bool use_knowhere_search_pool = true)
+                 const float filter_ratio, const knowhere::BitsetView& bitset,
+                 std::shared_ptr<diskann::PQFlashIndex<DataType>> index, bool use_knowhere_search_pool = true)
             : IndexIterator(transform, use_knowhere_search_pool),
               index_(index),
               transform_(transform),
@@ -180,7 +244,7 @@ class DiskANNIndexNode : public IndexNode {
         }
 
      private:
-        diskann::PQFlashIndex<DataType>* index_;
+        std::shared_ptr<diskann::PQFlashIndex<DataType>> index_;
         const bool transform_;
         std::unique_ptr<diskann::IteratorWorkspace<DataType>> workspace_;
     };
@@ -206,14 +270,122 @@ class DiskANNIndexNode : public IndexNode {
     uint64_t
     GetCachedNodeNum(const float cache_dram_budget, const uint64_t data_dim, const uint64_t max_degree);
 
+    // searches the sample queries in the given file on index, as a search after the load would
+    Status
+    SearchSampleQueries(diskann::PQFlashIndex<DataType>& index, const std::string& sample_file,
+                        const WarmupProgress& progress);
+
+    // searches into the given buffers, or into buffers owned by the result when they are null
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchAsyncWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                       DistType* distances) const;
+
+    // searches the index on disk, whose rows are filtered by bitset, as SearchAsyncWithBuf
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchDiskAsync(std::shared_ptr<diskann::PQFlashIndex<DataType>> disk, const DataSetPtr dataset,
+                    std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids, DistType* distances) const;
+
+    // The rows added to the index are taken by a growing HNSW_CC index in memory, a delta, with the ids that follow
+    // base.
+    struct Delta {
+        int64_t base;
+        Index<IndexNode> index;
+    };
+
+    // The index on disk and the deltas of the rows added since it was built. The deltas and the deleted rows are
+    // merged into a new index on disk in the background once they reach merge_threshold of its rows, the new index
+    // then replaces the index and the merged deltas. The tiers are published as a snapshot, like the segments of
+    // HNSW_CC: a search grabs the latest snapshot and searches it without any lock.
+    struct Tiers {
+        std::shared_ptr<diskann::PQFlashIndex<DataType>> disk;
+        // the ids of the rows of the index on disk in ascending order, nullptr if they are their positions
+        std::shared_ptr<const std::vector<int64_t>> disk_ids;
+        // the oldest first
+        std::vector<std::shared_ptr<const Delta>> deltas;
+        // the ids of the rows on disk and of the merged deltas are below end
+        int64_t end = 0;
+
+        int64_t
+        DiskId(int64_t row) const {
+            return disk_ids == nullptr ? row : (*disk_ids)[row];
+        }
+
+        // the id of the next row added
+        int64_t
+        Count() const {
+            return deltas.empty() ? end : deltas.back()->base + deltas.back()->index.Count();
+        }
+    };
+
+    // whether the row of id was deleted, it reads deleted_ without update_mutex_ as Delete() is not called
+    // concurrently with the searches
+    bool
+    IsDeleted(int64_t id) const {
+        return id < static_cast<int64_t>(deleted_.size()) * 8 && (deleted_[id >> 3] >> (id & 7)) & 1;
+    }
+
+    // fills bits with the bitset of the rows [0, rows) of a tier, whose ids are given by id_of, from bitset and the
+    // deleted rows, returns the number of rows filtered out
+    template <typename IdOf>
+    size_t
+    TierBitset(const BitsetView& bitset, int64_t rows, IdOf&& id_of, std::vector<uint8_t>& bits) const;
+
+    // merges the results of the tiers into the top k of each query of the search
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchTiers(std::shared_ptr<const Tiers> tiers, const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                const BitsetView& bitset, int64_t* ids, DistType* distances) const;
+
+    // starts a merge in the background if the updates reach the merge_threshold of cfg, called with update_mutex_
+    void
+    MaybeMerge(std::shared_ptr<Config> cfg);
+
+    // merges the rows of the index on disk and of the deltas that are not deleted into a new index on disk, which
+    // replaces them
+    void
+    MergeUpdates();
+
+    // builds the index of the rows of tiers that are not deleted under prefix, fills ids with the ids of its rows,
+    // builds nothing if all the rows are deleted. Gives up between the chunks of rows and the phases of the build,
+    // with an error, once the index is being destroyed.
+    Status
+    BuildMerged(const Tiers& tiers, const std::vector<uint8_t>& deleted, const DiskANNConfig& conf,
+                const std::string& prefix, std::vector<int64_t>& ids);
+
+    // loads the index built under prefix with the config of the load of the index, nullptr if it fails
+    std::shared_ptr<diskann::PQFlashIndex<DataType>>
+    LoadMerged(const std::string& prefix);
+
     std::string index_prefix_;
     mutable std::mutex preparation_lock_;
     std::atomic_bool is_prepared_;
     std::shared_ptr<milvus::FileManager> file_manager_;
-    std::unique_ptr<diskann::PQFlashIndex<DataType>> pq_flash_index_;
+    // accessed with std::atomic_load and std::atomic_store only
+    std::shared_ptr<const Tiers> tiers_;
     std::atomic_int64_t dim_;
     std::atomic_int64_t count_;
     std::shared_ptr<ThreadPool> search_pool_;
+    std::string metric_type_;
+    // the config of the load of the index, for the merged indexes
+    std::shared_ptr<Config> load_cfg_;
+
+    std::mutex update_mutex_;
+    // the deleted rows, a bit per id, guarded by update_mutex_
+    std::vector<uint8_t> deleted_;
+    // the number of deleted rows that the tiers still hold, guarded by update_mutex_
+    int64_t num_deleted_ = 0;
+    // whether a merge is running and the number of deltas it merges, the deltas after them take the added rows,
+    // guarded by update_mutex_
+    bool merging_ = false;
+    size_t merging_deltas_ = 0;
+    // the config of the update that started the merge, with the build parameters of the merged index
+    std::shared_ptr<Config> merge_cfg_;
+    // set when the index is being destroyed, for a running merge to give up; read by the merge without update_mutex_
+    std::atomic_bool stopping_ = false;
+    std::condition_variable merge_done_;
+    // the prefix of the last merged index, empty for the index loaded, and the number of merges, guarded by
+    // update_mutex_
+    std::string merged_prefix_;
+    int64_t num_merges_ = 0;
 };
 
 }  // namespace knowhere
@@ -267,6 +439,7 @@ GetOptionalFilenames(const std::string& prefix) {
     auto disk_index_filename = diskann::get_disk_index_filename(prefix);
     filenames.push_back(diskann::get_disk_index_centroids_filename(disk_index_filename));
     filenames.push_back(diskann::get_disk_index_medoids_filename(disk_index_filename));
+    filenames.push_back(diskann::get_disk_index_layout_filename(disk_index_filename));
     filenames.push_back(diskann::get_cached_nodes_file(prefix));
     return filenames;
 }
@@ -285,6 +458,17 @@ AnyIndexFileExist(const std::string& index_prefix) {
            file_exist(GetOptionalFilenames(index_prefix));
 }
 
+// removes the files of the index of prefix
+void
+RemoveIndexFiles(const std::string& prefix) {
+    for (const auto& filename : GetNecessaryFilenames(prefix, true, true, true)) {
+        std::remove(filename.c_str());
+    }
+    for (const auto& filename : GetOptionalFilenames(prefix)) {
+        std::remove(filename.c_str());
+    }
+}
+
 inline bool
 CheckMetric(const std::string& diskann_metric) {
     if (diskann_metric != knowhere::metric::L2 && diskann_metric != knowhere::metric::IP &&
@@ -299,6 +483,74 @@ CheckMetric(const std::string& diskann_metric) {
         return true;
     }
 }
+
+diskann::Metric
+GetDiskANNMetric(const std::string& metric_type) {
+    if (IsMetricType(metric_type, knowhere::metric::L2)) {
+        return diskann::Metric::L2;
+    } else if (IsMetricType(metric_type, knowhere::metric::COSINE)) {
+        return diskann::Metric::COSINE;
+    } else {
+        return diskann::Metric::INNER_PRODUCT;
+    }
+}
+
+// the reader of the index file of the io_engine of conf
+std::shared_ptr<AlignedFileReader>
+CreateFileReader(const DiskANNConfig& conf) {
+    std::shared_ptr<AlignedFileReader> reader = nullptr;
+    if (conf.io_engine.value() == "uring") {
+#ifdef KNOWHERE_WITH_IO_URING
+        reader.reset(new LinuxUringAlignedFileReader(conf.io_uring_sqpoll.value(), conf.io_priority.value()));
+#endif
+    } else {
+        reader.reset(new LinuxAlignedFileReader(conf.io_priority.value()));
+    }
+    return reader;
+}
+
+// sets up the dynamic cache and the rerank tier of a loaded index
+template <typename DataType>
+Status
+SetUpMemoryTiers(const DiskANNConfig& conf, diskann::PQFlashIndex<DataType>& index) {
+    if (conf.dynamic_cache_budget_gb.value() > 0) {
+        auto budget_bytes = static_cast<uint64_t>(conf.dynamic_cache_budget_gb.value() * 1024 * 1024 * 1024);
+        uint64_t num_slots = 0;
+        if (TryDiskANNCall([&]() { num_slots = index.setup_dynamic_cache(budget_bytes); }) != Status::success) {
+            LOG_KNOWHERE_ERROR_ << "Failed to set up the dynamic cache for DiskANN.";
+            return Status::diskann_inner_error;
+        }
+        if (num_slots == 0) {
+            LOG_KNOWHERE_WARNING_ << "dynamic_cache_budget_gb(" << conf.dynamic_cache_budget_gb.value()
+                                  << ") is too small to cache a node, the dynamic cache is disabled.";
+        }
+    }
+
+    if (conf.rerank_tier.value() != "none") {
+        auto tier_type =
+            conf.rerank_tier.value() == "sq8" ? diskann::RerankTierType::SQ8 : diskann::RerankTierType::FP16;
+        auto budget_bytes = static_cast<uint64_t>(conf.rerank_tier_budget_gb.value() * 1024 * 1024 * 1024);
+        bool loaded = false;
+        if (TryDiskANNCall([&]() { loaded = index.load_rerank_tier(tier_type, budget_bytes); }) != Status::success) {
+            LOG_KNOWHERE_ERROR_ << "Failed to load the rerank tier for DiskANN.";
+            return Status::diskann_inner_error;
+        }
+        if (!loaded) {
+            LOG_KNOWHERE_WARNING_ << "rerank_tier_budget_gb(" << conf.rerank_tier_budget_gb.value()
+                                  << ") is too small to hold the " << conf.rerank_tier.value()
+                                  << " vectors or the index has no full precision vectors on disk, no rerank tier.";
+        }
+    }
+    return Status::success;
+}
+
+// The merges of the updated indexes wait for their builds, which run on the global build pool, so they run on a pool
+// of their own.
+std::shared_ptr<ThreadPool>
+MergeThreadPool() {
+    static std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(1, "Knowhere_DiskANNMerge");
+    return pool;
+}
 }  // namespace
 
 template <typename DataType>
@@ -335,15 +587,7 @@ DiskANNIndexNode<DataType>::Build(const DataSetPtr dataset, std::shared_ptr<Conf
 
     bool need_norm = IsMetricType(build_conf.metric_type.value(), knowhere::metric::IP) ||
                      IsMetricType(build_conf.metric_type.value(), knowhere::metric::COSINE);
-    auto diskann_metric = [m = build_conf.metric_type.value()] {
-        if (IsMetricType(m, knowhere::metric::L2)) {
-            return diskann::Metric::L2;
-        } else if (IsMetricType(m, knowhere::metric::COSINE)) {
-            return diskann::Metric::COSINE;
-        } else {
-            return diskann::Metric::INNER_PRODUCT;
-        }
-    }();
+    auto diskann_metric = GetDiskANNMetric(build_conf.metric_type.value());
     auto num_nodes_to_cache =
         GetCachedNodeNum(build_conf.search_cache_budget_gb.value(), dim, build_conf.max_degree.value());
     diskann::BuildConfig diskann_internal_build_config{data_path,
@@ -358,6 +602,8 @@ DiskANNIndexNode<DataType>::Build(const DataSetPtr dataset, std::shared_ptr<Conf
                                                        build_conf.accelerate_build.value(),
                                                        static_cast<uint32_t>(num_nodes_to_cache),
                                                        build_conf.shuffle_build.value()};
+    diskann_internal_build_config.shard_parallelism = static_cast<unsigned>(build_conf.build_shard_parallelism.value());
+    diskann_internal_build_config.optimize_layout = build_conf.optimize_disk_layout.value();
     RETURN_IF_ERROR(TryDiskANNCall([&]() {
         int res = diskann::build_disk_index<DataType>(diskann_internal_build_config);
         if (res != 0)
@@ -402,20 +648,25 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr
     bool is_ip = IsMetricType(prep_conf.metric_type.value(), knowhere::metric::IP);
     bool need_norm = IsMetricType(prep_conf.metric_type.value(), knowhere::metric::IP) ||
                      IsMetricType(prep_conf.metric_type.value(), knowhere::metric::COSINE);
-    auto diskann_metric = [m = prep_conf.metric_type.value()] {
-        if (IsMetricType(m, knowhere::metric::L2)) {
-            return diskann::Metric::L2;
-        } else if (IsMetricType(m, knowhere::metric::COSINE)) {
-            return diskann::Metric::COSINE;
-        } else {
-            return diskann::Metric::INNER_PRODUCT;
+    auto diskann_metric = GetDiskANNMetric(prep_conf.metric_type.value());
+
+    std::shared_ptr<RangeReader> range_reader = nullptr;
+    if (prep_conf.tiered_load.value()) {
+        range_reader = RangeReader::GetGlobalRangeReader();
+        if (range_reader == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "tiered_load needs a disk range reader, see KnowhereConfig::SetDiskRangeReader.";
+            return Status::invalid_args;
         }
-    }();
+    }
+    auto disk_index_filename = diskann::get_disk_index_filename(index_prefix_);
 
-    // Load file from file manager.
+    // Load file from file manager, the index file is read through the range reader for a tiered load.
     for (auto& filename : GetNecessaryFilenames(
              index_prefix_, need_norm, prep_conf.search_cache_budget_gb.value() > 0 && !prep_conf.use_bfs_cache.value(),
              prep_conf.warm_up.value())) {
+        if (range_reader != nullptr && filename == disk_index_filename) {
+            continue;
+        }
         if (!LoadFile(filename)) {
             return Status::disk_file_error;
         }
@@ -435,13 +686,20 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr
     search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
 
     // load diskann pq code and meta info
-    std::shared_ptr<AlignedFileReader> reader = nullptr;
-
-    reader.reset(new LinuxAlignedFileReader());
+    auto reader = CreateFileReader(prep_conf);
+    if (range_reader != nullptr) {
+        auto tiered_reader = std::make_shared<TieredAlignedFileReader>(reader, range_reader);
+        // the index reads the metadata of the file before it opens it
+        if (TryDiskANNCall([&]() { tiered_reader->prepare(disk_index_filename); }) != Status::success) {
+            LOG_KNOWHERE_ERROR_ << "Failed to prepare the tiered load of " << disk_index_filename << ".";
+            return Status::disk_file_error;
+        }
+        reader = tiered_reader;
+    }
 
-    pq_flash_index_ = std::make_unique<diskann::PQFlashIndex<DataType>>(reader, diskann_metric);
+    auto pq_flash_index = std::make_shared<diskann::PQFlashIndex<DataType>>(reader, diskann_metric);
     auto disk_ann_call = [&]() {
-        int res = pq_flash_index_->load(search_pool_->size(), index_prefix_.c_str());
+        int res = pq_flash_index->load(search_pool_->size(), index_prefix_.c_str());
         if (res != 0) {
             throw diskann::ANNException("pq_flash_index_->load returned non-zero value: " + std::to_string(res), -1);
         }
@@ -451,12 +709,12 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr
         return Status::diskann_inner_error;
     }
 
-    count_.store(pq_flash_index_->get_num_points());
+    count_.store(pq_flash_index->get_num_points());
     // DiskANN will add one more dim for IP type.
     if (is_ip) {
-        dim_.store(pq_flash_index_->get_data_dim() - 1);
+        dim_.store(pq_flash_index->get_data_dim() - 1);
     } else {
-        dim_.store(pq_flash_index_->get_data_dim());
+        dim_.store(pq_flash_index->get_data_dim());
     }
 
     std::string warmup_query_file = diskann::get_sample_data_filename(index_prefix_);
@@ -471,8 +729,8 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr
         node_list.assign(cached_nodes_ids.get(), cached_nodes_ids.get() + num_nodes);
     } else {
         auto num_nodes_to_cache = GetCachedNodeNum(prep_conf.search_cache_budget_gb.value(),
-                                                   pq_flash_index_->get_data_dim(), pq_flash_index_->get_max_degree());
-        if (num_nodes_to_cache > pq_flash_index_->get_num_points() / 3) {
+                                                   pq_flash_index->get_data_dim(), pq_flash_index->get_max_degree());
+        if (num_nodes_to_cache > pq_flash_index->get_num_points() / 3) {
             LOG_KNOWHERE_ERROR_ << "Failed to generate cache, num_nodes_to_cache(" << num_nodes_to_cache
                                 << ") is larger than 1/3 of the total data number.";
             return Status::invalid_args;
@@ -481,7 +739,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr
             LOG_KNOWHERE_INFO_ << "Caching " << num_nodes_to_cache << " sample nodes around medoid(s).";
             if (prep_conf.use_bfs_cache.value()) {
                 LOG_KNOWHERE_INFO_ << "Use bfs to generate cache list";
-                if (TryDiskANNCall([&]() { pq_flash_index_->cache_bfs_levels(num_nodes_to_cache, node_list); }) !=
+                if (TryDiskANNCall([&]() { pq_flash_index->cache_bfs_levels(num_nodes_to_cache, node_list); }) !=
                     Status::success) {
                     LOG_KNOWHERE_ERROR_ << "Failed to generate bfs cache for DiskANN.";
                     return Status::diskann_inner_error;
@@ -489,7 +747,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr
             } else {
                 LOG_KNOWHERE_INFO_ << "Use sample_queries to generate cache list";
                 if (TryDiskANNCall([&]() {
-                        pq_flash_index_->async_generate_cache_list_from_sample_queries(warmup_query_file, 15, 6,
+                        pq_flash_index->async_generate_cache_list_from_sample_queries(warmup_query_file, 15, 6,
                                                                                        num_nodes_to_cache);
                     }) != Status::success) {
                     LOG_KNOWHERE_ERROR_ << "Failed to generate cache from sample queries for DiskANN.";
@@ -501,65 +759,198 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr
     }
 
     if (node_list.size() > 0) {
-        if (TryDiskANNCall([&]() { pq_flash_index_->load_cache_list(node_list); }) != Status::success) {
+        if (TryDiskANNCall([&]() { pq_flash_index->load_cache_list(node_list); }) != Status::success) {
             LOG_KNOWHERE_ERROR_ << "Failed to load cache for DiskANN.";
             return Status::diskann_inner_error;
         }
     }
 
+    RETURN_IF_ERROR(SetUpMemoryTiers(prep_conf, *pq_flash_index));
+
     // warmup
     if (prep_conf.warm_up.value()) {
         LOG_KNOWHERE_INFO_ << "Warming up.";
-        uint64_t warmup_L = 20;
-        uint64_t warmup_num = 0;
-        uint64_t warmup_dim = 0;
-        uint64_t warmup_aligned_dim = 0;
-        DataType* warmup = nullptr;
-        if (TryDiskANNCall([&]() {
-                diskann::load_aligned_bin<DataType>(warmup_query_file, warmup, warmup_num, warmup_dim,
-                                                    warmup_aligned_dim);
-            }) != Status::success) {
-            LOG_KNOWHERE_ERROR_ << "Failed to load warmup file for DiskANN.";
-            return Status::disk_file_error;
+        auto status = SearchSampleQueries(*pq_flash_index, warmup_query_file, nullptr);
+        if (status != Status::success) {
+            return status;
         }
-        std::vector<int64_t> warmup_result_ids_64(warmup_num, 0);
-        std::vector<DistType> warmup_result_dists(warmup_num, 0);
+    }
 
-        std::vector<folly::Future<folly::Unit>> futures;
-        futures.reserve(warmup_num);
-        for (_s64 i = 0; i < (int64_t)warmup_num; ++i) {
-            futures.emplace_back(search_pool_->push([&, index = i]() {
-                pq_flash_index_->cached_beam_search(warmup + (index * warmup_aligned_dim), 1, warmup_L,
-                                                    warmup_result_ids_64.data() + (index * 1),
-                                                    warmup_result_dists.data() + (index * 1), 4);
-            }));
-        }
+    auto tiers = std::make_shared<Tiers>();
+    tiers->disk = std::move(pq_flash_index);
+    tiers->end = count_.load();
+    std::atomic_store(&tiers_, std::shared_ptr<const Tiers>(std::move(tiers)));
+    metric_type_ = prep_conf.metric_type.value();
+    load_cfg_ = cfg;
+    is_prepared_.store(true);
+    LOG_KNOWHERE_INFO_ << "End of diskann loading.";
+    return Status::success;
+}
 
-        bool failed = TryDiskANNCall([&]() { WaitAllSuccess(futures); }) != Status::success;
+template <typename DataType>
+DiskANNIndexNode<DataType>::~DiskANNIndexNode() {
+    std::unique_lock lock(update_mutex_);
+    stopping_ = true;
+    merge_done_.wait(lock, [this] { return !merging_; });
+    // the merged indexes are local to the index
+    if (!merged_prefix_.empty()) {
+        RemoveIndexFiles(merged_prefix_);
+    }
+}
 
-        if (warmup != nullptr) {
-            diskann::aligned_free(warmup);
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) {
+    if (!is_prepared_.load()) {
+        LOG_KNOWHERE_ERROR_ << "DiskANN takes the rows added once it is loaded.";
+        return Status::empty_index;
+    }
+    if (dataset->GetDim() != Dim()) {
+        LOG_KNOWHERE_ERROR_ << "The dim of the rows added (" << dataset->GetDim() << ") is not the dim of the index ("
+                            << Dim() << ").";
+        return Status::invalid_args;
+    }
+    const auto& conf = static_cast<const DiskANNConfig&>(*cfg);
+
+    std::lock_guard lock(update_mutex_);
+    auto tiers = std::make_shared<Tiers>(*std::atomic_load(&tiers_));
+    // the deltas take the degree of the index on disk, with the two layers of links of HNSW
+    Json delta_json;
+    delta_json[meta::METRIC_TYPE] = metric_type_;
+    delta_json[indexparam::HNSW_M] = std::clamp<int64_t>(tiers->disk->get_max_degree() / 2, 2, 2048);
+    delta_json[indexparam::EFCONSTRUCTION] = conf.search_list_size.value();
+    // the deltas being merged take no more rows
+    if (tiers->deltas.size() <= merging_deltas_) {
+        auto index = IndexFactory::Instance().Create<DataType>(IndexEnum::INDEX_HNSW_CC, version_.VersionNumber());
+        if (!index.has_value()) {
+            LOG_KNOWHERE_ERROR_ << "Failed to create the delta of DiskANN: " << index.what();
+            return index.error();
         }
+        RETURN_IF_ERROR(index.value().Train(dataset, delta_json, use_knowhere_build_pool));
+        const auto base = tiers->Count();
+        tiers->deltas.push_back(std::make_shared<const Delta>(Delta{base, index.value()}));
+    }
+    auto delta = tiers->deltas.back()->index;
+    RETURN_IF_ERROR(delta.Add(dataset, delta_json, use_knowhere_build_pool));
+    count_.store(tiers->Count());
+    std::atomic_store(&tiers_, std::shared_ptr<const Tiers>(std::move(tiers)));
+    MaybeMerge(std::move(cfg));
+    return Status::success;
+}
 
-        if (failed) {
-            LOG_KNOWHERE_ERROR_ << "Failed to do search on warmup file for DiskANN.";
-            return Status::diskann_inner_error;
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::Delete(const DataSetPtr dataset, std::shared_ptr<Config> cfg,
+                                   bool use_knowhere_build_pool) {
+    if (!is_prepared_.load()) {
+        LOG_KNOWHERE_ERROR_ << "DiskANN deletes rows once it is loaded.";
+        return Status::empty_index;
+    }
+    const auto rows = dataset->GetRows();
+    const auto* ids = dataset->GetIds();
+
+    std::lock_guard lock(update_mutex_);
+    const auto count = std::atomic_load(&tiers_)->Count();
+    for (int64_t i = 0; i < rows; ++i) {
+        if (ids[i] < 0 || ids[i] >= count) {
+            LOG_KNOWHERE_ERROR_ << "The id deleted " << ids[i] << " is out of range [0, " << count << ").";
+            return Status::invalid_args;
+        }
+    }
+    if (static_cast<int64_t>(deleted_.size()) * 8 < count) {
+        deleted_.resize((count + 7) / 8, 0);
+    }
+    for (int64_t i = 0; i < rows; ++i) {
+        if (!IsDeleted(ids[i])) {
+            deleted_[ids[i] >> 3] |= 1 << (ids[i] & 7);
+            ++num_deleted_;
         }
     }
+    MaybeMerge(std::move(cfg));
+    return Status::success;
+}
 
-    is_prepared_.store(true);
-    LOG_KNOWHERE_INFO_ << "End of diskann loading.";
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::SearchSampleQueries(diskann::PQFlashIndex<DataType>& index, const std::string& sample_file,
+                                                const WarmupProgress& progress) {
+    uint64_t warmup_L = 20;
+    uint64_t warmup_num = 0;
+    uint64_t warmup_dim = 0;
+    uint64_t warmup_aligned_dim = 0;
+    DataType* warmup = nullptr;
+    if (TryDiskANNCall([&]() {
+            diskann::load_aligned_bin<DataType>(sample_file, warmup, warmup_num, warmup_dim, warmup_aligned_dim);
+        }) != Status::success) {
+        LOG_KNOWHERE_ERROR_ << "Failed to load warmup file for DiskANN.";
+        return Status::disk_file_error;
+    }
+    std::vector<int64_t> warmup_result_ids_64(warmup_num, 0);
+    std::vector<DistType> warmup_result_dists(warmup_num, 0);
+
+    std::mutex progress_mutex;
+    size_t done = 0;
+    std::vector<folly::Future<folly::Unit>> futures;
+    futures.reserve(warmup_num);
+    for (_s64 i = 0; i < (int64_t)warmup_num; ++i) {
+        futures.emplace_back(search_pool_->push([&, row = i]() {
+            index.cached_beam_search(warmup + (row * warmup_aligned_dim), 1, warmup_L,
+                                     warmup_result_ids_64.data() + (row * 1), warmup_result_dists.data() + (row * 1),
+                                     4);
+            if (progress) {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                progress(++done, warmup_num);
+            }
+        }));
+    }
+
+    bool failed = TryDiskANNCall([&]() { WaitAllSuccess(futures); }) != Status::success;
+
+    if (warmup != nullptr) {
+        diskann::aligned_free(warmup);
+    }
+
+    if (failed) {
+        LOG_KNOWHERE_ERROR_ << "Failed to do search on warmup file for DiskANN.";
+        return Status::diskann_inner_error;
+    }
     return Status::success;
 }
 
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::Warmup(WarmupLevel /*level*/, const WarmupProgress& progress) {
+    if (!is_prepared_.load()) {
+        LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
+        return Status::empty_index;
+    }
+    // the sample queries are only loaded along the index when it is warmed up at its load
+    auto sample_file = diskann::get_sample_data_filename(index_prefix_);
+    if (!file_exists(sample_file)) {
+        LOG_KNOWHERE_WARNING_ << "No sample queries to warm up DiskANN with, load it with warm_up.";
+        if (progress) {
+            progress(0, 0);
+        }
+        return Status::success;
+    }
+    LOG_KNOWHERE_INFO_ << "Warming up.";
+    return SearchSampleQueries(*std::atomic_load(&tiers_)->disk, sample_file, progress);
+}
+
 template <typename DataType>
 expected<std::vector<IndexNode::IteratorPtr>>
 DiskANNIndexNode<DataType>::AnnIterator(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset,
                                         bool use_knowhere_search_pool) const {
-    if (!is_prepared_.load() || !pq_flash_index_) {
+    if (!is_prepared_.load()) {
         LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
         return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::empty_index, "DiskANN not loaded");
     }
+    // the iterators walk the graph on disk only
+    auto tiers = std::atomic_load(&tiers_);
+    if (tiers->disk_ids != nullptr || !tiers->deltas.empty() || !deleted_.empty()) {
+        return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::not_implemented,
+                                                                  "DiskANN iterators do not support updated indexes");
+    }
 
     auto search_conf = static_cast<const DiskANNConfig&>(*cfg);
     if (!CheckMetric(search_conf.metric_type.value())) {
@@ -584,7 +975,7 @@ DiskANNIndexNode<DataType>::AnnIterator(const DataSetPtr dataset, std::unique_pt
         for (int i = 0; i < nq; i++) {
             auto single_query = (DataType*)xq + i * dim;
             auto it = std::make_shared<iterator>(transform, single_query, lsearch, beamwidth, filter_ratio, bitset,
-                                                 pq_flash_index_.get(), use_knowhere_search_pool);
+                                                 tiers->disk, use_knowhere_search_pool);
             vec[i] = it;
         }
     } catch (const std::exception& e) {
@@ -598,65 +989,278 @@ template <typename DataType>
 expected<DataSetPtr>
 DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
                                    const BitsetView& bitset) const {
-    if (!is_prepared_.load() || !pq_flash_index_) {
+    return SearchAsync(dataset, std::move(cfg), bitset).get();
+}
+
+template <typename DataType>
+folly::SemiFuture<expected<DataSetPtr>>
+DiskANNIndexNode<DataType>::SearchAsync(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                                        const BitsetView& bitset) const {
+    return SearchAsyncWithBuf(dataset, std::move(cfg), bitset, nullptr, nullptr);
+}
+
+template <typename DataType>
+expected<DataSetPtr>
+DiskANNIndexNode<DataType>::SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                                          const BitsetView& bitset, int64_t* ids, float* distances) const {
+    return SearchAsyncWithBuf(dataset, std::move(cfg), bitset, ids, distances).get();
+}
+
+template <typename DataType>
+folly::SemiFuture<expected<DataSetPtr>>
+DiskANNIndexNode<DataType>::SearchAsyncWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                                               const BitsetView& bitset, int64_t* ids, DistType* distances) const {
+    if (!is_prepared_.load()) {
         LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
-        return expected<DataSetPtr>::Err(Status::empty_index, "DiskANN not loaded");
+        return folly::makeSemiFuture(expected<DataSetPtr>::Err(Status::empty_index, "DiskANN not loaded"));
+    }
+    if (!CheckMetric(static_cast<const DiskANNConfig&>(*cfg).metric_type.value())) {
+        return folly::makeSemiFuture(expected<DataSetPtr>::Err(Status::invalid_metric_type, "unsupported metric type"));
     }
 
-    auto search_conf = static_cast<const DiskANNConfig&>(*cfg);
-    if (!CheckMetric(search_conf.metric_type.value())) {
-        return expected<DataSetPtr>::Err(Status::invalid_metric_type, "unsupported metric type");
+    auto tiers = std::atomic_load(&tiers_);
+    if (tiers->disk_ids != nullptr || !tiers->deltas.empty() || !deleted_.empty()) {
+        return SearchTiers(std::move(tiers), dataset, std::move(cfg), bitset, ids, distances);
     }
+    return SearchDiskAsync(tiers->disk, dataset, std::move(cfg), bitset, ids, distances);
+}
+
+template <typename DataType>
+folly::SemiFuture<expected<DataSetPtr>>
+DiskANNIndexNode<DataType>::SearchDiskAsync(std::shared_ptr<diskann::PQFlashIndex<DataType>> disk,
+                                            const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                                            const BitsetView& bitset, int64_t* ids, DistType* distances) const {
+    auto search_conf = static_cast<const DiskANNConfig&>(*cfg);
     auto k = static_cast<uint64_t>(search_conf.k.value());
     auto lsearch = static_cast<uint64_t>(search_conf.search_list_size.value());
     auto beamwidth = static_cast<uint64_t>(search_conf.beamwidth.value());
+    auto min_beamwidth = static_cast<uint64_t>(search_conf.min_beamwidth.value());
     auto filter_ratio = static_cast<float>(search_conf.filter_threshold.value());
+    auto filtered_read_skip_ratio = static_cast<float>(search_conf.filtered_read_skip_threshold.value());
+    auto exact_rerank = search_conf.exact_rerank.value();
     auto nq = dataset->GetRows();
     auto dim = dataset->GetDim();
     auto xq = static_cast<const DataType*>(dataset->GetTensor());
 
-    feder::diskann::FederResultUniq feder_result;
+    // shared by the queries, which outlive this call
+    struct SearchState {
+        DataSetPtr dataset;
+        ResultBuffer<int64_t> owned_id;
+        ResultBuffer<DistType> owned_dist;
+        int64_t* p_id = nullptr;
+        DistType* p_dist = nullptr;
+        feder::diskann::FederResultUniq feder_result;
+        // the stats of the queries, filled by their tasks if search_stats is set
+        SearchStats search_stats;
+    };
+    auto state = std::make_shared<SearchState>();
+    state->dataset = dataset;
+    if (search_conf.search_stats.value()) {
+        state->search_stats.resize(nq);
+    }
     if (search_conf.trace_visit.value()) {
         if (nq != 1) {
-            return expected<DataSetPtr>::Err(Status::invalid_args, "nq must be 1");
+            return folly::makeSemiFuture(expected<DataSetPtr>::Err(Status::invalid_args, "nq must be 1"));
         }
-        feder_result = std::make_unique<feder::diskann::FederResult>();
-        feder_result->visit_info_.SetQueryConfig(search_conf.k.value(), search_conf.beamwidth.value(),
-                                                 search_conf.search_list_size.value(), search_conf.beamwidth.value());
+        state->feder_result = std::make_unique<feder::diskann::FederResult>();
+        state->feder_result->visit_info_.SetQueryConfig(search_conf.k.value(), search_conf.beamwidth.value(),
+                                                        search_conf.search_list_size.value(),
+                                                        search_conf.beamwidth.value());
     }
 
-    auto p_id = std::make_unique<int64_t[]>(k * nq);
-    auto p_dist = std::make_unique<DistType[]>(k * nq);
+    if (ids == nullptr) {
+        state->owned_id = AllocateResultBuffer<int64_t>(k * nq);
+        state->owned_dist = AllocateResultBuffer<DistType>(k * nq);
+        ids = state->owned_id.get();
+        distances = state->owned_dist.get();
+    }
+    state->p_id = ids;
+    state->p_dist = distances;
 
     std::vector<folly::Future<folly::Unit>> futures;
     futures.reserve(nq);
     for (int64_t row = 0; row < nq; ++row) {
-        futures.emplace_back(search_pool_->push([&, index = row, p_id_ptr = p_id.get(), p_dist_ptr = p_dist.get()]() {
+        futures.emplace_back(PushSearchTask(search_pool_, [=]() {
+            if (SearchInterrupted()) {
+                MarkMissingResults(state->p_id, state->p_dist, k, row, row + 1);
+                return;
+            }
             diskann::QueryStats stats;
-            pq_flash_index_->cached_beam_search(xq + (index * dim), k, lsearch, p_id_ptr + (index * k),
-                                                p_dist_ptr + (index * k), beamwidth, false, &stats, feder_result,
-                                                bitset, filter_ratio);
+            {
+                ScopedSearchStage stage(SearchStage::GRAPH_TRAVERSAL);
+                disk->cached_beam_search(xq + (row * dim), k, lsearch, state->p_id + (row * k),
+                                         state->p_dist + (row * k), beamwidth, false, &stats, state->feder_result,
+                                         bitset, filter_ratio, min_beamwidth, filtered_read_skip_ratio, exact_rerank);
+            }
+            // the reads overlap the traversal, their wait is reported apart
+            RecordSearchStage(SearchStage::IO_WAIT, stats.io_us / 1000);
 #ifdef NOT_COMPILE_FOR_SWIG
             knowhere_diskann_search_hops.Observe(stats.n_hops);
+            knowhere_cache_hit_cnt.Observe(stats.n_cache_hits);
 #endif
+            if (!state->search_stats.empty()) {
+                auto& query_stats = state->search_stats[row];
+                query_stats.distance_computations = stats.n_cmps;
+                query_stats.graph_hops = stats.n_hops;
+                query_stats.io_count = stats.n_ios;
+                query_stats.cache_hits = stats.n_cache_hits;
+            }
         }));
     }
 
-    if (TryDiskANNCall([&]() { WaitAllSuccess(futures); }) != Status::success) {
-        return expected<DataSetPtr>::Err(Status::diskann_inner_error, "some search failed");
+    return folly::collectAll(futures.begin(), futures.end())
+        .deferValue([state, nq, k](std::vector<folly::Try<folly::Unit>>&& results) -> expected<DataSetPtr> {
+            auto status = TryDiskANNCall([&]() {
+                for (const auto& result : results) {
+                    result.throwUnlessValue();
+                }
+            });
+            if (status != Status::success) {
+                return expected<DataSetPtr>::Err(Status::diskann_inner_error, "some search failed");
+            }
+
+            auto res = GenResultDataSet(nq, k, state->p_id, state->p_dist);
+            // the result owns the buffers only if they were not given
+            res->SetIsOwner(state->owned_id != nullptr);
+            if (state->owned_id != nullptr) {
+                res->SetIds(std::move(state->owned_id));
+                res->SetDistance(std::move(state->owned_dist));
+            }
+
+            // set visit_info json string into result dataset
+            if (state->feder_result != nullptr) {
+                Json json_visit_info, json_id_set;
+                nlohmann::to_json(json_visit_info, state->feder_result->visit_info_);
+                nlohmann::to_json(json_id_set, state->feder_result->id_set_);
+                res->SetJsonInfo(json_visit_info.dump());
+                res->SetJsonIdSet(json_id_set.dump());
+            }
+            if (!state->search_stats.empty()) {
+                res->SetSearchStats(std::move(state->search_stats));
+            }
+            return res;
+        });
+}
+
+template <typename DataType>
+template <typename IdOf>
+size_t
+DiskANNIndexNode<DataType>::TierBitset(const BitsetView& bitset, int64_t rows, IdOf&& id_of,
+                                       std::vector<uint8_t>& bits) const {
+    bits.assign((rows + 7) / 8, 0);
+    size_t num_filtered = 0;
+    for (int64_t row = 0; row < rows; ++row) {
+        const auto id = id_of(row);
+        if ((!bitset.empty() && bitset.test(id)) || IsDeleted(id)) {
+            bits[row >> 3] |= 1 << (row & 7);
+            ++num_filtered;
+        }
     }
+    return num_filtered;
+}
 
-    auto res = GenResultDataSet(nq, k, std::move(p_id), std::move(p_dist));
+template <typename DataType>
+folly::SemiFuture<expected<DataSetPtr>>
+DiskANNIndexNode<DataType>::SearchTiers(std::shared_ptr<const Tiers> tiers, const DataSetPtr dataset,
+                                        std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                                        DistType* distances) const {
+    const auto& search_conf = static_cast<const DiskANNConfig&>(*cfg);
+    if (search_conf.trace_visit.value()) {
+        return folly::makeSemiFuture(
+            expected<DataSetPtr>::Err(Status::not_implemented, "the searches of updated indexes are not traced"));
+    }
+    const auto nq = dataset->GetRows();
+    const auto k = search_conf.k.value();
+    const bool larger_is_closer = !IsMetricType(metric_type_, metric::L2);
+
+    // the deltas are in memory, they are searched in the calling thread
+    Json delta_json;
+    delta_json[meta::METRIC_TYPE] = metric_type_;
+    delta_json[meta::TOPK] = k;
+    delta_json[indexparam::EF] = std::max<int64_t>(k, search_conf.search_list_size.value());
+    std::vector<DataSetPtr> delta_results;
+    for (const auto& delta : tiers->deltas) {
+        // the rows added after the bitset is built are filtered out
+        std::vector<uint8_t> bits;
+        const auto rows = delta->index.Count();
+        const auto num_filtered = TierBitset(
+            bitset, rows, [base = delta->base](int64_t row) { return base + row; }, bits);
+        auto res = delta->index.Search(dataset, delta_json, BitsetView(bits.data(), rows, num_filtered));
+        if (!res.has_value()) {
+            return folly::makeSemiFuture(std::move(res));
+        }
+        delta_results.push_back(res.value());
+    }
 
-    // set visit_info json string into result dataset
-    if (feder_result != nullptr) {
-        Json json_visit_info, json_id_set;
-        nlohmann::to_json(json_visit_info, feder_result->visit_info_);
-        nlohmann::to_json(json_id_set, feder_result->id_set_);
-        res->SetJsonInfo(json_visit_info.dump());
-        res->SetJsonIdSet(json_id_set.dump());
+    // the rows on disk take the bitset of the search as is while their ids are their positions and none is deleted
+    auto disk_bits = std::make_shared<std::vector<uint8_t>>();
+    BitsetView disk_bitset = bitset;
+    if (tiers->disk_ids != nullptr || !deleted_.empty()) {
+        const auto rows = static_cast<int64_t>(tiers->disk->get_num_points());
+        const auto num_filtered = TierBitset(
+            bitset, rows, [&tiers](int64_t row) { return tiers->DiskId(row); }, *disk_bits);
+        disk_bitset = BitsetView(disk_bits->data(), rows, num_filtered);
     }
-    return res;
+    return SearchDiskAsync(tiers->disk, dataset, std::move(cfg), disk_bitset, nullptr, nullptr)
+        .deferValue([tiers, disk_bits, delta_results = std::move(delta_results), nq, k, larger_is_closer, ids,
+                     distances](expected<DataSetPtr>&& disk_res) -> expected<DataSetPtr> {
+            if (!disk_res.has_value()) {
+                return disk_res;
+            }
+            // the results of the tiers, merged per query
+            std::vector<std::pair<DistType, int64_t>> candidates;
+            auto collect = [&](const DataSet& res, int64_t row, auto&& id_of) {
+                const auto* res_ids = res.GetIds() + row * k;
+                const auto* res_distances = res.GetDistance() + row * k;
+                for (int64_t i = 0; i < k; ++i) {
+                    if (res_ids[i] >= 0) {
+                        candidates.emplace_back(res_distances[i], id_of(res_ids[i]));
+                    }
+                }
+            };
+
+            ResultBuffer<int64_t> owned_ids;
+            ResultBuffer<DistType> owned_distances;
+            auto* p_id = ids;
+            auto* p_dist = distances;
+            if (p_id == nullptr) {
+                owned_ids = AllocateResultBuffer<int64_t>(nq * k);
+                owned_distances = AllocateResultBuffer<DistType>(nq * k);
+                p_id = owned_ids.get();
+                p_dist = owned_distances.get();
+            }
+            for (int64_t row = 0; row < nq; ++row) {
+                candidates.clear();
+                collect(*disk_res.value(), row, [&tiers](int64_t id) { return tiers->DiskId(id); });
+                for (size_t i = 0; i < delta_results.size(); ++i) {
+                    collect(*delta_results[i], row, [base = tiers->deltas[i]->base](int64_t id) { return base + id; });
+                }
+                const auto num = std::min<int64_t>(k, candidates.size());
+                std::partial_sort(candidates.begin(), candidates.begin() + num, candidates.end(),
+                                  [larger_is_closer](const auto& a, const auto& b) {
+                                      return larger_is_closer ? a.first > b.first : a.first < b.first;
+                                  });
+                for (int64_t i = 0; i < k; ++i) {
+                    p_id[row * k + i] = i < num ? candidates[i].second : -1;
+                    p_dist[row * k + i] = i < num ? candidates[i].first
+                                                  : (larger_is_closer ? std::numeric_limits<DistType>::lowest()
+                                                                      : std::numeric_limits<DistType>::max());
+                }
+            }
+
+            auto res = GenResultDataSet(nq, k, p_id, p_dist);
+            // the result owns the buffers only if they were not given
+            res->SetIsOwner(owned_ids != nullptr);
+            if (owned_ids != nullptr) {
+                res->SetIds(std::move(owned_ids));
+                res->SetDistance(std::move(owned_distances));
+            }
+            // the stats are the ones of the index on disk
+            if (const auto* stats = disk_res.value()->GetSearchStats(); stats != nullptr) {
+                res->SetSearchStats(SearchStats(*stats));
+            }
+            return res;
+        });
 }
 
 /*
@@ -667,33 +1271,76 @@ DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, std::unique_ptr<Con
 template <typename DataType>
 expected<DataSetPtr>
 DiskANNIndexNode<DataType>::GetVectorByIds(const DataSetPtr dataset) const {
-    if (!is_prepared_.load() || !pq_flash_index_) {
+    if (!is_prepared_.load()) {
         LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
         return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
     }
+    auto tiers = std::atomic_load(&tiers_);
     auto dim = Dim();
     auto rows = dataset->GetRows();
     auto ids = dataset->GetIds();
-    auto* data = new DataType[dim * rows];
-    if (data == nullptr) {
-        LOG_KNOWHERE_ERROR_ << "Failed to allocate memory for data.";
-        return expected<DataSetPtr>::Err(Status::malloc_error, "failed to allocate memory for data");
+
+    // the rows of the ids on disk, and the rows of the ids of each delta, with their positions in ids
+    std::vector<int64_t> disk_rows, disk_positions;
+    std::vector<std::vector<int64_t>> delta_rows(tiers->deltas.size()), delta_positions(tiers->deltas.size());
+    for (int64_t i = 0; i < rows; ++i) {
+        const auto id = ids[i];
+        if (id < 0 || id >= tiers->Count()) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "id " + std::to_string(id) + " is out of range");
+        }
+        if (id >= tiers->end) {
+            const auto d = std::upper_bound(tiers->deltas.begin(), tiers->deltas.end(), id,
+                                            [](int64_t value, const auto& delta) { return value < delta->base; }) -
+                           tiers->deltas.begin() - 1;
+            delta_rows[d].push_back(id - tiers->deltas[d]->base);
+            delta_positions[d].push_back(i);
+            continue;
+        }
+        auto row = id;
+        if (tiers->disk_ids != nullptr) {
+            auto it = std::lower_bound(tiers->disk_ids->begin(), tiers->disk_ids->end(), id);
+            if (it == tiers->disk_ids->end() || *it != id) {
+                return expected<DataSetPtr>::Err(Status::invalid_args, "id " + std::to_string(id) + " was deleted");
+            }
+            row = it - tiers->disk_ids->begin();
+        }
+        disk_rows.push_back(row);
+        disk_positions.push_back(i);
     }
 
-    if (TryDiskANNCall([&]() { pq_flash_index_->get_vector_by_ids(ids, rows, data); }) != Status::success) {
-        delete[] data;
+    auto data = std::make_unique<DataType[]>(dim * rows);
+    auto disk_data = std::make_unique<DataType[]>(dim * disk_rows.size());
+    auto get_disk_rows = [&]() { tiers->disk->get_vector_by_ids(disk_rows.data(), disk_rows.size(), disk_data.get()); };
+    if (TryDiskANNCall(get_disk_rows) != Status::success) {
         return expected<DataSetPtr>::Err(Status::diskann_inner_error, "failed to get vector");
     };
+    for (size_t i = 0; i < disk_rows.size(); ++i) {
+        std::copy_n(disk_data.get() + i * dim, dim, data.get() + disk_positions[i] * dim);
+    }
+    for (size_t d = 0; d < delta_rows.size(); ++d) {
+        if (delta_rows[d].empty()) {
+            continue;
+        }
+        auto res = tiers->deltas[d]->index.GetVectorByIds(GenIdsDataSet(delta_rows[d].size(), delta_rows[d].data()));
+        if (!res.has_value()) {
+            return res;
+        }
+        const auto* delta_data = static_cast<const DataType*>(res.value()->GetTensor());
+        for (size_t i = 0; i < delta_rows[d].size(); ++i) {
+            std::copy_n(delta_data + i * dim, dim, data.get() + delta_positions[d][i] * dim);
+        }
+    }
 
-    return GenResultDataSet(rows, dim, data);
+    return GenResultDataSet(rows, dim, data.release());
 }
 
 template <typename DataType>
 expected<DataSetPtr>
 DiskANNIndexNode<DataType>::GetIndexMeta(std::unique_ptr<Config> cfg) const {
+    auto tiers = std::atomic_load(&tiers_);
     std::vector<int64_t> entry_points;
-    for (size_t i = 0; i < pq_flash_index_->get_num_medoids(); i++) {
-        entry_points.push_back(pq_flash_index_->get_medoids()[i]);
+    for (size_t i = 0; i < tiers->disk->get_num_medoids(); i++) {
+        entry_points.push_back(tiers->DiskId(tiers->disk->get_medoids()[i]));
     }
     auto diskann_conf = static_cast<const DiskANNConfig&>(*cfg);
     feder::diskann::DiskANNMeta meta(diskann_conf.data_path.value(), diskann_conf.max_degree.value(),
@@ -708,6 +1355,251 @@ DiskANNIndexNode<DataType>::GetIndexMeta(std::unique_ptr<Config> cfg) const {
     return GenResultDataSet(json_meta.dump(), json_id_set.dump());
 }
 
+template <typename DataType>
+void
+DiskANNIndexNode<DataType>::MaybeMerge(std::shared_ptr<Config> cfg) {
+    const auto& conf = static_cast<const DiskANNConfig&>(*cfg);
+    if (merging_ || stopping_ || conf.merge_threshold.value() <= 0) {
+        return;
+    }
+    // the merged index is built from the vectors on disk
+    auto tiers = std::atomic_load(&tiers_);
+    if (!HasRawData(metric_type_) || !tiers->disk->has_full_precision_vectors()) {
+        return;
+    }
+    const auto updated = tiers->Count() - tiers->end + num_deleted_;
+    if (updated <= conf.merge_threshold.value() * tiers->disk->get_num_points()) {
+        return;
+    }
+    merging_ = true;
+    merge_cfg_ = std::move(cfg);
+    MergeThreadPool()->push([this] { MergeUpdates(); });
+}
+
+template <typename DataType>
+void
+DiskANNIndexNode<DataType>::MergeUpdates() {
+    std::shared_ptr<const Tiers> tiers;
+    std::vector<uint8_t> deleted;
+    std::shared_ptr<Config> cfg;
+    std::string prefix;
+    int64_t end = 0;
+    {
+        std::lock_guard lock(update_mutex_);
+        tiers = std::atomic_load(&tiers_);
+        merging_deltas_ = tiers->deltas.size();
+        end = tiers->Count();
+        deleted = deleted_;
+        cfg = std::move(merge_cfg_);
+        prefix = index_prefix_ + "_merged_" + std::to_string(++num_merges_);
+    }
+    LOG_KNOWHERE_INFO_ << "Merging the updates of DiskANN into " << prefix << ".";
+
+    std::vector<int64_t> ids;
+    std::shared_ptr<diskann::PQFlashIndex<DataType>> disk = nullptr;
+    if (!stopping_ &&
+        BuildMerged(*tiers, deleted, static_cast<const DiskANNConfig&>(*cfg), prefix, ids) == Status::success &&
+        !ids.empty() && !stopping_) {
+        disk = LoadMerged(prefix);
+    }
+
+    std::lock_guard lock(update_mutex_);
+    if (stopping_) {
+        LOG_KNOWHERE_INFO_ << "The merge of the updates of DiskANN was given up, the index is destroyed.";
+        RemoveIndexFiles(prefix);
+    } else if (disk != nullptr) {
+        auto current = std::atomic_load(&tiers_);
+        auto merged = std::make_shared<Tiers>();
+        merged->disk = std::move(disk);
+        merged->disk_ids = std::make_shared<const std::vector<int64_t>>(std::move(ids));
+        merged->deltas.assign(current->deltas.begin() + merging_deltas_, current->deltas.end());
+        merged->end = end;
+        // the rows deleted during the merge are still held
+        num_deleted_ = 0;
+        for (auto id : *merged->disk_ids) {
+            num_deleted_ += IsDeleted(id);
+        }
+        for (auto id = end; id < merged->Count(); ++id) {
+            num_deleted_ += IsDeleted(id);
+        }
+        std::atomic_store(&tiers_, std::shared_ptr<const Tiers>(std::move(merged)));
+        // the searches still on the previous index keep its files open
+        if (!merged_prefix_.empty()) {
+            RemoveIndexFiles(merged_prefix_);
+        }
+        merged_prefix_ = prefix;
+        LOG_KNOWHERE_INFO_ << "Merged the updates of DiskANN into " << prefix << ".";
+    } else {
+        LOG_KNOWHERE_WARNING_ << "The updates of DiskANN were not merged, they stay in memory.";
+        RemoveIndexFiles(prefix);
+    }
+    merging_deltas_ = 0;
+    merging_ = false;
+    merge_done_.notify_all();
+}
+
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::BuildMerged(const Tiers& tiers, const std::vector<uint8_t>& deleted,
+                                        const DiskANNConfig& conf, const std::string& prefix,
+                                        std::vector<int64_t>& ids) {
+    auto is_deleted = [&deleted](int64_t id) {
+        return id < static_cast<int64_t>(deleted.size()) * 8 && (deleted[id >> 3] >> (id & 7)) & 1;
+    };
+    const auto dim = Dim();
+    const auto data_path = prefix + "_data.bin";
+    std::ofstream writer(data_path, std::ios::binary);
+    if (!writer) {
+        LOG_KNOWHERE_ERROR_ << "Failed to open " << data_path << ".";
+        return Status::disk_file_error;
+    }
+    auto given_up = [&]() {
+        if (!stopping_) {
+            return false;
+        }
+        writer.close();
+        std::remove(data_path.c_str());
+        return true;
+    };
+    // the number of rows of the header is written once the live rows are counted
+    int32_t header[2] = {0, static_cast<int32_t>(dim)};
+    writer.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    constexpr int64_t kChunkRows = 4096;
+    std::vector<DataType> chunk(kChunkRows * dim);
+    std::vector<int64_t> rows;
+    const auto disk_rows = static_cast<int64_t>(tiers.disk->get_num_points());
+    for (int64_t begin = 0; begin < disk_rows; begin += kChunkRows) {
+        if (given_up()) {
+            return Status::diskann_inner_error;
+        }
+        rows.clear();
+        for (auto row = begin; row < std::min(begin + kChunkRows, disk_rows); ++row) {
+            if (!is_deleted(tiers.DiskId(row))) {
+                rows.push_back(row);
+            }
+        }
+        if (rows.empty()) {
+            continue;
+        }
+        RETURN_IF_ERROR(
+            TryDiskANNCall([&]() { tiers.disk->get_vector_by_ids(rows.data(), rows.size(), chunk.data()); }));
+        writer.write(reinterpret_cast<const char*>(chunk.data()), rows.size() * dim * sizeof(DataType));
+        for (auto row : rows) {
+            ids.push_back(tiers.DiskId(row));
+        }
+    }
+    for (const auto& delta : tiers.deltas) {
+        const auto delta_rows = delta->index.Count();
+        for (int64_t begin = 0; begin < delta_rows; begin += kChunkRows) {
+            if (given_up()) {
+                return Status::diskann_inner_error;
+            }
+            rows.clear();
+            for (auto row = begin; row < std::min(begin + kChunkRows, delta_rows); ++row) {
+                if (!is_deleted(delta->base + row)) {
+                    rows.push_back(row);
+                }
+            }
+            if (rows.empty()) {
+                continue;
+            }
+            auto res = delta->index.GetVectorByIds(GenIdsDataSet(rows.size(), rows.data()));
+            if (!res.has_value()) {
+                LOG_KNOWHERE_ERROR_ << "Failed to get the rows of a delta: " << res.what();
+                return res.error();
+            }
+            writer.write(static_cast<const char*>(res.value()->GetTensor()), rows.size() * dim * sizeof(DataType));
+            for (auto row : rows) {
+                ids.push_back(delta->base + row);
+            }
+        }
+    }
+    header[0] = static_cast<int32_t>(ids.size());
+    writer.seekp(0);
+    writer.write(reinterpret_cast<const char*>(header), sizeof(header));
+    writer.close();
+    if (!writer) {
+        LOG_KNOWHERE_ERROR_ << "Failed to write " << data_path << ".";
+        std::remove(data_path.c_str());
+        return Status::disk_file_error;
+    }
+    if (ids.empty()) {
+        std::remove(data_path.c_str());
+        return Status::success;
+    }
+
+    // the budgets follow the ones of the index on disk unless the config gives them
+    constexpr double kGB = 1024.0 * 1024 * 1024;
+    const auto max_degree = tiers.disk->get_max_degree();
+    auto pq_code_budget_gb = static_cast<double>(conf.pq_code_budget_gb.value());
+    if (pq_code_budget_gb <= 0) {
+        pq_code_budget_gb = static_cast<double>(tiers.disk->cal_memory().pq_codes) / disk_rows * ids.size() / kGB;
+    }
+    auto build_dram_budget_gb = static_cast<double>(conf.build_dram_budget_gb.value());
+    if (build_dram_budget_gb <= 0) {
+        build_dram_budget_gb = 2.0 * ids.size() * (dim * sizeof(float) + max_degree * sizeof(unsigned)) / kGB;
+    }
+    diskann::BuildConfig build_config{data_path,
+                                      prefix,
+                                      GetDiskANNMetric(metric_type_),
+                                      static_cast<unsigned>(max_degree),
+                                      static_cast<unsigned>(conf.search_list_size.value()),
+                                      pq_code_budget_gb,
+                                      build_dram_budget_gb,
+                                      0,
+                                      false,
+                                      conf.accelerate_build.value(),
+                                      0,
+                                      conf.shuffle_build.value()};
+    build_config.shard_parallelism = static_cast<unsigned>(conf.build_shard_parallelism.value());
+    build_config.optimize_layout = conf.optimize_disk_layout.value();
+    build_config.cancelled = &stopping_;
+    auto status = TryDiskANNCall([&]() {
+        int res = diskann::build_disk_index<DataType>(build_config);
+        if (res != 0)
+            throw diskann::ANNException("diskann::build_disk_index returned non-zero value: " + std::to_string(res),
+                                        -1);
+    });
+    std::remove(data_path.c_str());
+    return status;
+}
+
+template <typename DataType>
+std::shared_ptr<diskann::PQFlashIndex<DataType>>
+DiskANNIndexNode<DataType>::LoadMerged(const std::string& prefix) {
+    const auto& conf = static_cast<const DiskANNConfig&>(*load_cfg_);
+    auto disk =
+        std::make_shared<diskann::PQFlashIndex<DataType>>(CreateFileReader(conf), GetDiskANNMetric(metric_type_));
+    if (TryDiskANNCall([&]() {
+            int res = disk->load(search_pool_->size(), prefix.c_str());
+            if (res != 0) {
+                throw diskann::ANNException("load returned non-zero value: " + std::to_string(res), -1);
+            }
+        }) != Status::success) {
+        LOG_KNOWHERE_ERROR_ << "Failed to load the merged DiskANN.";
+        return nullptr;
+    }
+    // the cache of a merged index is the bfs levels around its medoids
+    auto num_nodes_to_cache = std::min<uint64_t>(
+        GetCachedNodeNum(conf.search_cache_budget_gb.value(), disk->get_data_dim(), disk->get_max_degree()),
+        disk->get_num_points() / 3);
+    if (num_nodes_to_cache > 0) {
+        std::vector<uint32_t> node_list;
+        if (TryDiskANNCall([&]() {
+                disk->cache_bfs_levels(num_nodes_to_cache, node_list);
+                disk->load_cache_list(node_list);
+            }) != Status::success) {
+            LOG_KNOWHERE_ERROR_ << "Failed to load the cache of the merged DiskANN.";
+            return nullptr;
+        }
+    }
+    if (SetUpMemoryTiers(conf, *disk) != Status::success) {
+        return nullptr;
+    }
+    return disk;
+}
+
 template <typename DataType>
 uint64_t
 DiskANNIndexNode<DataType>::GetCachedNodeNum(const float cache_dram_budget, const uint64_t data_dim,
@@ -6,8 +6,10 @@
 #include "diskann/aisaq.h"
 #include "diskann/aux_utils.h"
 #include "diskann/linux_aligned_file_reader.h"
+#include "diskann/linux_uring_aligned_file_reader.h"
 #include "diskann/pq_flash_aisaq_index.h"
 #include "diskann/pq_flash_index.h"
+#include "diskann/tiered_aligned_file_reader.h"
 #include "filemanager/FileManager.h"
 #include "fmt/core.h"
 #include "index/diskann/aisaq_config.h"
@@ -39,6 +41,13 @@ class AisaqIndexNode : public IndexNode {
         file_manager_ = diskann_index_pack->GetPack();
     }
 
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        // the data is read from data_path, the build stays within its dram budget
+        const auto& build_conf = static_cast<const AisaqConfig&>(cfg);
+        return static_cast<int64_t>(build_conf.build_dram_budget_gb.value_or(0) * (1LL << 30));
+    }
+
     Status
     Build(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
 
@@ -55,6 +64,9 @@ class AisaqIndexNode : public IndexNode {
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
 
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchAsync(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
+
     expected<DataSetPtr>
     GetVectorByIds(const DataSetPtr dataset) const override;
 
@@ -372,6 +384,7 @@ AisaqIndexNode<DataType>::Build(const DataSetPtr dataset, std::shared_ptr<Config
                                                      (uint32_t)build_conf.inline_pq.value(),
                                                      build_conf.rearrange.value(),
                                                      build_conf.num_entry_points.value()};
+    aisaq_internal_build_config.shard_parallelism = static_cast<unsigned>(build_conf.build_shard_parallelism.value());
     RETURN_IF_ERROR(TryDiskANNCall([&]() {
         int res = diskann::build_disk_index<DataType>(aisaq_internal_build_config);
         if (res != 0)
@@ -438,7 +451,17 @@ AisaqIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr<C
         }
     }();
 
-    // Load file from file manager.
+    std::shared_ptr<RangeReader> range_reader = nullptr;
+    if (prep_conf.tiered_load.value()) {
+        range_reader = RangeReader::GetGlobalRangeReader();
+        if (range_reader == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "tiered_load needs a disk range reader, see KnowhereConfig::SetDiskRangeReader.";
+            return Status::invalid_args;
+        }
+    }
+    auto disk_index_filename = diskann::get_disk_index_filename(index_prefix_);
+
+    // Load file from file manager, the index file is read through the range reader for a tiered load.
     bool use_bfs_cache = prep_conf.use_bfs_cache.value();
     for (auto& filename :
          GetNecessaryFilenames(index_prefix_, need_norm, prep_conf.search_cache_budget_gb.value() > 0 && !use_bfs_cache,
@@ -447,6 +470,9 @@ AisaqIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr<C
             LOG_KNOWHERE_DEBUG_ << "File load " << filename << " skipped";
             continue;
         }
+        if (range_reader != nullptr && filename == disk_index_filename) {
+            continue;
+        }
         if (!LoadFile(filename)) {
             return Status::disk_file_error;
         }
@@ -468,7 +494,22 @@ AisaqIndexNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr<C
     // load diskann pq code and meta info
     std::shared_ptr<AlignedFileReader> reader = nullptr;
 
-    reader.reset(new LinuxAlignedFileReader());
+    if (prep_conf.io_engine.value() == "uring") {
+#ifdef KNOWHERE_WITH_IO_URING
+        reader.reset(new LinuxUringAlignedFileReader(prep_conf.io_uring_sqpoll.value(), prep_conf.io_priority.value()));
+#endif
+    } else {
+        reader.reset(new LinuxAlignedFileReader(prep_conf.io_priority.value()));
+    }
+    if (range_reader != nullptr) {
+        auto tiered_reader = std::make_shared<TieredAlignedFileReader>(reader, range_reader);
+        // the index reads the metadata of the file before it opens it
+        if (TryDiskANNCall([&]() { tiered_reader->prepare(disk_index_filename); }) != Status::success) {
+            LOG_KNOWHERE_ERROR_ << "Failed to prepare the tiered load of " << disk_index_filename << ".";
+            return Status::disk_file_error;
+        }
+        reader = tiered_reader;
+    }
 
     pq_flash_index_ = std::make_unique<diskann::PQFlashAisaqIndex<DataType>>(reader, diskann_metric);
 
@@ -601,14 +642,21 @@ template <typename DataType>
 expected<DataSetPtr>
 AisaqIndexNode<DataType>::Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
                                  const BitsetView& bitset) const {
+    return SearchAsync(dataset, std::move(cfg), bitset).get();
+}
+
+template <typename DataType>
+folly::SemiFuture<expected<DataSetPtr>>
+AisaqIndexNode<DataType>::SearchAsync(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                                      const BitsetView& bitset) const {
     if (!is_prepared_.load() || !pq_flash_index_) {
         LOG_KNOWHERE_ERROR_ << "Failed to load AiSAQ.";
-        return expected<DataSetPtr>::Err(Status::empty_index, "AiSAQ not loaded");
+        return folly::makeSemiFuture(expected<DataSetPtr>::Err(Status::empty_index, "AiSAQ not loaded"));
     }
 
     auto search_conf = static_cast<const AisaqConfig&>(*cfg);
     if (!CheckMetric(search_conf.metric_type.value())) {
-        return expected<DataSetPtr>::Err(Status::invalid_metric_type, "unsupported metric type");
+        return folly::makeSemiFuture(expected<DataSetPtr>::Err(Status::invalid_metric_type, "unsupported metric type"));
     }
 
     auto k = static_cast<uint64_t>(search_conf.k.value());
@@ -623,7 +671,8 @@ AisaqIndexNode<DataType>::Search(const DataSetPtr dataset, std::unique_ptr<Confi
     } else {
         if (search_conf.beamwidth.value() > (int)diskann::defaults::MAX_AISAQ_BEAMWIDTH) {
             LOG_KNOWHERE_ERROR_ << "Error. Beam width more than max value";
-            return expected<DataSetPtr>::Err(Status::aisaq_error, "beam width more than maximal");
+            return folly::makeSemiFuture(
+                expected<DataSetPtr>::Err(Status::aisaq_error, "beam width more than maximal"));
         }
     }
 
@@ -632,12 +681,14 @@ AisaqIndexNode<DataType>::Search(const DataSetPtr dataset, std::unique_ptr<Confi
     } else {
         if (search_conf.vectors_beamwidth.value() > (int)diskann::defaults::MAX_AISAQ_VECTORS_BEAMWIDTH) {
             LOG_KNOWHERE_ERROR_ << "Error. Vector beam width more than max value";
-            return expected<DataSetPtr>::Err(Status::aisaq_error, "vector beam width more than maximal");
+            return folly::makeSemiFuture(
+                expected<DataSetPtr>::Err(Status::aisaq_error, "vector beam width more than maximal"));
         }
     }
     if (search_conf.vectors_beamwidth.value() > search_conf.beamwidth.value()) {
         LOG_KNOWHERE_ERROR_ << "Error. Vector beam width more than beam width";
-        return expected<DataSetPtr>::Err(Status::aisaq_error, "vector beam width more than beam width");
+        return folly::makeSemiFuture(
+            expected<DataSetPtr>::Err(Status::aisaq_error, "vector beam width more than beam width"));
     }
     aisaq_search_config.vector_beamwidth = search_conf.vectors_beamwidth.value();
     if (!search_conf.pq_read_page_cache_size.has_value()) {
@@ -645,6 +696,7 @@ AisaqIndexNode<DataType>::Search(const DataSetPtr dataset, std::unique_ptr<Confi
     } else {
         aisaq_search_config.pq_read_page_cache_size = search_conf.pq_read_page_cache_size.value();
     }
+    aisaq_search_config.speculative_reads = search_conf.speculative_reads.value();
 
     auto nq = (uint64_t)dataset->GetRows();
     auto dim = dataset->GetDim();
@@ -654,50 +706,90 @@ AisaqIndexNode<DataType>::Search(const DataSetPtr dataset, std::unique_ptr<Confi
                         << " index beam width: " << beamwidth
                         << " vectors beam width: " << aisaq_search_config.vector_beamwidth
                         << " pq-read-page-cache-size: " << aisaq_search_config.pq_read_page_cache_size << " bytes"
+                        << " speculative reads: " << aisaq_search_config.speculative_reads
                         << " search list size: " << search_conf.search_list_size.value();
 
-    feder::diskann::FederResultUniq feder_result;
+    // shared by the queries, which outlive this call
+    struct SearchState {
+        DataSetPtr dataset;
+        ResultBuffer<int64_t> p_id;
+        ResultBuffer<DistType> p_dist;
+        feder::diskann::FederResultUniq feder_result;
+        diskann::aisaq_search_config aisaq_search_config;
+        // the stats of the queries, filled by their tasks if search_stats is set
+        SearchStats search_stats;
+    };
+    auto state = std::make_shared<SearchState>();
+    state->dataset = dataset;
+    state->aisaq_search_config = aisaq_search_config;
+    if (search_conf.search_stats.value()) {
+        state->search_stats.resize(nq);
+    }
     if (search_conf.trace_visit.value()) {
         if (nq != 1) {
-            return expected<DataSetPtr>::Err(Status::invalid_args, "nq must be 1");
+            return folly::makeSemiFuture(expected<DataSetPtr>::Err(Status::invalid_args, "nq must be 1"));
         }
-        feder_result = std::make_unique<feder::diskann::FederResult>();
-        feder_result->visit_info_.SetQueryConfig(search_conf.k.value(), search_conf.search_list_size.value(),
-                                                 search_conf.beamwidth.value(), aisaq_search_config.vector_beamwidth);
+        state->feder_result = std::make_unique<feder::diskann::FederResult>();
+        state->feder_result->visit_info_.SetQueryConfig(search_conf.k.value(), search_conf.search_list_size.value(),
+                                                        search_conf.beamwidth.value(),
+                                                        aisaq_search_config.vector_beamwidth);
     }
 
-    auto p_id = std::make_unique<int64_t[]>(k * nq);
-    auto p_dist = std::make_unique<DistType[]>(k * nq);
+    state->p_id = AllocateResultBuffer<int64_t>(k * nq);
+    state->p_dist = AllocateResultBuffer<DistType>(k * nq);
 
     std::vector<folly::Future<folly::Unit>> futures;
     futures.reserve(nq);
     for (uint64_t row = 0; row < nq; ++row) {
-        futures.emplace_back(search_pool_->push([&, index = row, p_id_ptr = p_id.get(), p_dist_ptr = p_dist.get()]() {
+        futures.emplace_back(search_pool_->push([=]() {
             diskann::QueryStats stats;
-            pq_flash_index_->aisaq_cached_beam_search(xq + (index * dim), k, lsearch, p_id_ptr + (index * k),
-                                                      p_dist_ptr + (index * k), beamwidth, false, &stats, feder_result,
-                                                      bitset, filter_ratio, &aisaq_search_config);
+            pq_flash_index_->aisaq_cached_beam_search(xq + (row * dim), k, lsearch, state->p_id.get() + (row * k),
+                                                      state->p_dist.get() + (row * k), beamwidth, false, &stats,
+                                                      state->feder_result, bitset, filter_ratio,
+                                                      &state->aisaq_search_config);
 #ifdef NOT_COMPILE_FOR_SWIG
             knowhere_diskann_search_hops.Observe(stats.n_hops);
+            if (stats.n_speculative_reads > 0) {
+                knowhere_diskann_speculative_hit_ratio.Observe(static_cast<double>(stats.n_speculative_hits) /
+                                                                stats.n_speculative_reads);
+            }
 #endif
+            if (!state->search_stats.empty()) {
+                auto& query_stats = state->search_stats[row];
+                query_stats.distance_computations = stats.n_cmps;
+                query_stats.graph_hops = stats.n_hops;
+                query_stats.io_count = stats.n_ios;
+                query_stats.cache_hits = stats.n_cache_hits;
+            }
         }));
     }
 
-    if (TryDiskANNCall([&]() { WaitAllSuccess(futures); }) != Status::success) {
-        return expected<DataSetPtr>::Err(Status::aisaq_error, "some search failed");
-    }
+    return folly::collectAll(futures.begin(), futures.end())
+        .deferValue([state, nq, k](std::vector<folly::Try<folly::Unit>>&& results) -> expected<DataSetPtr> {
+            auto status = TryDiskANNCall([&]() {
+                for (const auto& result : results) {
+                    result.throwUnlessValue();
+                }
+            });
+            if (status != Status::success) {
+                return expected<DataSetPtr>::Err(Status::aisaq_error, "some search failed");
+            }
 
-    auto res = GenResultDataSet(nq, k, std::move(p_id), std::move(p_dist));
+            auto res = GenResultDataSet(nq, k, std::move(state->p_id), std::move(state->p_dist));
 
-    // set visit_info json string into result dataset
-    if (feder_result != nullptr) {
-        Json json_visit_info, json_id_set;
-        nlohmann::to_json(json_visit_info, feder_result->visit_info_);
-        nlohmann::to_json(json_id_set, feder_result->id_set_);
-        res->SetJsonInfo(json_visit_info.dump());
-        res->SetJsonIdSet(json_id_set.dump());
-    }
-    return res;
+            // set visit_info json string into result dataset
+            if (state->feder_result != nullptr) {
+                Json json_visit_info, json_id_set;
+                nlohmann::to_json(json_visit_info, state->feder_result->visit_info_);
+                nlohmann::to_json(json_id_set, state->feder_result->id_set_);
+                res->SetJsonInfo(json_visit_info.dump());
+                res->SetJsonIdSet(json_id_set.dump());
+            }
+            if (!state->search_stats.empty()) {
+                res->SetSearchStats(std::move(state->search_stats));
+            }
+            return res;
+        });
 }
 
 /*
@@ -47,6 +47,10 @@ class DiskANNConfig : public BaseConfig {
     // in the RAM budget. The sub-graphs are overlayed to build the overall index. This approach can be up to 1.5 times
     // slower than building the index in one shot. Allocate as much memory as your RAM allows.
     CFG_FLOAT build_dram_budget_gb;
+    // The number of sub-graphs built at once by the divide and conquer approach, which then share build_dram_budget_gb:
+    // the data is split into smaller sub-graphs, and their builds overlap the parts that a single build runs serially,
+    // such as reading the sub-graph data and saving it.
+    CFG_INT build_shard_parallelism;
     // Use 0 to store uncompressed data on SSD. This allows the index to asymptote to 100% recall. If your vectors are
     // too large to store in SSD, this parameter provides the option to compress the vectors using PQ for storing on
     // SSD. This will trade off the recall. You would also want this to be greater than the number of bytes used for the
@@ -55,6 +59,14 @@ class DiskANNConfig : public BaseConfig {
     // This is the flag to enable fast build, in which we will not build vamana graph by full 2 round. This can
     // accelerate index build ~30% with an ~1% recall regression.
     CFG_BOOL accelerate_build;
+    // Pack the nodes into the sectors on SSD by the graph instead of by id, so that the sector read for a node also
+    // holds the nodes it is likely visited with, which the search then expands without reading them again.
+    CFG_BOOL optimize_disk_layout;
+    // The share of the rows of the index on disk that the rows added and deleted since it was loaded reach before they
+    // are merged into a new index on disk in the background, built with the build parameters of the config of the
+    // updates. 0 disables the merges: the added rows then stay in memory, as they do for the indexes that do not keep
+    // their vectors on disk (IP, disk_pq_dims > 0).
+    CFG_FLOAT merge_threshold;
 
     // The ratio of the size reserved for the search cache to the size of the raw data (defined with vec_field_size_gb)
     // This parameter will replace pq_code_budget_gb to avoid calculating the actual size on the Milvus side.
@@ -70,11 +82,39 @@ class DiskANNConfig : public BaseConfig {
     // cached the nodes on the search paths; 2. do bfs from the entry point and cache them. The first method is suitable
     // for TopK query heavy circumstances and the second one performed better in range search.
     CFG_BOOL use_bfs_cache;
+    // The size of a second node cache in GB, filled while the index is searched: the nodes read most often by the knn
+    // searches replace the ones read least often, so that it follows the hot regions of the graph that the cache built
+    // at load time misses. 0 disables it.
+    CFG_FLOAT dynamic_cache_budget_gb;
+    // The precision of an in-memory copy of all the vectors, one of {none, sq8, fp16}, used instead of the vectors on
+    // SSD to rerank the PQ candidates of the searches that refine them (the heavily filtered and the large k ones), so
+    // that they read no sector. It is kept only if it fits in rerank_tier_budget_gb.
+    CFG_STRING rerank_tier;
+    // The size limit of the rerank tier in GB.
+    CFG_FLOAT rerank_tier_budget_gb;
+    // The engine that reads the index file during the search, one of {aio, uring}. aio contexts come from a global
+    // pool shared by all the indexes, uring rings are created by each index as needed. uring needs a build with
+    // WITH_IO_URING.
+    CFG_STRING io_engine;
+    // Whether the uring engine has a kernel thread poll its submission queues, which submits the reads without a system
+    // call at the cost of a core spinning while the index is searched.
+    CFG_BOOL io_uring_sqpoll;
+    // The priority of the index for the IO contexts shared by the disk indexes of the process: while indexes wait for a
+    // context, a free one goes to the index of the highest priority first. See KnowhereConfig::SetDiskIOQuota.
+    CFG_INT io_priority;
+    // Whether the index file is read through the RangeReader set by KnowhereConfig::SetDiskRangeReader instead of being
+    // loaded by the file manager: the local file is filled block by block, by the reads of the searches first and by a
+    // background prefetch, so that the index is searched before it is downloaded. The other files are loaded first.
+    CFG_BOOL tiered_load;
     // The beamwidth to be used for search. This is the maximum number of IO requests each query will issue per
     // iteration of search code. Larger beamwidth will result in fewer IO round-trips per query but might result in
     // slightly higher total number of IO requests to SSD per query. For the highest query throughput with a fixed SSD
     // IOps rating, use W=1. For best latency, use W=4,8 or higher complexity search.
     CFG_INT beamwidth;
+    // If > 0, the beam of the knn search adapts between min_beamwidth and beamwidth: it narrows while the search keeps
+    // improving the candidates ahead of it, where the reads of a wide beam are mostly wasted, and widens once the
+    // search converges, to explore the remaining candidates in fewer IO round-trips. 0 keeps the beam at beamwidth.
+    CFG_INT min_beamwidth;
     // DiskANN uses TopK search to simulate range search by double the K in every round. This is the start K.
     CFG_INT min_k;
     // DiskANN uses TopK search to simulate range search by double the K in every round. This is the largest K.
@@ -83,6 +123,14 @@ class DiskANNConfig : public BaseConfig {
     // value should be in range of [0.0, 1.0] which means when greater or equal to x% of the bits are set,
     // use PQ + Refine. Default to -1.0f, negative vlaues will use dynamic threshold calculator given topk.
     CFG_FLOAT filter_threshold;
+    // The threshold of the filter ratio from which the knn search skips the reads of the filtered nodes that are not
+    // essential: once a beam holds an unfiltered node, the filtered nodes farther from the query in PQ distance are not
+    // read, as their neighbors are likely reached through it. The filtered nodes that are cached are still expanded.
+    // The value should be in range of [0.0, 1.0], 1.0 disables it.
+    CFG_FLOAT filtered_read_skip_threshold;
+    // Whether the searches rerank their candidates with the vectors on SSD even if the index has a rerank tier, for
+    // exact distances: the tier then only narrows the candidates read.
+    CFG_BOOL exact_rerank;
     KNOHWERE_DECLARE_CONFIG(DiskANNConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(max_degree)
             .description("the degree of the graph index.")
@@ -112,6 +160,11 @@ class DiskANNConfig : public BaseConfig {
             .set_default(0)
             .set_range(0, std::numeric_limits<CFG_FLOAT::value_type>::max())
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(build_shard_parallelism)
+            .description("the number of sub-graphs built at once when the index does not fit in the memory budget.")
+            .set_default(1)
+            .set_range(1, 64)
+            .for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(disk_pq_dims)
             .description("the dimension of compressed vectors stored on the ssd, use 0 to store uncompressed data.")
             .set_default(0)
@@ -120,6 +173,15 @@ class DiskANNConfig : public BaseConfig {
             .description("a flag to enbale fast build.")
             .set_default(false)
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(optimize_disk_layout)
+            .description("a flag to pack the nodes on ssd by the graph instead of by id.")
+            .set_default(false)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(merge_threshold)
+            .description("the share of the rows on disk updated before the updates are merged, 0 to disable it.")
+            .set_default(0.1f)
+            .set_range(0, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(search_cache_budget_gb_ratio)
             .description("the ratio of the size reserved for the search cache to the size of the raw data.")
             .set_default(0)
@@ -140,6 +202,37 @@ class DiskANNConfig : public BaseConfig {
             .description("should bfs strategy to cache nodes.")
             .set_default(false)
             .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(dynamic_cache_budget_gb)
+            .description("the size of the node cache filled by the searches in GB.")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(rerank_tier)
+            .description("the precision of the in-memory vectors to rerank with, one of {none, sq8, fp16}.")
+            .set_default("none")
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(rerank_tier_budget_gb)
+            .description("the size limit of the rerank tier in GB.")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(io_engine)
+            .description("the engine that reads the index file, one of {aio, uring}.")
+            .set_default("aio")
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(io_uring_sqpoll)
+            .description("whether the uring engine polls its submission queues with a kernel thread.")
+            .set_default(false)
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(io_priority)
+            .description("the priority of the index for the IO contexts shared by the disk indexes.")
+            .set_default(0)
+            .set_range(0, 100)
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(tiered_load)
+            .description("whether the index file is read through the disk range reader while it is downloaded.")
+            .set_default(false)
+            .for_deserialize();
         KNOWHERE_CONFIG_DECLARE_FIELD(beamwidth)
             .description("the maximum number of IO requests each query will issue per iteration of search code.")
             .set_default(8)
@@ -147,6 +240,11 @@ class DiskANNConfig : public BaseConfig {
             .for_search()
             .for_range_search()
             .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(min_beamwidth)
+            .description("the minimum beamwidth of the adaptive beam of the knn search, 0 to disable it.")
+            .set_default(0)
+            .set_range(0, 128)
+            .for_search();
         KNOWHERE_CONFIG_DECLARE_FIELD(min_k)
             .description("the min l_search size used in range search.")
             .set_default(100)
@@ -163,6 +261,15 @@ class DiskANNConfig : public BaseConfig {
             .set_range(-1.0f, 1.0f)
             .for_search()
             .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(filtered_read_skip_threshold)
+            .description("the threshold of filter ratio to skip the reads of the filtered nodes.")
+            .set_default(1.0f)
+            .set_range(0.0f, 1.0f)
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(exact_rerank)
+            .description("whether to rerank with the vectors on ssd even with a rerank tier.")
+            .set_default(false)
+            .for_search();
     }
 
     Status
@@ -186,6 +293,29 @@ class DiskANNConfig : public BaseConfig {
                                       ") should be larger than k(" + std::to_string(k.value()) + ")";
                     return HandleError(err_msg, msg, Status::out_of_range_in_json);
                 }
+                if (min_beamwidth.value() > beamwidth.value()) {
+                    std::string msg = "min_beamwidth(" + std::to_string(min_beamwidth.value()) +
+                                      ") should not be larger than beamwidth(" + std::to_string(beamwidth.value()) +
+                                      ")";
+                    return HandleError(err_msg, msg, Status::out_of_range_in_json);
+                }
+                break;
+            }
+            case PARAM_TYPE::DESERIALIZE: {
+                if (io_engine.value() != "aio" && io_engine.value() != "uring") {
+                    std::string msg = "io_engine(" + io_engine.value() + ") should be one of {aio, uring}";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+#ifndef KNOWHERE_WITH_IO_URING
+                if (io_engine.value() == "uring") {
+                    return HandleError(err_msg, "io_engine uring needs a build with io_uring support",
+                                       Status::invalid_args);
+                }
+#endif
+                if (rerank_tier.value() != "none" && rerank_tier.value() != "sq8" && rerank_tier.value() != "fp16") {
+                    std::string msg = "rerank_tier(" + rerank_tier.value() + ") should be one of {none, sq8, fp16}";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
                 break;
             }
             default:
@@ -0,0 +1,685 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <set>
+
+#include "faiss/impl/mapped_io.h"
+#include "faiss/index_io.h"
+#include "index/emb_list/emb_list_config.h"
+#include "index/emb_list/emb_list_max_sim.h"
+#include "index/hnsw/base_hnsw_config.h"
+#include "index/ivf/ivf_config.h"
+#include "knowhere/comp/task.h"
+#include "knowhere/config.h"
+#include "knowhere/dataset.h"
+#include "knowhere/emb_list_utils.h"
+#include "knowhere/expected.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/index/index_node.h"
+#include "knowhere/index/index_node_data_mock_wrapper.h"
+#include "knowhere/log.h"
+#include "knowhere/object.h"
+#include "knowhere/operands.h"
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+/**
+ * @brief EmbListIndexNode: An embedding-list-based index node over a vector-based base index, the ANN engine of the
+ * first search stage (HNSW, HNSW_PQ, IVF_SQ8, DISKANN).
+ *
+ * This class is intended for scenarios where vectors are organized into embedding lists (emb_lists).
+ * Both the build and search operations are performed at the emb_list level, rather than on individual vectors.
+ * The interface remains consistent with other vector-based IndexNode implementations, using DataSetPtr as input.
+ * However, an additional Lims array is used to indicate the boundaries of each emb_list within both the train and
+ * query dataset.
+ *
+ * For example, if lims = [0, 5, 9, 100], this represents 3 emb_lists:
+ *   - The first emb_list starts at 0 and contains 5 vectors (indices 0-4)
+ *   - The second emb_list starts at 5 and contains 4 vectors (indices 5-8)
+ *   - The third emb_list starts at 9 and contains 91 vectors (indices 9-99)
+ *
+ * The class manages the mapping between vector IDs and emb_list IDs, and handles
+ * serialization/deserialization for both the emb_list structure and the underlying base index.
+ *
+ * In Milvus, all vectors within the same emb_list share the same scalar value, and correspond to the same bit in the
+ * bitset. Therefore, the bitset length equals the number of emb_lists, which may be much smaller than the total number
+ * of vectors.
+ *
+ * The emb_lists are scored in the second stage by the fused MaxSim kernel when the base index keeps the raw data, by
+ * the distances of CalcDistByIDs() when it computes them (the compressed HNSW indexes), and otherwise (IVF_SQ8)
+ * approximately, from the distances of the first stage alone.
+ *
+ * @tparam DataType The data type of the vectors (e.g., fp32, fp16, bf16).
+ * @tparam BaseIndex The traits of the base index: kIndexType, the emb_list index type, kBaseIndexType, the type of the
+ * base index, and Config, the config of the emb_list index, a config of the base index with retrieval_ann_ratio.
+ */
+template <typename DataType, typename BaseIndex>
+class EmbListIndexNode : public IndexNode {
+ public:
+    using EmbListConfig = typename BaseIndex::Config;
+
+    EmbListIndexNode(const int32_t& version, const Object& object) : IndexNode(version) {
+        build_pool_ = ThreadPool::GetGlobalBuildThreadPool();
+        search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
+        base_index_ =
+            std::move(IndexFactory::Instance().Create<DataType>(BaseIndex::kBaseIndexType, version, object).value());
+        data_format_ = datatype_v<DataType>;
+    }
+
+    /**
+     * @brief Build the emb_list index, with the Build() of the base index, for the base indexes that build from files
+     * rather than from the dataset (DISKANN). The dataset carries the emb_list offsets all the same.
+     */
+    Status
+    Build(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        LOG_KNOWHERE_INFO_ << "build";
+        auto status = InitEmbListOffset(dataset, *cfg);
+        if (status != Status::success) {
+            return status;
+        }
+        status = base_index_.Node()->Build(dataset, cfg, use_knowhere_build_pool);
+        if (status != Status::success) {
+            LOG_KNOWHERE_WARNING_ << "base index build failed";
+            return status;
+        }
+        SetBaseIndexIDMap();
+        return Status::success;
+    }
+
+    /**
+     * @brief Train the emb_list index.
+     * @param dataset Training dataset
+     * @param cfg     Configuration parameters
+     * @param use_knowhere_build_pool Whether to use the global build thread pool
+     *
+     * Main steps:
+     * 1. Check that the dataset contains emb_list offset information (group boundaries).
+     * 2. Force the underlying index to use IP as the metric.
+     * 3. Build the EmbListOffset structure (group offsets).
+     * 4. Call the underlying index's Train.
+     */
+    Status
+    Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        LOG_KNOWHERE_INFO_ << "train";
+        auto status = InitEmbListOffset(dataset, *cfg);
+        if (status != Status::success) {
+            return status;
+        }
+        return base_index_.Node()->Train(dataset, cfg, use_knowhere_build_pool);
+    }
+
+    Status
+    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        LOG_KNOWHERE_INFO_ << "add";
+        auto base_index_add_res = base_index_.Node()->Add(dataset, cfg, use_knowhere_build_pool);
+        if (base_index_add_res != Status::success) {
+            LOG_KNOWHERE_WARNING_ << "base index add failed";
+            return base_index_add_res;
+        }
+        // after Add, we need to set the mapping from internal IDs to emb_list IDs.
+        SetBaseIndexIDMap();
+        return Status::success;
+    }
+
+    /**
+     * @brief Establishes the mapping from the internal IDs of the base index to emb_list IDs.
+     *
+     * This mapping is essential for sub indexes to correctly apply bitset filtering using only a 1-hop mapping during
+     * search. In some cases, such as with mv-only *relayout*, a sub-HNSW index may have its own
+     * (base)internal-to-external ID mapping.
+     * However, the emb_list search bitset operates on emb_list IDs, which we refer to as the "most external" IDs.
+     * Therefore, we need to create a mapping from the base_internal_id (used by the sub-HNSW) to the most external
+     * emb_list_id, ensuring that bitset checks and search results are consistent at the emb_list level.
+     *
+     * The base indexes without ID maps of their own (IVF, DiskANN) search with the bitset of the emb_lists mapped from
+     * the vector IDs instead, see SearchBitset().
+     */
+    void
+    SetBaseIndexIDMap() {
+        LOG_KNOWHERE_INFO_ << "set base index id map";
+        std::shared_ptr<std::vector<uint32_t>> base_internal_id_to_external_id_map;
+        try {
+            base_internal_id_to_external_id_map = base_index_.Node()->GetInternalIdToExternalIdMap();
+        } catch (const std::runtime_error& e) {
+            LOG_KNOWHERE_INFO_ << "base index " << BaseIndex::kBaseIndexType
+                               << " has no id map, map the bitset by vector ids";
+            vid_to_el_id_.resize(emb_list_offset_->offset.back());
+            for (size_t el_id = 0; el_id < emb_list_offset_->num_el(); el_id++) {
+                std::fill(vid_to_el_id_.begin() + emb_list_offset_->offset[el_id],
+                          vid_to_el_id_.begin() + emb_list_offset_->offset[el_id + 1], (uint32_t)el_id);
+            }
+            return;
+        }
+        vid_to_el_id_.clear();
+        size_t base_id_map_size = base_internal_id_to_external_id_map->size();
+        assert(base_id_map_size == base_index_.Node()->Count());
+        std::vector<uint32_t> base_internal_id_to_most_internal_id_map(base_id_map_size);
+        for (size_t i = 0; i < base_id_map_size; i++) {
+            base_internal_id_to_most_internal_id_map[i] =
+                emb_list_offset_->get_el_id(base_internal_id_to_external_id_map->at(i));
+        }
+        base_index_.Node()->SetInternalIdToMostExternalIdMap(std::move(base_internal_id_to_most_internal_id_map));
+        LOG_KNOWHERE_INFO_ << "set base index id map success";
+    }
+
+    /**
+     * @brief Search interface supporting two-stage emb_list search.
+     * @param dataset Query dataset
+     * @param cfg     Search configuration
+     * @param bitset  Mask for filtering vectors
+     *
+     * Search process:
+     * 1. Check emb_list offset information and build the query group structure.
+     * 2. Stage 1: Call underlying index to retrieve candidate vector IDs for each query emb_list.
+     * 3. Stage 2: For each emb_list, collect candidate emb_list IDs, and for each emb_list, perform brute-force
+     *    distance calculation to aggregate scores at the emb_list level. With the raw data in the base index, the
+     *    scores are computed by the fused MaxSim kernel over the vectors of the candidates. With neither the raw data
+     *    nor CalcDistByIDs() in the base index, the scores are approximated from the distances of stage 1.
+     * 4. Return top-k emb_list results.
+     *
+     * Stage 2 reranks the query emb_lists in parallel on the search thread pool, each as soon as a worker is free, and
+     * the candidates of every query emb_list in descending order of their upper bounds from stage 1 (see
+     * MaxSimUpperBounds()), until the next bound cannot beat the current top-k: most candidates of long queries are
+     * never scored exactly.
+     *
+     * Note: The emb_list index node does not need to split the stage 1 tasks by nq and dispatch them to the search
+     * thread pool for parallel processing, because the sub-index_node already handles this.
+     */
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        auto dim = dataset->GetDim();
+        const size_t* lims = dataset->GetLims();
+        if (lims == nullptr) {
+            return expected<DataSetPtr>::Err(Status::emb_list_inner_error, "missing emb_list offset, could not search");
+        }
+        auto num_q_vecs = static_cast<size_t>(dataset->GetRows());
+        EmbListOffset query_emb_list_offset(lims, num_q_vecs);
+        auto num_q_el = query_emb_list_offset.num_el();
+        auto& config = static_cast<EmbListConfig&>(*cfg);
+        auto el_k = config.k.value();
+
+        // Allocate result arrays
+        auto ids = std::make_unique<int64_t[]>(num_q_el * el_k);
+        auto dists = std::make_unique<float[]>(num_q_el * el_k);
+
+        // Stage 1: base index search, force IP metric in the base index
+        config.metric_type = metric::IP;
+        int32_t vec_topk = std::max((int32_t)(el_k * config.retrieval_ann_ratio.value()), 1);
+        config.k = vec_topk;
+        const auto base_bitset = SearchBitset(bitset);
+        auto ann_search_res = base_index_.Node()->Search(dataset, std::move(cfg), base_bitset);
+        if (!ann_search_res.has_value()) {
+            return ann_search_res;
+        }
+
+        Stage1Results stage1{ann_search_res.value()->GetIds(), ann_search_res.value()->GetDistance(),
+                             (size_t)vec_topk};
+        Stage2Scorer scorer;
+        // with the raw data at hand, the candidates are scored by the fused MaxSim kernel, not over distance matrices
+        scorer.fused_max_sim = base_index_.Node()->HasRawData(metric::IP);
+        // cleared at the first candidate if the base index does not compute distances by ids
+        scorer.by_distances = !scorer.fused_max_sim;
+
+        // Stage 2: rerank every query emb_list
+        auto rerank = [&](size_t i) {
+            auto start_offset = query_emb_list_offset.offset[i];
+            auto end_offset = query_emb_list_offset.offset[i + 1];
+            auto query_tensor = (const DataType*)dataset->GetTensor() + start_offset * dim;
+            return RerankEmbList(query_tensor, start_offset, end_offset, dim, el_k, stage1, base_bitset, scorer,
+                                 ids.get() + i * el_k, dists.get() + i * el_k);
+        };
+        std::atomic<Status> status = Status::success;
+        if (num_q_el == 1) {
+            // a single query emb_list keeps the pool for its candidates
+            status = rerank(0);
+        } else {
+            const size_t avg_q_el_len = std::max<size_t>(1, num_q_vecs / std::max<size_t>(1, num_q_el));
+            ParallelForOverSearchThreadPool(
+                num_q_el, avg_q_el_len * vec_topk * dim,
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                        auto res = rerank(i);
+                        if (res != Status::success) {
+                            status = res;
+                        }
+                    }
+                },
+                [&](size_t, size_t) { status = Status::timeout; });
+        }
+        if (status != Status::success) {
+            return expected<DataSetPtr>::Err(status, "emb_list max sim scoring failed");
+        }
+
+        return GenResultDataSet((int64_t)num_q_el, (int64_t)el_k, std::move(ids), std::move(dists));
+    }
+
+    // TODO: support AnnIterator
+    expected<std::vector<IteratorPtr>>
+    AnnIterator(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset,
+                bool use_knowhere_search_pool) const override {
+        return expected<std::vector<IteratorPtr>>::Err(Status::not_implemented,
+                                                       "AnnIterator not supported for emb_list based index");
+    }
+
+    expected<DataSetPtr>
+    GetVectorByIds(const DataSetPtr dataset) const override {
+        return expected<DataSetPtr>::Err(Status::not_implemented,
+                                         "GetVectorByIds not supported for emb_list based index");
+    }
+
+    bool
+    HasRawData(const std::string& metric_type) const override {
+        return base_index_.Node()->HasRawData(metric_type);
+    }
+
+    expected<DataSetPtr>
+    GetIndexMeta(std::unique_ptr<Config> cfg) const override {
+        return expected<DataSetPtr>::Err(Status::not_implemented, "GetIndexMeta not implemented");
+    }
+
+    Status
+    Serialize(BinarySet& binset) const override {
+        try {
+            int64_t size = emb_list_offset_->offset.size() * sizeof(size_t);
+            auto data = std::shared_ptr<uint8_t[]>(new uint8_t[size]);
+            std::memcpy(data.get(), emb_list_offset_->offset.data(), size);
+            binset.Append(Type(), data, size);
+            return base_index_.Node()->Serialize(binset);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner: " << e.what();
+            return Status::emb_list_inner_error;
+        }
+    }
+
+    Status
+    Deserialize(const BinarySet& binset, std::shared_ptr<Config> config) override {
+        try {
+            auto binary_ptr = binset.GetByName(Type());
+            std::shared_ptr<uint8_t[]> data = binary_ptr->data;
+            const auto size = binary_ptr->size;
+            std::vector<size_t> offset(size / sizeof(size_t));
+            std::memcpy(offset.data(), data.get(), size);
+            emb_list_offset_ = std::make_unique<EmbListOffset>(std::move(offset));
+            auto base_index_deserialize_res = base_index_.Node()->Deserialize(binset, config);
+            if (base_index_deserialize_res != Status::success) {
+                return base_index_deserialize_res;
+            }
+            SetBaseIndexIDMap();
+            return Status::success;
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner: " << e.what();
+            return Status::emb_list_inner_error;
+        }
+    }
+
+    Status
+    DeserializeFromFile(const std::string& filename, std::shared_ptr<Config> config) override {
+        auto cfg = static_cast<const knowhere::BaseConfig&>(*config);
+
+        int io_flags = 0;
+        if (cfg.enable_mmap.value()) {
+            io_flags |= faiss::IO_FLAG_MMAP_IFC;
+        }
+
+        try {
+            if ((io_flags & faiss::IO_FLAG_MMAP_IFC) == faiss::IO_FLAG_MMAP_IFC) {
+                auto owner = std::make_shared<faiss::MmappedFileMappingOwner>(filename.data());
+                faiss::MappedFileIOReader reader(owner);
+                // Read emb_list offset
+                std::vector<uint32_t> offset;
+                faiss::read_vector(offset, &reader);
+                emb_list_offset_ = std::make_unique<EmbListOffset>(offset);
+            } else {
+                faiss::FileIOReader reader(filename.data());
+                // Read emb_list offset
+                std::vector<uint32_t> offset;
+                faiss::read_vector(offset, &reader);
+                emb_list_offset_ = std::make_unique<EmbListOffset>(offset);
+            }
+            // Read underlying index
+            auto base_index_deserialize_file_res = base_index_.Node()->DeserializeFromFile(filename, config);
+            if (base_index_deserialize_file_res != Status::success) {
+                return base_index_deserialize_file_res;
+            }
+            SetBaseIndexIDMap();
+            return Status::success;
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner: " << e.what();
+            return Status::emb_list_inner_error;
+        }
+    }
+
+    static std::unique_ptr<BaseConfig>
+    StaticCreateConfig() {
+        return std::make_unique<EmbListConfig>();
+    }
+
+    std::unique_ptr<BaseConfig>
+    CreateConfig() const override {
+        return StaticCreateConfig();
+    }
+
+    int64_t
+    Dim() const override {
+        return base_index_.Node()->Dim();
+    }
+
+    int64_t
+    Size() const override {
+        return base_index_.Node()->Size() + emb_list_offset_->offset.size() * sizeof(size_t);
+    }
+
+    /**
+     * @brief Get the number of vectors in the index.
+     * note that this is the number of vectors in the base index, not the number of the emb_list.
+     */
+    int64_t
+    Count() const override {
+        return base_index_.Node()->Count();
+    }
+
+    std::string
+    Type() const override {
+        return BaseIndex::kIndexType;
+    }
+
+ private:
+    struct Stage1Results {
+        const int64_t* ids;
+        const float* dists;
+        size_t vec_topk;
+    };
+
+    // how stage 2 scores the candidates, shared by the query emb_lists of a search
+    struct Stage2Scorer {
+        bool fused_max_sim = false;
+        std::atomic<bool> by_distances{false};
+    };
+
+    /**
+     * @brief Reranks the candidates of the query emb_list of the query vectors [begin, end), the emb_lists of their
+     * stage 1 results, into the el_k results at ids and dists. The candidates are scored in rounds, in descending order
+     * of their upper bounds, the candidates of a round in parallel, until the top-k is full and the bound of the next
+     * candidate does not beat its worst score.
+     */
+    Status
+    RerankEmbList(const DataType* query, size_t begin, size_t end, size_t dim, size_t el_k, const Stage1Results& stage1,
+                  const BitsetView& bitset, Stage2Scorer& scorer, int64_t* ids, float* dists) const {
+        const auto nq = end - begin;
+        // Collect unique emb_list IDs hit in stage 1
+        std::set<size_t> el_ids_set;
+        for (size_t j = begin * stage1.vec_topk; j < end * stage1.vec_topk; j++) {
+            if (stage1.ids[j] < 0) {
+                continue;
+            }
+            el_ids_set.emplace(emb_list_offset_->get_el_id((size_t)stage1.ids[j]));
+        }
+        std::vector<size_t> el_ids(el_ids_set.begin(), el_ids_set.end());
+        if (!el_ids.empty() && el_ids.back() >= emb_list_offset_->num_el()) {
+            LOG_KNOWHERE_ERROR_ << "Invalid el_id: " << el_ids.back();
+            return Status::emb_list_inner_error;
+        }
+        std::vector<float> bounds(el_ids.size());
+        MaxSimUpperBounds(stage1, begin, end, el_ids, bounds);
+
+        // Score every candidate emb_list (sum of max similarities)
+        // TODO: support other aggregation methods.
+        std::priority_queue<DistId, std::vector<DistId>, std::greater<>> minheap;
+        auto push = [&](size_t el_id, float score) {
+            if (minheap.size() < el_k) {
+                minheap.emplace((int64_t)el_id, score);
+            } else if (score > minheap.top().val) {
+                minheap.pop();
+                minheap.emplace((int64_t)el_id, score);
+            }
+        };
+        bool exact = scorer.fused_max_sim || scorer.by_distances;
+        if (exact) {
+            std::vector<size_t> order(el_ids.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return bounds[a] > bounds[b]; });
+            // the candidates of a round spread over the pool, unless the rerank runs on a worker of it already
+            const size_t round_size = IsSearchThreadPoolTask() ? 1 : 4 * std::max<size_t>(1, GetSearchThreadPoolSize());
+            std::vector<size_t> round_el_ids;
+            std::vector<float> round_scores;
+            size_t next = 0;
+            while (next < order.size() && (minheap.size() < el_k || bounds[order[next]] > minheap.top().val)) {
+                round_el_ids.clear();
+                for (; next < order.size() && round_el_ids.size() < round_size; next++) {
+                    round_el_ids.push_back(el_ids[order[next]]);
+                }
+                round_scores.resize(round_el_ids.size());
+                auto score_status = Status::success;
+                if (scorer.fused_max_sim) {
+                    score_status = FusedMaxSimScores(query, nq, dim, round_el_ids, round_scores);
+                } else {
+                    score_status = MaxSimScoresByDistances(query, nq, dim, bitset, round_el_ids, round_scores);
+                }
+                if (score_status == Status::not_implemented) {
+                    scorer.by_distances = false;
+                    exact = false;
+                    break;
+                }
+                if (score_status != Status::success) {
+                    return score_status;
+                }
+                for (size_t j = 0; j < round_el_ids.size(); j++) {
+                    push(round_el_ids[j], round_scores[j]);
+                }
+            }
+        }
+        if (!exact) {
+            minheap = {};
+            for (size_t j = 0; j < el_ids.size(); j++) {
+                push(el_ids[j], bounds[j]);
+            }
+        }
+
+        // Write results in descending order of score
+        auto real_el_k = minheap.size();
+        for (size_t j = 0; j < real_el_k; j++) {
+            auto& a = minheap.top();
+            ids[real_el_k - j - 1] = a.id;
+            dists[real_el_k - j - 1] = a.val;
+            minheap.pop();
+        }
+        // Fill remaining slots with -1 and minimum score if not enough results
+        std::fill(ids + real_el_k, ids + el_k, -1);
+        std::fill(dists + real_el_k, dists + el_k, std::numeric_limits<float>::min());
+        return Status::success;
+    }
+
+    Status
+    InitEmbListOffset(const DataSetPtr& dataset, Config& cfg) {
+        const size_t* lims = dataset->GetLims();
+        if (lims == nullptr) {
+            LOG_KNOWHERE_WARNING_ << "Missing emb_list offset, could not train index";
+            return Status::emb_list_inner_error;
+        }
+        auto& el_config = static_cast<BaseConfig&>(cfg);
+        el_config.metric_type = metric::IP;
+        emb_list_offset_ = std::make_unique<EmbListOffset>(lims, static_cast<size_t>(dataset->GetRows()));
+        return Status::success;
+    }
+
+    /**
+     * @brief The bitset that the base index searches with: the bitset of the emb_lists, mapped from the vector IDs
+     * when the base index has no ID map to map it with.
+     */
+    BitsetView
+    SearchBitset(const BitsetView& bitset) const {
+        BitsetView base_bitset = bitset;
+        if (!vid_to_el_id_.empty() && !bitset.empty()) {
+            base_bitset.set_out_ids(vid_to_el_id_.data(), vid_to_el_id_.size());
+        }
+        return base_bitset;
+    }
+
+    /**
+     * @brief Scores the candidate emb_lists with get_fused_sum_max_sim() over their vectors, reconstructed from the
+     * base index, the candidates spread over the search thread pool.
+     */
+    Status
+    FusedMaxSimScores(const DataType* query, size_t nq, size_t dim, const std::vector<size_t>& el_ids,
+                      std::vector<float>& scores) const {
+        std::atomic<Status> status = Status::success;
+        const size_t avg_el_len = std::max<size_t>(1, Count() / std::max<size_t>(1, emb_list_offset_->num_el()));
+        ParallelForOverSearchThreadPool(
+            el_ids.size(), nq * avg_el_len * dim,
+            [&](size_t begin, size_t end) {
+                for (size_t j = begin; j < end; j++) {
+                    auto vids = emb_list_offset_->get_vids(el_ids[j]);
+                    auto vectors = base_index_.Node()->GetVectorByIds(GenIdsDataSet(vids.size(), vids.data()));
+                    if (!vectors.has_value()) {
+                        LOG_KNOWHERE_WARNING_ << "failed to get the vectors of emb_list " << el_ids[j] << ": "
+                                              << vectors.what();
+                        status = Status::emb_list_inner_error;
+                        return;
+                    }
+                    auto score_or = get_fused_sum_max_sim(query, nq, (const DataType*)vectors.value()->GetTensor(),
+                                                          vids.size(), dim);
+                    if (!score_or.has_value()) {
+                        LOG_KNOWHERE_WARNING_ << "get_fused_sum_max_sim failed, nq: " << nq
+                                              << ", vids.size(): " << vids.size();
+                        status = Status::emb_list_inner_error;
+                        return;
+                    }
+                    scores[j] = score_or.value();
+                }
+            },
+            [&](size_t, size_t) { status = Status::timeout; });
+        return status;
+    }
+
+    /**
+     * @brief Scores the candidate emb_lists with get_sum_max_sim() over the distance matrices of CalcDistByIDs(), for
+     * the base indexes without raw data.
+     */
+    Status
+    MaxSimScoresByDistances(const DataType* query, size_t nq, size_t dim, const BitsetView& bitset,
+                            const std::vector<size_t>& el_ids, std::vector<float>& scores) const {
+        auto bf_query_dataset = GenDataSet(nq, dim, query);
+        for (size_t j = 0; j < el_ids.size(); j++) {
+            auto vids = emb_list_offset_->get_vids(el_ids[j]);
+            // Brute-force compute distances between all vectors in the query emb_list and all vectors in the
+            // candidate emb_list
+            auto bf_search_res = base_index_.Node()->CalcDistByIDs(bf_query_dataset, bitset, vids.data(), vids.size());
+            if (!bf_search_res.has_value() && bf_search_res.error() == Status::not_implemented) {
+                return Status::not_implemented;
+            }
+            if (!bf_search_res.has_value()) {
+                LOG_KNOWHERE_WARNING_ << "bf search error: " << bf_search_res.what();
+                return Status::emb_list_inner_error;
+            }
+            auto score_or = get_sum_max_sim(bf_search_res.value()->GetDistance(), nq, vids.size());
+            if (!score_or.has_value()) {
+                LOG_KNOWHERE_WARNING_ << "get_sum_max_sim failed, nq: " << nq << ", vids.size(): " << vids.size();
+                return Status::emb_list_inner_error;
+            }
+            scores[j] = score_or.value();
+        }
+        return Status::success;
+    }
+
+    /**
+     * @brief The upper bounds of the MaxSim of the candidate emb_lists, from the stage 1 results of the query vectors
+     * [begin, end) alone. Every query vector adds its best distance to the vectors of an emb_list among its results, or
+     * its worst distance in its results if it retrieved none of them, which no vector out of its results beats as long
+     * as stage 1 is exact. The bounds are the scores of the base indexes with neither the raw data nor CalcDistByIDs()
+     * (IVF_SQ8), estimates that get closer to the sums of max similarities as retrieval_ann_ratio grows.
+     */
+    void
+    MaxSimUpperBounds(const Stage1Results& stage1, size_t begin, size_t end, const std::vector<size_t>& el_ids,
+                      std::vector<float>& scores) const {
+        const auto vec_topk = stage1.vec_topk;
+        std::fill(scores.begin(), scores.end(), 0.0f);
+        std::vector<float> max_sims(el_ids.size());
+        for (size_t i = begin; i < end; i++) {
+            const auto q_ids = stage1.ids + i * vec_topk;
+            const auto q_dists = stage1.dists + i * vec_topk;
+            auto worst = std::numeric_limits<float>::max();
+            for (size_t j = 0; j < vec_topk; j++) {
+                if (q_ids[j] >= 0) {
+                    worst = std::min(worst, q_dists[j]);
+                }
+            }
+            if (worst == std::numeric_limits<float>::max()) {
+                continue;
+            }
+            std::fill(max_sims.begin(), max_sims.end(), worst);
+            for (size_t j = 0; j < vec_topk; j++) {
+                if (q_ids[j] < 0) {
+                    continue;
+                }
+                // el_ids are sorted, and hold the emb_lists of all the results
+                auto pos = std::lower_bound(el_ids.begin(), el_ids.end(), emb_list_offset_->get_el_id(q_ids[j])) -
+                           el_ids.begin();
+                max_sims[pos] = std::max(max_sims[pos], q_dists[j]);
+            }
+            for (size_t j = 0; j < el_ids.size(); j++) {
+                scores[j] += max_sims[j];
+            }
+        }
+    }
+
+ protected:
+    Index<IndexNode> base_index_;                     ///< Underlying index node
+    std::unique_ptr<EmbListOffset> emb_list_offset_;  ///< emb_list group offset structure
+    std::vector<uint32_t> vid_to_el_id_;  ///< emb_list IDs of the vectors, for the base indexes without ID maps
+    std::shared_ptr<ThreadPool> build_pool_;
+    std::shared_ptr<ThreadPool> search_pool_;
+    DataFormatEnum data_format_;  ///< Data format (e.g., fp32, fp16, bf16)
+};
+
+// the base indexes of the emb_list indexes
+struct EmbListHNSWBase {
+    static constexpr const char* kIndexType = IndexEnum::INDEX_EMB_LIST_HNSW;
+    static constexpr const char* kBaseIndexType = IndexEnum::INDEX_HNSW;
+    using Config = EmbListHNSWConfig;
+};
+
+struct EmbListHNSWPQBase {
+    static constexpr const char* kIndexType = IndexEnum::INDEX_EMB_LIST_HNSW_PQ;
+    static constexpr const char* kBaseIndexType = IndexEnum::INDEX_HNSW_PQ;
+    using Config = EmbListHNSWPQConfig;
+};
+
+struct EmbListIvfSq8Base {
+    static constexpr const char* kIndexType = IndexEnum::INDEX_EMB_LIST_IVF_SQ8;
+    static constexpr const char* kBaseIndexType = IndexEnum::INDEX_FAISS_IVFSQ8;
+    using Config = EmbListIvfSq8Config;
+};
+
+struct EmbListDiskANNBase {
+    static constexpr const char* kIndexType = IndexEnum::INDEX_EMB_LIST_DISKANN;
+    static constexpr const char* kBaseIndexType = IndexEnum::INDEX_DISKANN;
+    using Config = EmbListDiskANNConfig;
+};
+
+KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(EMB_LIST_HNSW, EmbListIndexNode,
+                                                knowhere::feature::MMAP | knowhere::feature::MV |
+                                                    knowhere::feature::EMB_LIST,
+                                                EmbListHNSWBase)
+KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(EMB_LIST_HNSW_PQ, EmbListIndexNode,
+                                                knowhere::feature::MMAP | knowhere::feature::MV |
+                                                    knowhere::feature::EMB_LIST,
+                                                EmbListHNSWPQBase)
+KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(EMB_LIST_IVF_SQ8, EmbListIndexNode,
+                                                knowhere::feature::MMAP | knowhere::feature::EMB_LIST,
+                                                EmbListIvfSq8Base)
+KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(EMB_LIST_DISKANN, EmbListIndexNode,
+                                                knowhere::feature::DISK | knowhere::feature::EMB_LIST,
+                                                EmbListDiskANNBase)
+}  // namespace knowhere
@@ -12,7 +12,11 @@
 #ifndef EMB_LIST_HNSW_CONFIG_H
 #define EMB_LIST_HNSW_CONFIG_H
 
+#include <algorithm>
+
+#include "index/diskann/diskann_config.h"
 #include "index/hnsw/faiss_hnsw_config.h"
+#include "index/ivf/ivf_config.h"
 #include "knowhere/config.h"
 
 namespace knowhere {
@@ -29,6 +33,101 @@ class EmbListHNSWConfig : public FaissHnswFlatConfig {
     }
 };
 
+// the configs of the emb_list indexes over the other base indexes, with the parameters of their base index
+
+class EmbListHNSWPQConfig : public FaissHnswPqConfig {
+ public:
+    CFG_FLOAT retrieval_ann_ratio;
+    KNOHWERE_DECLARE_CONFIG(EmbListHNSWPQConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(retrieval_ann_ratio)
+            .description("")
+            .set_default(1.0f)
+            .set_range(0.01f, 10.0f)
+            .for_search();
+    }
+};
+
+class EmbListIvfSq8Config : public IvfSqConfig {
+ public:
+    CFG_FLOAT retrieval_ann_ratio;
+    KNOHWERE_DECLARE_CONFIG(EmbListIvfSq8Config) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(retrieval_ann_ratio)
+            .description("")
+            .set_default(1.0f)
+            .set_range(0.01f, 10.0f)
+            .for_search();
+    }
+};
+
+class EmbListDiskANNConfig : public DiskANNConfig {
+ public:
+    CFG_FLOAT retrieval_ann_ratio;
+    KNOHWERE_DECLARE_CONFIG(EmbListDiskANNConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(retrieval_ann_ratio)
+            .description("")
+            .set_default(1.0f)
+            .set_range(0.01f, 10.0f)
+            .for_search();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type != PARAM_TYPE::SEARCH || !k.has_value() || !retrieval_ann_ratio.has_value()) {
+            return DiskANNConfig::CheckAndAdjust(param_type, err_msg);
+        }
+        // search_list_size is checked against the k of the base index, the vectors retrieved for every query vector
+        const auto el_k = k.value();
+        k = std::max((int32_t)(el_k * retrieval_ann_ratio.value()), 1);
+        const auto status = DiskANNConfig::CheckAndAdjust(param_type, err_msg);
+        k = el_k;
+        return status;
+    }
+};
+
+class EmbListPlaidConfig : public BaseConfig {
+ public:
+    CFG_INT nlist;
+    CFG_INT nprobe;
+    // the candidates of a query emb_list that are scored exactly, as a ratio of k, once ranked by their centroids
+    CFG_FLOAT centroid_candidate_ratio;
+    // the bits per dimension of the residuals of the vectors to their centroids, 0 to keep the vectors as they are
+    CFG_INT residual_bits;
+    // whether the vectors are kept as they are besides their residual codes, for the refine
+    CFG_BOOL refine;
+    CFG_FLOAT refine_k;
+    KNOHWERE_DECLARE_CONFIG(EmbListPlaidConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(nlist)
+            .description("number of centroids that the vectors of the emb_lists are clustered into.")
+            .set_default(256)
+            .set_range(1, 65536)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(nprobe)
+            .description("number of the nearest centroids of every query vector whose emb_lists are candidates.")
+            .set_default(8)
+            .set_range(1, 65536)
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(centroid_candidate_ratio)
+            .description("ratio of k of the candidates ranked by centroid interaction that are scored exactly.")
+            .set_default(4.0f)
+            .set_range(1.0f, 1000.0f)
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(residual_bits)
+            .description("bits per dimension of the residual codes of the vectors, 0 for full precision vectors.")
+            .set_default(0)
+            .set_range(0, 2)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine)
+            .description("whether the full precision vectors are kept to refine the residual code scores.")
+            .set_default(false)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_k)
+            .description("ratio of k of the candidates scored by residual codes that are refined.")
+            .set_default(1.0f)
+            .set_range(1.0f, 1000.0f)
+            .for_search();
+    }
+};
+
 }  // namespace knowhere
 
 #endif /* EMB_LIST_HNSW_CONFIG_H */
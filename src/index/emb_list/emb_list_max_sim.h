@@ -0,0 +1,104 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "knowhere/operands.h"
+#include "simd/hook.h"
+
+namespace knowhere {
+
+namespace detail {
+
+// the document tokens that the query tokens are scored against at a time, for the tile to stay in the L1/L2 cache
+// while every query token goes over it
+constexpr size_t kMaxSimDocTile = 64;
+
+template <typename DataType>
+inline float
+max_sim_ip(const DataType* x, const DataType* y, size_t dim) {
+    if constexpr (std::is_same_v<DataType, fp32>) {
+        return faiss::fvec_inner_product(x, y, dim);
+    } else if constexpr (std::is_same_v<DataType, fp16>) {
+        return faiss::fp16_vec_inner_product(x, y, dim);
+    } else if constexpr (std::is_same_v<DataType, bf16>) {
+        return faiss::bf16_vec_inner_product(x, y, dim);
+    } else {
+        return faiss::int8_vec_inner_product(x, y, dim);
+    }
+}
+
+template <typename DataType>
+inline void
+max_sim_ip_batch_4(const DataType* x, const DataType* y0, const DataType* y1, const DataType* y2, const DataType* y3,
+                   size_t dim, float& dis0, float& dis1, float& dis2, float& dis3) {
+    if constexpr (std::is_same_v<DataType, fp32>) {
+        faiss::fvec_inner_product_batch_4(x, y0, y1, y2, y3, dim, dis0, dis1, dis2, dis3);
+    } else if constexpr (std::is_same_v<DataType, fp16>) {
+        faiss::fp16_vec_inner_product_batch_4(x, y0, y1, y2, y3, dim, dis0, dis1, dis2, dis3);
+    } else if constexpr (std::is_same_v<DataType, bf16>) {
+        faiss::bf16_vec_inner_product_batch_4(x, y0, y1, y2, y3, dim, dis0, dis1, dis2, dis3);
+    } else {
+        faiss::int8_vec_inner_product_batch_4(x, y0, y1, y2, y3, dim, dis0, dis1, dis2, dis3);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief The sum over the query tokens of their max inner product with the document tokens (MaxSim), the same as
+ * get_sum_max_sim() over the nq x nd inner products, without materializing them.
+ *
+ * The document tokens are scored in tiles, every query token against four of them at once with the batch_4 kernels
+ * of its data type, and only the running max of every query token is kept.
+ *
+ * @return std::nullopt if either emb_list is empty.
+ */
+template <typename DataType>
+std::optional<float>
+get_fused_sum_max_sim(const DataType* query, size_t nq, const DataType* doc, size_t nd, size_t dim) {
+    if (nq == 0 || nd == 0) {
+        return std::nullopt;
+    }
+    std::vector<float> max_sims(nq, std::numeric_limits<float>::lowest());
+    for (size_t tile_begin = 0; tile_begin < nd; tile_begin += detail::kMaxSimDocTile) {
+        const size_t tile_end = std::min(nd, tile_begin + detail::kMaxSimDocTile);
+        for (size_t i = 0; i < nq; i++) {
+            const DataType* x = query + i * dim;
+            float max_sim = max_sims[i];
+            size_t j = tile_begin;
+            for (; j + 4 <= tile_end; j += 4) {
+                float dis0, dis1, dis2, dis3;
+                detail::max_sim_ip_batch_4(x, doc + j * dim, doc + (j + 1) * dim, doc + (j + 2) * dim,
+                                           doc + (j + 3) * dim, dim, dis0, dis1, dis2, dis3);
+                max_sim = std::max({max_sim, dis0, dis1, dis2, dis3});
+            }
+            for (; j < tile_end; j++) {
+                max_sim = std::max(max_sim, detail::max_sim_ip(x, doc + j * dim, dim));
+            }
+            max_sims[i] = max_sim;
+        }
+    }
+    float score = 0.0f;
+    for (const auto max_sim : max_sims) {
+        score += max_sim;
+    }
+    return score;
+}
+
+}  // namespace knowhere
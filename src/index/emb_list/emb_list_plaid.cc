@@ -0,0 +1,590 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+#include "faiss/Clustering.h"
+#include "faiss/IndexFlat.h"
+#include "index/emb_list/emb_list_config.h"
+#include "index/emb_list/emb_list_max_sim.h"
+#include "index/emb_list/emb_list_residual.h"
+#include "io/file_io.h"
+#include "io/memory_io.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/task.h"
+#include "knowhere/config.h"
+#include "knowhere/dataset.h"
+#include "knowhere/emb_list_utils.h"
+#include "knowhere/expected.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/index/index_node.h"
+#include "knowhere/log.h"
+#include "knowhere/object.h"
+#include "knowhere/operands.h"
+#include "knowhere/utils.h"
+#include "simd/hook.h"
+
+namespace knowhere {
+
+/**
+ * @brief EmbListPlaidIndexNode: an embedding-list-based index that generates its candidates from centroids, in the
+ * way of PLAID, instead of an ANN search of every query vector.
+ *
+ * Build: the vectors of all the emb_lists are clustered into nlist centroids, and every emb_list keeps the sorted,
+ * distinct centroids of its vectors (its centroid bag). The emb_lists of every centroid make an inverted list. The
+ * vectors are kept as they are, for the exact scoring, or with residual_bits, compressed into their centroids and the
+ * 1 or 2-bit codes of their residuals (see ResidualQuantizer), and kept as they are too only with refine.
+ *
+ * Search of a query emb_list:
+ * 1. The inner products of the query vectors with the centroids are computed, nq x nlist.
+ * 2. The emb_lists in the inverted lists of the nprobe best centroids of every query vector are the candidates.
+ * 3. Centroid interaction: every candidate is scored by the sum over the query vectors of their max inner product with
+ *    the centroids of its bag, an approximation of MaxSim that reads a few integers per candidate. The best
+ *    k * centroid_candidate_ratio candidates are kept.
+ * 4. The kept candidates are scored exactly with the fused MaxSim kernel, and the top-k are returned. With the residual
+ *    codes, they are scored by the MaxSim over the decoded vectors instead, the best k * refine_k of them then scored
+ *    exactly if the vectors are kept.
+ *
+ * Like EMB_LIST_HNSW, the bitset has a bit per emb_list, and the scores are MAX_SIM over inner products.
+ *
+ * @tparam DataType The data type of the vectors (e.g., fp32, fp16, bf16).
+ */
+template <typename DataType>
+class EmbListPlaidIndexNode : public IndexNode {
+ public:
+    EmbListPlaidIndexNode(const int32_t& version, const Object& object) : IndexNode(version) {
+    }
+
+    /**
+     * @brief Clusters the vectors of the emb_lists into the centroids.
+     */
+    Status
+    Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        const size_t* lims = dataset->GetLims();
+        if (lims == nullptr) {
+            LOG_KNOWHERE_WARNING_ << "Missing emb_list offset, could not train index";
+            return Status::emb_list_inner_error;
+        }
+        const auto& config = static_cast<const EmbListPlaidConfig&>(*cfg);
+        const auto rows = static_cast<size_t>(dataset->GetRows());
+        const auto dim = static_cast<size_t>(dataset->GetDim());
+        emb_list_offset_ = std::make_unique<EmbListOffset>(lims, rows);
+        // faiss needs at least as many training vectors as centroids
+        const auto nlist = std::min<size_t>(config.nlist.value(), rows);
+        try {
+            auto float_ds = ConvertFromDataTypeIfNeeded<DataType>(dataset);
+            faiss::Clustering clustering(dim, nlist);
+            faiss::IndexFlatL2 assigner(dim);
+            clustering.train(rows, static_cast<const float*>(float_ds->GetTensor()), assigner);
+            centroids_ = std::move(clustering.centroids);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return Status::faiss_inner_error;
+        }
+        dim_ = dim;
+        nlist_ = nlist;
+        residual_bits_ = config.residual_bits.value();
+        refine_ = config.refine.value();
+        return Status::success;
+    }
+
+    /**
+     * @brief Assigns the vectors to their centroids and builds the centroid bags and the inverted lists. The rows must
+     * be those of the emb_lists given to Train().
+     */
+    Status
+    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        if (emb_list_offset_ == nullptr || centroids_.empty()) {
+            LOG_KNOWHERE_WARNING_ << "index not trained";
+            return Status::index_not_trained;
+        }
+        const auto rows = static_cast<size_t>(dataset->GetRows());
+        if (rows != emb_list_offset_->offset.back() || !bag_offsets_.empty()) {
+            LOG_KNOWHERE_WARNING_ << "the rows to add (" << rows << ") are not the emb_lists of the trained index ("
+                                  << emb_list_offset_->offset.back() << " vectors)";
+            return Status::emb_list_inner_error;
+        }
+        std::vector<faiss::idx_t> assign(rows);
+        auto float_ds = ConvertFromDataTypeIfNeeded<DataType>(dataset);
+        const auto float_tensor = static_cast<const float*>(float_ds->GetTensor());
+        try {
+            faiss::IndexFlatL2 assigner(dim_);
+            assigner.add(nlist_, centroids_.data());
+            std::vector<float> dists(rows);
+            assigner.search(rows, float_tensor, 1, dists.data(), assign.data());
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return Status::faiss_inner_error;
+        }
+        if (residual_bits_ != 0) {
+            EncodeResiduals(float_tensor, rows, assign);
+        }
+        if (residual_bits_ == 0 || refine_) {
+            const auto tensor = static_cast<const DataType*>(dataset->GetTensor());
+            vectors_.assign(tensor, tensor + rows * dim_);
+        }
+
+        const auto num_el = emb_list_offset_->num_el();
+        bag_offsets_.assign(1, 0);
+        bag_centroids_.clear();
+        for (size_t el_id = 0; el_id < num_el; el_id++) {
+            const auto bag_begin = bag_centroids_.size();
+            for (auto vid = emb_list_offset_->offset[el_id]; vid < emb_list_offset_->offset[el_id + 1]; vid++) {
+                bag_centroids_.push_back(static_cast<uint32_t>(assign[vid]));
+            }
+            std::sort(bag_centroids_.begin() + bag_begin, bag_centroids_.end());
+            bag_centroids_.erase(std::unique(bag_centroids_.begin() + bag_begin, bag_centroids_.end()),
+                                 bag_centroids_.end());
+            bag_offsets_.push_back(bag_centroids_.size());
+        }
+        BuildInvertedLists();
+        LOG_KNOWHERE_INFO_ << "added " << rows << " vectors of " << num_el << " emb_lists, " << bag_centroids_.size()
+                           << " centroids in the bags";
+        return Status::success;
+    }
+
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        if (bag_offsets_.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        const size_t* lims = dataset->GetLims();
+        if (lims == nullptr) {
+            return expected<DataSetPtr>::Err(Status::emb_list_inner_error, "missing emb_list offset, could not search");
+        }
+        if (static_cast<size_t>(dataset->GetDim()) != dim_) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "dimension of the queries does not match");
+        }
+        const auto& config = static_cast<const EmbListPlaidConfig&>(*cfg);
+        if (!IsMetricType(config.metric_type.value(), metric::MAX_SIM)) {
+            return expected<DataSetPtr>::Err(Status::invalid_metric_type,
+                                             "metric type not supported for " + Type() + ": " +
+                                                 config.metric_type.value());
+        }
+        const auto num_q_vecs = static_cast<size_t>(dataset->GetRows());
+        EmbListOffset query_emb_list_offset(lims, num_q_vecs);
+        const auto num_q_el = query_emb_list_offset.num_el();
+        const auto el_k = static_cast<size_t>(config.k.value());
+        const auto nprobe = std::min<size_t>(config.nprobe.value(), nlist_);
+        const auto num_candidates =
+            std::max(el_k, static_cast<size_t>(std::ceil(el_k * config.centroid_candidate_ratio.value())));
+        // the candidates scored by their residual codes that are scored exactly
+        const auto num_refined = vectors_.empty()
+                                     ? el_k
+                                     : std::max(el_k, static_cast<size_t>(std::ceil(el_k * config.refine_k.value())));
+
+        auto float_ds = ConvertFromDataTypeIfNeeded<DataType>(dataset);
+        const auto float_queries = static_cast<const float*>(float_ds->GetTensor());
+        const auto queries = static_cast<const DataType*>(dataset->GetTensor());
+
+        auto ids = std::make_unique<int64_t[]>(num_q_el * el_k);
+        auto dists = std::make_unique<float[]>(num_q_el * el_k);
+        std::atomic<Status> status = Status::success;
+        const size_t avg_q_el_len = std::max<size_t>(1, num_q_vecs / std::max<size_t>(1, num_q_el));
+        ParallelForOverSearchThreadPool(
+            num_q_el, avg_q_el_len * nlist_ * dim_,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const auto start_offset = query_emb_list_offset.offset[i];
+                    const auto nq = query_emb_list_offset.offset[i + 1] - start_offset;
+                    auto res = SearchEmbList(float_queries + start_offset * dim_, queries + start_offset * dim_, nq,
+                                             el_k, nprobe, num_candidates, num_refined, bitset, ids.get() + i * el_k,
+                                             dists.get() + i * el_k);
+                    if (res != Status::success) {
+                        status = res;
+                    }
+                }
+            },
+            [&](size_t, size_t) { status = Status::timeout; });
+        if (status != Status::success) {
+            return expected<DataSetPtr>::Err(status, "emb_list plaid search failed");
+        }
+        return GenResultDataSet((int64_t)num_q_el, (int64_t)el_k, std::move(ids), std::move(dists));
+    }
+
+    expected<std::vector<IteratorPtr>>
+    AnnIterator(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset,
+                bool use_knowhere_search_pool) const override {
+        return expected<std::vector<IteratorPtr>>::Err(Status::not_implemented,
+                                                       "AnnIterator not supported for emb_list based index");
+    }
+
+    expected<DataSetPtr>
+    GetVectorByIds(const DataSetPtr dataset) const override {
+        return expected<DataSetPtr>::Err(Status::not_implemented,
+                                         "GetVectorByIds not supported for emb_list based index");
+    }
+
+    bool
+    HasRawData(const std::string& metric_type) const override {
+        return false;
+    }
+
+    expected<DataSetPtr>
+    GetIndexMeta(std::unique_ptr<Config> cfg) const override {
+        return expected<DataSetPtr>::Err(Status::not_implemented, "GetIndexMeta not implemented");
+    }
+
+    /**
+     * @brief The binary holds the dim, the emb_list offsets, the centroids, the centroid bags, the vectors, and the
+     * residual codes with their bucket weights. The inverted lists are rebuilt from the bags.
+     */
+    Status
+    Serialize(BinarySet& binset) const override {
+        if (bag_offsets_.empty()) {
+            LOG_KNOWHERE_ERROR_ << "Could not serialize empty " << Type();
+            return Status::empty_index;
+        }
+        try {
+            MemoryIOWriter writer;
+            writeBinaryPOD(writer, dim_);
+            writeBinaryPOD(writer, nlist_);
+            WriteVector(writer, emb_list_offset_->offset);
+            WriteVector(writer, centroids_);
+            WriteVector(writer, bag_offsets_);
+            WriteVector(writer, bag_centroids_);
+            WriteVector(writer, vectors_);
+            writeBinaryPOD(writer, residual_bits_);
+            WriteVector(writer, quantizer_.Weights());
+            WriteVector(writer, vector_centroids_);
+            WriteVector(writer, residual_codes_);
+            std::shared_ptr<uint8_t[]> data(writer.data());
+            binset.Append(Type(), data, writer.tellg());
+            return Status::success;
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner: " << e.what();
+            return Status::emb_list_inner_error;
+        }
+    }
+
+    Status
+    Deserialize(const BinarySet& binset, std::shared_ptr<Config> config) override {
+        auto binary = binset.GetByName(Type());
+        if (binary == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "Invalid BinarySet.";
+            return Status::invalid_binary_set;
+        }
+        return Load(binary->data.get(), binary->size);
+    }
+
+    Status
+    DeserializeFromFile(const std::string& filename, std::shared_ptr<Config> config) override {
+        try {
+            auto reader = FileReader(filename);
+            auto data = std::make_unique<uint8_t[]>(reader.size());
+            size_t read = 0;
+            while (read < reader.size()) {
+                auto n = reader.read(reinterpret_cast<char*>(data.get()) + read, reader.size() - read);
+                if (n <= 0) {
+                    LOG_KNOWHERE_ERROR_ << "Failed to read " << filename;
+                    return Status::disk_file_error;
+                }
+                read += n;
+            }
+            return Load(data.get(), reader.size());
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner: " << e.what();
+            return Status::disk_file_error;
+        }
+    }
+
+    static std::unique_ptr<BaseConfig>
+    StaticCreateConfig() {
+        return std::make_unique<EmbListPlaidConfig>();
+    }
+
+    std::unique_ptr<BaseConfig>
+    CreateConfig() const override {
+        return StaticCreateConfig();
+    }
+
+    int64_t
+    Dim() const override {
+        return dim_;
+    }
+
+    int64_t
+    Size() const override {
+        return vectors_.size() * sizeof(DataType) + residual_codes_.size() +
+               (centroids_.size() + quantizer_.Weights().size()) * sizeof(float) +
+               vector_centroids_.size() * sizeof(uint32_t) +
+               (bag_offsets_.size() + ivf_offsets_.size()) * sizeof(size_t) +
+               (bag_centroids_.size() + ivf_el_ids_.size()) * sizeof(uint32_t) +
+               (emb_list_offset_ ? emb_list_offset_->offset.size() * sizeof(size_t) : 0);
+    }
+
+    /**
+     * @brief Get the number of vectors in the index.
+     * note that this is the number of vectors, not the number of the emb_list.
+     */
+    int64_t
+    Count() const override {
+        return emb_list_offset_ == nullptr ? 0 : emb_list_offset_->offset.back();
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::IndexEnum::INDEX_EMB_LIST_PLAID;
+    }
+
+ private:
+    template <typename T>
+    static void
+    WriteVector(MemoryIOWriter& writer, const std::vector<T>& vec) {
+        writeBinaryPOD(writer, vec.size());
+        writer.write(vec.data(), sizeof(T), vec.size());
+    }
+
+    template <typename T>
+    static void
+    ReadVector(MemoryIOReader& reader, std::vector<T>& vec) {
+        size_t size;
+        readBinaryPOD(reader, size);
+        if (size > reader.remaining() / sizeof(T)) {
+            throw std::runtime_error("truncated emb_list plaid binary");
+        }
+        vec.resize(size);
+        reader.read(vec.data(), sizeof(T), size);
+    }
+
+    Status
+    Load(uint8_t* data, size_t size) {
+        try {
+            MemoryIOReader reader(data, size);
+            readBinaryPOD(reader, dim_);
+            readBinaryPOD(reader, nlist_);
+            std::vector<size_t> offset;
+            ReadVector(reader, offset);
+            emb_list_offset_ = std::make_unique<EmbListOffset>(std::move(offset));
+            ReadVector(reader, centroids_);
+            ReadVector(reader, bag_offsets_);
+            ReadVector(reader, bag_centroids_);
+            ReadVector(reader, vectors_);
+            readBinaryPOD(reader, residual_bits_);
+            std::vector<float> weights;
+            ReadVector(reader, weights);
+            quantizer_ = ResidualQuantizer(dim_, residual_bits_);
+            quantizer_.SetWeights(std::move(weights));
+            ReadVector(reader, vector_centroids_);
+            ReadVector(reader, residual_codes_);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner: " << e.what();
+            return Status::invalid_binary_set;
+        }
+        BuildInvertedLists();
+        return Status::success;
+    }
+
+    /**
+     * @brief Trains the residual quantizer on the residuals of a sample of the vectors to their centroids, and encodes
+     * the residuals of all the vectors.
+     */
+    void
+    EncodeResiduals(const float* vectors, size_t rows, const std::vector<faiss::idx_t>& assign) {
+        quantizer_ = ResidualQuantizer(dim_, residual_bits_);
+        const size_t code_size = quantizer_.CodeSize();
+        const size_t step = std::max<size_t>(1, rows / kResidualTrainVectors);
+        std::vector<float> residuals;
+        for (size_t vid = 0; vid < rows; vid += step) {
+            const float* centroid = centroids_.data() + assign[vid] * dim_;
+            for (size_t d = 0; d < dim_; d++) {
+                residuals.push_back(vectors[vid * dim_ + d] - centroid[d]);
+            }
+        }
+        quantizer_.Train(residuals.data(), residuals.size() / dim_);
+
+        vector_centroids_.resize(rows);
+        residual_codes_.resize(rows * code_size);
+        std::vector<float> residual(dim_);
+        for (size_t vid = 0; vid < rows; vid++) {
+            vector_centroids_[vid] = static_cast<uint32_t>(assign[vid]);
+            const float* centroid = centroids_.data() + assign[vid] * dim_;
+            for (size_t d = 0; d < dim_; d++) {
+                residual[d] = vectors[vid * dim_ + d] - centroid[d];
+            }
+            quantizer_.Encode(residual.data(), residual_codes_.data() + vid * code_size);
+        }
+    }
+
+    // the emb_lists of every centroid, from the centroid bags
+    void
+    BuildInvertedLists() {
+        ivf_offsets_.assign(nlist_ + 1, 0);
+        for (const auto c : bag_centroids_) {
+            ivf_offsets_[c + 1]++;
+        }
+        std::partial_sum(ivf_offsets_.begin(), ivf_offsets_.end(), ivf_offsets_.begin());
+        ivf_el_ids_.resize(bag_centroids_.size());
+        std::vector<size_t> pos(ivf_offsets_.begin(), ivf_offsets_.end() - 1);
+        for (size_t el_id = 0; el_id + 1 < bag_offsets_.size(); el_id++) {
+            for (auto j = bag_offsets_[el_id]; j < bag_offsets_[el_id + 1]; j++) {
+                ivf_el_ids_[pos[bag_centroids_[j]]++] = static_cast<uint32_t>(el_id);
+            }
+        }
+    }
+
+    Status
+    SearchEmbList(const float* float_query, const DataType* query, size_t nq, size_t el_k, size_t nprobe,
+                  size_t num_candidates, size_t num_refined, const BitsetView& bitset, int64_t* ids,
+                  float* dists) const {
+        // the scores of the query vectors with the centroids
+        std::vector<float> centroid_scores(nq * nlist_);
+        for (size_t i = 0; i < nq; i++) {
+            for (size_t c = 0; c < nlist_; c++) {
+                centroid_scores[i * nlist_ + c] =
+                    faiss::fvec_inner_product(float_query + i * dim_, centroids_.data() + c * dim_, dim_);
+            }
+        }
+
+        // the emb_lists of the nprobe best centroids of every query vector
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> probes(nlist_);
+        for (size_t i = 0; i < nq; i++) {
+            const float* scores = centroid_scores.data() + i * nlist_;
+            std::iota(probes.begin(), probes.end(), 0);
+            std::partial_sort(probes.begin(), probes.begin() + nprobe, probes.end(),
+                              [&](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+            for (size_t p = 0; p < nprobe; p++) {
+                const auto c = probes[p];
+                for (auto j = ivf_offsets_[c]; j < ivf_offsets_[c + 1]; j++) {
+                    if (bitset.empty() || !bitset.test(ivf_el_ids_[j])) {
+                        candidates.push_back(ivf_el_ids_[j]);
+                    }
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // centroid interaction: the max sim of every query vector over the centroids of the bag
+        std::priority_queue<DistId, std::vector<DistId>, std::greater<>> approx_heap;
+        for (const auto el_id : candidates) {
+            float score = 0.0f;
+            for (size_t i = 0; i < nq; i++) {
+                const float* scores = centroid_scores.data() + i * nlist_;
+                float max_score = std::numeric_limits<float>::lowest();
+                for (auto j = bag_offsets_[el_id]; j < bag_offsets_[el_id + 1]; j++) {
+                    max_score = std::max(max_score, scores[bag_centroids_[j]]);
+                }
+                score += max_score;
+            }
+            if (approx_heap.size() < num_candidates) {
+                approx_heap.emplace((int64_t)el_id, score);
+            } else if (score > approx_heap.top().val) {
+                approx_heap.pop();
+                approx_heap.emplace((int64_t)el_id, score);
+            }
+        }
+
+        std::priority_queue<DistId, std::vector<DistId>, std::greater<>> minheap;
+        if (residual_bits_ != 0) {
+            // the MaxSim over the decoded vectors of the kept candidates: the centroid scores plus the residual scores
+            // read from the lookup tables of the query vectors
+            const size_t code_size = quantizer_.CodeSize();
+            const size_t lut_size = code_size * ResidualQuantizer::kLutEntries;
+            std::vector<float> luts(nq * lut_size);
+            for (size_t i = 0; i < nq; i++) {
+                quantizer_.ComputeLut(float_query + i * dim_, luts.data() + i * lut_size);
+            }
+            for (; !approx_heap.empty(); approx_heap.pop()) {
+                const auto el_id = approx_heap.top().id;
+                const auto doc_begin = emb_list_offset_->offset[el_id];
+                const auto doc_end = emb_list_offset_->offset[el_id + 1];
+                float score = 0.0f;
+                for (size_t i = 0; i < nq; i++) {
+                    const float* lut = luts.data() + i * lut_size;
+                    const float* scores = centroid_scores.data() + i * nlist_;
+                    float max_score = std::numeric_limits<float>::lowest();
+                    for (auto vid = doc_begin; vid < doc_end; vid++) {
+                        const auto residual_score = quantizer_.Score(lut, residual_codes_.data() + vid * code_size);
+                        max_score = std::max(max_score, scores[vector_centroids_[vid]] + residual_score);
+                    }
+                    score += max_score;
+                }
+                if (minheap.size() < num_refined) {
+                    minheap.emplace(el_id, score);
+                } else if (score > minheap.top().val) {
+                    minheap.pop();
+                    minheap.emplace(el_id, score);
+                }
+            }
+            if (vectors_.empty()) {
+                WriteResults(minheap, el_k, ids, dists);
+                return Status::success;
+            }
+            // the best num_refined of them are scored exactly
+            std::swap(approx_heap, minheap);
+        }
+
+        // the exact MaxSim of the kept candidates
+        for (; !approx_heap.empty(); approx_heap.pop()) {
+            const auto el_id = approx_heap.top().id;
+            const auto doc_begin = emb_list_offset_->offset[el_id];
+            const auto nd = emb_list_offset_->offset[el_id + 1] - doc_begin;
+            auto score_or = get_fused_sum_max_sim(query, nq, vectors_.data() + doc_begin * dim_, nd, dim_);
+            if (!score_or.has_value()) {
+                LOG_KNOWHERE_WARNING_ << "get_fused_sum_max_sim failed, nq: " << nq << ", nd: " << nd;
+                return Status::emb_list_inner_error;
+            }
+            const auto score = score_or.value();
+            if (minheap.size() < el_k) {
+                minheap.emplace(el_id, score);
+            } else if (score > minheap.top().val) {
+                minheap.pop();
+                minheap.emplace(el_id, score);
+            }
+        }
+        WriteResults(minheap, el_k, ids, dists);
+        return Status::success;
+    }
+
+    // writes the results of the heap in descending order of score, padded to el_k
+    static void
+    WriteResults(std::priority_queue<DistId, std::vector<DistId>, std::greater<>>& minheap, size_t el_k, int64_t* ids,
+                 float* dists) {
+        const auto real_el_k = minheap.size();
+        for (size_t j = 0; j < real_el_k; j++) {
+            ids[real_el_k - j - 1] = minheap.top().id;
+            dists[real_el_k - j - 1] = minheap.top().val;
+            minheap.pop();
+        }
+        std::fill(ids + real_el_k, ids + el_k, -1);
+        std::fill(dists + real_el_k, dists + el_k, std::numeric_limits<float>::min());
+    }
+
+    // the vectors sampled to train the residual quantizer
+    static constexpr size_t kResidualTrainVectors = 1 << 16;
+
+    size_t dim_ = 0;
+    size_t nlist_ = 0;
+    size_t residual_bits_ = 0;
+    bool refine_ = false;
+    std::unique_ptr<EmbListOffset> emb_list_offset_;  ///< emb_list group offset structure
+    std::vector<float> centroids_;                    ///< nlist x dim
+    std::vector<DataType> vectors_;                   ///< the vectors of the emb_lists, for the exact MaxSim
+    ResidualQuantizer quantizer_;                     ///< the buckets of the residual codes
+    std::vector<uint32_t> vector_centroids_;          ///< the centroid of every vector, with the residual codes
+    std::vector<uint8_t> residual_codes_;             ///< the residual codes of the vectors, CodeSize() bytes each
+    std::vector<size_t> bag_offsets_;                 ///< the centroid bag of emb_list i, [bag_offsets_[i], [i + 1])
+    std::vector<uint32_t> bag_centroids_;             ///< the sorted, distinct centroids of the bags
+    std::vector<size_t> ivf_offsets_;                 ///< the emb_lists of centroid c, [ivf_offsets_[c], [c + 1])
+    std::vector<uint32_t> ivf_el_ids_;
+};
+
+KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(EMB_LIST_PLAID, EmbListPlaidIndexNode, knowhere::feature::EMB_LIST)
+}  // namespace knowhere
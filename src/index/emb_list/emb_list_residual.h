@@ -0,0 +1,142 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace knowhere {
+
+/**
+ * @brief The residual quantizer of the compressed emb_list vectors, in the way of ColBERTv2: a vector is stored as its
+ * centroid and, for every dimension, the bucket of its residual to the centroid, in 1 or 2 bits. The buckets are shared
+ * by all the dimensions: their cutoffs are the quantiles of the residual values, and a bucket decodes to the quantile
+ * at its middle.
+ *
+ * The inner product of a query vector with a decoded vector is that with the centroid plus that with the decoded
+ * residual. The latter is read from a lookup table of the query vector, with an entry for every byte value at every
+ * byte of the codes, a lookup per byte instead of a decode of 8 / bits dimensions.
+ */
+class ResidualQuantizer {
+ public:
+    // the entries of the lookup table of a query vector for every byte of the codes, one per byte value
+    static constexpr size_t kLutEntries = 256;
+
+    ResidualQuantizer() = default;
+
+    ResidualQuantizer(size_t dim, size_t bits) : dim_(dim), bits_(bits) {
+    }
+
+    /**
+     * @brief Sets the buckets from the residual values, n x dim of them.
+     */
+    void
+    Train(const float* residuals, size_t n) {
+        const size_t num_buckets = size_t{1} << bits_;
+        std::vector<float> values(residuals, residuals + n * dim_);
+        auto quantile = [&](double q) {
+            auto nth = values.begin() + std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+            std::nth_element(values.begin(), nth, values.end());
+            return *nth;
+        };
+        cutoffs_.resize(num_buckets - 1);
+        weights_.resize(num_buckets);
+        for (size_t b = 0; b + 1 < num_buckets; b++) {
+            cutoffs_[b] = quantile(static_cast<double>(b + 1) / num_buckets);
+        }
+        for (size_t b = 0; b < num_buckets; b++) {
+            weights_[b] = quantile((b + 0.5) / num_buckets);
+        }
+    }
+
+    void
+    Encode(const float* residual, uint8_t* code) const {
+        std::fill(code, code + CodeSize(), 0);
+        for (size_t d = 0; d < dim_; d++) {
+            const auto bucket = std::upper_bound(cutoffs_.begin(), cutoffs_.end(), residual[d]) - cutoffs_.begin();
+            code[d * bits_ / 8] |= static_cast<uint8_t>(bucket << (d * bits_ % 8));
+        }
+    }
+
+    /**
+     * @brief Fills the CodeSize() x kLutEntries lookup table of the query vector: the entry v of byte p is the inner
+     * product of the query with the residual that the byte value v decodes to, over the dimensions of byte p.
+     */
+    void
+    ComputeLut(const float* query, float* lut) const {
+        const size_t dims_per_byte = 8 / bits_;
+        const uint32_t mask = (1u << bits_) - 1;
+        for (size_t p = 0; p < CodeSize(); p++) {
+            const size_t d_begin = p * dims_per_byte;
+            const size_t d_end = std::min(dim_, d_begin + dims_per_byte);
+            float* byte_lut = lut + p * kLutEntries;
+            for (uint32_t v = 0; v < kLutEntries; v++) {
+                float sum = 0.0f;
+                for (size_t d = d_begin; d < d_end; d++) {
+                    sum += query[d] * weights_[(v >> ((d - d_begin) * bits_)) & mask];
+                }
+                byte_lut[v] = sum;
+            }
+        }
+    }
+
+    /**
+     * @brief The inner product of the query vector of the lookup table with the residual of the code.
+     */
+    float
+    Score(const float* lut, const uint8_t* code) const {
+        const size_t code_size = CodeSize();
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        size_t p = 0;
+        for (; p + 4 <= code_size; p += 4) {
+            sum0 += lut[p * kLutEntries + code[p]];
+            sum1 += lut[(p + 1) * kLutEntries + code[p + 1]];
+            sum2 += lut[(p + 2) * kLutEntries + code[p + 2]];
+            sum3 += lut[(p + 3) * kLutEntries + code[p + 3]];
+        }
+        for (; p < code_size; p++) {
+            sum0 += lut[p * kLutEntries + code[p]];
+        }
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    size_t
+    CodeSize() const {
+        return (dim_ * bits_ + 7) / 8;
+    }
+
+    size_t
+    Bits() const {
+        return bits_;
+    }
+
+    const std::vector<float>&
+    Weights() const {
+        return weights_;
+    }
+
+    void
+    SetWeights(std::vector<float> weights) {
+        weights_ = std::move(weights);
+    }
+
+ private:
+    size_t dim_ = 0;
+    size_t bits_ = 0;
+    std::vector<float> cutoffs_;
+    std::vector<float> weights_;
+};
+
+}  // namespace knowhere
@@ -9,15 +9,24 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <cstring>
+
 #include "common/metric.h"
 #include "faiss/IndexBinaryFlat.h"
 #include "faiss/IndexFlat.h"
+#include "faiss/IndexFlatHalf.h"
 #include "faiss/impl/AuxIndexStructures.h"
+#include "faiss/impl/FaissAssert.h"
 #include "faiss/index_io.h"
 #include "index/flat/flat_config.h"
+#include "index/huge_page_index.h"
+#include "index/index_memory_report.h"
+#include "index/index_warmup.h"
+#include "io/index_binary.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview_idselector.h"
 #include "knowhere/comp/task.h"
+#include "knowhere/comp/workspace.h"
 #include "knowhere/feature.h"
 #include "knowhere/index/index_factory.h"
 #include "knowhere/index/index_node_data_mock_wrapper.h"
@@ -31,11 +40,15 @@ template <typename DataType, typename IndexType>
 class FlatIndexNode : public IndexNode {
  public:
     FlatIndexNode(const int32_t version, const Object& object) : IndexNode(version), index_(nullptr) {
-        static_assert(
-            std::is_same<IndexType, faiss::IndexFlat>::value || std::is_same<IndexType, faiss::IndexBinaryFlat>::value,
-            "not support");
-        static_assert(std::is_same_v<DataType, fp32> || std::is_same_v<DataType, bin1>,
-                      "FlatIndexNode only support float/binary");
+        static_assert(std::is_same<IndexType, faiss::IndexFlat>::value ||
+                          std::is_same<IndexType, faiss::IndexFlatHalf>::value ||
+                          std::is_same<IndexType, faiss::IndexBinaryFlat>::value,
+                      "not support");
+        // fp16 and bf16 vectors are kept as they are by IndexFlatHalf, instead of being converted to fp32
+        static_assert(std::is_same<IndexType, faiss::IndexFlatHalf>::value
+                          ? (std::is_same_v<DataType, fp16> || std::is_same_v<DataType, bf16>)
+                          : (std::is_same_v<DataType, fp32> || std::is_same_v<DataType, bin1>),
+                      "FlatIndexNode only support float/half/binary");
         search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
     }
 
@@ -55,6 +68,11 @@ class FlatIndexNode : public IndexNode {
             bool is_cosine = IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE);
             index_ = std::make_unique<faiss::IndexFlat>(dataset->GetDim(), metric.value(), is_cosine);
         }
+        if constexpr (std::is_same<faiss::IndexFlatHalf, IndexType>::value) {
+            bool is_cosine = IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE);
+            index_ = std::make_unique<faiss::IndexFlatHalf>(dataset->GetDim(), metric.value(),
+                                                            std::is_same_v<DataType, bf16>, is_cosine);
+        }
         return Status::success;
     }
 
@@ -62,18 +80,27 @@ class FlatIndexNode : public IndexNode {
     Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
         auto x = dataset->GetTensor();
         auto n = dataset->GetRows();
-        index_->add(n, (const DataType*)x);
+        if constexpr (std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
+            index_->add_typed(n, x);
+        } else {
+            index_->add(n, (const DataType*)x);
+        }
         return Status::success;
     }
 
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        return SearchWithNewBuf(dataset, std::move(cfg), bitset);
+    }
+
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override {
         if (!index_) {
             LOG_KNOWHERE_WARNING_ << "search on empty index";
             return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
         }
 
-        DataSetPtr results = std::make_shared<DataSet>();
         const FlatConfig& f_cfg = static_cast<const FlatConfig&>(*cfg);
         bool is_cosine = IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE);
 
@@ -82,62 +109,84 @@ class FlatIndexNode : public IndexNode {
         auto x = dataset->GetTensor();
         auto dim = dataset->GetDim();
 
-        auto len = k * nq;
-        int64_t* ids = nullptr;
-        float* distances = nullptr;
         try {
-            ids = new (std::nothrow) int64_t[len];
-            distances = new (std::nothrow) float[len];
-            std::vector<folly::Future<folly::Unit>> futs;
-            futs.reserve(nq);
-            for (int i = 0; i < nq; ++i) {
-                futs.emplace_back(search_pool_->push([&, index = i] {
-                    ThreadPool::ScopedSearchOmpSetter setter(1);
-                    auto cur_ids = ids + k * index;
-                    auto cur_dis = distances + k * index;
+            // a selective filter is turned into the list of the ids that pass it, for the queries to compute only them
+            std::unique_ptr<BitsetViewIDList> id_list = nullptr;
+            if constexpr (!std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
+                if ((index_->metric_type == faiss::METRIC_L2 || index_->metric_type == faiss::METRIC_INNER_PRODUCT) &&
+                    BitsetViewIDList::pays_off(bitset)) {
+                    id_list = std::make_unique<BitsetViewIDList>(bitset, index_->ntotal);
+                }
+            }
+            // a query scans every vector, the queries on a small index are batched into the tasks
+            const size_t query_cost = static_cast<size_t>(index_->ntotal) * dim;
+            auto search_query = [&](const int64_t index) {
+                auto cur_ids = ids + k * index;
+                auto cur_dis = distances + k * index;
+
+                BitsetViewIDSelector bw_idselector(bitset);
+                faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+                if (id_list != nullptr) {
+                    id_selector = &id_list->selector;
+                }
 
-                    BitsetViewIDSelector bw_idselector(bitset);
-                    faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+                if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
+                    SearchWorkspace::Scope workspace;
+                    auto cur_query = (const DataType*)x + dim * index;
+                    if (is_cosine) {
+                        cur_query = NormalizedQuery(workspace, cur_query, dim);
+                    }
 
-                    if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
-                        auto cur_query = (const DataType*)x + dim * index;
-                        std::unique_ptr<DataType[]> copied_query = nullptr;
-                        if (is_cosine) {
-                            copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                            cur_query = copied_query.get();
-                        }
+                    faiss::SearchParameters search_params;
+                    search_params.sel = id_selector;
 
-                        faiss::SearchParameters search_params;
-                        search_params.sel = id_selector;
+                    index_->search(1, cur_query, k, cur_dis, cur_ids, &search_params);
+                }
+                if constexpr (std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
+                    // the typed cosine divides by the norm of the query, which is searched as it is
+                    faiss::SearchParameters search_params;
+                    search_params.sel = id_selector;
 
-                        index_->search(1, cur_query, k, cur_dis, cur_ids, &search_params);
-                    }
-                    if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
-                        auto cur_i_dis = reinterpret_cast<int32_t*>(cur_dis);
+                    index_->search_typed(1, (const DataType*)x + dim * index, k, cur_dis, cur_ids, &search_params);
+                }
+                if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
+                    auto cur_i_dis = reinterpret_cast<int32_t*>(cur_dis);
 
-                        faiss::SearchParameters search_params;
-                        search_params.sel = id_selector;
+                    faiss::SearchParameters search_params;
+                    search_params.sel = id_selector;
 
-                        index_->search(1, (const uint8_t*)x + index * ((dim + 7) / 8), k, cur_i_dis, cur_ids,
-                                       &search_params);
+                    index_->search(1, (const uint8_t*)x + index * ((dim + 7) / 8), k, cur_i_dis, cur_ids,
+                                   &search_params);
 
-                        if (index_->metric_type == faiss::METRIC_Hamming) {
-                            for (int64_t j = 0; j < k; j++) {
-                                cur_dis[j] = static_cast<float>(cur_i_dis[j]);
-                            }
+                    if (index_->metric_type == faiss::METRIC_Hamming) {
+                        for (int64_t j = 0; j < k; j++) {
+                            cur_dis[j] = static_cast<float>(cur_i_dis[j]);
                         }
                     }
-                }));
-            }
-            // wait for the completion
-            WaitAllSuccess(futs);
+                }
+            };
+            ParallelForOverSearchThreadPool(
+                nq, query_cost,
+                [&](size_t begin, size_t end) {
+                    for (auto i = begin; i < end; ++i) {
+                        search_query(i);
+                    }
+                },
+                [&](size_t begin, size_t end) { MarkMissingResults(ids, distances, k, begin, end); });
         } catch (const std::exception& e) {
-            std::unique_ptr<int64_t[]> auto_delete_ids(ids);
-            std::unique_ptr<float[]> auto_delete_dis(distances);
             LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
             return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
         }
-        return GenResultDataSet(nq, k, ids, distances);
+        auto res = GenResultDataSet(nq, k, ids, distances);
+        res->SetIsOwner(false);
+        if (f_cfg.search_stats.value()) {
+            // every query computes the distances to the vectors that pass the filter
+            QuerySearchStats query_stats;
+            query_stats.distance_computations =
+                bitset.empty() ? static_cast<size_t>(index_->ntotal) : bitset.size() - bitset.count();
+            res->SetSearchStats(SearchStats(nq, query_stats));
+        }
+        return res;
     }
 
     expected<DataSetPtr>
@@ -160,8 +209,8 @@ class FlatIndexNode : public IndexNode {
 
         RangeSearchResult range_search_result;
 
-        std::vector<std::vector<int64_t>> result_id_array(nq);
-        std::vector<std::vector<float>> result_dist_array(nq);
+        RangeSearchResultArena arena(nq);
+        const bool has_range_filter = (range_filter != defaultRangeFilter);
 
         try {
             std::vector<folly::Future<folly::Unit>> futs;
@@ -175,11 +224,10 @@ class FlatIndexNode : public IndexNode {
                     faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
 
                     if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
+                        SearchWorkspace::Scope workspace;
                         auto cur_query = (const DataType*)xq + dim * index;
-                        std::unique_ptr<DataType[]> copied_query = nullptr;
                         if (is_cosine) {
-                            copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                            cur_query = copied_query.get();
+                            cur_query = NormalizedQuery(workspace, cur_query, dim);
                         }
 
                         faiss::SearchParameters search_params;
@@ -187,6 +235,13 @@ class FlatIndexNode : public IndexNode {
 
                         index_->range_search(1, cur_query, radius, &res, &search_params);
                     }
+                    if constexpr (std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
+                        faiss::SearchParameters search_params;
+                        search_params.sel = id_selector;
+
+                        index_->range_search_typed(1, (const DataType*)xq + dim * index, radius, &res,
+                                                   &search_params);
+                    }
                     if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
                         faiss::SearchParameters search_params;
                         search_params.sel = id_selector;
@@ -194,23 +249,18 @@ class FlatIndexNode : public IndexNode {
                         index_->range_search(1, (const uint8_t*)xq + index * ((dim + 7) / 8), radius, &res,
                                              &search_params);
                     }
-                    auto elem_cnt = res.lims[1];
-                    result_dist_array[index].resize(elem_cnt);
-                    result_id_array[index].resize(elem_cnt);
-                    for (size_t j = 0; j < elem_cnt; j++) {
-                        result_dist_array[index][j] = res.distances[j];
-                        result_id_array[index][j] = res.labels[j];
-                    }
-                    if (f_cfg.range_filter.value() != defaultRangeFilter) {
-                        FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index], is_ip, radius,
-                                                        range_filter);
+                    auto writer = arena.GetWriter(index);
+                    for (size_t j = 0; j < res.lims[1]; j++) {
+                        if (!has_range_filter || distance_in_range(res.distances[j], radius, range_filter, is_ip)) {
+                            writer.Add(res.labels[j], res.distances[j]);
+                        }
                     }
                 }));
             }
             // wait for the completion
             WaitAllSuccess(futs);
-            range_search_result =
-                GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter);
+            ScopedSearchStage stage(SearchStage::RESULT_ASSEMBLY);
+            range_search_result = arena.Finish();
         } catch (const std::exception& e) {
             LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
             return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
@@ -238,6 +288,23 @@ class FlatIndexNode : public IndexNode {
                 return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
             }
         }
+        if constexpr (std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
+            // the codes are the vectors as they were added
+            DataType* data = nullptr;
+            try {
+                data = new DataType[rows * dim];
+                for (int64_t i = 0; i < rows; i++) {
+                    FAISS_THROW_IF_NOT(ids[i] >= 0 && ids[i] < index_->ntotal);
+                    std::memcpy(data + i * dim, index_->codes.data() + ids[i] * index_->code_size,
+                                index_->code_size);
+                }
+                return GenResultDataSet(rows, dim, data);
+            } catch (const std::exception& e) {
+                std::unique_ptr<DataType[]> auto_del(data);
+                LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+                return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+            }
+        }
         if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
             uint8_t* data = nullptr;
             try {
@@ -256,7 +323,8 @@ class FlatIndexNode : public IndexNode {
 
     static bool
     StaticHasRawData(const knowhere::BaseConfig& config, const IndexVersion& version) {
-        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
+        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value ||
+                      std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
             const FlatConfig& f_cfg = static_cast<const FlatConfig&>(config);
             if (knowhere::Version(version) <= Version::GetMinimalVersion()) {
                 return !IsMetricType(f_cfg.metric_type.value(), metric::COSINE);
@@ -272,7 +340,8 @@ class FlatIndexNode : public IndexNode {
 
     bool
     HasRawData(const std::string& metric_type) const override {
-        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
+        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value ||
+                      std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
             if (this->version_ <= Version::GetMinimalVersion()) {
                 return !IsMetricType(metric_type, metric::COSINE);
             } else {
@@ -296,15 +365,7 @@ class FlatIndexNode : public IndexNode {
             return Status::empty_index;
         }
         try {
-            MemoryIOWriter writer;
-            if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
-                faiss::write_index(index_.get(), &writer);
-            }
-            if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
-                faiss::write_index_binary(index_.get(), &writer);
-            }
-            std::shared_ptr<uint8_t[]> data(writer.data());
-            binset.Append(Type(), data, writer.tellg());
+            AppendIndexBinary(binset, Type(), this->version_, [&](faiss::IOWriter* writer) { WriteIndex(writer); });
             return Status::success;
         } catch (const std::exception& e) {
             LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
@@ -313,7 +374,22 @@ class FlatIndexNode : public IndexNode {
     }
 
     Status
-    Deserialize(const BinarySet& binset, std::shared_ptr<Config>) override {
+    SerializeToFile(const std::string& filename) const override {
+        if (!index_) {
+            LOG_KNOWHERE_ERROR_ << "Can not serialize empty index.";
+            return Status::empty_index;
+        }
+        try {
+            WriteIndexFile(filename, Type(), this->version_, [&](faiss::IOWriter* writer) { WriteIndex(writer); });
+            return Status::success;
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
+        }
+    }
+
+    Status
+    Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) override {
         std::vector<std::string> names = {"IVF",        // compatible with knowhere-1.x
                                           "BinaryIVF",  // compatible with knowhere-1.x
                                           Type()};
@@ -323,14 +399,25 @@ class FlatIndexNode : public IndexNode {
             return Status::invalid_binary_set;
         }
 
-        MemoryIOReader reader(binary->data.get(), binary->size);
-        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
-            faiss::Index* index = faiss::read_index(&reader);
-            index_.reset(static_cast<IndexType*>(index));
-        }
-        if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
-            faiss::IndexBinary* index = faiss::read_index_binary(&reader);
-            index_.reset(static_cast<IndexType*>(index));
+        // the index is read from the binary, or as views of its data, or decompressed
+        const bool zero_copy = static_cast<const BaseConfig&>(*cfg).enable_zero_copy.value();
+        try {
+            auto reader = MakeIndexBinaryReader(binary, this->version_, Type(), zero_copy);
+            if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
+                faiss::Index* index = faiss::read_index(reader.get());
+                index_.reset(static_cast<IndexType*>(index));
+            }
+            if constexpr (std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
+                index_ = ToHalfIndex(faiss::read_index(reader.get()));
+            }
+            if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
+                faiss::IndexBinary* index = faiss::read_index_binary(reader.get());
+                index_.reset(static_cast<IndexType*>(index));
+            }
+            BackIndexWithHugePages(index_.get(), zero_copy);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
         }
         return Status::success;
     }
@@ -344,17 +431,55 @@ class FlatIndexNode : public IndexNode {
             io_flags |= faiss::IO_FLAG_MMAP_IFC;
         }
 
-        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
-            faiss::Index* index = faiss::read_index(filename.data(), io_flags);
-            index_.reset(static_cast<IndexType*>(index));
-        }
-        if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
-            faiss::IndexBinary* index = faiss::read_index_binary(filename.data(), io_flags);
-            index_.reset(static_cast<IndexType*>(index));
+        try {
+            auto reader = OpenIndexFile(filename, this->version_, Type(), io_flags);
+            if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
+                faiss::Index* index = faiss::read_index(reader.get(), io_flags);
+                index_.reset(static_cast<IndexType*>(index));
+            }
+            if constexpr (std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
+                index_ = ToHalfIndex(faiss::read_index(reader.get(), io_flags));
+            }
+            if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
+                faiss::IndexBinary* index = faiss::read_index_binary(reader.get(), io_flags);
+                index_.reset(static_cast<IndexType*>(index));
+            }
+            BackIndexWithHugePages(index_.get(), flat_cfg.enable_mmap.value());
+            if (flat_cfg.enable_mmap.value()) {
+                AdviseMappedAccess(index_.get());
+            }
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
         }
         return Status::success;
     }
 
+    Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) override {
+        if (!index_) {
+            return Status::empty_index;
+        }
+        return WarmupRanges(GetMappedRanges(index_.get(), level), progress);
+    }
+
+    Status
+    Cooldown() override {
+        if (!index_) {
+            return Status::empty_index;
+        }
+        return CooldownRanges(GetMappedRanges(index_.get(), WarmupLevel::FULL));
+    }
+
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        MemoryReport report;
+        if (index_) {
+            ReportIndexMemory(index_.get(), report);
+        }
+        return report;
+    }
+
     static std::unique_ptr<BaseConfig>
     StaticCreateConfig() {
         return std::make_unique<FlatConfig>();
@@ -382,7 +507,8 @@ class FlatIndexNode : public IndexNode {
 
     std::string
     Type() const override {
-        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value) {
+        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value ||
+                      std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_IDMAP;
         }
         if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
@@ -391,14 +517,53 @@ class FlatIndexNode : public IndexNode {
     }
 
  private:
+    // the fp16 and bf16 indexes of the older versions kept the vectors converted to fp32, they are converted back,
+    //   which is exact
+    static std::unique_ptr<faiss::IndexFlatHalf>
+    ToHalfIndex(faiss::Index* index) {
+        std::unique_ptr<faiss::Index> read_index(index);
+        if (auto half = dynamic_cast<faiss::IndexFlatHalf*>(index); half != nullptr) {
+            read_index.release();
+            return std::unique_ptr<faiss::IndexFlatHalf>(half);
+        }
+        auto flat = dynamic_cast<const faiss::IndexFlat*>(index);
+        if (flat == nullptr) {
+            throw std::runtime_error("the binary holds neither a half nor a float flat index");
+        }
+        LOG_KNOWHERE_INFO_ << "converting the fp32 vectors of an older flat index to half precision";
+        auto half = std::make_unique<faiss::IndexFlatHalf>(flat->d, flat->metric_type, std::is_same_v<DataType, bf16>,
+                                                           flat->is_cosine);
+        half->add(flat->ntotal, flat->get_xb());
+        return half;
+    }
+
+    void
+    WriteIndex(faiss::IOWriter* writer) const {
+        if constexpr (std::is_same<IndexType, faiss::IndexFlat>::value ||
+                      std::is_same<IndexType, faiss::IndexFlatHalf>::value) {
+            faiss::write_index(index_.get(), writer);
+        }
+        if constexpr (std::is_same<IndexType, faiss::IndexBinaryFlat>::value) {
+            faiss::write_index_binary(index_.get(), writer);
+        }
+    }
+
     std::unique_ptr<IndexType> index_;
     std::shared_ptr<ThreadPool> search_pool_;
 };
 
-KNOWHERE_MOCK_REGISTER_DENSE_FLOAT_ALL_GLOBAL(FLAT, FlatIndexNode,
-                                              knowhere::feature::NO_TRAIN | knowhere::feature::KNN |
-                                                  knowhere::feature::MMAP,
-                                              faiss::IndexFlat);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(FLAT, FlatIndexNode, fp32,
+                                (knowhere::feature::NO_TRAIN | knowhere::feature::KNN | knowhere::feature::MMAP |
+                                 knowhere::feature::FLOAT32),
+                                faiss::IndexFlat);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(FLAT, FlatIndexNode, fp16,
+                                (knowhere::feature::NO_TRAIN | knowhere::feature::KNN | knowhere::feature::MMAP |
+                                 knowhere::feature::FP16),
+                                faiss::IndexFlatHalf);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(FLAT, FlatIndexNode, bf16,
+                                (knowhere::feature::NO_TRAIN | knowhere::feature::KNN | knowhere::feature::MMAP |
+                                 knowhere::feature::BF16),
+                                faiss::IndexFlatHalf);
 
 KNOWHERE_MOCK_REGISTER_DENSE_INT_GLOBAL(FLAT, FlatIndexNode,
                                         knowhere::feature::NO_TRAIN | knowhere::feature::KNN | knowhere::feature::MMAP,
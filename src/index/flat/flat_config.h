@@ -12,11 +12,111 @@
 #ifndef FLAT_CONFIG_H
 #define FLAT_CONFIG_H
 
+#include <limits>
+#include <string>
+#include <vector>
+
 #include "knowhere/config.h"
+#include "knowhere/tolower.h"
 
 namespace knowhere {
 
-class FlatConfig : public BaseConfig {};
+class FlatConfig : public BaseConfig {
+ public:
+    KNOHWERE_DECLARE_CONFIG(FlatConfig) {
+    }
+};
+
+// FLAT_SQ scans the scalar quantized codes of all the rows, then reranks the refine_k * k best of them with the
+// distances of a refine index, which holds the raw data by default.
+class FlatSqConfig : public FlatConfig {
+ public:
+    CFG_STRING sq_type;
+    // whether an index is built with a refine support
+    CFG_BOOL refine;
+    // the number of candidates of the scan, in multiples of k
+    CFG_FLOAT refine_k;
+    // type of refine
+    CFG_STRING refine_type;
+    // the number of leading dimensions that the codes keep, undefined value leads to codes of all the dimensions
+    CFG_INT prefix_dim;
+
+    KNOHWERE_DECLARE_CONFIG(FlatSqConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(sq_type)
+            .set_default("SQ8")
+            .description("scalar quantizer type")
+            .for_train()
+            .for_static();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine)
+            .description("whether the refine is used during the train")
+            .set_default(true)
+            .for_train()
+            .for_static();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_k)
+            .description("refine k")
+            .set_default(1)
+            .set_range(1, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_type)
+            .description("the type of a refine index")
+            .set_default("FLAT")
+            .for_train()
+            .for_static();
+        /**
+         * For Matryoshka embeddings, whose leading dimensions carry most of
+         * the signal: the scan compares the codes of the first prefix_dim
+         * dimensions only, and the refine reranks its candidates with all of
+         * them. Needs a refine.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(prefix_dim)
+            .description("the number of leading dimensions that the codes keep")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_train()
+            .for_static();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type == PARAM_TYPE::TRAIN) {
+            if (!WhetherAcceptable(sq_type.value(), {"sq4", "sq6", "sq8", "fp16", "bf16"})) {
+                std::string msg = "invalid scalar quantizer type : " + sq_type.value() +
+                                  ", optional types are [sq4, sq6, sq8, fp16, bf16]";
+                return HandleError(err_msg, msg, Status::invalid_args);
+            }
+            if (refine.value() &&
+                !WhetherAcceptable(refine_type.value(), {"sq6", "sq8", "fp16", "bf16", "fp32", "flat"})) {
+                std::string msg = "invalid refine type : " + refine_type.value() +
+                                  ", optional types are [sq6, sq8, fp16, bf16, fp32, flat]";
+                return HandleError(err_msg, msg, Status::invalid_args);
+            }
+            if (prefix_dim.has_value()) {
+                if (!refine.value()) {
+                    std::string msg = "prefix_dim needs a refine over all the dimensions";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+                if (dim.has_value() && prefix_dim.value() >= dim.value()) {
+                    std::string msg = "prefix_dim (" + std::to_string(prefix_dim.value()) +
+                                      ") should be less than dim (" + std::to_string(dim.value()) + ")";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+            }
+        }
+        return Status::success;
+    }
+
+ private:
+    static bool
+    WhetherAcceptable(const std::string& type, const std::vector<std::string>& allowed_list) {
+        std::string type_tolower = str_to_lower(type);
+        for (const auto& allowed : allowed_list) {
+            if (type_tolower == allowed) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
 
 }  // namespace knowhere
 
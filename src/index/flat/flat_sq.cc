@@ -0,0 +1,414 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "common/metric.h"
+#include "faiss/IndexFlat.h"
+#include "faiss/IndexPreTransform.h"
+#include "faiss/IndexRefine.h"
+#include "faiss/IndexScalarQuantizer.h"
+#include "faiss/impl/AuxIndexStructures.h"
+#include "faiss/index_io.h"
+#include "index/flat/flat_config.h"
+#include "index/index_warmup.h"
+#include "index/refine/refine_utils.h"
+#include "io/index_binary.h"
+#include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/task.h"
+#include "knowhere/feature.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/index/index_node_data_mock_wrapper.h"
+#include "knowhere/log.h"
+#include "knowhere/range_util.h"
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+// A brute force index that scans scalar quantized codes, which take a quarter of the bandwidth of fp32 rows with
+// SQ8, and reranks the best candidates with a refine index. The index is either a faiss::IndexScalarQuantizer or a
+// faiss::IndexRefine over one. COSINE is stored and searched as IP over normalized vectors. With prefix_dim, the
+// scalar quantizer is behind a faiss::IndexPreTransform that keeps the leading dimensions of the vectors.
+template <typename DataType>
+class FlatSqIndexNode : public IndexNode {
+ public:
+    FlatSqIndexNode(const int32_t version, const Object& object) : IndexNode(version), index_(nullptr) {
+        static_assert(std::is_same_v<DataType, fp32>, "FlatSqIndexNode only support float");
+        search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
+    }
+
+    Status
+    Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        const FlatSqConfig& f_cfg = static_cast<const FlatSqConfig&>(*cfg);
+
+        auto metric = Str2FaissMetricType(f_cfg.metric_type.value());
+        if (!metric.has_value() ||
+            (metric.value() != faiss::METRIC_L2 && metric.value() != faiss::METRIC_INNER_PRODUCT)) {
+            LOG_KNOWHERE_ERROR_ << "unsupported metric type: " << f_cfg.metric_type.value();
+            return Status::invalid_metric_type;
+        }
+        auto sq_type = get_sq_quantizer_type(f_cfg.sq_type.value());
+        if (!sq_type.has_value()) {
+            LOG_KNOWHERE_ERROR_ << "invalid scalar quantizer type: " << f_cfg.sq_type.value();
+            return sq_type.error();
+        }
+
+        auto dim = dataset->GetDim();
+        // the codes of the leading dimensions only, if prefix_dim is set
+        const auto code_dim = f_cfg.prefix_dim.value_or(dim);
+        auto index = std::unique_ptr<faiss::Index>(
+            std::make_unique<faiss::IndexScalarQuantizer>(code_dim, sq_type.value(), metric.value()));
+        if (code_dim != dim) {
+            index = make_prefix_dim_index(dim, std::move(index));
+        }
+        if (f_cfg.refine.value()) {
+            auto refine_index =
+                pick_refine_index(DataType2EnumHelper<DataType>::value, f_cfg.refine_type, std::move(index), dim,
+                                  metric.value());
+            if (!refine_index.has_value()) {
+                return refine_index.error();
+            }
+            index = std::move(refine_index.value());
+        }
+
+        try {
+            auto [x, copied_x] = NormalizedIfCosine(dataset, f_cfg.metric_type.value());
+            index->train(dataset->GetRows(), x);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
+        }
+        is_cosine_ = IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE);
+        index_ = std::move(index);
+        return Status::success;
+    }
+
+    Status
+    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        if (!index_) {
+            LOG_KNOWHERE_ERROR_ << "Can not add data to empty FLAT_SQ index.";
+            return Status::empty_index;
+        }
+        const FlatSqConfig& f_cfg = static_cast<const FlatSqConfig&>(*cfg);
+        try {
+            auto [x, copied_x] = NormalizedIfCosine(dataset, f_cfg.metric_type.value());
+            index_->add(dataset->GetRows(), x);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
+        }
+        return Status::success;
+    }
+
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_WARNING_ << "search on empty index";
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+
+        const FlatSqConfig& f_cfg = static_cast<const FlatSqConfig&>(*cfg);
+        bool is_cosine = IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE);
+
+        auto k = f_cfg.k.value();
+        auto nq = dataset->GetRows();
+        auto x = dataset->GetTensor();
+        auto dim = dataset->GetDim();
+        const auto refine_index = dynamic_cast<const faiss::IndexRefine*>(index_.get());
+
+        auto len = k * nq;
+        auto ids = std::make_unique<int64_t[]>(len);
+        auto distances = std::make_unique<float[]>(len);
+        try {
+            std::vector<folly::Future<folly::Unit>> futs;
+            futs.reserve(nq);
+            for (int i = 0; i < nq; ++i) {
+                futs.emplace_back(search_pool_->push([&, index = i] {
+                    ThreadPool::ScopedSearchOmpSetter setter(1);
+                    auto cur_query = (const float*)x + dim * index;
+                    std::unique_ptr<float[]> copied_query = nullptr;
+                    if (is_cosine) {
+                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
+                        cur_query = copied_query.get();
+                    }
+
+                    // the scanner tests the rows one by one, so the bitset is kept rather than an id list
+                    BitsetViewIDSelector bw_idselector(bitset);
+                    faiss::SearchParameters sq_search_params;
+                    sq_search_params.sel = (bitset.empty()) ? nullptr : &bw_idselector;
+
+                    if (refine_index != nullptr) {
+                        faiss::IndexRefineSearchParameters refine_search_params;
+                        refine_search_params.sel = sq_search_params.sel;
+                        refine_search_params.k_factor = f_cfg.refine_k.value();
+                        refine_search_params.base_index_params = &sq_search_params;
+                        index_->search(1, cur_query, k, distances.get() + k * index, ids.get() + k * index,
+                                       &refine_search_params);
+                    } else {
+                        index_->search(1, cur_query, k, distances.get() + k * index, ids.get() + k * index,
+                                       &sq_search_params);
+                    }
+                }));
+            }
+            // wait for the completion
+            WaitAllSuccess(futs);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        }
+        return GenResultDataSet(nq, k, std::move(ids), std::move(distances));
+    }
+
+    expected<DataSetPtr>
+    RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_WARNING_ << "range search on empty index";
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+
+        const FlatSqConfig& f_cfg = static_cast<const FlatSqConfig&>(*cfg);
+        bool is_cosine = IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE);
+
+        auto nq = dataset->GetRows();
+        auto xq = dataset->GetTensor();
+        auto dim = dataset->GetDim();
+
+        float radius = f_cfg.radius.value();
+        float range_filter = f_cfg.range_filter.value();
+        bool is_ip = (index_->metric_type == faiss::METRIC_INNER_PRODUCT);
+        // the codes do not tell which rows near the radius are in range, so the rows are compared with the distances
+        // of the refine index, if any
+        const auto refine_index = dynamic_cast<const faiss::IndexRefine*>(index_.get());
+        const faiss::Index* dis_index = (refine_index != nullptr) ? refine_index->refine_index : index_.get();
+
+        RangeSearchResultArena arena(nq);
+        try {
+            std::vector<folly::Future<folly::Unit>> futs;
+            futs.reserve(nq);
+            for (int i = 0; i < nq; ++i) {
+                futs.emplace_back(search_pool_->push([&, index = i] {
+                    ThreadPool::ScopedSearchOmpSetter setter(1);
+                    auto cur_query = (const float*)xq + dim * index;
+                    std::unique_ptr<float[]> copied_query = nullptr;
+                    if (is_cosine) {
+                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
+                        cur_query = copied_query.get();
+                    }
+
+                    std::unique_ptr<faiss::DistanceComputer> dc(dis_index->get_distance_computer());
+                    dc->set_query(cur_query);
+                    auto writer = arena.GetWriter(index);
+                    for (faiss::idx_t j = 0; j < index_->ntotal; j++) {
+                        if (!bitset.empty() && bitset.test(j)) {
+                            continue;
+                        }
+                        const float dis = (*dc)(j);
+                        if (distance_in_range(dis, radius, range_filter, is_ip)) {
+                            writer.Add(j, dis);
+                        }
+                    }
+                }));
+            }
+            // wait for the completion
+            WaitAllSuccess(futs);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        }
+
+        return GenResultDataSet(nq, arena.Finish());
+    }
+
+    expected<DataSetPtr>
+    GetVectorByIds(const DataSetPtr dataset) const override {
+        if (!HasRawData(is_cosine_ ? metric::COSINE : metric::L2)) {
+            return expected<DataSetPtr>::Err(Status::not_implemented, "the index does not keep the raw data");
+        }
+        auto dim = Dim();
+        auto rows = dataset->GetRows();
+        auto ids = dataset->GetIds();
+        try {
+            auto data = std::make_unique<float[]>(rows * dim);
+            for (int64_t i = 0; i < rows; i++) {
+                index_->reconstruct(ids[i], data.get() + i * dim);
+            }
+            return GenResultDataSet(rows, dim, std::move(data));
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        }
+    }
+
+    static bool
+    StaticHasRawData(const knowhere::BaseConfig& config, const IndexVersion& version) {
+        const FlatSqConfig& f_cfg = static_cast<const FlatSqConfig&>(config);
+        return !IsMetricType(f_cfg.metric_type.value(), metric::COSINE) &&
+               has_lossless_refine_index(f_cfg.refine, f_cfg.refine_type, DataType2EnumHelper<DataType>::value);
+    }
+
+    bool
+    HasRawData(const std::string& metric_type) const override {
+        if (!index_ || IsMetricType(metric_type, metric::COSINE)) {
+            return false;
+        }
+        const auto refine_index = dynamic_cast<const faiss::IndexRefine*>(index_.get());
+        if (refine_index == nullptr) {
+            return false;
+        }
+        if (dynamic_cast<const faiss::IndexFlat*>(refine_index->refine_index) != nullptr) {
+            return true;
+        }
+        auto sq = dynamic_cast<const faiss::IndexScalarQuantizer*>(refine_index->refine_index);
+        return sq != nullptr && has_lossless_quant(sq->sq.qtype, DataType2EnumHelper<DataType>::value);
+    }
+
+    expected<DataSetPtr>
+    GetIndexMeta(std::unique_ptr<Config>) const override {
+        return expected<DataSetPtr>::Err(Status::not_implemented, "GetIndexMeta not implemented");
+    }
+
+    Status
+    Serialize(BinarySet& binset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_ERROR_ << "Can not serialize empty index.";
+            return Status::empty_index;
+        }
+        try {
+            AppendIndexBinary(binset, Type(), this->version_,
+                              [&](faiss::IOWriter* writer) { faiss::write_index(index_.get(), writer); });
+            return Status::success;
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
+        }
+    }
+
+    Status
+    Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) override {
+        auto binary = binset.GetByName(Type());
+        if (binary == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "Invalid binary set.";
+            return Status::invalid_binary_set;
+        }
+
+        try {
+            auto reader = MakeIndexBinaryReader(binary, this->version_, Type(), false);
+            return SetIndex(std::unique_ptr<faiss::Index>(faiss::read_index(reader.get())), *cfg);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
+        }
+    }
+
+    Status
+    DeserializeFromFile(const std::string& filename, std::shared_ptr<Config> cfg) override {
+        auto flat_cfg = static_cast<const knowhere::BaseConfig&>(*cfg);
+
+        int io_flags = 0;
+        if (flat_cfg.enable_mmap.value()) {
+            io_flags |= faiss::IO_FLAG_MMAP_IFC;
+        }
+
+        try {
+            auto reader = OpenIndexFile(filename, this->version_, Type(), io_flags);
+            auto status = SetIndex(std::unique_ptr<faiss::Index>(faiss::read_index(reader.get(), io_flags)), *cfg);
+            if (status == Status::success && flat_cfg.enable_mmap.value()) {
+                AdviseMappedAccess(index_.get());
+            }
+            return status;
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+            return Status::faiss_inner_error;
+        }
+    }
+
+    static std::unique_ptr<BaseConfig>
+    StaticCreateConfig() {
+        return std::make_unique<FlatSqConfig>();
+    }
+
+    std::unique_ptr<BaseConfig>
+    CreateConfig() const override {
+        return StaticCreateConfig();
+    }
+
+    int64_t
+    Dim() const override {
+        return index_->d;
+    }
+
+    int64_t
+    Size() const override {
+        // the codes of the scan and those of the refine
+        const auto refine_index = dynamic_cast<const faiss::IndexRefine*>(index_.get());
+        int64_t size = index_->ntotal * GetSqIndex(index_.get())->code_size;
+        if (refine_index != nullptr) {
+            auto refine_codes = dynamic_cast<const faiss::IndexFlatCodes*>(refine_index->refine_index);
+            size += index_->ntotal * (refine_codes != nullptr ? refine_codes->code_size : index_->d * sizeof(float));
+        }
+        return size;
+    }
+
+    int64_t
+    Count() const override {
+        return index_->ntotal;
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::IndexEnum::INDEX_FAISS_IDMAP_SQ;
+    }
+
+ private:
+    // the rows of the dataset as they are stored, a normalized copy for COSINE
+    static std::tuple<const float*, std::unique_ptr<float[]>>
+    NormalizedIfCosine(const DataSetPtr dataset, const std::string& metric_type) {
+        auto x = (const float*)dataset->GetTensor();
+        if (!IsMetricType(metric_type, knowhere::metric::COSINE)) {
+            return {x, nullptr};
+        }
+        auto copied_x = CopyAndNormalizeVecs(x, dataset->GetRows(), dataset->GetDim());
+        x = copied_x.get();
+        return {x, std::move(copied_x)};
+    }
+
+    // the scalar quantizer of an index, under its refine and its prefix_dim transform if any
+    static const faiss::IndexScalarQuantizer*
+    GetSqIndex(const faiss::Index* index) {
+        if (const auto refine_index = dynamic_cast<const faiss::IndexRefine*>(index); refine_index != nullptr) {
+            index = refine_index->base_index;
+        }
+        if (const auto index_pt = dynamic_cast<const faiss::IndexPreTransform*>(index); index_pt != nullptr) {
+            index = index_pt->index;
+        }
+        return dynamic_cast<const faiss::IndexScalarQuantizer*>(index);
+    }
+
+    // takes a deserialized index, which is to be a scalar quantizer with or without a refine
+    Status
+    SetIndex(std::unique_ptr<faiss::Index>&& index, const Config& cfg) {
+        if (GetSqIndex(index.get()) == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "The deserialized index does not look like a FLAT_SQ";
+            return Status::invalid_serialized_index_type;
+        }
+        const BaseConfig& base_cfg = static_cast<const BaseConfig&>(cfg);
+        is_cosine_ = base_cfg.metric_type.has_value() && IsMetricType(base_cfg.metric_type.value(), metric::COSINE);
+        index_ = std::move(index);
+        return Status::success;
+    }
+
+    std::unique_ptr<faiss::Index> index_;
+    bool is_cosine_ = false;
+    std::shared_ptr<ThreadPool> search_pool_;
+};
+
+KNOWHERE_MOCK_REGISTER_DENSE_FLOAT_ALL_GLOBAL(FLAT_SQ, FlatSqIndexNode,
+                                              knowhere::feature::KNN | knowhere::feature::MMAP);
+
+}  // namespace knowhere
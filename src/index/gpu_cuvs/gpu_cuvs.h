@@ -17,11 +17,17 @@
 #ifndef GPU_CUVS_H
 #define GPU_CUVS_H
 
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <exception>
 #include <fstream>
 #include <istream>
+#include <limits>
+#include <memory>
 #include <numeric>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -93,9 +99,18 @@ struct GpuCuvsIndexNode : public IndexNode {
             auto rows = dataset->GetRows();
             auto dim = dataset->GetDim();
             auto const* data = reinterpret_cast<const data_type*>(dataset->GetTensor());
+            const auto& knowhere_cfg = static_cast<const knowhere_config_type&>(*cfg);
+            const auto num_shards =
+                std::min<int64_t>(knowhere_cfg.num_shards.value(), cuvs_knowhere_index_type::device_count());
             try {
-                index_.train(cuvs_cfg, data, rows, dim);
-                index_.synchronize(true);
+                if (num_shards <= 1) {
+                    index_.train(cuvs_cfg, data, rows, dim);
+                    index_.synchronize(true);
+                } else if (knowhere_cfg.replicate.value()) {
+                    TrainReplicas(cuvs_cfg, data, rows, dim, num_shards);
+                } else {
+                    TrainShards(cuvs_cfg, data, rows, dim, num_shards);
+                }
             } catch (const std::exception& e) {
                 LOG_KNOWHERE_ERROR_ << e.what();
                 result = Status::cuvs_inner_error;
@@ -126,10 +141,22 @@ struct GpuCuvsIndexNode : public IndexNode {
                 auto rows = dataset->GetRows();
                 auto dim = dataset->GetDim();
                 auto const* data = reinterpret_cast<const data_type*>(dataset->GetTensor());
+                // the devices filter by bitmaps, so a bitset given by its valid ids is expanded first
+                auto bits = std::vector<uint8_t>{};
+                if (bitset.has_valid_ids()) {
+                    bits.resize(bitset.byte_size());
+                    bitset.copy_bits_to(bits.data());
+                }
+                const auto filter = bits.empty() ? bitset : BitsetView(bits.data(), bitset.size(), bitset.count());
+                if (IsSharded()) {
+                    return SearchShards(cuvs_cfg, data, rows, dim, filter);
+                }
+                // the replicas take the searches in turn
+                const auto& index = Shard(shards_.empty() ? 0 : next_replica_.fetch_add(1) % NumShards());
                 auto search_result =
-                    index_.search(cuvs_cfg, data, rows, dim, bitset.data(), bitset.byte_size(), bitset.size());
+                    index.search(cuvs_cfg, data, rows, dim, filter.data(), filter.byte_size(), filter.size());
                 std::this_thread::yield();
-                index_.synchronize();
+                index.synchronize();
                 return GenResultDataSet(rows, cuvs_cfg.k, std::get<0>(search_result), std::get<1>(search_result));
             } catch (const std::exception& e) {
                 err_msg = std::string{e.what()};
@@ -157,6 +184,9 @@ struct GpuCuvsIndexNode : public IndexNode {
 
     Status
     Serialize(BinarySet& binset) const override {
+        if (!shards_.empty()) {
+            return SerializeShards(binset);
+        }
         auto result = Status::success;
         std::stringbuf buf;
         if (!index_.is_trained()) {
@@ -183,6 +213,9 @@ struct GpuCuvsIndexNode : public IndexNode {
 
     Status
     Deserialize(const BinarySet& binset, std::shared_ptr<Config>) override {
+        if (binset.Contains(this->Type() + "_shards")) {
+            return DeserializeShards(binset);
+        }
         auto result = Status::success;
         std::stringbuf buf;
         auto binary = binset.GetByName(this->Type());
@@ -229,6 +262,9 @@ struct GpuCuvsIndexNode : public IndexNode {
 
     int64_t
     Count() const override {
+        if (IsSharded()) {
+            return shard_offsets_.back();
+        }
         return index_.size();
     }
 
@@ -248,7 +284,246 @@ struct GpuCuvsIndexNode : public IndexNode {
     using cuvs_knowhere_index_type = typename cuvs_knowhere::cuvs_knowhere_index<K, DataType>;
 
  protected:
+    // the index, or the first shard or replica of a multi-GPU index
     cuvs_knowhere_index_type index_;
+    // the other shards or replicas, one per device
+    std::vector<cuvs_knowhere_index_type> shards_;
+    // the first row of every shard, followed by the number of rows
+    std::vector<int64_t> shard_offsets_;
+    bool replicated_ = false;
+    mutable std::atomic<uint64_t> next_replica_{0};
+
+    bool
+    IsSharded() const {
+        return !shards_.empty() && !replicated_;
+    }
+
+    size_t
+    NumShards() const {
+        return shards_.size() + 1;
+    }
+
+    const cuvs_knowhere_index_type&
+    Shard(const size_t i) const {
+        return i == 0 ? index_ : shards_[i - 1];
+    }
+
+    // the number of data_type elements of a row
+    static int64_t
+    RowSize(const int64_t dim) {
+        return std::is_same_v<DataType, bin1> ? dim / 8 : dim;
+    }
+
+    // runs func(i) for every shard on a thread of its own, the shards are on different devices. The first exception
+    //   is rethrown once all the threads are done.
+    template <typename Func>
+    static void
+    ForEachShard(const size_t num_shards, Func&& func) {
+        std::vector<std::exception_ptr> errors(num_shards);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_shards; ++i) {
+            threads.emplace_back([&, i]() {
+                try {
+                    func(i);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // splits the rows into contiguous shards, the i-th one is built on device i, all in parallel. The shards start
+    //   at multiples of 8 rows, so that the bitset of a search is split into whole bytes.
+    void
+    TrainShards(const cuvs_knowhere::cuvs_knowhere_config& cuvs_cfg, const data_type* data, const int64_t rows,
+                const int64_t dim, const int64_t num_shards) {
+        const int64_t shard_rows = ((rows + num_shards - 1) / num_shards + 7) / 8 * 8;
+        std::vector<cuvs_knowhere_index_type> shards;
+        std::vector<int64_t> offsets;
+        for (int64_t begin = 0; begin < rows; begin += shard_rows) {
+            shards.emplace_back(static_cast<int>(shards.size()));
+            offsets.push_back(begin);
+        }
+        offsets.push_back(rows);
+        ForEachShard(shards.size(), [&](const size_t i) {
+            shards[i].train(cuvs_cfg, data + offsets[i] * RowSize(dim), offsets[i + 1] - offsets[i], dim);
+            shards[i].synchronize(true);
+        });
+        index_ = std::move(shards[0]);
+        shards_.clear();
+        for (size_t i = 1; i < shards.size(); ++i) {
+            shards_.push_back(std::move(shards[i]));
+        }
+        shard_offsets_ = std::move(offsets);
+        replicated_ = false;
+    }
+
+    // builds the index on device 0, and copies it to the devices [1, num_replicas) through the host.
+    void
+    TrainReplicas(const cuvs_knowhere::cuvs_knowhere_config& cuvs_cfg, const data_type* data, const int64_t rows,
+                  const int64_t dim, const int64_t num_replicas) {
+        auto index = cuvs_knowhere_index_type(0);
+        index.train(cuvs_cfg, data, rows, dim);
+        index.synchronize(true);
+        std::stringbuf buf;
+        std::ostream os(&buf);
+        index.serialize(os);
+        index.synchronize(true);
+        const auto binary = buf.str();
+        std::vector<cuvs_knowhere_index_type> replicas(num_replicas - 1);
+        ForEachShard(replicas.size(), [&](const size_t i) {
+            std::stringbuf replica_buf(binary);
+            std::istream is(&replica_buf);
+            replicas[i] = cuvs_knowhere_index_type::deserialize(is, static_cast<int>(i + 1));
+            replicas[i].synchronize(true);
+        });
+        index_ = std::move(index);
+        shards_ = std::move(replicas);
+        shard_offsets_ = {0, rows};
+        replicated_ = true;
+    }
+
+    // searches all the shards in parallel, each with its part of the bitset, and merges their top-k on the host.
+    expected<DataSetPtr>
+    SearchShards(const cuvs_knowhere::cuvs_knowhere_config& cuvs_cfg, const data_type* data, const int64_t rows,
+                 const int64_t dim, const BitsetView& bitset) const {
+        const auto num_shards = NumShards();
+        const int64_t k = cuvs_cfg.k;
+        std::vector<std::unique_ptr<knowhere_indexing_type[]>> shard_ids(num_shards);
+        std::vector<std::unique_ptr<knowhere_distance_type[]>> shard_distances(num_shards);
+        ForEachShard(num_shards, [&](const size_t i) {
+            const int64_t shard_rows = shard_offsets_[i + 1] - shard_offsets_[i];
+            const auto bitset_data = bitset.empty() ? nullptr : bitset.data() + shard_offsets_[i] / 8;
+            const int64_t bitset_size = bitset.empty() ? 0 : shard_rows;
+            auto [ids, distances] =
+                Shard(i).search(cuvs_cfg, data, rows, dim, bitset_data, (bitset_size + 7) / 8, bitset_size);
+            Shard(i).synchronize();
+            shard_ids[i].reset(ids);
+            shard_distances[i].reset(distances);
+        });
+
+        const bool larger_is_closer =
+            IsMetricType(cuvs_cfg.metric_type, metric::IP) || IsMetricType(cuvs_cfg.metric_type, metric::COSINE);
+        const auto invalid_distance = larger_is_closer ? -std::numeric_limits<knowhere_distance_type>::infinity()
+                                                       : std::numeric_limits<knowhere_distance_type>::infinity();
+        auto ids = std::make_unique<knowhere_indexing_type[]>(rows * k);
+        auto distances = std::make_unique<knowhere_distance_type[]>(rows * k);
+        std::vector<int64_t> cursors(num_shards);
+        for (int64_t q = 0; q < rows; ++q) {
+            // the results of every shard are sorted, with the invalid ones at the end
+            std::fill(cursors.begin(), cursors.end(), 0);
+            for (int64_t j = 0; j < k; ++j) {
+                int64_t best = -1;
+                for (size_t i = 0; i < num_shards; ++i) {
+                    const int64_t pos = q * k + cursors[i];
+                    if (cursors[i] == k || shard_ids[i][pos] < 0) {
+                        continue;
+                    }
+                    if (best < 0) {
+                        best = i;
+                        continue;
+                    }
+                    const auto distance = shard_distances[i][pos];
+                    const auto best_distance = shard_distances[best][q * k + cursors[best]];
+                    if (larger_is_closer ? distance > best_distance : distance < best_distance) {
+                        best = i;
+                    }
+                }
+                if (best < 0) {
+                    ids[q * k + j] = -1;
+                    distances[q * k + j] = invalid_distance;
+                    continue;
+                }
+                const int64_t pos = q * k + cursors[best]++;
+                ids[q * k + j] = shard_ids[best][pos] + shard_offsets_[best];
+                distances[q * k + j] = shard_distances[best][pos];
+            }
+        }
+        return GenResultDataSet(rows, k, std::move(ids), std::move(distances));
+    }
+
+    // a multi-GPU index is serialized as its shards, and a meta binary: whether it is replicated, the number of
+    //   shards, and the shard offsets. The replicas are a single binary, loaded on every device.
+    Status
+    SerializeShards(BinarySet& binset) const {
+        std::vector<int64_t> meta = {replicated_, static_cast<int64_t>(NumShards())};
+        meta.insert(meta.end(), shard_offsets_.begin(), shard_offsets_.end());
+        const auto num_binaries = replicated_ ? 1 : NumShards();
+        for (size_t i = 0; i < num_binaries; ++i) {
+            std::stringbuf buf;
+            std::ostream os(&buf);
+            try {
+                Shard(i).serialize(os);
+                Shard(i).synchronize(true);
+            } catch (const std::exception& e) {
+                LOG_KNOWHERE_ERROR_ << e.what();
+                return Status::cuvs_inner_error;
+            }
+            os.flush();
+            const auto binary = buf.str();
+            std::shared_ptr<uint8_t[]> index_binary(new uint8_t[binary.size()]);
+            memcpy(index_binary.get(), binary.data(), binary.size());
+            binset.Append(this->Type() + "_shard_" + std::to_string(i), index_binary, binary.size());
+        }
+        std::shared_ptr<uint8_t[]> meta_binary(new uint8_t[meta.size() * sizeof(int64_t)]);
+        memcpy(meta_binary.get(), meta.data(), meta.size() * sizeof(int64_t));
+        binset.Append(this->Type() + "_shards", meta_binary, meta.size() * sizeof(int64_t));
+        return Status::success;
+    }
+
+    // the shards are loaded on the devices in turn, and the replicas on as many devices as available.
+    Status
+    DeserializeShards(const BinarySet& binset) {
+        const auto meta_binary = binset.GetByName(this->Type() + "_shards");
+        const auto meta = reinterpret_cast<const int64_t*>(meta_binary->data.get());
+        const auto meta_size = meta_binary->size / sizeof(int64_t);
+        if (meta_size < 4 || meta[1] < 1 || meta_size != static_cast<size_t>(meta[0] != 0 ? 4 : meta[1] + 3)) {
+            LOG_KNOWHERE_ERROR_ << "Invalid binary set.";
+            return Status::invalid_binary_set;
+        }
+        const bool replicated = meta[0] != 0;
+        const int64_t num_binaries = replicated ? 1 : meta[1];
+        std::vector<BinaryPtr> binaries;
+        for (int64_t i = 0; i < num_binaries; ++i) {
+            binaries.push_back(binset.GetByName(this->Type() + "_shard_" + std::to_string(i)));
+            if (binaries.back() == nullptr) {
+                LOG_KNOWHERE_ERROR_ << "Invalid binary set.";
+                return Status::invalid_binary_set;
+            }
+        }
+        try {
+            const int device_count = cuvs_knowhere_index_type::device_count();
+            const int64_t num_shards = replicated ? std::min<int64_t>(meta[1], device_count) : meta[1];
+            std::vector<cuvs_knowhere_index_type> shards(num_shards);
+            ForEachShard(num_shards, [&](const size_t i) {
+                const auto& binary = binaries[replicated ? 0 : i];
+                std::stringbuf buf;
+                buf.sputn(reinterpret_cast<const char*>(binary->data.get()), binary->size);
+                std::istream is(&buf);
+                shards[i] = cuvs_knowhere_index_type::deserialize(is, static_cast<int>(i % device_count));
+                shards[i].synchronize(true);
+            });
+            index_ = std::move(shards[0]);
+            shards_.clear();
+            for (int64_t i = 1; i < num_shards; ++i) {
+                shards_.push_back(std::move(shards[i]));
+            }
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << e.what();
+            return Status::cuvs_inner_error;
+        }
+        shard_offsets_.assign(meta + 2, meta + meta_size);
+        replicated_ = replicated;
+        return Status::success;
+    }
 
     Status
     DeserializeFromStream(std::istream& stream) {
@@ -24,6 +24,20 @@
 namespace knowhere {
 
 struct GpuCuvsBruteForceConfig : public BaseConfig {
+    CFG_INT num_shards;
+    CFG_BOOL replicate;
+    KNOHWERE_DECLARE_CONFIG(GpuCuvsBruteForceConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(num_shards)
+            .description("the number of devices the rows are split across, or the index is replicated to")
+            .set_default(1)
+            .set_range(1, 64)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(replicate)
+            .description("replicate the index to num_shards devices for throughput, instead of splitting the rows")
+            .set_default(false)
+            .for_train();
+    }
+
     Status
     CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
         if (param_type == PARAM_TYPE::TRAIN) {
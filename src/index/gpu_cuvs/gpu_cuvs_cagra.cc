@@ -15,11 +15,23 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
 #include <vector>
 
 #include "common/cuvs/proto/cuvs_index_kind.hpp"
+#include "faiss/IndexCosine.h"
+#include "faiss/IndexHNSW.h"
+#include "faiss/index_io.h"
 #include "gpu_cuvs.h"
 #include "hnswlib/hnswalg.h"
+#include "index/hnsw/impl/HnswBulkBuilder.h"
+#include "io/index_binary.h"
+#include "io/memory_io.h"
+#include "knowhere/comp/task.h"
 #include "knowhere/dataset.h"
 #include "knowhere/index/index_factory.h"
 #include "knowhere/index/index_node_thread_pool_wrapper.h"
@@ -40,11 +52,24 @@ class GpuCuvsCagraHybridIndexNode : public GpuCuvsCagraIndexNode<DataType> {
         const GpuCuvsCagraConfig& cagra_cfg = static_cast<const GpuCuvsCagraConfig&>(*cfg);
         if (cagra_cfg.adapt_for_cpu.value())
             adapt_for_cpu = true;
-        return GpuCuvsCagraIndexNode<DataType>::Train(dataset, cfg, use_knowhere_build_pool);
+        if (cagra_cfg.export_to_hnsw.value()) {
+            export_to_hnsw = true;
+            // the candidates of a node of the upper levels are searched as widely as those of the CAGRA graph
+            hnsw_ef_construction = cagra_cfg.intermediate_graph_degree.value();
+        }
+        // a CPU only index has nothing to share with the GPU
+        co_search = cagra_cfg.co_search.value() && !adapt_for_cpu;
+        auto status = GpuCuvsCagraIndexNode<DataType>::Train(dataset, cfg, use_knowhere_build_pool);
+        if (status == Status::success && co_search) {
+            status = LoadCpuCopy();
+        }
+        return status;
     }
 
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        if (co_search && hnsw_index_ != nullptr)
+            return CoSearch(dataset, std::move(cfg), bitset);
         if (!adapt_for_cpu || hnsw_index_ == nullptr)
             return GpuCuvsCagraIndexNode<DataType>::Search(dataset, std::move(cfg), bitset);
         auto nq = dataset->GetRows();
@@ -56,28 +81,7 @@ class GpuCuvsCagraHybridIndexNode : public GpuCuvsCagraIndexNode<DataType> {
         auto p_id = std::make_unique<int64_t[]>(k * nq);
         auto p_dist = std::make_unique<DistType[]>(k * nq);
 
-        hnswlib::SearchParam param{(size_t)cagra_cfg.ef.value()};
-        bool transform = (hnsw_index_->metric_type_ == hnswlib::Metric::INNER_PRODUCT ||
-                          hnsw_index_->metric_type_ == hnswlib::Metric::COSINE);
-
-        for (int i = 0; i < nq; ++i) {
-            auto p_id_ptr = p_id.get();
-            auto p_dist_ptr = p_dist.get();
-            auto single_query = (const char*)xq + i * hnsw_index_->data_size_;
-            auto rst = hnsw_index_->searchKnn(single_query, k, bitset, &param);
-            size_t rst_size = rst.size();
-            auto p_single_dis = p_dist_ptr + i * k;
-            auto p_single_id = p_id_ptr + i * k;
-            for (size_t idx = 0; idx < rst_size; ++idx) {
-                const auto& [dist, id] = rst[idx];
-                p_single_dis[idx] = transform ? (-dist) : dist;
-                p_single_id[idx] = id;
-            }
-            for (size_t idx = rst_size; idx < (size_t)k; idx++) {
-                p_single_dis[idx] = DistType(1.0 / 0.0);
-                p_single_id[idx] = -1;
-            }
-        }
+        SearchOnCpu(xq, 0, nq, k, cagra_cfg.ef.value(), bitset, p_id.get(), p_dist.get());
 
         auto res = GenResultDataSet(nq, k, p_id.release(), p_dist.release());
 
@@ -85,6 +89,12 @@ class GpuCuvsCagraHybridIndexNode : public GpuCuvsCagraIndexNode<DataType> {
     }
     Status
     Serialize(BinarySet& binset) const override {
+        if ((export_to_hnsw || adapt_for_cpu) && this->IsSharded()) {
+            LOG_KNOWHERE_ERROR_ << "CPU search of a sharded CAGRA index is not supported.";
+            return Status::not_implemented;
+        }
+        if (export_to_hnsw)
+            return SerializeToHnsw(binset);
         if (!adapt_for_cpu)
             return GpuCuvsCagraIndexNode<DataType>::Serialize(binset);
         auto result = Status::success;
@@ -124,6 +134,11 @@ class GpuCuvsCagraHybridIndexNode : public GpuCuvsCagraIndexNode<DataType> {
     Status
     Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) override {
         const GpuCuvsCagraConfig& cagra_cfg = static_cast<const GpuCuvsCagraConfig&>(*cfg);
+        if (cagra_cfg.co_search.value() && !cagra_cfg.adapt_for_cpu.value()) {
+            co_search = true;
+            auto status = GpuCuvsCagraIndexNode<DataType>::Deserialize(binset, std::move(cfg));
+            return status == Status::success ? LoadCpuCopy() : status;
+        }
         if (cagra_cfg.adapt_for_cpu.value()) {
             adapt_for_cpu = true;
             if constexpr (std::is_same_v<DataType, std::int8_t>) {
@@ -165,8 +180,260 @@ class GpuCuvsCagraHybridIndexNode : public GpuCuvsCagraIndexNode<DataType> {
     }
 
  private:
+    // the initial costs of the cost model of CoSearch, in microseconds, until they are measured
+    static constexpr double kInitialGpuBatchUs = 2000.0;
+    static constexpr double kInitialCpuQueryUs = 1000.0;
+    // the weight of a new measure in the moving averages of the costs
+    static constexpr double kCostUpdateWeight = 0.125;
+
+    // searches the queries [begin, end) on the CPU copy, writes their k results at their offsets in ids and dists
+    void
+    SearchOnCpu(const void* xq, const int64_t begin, const int64_t end, const int64_t k, const size_t ef,
+                const BitsetView& bitset, int64_t* ids, DistType* dists) const {
+        hnswlib::SearchParam param{ef};
+        bool transform = (hnsw_index_->metric_type_ == hnswlib::Metric::INNER_PRODUCT ||
+                          hnsw_index_->metric_type_ == hnswlib::Metric::COSINE);
+
+        for (int64_t i = begin; i < end; ++i) {
+            auto single_query = (const char*)xq + i * hnsw_index_->data_size_;
+            auto rst = hnsw_index_->searchKnn(single_query, k, bitset, &param);
+            size_t rst_size = rst.size();
+            auto p_single_dis = dists + i * k;
+            auto p_single_id = ids + i * k;
+            for (size_t idx = 0; idx < rst_size; ++idx) {
+                const auto& [dist, id] = rst[idx];
+                p_single_dis[idx] = transform ? (-dist) : dist;
+                p_single_id[idx] = id;
+            }
+            for (size_t idx = rst_size; idx < (size_t)k; idx++) {
+                p_single_dis[idx] = DistType(1.0 / 0.0);
+                p_single_id[idx] = -1;
+            }
+        }
+    }
+
+    // keeps the CAGRA graph in memory as a base layer only HNSW index, next to the GPU index, for CoSearch
+    Status
+    LoadCpuCopy() {
+        if (this->IsSharded()) {
+            LOG_KNOWHERE_ERROR_ << "Co-search of a sharded CAGRA index is not supported.";
+            return Status::not_implemented;
+        }
+        std::stringbuf buf;
+        try {
+            std::ostream os(&buf);
+            this->index_.serialize_to_hnswlib(os);
+            this->index_.synchronize(true);
+            os.flush();
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << e.what();
+            return Status::cuvs_inner_error;
+        }
+        hnswlib::SpaceInterface<float>* space = nullptr;
+        auto hnsw_index = std::make_unique<hnswlib::HierarchicalNSW<DataType, float, hnswlib::None>>(space);
+        try {
+            std::string binary = buf.str();
+            MemoryIOReader reader(reinterpret_cast<uint8_t*>(binary.data()), binary.size());
+            hnsw_index->loadIndex(reader);
+            hnsw_index->base_layer_only = true;
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << "hnsw inner error: " << e.what();
+            return Status::hnsw_inner_error;
+        }
+        hnsw_index_ = std::move(hnsw_index);
+        return Status::success;
+    }
+
+    // the number of the last queries of a batch of nq to search on the CPU: those the search pool answers before the
+    //   GPU is done with the others. A GPU search is taken to cost the same time whatever its batch size, once per
+    //   GPU search in flight ahead of it, and a query on the CPU the same time on every thread of the search pool
+    //   that the co-searches in flight leave to it. So the small batches stay on the CPU, the large ones go to the
+    //   GPU but for the share of the CPU, which grows while the GPU is busy.
+    int64_t
+    CpuShare(const int64_t nq) const {
+        const double gpu_us = gpu_batch_us_.load() * (1 + gpu_in_flight_.load());
+        const double cpu_threads = std::max<double>(1.0, GetSearchThreadPoolSize()) / (1 + cpu_in_flight_.load());
+        const double n_cpu = gpu_us * cpu_threads / cpu_query_us_.load();
+        return n_cpu >= nq ? nq : static_cast<int64_t>(n_cpu);
+    }
+
+    static void
+    UpdateCost(std::atomic<double>& cost, const double measure) {
+        cost.store(cost.load() * (1 - kCostUpdateWeight) + measure * kCostUpdateWeight);
+    }
+
+    // splits a batch between the GPU index and its CPU copy (@see CpuShare), searched at the same time, the first
+    //   queries on the GPU and the others over the search thread pool
+    expected<DataSetPtr>
+    CoSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const {
+        using clock = std::chrono::steady_clock;
+        const auto nq = dataset->GetRows();
+        const auto dim = dataset->GetDim();
+        const auto xq = dataset->GetTensor();
+        const auto& cagra_cfg = static_cast<const GpuCuvsCagraConfig&>(*cfg);
+        const auto k = cagra_cfg.k.value();
+        const size_t ef = cagra_cfg.ef.value_or(cagra_cfg.itopk_size.value());
+
+        const int64_t n_cpu = CpuShare(nq);
+        const int64_t n_gpu = nq - n_cpu;
+        if (n_cpu == 0) {
+            const auto in_flight = gpu_in_flight_.fetch_add(1);
+            const auto start = clock::now();
+            auto res = GpuCuvsCagraIndexNode<DataType>::Search(dataset, std::move(cfg), bitset);
+            gpu_in_flight_.fetch_sub(1);
+            UpdateCost(gpu_batch_us_,
+                       std::chrono::duration<double, std::micro>(clock::now() - start).count() / (1 + in_flight));
+            return res;
+        }
+
+        auto p_id = std::make_unique<int64_t[]>(k * nq);
+        auto p_dist = std::make_unique<DistType[]>(k * nq);
+
+        std::future<expected<DataSetPtr>> gpu_res;
+        if (n_gpu > 0) {
+            auto gpu_dataset = GenDataSet(n_gpu, dim, xq);
+            gpu_res = std::async(std::launch::async, [this, gpu_dataset, cfg = std::move(cfg), &bitset]() mutable {
+                const auto in_flight = gpu_in_flight_.fetch_add(1);
+                const auto start = clock::now();
+                auto res = GpuCuvsCagraIndexNode<DataType>::Search(gpu_dataset, std::move(cfg), bitset);
+                gpu_in_flight_.fetch_sub(1);
+                UpdateCost(gpu_batch_us_,
+                           std::chrono::duration<double, std::micro>(clock::now() - start).count() / (1 + in_flight));
+                return res;
+            });
+        }
+
+        const auto in_flight = cpu_in_flight_.fetch_add(1);
+        const auto start = clock::now();
+        try {
+            ParallelForOverSearchThreadPool(n_cpu, ef * dim, [&](size_t begin, size_t end) {
+                SearchOnCpu(xq, n_gpu + begin, n_gpu + end, k, ef, bitset, p_id.get(), p_dist.get());
+            });
+        } catch (const std::exception& e) {
+            cpu_in_flight_.fetch_sub(1);
+            if (gpu_res.valid()) {
+                gpu_res.wait();
+            }
+            LOG_KNOWHERE_WARNING_ << "hnsw inner error: " << e.what();
+            return expected<DataSetPtr>::Err(Status::hnsw_inner_error, e.what());
+        }
+        cpu_in_flight_.fetch_sub(1);
+        // the time of a query on a thread, out of the threads the search had
+        const double cpu_threads = std::max<double>(1.0, GetSearchThreadPoolSize()) / (1 + in_flight);
+        UpdateCost(cpu_query_us_, std::chrono::duration<double, std::micro>(clock::now() - start).count() *
+                                      std::min<double>(cpu_threads, n_cpu) / n_cpu);
+
+        if (n_gpu > 0) {
+            auto res = gpu_res.get();
+            if (!res.has_value()) {
+                return res;
+            }
+            std::copy_n(res.value()->GetIds(), n_gpu * k, p_id.get());
+            std::copy_n(res.value()->GetDistance(), n_gpu * k, p_dist.get());
+        }
+        return GenResultDataSet(nq, k, p_id.release(), p_dist.release());
+    }
+
+    // Serializes the index as an HNSW index of the CPU HNSW index node, so that it is built on GPU and served on CPU.
+    // Level 0 is the CAGRA graph, with M = graph_degree / 2, and only the upper levels are built on CPU.
+    Status
+    SerializeToHnsw(BinarySet& binset) const {
+        if constexpr (!std::is_same_v<DataType, fp32> && !std::is_same_v<DataType, fp16> &&
+                      !std::is_same_v<DataType, bf16>) {
+            LOG_KNOWHERE_ERROR_ << "CAGRA to HNSW export only supports float data.";
+            return Status::not_implemented;
+        } else {
+            if (!this->index_.is_trained()) {
+                return Status::empty_index;
+            }
+            // the graph and the vectors are taken from the hnswlib format of the CAGRA index
+            std::stringbuf buf;
+            try {
+                std::ostream os(&buf);
+                this->index_.serialize_to_hnswlib(os);
+                this->index_.synchronize(true);
+                os.flush();
+            } catch (const std::exception& e) {
+                LOG_KNOWHERE_ERROR_ << e.what();
+                return Status::cuvs_inner_error;
+            }
+            hnswlib::SpaceInterface<float>* space = nullptr;
+            hnswlib::HierarchicalNSW<DataType, float, hnswlib::None> cagra(space);
+            std::string cagra_binary = buf.str();
+            try {
+                MemoryIOReader reader(reinterpret_cast<uint8_t*>(cagra_binary.data()), cagra_binary.size());
+                cagra.loadIndex(reader);
+            } catch (const std::exception& e) {
+                LOG_KNOWHERE_ERROR_ << "hnsw inner error: " << e.what();
+                return Status::hnsw_inner_error;
+            }
+            cagra_binary = std::string();
+
+            const int64_t rows = cagra.cur_element_count;
+            const int64_t dim = cagra.data_size_ / sizeof(DataType);
+            const size_t degree = cagra.maxM0_;
+            const int m = std::max<int>(1, degree / 2);
+            // fp16 and bf16 are stored as they are
+            const auto qtype =
+                std::is_same_v<DataType, fp16> ? faiss::ScalarQuantizer::QT_fp16 : faiss::ScalarQuantizer::QT_bf16;
+            std::unique_ptr<faiss::IndexHNSW> hnsw_index;
+            if (cagra.metric_type_ == hnswlib::Metric::COSINE) {
+                if constexpr (std::is_same_v<DataType, fp32>) {
+                    hnsw_index = std::make_unique<faiss::IndexHNSWFlatCosine>(dim, m);
+                } else {
+                    hnsw_index = std::make_unique<faiss::IndexHNSWSQCosine>(dim, qtype, m);
+                }
+            } else if (cagra.metric_type_ == hnswlib::Metric::L2 ||
+                       cagra.metric_type_ == hnswlib::Metric::INNER_PRODUCT) {
+                const auto metric =
+                    cagra.metric_type_ == hnswlib::Metric::L2 ? faiss::METRIC_L2 : faiss::METRIC_INNER_PRODUCT;
+                if constexpr (std::is_same_v<DataType, fp32>) {
+                    hnsw_index = std::make_unique<faiss::IndexHNSWFlat>(dim, m, metric);
+                } else {
+                    hnsw_index = std::make_unique<faiss::IndexHNSWSQ>(dim, qtype, m, metric);
+                }
+            } else {
+                LOG_KNOWHERE_ERROR_ << "CAGRA to HNSW export does not support the metric of the index.";
+                return Status::invalid_metric_type;
+            }
+            hnsw_index->hnsw.efConstruction = hnsw_ef_construction;
+
+            // the internal ids of the hnswlib format are the row ids
+            std::vector<float> data(rows * dim);
+            std::vector<int64_t> graph(rows * degree, -1);
+            for (int64_t i = 0; i < rows; ++i) {
+                const auto vec = reinterpret_cast<const DataType*>(cagra.getDataByInternalId(i));
+                std::transform(vec, vec + dim, data.data() + i * dim, [](const DataType v) { return float(v); });
+                const auto list = cagra.get_linklist0(i);
+                const size_t size = std::min<size_t>(cagra.getListCount(list), degree);
+                const auto neighbors = reinterpret_cast<const hnswlib::tableint*>(list + 1);
+                std::copy(neighbors, neighbors + size, graph.begin() + i * degree);
+            }
+
+            try {
+                hnsw_index->train(rows, data.data());
+                hnsw_index->storage->add(rows, data.data());
+                hnsw_build_from_base_graph(*hnsw_index, graph.data(), degree);
+                AppendIndexBinary(binset, IndexEnum::INDEX_HNSW, this->version_,
+                                  [&](faiss::IOWriter* writer) { faiss::write_index(hnsw_index.get(), writer); });
+            } catch (const std::exception& e) {
+                LOG_KNOWHERE_ERROR_ << "faiss inner error: " << e.what();
+                return Status::faiss_inner_error;
+            }
+            return Status::success;
+        }
+    }
+
     bool adapt_for_cpu = false;
+    bool export_to_hnsw = false;
+    bool co_search = false;
+    int hnsw_ef_construction = 0;
     std::unique_ptr<hnswlib::HierarchicalNSW<DataType, float, hnswlib::None>> hnsw_index_ = nullptr;
+    // the cost model of CoSearch, learned from the searches, and the searches in flight on either side
+    mutable std::atomic<double> gpu_batch_us_{kInitialGpuBatchUs};
+    mutable std::atomic<double> cpu_query_us_{kInitialCpuQueryUs};
+    mutable std::atomic<int64_t> gpu_in_flight_{0};
+    mutable std::atomic<int64_t> cpu_in_flight_{0};
 };
 
 KNOWHERE_REGISTER_GLOBAL_WITH_THREAD_POOL(GPU_CUVS_CAGRA, GpuCuvsCagraHybridIndexNode, fp32,
@@ -48,8 +48,12 @@ struct GpuCuvsCagraConfig : public BaseConfig {
     CFG_FLOAT hashmap_max_fill_rate;
     CFG_INT nn_descent_niter;
     CFG_BOOL adapt_for_cpu;
+    CFG_BOOL export_to_hnsw;
     CFG_INT ef;
     CFG_BOOL persistent;
+    CFG_INT num_shards;
+    CFG_BOOL replicate;
+    CFG_BOOL co_search;
 
     KNOHWERE_DECLARE_CONFIG(GpuCuvsCagraConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(cache_dataset_on_device)
@@ -115,6 +119,10 @@ struct GpuCuvsCagraConfig : public BaseConfig {
             .set_default(false)
             .for_train()
             .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(export_to_hnsw)
+            .description("serialize as an HNSW index for the CPU HNSW index, with the CAGRA graph as its level 0")
+            .set_default(false)
+            .for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(ef)
             .description("hnsw ef")
             .allow_empty_without_default()
@@ -124,6 +132,20 @@ struct GpuCuvsCagraConfig : public BaseConfig {
             .description("use the persistent version of the search kernel (only supported with SINGLE_CTA)")
             .set_default(false)
             .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(num_shards)
+            .description("the number of devices the rows are split across, or the index is replicated to")
+            .set_default(1)
+            .set_range(1, 64)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(replicate)
+            .description("replicate the index to num_shards devices for throughput, instead of splitting the rows")
+            .set_default(false)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(co_search)
+            .description("keep a CPU copy of the graph next to the GPU index, and split the searches between them")
+            .set_default(false)
+            .for_train()
+            .for_deserialize();
     }
 
     Status
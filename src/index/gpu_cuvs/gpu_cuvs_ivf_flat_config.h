@@ -30,6 +30,8 @@ struct GpuCuvsIvfFlatConfig : public IvfFlatConfig {
     CFG_INT kmeans_n_iters;
     CFG_FLOAT kmeans_trainset_fraction;
     CFG_BOOL adaptive_centers;
+    CFG_INT num_shards;
+    CFG_BOOL replicate;
     KNOHWERE_DECLARE_CONFIG(GpuCuvsIvfFlatConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(cache_dataset_on_device)
             .set_default(false)
@@ -56,6 +58,15 @@ struct GpuCuvsIvfFlatConfig : public IvfFlatConfig {
             .description("update centroids with new data")
             .set_default(false)
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(num_shards)
+            .description("the number of devices the rows are split across, or the index is replicated to")
+            .set_default(1)
+            .set_range(1, 64)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(replicate)
+            .description("replicate the index to num_shards devices for throughput, instead of splitting the rows")
+            .set_default(false)
+            .for_train();
     }
 
     Status
@@ -36,6 +36,8 @@ struct GpuCuvsIvfPqConfig : public IvfPqConfig {
     CFG_STRING lut_dtype;
     CFG_STRING internal_distance_dtype;
     CFG_FLOAT preferred_shmem_carveout;
+    CFG_INT num_shards;
+    CFG_BOOL replicate;
 
     KNOHWERE_DECLARE_CONFIG(GpuCuvsIvfPqConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(cache_dataset_on_device)
@@ -91,6 +93,15 @@ struct GpuCuvsIvfPqConfig : public IvfPqConfig {
             .set_range(0.0f, 1.0f)
             .set_default(1.0f)
             .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(num_shards)
+            .description("the number of devices the rows are split across, or the index is replicated to")
+            .set_default(1)
+            .set_range(1, 64)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(replicate)
+            .description("replicate the index to num_shards devices for throughput, instead of splitting the rows")
+            .set_default(false)
+            .for_train();
     }
 
     Status
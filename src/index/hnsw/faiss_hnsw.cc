@@ -11,9 +11,10 @@
 
 #include <faiss/cppcontrib/knowhere/impl/CountSizeIOWriter.h>
 #include <faiss/cppcontrib/knowhere/impl/HnswSearcher.h>
-#include <faiss/cppcontrib/knowhere/utils/Bitset.h>
+#include <faiss/cppcontrib/knowhere/utils/VisitedSet.h>
 #include <faiss/utils/Heap.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -21,31 +22,49 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <typeinfo>
 
 #include "common/metric.h"
+#include "faiss/Clustering.h"
 #include "faiss/IndexBinaryHNSW.h"
+#include "faiss/IndexFlat.h"
 #include "faiss/IndexCosine.h"
 #include "faiss/IndexHNSW.h"
+#include "faiss/IndexNonUniformSQ.h"
+#include "faiss/IndexPreTransform.h"
+#include "faiss/IndexRaBitQ.h"
 #include "faiss/IndexRefine.h"
 #include "faiss/impl/ScalarQuantizer.h"
-#include "faiss/impl/mapped_io.h"
+#include "faiss/impl/io.h"
 #include "faiss/index_io.h"
+#include "index/huge_page_index.h"
+#include "index/index_memory_report.h"
+#include "index/index_warmup.h"
 #include "index/hnsw/faiss_hnsw_config.h"
 #include "index/hnsw/hnsw.h"
 #include "index/hnsw/impl/DummyVisitor.h"
 #include "index/hnsw/impl/FederVisitor.h"
+#include "index/hnsw/impl/HnswBulkBuilder.h"
+#include "index/hnsw/impl/HnswEntryPoints.h"
+#include "index/hnsw/impl/HnswGraphRepair.h"
+#include "index/hnsw/impl/HnswInlineLayout.h"
+#include "index/hnsw/impl/HnswLazyLoader.h"
 #include "index/hnsw/impl/IndexBruteForceWrapper.h"
 #include "index/hnsw/impl/IndexConditionalWrapper.h"
 #include "index/hnsw/impl/IndexHNSWWrapper.h"
 #include "index/hnsw/impl/IndexWrapperCosine.h"
 #include "index/refine/refine_utils.h"
+#include "io/index_binary.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview_idselector.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/numa.h"
 #include "knowhere/comp/task.h"
 #include "knowhere/comp/time_recorder.h"
+#include "knowhere/comp/workspace.h"
 #include "knowhere/config.h"
 #include "knowhere/expected.h"
 #include "knowhere/index/index_factory.h"
@@ -179,23 +198,23 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
         }
 
         try {
-            MemoryIOWriter writer;
-            if (indexes.size() > 1) {
-                // this is a hack for compatibility, faiss index has 4-byte header to indicate index category
-                // create a new one to distinguish MV faiss hnsw from faiss hnsw
-                faiss::write_mv(&writer);
-                writeHeader(&writer);
-                for (const auto& index : indexes) {
-                    faiss::write_index(index.get(), &writer);
-                }
+            AppendIndexBinary(binset, Type(), this->version_, [&](faiss::IOWriter* writer) { writeIndex(writer); });
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return Status::faiss_inner_error;
+        }
 
-                std::shared_ptr<uint8_t[]> data(writer.data());
-                binset.Append(Type(), data, writer.tellg());
-            } else {
-                faiss::write_index(indexes[0].get(), &writer);
-                std::shared_ptr<uint8_t[]> data(writer.data());
-                binset.Append(Type(), data, writer.tellg());
-            }
+        return Status::success;
+    }
+
+    Status
+    SerializeToFile(const std::string& filename) const override {
+        if (isIndexEmpty()) {
+            return Status::empty_index;
+        }
+
+        try {
+            WriteIndexFile(filename, Type(), this->version_, [&](faiss::IOWriter* writer) { writeIndex(writer); });
         } catch (const std::exception& e) {
             LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
             return Status::faiss_inner_error;
@@ -212,25 +231,32 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
             return Status::invalid_binary_set;
         }
 
-        MemoryIOReader reader(binary->data.get(), binary->size);
+        // the index is read from the binary, or as views of its data, or decompressed
+        const bool zero_copy = static_cast<const BaseConfig&>(*config).enable_zero_copy.value();
+        auto make_reader = [&]() { return MakeIndexBinaryReader(binary, this->version_, Type(), zero_copy); };
+        std::unique_ptr<faiss::IOReader> reader;
         try {
+            reader = make_reader();
             // this is a hack for compatibility, faiss index has 4-byte header to indicate index category
             // create a new one to distinguish MV faiss hnsw from faiss hnsw
-            bool is_mv = faiss::read_is_mv(&reader);
+            bool is_mv = faiss::read_is_mv(reader.get());
             if (is_mv) {
                 LOG_KNOWHERE_INFO_ << "start to load index by mv";
-                uint32_t v = readHeader(&reader);
+                uint32_t v = readHeader(reader.get());
                 indexes.resize(v);
                 LOG_KNOWHERE_INFO_ << "read " << v << " mvs";
                 for (auto i = 0; i < v; ++i) {
-                    auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(&reader));
+                    auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get()));
                     indexes[i].reset(read_index.release());
                 }
             } else {
-                reader.reset();
-                auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(&reader));
+                reader = make_reader();
+                auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get()));
                 indexes[0].reset(read_index.release());
             }
+            for (const auto& index : indexes) {
+                BackIndexWithHugePages(index.get(), zero_copy);
+            }
         } catch (const std::exception& e) {
             if (is_faiss_fourcc_error(e.what())) {
                 LOG_KNOWHERE_WARNING_ << "faiss does not recognize the input index: " << e.what();
@@ -253,35 +279,33 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
             io_flags |= faiss::IO_FLAG_MMAP_IFC;
         }
 
+        // the index is read from the file, or mapped, or decompressed
+        auto make_reader = [&]() { return OpenIndexFile(filename, this->version_, Type(), io_flags); };
         try {
+            auto reader = make_reader();
             // this is a hack for compatibility, faiss index has 4-byte header to indicate index category
             // create a new one to distinguish MV faiss hnsw from faiss hnsw
-            bool is_mv = faiss::read_is_mv(filename.data());
+            bool is_mv = faiss::read_is_mv(reader.get());
             if (is_mv) {
-                auto read_index = [&](faiss::IOReader* r) {
-                    LOG_KNOWHERE_INFO_ << "start to load index by mv";
-                    read_is_mv(r);
-                    uint32_t v = readHeader(r);
-                    LOG_KNOWHERE_INFO_ << "read " << v << " mvs";
-                    indexes.resize(v);
-                    for (auto i = 0; i < v; ++i) {
-                        auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(r, io_flags));
-                        indexes[i].reset(read_index.release());
-                    }
-                };
-                if ((io_flags & faiss::IO_FLAG_MMAP_IFC) == faiss::IO_FLAG_MMAP_IFC) {
-                    // enable mmap-supporting IOReader
-                    auto owner = std::make_shared<faiss::MmappedFileMappingOwner>(filename.data());
-                    faiss::MappedFileIOReader reader(owner);
-                    read_index(&reader);
-                } else {
-                    faiss::FileIOReader reader(filename.data());
-                    read_index(&reader);
+                LOG_KNOWHERE_INFO_ << "start to load index by mv";
+                uint32_t v = readHeader(reader.get());
+                LOG_KNOWHERE_INFO_ << "read " << v << " mvs";
+                indexes.resize(v);
+                for (auto i = 0; i < v; ++i) {
+                    auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get(), io_flags));
+                    indexes[i].reset(read_index.release());
                 }
             } else {
-                auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(filename.data(), io_flags));
+                reader = make_reader();
+                auto read_index = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get(), io_flags));
                 indexes[0].reset(read_index.release());
             }
+            for (const auto& index : indexes) {
+                BackIndexWithHugePages(index.get(), cfg.enable_mmap.value());
+                if (cfg.enable_mmap.value()) {
+                    AdviseMappedAccess(index.get());
+                }
+            }
         } catch (const std::exception& e) {
             if (is_faiss_fourcc_error(e.what())) {
                 LOG_KNOWHERE_WARNING_ << "faiss does not recognize the input index: " << e.what();
@@ -295,6 +319,22 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
         return Status::success;
     }
 
+    Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) override {
+        if (isIndexEmpty()) {
+            return Status::empty_index;
+        }
+        return WarmupRanges(getMappedRanges(level), progress);
+    }
+
+    Status
+    Cooldown() override {
+        if (isIndexEmpty()) {
+            return Status::empty_index;
+        }
+        return CooldownRanges(getMappedRanges(WarmupLevel::FULL));
+    }
+
     //
     int64_t
     Dim() const override {
@@ -335,11 +375,26 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
         return writer.total_size;
     }
 
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        MemoryReport report;
+        for (const auto& index : indexes) {
+            ReportIndexMemory(index.get(), report);
+        }
+        for (const auto& index_labels : labels) {
+            report.AddHeap(MemoryComponent::ID_MAP, index_labels->capacity() * sizeof(uint32_t));
+        }
+        for (const auto* ids : {&index_rows_sum, &label_to_internal_offset, &internal_offset_to_most_external_id}) {
+            report.AddHeap(MemoryComponent::ID_MAP, ids->capacity() * sizeof(uint32_t));
+        }
+        return report;
+    }
+
     std::shared_ptr<std::vector<uint32_t>>
     GetInternalIdToExternalIdMap() const override {
         auto internal_offset_to_label = std::make_shared<std::vector<uint32_t>>();
         assert(indexes.size() > 0);
-        if (indexes.size() == 1) {
+        if (labels.empty()) {
             // without mv-only labels, the id mapping is the same as the internal offset.
             internal_offset_to_label->resize(Count());
             std::iota(internal_offset_to_label->begin(), internal_offset_to_label->end(), 0);
@@ -368,6 +423,31 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
     }
 
  protected:
+    void
+    writeIndex(faiss::IOWriter* writer) const {
+        if (!labels.empty()) {
+            // this is a hack for compatibility, faiss index has 4-byte header to indicate index category
+            // create a new one to distinguish MV faiss hnsw from faiss hnsw
+            faiss::write_mv(writer);
+            writeHeader(writer);
+            for (const auto& index : indexes) {
+                faiss::write_index(index.get(), writer);
+            }
+        } else {
+            faiss::write_index(indexes[0].get(), writer);
+        }
+    }
+
+    std::vector<MemoryRange>
+    getMappedRanges(WarmupLevel level) const {
+        std::vector<MemoryRange> ranges;
+        for (const auto& index : indexes) {
+            auto index_ranges = GetMappedRanges(index.get(), level);
+            ranges.insert(ranges.end(), index_ranges.begin(), index_ranges.end());
+        }
+        return ranges;
+    }
+
     // it is std::shared_ptr, not std::unique_ptr, because it can be
     //    shared with FaissHnswIterator
     std::vector<std::shared_ptr<faiss::Index>> indexes;
@@ -380,6 +460,9 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
     std::vector<uint32_t> label_to_internal_offset;
     // internal offset to most external id, only for 1-hop bitset check
     std::vector<uint32_t> internal_offset_to_most_external_id;
+    // whether the indexes are the shards of a single set of rows (@see FaissHnswConfig::shards), which are all
+    // searched, rather than the partitions of a partition key
+    bool sharded = false;
 
     int
     getIndexToSearchByScalarInfo(const BitsetView& bitset) const {
@@ -408,10 +491,80 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
         return std::distance(index_rows_sum.begin(), it) - 1;
     }
 
+    // the index whose rows hold the internal offset
+    int
+    getIndexByInternalOffset(const uint32_t offset) const {
+        auto it = std::upper_bound(index_rows_sum.begin(), index_rows_sum.end(), offset);
+        return std::distance(index_rows_sum.begin(), it) - 1;
+    }
+
+    // the partitions that hold a valid id of bitset, with the number of their valid ids. A pure AND expression without
+    // NOT that touches a single category of the partition key (the only field of mv_info, as set for the partitioned
+    // segments) is routed to the partition of its first valid id, as before; any other expression may touch several
+    // categories, and every partition that holds one of its valid ids is searched. Returns an empty vector if the
+    // partition key value is not set.
+    std::vector<std::pair<int, size_t>>
+    getIndexesToSearchByScalarInfo(const BitsetView& bitset,
+                                   const std::optional<MaterializedViewSearchInfo>& mv_info) const {
+        const size_t num_valid = bitset.size() - bitset.count();
+        if (indexes.size() == 1 || (!bitset.empty() && num_valid == 0)) {
+            return {{0, num_valid}};
+        }
+        const bool single_category = mv_info.has_value() && mv_info->is_pure_and && !mv_info->has_not &&
+                                     mv_info->field_id_to_touched_categories_cnt.size() == 1 &&
+                                     mv_info->field_id_to_touched_categories_cnt.begin()->second == 1;
+        if (sharded && bitset.empty()) {
+            std::vector<std::pair<int, size_t>> index_ids;
+            for (size_t p = 0; p < indexes.size(); p++) {
+                index_ids.emplace_back(p, index_rows_sum[p + 1] - index_rows_sum[p]);
+            }
+            return index_ids;
+        }
+        if (!sharded && (bitset.empty() || single_category)) {
+            auto index_id = getIndexToSearchByScalarInfo(bitset);
+            return index_id < 0 ? std::vector<std::pair<int, size_t>>{}
+                                : std::vector<std::pair<int, size_t>>{{index_id, num_valid}};
+        }
+
+        const size_t num_partitions = indexes.size();
+        std::vector<size_t> partition_valid(num_partitions, 0);
+        if (bitset.has_out_ids()) {
+            // the internal offsets of a partition are contiguous
+            for (size_t p = 0; p < num_partitions; p++) {
+                for (size_t i = bitset.get_next_valid_index(index_rows_sum[p]); i < index_rows_sum[p + 1];
+                     i = bitset.get_next_valid_index(i + 1)) {
+                    partition_valid[p]++;
+                }
+            }
+        } else {
+            for (size_t label = bitset.get_first_valid_index(); label < bitset.size();
+                 label = bitset.get_next_valid_index(label + 1)) {
+                auto it =
+                    std::upper_bound(index_rows_sum.begin(), index_rows_sum.end(), label_to_internal_offset[label]);
+                const size_t p = std::distance(index_rows_sum.begin(), it) - 1;
+                if (p < num_partitions) {
+                    partition_valid[p]++;
+                }
+            }
+        }
+        std::vector<std::pair<int, size_t>> index_ids;
+        for (size_t p = 0; p < num_partitions; p++) {
+            if (partition_valid[p] > 0) {
+                index_ids.emplace_back(p, partition_valid[p]);
+            }
+        }
+        return index_ids;
+    }
+
+    // the header of the sharded indexes has version 1, which is followed by the sharded flag
     void
     writeHeader(faiss::IOWriter* f) const {
-        uint32_t version = 0;
+        uint32_t version = sharded ? 1 : 0;
         faiss::write_value(version, f);
+        if (sharded) {
+            uint32_t is_sharded = 1;
+            faiss::write_value(is_sharded, f);
+        }
         uint32_t size = indexes.size();
         faiss::write_value(size, f);
         uint32_t cluster_size = labels.size();
@@ -425,7 +578,12 @@ class BaseFaissRegularIndexNode : public BaseFaissIndexNode {
 
     uint32_t
     readHeader(faiss::IOReader* f) {
-        [[maybe_unused]] uint32_t version = faiss::read_value(f);
+        uint32_t version = faiss::read_value(f);
+        sharded = false;
+        if (version >= 1) {
+            uint32_t is_sharded = faiss::read_value(f);
+            sharded = is_sharded != 0;
+        }
         uint32_t size = faiss::read_value(f);
         uint32_t cluster_size = faiss::read_value(f);
         labels.resize(cluster_size);
@@ -647,6 +805,39 @@ add_partial_dataset_to_index(faiss::Index* const __restrict index, const DataSet
     return Status::success;
 }
 
+// adds rows to an hnsw index, possibly wrapped by a refine, add_rows(dst) adds them to a given faiss index. With
+// bulk_build, the rows of an empty index are only added to its storages, and its graph is built at once by
+// hnsw_bulk_build(). Otherwise, add_rows() inserts them into the graph one by one.
+template <typename AddRows>
+Status
+add_to_hnsw_index(faiss::Index* const index, const bool bulk_build, AddRows&& add_rows) {
+    if (!bulk_build) {
+        return add_rows(index);
+    }
+    auto index_refine = dynamic_cast<faiss::IndexRefine*>(index);
+    auto index_hnsw = dynamic_cast<faiss::IndexHNSW*>(index_refine != nullptr ? index_refine->base_index : index);
+    if (index_hnsw == nullptr || index_hnsw->storage == nullptr || index_hnsw->ntotal != 0) {
+        LOG_KNOWHERE_INFO_ << "HNSW Index can not be bulk-built, inserting the rows one by one";
+        return add_rows(index);
+    }
+
+    auto status = add_rows(index_hnsw->storage);
+    if (status != Status::success) {
+        return status;
+    }
+    if (index_refine != nullptr) {
+        status = add_rows(index_refine->refine_index);
+        if (status != Status::success) {
+            return status;
+        }
+    }
+    hnsw_bulk_build(*index_hnsw);
+    if (index_refine != nullptr) {
+        index_refine->ntotal = index_hnsw->ntotal;
+    }
+    return Status::success;
+}
+
 // IndexFlat and IndexFlatCosine contain raw fp32 data
 // IndexScalarQuantizer and IndexScalarQuantizerCosine may contain rar bf16 and fp16 data
 //
@@ -734,6 +925,347 @@ combine_partitions(const std::vector<std::vector<uint32_t>>& scalar_info, const
     return res;
 }
 
+// the rows of a shard of a sharded build, at least
+constexpr int64_t kHnswMinShardRows = 256;
+
+// splits the rows into num_shards shards of sorted row ids: at random, or by the nearest of the k-means centroids of
+// a sample of the rows. The empty shards are dropped. Returns an empty vector for an unsupported data format.
+std::vector<std::vector<uint32_t>>
+shard_rows(const void* data, const DataFormatEnum data_format, const int64_t rows, const int64_t dim,
+           const int64_t num_shards, const bool clustered) {
+    std::vector<uint32_t> ids(rows);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::mt19937 rng(42);
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    std::vector<std::vector<uint32_t>> shards(num_shards);
+    if (!clustered) {
+        for (int64_t i = 0; i < rows; i++) {
+            shards[i % num_shards].push_back(ids[i]);
+        }
+    } else {
+        // the centroids are trained on a random sample of the rows, as many as k-means uses anyway
+        const int64_t n_sample = std::min<int64_t>(rows, num_shards * 256);
+        std::vector<uint32_t> sample_ids(ids.begin(), ids.begin() + n_sample);
+        std::sort(sample_ids.begin(), sample_ids.end());
+        std::vector<float> sample(n_sample * dim);
+        if (!convert_rows_to_fp32(data, sample.data(), data_format, sample_ids.data(), n_sample, dim)) {
+            return {};
+        }
+        std::vector<float> centroids(num_shards * dim);
+        faiss::kmeans_clustering(dim, n_sample, num_shards, sample.data(), centroids.data());
+
+        faiss::IndexFlatL2 quantizer(dim);
+        quantizer.add(num_shards, centroids.data());
+        constexpr int64_t kAssignBlockRows = 65536;
+        std::vector<float> block(std::min(rows, kAssignBlockRows) * dim);
+        std::vector<faiss::idx_t> assignment(std::min(rows, kAssignBlockRows));
+        for (int64_t start = 0; start < rows; start += kAssignBlockRows) {
+            const int64_t n = std::min(rows - start, kAssignBlockRows);
+            if (!convert_rows_to_fp32(data, block.data(), data_format, start, n, dim)) {
+                return {};
+            }
+            quantizer.assign(n, block.data(), assignment.data());
+            for (int64_t i = 0; i < n; i++) {
+                shards[assignment[i]].push_back(start + i);
+            }
+        }
+    }
+
+    shards.erase(std::remove_if(shards.begin(), shards.end(), [](const auto& shard) { return shard.empty(); }),
+                 shards.end());
+    for (auto& shard : shards) {
+        std::sort(shard.begin(), shard.end());
+    }
+    return shards;
+}
+
+// returns the nodes of the graph in the BFS order of its bottom layer, starting from the entry point. The nodes that
+// are not reachable from it start a new BFS in their original order. perm[new_id] = old_id.
+std::vector<faiss::idx_t>
+bfs_graph_order(const faiss::HNSW& hnsw) {
+    const faiss::idx_t ntotal = hnsw.levels.size();
+    std::vector<faiss::idx_t> perm;
+    perm.reserve(ntotal);
+    std::vector<bool> visited(ntotal, false);
+    auto bfs = [&](faiss::idx_t start) {
+        size_t head = perm.size();
+        visited[start] = true;
+        perm.push_back(start);
+        while (head < perm.size()) {
+            size_t begin, end;
+            hnsw.neighbor_range(perm[head++], 0, &begin, &end);
+            for (size_t j = begin; j < end; ++j) {
+                const faiss::idx_t neighbor = hnsw.neighbors[j];
+                if (neighbor < 0) {
+                    break;
+                }
+                if (!visited[neighbor]) {
+                    visited[neighbor] = true;
+                    perm.push_back(neighbor);
+                }
+            }
+        }
+    };
+    if (hnsw.entry_point >= 0) {
+        bfs(hnsw.entry_point);
+    }
+    for (faiss::idx_t i = 0; i < ntotal; ++i) {
+        if (!visited[i]) {
+            bfs(i);
+        }
+    }
+    return perm;
+}
+
+template <typename T>
+void
+permute_vector(T& values, const faiss::idx_t* perm) {
+    T permuted(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        permuted[i] = values[perm[i]];
+    }
+    std::swap(values, permuted);
+}
+
+// the entries of a flat storage, along with the l2 norms kept by the cosine ones, permuted to reorder an index.
+struct PermutableStorage {
+    faiss::IndexFlatCodes* codes = nullptr;
+    std::vector<float>* inverse_l2_norms = nullptr;
+
+    // perm[new_id] = old_id
+    void
+    permute(const faiss::idx_t* perm) {
+        codes->permute_entries(perm);
+        if (inverse_l2_norms != nullptr) {
+            permute_vector(*inverse_l2_norms, perm);
+        }
+    }
+
+    // drops the entries from n on
+    void
+    truncate(const size_t n) {
+        codes->codes.resize(n * codes->code_size);
+        codes->ntotal = n;
+        if (inverse_l2_norms != nullptr) {
+            inverse_l2_norms->resize(n);
+        }
+    }
+};
+
+std::optional<PermutableStorage>
+get_permutable_storage(faiss::Index* storage) {
+    // a rotation ahead of the codes does not depend on the ids
+    if (auto index_pt = dynamic_cast<faiss::IndexPreTransform*>(storage); index_pt != nullptr) {
+        storage = index_pt->index;
+    }
+    PermutableStorage result;
+    result.codes = dynamic_cast<faiss::IndexFlatCodes*>(storage);
+    if (result.codes == nullptr) {
+        return std::nullopt;
+    }
+    if (auto index = dynamic_cast<faiss::IndexFlatCosine*>(storage); index != nullptr) {
+        result.inverse_l2_norms = &index->inverse_norms_storage.inverse_l2_norms;
+    } else if (auto index = dynamic_cast<faiss::IndexScalarQuantizerCosine*>(storage); index != nullptr) {
+        result.inverse_l2_norms = &index->inverse_norms_storage.inverse_l2_norms;
+    } else if (auto index = dynamic_cast<faiss::IndexPQCosine*>(storage); index != nullptr) {
+        result.inverse_l2_norms = &index->inverse_norms_storage.inverse_l2_norms;
+    } else if (auto index = dynamic_cast<faiss::IndexNonUniformSQCosine*>(storage); index != nullptr) {
+        result.inverse_l2_norms = &index->inverse_norms_storage.inverse_l2_norms;
+    } else if (auto index = dynamic_cast<faiss::IndexProductResidualQuantizerCosine*>(storage); index != nullptr) {
+        result.inverse_l2_norms = &index->inverse_norms_storage.inverse_l2_norms;
+    } else if (dynamic_cast<const faiss::HasInverseL2Norms*>(storage) != nullptr) {
+        // the norms of an unknown cosine storage would not follow the permuted codes
+        return std::nullopt;
+    }
+    return result;
+}
+
+// the storages of the refine of an index, those of both stages for a refine cascade. Returns nullopt if any of them
+// can not be permuted.
+std::optional<std::vector<PermutableStorage>>
+get_permutable_refine_storages(faiss::IndexRefine* index_refine) {
+    std::vector<PermutableStorage> result;
+    if (index_refine == nullptr) {
+        return result;
+    }
+    std::vector<faiss::Index*> stages = {index_refine->refine_index};
+    if (auto cascade = dynamic_cast<faiss::IndexRefine*>(index_refine->refine_index); cascade != nullptr) {
+        stages = {cascade->base_index, cascade->refine_index};
+    }
+    for (auto stage : stages) {
+        auto storage = get_permutable_storage(stage);
+        if (!storage.has_value()) {
+            return std::nullopt;
+        }
+        result.push_back(storage.value());
+    }
+    return result;
+}
+
+// renumbers the nodes of an hnsw index (possibly wrapped by a refine) in BFS order, so that neighbors are likely
+// stored close to each other. Returns perm[new_id] = old_id, or nullopt if the index can not be permuted.
+std::optional<std::vector<faiss::idx_t>>
+reorder_hnsw_index(faiss::Index* index) {
+    auto index_refine = dynamic_cast<faiss::IndexRefine*>(index);
+    auto index_hnsw = dynamic_cast<faiss::IndexHNSW*>(index_refine != nullptr ? index_refine->base_index : index);
+    if (index_hnsw == nullptr) {
+        return std::nullopt;
+    }
+    auto storage = get_permutable_storage(index_hnsw->storage);
+    if (!storage.has_value()) {
+        return std::nullopt;
+    }
+    auto refine_storages = get_permutable_refine_storages(index_refine);
+    if (!refine_storages.has_value()) {
+        return std::nullopt;
+    }
+
+    auto perm = bfs_graph_order(index_hnsw->hnsw);
+    storage->permute(perm.data());
+    for (auto& refine_storage : refine_storages.value()) {
+        refine_storage.permute(perm.data());
+    }
+    index_hnsw->hnsw.permute_entries(perm.data());
+    return perm;
+}
+
+// removes the deleted nodes of an hnsw index (possibly wrapped by a refine), which must already be unlinked from its
+// graph, and renumbers the remaining ones in their original order. Returns perm[new_id] = old_id for the remaining
+// nodes, or nullopt if the index can not be compacted.
+std::optional<std::vector<faiss::idx_t>>
+compact_hnsw_index(faiss::Index* index, const std::vector<bool>& deleted) {
+    auto index_refine = dynamic_cast<faiss::IndexRefine*>(index);
+    auto index_hnsw = dynamic_cast<faiss::IndexHNSW*>(index_refine != nullptr ? index_refine->base_index : index);
+    if (index_hnsw == nullptr) {
+        return std::nullopt;
+    }
+    auto storage = get_permutable_storage(index_hnsw->storage);
+    if (!storage.has_value()) {
+        return std::nullopt;
+    }
+    auto refine_storages = get_permutable_refine_storages(index_refine);
+    if (!refine_storages.has_value()) {
+        return std::nullopt;
+    }
+
+    // the deleted nodes are moved to the end, then dropped
+    const faiss::idx_t ntotal = index_hnsw->ntotal;
+    std::vector<faiss::idx_t> perm;
+    perm.reserve(ntotal);
+    for (faiss::idx_t i = 0; i < ntotal; ++i) {
+        if (!deleted[i]) {
+            perm.push_back(i);
+        }
+    }
+    const size_t n_remaining = perm.size();
+    for (faiss::idx_t i = 0; i < ntotal; ++i) {
+        if (deleted[i]) {
+            perm.push_back(i);
+        }
+    }
+
+    storage->permute(perm.data());
+    storage->truncate(n_remaining);
+    for (auto& refine_storage : refine_storages.value()) {
+        refine_storage.permute(perm.data());
+        refine_storage.truncate(n_remaining);
+    }
+    if (index_refine != nullptr) {
+        index_refine->ntotal = n_remaining;
+        if (auto cascade = dynamic_cast<faiss::IndexRefine*>(index_refine->refine_index); cascade != nullptr) {
+            cascade->ntotal = n_remaining;
+        }
+    }
+    faiss::HNSW& hnsw = index_hnsw->hnsw;
+    hnsw.permute_entries(perm.data());
+    hnsw.levels.resize(n_remaining);
+    hnsw.offsets.resize(n_remaining + 1);
+    hnsw.neighbors.resize(hnsw.offsets.back());
+    index_hnsw->ntotal = n_remaining;
+
+    perm.resize(n_remaining);
+    return perm;
+}
+
+// maps the internal ids of search results to the external ones in place, the missing ones (-1) stay as they are. The
+// loop has no branch per id, so that it is vectorized into masked gathers.
+void
+map_to_external_ids(faiss::idx_t* const __restrict ids, const size_t n, const uint32_t* const __restrict mapping) {
+    for (size_t i = 0; i < n; i++) {
+        const faiss::idx_t id = ids[i];
+        ids[i] = (id < 0) ? id : static_cast<faiss::idx_t>(mapping[id]);
+    }
+}
+
+// returns the filter of a search over the internal ids, with the id mapping of bitset resolved once for all of its
+// queries, so that their candidates are tested without the indirection. internal_bits holds its bits.
+BitsetView
+resolve_out_ids(const BitsetView& bitset, std::vector<uint8_t>& internal_bits) {
+    if (bitset.empty() || !bitset.has_out_ids()) {
+        return bitset;
+    }
+    internal_bits.resize((bitset.size() + 7) / 8);
+    bitset.copy_internal_bits_to(internal_bits.data());
+    return BitsetView(internal_bits.data(), bitset.size(), bitset.count());
+}
+
+// The visited sets of the iterators, kept per thread once their iterators are destroyed and handed out to the
+// iterators that start their search on that thread. A set keeps its buffers across reset(), so that the iterators of
+// a query batch over the same index allocate them once per thread rather than once per iterator.
+class IteratorVisitedSetPool {
+ public:
+    using VisitedSet = faiss::cppcontrib::knowhere::VisitedSet;
+
+    static constexpr size_t kMaxCachedSets = 16;
+    static constexpr size_t kMaxCachedBytes = 64UL << 20;
+
+    static std::unique_ptr<VisitedSet>
+    Acquire() {
+        auto cache = LocalCache();
+        if (cache == nullptr || cache->sets.empty()) {
+            return std::make_unique<VisitedSet>();
+        }
+        auto set = std::move(cache->sets.back());
+        cache->sets.pop_back();
+        cache->cached_bytes -= set->allocated_bytes();
+        return set;
+    }
+
+    static void
+    Release(std::unique_ptr<VisitedSet>&& set) {
+        auto cache = LocalCache();
+        if (set == nullptr || cache == nullptr || cache->sets.size() >= kMaxCachedSets ||
+            cache->cached_bytes + set->allocated_bytes() > kMaxCachedBytes) {
+            return;
+        }
+        cache->cached_bytes += set->allocated_bytes();
+        cache->sets.push_back(std::move(set));
+    }
+
+ private:
+    struct ThreadCache {
+        std::vector<std::unique_ptr<VisitedSet>> sets;
+        size_t cached_bytes = 0;
+
+        ~ThreadCache() {
+            destroyed = true;
+        }
+    };
+
+    // set once the cache of the thread is destroyed, the sets released at thread exit after it are freed
+    static inline thread_local bool destroyed = false;
+
+    static ThreadCache*
+    LocalCache() {
+        if (destroyed) {
+            return nullptr;
+        }
+        thread_local ThreadCache cache;
+        return &cache;
+    }
+};
+
 }  // namespace
 
 // Contains an iterator state
@@ -742,8 +1274,10 @@ struct FaissHnswIteratorWorkspace {
     // this pointer is not owned.
     const faiss::HNSW* hnsw = nullptr;
 
-    // nodes that we've already visited
-    faiss::cppcontrib::knowhere::Bitset visited_nodes;
+    // nodes that we've already visited.
+    //   it starts small and grows as the iterator goes further.
+    //   it is taken from IteratorVisitedSetPool by the initial search and returned to it with the iterator.
+    std::unique_ptr<faiss::cppcontrib::knowhere::VisitedSet> visited_nodes;
 
     // Computes distances.
     //   This needs to be wrapped with a sign change.
@@ -827,8 +1361,7 @@ class FaissHnswIterator : public IndexIterator {
                 // Basically, if out hnsw index's storage is HasInverseL2Norms, then
                 //   this is a cosine index. But because refine always keeps original
                 //   data, then we need to use a wrapper over a distance computer
-                const faiss::HasInverseL2Norms* has_l2_norms =
-                    dynamic_cast<const faiss::HasInverseL2Norms*>(index_hnsw->storage);
+                const faiss::HasInverseL2Norms* has_l2_norms = faiss::get_storage_inverse_l2_norms(index_hnsw->storage);
                 if (has_l2_norms != nullptr) {
                     // add a cosine wrapper over it
                     // DO NOT WRAP A SIGN, by design
@@ -836,12 +1369,12 @@ class FaissHnswIterator : public IndexIterator {
                         std::unique_ptr<faiss::DistanceComputer>(new faiss::WithCosineNormDistanceComputer(
                             has_l2_norms->get_inverse_l2_norms(), index->d,
                             std::unique_ptr<faiss::DistanceComputer>(
-                                index_refine->refine_index->get_distance_computer())));
+                                get_final_refine_index(index_refine->refine_index)->get_distance_computer())));
                 } else {
                     // use it as is
                     // DO NOT WRAP A SIGN, by design
-                    workspace.qdis_refine =
-                        std::unique_ptr<faiss::DistanceComputer>(index_refine->refine_index->get_distance_computer());
+                    workspace.qdis_refine = std::unique_ptr<faiss::DistanceComputer>(
+                        get_final_refine_index(index_refine->refine_index)->get_distance_computer());
                 }
             } else {
                 // the refine is not needed
@@ -867,9 +1400,6 @@ class FaissHnswIterator : public IndexIterator {
             workspace.qdis_refine->set_query(query_in.get());
         }
 
-        // set up a buffer that tracks visited points
-        workspace.visited_nodes = faiss::cppcontrib::knowhere::Bitset::create_cleared(index->ntotal);
-
         workspace.search_params.efSearch = ef_in;
         // no need to set this one, use bitsetview directly
         workspace.search_params.sel = nullptr;
@@ -884,6 +1414,10 @@ class FaissHnswIterator : public IndexIterator {
         workspace.query = std::move(query_in);
     }
 
+    ~FaissHnswIterator() override {
+        IteratorVisitedSetPool::Release(std::move(workspace.visited_nodes));
+    }
+
  protected:
     template <typename FilterT>
     void
@@ -891,12 +1425,20 @@ class FaissHnswIterator : public IndexIterator {
         //
         using searcher_type =
             faiss::cppcontrib::knowhere::v2_hnsw_searcher<faiss::DistanceComputer, DummyVisitor,
-                                                          faiss::cppcontrib::knowhere::Bitset, FilterT>;
+                                                          faiss::cppcontrib::knowhere::VisitedSet, FilterT>;
 
         using storage_idx_t = typename searcher_type::storage_idx_t;
         using idx_t = typename searcher_type::idx_t;
 
-        searcher_type searcher(*workspace.hnsw, *workspace.qdis, workspace.graph_visitor, workspace.visited_nodes,
+        if (workspace.visited_nodes == nullptr) {
+            // set up a buffer that tracks visited points, at the initial search rather than at the creation of the
+            //   iterator, on the thread that runs it
+            workspace.visited_nodes = IteratorVisitedSetPool::Acquire();
+            workspace.visited_nodes->reset(index->ntotal,
+                                           hnsw_expected_visits(*workspace.hnsw, workspace.search_params.efSearch));
+        }
+
+        searcher_type searcher(*workspace.hnsw, *workspace.qdis, workspace.graph_visitor, *workspace.visited_nodes,
                                filter, 1.0f, &workspace.search_params);
 
         // whether to track hnsw stats
@@ -940,7 +1482,7 @@ class FaissHnswIterator : public IndexIterator {
                             nearest, d_nearest, faiss::cppcontrib::knowhere::Neighbor::kValid));
                     }
 
-                    searcher.visited_nodes[nearest] = true;
+                    searcher.visited_nodes.set(nearest);
                 }
 
                 // perform the search of the level 0.
@@ -1039,6 +1581,24 @@ class FaissHnswIterator : public IndexIterator {
         return workspace.qdis_refine->operator()(mv_internal_offset);
     }
 
+    void
+    raw_distances(const int64_t* ids, size_t n, float* dists) override {
+        const auto to_internal = [this](const int64_t id) -> faiss::idx_t {
+            return label_to_internal_offset.empty() ? id : (label_to_internal_offset[id] - mv_base_offset);
+        };
+
+        // compute the distances by 4, which lets the refine distance computer reuse the loads of the query
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            workspace.qdis_refine->distances_batch_4(to_internal(ids[i]), to_internal(ids[i + 1]),
+                                                     to_internal(ids[i + 2]), to_internal(ids[i + 3]), dists[i],
+                                                     dists[i + 1], dists[i + 2], dists[i + 3]);
+        }
+        for (; i < n; i++) {
+            dists[i] = workspace.qdis_refine->operator()(to_internal(ids[i]));
+        }
+    }
+
  private:
     std::shared_ptr<faiss::Index> index;
     std::shared_ptr<std::vector<uint32_t>> labels;
@@ -1055,52 +1615,205 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         : BaseFaissRegularIndexNode(version, object), data_format{data_format_in} {
     }
 
-    bool
-    HasRawData(const std::string& metric_type) const override {
-        if (indexes.empty()) {
-            return false;
-        }
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        // the data converted to float, its copy in the storage, and the links of the base layer (2 * M)
+        const auto& hnsw_cfg = static_cast<const FaissHnswConfig&>(cfg);
+        const int64_t links = 2 * hnsw_cfg.M.value_or(0) + 2;
+        return 2 * DataSetBytes<fp32>(dataset) + dataset->GetRows() * links * static_cast<int64_t>(sizeof(int32_t));
+    }
 
-        // check whether there is an index to reconstruct a raw data from
-        // only check one is enough
-        return (GetIndexToReconstructRawDataFrom(0) != nullptr);
+    Status
+    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        lazy_loaders.clear();
+        auto status = BaseFaissRegularIndexNode::Add(dataset, cfg, use_knowhere_build_pool);
+        // the rows of a sharded index are added at once
+        std::vector<std::vector<uint32_t>>().swap(tmp_shard_info);
+        if (status != Status::success) {
+            return status;
+        }
+        UpdateEntryPoints(*cfg);
+        return UpdateInlineLayouts(*cfg);
     }
 
-    expected<DataSetPtr>
-    GetVectorByIds(const DataSetPtr dataset) const override {
-        if (indexes.empty()) {
-            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
-        }
-        for (const auto& index : indexes) {
-            if (index == nullptr) {
-                return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
-            }
-            if (!index->is_trained) {
-                return expected<DataSetPtr>::Err(Status::index_not_trained, "index not trained");
-            }
-        }
+    Status
+    Delete(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        const BaseConfig& base_cfg = static_cast<const FaissHnswConfig&>(*cfg);
+        lazy_loaders.clear();
 
-        // an index that is used for reconstruction
-        std::vector<const faiss::Index*> indexes_to_reconstruct_from(indexes.size());
-        for (auto i = 0; i < indexes.size(); ++i) {
-            const faiss::Index* index_to_reconstruct_from = GetIndexToReconstructRawDataFrom(i);
+        // the graph is repaired by the OMP threads spawned in build_pool_, the same way as it is built
+        auto tryObj =
+            build_pool
+                ->push([&] {
+                    std::unique_ptr<ThreadPool::ScopedBuildOmpSetter> setter;
+                    if (base_cfg.num_build_thread.has_value()) {
+                        setter = std::make_unique<ThreadPool::ScopedBuildOmpSetter>(base_cfg.num_build_thread.value());
+                    } else {
+                        setter = std::make_unique<ThreadPool::ScopedBuildOmpSetter>();
+                    }
+                    return DeleteInternal(dataset, *cfg);
+                })
+                .getTry();
 
-            // check whether raw data is available
-            if (index_to_reconstruct_from == nullptr) {
-                return expected<DataSetPtr>::Err(
-                    Status::invalid_index_error,
-                    "The index does not contain a raw data, cannot proceed with GetVectorByIds");
-            }
-            indexes_to_reconstruct_from[i] = index_to_reconstruct_from;
+        if (!tryObj.hasValue()) {
+            LOG_KNOWHERE_WARNING_ << "faiss internal error: " << tryObj.exception().what();
+            return Status::faiss_inner_error;
         }
 
-        // perform reconstruction
+        return tryObj.value();
+    }
+
+    Status
+    Merge(const IndexNode& other, const BitsetView& bitset, std::shared_ptr<Config> cfg,
+          bool use_knowhere_build_pool) override {
+        const BaseConfig& base_cfg = static_cast<const FaissHnswConfig&>(*cfg);
+        auto other_node = dynamic_cast<const BaseFaissRegularIndexHNSWNode*>(&other);
+        if (other_node == nullptr || other_node->Type() != Type() || other_node->data_format != data_format) {
+            LOG_KNOWHERE_ERROR_ << "Can not merge an HNSW Index with an index of another type.";
+            return Status::invalid_args;
+        }
+        lazy_loaders.clear();
+
+        // the graph is merged by the OMP threads spawned in build_pool_, the same way as it is built
+        auto tryObj =
+            build_pool
+                ->push([&] {
+                    std::unique_ptr<ThreadPool::ScopedBuildOmpSetter> setter;
+                    if (base_cfg.num_build_thread.has_value()) {
+                        setter = std::make_unique<ThreadPool::ScopedBuildOmpSetter>(base_cfg.num_build_thread.value());
+                    } else {
+                        setter = std::make_unique<ThreadPool::ScopedBuildOmpSetter>();
+                    }
+                    return MergeInternal(*other_node, bitset, *cfg);
+                })
+                .getTry();
+
+        if (!tryObj.hasValue()) {
+            LOG_KNOWHERE_WARNING_ << "faiss internal error: " << tryObj.exception().what();
+            return Status::faiss_inner_error;
+        }
+
+        return tryObj.value();
+    }
+
+    Status
+    SetInternalIdToMostExternalIdMap(std::vector<uint32_t>&& map) override {
+        // the tombstones are indexed by the ids of the rows of this index
+        if (num_tombstones > 0) {
+            LOG_KNOWHERE_ERROR_ << "Can not map the ids of an HNSW Index with deleted rows.";
+            return Status::not_implemented;
+        }
+        return BaseFaissRegularIndexNode::SetInternalIdToMostExternalIdMap(std::move(map));
+    }
+
+    Status
+    Deserialize(const BinarySet& binset, std::shared_ptr<Config> config) override {
+        lazy_loaders.clear();
+        auto status = BaseFaissRegularIndexNode::Deserialize(binset, config);
+        if (status != Status::success) {
+            return status;
+        }
+        tombstones.clear();
+        num_tombstones = 0;
+        mmapped = false;
+        UpdateEntryPoints(*config);
+        return UpdateInlineLayouts(*config);
+    }
+
+    Status
+    DeserializeFromFile(const std::string& filename, std::shared_ptr<Config> config) override {
+        lazy_loaders.clear();
+        auto status = BaseFaissRegularIndexNode::DeserializeFromFile(filename, config);
+        if (status != Status::success) {
+            return status;
+        }
+        tombstones.clear();
+        num_tombstones = 0;
+        const auto& hnsw_cfg = static_cast<const FaissHnswConfig&>(*config);
+        mmapped = hnsw_cfg.enable_mmap.value();
+        if (hnsw_cfg.enable_mmap.value() && hnsw_cfg.lazy_load.value()) {
+            StartLazyLoaders();
+        }
+        UpdateEntryPoints(*config);
+        return UpdateInlineLayouts(*config);
+    }
+
+    Status
+    Cooldown() override {
+        // the hot regions that the lazy loaders locked could not be released
+        lazy_loaders.clear();
+        return BaseFaissRegularIndexNode::Cooldown();
+    }
+
+    int64_t
+    Size() const override {
+        int64_t size = BaseFaissRegularIndexNode::Size();
+        for (const auto& inline_layout : inline_layouts) {
+            size += (inline_layout == nullptr) ? 0 : inline_layout->size();
+        }
+        return size;
+    }
+
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        auto report = BaseFaissRegularIndexNode::GetMemoryReport();
+        if (!report.has_value()) {
+            return report;
+        }
+        // the inline layouts are copies of the graph, interleaved with the codes
+        for (const auto& inline_layout : inline_layouts) {
+            report.value().AddHeap(MemoryComponent::GRAPH, (inline_layout == nullptr) ? 0 : inline_layout->size());
+        }
+        report.value().AddHeap(MemoryComponent::OTHER, tombstones.capacity());
+        return report;
+    }
+
+    bool
+    HasRawData(const std::string& metric_type) const override {
+        if (indexes.empty()) {
+            return false;
+        }
+
+        // check whether there is an index to reconstruct a raw data from
+        // only check one is enough
+        return (GetIndexToReconstructRawDataFrom(0) != nullptr);
+    }
+
+    expected<DataSetPtr>
+    GetVectorByIds(const DataSetPtr dataset) const override {
+        if (indexes.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        for (const auto& index : indexes) {
+            if (index == nullptr) {
+                return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+            }
+            if (!index->is_trained) {
+                return expected<DataSetPtr>::Err(Status::index_not_trained, "index not trained");
+            }
+        }
+
+        // an index that is used for reconstruction
+        std::vector<const faiss::Index*> indexes_to_reconstruct_from(indexes.size());
+        for (auto i = 0; i < indexes.size(); ++i) {
+            const faiss::Index* index_to_reconstruct_from = GetIndexToReconstructRawDataFrom(i);
+
+            // check whether raw data is available
+            if (index_to_reconstruct_from == nullptr) {
+                return expected<DataSetPtr>::Err(
+                    Status::invalid_index_error,
+                    "The index does not contain a raw data, cannot proceed with GetVectorByIds");
+            }
+            indexes_to_reconstruct_from[i] = index_to_reconstruct_from;
+        }
+
+        // perform reconstruction
         auto dim = Dim();
         auto rows = dataset->GetRows();
         auto ids = dataset->GetIds();
 
         auto get_vector = [&](int64_t id, float* result) -> bool {
-            if (indexes.size() == 1) {
+            if (labels.empty()) {
                 indexes_to_reconstruct_from[0]->reconstruct(id, result);
             } else {
                 auto it =
@@ -1124,7 +1837,7 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
                 auto data = std::make_unique<float[]>(dim * rows);
                 for (int64_t i = 0; i < rows; i++) {
                     const int64_t id = ids[i];
-                    assert(id >= 0 && id < Count());
+                    assert(id >= 0 && id < NumIds());
                     if (!get_vector(id, data.get() + i * dim)) {
                         return expected<DataSetPtr>::Err(Status::invalid_index_error,
                                                          "index inner error, cannot proceed with GetVectorByIds");
@@ -1138,7 +1851,7 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
                 auto tmp = std::make_unique<float[]>(dim);
                 for (int64_t i = 0; i < rows; i++) {
                     const int64_t id = ids[i];
-                    assert(id >= 0 && id < Count());
+                    assert(id >= 0 && id < NumIds());
                     if (!get_vector(id, tmp.get())) {
                         return expected<DataSetPtr>::Err(Status::invalid_index_error,
                                                          "index inner error, cannot proceed with GetVectorByIds");
@@ -1155,7 +1868,7 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
                 auto tmp = std::make_unique<float[]>(dim);
                 for (int64_t i = 0; i < rows; i++) {
                     const int64_t id = ids[i];
-                    assert(id >= 0 && id < Count());
+                    assert(id >= 0 && id < NumIds());
                     if (!get_vector(id, tmp.get())) {
                         return expected<DataSetPtr>::Err(Status::invalid_index_error,
                                                          "index inner error, cannot proceed with GetVectorByIds");
@@ -1172,7 +1885,7 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
                 auto tmp = std::make_unique<float[]>(dim);
                 for (int64_t i = 0; i < rows; i++) {
                     const int64_t id = ids[i];
-                    assert(id >= 0 && id < Count());
+                    assert(id >= 0 && id < NumIds());
                     if (!get_vector(id, tmp.get())) {
                         return expected<DataSetPtr>::Err(Status::invalid_index_error,
                                                          "index inner error, cannot proceed with GetVectorByIds");
@@ -1193,6 +1906,12 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
 
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset_) const override {
+        return SearchWithNewBuf(dataset, std::move(cfg), bitset_);
+    }
+
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset_, int64_t* ids,
+                  float* distances) const override {
         if (this->indexes.empty()) {
             return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
         }
@@ -1205,25 +1924,109 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             }
         }
 
-        const auto dim = dataset->GetDim();
         const auto rows = dataset->GetRows();
-        const auto* data = dataset->GetTensor();
 
         const auto hnsw_cfg = static_cast<const FaissHnswConfig&>(*cfg);
         const auto k = hnsw_cfg.k.value();
 
-        BitsetView bitset(bitset_);
+        std::vector<uint8_t> merged_bits;
+        BitsetView bitset = FilterDeletedRows(bitset_, merged_bits);
         if (!internal_offset_to_most_external_id.empty()) {
             bitset.set_out_ids(internal_offset_to_most_external_id.data(), internal_offset_to_most_external_id.size());
         }
-        auto index_id = getIndexToSearchByScalarInfo(bitset);
-        if (index_id < 0) {
+        auto index_ids = getIndexesToSearchByScalarInfo(bitset, hnsw_cfg.materialized_view_search_info);
+        if (index_ids.empty()) {
             return expected<DataSetPtr>::Err(Status::invalid_args, "partition key value not correctly set");
         }
-        if (indexes.size() > 1) {
+        SearchStats search_stats(hnsw_cfg.search_stats.value() ? rows : 0);
+        QuerySearchStats* const stats = search_stats.empty() ? nullptr : search_stats.data();
+        if (index_ids.size() == 1) {
+            auto res = SearchPartitionWithBuf(dataset, hnsw_cfg, bitset, index_ids[0].first, index_ids[0].second, ids,
+                                              distances, stats);
+            if (res.has_value() && stats != nullptr) {
+                res.value()->SetSearchStats(std::move(search_stats));
+            }
+            return res;
+        }
+        if (hnsw_cfg.trace_visit.value()) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "the filter touches more than one partition");
+        }
+
+        // every touched partition is searched for the top k of its valid ids, and the results are merged. The results
+        // of the partition p of the query q start at (p * rows + q) * k, as expected by merge_knn_results().
+        const size_t num_searched = index_ids.size();
+        auto partition_ids = std::make_unique<int64_t[]>(num_searched * rows * k);
+        auto partition_distances = std::make_unique<float[]>(num_searched * rows * k);
+        if (sharded && rows < std::max<int64_t>(search_pool->size(), 1)) {
+            // too few queries to keep the search pool busy: every shard is searched by a task of its own, so that
+            // the latency of a query goes down with the threads of the pool. The shards count their stats apart.
+            std::vector<SearchStats> shard_stats(stats == nullptr ? 0 : num_searched, SearchStats(rows));
+            std::vector<expected<DataSetPtr>> shard_results(num_searched, expected<DataSetPtr>::OK());
+            try {
+                std::vector<folly::Future<folly::Unit>> futs;
+                futs.reserve(num_searched);
+                for (size_t p = 0; p < num_searched; p++) {
+                    futs.emplace_back(PushSearchTask(search_pool, [&, p]() {
+                        shard_results[p] = SearchPartitionWithBuf(
+                            dataset, hnsw_cfg, bitset, index_ids[p].first, index_ids[p].second,
+                            partition_ids.get() + p * rows * k, partition_distances.get() + p * rows * k,
+                            shard_stats.empty() ? nullptr : shard_stats[p].data(), true);
+                    }));
+                }
+                WaitAllSuccess(futs);
+            } catch (const std::exception& e) {
+                LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+                return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+            }
+            for (size_t p = 0; p < num_searched; p++) {
+                if (!shard_results[p].has_value()) {
+                    return shard_results[p];
+                }
+                for (int64_t q = 0; !shard_stats.empty() && q < rows; q++) {
+                    stats[q] += shard_stats[p][q];
+                }
+            }
+        } else {
+            for (size_t p = 0; p < num_searched; p++) {
+                auto res = SearchPartitionWithBuf(dataset, hnsw_cfg, bitset, index_ids[p].first, index_ids[p].second,
+                                                  partition_ids.get() + p * rows * k,
+                                                  partition_distances.get() + p * rows * k, stats);
+                if (!res.has_value()) {
+                    return res;
+                }
+            }
+        }
+        if (faiss::is_similarity_metric(indexes[0]->metric_type)) {
+            faiss::merge_knn_results<faiss::idx_t, faiss::CMax<float, int>>(
+                rows, k, num_searched, partition_distances.get(), partition_ids.get(), distances, ids);
+        } else {
+            faiss::merge_knn_results<faiss::idx_t, faiss::CMin<float, int>>(
+                rows, k, num_searched, partition_distances.get(), partition_ids.get(), distances, ids);
+        }
+
+        auto res = GenResultDataSet(rows, k, ids, distances);
+        res->SetIsOwner(false);
+        if (stats != nullptr) {
+            res->SetSearchStats(std::move(search_stats));
+        }
+        return res;
+    }
+
+    // searches the partition index_id, adds the stats of the query q to stats[q] if stats is not null. The queries
+    // are searched by the calling thread if run_inline, in parallel on the search pool otherwise.
+    expected<DataSetPtr>
+    SearchPartitionWithBuf(const DataSetPtr& dataset, const FaissHnswConfig& hnsw_cfg, BitsetView bitset,
+                           const int index_id, const size_t num_valid, int64_t* ids, float* distances,
+                           QuerySearchStats* stats, const bool run_inline = false) const {
+        const auto dim = dataset->GetDim();
+        const auto rows = dataset->GetRows();
+        const auto* data = dataset->GetTensor();
+        const auto k = hnsw_cfg.k.value();
+
+        if (!labels.empty() && !bitset.empty()) {
             // calculate more accurate filter statistics for the single mv-index.
             size_t num_mv_ids = labels[index_id].get()->size();
-            size_t num_mv_filtered_out_ids = num_mv_ids - (bitset.size() - bitset.count());
+            size_t num_mv_filtered_out_ids = num_mv_ids - num_valid;
             if (!bitset.has_out_ids()) {
                 bitset.set_out_ids(labels[index_id].get()->data(), num_mv_ids, num_mv_filtered_out_ids);
             } else {
@@ -1240,19 +2043,26 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             feder_result = std::make_unique<feder::hnsw::FederResult>();
         }
 
-        // check for brute-force search
-        auto whether_bf_search = WhetherPerformBruteForceSearch(indexes[index_id].get(), hnsw_cfg, bitset);
+        // plan the search: a brute force, or one of the graph traversals
+        const auto plan = PlanHnswSearch(indexes[index_id].get(), hnsw_cfg, bitset, rows, mmapped);
 
-        if (!whether_bf_search.has_value()) {
+        if (!plan.has_value()) {
             return expected<DataSetPtr>::Err(Status::invalid_args, "k parameter is missing");
         }
+        const bool whether_bf_search = plan->strategy == SearchStrategy::BRUTE_FORCE;
+
+        // the id mapping of the filter is resolved once, if enough of its ids are tested to pay off
+        std::vector<uint8_t> internal_bits;
+        if (whether_bf_search || rows >= HnswSearchThresholds::kHnswSearchResolveOutIdsMinQueries) {
+            bitset = resolve_out_ids(bitset, internal_bits);
+        }
 
         // whether a user wants a refine
         const bool whether_to_enable_refine = hnsw_cfg.refine_k.has_value();
 
         // set up an index wrapper
         auto [index_wrapper, is_refined] = create_conditional_hnsw_wrapper(
-            indexes[index_id].get(), hnsw_cfg, whether_bf_search.value_or(false), whether_to_enable_refine);
+            indexes[index_id].get(), hnsw_cfg, whether_bf_search, whether_to_enable_refine);
 
         if (index_wrapper == nullptr) {
             return expected<DataSetPtr>::Err(Status::invalid_args, "an input index seems to be unrelated to HNSW");
@@ -1261,7 +2071,7 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         // set up a bf wrapper as fallback
         std::unique_ptr<faiss::Index> bf_index_wrapper = nullptr;
         faiss::Index* bf_index_wrapper_ptr = nullptr;
-        if (!whether_bf_search.value_or(false)) {
+        if (!whether_bf_search) {
             std::tie(bf_index_wrapper, is_refined) =
                 create_conditional_hnsw_wrapper(indexes[index_id].get(), hnsw_cfg, true, whether_to_enable_refine);
             if (bf_index_wrapper == nullptr) {
@@ -1272,6 +2082,31 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
 
         faiss::Index* index_wrapper_ptr = index_wrapper.get();
 
+        // the candidates of a query that the refine stages rerank
+        float refine_candidates = 0;
+        float refine_cascade_candidates = 0;
+        if (is_refined) {
+            faiss::IndexRefineSearchParameters refine_params;
+            faiss::IndexRefineSearchParameters cascade_params;
+            setup_refine_search_params(index_wrapper_ptr, hnsw_cfg, nullptr, refine_params, cascade_params);
+            if (refine_params.base_index_params == &cascade_params) {
+                refine_candidates = k * refine_params.k_factor * cascade_params.k_factor;
+                refine_cascade_candidates = k * refine_params.k_factor;
+            } else {
+                refine_candidates = k * refine_params.k_factor;
+            }
+        }
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+        if (is_refined) {
+            knowhere_hnsw_refine_candidates.Observe(refine_candidates);
+            if (refine_cascade_candidates > 0) {
+                knowhere_hnsw_refine_cascade_candidates.Observe(refine_cascade_candidates);
+            }
+        }
+#endif
+        // a brute force search computes the distances to the valid vectors of the partition
+        const size_t bf_distances = bitset.empty() ? indexes[index_id]->ntotal : bitset.size() - bitset.count();
+
         // set up faiss search parameters
         knowhere::SearchParametersHNSWWrapper hnsw_search_params;
         if (hnsw_cfg.ef.has_value()) {
@@ -1284,44 +2119,68 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         hnsw_search_params.feder = feder_result.get();
         // set up kAlpha
         hnsw_search_params.kAlpha = bitset.filter_ratio() * 0.7f;
+        // search the inline layout of the graph, if any
+        hnsw_search_params.inline_layout = inline_layouts.empty() ? nullptr : inline_layouts[index_id].get();
+        // expand the neighbors of filtered out nodes when the filter is restrictive enough for it to pay off
+        if (plan->strategy == SearchStrategy::GRAPH_TWO_HOP) {
+            hnsw_search_params.two_hop_connectivity = HnswSearchThresholds::kHnswSearchTwoHopConnectivityThreshold;
+        }
 
         // set up a selector
         BitsetViewIDSelector bw_idselector(bitset);
         faiss::IDSelector* id_selector = &bw_idselector;
         hnsw_search_params.sel = id_selector;
 
-        // run
-        auto ids = std::make_unique<faiss::idx_t[]>(rows * k);
-        auto distances = std::make_unique<float[]>(rows * k);
+        // search blocks of queries with interleaved expansions, as long as every search thread gets a block
+        const int64_t n_search_threads = std::max<int64_t>(search_pool->size(), 1);
+        const int64_t block_size = (feder_result != nullptr)
+                                       ? 1
+                                       : std::clamp<int64_t>(rows / n_search_threads, 1,
+                                                             HnswSearchThresholds::kHnswSearchInterleaveBlockSize);
+        hnsw_search_params.interleaved_queries = block_size;
+        // stop the searches whose results stopped improving before ef is exhausted
+        hnsw_search_params.early_termination_patience = hnsw_cfg.early_termination_patience.value_or(0);
+        // start the searches from the entry points nearest to the queries, if any
+        if (!entry_points.empty() && !entry_points[index_id].empty()) {
+            hnsw_search_params.entry_points = entry_points[index_id].data();
+            hnsw_search_params.n_entry_points = entry_points[index_id].size();
+        }
 
+        // run
         try {
             std::vector<folly::Future<folly::Unit>> futs;
-            futs.reserve(rows);
+            futs.reserve((rows + block_size - 1) / block_size);
 
-            for (int64_t i = 0; i < rows; ++i) {
-                futs.emplace_back(search_pool->push([&, idx = i, is_refined = is_refined,
-                                                     index_wrapper_ptr = index_wrapper_ptr,
-                                                     bf_index_wrapper_ptr = bf_index_wrapper_ptr]() {
-                    // 1 thread per element
+            for (int64_t i = 0; i < rows; i += block_size) {
+                auto search_block = [&, block_start = i, block_rows = std::min<int64_t>(block_size, rows - i),
+                                     is_refined = is_refined, index_wrapper_ptr = index_wrapper_ptr,
+                                     bf_index_wrapper_ptr = bf_index_wrapper_ptr]() {
+                    // 1 thread per block
                     ThreadPool::ScopedSearchOmpSetter setter(1);
 
-                    // set up a query
-                    const float* cur_query = nullptr;
+                    // skip the block once the search is interrupted
+                    if (SearchInterrupted()) {
+                        MarkMissingResults(ids, distances, k, block_start, block_start + block_rows);
+                        return;
+                    }
 
-                    std::vector<float> cur_query_tmp(dim);
+                    // set up the queries
+                    SearchWorkspace::Scope workspace;
+                    const float* cur_queries = nullptr;
                     if (data_format == DataFormatEnum::fp32) {
-                        cur_query = (const float*)data + idx * dim;
+                        cur_queries = (const float*)data + block_start * dim;
                     } else {
-                        convert_rows_to_fp32(data, cur_query_tmp.data(), data_format, idx, 1, dim);
-                        cur_query = cur_query_tmp.data();
+                        auto cur_queries_tmp = workspace.Alloc<float>(block_rows * dim);
+                        convert_rows_to_fp32(data, cur_queries_tmp, data_format, block_start, block_rows, dim);
+                        cur_queries = cur_queries_tmp;
                     }
 
                     // set up local results
-                    faiss::idx_t* const __restrict local_ids = ids.get() + k * idx;
-                    float* const __restrict local_distances = distances.get() + k * idx;
+                    faiss::idx_t* const __restrict block_ids = ids + k * block_start;
+                    float* const __restrict block_distances = distances + k * block_start;
 
                     // check if we need to perform a brute-force search bcz of the lack of results
-                    auto bf_search_needed = [&]() -> bool {
+                    auto bf_search_needed = [&](const faiss::idx_t* local_ids) -> bool {
                         size_t real_topk = 0;
                         for (auto j = 0; j < k; ++j) {
                             if (local_ids[j] < 0) {
@@ -1336,32 +2195,72 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
                         return false;
                     };
 
+                    // the stats of the graph traversal of the queries of the block
+                    std::vector<faiss::HNSWStats> block_stats(stats == nullptr ? 0 : block_rows);
+                    knowhere::SearchParametersHNSWWrapper block_search_params = hnsw_search_params;
+                    block_search_params.query_stats = block_stats.empty() ? nullptr : block_stats.data();
+                    std::vector<bool> bf_searched(block_stats.size(), false);
+
                     // perform the search
+                    ScopedSearchStage stage(SearchStage::GRAPH_TRAVERSAL);
                     if (is_refined) {
                         faiss::IndexRefineSearchParameters refine_params;
-                        refine_params.k_factor = hnsw_cfg.refine_k.value_or(1);
-                        // a refine procedure itself does not need to care about filtering
-                        refine_params.sel = nullptr;
-                        refine_params.base_index_params = &hnsw_search_params;
-
-                        index_wrapper_ptr->search(1, cur_query, k, local_distances, local_ids, &refine_params);
-                        if (bf_search_needed()) {
-                            bf_index_wrapper_ptr->search(1, cur_query, k, local_distances, local_ids, &refine_params);
+                        faiss::IndexRefineSearchParameters cascade_params;
+                        setup_refine_search_params(index_wrapper_ptr, hnsw_cfg, &block_search_params, refine_params,
+                                                   cascade_params);
+
+                        index_wrapper_ptr->search(block_rows, cur_queries, k, block_distances, block_ids,
+                                                  &refine_params);
+                        for (int64_t q = 0; q < block_rows; ++q) {
+                            if (bf_search_needed(block_ids + q * k)) {
+                                bf_index_wrapper_ptr->search(1, cur_queries + q * dim, k, block_distances + q * k,
+                                                             block_ids + q * k, &refine_params);
+                                if (!bf_searched.empty()) {
+                                    bf_searched[q] = true;
+                                }
+                            }
                         }
                     } else {
-                        index_wrapper_ptr->search(1, cur_query, k, local_distances, local_ids, &hnsw_search_params);
-                        if (bf_search_needed()) {
-                            bf_index_wrapper_ptr->search(1, cur_query, k, local_distances, local_ids,
-                                                         &hnsw_search_params);
+                        index_wrapper_ptr->search(block_rows, cur_queries, k, block_distances, block_ids,
+                                                  &block_search_params);
+                        for (int64_t q = 0; q < block_rows; ++q) {
+                            if (bf_search_needed(block_ids + q * k)) {
+                                bf_index_wrapper_ptr->search(1, cur_queries + q * dim, k, block_distances + q * k,
+                                                             block_ids + q * k, &block_search_params);
+                                if (!bf_searched.empty()) {
+                                    bf_searched[q] = true;
+                                }
+                            }
                         }
                     }
 
-                    if (!labels.empty()) {
-                        for (auto j = 0; j < k; ++j) {
-                            local_ids[j] = local_ids[j] < 0 ? local_ids[j] : labels[index_id]->operator[](local_ids[j]);
+                    if (stats != nullptr) {
+                        for (int64_t q = 0; q < block_rows; ++q) {
+                            auto& query_stats = stats[block_start + q];
+                            query_stats.distance_computations += block_stats[q].ndis;
+                            query_stats.graph_hops += block_stats[q].nhops;
+                            if (whether_bf_search || bf_searched[q]) {
+                                query_stats.distance_computations += bf_distances;
+                            }
+                            query_stats.strategies |= static_cast<uint32_t>(plan->strategy);
+                            if (bf_searched[q]) {
+                                query_stats.strategies |= static_cast<uint32_t>(SearchStrategy::BRUTE_FORCE);
+                            }
+                            query_stats.estimated_cost += plan->cost;
+                            query_stats.refine_candidates += refine_candidates + refine_cascade_candidates;
+                            query_stats.distance_computations += refine_candidates + refine_cascade_candidates;
                         }
                     }
-                }));
+
+                    if (!labels.empty()) {
+                        map_to_external_ids(block_ids, block_rows * k, labels[index_id]->data());
+                    }
+                };
+                if (run_inline) {
+                    search_block();
+                } else {
+                    futs.emplace_back(PushSearchTask(search_pool, std::move(search_block)));
+                }
             }
 
             // wait for the completion
@@ -1371,7 +2270,8 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
         }
 
-        auto res = GenResultDataSet(rows, k, std::move(ids), std::move(distances));
+        auto res = GenResultDataSet(rows, k, ids, distances);
+        res->SetIsOwner(false);
 
         // set visit_info json string into result dataset
         if (feder_result != nullptr) {
@@ -1385,6 +2285,135 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         return res;
     }
 
+    // the groups are collected within the graph traversal of a single partition, ranked by the distances of the
+    // codes of the graph without a refine
+    expected<DataSetPtr>
+    GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column, std::unique_ptr<Config> cfg,
+                  const BitsetView& bitset_) const override {
+        if (this->indexes.empty()) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        for (const auto& index : indexes) {
+            if (index == nullptr) {
+                return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+            }
+            if (!index->is_trained) {
+                return expected<DataSetPtr>::Err(Status::index_not_trained, "index not trained");
+            }
+        }
+
+        const auto dim = dataset->GetDim();
+        const auto rows = dataset->GetRows();
+        const auto* data = dataset->GetTensor();
+
+        const auto hnsw_cfg = static_cast<const FaissHnswConfig&>(*cfg);
+        const auto k = hnsw_cfg.k.value();
+        const auto group_size = hnsw_cfg.group_size.value();
+        const auto n_results = k * group_size;
+
+        std::vector<uint8_t> merged_bits;
+        BitsetView bitset = FilterDeletedRows(bitset_, merged_bits);
+        if (!internal_offset_to_most_external_id.empty()) {
+            bitset.set_out_ids(internal_offset_to_most_external_id.data(), internal_offset_to_most_external_id.size());
+        }
+        auto index_ids = getIndexesToSearchByScalarInfo(bitset, hnsw_cfg.materialized_view_search_info);
+        if (index_ids.empty()) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "partition key value not correctly set");
+        }
+        if (index_ids.size() != 1) {
+            return expected<DataSetPtr>::Err(Status::not_implemented,
+                                             "group-by search over more than one partition is not supported");
+        }
+        const int index_id = index_ids[0].first;
+        if (!labels.empty() && !bitset.empty()) {
+            size_t num_mv_ids = labels[index_id].get()->size();
+            size_t num_mv_filtered_out_ids = num_mv_ids - index_ids[0].second;
+            if (!bitset.has_out_ids()) {
+                bitset.set_out_ids(labels[index_id].get()->data(), num_mv_ids, num_mv_filtered_out_ids);
+            } else {
+                bitset.set_out_ids(internal_offset_to_most_external_id.data(), num_mv_ids, num_mv_filtered_out_ids);
+                bitset.set_id_offset(index_rows_sum[index_id]);
+            }
+        }
+        // every node reached by the traversal is tested against the filter, resolve its id mapping once
+        std::vector<uint8_t> internal_bits;
+        bitset = resolve_out_ids(bitset, internal_bits);
+
+        auto index_wrapper =
+            std::get<0>(create_conditional_hnsw_wrapper(indexes[index_id].get(), hnsw_cfg, false, false));
+        const auto* hnsw_wrapper = dynamic_cast<const knowhere::IndexHNSWWrapper*>(index_wrapper.get());
+        if (hnsw_wrapper == nullptr) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "an input index seems to be unrelated to HNSW");
+        }
+        // the nodes of a partition are its rows through its labels
+        const uint32_t* id_mapping = labels.empty() ? nullptr : labels[index_id]->data();
+
+        knowhere::SearchParametersHNSWWrapper hnsw_search_params;
+        if (hnsw_cfg.ef.has_value()) {
+            hnsw_search_params.efSearch = hnsw_cfg.ef.value();
+        }
+        hnsw_search_params.kAlpha = bitset.filter_ratio() * 0.7f;
+        hnsw_search_params.inline_layout = inline_layouts.empty() ? nullptr : inline_layouts[index_id].get();
+        if (bitset.filter_ratio() >= HnswSearchThresholds::kHnswSearchTwoHopFilterThreshold) {
+            hnsw_search_params.two_hop_connectivity = HnswSearchThresholds::kHnswSearchTwoHopConnectivityThreshold;
+        }
+        BitsetViewIDSelector bw_idselector(bitset);
+        hnsw_search_params.sel = &bw_idselector;
+
+        SearchStats search_stats(hnsw_cfg.search_stats.value() ? rows : 0);
+        auto ids = std::make_unique<int64_t[]>(rows * n_results);
+        auto distances = std::make_unique<float[]>(rows * n_results);
+        try {
+            std::vector<folly::Future<folly::Unit>> futs;
+            futs.reserve(rows);
+            for (int64_t i = 0; i < rows; ++i) {
+                futs.emplace_back(PushSearchTask(search_pool, [&, i]() {
+                    ThreadPool::ScopedSearchOmpSetter setter(1);
+                    if (SearchInterrupted()) {
+                        MarkMissingResults(ids.get(), distances.get(), n_results, i, i + 1);
+                        return;
+                    }
+
+                    SearchWorkspace::Scope workspace;
+                    const float* cur_query = nullptr;
+                    if (data_format == DataFormatEnum::fp32) {
+                        cur_query = (const float*)data + i * dim;
+                    } else {
+                        auto cur_query_tmp = workspace.Alloc<float>(dim);
+                        convert_rows_to_fp32(data, cur_query_tmp, data_format, i, 1, dim);
+                        cur_query = cur_query_tmp;
+                    }
+
+                    faiss::HNSWStats query_stats;
+                    knowhere::SearchParametersHNSWWrapper query_search_params = hnsw_search_params;
+                    query_search_params.query_stats = search_stats.empty() ? nullptr : &query_stats;
+
+                    ScopedSearchStage stage(SearchStage::GRAPH_TRAVERSAL);
+                    hnsw_wrapper->search_group_by(1, cur_query, k, group_size, column, id_mapping,
+                                                  distances.get() + i * n_results, ids.get() + i * n_results,
+                                                  &query_search_params);
+                    if (id_mapping != nullptr) {
+                        map_to_external_ids(ids.get() + i * n_results, n_results, id_mapping);
+                    }
+                    if (!search_stats.empty()) {
+                        search_stats[i].distance_computations = query_stats.ndis;
+                        search_stats[i].graph_hops = query_stats.nhops;
+                    }
+                }));
+            }
+            WaitAllSuccess(futs);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        }
+
+        auto res = GenResultDataSet(rows, n_results, std::move(ids), std::move(distances));
+        if (!search_stats.empty()) {
+            res->SetSearchStats(std::move(search_stats));
+        }
+        return res;
+    }
+
     expected<DataSetPtr>
     CalcDistByIDs(const DataSetPtr dataset, const BitsetView& bitset_, const int64_t* labels,
                   const size_t labels_len) const override {
@@ -1417,24 +2446,34 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             std::vector<folly::Future<folly::Unit>> futs;
             futs.reserve(rows);
             for (auto i = 0; i < rows; i++) {
-                futs.emplace_back(search_pool->push([&, idx = i, index_id = index_id]() {
+                futs.emplace_back(PushSearchTask(search_pool, [&, idx = i, index_id = index_id]() {
                     // set up a query
+                    SearchWorkspace::Scope workspace;
                     const float* cur_query = nullptr;
-                    std::vector<float> cur_query_tmp(dim);
                     if (data_format == DataFormatEnum::fp32) {
                         cur_query = (const float*)data + idx * dim;
                     } else {
-                        convert_rows_to_fp32(data, cur_query_tmp.data(), data_format, idx, 1, dim);
-                        cur_query = cur_query_tmp.data();
+                        auto cur_query_tmp = workspace.Alloc<float>(dim);
+                        convert_rows_to_fp32(data, cur_query_tmp, data_format, idx, 1, dim);
+                        cur_query = cur_query_tmp;
                     }
-                    std::unique_ptr<faiss::DistanceComputer> dist_computer(indexes[index_id]->get_distance_computer());
-                    dist_computer->set_query(cur_query);
+                    // the ids of a sharded index may be in any of its shards
+                    std::vector<std::unique_ptr<faiss::DistanceComputer>> dist_computers(indexes.size());
                     for (auto j = 0; j < labels_len; j++) {
                         auto id = labels[j];
-                        if (indexes.size() > 1) {
-                            id = label_to_internal_offset[labels[j]] - index_rows_sum[index_id];
+                        int p = index_id;
+                        if (!this->labels.empty()) {
+                            const uint32_t offset = label_to_internal_offset[labels[j]];
+                            if (sharded) {
+                                p = getIndexByInternalOffset(offset);
+                            }
+                            id = offset - index_rows_sum[p];
+                        }
+                        if (dist_computers[p] == nullptr) {
+                            dist_computers[p].reset(indexes[p]->get_distance_computer());
+                            dist_computers[p]->set_query(cur_query);
                         }
-                        distances[idx * labels_len + j] = (*dist_computer)(id);
+                        distances[idx * labels_len + j] = (*dist_computers[p])(id);
                     }
                 }));
             }
@@ -1452,8 +2491,9 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
 
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset_) const override {
-        // if support ann_iterator, use iterator-based range_search (IndexNode::RangeSearch)
-        if (is_ann_iterator_supported()) {
+        // if support ann_iterator, use iterator-based range_search (IndexNode::RangeSearch). The iterators walk a
+        // single partition, so the shards of a sharded index are range searched one by one instead.
+        if (is_ann_iterator_supported() && !sharded) {
             return IndexNode::RangeSearch(dataset, std::move(cfg), bitset_);
         }
         if (this->indexes.empty()) {
@@ -1468,22 +2508,65 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             }
         }
 
-        const auto dim = dataset->GetDim();
         const auto rows = dataset->GetRows();
-        const auto* data = dataset->GetTensor();
 
         const auto hnsw_cfg = static_cast<const FaissHnswConfig&>(*cfg);
-        BitsetView bitset(bitset_);
+        std::vector<uint8_t> merged_bits;
+        BitsetView bitset = FilterDeletedRows(bitset_, merged_bits);
         if (!internal_offset_to_most_external_id.empty()) {
             bitset.set_out_ids(internal_offset_to_most_external_id.data(), internal_offset_to_most_external_id.size());
         }
-        auto index_id = getIndexToSearchByScalarInfo(bitset);
-        if (index_id < 0) {
-            return expected<DataSetPtr>::Err(Status::invalid_args, "partition key value not correctly set");
+        if (!sharded) {
+            auto index_id = getIndexToSearchByScalarInfo(bitset);
+            if (index_id < 0) {
+                return expected<DataSetPtr>::Err(Status::invalid_args, "partition key value not correctly set");
+            }
+            return RangeSearchPartition(dataset, hnsw_cfg, bitset, index_id, bitset.size() - bitset.count());
+        }
+
+        // every shard with a valid id is range searched, and the results of a query are concatenated
+        auto index_ids = getIndexesToSearchByScalarInfo(bitset, hnsw_cfg.materialized_view_search_info);
+        if (index_ids.size() == 1) {
+            return RangeSearchPartition(dataset, hnsw_cfg, bitset, index_ids[0].first, index_ids[0].second);
         }
-        if (indexes.size() > 1) {
+        if (hnsw_cfg.trace_visit.value()) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "the filter touches more than one partition");
+        }
+        std::vector<std::vector<int64_t>> result_id_array(rows);
+        std::vector<std::vector<float>> result_dist_array(rows);
+        for (const auto& [index_id, num_valid] : index_ids) {
+            auto res = RangeSearchPartition(dataset, hnsw_cfg, bitset, index_id, num_valid);
+            if (!res.has_value()) {
+                return res;
+            }
+            const auto* lims = res.value()->GetLims();
+            const auto* ids = res.value()->GetIds();
+            const auto* distances = res.value()->GetDistance();
+            for (int64_t q = 0; q < rows; q++) {
+                result_id_array[q].insert(result_id_array[q].end(), ids + lims[q], ids + lims[q + 1]);
+                result_dist_array[q].insert(result_dist_array[q].end(), distances + lims[q], distances + lims[q + 1]);
+            }
+        }
+
+        ScopedSearchStage stage(SearchStage::RESULT_ASSEMBLY);
+        const bool is_similarity_metric = faiss::is_similarity_metric(indexes[0]->metric_type);
+        RangeSearchResult range_search_result =
+            GetRangeSearchResult(result_dist_array, result_id_array, is_similarity_metric, rows,
+                                 hnsw_cfg.radius.value(), hnsw_cfg.range_filter.value());
+        return GenResultDataSet(rows, std::move(range_search_result));
+    }
+
+    // range searches the partition index_id, which holds num_valid valid ids of bitset
+    expected<DataSetPtr>
+    RangeSearchPartition(const DataSetPtr& dataset, const FaissHnswConfig& hnsw_cfg, BitsetView bitset,
+                         const int index_id, const size_t num_valid) const {
+        const auto dim = dataset->GetDim();
+        const auto rows = dataset->GetRows();
+        const auto* data = dataset->GetTensor();
+
+        if (!labels.empty() && !bitset.empty()) {
             size_t num_mv_ids = labels[index_id].get()->size();
-            size_t num_mv_filtered_out_ids = num_mv_ids - (bitset.size() - bitset.count());
+            size_t num_mv_filtered_out_ids = num_mv_ids - num_valid;
             if (!bitset.has_out_ids()) {
                 bitset.set_out_ids(labels[index_id].get()->data(), num_mv_ids, num_mv_filtered_out_ids);
             } else {
@@ -1512,6 +2595,12 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             return expected<DataSetPtr>::Err(Status::invalid_args, "ef parameter is missing");
         }
 
+        // the id mapping of the filter is resolved once, if enough of its ids are tested to pay off
+        std::vector<uint8_t> internal_bits;
+        if (whether_bf_search.value() || rows >= HnswSearchThresholds::kHnswSearchResolveOutIdsMinQueries) {
+            bitset = resolve_out_ids(bitset, internal_bits);
+        }
+
         // whether a user wants a refine
         const bool whether_to_enable_refine = true;
 
@@ -1538,6 +2627,12 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         hnsw_search_params.feder = feder_result.get();
         // set up kAlpha
         hnsw_search_params.kAlpha = bitset.filter_ratio() * 0.7f;
+        // search the inline layout of the graph, if any
+        hnsw_search_params.inline_layout = inline_layouts.empty() ? nullptr : inline_layouts[index_id].get();
+        // expand the neighbors of filtered out nodes when the filter is restrictive
+        if (bitset.filter_ratio() >= HnswSearchThresholds::kHnswSearchTwoHopFilterThreshold) {
+            hnsw_search_params.two_hop_connectivity = HnswSearchThresholds::kHnswSearchTwoHopConnectivityThreshold;
+        }
 
         // set up a selector
         BitsetViewIDSelector bw_idselector(bitset);
@@ -1558,31 +2653,32 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             // {
 
             futs.emplace_back(
-                search_pool->push([&, idx = i, is_refined = is_refined, index_wrapper_ptr = index_wrapper_ptr] {
+                PushSearchTask(search_pool, [&, idx = i, is_refined = is_refined,
+                                             index_wrapper_ptr = index_wrapper_ptr] {
                     // 1 thread per element
                     ThreadPool::ScopedSearchOmpSetter setter(1);
 
                     // set up a query
+                    SearchWorkspace::Scope workspace;
                     const float* cur_query = nullptr;
-
-                    std::vector<float> cur_query_tmp(dim);
                     if (data_format == DataFormatEnum::fp32) {
                         cur_query = (const float*)data + idx * dim;
                     } else {
-                        convert_rows_to_fp32(data, cur_query_tmp.data(), data_format, idx, 1, dim);
-                        cur_query = cur_query_tmp.data();
+                        auto cur_query_tmp = workspace.Alloc<float>(dim);
+                        convert_rows_to_fp32(data, cur_query_tmp, data_format, idx, 1, dim);
+                        cur_query = cur_query_tmp;
                     }
 
                     // initialize a buffer
                     faiss::RangeSearchResult res(1);
 
                     // perform the search
+                    ScopedSearchStage stage(SearchStage::GRAPH_TRAVERSAL);
                     if (is_refined) {
                         faiss::IndexRefineSearchParameters refine_params;
-                        refine_params.k_factor = hnsw_cfg.refine_k.value_or(1);
-                        // a refine procedure itself does not need to care about filtering
-                        refine_params.sel = nullptr;
-                        refine_params.base_index_params = &hnsw_search_params;
+                        faiss::IndexRefineSearchParameters cascade_params;
+                        setup_refine_search_params(index_wrapper_ptr, hnsw_cfg, &hnsw_search_params, refine_params,
+                                                   cascade_params);
 
                         index_wrapper_ptr->range_search(1, cur_query, radius, &res, &refine_params);
                     } else {
@@ -1594,17 +2690,12 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
                     result_dist_array[idx].resize(elem_cnt);
                     result_id_array[idx].resize(elem_cnt);
 
-                    if (labels.empty()) {
-                        for (size_t j = 0; j < elem_cnt; j++) {
-                            result_dist_array[idx][j] = res.distances[j];
-                            result_id_array[idx][j] = res.labels[j];
-                        }
-                    } else {
-                        for (size_t j = 0; j < elem_cnt; j++) {
-                            result_dist_array[idx][j] = res.distances[j];
-                            result_id_array[idx][j] =
-                                res.labels[j] < 0 ? res.labels[j] : labels[index_id]->operator[](res.labels[j]);
-                        }
+                    if (!labels.empty()) {
+                        map_to_external_ids(res.labels, elem_cnt, labels[index_id]->data());
+                    }
+                    for (size_t j = 0; j < elem_cnt; j++) {
+                        result_dist_array[idx][j] = res.distances[j];
+                        result_id_array[idx][j] = res.labels[j];
                     }
 
                     if (hnsw_cfg.range_filter.value() != defaultRangeFilter) {
@@ -1617,7 +2708,7 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         // wait for the completion
         WaitAllSuccess(futs);
 
-        //
+        ScopedSearchStage stage(SearchStage::RESULT_ASSEMBLY);
         RangeSearchResult range_search_result =
             GetRangeSearchResult(result_dist_array, result_id_array, is_similarity_metric, rows, radius, range_filter);
 
@@ -1629,23 +2720,189 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
 
     std::vector<std::vector<int>> tmp_combined_scalar_ids;
 
+    // the shards of the rows of a sharded build (@see FaissHnswConfig::shards), from its train to its add
+    std::vector<std::vector<uint32_t>> tmp_shard_info;
+
+    // the base layers of the graphs stored next to their codes, one per index, empty if it is disabled
+    std::vector<std::unique_ptr<HnswInlineLayout>> inline_layouts;
+
+    // the entry points of the k-NN searches of the graphs, one table per index, empty if they are disabled
+    // (@see FaissHnswConfig::entry_points). They are not serialized.
+    size_t num_entry_points = 0;
+    std::vector<std::vector<faiss::HNSW::storage_idx_t>> entry_points;
+
+    // the warm-up of the mmapped indices, one per index, empty if it is disabled. They are stopped before the indices
+    // change or go away.
+    std::vector<std::unique_ptr<HnswLazyLoader>> lazy_loaders;
+    // whether the indices are mmapped, which makes the graph traversals costlier to the planner of the searches
+    bool mmapped = false;
+
+    // the rows deleted by Delete(), one bit per id, empty if none is. The deleted rows are unlinked from the graph,
+    // so only the brute-force searches have to filter them out. The tombstones are not serialized.
+    std::vector<uint8_t> tombstones;
+    size_t num_tombstones = 0;
+
+    // the number of ids of the rows, which exceeds Count() once the deleted rows are removed from the index
+    size_t
+    NumIds() const {
+        return labels.empty() ? Count() : label_to_internal_offset.size();
+    }
+
+    bool
+    IsDeleted(const size_t id) const {
+        return (tombstones[id >> 3] & (0x1 << (id & 0x7))) != 0;
+    }
+
+    // returns the filter of a search with the deleted rows filtered out as well, merged_bits holds its bits if they
+    // differ from the ones of bitset.
+    BitsetView
+    FilterDeletedRows(const BitsetView& bitset, std::vector<uint8_t>& merged_bits) const {
+        if (num_tombstones == 0) {
+            return bitset;
+        }
+        if (bitset.empty()) {
+            return BitsetView(tombstones.data(), NumIds(), num_tombstones);
+        }
+        // the ids past the end of bitset stay filtered out
+        merged_bits.resize(bitset.byte_size());
+        bitset.copy_bits_to(merged_bits.data());
+        const size_t n_bytes = std::min(merged_bits.size(), tombstones.size());
+        for (size_t i = 0; i < n_bytes; ++i) {
+            uint8_t deleted_bits = tombstones[i];
+            if ((i + 1) * 8 > bitset.size()) {
+                deleted_bits &= (0x1 << (bitset.size() % 8)) - 1;
+            }
+            merged_bits[i] |= deleted_bits;
+        }
+        BitsetView merged(merged_bits.data(), bitset.size());
+        return BitsetView(merged_bits.data(), bitset.size(), merged.get_filtered_out_num_());
+    }
+
+    void
+    StartLazyLoaders() {
+        try {
+            lazy_loaders.resize(indexes.size());
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                auto index_refine = dynamic_cast<const faiss::IndexRefine*>(indexes[i].get());
+                auto index_hnsw = dynamic_cast<const faiss::IndexHNSW*>(
+                    index_refine != nullptr ? index_refine->base_index : indexes[i].get());
+                if (index_hnsw != nullptr) {
+                    // the codes of the intermediate stage of a refine cascade are the ones read by every search
+                    auto cascade = index_refine != nullptr ? get_refine_cascade(index_refine->refine_index) : nullptr;
+                    const faiss::Index* refine_index = nullptr;
+                    if (index_refine != nullptr) {
+                        refine_index = cascade != nullptr ? cascade->base_index : index_refine->refine_index;
+                    }
+                    auto refine_codes = dynamic_cast<const faiss::IndexFlatCodes*>(refine_index);
+                    lazy_loaders[i] = HnswLazyLoader::create(*index_hnsw, refine_codes);
+                }
+                if (lazy_loaders[i] == nullptr) {
+                    LOG_KNOWHERE_WARNING_ << "The storage of this HNSW Index does not support the lazy load.";
+                }
+            }
+        } catch (const std::exception& e) {
+            // the index is still searchable, only colder
+            lazy_loaders.clear();
+            LOG_KNOWHERE_WARNING_ << "failed to start the lazy load of the HNSW index: " << e.what();
+        }
+    }
+
+    // (re)builds the entry points of the indices if they are enabled
+    void
+    UpdateEntryPoints(const Config& cfg) {
+        num_entry_points = static_cast<const FaissHnswConfig&>(cfg).entry_points.value_or(0);
+        BuildEntryPoints();
+    }
+
+    void
+    BuildEntryPoints() {
+        entry_points.clear();
+        if (num_entry_points == 0) {
+            return;
+        }
+        try {
+            knowhere::TimeRecorder rc("HNSW entry points", 2);
+            entry_points.resize(indexes.size());
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                auto index_refine = dynamic_cast<const faiss::IndexRefine*>(indexes[i].get());
+                auto index_hnsw = dynamic_cast<const faiss::IndexHNSW*>(
+                    index_refine != nullptr ? index_refine->base_index : indexes[i].get());
+                if (index_hnsw != nullptr) {
+                    entry_points[i] = build_hnsw_entry_points(*index_hnsw, num_entry_points);
+                }
+            }
+            rc.ElapseFromBegin("done");
+        } catch (const std::exception& e) {
+            // the searches descend the upper levels instead
+            entry_points.clear();
+            LOG_KNOWHERE_WARNING_ << "failed to build the entry points of the HNSW index: " << e.what();
+        }
+    }
+
+    // (re)builds the inline layouts of the indices if they are enabled
     Status
-    AddInternal(const DataSetPtr dataset, const Config&) override {
+    UpdateInlineLayouts(const Config& cfg) {
+        inline_layouts.clear();
+        if (!static_cast<const FaissHnswConfig&>(cfg).inline_layout.value_or(false)) {
+            return Status::success;
+        }
+        return BuildInlineLayouts();
+    }
+
+    Status
+    BuildInlineLayouts() {
+        try {
+            knowhere::TimeRecorder rc("HNSW inline layout", 2);
+            inline_layouts.resize(indexes.size());
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                auto index_refine = dynamic_cast<const faiss::IndexRefine*>(indexes[i].get());
+                auto index_hnsw = dynamic_cast<const faiss::IndexHNSW*>(
+                    index_refine != nullptr ? index_refine->base_index : indexes[i].get());
+                if (index_hnsw != nullptr) {
+                    inline_layouts[i] = HnswInlineLayout::create(*index_hnsw);
+                }
+                if (inline_layouts[i] == nullptr) {
+                    LOG_KNOWHERE_WARNING_ << "The storage of this HNSW Index does not support the inline layout.";
+                }
+            }
+            rc.ElapseFromBegin("done");
+        } catch (const std::exception& e) {
+            inline_layouts.clear();
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return Status::faiss_inner_error;
+        }
+        return Status::success;
+    }
+
+    Status
+    AddInternal(const DataSetPtr dataset, const Config& cfg) override {
         if (isIndexEmpty()) {
             LOG_KNOWHERE_ERROR_ << "Can not add data to an empty index.";
             return Status::empty_index;
         }
 
         auto rows = dataset->GetRows();
+        const bool graph_reordering = static_cast<const FaissHnswConfig&>(cfg).graph_reordering.value_or(false);
+        const bool bulk_build = static_cast<const FaissHnswConfig&>(cfg).bulk_build.value_or(false);
 
         const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
-            dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+            getScalarInfoMap(dataset);
         if (scalar_info_map.empty() || tmp_combined_scalar_ids.size() <= 1) {
+            if (!labels.empty()) {
+                // the labels of a reordered index only cover the rows it was built with
+                LOG_KNOWHERE_ERROR_ << "Can not add data to a reordered HNSW Index.";
+                return Status::not_implemented;
+            }
             try {
                 LOG_KNOWHERE_INFO_ << "Adding " << rows << " rows to HNSW Index";
 
-                auto status = add_to_index(indexes[0].get(), dataset, data_format);
-                return status;
+                auto status = add_to_hnsw_index(indexes[0].get(), bulk_build, [&](faiss::Index* index) {
+                    return add_to_index(index, dataset, data_format);
+                });
+                if (status != Status::success || !graph_reordering) {
+                    return status;
+                }
+                return ReorderGraphs();
             } catch (const std::exception& e) {
                 LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
                 return Status::faiss_inner_error;
@@ -1661,19 +2918,29 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         try {
             for (const auto& [field_id, scalar_info] : scalar_info_map) {
                 for (auto i = 0; i < tmp_combined_scalar_ids.size(); ++i) {
-                    for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
-                        auto id = tmp_combined_scalar_ids[i][j];
-                        // hnsw
-                        LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to HNSW Index";
-
-                        auto status =
-                            add_partial_dataset_to_index(indexes[i].get(), dataset, data_format, scalar_info[id]);
-                        if (status != Status::success) {
-                            return status;
+                    // structured bindings can not be captured in C++17
+                    auto add_rows = [&, &scalar_info = scalar_info](faiss::Index* index) {
+                        for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
+                            auto id = tmp_combined_scalar_ids[i][j];
+                            // hnsw
+                            LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to HNSW Index";
+
+                            auto status = add_partial_dataset_to_index(index, dataset, data_format, scalar_info[id]);
+                            if (status != Status::success) {
+                                return status;
+                            }
                         }
+                        return Status::success;
+                    };
+                    auto status = add_to_hnsw_index(indexes[i].get(), bulk_build, add_rows);
+                    if (status != Status::success) {
+                        return status;
                     }
                 }
             }
+            if (graph_reordering) {
+                return ReorderGraphs();
+            }
         } catch (const std::exception& e) {
             LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
             return Status::faiss_inner_error;
@@ -1682,6 +2949,271 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         return Status::success;
     }
 
+    // renumbers the nodes of each index in BFS order. The new internal offsets are mapped to the original ids
+    // through the labels, the same way as the ones of the mv-indexes, so a single reordered index is stored in the
+    // mv format with one partition.
+    Status
+    ReorderGraphs() {
+        if (labels.empty()) {
+            const uint32_t rows = indexes[0]->ntotal;
+            labels.push_back(std::make_shared<std::vector<uint32_t>>(rows));
+            std::iota(labels[0]->begin(), labels[0]->end(), 0);
+            index_rows_sum = {0, rows};
+            label_to_internal_offset.resize(rows);
+        }
+
+        knowhere::TimeRecorder rc("HNSW graph reordering", 2);
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            auto perm = reorder_hnsw_index(indexes[i].get());
+            if (!perm.has_value()) {
+                LOG_KNOWHERE_ERROR_ << "Can not reorder the graph of this HNSW Index.";
+                return Status::not_implemented;
+            }
+            auto& partition_labels = *labels[i];
+            permute_vector(partition_labels, perm->data());
+            for (size_t j = 0; j < partition_labels.size(); ++j) {
+                label_to_internal_offset[partition_labels[j]] = index_rows_sum[i] + j;
+            }
+        }
+        rc.ElapseFromBegin("done");
+        return Status::success;
+    }
+
+    // marks the rows as deleted and unlinks them from the graph. The index is compacted once the deleted rows make
+    // up more than tombstone_compaction_ratio of its rows.
+    Status
+    DeleteInternal(const DataSetPtr dataset, const Config& cfg) {
+        if (isIndexEmpty()) {
+            LOG_KNOWHERE_ERROR_ << "Can not delete data from an empty index.";
+            return Status::empty_index;
+        }
+        if (indexes.size() != 1 || !internal_offset_to_most_external_id.empty()) {
+            LOG_KNOWHERE_ERROR_ << "Can not delete data from a partitioned HNSW Index.";
+            return Status::not_implemented;
+        }
+        auto index_refine = dynamic_cast<faiss::IndexRefine*>(indexes[0].get());
+        auto index_hnsw =
+            dynamic_cast<faiss::IndexHNSW*>(index_refine != nullptr ? index_refine->base_index : indexes[0].get());
+        if (index_hnsw == nullptr || !index_hnsw->hnsw.neighbors.is_owned) {
+            LOG_KNOWHERE_ERROR_ << "Can not delete data from this HNSW Index.";
+            return Status::not_implemented;
+        }
+
+        const auto rows = dataset->GetRows();
+        const auto* ids = dataset->GetIds();
+        const size_t num_ids = NumIds();
+        if (rows > 0 && ids == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "The ids of the rows to delete are missing.";
+            return Status::invalid_args;
+        }
+        for (int64_t i = 0; i < rows; ++i) {
+            if (ids[i] < 0 || static_cast<size_t>(ids[i]) >= num_ids) {
+                LOG_KNOWHERE_ERROR_ << "Can not delete the row " << ids[i] << " from an HNSW Index of " << num_ids
+                                    << " rows.";
+                return Status::invalid_args;
+            }
+        }
+        tombstones.resize((num_ids + 7) / 8, 0);
+        for (int64_t i = 0; i < rows; ++i) {
+            if (!IsDeleted(ids[i])) {
+                tombstones[ids[i] >> 3] |= (0x1 << (ids[i] & 0x7));
+                num_tombstones++;
+            }
+        }
+
+        try {
+            knowhere::TimeRecorder rc("HNSW delete", 2);
+            // the deleted rows that are still in the index
+            const faiss::idx_t ntotal = index_hnsw->ntotal;
+            std::vector<bool> deleted(ntotal, false);
+            size_t num_deleted = 0;
+            for (size_t id = 0; id < num_ids; ++id) {
+                if (!IsDeleted(id)) {
+                    continue;
+                }
+                const size_t offset = labels.empty() ? id : label_to_internal_offset[id];
+                if (offset < static_cast<size_t>(ntotal)) {
+                    deleted[offset] = true;
+                    num_deleted++;
+                }
+            }
+
+            const size_t num_repaired = hnsw_unlink_deleted(*index_hnsw, deleted);
+            LOG_KNOWHERE_INFO_ << "Unlinked " << num_deleted << " deleted rows from HNSW Index, " << num_repaired
+                               << " neighbor lists are repaired";
+
+            const float compaction_ratio =
+                static_cast<const FaissHnswConfig&>(cfg).tombstone_compaction_ratio.value_or(0.3f);
+            if (num_deleted > 0 && num_deleted > ntotal * compaction_ratio) {
+                CompactGraph(deleted);
+            }
+            rc.ElapseFromBegin("done");
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return Status::faiss_inner_error;
+        }
+
+        BuildEntryPoints();
+        if (inline_layouts.empty()) {
+            return Status::success;
+        }
+        inline_layouts.clear();
+        return BuildInlineLayouts();
+    }
+
+    // removes the deleted rows, already unlinked from the graph, from the index. The remaining rows are mapped to
+    // their ids through the labels, the same way as the ones of a reordered index, and the ids of the removed ones
+    // are mapped past the end of the index.
+    void
+    CompactGraph(const std::vector<bool>& deleted) {
+        auto perm = compact_hnsw_index(indexes[0].get(), deleted);
+        if (!perm.has_value()) {
+            LOG_KNOWHERE_INFO_ << "The storage of this HNSW Index can not be compacted, keeping the deleted rows.";
+            return;
+        }
+        if (labels.empty()) {
+            const uint32_t rows = deleted.size();
+            labels.push_back(std::make_shared<std::vector<uint32_t>>(rows));
+            std::iota(labels[0]->begin(), labels[0]->end(), 0);
+            label_to_internal_offset.resize(rows);
+        }
+
+        const uint32_t n_remaining = perm->size();
+        // the labels may be shared with the iterators, so they are replaced rather than modified
+        auto remaining_labels = std::make_shared<std::vector<uint32_t>>(n_remaining);
+        for (uint32_t j = 0; j < n_remaining; ++j) {
+            (*remaining_labels)[j] = (*labels[0])[(*perm)[j]];
+        }
+        for (const auto label : *labels[0]) {
+            label_to_internal_offset[label] = n_remaining;
+        }
+        for (uint32_t j = 0; j < n_remaining; ++j) {
+            label_to_internal_offset[(*remaining_labels)[j]] = j;
+        }
+        labels[0] = std::move(remaining_labels);
+        index_rows_sum = {0, n_remaining};
+        LOG_KNOWHERE_INFO_ << "Compacted HNSW Index to " << n_remaining << " rows";
+    }
+
+    // the index that Merge() supports: a single IndexHNSW, neither reordered nor refined and without deleted rows,
+    // whose graph is in memory and whose storage can be permuted. nullptr otherwise.
+    const faiss::IndexHNSW*
+    GetMergeableIndex() const {
+        if (isIndexEmpty() || indexes.size() != 1 || !labels.empty() || !internal_offset_to_most_external_id.empty() ||
+            num_tombstones > 0) {
+            return nullptr;
+        }
+        auto index_hnsw = dynamic_cast<const faiss::IndexHNSW*>(indexes[0].get());
+        if (index_hnsw == nullptr || !index_hnsw->hnsw.neighbors.is_owned ||
+            !get_permutable_storage(index_hnsw->storage).has_value()) {
+            return nullptr;
+        }
+        return index_hnsw;
+    }
+
+    // merges the graph of the index with fewer remaining rows into the graph of the other one (@see
+    // hnsw_merge_graph), after the dropped rows of the latter are unlinked from it and removed. The nodes are then
+    // renumbered in the order of the rows, the remaining ones of this index first.
+    Status
+    MergeInternal(const BaseFaissRegularIndexHNSWNode& other, const BitsetView& bitset, const Config& cfg) {
+        const faiss::IndexHNSW* this_hnsw = GetMergeableIndex();
+        const faiss::IndexHNSW* other_hnsw = other.GetMergeableIndex();
+        if (this_hnsw == nullptr || other_hnsw == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "Can not merge these HNSW Indexes, the index of their rows is to be built instead.";
+            return Status::not_implemented;
+        }
+        if (this_hnsw->d != other_hnsw->d || this_hnsw->metric_type != other_hnsw->metric_type ||
+            typeid(*this_hnsw->storage) != typeid(*other_hnsw->storage)) {
+            LOG_KNOWHERE_ERROR_ << "Can not merge HNSW Indexes of different dimensions or metrics.";
+            return Status::invalid_args;
+        }
+        const size_t n_this = this_hnsw->ntotal;
+        const size_t n_other = other_hnsw->ntotal;
+        if (!bitset.empty() && bitset.size() != n_this + n_other) {
+            LOG_KNOWHERE_ERROR_ << "The bitset of a merge of HNSW Indexes of " << n_this << " and " << n_other
+                                << " rows has " << bitset.size() << " bits.";
+            return Status::invalid_args;
+        }
+        std::vector<bool> deleted_this(n_this, false);
+        std::vector<bool> deleted_other(n_other, false);
+        size_t live_this = n_this;
+        size_t live_other = n_other;
+        if (!bitset.empty()) {
+            for (size_t i = 0; i < n_this; ++i) {
+                deleted_this[i] = bitset.test(i);
+                live_this -= deleted_this[i];
+            }
+            for (size_t i = 0; i < n_other; ++i) {
+                deleted_other[i] = bitset.test(n_this + i);
+                live_other -= deleted_other[i];
+            }
+        }
+
+        try {
+            knowhere::TimeRecorder rc("HNSW merge", 2);
+            // the graph of the larger index is kept. It is merged into in a copy, which replaces the index of this
+            // node once complete, so that a merge that throws leaves both indexes as they were
+            const bool keep_this = live_this >= live_other;
+            std::unique_ptr<faiss::Index> copy;
+            {
+                faiss::VectorIOWriter writer;
+                faiss::write_index(keep_this ? this_hnsw : other_hnsw, &writer);
+                faiss::VectorIOReader reader;
+                reader.data = std::move(writer.data);
+                copy.reset(faiss::read_index(&reader));
+            }
+            faiss::Index* kept = copy.get();
+            auto kept_hnsw = dynamic_cast<faiss::IndexHNSW*>(kept);
+            const faiss::IndexHNSW& merged_hnsw = keep_this ? *other_hnsw : *this_hnsw;
+            const auto& kept_deleted = keep_this ? deleted_this : deleted_other;
+            const auto& merged_deleted = keep_this ? deleted_other : deleted_this;
+
+            if (std::find(kept_deleted.begin(), kept_deleted.end(), true) != kept_deleted.end()) {
+                hnsw_unlink_deleted(*kept_hnsw, kept_deleted);
+                compact_hnsw_index(kept, kept_deleted);
+            }
+
+            // the remaining vectors of the merged index are appended to the storage of the kept one
+            const int64_t dim = kept_hnsw->d;
+            const int64_t n_merged = keep_this ? live_other : live_this;
+            std::vector<int64_t> new_ids(merged_deleted.size(), -1);
+            std::vector<float> vectors(n_merged * dim);
+            for (size_t i = 0, j = 0; i < merged_deleted.size(); ++i) {
+                if (!merged_deleted[i]) {
+                    new_ids[i] = kept_hnsw->ntotal + j;
+                    merged_hnsw.storage->reconstruct(i, vectors.data() + (j++) * dim);
+                }
+            }
+            kept_hnsw->storage->add(n_merged, vectors.data());
+            kept_hnsw->hnsw.efConstruction = static_cast<const FaissHnswConfig&>(cfg).efConstruction.value();
+            const size_t n_linked = hnsw_merge_graph(*kept_hnsw, merged_hnsw.hnsw, new_ids);
+
+            if (!keep_this) {
+                // the remaining rows of this index come first, perm[new_id] = old_id
+                std::vector<faiss::idx_t> perm(live_this + live_other);
+                std::iota(perm.begin(), perm.begin() + live_this, live_other);
+                std::iota(perm.begin() + live_this, perm.end(), 0);
+                get_permutable_storage(kept_hnsw->storage)->permute(perm.data());
+                kept_hnsw->hnsw.permute_entries(perm.data());
+            }
+            indexes[0] = std::move(copy);
+            LOG_KNOWHERE_INFO_ << "Merged " << n_merged << " rows into an HNSW Index of "
+                               << (kept_hnsw->ntotal - n_merged) << " rows, " << n_linked
+                               << " neighbor lists are linked to them";
+            rc.ElapseFromBegin("done");
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return Status::faiss_inner_error;
+        }
+
+        BuildEntryPoints();
+        if (inline_layouts.empty()) {
+            return Status::success;
+        }
+        inline_layouts.clear();
+        return BuildInlineLayouts();
+    }
+
     const faiss::Index*
     GetIndexToReconstructRawDataFrom(int i) const {
         if (indexes.size() <= i) {
@@ -1717,11 +3249,12 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             // refined index
 
             // refine index holds the raw data
-            auto index_data_format = get_index_data_format(index_refine->refine_index);
+            const faiss::Index* final_refine_index = get_final_refine_index(index_refine->refine_index);
+            auto index_data_format = get_index_data_format(final_refine_index);
 
             // make sure that its data format matches our input format
             if (index_data_format.has_value() && index_data_format.value() == data_format) {
-                index_to_reconstruct_from = index_refine->refine_index;
+                index_to_reconstruct_from = final_refine_index;
             }
         }
 
@@ -1729,10 +3262,49 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
         return index_to_reconstruct_from;
     }
 
+    // splits the rows of dataset into the shards of a sharded build, unless they have scalar info or are too few
+    Status
+    InitShards(const DataSetPtr& dataset, const FaissHnswConfig& hnsw_cfg) {
+        tmp_shard_info.clear();
+        sharded = false;
+        const auto rows = dataset->GetRows();
+        const int64_t num_shards = std::min<int64_t>(hnsw_cfg.shards.value_or(1), rows / kHnswMinShardRows);
+        const bool has_scalar_info =
+            !dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO).empty();
+        if (num_shards <= 1 || has_scalar_info) {
+            return Status::success;
+        }
+
+        knowhere::TimeRecorder rc("HNSW sharding", 2);
+        const bool clustered = str_to_lower(hnsw_cfg.shard_type.value_or("random")) == "clustered";
+        tmp_shard_info = shard_rows(dataset->GetTensor(), data_format, rows, dataset->GetDim(), num_shards, clustered);
+        if (tmp_shard_info.empty()) {
+            LOG_KNOWHERE_ERROR_ << "Unsupported data format";
+            return Status::invalid_args;
+        }
+        if (tmp_shard_info.size() == 1) {
+            tmp_shard_info.clear();
+        }
+        LOG_KNOWHERE_INFO_ << "Split " << rows << " rows into " << std::max<size_t>(tmp_shard_info.size(), 1)
+                           << " HNSW shards";
+        rc.ElapseFromBegin("done");
+        return Status::success;
+    }
+
+    // the scalar info of the rows of dataset, or their shards for a sharded build
+    std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>
+    getScalarInfoMap(const DataSetPtr& dataset) const {
+        if (!tmp_shard_info.empty()) {
+            return {{0, tmp_shard_info}};
+        }
+        return dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+    }
+
     Status
     TrainIndexByScalarInfo(std::function<Status(const float* data, const int i, const int64_t rows)> train_index,
                            const std::vector<std::vector<uint32_t>>& scalar_info, const void* data, const int64_t rows,
                            const int64_t dim) {
+        sharded = !tmp_shard_info.empty();
         label_to_internal_offset.resize(rows);
         index_rows_sum.resize(tmp_combined_scalar_ids.size() + 1);
         labels.resize(tmp_combined_scalar_ids.size());
@@ -1791,6 +3363,10 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             LOG_KNOWHERE_ERROR_ << "Unsupported data format";
             return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::invalid_args, "unsupported data format");
         }
+        if (sharded) {
+            return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::not_implemented,
+                                                                      "sharded index iterators are not supported");
+        }
 
         // parse parameters
         const auto dim = dataset->GetDim();
@@ -1809,7 +3385,7 @@ class BaseFaissRegularIndexHNSWNode : public BaseFaissRegularIndexNode {
             return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::invalid_args,
                                                                       "partition key value not correctly set");
         }
-        if (indexes.size() > 1) {
+        if (!labels.empty() && !bitset.empty()) {
             size_t num_mv_ids = labels[index_id].get()->size();
             size_t num_mv_filtered_out_ids = num_mv_ids - (bitset.size() - bitset.count());
             if (!bitset.has_out_ids()) {
@@ -1904,6 +3480,11 @@ class BaseFaissRegularIndexHNSWFlatNode : public BaseFaissRegularIndexHNSWNode {
 
         // config
         auto hnsw_cfg = static_cast<const FaissHnswFlatConfig&>(cfg);
+        // a sharded build splits the rows the same way as the scalar info does
+        const auto shard_status = InitShards(dataset, hnsw_cfg);
+        if (shard_status != Status::success) {
+            return shard_status;
+        }
 
         auto metric = Str2FaissMetricType(hnsw_cfg.metric_type.value());
         if (!metric.has_value()) {
@@ -1965,7 +3546,7 @@ class BaseFaissRegularIndexHNSWFlatNode : public BaseFaissRegularIndexHNSWNode {
         };
 
         const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
-            dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+            getScalarInfoMap(dataset);
         if (scalar_info_map.size() > 1) {
             LOG_KNOWHERE_WARNING_ << "vector index build with multiple scalar info is not supported";
             return Status::invalid_args;
@@ -2025,6 +3606,15 @@ class HNSWIndexNodeWithFallback : public IndexNode {
         }
     }
 
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        if (use_base_index) {
+            return base_index->EstimateBuildMemory(dataset, cfg);
+        } else {
+            return fallback_search_index->EstimateBuildMemory(dataset, cfg);
+        }
+    }
+
     Status
     Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
         if (use_base_index) {
@@ -2043,6 +3633,26 @@ class HNSWIndexNodeWithFallback : public IndexNode {
         }
     }
 
+    Status
+    Delete(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        if (use_base_index) {
+            return base_index->Delete(dataset, cfg, use_knowhere_build_pool);
+        } else {
+            return fallback_search_index->Delete(dataset, cfg, use_knowhere_build_pool);
+        }
+    }
+
+    Status
+    Merge(const IndexNode& other, const BitsetView& bitset, std::shared_ptr<Config> cfg,
+          bool use_knowhere_build_pool) override {
+        auto other_node = dynamic_cast<const HNSWIndexNodeWithFallback*>(&other);
+        if (!use_base_index || other_node == nullptr || !other_node->use_base_index) {
+            LOG_KNOWHERE_ERROR_ << "Can not merge HNSW Indexes of an old version.";
+            return Status::not_implemented;
+        }
+        return base_index->Merge(*other_node->base_index, bitset, cfg, use_knowhere_build_pool);
+    }
+
     expected<DataSetPtr>
     GetIndexMeta(std::unique_ptr<Config> cfg) const override {
         if (use_base_index) {
@@ -2061,6 +3671,15 @@ class HNSWIndexNodeWithFallback : public IndexNode {
         }
     }
 
+    Status
+    SerializeToFile(const std::string& filename) const override {
+        if (use_base_index) {
+            return base_index->SerializeToFile(filename);
+        } else {
+            return fallback_search_index->SerializeToFile(filename);
+        }
+    }
+
     Status
     Deserialize(const BinarySet& binset, std::shared_ptr<Config> config) override {
         if (use_base_index) {
@@ -2079,6 +3698,24 @@ class HNSWIndexNodeWithFallback : public IndexNode {
         }
     }
 
+    Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) override {
+        if (use_base_index) {
+            return base_index->Warmup(level, progress);
+        } else {
+            return fallback_search_index->Warmup(level, progress);
+        }
+    }
+
+    Status
+    Cooldown() override {
+        if (use_base_index) {
+            return base_index->Cooldown();
+        } else {
+            return fallback_search_index->Cooldown();
+        }
+    }
+
     int64_t
     Dim() const override {
         if (use_base_index) {
@@ -2106,6 +3743,15 @@ class HNSWIndexNodeWithFallback : public IndexNode {
         }
     }
 
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        if (use_base_index) {
+            return base_index->GetMemoryReport();
+        } else {
+            return fallback_search_index->GetMemoryReport();
+        }
+    }
+
     std::string
     Type() const override {
         if (use_base_index) {
@@ -2142,6 +3788,16 @@ class HNSWIndexNodeWithFallback : public IndexNode {
         }
     }
 
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override {
+        if (use_base_index) {
+            return base_index->SearchWithBuf(dataset, std::move(cfg), bitset, ids, distances);
+        } else {
+            return fallback_search_index->SearchWithBuf(dataset, std::move(cfg), bitset, ids, distances);
+        }
+    }
+
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
         if (use_base_index) {
@@ -2161,6 +3817,16 @@ class HNSWIndexNodeWithFallback : public IndexNode {
         }
     }
 
+    expected<DataSetPtr>
+    GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column, std::unique_ptr<Config> cfg,
+                  const BitsetView& bitset) const override {
+        if (use_base_index) {
+            return base_index->GroupBySearch(dataset, column, std::move(cfg), bitset);
+        } else {
+            return fallback_search_index->GroupBySearch(dataset, column, std::move(cfg), bitset);
+        }
+    }
+
     std::shared_ptr<std::vector<uint32_t>>
     GetInternalIdToExternalIdMap() const override {
         if (use_base_index) {
@@ -2255,6 +3921,11 @@ class BaseFaissRegularIndexHNSWSQNode : public BaseFaissRegularIndexHNSWNode {
 
         // config
         auto hnsw_cfg = static_cast<const FaissHnswSqConfig&>(cfg);
+        // a sharded build splits the rows the same way as the scalar info does
+        const auto shard_status = InitShards(dataset, hnsw_cfg);
+        if (shard_status != Status::success) {
+            return shard_status;
+        }
 
         auto metric = Str2FaissMetricType(hnsw_cfg.metric_type.value());
         if (!metric.has_value()) {
@@ -2262,26 +3933,45 @@ class BaseFaissRegularIndexHNSWSQNode : public BaseFaissRegularIndexHNSWNode {
             return Status::invalid_metric_type;
         }
 
-        // parse a ScalarQuantizer type
+        // parse a ScalarQuantizer type, unless the quantizer is a non-uniform one
+        const auto nusq_bits = get_non_uniform_sq_bits(hnsw_cfg.sq_type.value());
         auto sq_type = get_sq_quantizer_type(hnsw_cfg.sq_type.value());
-        if (!sq_type.has_value()) {
+        if (!nusq_bits.has_value() && !sq_type.has_value()) {
             LOG_KNOWHERE_ERROR_ << "Invalid scalar quantizer type: " << hnsw_cfg.sq_type.value();
             return Status::invalid_args;
         }
 
         // create an index
         const bool is_cosine = IsMetricType(hnsw_cfg.metric_type.value(), metric::COSINE);
+        // the codes of the leading dimensions only, if prefix_dim is set
+        const int64_t code_dim = hnsw_cfg.prefix_dim.value_or(dim);
 
         // should refine be used?
         std::unique_ptr<faiss::Index> final_index;
 
         auto train_index = [&](const float* data, const int i, const int64_t rows) {
             std::unique_ptr<faiss::IndexHNSW> hnsw_index;
-            if (is_cosine) {
-                hnsw_index = std::make_unique<faiss::IndexHNSWSQCosine>(dim, sq_type.value(), hnsw_cfg.M.value());
-            } else {
+            if (nusq_bits.has_value()) {
+                if (is_cosine) {
+                    hnsw_index = std::make_unique<faiss::IndexHNSWNonUniformSQCosine>(code_dim, nusq_bits.value(),
+                                                                                      hnsw_cfg.M.value());
+                } else {
+                    hnsw_index = std::make_unique<faiss::IndexHNSWNonUniformSQ>(code_dim, nusq_bits.value(),
+                                                                                hnsw_cfg.M.value(), metric.value());
+                }
+            } else if (is_cosine) {
                 hnsw_index =
-                    std::make_unique<faiss::IndexHNSWSQ>(dim, sq_type.value(), hnsw_cfg.M.value(), metric.value());
+                    std::make_unique<faiss::IndexHNSWSQCosine>(code_dim, sq_type.value(), hnsw_cfg.M.value());
+            } else {
+                hnsw_index = std::make_unique<faiss::IndexHNSWSQ>(code_dim, sq_type.value(), hnsw_cfg.M.value(),
+                                                                  metric.value());
+            }
+            if (code_dim != dim) {
+                // the graph is built and traversed with the distances of the leading dimensions, the refine reranks
+                // its candidates with all of them
+                hnsw_index->storage =
+                    make_prefix_dim_index(dim, std::unique_ptr<faiss::Index>(hnsw_index->storage)).release();
+                hnsw_index->d = dim;
             }
 
             hnsw_index->hnsw.efConstruction = hnsw_cfg.efConstruction.value();
@@ -2291,7 +3981,7 @@ class BaseFaissRegularIndexHNSWSQNode : public BaseFaissRegularIndexHNSWNode {
                 const auto hnsw_d = hnsw_index->storage->d;
                 const auto hnsw_metric_type = hnsw_index->storage->metric_type;
                 auto final_index_cnd = pick_refine_index(data_format, hnsw_cfg.refine_type, std::move(hnsw_index),
-                                                         hnsw_d, hnsw_metric_type);
+                                                         hnsw_d, hnsw_metric_type, hnsw_cfg.refine_cascade_type);
                 if (!final_index_cnd.has_value()) {
                     return Status::invalid_args;
                 }
@@ -2316,7 +4006,7 @@ class BaseFaissRegularIndexHNSWSQNode : public BaseFaissRegularIndexHNSWNode {
         };
 
         const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
-            dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+            getScalarInfoMap(dataset);
         if (scalar_info_map.size() > 1) {
             LOG_KNOWHERE_WARNING_ << "vector index build with multiple scalar info is not supported";
             return Status::invalid_args;
@@ -2354,8 +4044,9 @@ class BaseFaissRegularIndexHNSWSQNodeTemplate : public BaseFaissRegularIndexHNSW
     StaticHasRawData(const knowhere::BaseConfig& config, const IndexVersion& version) {
         auto hnsw_sq_cfg = static_cast<const FaissHnswSqConfig&>(config);
 
+        // the codes of the leading dimensions do not hold the raw data
         auto sq_type = get_sq_quantizer_type(hnsw_sq_cfg.sq_type.value());
-        if (has_lossless_quant(sq_type, datatype_v<DataType>)) {
+        if (!hnsw_sq_cfg.prefix_dim.has_value() && has_lossless_quant(sq_type, datatype_v<DataType>)) {
             return true;
         }
 
@@ -2386,7 +4077,8 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
     }
 
  protected:
-    std::vector<std::unique_ptr<faiss::IndexPQ>> tmp_index_pq;
+    // PQ codes, behind a rotation if pq_rotation is set
+    std::vector<std::unique_ptr<faiss::Index>> tmp_index_pq;
 
     Status
     TrainInternal(const DataSetPtr dataset, const Config& cfg) override {
@@ -2399,6 +4091,11 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
 
         // config
         auto hnsw_cfg = static_cast<const FaissHnswPqConfig&>(cfg);
+        // a sharded build splits the rows the same way as the scalar info does
+        const auto shard_status = InitShards(dataset, hnsw_cfg);
+        if (shard_status != Status::success) {
+            return shard_status;
+        }
 
         if (rows < (1 << hnsw_cfg.nbits.value())) {
             LOG_KNOWHERE_ERROR_ << rows << " rows not enough, needs at least " << (1 << hnsw_cfg.nbits.value())
@@ -2414,6 +4111,7 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
 
         // create an index
         const bool is_cosine = IsMetricType(hnsw_cfg.metric_type.value(), metric::COSINE);
+        const auto pq_rotation = str_to_lower(hnsw_cfg.pq_rotation.value_or("none"));
 
         // HNSW + PQ index yields BAD recall somewhy.
         // Let's build HNSW+FLAT index, then replace FLAT with PQ
@@ -2428,8 +4126,11 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
             hnsw_index->hnsw.efConstruction = hnsw_cfg.efConstruction.value();
 
             // pq
-            std::unique_ptr<faiss::IndexPQ> pq_index;
-            if (is_cosine) {
+            std::unique_ptr<faiss::Index> pq_index;
+            if (pq_rotation != "none") {
+                pq_index.reset(faiss::make_rotated_pq_storage(dim, hnsw_cfg.m.value(), hnsw_cfg.nbits.value(),
+                                                              metric.value(), is_cosine, pq_rotation == "opq"));
+            } else if (is_cosine) {
                 pq_index = std::make_unique<faiss::IndexPQCosine>(dim, hnsw_cfg.m.value(), hnsw_cfg.nbits.value());
             } else {
                 pq_index =
@@ -2443,7 +4144,7 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
                 const auto hnsw_d = hnsw_index->storage->d;
                 const auto hnsw_metric_type = hnsw_index->storage->metric_type;
                 auto final_index_cnd = pick_refine_index(data_format, hnsw_cfg.refine_type, std::move(hnsw_index),
-                                                         hnsw_d, hnsw_metric_type);
+                                                         hnsw_d, hnsw_metric_type, hnsw_cfg.refine_cascade_type);
                 if (!final_index_cnd.has_value()) {
                     return Status::invalid_args;
                 }
@@ -2466,7 +4167,7 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
             LOG_KNOWHERE_INFO_ << "Training PQ Index";
 
             pq_index->train(rows, data);
-            pq_index->pq.compute_sdc_table();
+            faiss::get_storage_pq(pq_index.get())->pq.compute_sdc_table();
 
             // done
             indexes[i] = std::move(final_index);
@@ -2475,7 +4176,7 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
         };
 
         const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
-            dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+            getScalarInfoMap(dataset);
         if (scalar_info_map.size() > 1) {
             LOG_KNOWHERE_WARNING_ << "vector index build with multiple scalar info is not supported";
             return Status::invalid_args;
@@ -2507,13 +4208,14 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
     }
 
     Status
-    AddInternal(const DataSetPtr dataset, const Config&) override {
+    AddInternal(const DataSetPtr dataset, const Config& cfg) override {
         if (isIndexEmpty()) {
             LOG_KNOWHERE_ERROR_ << "Can not add data to an empty index.";
             return Status::empty_index;
         }
 
         auto rows = dataset->GetRows();
+        const bool bulk_build = static_cast<const FaissHnswConfig&>(cfg).bulk_build.value_or(false);
 
         auto finalize_index = [&](int i) {
             // we're done.
@@ -2562,13 +4264,15 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
         };
         try {
             const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
-                dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+                getScalarInfoMap(dataset);
 
             if (scalar_info_map.empty() || tmp_combined_scalar_ids.size() <= 1) {
                 // hnsw
                 LOG_KNOWHERE_INFO_ << "Adding " << rows << " to HNSW Index";
 
-                auto status_reg = add_to_index(indexes[0].get(), dataset, data_format);
+                auto status_reg = add_to_hnsw_index(indexes[0].get(), bulk_build, [&](faiss::Index* index) {
+                    return add_to_index(index, dataset, data_format);
+                });
                 if (status_reg != Status::success) {
                     return status_reg;
                 }
@@ -2590,17 +4294,27 @@ class BaseFaissRegularIndexHNSWPQNode : public BaseFaissRegularIndexHNSWNode {
 
             for (const auto& [field_id, scalar_info] : scalar_info_map) {
                 for (auto i = 0; i < tmp_combined_scalar_ids.size(); ++i) {
-                    for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
-                        auto id = tmp_combined_scalar_ids[i][j];
-                        // hnsw
-                        LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to HNSW Index";
-
-                        auto status_reg =
-                            add_partial_dataset_to_index(indexes[i].get(), dataset, data_format, scalar_info[id]);
-                        if (status_reg != Status::success) {
-                            return status_reg;
+                    // hnsw
+                    // structured bindings can not be captured in C++17
+                    auto add_rows = [&, &scalar_info = scalar_info](faiss::Index* index) {
+                        for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
+                            auto id = tmp_combined_scalar_ids[i][j];
+                            LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to HNSW Index";
+
+                            auto status = add_partial_dataset_to_index(index, dataset, data_format, scalar_info[id]);
+                            if (status != Status::success) {
+                                return status;
+                            }
                         }
+                        return Status::success;
+                    };
+                    auto status_reg = add_to_hnsw_index(indexes[i].get(), bulk_build, add_rows);
+                    if (status_reg != Status::success) {
+                        return status_reg;
+                    }
 
+                    for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
+                        auto id = tmp_combined_scalar_ids[i][j];
                         // pq
                         LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to PQ Index";
 
@@ -2674,6 +4388,11 @@ class BaseFaissRegularIndexHNSWPRQNode : public BaseFaissRegularIndexHNSWNode {
 
         // config
         auto hnsw_cfg = static_cast<const FaissHnswPrqConfig&>(cfg);
+        // a sharded build splits the rows the same way as the scalar info does
+        const auto shard_status = InitShards(dataset, hnsw_cfg);
+        if (shard_status != Status::success) {
+            return shard_status;
+        }
 
         if (rows < (1 << hnsw_cfg.nbits.value())) {
             LOG_KNOWHERE_ERROR_ << rows << " rows not enough, needs at least " << (1 << hnsw_cfg.nbits.value())
@@ -2725,7 +4444,7 @@ class BaseFaissRegularIndexHNSWPRQNode : public BaseFaissRegularIndexHNSWNode {
                 const auto hnsw_d = hnsw_index->storage->d;
                 const auto hnsw_metric_type = hnsw_index->storage->metric_type;
                 auto final_index_cnd = pick_refine_index(data_format, hnsw_cfg.refine_type, std::move(hnsw_index),
-                                                         hnsw_d, hnsw_metric_type);
+                                                         hnsw_d, hnsw_metric_type, hnsw_cfg.refine_cascade_type);
                 if (!final_index_cnd.has_value()) {
                     return Status::invalid_args;
                 }
@@ -2756,7 +4475,7 @@ class BaseFaissRegularIndexHNSWPRQNode : public BaseFaissRegularIndexHNSWNode {
             return Status::success;
         };
         const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
-            dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+            getScalarInfoMap(dataset);
         if (scalar_info_map.size() > 1) {
             LOG_KNOWHERE_WARNING_ << "vector index build with multiple scalar info is not supported";
             return Status::invalid_args;
@@ -2789,13 +4508,14 @@ class BaseFaissRegularIndexHNSWPRQNode : public BaseFaissRegularIndexHNSWNode {
     }
 
     Status
-    AddInternal(const DataSetPtr dataset, const Config&) override {
+    AddInternal(const DataSetPtr dataset, const Config& cfg) override {
         if (isIndexEmpty()) {
             LOG_KNOWHERE_ERROR_ << "Can not add data to an empty index.";
             return Status::empty_index;
         }
 
         auto rows = dataset->GetRows();
+        const bool bulk_build = static_cast<const FaissHnswConfig&>(cfg).bulk_build.value_or(false);
 
         auto finalize_index = [&](int i) {
             // we're done.
@@ -2844,13 +4564,15 @@ class BaseFaissRegularIndexHNSWPRQNode : public BaseFaissRegularIndexHNSWNode {
         };
         try {
             const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
-                dataset->Get<std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>>(meta::SCALAR_INFO);
+                getScalarInfoMap(dataset);
 
             if (scalar_info_map.empty() || tmp_combined_scalar_ids.size() <= 1) {
                 // hnsw
                 LOG_KNOWHERE_INFO_ << "Adding " << rows << " to HNSW Index";
 
-                auto status_reg = add_to_index(indexes[0].get(), dataset, data_format);
+                auto status_reg = add_to_hnsw_index(indexes[0].get(), bulk_build, [&](faiss::Index* index) {
+                    return add_to_index(index, dataset, data_format);
+                });
                 if (status_reg != Status::success) {
                     return status_reg;
                 }
@@ -2873,17 +4595,27 @@ class BaseFaissRegularIndexHNSWPRQNode : public BaseFaissRegularIndexHNSWNode {
 
             for (const auto& [field_id, scalar_info] : scalar_info_map) {
                 for (auto i = 0; i < tmp_combined_scalar_ids.size(); ++i) {
-                    for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
-                        auto id = tmp_combined_scalar_ids[i][j];
-                        // hnsw
-                        LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to HNSW Index";
-
-                        auto status_reg =
-                            add_partial_dataset_to_index(indexes[i].get(), dataset, data_format, scalar_info[id]);
-                        if (status_reg != Status::success) {
-                            return status_reg;
+                    // hnsw
+                    // structured bindings can not be captured in C++17
+                    auto add_rows = [&, &scalar_info = scalar_info](faiss::Index* index) {
+                        for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
+                            auto id = tmp_combined_scalar_ids[i][j];
+                            LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to HNSW Index";
+
+                            auto status = add_partial_dataset_to_index(index, dataset, data_format, scalar_info[id]);
+                            if (status != Status::success) {
+                                return status;
+                            }
                         }
+                        return Status::success;
+                    };
+                    auto status_reg = add_to_hnsw_index(indexes[i].get(), bulk_build, add_rows);
+                    if (status_reg != Status::success) {
+                        return status_reg;
+                    }
 
+                    for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
+                        auto id = tmp_combined_scalar_ids[i][j];
                         // prq
                         LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to PQ Index";
 
@@ -2921,6 +4653,287 @@ class BaseFaissRegularIndexHNSWPRQNodeTemplate : public BaseFaissRegularIndexHNS
     }
 };
 
+// this index trains RaBitQ and HNSW+FLAT separately, then constructs HNSW+RaBitQ
+class BaseFaissRegularIndexHNSWRaBitQNode : public BaseFaissRegularIndexHNSWNode {
+ public:
+    BaseFaissRegularIndexHNSWRaBitQNode(const int32_t& version, const Object& object, DataFormatEnum data_format)
+        : BaseFaissRegularIndexHNSWNode(version, object, data_format) {
+    }
+
+    static std::unique_ptr<BaseConfig>
+    StaticCreateConfig() {
+        return std::make_unique<FaissHnswRaBitQConfig>();
+    }
+
+    std::unique_ptr<BaseConfig>
+    CreateConfig() const override {
+        return StaticCreateConfig();
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::IndexEnum::INDEX_HNSW_RABITQ;
+    }
+
+ protected:
+    // a random rotation followed by RaBitQ codes
+    std::vector<std::unique_ptr<faiss::IndexPreTransform>> tmp_index_rabitq;
+
+    Status
+    TrainInternal(const DataSetPtr dataset, const Config& cfg) override {
+        // number of rows
+        auto rows = dataset->GetRows();
+        // dimensionality of the data
+        auto dim = dataset->GetDim();
+        // data
+        const void* data = dataset->GetTensor();
+
+        // config
+        auto hnsw_cfg = static_cast<const FaissHnswRaBitQConfig&>(cfg);
+        // a sharded build splits the rows the same way as the scalar info does
+        const auto shard_status = InitShards(dataset, hnsw_cfg);
+        if (shard_status != Status::success) {
+            return shard_status;
+        }
+
+        auto metric = Str2FaissMetricType(hnsw_cfg.metric_type.value());
+        if (!metric.has_value()) {
+            LOG_KNOWHERE_ERROR_ << "Invalid metric type: " << hnsw_cfg.metric_type.value();
+            return Status::invalid_metric_type;
+        }
+
+        // create an index
+        const bool is_cosine = IsMetricType(hnsw_cfg.metric_type.value(), metric::COSINE);
+
+        // the graph is built over the original vectors, then FLAT is replaced with RaBitQ
+        auto train_index = [&](const float* data, const int i, const int64_t rows) {
+            std::unique_ptr<faiss::IndexHNSW> hnsw_index;
+            if (is_cosine) {
+                hnsw_index = std::make_unique<faiss::IndexHNSWFlatCosine>(dim, hnsw_cfg.M.value());
+            } else {
+                hnsw_index = std::make_unique<faiss::IndexHNSWFlat>(dim, hnsw_cfg.M.value(), metric.value());
+            }
+
+            hnsw_index->hnsw.efConstruction = hnsw_cfg.efConstruction.value();
+
+            // rabitq
+            std::unique_ptr<faiss::IndexPreTransform> rabitq_index(
+                faiss::make_rotated_rabitq_storage(dim, metric.value(), is_cosine));
+            dynamic_cast<faiss::IndexRaBitQ*>(rabitq_index->index)->qb = hnsw_cfg.rbq_bits_query.value();
+
+            // should refine be used?
+            std::unique_ptr<faiss::Index> final_index;
+            if (hnsw_cfg.refine.value_or(false) && hnsw_cfg.refine_type.has_value()) {
+                // yes
+                const auto hnsw_d = hnsw_index->storage->d;
+                const auto hnsw_metric_type = hnsw_index->storage->metric_type;
+                auto final_index_cnd = pick_refine_index(data_format, hnsw_cfg.refine_type, std::move(hnsw_index),
+                                                         hnsw_d, hnsw_metric_type, hnsw_cfg.refine_cascade_type);
+                if (!final_index_cnd.has_value()) {
+                    return Status::invalid_args;
+                }
+
+                // assign
+                final_index = std::move(final_index_cnd.value());
+            } else {
+                // no refine
+
+                // assign
+                final_index = std::move(hnsw_index);
+            }
+
+            // train hnswflat
+            LOG_KNOWHERE_INFO_ << "Training HNSW Index";
+
+            final_index->train(rows, data);
+
+            // train rabitq
+            LOG_KNOWHERE_INFO_ << "Training RaBitQ Index";
+
+            rabitq_index->train(rows, data);
+
+            // done
+            indexes[i] = std::move(final_index);
+            tmp_index_rabitq[i] = std::move(rabitq_index);
+            return Status::success;
+        };
+
+        const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
+            getScalarInfoMap(dataset);
+        if (scalar_info_map.size() > 1) {
+            LOG_KNOWHERE_WARNING_ << "vector index build with multiple scalar info is not supported";
+            return Status::invalid_args;
+        }
+        for (const auto& [field_id, scalar_info] : scalar_info_map) {
+            tmp_combined_scalar_ids =
+                scalar_info.size() > 1 ? combine_partitions(scalar_info, 128) : std::vector<std::vector<int>>();
+        }
+
+        // no scalar info or just one partition(after possible combination), build index on whole data
+        if (scalar_info_map.empty() || tmp_combined_scalar_ids.size() <= 1) {
+            tmp_index_rabitq.resize(1);
+            // we have to convert the data to float, unfortunately, which costs extra RAM
+            auto float_ds_ptr = convert_ds_to_float(dataset, data_format);
+            if (float_ds_ptr == nullptr) {
+                LOG_KNOWHERE_ERROR_ << "Unsupported data format";
+                return Status::invalid_args;
+            }
+            return train_index((const float*)(float_ds_ptr->GetTensor()), 0, rows);
+        }
+
+        LOG_KNOWHERE_INFO_ << "Train HNSWRaBitQ Index with Scalar Info";
+        tmp_index_rabitq.resize(tmp_combined_scalar_ids.size());
+        for (const auto& [field_id, scalar_info] : scalar_info_map) {
+            return TrainIndexByScalarInfo(train_index, scalar_info, data, rows, dim);
+        }
+        return Status::success;
+    }
+
+    Status
+    AddInternal(const DataSetPtr dataset, const Config& cfg) override {
+        if (isIndexEmpty()) {
+            LOG_KNOWHERE_ERROR_ << "Can not add data to an empty index.";
+            return Status::empty_index;
+        }
+
+        auto rows = dataset->GetRows();
+        const bool bulk_build = static_cast<const FaissHnswConfig&>(cfg).bulk_build.value_or(false);
+
+        auto finalize_index = [&](int i) {
+            // we're done.
+            // throw away flat and replace it with rabitq
+
+            // check if we have a refine available.
+            faiss::IndexHNSW* index_hnsw = nullptr;
+
+            faiss::IndexRefine* const index_refine = dynamic_cast<faiss::IndexRefine*>(indexes[i].get());
+
+            if (index_refine != nullptr) {
+                index_hnsw = dynamic_cast<faiss::IndexHNSW*>(index_refine->base_index);
+            } else {
+                index_hnsw = dynamic_cast<faiss::IndexHNSW*>(indexes[i].get());
+            }
+
+            // recreate hnswrabitq
+            std::unique_ptr<faiss::IndexHNSW> index_hnsw_rabitq;
+
+            if (index_hnsw->storage->is_cosine) {
+                index_hnsw_rabitq = std::make_unique<faiss::IndexHNSWRaBitQCosine>();
+            } else {
+                index_hnsw_rabitq = std::make_unique<faiss::IndexHNSWRaBitQ>();
+            }
+
+            // C++ slicing.
+            // we can't use move, because faiss::IndexHNSW overrides a destructor.
+            static_cast<faiss::IndexHNSW&>(*index_hnsw_rabitq) = static_cast<faiss::IndexHNSW&>(*index_hnsw);
+
+            // clear out the storage
+            delete index_hnsw->storage;
+            index_hnsw->storage = nullptr;
+            index_hnsw_rabitq->storage = nullptr;
+
+            // replace storage
+            index_hnsw_rabitq->storage = tmp_index_rabitq[i].release();
+
+            // replace if refine
+            if (index_refine != nullptr) {
+                delete index_refine->base_index;
+                index_refine->base_index = index_hnsw_rabitq.release();
+            } else {
+                indexes[i] = std::move(index_hnsw_rabitq);
+            }
+            return Status::success;
+        };
+        try {
+            const std::unordered_map<int64_t, std::vector<std::vector<uint32_t>>>& scalar_info_map =
+                getScalarInfoMap(dataset);
+
+            if (scalar_info_map.empty() || tmp_combined_scalar_ids.size() <= 1) {
+                // hnsw
+                LOG_KNOWHERE_INFO_ << "Adding " << rows << " to HNSW Index";
+
+                auto status_reg = add_to_hnsw_index(indexes[0].get(), bulk_build, [&](faiss::Index* index) {
+                    return add_to_index(index, dataset, data_format);
+                });
+                if (status_reg != Status::success) {
+                    return status_reg;
+                }
+
+                // rabitq
+                LOG_KNOWHERE_INFO_ << "Adding " << rows << " to RaBitQ Index";
+
+                auto status_rabitq = add_to_index(tmp_index_rabitq[0].get(), dataset, data_format);
+                if (status_rabitq != Status::success) {
+                    return status_rabitq;
+                }
+                return finalize_index(0);
+            }
+            if (scalar_info_map.size() > 1) {
+                LOG_KNOWHERE_WARNING_ << "vector index build with multiple scalar info is not supported";
+                return Status::invalid_args;
+            }
+            LOG_KNOWHERE_INFO_ << "Add data to Index with Scalar Info";
+
+            for (const auto& [field_id, scalar_info] : scalar_info_map) {
+                for (auto i = 0; i < tmp_combined_scalar_ids.size(); ++i) {
+                    // hnsw
+                    // structured bindings can not be captured in C++17
+                    auto add_rows = [&, &scalar_info = scalar_info](faiss::Index* index) {
+                        for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
+                            auto id = tmp_combined_scalar_ids[i][j];
+                            LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to HNSW Index";
+
+                            auto status = add_partial_dataset_to_index(index, dataset, data_format, scalar_info[id]);
+                            if (status != Status::success) {
+                                return status;
+                            }
+                        }
+                        return Status::success;
+                    };
+                    auto status_reg = add_to_hnsw_index(indexes[i].get(), bulk_build, add_rows);
+                    if (status_reg != Status::success) {
+                        return status_reg;
+                    }
+
+                    for (auto j = 0; j < tmp_combined_scalar_ids[i].size(); ++j) {
+                        auto id = tmp_combined_scalar_ids[i][j];
+                        // rabitq
+                        LOG_KNOWHERE_INFO_ << "Adding " << scalar_info[id].size() << " to RaBitQ Index";
+
+                        auto status_rabitq = add_partial_dataset_to_index(tmp_index_rabitq[i].get(), dataset,
+                                                                          data_format, scalar_info[id]);
+
+                        if (status_rabitq != Status::success) {
+                            return status_rabitq;
+                        }
+                    }
+                    finalize_index(i);
+                }
+            }
+
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return Status::faiss_inner_error;
+        }
+
+        return Status::success;
+    }
+};
+
+template <typename DataType>
+class BaseFaissRegularIndexHNSWRaBitQNodeTemplate : public BaseFaissRegularIndexHNSWRaBitQNode {
+ public:
+    BaseFaissRegularIndexHNSWRaBitQNodeTemplate(const int32_t& version, const Object& object)
+        : BaseFaissRegularIndexHNSWRaBitQNode(version, object, datatype_v<DataType>) {
+    }
+
+    static bool
+    StaticHasRawData(const knowhere::BaseConfig& config, const IndexVersion& version) {
+        auto hnsw_cfg = static_cast<const FaissHnswConfig&>(config);
+        return has_lossless_refine_index(hnsw_cfg.refine, hnsw_cfg.refine_type, datatype_v<DataType>);
+    }
+};
+
 #ifdef KNOWHERE_WITH_CARDINAL
 KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(HNSW_DEPRECATED,
                                                 BaseFaissRegularIndexHNSWFlatNodeTemplateWithSearchFallback,
@@ -2944,5 +4957,9 @@ KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(HNSW_PRQ, BaseFaissRegularIndexH
                                                 knowhere::feature::MMAP | knowhere::feature::MV)
 KNOWHERE_SIMPLE_REGISTER_DENSE_INT_GLOBAL(HNSW_PRQ, BaseFaissRegularIndexHNSWPRQNodeTemplate,
                                           knowhere::feature::MMAP | knowhere::feature::MV)
+KNOWHERE_SIMPLE_REGISTER_DENSE_FLOAT_ALL_GLOBAL(HNSW_RABITQ, BaseFaissRegularIndexHNSWRaBitQNodeTemplate,
+                                                knowhere::feature::MMAP | knowhere::feature::MV)
+KNOWHERE_SIMPLE_REGISTER_DENSE_INT_GLOBAL(HNSW_RABITQ, BaseFaissRegularIndexHNSWRaBitQNodeTemplate,
+                                          knowhere::feature::MMAP | knowhere::feature::MV)
 
 }  // namespace knowhere
@@ -29,6 +29,30 @@ class FaissHnswConfig : public BaseHnswConfig {
     CFG_FLOAT refine_k;
     // type of refine
     CFG_STRING refine_type;
+    // type of the intermediate stage of a refine cascade, undefined value leads to a single refine stage
+    CFG_STRING refine_cascade_type;
+    // undefined value leads to a cascade search that keeps all the candidates after the intermediate stage
+    CFG_FLOAT refine_cascade_k;
+    // whether the graph nodes are renumbered in BFS order after the build
+    CFG_BOOL graph_reordering;
+    // whether the graph is built in parallel batches instead of inserting the rows one by one
+    CFG_BOOL bulk_build;
+    // whether the bottom layer of the graph is stored next to the codes for the search
+    CFG_BOOL inline_layout;
+    // whether an mmapped index is warmed up in the background instead of faulting in on the first searches
+    CFG_BOOL lazy_load;
+    // the fraction of deleted rows of the graph above which a delete compacts the index
+    CFG_FLOAT tombstone_compaction_ratio;
+    // the number of sub-graphs the rows are split into, searched in parallel
+    CFG_INT shards;
+    // how the rows are split into the sub-graphs: random or clustered
+    CFG_STRING shard_type;
+    // the expansions without improvement after which a search stops, 0 expands until ef is exhausted
+    CFG_INT early_termination_patience;
+    // the number of cluster representatives the searches start from, 0 descends from the entry point of the graph
+    CFG_INT entry_points;
+    // the strategies a k-NN search is planned from: auto, graph or brute_force
+    CFG_STRING search_strategy;
 
     KNOHWERE_DECLARE_CONFIG(FaissHnswConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(seed_ef)
@@ -51,9 +75,218 @@ class FaissHnswConfig : public BaseHnswConfig {
             .allow_empty_without_default()
             .for_train()
             .for_static();
+        /**
+         * With a refine cascade, the refine_k * k candidates of the graph are
+         * first reranked with the codes of this type (sq4, sq6, sq8, fp16 or
+         * bf16), kept in memory next to the graph, and only the
+         * refine_cascade_k * k best of them are reranked with the codes of
+         * the refine_type, e.g. fp32 ones that can stay mmapped on the disk
+         * since few of them are read by a search.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_cascade_type)
+            .description("the type of the intermediate stage of a refine cascade")
+            .allow_empty_without_default()
+            .for_train()
+            .for_static();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_cascade_k)
+            .description("the ratio of the candidates kept by the intermediate stage of a refine cascade")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_search();
+        /**
+         * If true, the nodes of the graph and their codes are renumbered in
+         * the BFS order of the bottom layer once the rows are added, so that
+         * the neighbors of a node are likely stored close to it. This reduces
+         * cache misses and page faults (when mmapped) during the search.
+         * Search results still use the original ids.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(graph_reordering)
+            .description("whether to reorder the graph nodes to improve the locality of the search")
+            .set_default(false)
+            .for_train();
+        /**
+         * If true, the graph is built once all the rows are added, by
+         * inserting them in batches of growing size: the neighbors of the
+         * rows of a batch are searched in parallel in the graph built so far,
+         * then their reverse links are merged in. No per-node locks are
+         * needed, which makes the build scale to many threads, and the graph
+         * does not depend on the thread scheduling. Indices that already
+         * hold rows insert new ones one by one.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(bulk_build)
+            .description("whether to build the graph in parallel batches")
+            .set_default(false)
+            .for_train();
+        /**
+         * If true, a copy of the bottom layer of the graph is made once the
+         * index is built or loaded, with the fixed-degree neighbor list of
+         * every node stored next to its code in cache line aligned records,
+         * and the search reads it instead of the lists and codes of the
+         * index. This saves a cache miss per expanded node at the cost of a
+         * second copy of the codes. The copy is not serialized.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(inline_layout)
+            .description("whether to store the bottom layer of the graph next to the codes for the search")
+            .set_default(false)
+            .for_train()
+            .for_deserialize()
+            .for_deserialize_from_file();
+        /**
+         * If true, an index loaded with mmap has the pages of its upper
+         * levels and of the neighborhood of its entry point loaded and locked
+         * in memory at once, and the rest of its pages prefetched by a
+         * background thread in the BFS order of the bottom layer from the
+         * entry point. The first searches then do not take a page fault on
+         * every hop, and the index is ready much sooner than if it were
+         * loaded without mmap. Ignored without mmap.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(lazy_load)
+            .description("whether to lock the hot pages of an mmapped index and prefetch the rest in the background")
+            .set_default(false)
+            .for_deserialize_from_file();
+        /**
+         * Deleted rows are only unlinked from the graph, their vectors stay
+         * in the index and are filtered out of the brute-force searches. Once
+         * they make up more than this fraction of the rows of the graph, a
+         * delete also removes them from the storage and renumbers the
+         * remaining nodes, the same way as the graph reordering does.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(tombstone_compaction_ratio)
+            .description("the fraction of deleted rows above which the index is compacted")
+            .set_default(0.3)
+            .set_range(0.0, 1.0)
+            .for_train();
+        /**
+         * If larger than 1, the rows are split into this many sub-graphs,
+         * built as the partitions of a partitioned index are. A search walks
+         * every sub-graph and merges their results; the sub-graphs of a query
+         * are walked in parallel on the search pool when there are too few
+         * queries to keep it busy, so that the latency of a single query on a
+         * huge index goes down with the cores. The rows go to the sub-graphs
+         * at random, or by the k-means clusters of a sample of them. Ignored
+         * by a build with scalar info.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(shards)
+            .description("the number of sub-graphs the rows are split into")
+            .set_default(1)
+            .set_range(1, 1024)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(shard_type)
+            .description("how the rows are split into the sub-graphs, random or clustered")
+            .set_default("random")
+            .for_train();
+        /**
+         * If positive, ef becomes a ceiling: the bottom layer search of a
+         * query stops once this many consecutive expanded nodes did not
+         * bring a filter-passing candidate closer than its k-th nearest
+         * result so far. The easy queries, whose results settle early, stop
+         * well before exhausting ef, while the hard ones keep the recall of
+         * the full ef. Ignored by the range and group-by searches and the
+         * iterators.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(early_termination_patience)
+            .description("the expansions without improvement after which a search stops")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+        /**
+         * If positive, this many representatives of the clusters of the
+         * rows (the rows nearest to the k-means centroids of a sample) are
+         * picked once the index is built or loaded. A k-NN search scans them
+         * and starts its bottom layer search from the few nearest to the
+         * query, instead of descending the upper layers from the single
+         * entry point of the graph, which may be far from the region of the
+         * query on clustered data. The representatives are not serialized.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(entry_points)
+            .description("the number of cluster representatives the searches start from")
+            .set_default(0)
+            .set_range(0, 65536)
+            .for_train()
+            .for_deserialize()
+            .for_deserialize_from_file();
+        /**
+         * The strategies a k-NN search is planned from (@see PlanSearch):
+         * auto picks the cheapest of the graph traversal, the two-hop
+         * traversal and the brute force from their estimated costs, graph
+         * the cheaper of the two traversals, and brute_force scans the rows
+         * that pass the filter. The plan of a query is returned in its
+         * search stats.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_strategy)
+            .description("the strategies a k-NN search is planned from, auto, graph or brute_force")
+            .set_default("auto")
+            .for_search();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        const auto base_status = BaseHnswConfig::CheckAndAdjust(param_type, err_msg);
+        if (base_status != Status::success) {
+            return base_status;
+        }
+        const auto shard_status = CheckShards(param_type, err_msg);
+        if (shard_status != Status::success) {
+            return shard_status;
+        }
+        const auto strategy_status = CheckSearchStrategy(param_type, err_msg);
+        if (strategy_status != Status::success) {
+            return strategy_status;
+        }
+        return CheckRefineCascade(param_type, err_msg);
     }
 
  protected:
+    Status
+    CheckSearchStrategy(PARAM_TYPE param_type, std::string* err_msg) {
+        if (param_type == PARAM_TYPE::SEARCH && search_strategy.has_value()) {
+            auto strategy_tolower = str_to_lower(search_strategy.value());
+            if (strategy_tolower != "auto" && strategy_tolower != "graph" && strategy_tolower != "brute_force") {
+                std::string msg = "invalid search strategy : " + search_strategy.value() +
+                                  ", optional strategies are [auto, graph, brute_force]";
+                return HandleError(err_msg, msg, Status::invalid_args);
+            }
+        }
+        return Status::success;
+    }
+
+    Status
+    CheckShards(PARAM_TYPE param_type, std::string* err_msg) {
+        if (param_type == PARAM_TYPE::TRAIN && shard_type.has_value()) {
+            auto shard_type_tolower = str_to_lower(shard_type.value());
+            if (shard_type_tolower != "random" && shard_type_tolower != "clustered") {
+                std::string msg =
+                    "invalid shard type : " + shard_type.value() + ", optional types are [random, clustered]";
+                return HandleError(err_msg, msg, Status::invalid_args);
+            }
+        }
+        return Status::success;
+    }
+
+    Status
+    CheckRefineCascade(PARAM_TYPE param_type, std::string* err_msg) {
+        if (param_type == PARAM_TYPE::TRAIN && refine_cascade_type.has_value()) {
+            auto cascade_type_tolower = str_to_lower(refine_cascade_type.value());
+            if (!refine_type.has_value()) {
+                std::string msg = "refine_cascade_type requires a refine_type for the last stage of the cascade";
+                return HandleError(err_msg, msg, Status::invalid_args);
+            }
+            if (cascade_type_tolower != "sq4" && (!WhetherAcceptableRefineType(cascade_type_tolower) ||
+                                                  cascade_type_tolower == "fp32" || cascade_type_tolower == "flat")) {
+                std::string msg = "invalid refine cascade type : " + refine_cascade_type.value() +
+                                  ", optional types are [sq4, sq6, sq8, fp16, bf16]";
+                return HandleError(err_msg, msg, Status::invalid_args);
+            }
+        }
+        if (param_type == PARAM_TYPE::SEARCH && refine_cascade_k.has_value() &&
+            refine_cascade_k.value() > refine_k.value_or(1)) {
+            std::string msg = "refine_cascade_k(" + std::to_string(refine_cascade_k.value()) +
+                              ") should not be larger than refine_k(" + std::to_string(refine_k.value_or(1)) + ")";
+            return HandleError(err_msg, msg, Status::invalid_args);
+        }
+        return Status::success;
+    }
+
     bool
     WhetherAcceptableRefineType(const std::string& refine_type) {
         // 'flat' is identical to 'fp32'
@@ -72,6 +305,9 @@ class FaissHnswConfig : public BaseHnswConfig {
 
 class FaissHnswFlatConfig : public FaissHnswConfig {
  public:
+    KNOHWERE_DECLARE_CONFIG(FaissHnswFlatConfig) {
+    }
+
     Status
     CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
         // check the base class
@@ -95,14 +331,30 @@ class FaissHnswFlatConfig : public FaissHnswConfig {
 class FaissHnswSqConfig : public FaissHnswConfig {
  public:
     // user can use quant_type to control quantizer type.
-    // we have fp16, bf16, etc, so '8', '4' and '6' is insufficient
+    // we have fp16, bf16, etc, so '8', '4' and '6' is insufficient.
+    // 'nusq4' and 'nusq6' are non-uniform quantizers, with a learned codebook of 16 or 64 levels per dimension
     CFG_STRING sq_type;
+    // the number of leading dimensions that the codes keep, undefined value leads to codes of all the dimensions
+    CFG_INT prefix_dim;
     KNOHWERE_DECLARE_CONFIG(FaissHnswSqConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(sq_type)
             .set_default("SQ8")
             .description("scalar quantizer type")
             .for_train()
             .for_static();
+        /**
+         * For Matryoshka embeddings, whose leading dimensions carry most of
+         * the signal: the graph is built and traversed with the codes of the
+         * first prefix_dim dimensions only, and the refine reranks its
+         * candidates with all of them. Needs a refine, and the L2 or IP
+         * metric.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(prefix_dim)
+            .description("the number of leading dimensions that the codes keep")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_train()
+            .for_static();
     };
 
     Status
@@ -129,6 +381,23 @@ class FaissHnswSqConfig : public FaissHnswConfig {
                     return HandleError(err_msg, msg, Status::invalid_args);
                 }
             }
+
+            if (prefix_dim.has_value()) {
+                if (!refine.value_or(false) || !refine_type.has_value()) {
+                    std::string msg = "prefix_dim needs a refine over all the dimensions";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+                // the refine of a cosine index divides by the norms that the codes keep
+                if (str_to_lower(metric_type.value()) == str_to_lower(metric::COSINE)) {
+                    std::string msg = "prefix_dim does not support the COSINE metric";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+                if (dim.has_value() && prefix_dim.value() >= dim.value()) {
+                    std::string msg = "prefix_dim (" + std::to_string(prefix_dim.value()) +
+                                      ") should be less than dim (" + std::to_string(dim.value()) + ")";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+            }
         }
         return Status::success;
     }
@@ -137,7 +406,7 @@ class FaissHnswSqConfig : public FaissHnswConfig {
     bool
     WhetherAcceptableQuantType(const std::string& sq_type) {
         // todo: add more
-        std::vector<std::string> allowed_list = {"sq6", "sq8", "fp16", "bf16"};
+        std::vector<std::string> allowed_list = {"sq6", "sq8", "fp16", "bf16", "nusq4", "nusq6"};
         std::string sq_type_tolower = str_to_lower(sq_type);
 
         for (const auto& allowed : allowed_list) {
@@ -156,15 +425,28 @@ class FaissHnswPqConfig : public FaissHnswConfig {
     CFG_INT m;
     // number of bits per subquantizer
     CFG_INT nbits;
+    // the rotation of the vectors before they are encoded, 'none', 'random' or 'opq'.
+    // 'opq' learns the rotation that balances the variance over the subquantizers, which lowers the error of
+    // the codes, so that fewer subquantizers reach the same recall.
+    CFG_STRING pq_rotation;
 
     KNOHWERE_DECLARE_CONFIG(FaissHnswPqConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(m).description("m").set_default(32).for_train().set_range(1, 65536);
         // FAISS rejects nbits > 24, because it is not practical
         KNOWHERE_CONFIG_DECLARE_FIELD(nbits).description("nbits").set_default(8).for_train().set_range(1, 24);
+        KNOWHERE_CONFIG_DECLARE_FIELD(pq_rotation)
+            .description("the rotation of the vectors before the PQ encoding")
+            .set_default("none")
+            .for_train()
+            .for_static();
     }
 
     Status
     CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        const auto cascade_status = CheckRefineCascade(param_type, err_msg);
+        if (cascade_status != Status::success) {
+            return cascade_status;
+        }
         switch (param_type) {
             case PARAM_TYPE::TRAIN: {
                 if (dim.has_value() && m.has_value()) {
@@ -179,6 +461,15 @@ class FaissHnswPqConfig : public FaissHnswConfig {
                     }
                 }
 
+                if (pq_rotation.has_value()) {
+                    const auto rotation = str_to_lower(pq_rotation.value());
+                    if (rotation != "none" && rotation != "random" && rotation != "opq") {
+                        std::string msg =
+                            "invalid pq rotation : " + pq_rotation.value() + ", optional types are [none, random, opq]";
+                        return HandleError(err_msg, msg, Status::invalid_args);
+                    }
+                }
+
                 // check refine
                 if (refine_type.has_value()) {
                     if (!WhetherAcceptableRefineType(refine_type.value())) {
@@ -217,6 +508,10 @@ class FaissHnswPrqConfig : public FaissHnswConfig {
 
     Status
     CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        const auto cascade_status = CheckRefineCascade(param_type, err_msg);
+        if (cascade_status != Status::success) {
+            return cascade_status;
+        }
         switch (param_type) {
             case PARAM_TYPE::TRAIN: {
                 if (dim.has_value() && m.has_value()) {
@@ -246,6 +541,43 @@ class FaissHnswPrqConfig : public FaissHnswConfig {
     }
 };
 
+class FaissHnswRaBitQConfig : public FaissHnswConfig {
+ public:
+    // the number of bits a query is quantized with, the value `0` means
+    //   that the query won't be quantized and will be processed as is.
+    CFG_INT rbq_bits_query;
+    KNOHWERE_DECLARE_CONFIG(FaissHnswRaBitQConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(rbq_bits_query)
+            .description("rbq_bits_query")
+            .set_default(0)
+            .set_range(0, 8)
+            .for_train()
+            .for_static();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        // check the base class
+        const auto base_status = FaissHnswConfig::CheckAndAdjust(param_type, err_msg);
+        if (base_status != Status::success) {
+            return base_status;
+        }
+
+        // check our parameters
+        if (param_type == PARAM_TYPE::TRAIN) {
+            // check refine
+            if (refine_type.has_value()) {
+                if (!WhetherAcceptableRefineType(refine_type.value())) {
+                    std::string msg = "invalid refine type : " + refine_type.value() +
+                                      ", optional types are [sq6, sq8, fp16, bf16, fp32, flat]";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+            }
+        }
+        return Status::success;
+    }
+};
+
 }  // namespace knowhere
 
 #endif /* FAISS_HNSW_CONFIG_H */
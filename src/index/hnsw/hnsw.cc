@@ -39,4 +39,19 @@ template class HnswIndexNode<knowhere::bf16, hnswlib::QuantType::None>;
 KNOWHERE_SIMPLE_REGISTER_DENSE_ALL_GLOBAL(HNSWLIB_DEPRECATED, HnswIndexNode,
                                           knowhere::feature::MMAP | knowhere::feature::MV)
 
+// The HNSW of the binary vectors, whose HAMMING and JACCARD distances are computed by the popcount kernels of the
+// simd hooks, 4 neighbors at a time.
+template <typename DataType>
+class BinHnswIndexNode : public HnswIndexNode<DataType> {
+ public:
+    using HnswIndexNode<DataType>::HnswIndexNode;
+
+    std::string
+    Type() const override {
+        return knowhere::IndexEnum::INDEX_BIN_HNSW;
+    }
+};
+
+KNOWHERE_SIMPLE_REGISTER_DENSE_BIN_GLOBAL(BIN_HNSW, BinHnswIndexNode, knowhere::feature::MMAP | knowhere::feature::MV)
+
 }  // namespace knowhere
@@ -42,6 +42,14 @@ class HnswIndexNode : public IndexNode {
         search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
     }
 
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        // the data, its copy in the graph, and the links of the base layer (2 * M) with their counts and labels
+        const auto& hnsw_cfg = static_cast<const BaseHnswConfig&>(cfg);
+        const int64_t links = 2 * hnsw_cfg.M.value_or(0) + 3;
+        return 2 * DataSetBytes<DataType>(dataset) + dataset->GetRows() * links * static_cast<int64_t>(sizeof(int32_t));
+    }
+
     Status
     Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
         auto rows = dataset->GetRows();
@@ -217,34 +225,42 @@ class HnswIndexNode : public IndexNode {
             feder_result = std::make_unique<feder::hnsw::FederResult>();
         }
 
-        auto p_id = std::make_unique<int64_t[]>(k * nq);
-        auto p_dist = std::make_unique<DistType[]>(k * nq);
+        auto p_id = AllocateResultBuffer<int64_t>(k * nq);
+        auto p_dist = AllocateResultBuffer<DistType>(k * nq);
 
         hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value()};
         bool transform =
             (index_->metric_type_ == hnswlib::Metric::INNER_PRODUCT || index_->metric_type_ == hnswlib::Metric::COSINE);
 
-        std::vector<folly::Future<folly::Unit>> futs;
-        futs.reserve(nq);
-        for (int i = 0; i < nq; ++i) {
-            futs.emplace_back(search_pool_->push([&, idx = i, p_id_ptr = p_id.get(), p_dist_ptr = p_dist.get()]() {
-                auto single_query = (const char*)xq + idx * index_->data_size_;
-                auto rst = index_->searchKnn(single_query, k, bitset, &param, feder_result);
-                size_t rst_size = rst.size();
-                auto p_single_dis = p_dist_ptr + idx * k;
-                auto p_single_id = p_id_ptr + idx * k;
-                for (size_t idx = 0; idx < rst_size; ++idx) {
-                    const auto& [dist, id] = rst[idx];
-                    p_single_dis[idx] = transform ? (-dist) : dist;
-                    p_single_id[idx] = id;
-                }
-                for (size_t idx = rst_size; idx < (size_t)k; idx++) {
-                    p_single_dis[idx] = DistType(1.0 / 0.0);
-                    p_single_id[idx] = -1;
+        // a query computes the distances to the neighbors of about ef visited nodes
+        const size_t query_cost = hnsw_cfg.ef.value() * index_->maxM0_ * Dim();
+        auto search_query = [&, p_id_ptr = p_id.get(), p_dist_ptr = p_dist.get()](const int64_t idx) {
+            auto single_query = (const char*)xq + idx * index_->data_size_;
+            auto rst = [&] {
+                ScopedSearchStage stage(SearchStage::GRAPH_TRAVERSAL);
+                return index_->searchKnn(single_query, k, bitset, &param, feder_result);
+            }();
+            size_t rst_size = rst.size();
+            auto p_single_dis = p_dist_ptr + idx * k;
+            auto p_single_id = p_id_ptr + idx * k;
+            for (size_t idx = 0; idx < rst_size; ++idx) {
+                const auto& [dist, id] = rst[idx];
+                p_single_dis[idx] = transform ? (-dist) : dist;
+                p_single_id[idx] = id;
+            }
+            for (size_t idx = rst_size; idx < (size_t)k; idx++) {
+                p_single_dis[idx] = DistType(1.0 / 0.0);
+                p_single_id[idx] = -1;
+            }
+        };
+        ParallelForOverSearchThreadPool(
+            nq, query_cost,
+            [&](size_t begin, size_t end) {
+                for (auto i = begin; i < end; ++i) {
+                    search_query(i);
                 }
-            }));
-        }
-        WaitAllSuccess(futs);
+            },
+            [&](size_t begin, size_t end) { MarkMissingResults(p_id.get(), p_dist.get(), k, begin, end); });
 
         auto res = GenResultDataSet(nq, k, std::move(p_id), std::move(p_dist));
 
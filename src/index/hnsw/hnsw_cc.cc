@@ -0,0 +1,486 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "index/hnsw/hnsw_cc_config.h"
+#include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/dataset.h"
+#include "knowhere/expected.h"
+#include "knowhere/feature.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/index/index_node_data_mock_wrapper.h"
+#include "knowhere/log.h"
+#include "knowhere/range_util.h"
+#include "knowhere/thread_pool.h"
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+namespace {
+
+// The seals of the HNSW_CC indexes wait for their graphs, which are built on the global build pool, so they run on a
+// pool of their own rather than blocking the threads of the build pool.
+std::shared_ptr<ThreadPool>
+SealThreadPool() {
+    static std::shared_ptr<ThreadPool> pool =
+        std::make_shared<ThreadPool>(ThreadPool::GetGlobalBuildThreadPool()->size(), "Knowhere_HnswCCSeal");
+    return pool;
+}
+
+}  // namespace
+
+// A growing index that is searched while rows are being added, with a search latency close to that of HNSW.
+//
+// The rows go to a flat buffer of buffer_rows rows, searched by brute force. A full buffer is sealed in the background
+// into an HNSW graph of its own, built with the HNSW parameters of the config, and a new buffer takes the next rows.
+// The sealed segments are merged into a single graph as long as the last one is at least half as large as the one
+// before it, like in a log-structured merge tree, so the number of graphs stays logarithmic in the number of rows. All
+// the segments share a single id space, each one from the id of its first row, and are filtered by a single bitset.
+//
+// The current list of segments is published as a snapshot, like in the growing sparse index: a search grabs the
+// latest snapshot and searches it without any lock, while an Add, a seal or a merge publishes a new one. A snapshot
+// holds its segments alive. The segments keep their raw rows, for the merges and GetVectorByIds.
+//
+// Adds are serialized among themselves, all the other methods can be called concurrently with each other and with
+// Add. The index is not serialized: a growing segment is indexed again once it is sealed.
+template <typename DataType>
+class HnswCCIndexNode : public IndexNode {
+ public:
+    explicit HnswCCIndexNode(const int32_t& version, const Object& /*object*/)
+        : IndexNode(version), snapshot_(std::make_shared<const Snapshot>()) {
+    }
+
+    ~HnswCCIndexNode() override {
+        std::unique_lock lock(add_mutex_);
+        stopping_ = true;
+        seal_done_.wait(lock, [this] { return !sealing_; });
+    }
+
+    Status
+    Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        const auto& hnsw_cfg = static_cast<const HnswCCConfig&>(*cfg);
+        const auto& metric_type = hnsw_cfg.metric_type.value();
+        if (!IsMetricType(metric_type, metric::L2) && !IsMetricType(metric_type, metric::IP) &&
+            !IsMetricType(metric_type, metric::COSINE)) {
+            LOG_KNOWHERE_ERROR_ << "unsupported metric type: " << metric_type;
+            return Status::invalid_metric_type;
+        }
+        std::lock_guard lock(add_mutex_);
+        dim_ = dataset->GetDim();
+        buffer_rows_ = hnsw_cfg.buffer_rows.value();
+        metric_type_ = metric_type;
+        build_cfg_ = std::move(cfg);
+        return Status::success;
+    }
+
+    Status
+    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
+        std::lock_guard lock(add_mutex_);
+        if (build_cfg_ == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "index not trained";
+            return Status::index_not_trained;
+        }
+        const auto* x = static_cast<const float*>(dataset->GetTensor());
+        const int64_t rows = dataset->GetRows();
+        auto segments = *std::atomic_load(&snapshot_);
+
+        for (int64_t added = 0; added < rows;) {
+            // the rows past the count of the buffer are not read by the searches of the published snapshots
+            if (segments.empty() || segments.back()->rows == buffer_rows_) {
+                const auto base = segments.empty() ? 0 : segments.back()->base + segments.back()->rows;
+                std::shared_ptr<float[]> data(new float[buffer_rows_ * dim_]);
+                segments.push_back(std::make_shared<const Segment>(Segment{base, 0, std::move(data), {}}));
+            }
+            const auto buffer = segments.back();
+            const auto n = std::min(rows - added, buffer_rows_ - buffer->rows);
+            std::copy_n(x + added * dim_, n * dim_, buffer->data.get() + buffer->rows * dim_);
+            segments.back() =
+                std::make_shared<const Segment>(Segment{buffer->base, buffer->rows + n, buffer->data, {}});
+            if (segments.back()->rows == buffer_rows_) {
+                to_seal_.push_back(segments.back()->base);
+            }
+            added += n;
+        }
+        Publish(std::move(segments));
+
+        if (!to_seal_.empty() && !sealing_ && !stopping_) {
+            sealing_ = true;
+            SealThreadPool()->push([this] { SealPending(); });
+        }
+        return Status::success;
+    }
+
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        const auto& hnsw_cfg = static_cast<const HnswCCConfig&>(*cfg);
+        const auto nq = dataset->GetRows();
+        const auto k = hnsw_cfg.k.value();
+        const bool larger_is_closer = IsLargerCloser();
+        auto snapshot = std::atomic_load(&snapshot_);
+
+        // the results of the segments, merged per query
+        std::vector<std::vector<std::pair<float, int64_t>>> candidates(nq);
+        auto collect = [&](const DataSet& res, const int64_t base) {
+            const auto* ids = res.GetIds();
+            const auto* distances = res.GetDistance();
+            for (int64_t i = 0; i < nq * k; i++) {
+                if (ids[i] >= 0) {
+                    candidates[i / k].emplace_back(distances[i], base + ids[i]);
+                }
+            }
+        };
+
+        std::vector<DataSetPtr> buffers;
+        for (const auto& segment : *snapshot) {
+            if (segment->graph.Node() == nullptr) {
+                buffers.push_back(GenDataSet(segment->rows, dim_, segment->data.get(), segment->base));
+                continue;
+            }
+            auto res = segment->graph.Node()->Search(dataset, cfg->Clone(), segment_bitset(bitset, *segment));
+            if (!res.has_value()) {
+                return res;
+            }
+            collect(*res.value(), segment->base);
+        }
+        if (!buffers.empty()) {
+            // the ids of the chunks are offset by their begin ids already
+            auto res = BruteForce::SearchChunks<fp32>(buffers, dataset, BruteForceJson(hnsw_cfg), bitset);
+            if (!res.has_value()) {
+                return res;
+            }
+            collect(*res.value(), 0);
+        }
+
+        auto ids = AllocateResultBuffer<int64_t>(nq * k);
+        auto distances = AllocateResultBuffer<float>(nq * k);
+        for (int64_t i = 0; i < nq; i++) {
+            auto& query_candidates = candidates[i];
+            const auto num = std::min<int64_t>(k, query_candidates.size());
+            std::partial_sort(query_candidates.begin(), query_candidates.begin() + num, query_candidates.end(),
+                              [larger_is_closer](const auto& a, const auto& b) {
+                                  return larger_is_closer ? a.first > b.first : a.first < b.first;
+                              });
+            for (int64_t j = 0; j < k; j++) {
+                ids[i * k + j] = j < num ? query_candidates[j].second : -1;
+                distances[i * k + j] = j < num ? query_candidates[j].first
+                                               : (larger_is_closer ? std::numeric_limits<float>::lowest()
+                                                                   : std::numeric_limits<float>::max());
+            }
+        }
+        return GenResultDataSet(nq, k, std::move(ids), std::move(distances));
+    }
+
+    expected<DataSetPtr>
+    RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        const auto& hnsw_cfg = static_cast<const HnswCCConfig&>(*cfg);
+        const auto nq = dataset->GetRows();
+        auto snapshot = std::atomic_load(&snapshot_);
+
+        std::vector<std::vector<float>> result_distances(nq);
+        std::vector<std::vector<int64_t>> result_labels(nq);
+        for (const auto& segment : *snapshot) {
+            const auto* graph = segment->graph.Node();
+            auto res = (graph == nullptr)
+                           ? BruteForce::RangeSearch<fp32>(
+                                 GenDataSet(segment->rows, dim_, segment->data.get(), segment->base), dataset,
+                                 BruteForceJson(hnsw_cfg), bitset)
+                           : graph->RangeSearch(dataset, cfg->Clone(), segment_bitset(bitset, *segment));
+            if (!res.has_value()) {
+                return res;
+            }
+            // the ids of a buffer are offset by its begin id already
+            const int64_t base = (graph == nullptr) ? 0 : segment->base;
+            const auto* lims = res.value()->GetLims();
+            const auto* ids = res.value()->GetIds();
+            const auto* distances = res.value()->GetDistance();
+            for (int64_t i = 0; i < nq; i++) {
+                for (size_t j = lims[i]; j < lims[i + 1]; j++) {
+                    result_labels[i].push_back(base + ids[j]);
+                    result_distances[i].push_back(distances[j]);
+                }
+            }
+        }
+        auto range_search_result = GetRangeSearchResult(result_distances, result_labels, IsLargerCloser(), nq,
+                                                        hnsw_cfg.radius.value(), hnsw_cfg.range_filter.value());
+        return GenResultDataSet(nq, std::move(range_search_result));
+    }
+
+    expected<DataSetPtr>
+    GetVectorByIds(const DataSetPtr dataset) const override {
+        auto snapshot = std::atomic_load(&snapshot_);
+        const auto rows = dataset->GetRows();
+        const auto* ids = dataset->GetIds();
+        auto data = std::make_unique<float[]>(rows * dim_);
+        for (int64_t i = 0; i < rows; i++) {
+            const auto segment = find_segment(*snapshot, ids[i]);
+            if (segment == nullptr) {
+                return expected<DataSetPtr>::Err(Status::invalid_args, "id out of range");
+            }
+            std::copy_n(segment->data.get() + (ids[i] - segment->base) * dim_, dim_, data.get() + i * dim_);
+        }
+        return GenResultDataSet(rows, dim_, std::move(data));
+    }
+
+    bool
+    HasRawData(const std::string& metric_type) const override {
+        return true;
+    }
+
+    static bool
+    StaticHasRawData(const BaseConfig& config, const IndexVersion& version) {
+        return true;
+    }
+
+    expected<DataSetPtr>
+    GetIndexMeta(std::unique_ptr<Config> cfg) const override {
+        return expected<DataSetPtr>::Err(Status::not_implemented, "GetIndexMeta not implemented");
+    }
+
+    Status
+    Serialize(BinarySet& binset) const override {
+        LOG_KNOWHERE_ERROR_ << "HNSW_CC is a growing index, it is not serialized";
+        return Status::not_implemented;
+    }
+
+    Status
+    Deserialize(const BinarySet& binset, std::shared_ptr<Config> config) override {
+        LOG_KNOWHERE_ERROR_ << "HNSW_CC is a growing index, it is not deserialized";
+        return Status::not_implemented;
+    }
+
+    Status
+    DeserializeFromFile(const std::string& filename, std::shared_ptr<Config> config) override {
+        LOG_KNOWHERE_ERROR_ << "HNSW_CC is a growing index, it is not deserialized";
+        return Status::not_implemented;
+    }
+
+    static std::unique_ptr<BaseConfig>
+    StaticCreateConfig() {
+        return std::make_unique<HnswCCConfig>();
+    }
+
+    std::unique_ptr<BaseConfig>
+    CreateConfig() const override {
+        return StaticCreateConfig();
+    }
+
+    int64_t
+    Dim() const override {
+        return dim_;
+    }
+
+    int64_t
+    Size() const override {
+        auto snapshot = std::atomic_load(&snapshot_);
+        int64_t size = 0;
+        for (const auto& segment : *snapshot) {
+            size += (segment->graph.Node() == nullptr) ? buffer_rows_ * dim_ * static_cast<int64_t>(sizeof(float))
+                                                       : segment->rows * dim_ * static_cast<int64_t>(sizeof(float)) +
+                                                             segment->graph.Node()->Size();
+        }
+        return size;
+    }
+
+    int64_t
+    Count() const override {
+        return n_rows(*std::atomic_load(&snapshot_));
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::IndexEnum::INDEX_HNSW_CC;
+    }
+
+ private:
+    struct Segment {
+        // id of the first row of the segment
+        int64_t base;
+        int64_t rows;
+        // the rows of the segment, with room for buffer_rows rows in a flat buffer
+        std::shared_ptr<float[]> data;
+        // the graph of a sealed segment, none for a flat buffer
+        Index<IndexNode> graph;
+    };
+    using Snapshot = std::vector<std::shared_ptr<const Segment>>;
+
+    static int64_t
+    n_rows(const Snapshot& snapshot) {
+        return snapshot.empty() ? 0 : snapshot.back()->base + snapshot.back()->rows;
+    }
+
+    // the segment of the row id, none if out of range
+    static std::shared_ptr<const Segment>
+    find_segment(const Snapshot& snapshot, int64_t id) {
+        if (id < 0 || id >= n_rows(snapshot)) {
+            return nullptr;
+        }
+        auto it = std::upper_bound(snapshot.begin(), snapshot.end(), id,
+                                   [](int64_t id, const auto& segment) { return id < segment->base; });
+        return *(it - 1);
+    }
+
+    // bitset viewed from the ids of segment.
+    static BitsetView
+    segment_bitset(const BitsetView& bitset, const Segment& segment) {
+        BitsetView seg_bitset = bitset;
+        if (!seg_bitset.empty()) {
+            seg_bitset.set_id_offset(segment.base);
+        }
+        return seg_bitset;
+    }
+
+    bool
+    IsLargerCloser() const {
+        return IsMetricType(metric_type_, metric::IP) || IsMetricType(metric_type_, metric::COSINE);
+    }
+
+    Json
+    BruteForceJson(const HnswCCConfig& cfg) const {
+        Json json;
+        json[meta::DIM] = dim_;
+        json[meta::METRIC_TYPE] = cfg.metric_type.value();
+        json[meta::TOPK] = cfg.k.value();
+        if (cfg.radius.has_value()) {
+            json[meta::RADIUS] = cfg.radius.value();
+        }
+        if (cfg.range_filter.has_value()) {
+            json[meta::RANGE_FILTER] = cfg.range_filter.value();
+        }
+        return json;
+    }
+
+    // builds the graph of the rows [0, rows) of data, none on failure
+    Index<IndexNode>
+    BuildGraph(const float* data, const int64_t rows) const {
+        auto graph = IndexFactory::Instance().Create<fp32>(IndexEnum::INDEX_HNSW, version_.VersionNumber());
+        if (!graph.has_value()) {
+            LOG_KNOWHERE_WARNING_ << "failed to create the graph of a segment: " << graph.what();
+            return Index<IndexNode>();
+        }
+        auto status = graph.value().Node()->Build(GenDataSet(rows, dim_, data), build_cfg_, true);
+        if (status != Status::success) {
+            LOG_KNOWHERE_WARNING_ << "failed to build the graph of a segment: " << Status2String(status);
+            return Index<IndexNode>();
+        }
+        return graph.value();
+    }
+
+    // called with add_mutex_ held
+    void
+    Publish(Snapshot segments) {
+        std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::make_shared<Snapshot>(std::move(segments))));
+    }
+
+    // publishes the segments of the current snapshot with the segments of the bases [first, last] replaced by segment
+    void
+    Replace(const int64_t first, const int64_t last, std::shared_ptr<const Segment> segment) {
+        std::lock_guard lock(add_mutex_);
+        auto segments = *std::atomic_load(&snapshot_);
+        auto begin = std::find_if(segments.begin(), segments.end(), [&](const auto& s) { return s->base == first; });
+        auto end = std::find_if(begin, segments.end(), [&](const auto& s) { return s->base == last; });
+        if (end == segments.end()) {
+            return;
+        }
+        segments.insert(segments.erase(begin, end + 1), std::move(segment));
+        Publish(std::move(segments));
+    }
+
+    // seals the full buffers in the order they were filled, merging the graphs on the way, until none is left
+    void
+    SealPending() {
+        while (true) {
+            std::shared_ptr<const Segment> buffer;
+            {
+                std::lock_guard lock(add_mutex_);
+                if (to_seal_.empty() || stopping_) {
+                    sealing_ = false;
+                    seal_done_.notify_all();
+                    return;
+                }
+                const auto base = to_seal_.front();
+                to_seal_.pop_front();
+                buffer = find_segment(*std::atomic_load(&snapshot_), base);
+            }
+            auto graph = BuildGraph(buffer->data.get(), buffer->rows);
+            if (graph.Node() == nullptr) {
+                // the buffer stays searched by brute force
+                continue;
+            }
+            Replace(buffer->base, buffer->base,
+                    std::make_shared<const Segment>(Segment{buffer->base, buffer->rows, buffer->data, graph}));
+            MergeSealed();
+        }
+    }
+
+    // merges the last two graphs while the last one is at least half as large as the one before it
+    void
+    MergeSealed() {
+        while (true) {
+            std::shared_ptr<const Segment> first, second;
+            {
+                std::lock_guard lock(add_mutex_);
+                if (stopping_) {
+                    return;
+                }
+                // the sealed segments come first, then the buffers
+                auto snapshot = std::atomic_load(&snapshot_);
+                size_t sealed = 0;
+                while (sealed < snapshot->size() && (*snapshot)[sealed]->graph.Node() != nullptr) {
+                    sealed++;
+                }
+                if (sealed < 2 || (*snapshot)[sealed - 1]->rows * 2 < (*snapshot)[sealed - 2]->rows) {
+                    return;
+                }
+                first = (*snapshot)[sealed - 2];
+                second = (*snapshot)[sealed - 1];
+            }
+            const auto rows = first->rows + second->rows;
+            std::shared_ptr<float[]> data(new float[rows * dim_]);
+            std::copy_n(first->data.get(), first->rows * dim_, data.get());
+            std::copy_n(second->data.get(), second->rows * dim_, data.get() + first->rows * dim_);
+            auto graph = BuildGraph(data.get(), rows);
+            if (graph.Node() == nullptr) {
+                return;
+            }
+            Replace(first->base, second->base,
+                    std::make_shared<const Segment>(Segment{first->base, rows, std::move(data), graph}));
+        }
+    }
+
+    int64_t dim_ = 0;
+    int64_t buffer_rows_ = 0;
+    std::string metric_type_;
+    // the config of the graphs
+    std::shared_ptr<Config> build_cfg_;
+
+    std::mutex add_mutex_;
+    // the bases of the full buffers to seal, guarded by add_mutex_
+    std::deque<int64_t> to_seal_;
+    // whether a task of the seal pool is sealing the buffers of the index, guarded by add_mutex_
+    bool sealing_ = false;
+    bool stopping_ = false;
+    std::condition_variable seal_done_;
+    // accessed with std::atomic_load and std::atomic_store only.
+    std::shared_ptr<const Snapshot> snapshot_;
+};
+
+KNOWHERE_MOCK_REGISTER_DENSE_FLOAT_ALL_GLOBAL(HNSW_CC, HnswCCIndexNode, knowhere::feature::NONE)
+
+}  // namespace knowhere
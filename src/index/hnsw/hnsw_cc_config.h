@@ -0,0 +1,35 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef HNSW_CC_CONFIG_H
+#define HNSW_CC_CONFIG_H
+
+#include "index/hnsw/faiss_hnsw_config.h"
+
+namespace knowhere {
+
+// The config of HNSW_CC, whose sealed segments are HNSW graphs built with the HNSW parameters of the config.
+class HnswCCConfig : public FaissHnswFlatConfig {
+ public:
+    // the rows of a flat buffer, sealed into a graph once full
+    CFG_INT buffer_rows;
+    KNOHWERE_DECLARE_CONFIG(HnswCCConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(buffer_rows)
+            .description("the rows of a flat buffer, sealed into a graph once full")
+            .set_default(8192)
+            .set_range(1, 1 << 24)
+            .for_train();
+    }
+};
+
+}  // namespace knowhere
+
+#endif /* HNSW_CC_CONFIG_H */
@@ -18,7 +18,11 @@
 
 namespace knowhere {
 
-class HnswConfig : public BaseHnswConfig {};
+class HnswConfig : public BaseHnswConfig {
+ public:
+    KNOHWERE_DECLARE_CONFIG(HnswConfig) {
+    }
+};
 
 }  // namespace knowhere
 
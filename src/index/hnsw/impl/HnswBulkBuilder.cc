@@ -0,0 +1,627 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "index/hnsw/impl/HnswBulkBuilder.h"
+
+#include <faiss/impl/AuxIndexStructures.h>
+#include <faiss/impl/DistanceComputer.h>
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/impl/HNSW.h>
+#include <faiss/impl/NSG.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <vector>
+
+namespace knowhere {
+
+namespace {
+
+using storage_idx_t = faiss::HNSW::storage_idx_t;
+using NodeDistCloser = faiss::HNSW::NodeDistCloser;
+using NodeDistFarther = faiss::HNSW::NodeDistFarther;
+
+// the batches double in size until they reach this fraction of the index. The nodes of a batch do not see each
+//   other while their neighbors are searched, so the batches have to stay small relative to the graph.
+constexpr double kMaxBatchFraction = 0.02;
+
+// the per thread state of the search of the neighbors of the nodes of a batch.
+struct BatchSearcher {
+    const faiss::IndexHNSW& index;
+    std::unique_ptr<faiss::DistanceComputer> dis;
+    faiss::VisitedTable vt;
+    std::vector<float> query;
+
+    explicit BatchSearcher(const faiss::IndexHNSW& index)
+        : index(index),
+          dis(faiss::nsg::storage_distance_computer(index.storage)),
+          vt(index.ntotal),
+          query(index.d) {
+    }
+
+    void
+    set_query(const storage_idx_t node) {
+        index.storage->reconstruct(node, query.data());
+        dis->set_query(query.data());
+    }
+
+    // moves nearest to the node closest to the query that can be reached greedily from it at a level.
+    void
+    greedy_update_nearest(const int level, storage_idx_t& nearest, float& d_nearest) {
+        const faiss::HNSW& hnsw = index.hnsw;
+        for (;;) {
+            const storage_idx_t prev_nearest = nearest;
+            size_t begin, end;
+            hnsw.neighbor_range(nearest, level, &begin, &end);
+            for (size_t i = begin; i < end && hnsw.neighbors[i] >= 0; i++) {
+                const float distance = (*dis)(hnsw.neighbors[i]);
+                if (distance < d_nearest) {
+                    nearest = hnsw.neighbors[i];
+                    d_nearest = distance;
+                }
+            }
+            if (nearest == prev_nearest) {
+                return;
+            }
+        }
+    }
+
+    // the efConstruction nodes closest to the query found by a beam search at a level, the same way as the
+    //   incremental insertion of faiss collects the neighbor candidates of a node.
+    void
+    search_candidates(const int level, const storage_idx_t entry, const float d_entry,
+                      std::priority_queue<NodeDistCloser>& results) {
+        search_candidates(level, {NodeDistCloser(d_entry, entry)}, results);
+    }
+
+    // the same, from several entry points.
+    void
+    search_candidates(const int level, const std::vector<NodeDistCloser>& entries,
+                      std::priority_queue<NodeDistCloser>& results) {
+        const faiss::HNSW& hnsw = index.hnsw;
+        const size_t ef = hnsw.efConstruction;
+        std::priority_queue<NodeDistFarther> candidates;
+        for (const auto& entry : entries) {
+            if (vt.get(entry.id)) {
+                continue;
+            }
+            vt.set(entry.id);
+            candidates.emplace(entry.d, entry.id);
+            results.emplace(entry.d, entry.id);
+            if (results.size() > ef) {
+                results.pop();
+            }
+        }
+
+        auto update_with_candidate = [&](const storage_idx_t node, const float distance) {
+            if (results.size() < ef || results.top().d > distance) {
+                results.emplace(distance, node);
+                candidates.emplace(distance, node);
+                if (results.size() > ef) {
+                    results.pop();
+                }
+            }
+        };
+
+        while (!candidates.empty()) {
+            const NodeDistFarther current = candidates.top();
+            if (current.d > results.top().d) {
+                break;
+            }
+            candidates.pop();
+
+            size_t begin, end;
+            hnsw.neighbor_range(current.id, level, &begin, &end);
+            storage_idx_t buffered_ids[4];
+            int n_buffered = 0;
+            for (size_t i = begin; i < end && hnsw.neighbors[i] >= 0; i++) {
+                const storage_idx_t node = hnsw.neighbors[i];
+                if (vt.get(node)) {
+                    continue;
+                }
+                vt.set(node);
+                buffered_ids[n_buffered++] = node;
+                if (n_buffered == 4) {
+                    float distances[4];
+                    dis->distances_batch_4(buffered_ids[0], buffered_ids[1], buffered_ids[2], buffered_ids[3],
+                                           distances[0], distances[1], distances[2], distances[3]);
+                    for (int j = 0; j < 4; j++) {
+                        update_with_candidate(buffered_ids[j], distances[j]);
+                    }
+                    n_buffered = 0;
+                }
+            }
+            for (int j = 0; j < n_buffered; j++) {
+                update_with_candidate(buffered_ids[j], (*dis)(buffered_ids[j]));
+            }
+        }
+        vt.advance();
+    }
+};
+
+// stores the neighbors of a node at a level, the remaining slots are cleared.
+void
+set_neighbors(faiss::HNSW& hnsw, const storage_idx_t node, const int level,
+              const std::vector<NodeDistFarther>& neighbors) {
+    size_t begin, end;
+    hnsw.neighbor_range(node, level, &begin, &end);
+    FAISS_ASSERT(neighbors.size() <= end - begin);
+    for (const auto& neighbor : neighbors) {
+        hnsw.neighbors[begin++] = neighbor.id;
+    }
+    std::fill(hnsw.neighbors.begin() + begin, hnsw.neighbors.begin() + end, -1);
+}
+
+// links a new node at its levels from min_level up: its neighbors are searched in the graph built so far and
+//   pruned with the HNSW heuristic, the same way as HNSW::add_with_locks() does. Only the lists of the node itself
+//   are modified.
+void
+link_new_node(faiss::HNSW& hnsw, BatchSearcher& searcher, const storage_idx_t node, const int min_level) {
+    const int node_level = hnsw.levels[node] - 1;
+    searcher.set_query(node);
+    storage_idx_t nearest = hnsw.entry_point;
+    float d_nearest = (*searcher.dis)(nearest);
+    for (int level = hnsw.max_level; level > node_level; level--) {
+        searcher.greedy_update_nearest(level, nearest, d_nearest);
+    }
+
+    std::priority_queue<NodeDistCloser> results;
+    std::priority_queue<NodeDistFarther> candidates;
+    std::vector<NodeDistFarther> neighbors;
+    for (int level = node_level; level >= min_level; level--) {
+        searcher.search_candidates(level, nearest, d_nearest, results);
+        for (; !results.empty(); results.pop()) {
+            candidates.emplace(results.top().d, results.top().id);
+        }
+        // the next level is searched from the closest candidate
+        nearest = candidates.top().id;
+        d_nearest = candidates.top().d;
+
+        neighbors.clear();
+        faiss::HNSW::shrink_neighbor_list(*searcher.dis, candidates, neighbors, hnsw.nb_neighbors(level));
+        candidates = {};
+        set_neighbors(hnsw, node, level, neighbors);
+    }
+}
+
+// the links from the nodes of the graph to the new nodes of a batch at a level, grouped by the node they start from.
+struct ReverseLinks {
+    // the nodes that get new links, the sources of the links of nodes[i] are in [offsets[i], offsets[i + 1]).
+    std::vector<storage_idx_t> nodes;
+    std::vector<size_t> offsets;
+    std::vector<storage_idx_t> sources;
+
+    // counts is a scratch array of the size of the index, filled with zeros.
+    void
+    collect(const faiss::HNSW& hnsw, const storage_idx_t* batch, const size_t batch_size, const int level,
+            std::vector<uint32_t>& counts) {
+        nodes.clear();
+        for (size_t i = 0; i < batch_size; i++) {
+            for_each_neighbor(hnsw, batch[i], level, [&](const storage_idx_t neighbor) {
+                if (counts[neighbor]++ == 0) {
+                    nodes.push_back(neighbor);
+                }
+            });
+        }
+        offsets.resize(nodes.size() + 1);
+        offsets[0] = 0;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            offsets[i + 1] = offsets[i] + counts[nodes[i]];
+            // from now on, counts holds the position of the node in nodes
+            counts[nodes[i]] = i;
+        }
+        sources.resize(offsets.back());
+        std::vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < batch_size; i++) {
+            for_each_neighbor(hnsw, batch[i], level,
+                              [&](const storage_idx_t neighbor) { sources[cursors[counts[neighbor]]++] = batch[i]; });
+        }
+        for (const auto node : nodes) {
+            counts[node] = 0;
+        }
+    }
+
+    template <typename Func>
+    static void
+    for_each_neighbor(const faiss::HNSW& hnsw, const storage_idx_t node, const int level, Func&& func) {
+        if (hnsw.levels[node] <= level) {
+            return;
+        }
+        size_t begin, end;
+        hnsw.neighbor_range(node, level, &begin, &end);
+        for (size_t i = begin; i < end && hnsw.neighbors[i] >= 0; i++) {
+            func(hnsw.neighbors[i]);
+        }
+    }
+};
+
+// adds the reverse links of the new nodes of a batch at a level. A list that overflows is pruned with the HNSW
+//   heuristic, the same way as the add_link() of faiss does. Every list is only modified by a single thread.
+void
+add_reverse_links(faiss::IndexHNSW& index, const ReverseLinks& links, const int level) {
+    faiss::HNSW& hnsw = index.hnsw;
+    const size_t max_size = hnsw.nb_neighbors(level);
+#pragma omp parallel
+    {
+        std::unique_ptr<faiss::DistanceComputer> dis(faiss::nsg::storage_distance_computer(index.storage));
+        std::priority_queue<NodeDistFarther> candidates;
+        std::vector<NodeDistFarther> neighbors;
+        std::vector<storage_idx_t> sources;
+#pragma omp for schedule(dynamic, 64)
+        for (int64_t i = 0; i < static_cast<int64_t>(links.nodes.size()); i++) {
+            const storage_idx_t node = links.nodes[i];
+            size_t begin, end;
+            hnsw.neighbor_range(node, level, &begin, &end);
+            size_t size = 0;
+            while (begin + size < end && hnsw.neighbors[begin + size] >= 0) {
+                size++;
+            }
+            // the links that the list has already, as the merged nodes get from the graph they come from, are skipped
+            const auto list_begin = hnsw.neighbors.begin() + begin;
+            const auto list_end = list_begin + size;
+            sources.clear();
+            for (size_t j = links.offsets[i]; j < links.offsets[i + 1]; j++) {
+                if (std::find(list_begin, list_end, links.sources[j]) == list_end) {
+                    sources.push_back(links.sources[j]);
+                }
+            }
+            if (size + sources.size() <= max_size) {
+                std::copy(sources.begin(), sources.end(), list_end);
+                continue;
+            }
+
+            for (auto neighbor = list_begin; neighbor != list_end; ++neighbor) {
+                candidates.emplace(dis->symmetric_dis(node, *neighbor), *neighbor);
+            }
+            for (const auto source : sources) {
+                candidates.emplace(dis->symmetric_dis(node, source), source);
+            }
+            neighbors.clear();
+            faiss::HNSW::shrink_neighbor_list(*dis, candidates, neighbors, max_size);
+            candidates = {};
+            set_neighbors(hnsw, node, level, neighbors);
+        }
+    }
+}
+
+// inserts the nodes order[1, count) at their levels from min_level up, in batches. order is sorted by decreasing
+//   level, and order[0] is the entry point.
+void
+insert_in_batches(faiss::IndexHNSW& index, const std::vector<storage_idx_t>& order, const size_t count,
+                  const int min_level) {
+    faiss::HNSW& hnsw = index.hnsw;
+    const size_t max_batch_size = std::max<size_t>(1, index.ntotal * kMaxBatchFraction);
+    std::vector<uint32_t> counts(index.ntotal, 0);
+    ReverseLinks links;
+    for (size_t inserted = 1; inserted < count;) {
+        const size_t batch_size = std::min({count - inserted, inserted, max_batch_size});
+        const storage_idx_t* batch = order.data() + inserted;
+
+        // the searches only read the lists of the nodes inserted before the batch
+#pragma omp parallel
+        {
+            BatchSearcher searcher(index);
+#pragma omp for schedule(dynamic, 16)
+            for (int64_t i = 0; i < static_cast<int64_t>(batch_size); i++) {
+                link_new_node(hnsw, searcher, batch[i], min_level);
+            }
+        }
+
+        // the batch is sorted by decreasing level as well
+        for (int level = min_level; level < hnsw.levels[batch[0]]; level++) {
+            links.collect(hnsw, batch, batch_size, level, counts);
+            add_reverse_links(index, links, level);
+        }
+        inserted += batch_size;
+    }
+}
+
+// draws the levels of the nodes of an empty graph, and returns the nodes sorted by decreasing level, the first one of
+//   which is set as the entry point.
+std::vector<storage_idx_t>
+prepare_levels(faiss::HNSW& hnsw, const size_t ntotal) {
+    hnsw.prepare_level_tab(ntotal, false);
+    std::vector<storage_idx_t> order(ntotal);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const storage_idx_t a, const storage_idx_t b) { return hnsw.levels[a] > hnsw.levels[b]; });
+    hnsw.entry_point = order[0];
+    hnsw.max_level = hnsw.levels[order[0]] - 1;
+    return order;
+}
+
+// the number of the closest nodes of the index found for a merged node, which seed the searches of its neighbors.
+constexpr size_t kMergeSeeds = 2;
+
+// the nodes of a graph in the BFS order of its bottom layer from its entry point, followed by the unreachable ones.
+std::vector<storage_idx_t>
+bfs_order(const faiss::HNSW& hnsw) {
+    const storage_idx_t ntotal = hnsw.levels.size();
+    std::vector<storage_idx_t> order;
+    order.reserve(ntotal);
+    std::vector<bool> visited(ntotal, false);
+    auto bfs = [&](const storage_idx_t start) {
+        size_t head = order.size();
+        visited[start] = true;
+        order.push_back(start);
+        while (head < order.size()) {
+            ReverseLinks::for_each_neighbor(hnsw, order[head++], 0, [&](const storage_idx_t neighbor) {
+                if (!visited[neighbor]) {
+                    visited[neighbor] = true;
+                    order.push_back(neighbor);
+                }
+            });
+        }
+    };
+    if (hnsw.entry_point >= 0) {
+        bfs(hnsw.entry_point);
+    }
+    for (storage_idx_t node = 0; node < ntotal; node++) {
+        if (!visited[node]) {
+            bfs(node);
+        }
+    }
+    return order;
+}
+
+// the state of the merge shared by the threads.
+struct GraphMerge {
+    const faiss::HNSW& other;
+    const std::vector<int64_t>& new_ids;
+    // the entry point and the top level of the graph of the index before the merge, -1 if it is empty
+    storage_idx_t entry_point;
+    int max_level;
+    // the closest nodes of the index found for the merged nodes, by their ids in other, valid once linked is set
+    std::vector<std::array<storage_idx_t, kMergeSeeds>> closest;
+    std::unique_ptr<std::atomic<bool>[]> linked;
+
+    GraphMerge(const faiss::HNSW& hnsw, const faiss::HNSW& other, const std::vector<int64_t>& new_ids)
+        : other(other),
+          new_ids(new_ids),
+          entry_point(hnsw.entry_point),
+          max_level(hnsw.entry_point >= 0 ? hnsw.max_level : -1),
+          closest(new_ids.size()),
+          linked(new std::atomic<bool>[new_ids.size()]()) {
+    }
+
+    // the merged neighbors of a node of other at a level, those of its dropped neighbors in their place.
+    void
+    merged_neighbors(const storage_idx_t other_node, const int level, std::vector<storage_idx_t>& neighbors) const {
+        neighbors.clear();
+        ReverseLinks::for_each_neighbor(other, other_node, level, [&](const storage_idx_t neighbor) {
+            if (new_ids[neighbor] >= 0) {
+                neighbors.push_back(new_ids[neighbor]);
+                return;
+            }
+            ReverseLinks::for_each_neighbor(other, neighbor, level, [&](const storage_idx_t second_neighbor) {
+                if (new_ids[second_neighbor] >= 0 && second_neighbor != other_node) {
+                    neighbors.push_back(new_ids[second_neighbor]);
+                }
+            });
+        });
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+    // the seeds of the search of a node of other: the closest nodes found for its neighbors linked already.
+    void
+    seeds(const storage_idx_t other_node, std::vector<storage_idx_t>& seed_ids) const {
+        seed_ids.clear();
+        ReverseLinks::for_each_neighbor(other, other_node, 0, [&](const storage_idx_t neighbor) {
+            if (new_ids[neighbor] < 0 || !linked[neighbor].load(std::memory_order_acquire)) {
+                return;
+            }
+            for (const auto seed : closest[neighbor]) {
+                if (seed >= 0) {
+                    seed_ids.push_back(seed);
+                }
+            }
+        });
+    }
+};
+
+// links the merged node of other_node at all its levels, and records the closest nodes of the index found for it.
+//   Only the lists of the node itself are modified, and only the lists of the nodes of the index are read.
+void
+link_merged_node(faiss::HNSW& hnsw, BatchSearcher& searcher, GraphMerge& merge, const storage_idx_t other_node) {
+    const storage_idx_t node = merge.new_ids[other_node];
+    const int node_level = hnsw.levels[node] - 1;
+    searcher.set_query(node);
+    faiss::DistanceComputer& dis = *searcher.dis;
+
+    std::vector<storage_idx_t> seed_ids;
+    merge.seeds(other_node, seed_ids);
+    // the upper levels, and the nodes without seeds, are searched from the entry point
+    storage_idx_t nearest = -1;
+    float d_nearest = 0;
+    if (merge.entry_point >= 0 && (node_level > 0 || seed_ids.empty())) {
+        nearest = merge.entry_point;
+        d_nearest = dis(nearest);
+        for (int level = merge.max_level; level > node_level; level--) {
+            searcher.greedy_update_nearest(level, nearest, d_nearest);
+        }
+    }
+
+    std::vector<storage_idx_t> ids;
+    std::vector<NodeDistCloser> entries;
+    std::priority_queue<NodeDistCloser> results;
+    std::priority_queue<NodeDistFarther> candidates;
+    std::vector<NodeDistFarther> neighbors;
+    std::array<storage_idx_t, kMergeSeeds> closest;
+    closest.fill(-1);
+    for (int level = node_level; level >= 0; level--) {
+        if (level <= merge.max_level) {
+            entries.clear();
+            if (nearest >= 0) {
+                entries.emplace_back(d_nearest, nearest);
+            }
+            if (level == 0) {
+                for (const auto seed : seed_ids) {
+                    entries.emplace_back(dis(seed), seed);
+                }
+            }
+            searcher.search_candidates(level, entries, results);
+            for (; !results.empty(); results.pop()) {
+                candidates.emplace(results.top().d, results.top().id);
+            }
+            // the next level is searched from the closest candidate
+            if (!candidates.empty()) {
+                nearest = candidates.top().id;
+                d_nearest = candidates.top().d;
+            }
+            if (level == 0) {
+                std::vector<NodeDistFarther> top;
+                for (size_t i = 0; i < kMergeSeeds && !candidates.empty(); i++) {
+                    closest[i] = candidates.top().id;
+                    top.push_back(candidates.top());
+                    candidates.pop();
+                }
+                for (const auto& candidate : top) {
+                    candidates.push(candidate);
+                }
+            }
+        }
+
+        merge.merged_neighbors(other_node, level, ids);
+        for (const auto neighbor : ids) {
+            candidates.emplace(dis(neighbor), neighbor);
+        }
+        neighbors.clear();
+        faiss::HNSW::shrink_neighbor_list(dis, candidates, neighbors, hnsw.nb_neighbors(level));
+        candidates = {};
+        set_neighbors(hnsw, node, level, neighbors);
+    }
+
+    merge.closest[other_node] = closest;
+    merge.linked[other_node].store(true, std::memory_order_release);
+}
+
+}  // namespace
+
+void
+hnsw_bulk_build(faiss::IndexHNSW& index) {
+    FAISS_THROW_IF_NOT(index.storage != nullptr);
+    faiss::HNSW& hnsw = index.hnsw;
+    FAISS_THROW_IF_NOT_MSG(hnsw.levels.empty(), "the graph of a bulk-built HNSW index must be empty");
+
+    const size_t ntotal = index.storage->ntotal;
+    index.ntotal = ntotal;
+    if (ntotal == 0) {
+        return;
+    }
+
+    // the nodes are inserted by decreasing level, so that the upper levels are built first
+    const auto order = prepare_levels(hnsw, ntotal);
+    insert_in_batches(index, order, ntotal, 0);
+}
+
+void
+hnsw_build_from_base_graph(faiss::IndexHNSW& index, const int64_t* graph, const size_t degree) {
+    FAISS_THROW_IF_NOT(index.storage != nullptr);
+    faiss::HNSW& hnsw = index.hnsw;
+    FAISS_THROW_IF_NOT_MSG(hnsw.levels.empty(), "the graph of an HNSW index built from a base graph must be empty");
+
+    const size_t ntotal = index.storage->ntotal;
+    index.ntotal = ntotal;
+    if (ntotal == 0) {
+        return;
+    }
+    const auto order = prepare_levels(hnsw, ntotal);
+
+    // level 0 is the base graph, the lists are kept in their order
+#pragma omp parallel for
+    for (int64_t i = 0; i < static_cast<int64_t>(ntotal); i++) {
+        size_t begin, end;
+        hnsw.neighbor_range(i, 0, &begin, &end);
+        for (size_t j = 0; j < degree && begin < end; j++) {
+            const int64_t neighbor = graph[i * degree + j];
+            if (neighbor >= 0 && neighbor < static_cast<int64_t>(ntotal) && neighbor != i) {
+                hnsw.neighbors[begin++] = neighbor;
+            }
+        }
+    }
+
+    // only the nodes of the upper levels are inserted, at those levels
+    const size_t num_upper = std::count_if(order.begin(), order.end(),
+                                           [&](const storage_idx_t node) { return hnsw.levels[node] > 1; });
+    insert_in_batches(index, order, num_upper, 1);
+}
+
+size_t
+hnsw_merge_graph(faiss::IndexHNSW& index, const faiss::HNSW& other, const std::vector<int64_t>& new_ids) {
+    FAISS_THROW_IF_NOT(index.storage != nullptr);
+    faiss::HNSW& hnsw = index.hnsw;
+    FAISS_THROW_IF_NOT(new_ids.size() == other.levels.size());
+    FAISS_THROW_IF_NOT_MSG(hnsw.neighbors.is_owned, "the graph of a mapped HNSW index can not be modified");
+
+    const storage_idx_t n0 = index.ntotal;
+    const storage_idx_t ntotal = index.storage->ntotal;
+    FAISS_THROW_IF_NOT(static_cast<storage_idx_t>(hnsw.levels.size()) == n0);
+    const size_t n_merged = std::count_if(new_ids.begin(), new_ids.end(), [](const int64_t id) { return id >= 0; });
+    FAISS_THROW_IF_NOT(static_cast<storage_idx_t>(n0 + n_merged) == ntotal);
+    if (n_merged == 0) {
+        return 0;
+    }
+
+    // the merged nodes keep their levels, up to the ones the index has room for
+    const int max_levels = static_cast<int>(hnsw.cum_nneighbor_per_level.size()) - 1;
+    hnsw.levels.resize(ntotal);
+    for (size_t i = 0; i < new_ids.size(); i++) {
+        if (new_ids[i] >= 0) {
+            FAISS_THROW_IF_NOT(new_ids[i] >= n0 && new_ids[i] < ntotal);
+            hnsw.levels[new_ids[i]] = std::min(other.levels[i], max_levels);
+        }
+    }
+    hnsw.prepare_level_tab(n_merged, true);
+    index.ntotal = ntotal;
+
+    GraphMerge merge(hnsw, other, new_ids);
+    std::vector<storage_idx_t> order = bfs_order(other);
+    order.erase(std::remove_if(order.begin(), order.end(), [&](const storage_idx_t i) { return new_ids[i] < 0; }),
+                order.end());
+#pragma omp parallel
+    {
+        BatchSearcher searcher(index);
+#pragma omp for schedule(dynamic, 16)
+        for (int64_t i = 0; i < static_cast<int64_t>(order.size()); i++) {
+            link_merged_node(hnsw, searcher, merge, order[i]);
+        }
+    }
+
+    // the merged nodes in their order in the index, sorted by decreasing level
+    std::vector<storage_idx_t> batch(n_merged);
+    std::iota(batch.begin(), batch.end(), n0);
+    std::stable_sort(batch.begin(), batch.end(),
+                     [&](const storage_idx_t a, const storage_idx_t b) { return hnsw.levels[a] > hnsw.levels[b]; });
+    size_t n_linked = 0;
+    std::vector<uint32_t> counts(ntotal, 0);
+    ReverseLinks links;
+    for (int level = 0; level < hnsw.levels[batch[0]]; level++) {
+        links.collect(hnsw, batch.data(), batch.size(), level, counts);
+        add_reverse_links(index, links, level);
+        n_linked += std::count_if(links.nodes.begin(), links.nodes.end(),
+                                  [&](const storage_idx_t node) { return node < n0; });
+    }
+
+    if (hnsw.levels[batch[0]] - 1 > merge.max_level) {
+        hnsw.entry_point = batch[0];
+        hnsw.max_level = hnsw.levels[batch[0]] - 1;
+    }
+    return n_linked;
+}
+
+}  // namespace knowhere
@@ -0,0 +1,58 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <faiss/IndexHNSW.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace knowhere {
+
+// Builds the whole graph of an IndexHNSW at once, as an alternative to inserting the nodes one by one.
+//
+// The storage of the index must already contain all the vectors, and its graph must be empty. The nodes are inserted
+// in batches of growing size: the neighbors of the nodes of a batch are searched in parallel in the graph built so
+// far, which is only read in the meantime, and then the reverse links are merged into the lists of their targets,
+// each list by a single thread. The levels, the candidate search and the HNSW pruning heuristic are the same as
+// for the incremental insertion of faiss. Unlike it, no per-node locks are needed, and the graph does not depend on
+// the scheduling of the threads. The result is a regular faiss HNSW graph, which is searched and serialized as usual.
+void
+hnsw_bulk_build(faiss::IndexHNSW& index);
+
+// Builds the graph of an IndexHNSW on top of a prebuilt graph of its level 0, as an alternative to building it all,
+// e.g. to serve on CPU a CAGRA graph built on GPU.
+//
+// The storage of the index must already contain all the vectors, and its graph must be empty. graph[i * degree + j]
+// is the j-th neighbor of node i; the invalid ids are skipped, and a list is truncated to the nb_neighbors(0) slots
+// of level 0. The levels are drawn as usual, and only the nodes of the upper levels, about 1 / M of them, are
+// inserted the same way as by hnsw_bulk_build(), at those levels only, so that the hierarchy costs a fraction of a
+// full build.
+void
+hnsw_build_from_base_graph(faiss::IndexHNSW& index, const int64_t* graph, size_t degree);
+
+// Merges the graph of another HNSW index into the graph of an IndexHNSW, as an alternative to building the graph of
+// their union, e.g. to compact two sealed segments.
+//
+// The vectors of the merged nodes must already be appended to the storage of the index, past its ntotal, in the order
+// of their ids in other: new_ids[i] is the id of node i of other in the index, or -1 if the node is dropped. The graph
+// of the index is kept as is. The merged nodes keep their levels, and their lists are built from their neighbors in
+// other, the dropped ones being bypassed through their own neighbors, and from the nodes of the index found by a beam
+// search, pruned with the HNSW heuristic. The nodes are linked in parallel in the BFS order of other, and a search is
+// seeded with the nodes found for the neighbors linked before it rather than started from the entry point. The
+// searches only read the lists of the index, which are then linked back to the merged nodes the same way as by
+// hnsw_bulk_build(). Returns the number of lists of the index that got links to merged nodes.
+size_t
+hnsw_merge_graph(faiss::IndexHNSW& index, const faiss::HNSW& other, const std::vector<int64_t>& new_ids);
+
+}  // namespace knowhere
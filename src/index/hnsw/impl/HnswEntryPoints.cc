@@ -0,0 +1,96 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+
+#include "index/hnsw/impl/HnswEntryPoints.h"
+
+#include <faiss/Clustering.h>
+#include <faiss/IndexFlat.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+std::vector<faiss::HNSW::storage_idx_t>
+build_hnsw_entry_points(const faiss::IndexHNSW& index_hnsw, size_t n) {
+    using storage_idx_t = faiss::HNSW::storage_idx_t;
+
+    const size_t ntotal = index_hnsw.ntotal;
+    n = std::min(n, ntotal);
+    if (n == 0 || index_hnsw.storage == nullptr) {
+        return {};
+    }
+
+    // a random sample of the linked nodes, as many as k-means uses anyway. The deleted rows are unlinked from the
+    // graph and can not lead anywhere.
+    const faiss::HNSW& hnsw = index_hnsw.hnsw;
+    auto is_linked = [&hnsw](const storage_idx_t id) {
+        size_t begin = 0;
+        size_t end = 0;
+        hnsw.neighbor_range(id, 0, &begin, &end);
+        return begin < end && hnsw.neighbors[begin] >= 0;
+    };
+    std::vector<storage_idx_t> ids(ntotal);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::mt19937 rng(42);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    const size_t max_sample = n * kHnswEntryPointSampleRows;
+    size_t n_sample = 0;
+    for (size_t i = 0; i < ntotal && n_sample < max_sample; ++i) {
+        if (is_linked(ids[i])) {
+            ids[n_sample++] = ids[i];
+        }
+    }
+    ids.resize(n_sample);
+    std::sort(ids.begin(), ids.end());
+    n = std::min(n, n_sample);
+    if (n == 0) {
+        return {};
+    }
+
+    const size_t dim = index_hnsw.d;
+    std::vector<float> sample(n_sample * dim);
+    try {
+        for (size_t i = 0; i < n_sample; ++i) {
+            index_hnsw.storage->reconstruct(ids[i], sample.data() + i * dim);
+        }
+    } catch (const std::exception& e) {
+        LOG_KNOWHERE_WARNING_ << "the storage of the HNSW index can not reconstruct its vectors: " << e.what();
+        return {};
+    }
+
+    std::vector<float> centroids(n * dim);
+    faiss::kmeans_clustering(dim, n_sample, n, sample.data(), centroids.data());
+
+    // the sampled node nearest to every centroid
+    faiss::IndexFlatL2 sample_index(dim);
+    sample_index.add(n_sample, sample.data());
+    std::vector<float> distances(n);
+    std::vector<faiss::idx_t> nearest(n);
+    sample_index.search(n, centroids.data(), 1, distances.data(), nearest.data());
+
+    std::vector<storage_idx_t> entry_points;
+    entry_points.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (nearest[i] >= 0) {
+            entry_points.push_back(ids[nearest[i]]);
+        }
+    }
+    std::sort(entry_points.begin(), entry_points.end());
+    entry_points.erase(std::unique(entry_points.begin(), entry_points.end()), entry_points.end());
+    return entry_points;
+}
+
+}  // namespace knowhere
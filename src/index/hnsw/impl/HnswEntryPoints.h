@@ -0,0 +1,35 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+
+#pragma once
+
+#include <faiss/IndexHNSW.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace knowhere {
+
+// the sampled rows per entry point whose k-means centroids the entry points are picked from
+constexpr size_t kHnswEntryPointSampleRows = 64;
+
+// Picks n entry points for the level 0 searches of an HNSW graph (@see FaissHnswConfig::entry_points): the nodes
+// nearest to the k-means centroids of a random sample of its vectors, i.e. representatives of its clusters. A
+// search scans them and starts its level 0 search from the ones nearest to the query, instead of descending the
+// upper levels from the single entry point of the graph.
+//
+// Returns fewer entry points if several centroids share their nearest node, and none if the storage of the index
+// can not reconstruct its vectors.
+std::vector<faiss::HNSW::storage_idx_t>
+build_hnsw_entry_points(const faiss::IndexHNSW& index_hnsw, size_t n);
+
+}  // namespace knowhere
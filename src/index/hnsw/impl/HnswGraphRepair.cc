@@ -0,0 +1,151 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "index/hnsw/impl/HnswGraphRepair.h"
+
+#include <faiss/impl/DistanceComputer.h>
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/impl/HNSW.h>
+#include <faiss/impl/NSG.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <queue>
+
+namespace knowhere {
+
+namespace {
+
+using storage_idx_t = faiss::HNSW::storage_idx_t;
+using NodeDistFarther = faiss::HNSW::NodeDistFarther;
+
+// calls func for each neighbor of a node at a level.
+template <typename Func>
+void
+for_each_neighbor(const faiss::HNSW& hnsw, const storage_idx_t node, const int level, Func&& func) {
+    size_t begin, end;
+    hnsw.neighbor_range(node, level, &begin, &end);
+    for (size_t i = begin; i < end && hnsw.neighbors[i] >= 0; i++) {
+        func(hnsw.neighbors[i]);
+    }
+}
+
+// the live nodes of a level that point to a deleted node.
+std::vector<storage_idx_t>
+collect_broken_nodes(const faiss::HNSW& hnsw, const std::vector<bool>& deleted, const int level) {
+    std::vector<storage_idx_t> nodes;
+    for (storage_idx_t node = 0; node < static_cast<storage_idx_t>(hnsw.levels.size()); node++) {
+        if (deleted[node] || hnsw.levels[node] <= level) {
+            continue;
+        }
+        size_t begin, end;
+        hnsw.neighbor_range(node, level, &begin, &end);
+        for (size_t i = begin; i < end && hnsw.neighbors[i] >= 0; i++) {
+            if (deleted[hnsw.neighbors[i]]) {
+                nodes.push_back(node);
+                break;
+            }
+        }
+    }
+    return nodes;
+}
+
+// the new neighbors of a live node at a level: its live neighbors and the live neighbors of its deleted ones, pruned
+//   with the HNSW heuristic.
+void
+repair_list(const faiss::HNSW& hnsw, faiss::DistanceComputer& dis, const std::vector<bool>& deleted,
+            const storage_idx_t node, const int level, std::vector<storage_idx_t>& candidate_ids,
+            std::vector<NodeDistFarther>& neighbors) {
+    candidate_ids.clear();
+    for_each_neighbor(hnsw, node, level, [&](const storage_idx_t neighbor) {
+        if (!deleted[neighbor]) {
+            candidate_ids.push_back(neighbor);
+            return;
+        }
+        for_each_neighbor(hnsw, neighbor, level, [&](const storage_idx_t second_neighbor) {
+            if (!deleted[second_neighbor] && second_neighbor != node) {
+                candidate_ids.push_back(second_neighbor);
+            }
+        });
+    });
+    std::sort(candidate_ids.begin(), candidate_ids.end());
+    candidate_ids.erase(std::unique(candidate_ids.begin(), candidate_ids.end()), candidate_ids.end());
+
+    std::priority_queue<NodeDistFarther> candidates;
+    for (const auto candidate : candidate_ids) {
+        candidates.emplace(dis.symmetric_dis(node, candidate), candidate);
+    }
+    neighbors.clear();
+    faiss::HNSW::shrink_neighbor_list(dis, candidates, neighbors, hnsw.nb_neighbors(level));
+}
+
+}  // namespace
+
+size_t
+hnsw_unlink_deleted(faiss::IndexHNSW& index, const std::vector<bool>& deleted) {
+    FAISS_THROW_IF_NOT(index.storage != nullptr);
+    faiss::HNSW& hnsw = index.hnsw;
+    FAISS_THROW_IF_NOT(deleted.size() == hnsw.levels.size());
+    FAISS_THROW_IF_NOT_MSG(hnsw.neighbors.is_owned, "the graph of a mapped HNSW index can not be modified");
+
+    size_t n_repaired = 0;
+    for (int level = 0; level <= hnsw.max_level; level++) {
+        const std::vector<storage_idx_t> nodes = collect_broken_nodes(hnsw, deleted, level);
+        std::vector<std::vector<storage_idx_t>> new_lists(nodes.size());
+
+        // the new lists are only computed from the lists of the level before the repair
+#pragma omp parallel
+        {
+            std::unique_ptr<faiss::DistanceComputer> dis(faiss::nsg::storage_distance_computer(index.storage));
+            std::vector<storage_idx_t> candidate_ids;
+            std::vector<NodeDistFarther> neighbors;
+#pragma omp for schedule(dynamic, 64)
+            for (int64_t i = 0; i < static_cast<int64_t>(nodes.size()); i++) {
+                repair_list(hnsw, *dis, deleted, nodes[i], level, candidate_ids, neighbors);
+                new_lists[i].reserve(neighbors.size());
+                for (const auto& neighbor : neighbors) {
+                    new_lists[i].push_back(neighbor.id);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < nodes.size(); i++) {
+            size_t begin, end;
+            hnsw.neighbor_range(nodes[i], level, &begin, &end);
+            std::copy(new_lists[i].begin(), new_lists[i].end(), hnsw.neighbors.begin() + begin);
+            std::fill(hnsw.neighbors.begin() + begin + new_lists[i].size(), hnsw.neighbors.begin() + end, -1);
+        }
+        n_repaired += nodes.size();
+    }
+
+    const storage_idx_t ntotal = hnsw.levels.size();
+    for (storage_idx_t node = 0; node < ntotal; node++) {
+        if (deleted[node]) {
+            std::fill(hnsw.neighbors.begin() + hnsw.offsets[node], hnsw.neighbors.begin() + hnsw.offsets[node + 1],
+                      -1);
+        }
+    }
+
+    if (hnsw.entry_point >= 0 && deleted[hnsw.entry_point]) {
+        hnsw.entry_point = -1;
+        hnsw.max_level = -1;
+        for (storage_idx_t node = 0; node < ntotal; node++) {
+            if (!deleted[node] && hnsw.levels[node] - 1 > hnsw.max_level) {
+                hnsw.entry_point = node;
+                hnsw.max_level = hnsw.levels[node] - 1;
+            }
+        }
+    }
+    return n_repaired;
+}
+
+}  // namespace knowhere
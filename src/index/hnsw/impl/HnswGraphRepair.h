@@ -0,0 +1,32 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <faiss/IndexHNSW.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace knowhere {
+
+// Unlinks the deleted nodes from the graph of an IndexHNSW, as an alternative to rebuilding it.
+//
+// deleted[i] tells whether node i is deleted. Every list of a live node that points to a deleted node is rebuilt from
+// the live nodes it points to and the live neighbors of the deleted ones, pruned with the HNSW heuristic, the same
+// way as an overflowing list is pruned during the insertion. The lists of the deleted nodes are cleared, so that the
+// search can no longer reach them, and the entry point is moved to a live node of the highest level if it is deleted.
+// The lists are repaired in parallel, level by level, from the lists of the level before the repair. The vectors of
+// the deleted nodes stay in the storage. Returns the number of repaired lists.
+size_t
+hnsw_unlink_deleted(faiss::IndexHNSW& index, const std::vector<bool>& deleted);
+
+}  // namespace knowhere
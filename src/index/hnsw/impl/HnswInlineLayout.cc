@@ -0,0 +1,87 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "index/hnsw/impl/HnswInlineLayout.h"
+
+#include <faiss/IndexCosine.h>
+#include <faiss/MetricType.h>
+#include <faiss/impl/HNSW.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace knowhere {
+
+std::unique_ptr<HnswInlineLayout>
+HnswInlineLayout::create(const faiss::IndexHNSW& index) {
+    const auto* storage = dynamic_cast<const faiss::IndexFlatCodes*>(index.storage);
+    if (storage == nullptr || storage->ntotal != index.ntotal) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<HnswInlineLayout>(new HnswInlineLayout(index, *storage));
+}
+
+HnswInlineLayout::HnswInlineLayout(const faiss::IndexHNSW& index, const faiss::IndexFlatCodes& storage_in)
+    : storage{storage_in}, n(storage_in.ntotal) {
+    const faiss::HNSW& hnsw = index.hnsw;
+    const size_t max_neighbors = hnsw.nb_neighbors(0);
+
+    neighbors_size = max_neighbors * sizeof(storage_idx_t);
+    record_size = (neighbors_size + storage.code_size + kAlignment - 1) / kAlignment * kAlignment;
+
+    data.resize(n * record_size);
+    uint8_t* const records = data.get();
+
+#pragma omp parallel for schedule(static, 4096)
+    for (int64_t i = 0; i < (int64_t)n; i++) {
+        uint8_t* const record = records + i * record_size;
+
+        size_t begin = 0;
+        size_t end = 0;
+        hnsw.neighbor_range(i, 0, &begin, &end);
+
+        storage_idx_t* const slots = reinterpret_cast<storage_idx_t*>(record);
+        for (size_t j = 0; j < max_neighbors; j++) {
+            slots[j] = (begin + j < end) ? hnsw.neighbors[begin + j] : -1;
+        }
+
+        std::memcpy(record + neighbors_size, storage.codes.data() + i * storage.code_size, storage.code_size);
+        std::memset(record + neighbors_size + storage.code_size, 0,
+                    record_size - neighbors_size - storage.code_size);
+    }
+}
+
+faiss::DistanceComputer*
+HnswInlineLayout::get_distance_computer() const {
+    // the flat codes distance computers locate the code i at codes + i * code_size
+    std::unique_ptr<faiss::FlatCodesDistanceComputer> flat_dis(storage.get_FlatCodesDistanceComputer());
+    flat_dis->codes = data.get() + neighbors_size;
+    flat_dis->code_size = record_size;
+    // everything past the code is padding
+    flat_dis->prefetch_bytes = std::min(flat_dis->prefetch_bytes, storage.code_size);
+
+    std::unique_ptr<faiss::DistanceComputer> dis = std::move(flat_dis);
+
+    // the cosine storages other than the flat one apply the norms on top of their codes
+    const auto* cosine_storage = dynamic_cast<const faiss::HasInverseL2Norms*>(&storage);
+    if (cosine_storage != nullptr && dynamic_cast<const faiss::IndexFlatCosine*>(&storage) == nullptr) {
+        dis = std::make_unique<faiss::WithCosineNormDistanceComputer>(cosine_storage->get_inverse_l2_norms(),
+                                                                      storage.d, std::move(dis));
+    }
+
+    if (faiss::is_similarity_metric(storage.metric_type)) {
+        return new faiss::NegativeDistanceComputer(dis.release());
+    }
+    return dis.release();
+}
+
+}  // namespace knowhere
@@ -0,0 +1,88 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <faiss/IndexFlatCodes.h>
+#include <faiss/IndexHNSW.h>
+#include <faiss/impl/DistanceComputer.h>
+#include <faiss/utils/AlignedTable.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace knowhere {
+
+// The base layer of an HNSW graph, with a fixed-degree neighbor list stored next to the code of every node.
+//
+// faiss keeps the neighbor lists of all the levels in a single array and the codes in the storage index, so that
+// expanding a node and evaluating its neighbors touch two unrelated memory regions. Here every node owns a record
+// of `stride()` bytes, aligned to the cache lines: its level 0 neighbor slots (padded with -1), then its code. The
+// records form a single flat buffer without pointers, which can be written to a file and mapped as is.
+//
+// The layout is a copy: the upper levels are still read from the index, and so are the codes for everything but
+// the HNSW search. It must be rebuilt if the index changes.
+class HnswInlineLayout {
+ public:
+    using storage_idx_t = faiss::HNSW::storage_idx_t;
+
+    static constexpr size_t kAlignment = 64;
+
+    // builds the layout of an index, or returns nullptr if its storage does not keep flat codes.
+    // the index is not owned and must outlive the layout.
+    static std::unique_ptr<HnswInlineLayout>
+    create(const faiss::IndexHNSW& index);
+
+    // the neighbor slots of the first node, those of the node i are stride_in_ids() * i elements further.
+    const storage_idx_t*
+    neighbors() const {
+        return reinterpret_cast<const storage_idx_t*>(data.get());
+    }
+
+    size_t
+    stride() const {
+        return record_size;
+    }
+
+    size_t
+    stride_in_ids() const {
+        return record_size / sizeof(storage_idx_t);
+    }
+
+    size_t
+    ntotal() const {
+        return n;
+    }
+
+    // the size of the layout, in bytes
+    size_t
+    size() const {
+        return n * record_size;
+    }
+
+    // a distance computer of the storage over the codes of the layout. similarity metrics are negated, as for the
+    //   HNSW search.
+    faiss::DistanceComputer*
+    get_distance_computer() const;
+
+ private:
+    HnswInlineLayout(const faiss::IndexHNSW& index, const faiss::IndexFlatCodes& storage);
+
+    const faiss::IndexFlatCodes& storage;
+    size_t n = 0;
+    // the bytes of the neighbor slots, the code of a node starts there
+    size_t neighbors_size = 0;
+    size_t record_size = 0;
+    faiss::AlignedTableTightAlloc<uint8_t, kAlignment> data;
+};
+
+}  // namespace knowhere
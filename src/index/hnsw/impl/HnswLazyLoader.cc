@@ -0,0 +1,235 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "index/hnsw/impl/HnswLazyLoader.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+namespace {
+
+// the nodes whose pages are prefetched at once
+constexpr size_t kPrefetchBatch = 1024;
+
+// reads a byte of every page of a range, to load the pages that could not be locked
+void
+touch(uintptr_t begin, size_t size, size_t page_size) {
+    for (uintptr_t p = begin; p < begin + size; p += page_size) {
+        [[maybe_unused]] volatile uint8_t value = *reinterpret_cast<const volatile uint8_t*>(p);
+    }
+}
+
+}  // namespace
+
+std::unique_ptr<HnswLazyLoader>
+HnswLazyLoader::create(const faiss::IndexHNSW& index, const faiss::IndexFlatCodes* refine, size_t hot_nodes) {
+    const auto* storage = dynamic_cast<const faiss::IndexFlatCodes*>(index.storage);
+    if (storage == nullptr || storage->ntotal != index.ntotal) {
+        return nullptr;
+    }
+
+    auto loader = std::unique_ptr<HnswLazyLoader>(new HnswLazyLoader(index, *storage, refine));
+    loader->lock_hot_region(hot_nodes);
+    loader->prefetcher = std::thread([loader = loader.get()]() { loader->prefetch(); });
+    return loader;
+}
+
+HnswLazyLoader::HnswLazyLoader(const faiss::IndexHNSW& index_in, const faiss::IndexFlatCodes& storage_in,
+                               const faiss::IndexFlatCodes* refine_in)
+    : index{index_in},
+      storage{storage_in},
+      refine{refine_in},
+      page_size{static_cast<size_t>(sysconf(_SC_PAGESIZE))},
+      visited(index_in.ntotal, false) {
+    if (index.ntotal > 0 && index.hnsw.entry_point >= 0) {
+        order.push_back(index.hnsw.entry_point);
+        visited[index.hnsw.entry_point] = true;
+    }
+}
+
+HnswLazyLoader::~HnswLazyLoader() {
+    stop.store(true);
+    if (prefetcher.joinable()) {
+        prefetcher.join();
+    }
+    for (const auto& [begin, size] : locked) {
+        munlock(reinterpret_cast<void*>(begin), size);
+    }
+}
+
+size_t
+HnswLazyLoader::locked_size() const {
+    size_t size = 0;
+    for (const auto& range : locked) {
+        size += range.second;
+    }
+    return size;
+}
+
+void
+HnswLazyLoader::lock_hot_region(size_t hot_nodes) {
+    std::vector<uintptr_t> pages;
+    // the descent of the searches through the upper levels, the levels of a node are one more than its top level
+    const auto& levels = index.hnsw.levels;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        if (levels[i] > 1) {
+            add_neighbor_pages(i, true, pages);
+        }
+        if (levels[i] > 2) {
+            add_code_pages(i, false, pages);
+        }
+    }
+    // the neighborhood of the entry point in level 0, where the searches start
+    traverse(hot_nodes);
+    next_prefetch = std::min(hot_nodes, order.size());
+    for (size_t i = 0; i < next_prefetch; ++i) {
+        add_neighbor_pages(order[i], false, pages);
+        add_code_pages(order[i], false, pages);
+    }
+
+    bool can_lock = true;
+    for (const auto& [begin, size] : to_ranges(pages)) {
+        if (can_lock && mlock(reinterpret_cast<void*>(begin), size) == 0) {
+            locked.emplace_back(begin, size);
+            continue;
+        }
+        if (can_lock) {
+            LOG_KNOWHERE_WARNING_ << "Failed to lock the hot pages of the HNSW index, they are loaded unlocked: "
+                                  << strerror(errno);
+            can_lock = false;
+        }
+        touch(begin, size, page_size);
+    }
+    LOG_KNOWHERE_INFO_ << "Locked " << locked_size() << " bytes of the HNSW index, " << next_prefetch
+                       << " nodes around the entry point";
+}
+
+void
+HnswLazyLoader::prefetch() {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<uintptr_t> pages;
+    while (!stop.load(std::memory_order_relaxed)) {
+        traverse(next_prefetch + kPrefetchBatch);
+        const size_t end = std::min(order.size(), next_prefetch + kPrefetchBatch);
+        if (end == next_prefetch) {
+            break;
+        }
+        pages.clear();
+        for (size_t i = next_prefetch; i < end; ++i) {
+            add_neighbor_pages(order[i], false, pages);
+            add_code_pages(order[i], true, pages);
+        }
+        for (const auto& [begin, size] : to_ranges(pages)) {
+            madvise(reinterpret_cast<void*>(begin), size, MADV_WILLNEED);
+        }
+        next_prefetch = end;
+    }
+    if (next_prefetch == static_cast<size_t>(index.ntotal)) {
+        prefetched.store(true, std::memory_order_release);
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LOG_KNOWHERE_INFO_ << "Prefetched the " << index.ntotal << " nodes of the HNSW index in " << elapsed << " s";
+    }
+}
+
+void
+HnswLazyLoader::traverse(size_t count) {
+    const auto& hnsw = index.hnsw;
+    while (order.size() < count && expanded < order.size()) {
+        size_t begin = 0;
+        size_t end = 0;
+        hnsw.neighbor_range(order[expanded++], 0, &begin, &end);
+        for (size_t j = begin; j < end; ++j) {
+            const storage_idx_t v = hnsw.neighbors[j];
+            if (v < 0) {
+                break;
+            }
+            if (!visited[v]) {
+                visited[v] = true;
+                order.push_back(v);
+            }
+        }
+        if (expanded == order.size() && order.size() < visited.size()) {
+            // the nodes that cannot be reached from the entry point come last
+            for (size_t i = 0; i < visited.size(); ++i) {
+                if (!visited[i]) {
+                    visited[i] = true;
+                    order.push_back(i);
+                }
+            }
+        }
+    }
+}
+
+void
+HnswLazyLoader::add_neighbor_pages(storage_idx_t node, bool upper, std::vector<uintptr_t>& pages) const {
+    const auto& hnsw = index.hnsw;
+    size_t begin = 0;
+    size_t end = 0;
+    if (upper) {
+        begin = hnsw.offsets[node];
+        end = hnsw.offsets[node + 1];
+    } else {
+        hnsw.neighbor_range(node, 0, &begin, &end);
+    }
+    if (begin == end) {
+        return;
+    }
+    const auto first = reinterpret_cast<uintptr_t>(hnsw.neighbors.data() + begin);
+    const auto last = reinterpret_cast<uintptr_t>(hnsw.neighbors.data() + end) - 1;
+    for (uintptr_t page = first / page_size; page <= last / page_size; ++page) {
+        pages.push_back(page);
+    }
+}
+
+void
+HnswLazyLoader::add_code_pages(storage_idx_t node, bool with_refine, std::vector<uintptr_t>& pages) const {
+    auto add = [&](const faiss::IndexFlatCodes& codes) {
+        if (codes.code_size == 0 || node >= codes.ntotal) {
+            return;
+        }
+        const auto first = reinterpret_cast<uintptr_t>(codes.codes.data() + node * codes.code_size);
+        const auto last = first + codes.code_size - 1;
+        for (uintptr_t page = first / page_size; page <= last / page_size; ++page) {
+            pages.push_back(page);
+        }
+    };
+    add(storage);
+    if (with_refine && refine != nullptr) {
+        add(*refine);
+    }
+}
+
+std::vector<HnswLazyLoader::Range>
+HnswLazyLoader::to_ranges(std::vector<uintptr_t>& pages) const {
+    std::sort(pages.begin(), pages.end());
+    pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+    std::vector<Range> ranges;
+    for (size_t i = 0; i < pages.size();) {
+        size_t j = i + 1;
+        while (j < pages.size() && pages[j] == pages[j - 1] + 1) {
+            ++j;
+        }
+        ranges.emplace_back(pages[i] * page_size, (j - i) * page_size);
+        i = j;
+    }
+    return ranges;
+}
+
+}  // namespace knowhere
@@ -0,0 +1,109 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <faiss/IndexFlatCodes.h>
+#include <faiss/IndexHNSW.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace knowhere {
+
+// Warms up an HNSW index whose neighbor lists and codes are mmapped, so that its first searches do not take a page
+// fault on every hop.
+//
+// The pages that every search touches are loaded and locked in memory at once: the neighbor lists of the nodes of
+// the upper levels, the codes of the nodes of level 2 and above, and the neighbor lists and codes of the first
+// `hot_nodes` nodes of the breadth-first traversal of level 0 from the entry point. Then a thread of the loader
+// prefetches the rest of the pages in the order of that traversal, which is about the order in which the searches
+// reach them. The mapping stays MADV_RANDOM, so the faults of the searches do not read ahead.
+//
+// The index is not owned and must outlive the loader, which stops its thread and unlocks the pages when destroyed.
+class HnswLazyLoader {
+ public:
+    static constexpr size_t kDefaultHotNodes = 16384;
+
+    // returns nullptr if the storage of the index does not keep flat codes. The codes of refine, if any, are
+    // prefetched with the others.
+    static std::unique_ptr<HnswLazyLoader>
+    create(const faiss::IndexHNSW& index, const faiss::IndexFlatCodes* refine, size_t hot_nodes = kDefaultHotNodes);
+
+    ~HnswLazyLoader();
+
+    HnswLazyLoader(const HnswLazyLoader&) = delete;
+    HnswLazyLoader&
+    operator=(const HnswLazyLoader&) = delete;
+
+    // whether all the pages of the index have been prefetched
+    bool
+    done() const {
+        return prefetched.load(std::memory_order_acquire);
+    }
+
+    // the bytes locked in memory
+    size_t
+    locked_size() const;
+
+ private:
+    using storage_idx_t = faiss::HNSW::storage_idx_t;
+    using Range = std::pair<uintptr_t, size_t>;
+
+    HnswLazyLoader(const faiss::IndexHNSW& index, const faiss::IndexFlatCodes& storage,
+                   const faiss::IndexFlatCodes* refine);
+
+    void
+    lock_hot_region(size_t hot_nodes);
+
+    void
+    prefetch();
+
+    // expands the next nodes of the traversal until `count` nodes are reached or all the reachable ones are
+    void
+    traverse(size_t count);
+
+    // appends the pages of the neighbor lists of a node, of all its levels if upper, or of its codes, to pages
+    void
+    add_neighbor_pages(storage_idx_t node, bool upper, std::vector<uintptr_t>& pages) const;
+
+    void
+    add_code_pages(storage_idx_t node, bool with_refine, std::vector<uintptr_t>& pages) const;
+
+    // sorts the pages and merges the adjacent ones into ranges
+    std::vector<Range>
+    to_ranges(std::vector<uintptr_t>& pages) const;
+
+    const faiss::IndexHNSW& index;
+    const faiss::IndexFlatCodes& storage;
+    const faiss::IndexFlatCodes* refine;
+    const size_t page_size;
+
+    // the nodes reached by the breadth-first traversal of level 0 from the entry point, in order, the first `expanded`
+    // of which had their neighbors visited
+    std::vector<storage_idx_t> order;
+    std::vector<bool> visited;
+    size_t expanded = 0;
+    // the nodes of the traversal before this one have been locked or prefetched
+    size_t next_prefetch = 0;
+    std::vector<Range> locked;
+
+    std::atomic<bool> stop{false};
+    std::atomic<bool> prefetched{false};
+    std::thread prefetcher;
+};
+
+}  // namespace knowhere
@@ -11,15 +11,19 @@
 
 #include "IndexConditionalWrapper.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
 #include "faiss/IndexCosine.h"
+#include "faiss/IndexFlatCodes.h"
 #include "faiss/IndexHNSW.h"
 #include "faiss/IndexRefine.h"
 #include "index/hnsw/impl/IndexBruteForceWrapper.h"
 #include "index/hnsw/impl/IndexHNSWWrapper.h"
 #include "index/hnsw/impl/IndexWrapperCosine.h"
+#include "index/refine/refine_utils.h"
+#include "knowhere/tolower.h"
 #include "knowhere/utils.h"
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
@@ -28,22 +32,37 @@
 
 namespace knowhere {
 
-// Decides whether a brute force should be used instead of a regular HNSW search.
-// This may be applicable in case of very large topk values or
-//   extremely high filtering levels.
-std::optional<bool>
-WhetherPerformBruteForceSearch(const faiss::Index* index, const BaseConfig& cfg, const BitsetView& bitset) {
+namespace {
+
+// the HNSW index under the refine of an index, nullptr if there is none
+const faiss::IndexHNSW*
+find_index_hnsw(const faiss::Index* index) {
+    const faiss::IndexRefine* const index_refine = dynamic_cast<const faiss::IndexRefine*>(index);
+    if (index_refine != nullptr) {
+        index = index_refine->base_index;
+    }
+    return dynamic_cast<const faiss::IndexHNSW*>(index);
+}
+
+}  // namespace
+
+// Plans a k-NN search of nq queries from the statistics of the graph and of the storage of an HNSW index, the density
+//   of the filter and the search_strategy of the config.
+std::optional<SearchPlan>
+PlanHnswSearch(const faiss::Index* index, const FaissHnswConfig& cfg, const BitsetView& bitset, const size_t nq,
+               const bool mmapped) {
     // check if parameters have all we need
     if (!cfg.k.has_value() || index == nullptr) {
         return std::nullopt;
     }
 
-    // decide
-    const auto k = cfg.k.value();
-
-    if (k >= (index->ntotal * HnswSearchThresholds::kHnswSearchBFTopkThreshold)) {
-        return true;
-    }
+    SearchProfile profile;
+    profile.num_rows = index->ntotal;
+    profile.num_valid_rows = index->ntotal;
+    profile.k = cfg.k.value();
+    profile.ef = cfg.ef.value_or(profile.k);
+    profile.nq = nq;
+    profile.mmapped = mmapped;
 
     if (!bitset.empty()) {
         const size_t filtered_out_num = bitset.count();
@@ -51,14 +70,31 @@ WhetherPerformBruteForceSearch(const faiss::Index* index, const BaseConfig& cfg,
         double ratio = ((double)filtered_out_num) / bitset.size();
         knowhere::knowhere_hnsw_bitset_ratio.Observe(ratio);
 #endif
-        if (filtered_out_num >= (bitset.size() * HnswSearchThresholds::kHnswSearchKnnBFFilterThreshold) ||
-            k >= (bitset.size() - filtered_out_num) * HnswSearchThresholds::kHnswSearchBFTopkThreshold) {
-            return true;
-        }
+        profile.num_rows = bitset.size();
+        profile.num_valid_rows = bitset.size() - filtered_out_num;
+        // the searches of fewer queries test the ids through the mapping, those of more resolve it anyway
+        profile.resolves_out_ids =
+            bitset.has_out_ids() && nq < (size_t)HnswSearchThresholds::kHnswSearchResolveOutIdsMinQueries;
     }
 
-    // the default value
-    return false;
+    const faiss::IndexHNSW* const index_hnsw = find_index_hnsw(index);
+    if (index_hnsw != nullptr) {
+        profile.graph_degree = index_hnsw->hnsw.nb_neighbors(0);
+        const faiss::IndexFlatCodes* const storage = dynamic_cast<const faiss::IndexFlatCodes*>(index_hnsw->storage);
+        profile.code_size = storage != nullptr ? storage->code_size : index_hnsw->d * sizeof(float);
+    } else {
+        profile.code_size = index->d * sizeof(float);
+    }
+
+    uint32_t allowed = kAllSearchStrategies;
+    const auto strategy = str_to_lower(cfg.search_strategy.value_or("auto"));
+    if (strategy == "graph") {
+        allowed = static_cast<uint32_t>(SearchStrategy::GRAPH) | static_cast<uint32_t>(SearchStrategy::GRAPH_TWO_HOP);
+    } else if (strategy == "brute_force") {
+        allowed = static_cast<uint32_t>(SearchStrategy::BRUTE_FORCE);
+    }
+
+    return PlanSearch(profile, allowed);
 }
 
 // Decides whether a brute force should be used instead of a regular HNSW range search.
@@ -136,41 +172,38 @@ create_conditional_hnsw_wrapper(faiss::Index* index, const FaissHnswConfig& hnsw
             // thus, we need to define a new refine index and pass
             //   wrapper_searcher into its ownership
 
-            // is it a cosine index?
-            if (index_hnsw->storage->is_cosine && is_cosine) {
-                // yes, wrap both base and refine index
-                std::unique_ptr<knowhere::IndexWrapperCosine> cosine_wrapper =
-                    std::make_unique<knowhere::IndexWrapperCosine>(
-                        index_refine->refine_index,
-                        dynamic_cast<faiss::HasInverseL2Norms*>(index_hnsw->storage)->get_inverse_l2_norms());
-
-                // create a temporary refine index
-                std::unique_ptr<faiss::IndexRefine> refine_wrapper =
-                    std::make_unique<faiss::IndexRefine>(base_wrapper.get(), cosine_wrapper.get());
-
-                // transfer ownership
-                refine_wrapper->own_fields = true;
-                base_wrapper.release();
-
-                refine_wrapper->own_refine_index = true;
-                cosine_wrapper.release();
-
-                // done
-                return {std::move(refine_wrapper), true};
-            } else {
-                // no, wrap base index only.
+            // is it a cosine index? if yes, the refine indices are wrapped as well
+            const bool wrap_cosine = index_hnsw->storage->is_cosine && is_cosine;
 
-                // create a temporary refine index
-                std::unique_ptr<faiss::IndexRefine> refine_wrapper =
-                    std::make_unique<faiss::IndexRefine>(base_wrapper.get(), index_refine->refine_index);
+            // creates a temporary refine index of `stage_index` over `base`
+            auto add_refine_stage = [&](std::unique_ptr<faiss::Index> base, faiss::Index* stage_index) {
+                std::unique_ptr<faiss::Index> cosine_wrapper;
+                if (wrap_cosine) {
+                    cosine_wrapper = std::make_unique<knowhere::IndexWrapperCosine>(
+                        stage_index, faiss::get_storage_inverse_l2_norms(index_hnsw->storage)->get_inverse_l2_norms());
+                }
+                std::unique_ptr<faiss::IndexRefine> refine_wrapper = std::make_unique<faiss::IndexRefine>(
+                    base.get(), cosine_wrapper != nullptr ? cosine_wrapper.get() : stage_index);
 
                 // transfer ownership
                 refine_wrapper->own_fields = true;
-                base_wrapper.release();
-
-                // done
-                return {std::move(refine_wrapper), true};
+                base.release();
+                if (cosine_wrapper != nullptr) {
+                    refine_wrapper->own_refine_index = true;
+                    cosine_wrapper.release();
+                }
+                return refine_wrapper;
+            };
+
+            // a refine cascade refines the base index with its intermediate stage, which its last stage refines
+            const faiss::IndexRefine* cascade = get_refine_cascade(index_refine->refine_index);
+            if (cascade != nullptr) {
+                auto cascade_wrapper = add_refine_stage(std::move(base_wrapper), cascade->base_index);
+                return {add_refine_stage(std::move(cascade_wrapper), cascade->refine_index), true};
             }
+
+            // done
+            return {add_refine_stage(std::move(base_wrapper), index_refine->refine_index), true};
         } else {
             // no, a user wants to skip a refine
 
@@ -201,4 +234,31 @@ create_conditional_hnsw_wrapper(faiss::Index* index, const FaissHnswConfig& hnsw
     }
 }
 
+void
+setup_refine_search_params(const faiss::Index* refine_wrapper, const FaissHnswConfig& hnsw_cfg,
+                           faiss::SearchParameters* base_params, faiss::IndexRefineSearchParameters& refine_params,
+                           faiss::IndexRefineSearchParameters& cascade_params) {
+    const float refine_k = hnsw_cfg.refine_k.value_or(1);
+
+    refine_params.k_factor = refine_k;
+    // a refine procedure itself does not need to care about filtering
+    refine_params.sel = nullptr;
+    refine_params.base_index_params = base_params;
+
+    const auto index_refine = dynamic_cast<const faiss::IndexRefine*>(refine_wrapper);
+    if (index_refine == nullptr || dynamic_cast<const faiss::IndexRefine*>(index_refine->base_index) == nullptr) {
+        return;
+    }
+
+    // a refine cascade: the last stage reranks the refine_cascade_k * k best candidates of the intermediate stage,
+    //   which reranks the refine_k * k ones of the base index
+    const float cascade_k = std::min(hnsw_cfg.refine_cascade_k.value_or(refine_k), refine_k);
+    refine_params.k_factor = cascade_k;
+    refine_params.base_index_params = &cascade_params;
+
+    cascade_params.k_factor = refine_k / cascade_k;
+    cascade_params.sel = nullptr;
+    cascade_params.base_index_params = base_params;
+}
+
 }  // namespace knowhere
@@ -18,8 +18,10 @@
 #include <tuple>
 
 #include "faiss/Index.h"
+#include "faiss/IndexRefine.h"
 #include "index/hnsw/faiss_hnsw_config.h"
 #include "knowhere/bitsetview.h"
+#include "knowhere/comp/search_planner.h"
 
 namespace knowhere {
 
@@ -27,13 +29,24 @@ struct HnswSearchThresholds {
     static constexpr float kHnswSearchKnnBFFilterThreshold = 0.93f;
     static constexpr float kHnswSearchRangeBFFilterThreshold = 0.97f;
     static constexpr float kHnswSearchBFTopkThreshold = 0.5f;
+    // the filter-aware (two-hop) traversal is enabled for the filter ratios from kHnswSearchTwoHopFilterThreshold
+    //   up to the brute force thresholds, and it is applied to the nodes with less than
+    //   kHnswSearchTwoHopConnectivityThreshold of their neighbors passing the filter.
+    static constexpr float kHnswSearchTwoHopFilterThreshold = 0.8f;
+    static constexpr float kHnswSearchTwoHopConnectivityThreshold = 0.25f;
+    // the number of queries whose searches a search task interleaves, if every search thread gets that many.
+    static constexpr size_t kHnswSearchInterleaveBlockSize = 8;
+    // the id mapping of a filter is resolved into a bitset over the internal ids for the brute force searches, which
+    //   test every id, and for the searches of at least this many queries.
+    static constexpr int64_t kHnswSearchResolveOutIdsMinQueries = 32;
 };
 
-// Decides whether a brute force should be used instead of a regular HNSW search.
-// This may be applicable in case of very large topk values or
-//   extremely high filtering levels.
-std::optional<bool>
-WhetherPerformBruteForceSearch(const faiss::Index* index, const BaseConfig& cfg, const BitsetView& bitset);
+// Plans a k-NN search of nq queries (@see PlanSearch) from the statistics of the graph and of the storage of an HNSW
+//   index, the density of the filter and the search_strategy of the config. The brute force pays off for very large
+//   topk values or for filters that leave few rows compared to the nodes the graph traversal would go through.
+std::optional<SearchPlan>
+PlanHnswSearch(const faiss::Index* index, const FaissHnswConfig& cfg, const BitsetView& bitset, const size_t nq,
+               const bool mmapped);
 
 // Decides whether a brute force should be used instead of a regular HNSW range search.
 // This may be applicable in case of very large topk values or
@@ -50,4 +63,12 @@ std::tuple<std::unique_ptr<faiss::Index>, bool>
 create_conditional_hnsw_wrapper(faiss::Index* index, const FaissHnswConfig& hnsw_cfg, const bool whether_bf_search,
                                 const bool whether_to_enable_refine);
 
+// Sets up the search parameters of a refine index created by create_conditional_hnsw_wrapper(), over the parameters
+//   of its base index. For a refine cascade, those of its intermediate stage are set up in `cascade_params`, which
+//   must outlive `refine_params`.
+void
+setup_refine_search_params(const faiss::Index* refine_wrapper, const FaissHnswConfig& hnsw_cfg,
+                           faiss::SearchParameters* base_params, faiss::IndexRefineSearchParameters& refine_params,
+                           faiss::IndexRefineSearchParameters& cascade_params);
+
 }  // namespace knowhere
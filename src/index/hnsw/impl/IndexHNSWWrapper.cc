@@ -11,11 +11,16 @@
 
 #include "index/hnsw/impl/IndexHNSWWrapper.h"
 
+#include <faiss/IndexAdditiveQuantizer.h>
+#include <faiss/IndexFlat.h>
 #include <faiss/IndexHNSW.h>
+#include <faiss/IndexPQ.h>
+#include <faiss/IndexPreTransform.h>
+#include <faiss/IndexScalarQuantizer.h>
 #include <faiss/MetricType.h>
 #include <faiss/cppcontrib/knowhere/impl/Bruteforce.h>
 #include <faiss/cppcontrib/knowhere/impl/HnswSearcher.h>
-#include <faiss/cppcontrib/knowhere/utils/Bitset.h>
+#include <faiss/cppcontrib/knowhere/utils/VisitedSet.h>
 #include <faiss/impl/AuxIndexStructures.h>
 #include <faiss/impl/DistanceComputer.h>
 #include <faiss/impl/FaissAssert.h>
@@ -26,6 +31,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "index/hnsw/impl/DummyVisitor.h"
 #include "index/hnsw/impl/FederVisitor.h"
@@ -54,8 +60,100 @@ storage_distance_computer(const faiss::Index* storage) {
     }
 }
 
+// the visited set of the search thread, reused by all the queries it runs
+faiss::cppcontrib::knowhere::VisitedSet&
+thread_visited_set() {
+    thread_local faiss::cppcontrib::knowhere::VisitedSet visited_set;
+    return visited_set;
+}
+
+// the visited sets of the queries that the search thread interleaves
+std::vector<faiss::cppcontrib::knowhere::VisitedSet>&
+thread_interleaved_visited_sets() {
+    thread_local std::vector<faiss::cppcontrib::knowhere::VisitedSet> visited_sets;
+    return visited_sets;
+}
+
+// searches nq queries with interleaved expansions, see faiss::cppcontrib::knowhere::search_interleaved()
+template <typename FilterT>
+void
+search_interleaved_block(const faiss::IndexHNSW* index_hnsw, const HnswInlineLayout* inline_layout,
+                         const FilterT& filter, const SearchParametersHNSWWrapper* params, const float kAlpha,
+                         const size_t prefetch_distance, const float two_hop_connectivity,
+                         const size_t expected_visits, const faiss::idx_t nq, const float* x, const faiss::idx_t k,
+                         float* distances, faiss::idx_t* labels, faiss::HNSWStats* query_stats,
+                         float* connectivity_ratios) {
+    using searcher_type =
+        faiss::cppcontrib::knowhere::v2_hnsw_searcher<faiss::DistanceComputer, DummyVisitor,
+                                                      faiss::cppcontrib::knowhere::VisitedSet, FilterT>;
+
+    const faiss::HNSW& hnsw = index_hnsw->hnsw;
+    const faiss::HNSW::storage_idx_t* level0_neighbors =
+        (inline_layout == nullptr) ? nullptr : inline_layout->neighbors();
+    const size_t level0_stride = (inline_layout == nullptr) ? 0 : inline_layout->stride_in_ids();
+
+    std::vector<faiss::cppcontrib::knowhere::VisitedSet>& visited_sets = thread_interleaved_visited_sets();
+    if (visited_sets.size() < (size_t)nq) {
+        visited_sets.resize(nq);
+    }
+
+    DummyVisitor graph_visitor;
+
+    std::vector<std::unique_ptr<faiss::DistanceComputer>> dis(nq);
+    std::vector<std::unique_ptr<searcher_type>> searchers(nq);
+    std::vector<searcher_type*> searcher_ptrs(nq);
+    for (faiss::idx_t q = 0; q < nq; q++) {
+        dis[q].reset((inline_layout == nullptr) ? storage_distance_computer(index_hnsw->storage)
+                                                : inline_layout->get_distance_computer());
+        dis[q]->set_query(x + q * index_hnsw->d);
+
+        visited_sets[q].reset(index_hnsw->ntotal, expected_visits);
+
+        searchers[q] = std::make_unique<searcher_type>(hnsw, *(dis[q].get()), graph_visitor, visited_sets[q], filter,
+                                                       kAlpha, params, prefetch_distance, two_hop_connectivity,
+                                                       level0_neighbors, level0_stride,
+                                                       params->early_termination_patience, params->entry_points,
+                                                       params->n_entry_points);
+        searcher_ptrs[q] = searchers[q].get();
+    }
+
+    faiss::cppcontrib::knowhere::search_interleaved(searcher_ptrs.data(), nq, k, distances, labels, query_stats);
+
+    for (faiss::idx_t q = 0; q < nq; q++) {
+        connectivity_ratios[q] = (two_hop_connectivity > 0) ? searchers[q]->connectivity_ratio() : -1.0f;
+    }
+}
+
 }  // namespace
 
+size_t
+hnsw_prefetch_distance(const faiss::Index* storage) {
+    // the distances to fp32 codes take long enough to hide the fetch of the next batch,
+    //   shorter codes have to be requested further ahead.
+    if (auto index_pt = dynamic_cast<const faiss::IndexPreTransform*>(storage); index_pt != nullptr) {
+        // the distance computer of a rotated storage forwards the prefetches to the one of its codes
+        storage = index_pt->index;
+    }
+    if (dynamic_cast<const faiss::IndexFlat*>(storage) != nullptr) {
+        return 4;
+    }
+    if (dynamic_cast<const faiss::IndexScalarQuantizer*>(storage) != nullptr) {
+        return 8;
+    }
+    if (dynamic_cast<const faiss::IndexPQ*>(storage) != nullptr ||
+        dynamic_cast<const faiss::IndexAdditiveQuantizer*>(storage) != nullptr) {
+        return 12;
+    }
+    // unknown storages do not prefetch
+    return 0;
+}
+
+size_t
+hnsw_expected_visits(const faiss::HNSW& hnsw, const size_t ef) {
+    // about ef nodes are expanded, each of them brings its whole neighbor list at worst
+    return std::max<size_t>(ef, 1) * hnsw.nb_neighbors(0);
+}
+
 /**************************************************************
  * IndexHNSWWrapper implementation
  **************************************************************/
@@ -101,8 +199,17 @@ IndexHNSWWrapper::search(idx_t n, const float* __restrict x, idx_t k, float* __r
         kAlpha = params->kAlpha;
     }
 
+    const size_t prefetch_distance = (params != nullptr && params->prefetch_distance >= 0)
+                                         ? params->prefetch_distance
+                                         : hnsw_prefetch_distance(index_hnsw->storage);
+    const float two_hop_connectivity = (params == nullptr) ? 0.0f : params->two_hop_connectivity;
+    const size_t early_termination_patience = (params == nullptr) ? 0 : params->early_termination_patience;
+    const faiss::HNSW::storage_idx_t* entry_points = (params == nullptr) ? nullptr : params->entry_points;
+    const size_t n_entry_points = (params == nullptr) ? 0 : params->n_entry_points;
+
     // set up hnsw_stats
     faiss::HNSWStats* __restrict const hnsw_stats = (params == nullptr) ? nullptr : params->hnsw_stats;
+    faiss::HNSWStats* __restrict const per_query_stats = (params == nullptr) ? nullptr : params->query_stats;
 
     //
     size_t n1 = 0;
@@ -110,26 +217,93 @@ IndexHNSWWrapper::search(idx_t n, const float* __restrict x, idx_t k, float* __r
     size_t ndis = 0;
     size_t nhops = 0;
 
-    //
-    faiss::cppcontrib::knowhere::Bitset bitset_visited_nodes =
-        faiss::cppcontrib::knowhere::Bitset::create_uninitialized(index->ntotal);
+    // the table of visited elements, sized for every query
+    faiss::cppcontrib::knowhere::VisitedSet& visited_nodes = thread_visited_set();
+    const size_t expected_visits =
+        hnsw_expected_visits(hnsw, (params != nullptr) ? params->efSearch : hnsw.efSearch);
+
+    // the inline layout replaces the level 0 neighbor lists and the codes of the index, if it was built for it
+    const HnswInlineLayout* inline_layout =
+        (params != nullptr && params->inline_layout != nullptr && params->inline_layout->ntotal() == index->ntotal)
+            ? params->inline_layout
+            : nullptr;
+    const faiss::HNSW::storage_idx_t* level0_neighbors =
+        (inline_layout == nullptr) ? nullptr : inline_layout->neighbors();
+    const size_t level0_stride = (inline_layout == nullptr) ? 0 : inline_layout->stride_in_ids();
 
     // create a distance computer
-    std::unique_ptr<faiss::DistanceComputer> dis(storage_distance_computer(index_hnsw->storage));
+    std::unique_ptr<faiss::DistanceComputer> dis((inline_layout == nullptr)
+                                                     ? storage_distance_computer(index_hnsw->storage)
+                                                     : inline_layout->get_distance_computer());
+
+    // the queries that were searched with interleaved expansions
+    idx_t n_interleaved = 0;
+
+    const size_t interleaved_queries =
+        (params == nullptr || params->feder != nullptr) ? 1 : std::max<size_t>(params->interleaved_queries, 1);
+    if (interleaved_queries > 1 && n > 1) {
+        std::vector<faiss::HNSWStats> query_stats(interleaved_queries);
+        std::vector<float> connectivity_ratios(interleaved_queries);
+
+        const knowhere::BitsetViewIDSelector* bw_idselector =
+            dynamic_cast<const knowhere::BitsetViewIDSelector*>(params->sel);
+
+        for (idx_t i0 = 0; i0 < n; i0 += interleaved_queries) {
+            const idx_t nq = std::min<idx_t>(interleaved_queries, n - i0);
+
+            if (bw_idselector != nullptr && !bw_idselector->bitset_view.empty()) {
+                search_interleaved_block(index_hnsw, inline_layout, *bw_idselector, params, kAlpha, prefetch_distance,
+                                         two_hop_connectivity, expected_visits, nq, x + i0 * index->d, k,
+                                         distances + i0 * k, labels + i0 * k, query_stats.data(),
+                                         connectivity_ratios.data());
+            } else {
+                faiss::IDSelectorAll sel_all;
+                search_interleaved_block(index_hnsw, inline_layout, sel_all, params, kAlpha, prefetch_distance, 0.0f,
+                                         expected_visits, nq, x + i0 * index->d, k, distances + i0 * k,
+                                         labels + i0 * k, query_stats.data(), connectivity_ratios.data());
+            }
+
+            for (idx_t q = 0; q < nq; q++) {
+                // record some statistics
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+                knowhere::knowhere_hnsw_search_hops.Observe(query_stats[q].nhops);
+                if (two_hop_connectivity > 0 && connectivity_ratios[q] >= 0) {
+                    knowhere::knowhere_filter_connectivity_ratio.Observe(connectivity_ratios[q]);
+                }
+#endif
+
+                if (per_query_stats != nullptr) {
+                    per_query_stats[i0 + q].combine(query_stats[q]);
+                }
+
+                // update stats if possible
+                if (hnsw_stats != nullptr) {
+                    n1 += query_stats[q].n1;
+                    n2 += query_stats[q].n2;
+                    ndis += query_stats[q].ndis;
+                    nhops += query_stats[q].nhops;
+                }
+            }
+        }
+
+        n_interleaved = n;
+    }
 
     // no parallelism by design
-    for (idx_t i = 0; i < n; i++) {
+    for (idx_t i = n_interleaved; i < n; i++) {
         // prepare the query
         dis->set_query(x + i * index->d);
 
         // prepare the table of visited elements
-        bitset_visited_nodes.clear();
+        visited_nodes.reset(index->ntotal, expected_visits);
 
         // a visitor
         knowhere::feder::hnsw::FederResult* feder = (params == nullptr) ? nullptr : params->feder;
 
         // future results
         faiss::HNSWStats local_stats;
+        // the fraction of the visited neighbors that pass the filter, if the filter-aware traversal measures it
+        float connectivity_ratio = -1.0f;
 
         // set up a filter
         faiss::IDSelector* sel = (params == nullptr) ? nullptr : params->sel;
@@ -147,26 +321,52 @@ IndexHNSWWrapper::search(idx_t n, const float* __restrict x, idx_t k, float* __r
 
                 using searcher_type =
                     faiss::cppcontrib::knowhere::v2_hnsw_searcher<faiss::DistanceComputer, DummyVisitor,
-                                                                  faiss::cppcontrib::knowhere::Bitset,
+                                                                  faiss::cppcontrib::knowhere::VisitedSet,
                                                                   knowhere::BitsetViewIDSelector>;
 
-                searcher_type searcher{hnsw,           *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       *bw_idselector, kAlpha,       params};
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       *bw_idselector,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       two_hop_connectivity,
+                                       level0_neighbors,
+                                       level0_stride,
+                                       early_termination_patience,
+                                       entry_points,
+                                       n_entry_points};
 
                 local_stats = searcher.search(k, distances + i * k, labels + i * k);
+                connectivity_ratio = searcher.connectivity_ratio();
             } else {
                 // use feder
                 FederVisitor graph_visitor(feder);
 
                 using searcher_type =
                     faiss::cppcontrib::knowhere::v2_hnsw_searcher<faiss::DistanceComputer, FederVisitor,
-                                                                  faiss::cppcontrib::knowhere::Bitset,
+                                                                  faiss::cppcontrib::knowhere::VisitedSet,
                                                                   knowhere::BitsetViewIDSelector>;
 
-                searcher_type searcher{hnsw,           *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       *bw_idselector, kAlpha,       params};
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       *bw_idselector,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       two_hop_connectivity,
+                                       level0_neighbors,
+                                       level0_stride,
+                                       early_termination_patience,
+                                       entry_points,
+                                       n_entry_points};
 
                 local_stats = searcher.search(k, distances + i * k, labels + i * k);
+                connectivity_ratio = searcher.connectivity_ratio();
             }
         } else {
             // no filter
@@ -178,10 +378,22 @@ IndexHNSWWrapper::search(idx_t n, const float* __restrict x, idx_t k, float* __r
                 DummyVisitor graph_visitor;
 
                 using searcher_type = faiss::cppcontrib::knowhere::v2_hnsw_searcher<
-                    faiss::DistanceComputer, DummyVisitor, faiss::cppcontrib::knowhere::Bitset, faiss::IDSelectorAll>;
-
-                searcher_type searcher{hnsw,    *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       sel_all, kAlpha,       params};
+                    faiss::DistanceComputer, DummyVisitor, faiss::cppcontrib::knowhere::VisitedSet, faiss::IDSelectorAll>;
+
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       sel_all,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       0.0f,
+                                       level0_neighbors,
+                                       level0_stride,
+                                       early_termination_patience,
+                                       entry_points,
+                                       n_entry_points};
 
                 local_stats = searcher.search(k, distances + i * k, labels + i * k);
             } else {
@@ -189,10 +401,22 @@ IndexHNSWWrapper::search(idx_t n, const float* __restrict x, idx_t k, float* __r
                 FederVisitor graph_visitor(feder);
 
                 using searcher_type = faiss::cppcontrib::knowhere::v2_hnsw_searcher<
-                    faiss::DistanceComputer, FederVisitor, faiss::cppcontrib::knowhere::Bitset, faiss::IDSelectorAll>;
-
-                searcher_type searcher{hnsw,    *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       sel_all, kAlpha,       params};
+                    faiss::DistanceComputer, FederVisitor, faiss::cppcontrib::knowhere::VisitedSet, faiss::IDSelectorAll>;
+
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       sel_all,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       0.0f,
+                                       level0_neighbors,
+                                       level0_stride,
+                                       early_termination_patience,
+                                       entry_points,
+                                       n_entry_points};
 
                 local_stats = searcher.search(k, distances + i * k, labels + i * k);
             }
@@ -201,8 +425,15 @@ IndexHNSWWrapper::search(idx_t n, const float* __restrict x, idx_t k, float* __r
         // record some statistics
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
         knowhere::knowhere_hnsw_search_hops.Observe(local_stats.nhops);
+        if (two_hop_connectivity > 0 && connectivity_ratio >= 0) {
+            knowhere::knowhere_filter_connectivity_ratio.Observe(connectivity_ratio);
+        }
 #endif
 
+        if (per_query_stats != nullptr) {
+            per_query_stats[i].combine(local_stats);
+        }
+
         // update stats if possible
         if (hnsw_stats != nullptr) {
             n1 += local_stats.n1;
@@ -226,6 +457,133 @@ IndexHNSWWrapper::search(idx_t n, const float* __restrict x, idx_t k, float* __r
     }
 }
 
+namespace {
+
+// the group of a node of a group-by search
+struct NodeGroupId {
+    const GroupByColumn& column;
+    const uint32_t* id_mapping;
+
+    int64_t
+    operator()(const idx_t id) const {
+        return column((id_mapping == nullptr) ? id : static_cast<int64_t>(id_mapping[id]));
+    }
+};
+
+// searches a single query for its groups with a given filter
+template <typename FilterT>
+faiss::HNSWStats
+search_group_by_query(const faiss::IndexHNSW* index_hnsw, const HnswInlineLayout* inline_layout,
+                      faiss::DistanceComputer& dis, faiss::cppcontrib::knowhere::VisitedSet& visited_nodes,
+                      const FilterT& filter, const SearchParametersHNSWWrapper* params, const float kAlpha,
+                      const size_t prefetch_distance, const float two_hop_connectivity, const idx_t k,
+                      const idx_t group_size, const NodeGroupId& group_id, float* distances, idx_t* labels) {
+    using searcher_type =
+        faiss::cppcontrib::knowhere::v2_hnsw_searcher<faiss::DistanceComputer, DummyVisitor,
+                                                      faiss::cppcontrib::knowhere::VisitedSet, FilterT>;
+
+    DummyVisitor graph_visitor;
+    searcher_type searcher{index_hnsw->hnsw,
+                           dis,
+                           graph_visitor,
+                           visited_nodes,
+                           filter,
+                           kAlpha,
+                           params,
+                           prefetch_distance,
+                           two_hop_connectivity,
+                           (inline_layout == nullptr) ? nullptr : inline_layout->neighbors(),
+                           (inline_layout == nullptr) ? 0 : inline_layout->stride_in_ids()};
+
+    return searcher.search_group_by(k, group_size, group_id, distances, labels);
+}
+
+}  // namespace
+
+void
+IndexHNSWWrapper::search_group_by(idx_t n, const float* __restrict x, idx_t k, idx_t group_size,
+                                  const GroupByColumn& column, const uint32_t* id_mapping, float* __restrict distances,
+                                  idx_t* __restrict labels, const faiss::SearchParameters* __restrict params_in) const {
+    FAISS_THROW_IF_NOT(k > 0 && group_size > 0);
+
+    const faiss::IndexHNSW* index_hnsw = dynamic_cast<const faiss::IndexHNSW*>(index);
+    FAISS_THROW_IF_NOT(index_hnsw);
+
+    FAISS_THROW_IF_NOT_MSG(index_hnsw->storage, "No storage index");
+
+    // check parameters
+    const SearchParametersHNSWWrapper* params = nullptr;
+    const faiss::HNSW& hnsw = index_hnsw->hnsw;
+
+    float kAlpha = 0.0f;
+    if (params_in) {
+        params = dynamic_cast<const SearchParametersHNSWWrapper*>(params_in);
+        FAISS_THROW_IF_NOT_MSG(params, "params type invalid");
+
+        kAlpha = params->kAlpha;
+    }
+
+    const size_t prefetch_distance = (params != nullptr && params->prefetch_distance >= 0)
+                                         ? params->prefetch_distance
+                                         : hnsw_prefetch_distance(index_hnsw->storage);
+    const float two_hop_connectivity = (params == nullptr) ? 0.0f : params->two_hop_connectivity;
+    faiss::HNSWStats* __restrict const per_query_stats = (params == nullptr) ? nullptr : params->query_stats;
+
+    // the table of visited elements, sized for every query
+    faiss::cppcontrib::knowhere::VisitedSet& visited_nodes = thread_visited_set();
+    const size_t expected_visits =
+        hnsw_expected_visits(hnsw, (params != nullptr) ? params->efSearch : hnsw.efSearch);
+
+    // the inline layout replaces the level 0 neighbor lists and the codes of the index, if it was built for it
+    const HnswInlineLayout* inline_layout =
+        (params != nullptr && params->inline_layout != nullptr && params->inline_layout->ntotal() == index->ntotal)
+            ? params->inline_layout
+            : nullptr;
+
+    // create a distance computer
+    std::unique_ptr<faiss::DistanceComputer> dis((inline_layout == nullptr)
+                                                     ? storage_distance_computer(index_hnsw->storage)
+                                                     : inline_layout->get_distance_computer());
+
+    const NodeGroupId group_id{column, id_mapping};
+    const knowhere::BitsetViewIDSelector* bw_idselector =
+        (params == nullptr) ? nullptr : dynamic_cast<const knowhere::BitsetViewIDSelector*>(params->sel);
+    const idx_t n_results = k * group_size;
+
+    for (idx_t i = 0; i < n; i++) {
+        dis->set_query(x + i * index->d);
+        visited_nodes.reset(index->ntotal, expected_visits);
+
+        faiss::HNSWStats local_stats;
+        if (bw_idselector != nullptr && !bw_idselector->bitset_view.empty()) {
+            local_stats = search_group_by_query(index_hnsw, inline_layout, *dis, visited_nodes, *bw_idselector,
+                                                params, kAlpha, prefetch_distance, two_hop_connectivity, k,
+                                                group_size, group_id, distances + i * n_results,
+                                                labels + i * n_results);
+        } else {
+            faiss::IDSelectorAll sel_all;
+            local_stats = search_group_by_query(index_hnsw, inline_layout, *dis, visited_nodes, sel_all, params,
+                                                kAlpha, prefetch_distance, 0.0f, k, group_size, group_id,
+                                                distances + i * n_results, labels + i * n_results);
+        }
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+        knowhere::knowhere_hnsw_search_hops.Observe(local_stats.nhops);
+#endif
+        if (per_query_stats != nullptr) {
+            per_query_stats[i].combine(local_stats);
+        }
+    }
+
+    // done, update the results, if needed
+    if (is_similarity_metric(index->metric_type)) {
+        // we need to revert the negated distances
+        for (idx_t i = 0; i < n * n_results; i++) {
+            distances[i] = -distances[i];
+        }
+    }
+}
+
 void
 IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_in,
                                faiss::RangeSearchResult* __restrict result,
@@ -252,6 +610,11 @@ IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_
         kAlpha = params->kAlpha;
     }
 
+    const size_t prefetch_distance = (params != nullptr && params->prefetch_distance >= 0)
+                                         ? params->prefetch_distance
+                                         : hnsw_prefetch_distance(index_hnsw->storage);
+    const float two_hop_connectivity = (params == nullptr) ? 0.0f : params->two_hop_connectivity;
+
     // set up hnsw_stats
     faiss::HNSWStats* __restrict const hnsw_stats = (params == nullptr) ? nullptr : params->hnsw_stats;
 
@@ -261,12 +624,24 @@ IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_
     size_t ndis = 0;
     size_t nhops = 0;
 
-    //
-    faiss::cppcontrib::knowhere::Bitset bitset_visited_nodes =
-        faiss::cppcontrib::knowhere::Bitset::create_uninitialized(index->ntotal);
+    // the table of visited elements, sized for every query
+    faiss::cppcontrib::knowhere::VisitedSet& visited_nodes = thread_visited_set();
+    const size_t expected_visits =
+        hnsw_expected_visits(hnsw, (params != nullptr) ? params->efSearch : hnsw.efSearch);
+
+    // the inline layout replaces the level 0 neighbor lists and the codes of the index, if it was built for it
+    const HnswInlineLayout* inline_layout =
+        (params != nullptr && params->inline_layout != nullptr && params->inline_layout->ntotal() == index->ntotal)
+            ? params->inline_layout
+            : nullptr;
+    const faiss::HNSW::storage_idx_t* level0_neighbors =
+        (inline_layout == nullptr) ? nullptr : inline_layout->neighbors();
+    const size_t level0_stride = (inline_layout == nullptr) ? 0 : inline_layout->stride_in_ids();
 
     // create a distance computer
-    std::unique_ptr<faiss::DistanceComputer> dis(storage_distance_computer(index_hnsw->storage));
+    std::unique_ptr<faiss::DistanceComputer> dis((inline_layout == nullptr)
+                                                     ? storage_distance_computer(index_hnsw->storage)
+                                                     : inline_layout->get_distance_computer());
 
     // radius
     float radius = radius_in;
@@ -288,13 +663,15 @@ IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_
         dis->set_query(x + i * index->d);
 
         // prepare the table of visited elements
-        bitset_visited_nodes.clear();
+        visited_nodes.reset(index->ntotal, expected_visits);
 
         // a visitor
         knowhere::feder::hnsw::FederResult* feder = (params == nullptr) ? nullptr : params->feder;
 
         // future results
         faiss::HNSWStats local_stats;
+        // the fraction of the visited neighbors that pass the filter, if the filter-aware traversal measures it
+        float connectivity_ratio = -1.0f;
 
         // set up a filter
         faiss::IDSelector* sel = (params == nullptr) ? nullptr : params->sel;
@@ -312,26 +689,46 @@ IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_
 
                 using searcher_type =
                     faiss::cppcontrib::knowhere::v2_hnsw_searcher<faiss::DistanceComputer, DummyVisitor,
-                                                                  faiss::cppcontrib::knowhere::Bitset,
+                                                                  faiss::cppcontrib::knowhere::VisitedSet,
                                                                   knowhere::BitsetViewIDSelector>;
 
-                searcher_type searcher{hnsw,           *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       *bw_idselector, kAlpha,       params};
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       *bw_idselector,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       two_hop_connectivity,
+                                       level0_neighbors,
+                                       level0_stride};
 
                 local_stats = searcher.range_search(radius, &res_min);
+                connectivity_ratio = searcher.connectivity_ratio();
             } else {
                 // use feder
                 FederVisitor graph_visitor(feder);
 
                 using searcher_type =
                     faiss::cppcontrib::knowhere::v2_hnsw_searcher<faiss::DistanceComputer, FederVisitor,
-                                                                  faiss::cppcontrib::knowhere::Bitset,
+                                                                  faiss::cppcontrib::knowhere::VisitedSet,
                                                                   knowhere::BitsetViewIDSelector>;
 
-                searcher_type searcher{hnsw,           *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       *bw_idselector, kAlpha,       params};
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       *bw_idselector,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       two_hop_connectivity,
+                                       level0_neighbors,
+                                       level0_stride};
 
                 local_stats = searcher.range_search(radius, &res_min);
+                connectivity_ratio = searcher.connectivity_ratio();
             }
         } else {
             // no filter
@@ -343,10 +740,19 @@ IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_
                 DummyVisitor graph_visitor;
 
                 using searcher_type = faiss::cppcontrib::knowhere::v2_hnsw_searcher<
-                    faiss::DistanceComputer, DummyVisitor, faiss::cppcontrib::knowhere::Bitset, faiss::IDSelectorAll>;
-
-                searcher_type searcher{hnsw,    *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       sel_all, kAlpha,       params};
+                    faiss::DistanceComputer, DummyVisitor, faiss::cppcontrib::knowhere::VisitedSet, faiss::IDSelectorAll>;
+
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       sel_all,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       0.0f,
+                                       level0_neighbors,
+                                       level0_stride};
 
                 local_stats = searcher.range_search(radius, &res_min);
             } else {
@@ -354,10 +760,19 @@ IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_
                 FederVisitor graph_visitor(feder);
 
                 using searcher_type = faiss::cppcontrib::knowhere::v2_hnsw_searcher<
-                    faiss::DistanceComputer, FederVisitor, faiss::cppcontrib::knowhere::Bitset, faiss::IDSelectorAll>;
-
-                searcher_type searcher{hnsw,    *(dis.get()), graph_visitor, bitset_visited_nodes,
-                                       sel_all, kAlpha,       params};
+                    faiss::DistanceComputer, FederVisitor, faiss::cppcontrib::knowhere::VisitedSet, faiss::IDSelectorAll>;
+
+                searcher_type searcher{hnsw,
+                                       *(dis.get()),
+                                       graph_visitor,
+                                       visited_nodes,
+                                       sel_all,
+                                       kAlpha,
+                                       params,
+                                       prefetch_distance,
+                                       0.0f,
+                                       level0_neighbors,
+                                       level0_stride};
 
                 local_stats = searcher.range_search(radius, &res_min);
             }
@@ -366,6 +781,9 @@ IndexHNSWWrapper::range_search(idx_t n, const float* __restrict x, float radius_
         // record some statistics
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
         knowhere::knowhere_hnsw_search_hops.Observe(local_stats.nhops);
+        if (two_hop_connectivity > 0 && connectivity_ratio >= 0) {
+            knowhere::knowhere_filter_connectivity_ratio.Observe(connectivity_ratio);
+        }
 #endif
 
         // update stats if possible
@@ -17,7 +17,9 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "index/hnsw/impl/HnswInlineLayout.h"
 #include "knowhere/feder/HNSW.h"
+#include "knowhere/group_by.h"
 
 namespace knowhere {
 
@@ -25,15 +27,44 @@ namespace knowhere {
 struct SearchParametersHNSWWrapper : public faiss::SearchParametersHNSW {
     // Stats will be updated if the object pointer is provided.
     faiss::HNSWStats* hnsw_stats = nullptr;
+    // the stats of the query i of a search() call are added to query_stats[i], if the array is provided.
+    faiss::HNSWStats* query_stats = nullptr;
     // feder will be updated if the object pointer is provided.
     knowhere::feder::hnsw::FederResult* feder = nullptr;
     // filtering parameter
     float kAlpha = 1.0f;
+    // how many candidates ahead the codes are prefetched while the neighbors of a node are evaluated,
+    //   a negative value picks the default of the storage type, 0 disables the prefetching.
+    int prefetch_distance = -1;
+    // filter-aware traversal: the neighbors of the filtered out neighbors of a node are expanded as well (two-hop)
+    //   if less than this fraction of its neighbors pass the filter, 0 disables it.
+    float two_hop_connectivity = 0.0f;
+    // the base layer of the graph stored next to the codes, used instead of the index one if provided.
+    const HnswInlineLayout* inline_layout = nullptr;
+    // the queries of a search() call are searched in blocks of this many queries, interleaving the expansions of
+    //   the queries of a block on the calling thread to overlap their memory accesses. 1 searches them one by one.
+    size_t interleaved_queries = 1;
+    // adaptive termination of the k-NN search: the level 0 search of a query stops once this many consecutive
+    //   expansions did not improve its k nearest results, efSearch becoming a ceiling. 0 disables it.
+    size_t early_termination_patience = 0;
+    // the entry points of the graph (@see build_hnsw_entry_points), the k-NN search starts from the ones nearest to
+    //   the query instead of descending the upper levels, if provided.
+    const faiss::HNSW::storage_idx_t* entry_points = nullptr;
+    size_t n_entry_points = 0;
 
     inline ~SearchParametersHNSWWrapper() {
     }
 };
 
+// the default prefetch distance of the HNSW search over a given storage index.
+size_t
+hnsw_prefetch_distance(const faiss::Index* storage);
+
+// a rough estimate of the number of nodes visited by an HNSW search with a given ef, which picks the implementation
+//   of its visited set.
+size_t
+hnsw_expected_visits(const faiss::HNSW& hnsw, const size_t ef);
+
 // TODO:
 // Please note that this particular searcher is int32_t based, so won't
 //   work correctly for 2B+ samples. This can be easily changed, if needed.
@@ -51,6 +82,13 @@ struct IndexHNSWWrapper : public faiss::cppcontrib::knowhere::IndexWrapper {
     void
     range_search(faiss::idx_t n, const float* x, float radius, faiss::RangeSearchResult* result,
                  const faiss::SearchParameters* params) const override;
+
+    /// entry point for group-by search, see v2_hnsw_searcher::search_group_by(). The group of a node is looked up in
+    ///   column by its id, mapped by id_mapping if it is not nullptr. Writes k * group_size results per query.
+    void
+    search_group_by(faiss::idx_t n, const float* x, faiss::idx_t k, faiss::idx_t group_size,
+                    const GroupByColumn& column, const uint32_t* id_mapping, float* distances, faiss::idx_t* labels,
+                    const faiss::SearchParameters* params) const;
 };
 
 }  // namespace knowhere
@@ -0,0 +1,171 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "index/huge_page_index.h"
+
+#include <faiss/IndexBinaryFlat.h>
+#include <faiss/IndexBinaryIVF.h>
+#include <faiss/IndexFlatCodes.h>
+#include <faiss/IndexHNSW.h>
+#include <faiss/IndexIVF.h>
+#include <faiss/IndexPreTransform.h>
+#include <faiss/IndexRefine.h>
+#include <faiss/impl/maybe_owned_vector.h>
+#include <faiss/invlists/ArenaInvertedLists.h>
+
+#include <cstring>
+#include <memory>
+
+#include "knowhere/comp/huge_page.h"
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+namespace {
+
+// the huge page buffer that the buffers of an index are views of
+struct HugePageOwner : public faiss::MaybeOwnedVectorOwner {
+    explicit HugePageOwner(std::unique_ptr<HugePageBuffer> buffer) : buffer(std::move(buffer)) {
+    }
+    std::unique_ptr<HugePageBuffer> buffer;
+};
+
+struct Backer {
+    bool in_place;
+    size_t moved = 0;
+    size_t advised = 0;
+
+    // a buffer of a huge page buffer, with the size bytes at data copied in, nullptr if it could not be allocated
+    std::shared_ptr<HugePageOwner>
+    Move(const void* data, size_t size) {
+        auto buffer = HugePageBuffer::Allocate(size);
+        if (buffer == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(buffer->data(), data, size);
+        moved += size;
+        return std::make_shared<HugePageOwner>(std::move(buffer));
+    }
+
+    void
+    Advise(const void* data, size_t size) {
+        if (size >= HugePageSize()) {
+            AdviseHugePages(data, size);
+            advised += size;
+        }
+    }
+
+    template <typename T>
+    void
+    Back(faiss::MaybeOwnedVector<T>& vec) {
+        const size_t size = vec.size() * sizeof(T);
+        if (size < HugePageSize()) {
+            return;
+        }
+        if (in_place || !vec.is_owned) {
+            Advise(vec.data(), size);
+            return;
+        }
+        if (auto owner = Move(vec.data(), size)) {
+            vec = faiss::MaybeOwnedVector<T>::create_view(owner->buffer->data(), vec.size(), owner);
+        }
+    }
+
+    void
+    Back(faiss::InvertedLists* invlists) {
+        auto arena = dynamic_cast<faiss::ArenaInvertedLists*>(invlists);
+        if (arena == nullptr) {
+            // the other inverted lists are a vector per list
+            return;
+        }
+        const size_t ids_size = arena->ids.size() * sizeof(faiss::idx_t);
+        const size_t codes_size = arena->codes.size();
+        if (in_place || ids_size + codes_size < HugePageSize()) {
+            Advise(arena->ids.data(), ids_size);
+            Advise(arena->codes.data(), codes_size);
+            return;
+        }
+        // the ids then the codes, as in the arena, for its lists to stay as close
+        auto buffer = HugePageBuffer::Allocate(ids_size + codes_size);
+        if (buffer == nullptr) {
+            return;
+        }
+        auto data = static_cast<uint8_t*>(buffer->data());
+        std::memcpy(data, arena->ids.data(), ids_size);
+        std::memcpy(data + ids_size, arena->codes.data(), codes_size);
+        moved += ids_size + codes_size;
+        auto owner = std::make_shared<HugePageOwner>(std::move(buffer));
+        arena->ids = faiss::MaybeOwnedVector<faiss::idx_t>::create_view(data, arena->ids.size(), owner);
+        arena->codes = faiss::MaybeOwnedVector<uint8_t>::create_view(data + ids_size, codes_size, owner);
+    }
+
+    void
+    Back(faiss::Index* index) {
+        if (index == nullptr) {
+            return;
+        }
+        if (auto hnsw = dynamic_cast<faiss::IndexHNSW*>(index)) {
+            Back(hnsw->hnsw.neighbors);
+            Back(hnsw->storage);
+        } else if (auto flat = dynamic_cast<faiss::IndexFlatCodes*>(index)) {
+            Back(flat->codes);
+        } else if (auto ivf = dynamic_cast<faiss::IndexIVF*>(index)) {
+            Back(ivf->quantizer);
+            Back(ivf->invlists);
+        } else if (auto refine = dynamic_cast<faiss::IndexRefine*>(index)) {
+            Back(refine->base_index);
+            Back(refine->refine_index);
+        } else if (auto transform = dynamic_cast<faiss::IndexPreTransform*>(index)) {
+            Back(transform->index);
+        }
+    }
+
+    void
+    Back(faiss::IndexBinary* index) {
+        if (auto flat = dynamic_cast<faiss::IndexBinaryFlat*>(index)) {
+            Back(flat->xb);
+        } else if (auto ivf = dynamic_cast<faiss::IndexBinaryIVF*>(index)) {
+            Back(ivf->invlists);
+        }
+    }
+
+    void
+    Log() const {
+        if (moved != 0 || advised != 0) {
+            LOG_KNOWHERE_INFO_ << "Backed the index with huge pages: moved " << moved << " bytes, advised " << advised
+                               << " bytes";
+        }
+    }
+};
+
+}  // namespace
+
+void
+BackIndexWithHugePages(faiss::Index* index, bool in_place) {
+    if (GetHugePagePolicy() == HugePagePolicy::NONE) {
+        return;
+    }
+    Backer backer{in_place};
+    backer.Back(index);
+    backer.Log();
+}
+
+void
+BackIndexWithHugePages(faiss::IndexBinary* index, bool in_place) {
+    if (GetHugePagePolicy() == HugePagePolicy::NONE) {
+        return;
+    }
+    Backer backer{in_place};
+    backer.Back(index);
+    backer.Log();
+}
+
+}  // namespace knowhere
@@ -0,0 +1,29 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <faiss/Index.h>
+#include <faiss/IndexBinary.h>
+
+namespace knowhere {
+
+// Backs the large buffers of a loaded faiss index, its codes, HNSW graph and IVF arena, with huge pages according to
+// the huge page policy (see knowhere/comp/huge_page.h): the buffers that the index owns are moved to huge page
+// buffers, once, after which the index must not grow. The buffers of an index mapped from a file or read zero-copy
+// stay in_place, they are only advised to the kernel. A no-op when the policy is NONE.
+void
+BackIndexWithHugePages(faiss::Index* index, bool in_place);
+
+void
+BackIndexWithHugePages(faiss::IndexBinary* index, bool in_place);
+
+}  // namespace knowhere
@@ -0,0 +1,137 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "index/hybrid_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+namespace {
+
+// the score of a distance of metric_type, normalized into [0, 1] and higher for the closer rows
+float
+NormalizeScore(const std::string& metric_type, float distance) {
+    if (IsMetricType(metric_type, metric::COSINE)) {
+        return (1.0f + distance) * 0.5f;
+    }
+    if (IsMetricType(metric_type, metric::IP)) {
+        return 0.5f + std::atan(distance) / static_cast<float>(M_PI);
+    }
+    if (IsMetricType(metric_type, metric::BM25)) {
+        return 2.0f * std::atan(distance) / static_cast<float>(M_PI);
+    }
+    // the other metrics are non-negative distances
+    return 1.0f - 2.0f * std::atan(distance) / static_cast<float>(M_PI);
+}
+
+// a row of the results of some of the searches, with its fused score over them
+struct HybridCandidate {
+    float score = 0.0f;
+    // the searches whose results the row was found in
+    uint32_t seen = 0;
+};
+
+}  // namespace
+
+void
+FuseHybridResults(const std::vector<HybridSearchResult>& results, const HybridSearchConfig& cfg, int64_t begin,
+                  int64_t end, float* scores, int64_t* ids) {
+    const int64_t topk = cfg.k.value();
+    const bool rrf = cfg.hybrid_fusion.value() == hybrid::RRF;
+    const float rrf_k = cfg.rrf_k.value();
+    int64_t max_depth = 0;
+    for (const auto& res : results) {
+        max_depth = std::max(max_depth, res.result->GetDim());
+    }
+
+    std::unordered_map<int64_t, HybridCandidate> candidates;
+    // the scores of the searches at the current rank, the highest ones that the rows they did not find yet may get
+    std::vector<float> bounds(results.size());
+    std::vector<float> candidate_scores;
+    for (int64_t i = begin; i < end; i++) {
+        candidates.clear();
+        for (int64_t depth = 0; depth < max_depth; depth++) {
+            for (size_t s = 0; s < results.size(); s++) {
+                const auto k = results[s].result->GetDim();
+                const auto id = depth < k ? results[s].result->GetIds()[i * k + depth] : -1;
+                if (id < 0) {
+                    bounds[s] = 0.0f;
+                    continue;
+                }
+                const auto distance = results[s].result->GetDistance()[i * k + depth];
+                bounds[s] = results[s].weight *
+                            (rrf ? 1.0f / (rrf_k + depth + 1) : NormalizeScore(results[s].metric_type, distance));
+                auto& candidate = candidates[id];
+                candidate.score += bounds[s];
+                candidate.seen |= 1u << s;
+            }
+            if (static_cast<int64_t>(candidates.size()) < topk) {
+                continue;
+            }
+
+            // no row to find yet may reach the k-th score any more: the walk goes on only for the candidates that may
+            candidate_scores.clear();
+            for (const auto& [id, candidate] : candidates) {
+                candidate_scores.push_back(candidate.score);
+            }
+            std::nth_element(candidate_scores.begin(), candidate_scores.begin() + topk - 1, candidate_scores.end(),
+                             std::greater<float>());
+            const float kth_score = candidate_scores[topk - 1];
+            float unseen_bound = 0.0f;
+            for (auto bound : bounds) {
+                unseen_bound += bound;
+            }
+            if (unseen_bound > kth_score) {
+                continue;
+            }
+            bool complete = true;
+            for (auto it = candidates.begin(); it != candidates.end();) {
+                float pending = 0.0f;
+                for (size_t s = 0; s < results.size(); s++) {
+                    if (!(it->second.seen & (1u << s))) {
+                        pending += bounds[s];
+                    }
+                }
+                if (it->second.score + pending < kth_score) {
+                    it = candidates.erase(it);
+                    continue;
+                }
+                complete = complete && pending == 0.0f;
+                ++it;
+            }
+            if (complete) {
+                break;
+            }
+        }
+
+        std::vector<std::pair<float, int64_t>> fused;
+        fused.reserve(candidates.size());
+        for (const auto& [id, candidate] : candidates) {
+            fused.emplace_back(candidate.score, id);
+        }
+        const auto num = std::min<int64_t>(topk, fused.size());
+        std::partial_sort(fused.begin(), fused.begin() + num, fused.end(), [](const auto& a, const auto& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+        for (int64_t j = 0; j < topk; j++) {
+            scores[i * topk + j] = j < num ? fused[j].first : std::numeric_limits<float>::lowest();
+            ids[i * topk + j] = j < num ? fused[j].second : -1;
+        }
+    }
+}
+
+}  // namespace knowhere
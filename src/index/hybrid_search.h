@@ -0,0 +1,104 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "knowhere/comp/index_param.h"
+#include "knowhere/config.h"
+#include "knowhere/dataset.h"
+
+namespace knowhere {
+
+namespace hybrid {
+// the fused score of a row is the sum over the searches of weight / (rrf_k + its rank in the search)
+constexpr const char* RRF = "RRF";
+// the fused score of a row is the weighted sum of its scores, normalized into [0, 1] by the metric of their search
+constexpr const char* WEIGHTED = "WEIGHTED";
+}  // namespace hybrid
+
+// The params of the fusion of a hybrid search (@see Index::HybridSearch), k being the number of fused results.
+class HybridSearchConfig : public BaseConfig {
+ public:
+    CFG_STRING hybrid_fusion;
+    // the results fetched from each search, the candidates of the fusion
+    CFG_INT hybrid_candidates;
+    CFG_INT rrf_k;
+    CFG_FLOAT dense_weight;
+    CFG_FLOAT sparse_weight;
+
+    KNOHWERE_DECLARE_CONFIG(HybridSearchConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(hybrid_fusion)
+            .set_default(hybrid::RRF)
+            .description("the fusion of the results of the hybrid search, one of {RRF, WEIGHTED}")
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(hybrid_candidates)
+            .description("the results fetched from each search of the hybrid search, k by default")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(rrf_k)
+            .set_default(60)
+            .description("the rank constant of the RRF fusion")
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(dense_weight)
+            .set_default(1.0f)
+            .description("the weight of the dense search in the fusion")
+            .set_range(0.0f, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(sparse_weight)
+            .set_default(1.0f)
+            .description("the weight of the sparse search in the fusion")
+            .set_range(0.0f, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_search();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type == PARAM_TYPE::SEARCH) {
+            if (hybrid_fusion.value() != hybrid::RRF && hybrid_fusion.value() != hybrid::WEIGHTED) {
+                std::string msg =
+                    "invalid hybrid fusion: " + hybrid_fusion.value() + ", should be one of {RRF, WEIGHTED}";
+                return HandleError(err_msg, msg, Status::invalid_args);
+            }
+            if (!hybrid_candidates.has_value()) {
+                hybrid_candidates = k.value();
+            } else if (hybrid_candidates.value() < k.value()) {
+                std::string msg = "hybrid_candidates(" + std::to_string(hybrid_candidates.value()) +
+                                  ") should be larger than k(" + std::to_string(k.value()) + ")";
+                return HandleError(err_msg, msg, Status::out_of_range_in_json);
+            }
+        }
+        return Status::success;
+    }
+};
+
+// the results of a search of a hybrid search, with the metric and weight of their scores in the fusion
+struct HybridSearchResult {
+    DataSetPtr result;
+    std::string metric_type;
+    float weight = 1.0f;
+};
+
+// Fuses the results of the queries [begin, end) of the searches into the top-k of the fused scores, sorted from the
+// highest one. The results of every search are walked rank by rank at once: once the k-th fused score reaches the
+// highest score that a row not seen yet may still get, the candidates that can no longer reach it are dropped, and
+// the walk stops when the fused scores of the remaining ones are complete. The rows missing from the results of a
+// search get no score from it.
+void
+FuseHybridResults(const std::vector<HybridSearchResult>& results, const HybridSearchConfig& cfg, int64_t begin,
+                  int64_t end, float* scores, int64_t* ids);
+
+}  // namespace knowhere
@@ -11,8 +11,14 @@
 
 #include "knowhere/index/index.h"
 
+#include "faiss/utils/Heap.h"
 #include "fmt/format.h"
+#include "folly/executors/InlineExecutor.h"
 #include "folly/futures/Future.h"
+#include "index/hybrid_search.h"
+#include "knowhere/comp/build_scheduler.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/task.h"
 #include "knowhere/comp/time_recorder.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
@@ -36,6 +42,111 @@ LoadConfig(BaseConfig* cfg, const Json& json, knowhere::PARAM_TYPE param_type, c
     return Config::Load(*cfg, json_, param_type, msg);
 }
 
+namespace {
+
+// The targets of a fan-out search wait for their own searches, which run on the global search pool, so they are
+// scheduled on a pool of their own rather than blocking the threads of the search pool.
+std::shared_ptr<ThreadPool>
+FanOutThreadPool() {
+    static std::shared_ptr<ThreadPool> pool =
+        std::make_shared<ThreadPool>(ThreadPool::GetGlobalSearchThreadPool()->size(), "Knowhere_FanOut");
+    return pool;
+}
+
+// a search that skipped work because of its deadline returns its partial results along with a timeout
+void
+CheckInterrupted(expected<DataSetPtr>& res, const SearchDeadline& deadline) {
+    if (res.has_value() && deadline.WasInterrupted()) {
+        LOG_KNOWHERE_WARNING_ << "search interrupted by its deadline or cancellation";
+        res = Status::timeout;
+        res << "the search was interrupted, the results are partial";
+    }
+}
+
+// the search config of a json as a key of the result cache: the parameters that do not change the results are dropped
+std::string
+ResultCacheConfigKey(const Json& json) {
+    Json key = json;
+    for (const auto* name : {meta::TRACE_ID, meta::SPAN_ID, meta::TRACE_FLAGS, meta::SEARCH_PRIORITY,
+                             meta::SEARCH_TIMEOUT_MS}) {
+        key.erase(name);
+    }
+    return key.dump();
+}
+
+bool
+IsLargerCloser(const std::string& metric_type) {
+    return IsMetricType(metric_type, metric::IP) || IsMetricType(metric_type, metric::COSINE) ||
+           IsMetricType(metric_type, metric::BM25) || IsMetricType(metric_type, metric::MHJACCARD) ||
+           IsMetricType(metric_type, metric::MAX_SIM) || IsMetricType(metric_type, metric::ORDERED_MAX_SIM) ||
+           IsMetricType(metric_type, metric::ORDERED_MAX_SIM_WITH_WINDOW);
+}
+
+// merges the top-k of the queries [begin, end) of all the targets into the sorted top-k of the queries
+template <class C>
+void
+MergeFanOutResults(const std::vector<DataSetPtr>& results, const std::vector<int64_t>& id_offsets, const int64_t begin,
+                   const int64_t end, const int64_t topk, float* distances, int64_t* ids) {
+    for (int64_t i = begin; i < end; i++) {
+        auto heap_dis = distances + i * topk;
+        auto heap_ids = ids + i * topk;
+        faiss::heap_heapify<C>(topk, heap_dis, heap_ids);
+        for (size_t t = 0; t < results.size(); t++) {
+            const auto k = results[t]->GetDim();
+            const auto res_ids = results[t]->GetIds() + i * k;
+            const auto res_dis = results[t]->GetDistance() + i * k;
+            for (int64_t j = 0; j < k; j++) {
+                if (res_ids[j] < 0) {
+                    continue;
+                }
+                if (C::cmp(heap_dis[0], res_dis[j])) {
+                    faiss::heap_replace_top<C>(topk, heap_dis, heap_ids, res_dis[j], res_ids[j] + id_offsets[t]);
+                }
+            }
+        }
+        faiss::heap_reorder<C>(topk, heap_dis, heap_ids);
+    }
+}
+
+// Admits a build under the build memory budget. Unless it sets num_build_thread, a build admitted along with others
+// runs with its share of the build pool threads.
+template <typename T>
+folly::SemiFuture<std::shared_ptr<BuildReservation>>
+AdmitBuildAsync(const T& node, const DataSetPtr& dataset, const BaseConfig& cfg) {
+    return BuildScheduler::GetInstance().AdmitAsync(node.EstimateBuildMemory(dataset, cfg));
+}
+
+void
+ApplyBuildThreadShare(BaseConfig& cfg, const BuildReservation& reservation) {
+    if (!cfg.num_build_thread.has_value() &&
+        static_cast<size_t>(reservation.NumThreads()) < ThreadPool::GetGlobalBuildThreadPoolSize()) {
+        cfg.num_build_thread = reservation.NumThreads();
+    }
+}
+
+// loads the config of a search, timed as its config parse stage
+Status
+LoadSearchConfig(BaseConfig* cfg, const Json& json, knowhere::PARAM_TYPE param_type, const std::string& method,
+                 std::string* const msg) {
+    ScopedSearchStage stage(SearchStage::CONFIG_PARSE);
+    return LoadConfig(cfg, json, param_type, method, msg);
+}
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+// the stage times of a traced search, as attributes of its span
+void
+SetSearchStageAttributes(tracer::trace::Span& span, const SearchStageTimes& times) {
+    for (size_t i = 0; i < kNumSearchStages; i++) {
+        const auto stage = static_cast<SearchStage>(i);
+        if (const auto ms = times.Ms(stage); ms > 0) {
+            span.SetAttribute(std::string("stage.") + SearchStageName(stage) + "_ms", ms);
+        }
+    }
+}
+#endif
+
+}  // namespace
+
 #ifdef KNOWHERE_WITH_CARDINAL
 template <typename T>
 inline const std::shared_ptr<Interrupt>
@@ -65,7 +176,22 @@ inline const std::shared_ptr<Interrupt>
 Index<T>::BuildAsync(const DataSetPtr dataset, const Json& json, bool use_knowhere_build_pool) {
     auto pool = ThreadPool::GetGlobalBuildThreadPool();
     auto interrupt = std::make_shared<Interrupt>();
-    interrupt->Set(pool->push([this, dataset, json]() { return this->Build(dataset, json); }));
+    std::shared_ptr<BaseConfig> cfg = this->node->CreateConfig();
+    auto status = LoadConfig(cfg.get(), json, knowhere::TRAIN, "Build");
+    if (status != Status::success) {
+        interrupt->Set(folly::makeFuture(status));
+        return interrupt;
+    }
+    // the build waits for its admission without holding a thread of the build pool, and is pushed to the pool once
+    // admitted, holding its reservation until it is done
+    interrupt->Set(AdmitBuildAsync(*this->node, dataset, *cfg)
+                       .via(&folly::InlineExecutor::instance())
+                       .thenValue([this, pool, dataset, cfg](std::shared_ptr<BuildReservation> reservation) {
+                           ApplyBuildThreadShare(*cfg, *reservation);
+                           return pool->push([this, dataset, cfg, reservation]() {
+                               return this->BuildAdmitted(dataset, cfg, true);
+                           });
+                       }));
     return interrupt;
 }
 #endif
@@ -76,6 +202,14 @@ Index<T>::Build(const DataSetPtr dataset, const Json& json, bool use_knowhere_bu
     auto cfg = this->node->CreateConfig();
     RETURN_IF_ERROR(LoadConfig(cfg.get(), json, knowhere::TRAIN, "Build"));
 
+    auto reservation = AdmitBuildAsync(*this->node, dataset, *cfg).get();
+    ApplyBuildThreadShare(*cfg, *reservation);
+    return BuildAdmitted(dataset, std::move(cfg), use_knowhere_build_pool);
+}
+
+template <typename T>
+inline Status
+Index<T>::BuildAdmitted(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) {
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     TimeRecorder rc("Build index", 2);
     auto res = this->node->Build(dataset, std::move(cfg), use_knowhere_build_pool);
@@ -85,6 +219,7 @@ Index<T>::Build(const DataSetPtr dataset, const Json& json, bool use_knowhere_bu
 #else
     auto res = this->node->Build(dataset, std::move(cfg), use_knowhere_build_pool);
 #endif
+    ClearResultCache();
     return res;
 }
 
@@ -94,7 +229,9 @@ Index<T>::Train(const DataSetPtr dataset, const Json& json, bool use_knowhere_bu
     auto cfg = this->node->CreateConfig();
     std::string msg;
     RETURN_IF_ERROR(LoadConfig(cfg.get(), json, knowhere::TRAIN, "Train", &msg));
-    return this->node->Train(dataset, std::move(cfg), use_knowhere_build_pool);
+    auto res = this->node->Train(dataset, std::move(cfg), use_knowhere_build_pool);
+    ClearResultCache();
+    return res;
 }
 
 template <typename T>
@@ -103,18 +240,171 @@ Index<T>::Add(const DataSetPtr dataset, const Json& json, bool use_knowhere_buil
     auto cfg = this->node->CreateConfig();
     std::string msg;
     RETURN_IF_ERROR(LoadConfig(cfg.get(), json, knowhere::TRAIN, "Add", &msg));
-    return this->node->Add(dataset, std::move(cfg), use_knowhere_build_pool);
+    auto res = this->node->Add(dataset, std::move(cfg), use_knowhere_build_pool);
+    ClearResultCache();
+    return res;
+}
+
+template <typename T>
+inline Status
+Index<T>::Delete(const DataSetPtr dataset, const Json& json, bool use_knowhere_build_pool) {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    RETURN_IF_ERROR(LoadConfig(cfg.get(), json, knowhere::TRAIN, "Delete", &msg));
+    auto res = this->node->Delete(dataset, std::move(cfg), use_knowhere_build_pool);
+    ClearResultCache();
+    return res;
+}
+
+template <typename T>
+inline Status
+Index<T>::Merge(const Index<T>& other, const BitsetView& bitset, const Json& json, bool use_knowhere_build_pool) {
+    if (other.node == nullptr) {
+        LOG_KNOWHERE_ERROR_ << "Can not merge an empty index.";
+        return Status::empty_index;
+    }
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    RETURN_IF_ERROR(LoadConfig(cfg.get(), json, knowhere::TRAIN, "Merge", &msg));
+    auto res = this->node->Merge(*other.node, bitset, std::move(cfg), use_knowhere_build_pool);
+    ClearResultCache();
+    return res;
 }
 
 template <typename T>
 inline expected<DataSetPtr>
-Index<T>::Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_) const {
+Index<T>::Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const {
     auto cfg = this->node->CreateConfig();
     std::string msg;
-    const Status load_status = LoadConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
+    const Status load_status = LoadSearchConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
     if (load_status != Status::success) {
         return expected<DataSetPtr>::Err(load_status, msg);
     }
+    if (auto cache = this->node->ResultCache(); cache != nullptr) {
+        return SearchCached(*cache, dataset, json, std::move(cfg), bitset);
+    }
+    return SearchLoaded(dataset, std::move(cfg), bitset);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::SearchCached(SearchResultCache& cache, const DataSetPtr dataset, const Json& json,
+                       std::unique_ptr<BaseConfig> cfg, const BitsetView& bitset) const {
+    // the stats are of the searches that ran, and the queries of several vectors have no row of their own
+    if (cfg->search_stats.value() || dataset->GetIsSparse() || dataset->GetLims() != nullptr ||
+        dataset->GetTensor() == nullptr) {
+        return SearchLoaded(dataset, std::move(cfg), bitset);
+    }
+
+    const auto rows = dataset->GetRows();
+    const auto dim = dataset->GetDim();
+    const auto k = cfg->k.value();
+    const auto* tensor = static_cast<const uint8_t*>(dataset->GetTensor());
+    const auto salt = SearchResultCache::SearchSalt(ResultCacheConfigKey(json), bitset);
+    auto ids = AllocateResultBuffer<int64_t>(rows * k);
+    auto distances = AllocateResultBuffer<float>(rows * k);
+    std::vector<uint64_t> keys(rows);
+    std::vector<std::string> queries(rows);
+    std::vector<int64_t> missed;
+    for (int64_t i = 0; i < rows; i++) {
+        keys[i] = cache.QueryKey(tensor, i, dim, salt);
+        queries[i] = cache.QueryBytes(tensor, i, dim);
+        if (!cache.Lookup(keys[i], queries[i], k, ids.get() + i * k, distances.get() + i * k)) {
+            missed.push_back(i);
+        }
+    }
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+    knowhere_search_result_cache_hits.Increment(rows - missed.size());
+    knowhere_search_result_cache_misses.Increment(missed.size());
+#endif
+
+    if (!missed.empty()) {
+        // the missed queries are searched at once
+        auto missed_dataset = dataset;
+        std::unique_ptr<uint8_t[]> missed_tensor;
+        if (static_cast<int64_t>(missed.size()) < rows) {
+            const auto row_bytes = cache.RowBytes(dim);
+            missed_tensor = std::make_unique<uint8_t[]>(missed.size() * row_bytes);
+            for (size_t i = 0; i < missed.size(); i++) {
+                std::copy_n(tensor + missed[i] * row_bytes, row_bytes, missed_tensor.get() + i * row_bytes);
+            }
+            missed_dataset = GenDataSet(missed.size(), dim, missed_tensor.get());
+        }
+        auto res = SearchLoaded(missed_dataset, std::move(cfg), bitset);
+        if (!res.has_value()) {
+            return res;
+        }
+        const auto* missed_ids = res.value()->GetIds();
+        const auto* missed_distances = res.value()->GetDistance();
+        for (size_t i = 0; i < missed.size(); i++) {
+            std::copy_n(missed_ids + i * k, k, ids.get() + missed[i] * k);
+            std::copy_n(missed_distances + i * k, k, distances.get() + missed[i] * k);
+            cache.Insert(keys[missed[i]], queries[missed[i]], k, missed_ids + i * k, missed_distances + i * k);
+        }
+    }
+    return GenResultDataSet(rows, k, std::move(ids), std::move(distances));
+}
+
+template <typename T>
+inline void
+Index<T>::ClearResultCache() const {
+    if (auto cache = this->node->ResultCache(); cache != nullptr) {
+        cache->Clear();
+    }
+}
+
+template <typename T>
+inline expected<PreparedSearchConfigPtr>
+Index<T>::PrepareSearchConfig(const Json& json) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    const Status load_status = LoadSearchConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
+    if (load_status != Status::success) {
+        return expected<PreparedSearchConfigPtr>::Err(load_status, msg);
+    }
+    return std::make_shared<const PreparedSearchConfig>(this->node->Type(), std::move(cfg));
+}
+
+template <typename T>
+inline expected<std::unique_ptr<BaseConfig>>
+Index<T>::CopyPreparedSearchConfig(const PreparedSearchConfig& prepared, int32_t k) const {
+    // timed as the config parse stage it replaces
+    ScopedSearchStage stage(SearchStage::CONFIG_PARSE);
+    if (prepared.IndexType() != this->node->Type()) {
+        auto msg = fmt::format("search config prepared for index type {}, not {}", prepared.IndexType(),
+                               this->node->Type());
+        LOG_KNOWHERE_ERROR_ << msg;
+        return expected<std::unique_ptr<BaseConfig>>::Err(Status::invalid_args, msg);
+    }
+    const auto prepared_k = prepared.Get().k.value();
+    if (k < 0 || k > prepared_k) {
+        auto msg = fmt::format("k should be in [0, {}] for the search config prepared with k {}, but we get {}",
+                               prepared_k, prepared_k, k);
+        LOG_KNOWHERE_ERROR_ << msg;
+        return expected<std::unique_ptr<BaseConfig>>::Err(Status::invalid_args, msg);
+    }
+    std::unique_ptr<BaseConfig> cfg(static_cast<BaseConfig*>(prepared.Get().Clone().release()));
+    if (k > 0) {
+        cfg->k = k;
+    }
+    return cfg;
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::Search(const DataSetPtr dataset, const PreparedSearchConfig& prepared, const BitsetView& bitset,
+                 int32_t k) const {
+    auto cfg = CopyPreparedSearchConfig(prepared, k);
+    if (!cfg.has_value()) {
+        return expected<DataSetPtr>::Err(cfg.error(), cfg.what());
+    }
+    return SearchLoaded(dataset, std::move(cfg.value()), bitset);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::SearchLoaded(const DataSetPtr dataset, std::unique_ptr<BaseConfig> cfg, const BitsetView& bitset_) const {
+    std::string msg;
     // when index is immutable, bitset size should always equal to data count in index
     // when index is mutable, it could happen that data count larger than bitset size, see
     // https://github.com/zilliztech/knowhere/issues/70
@@ -126,12 +416,23 @@ Index<T>::Search(const DataSetPtr dataset, const Json& json, const BitsetView& b
         return expected<DataSetPtr>::Err(Status::invalid_args, msg);
     }
 
-    const auto bitset = BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    // the bitsets given by their valid ids know their count already
+    const auto bitset = bitset_.has_valid_ids()
+                            ? bitset_
+                            : BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    ScopedSearchPriority priority_setter(ToSearchPriority(cfg->search_priority.value()));
+    ScopedNumaNode numa_setter(this->node->NumaNode());
+    const auto deadline = MakeSearchDeadline(cfg->search_timeout_ms.value());
+    ScopedSearchDeadline deadline_setter(deadline);
+    if (const auto admission = AdmitSearch(); admission != Status::success) {
+        return expected<DataSetPtr>::Err(admission, "search shed, the search queue of its priority is full");
+    }
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     const BaseConfig& b_cfg = static_cast<const BaseConfig&>(*cfg);
     // LCOV_EXCL_START
     std::shared_ptr<tracer::trace::Span> span = nullptr;
+    std::shared_ptr<SearchStageTimes> stage_times = nullptr;
     if (b_cfg.trace_id.has_value()) {
         auto trace_id_str = tracer::GetIDFromHexStr(b_cfg.trace_id.value());
         auto span_id_str = tracer::GetIDFromHexStr(b_cfg.span_id.value());
@@ -143,29 +444,283 @@ Index<T>::Search(const DataSetPtr dataset, const Json& json, const BitsetView& b
         span->SetAttribute(meta::ROWS, Count());
         span->SetAttribute(meta::DIM, Dim());
         span->SetAttribute(meta::NQ, dataset->GetRows());
+        stage_times = std::make_shared<SearchStageTimes>();
     }
+    ScopedSearchStageTimes stage_times_setter(stage_times);
     // LCOV_EXCL_STOP
 
     TimeRecorder rc("Search");
     bool has_trace_id = b_cfg.trace_id.has_value();
     auto k = cfg->k.value();
-    auto res = this->node->Search(dataset, std::move(cfg), bitset);
+    auto faults = std::make_shared<SearchFaults>(0);
+    auto res = [&] {
+        ScopedSearchFaults faults_setter(faults);
+        return this->node->Search(dataset, std::move(cfg), bitset);
+    }();
     auto time = rc.ElapseFromBegin("done");
     time *= 0.001;  // convert to ms
     knowhere_search_latency.Observe(time);
     knowhere_search_topk.Observe(k);
+    knowhere_search_major_faults.Observe(faults->load());
 
     // LCOV_EXCL_START
     if (has_trace_id) {
+        SetSearchStageAttributes(*span, *stage_times);
+        span->SetAttribute("major_faults", static_cast<int64_t>(faults->load()));
         span->End();
     }
     // LCOV_EXCL_STOP
 #else
     auto res = this->node->Search(dataset, std::move(cfg), bitset);
 #endif
+    CheckInterrupted(res, deadline);
     return res;
 }
 
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::SearchWithBuf(const DataSetPtr dataset, const Json& json, const BitsetView& bitset, int64_t* ids,
+                        float* distances) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    const Status load_status = LoadSearchConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
+    if (load_status != Status::success) {
+        return expected<DataSetPtr>::Err(load_status, msg);
+    }
+    return SearchWithBufLoaded(dataset, std::move(cfg), bitset, ids, distances);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::SearchWithBuf(const DataSetPtr dataset, const PreparedSearchConfig& prepared, const BitsetView& bitset,
+                        int64_t* ids, float* distances, int32_t k) const {
+    auto cfg = CopyPreparedSearchConfig(prepared, k);
+    if (!cfg.has_value()) {
+        return expected<DataSetPtr>::Err(cfg.error(), cfg.what());
+    }
+    return SearchWithBufLoaded(dataset, std::move(cfg.value()), bitset, ids, distances);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::SearchWithBufLoaded(const DataSetPtr dataset, std::unique_ptr<BaseConfig> cfg, const BitsetView& bitset_,
+                              int64_t* ids, float* distances) const {
+    std::string msg;
+    if (bitset_.size() > (size_t)this->Count()) {
+        msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
+                          bitset_.size(), this->Count());
+        LOG_KNOWHERE_ERROR_ << msg;
+        return expected<DataSetPtr>::Err(Status::invalid_args, msg);
+    }
+
+    // the bitsets given by their valid ids know their count already
+    const auto bitset = bitset_.has_valid_ids()
+                            ? bitset_
+                            : BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    ScopedSearchPriority priority_setter(ToSearchPriority(cfg->search_priority.value()));
+    ScopedNumaNode numa_setter(this->node->NumaNode());
+    const auto deadline = MakeSearchDeadline(cfg->search_timeout_ms.value());
+    ScopedSearchDeadline deadline_setter(deadline);
+    if (const auto admission = AdmitSearch(); admission != Status::success) {
+        return expected<DataSetPtr>::Err(admission, "search shed, the search queue of its priority is full");
+    }
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+    TimeRecorder rc("SearchWithBuf");
+    auto k = cfg->k.value();
+    auto faults = std::make_shared<SearchFaults>(0);
+    auto res = [&] {
+        ScopedSearchFaults faults_setter(faults);
+        return this->node->SearchWithBuf(dataset, std::move(cfg), bitset, ids, distances);
+    }();
+    auto time = rc.ElapseFromBegin("done");
+    time *= 0.001;  // convert to ms
+    knowhere_search_latency.Observe(time);
+    knowhere_search_topk.Observe(k);
+    knowhere_search_major_faults.Observe(faults->load());
+#else
+    auto res = this->node->SearchWithBuf(dataset, std::move(cfg), bitset, ids, distances);
+#endif
+    CheckInterrupted(res, deadline);
+    return res;
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::SearchFanOut(const std::vector<SearchTarget>& targets, const DataSetPtr dataset, const Json& json) {
+    if (targets.empty()) {
+        return expected<DataSetPtr>::Err(Status::invalid_args, "no index to search");
+    }
+    BaseConfig cfg;
+    std::string msg;
+    const Status load_status = LoadConfig(&cfg, json, knowhere::SEARCH, "SearchFanOut", &msg);
+    if (load_status != Status::success) {
+        return expected<DataSetPtr>::Err(load_status, msg);
+    }
+    const auto nq = dataset->GetRows();
+    const auto topk = cfg.k.value();
+
+    // every target is searched with the search pool, the fan-out pool only waits for them, so all the queries of
+    // all the targets are in flight together
+    auto pool = FanOutThreadPool();
+    std::vector<folly::Future<expected<DataSetPtr>>> futs;
+    futs.reserve(targets.size());
+    for (const auto& target : targets) {
+        futs.emplace_back(pool->push([&]() { return target.index.Search(dataset, json, target.bitset); }));
+    }
+    std::vector<DataSetPtr> results;
+    std::vector<int64_t> id_offsets;
+    results.reserve(targets.size());
+    id_offsets.reserve(targets.size());
+    Status status = Status::success;
+    for (size_t t = 0; t < futs.size(); t++) {
+        auto res = std::move(futs[t]).get();
+        if (!res.has_value()) {
+            if (status == Status::success) {
+                status = res.error();
+                msg = res.what();
+            }
+            continue;
+        }
+        results.push_back(res.value());
+        id_offsets.push_back(targets[t].id_offset);
+    }
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, msg);
+    }
+
+    auto ids = AllocateResultBuffer<int64_t>(nq * topk);
+    auto distances = AllocateResultBuffer<float>(nq * topk);
+    const bool larger_is_closer = IsLargerCloser(cfg.metric_type.value());
+    constexpr int64_t kQueriesPerTask = 16;
+    std::vector<folly::Future<folly::Unit>> merge_futs;
+    merge_futs.reserve((nq + kQueriesPerTask - 1) / kQueriesPerTask);
+    for (int64_t begin = 0; begin < nq; begin += kQueriesPerTask) {
+        const int64_t end = std::min(nq, begin + kQueriesPerTask);
+        merge_futs.emplace_back(ThreadPool::GetGlobalSearchThreadPool()->push([&, begin, end]() {
+            if (larger_is_closer) {
+                MergeFanOutResults<faiss::CMin<float, int64_t>>(results, id_offsets, begin, end, topk,
+                                                                distances.get(), ids.get());
+            } else {
+                MergeFanOutResults<faiss::CMax<float, int64_t>>(results, id_offsets, begin, end, topk,
+                                                                distances.get(), ids.get());
+            }
+        }));
+    }
+    WaitAllSuccess(merge_futs);
+    return GenResultDataSet(nq, topk, std::move(ids), std::move(distances));
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::HybridSearch(const HybridTarget& dense, const HybridTarget& sparse, const Json& json,
+                       const BitsetView& bitset) {
+    HybridSearchConfig cfg;
+    std::string msg;
+    const Status load_status = LoadConfig(&cfg, json, knowhere::SEARCH, "HybridSearch", &msg);
+    if (load_status != Status::success) {
+        return expected<DataSetPtr>::Err(load_status, msg);
+    }
+    if (dense.dataset->GetRows() != sparse.dataset->GetRows()) {
+        msg = fmt::format("the dense and sparse queries should be as many, but we get {} and {}",
+                          dense.dataset->GetRows(), sparse.dataset->GetRows());
+        LOG_KNOWHERE_ERROR_ << msg;
+        return expected<DataSetPtr>::Err(Status::invalid_args, msg);
+    }
+    if (dense.index.Count() != sparse.index.Count()) {
+        msg = fmt::format("the dense and sparse indexes should be over the same rows, but they have {} and {} rows",
+                          dense.index.Count(), sparse.index.Count());
+        LOG_KNOWHERE_ERROR_ << msg;
+        return expected<DataSetPtr>::Err(Status::invalid_args, msg);
+    }
+    const auto nq = dense.dataset->GetRows();
+    const auto topk = cfg.k.value();
+
+    // both searches run on the search pool at once, the fan-out pool only waits for them
+    const HybridTarget* targets[] = {&dense, &sparse};
+    const float weights[] = {cfg.dense_weight.value(), cfg.sparse_weight.value()};
+    auto pool = FanOutThreadPool();
+    std::vector<folly::Future<expected<DataSetPtr>>> futs;
+    std::vector<HybridSearchResult> results(2);
+    for (size_t t = 0; t < 2; t++) {
+        auto target_json = targets[t]->json;
+        target_json[meta::TOPK] = cfg.hybrid_candidates.value();
+        results[t].metric_type = target_json.value(meta::METRIC_TYPE, std::string(metric::L2));
+        results[t].weight = weights[t];
+        futs.emplace_back(pool->push([target = targets[t], target_json = std::move(target_json), &bitset]() {
+            return target->index.Search(target->dataset, target_json, bitset);
+        }));
+    }
+    Status status = Status::success;
+    for (size_t t = 0; t < futs.size(); t++) {
+        auto res = std::move(futs[t]).get();
+        if (!res.has_value()) {
+            if (status == Status::success) {
+                status = res.error();
+                msg = res.what();
+            }
+            continue;
+        }
+        results[t].result = res.value();
+    }
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, msg);
+    }
+
+    auto ids = AllocateResultBuffer<int64_t>(nq * topk);
+    auto scores = AllocateResultBuffer<float>(nq * topk);
+    constexpr int64_t kQueriesPerTask = 16;
+    std::vector<folly::Future<folly::Unit>> fuse_futs;
+    fuse_futs.reserve((nq + kQueriesPerTask - 1) / kQueriesPerTask);
+    for (int64_t begin = 0; begin < nq; begin += kQueriesPerTask) {
+        const int64_t end = std::min(nq, begin + kQueriesPerTask);
+        fuse_futs.emplace_back(ThreadPool::GetGlobalSearchThreadPool()->push(
+            [&, begin, end]() { FuseHybridResults(results, cfg, begin, end, scores.get(), ids.get()); }));
+    }
+    WaitAllSuccess(fuse_futs);
+    return GenResultDataSet(nq, topk, std::move(ids), std::move(scores));
+}
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+template <typename T>
+inline folly::SemiFuture<expected<DataSetPtr>>
+Index<T>::SearchAsync(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    const Status load_status = LoadSearchConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
+    if (load_status != Status::success) {
+        return folly::makeSemiFuture(expected<DataSetPtr>::Err(load_status, msg));
+    }
+    if (bitset_.size() > (size_t)this->Count()) {
+        msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
+                          bitset_.size(), this->Count());
+        LOG_KNOWHERE_ERROR_ << msg;
+        return folly::makeSemiFuture(expected<DataSetPtr>::Err(Status::invalid_args, msg));
+    }
+
+    // the bitsets given by their valid ids know their count already
+    const auto bitset = bitset_.has_valid_ids()
+                            ? bitset_
+                            : BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    ScopedSearchPriority priority_setter(ToSearchPriority(cfg->search_priority.value()));
+    if (const auto admission = AdmitSearch(); admission != Status::success) {
+        return folly::makeSemiFuture(
+            expected<DataSetPtr>::Err(admission, "search shed, the search queue of its priority is full"));
+    }
+
+    auto k = cfg->k.value();
+    auto rc = std::make_shared<TimeRecorder>("SearchAsync");
+    return this->node->SearchAsync(dataset, std::move(cfg), bitset)
+        .deferValue([rc, k](expected<DataSetPtr>&& res) {
+            auto time = rc->ElapseFromBegin("done");
+            time *= 0.001;  // convert to ms
+            knowhere_search_latency.Observe(time);
+            knowhere_search_topk.Observe(k);
+            return std::move(res);
+        });
+}
+#endif
+
 template <typename T>
 inline expected<std::vector<std::shared_ptr<IndexNode::iterator>>>
 Index<T>::AnnIterator(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_,
@@ -187,17 +742,54 @@ Index<T>::AnnIterator(const DataSetPtr dataset, const Json& json, const BitsetVi
         return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(Status::invalid_args, msg);
     }
 
-    const auto bitset = BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    // the bitsets given by their valid ids know their count already
+    const auto bitset = bitset_.has_valid_ids()
+                            ? bitset_
+                            : BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+
+    const bool batch_init = cfg->iterator_batch_init.value();
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     // note that this time includes only the initial search phase of iterator.
     TimeRecorder rc("AnnIterator");
     auto res = this->node->AnnIterator(dataset, std::move(cfg), bitset, use_knowhere_search_pool);
+    if (res.has_value() && batch_init) {
+        // the initial searches of all the queries in one pass over the pool, rather than one by one on the first
+        // calls of Next()
+        auto& its = res.value();
+        try {
+            if (use_knowhere_search_pool) {
+                ParallelForOverSearchThreadPool(its.size(), kParallelForMinChunkCost, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                        its[i]->Initialize();
+                    }
+                });
+            } else {
+                for (auto& it : its) {
+                    it->Initialize();
+                }
+            }
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << "failed to initialize the iterators: " << e.what();
+            return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(Status::internal_error, e.what());
+        }
+        knowhere_ann_iterator_init_latency.Observe(rc.ElapseFromBegin("initialized") * 0.001);
+    }
     auto time = rc.ElapseFromBegin("done");
     time *= 0.001;  // convert to ms
     knowhere_search_latency.Observe(time);
 #else
     auto res = this->node->AnnIterator(dataset, std::move(cfg), bitset, use_knowhere_search_pool);
+    if (res.has_value() && batch_init) {
+        try {
+            for (auto& it : res.value()) {
+                it->Initialize();
+            }
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << "failed to initialize the iterators: " << e.what();
+            return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(Status::internal_error, e.what());
+        }
+    }
 #endif
     return res;
 }
@@ -207,7 +799,7 @@ inline expected<DataSetPtr>
 Index<T>::RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_) const {
     auto cfg = this->node->CreateConfig();
     std::string msg;
-    auto status = LoadConfig(cfg.get(), json, knowhere::RANGE_SEARCH, "RangeSearch", &msg);
+    auto status = LoadSearchConfig(cfg.get(), json, knowhere::RANGE_SEARCH, "RangeSearch", &msg);
     if (status != Status::success) {
         return expected<DataSetPtr>::Err(status, std::move(msg));
     }
@@ -222,12 +814,23 @@ Index<T>::RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetVi
         return expected<DataSetPtr>::Err(Status::invalid_args, msg);
     }
 
-    const auto bitset = BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    // the bitsets given by their valid ids know their count already
+    const auto bitset = bitset_.has_valid_ids()
+                            ? bitset_
+                            : BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    ScopedSearchPriority priority_setter(ToSearchPriority(cfg->search_priority.value()));
+    ScopedNumaNode numa_setter(this->node->NumaNode());
+    const auto deadline = MakeSearchDeadline(cfg->search_timeout_ms.value());
+    ScopedSearchDeadline deadline_setter(deadline);
+    if (const auto admission = AdmitSearch(); admission != Status::success) {
+        return expected<DataSetPtr>::Err(admission, "search shed, the search queue of its priority is full");
+    }
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     const BaseConfig& b_cfg = static_cast<const BaseConfig&>(*cfg);
     // LCOV_EXCL_START
     std::shared_ptr<tracer::trace::Span> span = nullptr;
+    std::shared_ptr<SearchStageTimes> stage_times = nullptr;
     if (b_cfg.trace_id.has_value()) {
         auto trace_id_str = tracer::GetIDFromHexStr(b_cfg.trace_id.value());
         auto span_id_str = tracer::GetIDFromHexStr(b_cfg.span_id.value());
@@ -242,7 +845,9 @@ Index<T>::RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetVi
         span->SetAttribute(meta::ROWS, Count());
         span->SetAttribute(meta::DIM, Dim());
         span->SetAttribute(meta::NQ, dataset->GetRows());
+        stage_times = std::make_shared<SearchStageTimes>();
     }
+    ScopedSearchStageTimes stage_times_setter(stage_times);
     // LCOV_EXCL_STOP
 
     TimeRecorder rc("Range Search");
@@ -254,12 +859,52 @@ Index<T>::RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetVi
 
     // LCOV_EXCL_START
     if (has_trace_id) {
+        SetSearchStageAttributes(*span, *stage_times);
         span->End();
     }
     // LCOV_EXCL_STOP
 #else
     auto res = this->node->RangeSearch(dataset, std::move(cfg), bitset);
 #endif
+    CheckInterrupted(res, deadline);
+    return res;
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column, const Json& json,
+                        const BitsetView& bitset_) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    const Status load_status = LoadSearchConfig(cfg.get(), json, knowhere::SEARCH, "GroupBySearch", &msg);
+    if (load_status != Status::success) {
+        return expected<DataSetPtr>::Err(load_status, msg);
+    }
+    if (bitset_.size() > (size_t)this->Count()) {
+        msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
+                          bitset_.size(), this->Count());
+        LOG_KNOWHERE_ERROR_ << msg;
+        return expected<DataSetPtr>::Err(Status::invalid_args, msg);
+    }
+    if (!column.Covers(this->Count())) {
+        msg = fmt::format("group by column should cover the {} rows of the index", this->Count());
+        LOG_KNOWHERE_ERROR_ << msg;
+        return expected<DataSetPtr>::Err(Status::invalid_args, msg);
+    }
+
+    const auto bitset = bitset_.has_valid_ids()
+                            ? bitset_
+                            : BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    ScopedSearchPriority priority_setter(ToSearchPriority(cfg->search_priority.value()));
+    ScopedNumaNode numa_setter(this->node->NumaNode());
+    const auto deadline = MakeSearchDeadline(cfg->search_timeout_ms.value());
+    ScopedSearchDeadline deadline_setter(deadline);
+    if (const auto admission = AdmitSearch(); admission != Status::success) {
+        return expected<DataSetPtr>::Err(admission, "search shed, the search queue of its priority is full");
+    }
+
+    auto res = this->node->GroupBySearch(dataset, column, std::move(cfg), bitset);
+    CheckInterrupted(res, deadline);
     return res;
 }
 
@@ -299,6 +944,12 @@ Index<T>::Serialize(BinarySet& binset) const {
     return this->node->Serialize(binset);
 }
 
+template <typename T>
+inline Status
+Index<T>::SerializeToFile(const std::string& filename) const {
+    return this->node->SerializeToFile(filename);
+}
+
 template <typename T>
 inline Status
 Index<T>::Deserialize(const BinarySet& binset, const Json& json) {
@@ -316,6 +967,10 @@ Index<T>::Deserialize(const BinarySet& binset, const Json& json) {
         return res;
     }
 
+    const int numa_node = cfg->numa_node.value();
+    ScopedNumaMemoryBinding numa_binding(numa_node);
+    this->node->SetNumaNode(numa_node);
+
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     TimeRecorder rc("Load index", 2);
     res = this->node->Deserialize(binset, std::move(cfg));
@@ -325,6 +980,7 @@ Index<T>::Deserialize(const BinarySet& binset, const Json& json) {
 #else
     res = this->node->Deserialize(binset, std::move(cfg));
 #endif
+    ClearResultCache();
     return res;
 }
 
@@ -345,6 +1001,10 @@ Index<T>::DeserializeFromFile(const std::string& filename, const Json& json) {
         return res;
     }
 
+    const int numa_node = cfg->numa_node.value();
+    ScopedNumaMemoryBinding numa_binding(numa_node);
+    this->node->SetNumaNode(numa_node);
+
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     TimeRecorder rc("Load index from file", 2);
     res = this->node->DeserializeFromFile(filename, std::move(cfg));
@@ -354,9 +1014,22 @@ Index<T>::DeserializeFromFile(const std::string& filename, const Json& json) {
 #else
     res = this->node->DeserializeFromFile(filename, std::move(cfg));
 #endif
+    ClearResultCache();
     return res;
 }
 
+template <typename T>
+inline Status
+Index<T>::Warmup(WarmupLevel level, const WarmupProgress& progress) {
+    return this->node->Warmup(level, progress);
+}
+
+template <typename T>
+inline Status
+Index<T>::Cooldown() {
+    return this->node->Cooldown();
+}
+
 template <typename T>
 inline int64_t
 Index<T>::Dim() const {
@@ -369,6 +1042,23 @@ Index<T>::Size() const {
     return this->node->Size();
 }
 
+template <typename T>
+inline expected<MemoryReport>
+Index<T>::GetMemoryReport() const {
+    return this->node->GetMemoryReport();
+}
+
+template <typename T>
+inline Status
+Index<T>::ExportMemoryReport(const std::string& index_id) const {
+    auto report = this->node->GetMemoryReport();
+    if (!report.has_value()) {
+        return report.error();
+    }
+    knowhere::ExportMemoryReport(index_id, report.value());
+    return Status::success;
+}
+
 template <typename T>
 inline int64_t
 Index<T>::Count() const {
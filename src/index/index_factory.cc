@@ -11,6 +11,10 @@
 
 #include "knowhere/index/index_factory.h"
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "knowhere/index/index_table.h"
 #include "simd/hook.h"
 
@@ -20,6 +24,24 @@
 
 namespace knowhere {
 
+namespace {
+
+// the registrars queued by the registration macros that did not run yet
+struct DeferredRegistrars {
+    std::mutex mutex;
+    std::vector<void (*)()> registrars;
+    // the size of registrars, for the lookups not to lock once they all ran
+    std::atomic<size_t> pending{0};
+};
+
+DeferredRegistrars&
+DeferredRegistrarsInstance() {
+    static DeferredRegistrars deferred;
+    return deferred;
+}
+
+}  // namespace
+
 #ifdef KNOWHERE_WITH_CUVS
 
 bool
@@ -46,6 +68,7 @@ template <typename DataType>
 expected<Index<IndexNode>>
 IndexFactory::Create(const std::string& name, const int32_t& version, const Object& object) {
     static_assert(KnowhereDataTypeCheck<DataType>::value == true);
+    RunDeferred();
     auto& func_mapping_ = MapInstance();
     auto key = GetKey<DataType>(name);
     if (func_mapping_.find(key) == func_mapping_.end()) {
@@ -65,6 +88,11 @@ IndexFactory::Create(const std::string& name, const int32_t& version, const Obje
         return expected<Index<IndexNode>>::Err(Status::invalid_index_error,
                                                "SCANN index is not supported on the current CPU model");
     }
+    if (name == knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN && !faiss::support_pq_fast_scan) {
+        LOG_KNOWHERE_ERROR_ << "IVF_PQ_FASTSCAN index is not supported on the current CPU model";
+        return expected<Index<IndexNode>>::Err(Status::invalid_index_error,
+                                               "IVF_PQ_FASTSCAN index is not supported on the current CPU model");
+    }
 
     return fun_map_v->fun_value(version, object);
 }
@@ -115,8 +143,32 @@ IndexFactory::StaticIndexTableInstance() {
     return static_index_table;
 }
 
+bool
+IndexFactory::Defer(void (*registrar)()) {
+    auto& deferred = DeferredRegistrarsInstance();
+    std::lock_guard lock(deferred.mutex);
+    deferred.registrars.push_back(registrar);
+    deferred.pending.store(deferred.registrars.size(), std::memory_order_release);
+    return true;
+}
+
+void
+IndexFactory::RunDeferred() {
+    auto& deferred = DeferredRegistrarsInstance();
+    if (deferred.pending.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    std::lock_guard lock(deferred.mutex);
+    for (auto registrar : deferred.registrars) {
+        registrar();
+    }
+    deferred.registrars.clear();
+    deferred.pending.store(0, std::memory_order_release);
+}
+
 bool
 IndexFactory::FeatureCheck(const std::string& name, uint64_t feature) const {
+    RunDeferred();
     auto& feature_mapping_ = IndexFactory::FeatureMapInstance();
     assert(feature_mapping_.find(name) != feature_mapping_.end());
     return (feature_mapping_[name] & feature) == feature;
@@ -124,6 +176,7 @@ IndexFactory::FeatureCheck(const std::string& name, uint64_t feature) const {
 
 const std::map<std::string, uint64_t>&
 IndexFactory::GetIndexFeatures() {
+    RunDeferred();
     return FeatureMapInstance();
 }
 
@@ -0,0 +1,179 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "index/index_memory_report.h"
+
+#include <faiss/IndexBinaryFlat.h>
+#include <faiss/IndexBinaryIVF.h>
+#include <faiss/IndexFlat.h>
+#include <faiss/IndexFlatCodes.h>
+#include <faiss/IndexHNSW.h>
+#include <faiss/IndexIDMap.h>
+#include <faiss/IndexIVF.h>
+#include <faiss/IndexIVFFlat.h>
+#include <faiss/IndexIVFPQ.h>
+#include <faiss/IndexPreTransform.h>
+#include <faiss/IndexRefine.h>
+#include <faiss/VectorTransform.h>
+#include <faiss/cppcontrib/knowhere/impl/CountSizeIOWriter.h>
+#include <faiss/impl/mapped_io.h>
+#include <faiss/impl/maybe_owned_vector.h>
+#include <faiss/index_io.h>
+#include <faiss/invlists/ArenaInvertedLists.h>
+#include <faiss/invlists/InvertedLists.h>
+
+#include <optional>
+#include <vector>
+
+namespace knowhere {
+
+namespace {
+
+struct Reporter {
+    MemoryReport& report;
+    // the component that all the buffers of the index being walked through are accounted to, if set
+    std::optional<MemoryComponent> forced = std::nullopt;
+
+    MemoryComponent
+    Of(MemoryComponent component) const {
+        return forced.value_or(component);
+    }
+
+    template <typename T>
+    void
+    Add(const faiss::MaybeOwnedVector<T>& vec, MemoryComponent component) {
+        const size_t bytes = vec.size() * sizeof(T);
+        if (!vec.is_owned && dynamic_cast<const faiss::MmappedFileMappingOwner*>(vec.owner.get()) != nullptr) {
+            report.AddMapped(Of(component), vec.data(), bytes);
+        } else {
+            report.AddHeap(Of(component), bytes);
+        }
+    }
+
+    template <typename T>
+    void
+    Add(const std::vector<T>& vec, MemoryComponent component) {
+        report.AddHeap(Of(component), vec.capacity() * sizeof(T));
+    }
+
+    void
+    Add(const faiss::DirectMap& direct_map) {
+        Add(direct_map.array, MemoryComponent::ID_MAP);
+        // the nodes of the hash table, without the overhead of its buckets
+        report.AddHeap(Of(MemoryComponent::ID_MAP), direct_map.hashtable.size() * 2 * sizeof(faiss::idx_t));
+    }
+
+    void
+    Add(const faiss::InvertedLists* invlists, MemoryComponent codes) {
+        if (auto arena = dynamic_cast<const faiss::ArenaInvertedLists*>(invlists)) {
+            Add(arena->ids, MemoryComponent::ID_MAP);
+            Add(arena->codes, codes);
+        } else if (auto array = dynamic_cast<const faiss::ArrayInvertedLists*>(invlists)) {
+            for (size_t i = 0; i < array->nlist; ++i) {
+                Add(array->ids[i], MemoryComponent::ID_MAP);
+                Add(array->codes[i], codes);
+            }
+        } else if (invlists != nullptr) {
+            // the inverted lists that are not in memory, such as those on disk
+            for (size_t i = 0; i < invlists->nlist; ++i) {
+                const size_t size = invlists->list_size(i);
+                report.AddHeap(Of(MemoryComponent::ID_MAP), size * sizeof(faiss::idx_t));
+                report.AddHeap(Of(codes), size * invlists->code_size);
+            }
+        }
+    }
+
+    // the buffers of the walked index, accounted to the component unless a component is already forced
+    template <typename IndexT>
+    void
+    AddAs(const IndexT* index, MemoryComponent component) {
+        const auto saved = forced;
+        forced = Of(component);
+        Add(index);
+        forced = saved;
+    }
+
+    void
+    Add(const faiss::Index* index) {
+        if (index == nullptr) {
+            return;
+        }
+        if (auto hnsw = dynamic_cast<const faiss::IndexHNSW*>(index)) {
+            Add(hnsw->hnsw.neighbors, MemoryComponent::GRAPH);
+            Add(hnsw->hnsw.levels, MemoryComponent::GRAPH);
+            Add(hnsw->hnsw.offsets, MemoryComponent::GRAPH);
+            Add(hnsw->storage);
+        } else if (auto flat = dynamic_cast<const faiss::IndexFlat*>(index)) {
+            Add(flat->codes, MemoryComponent::RAW_DATA);
+        } else if (auto codes = dynamic_cast<const faiss::IndexFlatCodes*>(index)) {
+            Add(codes->codes, MemoryComponent::CODES);
+        } else if (auto ivf = dynamic_cast<const faiss::IndexIVF*>(index)) {
+            AddAs(ivf->quantizer, MemoryComponent::CENTROIDS);
+            const bool raw = dynamic_cast<const faiss::IndexIVFFlat*>(index) != nullptr;
+            Add(ivf->invlists, raw ? MemoryComponent::RAW_DATA : MemoryComponent::CODES);
+            Add(ivf->direct_map);
+            if (auto ivfpq = dynamic_cast<const faiss::IndexIVFPQ*>(index)) {
+                Add(ivfpq->pq.centroids, MemoryComponent::CENTROIDS);
+                report.AddHeap(Of(MemoryComponent::CACHE), ivfpq->precomputed_table.nbytes());
+            }
+        } else if (auto refine = dynamic_cast<const faiss::IndexRefine*>(index)) {
+            Add(refine->base_index);
+            AddAs(refine->refine_index, MemoryComponent::REFINE_DATA);
+        } else if (auto transform = dynamic_cast<const faiss::IndexPreTransform*>(index)) {
+            for (const auto* vt : transform->chain) {
+                if (auto linear = dynamic_cast<const faiss::LinearTransform*>(vt)) {
+                    Add(linear->A, MemoryComponent::OTHER);
+                    Add(linear->b, MemoryComponent::OTHER);
+                }
+            }
+            Add(transform->index);
+        } else if (auto id_map = dynamic_cast<const faiss::IndexIDMap*>(index)) {
+            Add(id_map->id_map, MemoryComponent::ID_MAP);
+            Add(id_map->index);
+        } else {
+            faiss::cppcontrib::knowhere::CountSizeIOWriter writer;
+            faiss::write_index(index, &writer);
+            report.AddHeap(Of(MemoryComponent::OTHER), writer.total_size);
+        }
+    }
+
+    void
+    Add(const faiss::IndexBinary* index) {
+        if (index == nullptr) {
+            return;
+        }
+        if (auto flat = dynamic_cast<const faiss::IndexBinaryFlat*>(index)) {
+            Add(flat->xb, MemoryComponent::RAW_DATA);
+        } else if (auto ivf = dynamic_cast<const faiss::IndexBinaryIVF*>(index)) {
+            AddAs(ivf->quantizer, MemoryComponent::CENTROIDS);
+            Add(ivf->invlists, MemoryComponent::RAW_DATA);
+            Add(ivf->direct_map);
+        } else {
+            faiss::cppcontrib::knowhere::CountSizeIOWriter writer;
+            faiss::write_index_binary(index, &writer);
+            report.AddHeap(Of(MemoryComponent::OTHER), writer.total_size);
+        }
+    }
+};
+
+}  // namespace
+
+void
+ReportIndexMemory(const faiss::Index* index, MemoryReport& report) {
+    Reporter{report}.Add(index);
+}
+
+void
+ReportIndexMemory(const faiss::IndexBinary* index, MemoryReport& report) {
+    Reporter{report}.Add(index);
+}
+
+}  // namespace knowhere
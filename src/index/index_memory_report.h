@@ -0,0 +1,30 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <faiss/Index.h>
+#include <faiss/IndexBinary.h>
+
+#include "knowhere/comp/memory_report.h"
+
+namespace knowhere {
+
+// Adds the memory of a faiss index to the report: its HNSW graph, codes, IVF centroids and inverted lists, refine
+// codes and id maps, the buffers mapped from its file as mapped. The indexes that are not walked through, such as the
+// quantizers of other types, are reported as a whole as MemoryComponent::OTHER, with the size of their serialization.
+void
+ReportIndexMemory(const faiss::Index* index, MemoryReport& report);
+
+void
+ReportIndexMemory(const faiss::IndexBinary* index, MemoryReport& report);
+
+}  // namespace knowhere
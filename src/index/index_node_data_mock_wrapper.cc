@@ -52,6 +52,14 @@ IndexNodeDataMockWrapper<DataType>::Search(const DataSetPtr dataset, std::unique
     return index_node_->Search(ds_ptr, std::move(cfg), bitset);
 }
 
+template <typename DataType>
+expected<DataSetPtr>
+IndexNodeDataMockWrapper<DataType>::SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                                                  const BitsetView& bitset, int64_t* ids, float* distances) const {
+    auto ds_ptr = ConvertFromDataTypeIfNeeded<DataType>(dataset);
+    return index_node_->SearchWithBuf(ds_ptr, std::move(cfg), bitset, ids, distances);
+}
+
 template <typename DataType>
 expected<DataSetPtr>
 IndexNodeDataMockWrapper<DataType>::RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
@@ -68,6 +76,14 @@ IndexNodeDataMockWrapper<DataType>::AnnIterator(const DataSetPtr dataset, std::u
     return index_node_->AnnIterator(ds_ptr, std::move(cfg), bitset, use_knowhere_search_pool);
 }
 
+template <typename DataType>
+expected<DataSetPtr>
+IndexNodeDataMockWrapper<DataType>::GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column,
+                                                  std::unique_ptr<Config> cfg, const BitsetView& bitset) const {
+    auto ds_ptr = ConvertFromDataTypeIfNeeded<DataType>(dataset);
+    return index_node_->GroupBySearch(ds_ptr, column, std::move(cfg), bitset);
+}
+
 template <typename DataType>
 expected<DataSetPtr>
 IndexNodeDataMockWrapper<DataType>::GetVectorByIds(const DataSetPtr dataset) const {
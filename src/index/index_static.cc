@@ -13,6 +13,7 @@
 
 #include <set>
 
+#include "knowhere/index/index_factory.h"
 #include "knowhere/operands.h"
 
 namespace knowhere {
@@ -37,6 +38,8 @@ IndexStaticFaced<DataType>::Instance() {
 template <typename DataType>
 std::unique_ptr<BaseConfig>
 IndexStaticFaced<DataType>::CreateConfig(const IndexType& indexType, const IndexVersion& version) {
+    // the other lookups create the config first
+    IndexFactory::RunDeferred();
     if (Instance().staticCreateConfigMap.find(indexType) != Instance().staticCreateConfigMap.end()) {
         return Instance().staticCreateConfigMap[indexType]();
     }
@@ -0,0 +1,142 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "index/index_warmup.h"
+
+#include <faiss/IndexBinaryFlat.h>
+#include <faiss/IndexBinaryIVF.h>
+#include <faiss/IndexFlatCodes.h>
+#include <faiss/IndexHNSW.h>
+#include <faiss/IndexIVF.h>
+#include <faiss/IndexPreTransform.h>
+#include <faiss/IndexRefine.h>
+#include <faiss/impl/mapped_io.h>
+#include <faiss/impl/maybe_owned_vector.h>
+#include <faiss/invlists/ArenaInvertedLists.h>
+
+namespace knowhere {
+
+namespace {
+
+// a range mapped from the file of the index
+struct MappedRange {
+    MemoryRange range;
+    // whether every search goes through the data
+    bool hot;
+    MmapAccess access;
+};
+
+struct RangeCollector {
+    std::vector<MappedRange> ranges;
+
+    template <typename T>
+    void
+    Add(const faiss::MaybeOwnedVector<T>& vec, bool hot, MmapAccess access) {
+        if (!vec.is_owned && vec.size() != 0 &&
+            dynamic_cast<const faiss::MmappedFileMappingOwner*>(vec.owner.get()) != nullptr) {
+            ranges.push_back({{vec.data(), vec.size() * sizeof(T)}, hot, access});
+        }
+    }
+
+    void
+    Add(const faiss::InvertedLists* invlists) {
+        if (auto arena = dynamic_cast<const faiss::ArenaInvertedLists*>(invlists)) {
+            Add(arena->ids, true, MmapAccess::SEQUENTIAL);
+            Add(arena->codes, false, MmapAccess::SEQUENTIAL);
+        }
+    }
+
+    // scanned: whether the searches scan the codes of the index through, rather than fetch them one by one
+    void
+    Add(const faiss::Index* index, bool hot, bool scanned) {
+        if (index == nullptr) {
+            return;
+        }
+        if (auto hnsw = dynamic_cast<const faiss::IndexHNSW*>(index)) {
+            Add(hnsw->hnsw.neighbors, hot, MmapAccess::RANDOM);
+            Add(hnsw->storage, false, false);
+        } else if (auto flat = dynamic_cast<const faiss::IndexFlatCodes*>(index)) {
+            Add(flat->codes, hot, scanned ? MmapAccess::SEQUENTIAL : MmapAccess::RANDOM);
+        } else if (auto ivf = dynamic_cast<const faiss::IndexIVF*>(index)) {
+            // the centroids are compared to every query
+            if (auto centroids = dynamic_cast<const faiss::IndexFlatCodes*>(ivf->quantizer)) {
+                Add(centroids->codes, hot, MmapAccess::WILLNEED);
+            } else {
+                Add(ivf->quantizer, hot, scanned);
+            }
+            Add(ivf->invlists);
+        } else if (auto refine = dynamic_cast<const faiss::IndexRefine*>(index)) {
+            Add(refine->base_index, hot, scanned);
+            Add(refine->refine_index, false, false);
+        } else if (auto transform = dynamic_cast<const faiss::IndexPreTransform*>(index)) {
+            Add(transform->index, hot, scanned);
+        }
+    }
+
+    void
+    Add(const faiss::IndexBinary* index) {
+        if (auto flat = dynamic_cast<const faiss::IndexBinaryFlat*>(index)) {
+            Add(flat->xb, true, MmapAccess::SEQUENTIAL);
+        } else if (auto ivf = dynamic_cast<const faiss::IndexBinaryIVF*>(index)) {
+            Add(ivf->invlists);
+        }
+    }
+
+    std::vector<MemoryRange>
+    Get(WarmupLevel level) const {
+        std::vector<MemoryRange> res;
+        for (const auto& mapped : ranges) {
+            if (mapped.hot || level == WarmupLevel::FULL) {
+                res.push_back(mapped.range);
+            }
+        }
+        return res;
+    }
+
+    void
+    Advise() const {
+        for (const auto& mapped : ranges) {
+            AdviseMmapAccess({mapped.range}, mapped.access);
+        }
+    }
+};
+
+}  // namespace
+
+std::vector<MemoryRange>
+GetMappedRanges(const faiss::Index* index, WarmupLevel level) {
+    RangeCollector collector;
+    collector.Add(index, true, true);
+    return collector.Get(level);
+}
+
+std::vector<MemoryRange>
+GetMappedRanges(const faiss::IndexBinary* index, WarmupLevel level) {
+    RangeCollector collector;
+    collector.Add(index);
+    return collector.Get(level);
+}
+
+void
+AdviseMappedAccess(const faiss::Index* index) {
+    RangeCollector collector;
+    collector.Add(index, true, true);
+    collector.Advise();
+}
+
+void
+AdviseMappedAccess(const faiss::IndexBinary* index) {
+    RangeCollector collector;
+    collector.Add(index);
+    collector.Advise();
+}
+
+}  // namespace knowhere
@@ -0,0 +1,41 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <faiss/Index.h>
+#include <faiss/IndexBinary.h>
+
+#include <vector>
+
+#include "knowhere/comp/warmup.h"
+
+namespace knowhere {
+
+// The ranges of the data of a faiss index that are mapped from its file, for WarmupRanges() and CooldownRanges(): of
+// the codes, HNSW graphs and IVF inverted lists, or only of the structures that every search goes through if the
+// level is HOT. Empty if the index is loaded in memory.
+std::vector<MemoryRange>
+GetMappedRanges(const faiss::Index* index, WarmupLevel level);
+
+std::vector<MemoryRange>
+GetMappedRanges(const faiss::IndexBinary* index, WarmupLevel level);
+
+// Advises the kernel of how the searches read the data of a faiss index mapped from its file (see MmapAccess): the
+// HNSW graphs and the vectors that they fetch are random, the IVF lists and FLAT codes that are scanned through are
+// sequential, the IVF centroids are read ahead at once. A no-op if the index is loaded in memory.
+void
+AdviseMappedAccess(const faiss::Index* index);
+
+void
+AdviseMappedAccess(const faiss::IndexBinary* index);
+
+}  // namespace knowhere
@@ -10,10 +10,12 @@
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
 #include "common/metric.h"
+#include "faiss/Clustering.h"
 #include "faiss/IndexBinaryFlat.h"
 #include "faiss/IndexBinaryIVF.h"
 #include "faiss/IndexFlat.h"
 #include "faiss/IndexFlatElkan.h"
+#include "faiss/IndexHNSW.h"
 #include "faiss/IndexIVFFlat.h"
 #include "faiss/IndexIVFPQ.h"
 #include "faiss/IndexIVFPQFastScan.h"
@@ -22,12 +24,21 @@
 #include "faiss/IndexScaNN.h"
 #include "faiss/IndexScalarQuantizer.h"
 #include "faiss/VectorTransform.h"
+#include "faiss/cppcontrib/knowhere/utils/GroupByCollector.h"
 #include "faiss/index_io.h"
 #include "index/data_view_dense_index/index_node_with_data_view_refiner.h"
+#include "index/huge_page_index.h"
+#include "index/index_memory_report.h"
+#include "index/index_warmup.h"
 #include "index/ivf/ivf_config.h"
+#include "index/ivf/ivfpqfs_wrapper.h"
 #include "index/ivf/ivfrbq_wrapper.h"
+#include "index/refine/refine_utils.h"
+#include "io/index_binary.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/workspace.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
 #include "knowhere/feature.h"
@@ -53,6 +64,32 @@ struct IndexDispatch<faiss::IndexIVFFlat> {
     using Tag = IVFFlatTag;
 };
 
+// probes the lists through the graph of an HNSW coarse quantizer with the given ef, no-op for a flat quantizer
+inline void
+SetGraphQuantizerParams(const faiss::Index* quantizer, const int64_t quantizer_ef,
+                        faiss::SearchParametersHNSW& quantizer_params, faiss::IVFSearchParameters& ivf_search_params) {
+    if (dynamic_cast<const faiss::IndexHNSW*>(quantizer) != nullptr) {
+        quantizer_params.efSearch = quantizer_ef;
+        ivf_search_params.quantizer_params = &quantizer_params;
+    }
+}
+
+// a search is split across the probed lists of its queries when each query gets at least this many search threads
+constexpr int64_t kIvfIntraQueryMinThreadsPerQuery = 4;
+// the minimal number of probed lists scanned by a task of a split search
+constexpr int64_t kIvfIntraQueryMinListsPerTask = 4;
+// a large batch of queries is searched list by list in blocks of this many queries at least (and at most), see
+// SearchListMajor()
+constexpr int64_t kIvfListMajorMinBlockRows = 64;
+constexpr int64_t kIvfListMajorMaxBlockRows = 1024;
+// the queries of a block that are expected to probe every list, for a list-major search to pay off
+constexpr int64_t kIvfListMajorMinQueriesPerList = 4;
+// the codes of a list are scanned for all the queries of a block that probe it in chunks of these many bytes
+constexpr size_t kIvfListMajorChunkBytes = 1 << 16;
+// past this share of filtered out vectors, more lists than nprobe are ranked, and the probed lists whose ids are all
+// filtered out are replaced with further ones
+constexpr float kIvfFilteredProbeMinFilterRatio = 0.5f;
+
 template <typename DataType, typename IndexType>
 class IvfIndexNode : public IndexNode {
  public:
@@ -64,19 +101,32 @@ class IvfIndexNode : public IndexNode {
                           std::is_same<IndexType, faiss::IndexBinaryIVF>::value ||
                           std::is_same<IndexType, faiss::IndexScaNN>::value ||
                           std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value ||
-                          std::is_same<IndexType, IndexIVFRaBitQWrapper>::value,
+                          std::is_same<IndexType, IndexIVFRaBitQWrapper>::value ||
+                          std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value,
                       "not support");
         static_assert(std::is_same_v<DataType, fp32> || std::is_same_v<DataType, bin1>,
                       "IvfIndexNode only support float/binary");
         search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
         build_pool_ = ThreadPool::GetGlobalBuildThreadPool();
     }
+    int64_t
+    EstimateBuildMemory(const DataSetPtr dataset, const Config& cfg) const override {
+        // the data, its copy in the inverted lists and the centroids
+        const auto& ivf_cfg = static_cast<const IvfConfig&>(cfg);
+        return 2 * DataSetBytes<DataType>(dataset) +
+               ivf_cfg.nlist.value_or(0) * dataset->GetDim() * static_cast<int64_t>(sizeof(float));
+    }
     Status
     Train(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
     Status
     Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
     expected<DataSetPtr>
-    Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
+    Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
+        return SearchWithNewBuf(dataset, std::move(cfg), bitset);
+    }
+    expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override;
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
     static constexpr bool
@@ -86,11 +136,23 @@ class IvfIndexNode : public IndexNode {
                 std::is_same<faiss::IndexIVFScalarQuantizer, IndexType>::value ||
                 std::is_same<faiss::IndexIVFScalarQuantizerCC, IndexType>::value ||
                 std::is_same<faiss::IndexScaNN, IndexType>::value ||
-                std::is_same<IndexIVFRaBitQWrapper, IndexType>::value);
+                std::is_same<IndexIVFRaBitQWrapper, IndexType>::value ||
+                std::is_same<IndexIVFPQFastScanWrapper, IndexType>::value);
     }
     expected<std::vector<IndexNode::IteratorPtr>>
     AnnIterator(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset,
                 bool use_knowhere_search_pool) const override;
+    // the types whose iterator yields the final distances of the rows, without a refine
+    static constexpr bool
+    is_group_by_supported() {
+        return std::is_same_v<faiss::IndexIVFFlatCC, IndexType> || std::is_same_v<faiss::IndexIVFFlat, IndexType> ||
+               std::is_same_v<faiss::IndexIVFScalarQuantizer, IndexType> ||
+               std::is_same_v<faiss::IndexIVFScalarQuantizerCC, IndexType> ||
+               std::is_same_v<IndexIVFRaBitQWrapper, IndexType>;
+    }
+    expected<DataSetPtr>
+    GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column, std::unique_ptr<Config> cfg,
+                  const BitsetView& bitset) const override;
     expected<DataSetPtr>
     GetVectorByIds(const DataSetPtr dataset) const override;
 
@@ -141,6 +203,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<IndexIVFRaBitQWrapper, IndexType>::value) {
             return false;
         }
+        if constexpr (std::is_same<IndexIVFPQFastScanWrapper, IndexType>::value) {
+            return false;
+        }
         return false;
     }
 
@@ -148,7 +213,11 @@ class IvfIndexNode : public IndexNode {
     StaticHasRawData(const knowhere::BaseConfig& config, const IndexVersion& version) {
         if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value) {
             const ScannConfig& scann_cfg = static_cast<const ScannConfig&>(config);
-            return scann_cfg.with_raw_data.has_value() && scann_cfg.with_raw_data.value();
+            if (!scann_cfg.with_raw_data.value_or(false)) {
+                return false;
+            }
+            return !scann_cfg.refine_type.has_value() ||
+                   has_lossless_refine_index(true, scann_cfg.refine_type, DataType2EnumHelper<DataType>::value);
         }
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizerCC, IndexType>::value) {
             const IvfSqCcConfig& ivfsqcc_cfg = static_cast<const IvfSqCcConfig&>(config);
@@ -163,7 +232,7 @@ class IvfIndexNode : public IndexNode {
             return false;
         }
         if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value) {
-            return index_->with_raw_data();
+            return index_->with_raw_data() && IsLosslessRefine(index_->refine_index);
         }
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizerCC, IndexType>::value) {
             return index_->with_raw_data();
@@ -179,9 +248,40 @@ class IvfIndexNode : public IndexNode {
         return this->SerializeImpl(binset);
     }
     Status
+    SerializeToFile(const std::string& filename) const override;
+    Status
     Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) override;
     Status
     DeserializeFromFile(const std::string& filename, std::shared_ptr<Config> cfg) override;
+    Status
+    Warmup(WarmupLevel level, const WarmupProgress& progress) override {
+        if (!index_) {
+            return Status::empty_index;
+        }
+        return WarmupRanges(GetMappedRanges(level), progress);
+    }
+    Status
+    Cooldown() override {
+        if (!index_) {
+            return Status::empty_index;
+        }
+        return CooldownRanges(GetMappedRanges(WarmupLevel::FULL));
+    }
+
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        MemoryReport report;
+        if (!index_) {
+            return report;
+        }
+        if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value ||
+                      std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+            ReportIndexMemory(index_->index.get(), report);
+        } else {
+            ReportIndexMemory(index_.get(), report);
+        }
+        return report;
+    }
 
     static std::unique_ptr<BaseConfig>
     StaticCreateConfig() {
@@ -209,6 +309,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<IndexIVFRaBitQWrapper, IndexType>::value) {
             return std::make_unique<IvfRaBitQConfig>();
         }
+        if constexpr (std::is_same<IndexIVFPQFastScanWrapper, IndexType>::value) {
+            return std::make_unique<IvfPqFastScanConfig>();
+        }
     };
 
     std::unique_ptr<BaseConfig>
@@ -276,6 +379,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
             return index_->size();
         }
+        if constexpr (std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+            return index_->size();
+        }
     };
     int64_t
     Count() const override {
@@ -310,6 +416,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ;
         }
+        if constexpr (std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+            return knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN;
+        }
     };
 
  private:
@@ -323,26 +432,101 @@ class IvfIndexNode : public IndexNode {
     Status
     SerializeImpl(BinarySet& binset) const;
 
+    void
+    WriteIndex(faiss::IOWriter* writer) const;
+
+    void
+    BackWithHugePages(bool in_place);
+
+    std::vector<MemoryRange>
+    GetMappedRanges(WarmupLevel level) const;
+
+    // advises the kernel of the access pattern of the index if it is mapped from its file
+    void
+    AdviseMappedAccess() const;
+
     Status
     TrainInternal(const DataSetPtr dataset, std::shared_ptr<Config> cfg);
 
+    // whether the refine data of a SCANN index reconstructs the vectors of DataType exactly
+    static bool
+    IsLosslessRefine(const faiss::Index* refine_index) {
+        if (dynamic_cast<const faiss::IndexFlat*>(refine_index) != nullptr) {
+            return true;
+        }
+        if (auto sq = dynamic_cast<const faiss::IndexScalarQuantizer*>(refine_index); sq != nullptr) {
+            return has_lossless_quant(sq->sq.qtype, DataType2EnumHelper<DataType>::value);
+        }
+        return false;
+    }
+
+    // the coarse quantizer that assigns the vectors to the lists, nullptr if it is not a float index
+    static const faiss::Index*
+    CoarseQuantizer(const IndexType* index) {
+        if constexpr (std::is_same_v<IndexType, faiss::IndexScaNN>) {
+            return static_cast<const faiss::IndexIVF*>(index->base_index)->quantizer;
+        } else if constexpr (std::is_base_of_v<faiss::IndexIVF, IndexType>) {
+            return index->quantizer;
+        } else {
+            return nullptr;
+        }
+    }
+
     static constexpr bool
     IsQuantized() {
         return std::is_same_v<IndexType, faiss::IndexIVFPQ> ||
                std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizer> ||
                std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizerCC> ||
-               std::is_same_v<IndexType, faiss::IndexScaNN> || std::is_same_v<IndexType, IndexIVFRaBitQWrapper>;
+               std::is_same_v<IndexType, faiss::IndexScaNN> || std::is_same_v<IndexType, IndexIVFRaBitQWrapper> ||
+               std::is_same_v<IndexType, IndexIVFPQFastScanWrapper>;
     }
 
  private:
-    // only support IVFFlat,IVFFlatCC, IVFSQ, IVFSQCC and SCANN
+    // whether the probed lists of a query can be scanned by several tasks, each with its own heap
+    static constexpr bool
+    is_intra_query_search_supported() {
+        return std::is_same_v<IndexType, faiss::IndexIVFFlat> || std::is_same_v<IndexType, faiss::IndexIVFFlatCC> ||
+               std::is_same_v<IndexType, faiss::IndexIVFPQ> ||
+               std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizer> ||
+               std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizerCC>;
+    }
+
+    // searches the queries with their probed lists split across tasks_per_query tasks of the search pool, the top k
+    // results of the tasks are merged. Used when there are too few queries to keep the search pool busy. The lists
+    // scanned for the query q are counted into stats[q] if stats is not null. quantized_query is passed on to the
+    // IVF_SQ scanners, see IvfSqConfig::quantized_query.
+    void
+    SearchSplitLists(const float* queries, const int64_t rows, const int64_t k, const int64_t nprobe,
+                     const int64_t quantizer_ef, const int64_t tasks_per_query, const bool is_cosine,
+                     const bool quantized_query, const BitsetView& bitset, float* distances, int64_t* ids,
+                     QuerySearchStats* stats) const;
+
+    // whether the probed lists of a block of queries can be scanned list by list
+    static constexpr bool
+    is_list_major_search_supported() {
+        return std::is_same_v<IndexType, faiss::IndexIVFFlat> ||
+               std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizer>;
+    }
+
+    // searches the queries in blocks of block_rows queries, one task of the search pool per block. The probed lists
+    // of the queries of a block are inverted, so that every list is read once for all the queries that probe it,
+    // chunk by chunk while the chunk stays in the cache. Used for the batches large enough for every list to be
+    // probed by several queries of a block. The lists scanned for the query q are counted into stats[q] if stats is
+    // not null. quantized_query is passed on to the IVF_SQ scanners as by SearchSplitLists().
+    void
+    SearchListMajor(const float* queries, const int64_t rows, const int64_t k, const int64_t nprobe,
+                    const int64_t quantizer_ef, const int64_t block_rows, const bool is_cosine,
+                    const bool quantized_query, const BitsetView& bitset, float* distances, int64_t* ids,
+                    QuerySearchStats* stats) const;
+
+    // only support IVFFlat,IVFFlatCC, IVFSQ, IVFSQCC, SCANN, IVFRABITQ and IVFPQFASTSCAN
     // iterator will own the copied_norm_query
     // TODO: iterator should copy and own query data.
     // TODO: If SCANN support Iterator, raw_distance() function should be override.
     class iterator : public IndexIterator {
      public:
         iterator(const IndexType* index, std::unique_ptr<float[]>&& copied_query, const BitsetView& bitset,
-                 size_t nprobe, bool larger_is_closer, const float refine_ratio = 0.5f,
+                 size_t nprobe, int64_t quantizer_ef, bool larger_is_closer, const float refine_ratio = 0.5f,
                  bool use_knowhere_search_pool = true)
             : IndexIterator(larger_is_closer, use_knowhere_search_pool, refine_ratio),
               index_(index),
@@ -354,6 +538,7 @@ class IvfIndexNode : public IndexNode {
 
             ivf_search_params_.nprobe = nprobe;
             ivf_search_params_.max_codes = 0;
+            SetGraphQuantizerParams(CoarseQuantizer(index_), quantizer_ef, quantizer_params_, ivf_search_params_);
 
             workspace_ = index_->getIteratorWorkspace(copied_query_.get(), &ivf_search_params_);
         }
@@ -368,7 +553,8 @@ class IvfIndexNode : public IndexNode {
 
         float
         raw_distance(int64_t id) override {
-            if constexpr (std::is_same_v<IndexType, faiss::IndexScaNN>) {
+            if constexpr (std::is_same_v<IndexType, faiss::IndexScaNN> ||
+                          std::is_same_v<IndexType, IndexIVFPQFastScanWrapper>) {
                 if (this->refine_) {
                     return workspace_->dis_refine->operator()(id);
                 } else {
@@ -378,12 +564,33 @@ class IvfIndexNode : public IndexNode {
             throw std::runtime_error("raw_distance not implemented");
         }
 
+        void
+        raw_distances(const int64_t* ids, size_t n, float* dists) override {
+            if constexpr (std::is_same_v<IndexType, faiss::IndexScaNN> ||
+                          std::is_same_v<IndexType, IndexIVFPQFastScanWrapper>) {
+                if (this->refine_) {
+                    auto& dis_refine = *workspace_->dis_refine;
+                    size_t i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        dis_refine.distances_batch_4(ids[i], ids[i + 1], ids[i + 2], ids[i + 3], dists[i],
+                                                     dists[i + 1], dists[i + 2], dists[i + 3]);
+                    }
+                    for (; i < n; i++) {
+                        dists[i] = dis_refine(ids[i]);
+                    }
+                    return;
+                }
+            }
+            IndexIterator::raw_distances(ids, n, dists);
+        }
+
      private:
         const IndexType* index_ = nullptr;
         std::unique_ptr<faiss::IVFIteratorWorkspace> workspace_ = nullptr;
         std::unique_ptr<float[]> copied_query_ = nullptr;
         std::unique_ptr<BitsetViewIDSelector> bw_idselector_ = nullptr;
         faiss::IVFSearchParameters ivf_search_params_;
+        faiss::SearchParametersHNSW quantizer_params_;
     };
 
     std::unique_ptr<IndexType> index_;
@@ -440,6 +647,43 @@ to_index_flat(std::unique_ptr<faiss::IndexFlat>&& index) {
     return std::make_unique<faiss::IndexFlat>(std::move(*index));
 }
 
+// turn the trained IndexFlatElkan into the coarse quantizer of the config. A graph quantizer finds the lists to probe
+//   without scanning all the centroids, which dominates the assignment and the search once nlist is very large.
+std::unique_ptr<faiss::Index>
+to_coarse_quantizer(std::unique_ptr<faiss::IndexFlat>&& index, const IvfConfig& cfg) {
+    std::unique_ptr<faiss::IndexFlat> flat = to_index_flat(std::move(index));
+    if (str_to_lower(cfg.quantizer_type.value()) != "hnsw") {
+        return flat;
+    }
+
+    auto graph = std::make_unique<faiss::IndexHNSWFlat>(flat->d, cfg.quantizer_hnsw_m.value(), flat->metric_type);
+    graph->hnsw.efConstruction = cfg.quantizer_ef_construction.value();
+    // used to assign the added vectors, the searches provide their own ef
+    graph->hnsw.efSearch = cfg.quantizer_ef_construction.value();
+    graph->add(flat->ntotal, flat->get_xb());
+    return graph;
+}
+
+// with hierarchical_kmeans, fill the training quantizer with the centroids of a hierarchical balanced k-means, for the
+//   training of the index to keep them instead of running the flat k-means of faiss. The k-means is in L2.
+void
+train_balanced_quantizer(faiss::IndexFlat* qzr, const int64_t rows, const float* data, const int64_t nlist,
+                         const faiss::ClusteringParameters& cp, const IvfConfig& cfg) {
+    if (!cfg.hierarchical_kmeans.value()) {
+        return;
+    }
+    std::unique_ptr<float[]> normalized;
+    if (IsMetricType(cfg.metric_type.value(), metric::COSINE)) {
+        // the index trains on the normalized vectors
+        normalized = CopyAndNormalizeVecs(data, rows, qzr->d);
+        data = normalized.get();
+    }
+    std::vector<float> centroids(nlist * qzr->d);
+    faiss::hierarchical_balanced_kmeans(qzr->d, rows, nlist, data, centroids.data(), cp,
+                                        cfg.kmeans_max_balance.value());
+    qzr->add(nlist, centroids.data());
+}
+
 expected<faiss::ScalarQuantizer::QuantizerType>
 get_ivf_sq_quantizer_type(int code_size) {
     switch (code_size) {
@@ -489,7 +733,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
     // do normalize for COSINE metric type
     if constexpr (std::is_same_v<faiss::IndexIVFPQ, IndexType> ||
                   std::is_same_v<faiss::IndexIVFScalarQuantizer, IndexType> ||
-                  std::is_same_v<IndexIVFRaBitQWrapper, IndexType>) {
+                  std::is_same_v<IndexIVFRaBitQWrapper, IndexType> ||
+                  std::is_same_v<IndexIVFPQFastScanWrapper, IndexType>) {
         if (is_cosine) {
             NormalizeDataset<DataType>(dataset);
         }
@@ -501,15 +746,25 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
         return Status::invalid_metric_type;
     }
 
+    const IvfConfig& ivf_cfg = static_cast<const IvfConfig&>(*cfg);
+    const std::string quantizer_type = str_to_lower(ivf_cfg.quantizer_type.value());
+    if (quantizer_type != "flat" && quantizer_type != "hnsw") {
+        LOG_KNOWHERE_ERROR_ << "Invalid coarse quantizer type: " << ivf_cfg.quantizer_type.value()
+                            << ", supported: [flat hnsw]";
+        return Status::invalid_args;
+    }
+
     auto rows = dataset->GetRows();
     auto dim = dataset->GetDim();
     auto data = dataset->GetTensor();
 
     // faiss scann needs at least 16 rows since nbits=4
     constexpr int64_t SCANN_MIN_ROWS = 16;
-    if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value) {
+    if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value ||
+                  std::is_same<IndexIVFPQFastScanWrapper, IndexType>::value) {
         if (rows < SCANN_MIN_ROWS) {
-            LOG_KNOWHERE_ERROR_ << rows << " rows is not enough, scann needs at least 16 rows to build index";
+            LOG_KNOWHERE_ERROR_ << rows << " rows is not enough, " << Type()
+                                << " needs at least 16 rows to build index";
             return Status::faiss_inner_error;
         }
     }
@@ -529,11 +784,12 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
         // create index. Index does not own qzr
         index = std::make_unique<faiss::IndexIVFFlat>(qzr.get(), dim, nlist, metric.value(), is_cosine);
         // train
+        train_balanced_quantizer(qzr.get(), rows, (const float*)data, nlist, index->cp, ivf_cfg);
         index->train(rows, (const float*)data);
-        // replace quantizer with a regular IndexFlat
-        qzr = to_index_flat(std::move(qzr));
+        // replace quantizer with a regular IndexFlat, or with a graph over its centroids
+        auto coarse_qzr = to_coarse_quantizer(std::move(qzr), ivf_cfg);
         // transfer ownership of qzr to index
-        index->quantizer = qzr.release();
+        index->quantizer = coarse_qzr.release();
         index->own_fields = true;
     }
     if constexpr (std::is_same<faiss::IndexIVFFlatCC, IndexType>::value) {
@@ -549,11 +805,12 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
         index = std::make_unique<faiss::IndexIVFFlatCC>(qzr.get(), dim, nlist, ivf_flat_cc_cfg.ssize.value(),
                                                         metric.value(), is_cosine);
         // train
+        train_balanced_quantizer(qzr.get(), rows, (const float*)data, nlist, index->cp, ivf_cfg);
         index->train(rows, (const float*)data);
-        // replace quantizer with a regular IndexFlat
-        qzr = to_index_flat(std::move(qzr));
+        // replace quantizer with a regular IndexFlat, or with a graph over its centroids
+        auto coarse_qzr = to_coarse_quantizer(std::move(qzr), ivf_cfg);
         // transfer ownership of qzr to index
-        index->quantizer = qzr.release();
+        index->quantizer = coarse_qzr.release();
         index->own_fields = true;
         // ivfflat_cc has no serialize stage, make map at build stage
         index->make_direct_map(true, faiss::DirectMap::ConcurrentArray);
@@ -571,11 +828,12 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
         // create index. Index does not own qzr
         index = std::make_unique<faiss::IndexIVFPQ>(qzr.get(), dim, nlist, ivf_pq_cfg.m.value(), nbits, metric.value());
         // train
+        train_balanced_quantizer(qzr.get(), rows, (const float*)data, nlist, index->cp, ivf_cfg);
         index->train(rows, (const float*)data);
-        // replace quantizer with a regular IndexFlat
-        qzr = to_index_flat(std::move(qzr));
+        // replace quantizer with a regular IndexFlat, or with a graph over its centroids
+        auto coarse_qzr = to_coarse_quantizer(std::move(qzr), ivf_cfg);
         // transfer ownership of qzr to index
-        index->quantizer = qzr.release();
+        index->quantizer = coarse_qzr.release();
         index->own_fields = true;
     }
     if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value) {
@@ -595,16 +853,30 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
         //    but owns the refine index by default omg
         if (scann_cfg.with_raw_data.value()) {
             index = std::make_unique<faiss::IndexScaNN>(base_index.get(), (const float*)data);
+            // keep the refine data in a reduced precision if asked to
+            auto is_fp32_refine = is_flat_refine(scann_cfg.refine_type);
+            if (!is_fp32_refine.has_value()) {
+                return is_fp32_refine.error();
+            }
+            if (!is_fp32_refine.value()) {
+                auto sq_type = get_sq_quantizer_type(scann_cfg.refine_type.value());
+                if (!sq_type.has_value()) {
+                    return sq_type.error();
+                }
+                delete index->refine_index;
+                index->refine_index = new faiss::IndexScalarQuantizer(dim, sq_type.value(), metric.value());
+            }
         } else {
             index = std::make_unique<faiss::IndexScaNN>(base_index.get(), nullptr);
         }
         // train
+        train_balanced_quantizer(qzr.get(), rows, (const float*)data, nlist, base_index->cp, ivf_cfg);
         index->train(rows, (const float*)data);
         // at this moment, we still own qzr.
-        // replace quantizer with a regular IndexFlat
-        qzr = to_index_flat(std::move(qzr));
+        // replace quantizer with a regular IndexFlat, or with a graph over its centroids
+        auto coarse_qzr = to_coarse_quantizer(std::move(qzr), ivf_cfg);
         // release qzr
-        base_index->quantizer = qzr.release();
+        base_index->quantizer = coarse_qzr.release();
         base_index->own_fields = true;
         // transfer ownership of the base index
         base_index.release();
@@ -623,11 +895,12 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
         index = std::make_unique<faiss::IndexIVFScalarQuantizer>(
             qzr.get(), dim, nlist, faiss::ScalarQuantizer::QuantizerType::QT_8bit, metric.value());
         // train
+        train_balanced_quantizer(qzr.get(), rows, (const float*)data, nlist, index->cp, ivf_cfg);
         index->train(rows, (const float*)data);
-        // replace quantizer with a regular IndexFlat
-        qzr = to_index_flat(std::move(qzr));
+        // replace quantizer with a regular IndexFlat, or with a graph over its centroids
+        auto coarse_qzr = to_coarse_quantizer(std::move(qzr), ivf_cfg);
         // transfer ownership of qzr to index
-        index->quantizer = qzr.release();
+        index->quantizer = coarse_qzr.release();
         index->own_fields = true;
     }
     if constexpr (std::is_same<faiss::IndexBinaryIVF, IndexType>::value) {
@@ -664,11 +937,12 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
                                                                    metric.value(), is_cosine, false,
                                                                    ivf_sq_cc_cfg.raw_data_store_prefix);
         // train
+        train_balanced_quantizer(qzr.get(), rows, (const float*)data, nlist, index->cp, ivf_cfg);
         index->train(rows, (const float*)data);
-        // replace quantizer with a regular IndexFlat
-        qzr = to_index_flat(std::move(qzr));
+        // replace quantizer with a regular IndexFlat, or with a graph over its centroids
+        auto coarse_qzr = to_coarse_quantizer(std::move(qzr), ivf_cfg);
         // transfer ownership of qzr to index
-        index->quantizer = qzr.release();
+        index->quantizer = coarse_qzr.release();
         index->own_fields = true;
         index->make_direct_map(true, faiss::DirectMap::ConcurrentArray);
     }
@@ -686,6 +960,20 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, std::
         index = std::move(result.value());
         index->train(rows, (const float*)data);
     }
+    if constexpr (std::is_same<IndexIVFPQFastScanWrapper, IndexType>::value) {
+        const IvfPqFastScanConfig& ivf_pq_fast_scan_cfg = static_cast<const IvfPqFastScanConfig&>(*cfg);
+        auto nlist = MatchNlist(rows, ivf_pq_fast_scan_cfg.nlist.value());
+
+        DataFormatEnum data_format = DataType2EnumHelper<DataType>::value;
+
+        auto result = IndexIVFPQFastScanWrapper::create(dim, nlist, ivf_pq_fast_scan_cfg, data_format, metric.value());
+        if (!result.has_value()) {
+            return result.error();
+        }
+
+        index = std::move(result.value());
+        index->train(rows, (const float*)data);
+    }
     index_ = std::move(index);
 
     return Status::success;
@@ -730,8 +1018,8 @@ IvfIndexNode<DataType, IndexType>::Add(const DataSetPtr dataset, std::shared_ptr
 
 template <typename DataType, typename IndexType>
 expected<DataSetPtr>
-IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
-                                          const BitsetView& bitset) const {
+IvfIndexNode<DataType, IndexType>::SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
+                                                 const BitsetView& bitset, int64_t* ids, float* distances) const {
     if (!this->index_) {
         LOG_KNOWHERE_WARNING_ << "search on empty index";
         return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
@@ -750,159 +1038,520 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, std::unique_
 
     auto k = ivf_cfg.k.value();
     auto nprobe = ivf_cfg.nprobe.value();
+    // the bound on the distance to a list only holds for the L2 distance and for normalized inner products
+    const float adaptive_nprobe_ratio =
+        (IsMetricType(ivf_cfg.metric_type.value(), knowhere::metric::L2) || is_cosine)
+            ? ivf_cfg.adaptive_nprobe_ratio.value_or(0.0f)
+            : 0.0f;
+
+    // nprobe counts the lists that hold unfiltered vectors, up to probe_ceiling lists are ranked to find them
+    int64_t probe_ceiling = nprobe;
+    if constexpr (std::is_base_of_v<faiss::IndexIVF, IndexType>) {
+        if (const float filter_ratio = bitset.filter_ratio(); filter_ratio >= kIvfFilteredProbeMinFilterRatio) {
+            const int64_t nlist = index_->nlist;
+            probe_ceiling =
+                filter_ratio < 1.0f ? static_cast<int64_t>(std::ceil(nprobe / (1.0f - filter_ratio))) : nlist;
+            probe_ceiling = std::min(std::max<int64_t>(probe_ceiling, nprobe), nlist);
+        }
+    }
 
-    auto ids = std::make_unique<int64_t[]>(rows * k);
-    auto distances = std::make_unique<float[]>(rows * k);
-    try {
-        std::vector<folly::Future<folly::Unit>> futs;
-        futs.reserve(rows);
-        for (int i = 0; i < rows; ++i) {
-            futs.emplace_back(search_pool_->push([&, index = i] {
-                ThreadPool::ScopedSearchOmpSetter setter(1);
-                auto offset = k * index;
-                std::unique_ptr<float[]> copied_query = nullptr;
+    // IVF_SQ may score its codes against the queries quantized to int8
+    bool quantized_query = false;
+    if constexpr (std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizer>) {
+        quantized_query = static_cast<const IvfSqConfig&>(*cfg).quantized_query.value_or(false);
+    }
 
-                BitsetViewIDSelector bw_idselector(bitset);
-                faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+    // the lists scanned and the distances computed by the faiss search of each query, which counts them into the
+    // stats of its parameters
+    SearchStats search_stats(ivf_cfg.search_stats.value() ? rows : 0);
+    QuerySearchStats* const stats = search_stats.empty() ? nullptr : search_stats.data();
+
+    // the queries alone would leave most of the search pool idle, split their probed lists across the threads
+    if constexpr (is_intra_query_search_supported()) {
+        const bool ensure_topk_full = ivf_cfg.ensure_topk_full.value_or(false) &&
+                                      (std::is_same_v<IndexType, faiss::IndexIVFFlatCC> ||
+                                       std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizerCC>);
+        const int64_t n_probed = std::min<int64_t>(nprobe, index_->nlist);
+        const int64_t tasks_per_query = std::min<int64_t>(std::max<int64_t>(search_pool_->size(), 1) / rows,
+                                                          n_probed / kIvfIntraQueryMinListsPerTask);
+        // the lists are skipped against the k-th result of the whole query, which a task does not see
+        if (!ensure_topk_full && adaptive_nprobe_ratio == 0.0f && probe_ceiling == nprobe &&
+            tasks_per_query >= kIvfIntraQueryMinThreadsPerQuery) {
+            try {
+                SearchSplitLists((const float*)data, rows, k, n_probed, ivf_cfg.quantizer_ef.value(),
+                                 tasks_per_query, is_cosine, quantized_query, bitset, distances, ids, stats);
+            } catch (const std::exception& e) {
+                LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+                return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+            }
+            auto res = GenResultDataSet(rows, k, ids, distances);
+            res->SetIsOwner(false);
+            if (stats != nullptr) {
+                res->SetSearchStats(std::move(search_stats));
+            }
+            return res;
+        }
+    }
 
-                if constexpr (std::is_same<IndexType, faiss::IndexBinaryIVF>::value) {
-                    auto cur_data = (const uint8_t*)data + index * ((dim + 7) / 8);
+    // the batches whose queries share most of their probed lists read every list once per block of queries
+    if constexpr (is_list_major_search_supported()) {
+        const int64_t n_probed = std::min<int64_t>(nprobe, index_->nlist);
+        const int64_t block_rows = std::clamp<int64_t>(rows / std::max<int64_t>(search_pool_->size(), 1),
+                                                       kIvfListMajorMinBlockRows, kIvfListMajorMaxBlockRows);
+        if (adaptive_nprobe_ratio == 0.0f && probe_ceiling == nprobe && !index_->invlists->use_iterator &&
+            rows >= kIvfListMajorMinBlockRows &&
+            std::min(rows, block_rows) * n_probed >= kIvfListMajorMinQueriesPerList * index_->nlist) {
+            try {
+                SearchListMajor((const float*)data, rows, k, n_probed, ivf_cfg.quantizer_ef.value(), block_rows,
+                                is_cosine, quantized_query, bitset, distances, ids, stats);
+            } catch (const std::exception& e) {
+                LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+                return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+            }
+            auto res = GenResultDataSet(rows, k, ids, distances);
+            res->SetIsOwner(false);
+            if (stats != nullptr) {
+                res->SetSearchStats(std::move(search_stats));
+            }
+            return res;
+        }
+    }
 
-                    int32_t* i_distances = reinterpret_cast<int32_t*>(distances.get());
+    // a query scans its probed lists, the queries on small lists are batched into the tasks
+    size_t query_cost = static_cast<size_t>(index_->ntotal) * dim;
+    if constexpr (std::is_base_of_v<faiss::IndexIVF, IndexType>) {
+        query_cost = static_cast<size_t>(probe_ceiling) * index_->ntotal / std::max<size_t>(index_->nlist, 1) * dim;
+    }
 
-                    faiss::IVFSearchParameters ivf_search_params;
-                    ivf_search_params.nprobe = nprobe;
-                    ivf_search_params.sel = id_selector;
-                    index_->search(1, cur_data, k, i_distances + offset, ids.get() + offset, &ivf_search_params);
+    try {
+        auto search_query = [&](const int64_t index) {
+            auto offset = k * index;
+            SearchWorkspace::Scope workspace;
+            faiss::IndexIVFStats ivf_stats;
+            faiss::IndexIVFStats* const ivf_stats_ptr = (stats == nullptr) ? nullptr : &ivf_stats;
+            // the candidates reranked by the refine of the index, if any
+            uint64_t refine_candidates = 0;
+            // faiss assigns the query to its lists within the scan
+            ScopedSearchStage stage(SearchStage::LIST_SCAN);
+
+            BitsetViewIDSelector bw_idselector(bitset);
+            faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
 
-                    if (index_->metric_type == faiss::METRIC_Hamming) {
-                        // this is an in-place conversion int32_t -> float
-                        for (int64_t i = 0; i < k; i++) {
-                            distances[i + offset] = static_cast<float>(i_distances[i + offset]);
-                        }
-                    }
-                } else if constexpr (std::is_same<IndexType, faiss::IndexIVFFlatCC>::value ||
-                                     std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value) {
-                    auto cur_query = (const float*)data + index * dim;
-                    if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
-                    }
+            if constexpr (std::is_same<IndexType, faiss::IndexBinaryIVF>::value) {
+                auto cur_data = (const uint8_t*)data + index * ((dim + 7) / 8);
 
-                    faiss::IVFSearchParameters ivf_search_params;
+                int32_t* i_distances = reinterpret_cast<int32_t*>(distances);
 
-                    ivf_search_params.sel = id_selector;
-                    ivf_search_params.ensure_topk_full = ivf_cfg.ensure_topk_full.value();
-                    if (ivf_search_params.ensure_topk_full) {
-                        ivf_search_params.nprobe = index_->nlist;
-                        // use max_codes to early termination
-                        ivf_search_params.max_codes =
-                            (nprobe * 1.0 / index_->nlist) * (index_->ntotal - bitset.count());
-                    } else {
-                        ivf_search_params.nprobe = nprobe;
-                        ivf_search_params.max_codes = 0;
-                    }
+                faiss::IVFSearchParameters ivf_search_params;
+                ivf_search_params.nprobe = nprobe;
+                ivf_search_params.sel = id_selector;
+                ivf_search_params.stats = ivf_stats_ptr;
+                index_->search(1, cur_data, k, i_distances + offset, ids + offset, &ivf_search_params);
 
-                    index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset, &ivf_search_params);
-                } else if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
-                    auto cur_query = (const float*)data + index * dim;
-                    const ScannConfig& scann_cfg = static_cast<const ScannConfig&>(*cfg);
-                    if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
+                if (index_->metric_type == faiss::METRIC_Hamming) {
+                    // this is an in-place conversion int32_t -> float
+                    for (int64_t i = 0; i < k; i++) {
+                        distances[i + offset] = static_cast<float>(i_distances[i + offset]);
                     }
+                }
+            } else if constexpr (std::is_same<IndexType, faiss::IndexIVFFlatCC>::value ||
+                                 std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value) {
+                auto cur_query = (const float*)data + index * dim;
+                if (is_cosine) {
+                    cur_query = NormalizedQuery(workspace, cur_query, dim);
+                }
 
-                    // todo aguzhva: this is somewhat alogical. Refactor?
-                    faiss::IVFSearchParameters base_search_params;
-                    base_search_params.sel = id_selector;
-                    base_search_params.nprobe = nprobe;
-                    base_search_params.ensure_topk_full = scann_cfg.ensure_topk_full.value();
-                    if (base_search_params.ensure_topk_full) {
-                        if (auto base_index_ptr = reinterpret_cast<faiss::IndexIVFPQFastScan*>(index_->base_index)) {
-                            auto nlist = base_index_ptr->nlist;
-                            base_search_params.nprobe = nlist;
-                            // use max_codes to early termination
-                            base_search_params.max_codes = (nprobe * 1.0 / nlist) * (index_->ntotal - bitset.count());
-                            base_search_params.max_lists_num = nprobe;
-                        } else {
-                            throw std::runtime_error("invalid base index type of scann base index");
-                        }
+                faiss::IVFSearchParameters ivf_search_params;
+
+                ivf_search_params.sel = id_selector;
+                ivf_search_params.ensure_topk_full = ivf_cfg.ensure_topk_full.value();
+                if (ivf_search_params.ensure_topk_full) {
+                    ivf_search_params.nprobe = index_->nlist;
+                    // use max_codes to early termination
+                    ivf_search_params.max_codes = (nprobe * 1.0 / index_->nlist) * (index_->ntotal - bitset.count());
+                } else {
+                    ivf_search_params.nprobe = probe_ceiling;
+                    ivf_search_params.max_lists_num = nprobe;
+                    ivf_search_params.max_codes = 0;
+                }
+                ivf_search_params.adaptive_nprobe_ratio = adaptive_nprobe_ratio;
+                ivf_search_params.stats = ivf_stats_ptr;
+                faiss::SearchParametersHNSW quantizer_params;
+                SetGraphQuantizerParams(index_->quantizer, ivf_cfg.quantizer_ef.value(), quantizer_params,
+                                        ivf_search_params);
+
+                index_->search(1, cur_query, k, distances + offset, ids + offset, &ivf_search_params);
+            } else if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
+                auto cur_query = (const float*)data + index * dim;
+                const ScannConfig& scann_cfg = static_cast<const ScannConfig&>(*cfg);
+                if (is_cosine) {
+                    cur_query = NormalizedQuery(workspace, cur_query, dim);
+                }
+
+                // todo aguzhva: this is somewhat alogical. Refactor?
+                faiss::IVFSearchParameters base_search_params;
+                base_search_params.sel = id_selector;
+                base_search_params.nprobe = nprobe;
+                base_search_params.ensure_topk_full = scann_cfg.ensure_topk_full.value();
+                if (base_search_params.ensure_topk_full) {
+                    if (auto base_index_ptr = reinterpret_cast<faiss::IndexIVFPQFastScan*>(index_->base_index)) {
+                        auto nlist = base_index_ptr->nlist;
+                        base_search_params.nprobe = nlist;
+                        // use max_codes to early termination
+                        base_search_params.max_codes = (nprobe * 1.0 / nlist) * (index_->ntotal - bitset.count());
+                        base_search_params.max_lists_num = nprobe;
                     } else {
-                        base_search_params.nprobe = nprobe;
-                        base_search_params.max_codes = 0;
+                        throw std::runtime_error("invalid base index type of scann base index");
                     }
+                } else {
+                    base_search_params.nprobe = nprobe;
+                    base_search_params.max_codes = 0;
+                }
+                base_search_params.stats = ivf_stats_ptr;
+                faiss::SearchParametersHNSW quantizer_params;
+                SetGraphQuantizerParams(CoarseQuantizer(index_.get()), ivf_cfg.quantizer_ef.value(),
+                                        quantizer_params, base_search_params);
+
+                faiss::IndexScaNNSearchParameters scann_search_params;
+                scann_search_params.base_index_params = &base_search_params;
+                scann_search_params.reorder_k = scann_cfg.reorder_k.value();
+                if (index_->refine_index != nullptr) {
+                    refine_candidates = scann_search_params.reorder_k;
+                }
 
-                    faiss::IndexScaNNSearchParameters scann_search_params;
-                    scann_search_params.base_index_params = &base_search_params;
-                    scann_search_params.reorder_k = scann_cfg.reorder_k.value();
+                index_->search(1, cur_query, k, distances + offset, ids + offset, &scann_search_params);
+            } else if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
+                auto cur_query = (const float*)data + index * dim;
+                if (is_cosine) {
+                    cur_query = NormalizedQuery(workspace, cur_query, dim);
+                }
 
-                    index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset, &scann_search_params);
-                } else if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
-                    auto cur_query = (const float*)data + index * dim;
-                    if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
-                    }
+                const IvfRaBitQConfig& ivf_rabitq_cfg = static_cast<const IvfRaBitQConfig&>(*cfg);
 
-                    const IvfRaBitQConfig& ivf_rabitq_cfg = static_cast<const IvfRaBitQConfig&>(*cfg);
+                // use refine?
+                bool use_refine = false;
 
-                    // use refine?
-                    bool use_refine = false;
+                const bool whether_to_enable_refine = ivf_rabitq_cfg.refine_k.has_value();
+                if (const auto wrapper_index = dynamic_cast<const IndexIVFRaBitQWrapper*>(index_.get());
+                    wrapper_index != nullptr) {
+                    const faiss::IndexRefine* refine_index = wrapper_index->get_refine_index();
+                    use_refine = (refine_index != nullptr);
+                }
 
-                    const bool whether_to_enable_refine = ivf_rabitq_cfg.refine_k.has_value();
-                    if (const auto wrapper_index = dynamic_cast<const IndexIVFRaBitQWrapper*>(index_.get());
-                        wrapper_index != nullptr) {
-                        const faiss::IndexRefine* refine_index = wrapper_index->get_refine_index();
-                        use_refine = (refine_index != nullptr);
-                    }
+                faiss::IVFRaBitQSearchParameters ivf_search_params;
+                ivf_search_params.nprobe = nprobe;
+                ivf_search_params.max_codes = 0;
+                ivf_search_params.sel = id_selector;
+                ivf_search_params.qb = ivf_rabitq_cfg.rbq_bits_query.value_or(0);
+                ivf_search_params.stats = ivf_stats_ptr;
+
+                if (use_refine && whether_to_enable_refine) {
+                    // yes, use refine
+                    faiss::IndexRefineSearchParameters refine_search_params;
+                    refine_search_params.sel = id_selector;
+                    refine_search_params.k_factor = ivf_rabitq_cfg.refine_k.value_or(1);
+                    refine_search_params.base_index_params = &ivf_search_params;
+                    refine_candidates = k * refine_search_params.k_factor;
+
+                    index_->search(1, cur_query, k, distances + offset, ids + offset, &refine_search_params);
+                } else {
+                    // do not use refine
+                    index_->search(1, cur_query, k, distances + offset, ids + offset, &ivf_search_params);
+                }
+            } else if constexpr (std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+                auto cur_query = (const float*)data + index * dim;
+                if (is_cosine) {
+                    cur_query = NormalizedQuery(workspace, cur_query, dim);
+                }
 
-                    faiss::IVFRaBitQSearchParameters ivf_search_params;
-                    ivf_search_params.nprobe = nprobe;
-                    ivf_search_params.max_codes = 0;
-                    ivf_search_params.sel = id_selector;
-                    ivf_search_params.qb = ivf_rabitq_cfg.rbq_bits_query.value_or(0);
+                const IvfPqFastScanConfig& ivf_pq_fast_scan_cfg = static_cast<const IvfPqFastScanConfig&>(*cfg);
 
-                    if (use_refine && whether_to_enable_refine) {
-                        // yes, use refine
-                        faiss::IndexRefineSearchParameters refine_search_params;
-                        refine_search_params.sel = id_selector;
-                        refine_search_params.k_factor = ivf_rabitq_cfg.refine_k.value_or(1);
-                        refine_search_params.base_index_params = &ivf_search_params;
+                faiss::IVFSearchParameters ivf_search_params;
+                ivf_search_params.nprobe = nprobe;
+                ivf_search_params.max_codes = 0;
+                ivf_search_params.sel = id_selector;
+                ivf_search_params.stats = ivf_stats_ptr;
 
-                        index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset,
-                                       &refine_search_params);
-                    } else {
-                        // do not use refine
-                        index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset,
-                                       &ivf_search_params);
-                    }
-                } else {
-                    auto cur_query = (const float*)data + index * dim;
-                    if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
-                    }
+                // the refine is used only if the index was built with it and refine_k is provided
+                if (index_->get_refine_index() != nullptr && ivf_pq_fast_scan_cfg.refine_k.has_value()) {
+                    faiss::IndexRefineSearchParameters refine_search_params;
+                    refine_search_params.sel = id_selector;
+                    refine_search_params.k_factor = ivf_pq_fast_scan_cfg.refine_k.value();
+                    refine_search_params.base_index_params = &ivf_search_params;
+                    refine_candidates = k * refine_search_params.k_factor;
 
-                    faiss::IVFSearchParameters ivf_search_params;
-                    ivf_search_params.nprobe = nprobe;
-                    ivf_search_params.max_codes = 0;
-                    ivf_search_params.sel = id_selector;
+                    index_->search(1, cur_query, k, distances + offset, ids + offset, &refine_search_params);
+                } else {
+                    index_->search(1, cur_query, k, distances + offset, ids + offset, &ivf_search_params);
+                }
+            } else {
+                auto cur_query = (const float*)data + index * dim;
+                if (is_cosine) {
+                    cur_query = NormalizedQuery(workspace, cur_query, dim);
+                }
 
-                    index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset, &ivf_search_params);
+                faiss::IVFScalarQuantizerSearchParameters ivf_search_params;
+                ivf_search_params.nprobe = probe_ceiling;
+                ivf_search_params.max_lists_num = nprobe;
+                ivf_search_params.max_codes = 0;
+                ivf_search_params.sel = id_selector;
+                ivf_search_params.adaptive_nprobe_ratio = adaptive_nprobe_ratio;
+                ivf_search_params.quantized_query = quantized_query;
+                ivf_search_params.stats = ivf_stats_ptr;
+                faiss::SearchParametersHNSW quantizer_params;
+                SetGraphQuantizerParams(CoarseQuantizer(index_.get()), ivf_cfg.quantizer_ef.value(),
+                                        quantizer_params, ivf_search_params);
+
+                index_->search(1, cur_query, k, distances + offset, ids + offset, &ivf_search_params);
+            }
+            if (stats != nullptr) {
+                stats[index].lists_probed = ivf_stats.nlist;
+                stats[index].distance_computations = ivf_stats.ndis + refine_candidates;
+                stats[index].refine_candidates = refine_candidates;
+            }
+        };
+        ParallelForOverSearchThreadPool(
+            rows, query_cost,
+            [&](size_t begin, size_t end) {
+                for (auto i = begin; i < end; ++i) {
+                    search_query(i);
                 }
-            }));
-        }
-        // wait for the completion
-        WaitAllSuccess(futs);
+            },
+            [&](size_t begin, size_t end) { MarkMissingResults(ids, distances, k, begin, end); });
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
     }
 
-    auto res = GenResultDataSet(rows, k, std::move(ids), std::move(distances));
+    auto res = GenResultDataSet(rows, k, ids, distances);
+    res->SetIsOwner(false);
+    if (stats != nullptr) {
+        res->SetSearchStats(std::move(search_stats));
+    }
     return res;
 }
 
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::SearchSplitLists(const float* queries, const int64_t rows, const int64_t k,
+                                                    const int64_t nprobe, const int64_t quantizer_ef,
+                                                    const int64_t tasks_per_query, const bool is_cosine,
+                                                    const bool quantized_query, const BitsetView& bitset,
+                                                    float* distances, int64_t* ids, QuerySearchStats* stats) const {
+    const auto dim = index_->d;
+    BitsetViewIDSelector bw_idselector(bitset);
+    faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+
+    // the queries are normalized and assigned to their lists once, then each task scans a contiguous range of them.
+    // The buffers come from the workspace of the calling thread, which waits for the tasks reading them.
+    SearchWorkspace::Scope workspace;
+    if (is_cosine) {
+        auto copied_queries = workspace.Alloc<float>(rows * dim);
+        std::copy_n(queries, rows * dim, copied_queries);
+        NormalizeVecs(copied_queries, rows, dim);
+        queries = copied_queries;
+    }
+    auto list_ids = workspace.Alloc<faiss::idx_t>(rows * nprobe);
+    auto list_distances = workspace.Alloc<float>(rows * nprobe);
+    {
+        ThreadPool::ScopedSearchOmpSetter setter(1);
+        ScopedSearchStage stage(SearchStage::COARSE_QUANTIZATION);
+        faiss::IVFSearchParameters coarse_params;
+        faiss::SearchParametersHNSW quantizer_params;
+        SetGraphQuantizerParams(index_->quantizer, quantizer_ef, quantizer_params, coarse_params);
+        index_->quantizer->search(rows, queries, nprobe, list_distances, list_ids, coarse_params.quantizer_params);
+    }
+    index_->invlists->prefetch_lists(list_ids, rows * nprobe);
+
+    // the results of the task t of the query q start at (t * rows + q) * k, as expected by merge_knn_results()
+    auto task_distances = workspace.Alloc<float>(tasks_per_query * rows * k);
+    auto task_ids = workspace.Alloc<faiss::idx_t>(tasks_per_query * rows * k);
+    std::vector<faiss::IndexIVFStats> task_stats(stats == nullptr ? 0 : tasks_per_query * rows);
+    std::vector<folly::Future<folly::Unit>> futs;
+    futs.reserve(rows * tasks_per_query);
+    for (int64_t q = 0; q < rows; ++q) {
+        for (int64_t t = 0; t < tasks_per_query; ++t) {
+            futs.emplace_back(PushSearchTask(search_pool_, [&, q, t] {
+                if (SearchInterrupted()) {
+                    return;
+                }
+                ThreadPool::ScopedSearchOmpSetter setter(1);
+                const int64_t list_begin = nprobe * t / tasks_per_query;
+                const int64_t list_end = nprobe * (t + 1) / tasks_per_query;
+
+                faiss::IVFScalarQuantizerSearchParameters ivf_search_params;
+                ivf_search_params.nprobe = list_end - list_begin;
+                ivf_search_params.max_codes = 0;
+                ivf_search_params.sel = id_selector;
+                ivf_search_params.quantized_query = quantized_query;
+
+                const int64_t offset = (t * rows + q) * k;
+                ScopedSearchStage stage(SearchStage::LIST_SCAN);
+                index_->search_preassigned(1, queries + q * dim, k, list_ids + q * nprobe + list_begin,
+                                           list_distances + q * nprobe + list_begin, task_distances + offset,
+                                           task_ids + offset, false, &ivf_search_params,
+                                           task_stats.empty() ? nullptr : &task_stats[t * rows + q]);
+            }));
+        }
+    }
+    WaitAllSuccess(futs);
+    for (size_t i = 0; i < task_stats.size(); ++i) {
+        stats[i % rows].lists_probed += task_stats[i].nlist;
+        stats[i % rows].distance_computations += task_stats[i].ndis;
+    }
+
+    ThreadPool::ScopedSearchOmpSetter setter(1);
+    ScopedSearchStage stage(SearchStage::RESULT_ASSEMBLY);
+    if (faiss::is_similarity_metric(index_->metric_type)) {
+        faiss::merge_knn_results<faiss::idx_t, faiss::CMax<float, int>>(
+            rows, k, tasks_per_query, task_distances, task_ids, distances, ids);
+    } else {
+        faiss::merge_knn_results<faiss::idx_t, faiss::CMin<float, int>>(
+            rows, k, tasks_per_query, task_distances, task_ids, distances, ids);
+    }
+    // the skipped tasks left garbage behind, none of the merged results can be trusted
+    if (SearchInterrupted()) {
+        MarkMissingResults(ids, distances, k, 0, rows);
+    }
+}
+
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::SearchListMajor(const float* queries, const int64_t rows, const int64_t k,
+                                                   const int64_t nprobe, const int64_t quantizer_ef,
+                                                   const int64_t block_rows, const bool is_cosine,
+                                                   const bool quantized_query, const BitsetView& bitset,
+                                                   float* distances, int64_t* ids, QuerySearchStats* stats) const {
+    const auto dim = index_->d;
+    const int64_t nlist = index_->nlist;
+    const faiss::InvertedLists* invlists = index_->invlists;
+    BitsetViewIDSelector bw_idselector(bitset);
+    faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+
+    // the queries are normalized and assigned to their lists once, the same way as by SearchSplitLists()
+    SearchWorkspace::Scope workspace;
+    if (is_cosine) {
+        auto copied_queries = workspace.Alloc<float>(rows * dim);
+        std::copy_n(queries, rows * dim, copied_queries);
+        NormalizeVecs(copied_queries, rows, dim);
+        queries = copied_queries;
+    }
+    auto list_ids = workspace.Alloc<faiss::idx_t>(rows * nprobe);
+    auto list_distances = workspace.Alloc<float>(rows * nprobe);
+    {
+        ThreadPool::ScopedSearchOmpSetter setter(1);
+        ScopedSearchStage stage(SearchStage::COARSE_QUANTIZATION);
+        faiss::IVFSearchParameters coarse_params;
+        faiss::SearchParametersHNSW quantizer_params;
+        SetGraphQuantizerParams(index_->quantizer, quantizer_ef, quantizer_params, coarse_params);
+        index_->quantizer->search(rows, queries, nprobe, list_distances, list_ids, coarse_params.quantizer_params);
+    }
+    invlists->prefetch_lists(list_ids, rows * nprobe);
+
+    faiss::IVFScalarQuantizerSearchParameters scan_params;
+    scan_params.quantized_query = quantized_query;
+    const bool keep_max = faiss::is_similarity_metric(index_->metric_type);
+    const size_t code_size = invlists->code_size;
+    const size_t chunk_rows = std::max<size_t>(1, kIvfListMajorChunkBytes / code_size);
+    const int64_t n_blocks = (rows + block_rows - 1) / block_rows;
+    const size_t block_cost = block_rows * nprobe * (index_->ntotal / std::max<int64_t>(nlist, 1) + 1) * dim;
+
+    auto search_block = [&](const int64_t q_begin, const int64_t q_end) {
+        ThreadPool::ScopedSearchOmpSetter setter(1);
+        ScopedSearchStage stage(SearchStage::LIST_SCAN);
+        const int64_t nq = q_end - q_begin;
+
+        // the (query, probe) pairs of the block grouped by list
+        std::vector<int64_t> list_offsets(nlist + 1, 0);
+        for (int64_t i = q_begin * nprobe; i < q_end * nprobe; ++i) {
+            if (list_ids[i] >= 0) {
+                list_offsets[list_ids[i] + 1]++;
+            }
+        }
+        std::partial_sum(list_offsets.begin(), list_offsets.end(), list_offsets.begin());
+        std::vector<int64_t> probes(list_offsets[nlist]);
+        {
+            std::vector<int64_t> cursors(list_offsets.begin(), list_offsets.end() - 1);
+            for (int64_t i = q_begin * nprobe; i < q_end * nprobe; ++i) {
+                if (list_ids[i] >= 0) {
+                    probes[cursors[list_ids[i]]++] = i;
+                }
+            }
+        }
+
+        // a scanner and a heap per query
+        std::vector<std::unique_ptr<faiss::InvertedListScanner>> scanners(nq);
+        for (int64_t q = 0; q < nq; ++q) {
+            scanners[q].reset(index_->get_InvertedListScanner(false, id_selector, &scan_params));
+            scanners[q]->set_query(queries + (q_begin + q) * dim);
+            if (keep_max) {
+                faiss::heap_heapify<faiss::CMin<float, faiss::idx_t>>(k, distances + (q_begin + q) * k,
+                                                                      ids + (q_begin + q) * k);
+            } else {
+                faiss::heap_heapify<faiss::CMax<float, faiss::idx_t>>(k, distances + (q_begin + q) * k,
+                                                                      ids + (q_begin + q) * k);
+            }
+        }
+
+        for (int64_t list_no = 0; list_no < nlist; ++list_no) {
+            const int64_t probe_begin = list_offsets[list_no];
+            const int64_t probe_end = list_offsets[list_no + 1];
+            if (probe_begin == probe_end || invlists->is_empty(list_no)) {
+                continue;
+            }
+            for (int64_t p = probe_begin; p < probe_end; ++p) {
+                const int64_t q = probes[p] / nprobe - q_begin;
+                scanners[q]->set_list(list_no, list_distances[probes[p]]);
+                if (stats != nullptr) {
+                    stats[q_begin + q].lists_probed++;
+                }
+            }
+            const size_t segment_num = invlists->get_segment_num(list_no);
+            for (size_t segment_idx = 0; segment_idx < segment_num; ++segment_idx) {
+                const size_t segment_size = invlists->get_segment_size(list_no, segment_idx);
+                const size_t segment_offset = invlists->get_segment_offset(list_no, segment_idx);
+                faiss::InvertedLists::ScopedCodes scodes(invlists, list_no, segment_offset);
+                faiss::InvertedLists::ScopedCodeNorms scode_norms(invlists, list_no, segment_offset);
+                faiss::InvertedLists::ScopedIds sids(invlists, list_no, segment_offset);
+                const float* code_norms = scode_norms.get();
+                for (size_t offset = 0; offset < segment_size; offset += chunk_rows) {
+                    const size_t n = std::min(chunk_rows, segment_size - offset);
+                    for (int64_t p = probe_begin; p < probe_end; ++p) {
+                        const int64_t q = probes[p] / nprobe - q_begin;
+                        size_t scan_cnt = 0;
+                        scanners[q]->scan_codes(n, scodes.get() + offset * code_size,
+                                                code_norms == nullptr ? nullptr : code_norms + offset,
+                                                sids.get() + offset, distances + (q_begin + q) * k,
+                                                ids + (q_begin + q) * k, k, scan_cnt);
+                        if (stats != nullptr) {
+                            stats[q_begin + q].distance_computations += scan_cnt;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int64_t q = q_begin; q < q_end; ++q) {
+            if (keep_max) {
+                faiss::heap_reorder<faiss::CMin<float, faiss::idx_t>>(k, distances + q * k, ids + q * k);
+            } else {
+                faiss::heap_reorder<faiss::CMax<float, faiss::idx_t>>(k, distances + q * k, ids + q * k);
+            }
+        }
+    };
+
+    ParallelForOverSearchThreadPool(
+        n_blocks, block_cost,
+        [&](size_t begin, size_t end) {
+            for (auto b = begin; b < end; ++b) {
+                search_block(b * block_rows, std::min<int64_t>((b + 1) * block_rows, rows));
+            }
+        },
+        [&](size_t begin, size_t end) {
+            MarkMissingResults(ids, distances, k, begin * block_rows, std::min<int64_t>(end * block_rows, rows));
+        });
+}
+
 template <typename DataType, typename IndexType>
 expected<DataSetPtr>
 IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg,
@@ -941,10 +1590,10 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::un
         std::vector<folly::Future<folly::Unit>> futs;
         futs.reserve(nq);
         for (int i = 0; i < nq; ++i) {
-            futs.emplace_back(search_pool_->push([&, index = i] {
+            futs.emplace_back(PushSearchTask(search_pool_, [&, index = i] {
                 ThreadPool::ScopedSearchOmpSetter setter(1);
                 faiss::RangeSearchResult res(1);
-                std::unique_ptr<float[]> copied_query = nullptr;
+                SearchWorkspace::Scope workspace;
 
                 BitsetViewIDSelector bw_idselector(bitset);
                 faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
@@ -961,8 +1610,7 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::un
                 } else if constexpr (std::is_same<IndexType, faiss::IndexIVFFlat>::value) {
                     auto cur_query = (const float*)xq + index * dim;
                     if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
+                        cur_query = NormalizedQuery(workspace, cur_query, dim);
                     }
 
                     faiss::IVFSearchParameters ivf_search_params;
@@ -975,8 +1623,7 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::un
                 } else if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
                     auto cur_query = (const float*)xq + index * dim;
                     if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
+                        cur_query = NormalizedQuery(workspace, cur_query, dim);
                     }
 
                     // todo aguzhva: this is somewhat alogical. Refactor?
@@ -988,8 +1635,7 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::un
                 } else if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
                     auto cur_query = (const float*)xq + index * dim;
                     if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
+                        cur_query = NormalizedQuery(workspace, cur_query, dim);
                     }
 
                     const IvfRaBitQConfig& ivf_rabitq_cfg = static_cast<const IvfRaBitQConfig&>(*cfg);
@@ -1020,6 +1666,30 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::un
                         refine_search_params.k_factor = ivf_rabitq_cfg.refine_k.value_or(1);
                         refine_search_params.base_index_params = &ivf_search_params;
 
+                        index_->range_search(1, cur_query, radius, &res, &refine_search_params);
+                    } else {
+                        index_->range_search(1, cur_query, radius, &res, &ivf_search_params);
+                    }
+                } else if constexpr (std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+                    auto cur_query = (const float*)xq + index * dim;
+                    if (is_cosine) {
+                        cur_query = NormalizedQuery(workspace, cur_query, dim);
+                    }
+
+                    const IvfPqFastScanConfig& ivf_pq_fast_scan_cfg = static_cast<const IvfPqFastScanConfig&>(*cfg);
+
+                    faiss::IVFSearchParameters ivf_search_params;
+                    ivf_search_params.nprobe = index_->get_ivfpq_fast_scan_index()->nlist;
+                    ivf_search_params.max_codes = 0;
+                    ivf_search_params.max_empty_result_buckets = ivf_cfg.max_empty_result_buckets.value();
+                    ivf_search_params.sel = id_selector;
+
+                    if (index_->get_refine_index() != nullptr && ivf_pq_fast_scan_cfg.refine_k.has_value()) {
+                        faiss::IndexRefineSearchParameters refine_search_params;
+                        refine_search_params.sel = id_selector;
+                        refine_search_params.k_factor = ivf_pq_fast_scan_cfg.refine_k.value();
+                        refine_search_params.base_index_params = &ivf_search_params;
+
                         index_->range_search(1, cur_query, radius, &res, &refine_search_params);
                     } else {
                         index_->range_search(1, cur_query, radius, &res, &ivf_search_params);
@@ -1027,8 +1697,7 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::un
                 } else {
                     auto cur_query = (const float*)xq + index * dim;
                     if (is_cosine) {
-                        copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
-                        cur_query = copied_query.get();
+                        cur_query = NormalizedQuery(workspace, cur_query, dim);
                     }
 
                     faiss::IVFSearchParameters ivf_search_params;
@@ -1054,6 +1723,7 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, std::un
         }
         // wait for the completion
         WaitAllSuccess(futs);
+        ScopedSearchStage stage(SearchStage::RESULT_ASSEMBLY);
         range_search_result = GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter);
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
@@ -1077,7 +1747,8 @@ IvfIndexNode<DataType, IndexType>::AnnIterator(const DataSetPtr dataset, std::un
     }
     if constexpr (!is_ann_iterator_supported()) {
         LOG_KNOWHERE_WARNING_ << "Current index_type: " << Type()
-                              << ", only IVFFlat, IVFFlatCC, IVF_SQ8, IVF_SQ_CC, SCANN and IVFRABITQ support Iterator.";
+                              << ", only IVFFlat, IVFFlatCC, IVF_SQ8, IVF_SQ_CC, SCANN, IVFRABITQ and IVF_PQ_FASTSCAN "
+                                 "support Iterator.";
         return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::not_implemented, "index not supported");
     } else {
         auto dim = dataset->GetDim();
@@ -1098,6 +1769,11 @@ IvfIndexNode<DataType, IndexType>::AnnIterator(const DataSetPtr dataset, std::un
                 iterator_refine_ratio = ivf_cfg.iterator_refine_ratio.value();
             }
         }
+        if constexpr (std::is_same_v<IndexType, IndexIVFPQFastScanWrapper>) {
+            if (index_->get_refine_index() != nullptr) {
+                iterator_refine_ratio = ivf_cfg.iterator_refine_ratio.value();
+            }
+        }
         try {
             for (int i = 0; i < rows; ++i) {
                 auto cur_query = (const float*)data + i * dim;
@@ -1112,7 +1788,8 @@ IvfIndexNode<DataType, IndexType>::AnnIterator(const DataSetPtr dataset, std::un
 
                 // iterator only own the copied_query.
                 auto it = std::make_shared<iterator>(index_.get(), std::move(copied_query), bitset, nprobe,
-                                                     larger_is_closer, iterator_refine_ratio, use_knowhere_search_pool);
+                                                     ivf_cfg.quantizer_ef.value(), larger_is_closer,
+                                                     iterator_refine_ratio, use_knowhere_search_pool);
                 vec[i] = it;
             }
 
@@ -1124,6 +1801,126 @@ IvfIndexNode<DataType, IndexType>::AnnIterator(const DataSetPtr dataset, std::un
     }
 }
 
+template <typename DataType, typename IndexType>
+expected<DataSetPtr>
+IvfIndexNode<DataType, IndexType>::GroupBySearch(const DataSetPtr dataset, const GroupByColumn& column,
+                                                 std::unique_ptr<Config> cfg, const BitsetView& bitset) const {
+    if (!index_) {
+        LOG_KNOWHERE_WARNING_ << "search on empty index";
+        return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+    }
+    if (!index_->is_trained) {
+        LOG_KNOWHERE_WARNING_ << "index not trained";
+        return expected<DataSetPtr>::Err(Status::index_not_trained, "index not trained");
+    }
+    if constexpr (!is_group_by_supported()) {
+        return IndexNode::GroupBySearch(dataset, column, std::move(cfg), bitset);
+    } else {
+        const auto dim = dataset->GetDim();
+        const auto rows = dataset->GetRows();
+        const auto data = dataset->GetTensor();
+
+        const IvfConfig& ivf_cfg = static_cast<const IvfConfig&>(*cfg);
+        const bool is_cosine = IsMetricType(ivf_cfg.metric_type.value(), knowhere::metric::COSINE);
+        const bool larger_is_closer = IsMetricType(ivf_cfg.metric_type.value(), knowhere::metric::IP) || is_cosine;
+        const auto k = ivf_cfg.k.value();
+        const auto group_size = ivf_cfg.group_size.value();
+        const auto n_results = k * group_size;
+        const auto nprobe = ivf_cfg.nprobe.value();
+        size_t nlist = 0;
+        if constexpr (std::is_same_v<IndexType, IndexIVFRaBitQWrapper>) {
+            nlist = index_->get_ivfrabitq_index()->nlist;
+        } else {
+            nlist = index_->nlist;
+        }
+
+        auto ids = std::make_unique<int64_t[]>(rows * n_results);
+        auto distances = std::make_unique<float[]>(rows * n_results);
+        SearchStats search_stats(ivf_cfg.search_stats.value() ? rows : 0);
+        QuerySearchStats* const stats = search_stats.empty() ? nullptr : search_stats.data();
+
+        // the groups are collected along the iterator of the query: the nprobe nearest lists first, then a list at a
+        // time until the k nearest groups are full, past which no row of a further list may enter them
+        auto search_query = [&](const int64_t index) {
+            SearchWorkspace::Scope workspace;
+            ScopedSearchStage stage(SearchStage::LIST_SCAN);
+            auto cur_query = (const float*)data + index * dim;
+            if (is_cosine) {
+                cur_query = NormalizedQuery(workspace, cur_query, dim);
+            }
+
+            BitsetViewIDSelector bw_idselector(bitset);
+            faiss::IVFSearchParameters ivf_search_params;
+            ivf_search_params.nprobe = nprobe;
+            ivf_search_params.max_codes = 0;
+            ivf_search_params.sel = bitset.empty() ? nullptr : &bw_idselector;
+            faiss::SearchParametersHNSW quantizer_params;
+            SetGraphQuantizerParams(CoarseQuantizer(index_.get()), ivf_cfg.quantizer_ef.value(), quantizer_params,
+                                    ivf_search_params);
+            auto iter_workspace = index_->getIteratorWorkspace(cur_query, &ivf_search_params);
+
+            faiss::cppcontrib::knowhere::GroupByCollector collector(k, group_size);
+            uint64_t scanned = 0;
+            size_t backup_count = 0;
+            while (!collector.full() && iter_workspace->next_visit_coarse_list_idx < nlist) {
+                const auto list_idx = iter_workspace->next_visit_coarse_list_idx;
+                const auto list_offset = iter_workspace->next_visit_list_offset;
+                index_->getIteratorNextBatch(iter_workspace.get(), backup_count);
+                for (const auto& dist_id : iter_workspace->dists) {
+                    const float dis = larger_is_closer ? -dist_id.val : dist_id.val;
+                    if (dis < collector.threshold()) {
+                        collector.add(dis, dist_id.id, column(dist_id.id));
+                    }
+                }
+                scanned += iter_workspace->dists.size();
+                iter_workspace->dists.clear();
+                if (list_idx == iter_workspace->next_visit_coarse_list_idx &&
+                    list_offset == iter_workspace->next_visit_list_offset) {
+                    break;
+                }
+                // the next batches ask for a list worth of codes
+                const auto threshold = iter_workspace->backup_count_threshold;
+                backup_count = threshold - std::max<size_t>(threshold / std::max<size_t>(iter_workspace->nprobe, 1), 1);
+            }
+
+            auto cur_distances = distances.get() + index * n_results;
+            collector.get_result(cur_distances, ids.get() + index * n_results);
+            if (larger_is_closer) {
+                for (int64_t i = 0; i < n_results; i++) {
+                    cur_distances[i] = -cur_distances[i];
+                }
+            }
+            if (stats != nullptr) {
+                stats[index].lists_probed = iter_workspace->next_visit_coarse_list_idx;
+                stats[index].distance_computations = scanned;
+            }
+        };
+
+        const size_t query_cost = static_cast<size_t>(nprobe) * index_->ntotal / std::max<size_t>(nlist, 1) * dim;
+        try {
+            ParallelForOverSearchThreadPool(
+                rows, query_cost,
+                [&](size_t begin, size_t end) {
+                    for (auto i = begin; i < end; ++i) {
+                        search_query(i);
+                    }
+                },
+                [&](size_t begin, size_t end) {
+                    MarkMissingResults(ids.get(), distances.get(), n_results, begin, end);
+                });
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        }
+
+        auto res = GenResultDataSet(rows, n_results, std::move(ids), std::move(distances));
+        if (stats != nullptr) {
+            res->SetSearchStats(std::move(search_stats));
+        }
+        return res;
+    }
+}
+
 template <typename DataType, typename IndexType>
 expected<DataSetPtr>
 IvfIndexNode<DataType, IndexType>::GetVectorByIds(const DataSetPtr dataset) const {
@@ -1171,7 +1968,11 @@ IvfIndexNode<DataType, IndexType>::GetVectorByIds(const DataSetPtr dataset) cons
     } else if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value ||
                          std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value) {
         // we should never go here since we should call HasRawData() first
-        if (!index_->with_raw_data()) {
+        bool has_raw_data = index_->with_raw_data();
+        if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
+            has_raw_data = has_raw_data && IsLosslessRefine(index_->refine_index);
+        }
+        if (!has_raw_data) {
             return expected<DataSetPtr>::Err(Status::not_implemented, "GetVectorByIds not implemented");
         }
         auto dim = Dim();
@@ -1205,6 +2006,9 @@ IvfIndexNode<DataType, IndexType>::GetIndexMetaImpl(std::unique_ptr<Config>, IVF
 
     auto ivf_index = dynamic_cast<faiss::IndexIVF*>(index_.get());
     auto ivf_quantizer = dynamic_cast<faiss::IndexFlat*>(ivf_index->quantizer);
+    if (auto graph_quantizer = dynamic_cast<faiss::IndexHNSW*>(ivf_index->quantizer); graph_quantizer != nullptr) {
+        ivf_quantizer = dynamic_cast<faiss::IndexFlat*>(graph_quantizer->storage);
+    }
 
     int64_t dim = ivf_index->d;
     int64_t nlist = ivf_index->nlist;
@@ -1242,16 +2046,23 @@ IvfIndexNode<DataType, IndexType>::SerializeImpl(BinarySet& binset) const {
             LOG_KNOWHERE_WARNING_ << "index can not be serialized for empty index";
             return Status::empty_index;
         }
-        MemoryIOWriter writer;
-        if constexpr (std::is_same<IndexType, faiss::IndexBinaryIVF>::value) {
-            faiss::write_index_binary(index_.get(), &writer);
-        } else if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
-            faiss::write_index(index_->index.get(), &writer);
-        } else {
-            faiss::write_index(index_.get(), &writer);
+        AppendIndexBinary(binset, Type(), this->version_, [&](faiss::IOWriter* writer) { WriteIndex(writer); });
+        return Status::success;
+    } catch (const std::exception& e) {
+        LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+        return Status::faiss_inner_error;
+    }
+}
+
+template <typename DataType, typename IndexType>
+Status
+IvfIndexNode<DataType, IndexType>::SerializeToFile(const std::string& filename) const {
+    try {
+        if (!this->index_) {
+            LOG_KNOWHERE_WARNING_ << "index can not be serialized for empty index";
+            return Status::empty_index;
         }
-        std::shared_ptr<uint8_t[]> data(writer.data());
-        binset.Append(Type(), data, writer.tellg());
+        WriteIndexFile(filename, Type(), this->version_, [&](faiss::IOWriter* writer) { WriteIndex(writer); });
         return Status::success;
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
@@ -1259,6 +2070,54 @@ IvfIndexNode<DataType, IndexType>::SerializeImpl(BinarySet& binset) const {
     }
 }
 
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::WriteIndex(faiss::IOWriter* writer) const {
+    // the array inverted lists are written as one arena, that is loaded with a single read, or mapped
+    const int io_flags = faiss::IO_FLAG_ARENA_INVLISTS;
+    if constexpr (std::is_same<IndexType, faiss::IndexBinaryIVF>::value) {
+        faiss::write_index_binary(index_.get(), writer);
+    } else if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value ||
+                         std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+        faiss::write_index(index_->index.get(), writer, io_flags);
+    } else {
+        faiss::write_index(index_.get(), writer, io_flags);
+    }
+}
+
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::BackWithHugePages(bool in_place) {
+    if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value ||
+                  std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+        BackIndexWithHugePages(index_->index.get(), in_place);
+    } else {
+        BackIndexWithHugePages(index_.get(), in_place);
+    }
+}
+
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::AdviseMappedAccess() const {
+    if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value ||
+                  std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+        knowhere::AdviseMappedAccess(index_->index.get());
+    } else {
+        knowhere::AdviseMappedAccess(index_.get());
+    }
+}
+
+template <typename DataType, typename IndexType>
+std::vector<MemoryRange>
+IvfIndexNode<DataType, IndexType>::GetMappedRanges(WarmupLevel level) const {
+    if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value ||
+                  std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+        return knowhere::GetMappedRanges(index_->index.get(), level);
+    } else {
+        return knowhere::GetMappedRanges(index_.get(), level);
+    }
+}
+
 template <typename DataType, typename IndexType>
 Status
 IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) {
@@ -1271,13 +2130,16 @@ IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, std::sha
         return Status::invalid_binary_set;
     }
 
-    MemoryIOReader reader(binary->data.get(), binary->size);
+    // the index is read from the binary, or as views of its data, or decompressed
+    const bool zero_copy = static_cast<const BaseConfig&>(*cfg).enable_zero_copy.value();
+    std::unique_ptr<faiss::IOReader> reader;
     try {
+        reader = MakeIndexBinaryReader(binary, this->version_, Type(), zero_copy);
         if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
             // a special case for IVFRaBitQ, bcz a wrapper is involved.
 
             // deserialize
-            auto index_raw = std::unique_ptr<faiss::Index>(faiss::read_index(&reader));
+            auto index_raw = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get()));
             auto index_wr = IndexIVFRaBitQWrapper::from_deserialized(std::move(index_raw));
             if (index_wr == nullptr) {
                 LOG_KNOWHERE_ERROR_ << "The deserialized index does not look like an IVFRaBitQ";
@@ -1285,13 +2147,22 @@ IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, std::sha
             }
 
             // use the wrapper
+            index_ = std::move(index_wr);
+        } else if constexpr (std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+            auto index_raw = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get()));
+            auto index_wr = IndexIVFPQFastScanWrapper::from_deserialized(std::move(index_raw));
+            if (index_wr == nullptr) {
+                LOG_KNOWHERE_ERROR_ << "The deserialized index does not look like an IVFPQFastScan";
+                return Status::invalid_serialized_index_type;
+            }
+
             index_ = std::move(index_wr);
         } else {
             // the default case for a regular index
             if constexpr (std::is_same<IndexType, faiss::IndexBinaryIVF>::value) {
-                index_.reset(static_cast<IndexType*>(faiss::read_index_binary(&reader)));
+                index_.reset(static_cast<IndexType*>(faiss::read_index_binary(reader.get())));
             } else {
-                index_.reset(static_cast<IndexType*>(faiss::read_index(&reader)));
+                index_.reset(static_cast<IndexType*>(faiss::read_index(reader.get())));
             }
 
             if constexpr (!std::is_same_v<IndexType, faiss::IndexScaNN> &&
@@ -1302,6 +2173,7 @@ IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, std::sha
                 }
             }
         }
+        BackWithHugePages(zero_copy);
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return Status::faiss_inner_error;
@@ -1319,11 +2191,12 @@ IvfIndexNode<DataType, IndexType>::DeserializeFromFile(const std::string& filena
         io_flags |= faiss::IO_FLAG_MMAP;
     }
     try {
+        auto reader = OpenIndexFile(filename, this->version_, Type(), io_flags);
         if constexpr (std::is_same<IndexType, IndexIVFRaBitQWrapper>::value) {
             // a special case for IVFRaBitQ, bcz a wrapper is involved.
 
             // deserialize into a wrapper
-            auto index_raw = std::unique_ptr<faiss::Index>(faiss::read_index(filename.data(), io_flags));
+            auto index_raw = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get(), io_flags));
             auto index_wr = IndexIVFRaBitQWrapper::from_deserialized(std::move(index_raw));
             if (index_wr == nullptr) {
                 LOG_KNOWHERE_ERROR_ << "The deserialized index does not look like an IVFRaBitQ";
@@ -1331,13 +2204,22 @@ IvfIndexNode<DataType, IndexType>::DeserializeFromFile(const std::string& filena
             }
 
             // use the wrapper
+            index_ = std::move(index_wr);
+        } else if constexpr (std::is_same<IndexType, IndexIVFPQFastScanWrapper>::value) {
+            auto index_raw = std::unique_ptr<faiss::Index>(faiss::read_index(reader.get(), io_flags));
+            auto index_wr = IndexIVFPQFastScanWrapper::from_deserialized(std::move(index_raw));
+            if (index_wr == nullptr) {
+                LOG_KNOWHERE_ERROR_ << "The deserialized index does not look like an IVFPQFastScan";
+                return Status::invalid_serialized_index_type;
+            }
+
             index_ = std::move(index_wr);
         } else {
             // the default case for a regular index
             if constexpr (std::is_same<IndexType, faiss::IndexBinaryIVF>::value) {
-                index_.reset(static_cast<IndexType*>(faiss::read_index_binary(filename.data(), io_flags)));
+                index_.reset(static_cast<IndexType*>(faiss::read_index_binary(reader.get(), io_flags)));
             } else {
-                index_.reset(static_cast<IndexType*>(faiss::read_index(filename.data(), io_flags)));
+                index_.reset(static_cast<IndexType*>(faiss::read_index(reader.get(), io_flags)));
             }
 
             if constexpr (!std::is_same_v<IndexType, faiss::IndexScaNN>) {
@@ -1347,6 +2229,10 @@ IvfIndexNode<DataType, IndexType>::DeserializeFromFile(const std::string& filena
                 }
             }
         }
+        BackWithHugePages(cfg.enable_mmap.value());
+        if (cfg.enable_mmap.value()) {
+            AdviseMappedAccess();
+        }
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return Status::faiss_inner_error;
@@ -1375,6 +2261,8 @@ KNOWHERE_MOCK_REGISTER_DENSE_FLOAT_ALL_GLOBAL(IVF_SQ_CC, IvfIndexNode, knowhere:
                                               faiss::IndexIVFScalarQuantizerCC)
 KNOWHERE_MOCK_REGISTER_DENSE_FLOAT_ALL_GLOBAL(IVFRABITQ, IvfIndexNode, knowhere::feature::MMAP, IndexIVFRaBitQWrapper)
 KNOWHERE_MOCK_REGISTER_DENSE_FLOAT_ALL_GLOBAL(IVF_RABITQ, IvfIndexNode, knowhere::feature::MMAP, IndexIVFRaBitQWrapper)
+KNOWHERE_MOCK_REGISTER_DENSE_FLOAT_ALL_GLOBAL(IVF_PQ_FASTSCAN, IvfIndexNode, knowhere::feature::MMAP,
+                                              IndexIVFPQFastScanWrapper)
 // int
 KNOWHERE_MOCK_REGISTER_DENSE_INT_GLOBAL(IVFFLAT, IvfIndexNode, knowhere::feature::MMAP, faiss::IndexIVFFlat)
 KNOWHERE_MOCK_REGISTER_DENSE_INT_GLOBAL(IVF_FLAT, IvfIndexNode, knowhere::feature::MMAP, faiss::IndexIVFFlat)
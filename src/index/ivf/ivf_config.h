@@ -22,6 +22,23 @@
 #include "simd/hook.h"
 
 namespace knowhere {
+
+// the types of the refine indices that an IVF index can be combined with
+inline bool
+WhetherAcceptableRefineType(const std::string& refine_type) {
+    // 'flat' is identical to 'fp32'
+    std::vector<std::string> allowed_list = {"sq6", "sq8", "fp16", "bf16", "fp32", "flat"};
+    std::string refine_type_tolower = str_to_lower(refine_type);
+
+    for (const auto& allowed : allowed_list) {
+        if (refine_type_tolower == allowed) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 class IvfConfig : public BaseConfig {
  public:
     CFG_INT nlist;
@@ -29,6 +46,21 @@ class IvfConfig : public BaseConfig {
     CFG_BOOL use_elkan;
     CFG_BOOL ensure_topk_full;  // internal config, used for temp index
     CFG_INT max_empty_result_buckets;
+    // the lists to probe are found with a flat scan of the centroids, or through an HNSW graph over them, which
+    //   scales to a much larger nlist
+    CFG_STRING quantizer_type;
+    CFG_INT quantizer_hnsw_m;
+    CFG_INT quantizer_ef_construction;
+    CFG_INT quantizer_ef;
+    // nprobe becomes a ceiling: a probed list is skipped once the distance of the query to its cell, scaled by
+    //   this ratio, can not beat the current k-th result. 0 probes every list, 1 skips only the lists that can not
+    //   contribute, larger values skip more. Applies to the L2 and COSINE metrics.
+    CFG_FLOAT adaptive_nprobe_ratio;
+    // the centroids are trained with a two-level k-means, about sqrt(nlist) coarse clusters split into nlist fine
+    //   ones, and the lists hold at most kmeans_max_balance times the mean list size of their coarse cluster. Trains
+    //   much faster for a large nlist, and bounds the length of the lists to scan.
+    CFG_BOOL hierarchical_kmeans;
+    CFG_FLOAT kmeans_max_balance;
     KNOHWERE_DECLARE_CONFIG(IvfConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(nlist)
             .description("number of inverted lists.")
@@ -55,10 +87,48 @@ class IvfConfig : public BaseConfig {
             .description("the maximum of continuous buckets with empty result")
             .for_range_search()
             .set_range(1, 65536);
+        KNOWHERE_CONFIG_DECLARE_FIELD(quantizer_type)
+            .set_default("flat")
+            .description("coarse quantizer type, flat or hnsw")
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(quantizer_hnsw_m)
+            .set_default(32)
+            .description("M of the hnsw coarse quantizer")
+            .for_train()
+            .set_range(2, 2048);
+        KNOWHERE_CONFIG_DECLARE_FIELD(quantizer_ef_construction)
+            .set_default(200)
+            .description("efConstruction of the hnsw coarse quantizer, also the ef used to assign the added vectors")
+            .for_train()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max());
+        KNOWHERE_CONFIG_DECLARE_FIELD(quantizer_ef)
+            .set_default(64)
+            .description("ef of the hnsw coarse quantizer at query time, at least nprobe is used")
+            .for_search()
+            .for_iterator()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max());
+        KNOWHERE_CONFIG_DECLARE_FIELD(adaptive_nprobe_ratio)
+            .set_default(0.0f)
+            .description("scale of the distance bound used to skip probed lists, 0 to probe all of them")
+            .for_search()
+            .set_range(0.0f, 16.0f);
+        KNOWHERE_CONFIG_DECLARE_FIELD(hierarchical_kmeans)
+            .set_default(false)
+            .description("whether to train the centroids with a hierarchical balanced k-means")
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_max_balance)
+            .set_default(1.2f)
+            .description("bound on the length of a list over the mean length, for hierarchical_kmeans")
+            .for_train()
+            .set_range(1.0f, 16.0f);
     }
 };
 
-class IvfFlatConfig : public IvfConfig {};
+class IvfFlatConfig : public IvfConfig {
+ public:
+    KNOHWERE_DECLARE_CONFIG(IvfFlatConfig) {
+    }
+};
 
 class IvfFlatCcConfig : public IvfFlatConfig {
  public:
@@ -109,6 +179,9 @@ class ScannConfig : public IvfFlatConfig {
  public:
     CFG_INT reorder_k;
     CFG_BOOL with_raw_data;
+    // the format of the data kept to refine the candidates when with_raw_data is set, fp32 if empty. A lossy format
+    //   makes the index report no raw data, GetVectorByIds then has to be served from elsewhere
+    CFG_STRING refine_type;
     CFG_INT sub_dim;
     CFG_BOOL ensure_topk_full;
     KNOHWERE_DECLARE_CONFIG(ScannConfig) {
@@ -122,6 +195,11 @@ class ScannConfig : public IvfFlatConfig {
             .set_default(true)
             .for_static()
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_type)
+            .description("the format of the data used to refine")
+            .allow_empty_without_default()
+            .for_train()
+            .for_static();
         KNOWHERE_CONFIG_DECLARE_FIELD(sub_dim)
             .description("sub dim of each sub dimension space")
             .set_default(2)
@@ -148,6 +226,11 @@ class ScannConfig : public IvfFlatConfig {
                         return HandleError(err_msg, msg, Status::invalid_args);
                     }
                 }
+                if (refine_type.has_value() && !WhetherAcceptableRefineType(refine_type.value())) {
+                    std::string msg = "invalid refine type : " + refine_type.value() +
+                                      ", optional types are [sq6, sq8, fp16, bf16, fp32, flat]";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
             }
             case PARAM_TYPE::SEARCH: {
                 if (!faiss::support_pq_fast_scan) {
@@ -181,9 +264,25 @@ class ScannConfig : public IvfFlatConfig {
     }
 };
 
-class IvfSqConfig : public IvfConfig {};
+class IvfSqConfig : public IvfConfig {
+ public:
+    // the IP and COSINE searches score the 8-bit codes against the query quantized to int8, with integer dot
+    // products on the codes, which makes the distances approximate
+    CFG_BOOL quantized_query;
+    KNOHWERE_DECLARE_CONFIG(IvfSqConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(quantized_query)
+            .set_default(false)
+            .description("score the codes against the query quantized to int8")
+            .for_search();
+    }
+};
 
 class IvfBinConfig : public IvfConfig {
+ public:
+    KNOHWERE_DECLARE_CONFIG(IvfBinConfig) {
+    }
+
+ private:
     Status
     CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
         if (param_type == PARAM_TYPE::TRAIN) {
@@ -245,7 +344,19 @@ class IvfRaBitQConfig : public IvfConfig {
     // the value `0` means that the query won't be quantized and will
     //   be processed as is.
     CFG_INT rbq_bits_query;
+    // the bits per dimension of the data codes. The value `1` is the original
+    //   RaBitQ, larger ones are the extended RaBitQ codes, which are more
+    //   accurate and may reach the target recall without a refine.
+    CFG_INT rbq_bits_data;
+    // the number of leading dimensions that the codes keep, undefined value leads to codes of all the dimensions
+    CFG_INT prefix_dim;
     KNOHWERE_DECLARE_CONFIG(IvfRaBitQConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(rbq_bits_data)
+            .description("rbq_bits_data")
+            .set_default(1)
+            .set_range(1, 8)
+            .for_train()
+            .for_static();
         KNOWHERE_CONFIG_DECLARE_FIELD(rbq_bits_query)
             .description("rbq_bits_query")
             .set_default(0)
@@ -267,6 +378,15 @@ class IvfRaBitQConfig : public IvfConfig {
             .allow_empty_without_default()
             .for_train()
             .for_static();
+        // For Matryoshka embeddings, whose leading dimensions carry most of the signal: the centroids and the codes
+        //   cover the first prefix_dim dimensions only, and the refine reranks the candidates with all of them.
+        //   Needs a refine.
+        KNOWHERE_CONFIG_DECLARE_FIELD(prefix_dim)
+            .description("the number of leading dimensions that the codes keep")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_train()
+            .for_static();
     }
 
     Status
@@ -287,24 +407,75 @@ class IvfRaBitQConfig : public IvfConfig {
                     return HandleError(err_msg, msg, Status::invalid_args);
                 }
             }
+
+            if (prefix_dim.has_value()) {
+                if (!refine.value_or(false) || !refine_type.has_value()) {
+                    std::string msg = "prefix_dim needs a refine over all the dimensions";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+                if (dim.has_value() && prefix_dim.value() >= dim.value()) {
+                    std::string msg = "prefix_dim (" + std::to_string(prefix_dim.value()) +
+                                      ") should be less than dim (" + std::to_string(dim.value()) + ")";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+            }
         }
         return Status::success;
     }
+};
+
+// IVF_PQ with 4-bit codes, which are scanned with SIMD lookup tables, optionally followed by a refine
+class IvfPqFastScanConfig : public IvfPqConfig {
+ public:
+    // whether an index is built with a refine support
+    CFG_BOOL refine;
+    // undefined value leads to a search without a refine
+    CFG_FLOAT refine_k;
+    // type of refine
+    CFG_STRING refine_type;
+    KNOHWERE_DECLARE_CONFIG(IvfPqFastScanConfig) {
+        // the fast scan kernels only handle 16-entry lookup tables
+        KNOWHERE_CONFIG_DECLARE_FIELD(nbits).description("nbits").set_default(4).for_train().set_range(4, 4);
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine)
+            .description("whether the refine is used during the train")
+            .set_default(false)
+            .for_train()
+            .for_static();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_k)
+            .description("refine k")
+            .set_default(1)
+            .set_range(1, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_type)
+            .description("the type of a refine index")
+            .allow_empty_without_default()
+            .for_train()
+            .for_static();
+    }
 
- protected:
-    bool
-    WhetherAcceptableRefineType(const std::string& refine_type) {
-        // 'flat' is identical to 'fp32'
-        std::vector<std::string> allowed_list = {"sq6", "sq8", "fp16", "bf16", "fp32", "flat"};
-        std::string refine_type_tolower = str_to_lower(refine_type);
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (!faiss::support_pq_fast_scan) {
+            std::string msg =
+                "IVF_PQ_FASTSCAN index is not supported on the current CPU model, avx2 support is needed for x86 arch.";
+            return HandleError(err_msg, msg, Status::invalid_instruction_set);
+        }
 
-        for (const auto& allowed : allowed_list) {
-            if (refine_type_tolower == allowed) {
-                return true;
-            }
+        const auto base_status = IvfPqConfig::CheckAndAdjust(param_type, err_msg);
+        if (base_status != Status::success) {
+            return base_status;
         }
 
-        return false;
+        if (param_type == PARAM_TYPE::TRAIN) {
+            if (refine_type.has_value()) {
+                if (!WhetherAcceptableRefineType(refine_type.value())) {
+                    std::string msg = "invalid refine type : " + refine_type.value() +
+                                      ", optional types are [sq6, sq8, fp16, bf16, fp32, flat]";
+                    return HandleError(err_msg, msg, Status::invalid_args);
+                }
+            }
+        }
+        return Status::success;
     }
 };
 
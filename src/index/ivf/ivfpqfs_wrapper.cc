@@ -0,0 +1,195 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "index/ivf/ivfpqfs_wrapper.h"
+
+#include <memory>
+
+#include "faiss/IndexFlat.h"
+#include "faiss/cppcontrib/knowhere/impl/CountSizeIOWriter.h"
+#include "faiss/index_io.h"
+#include "index/refine/refine_utils.h"
+
+namespace knowhere {
+
+expected<std::unique_ptr<IndexIVFPQFastScanWrapper>>
+IndexIVFPQFastScanWrapper::create(const faiss::idx_t d, const size_t nlist,
+                                  const IvfPqFastScanConfig& ivf_pq_fast_scan_cfg, const DataFormatEnum raw_data_format,
+                                  const faiss::MetricType metric) {
+    // the index factory string is either `IVFx,PQyx4fs,Refine(z)`,
+    //   or `IVFx,PQyx4fs`, depends on the refine parameters
+
+    // create IndexIVFPQFastScan
+    auto idx_flat = std::make_unique<faiss::IndexFlat>(d, metric, false);
+    auto idx_ivfpqfs = std::make_unique<faiss::IndexIVFPQFastScan>(
+        idx_flat.release(), d, nlist, ivf_pq_fast_scan_cfg.m.value(), ivf_pq_fast_scan_cfg.nbits.value(), metric);
+    idx_ivfpqfs->own_fields = true;
+
+    // create a refiner index, if needed
+    std::unique_ptr<faiss::Index> idx_final;
+    if (ivf_pq_fast_scan_cfg.refine.value_or(false) && ivf_pq_fast_scan_cfg.refine_type.has_value()) {
+        // refine is needed
+        const auto base_d = idx_ivfpqfs->d;
+        const auto base_metric_type = idx_ivfpqfs->metric_type;
+        auto final_index_cnd = pick_refine_index(raw_data_format, ivf_pq_fast_scan_cfg.refine_type,
+                                                 std::move(idx_ivfpqfs), base_d, base_metric_type);
+        if (!final_index_cnd.has_value()) {
+            return expected<std::unique_ptr<IndexIVFPQFastScanWrapper>>::Err(Status::invalid_args,
+                                                                             "Invalid refine parameters");
+        }
+
+        idx_final = std::move(final_index_cnd.value());
+    } else {
+        // refine is not needed
+        idx_final = std::move(idx_ivfpqfs);
+    }
+
+    auto result = std::make_unique<IndexIVFPQFastScanWrapper>(std::move(idx_final));
+    return result;
+}
+
+IndexIVFPQFastScanWrapper::IndexIVFPQFastScanWrapper(std::unique_ptr<faiss::Index>&& index_in)
+    : Index{index_in->d, index_in->metric_type}, index{std::move(index_in)} {
+    ntotal = index->ntotal;
+    is_trained = index->is_trained;
+    is_cosine = index->is_cosine;
+    verbose = index->verbose;
+    metric_arg = index->metric_arg;
+}
+
+std::unique_ptr<IndexIVFPQFastScanWrapper>
+IndexIVFPQFastScanWrapper::from_deserialized(std::unique_ptr<faiss::Index>&& index_in) {
+    auto index = std::make_unique<IndexIVFPQFastScanWrapper>(std::move(index_in));
+
+    // check a provided index type
+    if (index->get_ivfpq_fast_scan_index() == nullptr) {
+        return nullptr;
+    }
+
+    // done
+    return index;
+}
+
+void
+IndexIVFPQFastScanWrapper::train(faiss::idx_t n, const float* x) {
+    index->train(n, x);
+    is_trained = index->is_trained;
+}
+
+void
+IndexIVFPQFastScanWrapper::add(faiss::idx_t n, const float* x) {
+    index->add(n, x);
+    this->ntotal = index->ntotal;
+}
+
+void
+IndexIVFPQFastScanWrapper::search(faiss::idx_t n, const float* x, faiss::idx_t k, float* distances,
+                                  faiss::idx_t* labels, const faiss::SearchParameters* params) const {
+    index->search(n, x, k, distances, labels, params);
+}
+
+void
+IndexIVFPQFastScanWrapper::range_search(faiss::idx_t n, const float* x, float radius,
+                                        faiss::RangeSearchResult* result,
+                                        const faiss::SearchParameters* params) const {
+    index->range_search(n, x, radius, result, params);
+}
+
+void
+IndexIVFPQFastScanWrapper::reset() {
+    index->reset();
+    this->ntotal = 0;
+}
+
+void
+IndexIVFPQFastScanWrapper::merge_from(Index& otherIndex, faiss::idx_t add_id) {
+    index->merge_from(otherIndex, add_id);
+}
+
+faiss::DistanceComputer*
+IndexIVFPQFastScanWrapper::get_distance_computer() const {
+    return index->get_distance_computer();
+}
+
+faiss::IndexIVFPQFastScan*
+IndexIVFPQFastScanWrapper::get_ivfpq_fast_scan_index() {
+    faiss::IndexRefine* index_refine = dynamic_cast<faiss::IndexRefine*>(index.get());
+    faiss::Index* index_base = (index_refine != nullptr) ? index_refine->base_index : index.get();
+
+    return dynamic_cast<faiss::IndexIVFPQFastScan*>(index_base);
+}
+
+const faiss::IndexIVFPQFastScan*
+IndexIVFPQFastScanWrapper::get_ivfpq_fast_scan_index() const {
+    const faiss::IndexRefine* index_refine = dynamic_cast<const faiss::IndexRefine*>(index.get());
+    const faiss::Index* index_base = (index_refine != nullptr) ? index_refine->base_index : index.get();
+
+    return dynamic_cast<const faiss::IndexIVFPQFastScan*>(index_base);
+}
+
+faiss::IndexRefine*
+IndexIVFPQFastScanWrapper::get_refine_index() {
+    return dynamic_cast<faiss::IndexRefine*>(index.get());
+}
+
+const faiss::IndexRefine*
+IndexIVFPQFastScanWrapper::get_refine_index() const {
+    return dynamic_cast<const faiss::IndexRefine*>(index.get());
+}
+
+size_t
+IndexIVFPQFastScanWrapper::size() const {
+    if (index == nullptr) {
+        return 0;
+    }
+
+    // a temporary yet expensive workaround
+    faiss::cppcontrib::knowhere::CountSizeIOWriter writer;
+    faiss::write_index(index.get(), &writer);
+
+    return writer.total_size;
+}
+
+std::unique_ptr<faiss::IVFIteratorWorkspace>
+IndexIVFPQFastScanWrapper::getIteratorWorkspace(const float* query_data,
+                                                const faiss::IVFSearchParameters* ivfsearchParams) const {
+    const faiss::IndexIVFPQFastScan* index_ivfpqfs = get_ivfpq_fast_scan_index();
+    if (index_ivfpqfs == nullptr) {
+        return nullptr;
+    }
+
+    // create a workspace. This will make a clone of the query_data.
+    auto workspace = index_ivfpqfs->getIteratorWorkspace(query_data, ivfsearchParams);
+
+    // check if refine exists
+    const faiss::IndexRefine* index_refine = get_refine_index();
+    if (index_refine != nullptr) {
+        workspace->dis_refine =
+            std::unique_ptr<faiss::DistanceComputer>(index_refine->refine_index->get_distance_computer());
+        // this points to a previously saved clone
+        workspace->dis_refine->set_query(workspace->query_data.data());
+    } else {
+        // don't use refine
+        workspace->dis_refine = nullptr;
+    }
+
+    // done
+    return workspace;
+}
+
+void
+IndexIVFPQFastScanWrapper::getIteratorNextBatch(faiss::IVFIteratorWorkspace* workspace,
+                                                size_t current_backup_count) const {
+    const auto ivfpqfs = this->get_ivfpq_fast_scan_index();
+    ivfpqfs->getIteratorNextBatch(workspace, current_backup_count);
+}
+
+}  // namespace knowhere
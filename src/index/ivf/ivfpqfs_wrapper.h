@@ -0,0 +1,96 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "faiss/Index.h"
+#include "faiss/IndexIVF.h"
+#include "faiss/IndexIVFPQFastScan.h"
+#include "faiss/IndexRefine.h"
+#include "index/ivf/ivf_config.h"
+#include "knowhere/expected.h"
+
+namespace knowhere {
+
+// A wrapper for faiss::IndexIVFPQFastScan, optionally combined with
+//   faiss::IndexRefine. Same as IndexIVFRaBitQWrapper, it keeps ivf.cc
+//   from having to deal with a generic IndexRefine.
+struct IndexIVFPQFastScanWrapper : faiss::Index {
+    // this is one of two:
+    // * faiss::IndexIVFPQFastScan
+    // * faiss::IndexRefine + faiss::IndexIVFPQFastScan
+    std::unique_ptr<faiss::Index> index;
+
+    IndexIVFPQFastScanWrapper(std::unique_ptr<faiss::Index>&& index_in);
+
+    static expected<std::unique_ptr<IndexIVFPQFastScanWrapper>>
+    create(const faiss::idx_t d, const size_t nlist, const IvfPqFastScanConfig& ivf_pq_fast_scan_cfg,
+           // this is the data format of the raw data (if the refine is used)
+           const DataFormatEnum raw_data_format, const faiss::MetricType metric = faiss::METRIC_L2);
+
+    // this is for the deserialization.
+    // returns nullptr if the provided index type is not the one
+    //   as expected.
+    static std::unique_ptr<IndexIVFPQFastScanWrapper>
+    from_deserialized(std::unique_ptr<faiss::Index>&& index_in);
+
+    void
+    train(faiss::idx_t n, const float* x) override;
+
+    void
+    add(faiss::idx_t n, const float* x) override;
+
+    void
+    search(faiss::idx_t n, const float* x, faiss::idx_t k, float* distances, faiss::idx_t* labels,
+           const faiss::SearchParameters* params) const override;
+
+    void
+    range_search(faiss::idx_t n, const float* x, float radius, faiss::RangeSearchResult* result,
+                 const faiss::SearchParameters* params) const override;
+
+    void
+    reset() override;
+
+    void
+    merge_from(Index& otherIndex, faiss::idx_t add_id) override;
+
+    faiss::DistanceComputer*
+    get_distance_computer() const override;
+
+    // point to IndexIVFPQFastScan or return nullptr.
+    // this may also point to an index, owned by IndexRefine
+    faiss::IndexIVFPQFastScan*
+    get_ivfpq_fast_scan_index();
+    const faiss::IndexIVFPQFastScan*
+    get_ivfpq_fast_scan_index() const;
+
+    // point to IndexRefine or return nullptr.
+    faiss::IndexRefine*
+    get_refine_index();
+    const faiss::IndexRefine*
+    get_refine_index() const;
+
+    // return the size of the index
+    size_t
+    size() const;
+
+    std::unique_ptr<faiss::IVFIteratorWorkspace>
+    getIteratorWorkspace(const float* query_data, const faiss::IVFSearchParameters* ivfsearchParams) const;
+
+    void
+    getIteratorNextBatch(faiss::IVFIteratorWorkspace* workspace, size_t current_backup_count) const;
+};
+
+}  // namespace knowhere
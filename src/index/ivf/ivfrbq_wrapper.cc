@@ -28,18 +28,25 @@ IndexIVFRaBitQWrapper::create(const faiss::idx_t d, const size_t nlist, const Iv
     // the index factory string is either `RR(dim),IVFx,RaBitQ,Refine(y)`,
     //   or `RR(dim),IVFx,RaBitQ`, depends on the refine parameters
 
-    // create IndexIVFRaBitQ
+    // create IndexIVFRaBitQ, over the leading dimensions only if prefix_dim is set
     auto qb = ivf_rabitq_cfg.rbq_bits_query.value();
+    auto nb_bits = ivf_rabitq_cfg.rbq_bits_data.value();
+    const faiss::idx_t code_d = ivf_rabitq_cfg.prefix_dim.value_or(d);
 
-    auto idx_flat = std::make_unique<faiss::IndexFlat>(d, metric, false);
-    auto idx_ivfrbq = std::make_unique<faiss::IndexIVFRaBitQ>(idx_flat.release(), d, nlist, metric);
+    auto idx_flat = std::make_unique<faiss::IndexFlat>(code_d, metric, false);
+    auto idx_ivfrbq = std::make_unique<faiss::IndexIVFRaBitQ>(idx_flat.release(), code_d, nlist, metric, nb_bits);
     idx_ivfrbq->own_fields = true;
     idx_ivfrbq->qb = qb;
 
     // wrap it in an IndexPreTransform
-    auto rr = std::make_unique<faiss::RandomRotationMatrix>(d, d);
-    auto idx_rr = std::make_unique<faiss::IndexPreTransform>(rr.release(), idx_ivfrbq.release());
-    idx_rr->own_fields = true;
+    auto rr = std::make_unique<faiss::RandomRotationMatrix>(code_d, code_d);
+    auto idx_pt = std::make_unique<faiss::IndexPreTransform>(rr.release(), idx_ivfrbq.release());
+    idx_pt->own_fields = true;
+    std::unique_ptr<faiss::Index> idx_rr = std::move(idx_pt);
+    if (code_d != d) {
+        // the prefix goes ahead of the rotation, in the same IndexPreTransform
+        idx_rr = make_prefix_dim_index(d, std::move(idx_rr));
+    }
 
     // create a refiner index, if needed
     std::unique_ptr<faiss::Index> idx_final;
@@ -214,8 +221,9 @@ IndexIVFRaBitQWrapper::getIteratorWorkspace(const float* query_data,
         // a regular use case
         workspace->dis_refine =
             std::unique_ptr<faiss::DistanceComputer>(index_refine->refine_index->get_distance_computer());
-        // this points to a previously saved clone
-        workspace->dis_refine->set_query(workspace->query_data.data());
+        // the refine data is not transformed, so is not its query
+        workspace->refine_query_data.assign(query_data, query_data + d);
+        workspace->dis_refine->set_query(workspace->refine_query_data.data());
     } else {
         // don't use refine
         workspace->dis_refine = nullptr;
@@ -48,10 +48,9 @@ class MinHashLSHNode : public IndexNode {
         return Status::not_implemented;
     }
 
+    // adds the rows to the loaded index, in memory: they are searched along with the rows of the index file
     Status
-    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override {
-        return Status::not_implemented;
-    }
+    Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) override;
 
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override;
@@ -226,6 +225,11 @@ MinHashLSHNode<DataType>::Build(const DataSetPtr dataset, std::shared_ptr<Config
         }
         size_t mh_vec_element_size = size_t(build_conf.mh_element_bit_width.value() / 8);
         size_t mh_vec_length = size_t(dim / build_conf.mh_element_bit_width.value());
+        auto band_layout = minhash::ParseMinHashBandLayout(build_conf.mh_lsh_band_layout.value());
+        if (!band_layout.has_value()) {
+            LOG_KNOWHERE_ERROR_ << band_layout.what();
+            return band_layout.error();
+        }
         minhash::MinHashLSHBuildParams index_params = {
             .data_path = build_conf.data_path.value(),
             .index_file_path = build_conf.index_prefix.value() + fname_,
@@ -233,7 +237,9 @@ MinHashLSHNode<DataType>::Build(const DataSetPtr dataset, std::shared_ptr<Config
             .block_size = size_t(build_conf.mh_lsh_aligned_block_size.value()),
             .with_raw_data = build_conf.with_raw_data.value(),
             .mh_vec_element_size = mh_vec_element_size,
-            .mh_vec_length = mh_vec_length};
+            .mh_vec_length = mh_vec_length,
+            .band_layout = band_layout.value(),
+            .refine_bits = size_t(build_conf.mh_lsh_refine_bits.value())};
 
         auto build_stat = minhash::MinHashLSH::BuildAndSave(&index_params);
         if (build_stat != Status::success) {
@@ -250,6 +256,26 @@ MinHashLSHNode<DataType>::Build(const DataSetPtr dataset, std::shared_ptr<Config
     return Status::success;
 }
 
+template <typename DataType>
+Status
+MinHashLSHNode<DataType>::Add(const DataSetPtr dataset, std::shared_ptr<Config> cfg, bool use_knowhere_build_pool) {
+    if (!is_loaded_ || !minhash_lsh_) {
+        LOG_KNOWHERE_ERROR_ << "Failed to add rows to a minhash index that is not loaded.";
+        return Status::empty_index;
+    }
+    if (dataset->GetDim() != this->Dim()) {
+        LOG_KNOWHERE_ERROR_ << "The dim of the rows (" << dataset->GetDim() << ") is not the dim of the index ("
+                            << this->Dim() << ").";
+        return Status::invalid_args;
+    }
+    try {
+        return minhash_lsh_->Add(static_cast<const char*>(dataset->GetTensor()), dataset->GetRows());
+    } catch (const std::exception& e) {
+        LOG_KNOWHERE_ERROR_ << "minhash lsh inner error: " << e.what();
+        return Status::internal_error;
+    }
+}
+
 template <typename DataType>
 Status
 MinHashLSHNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr<Config> cfg) {
@@ -259,6 +285,12 @@ MinHashLSHNode<DataType>::Deserialize(const BinarySet& binset, std::shared_ptr<C
     index_params_ptr->hash_code_in_memory = load_conf.mh_lsh_code_in_mem.value();
     index_params_ptr->global_bloom_filter = load_conf.mh_lsh_shared_bloom_filter.value();
     index_params_ptr->false_positive_prob = load_conf.mh_lsh_bloom_false_positive_prob.value();
+    auto bloom_filter_type = minhash::ParseMinHashBloomFilterType(load_conf.mh_lsh_bloom_filter_type.value());
+    if (!bloom_filter_type.has_value()) {
+        LOG_KNOWHERE_ERROR_ << bloom_filter_type.what();
+        return bloom_filter_type.error();
+    }
+    index_params_ptr->bloom_filter_type = bloom_filter_type.value();
     if (!LoadFile(index_params_ptr->index_file_path)) {
         LOG_KNOWHERE_ERROR_ << "Failed load the raw data before building.";
         return Status::disk_file_error;
@@ -11,6 +11,13 @@
 
 #ifndef MINHASH_LSH_H
 #define MINHASH_LSH_H
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+
 #include "faiss/impl/io.h"
 #include "index/minhash/minhash_util.h"
 #include "io/file_io.h"
@@ -27,6 +34,29 @@ namespace knowhere::minhash {
 using KeyType = uint64_t;
 using ValueType = idx_t;
 
+// How the sorted keys of a band are searched, chosen at build time and saved with the index.
+enum class MinHashBandLayout : uint32_t {
+    // binary search over the max keys of the blocks, then within the block
+    SORTED = 0,
+    // the keys being uniformly distributed hashes, the position of a key is interpolated, over the max keys of the
+    // blocks and then within the block, and only searched for within the max error of the interpolation that the
+    // build recorded: a probe touches a few cache lines instead of a chain of them. The blocks are the same as the
+    // sorted layout, the errors are kept in the band meta.
+    LEARNED = 1,
+};
+
+inline expected<MinHashBandLayout>
+ParseMinHashBandLayout(const std::string& layout) {
+    if (layout == "sorted") {
+        return MinHashBandLayout::SORTED;
+    }
+    if (layout == "learned") {
+        return MinHashBandLayout::LEARNED;
+    }
+    return expected<MinHashBandLayout>::Err(Status::invalid_args,
+                                            "mh_lsh_band_layout(" + layout + ") should be one of {sorted, learned}");
+}
+
 struct MinHashLSHBuildParams {
     std::string data_path;
     std::string index_file_path;
@@ -35,13 +65,77 @@ struct MinHashLSHBuildParams {
     bool with_raw_data = false;
     size_t mh_vec_element_size = 8;
     size_t mh_vec_length = 0;
+    MinHashBandLayout band_layout = MinHashBandLayout::SORTED;
+    // the bits of every hash that the jaccard refine keeps in memory, one of {1, 2, 4, 8}, or 0 to refine with the
+    // full vectors of the raw data
+    size_t refine_bits = 0;
 };
 
+// The bloom filters that the band keys are checked against before the bands are searched.
+enum class MinHashBloomFilterType {
+    // k bits of an array per key
+    CLASSIC = 0,
+    // a block of a cache line per key, probed with SIMD, for the lookups of absent keys to cost one cache miss
+    SPLIT_BLOCK = 1,
+};
+
+inline expected<MinHashBloomFilterType>
+ParseMinHashBloomFilterType(const std::string& type) {
+    if (type == "classic") {
+        return MinHashBloomFilterType::CLASSIC;
+    }
+    if (type == "split_block") {
+        return MinHashBloomFilterType::SPLIT_BLOCK;
+    }
+    return expected<MinHashBloomFilterType>::Err(
+        Status::invalid_args, "mh_lsh_bloom_filter_type(" + type + ") should be one of {classic, split_block}");
+}
+
 struct MinHashLSHLoadParams {
     std::string index_file_path;
     bool hash_code_in_memory = false;
     bool global_bloom_filter = false;
     float false_positive_prob = 0.01;
+    MinHashBloomFilterType bloom_filter_type = MinHashBloomFilterType::CLASSIC;
+};
+
+// the bloom filter of a band, of either type
+class BandBloomFilter {
+ public:
+    BandBloomFilter(MinHashBloomFilterType type, size_t expected_elements, double false_positive_prob) {
+        if (type == MinHashBloomFilterType::SPLIT_BLOCK) {
+            split_block_ = std::make_unique<SplitBlockBloomFilter<KeyType>>(expected_elements, false_positive_prob);
+        } else {
+            classic_ = std::make_unique<BloomFilter<KeyType>>(expected_elements, false_positive_prob);
+        }
+    }
+
+    void
+    add(KeyType key) {
+        if (split_block_) {
+            split_block_->add(key);
+        } else {
+            classic_->add(key);
+        }
+    }
+
+    bool
+    contains(KeyType key) const {
+        return split_block_ ? split_block_->contains(key) : classic_->contains(key);
+    }
+
+    void
+    contains_batch(const KeyType* keys, size_t num, uint8_t* out) const {
+        if (split_block_) {
+            split_block_->contains_batch(keys, num, out);
+        } else {
+            classic_->contains_batch(keys, num, out);
+        }
+    }
+
+ private:
+    std::unique_ptr<BloomFilter<KeyType>> classic_;
+    std::unique_ptr<SplitBlockBloomFilter<KeyType>> split_block_;
 };
 
 struct MinHashLSHSearchParams {
@@ -55,19 +149,33 @@ struct KVPair {
     KeyType Key;
     ValueType Value;
 };
+
+// the key of a band that a query of a batch looks up
+struct BandProbe {
+    KeyType key;
+    size_t query_id;
+};
 // index of each band
 class MinHashBandIndex {
  public:
     static size_t
     FormatAndSave(faiss::BlockFileIOWriter& writer, const KVPair* sorted_kv, const size_t block_size,
-                  const size_t rows);
+                  const size_t rows, MinHashBandLayout layout);
 
+    // reads the band and pushes the tasks that add its keys to the bloom filter to futures, so that the next bands
+    // are read while the build pool fills the filters
     Status
-    Load(FileReader& reader, size_t rows, char* mmap_data, BloomFilter<KeyType>& bloom_filter);
+    Load(FileReader& reader, size_t rows, char* mmap_data, MinHashBandLayout layout, BandBloomFilter& bloom_filter,
+         std::vector<folly::Future<folly::Unit>>& futures);
 
     void
     Search(KeyType key, MinHashLSHResultHandler* res, faiss::IDSelector* id_selector) const;
 
+    // looks up the probes, sorted by key, for the results of their queries in res: the blocks and the positions in
+    // them only move forward from a probe to the next, so the keys of the band are read near sequentially.
+    void
+    MergeSearch(const BandProbe* probes, size_t n, MinHashLSHResultHandler* res, faiss::IDSelector* id_selector) const;
+
     Status
     WarmUp() const {
         if (mmap_enable_) {
@@ -91,9 +199,21 @@ class MinHashBandIndex {
     }
 
  private:
+    // the first block whose max key is not less than key, -1 if there is none
+    int64_t
+    FindBlock(KeyType key) const;
+
+    // the first position of key in the block, -1 if it is not in the block
+    int64_t
+    FindInBlock(size_t block_id, const KeyType* blk_k, KeyType key) const;
+
+    MinHashBandLayout layout_ = MinHashBandLayout::SORTED;
     std::vector<KeyType> mins_;
     std::vector<KeyType> maxs_;
     std::vector<size_t> num_in_a_blk_;
+    // the learned layout: the max error of the interpolation over maxs_ and of that within each block
+    size_t blocks_err_ = 0;
+    std::vector<uint32_t> blk_errs_;
     size_t block_size_ = 8192;
     size_t blocks_num_ = 0;
     bool mmap_enable_ = false;
@@ -101,6 +221,67 @@ class MinHashBandIndex {
     std::unique_ptr<char[]> owned_data_ = nullptr;
 };
 
+// The rows added to a loaded index, LSM style: every Add() sorts the band keys of its rows into a run of each band,
+// which the searches probe after the bands of the index, and once a band has kMaxDeltaRuns runs a task of the build
+// pool merges them into one, the runs being sorted already. The runs are immutable and published in snapshots, for
+// the searches to go on while rows are added and runs merged.
+class MinHashLSHDelta : public std::enable_shared_from_this<MinHashLSHDelta> {
+ public:
+    struct Run {
+        std::vector<KeyType> keys;
+        std::vector<ValueType> ids;
+    };
+
+    struct RawBatch {
+        idx_t first_id;
+        size_t rows;
+        std::shared_ptr<char[]> data;
+    };
+
+    struct Snapshot {
+        // the runs of every band, the oldest first
+        std::vector<std::vector<std::shared_ptr<const Run>>> runs;
+        std::vector<RawBatch> raw;
+        size_t vec_size = 0;
+        size_t count = 0;
+        size_t bytes = 0;
+
+        void
+        Search(size_t band_i, KeyType key, MinHashLSHResultHandler* res, faiss::IDSelector* id_selector) const;
+
+        // the raw data of the row, nullptr if it is not in the delta or the raw data is not kept
+        const char*
+        GetRow(idx_t id) const;
+    };
+
+    // the ids of the rows follow first_id, the count of the index
+    MinHashLSHDelta(size_t band, size_t vec_size, idx_t first_id, bool with_raw_data);
+
+    // thread-safe, the rows of the concurrent calls being added one call after the other
+    Status
+    Add(const char* data, size_t rows);
+
+    std::shared_ptr<const Snapshot>
+    GetSnapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return snapshot_;
+    }
+
+ private:
+    void
+    MergeBand(size_t band_i);
+
+    const size_t band_;
+    const size_t vec_size_;
+    const idx_t first_id_;
+    const bool with_raw_data_;
+    std::mutex add_mutex_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const Snapshot> snapshot_;
+    // the bands that a merge is running for
+    std::vector<bool> merging_;
+};
+
 /* all index meta and codes will maintain as blocks in file*/
 class MinHashLSH {
  public:
@@ -116,22 +297,30 @@ class MinHashLSH {
                 MinHashLSHSearchParams* params) const;
     Status
     GetDataByIds(const idx_t* ids, size_t n, char* data) const;
+    // adds the rows to the delta of the loaded index, their ids following those of the rows already in
+    Status
+    Add(const char* data, size_t n);
     bool
     HasRawData() const {
         return this->with_raw_data_;
     }
     size_t
     Size() const {
-        return this->ntotal_ * band_ * sizeof(KeyType);
+        return this->ntotal_ * band_ * sizeof(KeyType) + this->ntotal_ * GetBBitCodeSize() +
+               (delta_ ? delta_->GetSnapshot()->bytes : 0);
     }
     size_t
     Count() const {
-        return ntotal_;
+        return ntotal_ + (delta_ ? delta_->GetSnapshot()->count : 0);
     };
     size_t
     GetVectorSize() const {
         return this->mh_vec_length_ * this->mh_vec_elememt_size_;
     }
+    size_t
+    GetBBitCodeSize() const {
+        return refine_bits_ == 0 ? 0 : minhash_bbit_code_size(this->mh_vec_length_, refine_bits_);
+    }
 
     ~MinHashLSH() {
         if (mmap_data_) {
@@ -140,6 +329,16 @@ class MinHashLSH {
     }
 
  private:
+    // re-ranks the candidates of a query by jaccard similarity, the rows of the delta read from its snapshot
+    void
+    RefineByJaccard(const char* query, const idx_t* cand_ids, size_t cand_num, size_t topk, float* distances,
+                    idx_t* labels, const MinHashLSHDelta::Snapshot& delta) const;
+    // the same with the b-bit codes of the rows
+    void
+    RefineByBBitJaccard(const char* query, const idx_t* cand_ids, size_t cand_num, size_t topk, float* distances,
+                        idx_t* labels, const MinHashLSHDelta::Snapshot& delta) const;
+
+    std::shared_ptr<MinHashLSHDelta> delta_;
     std::unique_ptr<MinHashBandIndex[]> band_index_;
     bool is_loaded_ = false;
     size_t block_size_ = 0;
@@ -148,7 +347,10 @@ class MinHashLSH {
     size_t file_size_ = 0;
     bool with_raw_data_ = false;
     char* raw_data_ = nullptr;  // mmap mode, use IO object later
-    std::vector<BloomFilter<KeyType>> bloom_;
+    size_t refine_bits_ = 0;
+    // the b-bit codes of the rows, in memory, when refine_bits_ is not 0
+    std::unique_ptr<uint64_t[]> bbit_codes_;
+    std::vector<BandBloomFilter> bloom_;
     size_t mh_vec_elememt_size_ = 0;
     size_t mh_vec_length_ = 0;
     size_t ntotal_ = 0;
@@ -158,6 +360,25 @@ namespace {
 constexpr int kBatch = 4096;
 constexpr int kQueryBatch = 64;
 constexpr int kQueryBandBatch = 4;
+// the sorted probes of a band that a task of BatchSearch merges with the keys of the band
+constexpr size_t kProbeBatch = 4096;
+// the runs of a band of the delta from which they are merged
+constexpr size_t kMaxDeltaRuns = 8;
+// written after the offsets of the bands in the file header, the header of the files without it being zero padded
+constexpr uint32_t kBandLayoutMagic = 0x4d484c59;
+
+// the position of key among n sorted keys from min to max, interpolated. Monotone in key, for the build to bound
+// the error of the positions that the searches predict.
+inline int64_t
+interpolate_pos(KeyType key, KeyType min, KeyType max, size_t n) {
+    if (key <= min || max == min) {
+        return 0;
+    }
+    if (key >= max) {
+        return n - 1;
+    }
+    return static_cast<int64_t>(static_cast<double>(key - min) / static_cast<double>(max - min) * (n - 1));
+}
 
 inline KeyType
 get_hash_key(const char* data, size_t size /*in bytes*/, size_t band, size_t band_i) {
@@ -205,7 +426,7 @@ sort_kv(const std::shared_ptr<KVPair[]> kv_code, size_t rows, size_t band) {
 
 size_t
 MinHashBandIndex::FormatAndSave(faiss::BlockFileIOWriter& writer, const KVPair* sorted_kv, const size_t block_size,
-                                const size_t rows) {
+                                const size_t rows, MinHashBandLayout layout) {
     size_t max_num_of_a_block = block_size / sizeof(KVPair);
     size_t blocks_num = (rows + max_num_of_a_block - 1) / max_num_of_a_block;
     std::vector<KeyType> mins;
@@ -240,12 +461,30 @@ MinHashBandIndex::FormatAndSave(faiss::BlockFileIOWriter& writer, const KVPair*
     writer.write((const char*)mins.data(), mins.size() * sizeof(KeyType));
     writer.write((const char*)maxs.data(), maxs.size() * sizeof(KeyType));
     writer.write((const char*)num_in_a_blk.data(), num_in_a_blk.size() * sizeof(size_t));
+    if (layout == MinHashBandLayout::LEARNED) {
+        size_t blocks_err = 0;
+        for (size_t i = 0; i < blocks_num; i++) {
+            auto pos = interpolate_pos(maxs[i], maxs.front(), maxs.back(), blocks_num);
+            blocks_err = std::max<size_t>(blocks_err, std::abs(pos - int64_t(i)));
+        }
+        std::vector<uint32_t> blk_errs(blocks_num, 0);
+        for (size_t i = 0; i < blocks_num; i++) {
+            const auto beg = i * max_num_of_a_block;
+            for (size_t j = 0; j < num_in_a_blk[i]; j++) {
+                auto pos = interpolate_pos(sorted_kv[beg + j].Key, mins[i], maxs[i], num_in_a_blk[i]);
+                blk_errs[i] = std::max<uint32_t>(blk_errs[i], std::abs(pos - int64_t(j)));
+            }
+        }
+        writeBinaryPOD(writer, blocks_err);
+        writer.write((const char*)blk_errs.data(), blk_errs.size() * sizeof(uint32_t));
+    }
     writer.flush();
     return index_meta_pos;
 }
 
 Status
-MinHashBandIndex::Load(FileReader& reader, size_t rows, char* mmap_data, BloomFilter<KeyType>& bloom_filter) {
+MinHashBandIndex::Load(FileReader& reader, size_t rows, char* mmap_data, MinHashBandLayout layout,
+                       BandBloomFilter& bloom_filter, std::vector<folly::Future<folly::Unit>>& futures) {
     size_t data_pos;
     readBinaryPOD(reader, this->blocks_num_);
     readBinaryPOD(reader, this->block_size_);
@@ -256,6 +495,12 @@ MinHashBandIndex::Load(FileReader& reader, size_t rows, char* mmap_data, BloomFi
     reader.read((char*)mins_.data(), mins_.size() * sizeof(KeyType));
     reader.read((char*)maxs_.data(), maxs_.size() * sizeof(KeyType));
     reader.read((char*)num_in_a_blk_.data(), num_in_a_blk_.size() * sizeof(size_t));
+    layout_ = layout;
+    if (layout_ == MinHashBandLayout::LEARNED) {
+        readBinaryPOD(reader, this->blocks_err_);
+        blk_errs_.resize(blocks_num_);
+        reader.read((char*)blk_errs_.data(), blk_errs_.size() * sizeof(uint32_t));
+    }
     if (mmap_data) {
         data_ = mmap_data + data_pos;
         mmap_enable_ = true;
@@ -268,22 +513,108 @@ MinHashBandIndex::Load(FileReader& reader, size_t rows, char* mmap_data, BloomFi
     }
 
     auto build_pool = ThreadPool::GetGlobalBuildThreadPool();
-    std::vector<folly::Future<folly::Unit>> futures;
     for (size_t i = 0; i < blocks_num_; i++) {
-        futures.emplace_back(build_pool->push([&, idx = i]() {
+        futures.emplace_back(build_pool->push([this, &bloom_filter, idx = i]() {
             KeyType* blk_i = reinterpret_cast<KeyType*>(data_ + block_size_ * idx);
             for (size_t j = 0; j < num_in_a_blk_[idx]; j++) {
                 bloom_filter.add(blk_i[j]);
             }
         }));
     }
-    WaitAllSuccess(futures);
     return Status::success;
 }
 
+int64_t
+MinHashBandIndex::FindBlock(KeyType key) const {
+    if (layout_ == MinHashBandLayout::SORTED) {
+        return faiss::u64_binary_search_ge(maxs_.data(), maxs_.size(), key);
+    }
+    if (maxs_.empty() || key > maxs_.back()) {
+        return -1;
+    }
+    // the key is between the max keys of the blocks before and at the block, so is its interpolated position
+    const auto pos = interpolate_pos(key, maxs_.front(), maxs_.back(), maxs_.size());
+    const auto err = static_cast<int64_t>(blocks_err_);
+    const auto lo = std::max<int64_t>(0, pos - err - 1);
+    const auto hi = std::min<int64_t>(maxs_.size(), pos + err + 2);
+    return std::lower_bound(maxs_.data() + lo, maxs_.data() + hi, key) - maxs_.data();
+}
+
+int64_t
+MinHashBandIndex::FindInBlock(size_t block_id, const KeyType* blk_k, KeyType key) const {
+    const size_t rows = num_in_a_blk_[block_id];
+    if (layout_ == MinHashBandLayout::SORTED) {
+        return faiss::u64_binary_search_eq(blk_k, rows, key);
+    }
+    const auto pos = interpolate_pos(key, mins_[block_id], maxs_[block_id], rows);
+    const auto err = static_cast<int64_t>(blk_errs_[block_id]);
+    const auto lo = std::max<int64_t>(0, pos - err);
+    const auto hi = std::min<int64_t>(rows, pos + err + 1);
+    const auto it = std::lower_bound(blk_k + lo, blk_k + hi, key);
+    return it != blk_k + hi && *it == key ? it - blk_k : -1;
+}
+
+namespace {
+// the first position from from on of a key not less than key, found by doubling the step from from: the cost is
+// logarithmic in the distance to the position rather than in the size
+inline size_t
+gallop_lower_bound(const KeyType* data, size_t from, size_t size, KeyType key) {
+    if (from >= size || data[from] >= key) {
+        return from;
+    }
+    size_t lo = from, step = 1;
+    while (lo + step < size && data[lo + step] < key) {
+        lo += step;
+        step *= 2;
+    }
+    return std::lower_bound(data + lo + 1, data + std::min(lo + step, size), key) - data;
+}
+}  // namespace
+
+void
+MinHashBandIndex::MergeSearch(const BandProbe* probes, size_t n, MinHashLSHResultHandler* res,
+                              faiss::IDSelector* id_selector) const {
+    size_t block_id = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < n; i++) {
+        const auto key = probes[i].key;
+        auto& query_res = res[probes[i].query_id];
+        if (query_res.full()) {
+            continue;
+        }
+        const auto next_block_id = gallop_lower_bound(maxs_.data(), block_id, maxs_.size(), key);
+        if (next_block_id == maxs_.size()) {
+            break;
+        }
+        if (next_block_id != block_id) {
+            block_id = next_block_id;
+            pos = 0;
+        }
+        // the keys equal to the key may run over the next blocks
+        for (size_t b = block_id; b < mins_.size() && key >= mins_[b] && !query_res.full(); b++) {
+            const size_t rows = num_in_a_blk_[b];
+            const KeyType* blk_k = reinterpret_cast<const KeyType*>(data_ + block_size_ * b);
+            const ValueType* blk_v =
+                reinterpret_cast<const ValueType*>(data_ + block_size_ * b + rows * sizeof(KeyType));
+            size_t j = gallop_lower_bound(blk_k, b == block_id ? pos : 0, rows, key);
+            if (b == block_id) {
+                pos = j;
+            }
+            for (; j < rows && blk_k[j] == key; j++) {
+                if (id_selector == nullptr || id_selector->is_member(blk_v[j])) {
+                    query_res.push(blk_v[j], 1.0);
+                }
+                if (query_res.full()) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
 void
 MinHashBandIndex::Search(KeyType key, MinHashLSHResultHandler* res, faiss::IDSelector* id_selector) const {
-    auto block_id = faiss::u64_binary_search_ge(maxs_.data(), maxs_.size(), key);
+    auto block_id = FindBlock(key);
 
     if (block_id == -1 || key < mins_[block_id]) {
         return;
@@ -292,7 +623,7 @@ MinHashBandIndex::Search(KeyType key, MinHashLSHResultHandler* res, faiss::IDSel
         size_t rows = num_in_a_blk_[block_id];
         KeyType* blk_k = reinterpret_cast<KeyType*>(data_ + block_size_ * block_id);
         ValueType* blk_v = reinterpret_cast<ValueType*>(data_ + block_size_ * block_id + rows * sizeof(KeyType));
-        int inner_id = faiss::u64_binary_search_eq(blk_k, rows, key);
+        auto inner_id = FindInBlock(block_id, blk_k, key);
         if (inner_id != -1) {
             for (; key == blk_k[inner_id] && (size_t)inner_id < rows; inner_id++) {
                 if (id_selector == nullptr || id_selector->is_member(blk_v[inner_id])) {
@@ -307,6 +638,128 @@ MinHashBandIndex::Search(KeyType key, MinHashLSHResultHandler* res, faiss::IDSel
     return;
 }
 
+void
+MinHashLSHDelta::Snapshot::Search(size_t band_i, KeyType key, MinHashLSHResultHandler* res,
+                                  faiss::IDSelector* id_selector) const {
+    for (const auto& run : runs[band_i]) {
+        auto it = std::lower_bound(run->keys.begin(), run->keys.end(), key);
+        for (size_t j = it - run->keys.begin(); j < run->keys.size() && run->keys[j] == key; j++) {
+            if (id_selector == nullptr || id_selector->is_member(run->ids[j])) {
+                res->push(run->ids[j], 1.0);
+            }
+            if (res->full()) {
+                return;
+            }
+        }
+    }
+}
+
+const char*
+MinHashLSHDelta::Snapshot::GetRow(idx_t id) const {
+    auto it = std::upper_bound(raw.begin(), raw.end(), id,
+                               [](idx_t row_id, const RawBatch& batch) { return row_id < batch.first_id; });
+    if (it == raw.begin()) {
+        return nullptr;
+    }
+    --it;
+    if (id >= it->first_id + static_cast<idx_t>(it->rows)) {
+        return nullptr;
+    }
+    return it->data.get() + (id - it->first_id) * vec_size;
+}
+
+MinHashLSHDelta::MinHashLSHDelta(size_t band, size_t vec_size, idx_t first_id, bool with_raw_data)
+    : band_(band), vec_size_(vec_size), first_id_(first_id), with_raw_data_(with_raw_data), merging_(band, false) {
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->runs.resize(band_);
+    snapshot->vec_size = vec_size_;
+    snapshot_ = std::move(snapshot);
+}
+
+Status
+MinHashLSHDelta::Add(const char* data, size_t rows) {
+    if (rows == 0) {
+        return Status::success;
+    }
+    std::lock_guard<std::mutex> add_lock(add_mutex_);
+    const idx_t first_id = first_id_ + GetSnapshot()->count;
+    // only the new rows are sorted, into a run of each band
+    auto kv = gen_transposed_hash_kv(data, rows, vec_size_, band_);
+    sort_kv(kv, rows, band_);
+    std::vector<std::shared_ptr<const Run>> new_runs(band_);
+    for (size_t b = 0; b < band_; b++) {
+        auto run = std::make_shared<Run>();
+        run->keys.resize(rows);
+        run->ids.resize(rows);
+        for (size_t j = 0; j < rows; j++) {
+            run->keys[j] = kv.get()[b * rows + j].Key;
+            run->ids[j] = first_id + kv.get()[b * rows + j].Value;
+        }
+        new_runs[b] = std::move(run);
+    }
+    std::shared_ptr<char[]> raw_data = nullptr;
+    if (with_raw_data_) {
+        raw_data = std::shared_ptr<char[]>(new char[rows * vec_size_]);
+        std::memcpy(raw_data.get(), data, rows * vec_size_);
+    }
+
+    std::vector<size_t> to_merge;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto next = std::make_shared<Snapshot>(*snapshot_);
+        for (size_t b = 0; b < band_; b++) {
+            next->runs[b].push_back(std::move(new_runs[b]));
+            if (next->runs[b].size() >= kMaxDeltaRuns && !merging_[b]) {
+                merging_[b] = true;
+                to_merge.push_back(b);
+            }
+        }
+        if (raw_data != nullptr) {
+            next->raw.push_back({first_id, rows, std::move(raw_data)});
+        }
+        next->count += rows;
+        next->bytes += rows * band_ * (sizeof(KeyType) + sizeof(ValueType)) + (with_raw_data_ ? rows * vec_size_ : 0);
+        snapshot_ = std::move(next);
+    }
+    // the merges run in the background, the tasks keeping the delta alive
+    auto build_pool = ThreadPool::GetGlobalBuildThreadPool();
+    for (auto b : to_merge) {
+        build_pool->push([self = shared_from_this(), b]() { self->MergeBand(b); });
+    }
+    return Status::success;
+}
+
+void
+MinHashLSHDelta::MergeBand(size_t band_i) {
+    // the runs are only appended to while the merge of the band runs, so those merged stay the first ones
+    auto runs = GetSnapshot()->runs[band_i];
+    auto merged = std::make_shared<Run>();
+    for (const auto& run : runs) {
+        Run next;
+        next.keys.resize(merged->keys.size() + run->keys.size());
+        next.ids.resize(next.keys.size());
+        size_t i = 0, j = 0, o = 0;
+        // the older rows stay first among those of equal keys
+        while (i < merged->keys.size() || j < run->keys.size()) {
+            if (j == run->keys.size() || (i < merged->keys.size() && merged->keys[i] <= run->keys[j])) {
+                next.keys[o] = merged->keys[i];
+                next.ids[o++] = merged->ids[i++];
+            } else {
+                next.keys[o] = run->keys[j];
+                next.ids[o++] = run->ids[j++];
+            }
+        }
+        *merged = std::move(next);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto next = std::make_shared<Snapshot>(*snapshot_);
+    auto& band_runs = next->runs[band_i];
+    band_runs.erase(band_runs.begin(), band_runs.begin() + runs.size());
+    band_runs.insert(band_runs.begin(), std::move(merged));
+    snapshot_ = std::move(next);
+    merging_[band_i] = false;
+}
+
 Status
 MinHashLSH::BuildAndSave(MinHashLSHBuildParams* params) {
     if (params == nullptr) {
@@ -320,6 +773,14 @@ MinHashLSH::BuildAndSave(MinHashLSHBuildParams* params) {
     size_t data_size = mh_vec_element_size * mh_vec_length;
     size_t ntotal, bin_vec_dim;
     int64_t data_pos = -1;
+    int64_t bbit_pos = -1;
+    const size_t refine_bits = params->refine_bits;
+    if (refine_bits != 0 && refine_bits != 1 && refine_bits != 2 && refine_bits != 4 && refine_bits != 8) {
+        LOG_KNOWHERE_ERROR_ << "refine bits(" << refine_bits << ") should be one of {0, 1, 2, 4, 8}.";
+        return Status::invalid_args;
+    }
+    std::unique_ptr<uint8_t[]> bbit_codes = nullptr;
+    const size_t bbit_code_size = refine_bits == 0 ? 0 : minhash_bbit_code_size(mh_vec_length, refine_bits);
     if (params->with_raw_data) {
         block_size = ROUND_UP(mh_vec_element_size * mh_vec_length, block_size);
     }
@@ -344,6 +805,13 @@ MinHashLSH::BuildAndSave(MinHashLSHBuildParams* params) {
         }
 
         total_kv_pair = gen_transposed_hash_kv(data.get(), ntotal, data_size, band_index_n);
+        if (refine_bits != 0) {
+            bbit_codes = std::make_unique<uint8_t[]>(ntotal * bbit_code_size);
+            for (size_t i = 0; i < ntotal; i++) {
+                minhash_bbit_encode(data.get() + i * data_size, mh_vec_length, mh_vec_element_size, refine_bits,
+                                    bbit_codes.get() + i * bbit_code_size);
+            }
+        }
         if (params->with_raw_data) {
             data_pos = writer.tellg();
             // todo: @cqy123456 format raw data if use disk index
@@ -363,10 +831,19 @@ MinHashLSH::BuildAndSave(MinHashLSHBuildParams* params) {
 
         for (size_t index_i = 0; index_i < band_index_n; index_i++) {
             band_index_ofs[index_i] =
-                MinHashBandIndex::FormatAndSave(writer, total_kv_pair.get() + index_i * ntotal, block_size, ntotal);
+                MinHashBandIndex::FormatAndSave(writer, total_kv_pair.get() + index_i * ntotal, block_size, ntotal,
+                                                params->band_layout);
         }
     }
 
+    // save the b-bit codes, after the bands
+    if (bbit_codes != nullptr) {
+        writer.flush();
+        bbit_pos = writer.tellg();
+        writer.write((const char*)bbit_codes.get(), ntotal * bbit_code_size);
+        writer.flush();
+    }
+
     // write file header
     {
         MemoryIOWriter header_writer;
@@ -377,6 +854,10 @@ MinHashLSH::BuildAndSave(MinHashLSHBuildParams* params) {
         writeBinaryPOD(header_writer, band_index_n);
         writeBinaryPOD(header_writer, data_pos);
         header_writer.write((char*)band_index_ofs.data(), band_index_ofs.size() * sizeof(size_t));
+        writeBinaryPOD(header_writer, kBandLayoutMagic);
+        writeBinaryPOD(header_writer, static_cast<uint32_t>(params->band_layout));
+        writeBinaryPOD(header_writer, static_cast<uint32_t>(refine_bits));
+        writeBinaryPOD(header_writer, bbit_pos);
         writer.write_header((char*)header_writer.data_, header_writer.rp_);
         if (header_writer.data_) {
             delete[] header_writer.data_;
@@ -428,20 +909,134 @@ MinHashLSH::Load(MinHashLSHLoadParams* params) {
     band_index_ = std::make_unique<MinHashBandIndex[]>(band_);
     std::vector<size_t> band_index_ofs(band_);
     reader.read((char*)band_index_ofs.data(), band_index_ofs.size() * sizeof(size_t));
+    // the indexes built before the layouts were added are sorted
+    auto layout = MinHashBandLayout::SORTED;
+    uint32_t layout_magic;
+    readBinaryPOD(reader, layout_magic);
+    if (layout_magic == kBandLayoutMagic) {
+        uint32_t layout_value;
+        readBinaryPOD(reader, layout_value);
+        if (layout_value > static_cast<uint32_t>(MinHashBandLayout::LEARNED)) {
+            LOG_KNOWHERE_ERROR_ << "unknown band layout " << layout_value << " of the minhash lsh index.";
+            return Status::invalid_serialized_index_type;
+        }
+        layout = static_cast<MinHashBandLayout>(layout_value);
+        // the header being zero padded, the indexes built before the b-bit codes were added refine with raw data
+        uint32_t refine_bits;
+        int64_t bbit_pos;
+        readBinaryPOD(reader, refine_bits);
+        readBinaryPOD(reader, bbit_pos);
+        this->refine_bits_ = refine_bits;
+        if (refine_bits != 0) {
+            const size_t code_bytes = this->ntotal_ * GetBBitCodeSize();
+            bbit_codes_ = std::make_unique<uint64_t[]>(code_bytes / sizeof(uint64_t));
+            reader.seek(bbit_pos);
+            reader.read((char*)bbit_codes_.get(), code_bytes);
+        }
+    }
     size_t bloom_filter_num = params->global_bloom_filter ? 1 : this->band_;
     bloom_.reserve(bloom_filter_num);
     for (size_t i = 0; i < bloom_filter_num; i++) {
-        bloom_.emplace_back(this->ntotal_, params->false_positive_prob);
+        bloom_.emplace_back(params->bloom_filter_type, this->ntotal_, params->false_positive_prob);
     }
     auto band_mmap_addr = params->hash_code_in_memory ? nullptr : this->mmap_data_;
+    std::vector<folly::Future<folly::Unit>> futures;
     for (size_t i = 0; i < band_; i++) {
         reader.seek(band_index_ofs[i]);
-        band_index_[i].Load(reader, this->ntotal_, band_mmap_addr, bloom_[i % bloom_.size()]);
+        band_index_[i].Load(reader, this->ntotal_, band_mmap_addr, layout, bloom_[i % bloom_.size()], futures);
     }
+    WaitAllSuccess(futures);
+    // the codes of the rows of the delta are encoded from their raw data by the refine
+    delta_ = std::make_shared<MinHashLSHDelta>(band_, GetVectorSize(), ntotal_, with_raw_data_ || refine_bits_ != 0);
     is_loaded_ = true;
     return Status::success;
 }
 
+Status
+MinHashLSH::Add(const char* data, size_t n) {
+    if (!is_loaded_) {
+        LOG_KNOWHERE_ERROR_ << "fail to add rows to a minhash lsh index that is not loaded.";
+        return Status::empty_index;
+    }
+    return delta_->Add(data, n);
+}
+
+void
+MinHashLSH::RefineByJaccard(const char* query, const idx_t* cand_ids, size_t cand_num, size_t topk, float* distances,
+                            idx_t* labels, const MinHashLSHDelta::Snapshot& delta) const {
+    if (refine_bits_ != 0) {
+        RefineByBBitJaccard(query, cand_ids, cand_num, topk, distances, labels, delta);
+        return;
+    }
+    if (delta.count == 0) {
+        minhash_jaccard_knn_ny_by_ids(query, this->raw_data_, cand_ids, this->mh_vec_length_,
+                                      this->mh_vec_elememt_size_, cand_num, topk, distances, labels);
+        return;
+    }
+    // the rows of the delta are not after those of the index, so the candidates are gathered
+    const size_t vec_size = GetVectorSize();
+    auto rows = std::make_unique<char[]>(cand_num * vec_size);
+    std::vector<idx_t> row_ids;
+    row_ids.reserve(cand_num);
+    for (size_t i = 0; i < cand_num; i++) {
+        const auto id = cand_ids[i];
+        const char* row = id < 0 ? nullptr : (size_t(id) < ntotal_ ? raw_data_ + id * vec_size : delta.GetRow(id));
+        if (row != nullptr) {
+            std::memcpy(rows.get() + row_ids.size() * vec_size, row, vec_size);
+            row_ids.push_back(id);
+        }
+    }
+    std::vector<idx_t> positions(row_ids.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    minhash_jaccard_knn_ny_by_ids(query, rows.get(), positions.data(), this->mh_vec_length_, this->mh_vec_elememt_size_,
+                                  positions.size(), topk, distances, labels);
+    for (size_t i = 0; i < topk; i++) {
+        if (labels[i] >= 0) {
+            labels[i] = row_ids[labels[i]];
+        }
+    }
+}
+
+void
+MinHashLSH::RefineByBBitJaccard(const char* query, const idx_t* cand_ids, size_t cand_num, size_t topk,
+                                float* distances, idx_t* labels, const MinHashLSHDelta::Snapshot& delta) const {
+    const size_t code_size = GetBBitCodeSize();
+    auto query_code = std::make_unique<uint64_t[]>(code_size / sizeof(uint64_t));
+    minhash_bbit_encode(query, mh_vec_length_, mh_vec_elememt_size_, refine_bits_, (uint8_t*)query_code.get());
+    if (delta.count == 0) {
+        minhash_bbit_jaccard_knn_ny_by_ids((const uint8_t*)query_code.get(), (const uint8_t*)bbit_codes_.get(),
+                                           cand_ids, mh_vec_length_, refine_bits_, cand_num, topk, distances, labels);
+        return;
+    }
+    auto codes = std::make_unique<uint64_t[]>(cand_num * code_size / sizeof(uint64_t));
+    auto* codes_data = (uint8_t*)codes.get();
+    std::vector<idx_t> row_ids;
+    row_ids.reserve(cand_num);
+    for (size_t i = 0; i < cand_num; i++) {
+        const auto id = cand_ids[i];
+        auto* code = codes_data + row_ids.size() * code_size;
+        if (id < 0) {
+            continue;
+        } else if (size_t(id) < ntotal_) {
+            std::memcpy(code, (const uint8_t*)bbit_codes_.get() + id * code_size, code_size);
+        } else if (const char* row = delta.GetRow(id); row != nullptr) {
+            minhash_bbit_encode(row, mh_vec_length_, mh_vec_elememt_size_, refine_bits_, code);
+        } else {
+            continue;
+        }
+        row_ids.push_back(id);
+    }
+    std::vector<idx_t> positions(row_ids.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    minhash_bbit_jaccard_knn_ny_by_ids((const uint8_t*)query_code.get(), codes_data, positions.data(), mh_vec_length_,
+                                       refine_bits_, positions.size(), topk, distances, labels);
+    for (size_t i = 0; i < topk; i++) {
+        if (labels[i] >= 0) {
+            labels[i] = row_ids[labels[i]];
+        }
+    }
+}
+
 Status
 MinHashLSH::Search(const char* query, float* distances, idx_t* labels, MinHashLSHSearchParams* params) const {
     if (params == nullptr) {
@@ -449,8 +1044,8 @@ MinHashLSH::Search(const char* query, float* distances, idx_t* labels, MinHashLS
         return Status::invalid_args;
     }
     auto search_with_jaccard = params->search_with_jaccard;
-    if (search_with_jaccard && !this->with_raw_data_) {
-        LOG_KNOWHERE_ERROR_ << "fail to search with jaccard distance without raw data.";
+    if (search_with_jaccard && !this->with_raw_data_ && refine_bits_ == 0) {
+        LOG_KNOWHERE_ERROR_ << "fail to search with jaccard distance without raw data or b-bit codes.";
         return Status::invalid_args;
     }
     auto topk = params->k;
@@ -478,9 +1073,14 @@ MinHashLSH::Search(const char* query, float* distances, idx_t* labels, MinHashLS
         if (res->full())
             break;
     }
+    // the rows added since the index was loaded
+    const auto delta = delta_->GetSnapshot();
+    for (size_t i = 0; i < band_ && delta->count > 0 && !res->full(); i++) {
+        const auto hash = get_hash_key(query, this->mh_vec_elememt_size_ * this->mh_vec_length_, band_, i);
+        delta->Search(i, hash, res.get(), id_selector);
+    }
     if (search_with_jaccard) {
-        minhash_jaccard_knn_ny_by_ids(query, this->raw_data_, reorder_ids.get(), this->mh_vec_length_,
-                                      this->mh_vec_elememt_size_, res->topk_, topk, distances, labels);
+        RefineByJaccard(query, reorder_ids.get(), res->topk_, topk, distances, labels, *delta);
     }
     return Status::success;
 }
@@ -492,8 +1092,8 @@ MinHashLSH::BatchSearch(const char* query, size_t nq, float* distances, idx_t* l
         return Status::invalid_args;
     }
     auto search_with_jaccard = params->search_with_jaccard;
-    if (search_with_jaccard && !this->with_raw_data_) {
-        LOG_KNOWHERE_ERROR_ << "fail to search with jaccard distance without raw data.";
+    if (search_with_jaccard && !this->with_raw_data_ && refine_bits_ == 0) {
+        LOG_KNOWHERE_ERROR_ << "fail to search with jaccard distance without raw data or b-bit codes.";
         return Status::invalid_args;
     }
     auto topk = params->k;
@@ -517,72 +1117,96 @@ MinHashLSH::BatchSearch(const char* query, size_t nq, float* distances, idx_t* l
             all_res.emplace_back(labels + i * topk, distances + i * topk, topk);
         }
     }
-    // search bands
-    auto search_bands_list = [&](const char* query, size_t beg, size_t end, MinHashLSHResultHandler* res) {
-        for (auto i = beg; i < end; i++) {
-            const auto hash = get_hash_key(query, this->mh_vec_elememt_size_ * this->mh_vec_length_, band_, i);
-            auto& band = band_index_[i];
-            auto& bloom = bloom_[i % bloom_.size()];
-            if (bloom.contains(hash)) {
-                band.Search(hash, res, id_selector);
-            }
-            if (res->full())
-                break;
-        }
-    };
+    // probe the bands one after another with the keys of all the queries that are not full yet, sorted, for the
+    // searches to merge them with the sorted keys of the band instead of binary searching them one by one
+    const size_t vec_size = mh_vec_elememt_size_ * mh_vec_length_;
     std::vector<folly::Future<folly::Unit>> futures;
     std::vector<size_t> access_list(nq);
     for (size_t i = 0; i < nq; i++) {
         access_list[i] = i;
     }
-    size_t band_ofs = 0;
-    while (access_list.size() && band_ofs < this->band_) {
-        size_t band_beg = band_ofs;
-        size_t bend_end = std::min(band_beg + kQueryBandBatch, band_);
-        for (size_t i = band_beg; i < bend_end; i++) {
-            band_index_[i].WarmUp();
-        }
-        size_t access_num = access_list.size();
-        size_t run_time = (access_num + kQueryBatch - 1) / kQueryBatch;
-        futures.reserve(run_time);
-        for (size_t row = 0; row < run_time; ++row) {
-            futures.emplace_back(
-                pool->push([&, beg = row * kQueryBatch, end = std::min((size_t)((row + 1) * kQueryBatch), access_num),
-                            p_id_ptr = labels, p_dist_ptr = distances]() {
-                    for (size_t index = beg; index < end; index++) {
-                        auto query_id = access_list[index];
-                        search_bands_list(query + mh_vec_elememt_size_ * mh_vec_length_ * query_id, beg, end,
-                                          &all_res[query_id]);
-                    }
-                }));
+    std::vector<KeyType> keys;
+    std::vector<uint8_t> maybe_in_band;
+    std::vector<BandProbe> probes;
+    for (size_t band_i = 0; band_i < band_ && !access_list.empty(); band_i++) {
+        if (band_i % kQueryBandBatch == 0) {
+            for (size_t i = band_i; i < std::min(band_i + kQueryBandBatch, band_); i++) {
+                band_index_[i].WarmUp();
+            }
+        }
+        const size_t access_num = access_list.size();
+        keys.resize(access_num);
+        maybe_in_band.resize(access_num);
+        auto& bloom = bloom_[band_i % bloom_.size()];
+        for (size_t beg = 0; beg < access_num; beg += kBatch) {
+            futures.emplace_back(pool->push([&, beg, end = std::min(beg + kBatch, access_num)]() {
+                for (size_t i = beg; i < end; i++) {
+                    keys[i] = get_hash_key(query + vec_size * access_list[i], vec_size, band_, band_i);
+                }
+                bloom.contains_batch(keys.data() + beg, end - beg, maybe_in_band.data() + beg);
+            }));
         }
         WaitAllSuccess(futures);
         futures.clear();
+
+        probes.clear();
+        for (size_t i = 0; i < access_num; i++) {
+            if (maybe_in_band[i]) {
+                probes.push_back({keys[i], access_list[i]});
+            }
+        }
+        std::sort(probes.begin(), probes.end(),
+                  [](const BandProbe& a, const BandProbe& b) { return a.key < b.key; });
+        // a query probes a band once, so the chunks of the probes fill the results of distinct queries
+        const auto& band = band_index_[band_i];
+        for (size_t beg = 0; beg < probes.size(); beg += kProbeBatch) {
+            futures.emplace_back(pool->push([&, beg, end = std::min(beg + kProbeBatch, probes.size())]() {
+                band.MergeSearch(probes.data() + beg, end - beg, all_res.data(), id_selector);
+            }));
+        }
+        WaitAllSuccess(futures);
+        futures.clear();
+
         std::vector<size_t> new_access_list;
         for (auto q_i : access_list) {
             if (!all_res[q_i].full()) {
                 new_access_list.emplace_back(q_i);
             }
         }
-        band_ofs += kQueryBandBatch;
-        access_list = new_access_list;
+        access_list = std::move(new_access_list);
+    }
+    // the rows added since the index was loaded, for the queries that are not full yet
+    const auto delta = delta_->GetSnapshot();
+    if (delta->count > 0) {
+        for (size_t beg = 0; beg < access_list.size(); beg += kQueryBatch) {
+            futures.emplace_back(pool->push([&, beg, end = std::min(beg + kQueryBatch, access_list.size())]() {
+                for (size_t i = beg; i < end; i++) {
+                    const auto query_id = access_list[i];
+                    const char* q = query + vec_size * query_id;
+                    for (size_t b = 0; b < band_ && !all_res[query_id].full(); b++) {
+                        delta->Search(b, get_hash_key(q, vec_size, band_, b), &all_res[query_id], id_selector);
+                    }
+                }
+            }));
+        }
+        WaitAllSuccess(futures);
+        futures.clear();
     }
     // reorder by jaccard distance
     if (search_with_jaccard) {
         futures.reserve(nq);
         for (size_t i = 0; i < nq; i++) {
             futures.emplace_back(pool->push([&, id = i]() {
-                const char* q = query + i * mh_vec_elememt_size_ * mh_vec_length_;
-                auto reorder_ids = all_res[i].ids_list_;
-                auto refine_k = all_res[i].topk_;
-                auto res_ids = labels + i * topk;
-                auto res_dis = distances + i * topk;
-                minhash_jaccard_knn_ny_by_ids(q, this->raw_data_, reorder_ids, this->mh_vec_length_,
-                                              this->mh_vec_elememt_size_, refine_k, topk, res_dis, res_ids);
+                const char* q = query + id * mh_vec_elememt_size_ * mh_vec_length_;
+                auto reorder_ids = all_res[id].ids_list_;
+                auto refine_k = all_res[id].topk_;
+                auto res_ids = labels + id * topk;
+                auto res_dis = distances + id * topk;
+                RefineByJaccard(q, reorder_ids, refine_k, topk, res_dis, res_ids, *delta);
                 return;
             }));
-            WaitAllSuccess(futures);
         }
+        WaitAllSuccess(futures);
     }
     return Status::success;
 }
@@ -591,9 +1215,15 @@ Status
 MinHashLSH::GetDataByIds(const idx_t* ids, size_t n, char* data) const {
     if (this->with_raw_data_) {
         auto mh_vec_size = this->mh_vec_elememt_size_ * this->mh_vec_length_;
+        const auto delta = delta_->GetSnapshot();
         for (size_t i = 0; i < n; i++) {
             char* des = data + i * mh_vec_size;
-            char* src = this->raw_data_ + ids[i] * mh_vec_size;
+            const char* src =
+                size_t(ids[i]) < this->ntotal_ ? this->raw_data_ + ids[i] * mh_vec_size : delta->GetRow(ids[i]);
+            if (src == nullptr) {
+                LOG_KNOWHERE_ERROR_ << "id " << ids[i] << " is out of the range of the minhash lsh index.";
+                return Status::invalid_args;
+            }
             std::memcpy(des, src, mh_vec_size);
         }
         return Status::success;
@@ -19,11 +19,21 @@ namespace knowhere {
 class MinHashLSHConfig : public BaseConfig {
  public:
     CFG_INT mh_lsh_aligned_block_size;
+    // How the sorted keys of every band are searched, one of {sorted, learned}: "learned" interpolates the position of
+    // the keys within the error bounds recorded at build time, for fewer cache misses and page faults per probe.
+    CFG_STRING mh_lsh_band_layout;
     CFG_BOOL mh_lsh_code_in_mem;
     CFG_BOOL mh_lsh_shared_bloom_filter;
     CFG_FLOAT mh_lsh_bloom_false_positive_prob;
+    // The bloom filters of the bands, one of {classic, split_block}: "split_block" reads one cache line per lookup, for
+    // the lookups of absent keys to be cheaper, at a slightly higher false positive rate for the same memory.
+    CFG_STRING mh_lsh_bloom_filter_type;
     CFG_BOOL with_raw_data;
     CFG_INT refine_k;
+    // The bits of every hash that the jaccard refine keeps in memory, one of {0, 1, 2, 4, 8}: b-bit codes take
+    // b / mh_element_bit_width of the memory of the raw data, for an estimate of the similarity; 0 refines with the
+    // full hashes of the raw data.
+    CFG_INT mh_lsh_refine_bits;
     CFG_BOOL mh_lsh_batch_search;
     KNOHWERE_DECLARE_CONFIG(MinHashLSHConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(mh_lsh_aligned_block_size)
@@ -31,6 +41,10 @@ class MinHashLSHConfig : public BaseConfig {
             .set_default(4096)
             .set_range(4096, std::numeric_limits<CFG_INT::value_type>::max())
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(mh_lsh_band_layout)
+            .description("the layout of the keys of the bands, one of {sorted, learned}.")
+            .set_default("sorted")
+            .for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(mh_lsh_code_in_mem)
             .description("hash code is in ann-rss or in mmap file.")
             .set_default(true)
@@ -44,11 +58,20 @@ class MinHashLSHConfig : public BaseConfig {
             .set_default(0.01)
             .set_range(0.0, 1.0)
             .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(mh_lsh_bloom_filter_type)
+            .description("the bloom filters of the bands, one of {classic, split_block}.")
+            .set_default("classic")
+            .for_deserialize();
         KNOWHERE_CONFIG_DECLARE_FIELD(refine_k)
             .description("only useful in mh_search_with_jaccard, the search topk of minhash lsh.")
             .set_default(1)
             .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
             .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(mh_lsh_refine_bits)
+            .description("the bits of every hash that the jaccard refine keeps, one of {0, 1, 2, 4, 8}, 0 for all.")
+            .set_default(0)
+            .set_range(0, 8)
+            .for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(with_raw_data)
             .description("if with_raw_data = true, index will keep raw data in the index.")
             .set_default(false)
@@ -58,6 +81,29 @@ class MinHashLSHConfig : public BaseConfig {
             .set_default(false)
             .for_search();
     }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type == PARAM_TYPE::TRAIN && mh_lsh_band_layout.value() != "sorted" &&
+            mh_lsh_band_layout.value() != "learned") {
+            std::string msg =
+                "mh_lsh_band_layout(" + mh_lsh_band_layout.value() + ") should be one of {sorted, learned}";
+            return HandleError(err_msg, msg, Status::invalid_args);
+        }
+        if (param_type == PARAM_TYPE::TRAIN && mh_lsh_refine_bits.value() != 0 && mh_lsh_refine_bits.value() != 1 &&
+            mh_lsh_refine_bits.value() != 2 && mh_lsh_refine_bits.value() != 4 && mh_lsh_refine_bits.value() != 8) {
+            std::string msg = "mh_lsh_refine_bits(" + std::to_string(mh_lsh_refine_bits.value()) +
+                              ") should be one of {0, 1, 2, 4, 8}";
+            return HandleError(err_msg, msg, Status::invalid_args);
+        }
+        if (param_type == PARAM_TYPE::DESERIALIZE && mh_lsh_bloom_filter_type.value() != "classic" &&
+            mh_lsh_bloom_filter_type.value() != "split_block") {
+            std::string msg = "mh_lsh_bloom_filter_type(" + mh_lsh_bloom_filter_type.value() +
+                              ") should be one of {classic, split_block}";
+            return HandleError(err_msg, msg, Status::invalid_args);
+        }
+        return Status::success;
+    }
 };
 }  // namespace knowhere
 
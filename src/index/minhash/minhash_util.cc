@@ -15,6 +15,10 @@ using JcaccardSim = faiss::CMin<float, idx_t>;
 using DIST1FUNC = float (*)(const char* x, const char* y, size_t element_length, size_t element_size);
 using DIST4FUNC = void (*)(const char* x, const char* y0, const char* y1, const char* y2, const char* y3, size_t size,
                            size_t element_size, float& dis0, float& dis1, float& dis2, float& dis3);
+using DIST16FUNC = void (*)(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                            float* dis);
+constexpr size_t kJaccardBatchSize = 16;
+
 inline float
 minhash_jaccard_native(const char* x, const char* y, size_t element_length, size_t element_size) {
     float res = 0;
@@ -48,6 +52,13 @@ minhash_jaccard_batch_4_native(const char* x, const char* y0, const char* y1, co
     return;
 }
 
+inline void
+minhash_jaccard_batch_16_native(const char* x, const char* const* y, size_t size, size_t element_size, float* dis) {
+    for (size_t j = 0; j < kJaccardBatchSize; j++) {
+        dis[j] = minhash_jaccard_native(x, y[j], size, element_size);
+    }
+}
+
 inline float
 minhash_lsh_hit(const char* x, const char* y, size_t size, size_t mh_lsh_band) {
     size_t r = size / (mh_lsh_band);
@@ -68,6 +79,7 @@ struct MinHashJaccardComputer : faiss::DistanceComputer {
     size_t element_length;  // minhash vector dim
     DIST1FUNC dist1;
     DIST4FUNC dist4;
+    DIST16FUNC dist16;
     size_t element_size;  // minhash vector element size(in bytes)
     size_t vec_size;      // total minhash vector size
     MinHashJaccardComputer(const char* x, const size_t l, const size_t es)
@@ -75,12 +87,15 @@ struct MinHashJaccardComputer : faiss::DistanceComputer {
         if (element_size == 4) {
             dist1 = faiss::u32_jaccard_distance;
             dist4 = faiss::u32_jaccard_distance_batch_4;
+            dist16 = faiss::u32_jaccard_distance_batch_16;
         } else if (element_size == 8) {
             dist1 = faiss::u64_jaccard_distance;
             dist4 = faiss::u64_jaccard_distance_batch_4;
+            dist16 = faiss::u64_jaccard_distance_batch_16;
         } else {
             dist1 = &minhash_jaccard_native;
             dist4 = &minhash_jaccard_batch_4_native;
+            dist16 = &minhash_jaccard_batch_16_native;
         }
         vec_size = element_size * element_length;
     }
@@ -105,11 +120,44 @@ struct MinHashJaccardComputer : faiss::DistanceComputer {
         const char* xb_3 = base + idx3 * vec_size;
         dist4(q, xb_0, xb_1, xb_2, xb_3, element_length, element_size, dis0, dis1, dis2, dis3);
     }
+    void
+    distances_batch_16(const idx_t* idx, float* dis) {
+        const char* xb[kJaccardBatchSize];
+        for (size_t j = 0; j < kJaccardBatchSize; j++) {
+            xb[j] = base + idx[j] * vec_size;
+        }
+        dist16(q, xb, element_length, element_size, dis);
+    }
     float
     symmetric_dis(idx_t i, idx_t j) override {
         return dist1(base + i * vec_size, base + j * vec_size, element_length, element_size);
     }
 };
+
+// like faiss::distance_compute_if, but gathers the ids that pass the filter into batches of 16
+template <typename Filter, typename GetId, typename Apply>
+void
+jaccard_compute_if(const size_t n, MinHashJaccardComputer* computer, Filter filter, GetId get_id, Apply apply) {
+    idx_t ids[kJaccardBatchSize];
+    float dis[kJaccardBatchSize];
+    size_t num_ids = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!filter(i)) {
+            continue;
+        }
+        ids[num_ids++] = get_id(i);
+        if (num_ids == kJaccardBatchSize) {
+            computer->distances_batch_16(ids, dis);
+            for (size_t j = 0; j < kJaccardBatchSize; j++) {
+                apply(dis[j], ids[j]);
+            }
+            num_ids = 0;
+        }
+    }
+    for (size_t j = 0; j < num_ids; j++) {
+        apply(computer->operator()(ids[j]), ids[j]);
+    }
+}
 }  // namespace
 
 void
@@ -144,7 +192,7 @@ minhash_jaccard_knn_ny(const char* x, const char* y, size_t length, size_t eleme
             faiss::heap_replace_top<JcaccardSim>(topk, vals, ids, dis_in, j);
         }
     };
-    faiss::distance_compute_if(ny, computer.get(), filter, apply);
+    jaccard_compute_if(ny, computer.get(), filter, [](const size_t j) { return (idx_t)j; }, apply);
 }
 
 void
@@ -162,19 +210,100 @@ minhash_jaccard_knn_ny_by_ids(const char* x, const char* y, const int64_t* sel_i
     };
     auto computer = std::make_shared<MinHashJaccardComputer>(y, length, element_size);
     computer->set_query((const float*)x);
-    size_t i = 0;
-    float dis0, dis1, dis2, dis3;
-    for (; i + 4 < sel_ids_num; i += 4) {
-        computer->distances_batch_4(sel_ids[i], sel_ids[i + 1], sel_ids[i + 2], sel_ids[i + 3], dis0, dis1, dis2, dis3);
-        apply(dis0, sel_ids[i]);
-        apply(dis1, sel_ids[i + 1]);
-        apply(dis2, sel_ids[i + 2]);
-        apply(dis3, sel_ids[i + 3]);
-    }
-    while (i < sel_ids_num) {
-        auto dis = computer->operator()(sel_ids[i]);
-        apply(dis, sel_ids[i]);
-        i++;
+    jaccard_compute_if(
+        sel_ids_num, computer.get(), [](const size_t) { return true; }, [&](const size_t i) { return sel_ids[i]; },
+        apply);
+}
+
+size_t
+minhash_bbit_code_size(size_t length, size_t bits) {
+    return (length * bits + 63) / 64 * sizeof(uint64_t);
+}
+
+void
+minhash_bbit_encode(const char* x, size_t length, size_t element_size, size_t bits, uint8_t* code) {
+    const size_t words = minhash_bbit_code_size(length, bits) / sizeof(uint64_t);
+    const uint64_t mask = (uint64_t{1} << bits) - 1;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t word = 0;
+        // bits divides 64, so the elements do not straddle the words
+        for (size_t i = w * 64 / bits; i < std::min(length, (w + 1) * 64 / bits); i++) {
+            // the lowest bits of the element, the first of its bytes
+            const uint64_t low = static_cast<uint8_t>(x[element_size * i]) & mask;
+            word |= low << ((i * bits) % 64);
+        }
+        std::memcpy(code + w * sizeof(uint64_t), &word, sizeof(uint64_t));
+    }
+}
+
+namespace {
+// the elements of a word of two codes xor-ed that differ: their bits are or-ed into the lowest one, and counted
+template <size_t bits>
+inline size_t
+bbit_mismatches(const uint64_t* x, const uint64_t* y, size_t words) {
+    constexpr uint64_t kLowest = bits == 1 ? ~uint64_t{0}
+                                 : bits == 2 ? 0x5555555555555555ULL
+                                 : bits == 4 ? 0x1111111111111111ULL
+                                             : 0x0101010101010101ULL;
+    size_t mismatches = 0;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t diff = x[w] ^ y[w];
+        if constexpr (bits >= 2) {
+            diff |= diff >> 1;
+        }
+        if constexpr (bits >= 4) {
+            diff |= diff >> 2;
+        }
+        if constexpr (bits >= 8) {
+            diff |= diff >> 4;
+        }
+        mismatches += __builtin_popcountll(diff & kLowest);
+    }
+    return mismatches;
+}
+}  // namespace
+
+float
+minhash_bbit_jaccard(const uint8_t* x, const uint8_t* y, size_t length, size_t bits) {
+    const size_t words = minhash_bbit_code_size(length, bits) / sizeof(uint64_t);
+    const auto* x_words = reinterpret_cast<const uint64_t*>(x);
+    const auto* y_words = reinterpret_cast<const uint64_t*>(y);
+    size_t mismatches = 0;
+    switch (bits) {
+        case 1:
+            mismatches = bbit_mismatches<1>(x_words, y_words, words);
+            break;
+        case 2:
+            mismatches = bbit_mismatches<2>(x_words, y_words, words);
+            break;
+        case 4:
+            mismatches = bbit_mismatches<4>(x_words, y_words, words);
+            break;
+        default:
+            mismatches = bbit_mismatches<8>(x_words, y_words, words);
+            break;
+    }
+    const float matches = float(length - mismatches) / float(length);
+    const float collision = 1.0f / float(uint64_t{1} << bits);
+    return (matches - collision) / (1.0f - collision);
+}
+
+void
+minhash_bbit_jaccard_knn_ny_by_ids(const uint8_t* x, const uint8_t* y, const int64_t* sel_ids, size_t length,
+                                   size_t bits, size_t sel_ids_num, size_t topk, float* res_vals, int64_t* res_ids) {
+    for (size_t i = 0; i < topk; i++) {
+        res_vals[i] = 0.0;
+        res_ids[i] = -1;
+    }
+    const size_t code_size = minhash_bbit_code_size(length, bits);
+    for (size_t i = 0; i < sel_ids_num; i++) {
+        if (sel_ids[i] < 0) {
+            continue;
+        }
+        const float dis = minhash_bbit_jaccard(x, y + sel_ids[i] * code_size, length, bits);
+        if (JcaccardSim::cmp(res_vals[0], dis)) {
+            faiss::heap_replace_top<JcaccardSim>(topk, res_vals, res_ids, dis, sel_ids[i]);
+        }
     }
 }
 
@@ -69,4 +69,23 @@ minhash_jaccard_knn_ny(const char* x, const char* y, size_t length, size_t eleme
 void
 minhash_jaccard_knn_ny_by_ids(const char* x, const char* y, const int64_t* sel_ids, size_t length, size_t element_size,
                               size_t sel_ids_num, size_t topk, float* res_vals, int64_t* res_ids);
+
+// b-bit minwise hashing: only the lowest bits (1, 2, 4 or 8) of every hash element of a minhash vector are kept,
+// packed in 64-bit words, for the jaccard refine to hold bits / (8 * element_size) of the full vectors in memory.
+size_t
+minhash_bbit_code_size(size_t length, size_t bits);
+
+void
+minhash_bbit_encode(const char* x, size_t length, size_t element_size, size_t bits, uint8_t* code);
+
+// The unbiased estimate of the jaccard similarity of the vectors of two codes: two different hashes match on b bits
+// with probability 2^-b, so the matching fraction P of the elements is J + (1 - J) * 2^-b and J is estimated as
+// (P - 2^-b) / (1 - 2^-b). The estimate is negative for the vectors of similarity close to 0.
+float
+minhash_bbit_jaccard(const uint8_t* x, const uint8_t* y, size_t length, size_t bits);
+
+// like minhash_jaccard_knn_ny_by_ids, with the estimate of the b-bit codes y of the vectors
+void
+minhash_bbit_jaccard_knn_ny_by_ids(const uint8_t* x, const uint8_t* y, const int64_t* sel_ids, size_t length,
+                                   size_t bits, size_t sel_ids_num, size_t topk, float* res_vals, int64_t* res_ids);
 }  // namespace knowhere
@@ -7,8 +7,10 @@
 #include <optional>
 #include <string>
 
+#include "faiss/IndexPreTransform.h"
 #include "faiss/IndexRefine.h"
 #include "faiss/IndexScalarQuantizer.h"
+#include "faiss/VectorTransform.h"
 #include "fmt/format.h"
 #include "knowhere/log.h"
 #include "knowhere/tolower.h"
@@ -19,6 +21,7 @@ namespace knowhere {
 expected<faiss::ScalarQuantizer::QuantizerType>
 get_sq_quantizer_type(const std::string& sq_type) {
     std::map<std::string, faiss::ScalarQuantizer::QuantizerType> sq_types = {
+        {"sq4", faiss::ScalarQuantizer::QT_4bit},
         {"sq6", faiss::ScalarQuantizer::QT_6bit},
         {"sq8", faiss::ScalarQuantizer::QT_8bit},
         {"fp16", faiss::ScalarQuantizer::QT_fp16},
@@ -36,6 +39,18 @@ get_sq_quantizer_type(const std::string& sq_type) {
     return itr->second;
 }
 
+std::optional<size_t>
+get_non_uniform_sq_bits(const std::string& sq_type) {
+    const auto sq_type_tolower = str_to_lower(sq_type);
+    if (sq_type_tolower == "nusq4") {
+        return 4;
+    }
+    if (sq_type_tolower == "nusq6") {
+        return 6;
+    }
+    return std::nullopt;
+}
+
 expected<bool>
 is_flat_refine(const std::optional<std::string>& refine_type) {
     // grab a type of a refine index
@@ -100,7 +115,7 @@ has_lossless_refine_index(const std::optional<bool>& refine, const std::optional
 expected<std::unique_ptr<faiss::Index>>
 pick_refine_index(const DataFormatEnum data_format, const std::optional<std::string>& refine_type,
                   std::unique_ptr<faiss::Index>&& base_index, const size_t base_d,
-                  const faiss::MetricType base_metric_type) {
+                  const faiss::MetricType base_metric_type, const std::optional<std::string>& cascade_type) {
     // grab a type of a refine index
     expected<bool> is_fp32_flat = is_flat_refine(refine_type);
     if (!is_fp32_flat.has_value()) {
@@ -135,6 +150,32 @@ pick_refine_index(const DataFormatEnum data_format, const std::optional<std::str
     // build
     std::unique_ptr<faiss::Index> local_index = std::move(base_index);
 
+    // a refine cascade is built the same way over its intermediate stage, then put on top of the base index
+    if (cascade_type.has_value()) {
+        auto cascade_sq_type = get_sq_quantizer_type(cascade_type.value());
+        if (!cascade_sq_type.has_value()) {
+            LOG_KNOWHERE_ERROR_ << "Invalid refine cascade type: " << cascade_type.value();
+            return expected<std::unique_ptr<faiss::Index>>::Err(
+                Status::invalid_args, fmt::format("invalid refine cascade type ({})", cascade_type.value()));
+        }
+        std::unique_ptr<faiss::Index> cascade_sq =
+            std::make_unique<faiss::IndexScalarQuantizer>(base_d, cascade_sq_type.value(), base_metric_type);
+        auto cascade = pick_refine_index(data_format, refine_type, std::move(cascade_sq), base_d, base_metric_type);
+        if (!cascade.has_value()) {
+            return cascade;
+        }
+
+        auto refine_index = std::make_unique<faiss::IndexRefine>(local_index.get(), cascade.value().get());
+
+        // let refine_index to own everything
+        refine_index->own_refine_index = true;
+        refine_index->own_fields = true;
+        local_index.release();
+        cascade.value().release();
+
+        return refine_index;
+    }
+
     // either build flat or sq
     if (is_fp32_flat_v) {
         // build IndexFlat as a refine
@@ -174,4 +215,30 @@ pick_refine_index(const DataFormatEnum data_format, const std::optional<std::str
     }
 }
 
+const faiss::IndexRefine*
+get_refine_cascade(const faiss::Index* refine_index) {
+    return dynamic_cast<const faiss::IndexRefine*>(refine_index);
+}
+
+const faiss::Index*
+get_final_refine_index(const faiss::Index* refine_index) {
+    const auto cascade = get_refine_cascade(refine_index);
+    return cascade != nullptr ? cascade->refine_index : refine_index;
+}
+
+std::unique_ptr<faiss::Index>
+make_prefix_dim_index(const size_t d, std::unique_ptr<faiss::Index>&& prefix_index) {
+    // keeps the first dimensions, in their order
+    auto prefix = std::make_unique<faiss::RemapDimensionsTransform>(d, prefix_index->d, false);
+    if (auto index_pt = dynamic_cast<faiss::IndexPreTransform*>(prefix_index.get()); index_pt != nullptr) {
+        index_pt->prepend_transform(prefix.release());
+        return std::move(prefix_index);
+    }
+    const bool is_cosine = prefix_index->is_cosine;
+    auto index_pt = std::make_unique<faiss::IndexPreTransform>(prefix.release(), prefix_index.release());
+    index_pt->own_fields = true;
+    index_pt->is_cosine = is_cosine;
+    return index_pt;
+}
+
 }  // namespace knowhere
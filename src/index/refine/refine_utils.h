@@ -10,11 +10,19 @@
 #include "knowhere/expected.h"
 #include "knowhere/operands.h"
 
+namespace faiss {
+struct IndexRefine;
+}  // namespace faiss
+
 namespace knowhere {
 
 expected<faiss::ScalarQuantizer::QuantizerType>
 get_sq_quantizer_type(const std::string& sq_type);
 
+// the bits of a non-uniform scalar quantizer type ("nusq4" or "nusq6"), std::nullopt for the other types
+std::optional<size_t>
+get_non_uniform_sq_bits(const std::string& sq_type);
+
 expected<bool>
 is_flat_refine(const std::optional<std::string>& refine_type);
 
@@ -25,12 +33,31 @@ bool
 has_lossless_refine_index(const std::optional<bool>& refine, const std::optional<std::string>& refine_type,
                           DataFormatEnum dataFormat);
 
+// `cascade_type`, if any, is the scalar quantizer type of an intermediate refine stage: the refine index then is a
+//   refine cascade, an IndexRefine of the `cascade_type` codes refined by the `refine_type` ones, so that the
+//   candidates of the base index are reranked with the cheaper codes before the best of them are reranked with the
+//   most accurate ones.
 expected<std::unique_ptr<faiss::Index>>
 pick_refine_index(const DataFormatEnum data_format, const std::optional<std::string>& refine_type,
                   std::unique_ptr<faiss::Index>&& base_index,
                   // These two could be borrowed from base_index. But it seems that
                   //   for HNSW these things are borrowed from base_index.storage.
                   //   So, let's provide these externally
-                  const size_t base_d, const faiss::MetricType base_metric_type);
+                  const size_t base_d, const faiss::MetricType base_metric_type,
+                  const std::optional<std::string>& cascade_type = std::nullopt);
+
+// the refine cascade of a refine index, if it is one
+const faiss::IndexRefine*
+get_refine_cascade(const faiss::Index* refine_index);
+
+// the index with the most accurate codes of a refine index, its last stage if it is a refine cascade
+const faiss::Index*
+get_final_refine_index(const faiss::Index* refine_index);
+
+// `prefix_index` over the first prefix_index->d of the `d` dimensions of the vectors, for a base index to select the
+//   candidates by a prefix of the dimensions of Matryoshka embeddings, which carries most of their signal, before a
+//   refine over all of them. A prefix_index that is an IndexPreTransform gets the prefix ahead of its own transforms.
+std::unique_ptr<faiss::Index>
+make_prefix_dim_index(const size_t d, std::unique_ptr<faiss::Index>&& prefix_index);
 
 }  // namespace knowhere
@@ -0,0 +1,547 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SPARSE_CLUSTERED_INDEX_H
+#define SPARSE_CLUSTERED_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "index/sparse/sparse_inverted_index.h"
+
+namespace knowhere::sparse {
+
+struct ClusteredIndexBuildParams {
+    // max number of postings kept for each dim.
+    size_t posting_list_length;
+    // number of blocks of a posting list relative to its length.
+    float centroid_fraction;
+    // fraction of the L1 mass of a block summary that is kept.
+    float summary_energy;
+};
+
+// An approximate inverted index for learned sparse embeddings, following Seismic (Bruch et al., "Efficient Inverted
+// Indexes for Approximate Retrieval over Learned Sparse Representations", SIGIR 2024).
+//
+// At build time, each posting list is pruned to its posting_list_length largest values, and the remaining docs are
+// clustered into blocks of similar docs. Each block has a summary, which is the component-wise max of its docs pruned
+// to summary_energy of its L1 mass, so that the inner product of a query with the summary approximates an upper bound
+// of the scores of the docs of the block.
+//
+// At search time, only the posting lists of the query_cut largest query dims are visited. The blocks of a posting list
+// are visited in decreasing order of summary score, and the docs of a block are scored exactly with the forward index,
+// unless the summary score is less than the current k-th best score divided by heap_factor, in which case the
+// remaining blocks of the posting list are skipped. At most block_budget blocks are evaluated per query.
+//
+// Only the IP metric is supported. The forward index holds all rows, so that the scores are exact and that the index
+// can be rebuilt when more rows are added.
+template <typename T>
+class ClusteredInvertedIndex : public BaseInvertedIndex<T> {
+ public:
+    explicit ClusteredInvertedIndex(const ClusteredIndexBuildParams& build_params) : build_params_(build_params) {
+    }
+
+    Status
+    SerializeV0(MemoryIOWriter& writer) const override {
+        return Status::not_implemented;
+    }
+
+    Status
+    DeserializeV0(MemoryIOReader& reader, int map_flags, const std::string& supplement_target_filename) override {
+        return Status::not_implemented;
+    }
+
+    Status
+    Serialize(MemoryIOWriter& writer) const override {
+        // Serialized format:
+        // 1. Header:
+        //    - index_format_version (uint32_t): Version of the index format, currently 1
+        //    - nr_rows (uint32_t): Number of rows in the index
+        //    - max_dim (uint32_t): Number of columns, or maximum dimension ID
+        //    - nr_inner_dims (uint32_t): Number of inner dimensions
+        //    - nr_blocks (uint64_t): Number of blocks of all posting lists
+        //
+        // 2. Dimension Map:
+        //    - dim_map_reverse[nr_inner_dims] (uint32_t): Original dimension of each inner dimension
+        //
+        // 3. Forward Index:
+        //    - row_offsets[nr_rows + 1] (uint64_t): Offsets of the values of each row
+        //    - row_dims[row_offsets[nr_rows]] (uint32_t): Inner dimensions
+        //    - row_vals[row_offsets[nr_rows]] (float): Values
+        //
+        // 4. Blocks:
+        //    - dim_block_offsets[nr_inner_dims + 1] (uint64_t): Offsets of the blocks of each inner dimension
+        //    - block_doc_offsets[nr_blocks + 1] (uint64_t): Offsets of the doc ids of each block
+        //    - block_docs[block_doc_offsets[nr_blocks]] (uint32_t): Doc ids
+        //    - summary_offsets[nr_blocks + 1] (uint64_t): Offsets of the summary of each block
+        //    - summary_dims[summary_offsets[nr_blocks]] (uint32_t): Inner dimensions of the summaries
+        //    - summary_vals[summary_offsets[nr_blocks]] (float): Values of the summaries
+        const uint32_t index_format_version = 1;
+        const uint32_t nr_rows = n_rows();
+        const uint32_t nr_inner_dims = dim_map_.size();
+        const uint64_t nr_blocks = n_blocks();
+        writer.write(&index_format_version, sizeof(uint32_t));
+        writer.write(&nr_rows, sizeof(uint32_t));
+        writer.write(&max_dim_, sizeof(uint32_t));
+        writer.write(&nr_inner_dims, sizeof(uint32_t));
+        writer.write(&nr_blocks, sizeof(uint64_t));
+
+        for (size_t i = 0; i < nr_inner_dims; ++i) {
+            const uint32_t dim = dim_map_.dim(i);
+            writer.write(&dim, sizeof(uint32_t));
+        }
+
+        writer.write(row_offsets_.data(), sizeof(uint64_t), row_offsets_.size());
+        writer.write(row_dims_.data(), sizeof(uint32_t), row_dims_.size());
+        writer.write(row_vals_.data(), sizeof(float), row_vals_.size());
+
+        writer.write(dim_block_offsets_.data(), sizeof(uint64_t), dim_block_offsets_.size());
+        writer.write(block_doc_offsets_.data(), sizeof(uint64_t), block_doc_offsets_.size());
+        writer.write(block_docs_.data(), sizeof(uint32_t), block_docs_.size());
+        writer.write(summary_offsets_.data(), sizeof(uint64_t), summary_offsets_.size());
+        writer.write(summary_dims_.data(), sizeof(uint32_t), summary_dims_.size());
+        writer.write(summary_vals_.data(), sizeof(float), summary_vals_.size());
+        return Status::success;
+    }
+
+    Status
+    Deserialize(MemoryIOReader& reader) override {
+        uint32_t index_format_version = 0;
+        reader.read(&index_format_version, sizeof(uint32_t));
+        if (index_format_version != 1) {
+            return Status::invalid_serialized_index_type;
+        }
+        uint32_t nr_rows = 0, nr_inner_dims = 0;
+        uint64_t nr_blocks = 0;
+        reader.read(&nr_rows, sizeof(uint32_t));
+        reader.read(&max_dim_, sizeof(uint32_t));
+        reader.read(&nr_inner_dims, sizeof(uint32_t));
+        reader.read(&nr_blocks, sizeof(uint64_t));
+
+        auto read_vector = [&reader](auto& vec, size_t size) {
+            vec.resize(size);
+            if (size > 0) {
+                reader.read(vec.data(), sizeof(vec[0]), size);
+            }
+        };
+        dim_map_ = DimMap();
+        for (uint32_t i = 0; i < nr_inner_dims; ++i) {
+            uint32_t dim = 0;
+            reader.read(&dim, sizeof(uint32_t));
+            dim_map_.insert(dim);
+        }
+
+        read_vector(row_offsets_, nr_rows + 1);
+        read_vector(row_dims_, row_offsets_.back());
+        read_vector(row_vals_, row_offsets_.back());
+
+        read_vector(dim_block_offsets_, nr_inner_dims + 1);
+        read_vector(block_doc_offsets_, nr_blocks + 1);
+        read_vector(block_docs_, block_doc_offsets_.back());
+        read_vector(summary_offsets_, nr_blocks + 1);
+        read_vector(summary_dims_, summary_offsets_.back());
+        read_vector(summary_vals_, summary_offsets_.back());
+        return Status::success;
+    }
+
+    Status
+    Train(const SparseRow<T>* data, size_t rows) override {
+        return Status::success;
+    }
+
+    // The blocks depend on all rows, so they are rebuilt every time rows are added.
+    Status
+    Add(const SparseRow<T>* data, size_t rows, int64_t dim) override {
+        if ((size_t)dim > max_dim_) {
+            max_dim_ = dim;
+        }
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < data[i].size(); ++j) {
+                auto [dim, val] = data[i][j];
+                if (val == 0) {
+                    continue;
+                }
+                row_dims_.push_back(dim_map_.insert(dim));
+                row_vals_.push_back(val);
+            }
+            row_offsets_.push_back(row_dims_.size());
+        }
+        build_blocks();
+        return Status::success;
+    }
+
+    void
+    Search(const SparseRow<T>& query, size_t k, float* distances, label_t* labels, const BitsetView& bitset,
+           const DocValueComputer<T>& computer, InvertedIndexApproxSearchParams& approx_params) const override {
+        std::fill(distances, distances + k, std::numeric_limits<float>::quiet_NaN());
+        std::fill(labels, labels + k, -1);
+
+        auto& scratch = search_scratch();
+        scratch.prepare(dim_map_.size(), n_rows());
+        auto& q_dense = scratch.q_dense;
+        // q_vec is cut below, the dims of q_dense to reset are those of the whole query
+        scratch.touched_dims.clear();
+        std::vector<std::pair<uint32_t, float>> q_vec;
+        for (size_t i = 0; i < query.size(); ++i) {
+            auto dim_id = dim_map_.find(query[i].id);
+            if (dim_id == DimMap::npos || query[i].val == 0) {
+                continue;
+            }
+            q_vec.emplace_back(dim_id, query[i].val);
+            q_dense[dim_id] += query[i].val;
+            scratch.touched_dims.push_back(dim_id);
+        }
+        if (q_vec.empty()) {
+            return;
+        }
+        const size_t query_cut = approx_params.query_cut > 0 ? approx_params.query_cut : q_vec.size();
+        if (q_vec.size() > query_cut) {
+            std::partial_sort(q_vec.begin(), q_vec.begin() + query_cut, q_vec.end(),
+                              [](const auto& a, const auto& b) { return a.second > b.second; });
+            q_vec.resize(query_cut);
+        }
+
+        MaxMinHeap<float> heap(k);
+        auto& visited = scratch.visited;
+        const uint32_t generation = scratch.generation;
+        auto& block_scores = scratch.block_scores;
+        size_t budget = approx_params.block_budget > 0 ? approx_params.block_budget : n_blocks();
+        for (const auto& [q_dim, q_val] : q_vec) {
+            block_scores.clear();
+            for (size_t b = dim_block_offsets_[q_dim]; b < dim_block_offsets_[q_dim + 1]; ++b) {
+                float score = 0.0f;
+                for (size_t j = summary_offsets_[b]; j < summary_offsets_[b + 1]; ++j) {
+                    score += q_dense[summary_dims_[j]] * summary_vals_[j];
+                }
+                block_scores.emplace_back(score, b);
+            }
+            std::sort(block_scores.begin(), block_scores.end(), std::greater<>());
+            for (const auto& [score, b] : block_scores) {
+                if (budget == 0 || (heap.full() && score < heap.top().val / approx_params.heap_factor)) {
+                    break;
+                }
+                --budget;
+                for (size_t j = block_doc_offsets_[b]; j < block_doc_offsets_[b + 1]; ++j) {
+                    const auto doc = block_docs_[j];
+                    if (visited[doc] == generation || (!bitset.empty() && bitset.test(doc))) {
+                        continue;
+                    }
+                    visited[doc] = generation;
+                    heap.push(doc, row_distance(doc, q_dense));
+                }
+            }
+            if (budget == 0) {
+                break;
+            }
+        }
+        for (auto dim_id : scratch.touched_dims) {
+            q_dense[dim_id] = 0.0f;
+        }
+
+        for (auto i = static_cast<int64_t>(heap.size()) - 1; i >= 0; --i) {
+            labels[i] = heap.top().id;
+            distances[i] = heap.top().val;
+            heap.pop();
+        }
+    }
+
+    void
+    SearchBatch(const SparseRow<T>* queries, size_t nq, size_t k, float* distances, label_t* labels,
+                const BitsetView& bitset, const DocValueComputer<T>& computer,
+                InvertedIndexApproxSearchParams& approx_params) const override {
+        for (size_t i = 0; i < nq; ++i) {
+            Search(queries[i], k, distances + i * k, labels + i * k, bitset, computer, approx_params);
+        }
+    }
+
+    [[nodiscard]] size_t
+    max_search_batch_size() const override {
+        return 1;
+    }
+
+    // Returned distances are exact, they do not depend on the pruning of the posting lists.
+    std::vector<float>
+    GetAllDistances(const SparseRow<T>& query, float drop_ratio_search, const BitsetView& bitset,
+                    const DocValueComputer<T>& computer) const override {
+        if (query.size() == 0) {
+            return {};
+        }
+        auto q_dense = dense_query(query);
+        std::vector<float> distances(n_rows(), 0.0f);
+        for (size_t i = 0; i < distances.size(); ++i) {
+            if (bitset.empty() || !bitset.test(i)) {
+                distances[i] = row_distance(i, q_dense);
+            }
+        }
+        return distances;
+    }
+
+    float
+    GetRawDistance(const label_t vec_id, const SparseRow<T>& query, const DocValueComputer<T>& computer) const override {
+        return row_distance(vec_id, dense_query(query));
+    }
+
+    std::vector<SparseRow<T>>
+    GetRows() const override {
+        std::vector<SparseRow<T>> rows(n_rows());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rows[i] = SparseRow<T>(row_offsets_[i + 1] - row_offsets_[i]);
+            for (size_t j = row_offsets_[i]; j < row_offsets_[i + 1]; ++j) {
+                rows[i].set_at(j - row_offsets_[i], dim_map_.dim(row_dims_[j]), row_vals_[j]);
+            }
+        }
+        return rows;
+    }
+
+    expected<DocValueComputer<T>>
+    GetDocValueComputer(const SparseInvertedIndexConfig& cfg) const override {
+        if (cfg.metric_type.has_value() && !IsMetricType(cfg.metric_type.value(), metric::IP)) {
+            auto msg = "metric type not match, expected: " + std::string(metric::IP) + ", got: " + cfg.metric_type.value();
+            return expected<DocValueComputer<T>>::Err(Status::invalid_metric_type, msg);
+        }
+        return GetDocValueOriginalComputer<T>();
+    }
+
+    [[nodiscard]] size_t
+    size() const override {
+        size_t res = sizeof(*this);
+        res += dim_map_.byte_size();
+        res += row_offsets_.size() * sizeof(uint64_t) + row_dims_.size() * (sizeof(uint32_t) + sizeof(float));
+        res += dim_block_offsets_.size() * sizeof(uint64_t) + block_doc_offsets_.size() * sizeof(uint64_t) +
+               block_docs_.size() * sizeof(uint32_t);
+        res += summary_offsets_.size() * sizeof(uint64_t) + summary_dims_.size() * (sizeof(uint32_t) + sizeof(float));
+        return res;
+    }
+
+    [[nodiscard]] size_t
+    n_rows() const override {
+        return row_offsets_.size() - 1;
+    }
+
+    [[nodiscard]] size_t
+    n_cols() const override {
+        return max_dim_;
+    }
+
+    // the posting lists are always stored uncompressed and the doc ids are not reordered.
+    void
+    SetPostingListEncoding(PostingListEncoding encoding) override {
+    }
+
+    void
+    SetDocIdReordering(bool doc_id_reordering) override {
+    }
+
+ private:
+    // The buffers of a search, kept by the searching thread across its queries instead of allocated and zeroed for each
+    // of them: the entries of q_dense that a query sets are reset after it, and a row is visited by the current query
+    // if its stamp in visited is the generation of the query.
+    struct SearchScratch {
+        std::vector<float> q_dense;
+        std::vector<uint32_t> touched_dims;
+        std::vector<uint32_t> visited;
+        uint32_t generation = 0;
+        std::vector<std::pair<float, size_t>> block_scores;
+
+        void
+        prepare(size_t nr_inner_dims, size_t nr_rows) {
+            if (q_dense.size() < nr_inner_dims) {
+                q_dense.resize(nr_inner_dims, 0.0f);
+            }
+            if (visited.size() < nr_rows) {
+                visited.resize(nr_rows, 0);
+            }
+            if (++generation == 0) {
+                std::fill(visited.begin(), visited.end(), 0);
+                generation = 1;
+            }
+        }
+    };
+
+    static SearchScratch&
+    search_scratch() {
+        thread_local SearchScratch scratch;
+        return scratch;
+    }
+
+    [[nodiscard]] size_t
+    n_blocks() const {
+        return block_doc_offsets_.size() - 1;
+    }
+
+    std::vector<float>
+    dense_query(const SparseRow<T>& query) const {
+        std::vector<float> q_dense(dim_map_.size(), 0.0f);
+        for (size_t i = 0; i < query.size(); ++i) {
+            auto dim_id = dim_map_.find(query[i].id);
+            if (dim_id != DimMap::npos) {
+                q_dense[dim_id] += query[i].val;
+            }
+        }
+        return q_dense;
+    }
+
+    float
+    row_distance(size_t row, const std::vector<float>& q_dense) const {
+        float distance = 0.0f;
+        for (size_t j = row_offsets_[row]; j < row_offsets_[row + 1]; ++j) {
+            distance += q_dense[row_dims_[j]] * row_vals_[j];
+        }
+        return distance;
+    }
+
+    void
+    build_blocks() {
+        const size_t nr_inner_dims = dim_map_.size();
+        std::vector<std::vector<std::pair<uint32_t, float>>> postings(nr_inner_dims);
+        for (size_t i = 0; i < n_rows(); ++i) {
+            for (size_t j = row_offsets_[i]; j < row_offsets_[i + 1]; ++j) {
+                postings[row_dims_[j]].emplace_back(i, row_vals_[j]);
+            }
+        }
+
+        dim_block_offsets_.assign(1, 0);
+        block_doc_offsets_.assign(1, 0);
+        block_docs_.clear();
+        summary_offsets_.assign(1, 0);
+        summary_dims_.clear();
+        summary_vals_.clear();
+
+        // scratch buffers indexed by inner dim, reset after each use.
+        std::vector<std::vector<std::pair<uint32_t, float>>> centroid_postings(nr_inner_dims);
+        std::vector<float> summary(nr_inner_dims, 0.0f);
+        std::vector<uint32_t> summary_touched;
+        for (size_t d = 0; d < nr_inner_dims; ++d) {
+            auto& posting = postings[d];
+            if (posting.size() > build_params_.posting_list_length) {
+                std::nth_element(posting.begin(), posting.begin() + build_params_.posting_list_length, posting.end(),
+                                 [](const auto& a, const auto& b) { return a.second > b.second; });
+                posting.resize(build_params_.posting_list_length);
+            }
+            std::vector<uint32_t> docs(posting.size());
+            for (size_t i = 0; i < posting.size(); ++i) {
+                docs[i] = posting[i].first;
+            }
+            std::vector<std::vector<uint32_t>> clusters = cluster(docs, d, centroid_postings);
+
+            for (auto& cluster_docs : clusters) {
+                if (cluster_docs.empty()) {
+                    continue;
+                }
+                std::sort(cluster_docs.begin(), cluster_docs.end());
+                block_docs_.insert(block_docs_.end(), cluster_docs.begin(), cluster_docs.end());
+                block_doc_offsets_.push_back(block_docs_.size());
+
+                summary_touched.clear();
+                for (auto doc : cluster_docs) {
+                    for (size_t j = row_offsets_[doc]; j < row_offsets_[doc + 1]; ++j) {
+                        auto& val = summary[row_dims_[j]];
+                        if (row_vals_[j] <= val) {
+                            continue;
+                        }
+                        if (val == 0.0f) {
+                            summary_touched.push_back(row_dims_[j]);
+                        }
+                        val = row_vals_[j];
+                    }
+                }
+                add_summary(summary, summary_touched);
+            }
+            dim_block_offsets_.push_back(block_doc_offsets_.size() - 1);
+        }
+    }
+
+    // Clusters docs with a single round of k-means: random docs are picked as centroids, and each doc is assigned to
+    // the centroid it has the largest inner product with.
+    std::vector<std::vector<uint32_t>>
+    cluster(const std::vector<uint32_t>& docs, size_t seed,
+            std::vector<std::vector<std::pair<uint32_t, float>>>& centroid_postings) const {
+        const size_t n_centroids = std::clamp<size_t>(
+            std::ceil(docs.size() * build_params_.centroid_fraction), std::min<size_t>(docs.size(), 1), docs.size());
+        std::vector<uint32_t> centroids(docs);
+        std::mt19937 rng(seed);
+        std::shuffle(centroids.begin(), centroids.end(), rng);
+        centroids.resize(n_centroids);
+
+        // inverted index of the centroids, to compute the inner products of a doc with all centroids at once.
+        for (size_t c = 0; c < n_centroids; ++c) {
+            for (size_t j = row_offsets_[centroids[c]]; j < row_offsets_[centroids[c] + 1]; ++j) {
+                centroid_postings[row_dims_[j]].emplace_back(c, row_vals_[j]);
+            }
+        }
+        std::vector<std::vector<uint32_t>> clusters(n_centroids);
+        std::vector<float> scores(n_centroids);
+        for (auto doc : docs) {
+            std::fill(scores.begin(), scores.end(), 0.0f);
+            for (size_t j = row_offsets_[doc]; j < row_offsets_[doc + 1]; ++j) {
+                for (const auto& [c, val] : centroid_postings[row_dims_[j]]) {
+                    scores[c] += val * row_vals_[j];
+                }
+            }
+            clusters[std::max_element(scores.begin(), scores.end()) - scores.begin()].push_back(doc);
+        }
+        for (size_t c = 0; c < n_centroids; ++c) {
+            for (size_t j = row_offsets_[centroids[c]]; j < row_offsets_[centroids[c] + 1]; ++j) {
+                centroid_postings[row_dims_[j]].clear();
+            }
+        }
+        return clusters;
+    }
+
+    // Appends the largest values of summary accounting for summary_energy of its L1 mass, and resets summary.
+    void
+    add_summary(std::vector<float>& summary, std::vector<uint32_t>& touched) {
+        std::sort(touched.begin(), touched.end(), [&summary](uint32_t a, uint32_t b) { return summary[a] > summary[b]; });
+        float total = 0.0f;
+        for (auto dim : touched) {
+            total += summary[dim];
+        }
+        size_t kept = 0;
+        float energy = 0.0f;
+        while (kept < touched.size() && (kept == 0 || energy < build_params_.summary_energy * total)) {
+            energy += summary[touched[kept]];
+            ++kept;
+        }
+        std::sort(touched.begin(), touched.begin() + kept);
+        for (size_t i = 0; i < kept; ++i) {
+            summary_dims_.push_back(touched[i]);
+            summary_vals_.push_back(summary[touched[i]]);
+        }
+        summary_offsets_.push_back(summary_dims_.size());
+        for (auto dim : touched) {
+            summary[dim] = 0.0f;
+        }
+    }
+
+    const ClusteredIndexBuildParams build_params_;
+    uint32_t max_dim_ = 0;
+    DimMap dim_map_;
+
+    // forward index, in CSR format with inner dims.
+    std::vector<uint64_t> row_offsets_ = {0};
+    std::vector<uint32_t> row_dims_;
+    std::vector<float> row_vals_;
+
+    // blocks of each inner dim, the docs and the summary of each block.
+    std::vector<uint64_t> dim_block_offsets_ = {0};
+    std::vector<uint64_t> block_doc_offsets_ = {0};
+    std::vector<uint32_t> block_docs_;
+    std::vector<uint64_t> summary_offsets_ = {0};
+    std::vector<uint32_t> summary_dims_;
+    std::vector<float> summary_vals_;
+};  // class ClusteredInvertedIndex
+
+}  // namespace knowhere::sparse
+
+#endif  // SPARSE_CLUSTERED_INDEX_H
@@ -0,0 +1,112 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SPARSE_DIM_MAP_H
+#define SPARSE_DIM_MAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "knowhere/sparse_utils.h"
+
+namespace knowhere::sparse {
+
+// Maps the raw dims of sparse vectors to dense inner dim ids, assigned in insertion order.
+//
+// Vocabularies of learned sparse embeddings are small and dense (e.g. about 30k dims for SPLADE), so dims are looked
+// up in a flat array indexed by the raw dim, which takes a single load instead of hashing. The array only grows as long
+// as it stays within a constant factor of the number of dims, larger dims (e.g. hashed ones) fall back to a hash map.
+class DimMap {
+ public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    // inner id of dim, or npos if dim has not been inserted.
+    [[nodiscard]] uint32_t
+    find(table_t dim) const {
+        if (dim < dense_.size()) {
+            return dense_[dim];
+        }
+        if (sparse_.empty()) {
+            return npos;
+        }
+        auto it = sparse_.find(dim);
+        return it == sparse_.end() ? npos : it->second;
+    }
+
+    // inserts dim if it is not in the map yet, returns its inner id.
+    uint32_t
+    insert(table_t dim) {
+        auto id = find(dim);
+        if (id != npos) {
+            return id;
+        }
+        id = dims_.size();
+        dims_.push_back(dim);
+        const size_t max_dense_size = std::max(min_dense_size, dense_ratio * dims_.size());
+        if (dim >= dense_.size() && dim < max_dense_size) {
+            grow_dense(std::min<size_t>(max_dense_size, std::max<size_t>(dim + 1, dense_.size() * 2)));
+        }
+        if (dim < dense_.size()) {
+            dense_[dim] = id;
+        } else {
+            sparse_.emplace(dim, id);
+        }
+        return id;
+    }
+
+    // raw dim of the inner id.
+    [[nodiscard]] table_t
+    dim(uint32_t id) const {
+        return dims_[id];
+    }
+
+    [[nodiscard]] size_t
+    size() const {
+        return dims_.size();
+    }
+
+    [[nodiscard]] size_t
+    byte_size() const {
+        return dense_.size() * sizeof(uint32_t) + dims_.size() * sizeof(table_t) +
+               sparse_.size() * (sizeof(table_t) + sizeof(uint32_t));
+    }
+
+ private:
+    // the dense array can always cover dims up to min_dense_size, and up to dense_ratio times the number of dims.
+    static constexpr size_t min_dense_size = 1 << 16;
+    static constexpr size_t dense_ratio = 8;
+
+    // grows the dense array to new_size, and moves the dims of the hash map that it now covers.
+    void
+    grow_dense(size_t new_size) {
+        dense_.resize(new_size, npos);
+        for (auto it = sparse_.begin(); it != sparse_.end();) {
+            if (it->first < dense_.size()) {
+                dense_[it->first] = it->second;
+                it = sparse_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    std::vector<uint32_t> dense_;
+    std::unordered_map<table_t, uint32_t> sparse_;
+    // raw dim of each inner id.
+    std::vector<table_t> dims_;
+};
+
+}  // namespace knowhere::sparse
+
+#endif  // SPARSE_DIM_MAP_H
@@ -0,0 +1,180 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SPARSE_DOC_REORDER_H
+#define SPARSE_DOC_REORDER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include "knowhere/sparse_utils.h"
+
+namespace knowhere::sparse {
+
+// Reorders documents with recursive graph bisection (Dhulipala et al., "Compressing Graphs and Indexes with Recursive
+// Graph Bisection", KDD 2016), so that documents sharing many dims get close doc ids. This shortens the gaps between
+// the doc ids of the posting lists, which makes them more compressible and lets DAAT cursors skip longer runs.
+//
+// The documents are split in two halves, then documents are swapped between the halves as long as it reduces the
+// estimated log-gap cost of the posting lists, and each half is processed recursively.
+template <typename DType>
+class GraphBisectionReorderer {
+ public:
+    // max number of swap rounds at each level of the recursion.
+    static constexpr size_t max_iterations = 20;
+    // partitions smaller than this are not split anymore.
+    static constexpr size_t min_partition_size = 16;
+
+    // Returns the new order of rows: order[i] is the index in rows of the document that gets the i-th position.
+    static std::vector<uint32_t>
+    reorder(const SparseRow<DType>* rows, size_t n) {
+        GraphBisectionReorderer reorderer(rows, n);
+        reorderer.bisect(0, n);
+        return std::move(reorderer.docs_);
+    }
+
+ private:
+    GraphBisectionReorderer(const SparseRow<DType>* rows, size_t n) : docs_(n), gains_(n), log2_(n + 3) {
+        std::iota(docs_.begin(), docs_.end(), 0);
+        for (size_t i = 0; i < log2_.size(); ++i) {
+            log2_[i] = i == 0 ? 0.0f : std::log2(static_cast<float>(i));
+        }
+
+        // only dims shared by at least two documents affect the cost, the other ones are dropped.
+        std::unordered_map<table_t, uint32_t> dim_degrees;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < rows[i].size(); ++j) {
+                if (rows[i][j].val != 0) {
+                    dim_degrees[rows[i][j].id]++;
+                }
+            }
+        }
+        std::unordered_map<table_t, uint32_t> dim_ids;
+        for (const auto& [dim, degree] : dim_degrees) {
+            if (degree >= 2) {
+                dim_ids.emplace(dim, dim_ids.size());
+            }
+        }
+        deg_left_.assign(dim_ids.size(), 0);
+        deg_right_.assign(dim_ids.size(), 0);
+
+        terms_offsets_.resize(n + 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < rows[i].size(); ++j) {
+                if (rows[i][j].val == 0) {
+                    continue;
+                }
+                auto it = dim_ids.find(rows[i][j].id);
+                if (it != dim_ids.end()) {
+                    terms_.push_back(it->second);
+                }
+            }
+            terms_offsets_[i + 1] = terms_.size();
+        }
+    }
+
+    // estimated number of bits to encode the gaps of a posting list with degree doc ids in a partition of n docs.
+    float
+    cost(uint32_t degree, size_t n) const {
+        return degree * (log2_[n] - log2_[degree + 1]);
+    }
+
+    // gain of the cost of moving a document of a partition of n_from docs to a partition of n_to docs.
+    float
+    move_gain(uint32_t doc, const std::vector<uint32_t>& deg_from, const std::vector<uint32_t>& deg_to, size_t n_from,
+              size_t n_to) const {
+        float gain = 0.0f;
+        for (size_t j = terms_offsets_[doc]; j < terms_offsets_[doc + 1]; ++j) {
+            const auto from = deg_from[terms_[j]];
+            const auto to = deg_to[terms_[j]];
+            gain += cost(from, n_from) + cost(to, n_to) - cost(from - 1, n_from) - cost(to + 1, n_to);
+        }
+        return gain;
+    }
+
+    void
+    update_degrees(uint32_t doc, std::vector<uint32_t>& deg_from, std::vector<uint32_t>& deg_to) {
+        for (size_t j = terms_offsets_[doc]; j < terms_offsets_[doc + 1]; ++j) {
+            deg_from[terms_[j]]--;
+            deg_to[terms_[j]]++;
+        }
+    }
+
+    void
+    bisect(size_t begin, size_t end) {
+        if (end - begin <= min_partition_size) {
+            return;
+        }
+        const size_t mid = begin + (end - begin) / 2;
+        const size_t n_left = mid - begin;
+        const size_t n_right = end - mid;
+        for (size_t i = begin; i < end; ++i) {
+            auto& deg = i < mid ? deg_left_ : deg_right_;
+            for (size_t j = terms_offsets_[docs_[i]]; j < terms_offsets_[docs_[i] + 1]; ++j) {
+                deg[terms_[j]]++;
+            }
+        }
+
+        for (size_t iter = 0; iter < max_iterations; ++iter) {
+            for (size_t i = begin; i < mid; ++i) {
+                gains_[docs_[i]] = move_gain(docs_[i], deg_left_, deg_right_, n_left, n_right);
+            }
+            for (size_t i = mid; i < end; ++i) {
+                gains_[docs_[i]] = move_gain(docs_[i], deg_right_, deg_left_, n_right, n_left);
+            }
+            auto by_gain = [this](uint32_t a, uint32_t b) { return gains_[a] > gains_[b]; };
+            std::sort(docs_.begin() + begin, docs_.begin() + mid, by_gain);
+            std::sort(docs_.begin() + mid, docs_.begin() + end, by_gain);
+
+            size_t swapped = 0;
+            for (size_t i = begin, j = mid; i < mid && j < end; ++i, ++j) {
+                if (gains_[docs_[i]] + gains_[docs_[j]] <= 0) {
+                    break;
+                }
+                update_degrees(docs_[i], deg_left_, deg_right_);
+                update_degrees(docs_[j], deg_right_, deg_left_);
+                std::swap(docs_[i], docs_[j]);
+                ++swapped;
+            }
+            if (swapped == 0) {
+                break;
+            }
+        }
+
+        // reset the degrees so that the recursive calls start from zero.
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t j = terms_offsets_[docs_[i]]; j < terms_offsets_[docs_[i] + 1]; ++j) {
+                deg_left_[terms_[j]] = 0;
+                deg_right_[terms_[j]] = 0;
+            }
+        }
+        bisect(begin, mid);
+        bisect(mid, end);
+    }
+
+    std::vector<uint32_t> docs_;
+    std::vector<float> gains_;
+    std::vector<float> log2_;
+    // dims of each document, in CSR format.
+    std::vector<size_t> terms_offsets_;
+    std::vector<uint32_t> terms_;
+    // degree of each dim in the left and right partitions being bisected.
+    std::vector<uint32_t> deg_left_;
+    std::vector<uint32_t> deg_right_;
+};
+
+}  // namespace knowhere::sparse
+
+#endif  // SPARSE_DOC_REORDER_H
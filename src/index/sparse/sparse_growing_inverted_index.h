@@ -0,0 +1,345 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SPARSE_GROWING_INVERTED_INDEX_H
+#define SPARSE_GROWING_INVERTED_INDEX_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "index/sparse/sparse_inverted_index.h"
+
+namespace knowhere::sparse {
+
+// An inverted index that can be searched while rows are being added.
+//
+// Rows are stored in append-only segments, each segment being an immutable InvertedIndex. The current list of segments
+// is published as a snapshot: readers atomically grab the latest snapshot and search it without any lock, while an Add
+// builds new segments on the side and publishes a new snapshot when it is done. A snapshot holds its segments alive, so
+// a segment replaced by a merge is freed once the last reader that can see it is done.
+//
+// To keep the number of segments logarithmic in the number of rows, a new segment is merged with the previous one as
+// long as it is at least half as large, like in a log-structured merge tree.
+//
+// Adds are serialized among themselves, all the other methods can be called concurrently with each other and with Add.
+template <typename T>
+class GrowingInvertedIndex : public BaseInvertedIndex<T> {
+ public:
+    // creates an empty segment, configured like the segments of this index.
+    using SegmentFactory = std::function<expected<BaseInvertedIndex<T>*>()>;
+
+    GrowingInvertedIndex(SegmentFactory segment_factory, BaseInvertedIndex<T>* empty_segment, bool keep_raw_data)
+        : segment_factory_(std::move(segment_factory)),
+          empty_segment_(empty_segment),
+          keep_raw_data_(keep_raw_data),
+          snapshot_(std::make_shared<const Snapshot>()) {
+    }
+
+    Status
+    SerializeV0(MemoryIOWriter& writer) const override {
+        auto merged_or = merge_all();
+        if (!merged_or.has_value()) {
+            return merged_or.error();
+        }
+        return merged_or.value()->SerializeV0(writer);
+    }
+
+    Status
+    DeserializeV0(MemoryIOReader& reader, int map_flags, const std::string& supplement_target_filename) override {
+        return Status::not_implemented;
+    }
+
+    Status
+    Serialize(MemoryIOWriter& writer) const override {
+        auto merged_or = merge_all();
+        if (!merged_or.has_value()) {
+            return merged_or.error();
+        }
+        return merged_or.value()->Serialize(writer);
+    }
+
+    Status
+    Deserialize(MemoryIOReader& reader) override {
+        return Status::not_implemented;
+    }
+
+    Status
+    Train(const SparseRow<T>* data, size_t rows) override {
+        return Status::success;
+    }
+
+    Status
+    Add(const SparseRow<T>* data, size_t rows, int64_t dim) override {
+        std::lock_guard<std::mutex> lock(add_mutex_);
+        auto snapshot = std::atomic_load(&snapshot_);
+        auto segments = *snapshot;
+
+        std::vector<SparseRow<T>> raw_rows;
+        if (keep_raw_data_) {
+            raw_rows.assign(data, data + rows);
+        }
+        auto segment_or = make_segment(data, rows, dim, std::move(raw_rows), n_rows(*snapshot));
+        if (!segment_or.has_value()) {
+            return segment_or.error();
+        }
+        segments.push_back(segment_or.value());
+
+        while (segments.size() >= 2 &&
+               segments.back()->index->n_rows() * 2 >= segments[segments.size() - 2]->index->n_rows()) {
+            auto last = segments.back();
+            segments.pop_back();
+            auto merged_or = merge(*segments.back(), *last);
+            if (!merged_or.has_value()) {
+                return merged_or.error();
+            }
+            segments.back() = merged_or.value();
+        }
+
+        std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::make_shared<Snapshot>(std::move(segments))));
+        return Status::success;
+    }
+
+    void
+    Search(const SparseRow<T>& query, size_t k, float* distances, label_t* labels, const BitsetView& bitset,
+           const DocValueComputer<T>& computer, InvertedIndexApproxSearchParams& approx_params) const override {
+        SearchBatch(&query, 1, k, distances, labels, bitset, computer, approx_params);
+    }
+
+    void
+    SearchBatch(const SparseRow<T>* queries, size_t nq, size_t k, float* distances, label_t* labels,
+                const BitsetView& bitset, const DocValueComputer<T>& computer,
+                InvertedIndexApproxSearchParams& approx_params) const override {
+        auto snapshot = std::atomic_load(&snapshot_);
+        std::vector<MaxMinHeap<float>> heaps;
+        heaps.reserve(nq);
+        for (size_t i = 0; i < nq; ++i) {
+            heaps.emplace_back(k);
+        }
+        std::vector<float> seg_distances(nq * k);
+        std::vector<label_t> seg_labels(nq * k);
+        for (const auto& segment : *snapshot) {
+            segment->index->SearchBatch(queries, nq, k, seg_distances.data(), seg_labels.data(),
+                                        segment_bitset(bitset, *segment), computer, approx_params);
+            for (size_t i = 0; i < nq * k; ++i) {
+                if (seg_labels[i] != -1) {
+                    heaps[i / k].push(segment->base + seg_labels[i], seg_distances[i]);
+                }
+            }
+        }
+        for (size_t i = 0; i < nq; ++i) {
+            auto& heap = heaps[i];
+            std::fill(distances + i * k + heap.size(), distances + (i + 1) * k, std::numeric_limits<float>::quiet_NaN());
+            std::fill(labels + i * k + heap.size(), labels + (i + 1) * k, -1);
+            for (auto j = static_cast<int64_t>(heap.size()) - 1; j >= 0; --j) {
+                labels[i * k + j] = heap.top().id;
+                distances[i * k + j] = heap.top().val;
+                heap.pop();
+            }
+        }
+    }
+
+    [[nodiscard]] size_t
+    max_search_batch_size() const override {
+        return empty_segment_->max_search_batch_size();
+    }
+
+    std::vector<float>
+    GetAllDistances(const SparseRow<T>& query, float drop_ratio_search, const BitsetView& bitset,
+                    const DocValueComputer<T>& computer) const override {
+        if (query.size() == 0) {
+            return {};
+        }
+        auto snapshot = std::atomic_load(&snapshot_);
+        std::vector<float> distances;
+        distances.reserve(n_rows(*snapshot));
+        for (const auto& segment : *snapshot) {
+            auto seg_distances =
+                segment->index->GetAllDistances(query, drop_ratio_search, segment_bitset(bitset, *segment), computer);
+            distances.insert(distances.end(), seg_distances.begin(), seg_distances.end());
+        }
+        return distances;
+    }
+
+    float
+    GetRawDistance(const label_t vec_id, const SparseRow<T>& query, const DocValueComputer<T>& computer) const override {
+        auto snapshot = std::atomic_load(&snapshot_);
+        auto segment = find_segment(*snapshot, vec_id);
+        if (segment == nullptr) {
+            return 0.0f;
+        }
+        return segment->index->GetRawDistance(vec_id - segment->base, query, computer);
+    }
+
+    std::vector<SparseRow<T>>
+    GetRows() const override {
+        auto snapshot = std::atomic_load(&snapshot_);
+        std::vector<SparseRow<T>> rows;
+        rows.reserve(n_rows(*snapshot));
+        for (const auto& segment : *snapshot) {
+            auto seg_rows = segment->index->GetRows();
+            std::move(seg_rows.begin(), seg_rows.end(), std::back_inserter(rows));
+        }
+        return rows;
+    }
+
+    // Copies the raw row of vec_id to row, returns false if vec_id does not exist or raw data are not kept.
+    bool
+    GetRawRow(label_t vec_id, SparseRow<T>& row) const {
+        auto snapshot = std::atomic_load(&snapshot_);
+        auto segment = find_segment(*snapshot, vec_id);
+        if (segment == nullptr || segment->raw_rows.empty()) {
+            return false;
+        }
+        row = segment->raw_rows[vec_id - segment->base];
+        return true;
+    }
+
+    expected<DocValueComputer<T>>
+    GetDocValueComputer(const SparseInvertedIndexConfig& cfg) const override {
+        return empty_segment_->GetDocValueComputer(cfg);
+    }
+
+    [[nodiscard]] size_t
+    size() const override {
+        auto snapshot = std::atomic_load(&snapshot_);
+        size_t res = sizeof(*this);
+        for (const auto& segment : *snapshot) {
+            res += segment->index->size();
+        }
+        return res;
+    }
+
+    [[nodiscard]] size_t
+    n_rows() const override {
+        return n_rows(*std::atomic_load(&snapshot_));
+    }
+
+    [[nodiscard]] size_t
+    n_cols() const override {
+        auto snapshot = std::atomic_load(&snapshot_);
+        size_t res = 0;
+        for (const auto& segment : *snapshot) {
+            res = std::max(res, segment->index->n_cols());
+        }
+        return res;
+    }
+
+    // the encoding and the doc id reordering only apply to the serialized index, new segments are optimized for
+    // being built quickly.
+    void
+    SetPostingListEncoding(PostingListEncoding encoding) override {
+        posting_list_encoding_ = encoding;
+    }
+
+    void
+    SetDocIdReordering(bool doc_id_reordering) override {
+        doc_id_reordering_ = doc_id_reordering;
+    }
+
+ private:
+    struct Segment {
+        std::unique_ptr<BaseInvertedIndex<T>> index;
+        // raw rows of the segment, only kept if keep_raw_data_.
+        std::vector<SparseRow<T>> raw_rows;
+        // id of the first row of the segment.
+        size_t base;
+    };
+    using Snapshot = std::vector<std::shared_ptr<const Segment>>;
+
+    static size_t
+    n_rows(const Snapshot& snapshot) {
+        return snapshot.empty() ? 0 : snapshot.back()->base + snapshot.back()->index->n_rows();
+    }
+
+    static const Segment*
+    find_segment(const Snapshot& snapshot, label_t vec_id) {
+        auto it = std::upper_bound(snapshot.begin(), snapshot.end(), vec_id,
+                                   [](label_t id, const auto& segment) { return id < (label_t)segment->base; });
+        if (it == snapshot.begin() || vec_id >= (label_t)n_rows(snapshot)) {
+            return nullptr;
+        }
+        return (it - 1)->get();
+    }
+
+    // bitset viewed from the ids of segment.
+    static BitsetView
+    segment_bitset(const BitsetView& bitset, const Segment& segment) {
+        BitsetView seg_bitset = bitset;
+        if (!seg_bitset.empty()) {
+            seg_bitset.set_id_offset(segment.base);
+        }
+        return seg_bitset;
+    }
+
+    expected<std::shared_ptr<const Segment>>
+    make_segment(const SparseRow<T>* data, size_t rows, int64_t dim, std::vector<SparseRow<T>>&& raw_rows,
+                 size_t base) const {
+        auto index_or = segment_factory_();
+        if (!index_or.has_value()) {
+            return expected<std::shared_ptr<const Segment>>::Err(index_or.error(), index_or.what());
+        }
+        std::unique_ptr<BaseInvertedIndex<T>> index(index_or.value());
+        if (auto status = index->Add(data, rows, dim); status != Status::success) {
+            return expected<std::shared_ptr<const Segment>>::Err(status, "failed to add rows to a segment");
+        }
+        return std::shared_ptr<const Segment>(new Segment{std::move(index), std::move(raw_rows), base});
+    }
+
+    expected<std::shared_ptr<const Segment>>
+    merge(const Segment& first, const Segment& second) const {
+        auto rows = first.index->GetRows();
+        auto second_rows = second.index->GetRows();
+        std::move(second_rows.begin(), second_rows.end(), std::back_inserter(rows));
+        std::vector<SparseRow<T>> raw_rows;
+        if (keep_raw_data_) {
+            raw_rows.reserve(rows.size());
+            raw_rows.insert(raw_rows.end(), first.raw_rows.begin(), first.raw_rows.end());
+            raw_rows.insert(raw_rows.end(), second.raw_rows.begin(), second.raw_rows.end());
+        }
+        auto dim = std::max(first.index->n_cols(), second.index->n_cols());
+        return make_segment(rows.data(), rows.size(), dim, std::move(raw_rows), first.base);
+    }
+
+    // builds a single index with all the rows, configured for serialization.
+    expected<std::unique_ptr<BaseInvertedIndex<T>>>
+    merge_all() const {
+        auto index_or = segment_factory_();
+        if (!index_or.has_value()) {
+            return expected<std::unique_ptr<BaseInvertedIndex<T>>>::Err(index_or.error(), index_or.what());
+        }
+        std::unique_ptr<BaseInvertedIndex<T>> index(index_or.value());
+        index->SetPostingListEncoding(posting_list_encoding_);
+        index->SetDocIdReordering(doc_id_reordering_);
+        auto rows = GetRows();
+        if (auto status = index->Add(rows.data(), rows.size(), n_cols()); status != Status::success) {
+            return expected<std::unique_ptr<BaseInvertedIndex<T>>>::Err(status, "failed to merge the segments");
+        }
+        return index;
+    }
+
+    const SegmentFactory segment_factory_;
+    // used for the methods that do not depend on the rows.
+    const std::unique_ptr<BaseInvertedIndex<T>> empty_segment_;
+    const bool keep_raw_data_;
+    PostingListEncoding posting_list_encoding_ = PostingListEncoding::RAW;
+    bool doc_id_reordering_ = false;
+
+    std::mutex add_mutex_;
+    // accessed with std::atomic_load and std::atomic_store only.
+    std::shared_ptr<const Snapshot> snapshot_;
+};  // class GrowingInvertedIndex
+
+}  // namespace knowhere::sparse
+
+#endif  // SPARSE_GROWING_INVERTED_INDEX_H
@@ -11,13 +11,20 @@
 
 #include <sys/mman.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <exception>
 
+#include "index/sparse/sparse_clustered_index.h"
+#include "index/sparse/sparse_growing_inverted_index.h"
 #include "index/sparse/sparse_inverted_index.h"
 #include "index/sparse/sparse_inverted_index_config.h"
 #include "io/file_io.h"
+#include "io/index_binary.h"
 #include "io/memory_io.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/warmup.h"
 #include "knowhere/config.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
@@ -30,9 +37,13 @@
 
 namespace knowhere {
 
+// the posting lists of the longest dimensions that a mapped index reads ahead on load, 1 / ratio of its file
+constexpr size_t kHotPostingListsRatio = 10;
+
 // Inverted Index impl for sparse vectors.
 //
-// Not overriding RangeSearch, will use the default implementation in IndexNode.
+// RangeSearch searches the posting lists with the radius as the threshold of the search algorithm, it falls back to
+// the iterator based implementation in IndexNode when range_search_k limits the number of results.
 //
 // Thread safety: not thread safe.
 template <typename T, bool use_wand>
@@ -58,11 +69,14 @@ class SparseInvertedIndexNode : public IndexNode {
             LOG_KNOWHERE_ERROR_ << Type() << " only support metric_type IP or BM25";
             return Status::invalid_metric_type;
         }
-        auto index_or = CreateIndex</*mmapped=*/false>(cfg);
+        auto index_or = CreateTrainedIndex(*config);
         if (!index_or.has_value()) {
             return index_or.error();
         }
         auto index = index_or.value();
+        index->SetPostingListEncoding(cfg.posting_list_compression.value() ? sparse::PostingListEncoding::BLOCK_PACKED
+                                                                           : sparse::PostingListEncoding::RAW);
+        index->SetDocIdReordering(cfg.doc_id_reordering.value());
         index->Train(static_cast<const sparse::SparseRow<T>*>(dataset->GetTensor()), dataset->GetRows());
         if (index_ != nullptr) {
             LOG_KNOWHERE_WARNING_ << Type() << " has already been created, deleting old";
@@ -94,6 +108,12 @@ class SparseInvertedIndexNode : public IndexNode {
 
     [[nodiscard]] expected<DataSetPtr>
     Search(const DataSetPtr dataset, std::unique_ptr<Config> config, const BitsetView& bitset) const override {
+        return SearchWithNewBuf(dataset, std::move(config), bitset);
+    }
+
+    [[nodiscard]] expected<DataSetPtr>
+    SearchWithBuf(const DataSetPtr dataset, std::unique_ptr<Config> config, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override {
         if (!index_) {
             LOG_KNOWHERE_ERROR_ << "Could not search empty " << Type();
             return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
@@ -106,35 +126,90 @@ class SparseInvertedIndexNode : public IndexNode {
             return expected<DataSetPtr>::Err(computer_or.error(), computer_or.what());
         }
         auto computer = computer_or.value();
-        auto dim_max_score_ratio = cfg.dim_max_score_ratio.value();
-        auto drop_ratio_search = cfg.drop_ratio_search.value_or(0.0f);
-        auto refine_factor = cfg.refine_factor.value_or(1);
-        // if no data was dropped during search, no refinement is needed.
-        if (drop_ratio_search == 0) {
-            refine_factor = 1;
+        auto approx_params = GetApproxSearchParams(*config);
+
+        auto queries = static_cast<const sparse::SparseRow<T>*>(dataset->GetTensor());
+        auto nq = dataset->GetRows();
+        auto k = cfg.k.value();
+
+        // queries are searched in batches when the index can share work among them, but only as long as there are
+        // enough batches to keep all search threads busy.
+        const size_t batch_size = std::clamp<size_t>(nq / std::max<size_t>(search_pool_->size(), 1), 1,
+                                                     index_->max_search_batch_size());
+        SearchStats search_stats(cfg.search_stats.value() ? nq : 0);
+        QuerySearchStats* const stats = search_stats.empty() ? nullptr : search_stats.data();
+        std::vector<folly::Future<folly::Unit>> futs;
+        futs.reserve((nq + batch_size - 1) / batch_size);
+        for (int64_t idx = 0; idx < nq; idx += batch_size) {
+            futs.emplace_back(PushSearchTask(search_pool_, [&, idx = idx, p_id = ids, p_dist = distances]() {
+                if (SearchInterrupted()) {
+                    MarkMissingResults(p_id, p_dist, k, idx, std::min<int64_t>(idx + batch_size, nq));
+                    return;
+                }
+                ScopedSearchStage stage(SearchStage::LIST_SCAN);
+                // the stats of the queries of the task start at those of its first query
+                auto task_params = approx_params;
+                task_params.stats = (stats == nullptr) ? nullptr : stats + idx;
+                if (batch_size == 1) {
+                    index_->Search(queries[idx], k, p_dist + idx * k, p_id + idx * k, bitset, computer, task_params);
+                } else {
+                    index_->SearchBatch(queries + idx, std::min<int64_t>(batch_size, nq - idx), k, p_dist + idx * k,
+                                        p_id + idx * k, bitset, computer, task_params);
+                }
+            }));
+        }
+        WaitAllSuccess(futs);
+        auto res = GenResultDataSet(nq, k, ids, distances);
+        res->SetIsOwner(false);
+        if (stats != nullptr) {
+            res->SetSearchStats(std::move(search_stats));
         }
+        return res;
+    }
 
-        sparse::InvertedIndexApproxSearchParams approx_params = {
-            .refine_factor = refine_factor,
-            .drop_ratio_search = drop_ratio_search,
-            .dim_max_score_ratio = dim_max_score_ratio,
-        };
+    [[nodiscard]] expected<DataSetPtr>
+    RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> config, const BitsetView& bitset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_ERROR_ << "Could not search empty " << Type();
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+
+        auto cfg = static_cast<const SparseInvertedIndexConfig&>(*config);
+        // the k closest results in range are found by walking the iterator from the closest one
+        if (cfg.range_search_k.value() >= 0) {
+            return IndexNode::RangeSearch(dataset, std::move(config), bitset);
+        }
+
+        auto computer_or = index_->GetDocValueComputer(cfg);
+        if (!computer_or.has_value()) {
+            return expected<DataSetPtr>::Err(computer_or.error(), computer_or.what());
+        }
+        auto computer = computer_or.value();
+        auto approx_params = GetApproxSearchParams(*config);
 
         auto queries = static_cast<const sparse::SparseRow<T>*>(dataset->GetTensor());
         auto nq = dataset->GetRows();
-        auto k = cfg.k.value();
-        auto p_id = std::make_unique<sparse::label_t[]>(nq * k);
-        auto p_dist = std::make_unique<float[]>(nq * k);
+        const float radius = cfg.radius.value();
+        const float range_filter = cfg.range_filter.value();
 
+        RangeSearchResultArena arena(nq);
         std::vector<folly::Future<folly::Unit>> futs;
         futs.reserve(nq);
         for (int64_t idx = 0; idx < nq; ++idx) {
-            futs.emplace_back(search_pool_->push([&, idx = idx, p_id = p_id.get(), p_dist = p_dist.get()]() {
-                index_->Search(queries[idx], k, p_dist + idx * k, p_id + idx * k, bitset, computer, approx_params);
+            futs.emplace_back(PushSearchTask(search_pool_, [&, idx = idx]() {
+                // an interrupted search leaves the results of the remaining queries empty
+                if (SearchInterrupted()) {
+                    return;
+                }
+                ScopedSearchStage stage(SearchStage::LIST_SCAN);
+                auto writer = arena.GetWriter(idx);
+                auto task_params = approx_params;
+                index_->RangeSearch(queries[idx], radius, range_filter, bitset, computer, task_params, writer);
             }));
         }
         WaitAllSuccess(futs);
-        return GenResultDataSet(nq, k, p_id.release(), p_dist.release());
+        ScopedSearchStage stage(SearchStage::RESULT_ASSEMBLY);
+        return GenResultDataSet(nq, arena.Finish());
     }
 
  private:
@@ -155,14 +230,16 @@ class SparseInvertedIndexNode : public IndexNode {
         // returns n_rows / 10 DistId for the first time to create a large enough window for refinement.
         void
         next_batch(std::function<void(const std::vector<DistId>&)> batch_handler) override {
-            std::vector<DistId> dists;
             size_t num = first_return_ ? (std::max(index_->n_rows() / 10, static_cast<size_t>(20))) : 1;
             first_return_ = false;
-            for (size_t i = 0; i < num && precomputed_it_->HasNext(); ++i) {
-                auto [id, dist] = precomputed_it_->Next();
-                dists.emplace_back(id, dist);
+            ids_.resize(num);
+            dists_.resize(num);
+            num = precomputed_it_->NextBatch(num, ids_.data(), dists_.data());
+            batch_.clear();
+            for (size_t i = 0; i < num; ++i) {
+                batch_.emplace_back(ids_[i], dists_[i]);
             }
-            batch_handler(dists);
+            batch_handler(batch_);
         }
 
         float
@@ -176,6 +253,10 @@ class SparseInvertedIndexNode : public IndexNode {
         const sparse::DocValueComputer<float> computer_;
         std::shared_ptr<PrecomputedDistanceIterator> precomputed_it_;
         bool first_return_ = true;
+        // buffers reused by next_batch
+        std::vector<int64_t> ids_;
+        std::vector<float> dists_;
+        std::vector<DistId> batch_;
     };
 
  public:
@@ -275,24 +356,61 @@ class SparseInvertedIndexNode : public IndexNode {
             RETURN_IF_ERROR(index_->Serialize(writer));
         }
         std::shared_ptr<uint8_t[]> data(writer.data());
-        binset.Append(Type(), data, writer.tellg());
+        try {
+            AppendIndexBinary(binset, Type(), version_, data, writer.tellg());
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << "Failed to serialize " << Type() << ": " << e.what();
+            return Status::internal_error;
+        }
         return Status::success;
     }
 
+    Status
+    SerializeToFile(const std::string& filename) const override {
+        if (!index_) {
+            LOG_KNOWHERE_ERROR_ << "Could not serialize empty " << Type();
+            return Status::empty_index;
+        }
+        // the index is streamed uncompressed, as its binary is, for the file to be mapped
+        Status status = Status::success;
+        try {
+            WriteIndexFile(
+                filename, Type(), version_,
+                [&](faiss::IOWriter* sink) {
+                    ForwardingIOWriter writer(sink);
+                    status = version_use_raw_data() ? index_->SerializeV0(writer) : index_->Serialize(writer);
+                },
+                false);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << "Failed to serialize " << Type() << " to " << filename << ": " << e.what();
+            status = Status::disk_file_error;
+        }
+        if (status != Status::success) {
+            std::remove(filename.c_str());
+        }
+        return status;
+    }
+
     Status
     Deserialize(const BinarySet& binset, std::shared_ptr<Config> config) override {
         if (index_ != nullptr) {
             LOG_KNOWHERE_WARNING_ << Type() << " has already been created, deleting old";
             DeleteExistingIndex();
         }
-        auto cfg = static_cast<const knowhere::SparseInvertedIndexConfig&>(*config);
         auto binary = binset.GetByName(Type());
         if (binary == nullptr) {
             LOG_KNOWHERE_ERROR_ << "Invalid BinarySet.";
             return Status::invalid_binary_set;
         }
-        MemoryIOReader reader(binary->data.get(), binary->size);
-        auto index_or = CreateIndex</*mmapped=*/false>(cfg);
+        std::pair<const uint8_t*, size_t> index_data;
+        try {
+            index_data = GetIndexData(binary->data.get(), binary->size, version_, Type(), /*verify=*/true);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << "Invalid " << Type() << " binary: " << e.what();
+            return Status::invalid_binary_set;
+        }
+        MemoryIOReader reader(const_cast<uint8_t*>(index_data.first), index_data.second);
+        auto index_or = CreateLoadedIndex(*config, /*mmapped=*/false);
         if (!index_or.has_value()) {
             return index_or.error();
         }
@@ -313,7 +431,7 @@ class SparseInvertedIndexNode : public IndexNode {
         }
 
         auto cfg = static_cast<const knowhere::SparseInvertedIndexConfig&>(*config);
-        auto index_or = CreateIndex</*mmapped=*/true>(cfg);
+        auto index_or = CreateLoadedIndex(*config, /*mmapped=*/true);
         if (!index_or.has_value()) {
             return index_or.error();
         }
@@ -333,14 +451,61 @@ class SparseInvertedIndexNode : public IndexNode {
             return Status::disk_file_error;
         }
         auto mmap_guard = std::make_unique<MmapGuard>(map_size, filename, mapped_memory);
-        MemoryIOReader map_reader(reinterpret_cast<uint8_t*>(mapped_memory), map_size);
+        // the data is not verified, for the mapped index to only load the pages that it reads
+        std::pair<const uint8_t*, size_t> index_data;
+        try {
+            index_data = GetIndexData(reinterpret_cast<uint8_t*>(mapped_memory), map_size, version_, Type(),
+                                      /*verify=*/false);
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_ERROR_ << "Invalid " << Type() << " file " << filename << ": " << e.what();
+            return Status::disk_file_error;
+        }
+        MemoryIOReader map_reader(const_cast<uint8_t*>(index_data.first), index_data.second);
+        Status status;
         if (version_use_raw_data()) {
             auto supplement_target_filename = filename + ".knowhere_sparse_index_supplement";
-            return index_->DeserializeV0(map_reader, map_flags, supplement_target_filename);
+            status = index_->DeserializeV0(map_reader, map_flags, supplement_target_filename);
         } else {
             mmap_guard_ = std::move(mmap_guard);
-            return index_->Deserialize(map_reader);
+            status = index_->Deserialize(map_reader);
+            // the searches only read the posting lists of the dimensions of the queries
+            AdviseMmapAccess({{mapped_memory, map_size}}, MmapAccess::RANDOM);
+        }
+        if (status == Status::success) {
+            AdviseMmapAccess(index_->hot_ranges(map_size / kHotPostingListsRatio), MmapAccess::WILLNEED);
+        }
+        return status;
+    }
+
+    // the whole index is warmed up, the posting lists that a search goes through are not known ahead
+    Status
+    Warmup(WarmupLevel /*level*/, const WarmupProgress& progress) override {
+        if (index_ == nullptr) {
+            return Status::empty_index;
+        }
+        return WarmupRanges(MappedRanges(), progress);
+    }
+
+    Status
+    Cooldown() override {
+        if (index_ == nullptr) {
+            return Status::empty_index;
+        }
+        return CooldownRanges(MappedRanges());
+    }
+
+    expected<MemoryReport>
+    GetMemoryReport() const override {
+        MemoryReport report;
+        if (index_ == nullptr) {
+            return report;
+        }
+        index_->report_memory(report);
+        if (mmap_guard_ != nullptr) {
+            // the posting lists that the index views in the file
+            report.AddMapped(MemoryComponent::CODES, mmap_guard_->map_addr, mmap_guard_->map_size);
         }
+        return report;
     }
 
     static std::unique_ptr<BaseConfig>
@@ -374,7 +539,39 @@ class SparseInvertedIndexNode : public IndexNode {
         return use_wand ? knowhere::IndexEnum::INDEX_SPARSE_WAND : knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX;
     }
 
- private:
+ protected:
+    // creates the index that Train() sets up and Add() adds rows to.
+    virtual expected<sparse::BaseInvertedIndex<T>*>
+    CreateTrainedIndex(const Config& config) const {
+        return CreateIndex</*mmapped=*/false>(static_cast<const SparseInvertedIndexConfig&>(config));
+    }
+
+    // creates the index that Deserialize() and DeserializeFromFile() load data into.
+    virtual expected<sparse::BaseInvertedIndex<T>*>
+    CreateLoadedIndex(const Config& config, bool mmapped) const {
+        const auto& cfg = static_cast<const SparseInvertedIndexConfig&>(config);
+        return mmapped ? CreateIndex</*mmapped=*/true>(cfg) : CreateIndex</*mmapped=*/false>(cfg);
+    }
+
+    virtual sparse::InvertedIndexApproxSearchParams
+    GetApproxSearchParams(const Config& config) const {
+        const auto& cfg = static_cast<const SparseInvertedIndexConfig&>(config);
+        auto dim_max_score_ratio = cfg.dim_max_score_ratio.value();
+        auto drop_ratio_search = cfg.drop_ratio_search.value_or(0.0f);
+        auto refine_factor = cfg.refine_factor.value_or(1);
+        // if no data was dropped during search, no refinement is needed.
+        if (drop_ratio_search == 0) {
+            refine_factor = 1;
+        }
+
+        return {
+            .refine_factor = refine_factor,
+            .drop_ratio_search = drop_ratio_search,
+            .dim_max_score_ratio = dim_max_score_ratio,
+            .term_pruning_ratio = cfg.term_pruning_ratio.value_or(0.0f),
+        };
+    }
+
     template <bool mmapped>
     expected<sparse::BaseInvertedIndex<T>*>
     CreateIndex(const SparseInvertedIndexConfig& cfg) const {
@@ -389,21 +586,27 @@ class SparseInvertedIndexNode : public IndexNode {
             // avgdl is used as a denominator in BM25 score computation,
             // so it should be at least 1.0 to avoid division by zero.
             avgdl = std::max(avgdl, 1.0f);
+            auto precompute_impacts = cfg.bm25_precompute_impacts.value_or(false);
 
             if (use_wand || cfg.inverted_index_algo.value() == "DAAT_WAND") {
                 auto index = new sparse::InvertedIndex<T, uint16_t, sparse::InvertedIndexAlgo::DAAT_WAND, mmapped>(
                     sparse::SparseMetricType::METRIC_BM25);
-                index->SetBM25Params(k1, b, avgdl);
+                index->SetBM25Params(k1, b, avgdl, precompute_impacts);
                 return index;
             } else if (cfg.inverted_index_algo.value() == "DAAT_MAXSCORE") {
                 auto index = new sparse::InvertedIndex<T, uint16_t, sparse::InvertedIndexAlgo::DAAT_MAXSCORE, mmapped>(
                     sparse::SparseMetricType::METRIC_BM25);
-                index->SetBM25Params(k1, b, avgdl);
+                index->SetBM25Params(k1, b, avgdl, precompute_impacts);
+                return index;
+            } else if (cfg.inverted_index_algo.value() == "DAAT_BMW") {
+                auto index = new sparse::InvertedIndex<T, uint16_t, sparse::InvertedIndexAlgo::DAAT_BMW, mmapped>(
+                    sparse::SparseMetricType::METRIC_BM25);
+                index->SetBM25Params(k1, b, avgdl, precompute_impacts);
                 return index;
             } else if (cfg.inverted_index_algo.value() == "TAAT_NAIVE") {
                 auto index = new sparse::InvertedIndex<T, uint16_t, sparse::InvertedIndexAlgo::TAAT_NAIVE, mmapped>(
                     sparse::SparseMetricType::METRIC_BM25);
-                index->SetBM25Params(k1, b, avgdl);
+                index->SetBM25Params(k1, b, avgdl, precompute_impacts);
                 return index;
             } else {
                 return expected<sparse::BaseInvertedIndex<T>*>::Err(Status::invalid_args,
@@ -418,6 +621,10 @@ class SparseInvertedIndexNode : public IndexNode {
                 auto index = new sparse::InvertedIndex<T, T, sparse::InvertedIndexAlgo::DAAT_MAXSCORE, mmapped>(
                     sparse::SparseMetricType::METRIC_IP);
                 return index;
+            } else if (cfg.inverted_index_algo.value() == "DAAT_BMW") {
+                auto index = new sparse::InvertedIndex<T, T, sparse::InvertedIndexAlgo::DAAT_BMW, mmapped>(
+                    sparse::SparseMetricType::METRIC_IP);
+                return index;
             } else if (cfg.inverted_index_algo.value() == "TAAT_NAIVE") {
                 auto index = new sparse::InvertedIndex<T, T, sparse::InvertedIndexAlgo::TAAT_NAIVE, mmapped>(
                     sparse::SparseMetricType::METRIC_IP);
@@ -429,6 +636,9 @@ class SparseInvertedIndexNode : public IndexNode {
         }
     }
 
+    sparse::BaseInvertedIndex<T>* index_{};
+
+ private:
     void
     DeleteExistingIndex() {
         if (index_ != nullptr) {
@@ -457,7 +667,16 @@ class SparseInvertedIndexNode : public IndexNode {
         }
     };
 
-    sparse::BaseInvertedIndex<T>* index_{};
+    // the file that DeserializeFromFile() mapped, and the supplement file of the version 0 indexes
+    std::vector<MemoryRange>
+    MappedRanges() const {
+        auto ranges = index_->mapped_ranges();
+        if (mmap_guard_ != nullptr) {
+            ranges.push_back({mmap_guard_->map_addr, mmap_guard_->map_size});
+        }
+        return ranges;
+    }
+
     std::shared_ptr<ThreadPool> search_pool_;
     std::shared_ptr<ThreadPool> build_pool_;
     const int32_t index_version_;
@@ -467,7 +686,8 @@ class SparseInvertedIndexNode : public IndexNode {
 
 // Concurrent version of SparseInvertedIndexNode
 //
-// Thread safety: only the overridden methods are allowed to be called concurrently.
+// Thread safety: Add() can be called concurrently with the search methods and the getters. Rows are added to a
+// GrowingInvertedIndex, searches run on a snapshot of it and never wait for an Add to finish.
 template <typename T, bool use_wand>
 class SparseInvertedIndexNodeCC : public SparseInvertedIndexNode<T, use_wand> {
  public:
@@ -475,75 +695,6 @@ class SparseInvertedIndexNodeCC : public SparseInvertedIndexNode<T, use_wand> {
         : SparseInvertedIndexNode<T, use_wand>(version, object) {
     }
 
-    Status
-    Add(const DataSetPtr dataset, std::shared_ptr<Config> config, bool use_knowhere_build_pool) override {
-        std::unique_lock<std::mutex> lock(mutex_);
-        uint64_t task_id = next_task_id_++;
-        add_tasks_.push(task_id);
-
-        // add task is allowed to run only after all search tasks that come before it have finished.
-        cv_.wait(lock, [this, task_id]() { return current_task_id_ == task_id && active_readers_ == 0; });
-
-        auto res = SparseInvertedIndexNode<T, use_wand>::Add(dataset, config, use_knowhere_build_pool);
-
-        auto cfg = static_cast<const SparseInvertedIndexConfig&>(*config);
-        if (IsMetricType(cfg.metric_type.value(), metric::IP)) {
-            // insert dataset to raw data if metric type is IP
-            auto data = static_cast<const sparse::SparseRow<T>*>(dataset->GetTensor());
-            auto rows = dataset->GetRows();
-            raw_data_.insert(raw_data_.end(), data, data + rows);
-        }
-
-        add_tasks_.pop();
-        current_task_id_++;
-        lock.unlock();
-        cv_.notify_all();
-        return res;
-    }
-
-    expected<DataSetPtr>
-    Search(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
-        ReadPermission permission(*this);
-        return SparseInvertedIndexNode<T, use_wand>::Search(dataset, std::move(cfg), bitset);
-    }
-
-    expected<std::vector<IndexNode::IteratorPtr>>
-    AnnIterator(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset,
-                bool use_knowhere_search_pool) const override {
-        ReadPermission permission(*this);
-        // Always uses PrecomputedDistanceIterator for SparseInvertedIndexNodeCC:
-        // If we want to use RefineIterator, it needs to get another ReadPermission when calling
-        // index_->GetRawDistance(). If an Add task is added in between, there will be a deadlock.
-        auto config = static_cast<const knowhere::SparseInvertedIndexConfig&>(*cfg);
-        config.drop_ratio_search = 0.0f;
-        return SparseInvertedIndexNode<T, use_wand>::AnnIterator(dataset, std::move(cfg), bitset,
-                                                                 use_knowhere_search_pool);
-    }
-
-    expected<DataSetPtr>
-    RangeSearch(const DataSetPtr dataset, std::unique_ptr<Config> cfg, const BitsetView& bitset) const override {
-        ReadPermission permission(*this);
-        return SparseInvertedIndexNode<T, use_wand>::RangeSearch(dataset, std::move(cfg), bitset);
-    }
-
-    int64_t
-    Dim() const override {
-        ReadPermission permission(*this);
-        return SparseInvertedIndexNode<T, use_wand>::Dim();
-    }
-
-    int64_t
-    Size() const override {
-        ReadPermission permission(*this);
-        return SparseInvertedIndexNode<T, use_wand>::Size();
-    }
-
-    int64_t
-    Count() const override {
-        ReadPermission permission(*this);
-        return SparseInvertedIndexNode<T, use_wand>::Count();
-    }
-
     std::string
     Type() const override {
         return use_wand ? knowhere::IndexEnum::INDEX_SPARSE_WAND_CC
@@ -552,24 +703,23 @@ class SparseInvertedIndexNodeCC : public SparseInvertedIndexNode<T, use_wand> {
 
     expected<DataSetPtr>
     GetVectorByIds(const DataSetPtr dataset) const override {
-        ReadPermission permission(*this);
-
-        if (raw_data_.empty()) {
-            return expected<DataSetPtr>::Err(Status::invalid_args, "GetVectorByIds failed: raw data is empty");
+        if (this->index_ == nullptr) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "GetVectorByIds failed: index is empty");
         }
+        const auto& index = static_cast<const sparse::GrowingInvertedIndex<T>&>(*this->index_);
 
         auto rows = dataset->GetRows();
         auto ids = dataset->GetIds();
         auto data = std::make_unique<sparse::SparseRow<T>[]>(rows);
         int64_t dim = 0;
 
-        try {
-            for (int64_t i = 0; i < rows; ++i) {
-                data[i] = raw_data_[ids[i]];
-                dim = std::max(dim, data[i].dim());
+        for (int64_t i = 0; i < rows; ++i) {
+            if (!index.GetRawRow(ids[i], data[i])) {
+                return expected<DataSetPtr>::Err(Status::invalid_args,
+                                                 "GetVectorByIds failed: raw data of id " + std::to_string(ids[i]) +
+                                                     " is not available");
             }
-        } catch (std::exception& e) {
-            return expected<DataSetPtr>::Err(Status::invalid_args, "GetVectorByIds failed: " + std::string(e.what()));
+            dim = std::max(dim, data[i].dim());
         }
 
         auto res = GenResultDataSet(rows, dim, data.release());
@@ -601,37 +751,81 @@ class SparseInvertedIndexNodeCC : public SparseInvertedIndexNode<T, use_wand> {
         return Status::not_implemented;
     }
 
- private:
-    struct ReadPermission {
-        ReadPermission(const SparseInvertedIndexNodeCC& node) : node_(node) {
-            std::unique_lock<std::mutex> lock(node_.mutex_);
-            uint64_t task_id = node_.next_task_id_++;
-            // read task may execute only after all add tasks that come before it have finished.
-            if (!node_.add_tasks_.empty() && task_id > node_.add_tasks_.front()) {
-                node_.cv_.wait(
-                    lock, [this, task_id]() { return node_.add_tasks_.empty() || task_id < node_.add_tasks_.front(); });
-            }
-            // read task is allowed to run, block all add tasks
-            node_.active_readers_++;
+ protected:
+    expected<sparse::BaseInvertedIndex<T>*>
+    CreateTrainedIndex(const Config& config) const override {
+        auto cfg = static_cast<const SparseInvertedIndexConfig&>(config);
+        auto empty_segment_or = this->template CreateIndex</*mmapped=*/false>(cfg);
+        if (!empty_segment_or.has_value()) {
+            return empty_segment_or;
         }
+        // raw data are kept if metric type is IP
+        return new sparse::GrowingInvertedIndex<T>(
+            [this, cfg]() { return this->template CreateIndex</*mmapped=*/false>(cfg); }, empty_segment_or.value(),
+            IsMetricType(cfg.metric_type.value(), metric::IP));
+    }
+};  // class SparseInvertedIndexNodeCC
 
-        ~ReadPermission() {
-            std::unique_lock<std::mutex> lock(node_.mutex_);
-            node_.active_readers_--;
-            node_.current_task_id_++;
-            node_.cv_.notify_all();
+// Approximate clustered index for sparse vectors, see sparse::ClusteredInvertedIndex. It trades some recall for a
+// search latency that no longer grows with the length of the posting lists.
+//
+// Thread safety: not thread safe.
+template <typename T>
+class SparseClusteredIndexNode : public SparseInvertedIndexNode<T, /*use_wand=*/false> {
+ public:
+    explicit SparseClusteredIndexNode(const int32_t& version, const Object& object)
+        : SparseInvertedIndexNode<T, /*use_wand=*/false>(version, object) {
+    }
+
+    static std::unique_ptr<BaseConfig>
+    StaticCreateConfig() {
+        return std::make_unique<SparseClusteredIndexConfig>();
+    }
+
+    [[nodiscard]] std::unique_ptr<BaseConfig>
+    CreateConfig() const override {
+        return StaticCreateConfig();
+    }
+
+    [[nodiscard]] std::string
+    Type() const override {
+        return knowhere::IndexEnum::INDEX_SPARSE_CLUSTERED;
+    }
+
+ protected:
+    expected<sparse::BaseInvertedIndex<T>*>
+    CreateTrainedIndex(const Config& config) const override {
+        const auto& cfg = static_cast<const SparseClusteredIndexConfig&>(config);
+        if (!IsMetricType(cfg.metric_type.value(), metric::IP)) {
+            return expected<sparse::BaseInvertedIndex<T>*>::Err(Status::invalid_metric_type,
+                                                                Type() + " only support metric_type IP");
         }
-        const SparseInvertedIndexNodeCC& node_;
-    };
+        return new sparse::ClusteredInvertedIndex<T>({
+            .posting_list_length = static_cast<size_t>(cfg.posting_list_length.value()),
+            .centroid_fraction = cfg.centroid_fraction.value(),
+            .summary_energy = cfg.summary_energy.value(),
+        });
+    }
 
-    mutable std::mutex mutex_;
-    mutable std::condition_variable cv_;
-    mutable int64_t active_readers_ = 0;
-    mutable std::queue<uint64_t> add_tasks_;
-    mutable uint64_t next_task_id_ = 0;
-    mutable uint64_t current_task_id_ = 0;
-    mutable std::vector<sparse::SparseRow<T>> raw_data_ = {};
-};  // class SparseInvertedIndexNodeCC
+    expected<sparse::BaseInvertedIndex<T>*>
+    CreateLoadedIndex(const Config& config, bool mmapped) const override {
+        if (mmapped) {
+            return expected<sparse::BaseInvertedIndex<T>*>::Err(Status::not_implemented,
+                                                                Type() + " does not support mmap");
+        }
+        return CreateTrainedIndex(config);
+    }
+
+    sparse::InvertedIndexApproxSearchParams
+    GetApproxSearchParams(const Config& config) const override {
+        const auto& cfg = static_cast<const SparseClusteredIndexConfig&>(config);
+        auto approx_params = SparseInvertedIndexNode<T, /*use_wand=*/false>::GetApproxSearchParams(config);
+        approx_params.query_cut = cfg.query_cut.value();
+        approx_params.heap_factor = cfg.heap_factor.value();
+        approx_params.block_budget = cfg.block_budget.value();
+        return approx_params;
+    }
+};  // class SparseClusteredIndexNode
 
 #ifdef KNOWHERE_WITH_CARDINAL
 KNOWHERE_SIMPLE_REGISTER_SPARSE_FLOAT_GLOBAL(SPARSE_INVERTED_INDEX_DEPRECATED, SparseInvertedIndexNode,
@@ -656,4 +850,5 @@ KNOWHERE_SIMPLE_REGISTER_SPARSE_FLOAT_GLOBAL(SPARSE_INVERTED_INDEX_CC, SparseInv
 KNOWHERE_SIMPLE_REGISTER_SPARSE_FLOAT_GLOBAL(SPARSE_WAND_CC, SparseInvertedIndexNodeCC, knowhere::feature::MMAP,
                                              /*use_wand=*/true)
 #endif
+KNOWHERE_SIMPLE_REGISTER_SPARSE_FLOAT_GLOBAL(SPARSE_CLUSTERED, SparseClusteredIndexNode, knowhere::feature::NONE)
 }  // namespace knowhere
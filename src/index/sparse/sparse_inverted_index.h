@@ -16,24 +16,38 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <boost/core/span.hpp>
 #include <cmath>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "index/sparse/sparse_dim_map.h"
+#include "index/sparse/sparse_doc_reorder.h"
 #include "index/sparse/sparse_inverted_index_config.h"
+#include "index/sparse/sparse_posting_list.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview.h"
+#include "knowhere/comp/huge_page.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/memory_report.h"
+#include "knowhere/comp/task.h"
+#include "knowhere/comp/warmup.h"
 #include "knowhere/expected.h"
 #include "knowhere/log.h"
 #include "knowhere/prometheus_client.h"
+#include "knowhere/range_util.h"
+#include "knowhere/search_stats.h"
 #include "knowhere/sparse_utils.h"
 #include "knowhere/utils.h"
+#include "simd/hook.h"
 
 namespace knowhere::sparse {
 
@@ -41,6 +55,7 @@ enum class InvertedIndexAlgo {
     TAAT_NAIVE,
     DAAT_WAND,
     DAAT_MAXSCORE,
+    DAAT_BMW,
 };
 
 struct InvertedIndexBuildStats {
@@ -54,7 +69,9 @@ enum class InvertedIndexSectionType : uint32_t {
     DIM_MAP = 2,
     ROW_SUMS = 3,
     MAX_SCORES_PER_DIM = 4,
-    PROMETHEUS_BUILD_STATS = 5
+    PROMETHEUS_BUILD_STATS = 5,
+    BLOCK_MAX_SCORES = 6,
+    DOC_ID_MAP = 7
 };
 
 struct InvertedIndexSectionHeader {
@@ -67,6 +84,16 @@ struct InvertedIndexApproxSearchParams {
     int refine_factor;
     float drop_ratio_search;
     float dim_max_score_ratio;
+    // used by the DAAT algorithms of InvertedIndex only, 0 means no pruning, @see
+    // SparseInvertedIndexConfig::term_pruning_ratio.
+    float term_pruning_ratio = 0.0f;
+    // used by ClusteredInvertedIndex only, 0 means no limit.
+    int query_cut = 0;
+    float heap_factor = 1.0f;
+    int block_budget = 0;
+    // if not null, the cost of the search of the i-th query of a SearchBatch() (of the query of a Search()) is added to
+    // stats[i]. Counted by InvertedIndex only.
+    QuerySearchStats* stats = nullptr;
 };
 
 template <typename T>
@@ -98,13 +125,42 @@ class BaseInvertedIndex {
     Search(const SparseRow<T>& query, size_t k, float* distances, label_t* labels, const BitsetView& bitset,
            const DocValueComputer<T>& computer, InvertedIndexApproxSearchParams& approx_params) const = 0;
 
+    // Searches nq queries, the results of the i-th query are written to distances + i * k and labels + i * k.
+    virtual void
+    SearchBatch(const SparseRow<T>* queries, size_t nq, size_t k, float* distances, label_t* labels,
+                const BitsetView& bitset, const DocValueComputer<T>& computer,
+                InvertedIndexApproxSearchParams& approx_params) const = 0;
+
+    // Max number of queries that SearchBatch() searches together, 1 if the queries are always searched one by one.
+    [[nodiscard]] virtual size_t
+    max_search_batch_size() const = 0;
+
     virtual std::vector<float>
     GetAllDistances(const SparseRow<T>& query, float drop_ratio_search, const BitsetView& bitset,
                     const DocValueComputer<T>& computer) const = 0;
 
+    // Adds to writer the docs whose distance to the query is in (radius, range_filter], in no particular order. The
+    // default goes through the distances to all the docs.
+    virtual void
+    RangeSearch(const SparseRow<T>& query, float radius, float range_filter, const BitsetView& bitset,
+                const DocValueComputer<T>& computer, InvertedIndexApproxSearchParams& approx_params,
+                RangeSearchResultArena::Writer& writer) const {
+        auto distances = GetAllDistances(query, approx_params.drop_ratio_search, bitset, computer);
+        for (size_t i = 0; i < distances.size(); ++i) {
+            if (distances[i] != 0 && distances[i] > radius && distances[i] <= range_filter) {
+                writer.Add(i, distances[i]);
+            }
+        }
+    }
+
     virtual float
     GetRawDistance(const label_t vec_id, const SparseRow<T>& query, const DocValueComputer<T>& computer) const = 0;
 
+    // Reconstructs the rows of the index from the posting lists, in the order of their ids. Values are the quantized
+    // ones, and explicit zeros of the added rows are lost.
+    virtual std::vector<SparseRow<T>>
+    GetRows() const = 0;
+
     virtual expected<DocValueComputer<T>>
     GetDocValueComputer(const SparseInvertedIndexConfig& cfg) const = 0;
 
@@ -116,6 +172,32 @@ class BaseInvertedIndex {
 
     [[nodiscard]] virtual size_t
     n_cols() const = 0;
+
+    // encoding of the doc ids written by Serialize, posting lists are kept uncompressed in memory while growing.
+    virtual void
+    SetPostingListEncoding(PostingListEncoding encoding) = 0;
+
+    virtual void
+    SetDocIdReordering(bool doc_id_reordering) = 0;
+
+    // adds the memory of the index to the report. The posting lists of a mmapped index that are views of the file
+    // that it was deserialized from are not reported, that file being mapped by the caller.
+    virtual void
+    report_memory(MemoryReport& report) const {
+        report.AddHeap(MemoryComponent::CODES, size());
+    }
+
+    // the file mappings that the index allocated itself, to warm up and cool down, empty if it is not mmapped.
+    [[nodiscard]] virtual std::vector<MemoryRange>
+    mapped_ranges() const {
+        return {};
+    }
+
+    // the posting lists of the longest dimensions, that most queries are expected to go through, up to budget bytes.
+    [[nodiscard]] virtual std::vector<MemoryRange>
+    hot_ranges(size_t /*budget*/) const {
+        return {};
+    }
 };
 
 template <typename DType, typename QType, InvertedIndexAlgo algo, bool mmapped = false>
@@ -168,9 +250,36 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
     template <typename U>
     using Vector = std::conditional_t<mmapped, GrowableVectorView<U>, std::vector<U>>;
 
+    // DAAT algorithms prune with the max score of each dimension, DAAT_BMW
+    // additionally prunes with the max score of each fixed-size posting block.
+    static constexpr bool use_max_score_in_dim = algo == InvertedIndexAlgo::DAAT_WAND ||
+                                                 algo == InvertedIndexAlgo::DAAT_MAXSCORE ||
+                                                 algo == InvertedIndexAlgo::DAAT_BMW;
+    static constexpr bool use_block_max_scores = algo == InvertedIndexAlgo::DAAT_BMW;
+    // number of postings covered by one block max score.
+    static constexpr uint32_t block_max_block_size = posting_block_size;
+    // number of docs whose scores are accumulated together by TAAT_NAIVE, 64K floats fit in a typical L2 cache.
+    static constexpr size_t taat_block_size = 1 << 16;
+    // max number of queries whose posting lists are traversed together by TAAT_NAIVE in SearchBatch().
+    static constexpr size_t taat_query_batch_size = 32;
+    // Add() builds the posting lists in parallel once each build thread gets at least this many rows.
+    static constexpr size_t parallel_build_min_chunk_rows = 1 << 13;
+    // rough cost of looking up a posting by doc id relative to visiting a posting in a posting list.
+    static constexpr size_t filtered_brute_force_cost_factor = 16;
+
+    void
+    SetBM25Params(float k1, float b, float avgdl, bool precompute_impacts = false) {
+        bm25_params_ = std::make_unique<BM25Params>(k1, b, avgdl, precompute_impacts);
+    }
+
+    void
+    SetPostingListEncoding(PostingListEncoding encoding) override {
+        posting_list_encoding_ = encoding;
+    }
+
     void
-    SetBM25Params(float k1, float b, float avgdl) {
-        bm25_params_ = std::make_unique<BM25Params>(k1, b, avgdl);
+    SetDocIdReordering(bool doc_id_reordering) override {
+        doc_id_reordering_ = doc_id_reordering;
     }
 
     expected<DocValueComputer<float>>
@@ -190,6 +299,16 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                 "metric type not match, expected: " + std::string(metric::BM25) + ", got: " + metric_type.value();
             return expected<DocValueComputer<float>>::Err(Status::invalid_metric_type, msg);
         }
+        if (bm25_params_->precompute_impacts) {
+            // the postings are scored with their impacts, which were computed with the load time k1, b and avgdl.
+            if ((cfg.bm25_k1.has_value() && cfg.bm25_k1.value() != bm25_params_->k1) ||
+                ((cfg.bm25_b.has_value() && cfg.bm25_b.value() != bm25_params_->b))) {
+                return expected<DocValueComputer<float>>::Err(
+                    Status::invalid_args,
+                    "search time k1/b must equal load time config when BM25 impacts are precomputed.");
+            }
+            return bm25_params_->max_score_computer;
+        }
         // avgdl must be supplied during search
         if (!cfg.bm25_avgdl.has_value()) {
             return expected<DocValueComputer<float>>::Err(Status::invalid_args,
@@ -197,13 +316,13 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         }
         auto avgdl = cfg.bm25_avgdl.value();
         avgdl = std::max(avgdl, 1.0f);
-        if constexpr (algo == InvertedIndexAlgo::DAAT_WAND || algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
-            // daat_wand and daat_maxscore: search time k1/b must equal load time config.
+        if constexpr (use_max_score_in_dim) {
+            // daat_wand, daat_maxscore and daat_bmw: search time k1/b must equal load time config.
             if ((cfg.bm25_k1.has_value() && cfg.bm25_k1.value() != bm25_params_->k1) ||
                 ((cfg.bm25_b.has_value() && cfg.bm25_b.value() != bm25_params_->b))) {
                 return expected<DocValueComputer<float>>::Err(
                     Status::invalid_args,
-                    "search time k1/b must equal load time config for DAAT_WAND or DAAT_MAXSCORE algorithm.");
+                    "search time k1/b must equal load time config for DAAT_WAND, DAAT_MAXSCORE or DAAT_BMW algorithm.");
             }
             return GetDocValueBM25Computer<float>(bm25_params_->k1, bm25_params_->b, avgdl);
         } else {
@@ -229,10 +348,13 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
          *        2. DType val (when QType is different from DType, the QType value of val is stored as a DType with
          *           precision loss)
          *
-         * inverted_index_ids_spans_, inverted_index_vals_spans_ and max_score_in_dim_spans_ are
+         * inverted_index_ids_views_, inverted_index_vals_spans_ and max_score_in_dim_spans_ are
          * not serialized, they will be constructed dynamically during
          * deserialization.
          *
+         * Rows are written in the order of their external ids, a reordered index is thus loaded with the original
+         * doc ids.
+         *
          * Data are densely packed in serialized bytes and no padding is added.
          */
         DType deprecated_value_threshold = 0;
@@ -241,37 +363,11 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         writeBinaryPOD(writer, deprecated_value_threshold);
         BitsetView bitset(nullptr, 0);
 
-        auto dim_map_reverse = std::unordered_map<uint32_t, table_t>();
-        for (const auto& [dim, dim_id] : dim_map_) {
-            dim_map_reverse[dim_id] = dim;
-        }
-
-        std::vector<size_t> row_sizes(n_rows_internal_, 0);
-        for (auto inverted_index_ids_span : inverted_index_ids_spans_) {
-            for (const auto& id : inverted_index_ids_span) {
-                row_sizes[id]++;
-            }
-        }
-
-        std::vector<SparseRow<DType>> raw_rows(n_rows_internal_);
-        for (size_t i = 0; i < n_rows_internal_; ++i) {
-            raw_rows[i] = std::move(SparseRow<DType>(row_sizes[i]));
-        }
-
-        for (size_t i = 0; i < inverted_index_ids_spans_.size(); ++i) {
-            const auto& ids = inverted_index_ids_spans_[i];
-            const auto& vals = inverted_index_vals_spans_[i];
-            const auto dim = dim_map_reverse[i];
-            for (size_t j = 0; j < ids.size(); ++j) {
-                raw_rows[ids[j]].set_at(raw_rows[ids[j]].size() - row_sizes[ids[j]], dim, vals[j]);
-                --row_sizes[ids[j]];
-            }
-        }
-
-        for (table_t vec_id = 0; vec_id < n_rows_internal_; ++vec_id) {
-            writeBinaryPOD(writer, raw_rows[vec_id].size());
-            if (raw_rows[vec_id].size() > 0) {
-                writer.write(raw_rows[vec_id].data(), raw_rows[vec_id].size() * SparseRow<DType>::element_size());
+        auto raw_rows = GetRows();
+        for (const auto& raw_row : raw_rows) {
+            writeBinaryPOD(writer, raw_row.size());
+            if (raw_row.size() > 0) {
+                writer.write(raw_row.data(), raw_row.size() * SparseRow<DType>::element_size());
             }
         }
 
@@ -342,10 +438,11 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         }
 #endif
         // mapping data to spans
-        inverted_index_ids_spans_.reserve(nr_inner_dims_);
+        inverted_index_ids_views_.reserve(nr_inner_dims_);
         inverted_index_vals_spans_.reserve(nr_inner_dims_);
         for (size_t i = 0; i < nr_inner_dims_; ++i) {
-            inverted_index_ids_spans_.emplace_back(inverted_index_ids_[i].data(), inverted_index_ids_[i].size());
+            inverted_index_ids_views_.emplace_back(
+                boost::span<const table_t>(inverted_index_ids_[i].data(), inverted_index_ids_[i].size()));
             inverted_index_vals_spans_.emplace_back(inverted_index_vals_[i].data(), inverted_index_vals_[i].size());
         }
 
@@ -353,10 +450,19 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             max_score_in_dim_spans_ = boost::span<const float>(max_score_in_dim_.data(), max_score_in_dim_.size());
         }
 
+        if constexpr (use_block_max_scores) {
+            block_max_scores_spans_.clear();
+            block_max_scores_spans_.reserve(nr_inner_dims_);
+            for (size_t i = 0; i < nr_inner_dims_; ++i) {
+                block_max_scores_spans_.emplace_back(block_max_scores_[i].data(), block_max_scores_[i].size());
+            }
+        }
+
         if (metric_type_ == SparseMetricType::METRIC_BM25) {
             bm25_params_->row_sums_spans_ =
                 boost::span<const float>(bm25_params_->row_sums.data(), bm25_params_->row_sums.size());
         }
+        precompute_bm25_impacts();
 
         return Status::success;
     }
@@ -379,8 +485,18 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         //      - size (uint64_t): Size of the section in bytes
         //
         // 3. Posting Lists Section:
-        //    - index_encoding_type (uint32_t): Type of encoding used, only 0 is supported for now
+        //    - index_encoding_type (uint32_t): Type of encoding of the doc ids, a PostingListEncoding
         //    - encoded_index_data: Flattened posting lists
+        //      - RAW (0):
+        //        - offsets[nr_inner_dims + 1] (uint64_t): Offsets of the postings of each dimension
+        //        - ids[offsets[nr_inner_dims]] (uint32_t): Doc ids
+        //        - vals[offsets[nr_inner_dims]] (QType): Values
+        //      - BLOCK_PACKED (1):
+        //        - offsets[nr_inner_dims + 1] (uint64_t): Offsets of the postings of each dimension
+        //        - word_offsets[nr_inner_dims + 1] (uint64_t): Offsets of the packed ids of each dimension
+        //        - headers[] (PostingBlockHeader): Skip entry of every posting_block_size postings of each dimension
+        //        - words[word_offsets[nr_inner_dims]] (uint32_t): Bit-packed doc id deltas
+        //        - vals[offsets[nr_inner_dims]] (QType): Values
         //
         // 4. Dimension Map Section:
         //    - dim_map_reverse[nr_inner_dims]: Array mapping internal dimension IDs to original dimensions
@@ -390,6 +506,14 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         //
         // 6. Optional Max Scores Per Dimension Section:
         //    - max_score_per_dim[nr_inner_dims]: Array of maximum scores per dimension (float)
+        //
+        // 7. Optional Block Max Scores Section (DAAT_BMW only):
+        //    - block_size (uint32_t): Number of postings covered by each block max score
+        //    - block_offsets[nr_inner_dims + 1] (uint64_t): Offsets of the block max scores of each dimension
+        //    - block_max_scores[block_offsets[nr_inner_dims]]: Array of maximum scores per posting block (float)
+        //
+        // 8. Optional Doc Id Map Section (doc ids reordered at build time):
+        //    - internal_to_external_ids[nr_rows] (uint32_t): External doc id of each doc id of the posting lists
 
         // write index header data
         const uint32_t index_format_version = 1;
@@ -412,6 +536,12 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         if (max_score_in_dim_spans_.size() > 0) {
             nr_sections += 1;  // max scores per dim
         }
+        if (block_max_scores_spans_.size() > 0) {
+            nr_sections += 1;  // block max scores
+        }
+        if (internal_to_external_ids_span_.size() > 0) {
+            nr_sections += 1;  // doc id map
+        }
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOHWERE_WITH_LIGHT)
         // use a section to store some build stats for prometheus
         nr_sections += 1;
@@ -426,9 +556,28 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         section_headers[0].offset = used_offset;
         uint64_t posting_lists_size = sizeof(uint32_t);                       // used to store encoding type
         posting_lists_size += sizeof(uint64_t) * (this->nr_inner_dims_ + 1);  // used to store dim offsets
+        std::vector<PostingBlockHeader> packed_headers;
+        std::vector<uint32_t> packed_words;
+        std::vector<uint64_t> packed_word_offsets;
+        if (posting_list_encoding_ == PostingListEncoding::BLOCK_PACKED) {
+            packed_word_offsets.resize(this->nr_inner_dims_ + 1, 0);
+            std::vector<table_t> ids;
+            for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+                const auto& plist_ids = this->inverted_index_ids_views_[i];
+                ids.resize(plist_ids.size());
+                plist_ids.for_each([&](size_t pos, table_t id) { ids[pos] = id; });
+                BlockPackedPostingCodec::encode(ids.data(), ids.size(), packed_headers, packed_words);
+                packed_word_offsets[i + 1] = packed_words.size();
+            }
+            posting_lists_size += sizeof(uint64_t) * packed_word_offsets.size() +
+                                  sizeof(PostingBlockHeader) * packed_headers.size() +
+                                  sizeof(uint32_t) * packed_words.size();
+        }
         for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
-            posting_lists_size += this->inverted_index_ids_spans_[i].size() * sizeof(uint32_t) +
-                                  this->inverted_index_vals_spans_[i].size() * sizeof(QType);
+            if (posting_list_encoding_ == PostingListEncoding::RAW) {
+                posting_lists_size += this->inverted_index_ids_views_[i].size() * sizeof(uint32_t);
+            }
+            posting_lists_size += this->inverted_index_vals_spans_[i].size() * sizeof(QType);
         }
         section_headers[0].size = posting_lists_size;
         used_offset += section_headers[0].size;
@@ -455,6 +604,29 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             curr_section_idx++;
         }
 
+        std::vector<uint64_t> block_max_offsets;
+        if (block_max_scores_spans_.size() > 0) {
+            block_max_offsets.resize(this->nr_inner_dims_ + 1, 0);
+            for (size_t i = 1; i <= this->nr_inner_dims_; ++i) {
+                block_max_offsets[i] = block_max_offsets[i - 1] + block_max_scores_spans_[i - 1].size();
+            }
+            section_headers[curr_section_idx].type = InvertedIndexSectionType::BLOCK_MAX_SCORES;
+            section_headers[curr_section_idx].offset = used_offset;
+            section_headers[curr_section_idx].size = sizeof(uint32_t) +
+                                                     sizeof(uint64_t) * block_max_offsets.size() +
+                                                     sizeof(float) * block_max_offsets.back();
+            used_offset += section_headers[curr_section_idx].size;
+            curr_section_idx++;
+        }
+
+        if (internal_to_external_ids_span_.size() > 0) {
+            section_headers[curr_section_idx].type = InvertedIndexSectionType::DOC_ID_MAP;
+            section_headers[curr_section_idx].offset = used_offset;
+            section_headers[curr_section_idx].size = sizeof(uint32_t) * n_rows_internal_;
+            used_offset += section_headers[curr_section_idx].size;
+            curr_section_idx++;
+        }
+
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOHWERE_WITH_LIGHT)
         section_headers[curr_section_idx].type = InvertedIndexSectionType::PROMETHEUS_BUILD_STATS;
         section_headers[curr_section_idx].offset = used_offset;
@@ -470,17 +642,26 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         writer.write(section_headers.data(), sizeof(InvertedIndexSectionHeader), nr_sections);
 
         // write index encoding type and index
-        uint32_t index_encoding_type = 0;  // not used for now
+        auto index_encoding_type = static_cast<uint32_t>(posting_list_encoding_);
         writer.write(&index_encoding_type, sizeof(uint32_t));
         std::vector<uint64_t> inverted_index_offsets(this->nr_inner_dims_ + 1);
         inverted_index_offsets[0] = 0;
         for (size_t i = 1; i <= this->nr_inner_dims_; ++i) {
-            inverted_index_offsets[i] = inverted_index_offsets[i - 1] + this->inverted_index_ids_spans_[i - 1].size();
+            inverted_index_offsets[i] = inverted_index_offsets[i - 1] + this->inverted_index_ids_views_[i - 1].size();
         }
         writer.write(inverted_index_offsets.data(), sizeof(uint64_t), inverted_index_offsets.size());
-        for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
-            writer.write(this->inverted_index_ids_spans_[i].data(), sizeof(uint32_t),
-                         this->inverted_index_ids_spans_[i].size());
+        if (posting_list_encoding_ == PostingListEncoding::BLOCK_PACKED) {
+            writer.write(packed_word_offsets.data(), sizeof(uint64_t), packed_word_offsets.size());
+            writer.write(packed_headers.data(), sizeof(PostingBlockHeader), packed_headers.size());
+            writer.write(packed_words.data(), sizeof(uint32_t), packed_words.size());
+        } else {
+            std::vector<table_t> ids;
+            for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+                const auto& plist_ids = this->inverted_index_ids_views_[i];
+                ids.resize(plist_ids.size());
+                plist_ids.for_each([&](size_t pos, table_t id) { ids[pos] = id; });
+                writer.write(ids.data(), sizeof(uint32_t), ids.size());
+            }
         }
         for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
             writer.write(this->inverted_index_vals_spans_[i].data(), sizeof(QType),
@@ -489,8 +670,8 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
 
         // write dim map
         auto dim_map_reverse = std::vector<uint32_t>(this->nr_inner_dims_);
-        for (const auto& [dim, dim_id] : this->dim_map_) {
-            dim_map_reverse[dim_id] = dim;
+        for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+            dim_map_reverse[i] = this->dim_map_.dim(i);
         }
         writer.write(dim_map_reverse.data(), sizeof(uint32_t), this->nr_inner_dims_);
 
@@ -503,6 +684,18 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             writer.write(max_score_in_dim_spans_.data(), sizeof(float), this->nr_inner_dims_);
         }
 
+        if (block_max_scores_spans_.size() > 0) {
+            writer.write(&block_max_block_size, sizeof(uint32_t));
+            writer.write(block_max_offsets.data(), sizeof(uint64_t), block_max_offsets.size());
+            for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+                writer.write(block_max_scores_spans_[i].data(), sizeof(float), block_max_scores_spans_[i].size());
+            }
+        }
+
+        if (internal_to_external_ids_span_.size() > 0) {
+            writer.write(internal_to_external_ids_span_.data(), sizeof(uint32_t), n_rows_internal_);
+        }
+
         // write prometheus build stats
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOHWERE_WITH_LIGHT)
         writer.write(this->build_stats_.dataset_nnz_stats_.data(), sizeof(uint32_t), this->n_rows_internal_);
@@ -545,22 +738,47 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                 switch (section_header.type) {
                     case InvertedIndexSectionType::POSTING_LISTS: {
                         reader.seekg(section_header.offset);
-                        // check index encoding type, 0 is the only supported type for now
                         uint32_t index_encoding_type = 0;
                         reader.read(&index_encoding_type, sizeof(uint32_t));
-                        if (index_encoding_type != 0) {
+                        if (index_encoding_type != static_cast<uint32_t>(PostingListEncoding::RAW) &&
+                            index_encoding_type != static_cast<uint32_t>(PostingListEncoding::BLOCK_PACKED)) {
                             return Status::invalid_serialized_index_type;
                         }
+                        posting_list_encoding_ = static_cast<PostingListEncoding>(index_encoding_type);
                         auto inverted_index_offsets_span = boost::span<const uint64_t>(
                             reinterpret_cast<uint64_t*>(reader.data() + reader.tellg()), this->nr_inner_dims_ + 1);
                         reader.advance(sizeof(uint64_t) * (this->nr_inner_dims_ + 1));
-                        inverted_index_ids_spans_.resize(this->nr_inner_dims_);
+                        inverted_index_ids_views_.resize(this->nr_inner_dims_);
                         inverted_index_vals_spans_.resize(this->nr_inner_dims_);
-                        for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
-                            inverted_index_ids_spans_[i] = boost::span<const uint32_t>(
-                                reinterpret_cast<uint32_t*>(reader.data() + reader.tellg()),
-                                inverted_index_offsets_span[i + 1] - inverted_index_offsets_span[i]);
-                            reader.advance(inverted_index_ids_spans_[i].size() * sizeof(uint32_t));
+                        if (posting_list_encoding_ == PostingListEncoding::BLOCK_PACKED) {
+                            auto word_offsets_span = boost::span<const uint64_t>(
+                                reinterpret_cast<uint64_t*>(reader.data() + reader.tellg()), this->nr_inner_dims_ + 1);
+                            reader.advance(sizeof(uint64_t) * (this->nr_inner_dims_ + 1));
+                            size_t nr_blocks = 0;
+                            for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+                                auto plist_size = inverted_index_offsets_span[i + 1] - inverted_index_offsets_span[i];
+                                nr_blocks += (plist_size + posting_block_size - 1) / posting_block_size;
+                            }
+                            auto headers = reinterpret_cast<PostingBlockHeader*>(reader.data() + reader.tellg());
+                            reader.advance(sizeof(PostingBlockHeader) * nr_blocks);
+                            auto words = reinterpret_cast<uint32_t*>(reader.data() + reader.tellg());
+                            reader.advance(sizeof(uint32_t) * word_offsets_span[this->nr_inner_dims_]);
+                            for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+                                auto plist_size = inverted_index_offsets_span[i + 1] - inverted_index_offsets_span[i];
+                                auto plist_blocks = (plist_size + posting_block_size - 1) / posting_block_size;
+                                inverted_index_ids_views_[i] =
+                                    PostingListIdsView(boost::span<const PostingBlockHeader>(headers, plist_blocks),
+                                                       words + word_offsets_span[i], plist_size);
+                                headers += plist_blocks;
+                            }
+                        } else {
+                            for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+                                auto plist_ids = boost::span<const uint32_t>(
+                                    reinterpret_cast<uint32_t*>(reader.data() + reader.tellg()),
+                                    inverted_index_offsets_span[i + 1] - inverted_index_offsets_span[i]);
+                                inverted_index_ids_views_[i] = PostingListIdsView(plist_ids);
+                                reader.advance(plist_ids.size() * sizeof(uint32_t));
+                            }
                         }
                         for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
                             inverted_index_vals_spans_[i] = boost::span<const QType>(
@@ -575,7 +793,7 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                         for (uint32_t i = 0; i < this->nr_inner_dims_; ++i) {
                             uint32_t dim = 0;
                             reader.read(&dim, sizeof(uint32_t));
-                            this->dim_map_[dim] = i;
+                            this->dim_map_.insert(dim);
                         }
                         break;
                     }
@@ -593,6 +811,43 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                         reader.advance(sizeof(float) * this->nr_inner_dims_);
                         break;
                     }
+                    case InvertedIndexSectionType::BLOCK_MAX_SCORES: {
+                        if constexpr (!use_block_max_scores) {
+                            break;
+                        }
+                        reader.seekg(section_header.offset);
+                        uint32_t block_size = 0;
+                        reader.read(&block_size, sizeof(uint32_t));
+                        if (block_size != block_max_block_size) {
+                            // block max scores will be re-computed with the current block size.
+                            break;
+                        }
+                        auto block_max_offsets_span = boost::span<const uint64_t>(
+                            reinterpret_cast<uint64_t*>(reader.data() + reader.tellg()), this->nr_inner_dims_ + 1);
+                        reader.advance(sizeof(uint64_t) * (this->nr_inner_dims_ + 1));
+                        block_max_scores_spans_.resize(this->nr_inner_dims_);
+                        for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
+                            block_max_scores_spans_[i] = boost::span<const float>(
+                                reinterpret_cast<float*>(reader.data() + reader.tellg()),
+                                block_max_offsets_span[i + 1] - block_max_offsets_span[i]);
+                            reader.advance(block_max_scores_spans_[i].size() * sizeof(float));
+                        }
+                        break;
+                    }
+                    case InvertedIndexSectionType::DOC_ID_MAP: {
+                        reader.seekg(section_header.offset);
+                        internal_to_external_ids_span_ = boost::span<const table_t>(
+                            reinterpret_cast<table_t*>(reader.data() + section_header.offset), this->n_rows_internal_);
+                        reader.advance(sizeof(table_t) * this->n_rows_internal_);
+                        external_to_internal_ids_.resize(this->n_rows_internal_);
+                        // a permutation, the rows are inverted in parallel
+                        ParallelForOverBuildThreadPool(this->n_rows_internal_, 1, [&](size_t begin, size_t end) {
+                            for (size_t i = begin; i < end; ++i) {
+                                external_to_internal_ids_[internal_to_external_ids_span_[i]] = i;
+                            }
+                        });
+                        break;
+                    }
                     case InvertedIndexSectionType::PROMETHEUS_BUILD_STATS: {
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
                         reader.seekg(section_header.offset);
@@ -606,6 +861,9 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                         for (size_t i = 0; i < this->nr_inner_dims_; ++i) {
                             this->index_posting_list_len_histogram_->Observe(posting_list_length_stats[i]);
                         }
+                        // kept so that a loaded index can be serialized again.
+                        this->build_stats_.dataset_nnz_stats_ = std::move(dataset_nnz_stats);
+                        this->build_stats_.posting_list_length_stats_ = std::move(posting_list_length_stats);
 #endif
                         break;
                     }
@@ -626,6 +884,13 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             return status;
         }
 
+        if constexpr (use_block_max_scores) {
+            if (block_max_scores_spans_.size() != this->nr_inner_dims_) {
+                compute_block_max_scores();
+            }
+        }
+        precompute_bm25_impacts();
+
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
         this->index_size_gauge_->Set((double)size() / 1024.0 / 1024.0);
 #endif
@@ -666,12 +931,23 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         auto plists_vals_byte_size = nnz * sizeof(typename decltype(inverted_index_vals_)::value_type::value_type);
         auto max_score_in_dim_byte_size = idx_counts.size() * sizeof(typename decltype(max_score_in_dim_)::value_type);
         size_t row_sums_byte_size = 0;
+        size_t block_max_scores_byte_size = 0;
+        size_t plists_block_max_scores_byte_size = 0;
 
         map_byte_size_ =
             inverted_index_ids_byte_size + inverted_index_vals_byte_size + plists_ids_byte_size + plists_vals_byte_size;
-        if constexpr (algo == InvertedIndexAlgo::DAAT_WAND || algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+        if constexpr (use_max_score_in_dim) {
             map_byte_size_ += max_score_in_dim_byte_size;
         }
+        if constexpr (use_block_max_scores) {
+            block_max_scores_byte_size = idx_counts.size() * sizeof(typename decltype(block_max_scores_)::value_type);
+            for (const auto& [idx, count] : idx_counts) {
+                plists_block_max_scores_byte_size +=
+                    (count + block_max_block_size - 1) / block_max_block_size *
+                    sizeof(typename decltype(block_max_scores_)::value_type::value_type);
+            }
+            map_byte_size_ += block_max_scores_byte_size + plists_block_max_scores_byte_size;
+        }
         if (metric_type_ == SparseMetricType::METRIC_BM25) {
             row_sums_byte_size = rows * sizeof(typename decltype(bm25_params_->row_sums)::value_type);
             map_byte_size_ += row_sums_byte_size;
@@ -714,6 +990,8 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         if (madvise(map_, map_byte_size_, MADV_RANDOM) != 0) {
             LOG_KNOWHERE_WARNING_ << "Failed to madvise mmap when loading sparse InvertedIndex: " << strerror(errno);
         }
+        // the posting lists get transparent huge pages if the file system of the mapped file supports them (tmpfs)
+        AdviseHugePages(map_, map_byte_size_);
 
         char* ptr = map_;
 
@@ -723,11 +1001,16 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         inverted_index_vals_.initialize(ptr, inverted_index_vals_byte_size);
         ptr += inverted_index_vals_byte_size;
 
-        if constexpr (algo == InvertedIndexAlgo::DAAT_WAND || algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+        if constexpr (use_max_score_in_dim) {
             max_score_in_dim_.initialize(ptr, max_score_in_dim_byte_size);
             ptr += max_score_in_dim_byte_size;
         }
 
+        if constexpr (use_block_max_scores) {
+            block_max_scores_.initialize(ptr, block_max_scores_byte_size);
+            ptr += block_max_scores_byte_size;
+        }
+
         if (metric_type_ == SparseMetricType::METRIC_BM25) {
             bm25_params_->row_sums.initialize(ptr, row_sums_byte_size);
             ptr += row_sums_byte_size;
@@ -745,16 +1028,22 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             plist_vals.initialize(ptr, plist_vals_byte_size);
             ptr += plist_vals_byte_size;
         }
-        size_t dim_id = 0;
+        if constexpr (use_block_max_scores) {
+            for (const auto& [idx, count] : idx_counts) {
+                auto& plist_block_max = block_max_scores_.emplace_back();
+                auto plist_block_max_byte_size =
+                    (count + block_max_block_size - 1) / block_max_block_size *
+                    sizeof(typename decltype(block_max_scores_)::value_type::value_type);
+                plist_block_max.initialize(ptr, plist_block_max_byte_size);
+                ptr += plist_block_max_byte_size;
+            }
+        }
         for (const auto& [idx, count] : idx_counts) {
-            dim_map_[idx] = dim_id;
-            if constexpr (algo == InvertedIndexAlgo::DAAT_WAND || algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+            dim_map_.insert(idx);
+            if constexpr (use_max_score_in_dim) {
                 max_score_in_dim_.emplace_back(0.0f);
             }
-            ++dim_id;
         }
-        // in mmap mode, next_dim_id_ should never be used, but still assigning for consistency.
-        next_dim_id_ = dim_id;
 
         return Status::success;
     }
@@ -783,8 +1072,21 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             if (metric_type_ == SparseMetricType::METRIC_BM25) {
                 bm25_params_->row_sums.reserve(current_rows + rows);
             }
-            for (size_t i = 0; i < rows; ++i) {
-                add_row_to_index(data[i], current_rows + i);
+            if (doc_id_reordering_) {
+                // the rows of this batch get consecutive internal ids in the order given by the reorderer, the
+                // external id of a row is still its position in the input.
+                auto order = GraphBisectionReorderer<DType>::reorder(data, rows);
+                internal_to_external_ids_.resize(current_rows + rows);
+                external_to_internal_ids_.resize(current_rows + rows);
+                for (size_t i = 0; i < rows; ++i) {
+                    internal_to_external_ids_[current_rows + i] = current_rows + order[i];
+                    external_to_internal_ids_[current_rows + order[i]] = current_rows + i;
+                }
+                internal_to_external_ids_span_ =
+                    boost::span<const table_t>(internal_to_external_ids_.data(), internal_to_external_ids_.size());
+                add_rows_to_index(data, order.data(), rows, current_rows);
+            } else {
+                add_rows_to_index(data, nullptr, rows, current_rows);
             }
             n_rows_internal_ += rows;
 
@@ -797,14 +1099,15 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             }
 #endif
 
-            inverted_index_ids_spans_.clear();
+            inverted_index_ids_views_.clear();
             inverted_index_vals_spans_.clear();
-            inverted_index_ids_spans_.reserve(nr_inner_dims_);
+            inverted_index_ids_views_.reserve(nr_inner_dims_);
             inverted_index_vals_spans_.reserve(nr_inner_dims_);
 
             // mapping data to spans
             for (size_t i = 0; i < nr_inner_dims_; ++i) {
-                inverted_index_ids_spans_.emplace_back(inverted_index_ids_[i].data(), inverted_index_ids_[i].size());
+                inverted_index_ids_views_.emplace_back(
+                    boost::span<const table_t>(inverted_index_ids_[i].data(), inverted_index_ids_[i].size()));
                 inverted_index_vals_spans_.emplace_back(inverted_index_vals_[i].data(), inverted_index_vals_[i].size());
             }
 
@@ -812,10 +1115,19 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                 max_score_in_dim_spans_ = boost::span<const float>(max_score_in_dim_.data(), max_score_in_dim_.size());
             }
 
+            if constexpr (use_block_max_scores) {
+                block_max_scores_spans_.clear();
+                block_max_scores_spans_.reserve(nr_inner_dims_);
+                for (size_t i = 0; i < nr_inner_dims_; ++i) {
+                    block_max_scores_spans_.emplace_back(block_max_scores_[i].data(), block_max_scores_[i].size());
+                }
+            }
+
             if (metric_type_ == SparseMetricType::METRIC_BM25) {
                 bm25_params_->row_sums_spans_ =
                     boost::span<const float>(bm25_params_->row_sums.data(), bm25_params_->row_sums.size());
             }
+            precompute_bm25_impacts();
 
             return Status::success;
         }
@@ -824,32 +1136,111 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
     void
     Search(const SparseRow<DType>& query, size_t k, float* distances, label_t* labels, const BitsetView& bitset,
            const DocValueComputer<float>& computer, InvertedIndexApproxSearchParams& approx_params) const override {
-        // initially set result distances to NaN and labels to -1
-        std::fill(distances, distances + k, std::numeric_limits<float>::quiet_NaN());
-        std::fill(labels, labels + k, -1);
+        std::vector<uint8_t> internal_bits;
+        search_internal(query, k, distances, labels, to_internal_bitset(bitset, internal_bits), computer,
+                        approx_params);
+    }
+
+    void
+    SearchBatch(const SparseRow<DType>* queries, size_t nq, size_t k, float* distances, label_t* labels,
+                const BitsetView& bitset, const DocValueComputer<float>& computer,
+                InvertedIndexApproxSearchParams& approx_params) const override {
+        // the bitset is mapped to the internal doc ids once for all the queries
+        std::vector<uint8_t> internal_bits;
+        const auto internal_bitset = to_internal_bitset(bitset, internal_bits);
+        if constexpr (algo != InvertedIndexAlgo::TAAT_NAIVE) {
+            auto query_params = approx_params;
+            for (size_t i = 0; i < nq; ++i) {
+                query_params.stats = approx_params.stats == nullptr ? nullptr : approx_params.stats + i;
+                search_internal(queries[i], k, distances + i * k, labels + i * k, internal_bitset, computer,
+                                query_params);
+            }
+        } else {
+            std::fill(distances, distances + nq * k, std::numeric_limits<float>::quiet_NaN());
+            std::fill(labels, labels + nq * k, -1);
+
+            std::vector<size_t> batch;
+            std::vector<std::vector<std::pair<size_t, DType>>> q_vecs;
+            for (size_t i = 0; i < nq; ++i) {
+                if (queries[i].size() == 0) {
+                    continue;
+                }
+                auto q_vec = parse_query(queries[i], approx_params.drop_ratio_search);
+                if (q_vec.empty()) {
+                    continue;
+                }
+                if (use_filtered_brute_force(q_vec, internal_bitset)) {
+                    auto query_params = approx_params;
+                    query_params.stats = approx_params.stats == nullptr ? nullptr : approx_params.stats + i;
+                    search_internal(queries[i], k, distances + i * k, labels + i * k, internal_bitset, computer,
+                                    query_params);
+                    continue;
+                }
+                if (approx_params.stats != nullptr) {
+                    count_search_stats(q_vec, internal_bitset, false, approx_params.stats[i]);
+                }
+                batch.push_back(i);
+                q_vecs.emplace_back(std::move(q_vec));
+            }
+
+            std::vector<MaxMinHeap<float>> heaps;
+            heaps.reserve(batch.size());
+            for (size_t i = 0; i < batch.size(); ++i) {
+                heaps.emplace_back(k * approx_params.refine_factor);
+            }
+            for (size_t begin = 0; begin < batch.size(); begin += taat_query_batch_size) {
+                const size_t end = std::min(begin + taat_query_batch_size, batch.size());
+                search_taat_batch(q_vecs, begin, end, heaps, internal_bitset, computer);
+            }
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                const size_t q = batch[i];
+                if (approx_params.refine_factor == 1) {
+                    collect_result(heaps[i], distances + q * k, labels + q * k);
+                } else {
+                    if (approx_params.stats != nullptr) {
+                        approx_params.stats[q].refine_candidates += heaps[i].size();
+                    }
+                    refine_and_collect(queries[q], heaps[i], k, distances + q * k, labels + q * k, computer,
+                                       approx_params);
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] size_t
+    max_search_batch_size() const override {
+        return algo == InvertedIndexAlgo::TAAT_NAIVE ? taat_query_batch_size : 1;
+    }
+
+    // The docs are searched by the algorithm of the index with the radius as the threshold that a doc has to beat,
+    // instead of the score of the k-th best doc so far, so that WAND and MaxScore skip the docs that can not reach it.
+    void
+    RangeSearch(const SparseRow<DType>& query, float radius, float range_filter, const BitsetView& bitset,
+                const DocValueComputer<float>& computer, InvertedIndexApproxSearchParams& approx_params,
+                RangeSearchResultArena::Writer& writer) const override {
         if (query.size() == 0) {
             return;
         }
-
         auto q_vec = parse_query(query, approx_params.drop_ratio_search);
         if (q_vec.empty()) {
             return;
         }
 
-        MaxMinHeap<float> heap(k * approx_params.refine_factor);
-        // DAAT_WAND and DAAT_MAXSCORE are based on the implementation in PISA.
-        if constexpr (algo == InvertedIndexAlgo::DAAT_WAND) {
-            search_daat_wand(q_vec, heap, bitset, computer, approx_params.dim_max_score_ratio);
-        } else if constexpr (algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
-            search_daat_maxscore(q_vec, heap, bitset, computer, approx_params.dim_max_score_ratio);
-        } else {
-            search_taat_naive(q_vec, heap, bitset, computer);
-        }
+        std::vector<uint8_t> internal_bits;
+        const auto internal_bitset = to_internal_bitset(bitset, internal_bits);
 
-        if (approx_params.refine_factor == 1) {
-            collect_result(heap, distances, labels);
+        RangeCollector collector(*this, radius, range_filter, writer);
+        if (use_filtered_brute_force(q_vec, internal_bitset)) {
+            search_filtered_brute_force(q_vec, collector, internal_bitset, computer);
+        } else if constexpr (algo == InvertedIndexAlgo::DAAT_WAND) {
+            search_daat_wand(q_vec, collector, internal_bitset, computer, approx_params.dim_max_score_ratio);
+        } else if constexpr (algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+            search_daat_maxscore(q_vec, collector, internal_bitset, computer, approx_params.dim_max_score_ratio);
+        } else if constexpr (algo == InvertedIndexAlgo::DAAT_BMW) {
+            search_daat_bmw(q_vec, collector, internal_bitset, computer, approx_params.dim_max_score_ratio);
         } else {
-            refine_and_collect(query, heap, k, distances, labels, computer, approx_params);
+            search_taat_naive(q_vec, collector, internal_bitset, computer);
         }
     }
 
@@ -867,6 +1258,13 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         auto q_vec = parse_query(query, drop_ratio_search);
 
         auto distances = compute_all_distances(q_vec, computer);
+        if (internal_to_external_ids_span_.size() > 0) {
+            std::vector<float> external_distances(distances.size());
+            for (size_t i = 0; i < distances.size(); ++i) {
+                external_distances[internal_to_external_ids_span_[i]] = distances[i];
+            }
+            distances = std::move(external_distances);
+        }
         if (!bitset.empty()) {
             for (size_t i = 0; i < distances.size(); ++i) {
                 if (bitset.test(i)) {
@@ -881,40 +1279,66 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
     GetRawDistance(const label_t vec_id, const SparseRow<DType>& query,
                    const DocValueComputer<float>& computer) const override {
         float distance = 0.0f;
+        const auto doc_id = internal_id(vec_id);
 
         for (size_t i = 0; i < query.size(); ++i) {
             auto [dim, val] = query[i];
-            auto dim_it = dim_map_.find(dim);
-            if (dim_it == dim_map_.cend()) {
+            auto dim_id = dim_map_.find(dim);
+            if (dim_id == DimMap::npos) {
                 continue;
             }
-            auto& plist_ids = inverted_index_ids_spans_[dim_it->second];
-            auto it = std::lower_bound(plist_ids.begin(), plist_ids.end(), vec_id,
-                                       [](const auto& x, table_t y) { return x < y; });
-            if (it != plist_ids.end() && *it == vec_id) {
-                distance +=
-                    val *
-                    computer(inverted_index_vals_spans_[dim_it->second][it - plist_ids.begin()],
-                             metric_type_ == SparseMetricType::METRIC_BM25 ? bm25_params_->row_sums_spans_[vec_id] : 0);
+            auto& plist_ids = inverted_index_ids_views_[dim_id];
+            auto pos = plist_ids.find(doc_id);
+            if (pos != plist_ids.size()) {
+                distance += val * posting_score(dim_id, pos, doc_id, computer);
             }
         }
 
         return distance;
     }
 
+    std::vector<SparseRow<DType>>
+    GetRows() const override {
+        std::vector<size_t> row_sizes(n_rows_internal_, 0);
+        for (const auto& inverted_index_ids_view : inverted_index_ids_views_) {
+            inverted_index_ids_view.for_each([&](size_t, table_t id) { row_sizes[external_id(id)]++; });
+        }
+
+        std::vector<SparseRow<DType>> raw_rows(n_rows_internal_);
+        for (size_t i = 0; i < n_rows_internal_; ++i) {
+            raw_rows[i] = std::move(SparseRow<DType>(row_sizes[i]));
+        }
+
+        for (size_t i = 0; i < inverted_index_ids_views_.size(); ++i) {
+            const auto& vals = inverted_index_vals_spans_[i];
+            const auto dim = dim_map_.dim(i);
+            inverted_index_ids_views_[i].for_each([&](size_t j, table_t id) {
+                const auto row = external_id(id);
+                raw_rows[row].set_at(raw_rows[row].size() - row_sizes[row], dim, vals[j]);
+                --row_sizes[row];
+            });
+        }
+
+        return raw_rows;
+    }
+
     [[nodiscard]] size_t
     size() const override {
         size_t res = sizeof(*this);
-        res += dim_map_.size() *
-               (sizeof(typename decltype(dim_map_)::key_type) + sizeof(typename decltype(dim_map_)::mapped_type));
+        res += dim_map_.byte_size();
+        if (bm25_params_ != nullptr) {
+            // the impacts are kept in memory even if the index is mmapped.
+            for (const auto& impacts : bm25_params_->impacts) {
+                res += sizeof(impacts) + impacts.size();
+            }
+        }
 
         if constexpr (mmapped) {
             return res + map_byte_size_;
         } else {
-            res += sizeof(typename decltype(inverted_index_ids_spans_)::value_type) * inverted_index_ids_spans_.size();
-            for (auto inverted_index_ids_span : inverted_index_ids_spans_) {
-                res += sizeof(typename decltype(inverted_index_ids_spans_)::value_type::value_type) *
-                       inverted_index_ids_span.size();
+            res += sizeof(typename decltype(inverted_index_ids_views_)::value_type) * inverted_index_ids_views_.size();
+            for (const auto& inverted_index_ids_view : inverted_index_ids_views_) {
+                res += inverted_index_ids_view.byte_size();
             }
             res +=
                 sizeof(typename decltype(inverted_index_vals_spans_)::value_type) * inverted_index_vals_spans_.size();
@@ -922,9 +1346,17 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                 res += sizeof(typename decltype(inverted_index_vals_spans_)::value_type::value_type) *
                        inverted_index_vals_span.size();
             }
-            if constexpr (algo == InvertedIndexAlgo::DAAT_WAND || algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+            if constexpr (use_max_score_in_dim) {
                 res += sizeof(typename decltype(max_score_in_dim_spans_)::value_type) * max_score_in_dim_spans_.size();
             }
+            if constexpr (use_block_max_scores) {
+                res += sizeof(typename decltype(block_max_scores_spans_)::value_type) * block_max_scores_spans_.size();
+                for (auto block_max_scores_span : block_max_scores_spans_) {
+                    res += sizeof(typename decltype(block_max_scores_spans_)::value_type::value_type) *
+                           block_max_scores_span.size();
+                }
+            }
+            res += sizeof(table_t) * (internal_to_external_ids_span_.size() + external_to_internal_ids_.size());
             return res;
         }
     }
@@ -939,107 +1371,514 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         return max_dim_;
     }
 
- private:
-    // Given a vector of values, returns the threshold value.
-    // All values strictly smaller than the threshold will be ignored.
-    // values will be modified in this function.
-    inline DType
-    get_threshold(std::vector<DType>& values, float drop_ratio) const {
-        // drop_ratio is in [0, 1) thus drop_count is guaranteed to be less
-        // than values.size().
-        auto drop_count = static_cast<size_t>(drop_ratio * values.size());
-        if (drop_count == 0) {
-            return 0;
+    void
+    report_memory(MemoryReport& report) const override {
+        report.AddHeap(MemoryComponent::ID_MAP, dim_map_.byte_size());
+        report.AddHeap(MemoryComponent::ID_MAP, sizeof(table_t) * (internal_to_external_ids_.capacity() +
+                                                                     external_to_internal_ids_.capacity()));
+        // the views of the posting lists, in the index or in the file
+        using IdsView = typename decltype(inverted_index_ids_views_)::value_type;
+        using ValsSpan = typename decltype(inverted_index_vals_spans_)::value_type;
+        using ScoresSpan = typename decltype(block_max_scores_spans_)::value_type;
+        report.AddHeap(MemoryComponent::OTHER, sizeof(IdsView) * inverted_index_ids_views_.capacity() +
+                                                   sizeof(ValsSpan) * inverted_index_vals_spans_.capacity() +
+                                                   sizeof(ScoresSpan) * block_max_scores_spans_.capacity());
+        if constexpr (mmapped) {
+            // the posting lists, the max scores and the row sums of a version 0 index are in its supplement file
+            if (map_ != nullptr) {
+                report.AddMapped(MemoryComponent::CODES, map_, map_byte_size_);
+            }
+        } else {
+            size_t codes = 0;
+            for (const auto& inverted_index_ids_view : inverted_index_ids_views_) {
+                codes += inverted_index_ids_view.byte_size();
+            }
+            for (auto inverted_index_vals_span : inverted_index_vals_spans_) {
+                codes += sizeof(QType) * inverted_index_vals_span.size();
+            }
+            report.AddHeap(MemoryComponent::CODES, codes);
+            // the upper bounds of the scores that the searches prune the posting lists with
+            size_t bounds = 0;
+            if constexpr (use_max_score_in_dim) {
+                bounds += sizeof(float) * max_score_in_dim_spans_.size();
+            }
+            if constexpr (use_block_max_scores) {
+                for (auto block_max_scores_span : block_max_scores_spans_) {
+                    bounds += sizeof(float) * block_max_scores_span.size();
+                }
+            }
+            report.AddHeap(MemoryComponent::OTHER, bounds);
         }
-        auto pos = values.begin() + drop_count;
-        std::nth_element(values.begin(), pos, values.end());
-        return *pos;
     }
 
-    std::vector<float>
-    compute_all_distances(const std::vector<std::pair<size_t, DType>>& q_vec,
-                          const DocValueComputer<float>& computer) const {
-        std::vector<float> scores(n_rows_internal_, 0.0f);
-        for (size_t i = 0; i < q_vec.size(); ++i) {
-            auto& plist_ids = inverted_index_ids_spans_[q_vec[i].first];
-            auto& plist_vals = inverted_index_vals_spans_[q_vec[i].first];
-            // TODO: improve with SIMD
-            for (size_t j = 0; j < plist_ids.size(); ++j) {
-                auto doc_id = plist_ids[j];
-                float val_sum =
-                    metric_type_ == SparseMetricType::METRIC_BM25 ? bm25_params_->row_sums_spans_[doc_id] : 0;
-                scores[doc_id] += q_vec[i].second * computer(plist_vals[j], val_sum);
+    [[nodiscard]] std::vector<MemoryRange>
+    hot_ranges(size_t budget) const override {
+        std::vector<size_t> dims(inverted_index_ids_views_.size());
+        std::iota(dims.begin(), dims.end(), 0);
+        std::sort(dims.begin(), dims.end(), [&](size_t a, size_t b) {
+            return inverted_index_ids_views_[a].size() > inverted_index_ids_views_[b].size();
+        });
+        std::vector<MemoryRange> ranges;
+        size_t bytes = 0;
+        for (auto dim : dims) {
+            const auto& plist_ids = inverted_index_ids_views_[dim];
+            const auto plist_bytes = plist_ids.byte_size() + sizeof(QType) * inverted_index_vals_spans_[dim].size();
+            if (plist_ids.size() == 0 || bytes + plist_bytes > budget) {
+                break;
             }
+            plist_ids.for_each_buffer([&](const void* data, size_t size) { ranges.push_back({data, size}); });
+            ranges.push_back({inverted_index_vals_spans_[dim].data(), plist_bytes - plist_ids.byte_size()});
+            bytes += plist_bytes;
         }
-        return scores;
+        return ranges;
     }
 
-    template <typename DocIdFilter>
-    struct Cursor {
-     public:
-        Cursor(const boost::span<const table_t>& plist_ids, const boost::span<const QType>& plist_vals, size_t num_vec,
-               float max_score, float q_value, DocIdFilter filter)
-            : plist_ids_(plist_ids),
-              plist_vals_(plist_vals),
-              plist_size_(plist_ids.size()),
-              total_num_vec_(num_vec),
-              max_score_(max_score),
-              q_value_(q_value),
-              filter_(filter) {
-            skip_filtered_ids();
-            update_cur_vec_id();
+    [[nodiscard]] std::vector<MemoryRange>
+    mapped_ranges() const override {
+        if constexpr (mmapped) {
+            if (map_ != nullptr) {
+                return {{map_, map_byte_size_}};
+            }
         }
-        Cursor(const Cursor& rhs) = delete;
-        Cursor(Cursor&& rhs) noexcept = default;
+        return {};
+    }
 
-        void
-        next() {
-            ++loc_;
-            skip_filtered_ids();
-            update_cur_vec_id();
+ private:
+    // The score accumulator of the TAAT_NAIVE searches of a thread, kept across its queries and all zeros between them:
+    // a search resets the scores it sets as it collects them, instead of the accumulator being zeroed for every query.
+    // It is only zeroed as a whole if a search throws before collecting them.
+    class TaatScores {
+     public:
+        explicit TaatScores(size_t n) : scores_(buffer()), uncaught_(std::uncaught_exceptions()) {
+            if (scores_.size() < n) {
+                scores_.resize(n, 0.0f);
+            }
         }
 
-        void
-        seek(table_t vec_id) {
-            while (loc_ < plist_size_ && plist_ids_[loc_] < vec_id) {
-                ++loc_;
+        ~TaatScores() {
+            if (std::uncaught_exceptions() > uncaught_) {
+                std::fill(scores_.begin(), scores_.end(), 0.0f);
             }
-            skip_filtered_ids();
-            update_cur_vec_id();
         }
 
-        QType
-        cur_vec_val() const {
-            return plist_vals_[loc_];
-        }
+        TaatScores(const TaatScores&) = delete;
+        TaatScores&
+        operator=(const TaatScores&) = delete;
 
-        const boost::span<const table_t>& plist_ids_;
-        const boost::span<const QType>& plist_vals_;
-        const size_t plist_size_;
-        size_t loc_ = 0;
-        size_t total_num_vec_ = 0;
-        float max_score_ = 0.0f;
-        float q_value_ = 0.0f;
-        DocIdFilter filter_;
-        table_t cur_vec_id_ = 0;
+        float*
+        data() {
+            return scores_.data();
+        }
 
      private:
-        inline void
-        update_cur_vec_id() {
-            cur_vec_id_ = (loc_ >= plist_size_) ? total_num_vec_ : plist_ids_[loc_];
+        static std::vector<float>&
+        buffer() {
+            thread_local std::vector<float> scores;
+            return scores;
         }
 
-        inline void
-        skip_filtered_ids() {
-            while (loc_ < plist_size_ && !filter_.empty() && filter_.test(plist_ids_[loc_])) {
-                ++loc_;
-            }
-        }
-    };  // struct Cursor
+        std::vector<float>& scores_;
+        const int uncaught_;
+    };
 
-    std::vector<std::pair<size_t, DType>>
-    parse_query(const SparseRow<DType>& query, float drop_ratio_search) const {
-        DType q_threshold = 0;
+    [[nodiscard]] table_t
+    internal_id(table_t external_id) const {
+        return external_to_internal_ids_.empty() ? external_id : external_to_internal_ids_[external_id];
+    }
+
+    [[nodiscard]] table_t
+    external_id(table_t internal_id) const {
+        return internal_to_external_ids_span_.empty() ? internal_id : internal_to_external_ids_span_[internal_id];
+    }
+
+    // Returns a view of bitset that tests internal doc ids. If the doc ids are reordered, bitset is mapped once into
+    // internal_bits, a plain bitmap of the internal doc ids: the scans skip the filtered out ones a word at a time, and
+    // the count is that of the filtered out internal doc ids whatever the size of bitset.
+    BitsetView
+    to_internal_bitset(const BitsetView& bitset, std::vector<uint8_t>& internal_bits) const {
+        if (internal_to_external_ids_span_.empty() || bitset.empty()) {
+            return bitset;
+        }
+        internal_bits.assign((n_rows_internal_ + 7) >> 3, 0);
+        size_t num_filtered_out = 0;
+        for (size_t i = 0; i < n_rows_internal_; ++i) {
+            if (bitset.test(internal_to_external_ids_span_[i])) {
+                internal_bits[i >> 3] |= uint8_t(1) << (i & 0x7);
+                ++num_filtered_out;
+            }
+        }
+        return BitsetView(internal_bits.data(), n_rows_internal_, num_filtered_out);
+    }
+
+    // Search() with the bitset of the internal doc ids, see to_internal_bitset().
+    void
+    search_internal(const SparseRow<DType>& query, size_t k, float* distances, label_t* labels,
+                    const BitsetView& internal_bitset, const DocValueComputer<float>& computer,
+                    InvertedIndexApproxSearchParams& approx_params) const {
+        // initially set result distances to NaN and labels to -1
+        std::fill(distances, distances + k, std::numeric_limits<float>::quiet_NaN());
+        std::fill(labels, labels + k, -1);
+        if (query.size() == 0) {
+            return;
+        }
+
+        auto q_vec = parse_query(query, approx_params.drop_ratio_search);
+        if constexpr (use_max_score_in_dim) {
+            prune_query_terms(q_vec, approx_params.term_pruning_ratio);
+        }
+        if (q_vec.empty()) {
+            return;
+        }
+
+        MaxMinHeap<float> heap(k * approx_params.refine_factor);
+        const bool brute_force = use_filtered_brute_force(q_vec, internal_bitset);
+        if (approx_params.stats != nullptr) {
+            count_search_stats(q_vec, internal_bitset, brute_force, *approx_params.stats);
+        }
+        // DAAT_WAND and DAAT_MAXSCORE are based on the implementation in PISA.
+        if (brute_force) {
+            search_filtered_brute_force(q_vec, heap, internal_bitset, computer);
+        } else if constexpr (algo == InvertedIndexAlgo::DAAT_WAND) {
+            search_daat_wand(q_vec, heap, internal_bitset, computer, approx_params.dim_max_score_ratio);
+        } else if constexpr (algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+            search_daat_maxscore(q_vec, heap, internal_bitset, computer, approx_params.dim_max_score_ratio,
+                                 approx_params.term_pruning_ratio);
+        } else if constexpr (algo == InvertedIndexAlgo::DAAT_BMW) {
+            search_daat_bmw(q_vec, heap, internal_bitset, computer, approx_params.dim_max_score_ratio);
+        } else {
+            search_taat_naive(q_vec, heap, internal_bitset, computer);
+        }
+
+        if (approx_params.refine_factor == 1) {
+            collect_result(heap, distances, labels);
+        } else {
+            if (approx_params.stats != nullptr) {
+                approx_params.stats->refine_candidates += heap.size();
+            }
+            refine_and_collect(query, heap, k, distances, labels, computer, approx_params);
+        }
+    }
+
+    // Given a vector of values, returns the threshold value.
+    // All values strictly smaller than the threshold will be ignored.
+    // values will be modified in this function.
+    inline DType
+    get_threshold(std::vector<DType>& values, float drop_ratio) const {
+        // drop_ratio is in [0, 1) thus drop_count is guaranteed to be less
+        // than values.size().
+        auto drop_count = static_cast<size_t>(drop_ratio * values.size());
+        if (drop_count == 0) {
+            return 0;
+        }
+        auto pos = values.begin() + drop_count;
+        std::nth_element(values.begin(), pos, values.end());
+        return *pos;
+    }
+
+    // whether the postings are scored with the precomputed BM25 impacts instead of the computer.
+    inline bool
+    use_bm25_impacts() const {
+        return metric_type_ == SparseMetricType::METRIC_BM25 && bm25_params_->precompute_impacts;
+    }
+
+    // the doc length that the computer needs to score the postings of doc_id.
+    inline float
+    doc_val_sum(table_t doc_id) const {
+        return metric_type_ == SparseMetricType::METRIC_BM25 && !bm25_params_->precompute_impacts
+                   ? bm25_params_->row_sums_spans_[doc_id]
+                   : 0;
+    }
+
+    // the doc part of the score of the posting pos of the posting list of dim, which belongs to doc_id.
+    inline float
+    posting_score(size_t dim, size_t pos, table_t doc_id, const DocValueComputer<float>& computer) const {
+        if (use_bm25_impacts()) {
+            return bm25_params_->impact_scale * bm25_params_->impacts[dim][pos];
+        }
+        return computer(inverted_index_vals_spans_[dim][pos], doc_val_sum(doc_id));
+    }
+
+    // scores[ids[j] - block_begin] += q_value * computer(vals[pos + j]) for j in [0, n), vals being the values of the
+    // posting list of dim.
+    void
+    accumulate_posting_scores(size_t dim, const table_t* ids, size_t pos, size_t n, float q_value,
+                              const DocValueComputer<float>& computer, table_t block_begin, float* scores) const {
+        const QType* vals = inverted_index_vals_spans_[dim].data() + pos;
+        if constexpr (std::is_same_v<QType, float>) {
+            if (metric_type_ == SparseMetricType::METRIC_IP) {
+                faiss::fvec_scatter_madd(scores, ids, vals, n, q_value, block_begin);
+                return;
+            }
+        }
+        if (use_bm25_impacts()) {
+            const uint8_t* impacts = bm25_params_->impacts[dim].data() + pos;
+            const float weight = q_value * bm25_params_->impact_scale;
+            for (size_t j = 0; j < n; ++j) {
+                scores[ids[j] - block_begin] += weight * impacts[j];
+            }
+            return;
+        }
+        for (size_t j = 0; j < n; ++j) {
+            auto doc_id = ids[j];
+            scores[doc_id - block_begin] += q_value * computer(vals[j], doc_val_sum(doc_id));
+        }
+    }
+
+    // calls f(ids, pos, n) for the postings of the posting list of dim from position pos up to the first posting with
+    // doc id >= block_end, in chunks that do not cross a posting block. ids points to the doc ids of the postings
+    // [pos, pos + n). Returns the position of the first posting that was not visited.
+    template <typename F>
+    size_t
+    walk_block_postings(size_t dim, size_t pos, table_t block_end, F&& f) const {
+        const auto& plist_ids = inverted_index_ids_views_[dim];
+        table_t ids_buf[posting_block_size];
+        while (pos < plist_ids.size()) {
+            const size_t plist_block = pos / posting_block_size;
+            const size_t plist_block_begin = plist_block * posting_block_size;
+            const size_t plist_block_size = plist_ids.block_size(plist_block);
+            const table_t* ids = plist_ids.block(plist_block, ids_buf);
+            size_t end = plist_block_begin + plist_block_size;
+            if (plist_ids.block_last_id(plist_block) >= block_end) {
+                end = pos + faiss::u32_lower_bound(ids + (pos - plist_block_begin), end - pos, block_end);
+            }
+            f(ids + (pos - plist_block_begin), pos, end - pos);
+            const bool block_done = end == plist_block_begin + plist_block_size;
+            pos = end;
+            if (!block_done) {
+                break;
+            }
+        }
+        return pos;
+    }
+
+    // accumulates the scores of docs in [block_begin, block_end) into scores[0, block_end - block_begin).
+    // plist_pos[i] is the first not yet consumed position in the posting list of q_vec[i], it is advanced past all
+    // postings with doc id < block_end. Blocks must be visited in ascending order.
+    void
+    accumulate_block_scores(const std::vector<std::pair<size_t, DType>>& q_vec, const DocValueComputer<float>& computer,
+                            std::vector<size_t>& plist_pos, table_t block_begin, table_t block_end,
+                            float* scores) const {
+        for (size_t i = 0; i < q_vec.size(); ++i) {
+            plist_pos[i] = walk_block_postings(
+                q_vec[i].first, plist_pos[i], block_end, [&](const table_t* ids, size_t pos, size_t n) {
+                    accumulate_posting_scores(q_vec[i].first, ids, pos, n, q_vec[i].second, computer, block_begin,
+                                              scores);
+                });
+        }
+    }
+
+    std::vector<float>
+    compute_all_distances(const std::vector<std::pair<size_t, DType>>& q_vec,
+                          const DocValueComputer<float>& computer) const {
+        std::vector<float> scores(n_rows_internal_, 0.0f);
+        std::vector<size_t> plist_pos(q_vec.size(), 0);
+        accumulate_block_scores(q_vec, computer, plist_pos, 0, n_rows_internal_, scores.data());
+        return scores;
+    }
+
+    template <typename DocIdFilter>
+    struct Cursor {
+     public:
+        Cursor(const PostingListIdsView& plist_ids, const boost::span<const QType>& plist_vals, size_t num_vec,
+               float max_score, float q_value, DocIdFilter filter,
+               boost::span<const float> block_max_scores = boost::span<const float>(), float block_max_ratio = 0.0f)
+            : plist_ids_(plist_ids),
+              plist_vals_(plist_vals),
+              plist_size_(plist_ids.size()),
+              total_num_vec_(num_vec),
+              max_score_(max_score),
+              q_value_(q_value),
+              filter_(filter),
+              block_max_scores_(block_max_scores),
+              block_max_ratio_(block_max_ratio) {
+            if (plist_ids_.packed()) {
+                // heap allocated so that the decoded block stays valid when the cursor is moved.
+                block_buf_ = std::make_unique<table_t[]>(posting_block_size);
+            }
+            load_block(0);
+            skip_filtered_ids();
+            update_cur_vec_id();
+        }
+        Cursor(const Cursor& rhs) = delete;
+        Cursor(Cursor&& rhs) noexcept = default;
+
+        void
+        next() {
+            advance();
+            skip_filtered_ids();
+            update_cur_vec_id();
+        }
+
+        void
+        seek(table_t vec_id) {
+            seek_unfiltered(vec_id);
+            skip_filtered_ids();
+            update_cur_vec_id();
+        }
+
+        QType
+        cur_vec_val() const {
+            return plist_vals_[loc_];
+        }
+
+        // makes the cursor score its postings with their precomputed BM25 impacts, @see BM25Params::impacts.
+        void
+        set_impacts(const uint8_t* impacts, float impact_scale) {
+            impacts_ = impacts;
+            impact_weight_ = q_value_ * impact_scale;
+        }
+
+        // the score of the current posting weighted by the query value, vec_sum being the doc length of its doc.
+        float
+        cur_vec_score(const DocValueComputer<float>& computer, float vec_sum) const {
+            if (impacts_ != nullptr) {
+                return impact_weight_ * impacts_[loc_];
+            }
+            return q_value_ * computer(plist_vals_[loc_], vec_sum);
+        }
+
+        // The block max cursor moves independently of the posting cursor: it points to the first block whose last
+        // vector id is not smaller than the last target passed to block_max_seek().
+        void
+        block_max_seek(table_t vec_id) {
+            if (block_idx_ < block_max_scores_.size() && block_last_vec_id(block_idx_) < vec_id) {
+                block_idx_ = gallop_block(block_idx_ + 1, vec_id);
+            }
+        }
+
+        // last vector id covered by the current block, or total_num_vec_ if there is no block left.
+        table_t
+        block_max_vec_id() const {
+            return block_idx_ < block_max_scores_.size() ? block_last_vec_id(block_idx_) : total_num_vec_;
+        }
+
+        float
+        block_max_score() const {
+            return block_idx_ < block_max_scores_.size() ? block_max_scores_[block_idx_] * block_max_ratio_ : 0.0f;
+        }
+
+        const PostingListIdsView& plist_ids_;
+        const boost::span<const QType>& plist_vals_;
+        const size_t plist_size_;
+        size_t loc_ = 0;
+        size_t total_num_vec_ = 0;
+        float max_score_ = 0.0f;
+        float q_value_ = 0.0f;
+        DocIdFilter filter_;
+        table_t cur_vec_id_ = 0;
+        boost::span<const float> block_max_scores_;
+        // q_value * dim_max_score_ratio, applied to the block max scores.
+        float block_max_ratio_ = 0.0f;
+        size_t block_idx_ = 0;
+        // the BM25 impacts of the postings if they are precomputed, q_value * impact_scale applied to them.
+        const uint8_t* impacts_ = nullptr;
+        float impact_weight_ = 0.0f;
+
+     private:
+        // the posting block containing loc_, whose ids are decoded into block_buf_ for a packed posting list.
+        size_t block_ = 0;
+        size_t block_begin_ = 0;
+        size_t block_end_ = 0;
+        const table_t* block_ids_ = nullptr;
+        std::unique_ptr<table_t[]> block_buf_;
+
+        inline table_t
+        block_last_vec_id(size_t block_idx) const {
+            return plist_ids_.block_last_id(block_idx);
+        }
+
+        // first block at or after from whose last vector id is not smaller than vec_id, or num_blocks() if there is
+        // none. Seek targets are usually close to the current block, so gallop forward before the binary search.
+        inline size_t
+        gallop_block(size_t from, table_t vec_id) const {
+            const size_t num_blocks = plist_ids_.num_blocks();
+            size_t lo = from;
+            size_t hi = from;
+            size_t step = 1;
+            while (hi < num_blocks && block_last_vec_id(hi) < vec_id) {
+                lo = hi + 1;
+                hi += step;
+                step <<= 1;
+            }
+            hi = std::min(hi, num_blocks);
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (block_last_vec_id(mid) < vec_id) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+
+        inline void
+        load_block(size_t block) {
+            block_ = block;
+            block_begin_ = block * posting_block_size;
+            if (block < plist_ids_.num_blocks()) {
+                block_end_ = block_begin_ + plist_ids_.block_size(block);
+                block_ids_ = plist_ids_.block(block, block_buf_.get());
+            } else {
+                block_end_ = block_begin_;
+            }
+        }
+
+        inline table_t
+        cur_block_id() const {
+            return block_ids_[loc_ - block_begin_];
+        }
+
+        // moves loc_ to the first posting whose vector id is not smaller than vec_id, ignoring the filter.
+        inline void
+        seek_unfiltered(table_t vec_id) {
+            if (loc_ < plist_size_ && cur_block_id() < vec_id) {
+                // skip the blocks that end before vec_id using their last ids, then search inside the block.
+                if (plist_ids_.block_last_id(block_) < vec_id) {
+                    load_block(gallop_block(block_ + 1, vec_id));
+                    loc_ = std::min(block_begin_, plist_size_);
+                }
+                if (loc_ < plist_size_) {
+                    loc_ += faiss::u32_lower_bound(block_ids_ + (loc_ - block_begin_), block_end_ - loc_, vec_id);
+                }
+            }
+        }
+
+        inline void
+        advance() {
+            ++loc_;
+            if (loc_ == block_end_ && loc_ < plist_size_) {
+                load_block(block_ + 1);
+            }
+        }
+
+        inline void
+        update_cur_vec_id() {
+            cur_vec_id_ = (loc_ >= plist_size_) ? total_num_vec_ : cur_block_id();
+        }
+
+        inline void
+        skip_filtered_ids() {
+            while (loc_ < plist_size_ && !filter_.empty() && filter_.test(cur_block_id())) {
+                if constexpr (std::is_same_v<std::decay_t<DocIdFilter>, BitsetView>) {
+                    // jump over the run of filtered out vector ids with the bitset words instead of testing the
+                    // postings one by one.
+                    auto next_valid = filter_.get_next_valid_index(cur_block_id() + 1);
+                    if (next_valid >= filter_.size()) {
+                        loc_ = plist_size_;
+                        return;
+                    }
+                    seek_unfiltered(next_valid);
+                } else {
+                    advance();
+                }
+            }
+        }
+    };  // struct Cursor
+
+    std::vector<std::pair<size_t, DType>>
+    parse_query(const SparseRow<DType>& query, float drop_ratio_search) const {
+        DType q_threshold = 0;
         if (drop_ratio_search != 0) {
             std::vector<DType> values(query.size());
             for (size_t i = 0; i < query.size(); ++i) {
@@ -1051,16 +1890,56 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         std::vector<std::pair<size_t, DType>> filtered_query;
         for (size_t i = 0; i < query.size(); ++i) {
             auto [dim, val] = query[i];
-            auto dim_it = dim_map_.find(dim);
-            if (dim_it == dim_map_.cend() || std::abs(val) < q_threshold) {
+            auto dim_id = dim_map_.find(dim);
+            if (dim_id == DimMap::npos || std::abs(val) < q_threshold) {
                 continue;
             }
-            filtered_query.emplace_back(dim_it->second, val);
+            filtered_query.emplace_back(dim_id, val);
         }
 
         return filtered_query;
     }
 
+    // Drops the query terms that yield the least for the cost of their posting lists: in increasing order of the max
+    // contribution of a term, its query value times the max score of its dim, per posting of its list, the terms are
+    // dropped as long as the max contributions of all dropped terms sum up to at most ratio of those of all terms.
+    void
+    prune_query_terms(std::vector<std::pair<size_t, DType>>& q_vec, float ratio) const {
+        if (ratio <= 0 || q_vec.size() <= 1) {
+            return;
+        }
+        std::vector<float> bounds(q_vec.size());
+        float bound_sum = 0.0f;
+        for (size_t i = 0; i < q_vec.size(); ++i) {
+            bounds[i] = std::max(0.0f, static_cast<float>(q_vec[i].second) * max_score_in_dim_spans_[q_vec[i].first]);
+            bound_sum += bounds[i];
+        }
+        if (bound_sum <= 0) {
+            return;
+        }
+        std::vector<size_t> order(q_vec.size());
+        std::iota(order.begin(), order.end(), 0);
+        auto yield = [&](size_t i) {
+            return bounds[i] / std::max<size_t>(inverted_index_ids_views_[q_vec[i].first].size(), 1);
+        };
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return yield(a) < yield(b); });
+        float budget = ratio * bound_sum;
+        std::vector<bool> dropped(q_vec.size(), false);
+        for (auto i : order) {
+            if (bounds[i] <= budget) {
+                budget -= bounds[i];
+                dropped[i] = true;
+            }
+        }
+        size_t n = 0;
+        for (size_t i = 0; i < q_vec.size(); ++i) {
+            if (!dropped[i]) {
+                q_vec[n++] = q_vec[i];
+            }
+        }
+        q_vec.resize(n);
+    }
+
     template <typename DocIdFilter>
     std::vector<Cursor<DocIdFilter>>
     make_cursors(const std::vector<std::pair<size_t, DType>>& q_vec, const DocValueComputer<float>& computer,
@@ -1068,33 +1947,197 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         std::vector<Cursor<DocIdFilter>> cursors;
         cursors.reserve(q_vec.size());
         for (auto q_dim : q_vec) {
-            auto& plist_ids = inverted_index_ids_spans_[q_dim.first];
+            auto& plist_ids = inverted_index_ids_views_[q_dim.first];
             auto& plist_vals = inverted_index_vals_spans_[q_dim.first];
-            cursors.emplace_back(plist_ids, plist_vals, n_rows_internal_,
-                                 max_score_in_dim_spans_[q_dim.first] * q_dim.second * dim_max_score_ratio,
-                                 q_dim.second, filter);
+            if constexpr (use_block_max_scores) {
+                cursors.emplace_back(plist_ids, plist_vals, n_rows_internal_,
+                                     max_score_in_dim_spans_[q_dim.first] * q_dim.second * dim_max_score_ratio,
+                                     q_dim.second, filter, block_max_scores_spans_[q_dim.first],
+                                     q_dim.second * dim_max_score_ratio);
+            } else {
+                cursors.emplace_back(plist_ids, plist_vals, n_rows_internal_,
+                                     max_score_in_dim_spans_[q_dim.first] * q_dim.second * dim_max_score_ratio,
+                                     q_dim.second, filter);
+            }
+            if (use_bm25_impacts()) {
+                cursors.back().set_impacts(bm25_params_->impacts[q_dim.first].data(), bm25_params_->impact_scale);
+            }
         }
         return cursors;
     }
 
+    // Whether to score the docs that pass the bitset one by one instead of traversing the posting lists of the query.
+    // Looking up a posting by doc id costs about filtered_brute_force_cost_factor times more than visiting it in a
+    // posting list, so this pays off only when the bitset filters out most of the docs.
+    bool
+    use_filtered_brute_force(const std::vector<std::pair<size_t, DType>>& q_vec, const BitsetView& bitset) const {
+        if (bitset.empty()) {
+            return false;
+        }
+        if (bitset.count() >= bitset.size()) {
+            // nothing passes the bitset.
+            return true;
+        }
+        size_t nr_postings = 0;
+        for (const auto& q_dim : q_vec) {
+            nr_postings += inverted_index_ids_views_[q_dim.first].size();
+        }
+        size_t nr_valid = bitset.size() - bitset.count();
+        return nr_valid * q_vec.size() * filtered_brute_force_cost_factor < nr_postings;
+    }
+
+    // counts into stats the posting lists of the query and the postings that the search visits: all of those of the
+    // lists for the traversal of the lists (the DAAT algorithms skip some of them, so this bounds their cost), one
+    // lookup per list for each doc that passes the bitset for the brute force.
+    void
+    count_search_stats(const std::vector<std::pair<size_t, DType>>& q_vec, const BitsetView& bitset,
+                       const bool brute_force, QuerySearchStats& stats) const {
+        stats.lists_probed += q_vec.size();
+        if (brute_force) {
+            const size_t n = std::min(n_rows_internal_, bitset.size());
+            const size_t nr_valid = bitset.count() >= n ? 0 : n - bitset.count();
+            stats.distance_computations += nr_valid * q_vec.size();
+            return;
+        }
+        for (const auto& q_dim : q_vec) {
+            stats.distance_computations += inverted_index_ids_views_[q_dim.first].size();
+        }
+    }
+
+    // find the top-k candidates among the docs that pass the bitset by looking up each of them in the posting lists
+    // of the query, k as specified by the capacity of the heap.
+    template <typename HeapType>
+    void
+    search_filtered_brute_force(const std::vector<std::pair<size_t, DType>>& q_vec, HeapType& heap,
+                                const BitsetView& bitset, const DocValueComputer<float>& computer) const {
+        const size_t n = std::min(n_rows_internal_, bitset.size());
+        for (size_t vec_id = bitset.get_next_valid_index(0); vec_id < n;
+             vec_id = bitset.get_next_valid_index(vec_id + 1)) {
+            float score = 0.0f;
+            bool matched = false;
+            for (const auto& [dim_id, q_val] : q_vec) {
+                const auto& plist_ids = inverted_index_ids_views_[dim_id];
+                auto pos = plist_ids.find(vec_id);
+                if (pos != plist_ids.size()) {
+                    score += q_val * posting_score(dim_id, pos, vec_id, computer);
+                    matched = true;
+                }
+            }
+            if (matched) {
+                heap.push(vec_id, score);
+            }
+        }
+    }
+
     // find the top-k candidates using brute force search, k as specified by the capacity of the heap.
     // any value in q_vec that is smaller than q_threshold and any value with dimension >= n_cols() will be ignored.
+    // the doc id space is processed in blocks of taat_block_size docs so that the score accumulator stays in cache
+    // instead of scattering into a buffer of n_rows_internal_ floats. The scores of a block are reset as they are
+    // collected, the accumulator is kept zeroed for the next query of the thread.
     // TODO: may switch to row-wise brute force if filter rate is high. Benchmark needed.
-    template <typename DocIdFilter>
+    template <typename DocIdFilter, typename HeapType>
     void
-    search_taat_naive(const std::vector<std::pair<size_t, DType>>& q_vec, MaxMinHeap<float>& heap, DocIdFilter& filter,
+    search_taat_naive(const std::vector<std::pair<size_t, DType>>& q_vec, HeapType& heap, DocIdFilter& filter,
                       const DocValueComputer<float>& computer) const {
-        auto scores = compute_all_distances(q_vec, computer);
-        for (size_t i = 0; i < n_rows_internal_; ++i) {
-            if ((filter.empty() || !filter.test(i)) && scores[i] != 0) {
-                heap.push(i, scores[i]);
+        TaatScores taat_scores(std::min<size_t>(taat_block_size, n_rows_internal_));
+        float* scores = taat_scores.data();
+        std::vector<size_t> plist_pos(q_vec.size(), 0);
+        for (size_t block_begin = 0; block_begin < n_rows_internal_; block_begin += taat_block_size) {
+            const size_t block_end = std::min<size_t>(block_begin + taat_block_size, n_rows_internal_);
+            accumulate_block_scores(q_vec, computer, plist_pos, block_begin, block_end, scores);
+            for (size_t i = block_begin; i < block_end; ++i) {
+                auto& score = scores[i - block_begin];
+                if (score != 0) {
+                    if (filter.empty() || !filter.test(i)) {
+                        heap.push(i, score);
+                    }
+                    score = 0;
+                }
             }
         }
     }
 
+    // TAAT_NAIVE for the queries q_vecs[q_begin, q_end): the query terms are grouped by dim so that each posting list
+    // is read once for all the queries containing it, and each posting is scattered into the scores of those queries.
+    // The docs are still processed in blocks, smaller ones so that the scores of all queries of a block stay in cache.
     template <typename DocIdFilter>
     void
-    search_daat_wand(const std::vector<std::pair<size_t, DType>>& q_vec, MaxMinHeap<float>& heap, DocIdFilter& filter,
+    search_taat_batch(const std::vector<std::vector<std::pair<size_t, DType>>>& q_vecs, size_t q_begin, size_t q_end,
+                      std::vector<MaxMinHeap<float>>& heaps, DocIdFilter& filter,
+                      const DocValueComputer<float>& computer) const {
+        const size_t nq = q_end - q_begin;
+        std::unordered_map<size_t, size_t> dim_terms;
+        std::vector<size_t> term_dims;
+        // (query offset in the batch, query value) of each query containing the term.
+        std::vector<std::vector<std::pair<size_t, float>>> term_queries;
+        for (size_t q = q_begin; q < q_end; ++q) {
+            for (const auto& [dim, val] : q_vecs[q]) {
+                auto [it, inserted] = dim_terms.try_emplace(dim, term_dims.size());
+                if (inserted) {
+                    term_dims.push_back(dim);
+                    term_queries.emplace_back();
+                }
+                term_queries[it->second].emplace_back(q - q_begin, val);
+            }
+        }
+
+        const size_t block_size =
+            std::min<size_t>(std::max<size_t>(taat_block_size / nq, posting_block_size), n_rows_internal_);
+        TaatScores taat_scores(nq * block_size);
+        float* scores = taat_scores.data();
+        std::vector<size_t> plist_pos(term_dims.size(), 0);
+        float doc_scores[posting_block_size];
+        for (size_t block_begin = 0; block_begin < n_rows_internal_; block_begin += block_size) {
+            const size_t block_end = std::min<size_t>(block_begin + block_size, n_rows_internal_);
+            for (size_t t = 0; t < term_dims.size(); ++t) {
+                const auto& plist_vals = inverted_index_vals_spans_[term_dims[t]];
+                plist_pos[t] = walk_block_postings(
+                    term_dims[t], plist_pos[t], block_end, [&](const table_t* ids, size_t pos, size_t n) {
+                        // the doc part of the score is computed once per posting and shared by all queries.
+                        const float* vals = nullptr;
+                        if constexpr (std::is_same_v<QType, float>) {
+                            if (metric_type_ == SparseMetricType::METRIC_IP) {
+                                vals = plist_vals.data() + pos;
+                            }
+                        }
+                        if (vals == nullptr && use_bm25_impacts()) {
+                            const uint8_t* impacts = bm25_params_->impacts[term_dims[t]].data() + pos;
+                            for (size_t j = 0; j < n; ++j) {
+                                doc_scores[j] = bm25_params_->impact_scale * impacts[j];
+                            }
+                            vals = doc_scores;
+                        }
+                        if (vals == nullptr) {
+                            for (size_t j = 0; j < n; ++j) {
+                                doc_scores[j] = computer(plist_vals[pos + j], doc_val_sum(ids[j]));
+                            }
+                            vals = doc_scores;
+                        }
+                        for (const auto& [q, q_value] : term_queries[t]) {
+                            faiss::fvec_scatter_madd(scores + q * block_size, ids, vals, n, q_value,
+                                                     block_begin);
+                        }
+                    });
+            }
+            for (size_t q = 0; q < nq; ++q) {
+                float* q_scores = scores + q * block_size;
+                auto& heap = heaps[q_begin + q];
+                for (size_t i = block_begin; i < block_end; ++i) {
+                    auto& score = q_scores[i - block_begin];
+                    if (score != 0) {
+                        if (filter.empty() || !filter.test(i)) {
+                            heap.push(i, score);
+                        }
+                        score = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename DocIdFilter, typename HeapType>
+    void
+    search_daat_wand(const std::vector<std::pair<size_t, DType>>& q_vec, HeapType& heap, DocIdFilter& filter,
                      const DocValueComputer<float>& computer, float dim_max_score_ratio) const {
         std::vector<Cursor<DocIdFilter>> cursors = make_cursors(q_vec, computer, filter, dim_max_score_ratio);
         std::vector<Cursor<DocIdFilter>*> cursor_ptrs(cursors.size());
@@ -1131,13 +2174,12 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             table_t pivot_id = cursor_ptrs[pivot]->cur_vec_id_;
             if (pivot_id == cursor_ptrs[0]->cur_vec_id_) {
                 float score = 0;
-                float cur_vec_sum =
-                    metric_type_ == SparseMetricType::METRIC_BM25 ? bm25_params_->row_sums_spans_[pivot_id] : 0;
+                float cur_vec_sum = doc_val_sum(pivot_id);
                 for (auto& cursor_ptr : cursor_ptrs) {
                     if (cursor_ptr->cur_vec_id_ != pivot_id) {
                         break;
                     }
-                    score += cursor_ptr->q_value_ * computer(cursor_ptr->cur_vec_val(), cur_vec_sum);
+                    score += cursor_ptr->cur_vec_score(computer, cur_vec_sum);
                     cursor_ptr->next();
                 }
                 heap.push(pivot_id, score);
@@ -1157,10 +2199,119 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         }
     }
 
-    template <typename DocIdFilter>
+    // Block-Max WAND: WAND pivot selection with the max score of each dim, then the pivot is checked against the
+    // sum of the block max scores of the blocks it falls into. If the pivot can not make it into the heap, the
+    // cursors jump over the shallowest block boundary instead of evaluating the pivot.
+    template <typename DocIdFilter, typename HeapType>
+    void
+    search_daat_bmw(const std::vector<std::pair<size_t, DType>>& q_vec, HeapType& heap, DocIdFilter& filter,
+                    const DocValueComputer<float>& computer, float dim_max_score_ratio) const {
+        std::vector<Cursor<DocIdFilter>> cursors = make_cursors(q_vec, computer, filter, dim_max_score_ratio);
+        std::vector<Cursor<DocIdFilter>*> cursor_ptrs(cursors.size());
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            cursor_ptrs[i] = &cursors[i];
+        }
+
+        auto sort_cursors = [&cursor_ptrs] {
+            std::sort(cursor_ptrs.begin(), cursor_ptrs.end(),
+                      [](auto& x, auto& y) { return x->cur_vec_id_ < y->cur_vec_id_; });
+        };
+        // move cursor_ptrs[idx] forward to keep cursor_ptrs sorted after it advanced.
+        auto bubble_down = [&cursor_ptrs](size_t idx) {
+            for (size_t i = idx + 1; i < cursor_ptrs.size(); ++i) {
+                if (cursor_ptrs[i]->cur_vec_id_ >= cursor_ptrs[i - 1]->cur_vec_id_) {
+                    break;
+                }
+                std::swap(cursor_ptrs[i], cursor_ptrs[i - 1]);
+            }
+        };
+        sort_cursors();
+
+        while (true) {
+            float threshold = heap.full() ? heap.top().val : 0;
+            float upper_bound = 0;
+            size_t pivot;
+
+            bool found_pivot = false;
+            for (pivot = 0; pivot < cursor_ptrs.size(); ++pivot) {
+                if (cursor_ptrs[pivot]->cur_vec_id_ >= n_rows_internal_) {
+                    break;
+                }
+                upper_bound += cursor_ptrs[pivot]->max_score_;
+                if (upper_bound > threshold) {
+                    found_pivot = true;
+                    break;
+                }
+            }
+            if (!found_pivot) {
+                break;
+            }
+
+            table_t pivot_id = cursor_ptrs[pivot]->cur_vec_id_;
+            // lists after the pivot that are also on pivot_id contribute to its score.
+            while (pivot + 1 < cursor_ptrs.size() && cursor_ptrs[pivot + 1]->cur_vec_id_ == pivot_id) {
+                ++pivot;
+            }
+
+            float block_upper_bound = 0;
+            for (size_t i = 0; i <= pivot; ++i) {
+                cursor_ptrs[i]->block_max_seek(pivot_id);
+                block_upper_bound += cursor_ptrs[i]->block_max_score();
+            }
+
+            if (block_upper_bound > threshold) {
+                if (pivot_id == cursor_ptrs[0]->cur_vec_id_) {
+                    float score = 0;
+                    float cur_vec_sum = doc_val_sum(pivot_id);
+                    for (auto& cursor_ptr : cursor_ptrs) {
+                        if (cursor_ptr->cur_vec_id_ != pivot_id) {
+                            break;
+                        }
+                        score += cursor_ptr->cur_vec_score(computer, cur_vec_sum);
+                        cursor_ptr->next();
+                    }
+                    heap.push(pivot_id, score);
+                    sort_cursors();
+                } else {
+                    size_t next_list = pivot;
+                    for (; cursor_ptrs[next_list]->cur_vec_id_ == pivot_id; --next_list) {
+                    }
+                    cursor_ptrs[next_list]->seek(pivot_id);
+                    bubble_down(next_list);
+                }
+            } else {
+                // no vector before the end of the shallowest block can beat the threshold with the lists up to the
+                // pivot, advance the list with the largest max score past it.
+                size_t next_list = pivot;
+                float max_weight = cursor_ptrs[next_list]->max_score_;
+                for (size_t i = 0; i < pivot; ++i) {
+                    if (cursor_ptrs[i]->max_score_ > max_weight) {
+                        next_list = i;
+                        max_weight = cursor_ptrs[i]->max_score_;
+                    }
+                }
+                size_t next_vec_id = n_rows_internal_;
+                for (size_t i = 0; i <= pivot; ++i) {
+                    next_vec_id = std::min<size_t>(next_vec_id, cursor_ptrs[i]->block_max_vec_id());
+                }
+                next_vec_id += 1;
+                if (pivot + 1 < cursor_ptrs.size() && cursor_ptrs[pivot + 1]->cur_vec_id_ < next_vec_id) {
+                    next_vec_id = cursor_ptrs[pivot + 1]->cur_vec_id_;
+                }
+                if (next_vec_id <= pivot_id) {
+                    next_vec_id = pivot_id + 1;
+                }
+                cursor_ptrs[next_list]->seek(next_vec_id);
+                bubble_down(next_list);
+            }
+        }
+    }
+
+    template <typename DocIdFilter, typename HeapType>
     void
-    search_daat_maxscore(std::vector<std::pair<size_t, DType>>& q_vec, MaxMinHeap<float>& heap, DocIdFilter& filter,
-                         const DocValueComputer<float>& computer, float dim_max_score_ratio) const {
+    search_daat_maxscore(std::vector<std::pair<size_t, DType>>& q_vec, HeapType& heap, DocIdFilter& filter,
+                         const DocValueComputer<float>& computer, float dim_max_score_ratio,
+                         float term_pruning_ratio = 0.0f) const {
         std::sort(q_vec.begin(), q_vec.end(), [this](auto& a, auto& b) {
             return a.second * max_score_in_dim_spans_[a.first] > b.second * max_score_in_dim_spans_[b.first];
         });
@@ -1193,6 +2344,19 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             }
         }
 
+        // the non-essential cursors from probe_end on are not probed for the candidates anymore: their max scores are
+        // at most term_pruning_ratio of the threshold, which only grows, so they would hardly change the top-k.
+        size_t probe_end = cursors.size();
+        auto drop_low_yield_cursors = [&]() {
+            if (term_pruning_ratio <= 0) {
+                return;
+            }
+            while (probe_end > first_ne_idx && cursors[probe_end - 1].max_score_ <= term_pruning_ratio * threshold) {
+                --probe_end;
+            }
+        };
+        drop_low_yield_cursors();
+
         float curr_cand_score = 0.0f;
         table_t curr_cand_vec_id = 0;
 
@@ -1208,12 +2372,11 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                 curr_cand_score = 0.0f;
                 // update next_cand_vec_id
                 next_cand_vec_id = n_rows_internal_;
-                float cur_vec_sum =
-                    metric_type_ == SparseMetricType::METRIC_BM25 ? bm25_params_->row_sums_spans_[curr_cand_vec_id] : 0;
+                float cur_vec_sum = doc_val_sum(curr_cand_vec_id);
 
                 for (size_t i = 0; i < first_ne_idx; ++i) {
                     if (cursors[i].cur_vec_id_ == curr_cand_vec_id) {
-                        curr_cand_score += cursors[i].q_value_ * computer(cursors[i].cur_vec_val(), cur_vec_sum);
+                        curr_cand_score += cursors[i].cur_vec_score(computer, cur_vec_sum);
                         cursors[i].next();
                     }
                     if (cursors[i].cur_vec_id_ < next_cand_vec_id) {
@@ -1222,14 +2385,14 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                 }
 
                 found_cand = true;
-                for (size_t i = first_ne_idx; i < cursors.size(); ++i) {
+                for (size_t i = first_ne_idx; i < probe_end; ++i) {
                     if (curr_cand_score + upper_bounds[i] <= threshold) {
                         found_cand = false;
                         break;
                     }
                     cursors[i].seek(curr_cand_vec_id);
                     if (cursors[i].cur_vec_id_ == curr_cand_vec_id) {
-                        curr_cand_score += cursors[i].q_value_ * computer(cursors[i].cur_vec_val(), cur_vec_sum);
+                        curr_cand_score += cursors[i].cur_vec_score(computer, cur_vec_sum);
                     }
                 }
             }
@@ -1243,10 +2406,57 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
                         return;
                     }
                 }
+                drop_low_yield_cursors();
             }
         }
     }
 
+    // Computes the block max scores, and the max scores of each dim if they are missing as well, from the posting
+    // lists. Used when the serialized index does not contain the block max scores section.
+    void
+    compute_block_max_scores() {
+        std::vector<size_t> block_max_offsets(nr_inner_dims_ + 1, 0);
+        for (size_t i = 0; i < nr_inner_dims_; ++i) {
+            block_max_offsets[i + 1] = block_max_offsets[i] +
+                                       (inverted_index_ids_views_[i].size() + block_max_block_size - 1) /
+                                           block_max_block_size;
+        }
+        block_max_scores_buffer_.assign(block_max_offsets.back(), 0.0f);
+        const bool compute_max_score_in_dim = max_score_in_dim_spans_.size() != nr_inner_dims_;
+        if (compute_max_score_in_dim) {
+            max_score_in_dim_buffer_.assign(nr_inner_dims_, 0.0f);
+        }
+        // the dims write their own blocks, they are scored in parallel at load
+        const size_t nr_postings = block_max_offsets.back() * block_max_block_size;
+        const size_t dim_cost = nr_postings / std::max<size_t>(nr_inner_dims_, 1);
+        ParallelForOverBuildThreadPool(nr_inner_dims_, dim_cost, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const auto& plist_vals = inverted_index_vals_spans_[i];
+                inverted_index_ids_views_[i].for_each([&](size_t j, table_t id) {
+                    auto score = static_cast<float>(plist_vals[j]);
+                    if (metric_type_ == SparseMetricType::METRIC_BM25) {
+                        score = bm25_params_->max_score_computer(plist_vals[j], bm25_params_->row_sums_spans_[id]);
+                    }
+                    auto& block_max = block_max_scores_buffer_[block_max_offsets[i] + j / block_max_block_size];
+                    block_max = std::max(block_max, score);
+                    if (compute_max_score_in_dim) {
+                        max_score_in_dim_buffer_[i] = std::max(max_score_in_dim_buffer_[i], score);
+                    }
+                });
+            }
+        });
+        block_max_scores_spans_.resize(nr_inner_dims_);
+        for (size_t i = 0; i < nr_inner_dims_; ++i) {
+            block_max_scores_spans_[i] =
+                boost::span<const float>(block_max_scores_buffer_.data() + block_max_offsets[i],
+                                         block_max_offsets[i + 1] - block_max_offsets[i]);
+        }
+        if (compute_max_score_in_dim) {
+            max_score_in_dim_spans_ =
+                boost::span<const float>(max_score_in_dim_buffer_.data(), max_score_in_dim_buffer_.size());
+        }
+    }
+
     void
     refine_and_collect(const SparseRow<DType>& query, MaxMinHeap<float>& inacc_heap, size_t k, float* distances,
                        label_t* labels, const DocValueComputer<float>& computer,
@@ -1273,23 +2483,234 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             search_daat_wand(q_vec, heap, filter, computer, dim_max_score_ratio);
         } else if constexpr (algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
             search_daat_maxscore(q_vec, heap, filter, computer, dim_max_score_ratio);
+        } else if constexpr (algo == InvertedIndexAlgo::DAAT_BMW) {
+            search_daat_bmw(q_vec, heap, filter, computer, dim_max_score_ratio);
         } else {
             search_taat_naive(q_vec, heap, filter, computer);
         }
         collect_result(heap, distances, labels);
     }
 
+    // Stands for the heap of the search algorithms in a range search: it is always full and its top is the radius,
+    // so that the algorithms only keep the docs that score above the radius, which are added to the results.
+    class RangeCollector {
+     public:
+        RangeCollector(const InvertedIndex& index, float radius, float range_filter,
+                       RangeSearchResultArena::Writer& writer)
+            : index_(index), radius_(radius), range_filter_(range_filter), writer_(writer) {
+        }
+
+        [[nodiscard]] bool
+        full() const {
+            return true;
+        }
+
+        [[nodiscard]] SparseIdVal<float>
+        top() const {
+            return {0, radius_};
+        }
+
+        void
+        push(table_t id, float val) {
+            if (val > radius_ && val <= range_filter_) {
+                writer_.Add(index_.external_id(id), val);
+            }
+        }
+
+     private:
+        const InvertedIndex& index_;
+        const float radius_;
+        const float range_filter_;
+        RangeSearchResultArena::Writer& writer_;
+    };
+
     template <typename HeapType>
     void
     collect_result(HeapType& heap, float* distances, label_t* labels) const {
         int cnt = heap.size();
         for (auto i = cnt - 1; i >= 0; --i) {
-            labels[i] = heap.top().id;
+            labels[i] = external_id(heap.top().id);
             distances[i] = heap.top().val;
             heap.pop();
         }
     }
 
+    // computes the BM25 impacts of all postings once the posting lists and the row sums are in place.
+    void
+    precompute_bm25_impacts() {
+        if (!use_bm25_impacts()) {
+            return;
+        }
+        auto& params = *bm25_params_;
+        // the BM25 score of a posting is below k1 + 1.
+        params.impact_scale = (params.k1 + 1.0f) / std::numeric_limits<uint8_t>::max();
+        params.impacts.resize(nr_inner_dims_);
+        for (size_t i = 0; i < nr_inner_dims_; ++i) {
+            const auto& plist_vals = inverted_index_vals_spans_[i];
+            auto& impacts = params.impacts[i];
+            impacts.resize(plist_vals.size());
+            inverted_index_ids_views_[i].for_each([&](size_t pos, table_t id) {
+                auto score = params.max_score_computer(plist_vals[pos], params.row_sums_spans_[id]);
+                impacts[pos] = static_cast<uint8_t>(std::min<float>(std::floor(score / params.impact_scale),
+                                                                    std::numeric_limits<uint8_t>::max()));
+            });
+        }
+    }
+
+    // adds the rows data[order[i]], or data[i] if order is null, with the ids first_id + i.
+    void
+    add_rows_to_index(const SparseRow<DType>* data, const uint32_t* order, size_t rows, table_t first_id) {
+        if (rows >= 2 * parallel_build_min_chunk_rows && GetBuildThreadPoolSize() > 1) {
+            add_rows_to_index_parallel(data, order, rows, first_id);
+            return;
+        }
+        for (size_t i = 0; i < rows; ++i) {
+            add_row_to_index(data[order == nullptr ? i : order[i]], first_id + i);
+        }
+    }
+
+    // Builds the same posting lists, row sums and max scores as add_row_to_index() for each of the rows in turn, in
+    // parallel over chunks of rows on the build pool: the dims new to the index are found in the order of their first
+    // occurrence, the postings of each dim are counted per chunk so that the posting lists are grown exactly once and
+    // each chunk fills its own range of each of them, then the max scores are updated per dim.
+    void
+    add_rows_to_index_parallel(const SparseRow<DType>* data, const uint32_t* order, size_t rows, table_t first_id) {
+        auto row_at = [&](size_t i) -> const SparseRow<DType>& { return data[order == nullptr ? i : order[i]]; };
+        const size_t nr_chunks = std::clamp<size_t>(rows / parallel_build_min_chunk_rows, 1, GetBuildThreadPoolSize());
+        auto chunk_begin = [&](size_t c) { return rows * c / nr_chunks; };
+        auto for_each_chunk = [&](const std::function<void(size_t)>& f) {
+            // a chunk per worker
+            ParallelForOverBuildThreadPool(nr_chunks, kParallelForMinChunkCost, [&](size_t begin, size_t end) {
+                for (size_t c = begin; c < end; ++c) {
+                    f(c);
+                }
+            });
+        };
+
+        std::vector<std::vector<table_t>> chunk_new_dims(nr_chunks);
+        for_each_chunk([&](size_t c) {
+            std::unordered_set<table_t> seen;
+            for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+                const auto& row = row_at(i);
+                for (size_t j = 0; j < row.size(); ++j) {
+                    auto [dim, val] = row[j];
+                    if (val != 0 && dim_map_.find(dim) == DimMap::npos && seen.insert(dim).second) {
+                        chunk_new_dims[c].push_back(dim);
+                    }
+                }
+            }
+        });
+        for (const auto& new_dims : chunk_new_dims) {
+            for (auto dim : new_dims) {
+                if (dim_map_.find(dim) != DimMap::npos) {
+                    continue;
+                }
+                dim_map_.insert(dim);
+                inverted_index_ids_.emplace_back();
+                inverted_index_vals_.emplace_back();
+                if constexpr (use_max_score_in_dim) {
+                    max_score_in_dim_.emplace_back(0.0f);
+                }
+                if constexpr (use_block_max_scores) {
+                    block_max_scores_.emplace_back();
+                }
+            }
+        }
+        const size_t nr_dims = dim_map_.size();
+
+        // chunk_offsets[c][i] is first the number of postings of the chunk c in the posting list of i, then the
+        // position of the next one.
+        std::vector<std::vector<size_t>> chunk_offsets(nr_chunks);
+        std::vector<float> row_sums(metric_type_ == SparseMetricType::METRIC_BM25 ? rows : 0);
+        for_each_chunk([&](size_t c) {
+            auto& counts = chunk_offsets[c];
+            counts.assign(nr_dims, 0);
+            for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+                const auto& row = row_at(i);
+                float row_sum = 0;
+                for (size_t j = 0; j < row.size(); ++j) {
+                    auto [dim, val] = row[j];
+                    row_sum += val;
+                    if (val != 0) {
+                        ++counts[dim_map_.find(dim)];
+                    }
+                }
+                if (metric_type_ == SparseMetricType::METRIC_BM25) {
+                    row_sums[i] = row_sum;
+                }
+            }
+        });
+        std::vector<size_t> old_sizes(nr_dims);
+        // the scores of the new postings of i start at score_offsets[i].
+        std::vector<size_t> score_offsets(nr_dims + 1, 0);
+        for (size_t i = 0; i < nr_dims; ++i) {
+            size_t offset = inverted_index_ids_[i].size();
+            old_sizes[i] = offset;
+            for (size_t c = 0; c < nr_chunks; ++c) {
+                auto count = chunk_offsets[c][i];
+                chunk_offsets[c][i] = offset;
+                offset += count;
+            }
+            inverted_index_ids_[i].resize(offset);
+            inverted_index_vals_[i].resize(offset);
+            score_offsets[i + 1] = score_offsets[i] + (offset - old_sizes[i]);
+        }
+        std::vector<float> scores(use_max_score_in_dim ? score_offsets.back() : 0);
+
+        for_each_chunk([&](size_t c) {
+            auto& offsets = chunk_offsets[c];
+            for (size_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+                const auto& row = row_at(i);
+                for (size_t j = 0; j < row.size(); ++j) {
+                    auto [dim, val] = row[j];
+                    if (val == 0) {
+                        continue;
+                    }
+                    auto dim_id = dim_map_.find(dim);
+                    auto pos = offsets[dim_id]++;
+                    inverted_index_ids_[dim_id][pos] = first_id + i;
+                    inverted_index_vals_[dim_id][pos] = get_quant_val(val);
+                    if constexpr (use_max_score_in_dim) {
+                        auto score = static_cast<float>(val);
+                        if (metric_type_ == SparseMetricType::METRIC_BM25) {
+                            score = bm25_params_->max_score_computer(val, row_sums[i]);
+                        }
+                        scores[score_offsets[dim_id] + pos - old_sizes[dim_id]] = score;
+                    }
+                }
+            }
+        });
+
+        if constexpr (use_max_score_in_dim) {
+            const size_t dim_cost = scores.size() / std::max<size_t>(nr_dims, 1) + 1;
+            ParallelForOverBuildThreadPool(nr_dims, dim_cost, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    for (size_t pos = old_sizes[i]; pos < inverted_index_ids_[i].size(); ++pos) {
+                        auto score = scores[score_offsets[i] + pos - old_sizes[i]];
+                        max_score_in_dim_[i] = std::max(max_score_in_dim_[i], score);
+                        if constexpr (use_block_max_scores) {
+                            auto& block_max = block_max_scores_[i];
+                            if (pos % block_max_block_size == 0) {
+                                block_max.emplace_back(score);
+                            } else {
+                                block_max[block_max.size() - 1] = std::max(block_max[block_max.size() - 1], score);
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
+        if (metric_type_ == SparseMetricType::METRIC_BM25) {
+            bm25_params_->row_sums.insert(bm25_params_->row_sums.end(), row_sums.begin(), row_sums.end());
+        }
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+        for (size_t i = 0; i < rows; ++i) {
+            build_stats_.dataset_nnz_stats_.push_back(row_at(i).size());
+        }
+#endif
+    }
+
     inline void
     add_row_to_index(const SparseRow<DType>& row, table_t vec_id) {
         [[maybe_unused]] float row_sum = 0;
@@ -1303,40 +2724,53 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
             if (val == 0) {
                 continue;
             }
-            auto dim_it = dim_map_.find(dim);
-            if (dim_it == dim_map_.cend()) {
+            auto dim_id = dim_map_.find(dim);
+            if (dim_id == DimMap::npos) {
                 if constexpr (mmapped) {
                     throw std::runtime_error("unexpected vector dimension in mmapped InvertedIndex");
                 }
-                dim_it = dim_map_.insert({dim, next_dim_id_++}).first;
+                dim_id = dim_map_.insert(dim);
                 inverted_index_ids_.emplace_back();
                 inverted_index_vals_.emplace_back();
-                if constexpr (algo == InvertedIndexAlgo::DAAT_WAND || algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+                if constexpr (use_max_score_in_dim) {
                     max_score_in_dim_.emplace_back(0.0f);
                 }
+                if constexpr (use_block_max_scores) {
+                    block_max_scores_.emplace_back();
+                }
             }
-            inverted_index_ids_[dim_it->second].emplace_back(vec_id);
-            inverted_index_vals_[dim_it->second].emplace_back(get_quant_val(val));
+            inverted_index_ids_[dim_id].emplace_back(vec_id);
+            inverted_index_vals_[dim_id].emplace_back(get_quant_val(val));
         }
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
         build_stats_.dataset_nnz_stats_.push_back(row.size());
 #endif
         // update max_score_in_dim_
-        if constexpr (algo == InvertedIndexAlgo::DAAT_WAND || algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+        if constexpr (use_max_score_in_dim) {
             for (size_t j = 0; j < row.size(); ++j) {
                 auto [dim, val] = row[j];
                 if (val == 0) {
                     continue;
                 }
-                auto dim_it = dim_map_.find(dim);
-                if (dim_it == dim_map_.cend()) {
+                auto dim_id = dim_map_.find(dim);
+                if (dim_id == DimMap::npos) {
                     throw std::runtime_error("unexpected vector dimension in InvertedIndex");
                 }
                 auto score = static_cast<float>(val);
                 if (metric_type_ == SparseMetricType::METRIC_BM25) {
                     score = bm25_params_->max_score_computer(val, row_sum);
                 }
-                max_score_in_dim_[dim_it->second] = std::max(max_score_in_dim_[dim_it->second], score);
+                max_score_in_dim_[dim_id] = std::max(max_score_in_dim_[dim_id], score);
+                if constexpr (use_block_max_scores) {
+                    // the posting of this row is the last one of the posting list.
+                    auto& block_max = block_max_scores_[dim_id];
+                    auto pos = inverted_index_ids_[dim_id].size() - 1;
+                    if (pos % block_max_block_size == 0) {
+                        block_max.emplace_back(score);
+                    } else {
+                        block_max[block_max.size() - 1] = std::max(block_max[block_max.size() - 1], score);
+                    }
+                }
             }
         }
         if (metric_type_ == SparseMetricType::METRIC_BM25) {
@@ -1360,23 +2794,40 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
         }
     }
 
-    // key is raw sparse vector dim/idx, value is the mapped dim/idx id in the index.
-    std::unordered_map<table_t, uint32_t> dim_map_;
+    // maps raw sparse vector dim/idx to the dim/idx id in the index.
+    DimMap dim_map_;
     uint32_t nr_inner_dims_ = 0;
 
     // reserve, [], size, emplace_back
     Vector<Vector<table_t>> inverted_index_ids_;
     Vector<Vector<QType>> inverted_index_vals_;
-    std::vector<boost::span<const table_t>> inverted_index_ids_spans_;
+    // raw views of inverted_index_ids_, or views of the block packed ids of a deserialized index.
+    std::vector<PostingListIdsView> inverted_index_ids_views_;
     std::vector<boost::span<const QType>> inverted_index_vals_spans_;
     Vector<float> max_score_in_dim_;
     boost::span<const float> max_score_in_dim_spans_;
+    // max score of every block_max_block_size postings of each dim, only used by DAAT_BMW.
+    Vector<Vector<float>> block_max_scores_;
+    std::vector<boost::span<const float>> block_max_scores_spans_;
+    // owns the block max scores (and max scores per dim) computed during Deserialize when they are missing in the
+    // serialized index, e.g. an index built with another algorithm and loaded with DAAT_BMW.
+    std::vector<float> block_max_scores_buffer_;
+    std::vector<float> max_score_in_dim_buffer_;
 
     SparseMetricType metric_type_;
+    PostingListEncoding posting_list_encoding_ = PostingListEncoding::RAW;
+
+    // if true, the rows of each Add() batch are reordered with GraphBisectionReorderer to get more compact posting
+    // lists. The doc ids of the posting lists are then internal ids, they are mapped back to the external ids, i.e.
+    // the positions of the rows in the added data, in the results.
+    bool doc_id_reordering_ = false;
+    // empty if the doc ids are not reordered.
+    std::vector<table_t> internal_to_external_ids_;
+    boost::span<const table_t> internal_to_external_ids_span_;
+    std::vector<table_t> external_to_internal_ids_;
 
     size_t n_rows_internal_ = 0;
     size_t max_dim_ = 0;
-    uint32_t next_dim_id_ = 0;
 
     char* map_ = nullptr;
     size_t map_byte_size_ = 0;
@@ -1392,8 +2843,17 @@ class InvertedIndex : public BaseInvertedIndex<DType> {
 
         DocValueComputer<float> max_score_computer;
 
-        BM25Params(float k1, float b, float avgdl)
-            : k1(k1), b(b), max_score_computer(GetDocValueBM25Computer<float>(k1, b, avgdl)) {
+        // if precompute_impacts, impacts[dim][pos] is the score of the posting pos of the posting list of dim by
+        // max_score_computer, floored to a multiple of impact_scale so that the max scores still bound it.
+        bool precompute_impacts;
+        float impact_scale = 0.0f;
+        std::vector<std::vector<uint8_t>> impacts;
+
+        BM25Params(float k1, float b, float avgdl, bool precompute_impacts)
+            : k1(k1),
+              b(b),
+              max_score_computer(GetDocValueBM25Computer<float>(k1, b, avgdl)),
+              precompute_impacts(precompute_impacts) {
         }
     };  // struct BM25Params
 
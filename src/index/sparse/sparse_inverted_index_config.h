@@ -23,7 +23,11 @@ class SparseInvertedIndexConfig : public BaseConfig {
     CFG_FLOAT drop_ratio_search;
     CFG_INT refine_factor;
     CFG_FLOAT dim_max_score_ratio;
+    CFG_FLOAT term_pruning_ratio;
     CFG_STRING inverted_index_algo;
+    CFG_BOOL posting_list_compression;
+    CFG_BOOL doc_id_reordering;
+    CFG_BOOL bm25_precompute_impacts;
     KNOHWERE_DECLARE_CONFIG(SparseInvertedIndexConfig) {
         // NOTE: drop_ratio_build has been deprecated, it won't change anything
         KNOWHERE_CONFIG_DECLARE_FIELD(drop_ratio_build)
@@ -81,24 +85,85 @@ class SparseInvertedIndexConfig : public BaseConfig {
             .set_default(1.05)
             .description("ratio to upscale/downscale the max score of each dimension")
             .for_search();
+        /**
+         * Used by DAAT_WAND, DAAT_MAXSCORE and DAAT_BMW only. If greater than
+         * 0, the search skips the query terms that can hardly change the
+         * top-k:
+         * 1. Before the search, the terms whose max contribution, query value
+         *    times the max score of the dim, is the smallest relative to the
+         *    length of their posting lists are dropped, as long as the max
+         *    contributions of the dropped terms sum up to at most
+         *    term_pruning_ratio of those of all terms.
+         * 2. During the search, DAAT_MAXSCORE stops probing the posting lists
+         *    of the non-essential terms whose max contribution is at most
+         *    term_pruning_ratio of the score of the k-th best doc so far.
+         * Unlike drop_ratio_search, the pruning accounts for the max scores
+         * and the cost of the posting lists, which suits long queries such as
+         * those of learned sparse embeddings.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(term_pruning_ratio)
+            .description("ratio of the max score of a query to prune as low yield query terms")
+            .set_default(0.0f)
+            .set_range(0.0f, 1.0f, true, false)
+            .for_search();
         KNOWHERE_CONFIG_DECLARE_FIELD(inverted_index_algo)
             .description("inverted index algorithm")
             .set_default("DAAT_MAXSCORE")
             .for_train()
             .for_deserialize()
             .for_deserialize_from_file();
+        /**
+         * If true, the doc ids of the posting lists are delta encoded and
+         * bit-packed in blocks when the index is serialized, and they are
+         * decoded on the fly during search after loading. This reduces the
+         * memory usage of a loaded index at a small cost of search latency.
+         * It has no effect on an index serialized with the raw data format.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(posting_list_compression)
+            .description("whether to compress the doc ids of the posting lists")
+            .set_default(false)
+            .for_train();
+        /**
+         * If true, the doc ids are reordered with recursive graph bisection
+         * when rows are added, so that docs sharing many dims get close doc
+         * ids. This makes the posting lists more compressible and speeds up
+         * DAAT search, at the cost of a slower build. Search results still
+         * use the original doc ids.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(doc_id_reordering)
+            .description("whether to reorder the doc ids to improve the locality of the posting lists")
+            .set_default(false)
+            .for_train();
+        /**
+         * If true, the BM25 term frequency part of the score of each posting
+         * is computed once with the k1, b and avgdl of the build/load config
+         * and kept quantized to 8 bits, so that search scores a posting with
+         * a single multiply-add instead of looking up the doc length and
+         * evaluating the BM25 formula. The impacts are not serialized, they
+         * are recomputed when the index is loaded. Search time k1 and b must
+         * then equal the load time ones, and search time avgdl is ignored.
+         * The scores are approximate, off by less than (k1 + 1) / 255 times
+         * the query value per term.
+         */
+        KNOWHERE_CONFIG_DECLARE_FIELD(bm25_precompute_impacts)
+            .description("whether to precompute the quantized BM25 scores of the postings")
+            .set_default(false)
+            .for_train()
+            .for_deserialize()
+            .for_deserialize_from_file();
     }
 
     Status
     CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
         if (param_type == PARAM_TYPE::TRAIN) {
-            constexpr std::array<std::string_view, 3> legal_inverted_index_algo_list{"TAAT_NAIVE", "DAAT_WAND",
-                                                                                     "DAAT_MAXSCORE"};
+            constexpr std::array<std::string_view, 4> legal_inverted_index_algo_list{"TAAT_NAIVE", "DAAT_WAND",
+                                                                                     "DAAT_MAXSCORE", "DAAT_BMW"};
             std::string inverted_index_algo_str = inverted_index_algo.value_or("");
             if (std::find(legal_inverted_index_algo_list.begin(), legal_inverted_index_algo_list.end(),
                           inverted_index_algo_str) == legal_inverted_index_algo_list.end()) {
-                std::string msg = "sparse inverted index algo " + inverted_index_algo_str +
-                                  " not found or not supported, supported: [TAAT_NAIVE DAAT_WAND DAAT_MAXSCORE]";
+                std::string msg =
+                    "sparse inverted index algo " + inverted_index_algo_str +
+                    " not found or not supported, supported: [TAAT_NAIVE DAAT_WAND DAAT_MAXSCORE DAAT_BMW]";
                 return HandleError(err_msg, msg, Status::invalid_args);
             }
         }
@@ -107,6 +172,56 @@ class SparseInvertedIndexConfig : public BaseConfig {
     }
 };  // class SparseInvertedIndexConfig
 
+class SparseClusteredIndexConfig : public SparseInvertedIndexConfig {
+ public:
+    CFG_INT posting_list_length;
+    CFG_FLOAT centroid_fraction;
+    CFG_FLOAT summary_energy;
+    CFG_INT query_cut;
+    CFG_FLOAT heap_factor;
+    CFG_INT block_budget;
+    KNOHWERE_DECLARE_CONFIG(SparseClusteredIndexConfig) {
+        // each posting list is statically pruned to its posting_list_length largest values.
+        KNOWHERE_CONFIG_DECLARE_FIELD(posting_list_length)
+            .description("max number of postings kept for each dimension")
+            .set_default(4000)
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_train();
+        // the pruned postings of a dimension are clustered into about
+        // posting_list_length * centroid_fraction blocks.
+        KNOWHERE_CONFIG_DECLARE_FIELD(centroid_fraction)
+            .description("number of blocks of each posting list relative to its length")
+            .set_default(0.1f)
+            .set_range(0.0f, 1.0f, false, true)
+            .for_train();
+        // a block is summarized by the component-wise max of its rows, only
+        // the largest summary values accounting for summary_energy of the
+        // total are kept.
+        KNOWHERE_CONFIG_DECLARE_FIELD(summary_energy)
+            .description("fraction of the L1 mass of a block summary that is kept")
+            .set_default(0.4f)
+            .set_range(0.0f, 1.0f, false, true)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(query_cut)
+            .description("number of largest query dimensions whose posting lists are visited")
+            .set_default(10)
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+        // a block is skipped if its summary score is less than the k-th best
+        // score divided by heap_factor, smaller values skip more blocks.
+        KNOWHERE_CONFIG_DECLARE_FIELD(heap_factor)
+            .description("how aggressively blocks are skipped based on their summary score")
+            .set_default(0.9f)
+            .set_range(0.0f, 1.0f, false, true)
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(block_budget)
+            .description("max number of blocks evaluated per query, 0 means no limit")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+    }
+};  // class SparseClusteredIndexConfig
+
 }  // namespace knowhere
 
 #endif  // SPARSE_INVERTED_INDEX_CONFIG_H
@@ -0,0 +1,235 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SPARSE_POSTING_LIST_H
+#define SPARSE_POSTING_LIST_H
+
+#include <algorithm>
+#include <boost/core/span.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "knowhere/sparse_utils.h"
+
+namespace knowhere::sparse {
+
+// Encoding of the doc ids in the posting lists section of a serialized InvertedIndex.
+enum class PostingListEncoding : uint32_t {
+    // doc ids are stored as raw table_t.
+    RAW = 0,
+    // doc ids are split into blocks of posting_block_size ids, the deltas of the ids in a block are bit-packed with
+    // the minimal bit width of that block.
+    BLOCK_PACKED = 1,
+};
+
+// Number of doc ids in a packed block. It is the same as the block size of the block max scores used by DAAT_BMW, so
+// that a skip entry and a block max score always cover the same postings.
+constexpr size_t posting_block_size = 64;
+
+// Skip entry of a packed block.
+struct PostingBlockHeader {
+    // last doc id of the block.
+    table_t last_id;
+    // offset of the packed deltas of the block, in uint32_t words relative to the packed data of the posting list.
+    uint32_t offset;
+    // bit width of each packed delta.
+    uint32_t bits;
+};
+
+struct BlockPackedPostingCodec {
+    // Appends the skip entries and the packed deltas of the sorted doc ids to headers and words. The offsets in the
+    // headers are relative to words.size() at the time of the call. A zero word is appended after the packed data so
+    // that decode() can always read one word past the end of a block.
+    static void
+    encode(const table_t* ids, size_t n, std::vector<PostingBlockHeader>& headers, std::vector<uint32_t>& words) {
+        if (n == 0) {
+            return;
+        }
+        const size_t words_begin = words.size();
+        table_t prev = 0;
+        for (size_t begin = 0; begin < n; begin += posting_block_size) {
+            const size_t cnt = std::min(posting_block_size, n - begin);
+            table_t max_delta = 0;
+            for (size_t i = 0; i < cnt; ++i) {
+                max_delta = std::max(max_delta, ids[begin + i] - (i == 0 ? prev : ids[begin + i - 1]));
+            }
+            const uint32_t bits = max_delta == 0 ? 0 : 32 - __builtin_clz(max_delta);
+            headers.push_back({ids[begin + cnt - 1], static_cast<uint32_t>(words.size() - words_begin), bits});
+
+            const size_t block_words = (cnt * bits + 31) / 32;
+            words.resize(words.size() + block_words, 0);
+            uint32_t* out = words.data() + words.size() - block_words;
+            for (size_t i = 0; i < cnt; ++i) {
+                const table_t delta = ids[begin + i] - prev;
+                prev = ids[begin + i];
+                const size_t pos = i * bits;
+                const uint32_t shift = pos & 31;
+                out[pos >> 5] |= delta << shift;
+                if (shift + bits > 32) {
+                    out[(pos >> 5) + 1] |= delta >> (32 - shift);
+                }
+            }
+        }
+        words.push_back(0);
+    }
+
+    // Decodes the cnt doc ids of a block into out. prev is the last doc id of the previous block, or 0 for the first
+    // block of a posting list.
+    static void
+    decode(const uint32_t* words, uint32_t bits, size_t cnt, table_t prev, table_t* out) {
+        if (bits == 0) {
+            std::fill(out, out + cnt, prev);
+            return;
+        }
+        // the unpacking of each delta is independent of the others so that the compiler can vectorize the loop, the
+        // prefix sum is done in a separate pass.
+        const uint64_t mask = (uint64_t(1) << bits) - 1;
+        for (size_t i = 0; i < cnt; ++i) {
+            const size_t pos = i * bits;
+            const uint64_t w = words[pos >> 5] | (uint64_t(words[(pos >> 5) + 1]) << 32);
+            out[i] = static_cast<table_t>((w >> (pos & 31)) & mask);
+        }
+        for (size_t i = 0; i < cnt; ++i) {
+            prev += out[i];
+            out[i] = prev;
+        }
+    }
+};
+
+// Read-only view of the doc ids of a posting list, either raw or block packed. Ids are accessed block by block: a raw
+// posting list returns a pointer into its storage, while a packed one decodes the block into a caller provided buffer
+// of posting_block_size ids.
+class PostingListIdsView {
+ public:
+    PostingListIdsView() = default;
+
+    explicit PostingListIdsView(boost::span<const table_t> ids) : raw_ids_(ids), size_(ids.size()) {
+    }
+
+    PostingListIdsView(boost::span<const PostingBlockHeader> headers, const uint32_t* words, size_t size)
+        : headers_(headers), words_(words), size_(size), packed_(true) {
+    }
+
+    [[nodiscard]] size_t
+    size() const {
+        return size_;
+    }
+
+    [[nodiscard]] bool
+    packed() const {
+        return packed_;
+    }
+
+    [[nodiscard]] size_t
+    num_blocks() const {
+        return (size_ + posting_block_size - 1) / posting_block_size;
+    }
+
+    [[nodiscard]] size_t
+    block_size(size_t block) const {
+        return std::min(posting_block_size, size_ - block * posting_block_size);
+    }
+
+    [[nodiscard]] table_t
+    block_last_id(size_t block) const {
+        if (packed_) {
+            return headers_[block].last_id;
+        }
+        return raw_ids_[block * posting_block_size + block_size(block) - 1];
+    }
+
+    const table_t*
+    block(size_t block, table_t* buf) const {
+        if (!packed_) {
+            return raw_ids_.data() + block * posting_block_size;
+        }
+        const auto& header = headers_[block];
+        BlockPackedPostingCodec::decode(words_ + header.offset, header.bits, block_size(block),
+                                        block == 0 ? 0 : headers_[block - 1].last_id, buf);
+        return buf;
+    }
+
+    // position of doc id id, or size() if the posting list does not contain it.
+    [[nodiscard]] size_t
+    find(table_t id) const {
+        size_t lo = 0, hi = num_blocks();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (block_last_id(mid) < id) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == num_blocks()) {
+            return size_;
+        }
+        table_t buf[posting_block_size];
+        const table_t* ids = block(lo, buf);
+        const table_t* it = std::lower_bound(ids, ids + block_size(lo), id);
+        return *it == id ? lo * posting_block_size + (it - ids) : size_;
+    }
+
+    // calls f(pos, id) for every doc id of the posting list in order.
+    template <typename F>
+    void
+    for_each(F&& f) const {
+        table_t buf[posting_block_size];
+        for (size_t b = 0; b < num_blocks(); ++b) {
+            const table_t* ids = block(b, buf);
+            for (size_t j = 0; j < block_size(b); ++j) {
+                f(b * posting_block_size + j, ids[j]);
+            }
+        }
+    }
+
+    // byte size of the doc ids.
+    [[nodiscard]] size_t
+    byte_size() const {
+        if (!packed_) {
+            return size_ * sizeof(table_t);
+        }
+        if (headers_.empty()) {
+            return 0;
+        }
+        const auto& last = headers_.back();
+        const size_t words = last.offset + (block_size(headers_.size() - 1) * last.bits + 31) / 32 + 1;
+        return headers_.size() * sizeof(PostingBlockHeader) + words * sizeof(uint32_t);
+    }
+
+    // calls f(data, bytes) for the buffers that the doc ids are read from: the raw ids, or the block headers and the
+    // packed words.
+    template <typename F>
+    void
+    for_each_buffer(F&& f) const {
+        if (!packed_) {
+            f(static_cast<const void*>(raw_ids_.data()), size_ * sizeof(table_t));
+            return;
+        }
+        if (headers_.empty()) {
+            return;
+        }
+        const size_t headers_bytes = headers_.size() * sizeof(PostingBlockHeader);
+        f(static_cast<const void*>(headers_.data()), headers_bytes);
+        f(static_cast<const void*>(words_), byte_size() - headers_bytes);
+    }
+
+ private:
+    boost::span<const table_t> raw_ids_;
+    boost::span<const PostingBlockHeader> headers_;
+    const uint32_t* words_ = nullptr;
+    size_t size_ = 0;
+    bool packed_ = false;
+};
+
+}  // namespace knowhere::sparse
+
+#endif  // SPARSE_POSTING_LIST_H
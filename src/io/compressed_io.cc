@@ -0,0 +1,211 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "io/compressed_io.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "knowhere/log.h"
+#include "xxhash.h"
+
+namespace knowhere {
+
+namespace {
+
+constexpr char kMagic[8] = {'K', 'N', 'W', 'H', 'Z', 'S', 'T', 'D'};
+constexpr uint32_t kFormatVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t chunk_size;
+    uint64_t raw_size;
+};
+
+struct ChunkHeader {
+    uint32_t compressed_size;
+    uint32_t raw_size;
+    uint64_t checksum;
+};
+
+std::atomic<int> binary_compression_level{0};
+
+}  // namespace
+
+CompressedIOWriter::CompressedIOWriter(int level, size_t chunk_size, faiss::IOWriter* sink)
+    : sink_(sink != nullptr ? sink : &out_), level_(level), chunk_size_(chunk_size), cctx_(ZSTD_createCCtx()) {
+    KNOWHERE_THROW_IF_NOT_MSG(cctx_ != nullptr, "failed to create the zstd context");
+    // the header is completed by Finish()
+    FileHeader header{};
+    Write(&header, sizeof(header));
+    chunk_.reserve(chunk_size_);
+    compressed_.resize(ZSTD_compressBound(chunk_size_));
+}
+
+CompressedIOWriter::~CompressedIOWriter() {
+    ZSTD_freeCCtx(cctx_);
+}
+
+size_t
+CompressedIOWriter::operator()(const void* ptr, size_t size, size_t nitems) {
+    auto src = static_cast<const uint8_t*>(ptr);
+    size_t remaining = size * nitems;
+    while (remaining > 0) {
+        if (chunk_.empty() && remaining >= chunk_size_) {
+            // the whole chunks of a large write are compressed from the caller's buffer
+            WriteChunk(src, chunk_size_);
+            src += chunk_size_;
+            remaining -= chunk_size_;
+            continue;
+        }
+        const size_t n = std::min(remaining, chunk_size_ - chunk_.size());
+        chunk_.insert(chunk_.end(), src, src + n);
+        src += n;
+        remaining -= n;
+        if (chunk_.size() == chunk_size_) {
+            WriteChunk(chunk_.data(), chunk_.size());
+            chunk_.clear();
+        }
+    }
+    return nitems;
+}
+
+void
+CompressedIOWriter::Finish() {
+    if (!chunk_.empty()) {
+        WriteChunk(chunk_.data(), chunk_.size());
+        chunk_.clear();
+    }
+    if (sink_ == &out_) {
+        const auto header = Header();
+        std::memcpy(out_.data(), header.data(), header.size());
+    }
+}
+
+std::vector<uint8_t>
+CompressedIOWriter::Header() const {
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.format_version = kFormatVersion;
+    header.chunk_size = static_cast<uint32_t>(chunk_size_);
+    header.raw_size = raw_size_;
+    const auto bytes = reinterpret_cast<const uint8_t*>(&header);
+    return std::vector<uint8_t>(bytes, bytes + sizeof(header));
+}
+
+void
+CompressedIOWriter::Write(const void* ptr, size_t size) {
+    KNOWHERE_THROW_IF_NOT_MSG((*sink_)(ptr, size, 1) == 1, "failed to write a compressed binary");
+    written_ += size;
+}
+
+void
+CompressedIOWriter::WriteChunk(const uint8_t* raw, size_t size) {
+    const size_t compressed_size =
+        ZSTD_compressCCtx(cctx_, compressed_.data(), compressed_.size(), raw, size, level_);
+    KNOWHERE_THROW_IF_NOT_FMT(!ZSTD_isError(compressed_size), "zstd compression failed: %s",
+                              ZSTD_getErrorName(compressed_size));
+    ChunkHeader header{static_cast<uint32_t>(compressed_size), static_cast<uint32_t>(size), XXH3_64bits(raw, size)};
+    Write(&header, sizeof(header));
+    Write(compressed_.data(), compressed_size);
+    raw_size_ += size;
+}
+
+CompressedIOReader::CompressedIOReader(const uint8_t* data, size_t size, std::shared_ptr<void> owner)
+    : owner_(std::move(owner)), data_(data), size_(size), dctx_(ZSTD_createDCtx()) {
+    KNOWHERE_THROW_IF_NOT_MSG(dctx_ != nullptr, "failed to create the zstd context");
+    KNOWHERE_THROW_IF_NOT_MSG(IsCompressedBinary(data, size), "not a compressed binary");
+    FileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    KNOWHERE_THROW_IF_NOT_FMT(header.format_version == kFormatVersion, "unsupported compressed binary format %u",
+                              header.format_version);
+    raw_size_ = header.raw_size;
+    chunk_.resize(header.chunk_size);
+    pos_ = sizeof(header);
+}
+
+CompressedIOReader::~CompressedIOReader() {
+    ZSTD_freeDCtx(dctx_);
+}
+
+size_t
+CompressedIOReader::operator()(void* ptr, size_t size, size_t nitems) {
+    if (size == 0) {
+        return 0;
+    }
+    nitems = std::min<uint64_t>(nitems, (raw_size_ - raw_read_) / size);
+    auto dst = static_cast<uint8_t*>(ptr);
+    size_t remaining = size * nitems;
+    while (remaining > 0) {
+        if (chunk_pos_ < chunk_len_) {
+            const size_t n = std::min(remaining, chunk_len_ - chunk_pos_);
+            std::memcpy(dst, chunk_.data() + chunk_pos_, n);
+            chunk_pos_ += n;
+            dst += n;
+            remaining -= n;
+        } else if (NextChunkRawSize() <= remaining) {
+            const size_t n = ReadChunk(dst);
+            dst += n;
+            remaining -= n;
+        } else {
+            chunk_len_ = ReadChunk(chunk_.data());
+            chunk_pos_ = 0;
+        }
+    }
+    raw_read_ += size * nitems;
+    return nitems;
+}
+
+size_t
+CompressedIOReader::NextChunkRawSize() const {
+    KNOWHERE_THROW_IF_NOT_MSG(pos_ + sizeof(ChunkHeader) <= size_, "truncated compressed binary");
+    ChunkHeader header;
+    std::memcpy(&header, data_ + pos_, sizeof(header));
+    return header.raw_size;
+}
+
+size_t
+CompressedIOReader::ReadChunk(uint8_t* dst) {
+    KNOWHERE_THROW_IF_NOT_MSG(pos_ + sizeof(ChunkHeader) <= size_, "truncated compressed binary");
+    ChunkHeader header;
+    std::memcpy(&header, data_ + pos_, sizeof(header));
+    pos_ += sizeof(header);
+    KNOWHERE_THROW_IF_NOT_MSG(pos_ + header.compressed_size <= size_ && header.raw_size <= chunk_.size(),
+                              "corrupted compressed binary");
+    const size_t raw_size = ZSTD_decompressDCtx(dctx_, dst, header.raw_size, data_ + pos_, header.compressed_size);
+    KNOWHERE_THROW_IF_NOT_FMT(!ZSTD_isError(raw_size), "zstd decompression failed: %s", ZSTD_getErrorName(raw_size));
+    KNOWHERE_THROW_IF_NOT_MSG(raw_size == header.raw_size && XXH3_64bits(dst, raw_size) == header.checksum,
+                              "checksum mismatch of a compressed binary chunk");
+    pos_ += header.compressed_size;
+    return raw_size;
+}
+
+bool
+IsCompressedBinary(const uint8_t* data, size_t size) {
+    return data != nullptr && size >= sizeof(FileHeader) && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+void
+SetBinaryCompressionLevel(int level) {
+    binary_compression_level.store(level);
+}
+
+int
+GetBinaryCompressionLevel() {
+    return binary_compression_level.load();
+}
+
+}  // namespace knowhere
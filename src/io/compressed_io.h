@@ -0,0 +1,121 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <faiss/impl/io.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "io/memory_io.h"
+
+typedef struct ZSTD_CCtx_s ZSTD_CCtx;
+typedef struct ZSTD_DCtx_s ZSTD_DCtx;
+
+namespace knowhere {
+
+// The compressed binary of an index: a header of the magic, the format version, the raw size and the chunk size,
+// followed by chunks of at most chunk size raw bytes, each a zstd frame headed by its compressed size, its raw size
+// and the XXH3 checksum of its raw bytes. It is only found in the data section of a container (see io/container.h).
+constexpr size_t kCompressedChunkSize = 1UL << 20;
+
+// Writes a binary as compressed chunks, into its own buffer, or passing them on to a sink. The binary is complete after
+// Finish(), except that the header that starts the binary of a sink is only written as a placeholder: the owner of the
+// sink overwrites it with Header().
+class CompressedIOWriter : public faiss::IOWriter {
+ public:
+    explicit CompressedIOWriter(int level, size_t chunk_size = kCompressedChunkSize, faiss::IOWriter* sink = nullptr);
+    ~CompressedIOWriter() override;
+
+    size_t
+    operator()(const void* ptr, size_t size, size_t nitems) override;
+
+    void
+    Finish();
+
+    // the header of the binary, valid after Finish()
+    std::vector<uint8_t>
+    Header() const;
+
+    // the binary, null with a sink
+    uint8_t*
+    data() const {
+        return out_.data();
+    }
+
+    size_t
+    tellg() const {
+        return written_;
+    }
+
+ private:
+    void
+    WriteChunk(const uint8_t* raw, size_t size);
+
+    void
+    Write(const void* ptr, size_t size);
+
+    MemoryIOWriter out_;
+    faiss::IOWriter* sink_;
+    size_t written_ = 0;
+    const int level_;
+    const size_t chunk_size_;
+    ZSTD_CCtx* cctx_;
+    // the raw bytes of the next chunk, and the compressed bytes of the last one
+    std::vector<uint8_t> chunk_;
+    std::vector<uint8_t> compressed_;
+    uint64_t raw_size_ = 0;
+};
+
+// Reads a compressed binary, decompressing its chunks as they are read: the reads that take a whole chunk have it
+// decompressed into their buffer, the others are served from one chunk buffer. Throws on a corrupted chunk.
+class CompressedIOReader : public faiss::IOReader {
+ public:
+    // owner, if any, is kept alive with the reader, for data to stay valid
+    CompressedIOReader(const uint8_t* data, size_t size, std::shared_ptr<void> owner = nullptr);
+    ~CompressedIOReader() override;
+
+    size_t
+    operator()(void* ptr, size_t size, size_t nitems) override;
+
+ private:
+    // decompresses the next chunk into dst, of at least its raw size, and returns the raw size
+    size_t
+    ReadChunk(uint8_t* dst);
+
+    size_t
+    NextChunkRawSize() const;
+
+    std::shared_ptr<void> owner_;
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    ZSTD_DCtx* dctx_;
+    uint64_t raw_size_ = 0;
+    uint64_t raw_read_ = 0;
+    std::vector<uint8_t> chunk_;
+    size_t chunk_pos_ = 0;
+    size_t chunk_len_ = 0;
+};
+
+bool
+IsCompressedBinary(const uint8_t* data, size_t size);
+
+// The zstd level of the index binaries, 0 for uncompressed (the default).
+void
+SetBinaryCompressionLevel(int level);
+
+int
+GetBinaryCompressionLevel();
+
+}  // namespace knowhere
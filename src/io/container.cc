@@ -0,0 +1,326 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "io/container.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "knowhere/log.h"
+#include "xxhash.h"
+
+namespace knowhere {
+
+namespace {
+
+constexpr char kMagic[8] = {'K', 'N', 'W', 'H', 'C', 'N', 'T', 'R'};
+
+size_t
+AlignUp(size_t size) {
+    return (size + kContainerAlignment - 1) / kContainerAlignment * kContainerAlignment;
+}
+
+uint64_t
+TableChecksum(const SectionEntry* table, size_t num_sections) {
+    return XXH3_64bits(table, num_sections * sizeof(SectionEntry));
+}
+
+// the header and the section table, that make the first page of a container
+void
+WriteFirstPage(const std::vector<SectionEntry>& table, uint8_t* page) {
+    ContainerHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.format_version = kContainerFormatVersion;
+    header.num_sections = static_cast<uint32_t>(table.size());
+    header.table_checksum = TableChecksum(table.data(), table.size());
+    std::memcpy(page, &header, sizeof(header));
+    std::memcpy(page + sizeof(header), table.data(), table.size() * sizeof(SectionEntry));
+}
+
+ContainerIndexHeader
+MakeIndexHeader(const std::string& index_type, int32_t version) {
+    ContainerIndexHeader header{};
+    KNOWHERE_THROW_IF_NOT_FMT(index_type.size() < sizeof(header.index_type), "index type %s is too long",
+                              index_type.c_str());
+    std::memcpy(header.index_type, index_type.data(), index_type.size());
+    header.version = version;
+    return header;
+}
+
+using ChecksumState = std::unique_ptr<XXH3_state_t, decltype(&XXH3_freeState)>;
+
+ChecksumState
+MakeChecksumState() {
+    ChecksumState state(XXH3_createState(), &XXH3_freeState);
+    KNOWHERE_THROW_IF_NOT_MSG(state != nullptr && XXH3_64bits_reset(state.get()) == XXH_OK,
+                              "failed to create the checksum state");
+    return state;
+}
+
+// the checksum of size bytes at offset in a file, read in chunks
+uint64_t
+FileChecksum(FILE* f, uint64_t offset, uint64_t size) {
+    auto state = MakeChecksumState();
+    KNOWHERE_THROW_IF_NOT_MSG(std::fseek(f, offset, SEEK_SET) == 0, "failed to seek an index file");
+    std::vector<uint8_t> chunk(std::min<uint64_t>(size, 1UL << 20));
+    for (uint64_t remaining = size; remaining > 0;) {
+        const size_t n = std::min<uint64_t>(remaining, chunk.size());
+        KNOWHERE_THROW_IF_NOT_MSG(std::fread(chunk.data(), n, 1, f) == 1, "failed to read an index file");
+        XXH3_64bits_update(state.get(), chunk.data(), n);
+        remaining -= n;
+    }
+    return XXH3_64bits_digest(state.get());
+}
+
+}  // namespace
+
+void
+ContainerWriter::AddSection(SectionType type, uint32_t flags, const uint8_t* data, size_t size) {
+    KNOWHERE_THROW_IF_NOT_MSG(sections_.size() < kMaxContainerSections, "too many sections in a container");
+    SectionEntry entry{};
+    entry.type = static_cast<uint32_t>(type);
+    entry.flags = flags;
+    entry.size = size;
+    entry.checksum = XXH3_64bits(data, size);
+    sections_.push_back({entry, data});
+}
+
+void
+ContainerWriter::AddIndexHeader(const std::string& index_type, int32_t version) {
+    index_header_ = MakeIndexHeader(index_type, version);
+    AddSection(SectionType::INDEX_HEADER, 0, reinterpret_cast<const uint8_t*>(&index_header_), sizeof(index_header_));
+}
+
+std::pair<std::shared_ptr<uint8_t[]>, size_t>
+ContainerWriter::Finish() {
+    size_t size = kContainerAlignment;
+    for (auto& section : sections_) {
+        section.entry.offset = size;
+        size = AlignUp(size + section.entry.size);
+    }
+
+    std::shared_ptr<uint8_t[]> data(new uint8_t[size]);
+    std::memset(data.get(), 0, size);
+    std::vector<SectionEntry> table;
+    table.reserve(sections_.size());
+    for (const auto& section : sections_) {
+        table.push_back(section.entry);
+        if (section.entry.size > 0) {
+            std::memcpy(data.get() + section.entry.offset, section.data, section.entry.size);
+        }
+    }
+
+    WriteFirstPage(table, data.get());
+    sections_.clear();
+    return {data, size};
+}
+
+// writes the data of a section to the file, through its checksum
+class ContainerFileWriter::SectionWriter : public faiss::IOWriter {
+ public:
+    SectionWriter(FILE* f, SectionType type, uint32_t flags, uint64_t offset) : f_(f), state_(MakeChecksumState()) {
+        entry_.type = static_cast<uint32_t>(type);
+        entry_.flags = flags;
+        entry_.offset = offset;
+    }
+
+    size_t
+    operator()(const void* ptr, size_t size, size_t nitems) override {
+        const size_t written = std::fwrite(ptr, size, nitems, f_);
+        XXH3_64bits_update(state_.get(), ptr, size * written);
+        entry_.size += size * written;
+        return written;
+    }
+
+    SectionEntry
+    End() {
+        entry_.checksum = patched_ ? FileChecksum(f_, entry_.offset, entry_.size) : XXH3_64bits_digest(state_.get());
+        return entry_;
+    }
+
+    SectionEntry entry_{};
+    bool patched_ = false;
+
+ private:
+    FILE* f_;
+    ChecksumState state_;
+};
+
+ContainerFileWriter::ContainerFileWriter(FILE* f) : f_(f) {
+    // the first page is written by Finish()
+    std::vector<uint8_t> page(kContainerAlignment, 0);
+    KNOWHERE_THROW_IF_NOT_MSG(std::fwrite(page.data(), page.size(), 1, f_) == 1, "failed to write an index file");
+}
+
+ContainerFileWriter::~ContainerFileWriter() = default;
+
+void
+ContainerFileWriter::AddIndexHeader(const std::string& index_type, int32_t version) {
+    const auto header = MakeIndexHeader(index_type, version);
+    auto writer = BeginSection(SectionType::INDEX_HEADER, 0);
+    KNOWHERE_THROW_IF_NOT_MSG((*writer)(&header, sizeof(header), 1) == 1, "failed to write an index file");
+    EndSection();
+}
+
+faiss::IOWriter*
+ContainerFileWriter::BeginSection(SectionType type, uint32_t flags) {
+    KNOWHERE_THROW_IF_NOT_MSG(section_ == nullptr, "a section of the container is being written");
+    KNOWHERE_THROW_IF_NOT_MSG(sections_.size() < kMaxContainerSections, "too many sections in a container");
+    const long offset = std::ftell(f_);
+    KNOWHERE_THROW_IF_NOT_MSG(offset >= 0 && offset % kContainerAlignment == 0, "invalid offset of a section");
+    section_ = std::make_unique<SectionWriter>(f_, type, flags, offset);
+    return section_.get();
+}
+
+void
+ContainerFileWriter::Patch(size_t offset, const void* data, size_t size) {
+    KNOWHERE_THROW_IF_NOT_MSG(section_ != nullptr && offset + size <= section_->entry_.size,
+                              "invalid patch of a section of the container");
+    const long end = std::ftell(f_);
+    KNOWHERE_THROW_IF_NOT_MSG(std::fseek(f_, section_->entry_.offset + offset, SEEK_SET) == 0 &&
+                                  std::fwrite(data, size, 1, f_) == 1 && std::fseek(f_, end, SEEK_SET) == 0,
+                              "failed to patch an index file");
+    section_->patched_ = true;
+}
+
+void
+ContainerFileWriter::EndSection() {
+    KNOWHERE_THROW_IF_NOT_MSG(section_ != nullptr, "no section of the container is being written");
+    const auto entry = section_->End();
+    section_.reset();
+    sections_.push_back(entry);
+    // the next section starts on the next page
+    const uint64_t end = entry.offset + entry.size;
+    std::vector<uint8_t> padding(AlignUp(end) - end, 0);
+    KNOWHERE_THROW_IF_NOT_MSG(std::fseek(f_, end, SEEK_SET) == 0 &&
+                                  (padding.empty() || std::fwrite(padding.data(), padding.size(), 1, f_) == 1),
+                              "failed to write an index file");
+}
+
+void
+ContainerFileWriter::Finish() {
+    KNOWHERE_THROW_IF_NOT_MSG(section_ == nullptr, "a section of the container is being written");
+    std::vector<uint8_t> page(kContainerAlignment, 0);
+    WriteFirstPage(sections_, page.data());
+    KNOWHERE_THROW_IF_NOT_MSG(std::fseek(f_, 0, SEEK_SET) == 0 && std::fwrite(page.data(), page.size(), 1, f_) == 1 &&
+                                  std::fseek(f_, 0, SEEK_END) == 0,
+                              "failed to write an index file");
+}
+
+bool
+ContainerReader::IsContainer(const uint8_t* data, size_t size) {
+    return data != nullptr && size >= kContainerAlignment && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool
+ContainerReader::IsContainer(FILE* f) {
+    char magic[sizeof(kMagic)];
+    const long pos = std::ftell(f);
+    const bool is_container = std::fseek(f, 0, SEEK_SET) == 0 && std::fread(magic, sizeof(magic), 1, f) == 1 &&
+                              std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    std::fseek(f, pos, SEEK_SET);
+    return is_container;
+}
+
+ContainerReader::ContainerReader(const uint8_t* data, size_t size) {
+    KNOWHERE_THROW_IF_NOT_MSG(IsContainer(data, size), "not an index container");
+    Parse(data, size);
+}
+
+ContainerReader::ContainerReader(FILE* f, size_t size) {
+    std::vector<uint8_t> table(kContainerAlignment);
+    KNOWHERE_THROW_IF_NOT_MSG(size >= kContainerAlignment && std::fseek(f, 0, SEEK_SET) == 0 &&
+                                  std::fread(table.data(), table.size(), 1, f) == 1,
+                              "failed to read the section table of an index container");
+    KNOWHERE_THROW_IF_NOT_MSG(IsContainer(table.data(), size), "not an index container");
+    Parse(table.data(), size);
+}
+
+void
+ContainerReader::Parse(const uint8_t* table, size_t size) {
+    ContainerHeader header;
+    std::memcpy(&header, table, sizeof(header));
+    KNOWHERE_THROW_IF_NOT_FMT(header.format_version == kContainerFormatVersion,
+                              "unsupported index container format %u", header.format_version);
+    KNOWHERE_THROW_IF_NOT_FMT(header.num_sections <= kMaxContainerSections, "invalid section count %u",
+                              header.num_sections);
+    sections_.resize(header.num_sections);
+    std::memcpy(sections_.data(), table + sizeof(header), sections_.size() * sizeof(SectionEntry));
+    KNOWHERE_THROW_IF_NOT_MSG(TableChecksum(sections_.data(), sections_.size()) == header.table_checksum,
+                              "checksum mismatch of the section table of an index container");
+    for (const auto& section : sections_) {
+        KNOWHERE_THROW_IF_NOT_MSG(section.offset % kContainerAlignment == 0 && section.offset <= size &&
+                                      section.size <= size - section.offset,
+                                  "invalid section in an index container");
+    }
+}
+
+const SectionEntry*
+ContainerReader::Find(SectionType type) const {
+    for (const auto& section : sections_) {
+        if (section.type == static_cast<uint32_t>(type)) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+const SectionEntry&
+ContainerReader::Get(SectionType type) const {
+    const auto* section = Find(type);
+    KNOWHERE_THROW_IF_NOT_FMT(section != nullptr, "section %u is missing from the index container",
+                              static_cast<uint32_t>(type));
+    return *section;
+}
+
+void
+ContainerReader::CheckIndexHeader(const uint8_t* data, const std::string& index_type) const {
+    const auto& section = Get(SectionType::INDEX_HEADER);
+    KNOWHERE_THROW_IF_NOT_MSG(section.size == sizeof(ContainerIndexHeader), "invalid index header");
+    Verify(section, data);
+    ContainerIndexHeader header;
+    std::memcpy(&header, data + section.offset, sizeof(header));
+    CheckIndexType(header, index_type);
+}
+
+void
+ContainerReader::CheckIndexHeader(FILE* f, const std::string& index_type) const {
+    const auto& section = Get(SectionType::INDEX_HEADER);
+    KNOWHERE_THROW_IF_NOT_MSG(section.size == sizeof(ContainerIndexHeader), "invalid index header");
+    ContainerIndexHeader header;
+    KNOWHERE_THROW_IF_NOT_MSG(std::fseek(f, section.offset, SEEK_SET) == 0 &&
+                                  std::fread(&header, sizeof(header), 1, f) == 1,
+                              "failed to read the index header of an index container");
+    KNOWHERE_THROW_IF_NOT_MSG(XXH3_64bits(&header, sizeof(header)) == section.checksum,
+                              "checksum mismatch of the index header of an index container");
+    CheckIndexType(header, index_type);
+}
+
+void
+ContainerReader::CheckIndexType(const ContainerIndexHeader& header, const std::string& index_type) {
+    const std::string type(header.index_type, strnlen(header.index_type, sizeof(header.index_type)));
+    KNOWHERE_THROW_IF_NOT_FMT(type == index_type, "the index container holds a %s index, not a %s index",
+                              type.c_str(), index_type.c_str());
+}
+
+void
+ContainerReader::Verify(const SectionEntry& section, FILE* f) {
+    KNOWHERE_THROW_IF_NOT_FMT(FileChecksum(f, section.offset, section.size) == section.checksum,
+                              "checksum mismatch of section %u of an index container", section.type);
+}
+
+void
+ContainerReader::Verify(const SectionEntry& section, const uint8_t* data) {
+    KNOWHERE_THROW_IF_NOT_FMT(XXH3_64bits(data + section.offset, section.size) == section.checksum,
+                              "checksum mismatch of section %u of an index container", section.type);
+}
+
+}  // namespace knowhere
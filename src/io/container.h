@@ -0,0 +1,178 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <faiss/impl/io.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace knowhere {
+
+// The container of the serialized data of an index, laid out to be mapped as is:
+//
+//   ContainerHeader | SectionEntry[num_sections] | padding | section | padding | section ...
+//
+// Every section starts on a kContainerAlignment boundary, so that the arrays of a mapped section are as aligned as
+// they would be in memory, and is covered by the XXH3 checksum of its entry. The header covers the section table
+// with its own checksum, so that a container is opened by reading its first page, without parsing or reading its
+// sections. All the fields are little-endian.
+constexpr size_t kContainerAlignment = 4096;
+constexpr uint32_t kContainerFormatVersion = 1;
+
+enum class SectionType : uint32_t {
+    // a ContainerIndexHeader
+    INDEX_HEADER = 1,
+    // the serialized index
+    INDEX_DATA = 2,
+};
+
+// the section holds a compressed binary, see CompressedIOWriter
+constexpr uint32_t kSectionCompressed = 0x1;
+
+struct ContainerHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t num_sections;
+    uint64_t table_checksum;
+    uint64_t reserved;
+};
+
+struct SectionEntry {
+    uint32_t type;
+    uint32_t flags;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+// the typed header of the index of a container
+struct ContainerIndexHeader {
+    char index_type[64];
+    int32_t version;
+    uint32_t reserved;
+};
+
+// the sections of a container must fit in its first page
+constexpr size_t kMaxContainerSections = (kContainerAlignment - sizeof(ContainerHeader)) / sizeof(SectionEntry);
+
+// Builds a container out of sections, which are copied once by Finish().
+class ContainerWriter {
+ public:
+    // data must stay valid until Finish()
+    void
+    AddSection(SectionType type, uint32_t flags, const uint8_t* data, size_t size);
+
+    void
+    AddIndexHeader(const std::string& index_type, int32_t version);
+
+    // the container and its size
+    std::pair<std::shared_ptr<uint8_t[]>, size_t>
+    Finish();
+
+ private:
+    struct Pending {
+        SectionEntry entry;
+        const uint8_t* data;
+    };
+    std::vector<Pending> sections_;
+    ContainerIndexHeader index_header_{};
+};
+
+// Writes a container to a file, streaming the data of its sections: the first page, of the section table, is written
+// by Finish() once the sections are. The file must be open for reading and writing, at its start.
+class ContainerFileWriter {
+ public:
+    explicit ContainerFileWriter(FILE* f);
+    ~ContainerFileWriter();
+
+    void
+    AddIndexHeader(const std::string& index_type, int32_t version);
+
+    // starts a section and returns the writer of its data, valid until EndSection()
+    faiss::IOWriter*
+    BeginSection(SectionType type, uint32_t flags);
+
+    // overwrites size bytes at offset in the data of the section being written, which is then read back from the
+    // file for its checksum
+    void
+    Patch(size_t offset, const void* data, size_t size);
+
+    void
+    EndSection();
+
+    void
+    Finish();
+
+ private:
+    class SectionWriter;
+
+    FILE* f_;
+    std::unique_ptr<SectionWriter> section_;
+    std::vector<SectionEntry> sections_;
+};
+
+// The section table of a container. It is checked when read, the sections are not.
+class ContainerReader {
+ public:
+    static bool
+    IsContainer(const uint8_t* data, size_t size);
+
+    // whether the file starts with a container
+    static bool
+    IsContainer(FILE* f);
+
+    // reads the table of the container of size bytes at data, throws if it is invalid
+    ContainerReader(const uint8_t* data, size_t size);
+
+    // reads the table of the container of the file, of size bytes, throws if it is invalid
+    ContainerReader(FILE* f, size_t size);
+
+    // the section of a type, nullptr if there is none
+    const SectionEntry*
+    Find(SectionType type) const;
+
+    // the section of a type, throws if there is none
+    const SectionEntry&
+    Get(SectionType type) const;
+
+    // throws if the index header of the container at data, or of the file, is corrupted or not of the index type
+    void
+    CheckIndexHeader(const uint8_t* data, const std::string& index_type) const;
+
+    void
+    CheckIndexHeader(FILE* f, const std::string& index_type) const;
+
+    // throws if the checksum of the section of data, the start of the container, does not match
+    static void
+    Verify(const SectionEntry& section, const uint8_t* data);
+
+    // reads the section of the file, in chunks, through its checksum
+    static void
+    Verify(const SectionEntry& section, FILE* f);
+
+ private:
+    void
+    Parse(const uint8_t* table, size_t size);
+
+    static void
+    CheckIndexType(const ContainerIndexHeader& header, const std::string& index_type);
+
+    std::vector<SectionEntry> sections_;
+};
+
+}  // namespace knowhere
@@ -0,0 +1,200 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "io/index_binary.h"
+
+#include <faiss/impl/mapped_io.h>
+#include <faiss/index_io.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "io/compressed_io.h"
+#include "io/container.h"
+#include "io/memory_io.h"
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+namespace {
+
+bool
+IsContainerVersion(const Version& version) {
+    return Version(kContainerMinVersion) <= version;
+}
+
+// appends the serialized data of an index, wrapped in a container if the index version reads it
+void
+AppendIndexData(BinarySet& binset, const std::string& index_type, const Version& version,
+                const std::shared_ptr<uint8_t[]>& data, size_t size, uint32_t flags) {
+    if (!IsContainerVersion(version)) {
+        binset.Append(index_type, data, size);
+        return;
+    }
+    ContainerWriter writer;
+    writer.AddIndexHeader(index_type, version.VersionNumber());
+    writer.AddSection(SectionType::INDEX_DATA, flags, data.get(), size);
+    auto [container, container_size] = writer.Finish();
+    binset.Append(index_type, container, container_size);
+}
+
+size_t
+FileSize(FILE* f) {
+    KNOWHERE_THROW_IF_NOT_MSG(std::fseek(f, 0, SEEK_END) == 0, "failed to seek an index file");
+    const long size = std::ftell(f);
+    KNOWHERE_THROW_IF_NOT_MSG(size >= 0, "failed to get the size of an index file");
+    return size;
+}
+
+}  // namespace
+
+void
+AppendIndexBinary(BinarySet& binset, const std::string& index_type, const Version& version,
+                  const std::function<void(faiss::IOWriter*)>& write) {
+    const int level = GetBinaryCompressionLevel();
+    if (level != 0 && IsContainerVersion(version)) {
+        CompressedIOWriter writer(level);
+        write(&writer);
+        writer.Finish();
+        std::shared_ptr<uint8_t[]> data(writer.data());
+        AppendIndexData(binset, index_type, version, data, writer.tellg(), kSectionCompressed);
+        return;
+    }
+    MemoryIOWriter writer;
+    write(&writer);
+    std::shared_ptr<uint8_t[]> data(writer.data());
+    AppendIndexData(binset, index_type, version, data, writer.tellg(), 0);
+}
+
+void
+AppendIndexBinary(BinarySet& binset, const std::string& index_type, const Version& version,
+                  const std::shared_ptr<uint8_t[]>& data, size_t size) {
+    AppendIndexData(binset, index_type, version, data, size, 0);
+}
+
+std::unique_ptr<faiss::IOReader>
+MakeIndexBinaryReader(const BinaryPtr& binary, const Version& version, const std::string& index_type, bool zero_copy) {
+    const uint8_t* begin = binary->data.get();
+    size_t offset = 0;
+    size_t size = binary->size;
+    bool compressed = false;
+    if (IsContainerVersion(version) && ContainerReader::IsContainer(begin, size)) {
+        ContainerReader container(begin, size);
+        container.CheckIndexHeader(begin, index_type);
+        const auto& section = container.Get(SectionType::INDEX_DATA);
+        // the chunks of a compressed section have checksums of their own
+        compressed = (section.flags & kSectionCompressed) != 0;
+        if (!compressed) {
+            ContainerReader::Verify(section, begin);
+        }
+        offset = section.offset;
+        size = section.size;
+    }
+
+    if (compressed) {
+        if (zero_copy) {
+            LOG_KNOWHERE_INFO_ << "the binary is compressed, it is decompressed instead of read zero-copy";
+        }
+        return std::make_unique<CompressedIOReader>(begin + offset, size);
+    }
+    if (zero_copy) {
+        return std::make_unique<ZeroCopyBinaryReader>(binary->data, size, offset);
+    }
+    return std::make_unique<MemoryIOReader>(binary->data.get() + offset, size);
+}
+
+std::pair<const uint8_t*, size_t>
+GetIndexData(const uint8_t* data, size_t size, const Version& version, const std::string& index_type, bool verify) {
+    if (!IsContainerVersion(version) || !ContainerReader::IsContainer(data, size)) {
+        return {data, size};
+    }
+    ContainerReader container(data, size);
+    container.CheckIndexHeader(data, index_type);
+    const auto& section = container.Get(SectionType::INDEX_DATA);
+    KNOWHERE_THROW_IF_NOT_FMT((section.flags & kSectionCompressed) == 0, "the %s data is compressed",
+                              index_type.c_str());
+    if (verify) {
+        ContainerReader::Verify(section, data);
+    }
+    return {data + section.offset, section.size};
+}
+
+std::unique_ptr<faiss::IOReader>
+OpenIndexFile(const std::string& filename, const Version& version, const std::string& index_type, int io_flags) {
+    auto file_reader = std::make_unique<faiss::FileIOReader>(filename.c_str());
+    FILE* f = file_reader->f;
+    const size_t file_size = FileSize(f);
+    const bool mmap = (io_flags & faiss::IO_FLAG_MMAP_IFC) == faiss::IO_FLAG_MMAP_IFC;
+
+    size_t offset = 0;
+    size_t size = file_size;
+    bool compressed = false;
+    if (IsContainerVersion(version) && ContainerReader::IsContainer(f)) {
+        ContainerReader container(f, file_size);
+        container.CheckIndexHeader(f, index_type);
+        const auto& section = container.Get(SectionType::INDEX_DATA);
+        compressed = (section.flags & kSectionCompressed) != 0;
+        if (!compressed && !mmap) {
+            ContainerReader::Verify(section, f);
+        }
+        offset = section.offset;
+        size = section.size;
+    }
+
+    if (compressed || mmap) {
+        auto mapping = std::make_shared<faiss::MmappedFileMappingOwner>(f);
+        if (compressed) {
+            const auto* data = static_cast<const uint8_t*>(mapping->data()) + offset;
+            return std::make_unique<CompressedIOReader>(data, size, mapping);
+        }
+        auto reader = std::make_unique<faiss::MappedFileIOReader>(mapping);
+        reader->pos = offset;
+        return reader;
+    }
+    KNOWHERE_THROW_IF_NOT_MSG(std::fseek(f, offset, SEEK_SET) == 0, "failed to seek an index file");
+    return file_reader;
+}
+
+void
+WriteIndexFile(const std::string& filename, const std::string& index_type, const Version& version,
+               const std::function<void(faiss::IOWriter*)>& write, bool compressible) {
+    std::unique_ptr<FILE, decltype(&std::fclose)> file(std::fopen(filename.c_str(), "w+b"), &std::fclose);
+    KNOWHERE_THROW_IF_NOT_FMT(file != nullptr, "failed to open %s: %s", filename.c_str(), strerror(errno));
+    FILE* f = file.get();
+    // the index reaches the file in writes of at most a chunk
+    std::setvbuf(f, nullptr, _IOFBF, kCompressedChunkSize);
+    if (!IsContainerVersion(version)) {
+        faiss::FileIOWriter writer(f);
+        write(&writer);
+    } else {
+        const int level = compressible ? GetBinaryCompressionLevel() : 0;
+        ContainerFileWriter container(f);
+        container.AddIndexHeader(index_type, version.VersionNumber());
+        auto* sink = container.BeginSection(SectionType::INDEX_DATA, level != 0 ? kSectionCompressed : 0);
+        if (level == 0) {
+            write(sink);
+        } else {
+            // the header of the compressed data, that starts the section, is known once all of it is written
+            CompressedIOWriter writer(level, kCompressedChunkSize, sink);
+            write(&writer);
+            writer.Finish();
+            const auto header = writer.Header();
+            container.Patch(0, header.data(), header.size());
+        }
+        container.EndSection();
+        container.Finish();
+    }
+    KNOWHERE_THROW_IF_NOT_FMT(std::fclose(file.release()) == 0, "failed to write %s: %s", filename.c_str(),
+                              strerror(errno));
+}
+
+}  // namespace knowhere
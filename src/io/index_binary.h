@@ -0,0 +1,67 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <faiss/impl/io.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "knowhere/binaryset.h"
+#include "knowhere/version.h"
+
+namespace knowhere {
+
+// The binaries of the indexes of version 9 or later are containers (see io/container.h) of the header of the index,
+// its type and version, and of its serialized data, compressed or not. The binaries of older versions are the
+// serialized data itself. A container is only probed for in the binaries and files of the versions that write it.
+constexpr int32_t kContainerMinVersion = 9;
+
+// Appends the binary of an index that write() serializes, compressed if the binary compression is on and the index
+// version is that of a container.
+void
+AppendIndexBinary(BinarySet& binset, const std::string& index_type, const Version& version,
+                  const std::function<void(faiss::IOWriter*)>& write);
+
+// Appends the binary of an index serialized, uncompressed, into the size bytes of data.
+void
+AppendIndexBinary(BinarySet& binset, const std::string& index_type, const Version& version,
+                  const std::shared_ptr<uint8_t[]>& data, size_t size);
+
+// Writes the file of an index that write() serializes, of the bytes of the binary that AppendIndexBinary() appends. The
+// index is streamed to the file through a buffer of a chunk, instead of serialized in memory first. The index is
+// compressed if compressible and the binary compression is on, as in a binary.
+void
+WriteIndexFile(const std::string& filename, const std::string& index_type, const Version& version,
+               const std::function<void(faiss::IOWriter*)>& write, bool compressible = true);
+
+// The reader of the binary of an index: decompressing if it is compressed, else reading views of its data if
+// zero_copy, else copies. Throws if the binary is a corrupted container, or one of another index type.
+std::unique_ptr<faiss::IOReader>
+MakeIndexBinaryReader(const BinaryPtr& binary, const Version& version, const std::string& index_type, bool zero_copy);
+
+// The uncompressed serialized data of an index in the size bytes of a binary, or of a mapped file. Its checksum is
+// verified if verify, which reads all of it.
+std::pair<const uint8_t*, size_t>
+GetIndexData(const uint8_t* data, size_t size, const Version& version, const std::string& index_type, bool verify);
+
+// The reader of an index file, positioned at the serialized data of the index, which is decompressed if it is
+// compressed, else mapped if io_flags has IO_FLAG_MMAP_IFC, else read by a faiss::FileIOReader, that faiss can map
+// with IO_FLAG_MMAP. The checksum of the data of a container is verified unless the data is mapped, for a mapped
+// index to only load the pages that it reads.
+std::unique_ptr<faiss::IOReader>
+OpenIndexFile(const std::string& filename, const Version& version, const std::string& index_type, int io_flags);
+
+}  // namespace knowhere
@@ -12,6 +12,10 @@
 #pragma once
 
 #include <faiss/impl/io.h>
+#include <faiss/impl/zerocopy_io.h>
+
+#include <memory>
+#include <utility>
 
 namespace knowhere {
 
@@ -102,6 +106,23 @@ struct MemoryIOWriter : public faiss::IOWriter {
     }
 };
 
+// A MemoryIOWriter that passes the written bytes on to a sink instead of keeping them, for the serializers that write
+// to a MemoryIOWriter to stream their output. tellg() counts the written bytes, data() stays null.
+struct ForwardingIOWriter : public MemoryIOWriter {
+    explicit ForwardingIOWriter(faiss::IOWriter* sink) : sink_(sink) {
+    }
+
+    size_t
+    operator()(const void* ptr, size_t size, size_t nitems) override {
+        const size_t written = (*sink_)(ptr, size, nitems);
+        rp_ += size * written;
+        return written;
+    }
+
+ private:
+    faiss::IOWriter* sink_;
+};
+
 struct MemoryIOReader : public faiss::IOReader {
     uint8_t* data_;
     size_t rp_ = 0;
@@ -162,4 +183,21 @@ struct MemoryIOReader : public faiss::IOReader {
     }
 };
 
+// Reads a faiss index out of the data of a binary without copying its vectors: the codes, the neighbor lists and the
+// ids of the read index are views of the data, which they keep alive. The data must not be modified afterwards, and
+// the read index is read-only. The index is read from the size bytes at offset in the data.
+struct ZeroCopyBinaryReader : public faiss::ZeroCopyIOReader {
+    ZeroCopyBinaryReader(const std::shared_ptr<uint8_t[]>& data, size_t size, size_t offset = 0)
+        : faiss::ZeroCopyIOReader(data.get() + offset, size) {
+        data_owner = std::make_shared<Owner>(data);
+    }
+
+ private:
+    struct Owner : public faiss::MaybeOwnedVectorOwner {
+        explicit Owner(std::shared_ptr<uint8_t[]> data) : data(std::move(data)) {
+        }
+        std::shared_ptr<uint8_t[]> data;
+    };
+};
+
 }  // namespace knowhere
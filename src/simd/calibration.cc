@@ -0,0 +1,272 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "calibration.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <tuple>
+#include <type_traits>
+
+#include "hook.h"
+#include "knowhere/operands.h"
+
+#if defined(__x86_64__)
+#include "distances_avx.h"
+#include "distances_avx512.h"
+#include "distances_avx512bf16.h"
+#include "distances_avx512vnni.h"
+#include "distances_avxvnni.h"
+#include "distances_sse.h"
+#endif
+
+#include "distances_ref.h"
+
+namespace faiss {
+
+namespace {
+
+constexpr size_t kNumDimBuckets = std::size(kCalibrationDimBuckets);
+
+// the vectors a kernel is timed on, few enough to stay in the cache like the neighbors of a graph search
+constexpr size_t kNumVectors = 16;
+
+size_t
+dim_bucket(const size_t d) {
+    for (size_t i = 0; i + 1 < kNumDimBuckets; i++) {
+        if (d <= kCalibrationDimBuckets[i]) {
+            return i;
+        }
+    }
+    return kNumDimBuckets - 1;
+}
+
+template <typename Fn>
+struct Candidate {
+    const char* name;
+    Fn fn;
+};
+
+// installed in place of a hook whose dim buckets have different winners, the dim is the last argument
+template <auto* Hook, typename Fn = std::remove_reference_t<decltype(*Hook)>>
+struct DimDispatch;
+
+template <auto* Hook, typename R, typename... Args>
+struct DimDispatch<Hook, R (*)(Args...)> {
+    static inline R (*kernels[kNumDimBuckets])(Args...) = {};
+
+    static R
+    call(Args... args) {
+        const size_t d = std::get<sizeof...(Args) - 1>(std::forward_as_tuple(args...));
+        return kernels[dim_bucket(d)](args...);
+    }
+};
+
+template <typename T>
+std::vector<T>
+random_data(const size_t n) {
+    std::mt19937 rng(n);
+    std::vector<T> data(n);
+    if constexpr (std::is_same_v<T, knowhere::int8>) {
+        std::uniform_int_distribution<int> distrib(-128, 127);
+        for (auto& v : data) {
+            v = (T)distrib(rng);
+        }
+    } else {
+        std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+        for (auto& v : data) {
+            v = (T)distrib(rng);
+        }
+    }
+    return data;
+}
+
+// the best of a few rounds, which filters out the interrupts and the frequency changes
+template <typename T, typename Fn>
+double
+time_kernel(const Fn fn, const std::vector<T>& x, const std::vector<T>& y, const size_t d) {
+    constexpr size_t kNumRounds = 5;
+    const size_t num_calls = std::max<size_t>(kNumVectors, (size_t{1} << 16) / d / kNumVectors * kNumVectors);
+    volatile float sink = 0;
+    double best = std::numeric_limits<double>::max();
+    for (size_t round = 0; round <= kNumRounds; round++) {
+        float sum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_calls; i++) {
+            const T* y_i = y.data() + (i % kNumVectors) * d;
+            if constexpr (std::is_invocable_v<Fn, const T*, size_t>) {
+                sum += fn(y_i, d);
+            } else {
+                sum += fn(x.data(), y_i, d);
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        sink = sink + sum;
+        // the first round warms up the cache and the clock
+        if (round > 0) {
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / num_calls);
+        }
+    }
+    return best;
+}
+
+template <auto* Hook, typename T, typename Fn = std::remove_reference_t<decltype(*Hook)>>
+void
+calibrate(const char* function, const std::vector<Candidate<Fn>>& candidates, std::vector<KernelChoice>& choices) {
+    if (candidates.size() < 2) {
+        return;
+    }
+    Fn winners[kNumDimBuckets];
+    for (size_t b = 0; b < kNumDimBuckets; b++) {
+        const size_t d = kCalibrationDimBuckets[b];
+        const auto x = random_data<T>(d);
+        const auto y = random_data<T>(d * kNumVectors);
+        const Candidate<Fn>* best = nullptr;
+        double best_ns = std::numeric_limits<double>::max();
+        for (const auto& candidate : candidates) {
+            const double ns = time_kernel<T>(candidate.fn, x, y, d);
+            if (ns < best_ns) {
+                best = &candidate;
+                best_ns = ns;
+            }
+        }
+        winners[b] = best->fn;
+        choices.push_back({function, b + 1 < kNumDimBuckets ? d : std::numeric_limits<size_t>::max(), best->name,
+                           best_ns});
+    }
+    if (std::all_of(winners, winners + kNumDimBuckets, [&](const Fn fn) { return fn == winners[0]; })) {
+        *Hook = winners[0];
+        return;
+    }
+    std::copy(winners, winners + kNumDimBuckets, DimDispatch<Hook>::kernels);
+    *Hook = DimDispatch<Hook>::call;
+}
+
+}  // namespace
+
+std::vector<KernelChoice>
+fvec_calibrate() {
+    static std::mutex calibrate_mutex;
+    std::lock_guard<std::mutex> lock(calibrate_mutex);
+    std::vector<KernelChoice> choices;
+#if defined(__x86_64__)
+    const bool sse4_2 = use_sse4_2 && cpu_support_sse4_2();
+    const bool avx2 = use_avx2 && cpu_support_avx2();
+    const bool avx512 = use_avx512 && cpu_support_avx512();
+    const bool avx512_bf16 = avx512 && cpu_support_avx512_bf16();
+    const bool avx512_vnni = avx512 && cpu_support_avx512_vnni();
+    const bool avx_vnni = avx2 && cpu_support_avx_vnni();
+
+    // the candidates of a function are the ref kernel and the ones the flags allow
+    auto candidates = [](auto ref, std::initializer_list<std::tuple<bool, const char*, decltype(ref)>> others) {
+        std::vector<Candidate<decltype(ref)>> res{{"ref", ref}};
+        for (const auto& [enabled, name, fn] : others) {
+            if (enabled) {
+                res.push_back({name, fn});
+            }
+        }
+        return res;
+    };
+
+    // fp32
+    calibrate<&fvec_inner_product, float>(
+        "fvec_inner_product",
+        candidates(fvec_inner_product_ref, {{sse4_2, "sse", fvec_inner_product_sse},
+                                            {avx2, "avx", fvec_inner_product_avx},
+                                            {avx512, "avx512", fvec_inner_product_avx512}}),
+        choices);
+    calibrate<&fvec_L2sqr, float>(
+        "fvec_L2sqr",
+        candidates(fvec_L2sqr_ref, {{sse4_2, "sse", fvec_L2sqr_sse},
+                                    {avx2, "avx", fvec_L2sqr_avx},
+                                    {avx512, "avx512", fvec_L2sqr_avx512}}),
+        choices);
+    calibrate<&fvec_norm_L2sqr, float>(
+        "fvec_norm_L2sqr",
+        candidates(fvec_norm_L2sqr_ref, {{sse4_2, "sse", fvec_norm_L2sqr_sse},
+                                         {avx2, "avx", fvec_norm_L2sqr_avx},
+                                         {avx512, "avx512", fvec_norm_L2sqr_avx512}}),
+        choices);
+
+    // fp16, the avx kernels convert with f16c
+    const bool avx2_f16c = avx2 && cpu_support_f16c();
+    calibrate<&fp16_vec_inner_product, knowhere::fp16>(
+        "fp16_vec_inner_product",
+        candidates(fp16_vec_inner_product_ref, {{avx2_f16c, "avx", fp16_vec_inner_product_avx},
+                                                {avx512, "avx512", fp16_vec_inner_product_avx512}}),
+        choices);
+    calibrate<&fp16_vec_L2sqr, knowhere::fp16>(
+        "fp16_vec_L2sqr",
+        candidates(fp16_vec_L2sqr_ref,
+                   {{avx2_f16c, "avx", fp16_vec_L2sqr_avx}, {avx512, "avx512", fp16_vec_L2sqr_avx512}}),
+        choices);
+    calibrate<&fp16_vec_norm_L2sqr, knowhere::fp16>(
+        "fp16_vec_norm_L2sqr",
+        candidates(fp16_vec_norm_L2sqr_ref,
+                   {{avx2_f16c, "avx", fp16_vec_norm_L2sqr_avx}, {avx512, "avx512", fp16_vec_norm_L2sqr_avx512}}),
+        choices);
+
+    // bf16
+    calibrate<&bf16_vec_inner_product, knowhere::bf16>(
+        "bf16_vec_inner_product",
+        candidates(bf16_vec_inner_product_ref, {{sse4_2, "sse", bf16_vec_inner_product_sse},
+                                                {avx2, "avx", bf16_vec_inner_product_avx},
+                                                {avx512, "avx512", bf16_vec_inner_product_avx512},
+                                                {avx512_bf16, "avx512bf16", bf16_vec_inner_product_avx512bf16}}),
+        choices);
+    calibrate<&bf16_vec_L2sqr, knowhere::bf16>(
+        "bf16_vec_L2sqr",
+        candidates(bf16_vec_L2sqr_ref, {{sse4_2, "sse", bf16_vec_L2sqr_sse},
+                                        {avx2, "avx", bf16_vec_L2sqr_avx},
+                                        {avx512, "avx512", bf16_vec_L2sqr_avx512}}),
+        choices);
+    calibrate<&bf16_vec_norm_L2sqr, knowhere::bf16>(
+        "bf16_vec_norm_L2sqr",
+        candidates(bf16_vec_norm_L2sqr_ref, {{sse4_2, "sse", bf16_vec_norm_L2sqr_sse},
+                                             {avx2, "avx", bf16_vec_norm_L2sqr_avx},
+                                             {avx512, "avx512", bf16_vec_norm_L2sqr_avx512},
+                                             {avx512_bf16, "avx512bf16", bf16_vec_norm_L2sqr_avx512bf16}}),
+        choices);
+
+    // int8
+    calibrate<&int8_vec_inner_product, knowhere::int8>(
+        "int8_vec_inner_product",
+        candidates(int8_vec_inner_product_ref, {{sse4_2, "sse", int8_vec_inner_product_sse},
+                                                {avx2, "avx", int8_vec_inner_product_avx},
+                                                {avx_vnni, "avxvnni", int8_vec_inner_product_avxvnni},
+                                                {avx512, "avx512", int8_vec_inner_product_avx512},
+                                                {avx512_vnni, "avx512vnni", int8_vec_inner_product_avx512vnni}}),
+        choices);
+    calibrate<&int8_vec_L2sqr, knowhere::int8>(
+        "int8_vec_L2sqr",
+        candidates(int8_vec_L2sqr_ref, {{sse4_2, "sse", int8_vec_L2sqr_sse},
+                                        {avx2, "avx", int8_vec_L2sqr_avx},
+                                        {avx_vnni, "avxvnni", int8_vec_L2sqr_avxvnni},
+                                        {avx512, "avx512", int8_vec_L2sqr_avx512},
+                                        {avx512_vnni, "avx512vnni", int8_vec_L2sqr_avx512vnni}}),
+        choices);
+    calibrate<&int8_vec_norm_L2sqr, knowhere::int8>(
+        "int8_vec_norm_L2sqr",
+        candidates(int8_vec_norm_L2sqr_ref, {{sse4_2, "sse", int8_vec_norm_L2sqr_sse},
+                                             {avx2, "avx", int8_vec_norm_L2sqr_avx},
+                                             {avx_vnni, "avxvnni", int8_vec_norm_L2sqr_avxvnni},
+                                             {avx512, "avx512", int8_vec_norm_L2sqr_avx512},
+                                             {avx512_vnni, "avx512vnni", int8_vec_norm_L2sqr_avx512vnni}}),
+        choices);
+#endif
+    return choices;
+}
+
+}  // namespace faiss
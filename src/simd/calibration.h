@@ -0,0 +1,42 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SIMD_CALIBRATION_H
+#define SIMD_CALIBRATION_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace faiss {
+
+// the kernel installed for the dims of a function up to max_dim
+struct KernelChoice {
+    std::string function;
+    size_t max_dim;
+    std::string kernel;
+    double ns_per_call;
+};
+
+// The dims are bucketed by their upper bounds, the last bucket takes the larger ones.
+constexpr size_t kCalibrationDimBuckets[] = {32, 128, 512, 2048};
+
+// Times the kernels of the single vector distances (fp32, fp16, bf16 and int8 inner product, L2 and norm) that
+// the cpu and the use_* flags allow, for each dim bucket, and installs the fastest. A function with one winner
+// gets it installed directly, the others a dispatcher by dim. Call after fvec_hook, which it starts from and
+// which undoes it. The batch and ny kernels keep the choice of fvec_hook. Returns nothing where there is only
+// one candidate per function.
+std::vector<KernelChoice>
+fvec_calibrate();
+
+}  // namespace faiss
+
+#endif /* SIMD_CALIBRATION_H */
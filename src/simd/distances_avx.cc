@@ -109,6 +109,36 @@ fvec_L2sqr_avx(const float* x, const float* y, size_t d) {
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
+namespace {
+
+struct InnerProductKernel {
+    static float
+    call(const float* x, const float* y, size_t d) {
+        return fvec_inner_product_avx(x, y, d);
+    }
+};
+
+struct L2sqrKernel {
+    static float
+    call(const float* x, const float* y, size_t d) {
+        return fvec_L2sqr_avx(x, y, d);
+    }
+};
+
+}  // namespace
+
+void
+fvec_inner_product_by_ids_avx(const float* x, const float* y, size_t d, const int32_t* ids, size_t n,
+                              size_t prefetch_distance, float* dis) {
+    fvec_by_ids<InnerProductKernel>(x, y, d, ids, n, prefetch_distance, dis);
+}
+
+void
+fvec_L2sqr_by_ids_avx(const float* x, const float* y, size_t d, const int32_t* ids, size_t n,
+                      size_t prefetch_distance, float* dis) {
+    fvec_by_ids<L2sqrKernel>(x, y, d, ids, n, prefetch_distance, dis);
+}
+
 float
 fvec_L1_avx(const float* x, const float* y, size_t d) {
     __m256 msum1 = _mm256_setzero_ps();
@@ -225,6 +255,39 @@ fvec_inner_product_batch_4_avx(const float* __restrict x, const float* __restric
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
+// the eight accumulators still fit the registers, while x is loaded once for twice the vectors
+FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
+void
+fvec_inner_product_batch_8_avx(const float* __restrict x, const float* __restrict y0, const float* __restrict y1,
+                               const float* __restrict y2, const float* __restrict y3, const float* __restrict y4,
+                               const float* __restrict y5, const float* __restrict y6, const float* __restrict y7,
+                               const size_t d, float& dis0, float& dis1, float& dis2, float& dis3, float& dis4,
+                               float& dis5, float& dis6, float& dis7) {
+    float d0 = 0, d1 = 0, d2 = 0, d3 = 0, d4 = 0, d5 = 0, d6 = 0, d7 = 0;
+
+    FAISS_PRAGMA_IMPRECISE_LOOP
+    for (size_t i = 0; i < d; ++i) {
+        d0 += x[i] * y0[i];
+        d1 += x[i] * y1[i];
+        d2 += x[i] * y2[i];
+        d3 += x[i] * y3[i];
+        d4 += x[i] * y4[i];
+        d5 += x[i] * y5[i];
+        d6 += x[i] * y6[i];
+        d7 += x[i] * y7[i];
+    }
+
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+    dis4 = d4;
+    dis5 = d5;
+    dis6 = d6;
+    dis7 = d7;
+}
+FAISS_PRAGMA_IMPRECISE_FUNCTION_END
+
 // trust the compiler to unroll this properly
 FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
 void
@@ -966,6 +1029,41 @@ int8_vec_L2sqr_batch_4_avx(const int8_t* x, const int8_t* y0, const int8_t* y1,
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
+FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
+int32_t
+s8u8_inner_product_avx(const int8_t* x, const uint8_t* y, size_t d) {
+    int32_t res = 0;
+    FAISS_PRAGMA_IMPRECISE_LOOP
+    for (size_t i = 0; i < d; i++) {
+        res += (int32_t)x[i] * (int32_t)y[i];
+    }
+    return res;
+}
+FAISS_PRAGMA_IMPRECISE_FUNCTION_END
+
+FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
+void
+s8u8_inner_product_batch_4_avx(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                               const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                               int32_t& dis3) {
+    int32_t d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+
+    FAISS_PRAGMA_IMPRECISE_LOOP
+    for (size_t i = 0; i < d; ++i) {
+        auto x_i = (int32_t)x[i];
+        d0 += x_i * (int32_t)y0[i];
+        d1 += x_i * (int32_t)y1[i];
+        d2 += x_i * (int32_t)y2[i];
+        d3 += x_i * (int32_t)y3[i];
+    }
+
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+}
+FAISS_PRAGMA_IMPRECISE_FUNCTION_END
+
 ///////////////////////////////////////////////////////////////////////////////
 // for cardinal
 
@@ -1140,10 +1238,179 @@ rabitq_dp_popcnt_avx(const uint8_t* q, const uint8_t* x, const size_t d, const s
     return dot;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+namespace {
+
+// the popcounts of the bytes are looked up by nibble, then summed in the 64-bit lanes by a sad against zero
+inline __m256i
+popcount_epi64(const __m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2,
+                                         2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low_mask));
+    const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+inline __m256i
+load_si256(const uint8_t* x) {
+    return _mm256_loadu_si256((const __m256i*)x);
+}
+
+inline int64_t
+reduce_add_epi64(const __m256i v) {
+    const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1);
+}
+
+}  // namespace
+
+int
+bvec_hamming_distance_avx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        sum = _mm256_add_epi64(sum, popcount_epi64(_mm256_xor_si256(load_si256(x + i), load_si256(y + i))));
+    }
+    int res = (int)reduce_add_epi64(sum);
+    for (; i + 8 <= code_size; i += 8) {
+        res += __builtin_popcountll(*(const uint64_t*)(x + i) ^ *(const uint64_t*)(y + i));
+    }
+    for (; i < code_size; i++) {
+        res += __builtin_popcount(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+void
+bvec_hamming_distance_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    __m256i sum0 = _mm256_setzero_si256();
+    __m256i sum1 = _mm256_setzero_si256();
+    __m256i sum2 = _mm256_setzero_si256();
+    __m256i sum3 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const auto mx = load_si256(x + i);
+        sum0 = _mm256_add_epi64(sum0, popcount_epi64(_mm256_xor_si256(mx, load_si256(y0 + i))));
+        sum1 = _mm256_add_epi64(sum1, popcount_epi64(_mm256_xor_si256(mx, load_si256(y1 + i))));
+        sum2 = _mm256_add_epi64(sum2, popcount_epi64(_mm256_xor_si256(mx, load_si256(y2 + i))));
+        sum3 = _mm256_add_epi64(sum3, popcount_epi64(_mm256_xor_si256(mx, load_si256(y3 + i))));
+    }
+    int d0 = (int)reduce_add_epi64(sum0);
+    int d1 = (int)reduce_add_epi64(sum1);
+    int d2 = (int)reduce_add_epi64(sum2);
+    int d3 = (int)reduce_add_epi64(sum3);
+    for (; i + 8 <= code_size; i += 8) {
+        const auto xv = *(const uint64_t*)(x + i);
+        d0 += __builtin_popcountll(xv ^ *(const uint64_t*)(y0 + i));
+        d1 += __builtin_popcountll(xv ^ *(const uint64_t*)(y1 + i));
+        d2 += __builtin_popcountll(xv ^ *(const uint64_t*)(y2 + i));
+        d3 += __builtin_popcountll(xv ^ *(const uint64_t*)(y3 + i));
+    }
+    for (; i < code_size; i++) {
+        d0 += __builtin_popcount(x[i] ^ y0[i]);
+        d1 += __builtin_popcount(x[i] ^ y1[i]);
+        d2 += __builtin_popcount(x[i] ^ y2[i]);
+        d3 += __builtin_popcount(x[i] ^ y3[i]);
+    }
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+}
+
+float
+bvec_jaccard_distance_avx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m256i sum_num = _mm256_setzero_si256();
+    __m256i sum_den = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const auto mx = load_si256(x + i);
+        const auto my = load_si256(y + i);
+        sum_num = _mm256_add_epi64(sum_num, popcount_epi64(_mm256_and_si256(mx, my)));
+        sum_den = _mm256_add_epi64(sum_den, popcount_epi64(_mm256_or_si256(mx, my)));
+    }
+    int num = (int)reduce_add_epi64(sum_num);
+    int den = (int)reduce_add_epi64(sum_den);
+    for (; i + 8 <= code_size; i += 8) {
+        const auto xv = *(const uint64_t*)(x + i);
+        const auto yv = *(const uint64_t*)(y + i);
+        num += __builtin_popcountll(xv & yv);
+        den += __builtin_popcountll(xv | yv);
+    }
+    for (; i < code_size; i++) {
+        num += __builtin_popcount(x[i] & y[i]);
+        den += __builtin_popcount(x[i] | y[i]);
+    }
+    return (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+}
+
+void
+bvec_jaccard_distance_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                  float& dis3) {
+    __m256i sum_num[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    __m256i sum_den[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    const uint8_t* y[4] = {y0, y1, y2, y3};
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const auto mx = load_si256(x + i);
+        for (size_t j = 0; j < 4; j++) {
+            const auto my = load_si256(y[j] + i);
+            sum_num[j] = _mm256_add_epi64(sum_num[j], popcount_epi64(_mm256_and_si256(mx, my)));
+            sum_den[j] = _mm256_add_epi64(sum_den[j], popcount_epi64(_mm256_or_si256(mx, my)));
+        }
+    }
+    float dis[4];
+    for (size_t j = 0; j < 4; j++) {
+        int num = (int)reduce_add_epi64(sum_num[j]);
+        int den = (int)reduce_add_epi64(sum_den[j]);
+        size_t k = i;
+        for (; k + 8 <= code_size; k += 8) {
+            const auto xv = *(const uint64_t*)(x + k);
+            const auto yv = *(const uint64_t*)(y[j] + k);
+            num += __builtin_popcountll(xv & yv);
+            den += __builtin_popcountll(xv | yv);
+        }
+        for (; k < code_size; k++) {
+            num += __builtin_popcount(x[k] & y[j][k]);
+            den += __builtin_popcount(x[k] | y[j][k]);
+        }
+        dis[j] = (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+    }
+    dis0 = dis[0];
+    dis1 = dis[1];
+    dis2 = dis[2];
+    dis3 = dis[3];
+}
+
 uint64_t
 calculate_hash_avx2(const char* data, size_t size) {
     return XXH3_64bits(data, size);
 }
 
+void
+pq8_lut_sum_avx(const uint8_t* codes, size_t n, size_t nchunks, const float* lut, float* out) {
+    // lane j of a step over chunks [c, c + 8) gathers lut[256 * (c + j) + code]
+    const __m256i lane_offsets = _mm256_setr_epi32(0, 256, 512, 768, 1024, 1280, 1536, 1792);
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* x = codes + i * nchunks;
+        __m256 acc = _mm256_setzero_ps();
+        size_t c = 0;
+        for (; c + 8 <= nchunks; c += 8) {
+            const __m256i idx = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(x + c))),
+                                                 _mm256_add_epi32(lane_offsets, _mm256_set1_epi32(256 * c)));
+            acc = _mm256_add_ps(acc, _mm256_i32gather_ps(lut, idx, sizeof(float)));
+        }
+        float sum = _mm256_reduce_add_ps(acc);
+        for (; c < nchunks; c++) {
+            sum += lut[256 * c + x[c]];
+        }
+        out[i] = sum;
+    }
+}
+
 }  // namespace faiss
 #endif
@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "distances_by_ids.h"
 #include "knowhere/operands.h"
 
 namespace faiss {
@@ -26,6 +27,15 @@ fvec_L2sqr_avx(const float* x, const float* y, size_t d);
 float
 fvec_inner_product_avx(const float* x, const float* y, size_t d);
 
+/// the by-ids loops of the kernels above
+void
+fvec_inner_product_by_ids_avx(const float* x, const float* y, size_t d, const int32_t* ids, size_t n,
+                              size_t prefetch_distance, float* dis);
+
+void
+fvec_L2sqr_by_ids_avx(const float* x, const float* y, size_t d, const int32_t* ids, size_t n,
+                      size_t prefetch_distance, float* dis);
+
 /// L1 distance
 float
 fvec_L1_avx(const float* x, const float* y, size_t d);
@@ -41,6 +51,12 @@ void
 fvec_inner_product_batch_4_avx(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
                                const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
 
+void
+fvec_inner_product_batch_8_avx(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+                               const float* y4, const float* y5, const float* y6, const float* y7, const size_t d,
+                               float& dis0, float& dis1, float& dis2, float& dis3, float& dis4, float& dis5,
+                               float& dis6, float& dis7);
+
 void
 fvec_L2sqr_batch_4_avx(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
                        const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
@@ -127,6 +143,14 @@ void
 int8_vec_L2sqr_batch_4_avx(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2, const int8_t* y3,
                            const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
 
+int32_t
+s8u8_inner_product_avx(const int8_t* x, const uint8_t* y, size_t d);
+
+void
+s8u8_inner_product_batch_4_avx(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                               const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                               int32_t& dis3);
+
 ///////////////////////////////////////////////////////////////////////////////
 // for cardinal
 
@@ -152,9 +176,28 @@ fvec_masked_sum_avx(const float* q, const uint8_t* x, const size_t d);
 int
 rabitq_dp_popcnt_avx(const uint8_t* q, const uint8_t* x, const size_t d, const size_t nb);
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+int
+bvec_hamming_distance_avx(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_hamming_distance_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3);
+float
+bvec_jaccard_distance_avx(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_jaccard_distance_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                  float& dis3);
+
 ///////////////////////////////////////////////////////////////////////////////
 // minhash
 uint64_t
 calculate_hash_avx2(const char* data, size_t size);
 
+///////////////////////////////////////////////////////////////////////////////
+// pq
+void
+pq8_lut_sum_avx(const uint8_t* codes, size_t n, size_t nchunks, const float* lut, float* out);
+
 }  // namespace faiss
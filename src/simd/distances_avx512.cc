@@ -17,6 +17,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <string>
 
@@ -76,6 +77,126 @@ fvec_L2sqr_avx512(const float* x, const float* y, size_t d) {
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
+namespace {
+
+// the same loops with the dim known at compile time, they unroll fully and have no tail
+FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
+template <size_t D>
+struct InnerProductDim {
+    static float
+    call(const float* x, const float* y, size_t) {
+        float res = 0;
+        FAISS_PRAGMA_IMPRECISE_LOOP
+        for (size_t i = 0; i < D; i++) {
+            res += x[i] * y[i];
+        }
+        return res;
+    }
+};
+
+template <size_t D>
+struct L2sqrDim {
+    static float
+    call(const float* x, const float* y, size_t) {
+        float res = 0;
+        FAISS_PRAGMA_IMPRECISE_LOOP
+        for (size_t i = 0; i < D; i++) {
+            const float tmp = x[i] - y[i];
+            res += tmp * tmp;
+        }
+        return res;
+    }
+};
+FAISS_PRAGMA_IMPRECISE_FUNCTION_END
+
+// the dims of the common embedding models
+template <template <size_t> class Kernel>
+float (*kernel_for_dim(const size_t d))(const float*, const float*, size_t) {
+    switch (d) {
+        case 128:
+            return Kernel<128>::call;
+        case 256:
+            return Kernel<256>::call;
+        case 384:
+            return Kernel<384>::call;
+        case 512:
+            return Kernel<512>::call;
+        case 768:
+            return Kernel<768>::call;
+        case 1024:
+            return Kernel<1024>::call;
+        case 1536:
+            return Kernel<1536>::call;
+        case 3072:
+            return Kernel<3072>::call;
+        default:
+            return nullptr;
+    }
+}
+
+}  // namespace
+
+float (*fvec_inner_product_avx512_for_dim(const size_t d))(const float*, const float*, size_t) {
+    return kernel_for_dim<InnerProductDim>(d);
+}
+
+float (*fvec_L2sqr_avx512_for_dim(const size_t d))(const float*, const float*, size_t) {
+    return kernel_for_dim<L2sqrDim>(d);
+}
+
+namespace {
+
+struct InnerProductAnyDim {
+    static float
+    call(const float* x, const float* y, size_t d) {
+        return fvec_inner_product_avx512(x, y, d);
+    }
+};
+
+struct L2sqrAnyDim {
+    static float
+    call(const float* x, const float* y, size_t d) {
+        return fvec_L2sqr_avx512(x, y, d);
+    }
+};
+
+template <template <size_t> class Kernel, typename AnyDimKernel>
+fvec_by_ids_func
+by_ids_for_dim(const size_t d) {
+    switch (d) {
+        case 128:
+            return fvec_by_ids<Kernel<128>>;
+        case 256:
+            return fvec_by_ids<Kernel<256>>;
+        case 384:
+            return fvec_by_ids<Kernel<384>>;
+        case 512:
+            return fvec_by_ids<Kernel<512>>;
+        case 768:
+            return fvec_by_ids<Kernel<768>>;
+        case 1024:
+            return fvec_by_ids<Kernel<1024>>;
+        case 1536:
+            return fvec_by_ids<Kernel<1536>>;
+        case 3072:
+            return fvec_by_ids<Kernel<3072>>;
+        default:
+            return fvec_by_ids<AnyDimKernel>;
+    }
+}
+
+}  // namespace
+
+fvec_by_ids_func
+fvec_inner_product_by_ids_avx512_for_dim(const size_t d) {
+    return by_ids_for_dim<InnerProductDim, InnerProductAnyDim>(d);
+}
+
+fvec_by_ids_func
+fvec_L2sqr_by_ids_avx512_for_dim(const size_t d) {
+    return by_ids_for_dim<L2sqrDim, L2sqrAnyDim>(d);
+}
+
 float
 fvec_L1_avx512(const float* x, const float* y, size_t d) {
     __m512 msum0 = _mm512_setzero_ps();
@@ -220,6 +341,39 @@ fvec_inner_product_batch_4_avx512(const float* __restrict x, const float* __rest
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
+// the eight accumulators still fit the registers, while x is loaded once for twice the vectors
+FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
+void
+fvec_inner_product_batch_8_avx512(const float* __restrict x, const float* __restrict y0, const float* __restrict y1,
+                                  const float* __restrict y2, const float* __restrict y3, const float* __restrict y4,
+                                  const float* __restrict y5, const float* __restrict y6, const float* __restrict y7,
+                                  const size_t d, float& dis0, float& dis1, float& dis2, float& dis3, float& dis4,
+                                  float& dis5, float& dis6, float& dis7) {
+    float d0 = 0, d1 = 0, d2 = 0, d3 = 0, d4 = 0, d5 = 0, d6 = 0, d7 = 0;
+
+    FAISS_PRAGMA_IMPRECISE_LOOP
+    for (size_t i = 0; i < d; ++i) {
+        d0 += x[i] * y0[i];
+        d1 += x[i] * y1[i];
+        d2 += x[i] * y2[i];
+        d3 += x[i] * y3[i];
+        d4 += x[i] * y4[i];
+        d5 += x[i] * y5[i];
+        d6 += x[i] * y6[i];
+        d7 += x[i] * y7[i];
+    }
+
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+    dis4 = d4;
+    dis5 = d5;
+    dis6 = d6;
+    dis7 = d7;
+}
+FAISS_PRAGMA_IMPRECISE_FUNCTION_END
+
 FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
 void
 fvec_L2sqr_batch_4_avx512(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
@@ -773,6 +927,41 @@ int8_vec_L2sqr_batch_4_avx512(const int8_t* x, const int8_t* y0, const int8_t* y
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
+FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
+int32_t
+s8u8_inner_product_avx512(const int8_t* x, const uint8_t* y, size_t d) {
+    int32_t res = 0;
+    FAISS_PRAGMA_IMPRECISE_LOOP
+    for (size_t i = 0; i < d; i++) {
+        res += (int32_t)x[i] * (int32_t)y[i];
+    }
+    return res;
+}
+FAISS_PRAGMA_IMPRECISE_FUNCTION_END
+
+FAISS_PRAGMA_IMPRECISE_FUNCTION_BEGIN
+void
+s8u8_inner_product_batch_4_avx512(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                                  int32_t& dis3) {
+    int32_t d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+
+    FAISS_PRAGMA_IMPRECISE_LOOP
+    for (size_t i = 0; i < d; ++i) {
+        auto x_i = (int32_t)x[i];
+        d0 += x_i * (int32_t)y0[i];
+        d1 += x_i * (int32_t)y1[i];
+        d2 += x_i * (int32_t)y2[i];
+        d3 += x_i * (int32_t)y3[i];
+    }
+
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+}
+FAISS_PRAGMA_IMPRECISE_FUNCTION_END
+
 ///////////////////////////////////////////////////////////////////////////////
 // for cardinal
 
@@ -1156,5 +1345,334 @@ u64_jaccard_distance_batch_4_avx512(const char* x, const char* y0, const char* y
     dis2 = float(d2) / element_length;
     dis3 = float(d3) / element_length;
 }
+
+// the query chunk is loaded once for the 16 signatures, the tail compares only the lanes of the mask
+void
+u32_jaccard_distance_batch_16_avx512(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                     float* dis) {
+    const uint32_t* u32_x = reinterpret_cast<const uint32_t*>(x);
+    uint32_t d[16] = {};
+    size_t i = 0;
+    for (; i + 16 <= element_length; i += 16) {
+        const __m512i mx = _mm512_loadu_si512(u32_x + i);
+        for (size_t j = 0; j < 16; j++) {
+            const __m512i my = _mm512_loadu_si512(reinterpret_cast<const uint32_t*>(y[j]) + i);
+            d[j] += __builtin_popcount(static_cast<unsigned int>(_mm512_cmpeq_epu32_mask(mx, my)));
+        }
+    }
+    if (i < element_length) {
+        const __mmask16 mask = (1U << (element_length - i)) - 1U;
+        const __m512i mx = _mm512_maskz_loadu_epi32(mask, u32_x + i);
+        for (size_t j = 0; j < 16; j++) {
+            const __m512i my = _mm512_maskz_loadu_epi32(mask, reinterpret_cast<const uint32_t*>(y[j]) + i);
+            d[j] += __builtin_popcount(static_cast<unsigned int>(_mm512_mask_cmpeq_epu32_mask(mask, mx, my)));
+        }
+    }
+    for (size_t j = 0; j < 16; j++) {
+        dis[j] = float(d[j]) / float(element_length);
+    }
+}
+
+void
+u64_jaccard_distance_batch_16_avx512(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                     float* dis) {
+    const uint64_t* u64_x = reinterpret_cast<const uint64_t*>(x);
+    uint32_t d[16] = {};
+    size_t i = 0;
+    for (; i + 8 <= element_length; i += 8) {
+        const __m512i mx = _mm512_loadu_si512(u64_x + i);
+        for (size_t j = 0; j < 16; j++) {
+            const __m512i my = _mm512_loadu_si512(reinterpret_cast<const uint64_t*>(y[j]) + i);
+            d[j] += __builtin_popcount(static_cast<unsigned int>(_mm512_cmpeq_epu64_mask(mx, my)));
+        }
+    }
+    if (i < element_length) {
+        const __mmask8 mask = (1U << (element_length - i)) - 1U;
+        const __m512i mx = _mm512_maskz_loadu_epi64(mask, u64_x + i);
+        for (size_t j = 0; j < 16; j++) {
+            const __m512i my = _mm512_maskz_loadu_epi64(mask, reinterpret_cast<const uint64_t*>(y[j]) + i);
+            d[j] += __builtin_popcount(static_cast<unsigned int>(_mm512_mask_cmpeq_epu64_mask(mask, mx, my)));
+        }
+    }
+    for (size_t j = 0; j < 16; j++) {
+        dis[j] = float(d[j]) / float(element_length);
+    }
+}
+
+void
+pq8_lut_sum_avx512(const uint8_t* codes, size_t n, size_t nchunks, const float* lut, float* out) {
+    // lane j of a step over chunks [c, c + 16) gathers lut[256 * (c + j) + code]
+    const __m512i lane_offsets = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(256));
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* x = codes + i * nchunks;
+        __m512 acc = _mm512_setzero_ps();
+        size_t c = 0;
+        for (; c + 16 <= nchunks; c += 16) {
+            const __m512i idx = _mm512_add_epi32(_mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(x + c))),
+                                                 _mm512_add_epi32(lane_offsets, _mm512_set1_epi32(256 * c)));
+            acc = _mm512_add_ps(acc, _mm512_i32gather_ps(idx, lut, sizeof(float)));
+        }
+        if (c < nchunks) {
+            const __mmask16 mask = (1U << (nchunks - c)) - 1;
+            const __m512i idx = _mm512_add_epi32(_mm512_cvtepu8_epi32(_mm_maskz_loadu_epi8(mask, x + c)),
+                                                 _mm512_add_epi32(lane_offsets, _mm512_set1_epi32(256 * c)));
+            acc = _mm512_add_ps(acc, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, idx, lut, sizeof(float)));
+        }
+        out[i] = _mm512_reduce_add_ps(acc);
+    }
+}
+
+void
+fvec_scatter_madd_avx512(float* acc, const uint32_t* ids, const float* vals, size_t n, float q, uint32_t base) {
+    // ids within a single posting list are unique, so a gather-fma-scatter of 16 lanes never has conflicting lanes.
+    const __m512 q_vec = _mm512_set1_ps(q);
+    const __m512i base_vec = _mm512_set1_epi32(base);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i idx = _mm512_sub_epi32(_mm512_loadu_si512(ids + i), base_vec);
+        const __m512 v = _mm512_loadu_ps(vals + i);
+        const __m512 a = _mm512_i32gather_ps(idx, acc, sizeof(float));
+        _mm512_i32scatter_ps(acc, idx, _mm512_fmadd_ps(q_vec, v, a), sizeof(float));
+    }
+    if (i < n) {
+        const __mmask16 mask = (1U << (n - i)) - 1;
+        const __m512i idx = _mm512_sub_epi32(_mm512_maskz_loadu_epi32(mask, ids + i), base_vec);
+        const __m512 v = _mm512_maskz_loadu_ps(mask, vals + i);
+        const __m512 a = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, idx, acc, sizeof(float));
+        _mm512_mask_i32scatter_ps(acc, mask, idx, _mm512_fmadd_ps(q_vec, v, a), sizeof(float));
+    }
+}
+
+size_t
+u32_lower_bound_avx512(const uint32_t* data, size_t n, uint32_t key) {
+    // meant for short arrays such as a posting block: since data is sorted, the number of elements smaller than key
+    // is the position of the first element >= key, so count them 16 at a time without branching on the data.
+    const __m512i v_key = _mm512_set1_epi32(key);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i v_data = _mm512_loadu_si512(data + i);
+        const __mmask16 lt_mask = _mm512_cmplt_epu32_mask(v_data, v_key);
+        if (lt_mask != 0xFFFF) {
+            return i + __builtin_popcount(lt_mask);
+        }
+        count += 16;
+    }
+    if (i < n) {
+        const __mmask16 mask = (1U << (n - i)) - 1;
+        const __m512i v_data = _mm512_maskz_loadu_epi32(mask, data + i);
+        count += __builtin_popcount(_mm512_mask_cmplt_epu32_mask(mask, v_data, v_key));
+    }
+    return count;
+}
+
+float
+sparse_ip_avx512(const void* x, size_t nx, const void* y, size_t ny) {
+    // Blocks of 8 (id, value) pairs are intersected all against all: the ids of x sit twice in the 16 lanes, the
+    // ids of y rotated by 2r in the low and by 2r + 1 in the high half, so 4 compares cover the 8 rotations. The
+    // block with the smaller last id moves on, both on a tie, which meets every matching pair exactly once.
+    const auto* x_u32 = (const uint32_t*)x;
+    const auto* y_u32 = (const uint32_t*)y;
+    const __m512i x_ids_perm = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 0, 2, 4, 6, 8, 10, 12, 14);
+    const __m512i one = _mm512_set1_epi32(1);
+    __m512i y_ids_perm[4];
+    for (int r = 0; r < 4; r++) {
+        alignas(64) int32_t perm[16];
+        for (int k = 0; k < 16; k++) {
+            perm[k] = 2 * (((k & 7) + 2 * r + (k >> 3)) & 7);
+        }
+        y_ids_perm[r] = _mm512_load_si512(perm);
+    }
+    const __m512i x_vals_perm = _mm512_add_epi32(x_ids_perm, one);
+
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    size_t j = 0;
+    while (i + 8 <= nx && j + 8 <= ny) {
+        const __m512i x_block = _mm512_loadu_si512(x_u32 + 2 * i);
+        const __m512i y_block = _mm512_loadu_si512(y_u32 + 2 * j);
+        const __m512i x_ids = _mm512_permutexvar_epi32(x_ids_perm, x_block);
+        for (int r = 0; r < 4; r++) {
+            const __mmask16 match = _mm512_cmpeq_epi32_mask(x_ids, _mm512_permutexvar_epi32(y_ids_perm[r], y_block));
+            if (match) {
+                const __m512 x_vals = _mm512_permutexvar_ps(x_vals_perm, _mm512_castsi512_ps(x_block));
+                const __m512 y_vals =
+                    _mm512_permutexvar_ps(_mm512_add_epi32(y_ids_perm[r], one), _mm512_castsi512_ps(y_block));
+                acc = _mm512_mask3_fmadd_ps(x_vals, y_vals, acc, match);
+            }
+        }
+        const uint32_t x_last = x_u32[2 * (i + 7)];
+        const uint32_t y_last = y_u32[2 * (j + 7)];
+        i += (x_last <= y_last) ? 8 : 0;
+        j += (y_last <= x_last) ? 8 : 0;
+    }
+    // the pairs left behind are all beyond the ids the blocks matched
+    float res = _mm512_reduce_add_ps(acc);
+    while (i < nx && j < ny) {
+        const uint32_t x_id = x_u32[2 * i];
+        const uint32_t y_id = y_u32[2 * j];
+        if (x_id == y_id) {
+            float x_val;
+            float y_val;
+            std::memcpy(&x_val, x_u32 + 2 * i + 1, sizeof(float));
+            std::memcpy(&y_val, y_u32 + 2 * j + 1, sizeof(float));
+            res += x_val * y_val;
+        }
+        i += (x_id <= y_id);
+        j += (y_id <= x_id);
+    }
+    return res;
+}
+
+float
+sparse_dense_ip_avx512(const void* x, size_t nx, const float* y, size_t dim) {
+    // 16 pairs at a time: the ids and the values are split out of two loads, the values of y are gathered by id.
+    const auto* x_u32 = (const uint32_t*)x;
+    const __m512i ids_perm = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i vals_perm = _mm512_add_epi32(ids_perm, _mm512_set1_epi32(1));
+    const __m512i v_dim = _mm512_set1_epi32((uint32_t)std::min<size_t>(dim, UINT32_MAX));
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i < nx; i += 16) {
+        const size_t n = std::min<size_t>(16, nx - i);
+        // the lanes of the 2 * n words of the remaining pairs
+        const __mmask16 lo_mask = (n >= 8) ? 0xFFFF : (__mmask16)((1U << (2 * n)) - 1);
+        const __mmask16 hi_mask = (n <= 8) ? 0 : (__mmask16)((1U << (2 * (n - 8))) - 1);
+        const __m512i lo = _mm512_maskz_loadu_epi32(lo_mask, x_u32 + 2 * i);
+        const __m512i hi = _mm512_maskz_loadu_epi32(hi_mask, x_u32 + 2 * i + 16);
+        const __m512i ids = _mm512_permutex2var_epi32(lo, ids_perm, hi);
+        const __m512 vals = _mm512_castsi512_ps(_mm512_permutex2var_epi32(lo, vals_perm, hi));
+        const __mmask16 valid = _mm512_mask_cmplt_epu32_mask((__mmask16)((1U << n) - 1), ids, v_dim);
+        const __m512 y_vals = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), valid, ids, y, sizeof(float));
+        acc = _mm512_fmadd_ps(vals, y_vals, acc);
+    }
+    return _mm512_reduce_add_ps(acc);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// binary
+namespace {
+
+// see distances_avx.cc, the cpus without vpopcntdq look the popcounts of the nibbles up
+inline __m512i
+popcount_epi64(const __m512i v) {
+    const __m512i lut = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+    const __m512i low_mask = _mm512_set1_epi8(0x0f);
+    const __m512i lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(v, low_mask));
+    const __m512i hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask));
+    return _mm512_sad_epu8(_mm512_add_epi8(lo, hi), _mm512_setzero_si512());
+}
+
+inline __mmask64
+tail_mask_64(const size_t n) {
+    return (__mmask64)((1ULL << n) - 1ULL);
+}
+
+}  // namespace
+
+int
+bvec_hamming_distance_avx512(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i sum = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        sum = _mm512_add_epi64(sum, popcount_epi64(_mm512_xor_si512(_mm512_loadu_si512(x + i), _mm512_loadu_si512(y + i))));
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        sum = _mm512_add_epi64(sum, popcount_epi64(_mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, x + i),
+                                                            _mm512_maskz_loadu_epi8(mask, y + i))));
+    }
+    return (int)_mm512_reduce_add_epi64(sum);
+}
+
+void
+bvec_hamming_distance_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                     const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    __m512i sum0 = _mm512_setzero_si512();
+    __m512i sum1 = _mm512_setzero_si512();
+    __m512i sum2 = _mm512_setzero_si512();
+    __m512i sum3 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        const auto mx = _mm512_loadu_si512(x + i);
+        sum0 = _mm512_add_epi64(sum0, popcount_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y0 + i))));
+        sum1 = _mm512_add_epi64(sum1, popcount_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y1 + i))));
+        sum2 = _mm512_add_epi64(sum2, popcount_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y2 + i))));
+        sum3 = _mm512_add_epi64(sum3, popcount_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y3 + i))));
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        const __m512i mx = _mm512_maskz_loadu_epi8(mask, x + i);
+        sum0 = _mm512_add_epi64(sum0, popcount_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y0 + i))));
+        sum1 = _mm512_add_epi64(sum1, popcount_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y1 + i))));
+        sum2 = _mm512_add_epi64(sum2, popcount_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y2 + i))));
+        sum3 = _mm512_add_epi64(sum3, popcount_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y3 + i))));
+    }
+    dis0 = (int)_mm512_reduce_add_epi64(sum0);
+    dis1 = (int)_mm512_reduce_add_epi64(sum1);
+    dis2 = (int)_mm512_reduce_add_epi64(sum2);
+    dis3 = (int)_mm512_reduce_add_epi64(sum3);
+}
+
+float
+bvec_jaccard_distance_avx512(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i sum_num = _mm512_setzero_si512();
+    __m512i sum_den = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        const auto mx = _mm512_loadu_si512(x + i);
+        const auto my = _mm512_loadu_si512(y + i);
+        sum_num = _mm512_add_epi64(sum_num, popcount_epi64(_mm512_and_si512(mx, my)));
+        sum_den = _mm512_add_epi64(sum_den, popcount_epi64(_mm512_or_si512(mx, my)));
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        const __m512i mx = _mm512_maskz_loadu_epi8(mask, x + i);
+        const __m512i my = _mm512_maskz_loadu_epi8(mask, y + i);
+        sum_num = _mm512_add_epi64(sum_num, popcount_epi64(_mm512_and_si512(mx, my)));
+        sum_den = _mm512_add_epi64(sum_den, popcount_epi64(_mm512_or_si512(mx, my)));
+    }
+    const int num = (int)_mm512_reduce_add_epi64(sum_num);
+    const int den = (int)_mm512_reduce_add_epi64(sum_den);
+    return (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+}
+
+void
+bvec_jaccard_distance_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                     const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                     float& dis3) {
+    __m512i sum_num[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()};
+    __m512i sum_den[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()};
+    const uint8_t* y[4] = {y0, y1, y2, y3};
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        const auto mx = _mm512_loadu_si512(x + i);
+        for (size_t j = 0; j < 4; j++) {
+            const auto my = _mm512_loadu_si512(y[j] + i);
+            sum_num[j] = _mm512_add_epi64(sum_num[j], popcount_epi64(_mm512_and_si512(mx, my)));
+            sum_den[j] = _mm512_add_epi64(sum_den[j], popcount_epi64(_mm512_or_si512(mx, my)));
+        }
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        const __m512i mx = _mm512_maskz_loadu_epi8(mask, x + i);
+        for (size_t j = 0; j < 4; j++) {
+            const __m512i my = _mm512_maskz_loadu_epi8(mask, y[j] + i);
+            sum_num[j] = _mm512_add_epi64(sum_num[j], popcount_epi64(_mm512_and_si512(mx, my)));
+            sum_den[j] = _mm512_add_epi64(sum_den[j], popcount_epi64(_mm512_or_si512(mx, my)));
+        }
+    }
+    float dis[4];
+    for (size_t j = 0; j < 4; j++) {
+        const int num = (int)_mm512_reduce_add_epi64(sum_num[j]);
+        const int den = (int)_mm512_reduce_add_epi64(sum_den[j]);
+        dis[j] = (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+    }
+    dis0 = dis[0];
+    dis1 = dis[1];
+    dis2 = dis[2];
+    dis3 = dis[3];
+}
 }  // namespace faiss
 #endif
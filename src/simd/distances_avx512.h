@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "distances_by_ids.h"
 #include "knowhere/operands.h"
 
 namespace faiss {
@@ -25,6 +26,18 @@ fvec_L2sqr_avx512(const float* x, const float* y, size_t d);
 float
 fvec_inner_product_avx512(const float* x, const float* y, size_t d);
 
+/// the kernels above for a dim known at compile time, nullptr for the dims without one
+float (*fvec_inner_product_avx512_for_dim(size_t d))(const float*, const float*, size_t);
+
+float (*fvec_L2sqr_avx512_for_dim(size_t d))(const float*, const float*, size_t);
+
+/// the by-ids loops of the kernels above, with the kernels for the dim inlined
+fvec_by_ids_func
+fvec_inner_product_by_ids_avx512_for_dim(size_t d);
+
+fvec_by_ids_func
+fvec_L2sqr_by_ids_avx512_for_dim(size_t d);
+
 /// L1 distance
 float
 fvec_L1_avx512(const float* x, const float* y, size_t d);
@@ -40,6 +53,12 @@ void
 fvec_inner_product_batch_4_avx512(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
                                   const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
 
+void
+fvec_inner_product_batch_8_avx512(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+                                  const float* y4, const float* y5, const float* y6, const float* y7, const size_t d,
+                                  float& dis0, float& dis1, float& dis2, float& dis3, float& dis4, float& dis5,
+                                  float& dis6, float& dis7);
+
 void
 fvec_L2sqr_batch_4_avx512(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
                           const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
@@ -121,6 +140,14 @@ void
 int8_vec_L2sqr_batch_4_avx512(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2, const int8_t* y3,
                               const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
 
+int32_t
+s8u8_inner_product_avx512(const int8_t* x, const uint8_t* y, size_t d);
+
+void
+s8u8_inner_product_batch_4_avx512(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                                  int32_t& dis3);
+
 ///////////////////////////////////////////////////////////////////////////////
 // for cardinal
 
@@ -146,6 +173,20 @@ fvec_masked_sum_avx512(const float* q, const uint8_t* x, const size_t d);
 int
 rabitq_dp_popcnt_avx512(const uint8_t* q, const uint8_t* x, const size_t d, const size_t nb);
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+int
+bvec_hamming_distance_avx512(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_hamming_distance_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                     const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3);
+float
+bvec_jaccard_distance_avx512(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_jaccard_distance_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                     const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                     float& dis3);
+
 ///////////////////////////////////////////////////////////////////////////////
 // minhash
 int
@@ -165,4 +206,24 @@ u64_jaccard_distance_avx512(const char*, const char*, size_t size, size_t);
 void
 u64_jaccard_distance_batch_4_avx512(const char*, const char*, const char*, const char*, const char*, size_t, size_t,
                                     float&, float&, float&, float&);
+void
+u32_jaccard_distance_batch_16_avx512(const char*, const char* const*, size_t, size_t, float*);
+void
+u64_jaccard_distance_batch_16_avx512(const char*, const char* const*, size_t, size_t, float*);
+
+///////////////////////////////////////////////////////////////////////////////
+// sparse
+void
+fvec_scatter_madd_avx512(float* acc, const uint32_t* ids, const float* vals, size_t n, float q, uint32_t base);
+size_t
+u32_lower_bound_avx512(const uint32_t* data, size_t n, uint32_t key);
+float
+sparse_ip_avx512(const void* x, size_t nx, const void* y, size_t ny);
+float
+sparse_dense_ip_avx512(const void* x, size_t nx, const float* y, size_t dim);
+
+///////////////////////////////////////////////////////////////////////////////
+// pq
+void
+pq8_lut_sum_avx512(const uint8_t* codes, size_t n, size_t nchunks, const float* lut, float* out);
 }  // namespace faiss
@@ -0,0 +1,132 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#if defined(__x86_64__)
+
+#include "distances_avx512bf16.h"
+
+#include <immintrin.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace faiss {
+
+namespace {
+
+// 32 bf16 per register, the ones past d are zero and add nothing
+inline __m512bh
+load_bf16(const knowhere::bf16* x) {
+    return (__m512bh)_mm512_loadu_si512(x);
+}
+
+inline __m512bh
+maskz_load_bf16(const __mmask32 mask, const knowhere::bf16* x) {
+    return (__m512bh)_mm512_maskz_loadu_epi16(mask, x);
+}
+
+inline __mmask32
+tail_mask(const size_t d) {
+    return (__mmask32)((1ULL << d) - 1ULL);
+}
+
+}  // namespace
+
+float
+bf16_vec_inner_product_avx512bf16(const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+    __m512 m512_res = _mm512_setzero_ps();
+    __m512 m512_res_0 = _mm512_setzero_ps();
+    while (d >= 64) {
+        m512_res = _mm512_dpbf16_ps(m512_res, load_bf16(x), load_bf16(y));
+        m512_res_0 = _mm512_dpbf16_ps(m512_res_0, load_bf16(x + 32), load_bf16(y + 32));
+        x += 64;
+        y += 64;
+        d -= 64;
+    }
+    m512_res = m512_res + m512_res_0;
+    if (d >= 32) {
+        m512_res = _mm512_dpbf16_ps(m512_res, load_bf16(x), load_bf16(y));
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    if (d > 0) {
+        const __mmask32 mask = tail_mask(d);
+        m512_res = _mm512_dpbf16_ps(m512_res, maskz_load_bf16(mask, x), maskz_load_bf16(mask, y));
+    }
+    return _mm512_reduce_add_ps(m512_res);
+}
+
+float
+bf16_vec_norm_L2sqr_avx512bf16(const knowhere::bf16* x, size_t d) {
+    __m512 m512_res = _mm512_setzero_ps();
+    __m512 m512_res_0 = _mm512_setzero_ps();
+    while (d >= 64) {
+        auto mx_0 = load_bf16(x);
+        auto mx_1 = load_bf16(x + 32);
+        m512_res = _mm512_dpbf16_ps(m512_res, mx_0, mx_0);
+        m512_res_0 = _mm512_dpbf16_ps(m512_res_0, mx_1, mx_1);
+        x += 64;
+        d -= 64;
+    }
+    m512_res = m512_res + m512_res_0;
+    if (d >= 32) {
+        auto mx = load_bf16(x);
+        m512_res = _mm512_dpbf16_ps(m512_res, mx, mx);
+        x += 32;
+        d -= 32;
+    }
+    if (d > 0) {
+        auto mx = maskz_load_bf16(tail_mask(d), x);
+        m512_res = _mm512_dpbf16_ps(m512_res, mx, mx);
+    }
+    return _mm512_reduce_add_ps(m512_res);
+}
+
+void
+bf16_vec_inner_product_batch_4_avx512bf16(const knowhere::bf16* x, const knowhere::bf16* y0,
+                                          const knowhere::bf16* y1, const knowhere::bf16* y2,
+                                          const knowhere::bf16* y3, const size_t d, float& dis0, float& dis1,
+                                          float& dis2, float& dis3) {
+    __m512 m512_res_0 = _mm512_setzero_ps();
+    __m512 m512_res_1 = _mm512_setzero_ps();
+    __m512 m512_res_2 = _mm512_setzero_ps();
+    __m512 m512_res_3 = _mm512_setzero_ps();
+    size_t cur_d = d;
+    while (cur_d >= 32) {
+        auto mx = load_bf16(x);
+        m512_res_0 = _mm512_dpbf16_ps(m512_res_0, mx, load_bf16(y0));
+        m512_res_1 = _mm512_dpbf16_ps(m512_res_1, mx, load_bf16(y1));
+        m512_res_2 = _mm512_dpbf16_ps(m512_res_2, mx, load_bf16(y2));
+        m512_res_3 = _mm512_dpbf16_ps(m512_res_3, mx, load_bf16(y3));
+        x += 32;
+        y0 += 32;
+        y1 += 32;
+        y2 += 32;
+        y3 += 32;
+        cur_d -= 32;
+    }
+    if (cur_d > 0) {
+        const __mmask32 mask = tail_mask(cur_d);
+        auto mx = maskz_load_bf16(mask, x);
+        m512_res_0 = _mm512_dpbf16_ps(m512_res_0, mx, maskz_load_bf16(mask, y0));
+        m512_res_1 = _mm512_dpbf16_ps(m512_res_1, mx, maskz_load_bf16(mask, y1));
+        m512_res_2 = _mm512_dpbf16_ps(m512_res_2, mx, maskz_load_bf16(mask, y2));
+        m512_res_3 = _mm512_dpbf16_ps(m512_res_3, mx, maskz_load_bf16(mask, y3));
+    }
+    dis0 = _mm512_reduce_add_ps(m512_res_0);
+    dis1 = _mm512_reduce_add_ps(m512_res_1);
+    dis2 = _mm512_reduce_add_ps(m512_res_2);
+    dis3 = _mm512_reduce_add_ps(m512_res_3);
+}
+
+}  // namespace faiss
+#endif
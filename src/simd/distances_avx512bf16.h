@@ -0,0 +1,36 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "knowhere/operands.h"
+
+namespace faiss {
+
+///////////////////////////////////////////////////////////////////////////////
+// bf16, the products are exact and summed in fp32 by the dot-product instruction. L2 is left to the avx512
+// kernels, as ||x||^2 + ||y||^2 - 2<x,y> takes three of them and is slower than widening x - y.
+float
+bf16_vec_inner_product_avx512bf16(const knowhere::bf16* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_norm_L2sqr_avx512bf16(const knowhere::bf16* x, size_t d);
+
+void
+bf16_vec_inner_product_batch_4_avx512bf16(const knowhere::bf16* x, const knowhere::bf16* y0,
+                                          const knowhere::bf16* y1, const knowhere::bf16* y2,
+                                          const knowhere::bf16* y3, const size_t d, float& dis0, float& dis1,
+                                          float& dis2, float& dis3);
+
+}  // namespace faiss
@@ -115,5 +115,121 @@ rabitq_dp_popcnt_avx512icx(const uint8_t* q, const uint8_t* x, const size_t d, c
     return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+namespace {
+
+inline __mmask64
+tail_mask_64(const size_t n) {
+    return (__mmask64)((1ULL << n) - 1ULL);
+}
+
+}  // namespace
+
+int
+bvec_hamming_distance_avx512icx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i sum = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_xor_si512(_mm512_loadu_si512(x + i), _mm512_loadu_si512(y + i))));
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, x + i),
+                                                            _mm512_maskz_loadu_epi8(mask, y + i))));
+    }
+    return (int)_mm512_reduce_add_epi64(sum);
+}
+
+void
+bvec_hamming_distance_batch_4_avx512icx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                        const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2,
+                                        int& dis3) {
+    __m512i sum0 = _mm512_setzero_si512();
+    __m512i sum1 = _mm512_setzero_si512();
+    __m512i sum2 = _mm512_setzero_si512();
+    __m512i sum3 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        const auto mx = _mm512_loadu_si512(x + i);
+        sum0 = _mm512_add_epi64(sum0, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y0 + i))));
+        sum1 = _mm512_add_epi64(sum1, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y1 + i))));
+        sum2 = _mm512_add_epi64(sum2, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y2 + i))));
+        sum3 = _mm512_add_epi64(sum3, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_loadu_si512(y3 + i))));
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        const __m512i mx = _mm512_maskz_loadu_epi8(mask, x + i);
+        sum0 = _mm512_add_epi64(sum0, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y0 + i))));
+        sum1 = _mm512_add_epi64(sum1, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y1 + i))));
+        sum2 = _mm512_add_epi64(sum2, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y2 + i))));
+        sum3 = _mm512_add_epi64(sum3, _mm512_popcnt_epi64(_mm512_xor_si512(mx, _mm512_maskz_loadu_epi8(mask, y3 + i))));
+    }
+    dis0 = (int)_mm512_reduce_add_epi64(sum0);
+    dis1 = (int)_mm512_reduce_add_epi64(sum1);
+    dis2 = (int)_mm512_reduce_add_epi64(sum2);
+    dis3 = (int)_mm512_reduce_add_epi64(sum3);
+}
+
+float
+bvec_jaccard_distance_avx512icx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i sum_num = _mm512_setzero_si512();
+    __m512i sum_den = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        const auto mx = _mm512_loadu_si512(x + i);
+        const auto my = _mm512_loadu_si512(y + i);
+        sum_num = _mm512_add_epi64(sum_num, _mm512_popcnt_epi64(_mm512_and_si512(mx, my)));
+        sum_den = _mm512_add_epi64(sum_den, _mm512_popcnt_epi64(_mm512_or_si512(mx, my)));
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        const __m512i mx = _mm512_maskz_loadu_epi8(mask, x + i);
+        const __m512i my = _mm512_maskz_loadu_epi8(mask, y + i);
+        sum_num = _mm512_add_epi64(sum_num, _mm512_popcnt_epi64(_mm512_and_si512(mx, my)));
+        sum_den = _mm512_add_epi64(sum_den, _mm512_popcnt_epi64(_mm512_or_si512(mx, my)));
+    }
+    const int num = (int)_mm512_reduce_add_epi64(sum_num);
+    const int den = (int)_mm512_reduce_add_epi64(sum_den);
+    return (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+}
+
+void
+bvec_jaccard_distance_batch_4_avx512icx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                        const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                        float& dis3) {
+    __m512i sum_num[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()};
+    __m512i sum_den[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()};
+    const uint8_t* y[4] = {y0, y1, y2, y3};
+    size_t i = 0;
+    for (; i + 64 <= code_size; i += 64) {
+        const auto mx = _mm512_loadu_si512(x + i);
+        for (size_t j = 0; j < 4; j++) {
+            const auto my = _mm512_loadu_si512(y[j] + i);
+            sum_num[j] = _mm512_add_epi64(sum_num[j], _mm512_popcnt_epi64(_mm512_and_si512(mx, my)));
+            sum_den[j] = _mm512_add_epi64(sum_den[j], _mm512_popcnt_epi64(_mm512_or_si512(mx, my)));
+        }
+    }
+    if (i < code_size) {
+        const __mmask64 mask = tail_mask_64(code_size - i);
+        const __m512i mx = _mm512_maskz_loadu_epi8(mask, x + i);
+        for (size_t j = 0; j < 4; j++) {
+            const __m512i my = _mm512_maskz_loadu_epi8(mask, y[j] + i);
+            sum_num[j] = _mm512_add_epi64(sum_num[j], _mm512_popcnt_epi64(_mm512_and_si512(mx, my)));
+            sum_den[j] = _mm512_add_epi64(sum_den[j], _mm512_popcnt_epi64(_mm512_or_si512(mx, my)));
+        }
+    }
+    float dis[4];
+    for (size_t j = 0; j < 4; j++) {
+        const int num = (int)_mm512_reduce_add_epi64(sum_num[j]);
+        const int den = (int)_mm512_reduce_add_epi64(sum_den[j]);
+        dis[j] = (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+    }
+    dis0 = dis[0];
+    dis1 = dis[1];
+    dis2 = dis[2];
+    dis3 = dis[3];
+}
+
 }  // namespace faiss
 #endif
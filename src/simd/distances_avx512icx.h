@@ -21,4 +21,19 @@ namespace faiss {
 int
 rabitq_dp_popcnt_avx512icx(const uint8_t* q, const uint8_t* x, const size_t d, const size_t nb);
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+int
+bvec_hamming_distance_avx512icx(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_hamming_distance_batch_4_avx512icx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                        const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2,
+                                        int& dis3);
+float
+bvec_jaccard_distance_avx512icx(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_jaccard_distance_batch_4_avx512icx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                        const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                        float& dis3);
+
 }  // namespace faiss
@@ -0,0 +1,299 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#if defined(__x86_64__)
+
+#include "distances_avx512vnni.h"
+
+#include <immintrin.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace faiss {
+
+namespace {
+
+// vpdpbusd multiplies unsigned by signed bytes. y + 128 is unsigned, so
+//   sum(x * y) = sum(x * (y + 128)) - 128 * sum(x),
+// the flip of the sign bit adds the 128 and the second sum is one more vpdpbusd of x.
+inline __m512i
+flip_sign(const __m512i y) {
+    return _mm512_xor_si512(y, _mm512_set1_epi8((char)0x80));
+}
+
+inline __mmask64
+tail_mask_64(const size_t d) {
+    return (__mmask64)((1ULL << d) - 1ULL);
+}
+
+inline __mmask32
+tail_mask_32(const size_t d) {
+    return (__mmask32)((1ULL << d) - 1ULL);
+}
+
+// the squares need the signed differences, which take 16 bits
+inline __m512i
+load_epi16(const int8_t* x) {
+    return _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)x));
+}
+
+inline __m512i
+maskz_load_epi16(const __mmask32 mask, const int8_t* x) {
+    return _mm512_cvtepi8_epi16(_mm256_maskz_loadu_epi8(mask, x));
+}
+
+inline int32_t
+inner_product(const int8_t* x, const int8_t* y, size_t d) {
+    const __m512i m512_off = _mm512_set1_epi8((char)0x80);
+    __m512i m512_res = _mm512_setzero_si512();
+    __m512i m512_corr = _mm512_setzero_si512();
+    while (d >= 64) {
+        auto mx = _mm512_loadu_si512(x);
+        m512_res = _mm512_dpbusd_epi32(m512_res, flip_sign(_mm512_loadu_si512(y)), mx);
+        m512_corr = _mm512_dpbusd_epi32(m512_corr, m512_off, mx);
+        x += 64;
+        y += 64;
+        d -= 64;
+    }
+    if (d > 0) {
+        // the masked bytes are zero in x, they add nothing to either sum
+        const __mmask64 mask = tail_mask_64(d);
+        auto mx = _mm512_maskz_loadu_epi8(mask, x);
+        m512_res = _mm512_dpbusd_epi32(m512_res, flip_sign(_mm512_maskz_loadu_epi8(mask, y)), mx);
+        m512_corr = _mm512_dpbusd_epi32(m512_corr, m512_off, mx);
+    }
+    return _mm512_reduce_add_epi32(_mm512_sub_epi32(m512_res, m512_corr));
+}
+
+inline int32_t
+L2sqr(const int8_t* x, const int8_t* y, size_t d) {
+    __m512i m512_res = _mm512_setzero_si512();
+    __m512i m512_res_0 = _mm512_setzero_si512();
+    while (d >= 64) {
+        auto mt_0 = _mm512_sub_epi16(load_epi16(x), load_epi16(y));
+        auto mt_1 = _mm512_sub_epi16(load_epi16(x + 32), load_epi16(y + 32));
+        m512_res = _mm512_dpwssd_epi32(m512_res, mt_0, mt_0);
+        m512_res_0 = _mm512_dpwssd_epi32(m512_res_0, mt_1, mt_1);
+        x += 64;
+        y += 64;
+        d -= 64;
+    }
+    m512_res = _mm512_add_epi32(m512_res, m512_res_0);
+    if (d >= 32) {
+        auto mt = _mm512_sub_epi16(load_epi16(x), load_epi16(y));
+        m512_res = _mm512_dpwssd_epi32(m512_res, mt, mt);
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    if (d > 0) {
+        const __mmask32 mask = tail_mask_32(d);
+        auto mt = _mm512_sub_epi16(maskz_load_epi16(mask, x), maskz_load_epi16(mask, y));
+        m512_res = _mm512_dpwssd_epi32(m512_res, mt, mt);
+    }
+    return _mm512_reduce_add_epi32(m512_res);
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// for hnsw sq, obsolete
+int32_t
+ivec_inner_product_avx512vnni(const int8_t* x, const int8_t* y, size_t d) {
+    return inner_product(x, y, d);
+}
+
+int32_t
+ivec_L2sqr_avx512vnni(const int8_t* x, const int8_t* y, size_t d) {
+    return L2sqr(x, y, d);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// int8
+float
+int8_vec_inner_product_avx512vnni(const int8_t* x, const int8_t* y, size_t d) {
+    return (float)inner_product(x, y, d);
+}
+
+float
+int8_vec_L2sqr_avx512vnni(const int8_t* x, const int8_t* y, size_t d) {
+    return (float)L2sqr(x, y, d);
+}
+
+float
+int8_vec_norm_L2sqr_avx512vnni(const int8_t* x, size_t d) {
+    __m512i m512_res = _mm512_setzero_si512();
+    __m512i m512_res_0 = _mm512_setzero_si512();
+    while (d >= 64) {
+        auto mx_0 = load_epi16(x);
+        auto mx_1 = load_epi16(x + 32);
+        m512_res = _mm512_dpwssd_epi32(m512_res, mx_0, mx_0);
+        m512_res_0 = _mm512_dpwssd_epi32(m512_res_0, mx_1, mx_1);
+        x += 64;
+        d -= 64;
+    }
+    m512_res = _mm512_add_epi32(m512_res, m512_res_0);
+    if (d >= 32) {
+        auto mx = load_epi16(x);
+        m512_res = _mm512_dpwssd_epi32(m512_res, mx, mx);
+        x += 32;
+        d -= 32;
+    }
+    if (d > 0) {
+        auto mx = maskz_load_epi16(tail_mask_32(d), x);
+        m512_res = _mm512_dpwssd_epi32(m512_res, mx, mx);
+    }
+    return (float)_mm512_reduce_add_epi32(m512_res);
+}
+
+void
+int8_vec_inner_product_batch_4_avx512vnni(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2,
+                                          const int8_t* y3, const size_t d, float& dis0, float& dis1, float& dis2,
+                                          float& dis3) {
+    // the correction of x is shared by the four vectors
+    const __m512i m512_off = _mm512_set1_epi8((char)0x80);
+    __m512i m512_corr = _mm512_setzero_si512();
+    __m512i m512_res_0 = _mm512_setzero_si512();
+    __m512i m512_res_1 = _mm512_setzero_si512();
+    __m512i m512_res_2 = _mm512_setzero_si512();
+    __m512i m512_res_3 = _mm512_setzero_si512();
+    size_t cur_d = d;
+    while (cur_d >= 64) {
+        auto mx = _mm512_loadu_si512(x);
+        m512_corr = _mm512_dpbusd_epi32(m512_corr, m512_off, mx);
+        m512_res_0 = _mm512_dpbusd_epi32(m512_res_0, flip_sign(_mm512_loadu_si512(y0)), mx);
+        m512_res_1 = _mm512_dpbusd_epi32(m512_res_1, flip_sign(_mm512_loadu_si512(y1)), mx);
+        m512_res_2 = _mm512_dpbusd_epi32(m512_res_2, flip_sign(_mm512_loadu_si512(y2)), mx);
+        m512_res_3 = _mm512_dpbusd_epi32(m512_res_3, flip_sign(_mm512_loadu_si512(y3)), mx);
+        x += 64;
+        y0 += 64;
+        y1 += 64;
+        y2 += 64;
+        y3 += 64;
+        cur_d -= 64;
+    }
+    if (cur_d > 0) {
+        const __mmask64 mask = tail_mask_64(cur_d);
+        auto mx = _mm512_maskz_loadu_epi8(mask, x);
+        m512_corr = _mm512_dpbusd_epi32(m512_corr, m512_off, mx);
+        m512_res_0 = _mm512_dpbusd_epi32(m512_res_0, flip_sign(_mm512_maskz_loadu_epi8(mask, y0)), mx);
+        m512_res_1 = _mm512_dpbusd_epi32(m512_res_1, flip_sign(_mm512_maskz_loadu_epi8(mask, y1)), mx);
+        m512_res_2 = _mm512_dpbusd_epi32(m512_res_2, flip_sign(_mm512_maskz_loadu_epi8(mask, y2)), mx);
+        m512_res_3 = _mm512_dpbusd_epi32(m512_res_3, flip_sign(_mm512_maskz_loadu_epi8(mask, y3)), mx);
+    }
+    const int32_t corr = _mm512_reduce_add_epi32(m512_corr);
+    dis0 = (float)(_mm512_reduce_add_epi32(m512_res_0) - corr);
+    dis1 = (float)(_mm512_reduce_add_epi32(m512_res_1) - corr);
+    dis2 = (float)(_mm512_reduce_add_epi32(m512_res_2) - corr);
+    dis3 = (float)(_mm512_reduce_add_epi32(m512_res_3) - corr);
+}
+
+void
+int8_vec_L2sqr_batch_4_avx512vnni(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2,
+                                  const int8_t* y3, const size_t d, float& dis0, float& dis1, float& dis2,
+                                  float& dis3) {
+    __m512i m512_res_0 = _mm512_setzero_si512();
+    __m512i m512_res_1 = _mm512_setzero_si512();
+    __m512i m512_res_2 = _mm512_setzero_si512();
+    __m512i m512_res_3 = _mm512_setzero_si512();
+    size_t cur_d = d;
+    while (cur_d >= 32) {
+        auto mx = load_epi16(x);
+        auto mt_0 = _mm512_sub_epi16(mx, load_epi16(y0));
+        auto mt_1 = _mm512_sub_epi16(mx, load_epi16(y1));
+        auto mt_2 = _mm512_sub_epi16(mx, load_epi16(y2));
+        auto mt_3 = _mm512_sub_epi16(mx, load_epi16(y3));
+        m512_res_0 = _mm512_dpwssd_epi32(m512_res_0, mt_0, mt_0);
+        m512_res_1 = _mm512_dpwssd_epi32(m512_res_1, mt_1, mt_1);
+        m512_res_2 = _mm512_dpwssd_epi32(m512_res_2, mt_2, mt_2);
+        m512_res_3 = _mm512_dpwssd_epi32(m512_res_3, mt_3, mt_3);
+        x += 32;
+        y0 += 32;
+        y1 += 32;
+        y2 += 32;
+        y3 += 32;
+        cur_d -= 32;
+    }
+    if (cur_d > 0) {
+        const __mmask32 mask = tail_mask_32(cur_d);
+        auto mx = maskz_load_epi16(mask, x);
+        auto mt_0 = _mm512_sub_epi16(mx, maskz_load_epi16(mask, y0));
+        auto mt_1 = _mm512_sub_epi16(mx, maskz_load_epi16(mask, y1));
+        auto mt_2 = _mm512_sub_epi16(mx, maskz_load_epi16(mask, y2));
+        auto mt_3 = _mm512_sub_epi16(mx, maskz_load_epi16(mask, y3));
+        m512_res_0 = _mm512_dpwssd_epi32(m512_res_0, mt_0, mt_0);
+        m512_res_1 = _mm512_dpwssd_epi32(m512_res_1, mt_1, mt_1);
+        m512_res_2 = _mm512_dpwssd_epi32(m512_res_2, mt_2, mt_2);
+        m512_res_3 = _mm512_dpwssd_epi32(m512_res_3, mt_3, mt_3);
+    }
+    dis0 = (float)_mm512_reduce_add_epi32(m512_res_0);
+    dis1 = (float)_mm512_reduce_add_epi32(m512_res_1);
+    dis2 = (float)_mm512_reduce_add_epi32(m512_res_2);
+    dis3 = (float)_mm512_reduce_add_epi32(m512_res_3);
+}
+
+// vpdpbusd multiplies the unsigned bytes of y by the signed bytes of x as they are, no correction needed
+int32_t
+s8u8_inner_product_avx512vnni(const int8_t* x, const uint8_t* y, size_t d) {
+    __m512i m512_res = _mm512_setzero_si512();
+    while (d >= 64) {
+        m512_res = _mm512_dpbusd_epi32(m512_res, _mm512_loadu_si512(y), _mm512_loadu_si512(x));
+        x += 64;
+        y += 64;
+        d -= 64;
+    }
+    if (d > 0) {
+        const __mmask64 mask = tail_mask_64(d);
+        m512_res =
+            _mm512_dpbusd_epi32(m512_res, _mm512_maskz_loadu_epi8(mask, y), _mm512_maskz_loadu_epi8(mask, x));
+    }
+    return _mm512_reduce_add_epi32(m512_res);
+}
+
+void
+s8u8_inner_product_batch_4_avx512vnni(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                      const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                                      int32_t& dis3) {
+    __m512i m512_res_0 = _mm512_setzero_si512();
+    __m512i m512_res_1 = _mm512_setzero_si512();
+    __m512i m512_res_2 = _mm512_setzero_si512();
+    __m512i m512_res_3 = _mm512_setzero_si512();
+    size_t cur_d = d;
+    while (cur_d >= 64) {
+        auto mx = _mm512_loadu_si512(x);
+        m512_res_0 = _mm512_dpbusd_epi32(m512_res_0, _mm512_loadu_si512(y0), mx);
+        m512_res_1 = _mm512_dpbusd_epi32(m512_res_1, _mm512_loadu_si512(y1), mx);
+        m512_res_2 = _mm512_dpbusd_epi32(m512_res_2, _mm512_loadu_si512(y2), mx);
+        m512_res_3 = _mm512_dpbusd_epi32(m512_res_3, _mm512_loadu_si512(y3), mx);
+        x += 64;
+        y0 += 64;
+        y1 += 64;
+        y2 += 64;
+        y3 += 64;
+        cur_d -= 64;
+    }
+    if (cur_d > 0) {
+        const __mmask64 mask = tail_mask_64(cur_d);
+        auto mx = _mm512_maskz_loadu_epi8(mask, x);
+        m512_res_0 = _mm512_dpbusd_epi32(m512_res_0, _mm512_maskz_loadu_epi8(mask, y0), mx);
+        m512_res_1 = _mm512_dpbusd_epi32(m512_res_1, _mm512_maskz_loadu_epi8(mask, y1), mx);
+        m512_res_2 = _mm512_dpbusd_epi32(m512_res_2, _mm512_maskz_loadu_epi8(mask, y2), mx);
+        m512_res_3 = _mm512_dpbusd_epi32(m512_res_3, _mm512_maskz_loadu_epi8(mask, y3), mx);
+    }
+    dis0 = _mm512_reduce_add_epi32(m512_res_0);
+    dis1 = _mm512_reduce_add_epi32(m512_res_1);
+    dis2 = _mm512_reduce_add_epi32(m512_res_2);
+    dis3 = _mm512_reduce_add_epi32(m512_res_3);
+}
+
+}  // namespace faiss
+#endif
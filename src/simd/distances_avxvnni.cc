@@ -0,0 +1,243 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#if defined(__x86_64__)
+
+#include "distances_avxvnni.h"
+
+#include <immintrin.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace faiss {
+
+namespace {
+
+// see distances_avx512vnni.cc, sum(x * y) = sum(x * (y + 128)) - 128 * sum(x)
+inline __m256i
+flip_sign(const __m256i y) {
+    return _mm256_xor_si256(y, _mm256_set1_epi8((char)0x80));
+}
+
+inline __m256i
+load_epi8(const int8_t* x) {
+    return _mm256_loadu_si256((const __m256i*)x);
+}
+
+inline __m256i
+load_epi16(const int8_t* x) {
+    return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)x));
+}
+
+inline int32_t
+reduce_add_epi32(const __m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+inline int32_t
+inner_product(const int8_t* x, const int8_t* y, size_t d) {
+    const __m256i m256_off = _mm256_set1_epi8((char)0x80);
+    __m256i m256_res = _mm256_setzero_si256();
+    __m256i m256_corr = _mm256_setzero_si256();
+    while (d >= 32) {
+        auto mx = load_epi8(x);
+        m256_res = _mm256_dpbusd_avx_epi32(m256_res, flip_sign(load_epi8(y)), mx);
+        m256_corr = _mm256_dpbusd_avx_epi32(m256_corr, m256_off, mx);
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    int32_t res = reduce_add_epi32(_mm256_sub_epi32(m256_res, m256_corr));
+    // there are no masked byte loads without avx512
+    for (size_t i = 0; i < d; i++) {
+        res += (int32_t)x[i] * (int32_t)y[i];
+    }
+    return res;
+}
+
+inline int32_t
+L2sqr(const int8_t* x, const int8_t* y, size_t d) {
+    __m256i m256_res = _mm256_setzero_si256();
+    __m256i m256_res_0 = _mm256_setzero_si256();
+    while (d >= 32) {
+        auto mt_0 = _mm256_sub_epi16(load_epi16(x), load_epi16(y));
+        auto mt_1 = _mm256_sub_epi16(load_epi16(x + 16), load_epi16(y + 16));
+        m256_res = _mm256_dpwssd_avx_epi32(m256_res, mt_0, mt_0);
+        m256_res_0 = _mm256_dpwssd_avx_epi32(m256_res_0, mt_1, mt_1);
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    m256_res = _mm256_add_epi32(m256_res, m256_res_0);
+    if (d >= 16) {
+        auto mt = _mm256_sub_epi16(load_epi16(x), load_epi16(y));
+        m256_res = _mm256_dpwssd_avx_epi32(m256_res, mt, mt);
+        x += 16;
+        y += 16;
+        d -= 16;
+    }
+    int32_t res = reduce_add_epi32(m256_res);
+    for (size_t i = 0; i < d; i++) {
+        const int32_t tmp = (int32_t)x[i] - (int32_t)y[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// for hnsw sq, obsolete
+int32_t
+ivec_inner_product_avxvnni(const int8_t* x, const int8_t* y, size_t d) {
+    return inner_product(x, y, d);
+}
+
+int32_t
+ivec_L2sqr_avxvnni(const int8_t* x, const int8_t* y, size_t d) {
+    return L2sqr(x, y, d);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// int8
+float
+int8_vec_inner_product_avxvnni(const int8_t* x, const int8_t* y, size_t d) {
+    return (float)inner_product(x, y, d);
+}
+
+float
+int8_vec_L2sqr_avxvnni(const int8_t* x, const int8_t* y, size_t d) {
+    return (float)L2sqr(x, y, d);
+}
+
+float
+int8_vec_norm_L2sqr_avxvnni(const int8_t* x, size_t d) {
+    __m256i m256_res = _mm256_setzero_si256();
+    __m256i m256_res_0 = _mm256_setzero_si256();
+    while (d >= 32) {
+        auto mx_0 = load_epi16(x);
+        auto mx_1 = load_epi16(x + 16);
+        m256_res = _mm256_dpwssd_avx_epi32(m256_res, mx_0, mx_0);
+        m256_res_0 = _mm256_dpwssd_avx_epi32(m256_res_0, mx_1, mx_1);
+        x += 32;
+        d -= 32;
+    }
+    m256_res = _mm256_add_epi32(m256_res, m256_res_0);
+    if (d >= 16) {
+        auto mx = load_epi16(x);
+        m256_res = _mm256_dpwssd_avx_epi32(m256_res, mx, mx);
+        x += 16;
+        d -= 16;
+    }
+    int32_t res = reduce_add_epi32(m256_res);
+    for (size_t i = 0; i < d; i++) {
+        res += (int32_t)x[i] * (int32_t)x[i];
+    }
+    return (float)res;
+}
+
+void
+int8_vec_inner_product_batch_4_avxvnni(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2,
+                                       const int8_t* y3, const size_t d, float& dis0, float& dis1, float& dis2,
+                                       float& dis3) {
+    // the correction of x is shared by the four vectors
+    const __m256i m256_off = _mm256_set1_epi8((char)0x80);
+    __m256i m256_corr = _mm256_setzero_si256();
+    __m256i m256_res_0 = _mm256_setzero_si256();
+    __m256i m256_res_1 = _mm256_setzero_si256();
+    __m256i m256_res_2 = _mm256_setzero_si256();
+    __m256i m256_res_3 = _mm256_setzero_si256();
+    size_t cur_d = d;
+    while (cur_d >= 32) {
+        auto mx = load_epi8(x);
+        m256_corr = _mm256_dpbusd_avx_epi32(m256_corr, m256_off, mx);
+        m256_res_0 = _mm256_dpbusd_avx_epi32(m256_res_0, flip_sign(load_epi8(y0)), mx);
+        m256_res_1 = _mm256_dpbusd_avx_epi32(m256_res_1, flip_sign(load_epi8(y1)), mx);
+        m256_res_2 = _mm256_dpbusd_avx_epi32(m256_res_2, flip_sign(load_epi8(y2)), mx);
+        m256_res_3 = _mm256_dpbusd_avx_epi32(m256_res_3, flip_sign(load_epi8(y3)), mx);
+        x += 32;
+        y0 += 32;
+        y1 += 32;
+        y2 += 32;
+        y3 += 32;
+        cur_d -= 32;
+    }
+    const int32_t corr = reduce_add_epi32(m256_corr);
+    int32_t d0 = reduce_add_epi32(m256_res_0) - corr;
+    int32_t d1 = reduce_add_epi32(m256_res_1) - corr;
+    int32_t d2 = reduce_add_epi32(m256_res_2) - corr;
+    int32_t d3 = reduce_add_epi32(m256_res_3) - corr;
+    for (size_t i = 0; i < cur_d; i++) {
+        auto x_i = (int32_t)x[i];
+        d0 += x_i * (int32_t)y0[i];
+        d1 += x_i * (int32_t)y1[i];
+        d2 += x_i * (int32_t)y2[i];
+        d3 += x_i * (int32_t)y3[i];
+    }
+    dis0 = (float)d0;
+    dis1 = (float)d1;
+    dis2 = (float)d2;
+    dis3 = (float)d3;
+}
+
+void
+int8_vec_L2sqr_batch_4_avxvnni(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2,
+                               const int8_t* y3, const size_t d, float& dis0, float& dis1, float& dis2,
+                               float& dis3) {
+    __m256i m256_res_0 = _mm256_setzero_si256();
+    __m256i m256_res_1 = _mm256_setzero_si256();
+    __m256i m256_res_2 = _mm256_setzero_si256();
+    __m256i m256_res_3 = _mm256_setzero_si256();
+    size_t cur_d = d;
+    while (cur_d >= 16) {
+        auto mx = load_epi16(x);
+        auto mt_0 = _mm256_sub_epi16(mx, load_epi16(y0));
+        auto mt_1 = _mm256_sub_epi16(mx, load_epi16(y1));
+        auto mt_2 = _mm256_sub_epi16(mx, load_epi16(y2));
+        auto mt_3 = _mm256_sub_epi16(mx, load_epi16(y3));
+        m256_res_0 = _mm256_dpwssd_avx_epi32(m256_res_0, mt_0, mt_0);
+        m256_res_1 = _mm256_dpwssd_avx_epi32(m256_res_1, mt_1, mt_1);
+        m256_res_2 = _mm256_dpwssd_avx_epi32(m256_res_2, mt_2, mt_2);
+        m256_res_3 = _mm256_dpwssd_avx_epi32(m256_res_3, mt_3, mt_3);
+        x += 16;
+        y0 += 16;
+        y1 += 16;
+        y2 += 16;
+        y3 += 16;
+        cur_d -= 16;
+    }
+    int32_t d0 = reduce_add_epi32(m256_res_0);
+    int32_t d1 = reduce_add_epi32(m256_res_1);
+    int32_t d2 = reduce_add_epi32(m256_res_2);
+    int32_t d3 = reduce_add_epi32(m256_res_3);
+    for (size_t i = 0; i < cur_d; i++) {
+        auto x_i = (int32_t)x[i];
+        const int32_t q0 = x_i - (int32_t)y0[i];
+        const int32_t q1 = x_i - (int32_t)y1[i];
+        const int32_t q2 = x_i - (int32_t)y2[i];
+        const int32_t q3 = x_i - (int32_t)y3[i];
+        d0 += q0 * q0;
+        d1 += q1 * q1;
+        d2 += q2 * q2;
+        d3 += q3 * q3;
+    }
+    dis0 = (float)d0;
+    dis1 = (float)d1;
+    dis2 = (float)d2;
+    dis3 = (float)d3;
+}
+
+}  // namespace faiss
+#endif
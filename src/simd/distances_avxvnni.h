@@ -0,0 +1,48 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace faiss {
+
+///////////////////////////////////////////////////////////////////////////////
+// for hnsw sq, obsolete
+int32_t
+ivec_inner_product_avxvnni(const int8_t* x, const int8_t* y, size_t d);
+
+int32_t
+ivec_L2sqr_avxvnni(const int8_t* x, const int8_t* y, size_t d);
+
+///////////////////////////////////////////////////////////////////////////////
+// int8, AVX-VNNI is the 256-bit encoding of the same instructions for the cpus without avx512
+float
+int8_vec_inner_product_avxvnni(const int8_t* x, const int8_t* y, size_t d);
+
+float
+int8_vec_L2sqr_avxvnni(const int8_t* x, const int8_t* y, size_t d);
+
+float
+int8_vec_norm_L2sqr_avxvnni(const int8_t* x, size_t d);
+
+void
+int8_vec_inner_product_batch_4_avxvnni(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2,
+                                       const int8_t* y3, const size_t d, float& dis0, float& dis1, float& dis2,
+                                       float& dis3);
+
+void
+int8_vec_L2sqr_batch_4_avxvnni(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2,
+                               const int8_t* y3, const size_t d, float& dis0, float& dis1, float& dis2,
+                               float& dis3);
+
+}  // namespace faiss
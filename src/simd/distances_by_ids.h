@@ -0,0 +1,44 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace faiss {
+
+/// the distances of a query x to the vectors ids[0..n) of the d-dim vectors y, the vectors prefetch_distance
+/// positions ahead being brought to the cache meanwhile, the first prefetch_distance ones are expected to be there.
+using fvec_by_ids_func = void (*)(const float* x, const float* y, size_t d, const int32_t* ids, size_t n,
+                                  size_t prefetch_distance, float* dis);
+
+// The loop of the by-ids kernels, compiled in the translation unit of an instruction set so that Kernel::call is
+// inlined in it instead of being called through a hook for every distance.
+template <typename Kernel>
+void
+fvec_by_ids(const float* x, const float* y, size_t d, const int32_t* ids, size_t n, size_t prefetch_distance,
+            float* dis) {
+    // as FlatCodesDistanceComputer::prefetch, the hardware prefetcher follows the longer vectors
+    const size_t prefetch_bytes = std::min<size_t>(d * sizeof(float), 256);
+    for (size_t i = 0; i < n; i++) {
+        if (prefetch_distance > 0 && i + prefetch_distance < n) {
+            const char* ahead = reinterpret_cast<const char*>(y + size_t(ids[i + prefetch_distance]) * d);
+            for (size_t offset = 0; offset < prefetch_bytes; offset += 64) {
+                __builtin_prefetch(ahead + offset, 0, 3);
+            }
+        }
+        dis[i] = Kernel::call(x, y + size_t(ids[i]) * d, d);
+    }
+}
+
+}  // namespace faiss
@@ -2927,6 +2927,65 @@ int8_vec_L2sqr_batch_4_neon(const int8_t* x, const int8_t* y0, const int8_t* y1,
     dis3 = static_cast<float>(vaddvq_s32(sum3) + rem_sum3);
 }
 
+namespace {
+
+// the products of the 8 int8 of x with the 8 uint8 of y, accumulated into acc
+inline int32x4_t
+s8u8_madd(int32x4_t acc, const int8x8_t x, const uint8x8_t y) {
+    const int16x8_t x16 = vmovl_s8(x);
+    const int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(y));
+    acc = vmlal_s16(acc, vget_low_s16(x16), vget_low_s16(y16));
+    return vmlal_s16(acc, vget_high_s16(x16), vget_high_s16(y16));
+}
+
+}  // namespace
+
+int32_t
+s8u8_inner_product_neon(const int8_t* x, const uint8_t* y, size_t d) {
+    int32x4_t sum_ = vdupq_n_s32(0);
+    while (d >= 8) {
+        sum_ = s8u8_madd(sum_, vld1_s8(x), vld1_u8(y));
+        x += 8;
+        y += 8;
+        d -= 8;
+    }
+    int32_t res = vaddvq_s32(sum_);
+    for (size_t i = 0; i < d; i++) {
+        res += (int32_t)x[i] * (int32_t)y[i];
+    }
+    return res;
+}
+
+void
+s8u8_inner_product_batch_4_neon(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                                int32_t& dis3) {
+    int32x4_t sum_0 = vdupq_n_s32(0);
+    int32x4_t sum_1 = vdupq_n_s32(0);
+    int32x4_t sum_2 = vdupq_n_s32(0);
+    int32x4_t sum_3 = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 8 <= d; i += 8) {
+        const int8x8_t mx = vld1_s8(x + i);
+        sum_0 = s8u8_madd(sum_0, mx, vld1_u8(y0 + i));
+        sum_1 = s8u8_madd(sum_1, mx, vld1_u8(y1 + i));
+        sum_2 = s8u8_madd(sum_2, mx, vld1_u8(y2 + i));
+        sum_3 = s8u8_madd(sum_3, mx, vld1_u8(y3 + i));
+    }
+    int32_t d0 = vaddvq_s32(sum_0), d1 = vaddvq_s32(sum_1), d2 = vaddvq_s32(sum_2), d3 = vaddvq_s32(sum_3);
+    for (; i < d; ++i) {
+        auto x_i = (int32_t)x[i];
+        d0 += x_i * (int32_t)y0[i];
+        d1 += x_i * (int32_t)y1[i];
+        d2 += x_i * (int32_t)y2[i];
+        d3 += x_i * (int32_t)y3[i];
+    }
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // for cardinal
 
@@ -3520,5 +3579,114 @@ fvec_L2sqr_batch_4_bf16_patch_neon(const float* x, const float* y0, const float*
     dis3 = vaddvq_f32(sum_.val[3]);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+namespace {
+
+// cnt counts the bits of the bytes, the pairwise adds widen them into the 32-bit lanes
+inline uint32x4_t
+popcount_acc_u32(const uint32x4_t acc, const uint8x16_t v) {
+    return vpadalq_u16(acc, vpaddlq_u8(vcntq_u8(v)));
+}
+
+}  // namespace
+
+int
+bvec_hamming_distance_neon(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    uint32x4_t sum = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= code_size; i += 16) {
+        sum = popcount_acc_u32(sum, veorq_u8(vld1q_u8(x + i), vld1q_u8(y + i)));
+    }
+    int res = (int)vaddvq_u32(sum);
+    for (; i < code_size; i++) {
+        res += __builtin_popcount(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+void
+bvec_hamming_distance_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                   const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    uint32x4_t sum0 = vdupq_n_u32(0);
+    uint32x4_t sum1 = vdupq_n_u32(0);
+    uint32x4_t sum2 = vdupq_n_u32(0);
+    uint32x4_t sum3 = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= code_size; i += 16) {
+        const uint8x16_t mx = vld1q_u8(x + i);
+        sum0 = popcount_acc_u32(sum0, veorq_u8(mx, vld1q_u8(y0 + i)));
+        sum1 = popcount_acc_u32(sum1, veorq_u8(mx, vld1q_u8(y1 + i)));
+        sum2 = popcount_acc_u32(sum2, veorq_u8(mx, vld1q_u8(y2 + i)));
+        sum3 = popcount_acc_u32(sum3, veorq_u8(mx, vld1q_u8(y3 + i)));
+    }
+    int d0 = (int)vaddvq_u32(sum0);
+    int d1 = (int)vaddvq_u32(sum1);
+    int d2 = (int)vaddvq_u32(sum2);
+    int d3 = (int)vaddvq_u32(sum3);
+    for (; i < code_size; i++) {
+        d0 += __builtin_popcount(x[i] ^ y0[i]);
+        d1 += __builtin_popcount(x[i] ^ y1[i]);
+        d2 += __builtin_popcount(x[i] ^ y2[i]);
+        d3 += __builtin_popcount(x[i] ^ y3[i]);
+    }
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+}
+
+float
+bvec_jaccard_distance_neon(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    uint32x4_t sum_num = vdupq_n_u32(0);
+    uint32x4_t sum_den = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= code_size; i += 16) {
+        const uint8x16_t mx = vld1q_u8(x + i);
+        const uint8x16_t my = vld1q_u8(y + i);
+        sum_num = popcount_acc_u32(sum_num, vandq_u8(mx, my));
+        sum_den = popcount_acc_u32(sum_den, vorrq_u8(mx, my));
+    }
+    int num = (int)vaddvq_u32(sum_num);
+    int den = (int)vaddvq_u32(sum_den);
+    for (; i < code_size; i++) {
+        num += __builtin_popcount(x[i] & y[i]);
+        den += __builtin_popcount(x[i] | y[i]);
+    }
+    return (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+}
+
+void
+bvec_jaccard_distance_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                   const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                   float& dis3) {
+    uint32x4_t sum_num[4] = {vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0)};
+    uint32x4_t sum_den[4] = {vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0)};
+    const uint8_t* y[4] = {y0, y1, y2, y3};
+    size_t i = 0;
+    for (; i + 16 <= code_size; i += 16) {
+        const uint8x16_t mx = vld1q_u8(x + i);
+        for (size_t j = 0; j < 4; j++) {
+            const uint8x16_t my = vld1q_u8(y[j] + i);
+            sum_num[j] = popcount_acc_u32(sum_num[j], vandq_u8(mx, my));
+            sum_den[j] = popcount_acc_u32(sum_den[j], vorrq_u8(mx, my));
+        }
+    }
+    float dis[4];
+    for (size_t j = 0; j < 4; j++) {
+        int num = (int)vaddvq_u32(sum_num[j]);
+        int den = (int)vaddvq_u32(sum_den[j]);
+        for (size_t k = i; k < code_size; k++) {
+            num += __builtin_popcount(x[k] & y[j][k]);
+            den += __builtin_popcount(x[k] | y[j][k]);
+        }
+        dis[j] = (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+    }
+    dis0 = dis[0];
+    dis1 = dis[1];
+    dis2 = dis[2];
+    dis3 = dis[3];
+}
+
 }  // namespace faiss
 #endif
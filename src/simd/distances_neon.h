@@ -144,6 +144,14 @@ void
 int8_vec_L2sqr_batch_4_neon(const int8_t* x, const int8_t* y0, const int8_t* y1, const int8_t* y2, const int8_t* y3,
                             const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
 
+int32_t
+s8u8_inner_product_neon(const int8_t* x, const uint8_t* y, size_t d);
+
+void
+s8u8_inner_product_batch_4_neon(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                                int32_t& dis3);
+
 ///////////////////////////////////////////////////////////////////////////////
 // for cardinal
 
@@ -162,4 +170,18 @@ void
 fvec_L2sqr_batch_4_bf16_patch_neon(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
                                    const size_t dim, float& dis0, float& dis1, float& dis2, float& dis3);
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+int
+bvec_hamming_distance_neon(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_hamming_distance_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                   const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3);
+float
+bvec_jaccard_distance_neon(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_jaccard_distance_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                   const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                   float& dis3);
+
 }  // namespace faiss
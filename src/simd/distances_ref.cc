@@ -11,7 +11,9 @@
 
 #include "distances_ref.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "knowhere/operands.h"
 #include "xxhash.h"
@@ -186,6 +188,35 @@ fvec_inner_product_batch_4_ref(const float* __restrict x, const float* __restric
     dis3 = d3;
 }
 
+void
+fvec_inner_product_batch_8_ref(const float* __restrict x, const float* __restrict y0, const float* __restrict y1,
+                               const float* __restrict y2, const float* __restrict y3, const float* __restrict y4,
+                               const float* __restrict y5, const float* __restrict y6, const float* __restrict y7,
+                               const size_t d, float& dis0, float& dis1, float& dis2, float& dis3, float& dis4,
+                               float& dis5, float& dis6, float& dis7) {
+    float d0 = 0, d1 = 0, d2 = 0, d3 = 0, d4 = 0, d5 = 0, d6 = 0, d7 = 0;
+
+    for (size_t i = 0; i < d; ++i) {
+        d0 += x[i] * y0[i];
+        d1 += x[i] * y1[i];
+        d2 += x[i] * y2[i];
+        d3 += x[i] * y3[i];
+        d4 += x[i] * y4[i];
+        d5 += x[i] * y5[i];
+        d6 += x[i] * y6[i];
+        d7 += x[i] * y7[i];
+    }
+
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+    dis4 = d4;
+    dis5 = d5;
+    dis6 = d6;
+    dis7 = d7;
+}
+
 void
 fvec_L2sqr_batch_4_ref(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
                        const size_t d, float& dis0, float& dis1, float& dis2, float& dis3) {
@@ -454,6 +485,35 @@ int8_vec_L2sqr_batch_4_ref(const int8_t* x, const int8_t* y0, const int8_t* y1,
     dis3 = (float)d3;
 }
 
+int32_t
+s8u8_inner_product_ref(const int8_t* x, const uint8_t* y, size_t d) {
+    int32_t res = 0;
+    for (size_t i = 0; i < d; i++) {
+        res += (int32_t)x[i] * (int32_t)y[i];
+    }
+    return res;
+}
+
+void
+s8u8_inner_product_batch_4_ref(const int8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                               const uint8_t* y3, const size_t d, int32_t& dis0, int32_t& dis1, int32_t& dis2,
+                               int32_t& dis3) {
+    int32_t d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+
+    for (size_t i = 0; i < d; ++i) {
+        auto x_i = (int32_t)x[i];
+        d0 += x_i * (int32_t)y0[i];
+        d1 += x_i * (int32_t)y1[i];
+        d2 += x_i * (int32_t)y2[i];
+        d3 += x_i * (int32_t)y3[i];
+    }
+
+    dis0 = d0;
+    dis1 = d1;
+    dis2 = d2;
+    dis3 = d3;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // for cardinal
 
@@ -567,6 +627,47 @@ rabitq_dp_popcnt_ref(const uint8_t* q, const uint8_t* x, const size_t d, const s
     return dot;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+int
+bvec_hamming_distance_ref(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int res = 0;
+    for (size_t i = 0; i < code_size; i++) {
+        res += __builtin_popcount(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+void
+bvec_hamming_distance_batch_4_ref(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    dis0 = bvec_hamming_distance_ref(x, y0, code_size);
+    dis1 = bvec_hamming_distance_ref(x, y1, code_size);
+    dis2 = bvec_hamming_distance_ref(x, y2, code_size);
+    dis3 = bvec_hamming_distance_ref(x, y3, code_size);
+}
+
+float
+bvec_jaccard_distance_ref(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int num = 0;
+    int den = 0;
+    for (size_t i = 0; i < code_size; i++) {
+        num += __builtin_popcount(x[i] & y[i]);
+        den += __builtin_popcount(x[i] | y[i]);
+    }
+    return (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+}
+
+void
+bvec_jaccard_distance_batch_4_ref(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                  float& dis3) {
+    dis0 = bvec_jaccard_distance_ref(x, y0, code_size);
+    dis1 = bvec_jaccard_distance_ref(x, y1, code_size);
+    dis2 = bvec_jaccard_distance_ref(x, y2, code_size);
+    dis3 = bvec_jaccard_distance_ref(x, y3, code_size);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // minhash
 float
@@ -717,5 +818,86 @@ u64_jaccard_distance_batch_4_ref(const char* x, const char* y0, const char* y1,
     dis3 /= element_length;
     return;
 }
+void
+u32_jaccard_distance_batch_16_ref(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                  float* dis) {
+    for (size_t j = 0; j < 16; j++) {
+        dis[j] = u32_jaccard_distance_ref(x, y[j], element_length, element_size);
+    }
+}
+void
+u64_jaccard_distance_batch_16_ref(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                  float* dis) {
+    for (size_t j = 0; j < 16; j++) {
+        dis[j] = u64_jaccard_distance_ref(x, y[j], element_length, element_size);
+    }
+}
+
+void
+fvec_scatter_madd_ref(float* acc, const uint32_t* ids, const float* vals, size_t n, float q, uint32_t base) {
+    for (size_t i = 0; i < n; i++) {
+        acc[ids[i] - base] += q * vals[i];
+    }
+}
+
+size_t
+u32_lower_bound_ref(const uint32_t* data, size_t n, uint32_t key) {
+    return std::lower_bound(data, data + n, key) - data;
+}
+
+float
+sparse_ip_ref(const void* x, size_t nx, const void* y, size_t ny) {
+    // the pairs are 8 bytes, an id and a value
+    const auto* x_u32 = (const uint32_t*)x;
+    const auto* y_u32 = (const uint32_t*)y;
+    float res = 0.0f;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < nx && j < ny) {
+        const uint32_t x_id = x_u32[2 * i];
+        const uint32_t y_id = y_u32[2 * j];
+        if (x_id < y_id) {
+            ++i;
+        } else if (x_id > y_id) {
+            ++j;
+        } else {
+            float x_val;
+            float y_val;
+            std::memcpy(&x_val, x_u32 + 2 * i + 1, sizeof(float));
+            std::memcpy(&y_val, y_u32 + 2 * j + 1, sizeof(float));
+            res += x_val * y_val;
+            ++i;
+            ++j;
+        }
+    }
+    return res;
+}
+
+float
+sparse_dense_ip_ref(const void* x, size_t nx, const float* y, size_t dim) {
+    const auto* x_u32 = (const uint32_t*)x;
+    float res = 0.0f;
+    for (size_t i = 0; i < nx; ++i) {
+        const uint32_t id = x_u32[2 * i];
+        if (id < dim) {
+            float val;
+            std::memcpy(&val, x_u32 + 2 * i + 1, sizeof(float));
+            res += val * y[id];
+        }
+    }
+    return res;
+}
+
+void
+pq8_lut_sum_ref(const uint8_t* codes, size_t n, size_t nchunks, const float* lut, float* out) {
+    // chunk by chunk, so that a single table of 256 entries is hot at a time
+    std::fill(out, out + n, 0.0f);
+    for (size_t c = 0; c < nchunks; c++) {
+        const float* chunk_lut = lut + 256 * c;
+        for (size_t i = 0; i < n; i++) {
+            out[i] += chunk_lut[codes[i * nchunks + c]];
+        }
+    }
+}
 
 }  // namespace faiss
@@ -583,6 +583,59 @@ rabitq_dp_popcnt_sse(const uint8_t* q, const uint8_t* x, const size_t d, const s
     return dot;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// binary
+// popcnt takes 8 bytes at a time, which is as fast as sse gets, so the batch kernels are four calls
+int
+bvec_hamming_distance_sse(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int res = 0;
+    size_t i = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        res += __builtin_popcountll(*(const uint64_t*)(x + i) ^ *(const uint64_t*)(y + i));
+    }
+    for (; i < code_size; i++) {
+        res += __builtin_popcount(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+void
+bvec_hamming_distance_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    dis0 = bvec_hamming_distance_sse(x, y0, code_size);
+    dis1 = bvec_hamming_distance_sse(x, y1, code_size);
+    dis2 = bvec_hamming_distance_sse(x, y2, code_size);
+    dis3 = bvec_hamming_distance_sse(x, y3, code_size);
+}
+
+float
+bvec_jaccard_distance_sse(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int num = 0;
+    int den = 0;
+    size_t i = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        const auto xv = *(const uint64_t*)(x + i);
+        const auto yv = *(const uint64_t*)(y + i);
+        num += __builtin_popcountll(xv & yv);
+        den += __builtin_popcountll(xv | yv);
+    }
+    for (; i < code_size; i++) {
+        num += __builtin_popcount(x[i] & y[i]);
+        den += __builtin_popcount(x[i] | y[i]);
+    }
+    return (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+}
+
+void
+bvec_jaccard_distance_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                  float& dis3) {
+    dis0 = bvec_jaccard_distance_sse(x, y0, code_size);
+    dis1 = bvec_jaccard_distance_sse(x, y1, code_size);
+    dis2 = bvec_jaccard_distance_sse(x, y2, code_size);
+    dis3 = bvec_jaccard_distance_sse(x, y3, code_size);
+}
+
 uint64_t
 calculate_hash_sse(const char* data, size_t size) {
     return XXH3_64bits(data, size);
@@ -974,6 +974,344 @@ bf16_vec_inner_product_batch_4_sve(const knowhere::bf16* x, const knowhere::bf16
     dis3 = svaddv_f32(svptrue_b32(), acc3);
 }
 
+void
+fvec_scatter_madd_sve(float* acc, const uint32_t* ids, const float* vals, size_t n, float q, uint32_t base) {
+    size_t i = 0;
+    svbool_t pg = svptrue_b32();
+
+    while (i < n) {
+        if (n - i < svcntw())
+            pg = svwhilelt_b32(i, n);
+
+        svuint32_t idx = svsub_n_u32_x(pg, svld1_u32(pg, ids + i), base);
+        svfloat32_t v = svld1_f32(pg, vals + i);
+        svfloat32_t a = svld1_gather_u32index_f32(pg, acc, idx);
+        a = svmla_n_f32_x(pg, a, v, q);
+        svst1_scatter_u32index_f32(pg, acc, idx, a);
+        i += svcntw();
+    }
+}
+
+size_t
+u32_lower_bound_sve(const uint32_t* data, size_t n, uint32_t key) {
+    size_t i = 0;
+    svbool_t pg = svptrue_b32();
+
+    while (i < n) {
+        if (n - i < svcntw())
+            pg = svwhilelt_b32(i, n);
+
+        svuint32_t v_data = svld1_u32(pg, data + i);
+        svbool_t lt = svcmplt_n_u32(pg, v_data, key);
+        uint64_t lt_count = svcntp_b32(pg, lt);
+        if (lt_count < svcntp_b32(pg, pg)) {
+            return i + lt_count;
+        }
+        i += svcntw();
+    }
+    return n;
+}
+
+void
+u32_jaccard_distance_batch_16_sve(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                  float* dis) {
+    const uint32_t* u32_x = reinterpret_cast<const uint32_t*>(x);
+    uint64_t d[16] = {};
+    for (size_t i = 0; i < element_length; i += svcntw()) {
+        svbool_t pg = svwhilelt_b32(i, element_length);
+        svuint32_t mx = svld1_u32(pg, u32_x + i);
+        for (size_t j = 0; j < 16; j++) {
+            svuint32_t my = svld1_u32(pg, reinterpret_cast<const uint32_t*>(y[j]) + i);
+            d[j] += svcntp_b32(pg, svcmpeq_u32(pg, mx, my));
+        }
+    }
+    for (size_t j = 0; j < 16; j++) {
+        dis[j] = float(d[j]) / float(element_length);
+    }
+}
+
+void
+u64_jaccard_distance_batch_16_sve(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                  float* dis) {
+    const uint64_t* u64_x = reinterpret_cast<const uint64_t*>(x);
+    uint64_t d[16] = {};
+    for (size_t i = 0; i < element_length; i += svcntd()) {
+        svbool_t pg = svwhilelt_b64(i, element_length);
+        svuint64_t mx = svld1_u64(pg, u64_x + i);
+        for (size_t j = 0; j < 16; j++) {
+            svuint64_t my = svld1_u64(pg, reinterpret_cast<const uint64_t*>(y[j]) + i);
+            d[j] += svcntp_b64(pg, svcmpeq_u64(pg, mx, my));
+        }
+    }
+    for (size_t j = 0; j < 16; j++) {
+        dis[j] = float(d[j]) / float(element_length);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// binary
+// the inactive bytes of the last iteration load as zeros and count nothing. udot by ones sums the byte counts into
+// the 32-bit lanes.
+int
+bvec_hamming_distance_sve(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    svuint32_t sum = svdup_n_u32(0);
+    for (size_t i = 0; i < code_size; i += svcntb()) {
+        const svbool_t pg = svwhilelt_b8(i, code_size);
+        const svuint8_t cnt = svcnt_u8_z(pg, sveor_u8_z(pg, svld1_u8(pg, x + i), svld1_u8(pg, y + i)));
+        sum = svdot_n_u32(sum, cnt, 1);
+    }
+    return (int)svaddv_u32(svptrue_b32(), sum);
+}
+
+void
+bvec_hamming_distance_batch_4_sve(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    svuint32_t sum0 = svdup_n_u32(0);
+    svuint32_t sum1 = svdup_n_u32(0);
+    svuint32_t sum2 = svdup_n_u32(0);
+    svuint32_t sum3 = svdup_n_u32(0);
+    for (size_t i = 0; i < code_size; i += svcntb()) {
+        const svbool_t pg = svwhilelt_b8(i, code_size);
+        const svuint8_t mx = svld1_u8(pg, x + i);
+        sum0 = svdot_n_u32(sum0, svcnt_u8_z(pg, sveor_u8_z(pg, mx, svld1_u8(pg, y0 + i))), 1);
+        sum1 = svdot_n_u32(sum1, svcnt_u8_z(pg, sveor_u8_z(pg, mx, svld1_u8(pg, y1 + i))), 1);
+        sum2 = svdot_n_u32(sum2, svcnt_u8_z(pg, sveor_u8_z(pg, mx, svld1_u8(pg, y2 + i))), 1);
+        sum3 = svdot_n_u32(sum3, svcnt_u8_z(pg, sveor_u8_z(pg, mx, svld1_u8(pg, y3 + i))), 1);
+    }
+    const svbool_t pg32 = svptrue_b32();
+    dis0 = (int)svaddv_u32(pg32, sum0);
+    dis1 = (int)svaddv_u32(pg32, sum1);
+    dis2 = (int)svaddv_u32(pg32, sum2);
+    dis3 = (int)svaddv_u32(pg32, sum3);
+}
+
+float
+bvec_jaccard_distance_sve(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    svuint32_t sum_num = svdup_n_u32(0);
+    svuint32_t sum_den = svdup_n_u32(0);
+    for (size_t i = 0; i < code_size; i += svcntb()) {
+        const svbool_t pg = svwhilelt_b8(i, code_size);
+        const svuint8_t mx = svld1_u8(pg, x + i);
+        const svuint8_t my = svld1_u8(pg, y + i);
+        sum_num = svdot_n_u32(sum_num, svcnt_u8_z(pg, svand_u8_z(pg, mx, my)), 1);
+        sum_den = svdot_n_u32(sum_den, svcnt_u8_z(pg, svorr_u8_z(pg, mx, my)), 1);
+    }
+    const int num = (int)svaddv_u32(svptrue_b32(), sum_num);
+    const int den = (int)svaddv_u32(svptrue_b32(), sum_den);
+    return (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+}
+
+void
+bvec_jaccard_distance_batch_4_sve(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                  float& dis3) {
+    svuint32_t sum_num[4] = {svdup_n_u32(0), svdup_n_u32(0), svdup_n_u32(0), svdup_n_u32(0)};
+    svuint32_t sum_den[4] = {svdup_n_u32(0), svdup_n_u32(0), svdup_n_u32(0), svdup_n_u32(0)};
+    const uint8_t* y[4] = {y0, y1, y2, y3};
+    for (size_t i = 0; i < code_size; i += svcntb()) {
+        const svbool_t pg = svwhilelt_b8(i, code_size);
+        const svuint8_t mx = svld1_u8(pg, x + i);
+        for (size_t j = 0; j < 4; j++) {
+            const svuint8_t my = svld1_u8(pg, y[j] + i);
+            sum_num[j] = svdot_n_u32(sum_num[j], svcnt_u8_z(pg, svand_u8_z(pg, mx, my)), 1);
+            sum_den[j] = svdot_n_u32(sum_den[j], svcnt_u8_z(pg, svorr_u8_z(pg, mx, my)), 1);
+        }
+    }
+    float dis[4];
+    for (size_t j = 0; j < 4; j++) {
+        const int num = (int)svaddv_u32(svptrue_b32(), sum_num[j]);
+        const int den = (int)svaddv_u32(svptrue_b32(), sum_den[j]);
+        dis[j] = (den == 0) ? 1.0f : (float)(den - num) / (float)den;
+    }
+    dis0 = dis[0];
+    dis1 = dis[1];
+    dis2 = dis[2];
+    dis3 = dis[3];
+}
+
+#if defined(__ARM_FEATURE_SVE2)
+// fmlalb and fmlalt multiply the even and the odd fp16 lanes into fp32, the inputs need no conversion. fcvtlt
+// widens the odd lanes, which the sve kernels take with a trn2 and a fcvt.
+float
+fp16_vec_inner_product_sve2(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    svfloat32_t sum_even = svdup_f32(0.0f);
+    svfloat32_t sum_odd = svdup_f32(0.0f);
+    size_t i = 0;
+
+    svbool_t pg_16 = svptrue_b16();
+
+    while (i < d) {
+        if (d - i < svcnth())
+            pg_16 = svwhilelt_b16(i, d);
+
+        svfloat16_t a_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(x + i));
+        svfloat16_t b_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y + i));
+
+        sum_even = svmlalb_f32(sum_even, a_fp16, b_fp16);
+        sum_odd = svmlalt_f32(sum_odd, a_fp16, b_fp16);
+
+        i += svcnth();
+    }
+
+    svbool_t pg_32 = svptrue_b32();
+    return svaddv_f32(pg_32, svadd_f32_x(pg_32, sum_even, sum_odd));
+}
+
+float
+fp16_vec_L2sqr_sve2(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    svfloat32_t sum_even = svdup_f32(0.0f);
+    svfloat32_t sum_odd = svdup_f32(0.0f);
+    size_t i = 0;
+
+    svbool_t pg_16 = svptrue_b16();
+    svbool_t pg_32 = svptrue_b32();
+
+    while (i < d) {
+        if (d - i < svcnth())
+            pg_16 = svwhilelt_b16(i, d);
+
+        svfloat16_t a_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(x + i));
+        svfloat16_t b_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y + i));
+
+        // the differences are taken in fp32, fp16 would round them and overflow
+        svfloat32_t diff_even =
+            svsub_f32_x(pg_32, svcvt_f32_f16_x(pg_32, a_fp16), svcvt_f32_f16_x(pg_32, b_fp16));
+        svfloat32_t diff_odd =
+            svsub_f32_x(pg_32, svcvtlt_f32_f16_x(pg_32, a_fp16), svcvtlt_f32_f16_x(pg_32, b_fp16));
+
+        sum_even = svmla_f32_x(pg_32, sum_even, diff_even, diff_even);
+        sum_odd = svmla_f32_x(pg_32, sum_odd, diff_odd, diff_odd);
+
+        i += svcnth();
+    }
+
+    return svaddv_f32(pg_32, svadd_f32_x(pg_32, sum_even, sum_odd));
+}
+
+float
+fp16_vec_norm_L2sqr_sve2(const knowhere::fp16* x, size_t d) {
+    svfloat32_t sum_even = svdup_f32(0.0f);
+    svfloat32_t sum_odd = svdup_f32(0.0f);
+    size_t i = 0;
+
+    svbool_t pg_16 = svptrue_b16();
+
+    while (i < d) {
+        if (d - i < svcnth())
+            pg_16 = svwhilelt_b16(i, d);
+
+        svfloat16_t a_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(x + i));
+
+        sum_even = svmlalb_f32(sum_even, a_fp16, a_fp16);
+        sum_odd = svmlalt_f32(sum_odd, a_fp16, a_fp16);
+
+        i += svcnth();
+    }
+
+    svbool_t pg_32 = svptrue_b32();
+    return svaddv_f32(pg_32, svadd_f32_x(pg_32, sum_even, sum_odd));
+}
+
+void
+fp16_vec_inner_product_batch_4_sve2(const knowhere::fp16* x, const knowhere::fp16* y0, const knowhere::fp16* y1,
+                                    const knowhere::fp16* y2, const knowhere::fp16* y3, const size_t d, float& dis0,
+                                    float& dis1, float& dis2, float& dis3) {
+    svfloat32_t sum0_even = svdup_f32(0.0f);
+    svfloat32_t sum0_odd = svdup_f32(0.0f);
+    svfloat32_t sum1_even = svdup_f32(0.0f);
+    svfloat32_t sum1_odd = svdup_f32(0.0f);
+    svfloat32_t sum2_even = svdup_f32(0.0f);
+    svfloat32_t sum2_odd = svdup_f32(0.0f);
+    svfloat32_t sum3_even = svdup_f32(0.0f);
+    svfloat32_t sum3_odd = svdup_f32(0.0f);
+    size_t i = 0;
+
+    svbool_t pg_16 = svptrue_b16();
+
+    while (i < d) {
+        if (d - i < svcnth())
+            pg_16 = svwhilelt_b16(i, d);
+
+        svfloat16_t x_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(x + i));
+        svfloat16_t y0_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y0 + i));
+        svfloat16_t y1_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y1 + i));
+        svfloat16_t y2_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y2 + i));
+        svfloat16_t y3_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y3 + i));
+
+        sum0_even = svmlalb_f32(sum0_even, x_fp16, y0_fp16);
+        sum0_odd = svmlalt_f32(sum0_odd, x_fp16, y0_fp16);
+        sum1_even = svmlalb_f32(sum1_even, x_fp16, y1_fp16);
+        sum1_odd = svmlalt_f32(sum1_odd, x_fp16, y1_fp16);
+        sum2_even = svmlalb_f32(sum2_even, x_fp16, y2_fp16);
+        sum2_odd = svmlalt_f32(sum2_odd, x_fp16, y2_fp16);
+        sum3_even = svmlalb_f32(sum3_even, x_fp16, y3_fp16);
+        sum3_odd = svmlalt_f32(sum3_odd, x_fp16, y3_fp16);
+
+        i += svcnth();
+    }
+
+    svbool_t pg_32 = svptrue_b32();
+    dis0 = svaddv_f32(pg_32, svadd_f32_x(pg_32, sum0_even, sum0_odd));
+    dis1 = svaddv_f32(pg_32, svadd_f32_x(pg_32, sum1_even, sum1_odd));
+    dis2 = svaddv_f32(pg_32, svadd_f32_x(pg_32, sum2_even, sum2_odd));
+    dis3 = svaddv_f32(pg_32, svadd_f32_x(pg_32, sum3_even, sum3_odd));
+}
+
+void
+fp16_vec_L2sqr_batch_4_sve2(const knowhere::fp16* x, const knowhere::fp16* y0, const knowhere::fp16* y1,
+                            const knowhere::fp16* y2, const knowhere::fp16* y3, const size_t d, float& dis0,
+                            float& dis1, float& dis2, float& dis3) {
+    svfloat32_t sum0 = svdup_f32(0.0f);
+    svfloat32_t sum1 = svdup_f32(0.0f);
+    svfloat32_t sum2 = svdup_f32(0.0f);
+    svfloat32_t sum3 = svdup_f32(0.0f);
+    size_t i = 0;
+
+    svbool_t pg_16 = svptrue_b16();
+    svbool_t pg_32 = svptrue_b32();
+
+    while (i < d) {
+        if (d - i < svcnth())
+            pg_16 = svwhilelt_b16(i, d);
+
+        svfloat16_t x_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(x + i));
+        svfloat32_t x_even = svcvt_f32_f16_x(pg_32, x_fp16);
+        svfloat32_t x_odd = svcvtlt_f32_f16_x(pg_32, x_fp16);
+
+        svfloat16_t y_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y0 + i));
+        svfloat32_t diff_even = svsub_f32_x(pg_32, x_even, svcvt_f32_f16_x(pg_32, y_fp16));
+        svfloat32_t diff_odd = svsub_f32_x(pg_32, x_odd, svcvtlt_f32_f16_x(pg_32, y_fp16));
+        sum0 = svmla_f32_x(pg_32, sum0, diff_even, diff_even);
+        sum0 = svmla_f32_x(pg_32, sum0, diff_odd, diff_odd);
+
+        y_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y1 + i));
+        diff_even = svsub_f32_x(pg_32, x_even, svcvt_f32_f16_x(pg_32, y_fp16));
+        diff_odd = svsub_f32_x(pg_32, x_odd, svcvtlt_f32_f16_x(pg_32, y_fp16));
+        sum1 = svmla_f32_x(pg_32, sum1, diff_even, diff_even);
+        sum1 = svmla_f32_x(pg_32, sum1, diff_odd, diff_odd);
+
+        y_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y2 + i));
+        diff_even = svsub_f32_x(pg_32, x_even, svcvt_f32_f16_x(pg_32, y_fp16));
+        diff_odd = svsub_f32_x(pg_32, x_odd, svcvtlt_f32_f16_x(pg_32, y_fp16));
+        sum2 = svmla_f32_x(pg_32, sum2, diff_even, diff_even);
+        sum2 = svmla_f32_x(pg_32, sum2, diff_odd, diff_odd);
+
+        y_fp16 = svld1_f16(pg_16, reinterpret_cast<const __fp16*>(y3 + i));
+        diff_even = svsub_f32_x(pg_32, x_even, svcvt_f32_f16_x(pg_32, y_fp16));
+        diff_odd = svsub_f32_x(pg_32, x_odd, svcvtlt_f32_f16_x(pg_32, y_fp16));
+        sum3 = svmla_f32_x(pg_32, sum3, diff_even, diff_even);
+        sum3 = svmla_f32_x(pg_32, sum3, diff_odd, diff_odd);
+
+        i += svcnth();
+    }
+
+    dis0 = svaddv_f32(pg_32, sum0);
+    dis1 = svaddv_f32(pg_32, sum1);
+    dis2 = svaddv_f32(pg_32, sum2);
+    dis3 = svaddv_f32(pg_32, sum3);
+}
+#endif
+
 }  // namespace faiss
 
 #endif
@@ -109,5 +109,54 @@ bf16_vec_inner_product_batch_4_sve(const knowhere::bf16* x, const knowhere::bf16
                                    const knowhere::bf16* y2, const knowhere::bf16* y3, const size_t d, float& dis0,
                                    float& dis1, float& dis2, float& dis3);
 
+void
+fvec_scatter_madd_sve(float* acc, const uint32_t* ids, const float* vals, size_t n, float q, uint32_t base);
+
+size_t
+u32_lower_bound_sve(const uint32_t* data, size_t n, uint32_t key);
+
+void
+u32_jaccard_distance_batch_16_sve(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                  float* dis);
+
+void
+u64_jaccard_distance_batch_16_sve(const char* x, const char* const* y, size_t element_length, size_t element_size,
+                                  float* dis);
+
+///////////////////////////////////////////////////////////////////////////////
+// binary
+int
+bvec_hamming_distance_sve(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_hamming_distance_batch_4_sve(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3);
+float
+bvec_jaccard_distance_sve(const uint8_t* x, const uint8_t* y, size_t code_size);
+void
+bvec_jaccard_distance_batch_4_sve(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t code_size, float& dis0, float& dis1, float& dis2,
+                                  float& dis3);
+
+#if defined(__ARM_FEATURE_SVE2)
+float
+fp16_vec_inner_product_sve2(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_L2sqr_sve2(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_norm_L2sqr_sve2(const knowhere::fp16* x, size_t d);
+
+void
+fp16_vec_inner_product_batch_4_sve2(const knowhere::fp16* x, const knowhere::fp16* y0, const knowhere::fp16* y1,
+                                    const knowhere::fp16* y2, const knowhere::fp16* y3, const size_t d, float& dis0,
+                                    float& dis1, float& dis2, float& dis3);
+
+void
+fp16_vec_L2sqr_batch_4_sve2(const knowhere::fp16* x, const knowhere::fp16* y0, const knowhere::fp16* y1,
+                            const knowhere::fp16* y2, const knowhere::fp16* y3, const size_t d, float& dis0,
+                            float& dis1, float& dis2, float& dis3);
+#endif
+
 }  // namespace faiss
 #endif
@@ -18,7 +18,10 @@
 #if defined(__x86_64__)
 #include "distances_avx.h"
 #include "distances_avx512.h"
+#include "distances_avx512bf16.h"
 #include "distances_avx512icx.h"
+#include "distances_avx512vnni.h"
+#include "distances_avxvnni.h"
 #include "distances_sse.h"
 #include "instruction_set.h"
 #endif
@@ -56,6 +59,18 @@ bool use_sse4_2 = true;
 
 bool support_pq_fast_scan = true;
 
+namespace {
+// batch_8 for the platforms and the bf16 patch without a kernel of their own
+void
+fvec_inner_product_batch_8_by_batch_4(const float* x, const float* y0, const float* y1, const float* y2,
+                                      const float* y3, const float* y4, const float* y5, const float* y6,
+                                      const float* y7, const size_t d, float& dis0, float& dis1, float& dis2,
+                                      float& dis3, float& dis4, float& dis5, float& dis6, float& dis7) {
+    fvec_inner_product_batch_4(x, y0, y1, y2, y3, d, dis0, dis1, dis2, dis3);
+    fvec_inner_product_batch_4(x, y4, y5, y6, y7, d, dis4, dis5, dis6, dis7);
+}
+}  // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 decltype(fvec_inner_product) fvec_inner_product = fvec_inner_product_ref;
 decltype(fvec_L2sqr) fvec_L2sqr = fvec_L2sqr_ref;
@@ -74,6 +89,7 @@ decltype(fvec_L2sqr_ny_nearest_y_transposed) fvec_L2sqr_ny_nearest_y_transposed
 decltype(fvec_L2sqr_ny_transposed) fvec_L2sqr_ny_transposed = fvec_L2sqr_ny_transposed_ref;
 
 decltype(fvec_inner_product_batch_4) fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
+decltype(fvec_inner_product_batch_8) fvec_inner_product_batch_8 = fvec_inner_product_batch_8_by_batch_4;
 decltype(fvec_L2sqr_batch_4) fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
 
 // for hnsw sq, obsolete
@@ -103,11 +119,19 @@ decltype(int8_vec_norm_L2sqr) int8_vec_norm_L2sqr = int8_vec_norm_L2sqr_ref;
 
 decltype(int8_vec_inner_product_batch_4) int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_ref;
 decltype(int8_vec_L2sqr_batch_4) int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_ref;
+decltype(s8u8_inner_product) s8u8_inner_product = s8u8_inner_product_ref;
+decltype(s8u8_inner_product_batch_4) s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_ref;
 
 // rabitq
 decltype(fvec_masked_sum) fvec_masked_sum = fvec_masked_sum_ref;
 decltype(rabitq_dp_popcnt) rabitq_dp_popcnt = rabitq_dp_popcnt_ref;
 
+// binary
+decltype(bvec_hamming_distance) bvec_hamming_distance = bvec_hamming_distance_ref;
+decltype(bvec_hamming_distance_batch_4) bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_ref;
+decltype(bvec_jaccard_distance) bvec_jaccard_distance = bvec_jaccard_distance_ref;
+decltype(bvec_jaccard_distance_batch_4) bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_ref;
+
 // minhash
 decltype(u64_binary_search_eq) u64_binary_search_eq = u64_binary_search_eq_ref;
 decltype(u64_binary_search_ge) u64_binary_search_ge = u64_binary_search_ge_ref;
@@ -116,6 +140,17 @@ decltype(u32_jaccard_distance) u32_jaccard_distance = u32_jaccard_distance_ref;
 decltype(u32_jaccard_distance_batch_4) u32_jaccard_distance_batch_4 = u32_jaccard_distance_batch_4_ref;
 decltype(u64_jaccard_distance) u64_jaccard_distance = u64_jaccard_distance_ref;
 decltype(u64_jaccard_distance_batch_4) u64_jaccard_distance_batch_4 = u64_jaccard_distance_batch_4_ref;
+decltype(u32_jaccard_distance_batch_16) u32_jaccard_distance_batch_16 = u32_jaccard_distance_batch_16_ref;
+decltype(u64_jaccard_distance_batch_16) u64_jaccard_distance_batch_16 = u64_jaccard_distance_batch_16_ref;
+
+// sparse
+decltype(fvec_scatter_madd) fvec_scatter_madd = fvec_scatter_madd_ref;
+decltype(u32_lower_bound) u32_lower_bound = u32_lower_bound_ref;
+decltype(sparse_ip) sparse_ip = sparse_ip_ref;
+decltype(sparse_dense_ip) sparse_dense_ip = sparse_dense_ip_ref;
+
+// pq
+decltype(pq8_lut_sum) pq8_lut_sum = pq8_lut_sum_ref;
 ///////////////////////////////////////////////////////////////////////////////
 #if defined(__x86_64__)
 bool
@@ -124,12 +159,30 @@ cpu_support_avx512() {
     return (instruction_set_inst.AVX512F() && instruction_set_inst.AVX512DQ() && instruction_set_inst.AVX512BW());
 }
 
+bool
+cpu_support_avx512_bf16() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return (cpu_support_avx512() && instruction_set_inst.AVX512VL() && instruction_set_inst.AVX512BF16());
+}
+
+bool
+cpu_support_avx512_vnni() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return (cpu_support_avx512() && instruction_set_inst.AVX512VL() && instruction_set_inst.AVX512VNNI());
+}
+
 bool
 cpu_support_avx2() {
     InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
     return (instruction_set_inst.AVX2());
 }
 
+bool
+cpu_support_avx_vnni() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return (cpu_support_avx2() && instruction_set_inst.AVXVNNI());
+}
+
 bool
 cpu_support_sse4_2() {
     InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
@@ -149,12 +202,23 @@ bool
 supports_sve() {
     return false;
 }
+
+bool
+supports_sve2() {
+    return false;
+}
 #else
 bool
 supports_sve() {
     unsigned long hwcap = getauxval(AT_HWCAP);
     return (hwcap & HWCAP_SVE) != 0;
 }
+
+bool
+supports_sve2() {
+    unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    return (hwcap2 & HWCAP2_SVE2) != 0;
+}
 #endif
 #endif
 
@@ -168,12 +232,14 @@ enable_patch_for_fp32_bf16() {
         // Cloud branch
         fvec_inner_product = fvec_inner_product_bf16_patch_avx512;
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_bf16_patch_avx512;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_by_batch_4;
 
         fvec_L2sqr = fvec_L2sqr_bf16_patch_avx512;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_bf16_patch_avx512;
     } else if (use_avx2 && cpu_support_avx2()) {
         fvec_inner_product = fvec_inner_product_bf16_patch_avx;
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_bf16_patch_avx;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_by_batch_4;
 
         fvec_L2sqr = fvec_L2sqr_bf16_patch_avx;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_bf16_patch_avx;
@@ -182,6 +248,7 @@ enable_patch_for_fp32_bf16() {
     } else {
         fvec_inner_product = fvec_inner_product_bf16_patch_ref;
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_bf16_patch_ref;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_by_batch_4;
 
         fvec_L2sqr = fvec_L2sqr_bf16_patch_ref;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_bf16_patch_ref;
@@ -194,6 +261,7 @@ enable_patch_for_fp32_bf16() {
 
     fvec_inner_product = fvec_inner_product_bf16_patch_neon;
     fvec_inner_product_batch_4 = fvec_inner_product_batch_4_bf16_patch_neon;
+    fvec_inner_product_batch_8 = fvec_inner_product_batch_8_by_batch_4;
 
     fvec_L2sqr = fvec_L2sqr_bf16_patch_neon;
     fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_bf16_patch_neon;
@@ -211,12 +279,14 @@ disable_patch_for_fp32_bf16() {
         // Cloud branch
         fvec_inner_product = fvec_inner_product_avx512;
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx512;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_avx512;
 
         fvec_L2sqr = fvec_L2sqr_avx512;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512;
     } else if (use_avx2 && cpu_support_avx2()) {
         fvec_inner_product = fvec_inner_product_avx;
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_avx;
 
         fvec_L2sqr = fvec_L2sqr_avx;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx;
@@ -225,6 +295,7 @@ disable_patch_for_fp32_bf16() {
     } else {
         fvec_inner_product = fvec_inner_product_ref;
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_ref;
 
         fvec_L2sqr = fvec_L2sqr_ref;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
@@ -250,6 +321,7 @@ fvec_hook(std::string& simd_type) {
         fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
 
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx512;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_avx512;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512;
         fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_avx;  // avx2 compute small dim faster than avx512
 
@@ -272,6 +344,11 @@ fvec_hook(std::string& simd_type) {
 
         bf16_vec_inner_product_batch_4 = bf16_vec_inner_product_batch_4_avx512;
         bf16_vec_L2sqr_batch_4 = bf16_vec_L2sqr_batch_4_avx512;
+        if (cpu_support_avx512_bf16()) {
+            bf16_vec_inner_product = bf16_vec_inner_product_avx512bf16;
+            bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx512bf16;
+            bf16_vec_inner_product_batch_4 = bf16_vec_inner_product_batch_4_avx512bf16;
+        }
 
         // int8
         int8_vec_inner_product = int8_vec_inner_product_avx512;
@@ -280,6 +357,21 @@ fvec_hook(std::string& simd_type) {
 
         int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_avx512;
         int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_avx512;
+        s8u8_inner_product = s8u8_inner_product_avx512;
+        s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_avx512;
+        if (cpu_support_avx512_vnni()) {
+            ivec_inner_product = ivec_inner_product_avx512vnni;
+            ivec_L2sqr = ivec_L2sqr_avx512vnni;
+
+            int8_vec_inner_product = int8_vec_inner_product_avx512vnni;
+            int8_vec_L2sqr = int8_vec_L2sqr_avx512vnni;
+            int8_vec_norm_L2sqr = int8_vec_norm_L2sqr_avx512vnni;
+
+            int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_avx512vnni;
+            int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_avx512vnni;
+            s8u8_inner_product = s8u8_inner_product_avx512vnni;
+            s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_avx512vnni;
+        }
 
         // rabitq
         fvec_masked_sum = fvec_masked_sum_avx512;
@@ -288,6 +380,18 @@ fvec_hook(std::string& simd_type) {
         } else {
             rabitq_dp_popcnt = rabitq_dp_popcnt_avx512;
         }
+        // binary
+        if (InstructionSet::GetInstance().AVX512VPOPCNTDQ()) {
+            bvec_hamming_distance = bvec_hamming_distance_avx512icx;
+            bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_avx512icx;
+            bvec_jaccard_distance = bvec_jaccard_distance_avx512icx;
+            bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_avx512icx;
+        } else {
+            bvec_hamming_distance = bvec_hamming_distance_avx512;
+            bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_avx512;
+            bvec_jaccard_distance = bvec_jaccard_distance_avx512;
+            bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_avx512;
+        }
         // minhash
         u64_binary_search_eq = u64_binary_search_eq_avx512;
         u64_binary_search_ge = u64_binary_search_ge_avx512;
@@ -296,6 +400,15 @@ fvec_hook(std::string& simd_type) {
         u32_jaccard_distance_batch_4 = u32_jaccard_distance_batch_4_ref;
         u64_jaccard_distance = u64_jaccard_distance_ref;
         u64_jaccard_distance_batch_4 = u64_jaccard_distance_batch_4_ref;
+        u32_jaccard_distance_batch_16 = u32_jaccard_distance_batch_16_avx512;
+        u64_jaccard_distance_batch_16 = u64_jaccard_distance_batch_16_avx512;
+        // sparse
+        fvec_scatter_madd = fvec_scatter_madd_avx512;
+        u32_lower_bound = u32_lower_bound_avx512;
+        sparse_ip = sparse_ip_avx512;
+        sparse_dense_ip = sparse_dense_ip_avx512;
+        // pq
+        pq8_lut_sum = pq8_lut_sum_avx512;
         //
         simd_type = "AVX512";
         support_pq_fast_scan = true;
@@ -312,6 +425,7 @@ fvec_hook(std::string& simd_type) {
         fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
 
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_avx;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx;
         fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_avx;
 
@@ -342,11 +456,37 @@ fvec_hook(std::string& simd_type) {
 
         int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_avx;
         int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_avx;
+        s8u8_inner_product = s8u8_inner_product_avx;
+        s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_avx;
+        if (cpu_support_avx_vnni()) {
+            ivec_inner_product = ivec_inner_product_avxvnni;
+            ivec_L2sqr = ivec_L2sqr_avxvnni;
+
+            int8_vec_inner_product = int8_vec_inner_product_avxvnni;
+            int8_vec_L2sqr = int8_vec_L2sqr_avxvnni;
+            int8_vec_norm_L2sqr = int8_vec_norm_L2sqr_avxvnni;
+
+            int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_avxvnni;
+            int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_avxvnni;
+        }
 
         // rabitq
         fvec_masked_sum = fvec_masked_sum_avx;
         rabitq_dp_popcnt = rabitq_dp_popcnt_avx;
 
+        // binary
+        bvec_hamming_distance = bvec_hamming_distance_avx;
+        bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_avx;
+        bvec_jaccard_distance = bvec_jaccard_distance_avx;
+        bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_avx;
+
+        // minhash
+        u32_jaccard_distance_batch_16 = u32_jaccard_distance_batch_16_ref;
+        u64_jaccard_distance_batch_16 = u64_jaccard_distance_batch_16_ref;
+
+        // pq
+        pq8_lut_sum = pq8_lut_sum_avx;
+
         //
         simd_type = "AVX2";
         support_pq_fast_scan = true;
@@ -363,6 +503,7 @@ fvec_hook(std::string& simd_type) {
         fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
 
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_ref;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
 
         // for hnsw sq, obsolete
@@ -392,11 +533,23 @@ fvec_hook(std::string& simd_type) {
 
         int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_ref;
         int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_ref;
+        s8u8_inner_product = s8u8_inner_product_ref;
+        s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_ref;
 
         // rabitq
         fvec_masked_sum = fvec_masked_sum_sse;
         rabitq_dp_popcnt = rabitq_dp_popcnt_sse;
 
+        // binary
+        bvec_hamming_distance = bvec_hamming_distance_sse;
+        bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_sse;
+        bvec_jaccard_distance = bvec_jaccard_distance_sse;
+        bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_sse;
+
+        // minhash
+        u32_jaccard_distance_batch_16 = u32_jaccard_distance_batch_16_ref;
+        u64_jaccard_distance_batch_16 = u64_jaccard_distance_batch_16_ref;
+
         //
         simd_type = "SSE4_2";
         support_pq_fast_scan = false;
@@ -413,6 +566,7 @@ fvec_hook(std::string& simd_type) {
         fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
 
         fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
+        fvec_inner_product_batch_8 = fvec_inner_product_batch_8_ref;
         fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
 
         // for hnsw sq, obsolete
@@ -442,11 +596,23 @@ fvec_hook(std::string& simd_type) {
 
         int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_ref;
         int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_ref;
+        s8u8_inner_product = s8u8_inner_product_ref;
+        s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_ref;
 
         // rabitq
         fvec_masked_sum = fvec_masked_sum_ref;
         rabitq_dp_popcnt = rabitq_dp_popcnt_ref;
 
+        // binary
+        bvec_hamming_distance = bvec_hamming_distance_ref;
+        bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_ref;
+        bvec_jaccard_distance = bvec_jaccard_distance_ref;
+        bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_ref;
+
+        // minhash
+        u32_jaccard_distance_batch_16 = u32_jaccard_distance_batch_16_ref;
+        u64_jaccard_distance_batch_16 = u64_jaccard_distance_batch_16_ref;
+
         //
         simd_type = "GENERIC";
         support_pq_fast_scan = false;
@@ -472,10 +638,22 @@ fvec_hook(std::string& simd_type) {
         ivec_inner_product = ivec_inner_product_neon;
         ivec_L2sqr = ivec_L2sqr_neon;
 
-        // fp16
+        // fp16, sve has no batch_4 kernels of its own
         fp16_vec_inner_product = fp16_vec_inner_product_sve;
         fp16_vec_L2sqr = fp16_vec_L2sqr_sve;
         fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_sve;
+        fp16_vec_inner_product_batch_4 = fp16_vec_inner_product_batch_4_neon;
+        fp16_vec_L2sqr_batch_4 = fp16_vec_L2sqr_batch_4_neon;
+#if defined(__ARM_FEATURE_SVE2)
+        // the files built for armv9 run on armv8 cpus with sve too, which lack sve2
+        if (supports_sve2()) {
+            fp16_vec_inner_product = fp16_vec_inner_product_sve2;
+            fp16_vec_L2sqr = fp16_vec_L2sqr_sve2;
+            fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_sve2;
+            fp16_vec_inner_product_batch_4 = fp16_vec_inner_product_batch_4_sve2;
+            fp16_vec_L2sqr_batch_4 = fp16_vec_L2sqr_batch_4_sve2;
+        }
+#endif
 
         // bf16
         bf16_vec_inner_product = bf16_vec_inner_product_sve;
@@ -493,6 +671,22 @@ fvec_hook(std::string& simd_type) {
         int8_vec_L2sqr_batch_4 = int8_vec_L2sqr_batch_4_sve;
         int8_vec_inner_product = int8_vec_inner_product_sve;
         int8_vec_inner_product_batch_4 = int8_vec_inner_product_batch_4_sve;
+        s8u8_inner_product = s8u8_inner_product_neon;
+        s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_neon;
+
+        // sparse
+        fvec_scatter_madd = fvec_scatter_madd_sve;
+        u32_lower_bound = u32_lower_bound_sve;
+
+        // minhash
+        u32_jaccard_distance_batch_16 = u32_jaccard_distance_batch_16_sve;
+        u64_jaccard_distance_batch_16 = u64_jaccard_distance_batch_16_sve;
+
+        // binary
+        bvec_hamming_distance = bvec_hamming_distance_sve;
+        bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_sve;
+        bvec_jaccard_distance = bvec_jaccard_distance_sve;
+        bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_sve;
 
         simd_type = "SVE";
         support_pq_fast_scan = true;
@@ -533,6 +727,16 @@ fvec_hook(std::string& simd_type) {
         bf16_vec_inner_product_batch_4 = bf16_vec_inner_product_batch_4_neon;
         bf16_vec_L2sqr_batch_4 = bf16_vec_L2sqr_batch_4_neon;
 
+        // int8
+        s8u8_inner_product = s8u8_inner_product_neon;
+        s8u8_inner_product_batch_4 = s8u8_inner_product_batch_4_neon;
+
+        // binary
+        bvec_hamming_distance = bvec_hamming_distance_neon;
+        bvec_hamming_distance_batch_4 = bvec_hamming_distance_batch_4_neon;
+        bvec_jaccard_distance = bvec_jaccard_distance_neon;
+        bvec_jaccard_distance_batch_4 = bvec_jaccard_distance_batch_4_neon;
+
         //
         simd_type = "NEON";
         support_pq_fast_scan = true;
@@ -612,6 +816,76 @@ fvec_hook(std::string& simd_type) {
 #endif
 }
 
+decltype(fvec_inner_product)
+fvec_inner_product_for_dim(const size_t d) {
+#if defined(__x86_64__)
+    // the bf16 patch and the calibration install other kernels, which are kept
+    if (fvec_inner_product == fvec_inner_product_avx512) {
+        if (auto kernel = fvec_inner_product_avx512_for_dim(d)) {
+            return kernel;
+        }
+    }
+#endif
+    return fvec_inner_product;
+}
+
+decltype(fvec_L2sqr)
+fvec_L2sqr_for_dim(const size_t d) {
+#if defined(__x86_64__)
+    if (fvec_L2sqr == fvec_L2sqr_avx512) {
+        if (auto kernel = fvec_L2sqr_avx512_for_dim(d)) {
+            return kernel;
+        }
+    }
+#endif
+    return fvec_L2sqr;
+}
+
+namespace {
+
+// the hooks as they are when the loop runs
+struct InnerProductHook {
+    static float
+    call(const float* x, const float* y, size_t d) {
+        return fvec_inner_product(x, y, d);
+    }
+};
+
+struct L2sqrHook {
+    static float
+    call(const float* x, const float* y, size_t d) {
+        return fvec_L2sqr(x, y, d);
+    }
+};
+
+}  // namespace
+
+fvec_by_ids_func
+fvec_inner_product_by_ids_for_dim(const size_t d) {
+#if defined(__x86_64__)
+    if (fvec_inner_product == fvec_inner_product_avx512) {
+        return fvec_inner_product_by_ids_avx512_for_dim(d);
+    }
+    if (fvec_inner_product == fvec_inner_product_avx) {
+        return fvec_inner_product_by_ids_avx;
+    }
+#endif
+    return fvec_by_ids<InnerProductHook>;
+}
+
+fvec_by_ids_func
+fvec_L2sqr_by_ids_for_dim(const size_t d) {
+#if defined(__x86_64__)
+    if (fvec_L2sqr == fvec_L2sqr_avx512) {
+        return fvec_L2sqr_by_ids_avx512_for_dim(d);
+    }
+    if (fvec_L2sqr == fvec_L2sqr_avx) {
+        return fvec_L2sqr_by_ids_avx;
+    }
+#endif
+    return fvec_by_ids<L2sqrHook>;
+}
+
 static int init_hook_ = []() {
     std::string simd_type;
     fvec_hook(simd_type);
@@ -14,6 +14,7 @@
 
 #include <string>
 
+#include "distances_by_ids.h"
 #include "knowhere/operands.h"
 
 namespace faiss {
@@ -75,6 +76,13 @@ extern int (*fvec_madd_and_argmin)(size_t, const float*, float, const float*, fl
 extern void (*fvec_inner_product_batch_4)(const float*, const float*, const float*, const float*, const float*,
                                           const size_t, float&, float&, float&, float&);
 
+/// Special version of inner product that computes 8 distances
+/// between x and yi, which loads x once for twice the vectors of batch_4.
+/// Two batch_4 calls on the platforms without a kernel.
+extern void (*fvec_inner_product_batch_8)(const float*, const float*, const float*, const float*, const float*,
+                                          const float*, const float*, const float*, const float*, const size_t,
+                                          float&, float&, float&, float&, float&, float&, float&, float&);
+
 /// Special version of L2sqr that computes 4 distances
 /// between x and yi, which is performance oriented.
 /// todo aguzhva: bring non-ref versions
@@ -117,11 +125,23 @@ extern void (*int8_vec_inner_product_batch_4)(const int8_t*, const int8_t*, cons
                                               const size_t, float&, float&, float&, float&);
 extern void (*int8_vec_L2sqr_batch_4)(const int8_t*, const int8_t*, const int8_t*, const int8_t*, const int8_t*,
                                       const size_t, float&, float&, float&, float&);
+// the inner products of the int8 vector x with the uint8 codes y, exact in int32 up to 2^16 dimensions
+extern int32_t (*s8u8_inner_product)(const int8_t*, const uint8_t*, size_t);
+extern void (*s8u8_inner_product_batch_4)(const int8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                                          const uint8_t*, const size_t, int32_t&, int32_t&, int32_t&, int32_t&);
 
 // rabitq
 extern float (*fvec_masked_sum)(const float*, const uint8_t*, const size_t);
 extern int (*rabitq_dp_popcnt)(const uint8_t*, const uint8_t*, const size_t, const size_t);
 
+// binary, the hamming and the jaccard distances of codes of code_size bytes
+extern int (*bvec_hamming_distance)(const uint8_t*, const uint8_t*, size_t);
+extern void (*bvec_hamming_distance_batch_4)(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                                             const uint8_t*, size_t, int&, int&, int&, int&);
+extern float (*bvec_jaccard_distance)(const uint8_t*, const uint8_t*, size_t);
+extern void (*bvec_jaccard_distance_batch_4)(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                                             const uint8_t*, size_t, float&, float&, float&, float&);
+
 // minhash
 extern int (*u64_binary_search_eq)(const uint64_t*, const size_t, const uint64_t);
 extern int (*u64_binary_search_ge)(const uint64_t*, const size_t, const uint64_t);
@@ -131,14 +151,38 @@ extern void (*u32_jaccard_distance_batch_4)(const char*, const char*, const char
 extern float (*u64_jaccard_distance)(const char*, const char*, size_t size, size_t);
 extern void (*u64_jaccard_distance_batch_4)(const char*, const char*, const char*, const char*, const char*, size_t,
                                             size_t, float&, float&, float&, float&);
+// the distances of x to the 16 signatures y[0], ..., y[15], written to dis[0], ..., dis[15]
+extern void (*u32_jaccard_distance_batch_16)(const char*, const char* const*, size_t, size_t, float*);
+extern void (*u64_jaccard_distance_batch_16)(const char*, const char* const*, size_t, size_t, float*);
 extern uint64_t (*calculate_hash)(const char*, size_t);
+
+// sparse
+// acc[ids[i] - base] += q * vals[i] for i in [0, n); ids must be unique and ids[i] - base must fit in int32_t.
+extern void (*fvec_scatter_madd)(float*, const uint32_t*, const float*, size_t, float, uint32_t);
+// number of elements smaller than key in a sorted array, i.e. the position of the first element >= key.
+extern size_t (*u32_lower_bound)(const uint32_t*, size_t, uint32_t);
+// inner product of two sparse rows of nx and ny (uint32_t id, float value) pairs, packed and sorted by id.
+extern float (*sparse_ip)(const void*, size_t, const void*, size_t);
+// inner product of a sparse row of nx (uint32_t id, float value) pairs with the dense vector y of dim elements, the
+// ids >= dim count as zeros of y.
+extern float (*sparse_dense_ip)(const void*, size_t, const float*, size_t);
+
+// pq
+// out[i] = sum of lut[256 * c + codes[i * nchunks + c]] over the nchunks chunks, for the 8-bit codes of n points.
+extern void (*pq8_lut_sum)(const uint8_t*, size_t, size_t, const float*, float*);
 ///////////////////////////////////////////////////////////////////////////////
 #if defined(__x86_64__)
 bool
 cpu_support_avx512();
 bool
+cpu_support_avx512_bf16();
+bool
+cpu_support_avx512_vnni();
+bool
 cpu_support_avx2();
 bool
+cpu_support_avx_vnni();
+bool
 cpu_support_sse4_2();
 bool
 cpu_support_f16c();
@@ -147,6 +191,8 @@ cpu_support_f16c();
 #if defined(__aarch64__)
 bool
 supports_sve();
+bool
+supports_sve2();
 #endif
 
 void
@@ -158,6 +204,23 @@ disable_patch_for_fp32_bf16();
 void
 fvec_hook(std::string&);
 
+/// fvec_inner_product and fvec_L2sqr as resolved once by a caller that computes many distances of one dim. The
+/// avx512 kernels have versions for the common embedding dims, other hooks and dims get the hook itself.
+decltype(fvec_inner_product)
+fvec_inner_product_for_dim(size_t d);
+
+decltype(fvec_L2sqr)
+fvec_L2sqr_for_dim(size_t d);
+
+/// The distances of a query to the vectors of a list of ids, as resolved once by a caller that evaluates the neighbors
+/// of graph nodes. The avx512 and avx2 loops inline their kernel (and for avx512 the one of the dim) rather than going
+/// through the hook for every distance, other hooks get a loop over the hook itself.
+fvec_by_ids_func
+fvec_inner_product_by_ids_for_dim(size_t d);
+
+fvec_by_ids_func
+fvec_L2sqr_by_ids_for_dim(size_t d);
+
 }  // namespace faiss
 
 #endif /* HOOK_H */
@@ -41,6 +41,7 @@ class InstructionSet {
           f_1_EDX_{0},
           f_7_EBX_{0},
           f_7_ECX_{0},
+          f_7_1_EAX_{0},
           f_81_ECX_{0},
           f_81_EDX_{0},
           data_{},
@@ -82,6 +83,12 @@ class InstructionSet {
             f_7_ECX_ = data_[7][2];
         }
 
+        // load bitset with flags for function 0x00000007, sub-leaf 0x00000001
+        if (nIds_ >= 7 && data_[7][0] >= 1) {
+            __cpuid_count(7, 1, cpui[0], cpui[1], cpui[2], cpui[3]);
+            f_7_1_EAX_ = cpui[0];
+        }
+
         // Calling __cpuid with 0x80000000 as the function_id argument
         // gets the number of the highest valid extended ID.
         __cpuid(0x80000000, cpui[0], cpui[1], cpui[2], cpui[3]);
@@ -347,11 +354,26 @@ class InstructionSet {
         return isAMD_ && f_81_EDX_[31];
     }
 
+    bool
+    AVX512VNNI() {
+        return f_7_ECX_[11];
+    }
+
     bool
     AVX512VPOPCNTDQ() {
         return f_7_ECX_[14];
     }
 
+    bool
+    AVXVNNI() {
+        return f_7_1_EAX_[4];
+    }
+
+    bool
+    AVX512BF16() {
+        return f_7_1_EAX_[5];
+    }
+
  private:
     int nIds_;
     int nExIds_;
@@ -363,6 +385,7 @@ class InstructionSet {
     std::bitset<32> f_1_EDX_;
     std::bitset<32> f_7_EBX_;
     std::bitset<32> f_7_ECX_;
+    std::bitset<32> f_7_1_EAX_;
     std::bitset<32> f_81_ECX_;
     std::bitset<32> f_81_EDX_;
     std::vector<std::array<int, 4>> data_;
@@ -187,3 +187,29 @@ def test_bfloat16_index(gen_data_with_type, faiss_ans, recall, error, name, conf
     else:
         assert recall(f_ids, k_ids) >= 0.5
     assert error(f_dis, f_dis) <= 0.01
+
+
+def test_search_batch(gen_data):
+    version = knowhere.GetCurrentVersion()
+    config = test_data[0][1]
+    xqs, indexes, datasets = [], [], []
+    for _ in range(4):
+        xb, xq = gen_data(2000, 50, 256)
+        idx = knowhere.CreateIndex("FLAT", version)
+        idx.Build(knowhere.ArrayToDataSet(xb), json.dumps(config))
+        xqs.append(xq)
+        indexes.append(idx)
+        datasets.append(knowhere.ArrayToDataSet(xq))
+
+    batch = knowhere.SearchBatch()
+    outputs = [
+        batch.add(idx, ds, json.dumps(config), knowhere.GetNullBitSetView(), config["k"])
+        for idx, ds in zip(indexes, datasets)
+    ]
+    assert batch.run() == [knowhere.Status.success] * len(indexes)
+
+    for idx, ds, (dis, ids) in zip(indexes, datasets, outputs):
+        ans, _ = idx.Search(ds, json.dumps(config), knowhere.GetNullBitSetView())
+        k_dis, k_ids = knowhere.DataSetToArray(ans)
+        assert (ids == k_ids).all()
+        assert np.allclose(dis, k_dis)
@@ -13,6 +13,8 @@
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
 #include "faiss/utils/Heap.h"
+#include "faiss/utils/distances_typed.h"
+#include "knowhere/bitsetview_idselector.h"
 #include "knowhere/comp/brute_force.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/utils.h"
@@ -274,3 +276,174 @@ TEST_CASE("Test Brute Force with input ids", "[float vector]") {
     check_search_with_out_ids<knowhere::bf16>(nb, nq, dim, k, metric, conf);
     check_search_with_out_ids<knowhere::int8>(nb, nq, dim, k, metric, conf);
 }
+
+template <typename T>
+void
+check_search_with_blas(const knowhere::DataSetPtr train_ds, const knowhere::DataSetPtr query_ds, const int64_t k,
+                       const knowhere::Json& conf, const knowhere::BitsetView& bitset) {
+    auto base = knowhere::ConvertToDataTypeIfNeeded<T>(train_ds);
+    auto query = knowhere::ConvertToDataTypeIfNeeded<T>(query_ds);
+    auto nq = query_ds->GetRows();
+
+    // one query per task, which takes the pairwise kernels
+    faiss::distance_compute_typed_blas_threshold = std::numeric_limits<int>::max();
+    auto gt = knowhere::BruteForce::Search<T>(base, query, conf, bitset);
+    // blocks of queries, which take blas
+    faiss::distance_compute_typed_blas_threshold = 1;
+    auto res = knowhere::BruteForce::Search<T>(base, query, conf, bitset);
+    faiss::distance_compute_typed_blas_threshold = 32;
+    REQUIRE(gt.has_value());
+    REQUIRE(res.has_value());
+
+    auto gt_dis = gt.value()->GetDistance();
+    auto ids = res.value()->GetIds();
+    auto dis = res.value()->GetDistance();
+    for (int64_t i = 0; i < nq * k; i++) {
+        // the ties can come in another order
+        REQUIRE(GetRelativeLoss(gt_dis[i], dis[i]) < 0.001);
+        if (!bitset.empty() && ids[i] >= 0) {
+            REQUIRE(!bitset.test(ids[i]));
+        }
+    }
+}
+
+TEST_CASE("Test Brute Force with blas", "[float vector]") {
+    const int64_t nb = 2000;
+    const int64_t nq = 100;
+    const int64_t dim = 128;
+    const int64_t k = 10;
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    const knowhere::Json conf = {
+        {knowhere::meta::DIM, dim},
+        {knowhere::meta::METRIC_TYPE, metric},
+        {knowhere::meta::TOPK, k},
+    };
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim);
+
+    auto filter_bits = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+    knowhere::BitsetView bitset(filter_bits.data(), nb);
+
+    for (const auto& bs : {knowhere::BitsetView(), bitset}) {
+        check_search_with_blas<knowhere::fp16>(train_ds, query_ds, k, conf, bs);
+        check_search_with_blas<knowhere::bf16>(train_ds, query_ds, k, conf, bs);
+        check_search_with_blas<knowhere::int8>(train_ds, query_ds, k, conf, bs);
+    }
+}
+
+template <typename T>
+void
+check_search_chunks(const uint64_t nb, const uint64_t nq, const uint64_t dim, const int64_t k,
+                    const knowhere::Json& conf) {
+    auto total_train_ds = knowhere::ConvertToDataTypeIfNeeded<T>(GenDataSet(nb, dim));
+    auto query_ds = knowhere::ConvertToDataTypeIfNeeded<T>(GenDataSet(nq, dim));
+    std::vector<int64_t> block_prefix = {0, 111, 333, 333, 500, 555, 666, 888, 1000};
+
+    auto filter_bits = GenerateBitsetWithRandomTbitsSet(nb, 100);
+    knowhere::BitsetView bitset(filter_bits.data(), nb);
+
+    std::vector<knowhere::DataSetPtr> chunks;
+    for (size_t i = 0; i < block_prefix.size() - 1; i++) {
+        auto begin_id = block_prefix[i];
+        auto blk_rows = block_prefix[i + 1] - begin_id;
+        auto tensor = (const T*)total_train_ds->GetTensor() + dim * begin_id;
+        chunks.push_back(knowhere::GenDataSet(blk_rows, dim, tensor, begin_id));
+    }
+    auto res = knowhere::BruteForce::SearchChunks<T>(chunks, query_ds, conf, bitset);
+    REQUIRE(res.has_value());
+    auto ids = res.value()->GetIds();
+    const float* dis = res.value()->GetDistance();
+
+    auto gt = knowhere::BruteForce::Search<T>(total_train_ds, query_ds, conf, bitset);
+    REQUIRE(gt.has_value());
+    auto gt_ids = gt.value()->GetIds();
+    const float* gt_dis = gt.value()->GetDistance();
+    for (size_t i = 0; i < nq * k; i++) {
+        REQUIRE(gt_ids[i] == ids[i]);
+        REQUIRE(GetRelativeLoss(gt_dis[i], dis[i]) < 0.00001);
+    }
+}
+
+TEST_CASE("Test Brute Force with chunks", "[float vector]") {
+    const int64_t nb = 1000;
+    const int64_t nq = 10;
+    const int64_t dim = 128;
+    const int64_t k = 10;
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    const knowhere::Json conf = {
+        {knowhere::meta::DIM, dim},
+        {knowhere::meta::METRIC_TYPE, metric},
+        {knowhere::meta::TOPK, k},
+    };
+    check_search_chunks<knowhere::fp32>(nb, nq, dim, k, conf);
+    check_search_chunks<knowhere::fp16>(nb, nq, dim, k, conf);
+    check_search_chunks<knowhere::bf16>(nb, nq, dim, k, conf);
+    check_search_chunks<knowhere::int8>(nb, nq, dim, k, conf);
+}
+
+template <typename T>
+void
+check_search_with_id_list(const knowhere::DataSetPtr train_ds, const knowhere::DataSetPtr query_ds, const int64_t k,
+                          const knowhere::Json& conf, const size_t num_valid) {
+    auto base = knowhere::ConvertToDataTypeIfNeeded<T>(train_ds);
+    auto query = knowhere::ConvertToDataTypeIfNeeded<T>(query_ds);
+    const auto nb = train_ds->GetRows();
+    const auto nq = query_ds->GetRows();
+    const auto dim = train_ds->GetDim();
+
+    auto filter_bits = GenerateBitsetWithRandomTbitsSet(nb, nb - num_valid);
+    knowhere::BitsetView bitset(filter_bits.data(), nb, nb - num_valid);
+    REQUIRE(knowhere::BitsetViewIDList::pays_off(bitset));
+    auto res = knowhere::BruteForce::Search<T>(base, query, conf, bitset);
+    REQUIRE(res.has_value());
+
+    // the ground truth is the search of a base made of the valid rows only
+    std::vector<int64_t> valid_ids;
+    std::vector<T> valid_rows;
+    for (int64_t i = 0; i < nb; i++) {
+        if (!bitset.test(i)) {
+            valid_ids.push_back(i);
+            auto row = (const T*)base->GetTensor() + dim * i;
+            valid_rows.insert(valid_rows.end(), row, row + dim);
+        }
+    }
+    REQUIRE(valid_ids.size() == num_valid);
+    auto valid_ds = knowhere::GenDataSet(valid_ids.size(), dim, valid_rows.data());
+    auto gt = knowhere::BruteForce::Search<T>(valid_ds, query, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    auto gt_ids = gt.value()->GetIds();
+    auto gt_dis = gt.value()->GetDistance();
+    auto ids = res.value()->GetIds();
+    auto dis = res.value()->GetDistance();
+    for (int64_t i = 0; i < nq * k; i++) {
+        if (gt_ids[i] < 0) {
+            REQUIRE(ids[i] == -1);
+            continue;
+        }
+        REQUIRE(ids[i] == valid_ids[gt_ids[i]]);
+        REQUIRE(GetRelativeLoss(gt_dis[i], dis[i]) < 0.00001);
+    }
+}
+
+TEST_CASE("Test Brute Force with selective filter", "[float vector]") {
+    const int64_t nb = 10000;
+    const int64_t nq = 10;
+    const int64_t dim = 128;
+    const int64_t k = 10;
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP);
+    // fewer valid ids than topk leaves the tail of the results empty
+    auto num_valid = GENERATE(as<size_t>{}, 5, 100, 500);
+    const knowhere::Json conf = {
+        {knowhere::meta::DIM, dim},
+        {knowhere::meta::METRIC_TYPE, metric},
+        {knowhere::meta::TOPK, k},
+    };
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim);
+
+    check_search_with_id_list<knowhere::fp32>(train_ds, query_ds, k, conf, num_valid);
+    check_search_with_id_list<knowhere::fp16>(train_ds, query_ds, k, conf, num_valid);
+    check_search_with_id_list<knowhere::bf16>(train_ds, query_ds, k, conf, num_valid);
+    check_search_with_id_list<knowhere::int8>(train_ds, query_ds, k, conf, num_valid);
+}
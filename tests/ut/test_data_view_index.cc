@@ -9,6 +9,9 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <atomic>
+#include <cstring>
+
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
@@ -114,11 +117,25 @@ TEST_CASE("Test SCANN with data view refiner", "[float metrics]") {
         return json;
     };
 
+    auto scann_gen5 = [base_gen, topk]() {
+        knowhere::Json json = base_gen();
+        json[knowhere::indexparam::NLIST] = 16;
+        json[knowhere::indexparam::NPROBE] = 12;
+        json[knowhere::indexparam::REFINE_RATIO] = 4.0;
+        json[knowhere::indexparam::SUB_DIM] = 2;
+        json[knowhere::indexparam::WITH_RAW_DATA] = true;
+        json[knowhere::indexparam::ENSURE_TOPK_FULL] = true;
+        json[knowhere::indexparam::REFINE_TYPE] = knowhere::RefineType::INT8_QUANT;
+        json[knowhere::indexparam::REFINE_WITH_QUANT] = true;
+        return json;
+    };
+
     auto rand = GENERATE(1);
     const auto train_ds = GenDataSet(nb, dim, rand);
     const auto query_ds = GenDataSet(nq, dim, rand + 777);
 
-    auto gen = GENERATE_REF(as<std::function<knowhere::Json()>>{}, scann_gen1, scann_gen2, scann_gen3, scann_gen4);
+    auto gen = GENERATE_REF(as<std::function<knowhere::Json()>>{}, scann_gen1, scann_gen2, scann_gen3, scann_gen4,
+                            scann_gen5);
 
     const knowhere::Json conf = {
         {knowhere::meta::METRIC_TYPE, metric},
@@ -182,6 +199,146 @@ TEST_CASE("Test SCANN with data view refiner", "[float metrics]") {
     }
 }
 
+TEST_CASE("Test data view refiner with sq4 quant refine", "[float metrics]") {
+    auto version = GenTestVersionList();
+    if (!faiss::support_pq_fast_scan) {
+        SKIP("pass scann test");
+    }
+
+    const int64_t nb = 1000, nq = 10, topk = 10, dim = 120;
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::COSINE, knowhere::metric::IP, knowhere::metric::L2);
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 12;
+    json[knowhere::indexparam::REFINE_RATIO] = 4.0;
+    json[knowhere::indexparam::SUB_DIM] = 2;
+    json[knowhere::indexparam::WITH_RAW_DATA] = true;
+    json[knowhere::indexparam::REFINE_TYPE] = knowhere::RefineType::SQ4_QUANT;
+
+    const auto train_ds = GenDataSet(nb, dim, 1);
+    const auto query_ds = GenDataSet(nq, dim, 778);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, nullptr);
+    knowhere::ViewDataOp data_view = [&train_ds, dim](size_t id) {
+        return (const float*)train_ds->GetTensor() + dim * id;
+    };
+    auto index = knowhere::IndexFactory::Instance()
+                     .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_SCANN_DVR, version,
+                                             knowhere::Pack(data_view))
+                     .value();
+    REQUIRE(index.Build(train_ds, json, false) == knowhere::Status::success);
+
+    // the 4 bits codes rank the candidates coarsely, the data view refine ranks them exactly
+    json[knowhere::indexparam::REFINE_WITH_QUANT] = true;
+    auto quant_results = index.Search(query_ds, json, nullptr);
+    REQUIRE(quant_results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *quant_results.value()) > 0.5f);
+
+    json[knowhere::indexparam::REFINE_WITH_QUANT] = false;
+    auto results = index.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+}
+
+TEST_CASE("Test data view refiner with batched view", "[float metrics]") {
+    auto version = GenTestVersionList();
+    if (!faiss::support_pq_fast_scan) {
+        SKIP("pass scann test");
+    }
+
+    const int64_t nb = 1000, nq = 10, topk = 10, dim = 120;
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::COSINE, knowhere::metric::IP, knowhere::metric::L2);
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 12;
+    json[knowhere::indexparam::REFINE_RATIO] = 4.0;
+    json[knowhere::indexparam::SUB_DIM] = 2;
+    json[knowhere::indexparam::WITH_RAW_DATA] = true;
+
+    const auto train_ds = GenDataSet(nb, dim, 1);
+    const auto query_ds = GenDataSet(nq, dim, 778);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, nullptr);
+
+    std::atomic<int64_t> batch_calls = 0;
+    std::atomic<int64_t> hinted_ids = 0;
+    std::atomic<bool> oversized_batch = false;
+    knowhere::DataViewOps ops;
+    ops.view_data = [&train_ds, dim](size_t id) { return (const float*)train_ds->GetTensor() + dim * id; };
+    ops.view_data_batch = [&](const int64_t* ids, size_t n, void* out, const int64_t* next_ids, size_t next_n) {
+        batch_calls++;
+        hinted_ids += next_ids == nullptr ? 0 : next_n;
+        oversized_batch = oversized_batch || n > 64;
+        for (size_t i = 0; i < n; i++) {
+            std::memcpy((float*)out + i * dim, (const float*)train_ds->GetTensor() + dim * ids[i], sizeof(float) * dim);
+        }
+    };
+    auto index = knowhere::IndexFactory::Instance()
+                     .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_SCANN_DVR, version, knowhere::Pack(ops))
+                     .value();
+    REQUIRE(index.Build(train_ds, json, false) == knowhere::Status::success);
+    auto results = index.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+    // the refine reads the candidates in batches, hinting the next ones
+    REQUIRE(batch_calls > 0);
+    REQUIRE(hinted_ids > 0);
+    REQUIRE(!oversized_batch);
+}
+
+TEST_CASE("Test data view refiner with batch ordered refine", "[float metrics]") {
+    auto version = GenTestVersionList();
+    if (!faiss::support_pq_fast_scan) {
+        SKIP("pass scann test");
+    }
+
+    const int64_t nb = 1000, nq = 10, topk = 10, dim = 120;
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::COSINE, knowhere::metric::IP, knowhere::metric::L2);
+    auto batched_view = GENERATE(false, true);
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 12;
+    json[knowhere::indexparam::REFINE_RATIO] = 4.0;
+    json[knowhere::indexparam::SUB_DIM] = 2;
+    json[knowhere::indexparam::WITH_RAW_DATA] = true;
+
+    const auto train_ds = GenDataSet(nb, dim, 1);
+    const auto query_ds = GenDataSet(nq, dim, 778);
+
+    std::atomic<bool> unordered_batch = false;
+    knowhere::DataViewOps ops;
+    ops.view_data = [&train_ds, dim](size_t id) { return (const float*)train_ds->GetTensor() + dim * id; };
+    if (batched_view) {
+        ops.view_data_batch = [&](const int64_t* ids, size_t n, void* out, const int64_t* next_ids, size_t next_n) {
+            for (size_t i = 0; i < n; i++) {
+                unordered_batch = unordered_batch || (i > 0 && ids[i] <= ids[i - 1]);
+                std::memcpy((float*)out + i * dim, (const float*)train_ds->GetTensor() + dim * ids[i],
+                            sizeof(float) * dim);
+            }
+        };
+    }
+    auto index = knowhere::IndexFactory::Instance()
+                     .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_SCANN_DVR, version, knowhere::Pack(ops))
+                     .value();
+    REQUIRE(index.Build(train_ds, json, false) == knowhere::Status::success);
+    auto results = index.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+
+    // the candidates of all the queries are refined at once, each id read once in increasing order
+    json[knowhere::indexparam::REFINE_BATCH_ORDER] = true;
+    auto ordered_results = index.Search(query_ds, json, nullptr);
+    REQUIRE(ordered_results.has_value());
+    REQUIRE(!unordered_batch);
+    REQUIRE(GetKNNRecall(*results.value(), *ordered_results.value()) > 0.99f);
+}
+
 TEST_CASE("Ensure topk test", "[float metrics]") {
     using Catch::Approx;
     auto version = GenTestVersionList();
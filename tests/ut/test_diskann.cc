@@ -11,7 +11,10 @@
 
 #include <sys/resource.h>
 
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 
 #include "../DiskANN/include/diskann/defaults.h"
 #include "catch2/catch_approx.hpp"
@@ -21,6 +24,7 @@
 #include "filemanager/impl/LocalFileManager.h"
 #include "index/diskann/diskann_config.h"
 #include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/knowhere_config.h"
 #include "knowhere/comp/knowhere_check.h"
 #include "knowhere/expected.h"
 #include "knowhere/index/index_factory.h"
@@ -58,6 +62,34 @@ constexpr float AiSAQKnnRecall = 0.01;
 constexpr float kL2RangeAp = 0.9;
 constexpr float kIpRangeAp = 0.9;
 constexpr float kCosineRangeAp = 0.9;
+
+// serves the files from their copies with a suffix, as an object store would
+class SuffixRangeReader : public RangeReader {
+ public:
+    explicit SuffixRangeReader(std::string suffix) : suffix_(std::move(suffix)) {
+    }
+
+    uint64_t
+    size(const std::string& fname) override {
+        return fs::file_size(fname + suffix_);
+    }
+
+    void
+    read(const std::string& fname, uint64_t offset, uint64_t len, void* buf) override {
+        std::ifstream file(fname + suffix_, std::ios::binary);
+        file.seekg(offset);
+        file.read(static_cast<char*>(buf), len);
+        if (!file) {
+            throw std::runtime_error("failed to read " + fname + suffix_);
+        }
+        num_reads++;
+    }
+
+    std::atomic<size_t> num_reads = 0;
+
+ private:
+    std::string suffix_;
+};
 }  // namespace
 TEST_CASE("Valid diskann build params test", "[diskann]") {
     int rows_num = 1000000;
@@ -177,6 +209,15 @@ TEST_CASE("Invalid diskann params test", "[diskann]") {
             REQUIRE(res.error() == knowhere::Status::out_of_range_in_json);
         }
 #endif
+        // min_beamwidth > beamwidth
+        {
+            test_json = test_gen();
+            test_json["search_list_size"] = 128;
+            test_json["min_beamwidth"] = 16;
+            auto res = diskann.Search(query_ds, test_json, nullptr);
+            REQUIRE_FALSE(res.has_value());
+            REQUIRE(res.error() == knowhere::Status::out_of_range_in_json);
+        }
     }
     fs::remove_all(kDir);
     fs::remove(kDir);
@@ -309,6 +350,13 @@ base_search() {
             auto knn_recall = GetKNNRecall(*knn_gt_ptr, *res.value());
             CAPTURE(knn_json.dump());
             REQUIRE(knn_recall > kKnnRecall);
+            // knn search without blocking the caller
+            {
+                auto future = diskann.SearchAsync(query_ds, knn_json, nullptr);
+                auto res = std::move(future).get();
+                REQUIRE(res.has_value());
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
+            }
             // knn search without cache file
             {
                 std::string cached_nodes_file_path =
@@ -325,6 +373,60 @@ base_search() {
                 REQUIRE(res.has_value());
                 REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
             }
+            // knn search with an adaptive beam
+            {
+                knowhere::Json adaptive_json = knn_json;
+                adaptive_json["min_beamwidth"] = 2;
+                auto res = diskann.Search(query_ds, adaptive_json, nullptr);
+                REQUIRE(res.has_value());
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
+            }
+            // knn search with a dynamic cache, the second search reads the nodes cached by the first one
+            {
+                knowhere::Json dynamic_cache_json = deserialize_json;
+                dynamic_cache_json["dynamic_cache_budget_gb"] = 0.01;
+                auto diskann_dynamic_cache =
+                    knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+                REQUIRE(diskann_dynamic_cache.Deserialize(binset, dynamic_cache_json) == knowhere::Status::success);
+                auto cold_res = diskann_dynamic_cache.Search(query_ds, knn_json, nullptr);
+                REQUIRE(cold_res.has_value());
+                auto hot_res = diskann_dynamic_cache.Search(query_ds, knn_json, nullptr);
+                REQUIRE(hot_res.has_value());
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *hot_res.value()) >= kKnnRecall);
+                auto cold_ids = cold_res.value()->GetIds();
+                auto hot_ids = hot_res.value()->GetIds();
+                REQUIRE(std::equal(cold_ids, cold_ids + kNumQueries * knn_json["k"].get<int64_t>(), hot_ids));
+            }
+            // knn search with a quota on the IO contexts held by an index of a higher priority
+            {
+                knowhere::KnowhereConfig::SetDiskIOQuota(1);
+                knowhere::Json priority_json = deserialize_json;
+                priority_json["io_priority"] = 10;
+                auto diskann_priority =
+                    knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+                REQUIRE(diskann_priority.Deserialize(binset, priority_json) == knowhere::Status::success);
+                auto res = diskann_priority.Search(query_ds, knn_json, nullptr);
+                knowhere::KnowhereConfig::SetDiskIOQuota(0);
+                REQUIRE(res.has_value());
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
+            }
+            // knn search reading the index file with io_uring
+            {
+                knowhere::Json uring_json = deserialize_json;
+                uring_json["io_engine"] = "uring";
+                auto diskann_uring =
+                    knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+#ifdef KNOWHERE_WITH_IO_URING
+                REQUIRE(diskann_uring.Deserialize(binset, uring_json) == knowhere::Status::success);
+                auto res = diskann_uring.Search(query_ds, knn_json, nullptr);
+                REQUIRE(res.has_value());
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
+#else
+                REQUIRE(diskann_uring.Deserialize(binset, uring_json) == knowhere::Status::invalid_args);
+#endif
+                uring_json["io_engine"] = "sync";
+                REQUIRE(diskann_uring.Deserialize(binset, uring_json) == knowhere::Status::invalid_args);
+            }
             // knn search with bitset
             std::vector<std::function<std::vector<uint8_t>(size_t, size_t)>> gen_bitset_funcs = {
                 GenerateBitsetWithFirstTbitsSet, GenerateBitsetWithRandomTbitsSet};
@@ -347,6 +449,46 @@ base_search() {
                     }
                 }
             }
+            // knn search with bitset, skipping the reads of the filtered nodes
+            {
+                knowhere::Json skip_json = knn_json;
+                skip_json["filter_threshold"] = -1.0f;
+                skip_json["filtered_read_skip_threshold"] = 0.3f;
+                auto bitset_data = GenerateBitsetWithRandomTbitsSet(kNumRows, 0.4f * kNumRows);
+                knowhere::BitsetView bitset(bitset_data.data(), kNumRows);
+                auto results = diskann.Search(query_ds, skip_json, bitset);
+                REQUIRE(results.has_value());
+                auto gt = knowhere::BruteForce::Search<DataType>(base_ds, query_ds, skip_json, bitset);
+                REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.8f);
+            }
+            // knn search with bitset reranking the PQ candidates with the in-memory vectors
+            {
+                knowhere::Json filter_json = knn_json;
+                filter_json["filter_threshold"] = 0.9f;
+                auto bitset_data = GenerateBitsetWithRandomTbitsSet(kNumRows, 0.98f * kNumRows);
+                knowhere::BitsetView bitset(bitset_data.data(), kNumRows);
+                auto gt = knowhere::BruteForce::Search<DataType>(base_ds, query_ds, filter_json, bitset);
+                for (const std::string tier : {"sq8", "fp16"}) {
+                    knowhere::Json tier_json = deserialize_json;
+                    tier_json["rerank_tier"] = tier;
+                    tier_json["rerank_tier_budget_gb"] = 0.01;
+                    auto diskann_tier = knowhere::IndexFactory::Instance()
+                                            .Create<DataType>("DISKANN", version, diskann_index_pack)
+                                            .value();
+                    REQUIRE(diskann_tier.Deserialize(binset, tier_json) == knowhere::Status::success);
+                    for (const bool exact : {false, true}) {
+                        filter_json["exact_rerank"] = exact;
+                        auto results = diskann_tier.Search(query_ds, filter_json, bitset);
+                        REQUIRE(results.has_value());
+                        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+                    }
+                }
+                knowhere::Json tier_json = deserialize_json;
+                tier_json["rerank_tier"] = "pq";
+                auto diskann_tier =
+                    knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+                REQUIRE(diskann_tier.Deserialize(binset, tier_json) == knowhere::Status::invalid_args);
+            }
 
             // range search process
             auto range_search_json = range_search_gen().dump();
@@ -357,6 +499,67 @@ base_search() {
             float standard_ap = metric_range_ap_map[metric_str];
             REQUIRE(ap > standard_ap);
         }
+        // build the sub-graphs in parallel under a memory budget that the whole index does not fit in
+        {
+            knowhere::Json shard_json = json;
+            shard_json["index_prefix"] = metric_dir_map[metric_str] + "_shard";
+            shard_json["build_dram_budget_gb"] = 0.0006;
+            shard_json["build_shard_parallelism"] = 2;
+            knowhere::Json shard_deserialize_json = deserialize_json;
+            shard_deserialize_json["index_prefix"] = shard_json["index_prefix"];
+            knowhere::BinarySet shard_binset;
+            auto diskann =
+                knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+            REQUIRE(diskann.Build(nullptr, shard_json) == knowhere::Status::success);
+            diskann.Serialize(shard_binset);
+            REQUIRE(diskann.Deserialize(shard_binset, shard_deserialize_json) == knowhere::Status::success);
+            auto res = diskann.Search(query_ds, knowhere::Json::parse(knn_search_gen().dump()), nullptr);
+            REQUIRE(res.has_value());
+            REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= 0.8f);
+        }
+        // pack the nodes on disk by the graph
+        {
+            knowhere::Json layout_json = json;
+            layout_json["index_prefix"] = metric_dir_map[metric_str] + "_layout";
+            layout_json["optimize_disk_layout"] = true;
+            knowhere::Json layout_deserialize_json = deserialize_json;
+            layout_deserialize_json["index_prefix"] = layout_json["index_prefix"];
+            knowhere::BinarySet layout_binset;
+            auto diskann =
+                knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+            REQUIRE(diskann.Build(nullptr, layout_json) == knowhere::Status::success);
+            REQUIRE(fs::exists(layout_json["index_prefix"].get<std::string>() + "_disk.index_layout.bin"));
+            diskann.Serialize(layout_binset);
+            REQUIRE(diskann.Deserialize(layout_binset, layout_deserialize_json) == knowhere::Status::success);
+            auto res = diskann.Search(query_ds, knowhere::Json::parse(knn_search_gen().dump()), nullptr);
+            REQUIRE(res.has_value());
+            REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
+        }
+        // search the index file while it is read through a range reader
+        {
+            knowhere::Json tiered_json = json;
+            tiered_json["index_prefix"] = metric_dir_map[metric_str] + "_tiered";
+            knowhere::Json tiered_deserialize_json = deserialize_json;
+            tiered_deserialize_json["index_prefix"] = tiered_json["index_prefix"];
+            tiered_deserialize_json["tiered_load"] = true;
+            knowhere::BinarySet tiered_binset;
+            auto diskann =
+                knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+            REQUIRE(diskann.Build(nullptr, tiered_json) == knowhere::Status::success);
+            diskann.Serialize(tiered_binset);
+            REQUIRE(diskann.Deserialize(tiered_binset, tiered_deserialize_json) == knowhere::Status::invalid_args);
+
+            auto disk_index_file = tiered_json["index_prefix"].get<std::string>() + "_disk.index";
+            fs::rename(disk_index_file, disk_index_file + ".remote");
+            auto range_reader = std::make_shared<SuffixRangeReader>(".remote");
+            knowhere::KnowhereConfig::SetDiskRangeReader(range_reader);
+            REQUIRE(diskann.Deserialize(tiered_binset, tiered_deserialize_json) == knowhere::Status::success);
+            auto res = diskann.Search(query_ds, knowhere::Json::parse(knn_search_gen().dump()), nullptr);
+            knowhere::KnowhereConfig::SetDiskRangeReader(nullptr);
+            REQUIRE(res.has_value());
+            REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
+            REQUIRE(range_reader->num_reads > 0);
+        }
     }
     fs::remove_all(kDir);
     fs::remove(kDir);
@@ -452,6 +655,131 @@ TEST_CASE("Test DiskANN GetVectorByIds", "[diskann]") {
     fs::remove(kDir);
 }
 
+TEST_CASE("Test DiskANN updates", "[diskann]") {
+    auto version = GenTestVersionList();
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+    REQUIRE_NOTHROW(fs::create_directories(kL2IndexDir));
+
+    constexpr uint32_t kNumAdded = 200;
+    constexpr uint32_t kNumTotal = kNumRows + kNumAdded;
+    auto base_gen = [] {
+        knowhere::Json json;
+        json["dim"] = kDim;
+        json["metric_type"] = knowhere::metric::L2;
+        json["k"] = kK;
+        return json;
+    };
+
+    auto base_ds = GenDataSet(kNumRows, kDim, 30);
+    auto added_ds = GenDataSet(kNumAdded, kDim, 31);
+    auto query_ds = GenDataSet(kNumQueries, kDim, 42);
+    std::vector<float> all_data(kNumTotal * kDim);
+    std::copy_n(static_cast<const float*>(base_ds->GetTensor()), kNumRows * kDim, all_data.begin());
+    std::copy_n(static_cast<const float*>(added_ds->GetTensor()), kNumAdded * kDim,
+                all_data.begin() + kNumRows * kDim);
+    auto all_ds = knowhere::GenDataSet(kNumTotal, kDim, all_data.data());
+    WriteRawDataToDisk<float>(kRawDataPath, static_cast<const float*>(base_ds->GetTensor()), kNumRows, kDim);
+
+    std::shared_ptr<milvus::FileManager> file_manager = std::make_shared<milvus::LocalFileManager>();
+    auto diskann_index_pack = knowhere::Pack(file_manager);
+    knowhere::Json build_json = base_gen();
+    build_json["index_prefix"] = kL2IndexPrefix;
+    build_json["data_path"] = kRawDataPath;
+    build_json["max_degree"] = 56;
+    build_json["search_list_size"] = 128;
+    build_json["pq_code_budget_gb"] = sizeof(float) * kDim * kNumRows * 0.125 / (1024 * 1024 * 1024);
+    build_json["build_dram_budget_gb"] = 32.0;
+    auto diskann =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+    REQUIRE(diskann.Build(nullptr, build_json) == knowhere::Status::success);
+    knowhere::BinarySet binset;
+    REQUIRE(diskann.Serialize(binset) == knowhere::Status::success);
+
+    auto index =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+    knowhere::Json deserialize_json = base_gen();
+    deserialize_json["index_prefix"] = kL2IndexPrefix;
+    REQUIRE(index.Deserialize(binset, deserialize_json) == knowhere::Status::success);
+
+    knowhere::Json search_json = base_gen();
+    search_json["search_list_size"] = 36;
+    std::vector<uint8_t> deleted((kNumTotal + 7) / 8, 0);
+    // the results of the live rows, their vectors and no deleted row
+    auto check = [&]() {
+        knowhere::BitsetView bitset(deleted.data(), kNumTotal);
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(all_ds, query_ds, search_json, bitset);
+        REQUIRE(gt.has_value());
+        auto res = index.Search(query_ds, search_json, nullptr);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *res.value()) >= kKnnRecall);
+        for (uint32_t i = 0; i < kNumQueries * kK; ++i) {
+            auto id = res.value()->GetIds()[i];
+            REQUIRE((id < 0 || !bitset.test(id)));
+        }
+
+        std::vector<int64_t> ids = {1, kNumRows - 1, kNumRows + 1, kNumTotal - 1};
+        auto vectors = index.GetVectorByIds(GenIdsDataSet(ids.size(), ids));
+        REQUIRE(vectors.has_value());
+        auto data = static_cast<const float*>(vectors.value()->GetTensor());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            for (size_t j = 0; j < kDim; ++j) {
+                REQUIRE(data[i * kDim + j] == all_data[ids[i] * kDim + j]);
+            }
+        }
+    };
+
+    // the updates stay in memory without merges
+    knowhere::Json update_json = base_gen();
+    update_json["merge_threshold"] = 0;
+    REQUIRE(index.Add(added_ds, update_json) == knowhere::Status::success);
+    REQUIRE(index.Count() == kNumTotal);
+    std::vector<int64_t> deleted_ids;
+    for (uint32_t id = 0; id < kNumTotal; id += 10) {
+        deleted_ids.push_back(id);
+        deleted[id >> 3] |= 1 << (id & 7);
+    }
+    REQUIRE(index.Delete(GenIdsDataSet(deleted_ids.size(), deleted_ids), update_json) == knowhere::Status::success);
+    std::vector<int64_t> out_of_range_ids = {kNumTotal};
+    REQUIRE(index.Delete(GenIdsDataSet(1, out_of_range_ids), update_json) == knowhere::Status::invalid_args);
+    check();
+
+    // past merge_threshold, the live rows are merged into a new index on disk, which maps their ids
+    update_json["merge_threshold"] = 0.1;
+    std::vector<int64_t> more_deleted_ids = {5};
+    deleted[0] |= 1 << 5;
+    REQUIRE(index.Delete(GenIdsDataSet(1, more_deleted_ids), update_json) == knowhere::Status::success);
+    const auto num_live = kNumTotal - deleted_ids.size() - 1;
+    auto merged = [&]() {
+        auto report = index.GetMemoryReport();
+        return report.has_value() &&
+               report.value().Get(knowhere::MemoryComponent::ID_MAP).heap_bytes >= num_live * sizeof(int64_t);
+    };
+    for (int i = 0; i < 600 && !merged(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    REQUIRE(merged());
+    REQUIRE(index.Count() == kNumTotal);
+    check();
+    std::vector<int64_t> merged_away_ids = {0};
+    REQUIRE(!index.GetVectorByIds(GenIdsDataSet(1, merged_away_ids)).has_value());
+
+    // an index destroyed during a merge gives it up, and leaves no merged files behind
+    index = knowhere::Index<knowhere::IndexNode>();
+    {
+        auto stopped =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(stopped.Deserialize(binset, deserialize_json) == knowhere::Status::success);
+        REQUIRE(stopped.Add(added_ds, update_json) == knowhere::Status::success);
+    }
+    for (const auto& entry : fs::directory_iterator(kL2IndexDir)) {
+        REQUIRE(entry.path().filename().string().find("_merged_") == std::string::npos);
+    }
+
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+}
+
 TEST_CASE("Test_AiSAQ_dynamic_cache", "[diskann]") {
     std::string index_type = "AISAQ";
     constexpr uint32_t kNumRowsTest = 10000;
@@ -886,6 +1214,17 @@ base_AiSAQ_param_test() {
             test_json["beamwidth"] = diskann::defaults::MAX_AISAQ_BEAMWIDTH + 1;
             search_stat = diskann.Search(query_ds, test_json, nullptr);
             REQUIRE(search_stat.error() == knowhere::Status::aisaq_error);
+            LOG_KNOWHERE_INFO_ << "Test speculative_reads parameter value more than maximum";
+            test_json = knn_search_gen();
+            test_json["speculative_reads"] = 65;
+            search_stat = diskann.Search(query_ds, test_json, nullptr);
+            REQUIRE(search_stat.error() == knowhere::Status::out_of_range_in_json);
+            LOG_KNOWHERE_INFO_ << "Test search with speculative reads";
+            test_json = knn_search_gen();
+            test_json["speculative_reads"] = 8;
+            search_stat = diskann.Search(query_ds, test_json, nullptr);
+            REQUIRE(search_stat.has_value());
+            REQUIRE(GetKNNRecall(*knn_gt_ptr, *search_stat.value()) >= kKnnRecall);
         }
     }
     fs::remove_all(kDir);
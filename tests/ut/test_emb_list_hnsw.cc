@@ -27,11 +27,14 @@
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "index/emb_list/emb_list_max_sim.h"
 #include "knowhere/comp/brute_force.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/comp/knowhere_config.h"
 #include "knowhere/dataset.h"
+#include "knowhere/emb_list_utils.h"
 #include "knowhere/index/index_factory.h"
+#include "simd/hook.h"
 #include "utils.h"
 
 namespace {
@@ -486,3 +489,245 @@ TEST_CASE("Search for EMBList HNSW Indices", "Benchmark and validation") {
         }
     }
 }
+
+TEST_CASE("Test fused sum max sim", "[emb_list]") {
+    const size_t dim = GENERATE(as<size_t>{}, 7, 64, 129);
+    const size_t nq = GENERATE(as<size_t>{}, 1, 5, 32);
+    const size_t nd = GENERATE(as<size_t>{}, 1, 3, 100);
+    auto query_ds = GenDataSet(nq, dim, 42);
+    auto doc_ds = GenDataSet(nd, dim, 43);
+    const auto query = static_cast<const float*>(query_ds->GetTensor());
+    const auto doc = static_cast<const float*>(doc_ds->GetTensor());
+
+    // the max sims of the materialized nq x nd inner products
+    std::vector<float> dists(nq * nd);
+    for (size_t i = 0; i < nq; i++) {
+        for (size_t j = 0; j < nd; j++) {
+            dists[i * nd + j] = faiss::fvec_inner_product(query + i * dim, doc + j * dim, dim);
+        }
+    }
+    auto expected_score = knowhere::get_sum_max_sim(dists.data(), nq, nd);
+    REQUIRE(expected_score.has_value());
+
+    SECTION("fp32") {
+        auto score = knowhere::get_fused_sum_max_sim(query, nq, doc, nd, dim);
+        REQUIRE(score.has_value());
+        REQUIRE(score.value() == Catch::Approx(expected_score.value()).epsilon(1e-4));
+    }
+    SECTION("fp16") {
+        std::vector<knowhere::fp16> query_fp16(query, query + nq * dim);
+        std::vector<knowhere::fp16> doc_fp16(doc, doc + nd * dim);
+        auto score = knowhere::get_fused_sum_max_sim(query_fp16.data(), nq, doc_fp16.data(), nd, dim);
+        REQUIRE(score.has_value());
+        REQUIRE(score.value() == Catch::Approx(expected_score.value()).epsilon(1e-2));
+    }
+    SECTION("empty emb_list") {
+        REQUIRE(!knowhere::get_fused_sum_max_sim(query, nq, doc, 0, dim).has_value());
+    }
+}
+
+TEST_CASE("Test EMB_LIST_PLAID", "[emb_list]") {
+    const int32_t dim = 32;
+    const int32_t nb = 1000;
+    const int32_t nq = 10;
+    const int32_t topk = 10;
+    auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+    auto base_ds = GenEmbListDataSet(nb, dim, 42, 10);
+    auto query_ds = GenQueryEmbListDataSet(nq, dim, 43);
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::MAX_SIM;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = topk;
+    conf[knowhere::indexparam::NLIST] = 16;
+    auto golden_result = knowhere::BruteForce::Search<knowhere::fp32>(base_ds, query_ds, conf, nullptr);
+    REQUIRE(golden_result.has_value());
+
+    auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_EMB_LIST_PLAID,
+                                                                           version);
+    REQUIRE(index.has_value());
+    REQUIRE(index.value().Build(base_ds, conf) == knowhere::Status::success);
+    REQUIRE(index.value().Count() == nb);
+
+    SECTION("all the centroids probed, all the candidates scored exactly") {
+        conf[knowhere::indexparam::NPROBE] = 16;
+        conf[knowhere::indexparam::CENTROID_CANDIDATE_RATIO] = 1000.0f;
+        auto result = index.value().Search(query_ds, conf, nullptr);
+        REQUIRE(result.has_value());
+        REQUIRE(GetKNNRecall(*golden_result.value(), *result.value()) == 1.0f);
+
+        knowhere::BinarySet binset;
+        REQUIRE(index.value().Serialize(binset) == knowhere::Status::success);
+        auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(
+            knowhere::IndexEnum::INDEX_EMB_LIST_PLAID, version);
+        REQUIRE(loaded.value().Deserialize(binset, conf) == knowhere::Status::success);
+        auto result_loaded = loaded.value().Search(query_ds, conf, nullptr);
+        REQUIRE(result_loaded.has_value());
+        for (int64_t i = 0; i < result.value()->GetRows() * topk; i++) {
+            REQUIRE(result.value()->GetIds()[i] == result_loaded.value()->GetIds()[i]);
+        }
+    }
+
+    SECTION("filtered emb_lists are not returned") {
+        conf[knowhere::indexparam::NPROBE] = 4;
+        const size_t num_el = nb / 10;
+        std::vector<uint8_t> bitset_data((num_el + 7) / 8, 0);
+        for (size_t i = 0; i < num_el; i += 2) {
+            bitset_data[i / 8] |= 1 << (i % 8);
+        }
+        knowhere::BitsetView bitset(bitset_data.data(), num_el);
+        auto result = index.value().Search(query_ds, conf, bitset);
+        REQUIRE(result.has_value());
+        for (int64_t i = 0; i < result.value()->GetRows() * topk; i++) {
+            auto id = result.value()->GetIds()[i];
+            REQUIRE((id == -1 || id % 2 == 1));
+        }
+    }
+}
+
+TEST_CASE("Test emb_list over compressed base indexes", "[emb_list]") {
+    const int32_t dim = 32;
+    const int32_t nb = 1000;
+    const int32_t nq = 10;
+    const int32_t topk = 10;
+    auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+    auto base_ds = GenEmbListDataSet(nb, dim, 42, 10);
+    auto query_ds = GenQueryEmbListDataSet(nq, dim, 43);
+
+    auto index_type = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_EMB_LIST_IVF_SQ8,
+                               knowhere::IndexEnum::INDEX_EMB_LIST_HNSW_PQ);
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::MAX_SIM;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = topk;
+    conf[knowhere::indexparam::NLIST] = 16;
+    conf[knowhere::indexparam::NPROBE] = 16;
+    conf[knowhere::indexparam::M] = 8;
+    conf[knowhere::indexparam::EF] = 200;
+    conf[knowhere::indexparam::RETRIEVAL_ANN_RATIO] = 10.0f;
+    auto golden_result = knowhere::BruteForce::Search<knowhere::fp32>(base_ds, query_ds, conf, nullptr);
+    REQUIRE(golden_result.has_value());
+
+    auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version);
+    REQUIRE(index.has_value());
+    REQUIRE(index.value().Build(base_ds, conf) == knowhere::Status::success);
+    REQUIRE(index.value().Count() == nb);
+
+    SECTION("search") {
+        auto result = index.value().Search(query_ds, conf, nullptr);
+        REQUIRE(result.has_value());
+        auto recall = GetKNNRecall(*golden_result.value(), *result.value());
+        printf("%s recall: %f\n", index_type.c_str(), recall);
+        REQUIRE(recall >= 0.5);
+    }
+
+    SECTION("filtered emb_lists are not returned") {
+        const size_t num_el = nb / 10;
+        std::vector<uint8_t> bitset_data((num_el + 7) / 8, 0);
+        for (size_t i = 0; i < num_el; i += 2) {
+            bitset_data[i / 8] |= 1 << (i % 8);
+        }
+        knowhere::BitsetView bitset(bitset_data.data(), num_el);
+        auto result = index.value().Search(query_ds, conf, bitset);
+        REQUIRE(result.has_value());
+        for (int64_t i = 0; i < result.value()->GetRows() * topk; i++) {
+            auto id = result.value()->GetIds()[i];
+            REQUIRE((id == -1 || id % 2 == 1));
+        }
+    }
+}
+
+TEST_CASE("Test EMB_LIST_PLAID with residual codes", "[emb_list]") {
+    const int32_t dim = 32;
+    const int32_t nb = 1000;
+    const int32_t nq = 10;
+    const int32_t topk = 10;
+    auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+    auto base_ds = GenEmbListDataSet(nb, dim, 42, 10);
+    auto query_ds = GenQueryEmbListDataSet(nq, dim, 43);
+
+    auto residual_bits = GENERATE(1, 2);
+    auto refine = GENERATE(false, true);
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::MAX_SIM;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = topk;
+    conf[knowhere::indexparam::NLIST] = 16;
+    conf[knowhere::indexparam::NPROBE] = 16;
+    conf[knowhere::indexparam::CENTROID_CANDIDATE_RATIO] = 1000.0f;
+    conf[knowhere::indexparam::EMB_LIST_RESIDUAL_BITS] = residual_bits;
+    conf[knowhere::indexparam::EMB_LIST_REFINE] = refine;
+    conf[knowhere::indexparam::EMB_LIST_REFINE_K] = 1000.0f;
+    auto golden_result = knowhere::BruteForce::Search<knowhere::fp32>(base_ds, query_ds, conf, nullptr);
+    REQUIRE(golden_result.has_value());
+
+    auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_EMB_LIST_PLAID,
+                                                                           version);
+    REQUIRE(index.value().Build(base_ds, conf) == knowhere::Status::success);
+    REQUIRE(index.value().Count() == nb);
+    auto result = index.value().Search(query_ds, conf, nullptr);
+    REQUIRE(result.has_value());
+    auto recall = GetKNNRecall(*golden_result.value(), *result.value());
+    printf("residual_bits: %d, refine: %d, recall: %f\n", residual_bits, refine, recall);
+    if (refine) {
+        // every candidate is refined
+        REQUIRE(recall == 1.0f);
+    } else {
+        REQUIRE(recall >= 0.5f);
+    }
+
+    knowhere::BinarySet binset;
+    REQUIRE(index.value().Serialize(binset) == knowhere::Status::success);
+    auto loaded =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_EMB_LIST_PLAID, version);
+    REQUIRE(loaded.value().Deserialize(binset, conf) == knowhere::Status::success);
+    REQUIRE(loaded.value().Size() == index.value().Size());
+    auto result_loaded = loaded.value().Search(query_ds, conf, nullptr);
+    REQUIRE(result_loaded.has_value());
+    for (int64_t i = 0; i < result.value()->GetRows() * topk; i++) {
+        REQUIRE(result.value()->GetIds()[i] == result_loaded.value()->GetIds()[i]);
+    }
+}
+
+TEST_CASE("Test emb_list rerank of query emb_lists in parallel", "[emb_list]") {
+    const int32_t dim = 32;
+    const int32_t nb = 1000;
+    const int32_t nq = 16;
+    const int32_t topk = 10;
+    auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+    auto base_ds = GenEmbListDataSet(nb, dim, 42, 10);
+    auto query_ds = GenQueryEmbListDataSet(nq, dim, 43);
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::MAX_SIM;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = topk;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    conf[knowhere::indexparam::RETRIEVAL_ANN_RATIO] = 2.0f;
+
+    auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_EMB_LIST_HNSW,
+                                                                           version);
+    REQUIRE(index.value().Build(base_ds, conf) == knowhere::Status::success);
+    auto result = index.value().Search(query_ds, conf, nullptr);
+    REQUIRE(result.has_value());
+
+    // every query emb_list alone, reranked with the whole pool, has the results of the batch
+    const size_t* lims = query_ds->GetLims();
+    const auto tensor = static_cast<const float*>(query_ds->GetTensor());
+    for (int64_t i = 0; i < result.value()->GetRows(); i++) {
+        const auto rows = lims[i + 1] - lims[i];
+        auto single_ds = knowhere::GenDataSet(rows, dim, tensor + lims[i] * dim);
+        auto single_lims = std::make_unique<size_t[]>(2);
+        single_lims[0] = 0;
+        single_lims[1] = rows;
+        single_ds->SetLims(std::move(single_lims));
+        auto single_result = index.value().Search(single_ds, conf, nullptr);
+        REQUIRE(single_result.has_value());
+        for (int32_t j = 0; j < topk; j++) {
+            REQUIRE(single_result.value()->GetIds()[j] == result.value()->GetIds()[i * topk + j]);
+            REQUIRE(single_result.value()->GetDistance()[j] == result.value()->GetDistance()[i * topk + j]);
+        }
+    }
+}
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -18,6 +19,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
@@ -27,11 +29,23 @@
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "faiss/IndexCosine.h"
+#include "faiss/IndexHNSW.h"
+#include "faiss/cppcontrib/knowhere/utils/VisitedSet.h"
+#include "faiss/index_io.h"
+#include "index/hnsw/impl/HnswBulkBuilder.h"
+#include "index/hnsw/impl/HnswEntryPoints.h"
+#include "index/hnsw/impl/IndexConditionalWrapper.h"
+#include "index/hnsw/impl/HnswLazyLoader.h"
+#include "index/hnsw/impl/IndexHNSWWrapper.h"
+#include "knowhere/bitsetview_idselector.h"
 #include "knowhere/comp/brute_force.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/comp/knowhere_config.h"
+#include "knowhere/comp/search_planner.h"
 #include "knowhere/dataset.h"
 #include "knowhere/index/index_factory.h"
+#include "io/index_binary.h"
 #include "utils.h"
 
 namespace {
@@ -2426,3 +2440,1392 @@ TEST_CASE("External ID Map for 1-hop Bitset Check", "[external_id_map]") {
         }
     }
 }
+
+TEST_CASE("Graph Reordering for FAISS HNSW Indices", "[graph_reordering]") {
+    const int64_t nb = 2000;
+    const int64_t dim = 32;
+    const int64_t nq = 20;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto [index_type, sq_refine] = GENERATE(table<std::string, bool>({{knowhere::IndexEnum::INDEX_HNSW, false},
+                                                                       {knowhere::IndexEnum::INDEX_HNSW_SQ, false},
+                                                                       {knowhere::IndexEnum::INDEX_HNSW_SQ, true}}));
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    if (sq_refine) {
+        conf[knowhere::indexparam::HNSW_REFINE] = true;
+        conf[knowhere::indexparam::HNSW_REFINE_TYPE] = "FLAT";
+        conf[knowhere::indexparam::HNSW_REFINE_K] = 2;
+    }
+    knowhere::Json reorder_conf = conf;
+    reorder_conf[knowhere::indexparam::GRAPH_REORDERING] = true;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = CopyDataSet(train_ds, nq);
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+    auto reordered_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(reordered_idx.Build(train_ds, reorder_conf) == knowhere::Status::success);
+    REQUIRE(reordered_idx.Count() == nb);
+
+    // the reordered graph is the same graph with other node ids, so it is expected to find the same neighbors
+    auto results = idx.Search(query_ds, conf, nullptr);
+    auto reordered_results = reordered_idx.Search(query_ds, conf, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(reordered_results.has_value());
+    REQUIRE(GetKNNRecall(*results.value(), *reordered_results.value()) >= 0.95f);
+
+    SECTION("Search With Bitset") {
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto filtered_results = reordered_idx.Search(query_ds, conf, bitset);
+        REQUIRE(filtered_results.has_value());
+        auto ids = filtered_results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(!bitset.test(ids[i]));
+        }
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, bitset);
+        REQUIRE(GetKNNRecall(*gt.value(), *filtered_results.value()) >= 0.9f);
+    }
+
+    SECTION("Serialize and Deserialize") {
+        knowhere::BinarySet bs;
+        REQUIRE(reordered_idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, conf) == knowhere::Status::success);
+        auto loaded_results = loaded_idx.Search(query_ds, conf, nullptr);
+        REQUIRE(loaded_results.has_value());
+        auto ids = reordered_results.value()->GetIds();
+        auto loaded_ids = loaded_results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == loaded_ids[i]);
+        }
+    }
+
+    SECTION("Get Vector By Ids") {
+        if (index_type == knowhere::IndexEnum::INDEX_HNSW) {
+            std::vector<int64_t> ids_v{0, 1, nb / 2, nb - 1};
+            auto ids_ds = GenIdsDataSet(ids_v.size(), ids_v);
+            auto vectors = reordered_idx.GetVectorByIds(ids_ds);
+            REQUIRE(vectors.has_value());
+            auto data = reinterpret_cast<const float*>(vectors.value()->GetTensor());
+            auto train_data = reinterpret_cast<const float*>(train_ds->GetTensor());
+            for (size_t i = 0; i < ids_v.size(); ++i) {
+                for (int64_t j = 0; j < dim; ++j) {
+                    REQUIRE(data[i * dim + j] == train_data[ids_v[i] * dim + j]);
+                }
+            }
+        }
+    }
+
+    SECTION("Add To A Reordered Index") {
+        REQUIRE(reordered_idx.Add(train_ds, reorder_conf) == knowhere::Status::not_implemented);
+    }
+}
+
+TEST_CASE("Prefetching in the HNSW Searcher", "[prefetch]") {
+    const int64_t nb = 5000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+
+    auto index_type = GENERATE(as<std::string>{}, "FLAT", "FLAT_COSINE", "SQ8", "PQ");
+    std::unique_ptr<faiss::IndexHNSW> index;
+    if (index_type == "FLAT") {
+        index = std::make_unique<faiss::IndexHNSWFlat>(dim, 16);
+    } else if (index_type == "FLAT_COSINE") {
+        index = std::make_unique<faiss::IndexHNSWFlatCosine>(dim, 16);
+    } else if (index_type == "SQ8") {
+        index = std::make_unique<faiss::IndexHNSWSQ>(dim, faiss::ScalarQuantizer::QT_8bit, 16);
+    } else {
+        index = std::make_unique<faiss::IndexHNSWPQ>(dim, 8, 16, 8);
+    }
+    REQUIRE(knowhere::hnsw_prefetch_distance(index->storage) > 0);
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto train_data = reinterpret_cast<const float*>(train_ds->GetTensor());
+    auto query_data = reinterpret_cast<const float*>(query_ds->GetTensor());
+    index->train(nb, train_data);
+    index->add(nb, train_data);
+
+    knowhere::IndexHNSWWrapper wrapper(index.get());
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+    knowhere::BitsetView bitset(bitset_data.data(), nb);
+    knowhere::BitsetViewIDSelector selector(bitset);
+    auto with_filter = GENERATE(false, true);
+
+    // the prefetching only changes the order of the memory accesses, results are expected to be the same
+    auto search = [&](int prefetch_distance) {
+        knowhere::SearchParametersHNSWWrapper params;
+        params.efSearch = 64;
+        params.prefetch_distance = prefetch_distance;
+        params.kAlpha = with_filter ? bitset.filter_ratio() * 0.7f : 0.0f;
+        params.sel = with_filter ? &selector : nullptr;
+        std::vector<faiss::idx_t> ids(nq * k);
+        std::vector<float> distances(nq * k);
+        wrapper.search(nq, query_data, k, distances.data(), ids.data(), &params);
+        return std::make_pair(ids, distances);
+    };
+    auto [ids, distances] = search(0);
+    for (int prefetch_distance : {-1, 1, 5, 64}) {
+        auto [prefetched_ids, prefetched_distances] = search(prefetch_distance);
+        REQUIRE(prefetched_ids == ids);
+        REQUIRE(prefetched_distances == distances);
+    }
+}
+
+TEST_CASE("Interleaved Searches of the HNSW Searcher", "[interleaved]") {
+    const int64_t nb = 5000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+
+    auto index_type = GENERATE(as<std::string>{}, "FLAT", "SQ8");
+    std::unique_ptr<faiss::IndexHNSW> index;
+    if (index_type == "FLAT") {
+        index = std::make_unique<faiss::IndexHNSWFlat>(dim, 16);
+    } else {
+        index = std::make_unique<faiss::IndexHNSWSQ>(dim, faiss::ScalarQuantizer::QT_8bit, 16);
+    }
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto train_data = reinterpret_cast<const float*>(train_ds->GetTensor());
+    auto query_data = reinterpret_cast<const float*>(query_ds->GetTensor());
+    index->train(nb, train_data);
+    index->add(nb, train_data);
+
+    knowhere::IndexHNSWWrapper wrapper(index.get());
+    const size_t nbits_set = nb * 0.85f;
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nbits_set);
+    knowhere::BitsetView bitset(bitset_data.data(), nb, nbits_set);
+    knowhere::BitsetViewIDSelector selector(bitset);
+    auto with_filter = GENERATE(false, true);
+    auto two_hop_connectivity = GENERATE(0.0f, 0.25f);
+
+    // the interleaving only changes the order in which the expansions of the queries are run,
+    //   results are expected to be the same
+    auto search = [&](size_t interleaved_queries) {
+        knowhere::SearchParametersHNSWWrapper params;
+        params.efSearch = 64;
+        params.interleaved_queries = interleaved_queries;
+        params.kAlpha = with_filter ? bitset.filter_ratio() * 0.7f : 0.0f;
+        params.sel = with_filter ? &selector : nullptr;
+        params.two_hop_connectivity = with_filter ? two_hop_connectivity : 0.0f;
+        std::vector<faiss::idx_t> ids(nq * k);
+        std::vector<float> distances(nq * k);
+        wrapper.search(nq, query_data, k, distances.data(), ids.data(), &params);
+        return std::make_pair(ids, distances);
+    };
+    auto [ids, distances] = search(1);
+    for (size_t interleaved_queries : {2, 7, 8, 64}) {
+        auto [interleaved_ids, interleaved_distances] = search(interleaved_queries);
+        REQUIRE(interleaved_ids == ids);
+        REQUIRE(interleaved_distances == distances);
+    }
+}
+
+TEST_CASE("Early Termination of the HNSW Searcher", "[early_termination]") {
+    const int64_t nb = 5000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+
+    faiss::IndexHNSWFlat index(dim, 16);
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto train_data = reinterpret_cast<const float*>(train_ds->GetTensor());
+    auto query_data = reinterpret_cast<const float*>(query_ds->GetTensor());
+    index.add(nb, train_data);
+
+    knowhere::IndexHNSWWrapper wrapper(&index);
+    auto search = [&](size_t patience, size_t interleaved_queries) {
+        faiss::HNSWStats stats;
+        knowhere::SearchParametersHNSWWrapper params;
+        params.efSearch = 256;
+        params.hnsw_stats = &stats;
+        params.interleaved_queries = interleaved_queries;
+        params.early_termination_patience = patience;
+        std::vector<faiss::idx_t> ids(nq * k);
+        std::vector<float> distances(nq * k);
+        wrapper.search(nq, query_data, k, distances.data(), ids.data(), &params);
+        return std::make_tuple(ids, distances, stats.ndis);
+    };
+
+    // a patience that is never exhausted does not change the search
+    auto [ids, distances, ndis] = search(0, 1);
+    auto [patient_ids, patient_distances, patient_ndis] = search(1 << 20, 1);
+    REQUIRE(patient_ids == ids);
+    REQUIRE(patient_distances == distances);
+    REQUIRE(patient_ndis == ndis);
+
+    // a short patience stops the searches early, the same way with interleaved expansions
+    auto [early_ids, early_distances, early_ndis] = search(16, 1);
+    REQUIRE(early_ndis < ndis);
+    auto [interleaved_ids, interleaved_distances, interleaved_ndis] = search(16, 8);
+    REQUIRE(interleaved_ids == early_ids);
+    REQUIRE(interleaved_distances == early_distances);
+
+    size_t hits = 0;
+    for (int64_t i = 0; i < nq * k; ++i) {
+        hits += std::count(ids.begin() + (i / k) * k, ids.begin() + (i / k + 1) * k, early_ids[i]);
+    }
+    REQUIRE(hits >= nq * k * 0.8f);
+}
+
+TEST_CASE("Entry Points of the HNSW Searcher", "[entry_points]") {
+    const int64_t nb = 5000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+
+    faiss::IndexHNSWFlat index(dim, 16);
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto train_data = reinterpret_cast<const float*>(train_ds->GetTensor());
+    auto query_data = reinterpret_cast<const float*>(query_ds->GetTensor());
+    index.add(nb, train_data);
+
+    const auto entry_points = knowhere::build_hnsw_entry_points(index, 32);
+    REQUIRE(!entry_points.empty());
+    REQUIRE(entry_points.size() <= 32);
+    REQUIRE(std::is_sorted(entry_points.begin(), entry_points.end()));
+    REQUIRE(std::adjacent_find(entry_points.begin(), entry_points.end()) == entry_points.end());
+    REQUIRE(entry_points.back() < nb);
+
+    knowhere::IndexHNSWWrapper wrapper(&index);
+    auto search = [&](bool with_entry_points, size_t interleaved_queries) {
+        knowhere::SearchParametersHNSWWrapper params;
+        params.efSearch = 64;
+        params.interleaved_queries = interleaved_queries;
+        if (with_entry_points) {
+            params.entry_points = entry_points.data();
+            params.n_entry_points = entry_points.size();
+        }
+        std::vector<faiss::idx_t> ids(nq * k);
+        std::vector<float> distances(nq * k);
+        wrapper.search(nq, query_data, k, distances.data(), ids.data(), &params);
+        return std::make_pair(ids, distances);
+    };
+
+    // the searches that start from the entry points find about the same neighbors
+    auto [ids, distances] = search(false, 1);
+    auto [entry_ids, entry_distances] = search(true, 1);
+    size_t hits = 0;
+    for (int64_t i = 0; i < nq * k; ++i) {
+        hits += std::count(ids.begin() + (i / k) * k, ids.begin() + (i / k + 1) * k, entry_ids[i]);
+    }
+    REQUIRE(hits >= nq * k * 0.9f);
+
+    // the same way with interleaved expansions
+    auto [interleaved_ids, interleaved_distances] = search(true, 8);
+    REQUIRE(interleaved_ids == entry_ids);
+    REQUIRE(interleaved_distances == entry_distances);
+}
+
+TEST_CASE("Bulk Build of FAISS HNSW Indices", "[bulk_build]") {
+    const int64_t nb = 3000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto [index_type, sq_refine] = GENERATE(table<std::string, bool>({{knowhere::IndexEnum::INDEX_HNSW, false},
+                                                                       {knowhere::IndexEnum::INDEX_HNSW_SQ, true},
+                                                                       {knowhere::IndexEnum::INDEX_HNSW_PQ, false}}));
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    if (index_type == knowhere::IndexEnum::INDEX_HNSW_PQ) {
+        conf[knowhere::indexparam::M] = 8;
+        conf[knowhere::indexparam::NBITS] = 8;
+    }
+    if (sq_refine) {
+        conf[knowhere::indexparam::HNSW_REFINE] = true;
+        conf[knowhere::indexparam::HNSW_REFINE_TYPE] = "FLAT";
+        conf[knowhere::indexparam::HNSW_REFINE_K] = 2;
+    }
+    knowhere::Json bulk_conf = conf;
+    bulk_conf[knowhere::indexparam::HNSW_BULK_BUILD] = true;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    auto build_and_search = [&](const knowhere::Json& build_conf, const knowhere::BitsetView& bitset) {
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(idx.Build(train_ds, build_conf) == knowhere::Status::success);
+        REQUIRE(idx.Count() == nb);
+        auto results = idx.Search(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+        return results.value();
+    };
+
+    // the graph is built with the same candidate search and pruning, so it is expected to be as good
+    auto results = build_and_search(conf, nullptr);
+    auto bulk_results = build_and_search(bulk_conf, nullptr);
+    const float recall = GetKNNRecall(*gt.value(), *results);
+    const float bulk_recall = GetKNNRecall(*gt.value(), *bulk_results);
+    REQUIRE(bulk_recall >= recall - 0.05f);
+
+    SECTION("Deterministic Graph") {
+        // the batches do not depend on the scheduling of the threads
+        auto bulk_results_again = build_and_search(bulk_conf, nullptr);
+        auto ids = bulk_results->GetIds();
+        auto ids_again = bulk_results_again->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == ids_again[i]);
+        }
+    }
+
+    SECTION("Serialize and Deserialize") {
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(idx.Build(train_ds, bulk_conf) == knowhere::Status::success);
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, conf) == knowhere::Status::success);
+        auto loaded_results = loaded_idx.Search(query_ds, conf, nullptr);
+        REQUIRE(loaded_results.has_value());
+        auto ids = bulk_results->GetIds();
+        auto loaded_ids = loaded_results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == loaded_ids[i]);
+        }
+    }
+
+    SECTION("Build With Scalar Info") {
+        auto scalar_info = GenerateScalarInfo(nb);
+        train_ds->Set(knowhere::meta::SCALAR_INFO, scalar_info);
+        auto bitset_data = GenerateBitsetByScalarInfoAndFirstTBits(scalar_info[0][0], nb, 0);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto filtered_gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, bitset);
+        auto filtered_results = build_and_search(conf, bitset);
+        auto bulk_filtered_results = build_and_search(bulk_conf, bitset);
+        auto ids = bulk_filtered_results->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(!bitset.test(ids[i]));
+        }
+        REQUIRE(GetKNNRecall(*filtered_gt.value(), *bulk_filtered_results) >=
+                GetKNNRecall(*filtered_gt.value(), *filtered_results) - 0.05f);
+    }
+}
+
+TEST_CASE("FAISS HNSW Indices From a Prebuilt Base Graph", "[base_graph]") {
+    const int64_t nb = 3000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    const int hnsw_m = 16;
+    const int64_t degree = 2 * hnsw_m;
+    auto version = GenTestVersionList();
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::EF] = 64;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    // an exact knn graph stands for the graph built on GPU, the first neighbor of a node is the node itself
+    knowhere::Json graph_conf = conf;
+    graph_conf[knowhere::meta::TOPK] = degree + 1;
+    auto knn = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, train_ds, graph_conf, nullptr);
+    REQUIRE(knn.has_value());
+    std::vector<int64_t> graph(nb * degree);
+    for (int64_t i = 0; i < nb; ++i) {
+        std::copy_n(knn.value()->GetIds() + i * (degree + 1) + 1, degree, graph.begin() + i * degree);
+    }
+
+    faiss::IndexHNSWFlat hnsw_index(dim, hnsw_m);
+    hnsw_index.hnsw.efConstruction = 96;
+    hnsw_index.storage->add(nb, static_cast<const float*>(train_ds->GetTensor()));
+    knowhere::hnsw_build_from_base_graph(hnsw_index, graph.data(), degree);
+    REQUIRE(hnsw_index.ntotal == nb);
+
+    // level 0 is the base graph
+    size_t begin, end;
+    hnsw_index.hnsw.neighbor_range(0, 0, &begin, &end);
+    for (int64_t j = 0; j < degree; ++j) {
+        REQUIRE(hnsw_index.hnsw.neighbors[begin + j] == graph[j]);
+    }
+
+    // the index is served by the HNSW index node
+    knowhere::BinarySet bs;
+    knowhere::AppendIndexBinary(bs, knowhere::IndexEnum::INDEX_HNSW, knowhere::Version(version),
+                                [&](faiss::IOWriter* writer) { faiss::write_index(&hnsw_index, writer); });
+    auto idx =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_HNSW, version).value();
+    REQUIRE(idx.Deserialize(bs, conf) == knowhere::Status::success);
+    REQUIRE(idx.Count() == nb);
+    auto results = idx.Search(query_ds, conf, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+}
+
+TEST_CASE("Filter-Aware Traversal of FAISS HNSW Indices", "[filter]") {
+    const int64_t nb = 10000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto index_type = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_HNSW, knowhere::IndexEnum::INDEX_HNSW_SQ);
+    // restrictive filters, served by the graph rather than by the brute force the planner picks for so few rows
+    auto filter_ratio = GENERATE(0.8f, 0.9f);
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::meta::RADIUS] = knowhere::IsMetricType(metric, knowhere::metric::L2) ? 10.0 : 0.0;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    conf[knowhere::indexparam::HNSW_SEARCH_STRATEGY] = "graph";
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+
+    const size_t nbits_set = nb * filter_ratio;
+    const std::vector<uint8_t> bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nbits_set);
+    knowhere::BitsetView bitset(bitset_data.data(), nb, nbits_set);
+    REQUIRE(bitset.filter_ratio() >= knowhere::HnswSearchThresholds::kHnswSearchTwoHopFilterThreshold);
+
+    SECTION("Search") {
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, bitset);
+        REQUIRE(gt.has_value());
+        conf[knowhere::meta::SEARCH_STATS] = true;
+        auto results = idx.Search(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+
+        auto ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(!bitset.test(ids[i]));
+        }
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+
+        // the queries went through the two-hop traversal
+        auto stats = results.value()->GetSearchStats();
+        REQUIRE(stats != nullptr);
+        for (const auto& query_stats : *stats) {
+            REQUIRE((query_stats.strategies & static_cast<uint32_t>(knowhere::SearchStrategy::GRAPH_TWO_HOP)) != 0);
+        }
+    }
+
+    SECTION("Range Search") {
+        auto results = idx.RangeSearch(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+
+        auto ids = results.value()->GetIds();
+        auto lims = results.value()->GetLims();
+        for (size_t i = 0; i < lims[nq]; ++i) {
+            REQUIRE(!bitset.test(ids[i]));
+        }
+    }
+}
+
+TEST_CASE("Inline Layout of FAISS HNSW Indices", "[inline_layout]") {
+    const int64_t nb = 3000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto index_type = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_HNSW, knowhere::IndexEnum::INDEX_HNSW_SQ,
+                               knowhere::IndexEnum::INDEX_HNSW_PQ);
+    const bool with_filter = GENERATE(false, true);
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::meta::RADIUS] = knowhere::IsMetricType(metric, knowhere::metric::L2) ? 10.0 : 0.0;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    if (index_type == knowhere::IndexEnum::INDEX_HNSW_PQ) {
+        conf[knowhere::indexparam::M] = 8;
+        conf[knowhere::indexparam::NBITS] = 8;
+    }
+    knowhere::Json inline_conf = conf;
+    inline_conf[knowhere::indexparam::HNSW_INLINE_LAYOUT] = true;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+
+    // no refine, so that the results only come from the graph search
+    auto inline_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(inline_idx.Build(train_ds, inline_conf) == knowhere::Status::success);
+    knowhere::BinarySet bs;
+    REQUIRE(inline_idx.Serialize(bs) == knowhere::Status::success);
+
+    // the layout is not serialized
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Deserialize(bs, conf) == knowhere::Status::success);
+    REQUIRE(inline_idx.Size() > idx.Size());
+
+    auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(loaded_idx.Deserialize(bs, inline_conf) == knowhere::Status::success);
+    REQUIRE(loaded_idx.Size() == inline_idx.Size());
+
+    const auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+    const knowhere::BitsetView bitset =
+        with_filter ? knowhere::BitsetView(bitset_data.data(), nb, nb / 2) : knowhere::BitsetView(nullptr);
+
+    // the layout is a copy of the graph and of the codes, so the search visits the same nodes
+    auto results = idx.Search(query_ds, conf, bitset);
+    REQUIRE(results.has_value());
+    for (auto* other_idx : {&inline_idx, &loaded_idx}) {
+        auto inline_results = other_idx->Search(query_ds, conf, bitset);
+        REQUIRE(inline_results.has_value());
+        auto ids = results.value()->GetIds();
+        auto inline_ids = inline_results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == inline_ids[i]);
+        }
+
+        auto range_results = idx.RangeSearch(query_ds, conf, bitset);
+        auto inline_range_results = other_idx->RangeSearch(query_ds, conf, bitset);
+        REQUIRE(range_results.has_value());
+        REQUIRE(inline_range_results.has_value());
+        auto lims = range_results.value()->GetLims();
+        auto inline_lims = inline_range_results.value()->GetLims();
+        for (int64_t i = 0; i <= nq; ++i) {
+            REQUIRE(lims[i] == inline_lims[i]);
+        }
+    }
+}
+
+TEST_CASE("Lazy Load of FAISS HNSW Indices", "[lazy_load]") {
+    const int64_t nb = 3000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    SECTION("prefetch of all the nodes") {
+        auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+        faiss::IndexHNSWFlat index(dim, 16);
+        index.add(nb, reinterpret_cast<const float*>(train_ds->GetTensor()));
+
+        auto hot_nodes = GENERATE(as<size_t>{}, 0, 100, 100000);
+        auto loader = knowhere::HnswLazyLoader::create(index, nullptr, hot_nodes);
+        REQUIRE(loader != nullptr);
+        for (int i = 0; i < 1000 && !loader->done(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(loader->done());
+    }
+
+    SECTION("search of an mmapped index") {
+        auto index_type = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_HNSW,
+                                   knowhere::IndexEnum::INDEX_HNSW_SQ);
+        knowhere::Json conf;
+        conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+        conf[knowhere::meta::DIM] = dim;
+        conf[knowhere::meta::TOPK] = k;
+        conf[knowhere::indexparam::HNSW_M] = 16;
+        conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+        conf[knowhere::indexparam::EF] = 64;
+
+        auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+        auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+
+        const std::string path = "/tmp/knowhere_hnsw_lazy_load_test";
+        auto binary = bs.GetByName(idx.Type());
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(binary->data.get()), binary->size);
+        out.close();
+
+        knowhere::Json lazy_conf = conf;
+        lazy_conf["enable_mmap"] = true;
+        lazy_conf[knowhere::indexparam::HNSW_LAZY_LOAD] = true;
+        auto lazy_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(lazy_idx.DeserializeFromFile(path, lazy_conf) == knowhere::Status::success);
+
+        // the searches do not wait for the prefetch, and see the same index
+        auto results = idx.Search(query_ds, conf, nullptr);
+        auto lazy_results = lazy_idx.Search(query_ds, conf, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(lazy_results.has_value());
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(results.value()->GetIds()[i] == lazy_results.value()->GetIds()[i]);
+        }
+
+        // the prefetch is stopped before the index is reloaded
+        REQUIRE(lazy_idx.DeserializeFromFile(path, lazy_conf) == knowhere::Status::success);
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("Visited Sets of the HNSW Searcher", "[visited_set]") {
+    using VisitedSet = faiss::cppcontrib::knowhere::VisitedSet;
+
+    // large graphs visited by small queries use a hash set, others a per-node table
+    const auto [ntotal, expected_visits, kind] = GENERATE(table<size_t, size_t, VisitedSet::Kind>(
+        {std::make_tuple(size_t(1) << 20, 500, VisitedSet::Kind::Hash),
+         std::make_tuple(size_t(1) << 12, 500, VisitedSet::Kind::Epoch),
+         std::make_tuple((size_t(1) << 24) + 1, size_t(1) << 20, VisitedSet::Kind::Bitset)}));
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> distrib(0, ntotal - 1);
+
+    VisitedSet visited;
+    for (int query = 0; query < 3; query++) {
+        visited.reset(ntotal, expected_visits);
+        REQUIRE(visited.get_kind() == kind);
+
+        // more visits than expected, so that the hash set grows and ends up as a bitset
+        std::unordered_set<size_t> reference;
+        for (size_t i = 0; i < std::min<size_t>(100 * expected_visits, 50000); i++) {
+            const size_t id = distrib(rng);
+            REQUIRE(visited.get(id) == (reference.count(id) > 0));
+            visited.set(id);
+            reference.insert(id);
+            REQUIRE(visited.get(id));
+        }
+        if (kind == VisitedSet::Kind::Hash) {
+            REQUIRE(visited.get_kind() == VisitedSet::Kind::Bitset);
+        }
+        for (size_t i = 0; i < 1000; i++) {
+            const size_t id = distrib(rng);
+            REQUIRE(visited.get(id) == (reference.count(id) > 0));
+        }
+
+        // the set is empty again after a clear
+        visited.clear();
+        for (const auto id : reference) {
+            REQUIRE(!visited.get(id));
+        }
+    }
+}
+
+TEST_CASE("HNSW_RABITQ Indices", "[rabitq]") {
+    const int64_t nb = 3000;
+    const int64_t dim = 128;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    const int rbq_bits_query = GENERATE(0, 8);
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    conf[knowhere::indexparam::RABITQ_QUERY_BITS] = rbq_bits_query;
+    knowhere::Json refine_conf = conf;
+    refine_conf[knowhere::indexparam::HNSW_REFINE] = true;
+    refine_conf[knowhere::indexparam::HNSW_REFINE_TYPE] = "FP32";
+    refine_conf[knowhere::indexparam::HNSW_REFINE_K] = 4;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    const auto index_type = knowhere::IndexEnum::INDEX_HNSW_RABITQ;
+    REQUIRE(!knowhere::IndexStaticFaced<knowhere::fp32>::HasRawData(index_type, version, conf));
+    REQUIRE(knowhere::IndexStaticFaced<knowhere::fp32>::HasRawData(index_type, version, refine_conf));
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+    REQUIRE(idx.Count() == nb);
+    REQUIRE(!idx.HasRawData(metric));
+    auto results = idx.Search(query_ds, conf, nullptr);
+    REQUIRE(results.has_value());
+
+    auto refine_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(refine_idx.Build(train_ds, refine_conf) == knowhere::Status::success);
+    REQUIRE(refine_idx.HasRawData(metric));
+    auto refine_results = refine_idx.Search(query_ds, refine_conf, nullptr);
+    REQUIRE(refine_results.has_value());
+
+    // the refine recovers the recall that 1-bit codes lose
+    const float recall = GetKNNRecall(*gt.value(), *results.value());
+    const float refine_recall = GetKNNRecall(*gt.value(), *refine_results.value());
+    REQUIRE(refine_recall >= recall);
+    REQUIRE(refine_recall >= 0.8f);
+
+    // 1-bit codes are much smaller than the fp32 vectors the graph was built with
+    auto flat_idx =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_HNSW, version).value();
+    REQUIRE(flat_idx.Build(train_ds, conf) == knowhere::Status::success);
+    REQUIRE(idx.Size() < flat_idx.Size());
+
+    // the rotation, the codes and the norms are serialized
+    for (auto* index : {&idx, &refine_idx}) {
+        const auto& search_conf = (index == &idx) ? conf : refine_conf;
+        knowhere::BinarySet bs;
+        REQUIRE(index->Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, search_conf) == knowhere::Status::success);
+
+        auto expected_results = index->Search(query_ds, search_conf, nullptr);
+        auto loaded_results = loaded_idx.Search(query_ds, search_conf, nullptr);
+        REQUIRE(expected_results.has_value());
+        REQUIRE(loaded_results.has_value());
+        auto ids = expected_results.value()->GetIds();
+        auto loaded_ids = loaded_results.value()->GetIds();
+        auto dists = expected_results.value()->GetDistance();
+        auto loaded_dists = loaded_results.value()->GetDistance();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == loaded_ids[i]);
+            REQUIRE(dists[i] == Catch::Approx(loaded_dists[i]));
+        }
+    }
+}
+
+TEST_CASE("Deletes From FAISS HNSW Indices", "[delete]") {
+    const int64_t nb = 3000;
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::COSINE);
+    auto [index_type, sq_refine] = GENERATE(table<std::string, bool>({{knowhere::IndexEnum::INDEX_HNSW, false},
+                                                                       {knowhere::IndexEnum::INDEX_HNSW_SQ, false},
+                                                                       {knowhere::IndexEnum::INDEX_HNSW_SQ, true}}));
+    // 1.0 only unlinks the deleted rows from the graph, 0.0 removes them from the index as well
+    const float compaction_ratio = GENERATE(1.0f, 0.0f);
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::meta::RADIUS] = knowhere::IsMetricType(metric, knowhere::metric::L2) ? 10.0 : 0.0;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    if (sq_refine) {
+        conf[knowhere::indexparam::HNSW_REFINE] = true;
+        conf[knowhere::indexparam::HNSW_REFINE_TYPE] = "FLAT";
+        conf[knowhere::indexparam::HNSW_REFINE_K] = 2;
+    }
+    knowhere::Json delete_conf = conf;
+    delete_conf[knowhere::indexparam::HNSW_TOMBSTONE_COMPACTION_RATIO] = compaction_ratio;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+
+    // every third row is deleted, in two batches
+    std::vector<uint8_t> deleted_data((nb + 7) / 8, 0);
+    std::vector<int64_t> first_ids, second_ids;
+    for (int64_t i = 0; i < nb; i += 3) {
+        deleted_data[i >> 3] |= (0x1 << (i & 0x7));
+        (i < nb / 2 ? first_ids : second_ids).push_back(i);
+    }
+    const int64_t num_deleted = first_ids.size() + second_ids.size();
+    const knowhere::BitsetView deleted(deleted_data.data(), nb, num_deleted);
+    REQUIRE(idx.Delete(GenIdsDataSet(first_ids.size(), first_ids), delete_conf) == knowhere::Status::success);
+    REQUIRE(idx.Delete(GenIdsDataSet(second_ids.size(), second_ids), delete_conf) == knowhere::Status::success);
+    // deleting a row twice has no effect
+    REQUIRE(idx.Delete(GenIdsDataSet(first_ids.size(), first_ids), delete_conf) == knowhere::Status::success);
+    REQUIRE(idx.Count() == (compaction_ratio < 1.0f ? nb - num_deleted : nb));
+
+    SECTION("Search") {
+        auto results = idx.Search(query_ds, conf, nullptr);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(!deleted.test(ids[i]));
+        }
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, deleted);
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+    }
+
+    SECTION("Search With Bitset") {
+        // the filter is restrictive enough for a brute-force search, which has to skip the deleted rows as well
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb * 9 / 10);
+        knowhere::BitsetView bitset(bitset_data.data(), nb, nb * 9 / 10);
+        auto results = idx.Search(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            if (ids[i] >= 0) {
+                REQUIRE(!deleted.test(ids[i]));
+                REQUIRE(!bitset.test(ids[i]));
+            }
+        }
+    }
+
+    SECTION("Range Search") {
+        auto results = idx.RangeSearch(query_ds, conf, nullptr);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        auto lims = results.value()->GetLims();
+        for (size_t i = 0; i < lims[nq]; ++i) {
+            REQUIRE(!deleted.test(ids[i]));
+        }
+    }
+
+    SECTION("Invalid Ids") {
+        std::vector<int64_t> invalid_ids{nb};
+        REQUIRE(idx.Delete(GenIdsDataSet(invalid_ids.size(), invalid_ids), delete_conf) ==
+                knowhere::Status::invalid_args);
+    }
+}
+
+TEST_CASE("Merge of FAISS HNSW Indices", "[merge]") {
+    const int64_t dim = 32;
+    const int64_t nq = 50;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    // either graph may be the larger one, the rows of the merged index are renumbered the same way
+    auto [nb_first, nb_second] = GENERATE(table<int64_t, int64_t>({{2000, 1000}, {1000, 2000}}));
+    const int64_t nb = nb_first + nb_second;
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    const auto* data = reinterpret_cast<const float*>(train_ds->GetTensor());
+    auto first_ds = knowhere::GenDataSet(nb_first, dim, data);
+    auto second_ds = knowhere::GenDataSet(nb_second, dim, data + nb_first * dim);
+
+    const auto index_type = knowhere::IndexEnum::INDEX_HNSW;
+    auto full = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(full.Build(train_ds, conf) == knowhere::Status::success);
+    auto first = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(first.Build(first_ds, conf) == knowhere::Status::success);
+    auto second = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(second.Build(second_ds, conf) == knowhere::Status::success);
+
+    auto full_results = full.Search(query_ds, conf, nullptr);
+    REQUIRE(full_results.has_value());
+
+    SECTION("Merge") {
+        REQUIRE(first.Merge(second, nullptr, conf) == knowhere::Status::success);
+        REQUIRE(first.Count() == nb);
+
+        // the rows of the first index come first
+        std::vector<int64_t> ids{0, nb_first - 1, nb_first, nb - 1};
+        auto vectors = first.GetVectorByIds(GenIdsDataSet(ids.size(), ids));
+        REQUIRE(vectors.has_value());
+        const auto* tensor = reinterpret_cast<const float*>(vectors.value()->GetTensor());
+        if (!knowhere::IsMetricType(metric, knowhere::metric::COSINE)) {
+            for (size_t i = 0; i < ids.size(); ++i) {
+                for (int64_t j = 0; j < dim; ++j) {
+                    REQUIRE(tensor[i * dim + j] == data[ids[i] * dim + j]);
+                }
+            }
+        }
+
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+        auto results = first.Search(query_ds, conf, nullptr);
+        REQUIRE(results.has_value());
+        const float full_recall = GetKNNRecall(*gt.value(), *full_results.value());
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= full_recall - 0.05f);
+    }
+
+    SECTION("Merge With Bitset") {
+        // every fourth row of both indexes is dropped, the remaining ones are renumbered in order
+        std::vector<uint8_t> bitset_data((nb + 7) / 8, 0);
+        std::vector<int64_t> remaining;
+        int64_t num_dropped = 0;
+        for (int64_t i = 0; i < nb; ++i) {
+            if (i % 4 == 0) {
+                bitset_data[i >> 3] |= (0x1 << (i & 0x7));
+                ++num_dropped;
+            } else {
+                remaining.push_back(i);
+            }
+        }
+        const knowhere::BitsetView bitset(bitset_data.data(), nb, num_dropped);
+        REQUIRE(first.Merge(second, bitset, conf) == knowhere::Status::success);
+        REQUIRE(first.Count() == nb - num_dropped);
+
+        auto results = first.Search(query_ds, conf, nullptr);
+        REQUIRE(results.has_value());
+        auto result_ids = results.value()->GetIds();
+        std::vector<std::vector<int64_t>> mapped(nq);
+        for (int64_t i = 0; i < nq; ++i) {
+            for (int64_t j = 0; j < k; ++j) {
+                const auto id = result_ids[i * k + j];
+                REQUIRE(id >= 0);
+                REQUIRE(id < (int64_t)remaining.size());
+                mapped[i].push_back(remaining[id]);
+            }
+        }
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, bitset);
+        REQUIRE(GetKNNRecall(*gt.value(), mapped) >= 0.8f);
+    }
+
+    SECTION("Invalid Merges") {
+        knowhere::Json other_conf = conf;
+        other_conf[knowhere::meta::DIM] = dim / 2;
+        auto other_ds = GenDataSet(nb_second, dim / 2, (uint64_t)7);
+        auto other = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(other.Build(other_ds, other_conf) == knowhere::Status::success);
+        REQUIRE(first.Merge(other, nullptr, conf) != knowhere::Status::success);
+
+        auto flat = knowhere::IndexFactory::Instance()
+                        .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IDMAP, version)
+                        .value();
+        REQUIRE(flat.Build(second_ds, conf) == knowhere::Status::success);
+        REQUIRE(first.Merge(flat, nullptr, conf) != knowhere::Status::success);
+        REQUIRE(first.Count() == nb_first);
+    }
+}
+
+TEST_CASE("Sharded FAISS HNSW Indices", "[shards]") {
+    const int64_t nb = 4000;
+    const int64_t dim = 32;
+    const int64_t nq = 40;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto index_type =
+        GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_HNSW, knowhere::IndexEnum::INDEX_HNSW_SQ);
+    auto shard_type = GENERATE(as<std::string>{}, "random", "clustered");
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    // about 1% of the rows are within the radius
+    conf[knowhere::meta::RADIUS] = knowhere::IsMetricType(metric, knowhere::metric::L2)   ? 115000.0
+                                   : knowhere::IsMetricType(metric, knowhere::metric::IP) ? 45000.0
+                                                                                          : 0.4;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 64;
+    conf[knowhere::indexparam::SQ_TYPE] = "SQ8";
+    knowhere::Json shard_conf = conf;
+    shard_conf[knowhere::indexparam::HNSW_SHARDS] = 4;
+    shard_conf[knowhere::indexparam::HNSW_SHARD_TYPE] = shard_type;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, shard_conf) == knowhere::Status::success);
+    REQUIRE(idx.Count() == nb);
+
+    SECTION("Search") {
+        auto results = idx.Search(query_ds, conf, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+
+        // a single query searches the shards in parallel, with the same results
+        auto ids = results.value()->GetIds();
+        const auto* queries = reinterpret_cast<const float*>(query_ds->GetTensor());
+        for (int64_t q = 0; q < nq; q += 7) {
+            auto single_ds = knowhere::GenDataSet(1, dim, queries + q * dim);
+            auto single = idx.Search(single_ds, conf, nullptr);
+            REQUIRE(single.has_value());
+            for (int64_t i = 0; i < k; ++i) {
+                REQUIRE(single.value()->GetIds()[i] == ids[q * k + i]);
+            }
+        }
+    }
+
+    SECTION("Search With Bitset") {
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb, nb / 2);
+        auto filtered_gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, bitset);
+        auto results = idx.Search(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(!bitset.test(ids[i]));
+        }
+        REQUIRE(GetKNNRecall(*filtered_gt.value(), *results.value()) >= 0.85f);
+    }
+
+    SECTION("Range Search") {
+        auto range_gt = knowhere::BruteForce::RangeSearch<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+        REQUIRE(range_gt.has_value());
+        auto results = idx.RangeSearch(query_ds, conf, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetRangeSearchRecall(*range_gt.value(), *results.value()) >= 0.8f);
+    }
+
+    SECTION("Serialize and Deserialize") {
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, conf) == knowhere::Status::success);
+        auto results = idx.Search(query_ds, conf, nullptr);
+        auto loaded_results = loaded_idx.Search(query_ds, conf, nullptr);
+        REQUIRE(loaded_results.has_value());
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(results.value()->GetIds()[i] == loaded_results.value()->GetIds()[i]);
+        }
+    }
+}
+
+TEST_CASE("Refine Cascades of FAISS HNSW Indices", "[refine_cascade]") {
+    const int64_t nb = 2000;
+    const int64_t dim = 64;
+    const int64_t nq = 20;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto index_type =
+        GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_HNSW_SQ, knowhere::IndexEnum::INDEX_HNSW_PQ);
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 96;
+    conf[knowhere::indexparam::SQ_TYPE] = "SQ6";
+    conf[knowhere::indexparam::M] = 16;
+    conf[knowhere::indexparam::NBITS] = 4;
+    conf[knowhere::indexparam::HNSW_REFINE] = true;
+    conf[knowhere::indexparam::HNSW_REFINE_TYPE] = "FP32";
+    conf[knowhere::indexparam::HNSW_REFINE_CASCADE_TYPE] = "SQ8";
+    conf[knowhere::indexparam::HNSW_REFINE_K] = 8;
+    conf[knowhere::indexparam::HNSW_REFINE_CASCADE_K] = 2;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    // the last stage of the cascade holds the raw data
+    REQUIRE(knowhere::IndexStaticFaced<knowhere::fp32>::HasRawData(index_type, version, conf));
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+    REQUIRE(idx.Count() == nb);
+    REQUIRE(idx.HasRawData(metric));
+
+    // the fp32 refine of the sq8 survivors gives near-exact results
+    auto results = idx.Search(query_ds, conf, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+
+    SECTION("Get Vector By Ids") {
+        // the vectors come from the fp32 stage, with every candidate of the graph reranked by it
+        auto full_cascade_conf = conf;
+        full_cascade_conf[knowhere::indexparam::HNSW_REFINE_CASCADE_K] = 8;
+        auto full_results = idx.Search(query_ds, full_cascade_conf, nullptr);
+        REQUIRE(full_results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *full_results.value()) >= 0.9f);
+
+        std::vector<int64_t> ids_v{0, 1, nb / 2, nb - 1};
+        auto ids_ds = GenIdsDataSet(ids_v.size(), ids_v);
+        auto vectors = idx.GetVectorByIds(ids_ds);
+        REQUIRE(vectors.has_value());
+        auto data = reinterpret_cast<const float*>(vectors.value()->GetTensor());
+        auto train_data = reinterpret_cast<const float*>(train_ds->GetTensor());
+        for (size_t i = 0; i < ids_v.size(); ++i) {
+            for (int64_t j = 0; j < dim; ++j) {
+                REQUIRE(data[i * dim + j] == train_data[ids_v[i] * dim + j]);
+            }
+        }
+    }
+
+    SECTION("Serialize and Deserialize") {
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, conf) == knowhere::Status::success);
+        auto loaded_results = loaded_idx.Search(query_ds, conf, nullptr);
+        REQUIRE(loaded_results.has_value());
+        auto ids = results.value()->GetIds();
+        auto loaded_ids = loaded_results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == loaded_ids[i]);
+        }
+    }
+
+    SECTION("Invalid Cascades") {
+        auto bad_search_conf = conf;
+        bad_search_conf[knowhere::indexparam::HNSW_REFINE_CASCADE_K] = 16;
+        REQUIRE(!idx.Search(query_ds, bad_search_conf, nullptr).has_value());
+
+        auto bad_build_conf = conf;
+        bad_build_conf[knowhere::indexparam::HNSW_REFINE_CASCADE_TYPE] = "FLAT";
+        auto bad_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(bad_idx.Build(train_ds, bad_build_conf) != knowhere::Status::success);
+    }
+}
+
+TEST_CASE("Non-Uniform SQ of FAISS HNSW Indices", "[nusq]") {
+    const int64_t nb = 2000;
+    const int64_t dim = 64;
+    const int64_t nq = 20;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+    const auto index_type = knowhere::IndexEnum::INDEX_HNSW_SQ;
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto [sq_type, min_recall] = GENERATE(table<std::string, float>({{"NUSQ4", 0.5f}, {"NUSQ6", 0.7f}}));
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 96;
+    conf[knowhere::indexparam::SQ_TYPE] = sq_type;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    REQUIRE(!knowhere::IndexStaticFaced<knowhere::fp32>::HasRawData(index_type, version, conf));
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+    REQUIRE(idx.Count() == nb);
+
+    auto results = idx.Search(query_ds, conf, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= min_recall);
+
+    SECTION("Smaller Than SQ8") {
+        auto sq8_conf = conf;
+        sq8_conf[knowhere::indexparam::SQ_TYPE] = "SQ8";
+        auto sq8_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(sq8_idx.Build(train_ds, sq8_conf) == knowhere::Status::success);
+        REQUIRE(idx.Size() < sq8_idx.Size());
+    }
+
+    SECTION("Refine") {
+        auto refine_conf = conf;
+        refine_conf[knowhere::indexparam::HNSW_REFINE] = true;
+        refine_conf[knowhere::indexparam::HNSW_REFINE_TYPE] = "FP32";
+        refine_conf[knowhere::indexparam::HNSW_REFINE_K] = 4;
+        REQUIRE(knowhere::IndexStaticFaced<knowhere::fp32>::HasRawData(index_type, version, refine_conf));
+
+        auto refine_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(refine_idx.Build(train_ds, refine_conf) == knowhere::Status::success);
+        auto refine_results = refine_idx.Search(query_ds, refine_conf, nullptr);
+        REQUIRE(refine_results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *refine_results.value()) >= 0.9f);
+    }
+
+    SECTION("Serialize and Deserialize") {
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, conf) == knowhere::Status::success);
+        auto loaded_results = loaded_idx.Search(query_ds, conf, nullptr);
+        REQUIRE(loaded_results.has_value());
+        auto ids = results.value()->GetIds();
+        auto loaded_ids = loaded_results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == loaded_ids[i]);
+        }
+    }
+}
+
+TEST_CASE("Rotated PQ of FAISS HNSW Indices", "[pq_rotation]") {
+    const int64_t nb = 2000;
+    const int64_t dim = 64;
+    const int64_t nq = 20;
+    const int64_t k = 10;
+    auto version = GenTestVersionList();
+    const auto index_type = knowhere::IndexEnum::INDEX_HNSW_PQ;
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto rotation = GENERATE(as<std::string>{}, "random", "opq");
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = metric;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 96;
+    conf[knowhere::indexparam::M] = 16;
+    conf[knowhere::indexparam::NBITS] = 8;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+    REQUIRE(gt.has_value());
+
+    auto plain_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(plain_idx.Build(train_ds, conf) == knowhere::Status::success);
+    auto plain_results = plain_idx.Search(query_ds, conf, nullptr);
+    REQUIRE(plain_results.has_value());
+
+    conf[knowhere::indexparam::PQ_ROTATION] = rotation;
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+    REQUIRE(idx.Count() == nb);
+
+    auto results = idx.Search(query_ds, conf, nullptr);
+    REQUIRE(results.has_value());
+    // the random data has no correlated dimensions to align, the rotated codes are about as accurate
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= GetKNNRecall(*gt.value(), *plain_results.value()) - 0.1f);
+
+    SECTION("Invalid Rotation") {
+        auto invalid_conf = conf;
+        invalid_conf[knowhere::indexparam::PQ_ROTATION] = "hadamard";
+        auto invalid_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(invalid_idx.Build(train_ds, invalid_conf) != knowhere::Status::success);
+    }
+
+    SECTION("Refine") {
+        auto refine_conf = conf;
+        refine_conf[knowhere::indexparam::HNSW_REFINE] = true;
+        refine_conf[knowhere::indexparam::HNSW_REFINE_TYPE] = "FP32";
+        refine_conf[knowhere::indexparam::HNSW_REFINE_K] = 4;
+
+        auto refine_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(refine_idx.Build(train_ds, refine_conf) == knowhere::Status::success);
+        auto refine_results = refine_idx.Search(query_ds, refine_conf, nullptr);
+        REQUIRE(refine_results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *refine_results.value()) >= 0.9f);
+    }
+
+    SECTION("Serialize and Deserialize") {
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, conf) == knowhere::Status::success);
+        auto loaded_results = loaded_idx.Search(query_ds, conf, nullptr);
+        REQUIRE(loaded_results.has_value());
+        auto ids = results.value()->GetIds();
+        auto loaded_ids = loaded_results.value()->GetIds();
+        for (int64_t i = 0; i < nq * k; ++i) {
+            REQUIRE(ids[i] == loaded_ids[i]);
+        }
+    }
+}
+
+TEST_CASE("Filters Touching Several Materialized View Partitions", "[materialized_view]") {
+    const int64_t nb = 4000;
+    const int64_t dim = 32;
+    const int64_t nq = 20;
+    const int64_t k = 10;
+    const size_t partition_num = 4;
+    auto version = GenTestVersionList();
+    const auto index_type = knowhere::IndexEnum::INDEX_HNSW;
+
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    conf[knowhere::meta::DIM] = dim;
+    conf[knowhere::meta::TOPK] = k;
+    conf[knowhere::indexparam::HNSW_M] = 16;
+    conf[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    conf[knowhere::indexparam::EF] = 96;
+
+    auto train_ds = GenDataSet(nb, dim, (uint64_t)42);
+    auto query_ds = GenDataSet(nq, dim, (uint64_t)123);
+    auto scalar_info = GenerateScalarInfo(nb, partition_num);
+    train_ds->Set(knowhere::meta::SCALAR_INFO, scalar_info);
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+
+    // the categories 1 and 2 of the partition key pass the filter
+    std::vector<uint8_t> bitset_data((nb + 7) / 8, 0);
+    for (const size_t p : {size_t(0), size_t(3)}) {
+        for (const auto id : scalar_info[0][p]) {
+            bitset_data[id >> 3] |= (0x1 << (id & 0x7));
+        }
+    }
+    const size_t nbits_set = scalar_info[0][0].size() + scalar_info[0][3].size();
+    knowhere::BitsetView bitset(bitset_data.data(), nb, nbits_set);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, bitset);
+    REQUIRE(gt.has_value());
+
+    auto check_results = [&](const knowhere::DataSetPtr& results, const size_t num_partitions) {
+        std::unordered_set<int64_t> partitions;
+        for (int64_t i = 0; i < nq * k; ++i) {
+            const auto id = results->GetIds()[i];
+            REQUIRE(id >= 0);
+            REQUIRE(!bitset.test(id));
+            partitions.insert(id % partition_num);
+        }
+        REQUIRE(partitions.size() == num_partitions);
+    };
+
+    SECTION("Without Search Info") {
+        auto results = idx.Search(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+        check_results(results.value(), 2);
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+    }
+
+    SECTION("Several Touched Categories") {
+        conf[knowhere::meta::MATERIALIZED_VIEW_SEARCH_INFO] = knowhere::Json::parse(R"({
+            "field_id_to_touched_categories_cnt": [[0, 2]],
+            "is_pure_and": true,
+            "has_not": false
+        })");
+        auto results = idx.Search(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+        check_results(results.value(), 2);
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+    }
+
+    SECTION("Single Touched Category") {
+        // the expression is trusted to touch the partition of the first valid id only
+        conf[knowhere::meta::MATERIALIZED_VIEW_SEARCH_INFO] = knowhere::Json::parse(R"({
+            "field_id_to_touched_categories_cnt": [[0, 1]],
+            "is_pure_and": true,
+            "has_not": false
+        })");
+        auto results = idx.Search(query_ds, conf, bitset);
+        REQUIRE(results.has_value());
+        check_results(results.value(), 1);
+    }
+}
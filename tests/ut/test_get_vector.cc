@@ -168,6 +168,13 @@ TEST_CASE("Test Float Get Vector By Ids", "[Float GetVectorByIds]") {
         return json;
     };
 
+    // lossy refine data is kept for reordering only, can not get vector from index
+    auto scann_sq8_gen = [scann_gen]() {
+        knowhere::Json json = scann_gen();
+        json["refine_type"] = "SQ8";
+        return json;
+    };
+
     auto flat_gen = base_gen;
 
     auto ivfrabitq_gen = ivfflat_gen;
@@ -189,6 +196,7 @@ TEST_CASE("Test Float Get Vector By Ids", "[Float GetVectorByIds]") {
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, base_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen2),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_sq8_gen),
              make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_refine_flat_gen)}));
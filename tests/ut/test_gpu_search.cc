@@ -10,6 +10,7 @@
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
 #include <string>
+#include <vector>
 
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
@@ -115,6 +116,14 @@ TEST_CASE("Test All GPU Index", "[search]") {
         };
     };
 
+    auto co_search_gen = [](auto&& upstream_gen) {
+        return [upstream_gen]() {
+            knowhere::Json json = upstream_gen();
+            json[knowhere::indexparam::CO_SEARCH] = true;
+            return json;
+        };
+    };
+
     auto refined_gen = [](auto&& upstream_gen) {
         return [upstream_gen]() {
             knowhere::Json json = upstream_gen();
@@ -124,6 +133,15 @@ TEST_CASE("Test All GPU Index", "[search]") {
         };
     };
 
+    auto sharded_gen = [](auto&& upstream_gen, bool replicate) {
+        return [upstream_gen, replicate]() {
+            knowhere::Json json = upstream_gen();
+            json[knowhere::indexparam::NUM_SHARDS] = 2;
+            json[knowhere::indexparam::REPLICATE] = replicate;
+            return json;
+        };
+    };
+
     auto cosine_gen = [](auto&& upstream_gen) {
         return [upstream_gen]() {
             knowhere::Json json = upstream_gen();
@@ -150,6 +168,7 @@ TEST_CASE("Test All GPU Index", "[search]") {
             make_tuple(knowhere::IndexEnum::INDEX_GPU_IVFPQ, refined_gen(ivfpq_gen), 0.75f),
             make_tuple(knowhere::IndexEnum::INDEX_GPU_CAGRA, cagra_gen, 0.9f),
             make_tuple(knowhere::IndexEnum::INDEX_GPU_CAGRA, cagra_hnsw_gen(cagra_gen), 0.9f),
+            make_tuple(knowhere::IndexEnum::INDEX_GPU_CAGRA, co_search_gen(cagra_gen), 0.9f),
         }));
 
         auto cfg_json = gen().dump();
@@ -253,6 +272,7 @@ TEST_CASE("Test All GPU Index", "[search]") {
             make_tuple(knowhere::IndexEnum::INDEX_CUVS_IVFPQ, refined_gen(ivfpq_gen)),
             make_tuple(knowhere::IndexEnum::INDEX_CUVS_CAGRA, cagra_gen),
             make_tuple(knowhere::IndexEnum::INDEX_CUVS_CAGRA, cagra_hnsw_gen(cagra_gen)),
+            make_tuple(knowhere::IndexEnum::INDEX_CUVS_CAGRA, co_search_gen(cagra_gen)),
         }));
 
         auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
@@ -279,6 +299,48 @@ TEST_CASE("Test All GPU Index", "[search]") {
         }
     }
 
+    SECTION("Test Gpu Index Multi-GPU Search") {
+        // with a single device, the index is neither split nor replicated
+        using std::make_tuple;
+        auto [name, gen, min_recall] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>, float>({
+            make_tuple(knowhere::IndexEnum::INDEX_CUVS_BRUTEFORCE, sharded_gen(bruteforce_gen, false), 0.999f),
+            make_tuple(knowhere::IndexEnum::INDEX_CUVS_BRUTEFORCE, sharded_gen(bruteforce_gen, true), 0.999f),
+            make_tuple(knowhere::IndexEnum::INDEX_CUVS_IVFFLAT, sharded_gen(ivfflat_gen, false), 0.95f),
+            make_tuple(knowhere::IndexEnum::INDEX_CUVS_CAGRA, sharded_gen(cagra_gen, false), 0.9f),
+            make_tuple(knowhere::IndexEnum::INDEX_CUVS_CAGRA, sharded_gen(cagra_gen, true), 0.9f),
+        }));
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        check_search<knowhere::fp32>(nb, nq, dim, seed, name, version, json, min_recall);
+
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto train_ds = GenDataSet(nb, dim, seed);
+        auto query_ds = GenDataSet(nq, dim, seed + 2);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+        REQUIRE(idx.Count() == nb);
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto idx_ = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx_.Deserialize(bs, json) == knowhere::Status::success);
+        REQUIRE(idx_.Count() == nb);
+
+        // the bitset is split between the shards as well
+        std::vector<uint8_t> bitset_data(nb / 8);
+        for (int64_t i = 0; i < nb; i += 2) {
+            bitset_data[i / 8] |= 1 << (i % 8);
+        }
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto results = idx_.Search(query_ds, json, bitset);
+        REQUIRE(results.has_value());
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, bitset);
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= min_recall);
+        auto ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq; ++i) {
+            REQUIRE((ids[i] < 0 || !bitset.test(ids[i])));
+        }
+    }
+
     SECTION("Test Gpu Index Cagra Adapt For Cpu") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
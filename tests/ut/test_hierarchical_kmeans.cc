@@ -0,0 +1,85 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <algorithm>
+
+#include "catch2/catch_test_macros.hpp"
+#include "knowhere/cluster/cluster_factory.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/dataset.h"
+#include "knowhere/log.h"
+#include "utils.h"
+
+namespace {
+constexpr float kAssignAgreementThreshold = 0.7f;
+}  // namespace
+
+TEST_CASE("Test Hierarchical Balanced Kmeans", "[float metrics]") {
+    const int64_t nb = 4000, nq = 10;
+    const int64_t dim = 32;
+    const int64_t num_clusters = 16;
+    const float max_balance = 1.2f;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim);
+
+    knowhere::Json json;
+    json["num_clusters"] = num_clusters;
+    json["max_balance"] = max_balance;
+
+    auto cluster = knowhere::ClusterFactory::Instance()
+                       .Create<knowhere::fp32>(knowhere::ClusterEnum::CLUSTER_HIERARCHICAL_KMEANS)
+                       .value();
+    REQUIRE(cluster.Type() == knowhere::ClusterEnum::CLUSTER_HIERARCHICAL_KMEANS);
+
+    SECTION("Test balanced clusters") {
+        auto res = cluster.Train(*train_ds, json);
+        REQUIRE(res.has_value());
+
+        std::vector<std::vector<int64_t>> ids(num_clusters);
+        for (int64_t i = 0; i < nb; ++i) {
+            auto centroid_id = reinterpret_cast<const uint32_t*>(res.value()->GetTensor())[i];
+            REQUIRE(centroid_id < num_clusters);
+            ids[centroid_id].push_back(i);
+        }
+        // the bound holds per coarse cluster, whose share of the clusters is rounded
+        size_t max_size = 0;
+        for (const auto& cluster_ids : ids) {
+            max_size = std::max(max_size, cluster_ids.size());
+        }
+        REQUIRE(max_size <= 2 * max_balance * nb / num_clusters);
+
+        auto centroids = cluster.GetCentroids();
+        REQUIRE(centroids.has_value());
+        REQUIRE(centroids.value()->GetRows() == num_clusters);
+        REQUIRE(centroids.value()->GetDim() == dim);
+
+        // the balanced clusters are close to the cells of their centroids
+        auto assign_res = cluster.Assign(*train_ds);
+        REQUIRE(assign_res.has_value());
+        int64_t same = 0;
+        for (int64_t i = 0; i < nb; ++i) {
+            same += reinterpret_cast<const uint32_t*>(assign_res.value()->GetTensor())[i] ==
+                    reinterpret_cast<const uint32_t*>(res.value()->GetTensor())[i];
+        }
+        LOG_KNOWHERE_INFO_ << "assignment agreement: " << (float)same / nb;
+        REQUIRE(same > kAssignAgreementThreshold * nb);
+    }
+
+    SECTION("Test invalid params") {
+        REQUIRE(!cluster.Assign(*query_ds).has_value());
+        json["max_balance"] = 0.5f;
+        REQUIRE(!cluster.Train(*train_ds, json).has_value());
+        json["max_balance"] = max_balance;
+        json["num_clusters"] = nb + 1;
+        REQUIRE(!cluster.Train(*train_ds, json).has_value());
+    }
+}
@@ -0,0 +1,139 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <atomic>
+#include <future>
+
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators.hpp"
+#include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/index/index_factory.h"
+#include "utils.h"
+
+namespace {
+constexpr float kKnnRecallThreshold = 0.6f;
+}  // namespace
+
+TEST_CASE("Test HNSW_CC Growing Index", "[HNSW_CC]") {
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto version = GenTestVersionList();
+
+    const int64_t nb = 2000, nq = 20, dim = 32, topk = 10;
+    const int64_t buffer_rows = 128;
+    const int64_t batch = 250;
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 100;
+    json[knowhere::indexparam::EF] = 64;
+    json[knowhere::indexparam::BUFFER_ROWS] = buffer_rows;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 7);
+    const auto* xb = static_cast<const float*>(train_ds->GetTensor());
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_HNSW_CC, version);
+    REQUIRE(idx.has_value());
+    auto index = idx.value();
+    REQUIRE(index.Build(knowhere::GenDataSet(batch, dim, xb), json) == knowhere::Status::success);
+
+    SECTION("Test Search While Adding") {
+        // the rows added so far are all found, whether in a buffer or in a graph, while the buffers get sealed
+        for (int64_t rows = batch; rows < nb; rows += batch) {
+            REQUIRE(index.Add(knowhere::GenDataSet(batch, dim, xb + rows * dim), json) == knowhere::Status::success);
+            REQUIRE(index.Count() == rows + batch);
+
+            auto added_ds = knowhere::GenDataSet(rows + batch, dim, xb);
+            auto gt = knowhere::BruteForce::Search<knowhere::fp32>(added_ds, query_ds, json, nullptr);
+            auto results = index.Search(query_ds, json, nullptr);
+            REQUIRE(results.has_value());
+            REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+        }
+    }
+
+    SECTION("Test Search With Bitset") {
+        REQUIRE(index.Add(knowhere::GenDataSet(nb - batch, dim, xb + batch * dim), json) ==
+                knowhere::Status::success);
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, bitset);
+        auto results = index.Search(query_ds, json, bitset);
+        REQUIRE(results.has_value());
+        const auto* ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq * topk; i++) {
+            REQUIRE((ids[i] < 0 || !bitset.test(ids[i])));
+        }
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+    }
+
+    SECTION("Test Concurrent Add And Search") {
+        std::atomic<bool> done = false;
+        auto searcher = std::async(std::launch::async, [&] {
+            size_t n_errors = 0;
+            while (!done.load()) {
+                auto count = index.Count();
+                auto results = index.Search(query_ds, json, nullptr);
+                if (!results.has_value()) {
+                    n_errors++;
+                    continue;
+                }
+                const auto* ids = results.value()->GetIds();
+                for (int64_t i = 0; i < nq * topk; i++) {
+                    // the rows of a search are at least those counted before it
+                    n_errors += ids[i] >= nb || (ids[i] < 0 && count >= topk);
+                }
+            }
+            return n_errors;
+        });
+        for (int64_t rows = batch; rows < nb; rows += batch) {
+            REQUIRE(index.Add(knowhere::GenDataSet(batch, dim, xb + rows * dim), json) == knowhere::Status::success);
+        }
+        done = true;
+        REQUIRE(searcher.get() == 0);
+    }
+
+    SECTION("Test Range Search") {
+        REQUIRE(index.Add(knowhere::GenDataSet(nb - batch, dim, xb + batch * dim), json) ==
+                knowhere::Status::success);
+        // a radius around the distance of the topk-th neighbor, for a few results per query
+        auto knn_gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, nullptr);
+        auto range_json = json;
+        range_json[knowhere::meta::RADIUS] = knn_gt.value()->GetDistance()[topk - 1];
+        auto gt = knowhere::BruteForce::RangeSearch<knowhere::fp32>(train_ds, query_ds, range_json, nullptr);
+        auto results = index.RangeSearch(query_ds, range_json, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetRangeSearchRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+    }
+
+    SECTION("Test GetVectorByIds") {
+        REQUIRE(index.Add(knowhere::GenDataSet(nb - batch, dim, xb + batch * dim), json) ==
+                knowhere::Status::success);
+        std::vector<int64_t> ids = {0, buffer_rows - 1, buffer_rows, nb / 2, nb - 1};
+        auto results = index.GetVectorByIds(knowhere::GenIdsDataSet(ids.size(), ids.data()));
+        REQUIRE(results.has_value());
+        const auto* x = static_cast<const float*>(results.value()->GetTensor());
+        for (size_t i = 0; i < ids.size(); i++) {
+            for (int64_t d = 0; d < dim; d++) {
+                REQUIRE(x[i * dim + d] == xb[ids[i] * dim + d]);
+            }
+        }
+    }
+
+    SECTION("Test Serialize") {
+        knowhere::BinarySet binset;
+        REQUIRE(index.Serialize(binset) == knowhere::Status::not_implemented);
+    }
+}
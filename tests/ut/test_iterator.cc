@@ -211,6 +211,14 @@ TEST_CASE("Test Iterator Mem Index With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto ivfpqfastscan_refine_flat_gen = [ivf_base_gen] {
+        knowhere::Json json = ivf_base_gen();
+        json[knowhere::indexparam::M] = dim / 2;
+        json["refine"] = true;
+        json["refine_type"] = "FLAT";
+        return json;
+    };
+
     auto rand = GENERATE(1, 2);
 
     const auto train_ds = GenDataSet(nb, dim, rand);
@@ -236,7 +244,8 @@ TEST_CASE("Test Iterator Mem Index With Float Vector", "[float metrics]") {
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen2),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_gen),
-             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_refine_flat_gen)}));
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_refine_flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfastscan_refine_flat_gen)}));
         auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
         auto cfg_json = gen().dump();
         CAPTURE(name, cfg_json);
@@ -262,6 +271,84 @@ TEST_CASE("Test Iterator Mem Index With Float Vector", "[float metrics]") {
         REQUIRE(recall > kKnnRecallThreshold);
     }
 
+    SECTION("Test NextBatch of iterators") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>(
+            {make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivf_base_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ, hnsw_sq_refine_flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen)}));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto its = idx.AnnIterator(query_ds, json, nullptr);
+        REQUIRE(its.has_value());
+        auto batch_its = idx.AnnIterator(query_ds, json, nullptr);
+        REQUIRE(batch_its.has_value());
+
+        // the batches return the same results as the calls to Next(), whatever their size
+        const size_t n_results = 3 * topk;
+        for (int i = 0; i < nq; ++i) {
+            auto& iter = its.value()[i];
+            auto& batch_iter = batch_its.value()[i];
+
+            std::vector<int64_t> ids(n_results);
+            std::vector<float> dists(n_results);
+            size_t n_read = 0;
+            for (size_t batch_size = 1; n_read < n_results; batch_size *= 2) {
+                const size_t n = std::min(batch_size, n_results - n_read);
+                const size_t n_batch = batch_iter->NextBatch(n, ids.data() + n_read, dists.data() + n_read);
+                n_read += n_batch;
+                if (n_batch < n) {
+                    REQUIRE(!batch_iter->HasNext());
+                    break;
+                }
+            }
+
+            for (size_t j = 0; j < n_read; ++j) {
+                REQUIRE(iter->HasNext());
+                auto [id, dist] = iter->Next();
+                REQUIRE(id == ids[j]);
+                REQUIRE(dist == dists[j]);
+            }
+        }
+    }
+
+    SECTION("Test batch initialization of iterators") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>(
+            {make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivf_base_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ, hnsw_sq_refine_flat_gen)}));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto its = idx.AnnIterator(query_ds, json, nullptr);
+        REQUIRE(its.has_value());
+        json[knowhere::meta::ITERATOR_BATCH_INIT] = true;
+        auto init_its = idx.AnnIterator(query_ds, json, nullptr);
+        REQUIRE(init_its.has_value());
+
+        // the iterators initialized at their creation return the same results as the lazy ones
+        for (int i = 0; i < nq; ++i) {
+            auto& iter = its.value()[i];
+            auto& init_iter = init_its.value()[i];
+            for (int j = 0; j < topk; ++j) {
+                REQUIRE(iter->HasNext() == init_iter->HasNext());
+                if (!iter->HasNext()) {
+                    break;
+                }
+                REQUIRE(iter->Next() == init_iter->Next());
+            }
+        }
+    }
+
 #ifdef KNOWHERE_WITH_CARDINAL
     // currently, only cardinal support iterator_retain_order
     SECTION("Test Search with ordered Iterator") {
@@ -590,6 +677,35 @@ TEST_CASE("Test Iterator BruteForce With Float Vector", "[float metrics]") {
     }
 }
 
+TEST_CASE("Test Iterator BruteForce With Large Float Vector", "[float metrics]") {
+    // large enough for the iterators to keep a bounded buffer of results and compute the distances block by block
+    const int64_t nb = 70000, nq = 2;
+    const int64_t dim = 4;
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 777);
+
+    const knowhere::Json conf = {
+        {knowhere::meta::METRIC_TYPE, metric}, {knowhere::meta::TOPK, nb},  // to return all vectors
+    };
+
+    SECTION("Test Iterator BruteForce") {
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+        auto iterators = knowhere::BruteForce::AnnIterator<knowhere::fp32>(train_ds, query_ds, conf, nullptr).value();
+        AssertBruteForceIteratorResultCorrect(nb, iterators, gt.value());
+    }
+
+    SECTION("Test Iterator BruteForce with filtering") {
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, 0.4f * nb);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto iterators = knowhere::BruteForce::AnnIterator<knowhere::fp32>(train_ds, query_ds, conf, bitset).value();
+        auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, bitset);
+        AssertBruteForceIteratorResultCorrect(nb, iterators, gt.value());
+    }
+}
+
 TEST_CASE("Test Iterator BruteForce With Sparse Float Vector", "[IP metric]") {
     using Catch::Approx;
 
@@ -9,6 +9,8 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <future>
 
@@ -145,6 +147,71 @@ TEST_CASE("Test Build Search Concurrency", "[Concurrency]") {
         }
     }
 
+    SECTION("Test Concurrent Invlists Append & Read") {
+        size_t nlist = 16;
+        size_t code_size = 16;
+        size_t segment_size = 7;
+        size_t per_list = 2000;
+        size_t n_writers = 4;
+        size_t n_readers = 4;
+
+        faiss::ConcurrentArrayInvertedLists invList(nlist, code_size, segment_size, false);
+
+        // entry j of list i has the id i * per_list + j, and a code filled with its low byte
+        std::vector<std::future<size_t>> writers;
+        for (size_t w = 0; w < n_writers; w++) {
+            writers.push_back(std::async(std::launch::async, [&, w] {
+                size_t n_errors = 0;
+                for (size_t i = w; i < nlist; i += n_writers) {
+                    for (size_t j = 0; j < per_list;) {
+                        size_t n = std::min<size_t>(j % 13 + 1, per_list - j);
+                        std::vector<faiss::idx_t> ids(n);
+                        std::vector<uint8_t> codes(n * code_size);
+                        for (size_t k = 0; k < n; k++) {
+                            ids[k] = i * per_list + j + k;
+                            std::fill_n(codes.data() + k * code_size, code_size, uint8_t(ids[k]));
+                        }
+                        n_errors += invList.add_entries(i, n, ids.data(), codes.data()) != j;
+                        j += n;
+                    }
+                }
+                return n_errors;
+            }));
+        }
+        std::atomic<bool> done = false;
+        std::vector<std::future<size_t>> readers;
+        for (size_t r = 0; r < n_readers; r++) {
+            readers.push_back(std::async(std::launch::async, [&] {
+                size_t n_errors = 0;
+                while (!done.load()) {
+                    for (size_t i = 0; i < nlist; i++) {
+                        size_t size = invList.list_size(i);
+                        for (size_t j = 0; j < size; j++) {
+                            auto id = invList.get_single_id(i, j);
+                            auto code = invList.get_single_code(i, j);
+                            n_errors += id != faiss::idx_t(i * per_list + j) || code[0] != uint8_t(id) ||
+                                        code[code_size - 1] != uint8_t(id);
+                        }
+                    }
+                }
+                return n_errors;
+            }));
+        }
+        size_t n_write_errors = 0;
+        for (auto& writer : writers) {
+            n_write_errors += writer.get();
+        }
+        done.store(true);
+        REQUIRE(n_write_errors == 0);
+        for (auto& reader : readers) {
+            REQUIRE(reader.get() == 0);
+        }
+        for (size_t i = 0; i < nlist; i++) {
+            REQUIRE(invList.list_size(i) == per_list);
+            REQUIRE(invList.get_segment_num(i) == (per_list + segment_size - 1) / segment_size);
+        }
+    }
+
     SECTION("Test Add & Search & RangeSearch Serialized ") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
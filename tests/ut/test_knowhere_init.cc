@@ -33,6 +33,16 @@ TEST_CASE("Knowhere global config", "[init]") {
     knowhere::KnowhereConfig::SetClusteringType(knowhere::KnowhereConfig::ClusteringType::K_MEANS_PLUS_PLUS);
     knowhere::KnowhereConfig::SetClusteringType(knowhere::KnowhereConfig::ClusteringType::K_MEANS);
 
+    knowhere::KnowhereConfig::SetClusteringMiniBatchSize(4096);
+    REQUIRE(knowhere::KnowhereConfig::GetClusteringMiniBatchSize() == 4096);
+    knowhere::KnowhereConfig::SetClusteringMiniBatchSize(0);
+    REQUIRE(knowhere::KnowhereConfig::GetClusteringMiniBatchSize() == 0);
+
+    knowhere::KnowhereConfig::SetClusteringTimeBudget(60.0);
+    REQUIRE(knowhere::KnowhereConfig::GetClusteringTimeBudget() == 60.0);
+    knowhere::KnowhereConfig::SetClusteringTimeBudget(0.0);
+    REQUIRE(knowhere::KnowhereConfig::GetClusteringTimeBudget() == 0.0);
+
     size_t prev_build_thread_num = knowhere::KnowhereConfig::GetBuildThreadPoolSize();
     knowhere::KnowhereConfig::SetBuildThreadPoolSize(8);
     REQUIRE(knowhere::KnowhereConfig::GetBuildThreadPoolSize() == 8);
@@ -50,6 +60,10 @@ TEST_CASE("Knowhere global config", "[init]") {
 #ifdef KNOWHERE_WITH_DISKANN
     REQUIRE_FALSE(knowhere::KnowhereConfig::SetAioContextPool(0));
     REQUIRE(knowhere::KnowhereConfig::SetAioContextPool(16));
+    knowhere::KnowhereConfig::SetDiskIOQuota(4);
+    REQUIRE(knowhere::KnowhereConfig::GetDiskIOQuota() == 4);
+    knowhere::KnowhereConfig::SetDiskIOQuota(0);
+    REQUIRE(knowhere::KnowhereConfig::GetDiskIOQuota() == 0);
 #endif
 
 #ifdef KNOWHERE_WITH_CUVS
@@ -9,6 +9,7 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <algorithm>
 #include <string>
 
 #include "catch2/catch_approx.hpp"
@@ -56,6 +57,8 @@ TEST_CASE("Test MinHashLSHIndexNode with MinHashLSH hit", "[minhash_lsh_index]")
     auto use_mmap = GENERATE(as<bool>{}, true, false);
     auto batch_search_flag = GENERATE(as<bool>{}, true, false);
     auto mh_search_with_jaccard = GENERATE(as<bool>{}, true, false);
+    auto band_layout = GENERATE(as<std::string>{}, "sorted", "learned");
+    auto bloom_filter_type = GENERATE(as<std::string>{}, "classic", "split_block");
     size_t bin_vec_dim = kHashDim * hash_bit;
     auto base_gen = [&metric_str, &hash_bit, &mh_search_with_jaccard, &dim = bin_vec_dim]() {
         knowhere::Json json;
@@ -69,20 +72,22 @@ TEST_CASE("Test MinHashLSHIndexNode with MinHashLSH hit", "[minhash_lsh_index]")
         return json;
     };
 
-    auto build_gen = [&base_gen, &metric_str]() {
+    auto build_gen = [&base_gen, &metric_str, &band_layout]() {
         knowhere::Json json = base_gen();
         json["index_prefix"] = kIndexDir;
         json["data_path"] = kRawDataPath;
         json["mh_lsh_aligned_block_size"] = 4096;
+        json["mh_lsh_band_layout"] = band_layout;
         json["mh_lsh_shared_bloom_filter"] = true;
         json["mh_lsh_bloom_false_positive_prob"] = 0.01;
         json["with_raw_data"] = true;
         return json;
     };
 
-    auto deserialize_gen = [&base_gen, &metric_str, &use_mmap, &batch_search_flag]() {
+    auto deserialize_gen = [&base_gen, &metric_str, &use_mmap, &batch_search_flag, &bloom_filter_type]() {
         knowhere::Json json = base_gen();
         json["index_prefix"] = kIndexDir;
+        json["mh_lsh_bloom_filter_type"] = bloom_filter_type;
         json["mh_lsh_batch_search"] = batch_search_flag;
         json["hash_code_in_memory"] = !use_mmap;
         return json;
@@ -144,6 +149,61 @@ TEST_CASE("Test MinHashLSHIndexNode with MinHashLSH hit", "[minhash_lsh_index]")
                 REQUIRE(lsh_recall == 1.0);
             }
         }
+        SECTION("Test add rows") {
+            auto minhash_index = knowhere::IndexFactory::Instance()
+                                     .Create<knowhere::bin1>("MINHASH_LSH", version, minhash_index_index_pack)
+                                     .value();
+            REQUIRE(minhash_index.Deserialize(binset, deserialize_json) == knowhere::Status::success);
+            // enough adds for the runs of the bands to be merged
+            constexpr int64_t kAddRows = 100, kAdds = 10;
+            auto add_ds = GenBinDataSet(kAddRows * kAdds, bin_vec_dim, 33);
+            auto add_data = static_cast<const uint8_t*>(add_ds->GetTensor());
+            for (int64_t i = 0; i < kAdds; i++) {
+                auto ds = knowhere::GenDataSet(kAddRows, bin_vec_dim, add_data + i * kAddRows * bin_vec_dim / 8);
+                REQUIRE(minhash_index.Add(ds, json) == knowhere::Status::success);
+            }
+            REQUIRE(minhash_index.Count() == kNumRows + kAddRows * kAdds);
+
+            // the added rows are found by themselves
+            auto add_query_ds = knowhere::GenDataSet(kNumQueries, bin_vec_dim, add_data + kAddRows * bin_vec_dim / 8);
+            knowhere::Json knn_json = knowhere::Json::parse(knn_search_gen().dump());
+            auto res = minhash_index.Search(add_query_ds, knn_json, nullptr);
+            REQUIRE(res.has_value());
+            for (int64_t i = 0; i < kNumQueries; i++) {
+                auto ids = res.value()->GetIds() + i * kK;
+                REQUIRE(std::find(ids, ids + kK, kNumRows + kAddRows + i) != ids + kK);
+            }
+        }
+    }
+    SECTION("Test search with b-bit refine") {
+        std::shared_ptr<milvus::FileManager> file_manager = std::make_shared<milvus::LocalFileManager>();
+        auto minhash_index_index_pack = knowhere::Pack(file_manager);
+        auto refine_bits = GENERATE(as<int32_t>{}, 1, 2, 4, 8);
+        knowhere::Json json = build_gen();
+        json["with_raw_data"] = false;
+        json["mh_lsh_refine_bits"] = refine_bits;
+        knowhere::BinarySet binset;
+        {
+            auto minhash_index = knowhere::IndexFactory::Instance()
+                                     .Create<knowhere::bin1>("MINHASH_LSH", version, minhash_index_index_pack)
+                                     .value();
+            knowhere::DataSetPtr ds_ptr = nullptr;
+            REQUIRE(minhash_index.Build(ds_ptr, json) == knowhere::Status::success);
+            minhash_index.Serialize(binset);
+        }
+        auto minhash_index = knowhere::IndexFactory::Instance()
+                                 .Create<knowhere::bin1>("MINHASH_LSH", version, minhash_index_index_pack)
+                                 .value();
+        REQUIRE(minhash_index.Deserialize(binset, deserialize_gen()) == knowhere::Status::success);
+        knowhere::Json knn_json = knn_search_gen();
+        knn_json["mh_search_with_jaccard"] = true;
+        auto res = minhash_index.Search(query_ds, knn_json, nullptr);
+        REQUIRE(res.has_value());
+        // the queries are the first rows, that match themselves on all the bits
+        for (int64_t i = 0; i < kNumQueries; i++) {
+            REQUIRE(res.value()->GetIds()[i * kK] == i);
+            REQUIRE(res.value()->GetDistance()[i * kK] == 1.0f);
+        }
     }
     fs::remove_all(kDir);
     fs::remove(kDir);
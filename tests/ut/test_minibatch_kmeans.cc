@@ -0,0 +1,143 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "catch2/catch_test_macros.hpp"
+#include "knowhere/cluster/cluster_factory.h"
+#include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/dataset.h"
+#include "knowhere/log.h"
+#include "knowhere/utils.h"
+#include "utils.h"
+
+namespace {
+constexpr float kKnnRecallThreshold = 0.8f;
+}  // namespace
+
+TEST_CASE("Test Mini-batch Kmeans With Streamed Chunks", "[float metrics]") {
+    const int64_t nb = 4000, nq = 10;
+    const int64_t dim = 64;
+    const int64_t num_clusters = 8;
+    const int64_t num_chunks = 4;
+    const int64_t chunk_rows = nb / num_chunks;
+    auto topk = 1;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim);
+    const auto train_data = static_cast<const float*>(train_ds->GetTensor());
+
+    const knowhere::Json conf = {
+        {knowhere::meta::METRIC_TYPE, knowhere::metric::L2},
+        {knowhere::meta::TOPK, topk},
+    };
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, conf, nullptr);
+
+    knowhere::Json json;
+    json["num_clusters"] = num_clusters;
+    json["batch_size"] = 256;
+    json["max_iter"] = 2;
+
+    auto cluster =
+        knowhere::ClusterFactory::Instance().Create<knowhere::fp32>(knowhere::ClusterEnum::CLUSTER_MINIBATCH_KMEANS);
+    REQUIRE(cluster.has_value());
+    REQUIRE(cluster.value().Type() == knowhere::ClusterEnum::CLUSTER_MINIBATCH_KMEANS);
+
+    SECTION("Test streamed train") {
+        auto& kmeans = cluster.value();
+        for (int64_t c = 0; c < num_chunks; ++c) {
+            auto chunk = knowhere::GenDataSet(chunk_rows, dim, train_data + c * chunk_rows * dim);
+            auto res = kmeans.Train(*chunk, json);
+            REQUIRE(res.has_value());
+            REQUIRE(res.value()->GetRows() == chunk_rows);
+        }
+        auto centroids = kmeans.GetCentroids();
+        REQUIRE(centroids.has_value());
+        REQUIRE(centroids.value()->GetRows() == num_clusters);
+        REQUIRE(centroids.value()->GetDim() == dim);
+
+        auto train_assign = kmeans.Assign(*train_ds);
+        REQUIRE(train_assign.has_value());
+        std::vector<std::vector<int64_t>> ids(num_clusters);
+        for (int64_t i = 0; i < nb; ++i) {
+            auto centroid_id = reinterpret_cast<const uint32_t*>(train_assign.value()->GetTensor())[i];
+            REQUIRE(centroid_id < num_clusters);
+            ids[centroid_id].push_back(i);
+        }
+
+        // each query selects its nearest cluster as the result, like ivfflat with nprobe=1
+        auto assign_res = kmeans.Assign(*query_ds);
+        REQUIRE(assign_res.has_value());
+        std::vector<std::vector<int64_t>> result(nq);
+        for (int64_t i = 0; i < nq; ++i) {
+            auto centroid_id = reinterpret_cast<const uint32_t*>(assign_res.value()->GetTensor())[i];
+            result[i] = ids[centroid_id];
+        }
+        float recall = GetKNNRecall(*gt.value(), result);
+        LOG_KNOWHERE_INFO_ << "recall: " << recall;
+        REQUIRE(recall > kKnnRecallThreshold);
+    }
+
+    SECTION("Test warm start from centroids") {
+        auto& kmeans = cluster.value();
+        auto init = knowhere::GenDataSet(num_clusters, dim, train_data);
+        REQUIRE(kmeans.SetCentroids(*init) == knowhere::Status::success);
+        auto res = kmeans.Train(*knowhere::GenDataSet(chunk_rows, dim, train_data), json);
+        REQUIRE(res.has_value());
+
+        // a chunk of another dim does not fit the centroids
+        auto bad_chunk = knowhere::GenDataSet(chunk_rows / 2, dim * 2, train_data);
+        REQUIRE(!kmeans.Train(*bad_chunk, json).has_value());
+
+        // without warm start, the centroids are initialized again from the chunk
+        json["warm_start"] = false;
+        REQUIRE(kmeans.Train(*bad_chunk, json).has_value());
+        REQUIRE(kmeans.GetCentroids().value()->GetDim() == dim * 2);
+    }
+
+    SECTION("Test top-m assign") {
+        auto& kmeans = cluster.value();
+        REQUIRE(kmeans.Train(*train_ds, json).has_value());
+        const int64_t m = 3;
+        auto top_m = kmeans.AssignTopM(*query_ds, m);
+        REQUIRE(top_m.has_value());
+        auto nearest = kmeans.Assign(*query_ds);
+        REQUIRE(nearest.has_value());
+        auto ids = top_m.value()->GetIds();
+        auto distances = top_m.value()->GetDistance();
+        for (int64_t i = 0; i < nq; ++i) {
+            REQUIRE(ids[i * m] == reinterpret_cast<const uint32_t*>(nearest.value()->GetTensor())[i]);
+            for (int64_t j = 1; j < m; ++j) {
+                REQUIRE(ids[i * m + j] >= 0);
+                REQUIRE(distances[i * m + j - 1] <= distances[i * m + j]);
+            }
+        }
+
+        // the fp16 tiles are converted to fp32
+        auto fp16_cluster = knowhere::ClusterFactory::Instance()
+                                .Create<knowhere::fp16>(knowhere::ClusterEnum::CLUSTER_MINIBATCH_KMEANS)
+                                .value();
+        REQUIRE(fp16_cluster.Train(*knowhere::ConvertToDataTypeIfNeeded<knowhere::fp16>(train_ds), json).has_value());
+        auto fp16_top_m = fp16_cluster.AssignTopM(*knowhere::ConvertToDataTypeIfNeeded<knowhere::fp16>(query_ds), m);
+        REQUIRE(fp16_top_m.has_value());
+        REQUIRE(fp16_top_m.value()->GetDim() == m);
+
+        REQUIRE(!kmeans.AssignTopM(*query_ds, num_clusters + 1).has_value());
+    }
+
+    SECTION("Test invalid params") {
+        auto& kmeans = cluster.value();
+        REQUIRE(!kmeans.Assign(*query_ds).has_value());
+        knowhere::Json no_clusters;
+        REQUIRE(!kmeans.Train(*train_ds, no_clusters).has_value());
+        // the first chunk must hold a row per cluster
+        REQUIRE(!kmeans.Train(*knowhere::GenDataSet(num_clusters - 1, dim, train_data), json).has_value());
+    }
+}
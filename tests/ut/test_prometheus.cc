@@ -9,10 +9,14 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <functional>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "catch2/catch_test_macros.hpp"
+#include "knowhere/comp/memory_report.h"
+#include "knowhere/comp/task.h"
 #include "knowhere/prometheus_client.h"
 
 TEST_CASE("Test prometheus client", "[prometheus client]") {
@@ -21,4 +25,45 @@ TEST_CASE("Test prometheus client", "[prometheus client]") {
         std::cout << str << std::endl;
         CHECK(str.length() >= 0);
     }
+
+    SECTION("check search major faults") {
+        knowhere::knowhere_search_major_faults.Observe(3);
+        auto str = knowhere::prometheusClient->GetMetrics();
+        CHECK(str.find("search_major_faults_count") != std::string::npos);
+    }
+}
+
+TEST_CASE("Test memory report gauges", "[prometheus client]") {
+    knowhere::MemoryReport report;
+    report.AddHeap(knowhere::MemoryComponent::CODES, 4096);
+    report.AddHeap(knowhere::MemoryComponent::GRAPH, 1024);
+    REQUIRE(report.Get(knowhere::MemoryComponent::CODES).heap_bytes == 4096);
+    REQUIRE(report.Total().heap_bytes == 5120);
+    REQUIRE(report.Total().mapped_bytes == 0);
+
+    knowhere::ExportMemoryReport("memory_report_test", report);
+    auto str = knowhere::prometheusClient->GetMetrics();
+    CHECK(str.find("index_memory_bytes{component=\"codes\",index_id=\"memory_report_test\",kind=\"heap\"} 4096") !=
+          std::string::npos);
+    knowhere::RemoveMemoryReport("memory_report_test");
+    str = knowhere::prometheusClient->GetMetrics();
+    CHECK(str.find("memory_report_test") == std::string::npos);
+}
+
+TEST_CASE("Test thread pool metrics", "[prometheus client]") {
+    std::vector<std::function<void()>> tasks(4, []() {});
+    knowhere::ExecOverBuildThreadPool(tasks);
+    knowhere::InstrumentThreadPools();
+
+    auto str = knowhere::prometheusClient->GetMetrics();
+    for (const std::string pool : {"build", "search"}) {
+        const std::string labels = "{module=\"knowhere\",pool=\"" + pool + "\"}";
+        CHECK(str.find("thread_pool_threads" + labels) != std::string::npos);
+        CHECK(str.find("thread_pool_active_threads" + labels) != std::string::npos);
+        CHECK(str.find("thread_pool_queue_length" + labels) != std::string::npos);
+        CHECK(str.find("thread_pool_task_wait_latency_count" + labels) != std::string::npos);
+        CHECK(str.find("thread_pool_task_run_latency_count" + labels) != std::string::npos);
+    }
+    CHECK(str.find("thread_pool_threads{module=\"knowhere\",pool=\"build\"} " +
+                   std::to_string(knowhere::GetBuildThreadPoolSize())) != std::string::npos);
 }
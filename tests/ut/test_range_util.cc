@@ -9,6 +9,8 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <thread>
+
 #include "catch2/catch_test_macros.hpp"
 #include "faiss/impl/AuxIndexStructures.h"
 #include "knowhere/index/index_factory.h"
@@ -112,6 +114,60 @@ TEST_CASE("Test GetRangeSearchResult for HNSW/DiskANN", "[range search]") {
     }
 }
 
+TEST_CASE("Test RangeSearchResultArena", "[range search]") {
+    const int64_t nq = 10;
+    const int64_t label_min = 0, label_max = 10000;
+    const float dist_min = 0.0, dist_max = 100.0;
+    std::vector<std::vector<int64_t>> gen_labels;
+    std::vector<std::vector<float>> gen_distances;
+
+    GenRangeSearchResult(gen_labels, gen_distances, nq, label_min, label_max, dist_min, dist_max);
+    // results over several chunks
+    for (size_t j = 0; j < 2 * knowhere::RangeSearchResultArena::kChunkSize + 1; j++) {
+        gen_labels[3].push_back(j);
+        gen_distances[3].push_back(j * 0.1f);
+    }
+    auto gt = knowhere::GenResultDataSet(
+        nq, knowhere::GetRangeSearchResult(gen_distances, gen_labels, false, nq, dist_max, dist_min));
+
+    // the queries are written by several threads, which interleave in the lanes
+    for (int round = 0; round < 2; round++) {
+        knowhere::RangeSearchResultArena arena(nq);
+        std::vector<size_t> sizes(nq);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; t++) {
+            threads.emplace_back([&, t]() {
+                for (int64_t i = t; i < nq; i += 3) {
+                    auto writer = arena.GetWriter(i);
+                    for (size_t j = 0; j < gen_labels[i].size(); j++) {
+                        writer.Add(gen_labels[i][j], gen_distances[i][j]);
+                    }
+                    sizes[i] = writer.Size();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (int64_t i = 0; i < nq; i++) {
+            REQUIRE(sizes[i] == gen_labels[i].size());
+        }
+        auto result = knowhere::GenResultDataSet(nq, arena.Finish());
+
+        for (int64_t i = 0; i <= nq; i++) {
+            REQUIRE(result->GetLims()[i] == gt->GetLims()[i]);
+        }
+        for (size_t j = 0; j < gt->GetLims()[nq]; j++) {
+            REQUIRE(result->GetIds()[j] == gt->GetIds()[j]);
+            REQUIRE(result->GetDistance()[j] == gt->GetDistance()[j]);
+        }
+    }
+
+    // no writer, no result
+    auto empty = knowhere::GenResultDataSet(nq, knowhere::RangeSearchResultArena(nq).Finish());
+    REQUIRE(empty->GetLims()[nq] == 0);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 #if 0
 namespace {
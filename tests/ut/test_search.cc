@@ -9,17 +9,30 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
 #include "faiss/utils/binary_distances.h"
 #include "hnswlib/hnswalg.h"
+#include "io/compressed_io.h"
+#include "io/container.h"
+#include "io/index_binary.h"
 #include "knowhere/bitsetview.h"
 #include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/huge_page.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/comp/knowhere_check.h"
 #include "knowhere/comp/knowhere_config.h"
+#include "knowhere/comp/search_planner.h"
+#include "knowhere/comp/task.h"
 #include "knowhere/index/index_factory.h"
+#include "knowhere/index/search_batcher.h"
 #include "knowhere/log.h"
 #include "simd/hook.h"
 #include "utils.h"
@@ -96,6 +109,15 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
 
     auto flat_gen = base_gen;
 
+    auto flat_sq_gen = [base_gen]() {
+        knowhere::Json json = base_gen();
+        json["sq_type"] = "SQ8";
+        json["refine"] = true;
+        json["refine_type"] = "FLAT";
+        json["refine_k"] = 4;
+        return json;
+    };
+
     auto ivfpq_gen = [ivfflat_gen]() {
         knowhere::Json json = ivfflat_gen();
         json[knowhere::indexparam::M] = 4;
@@ -155,6 +177,21 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto ivfpqfastscan_gen = [ivfflat_gen]() {
+        knowhere::Json json = ivfflat_gen();
+        json[knowhere::indexparam::M] = dim / 2;
+        json[knowhere::indexparam::NBITS] = 4;
+        return json;
+    };
+
+    auto ivfpqfastscan_refine_flat_gen = [ivfpqfastscan_gen]() {
+        knowhere::Json json = ivfpqfastscan_gen();
+        json["refine"] = true;
+        json["refine_type"] = "FLAT";
+        json["refine_k"] = 4;
+        return json;
+    };
+
     const auto train_ds = GenDataSet(nb, dim);
     const auto query_ds = GenDataSet(nq, dim);
 
@@ -168,6 +205,7 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>(
             {make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP_SQ, flat_sq_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
@@ -181,12 +219,15 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
              make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
              make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ, hnsw_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_gen),
-             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_refine_flat_gen)}));
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_refine_flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfastscan_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfastscan_refine_flat_gen)}));
         knowhere::BinarySet bs;
         // build process
         {
             auto idx_expected = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version);
-            if (name == knowhere::IndexEnum::INDEX_FAISS_SCANN) {
+            if (name == knowhere::IndexEnum::INDEX_FAISS_SCANN ||
+                name == knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN) {
                 // need to check cpu model for scann
                 if (!faiss::support_pq_fast_scan) {
                     REQUIRE(idx_expected.error() == knowhere::Status::invalid_index_error);
@@ -241,15 +282,18 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
             float recall = GetKNNRecall(*gt.value(), *results.value());
             bool scann_without_raw_data =
                 (name == knowhere::IndexEnum::INDEX_FAISS_SCANN && scann_gen2().dump() == cfg_json);
+            bool ivfpqfastscan_without_refine =
+                (name == knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN && ivfpqfastscan_gen().dump() == cfg_json);
             if (name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ && name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ &&
-                !scann_without_raw_data) {
+                !scann_without_raw_data && !ivfpqfastscan_without_refine) {
                 REQUIRE(recall > kKnnRecallThreshold);
             }
 
             if (metric == knowhere::metric::COSINE) {
                 if (name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ8 && name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ &&
                     name != knowhere::IndexEnum::INDEX_HNSW_SQ && name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC &&
-                    name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ && !scann_without_raw_data) {
+                    name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ && !scann_without_raw_data &&
+                    !ivfpqfastscan_without_refine) {
                     REQUIRE(CheckDistanceInScope(*results.value(), topk, -1.00001, 1.00001));
                 }
             }
@@ -264,6 +308,7 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>(
             {make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP_SQ, flat_sq_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
@@ -274,9 +319,11 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
              make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
              make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ, hnsw_gen),
              make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_gen),
-             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_refine_flat_gen)}));
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_refine_flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfastscan_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfastscan_refine_flat_gen)}));
         auto idx_expected = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version);
-        if (name == knowhere::IndexEnum::INDEX_FAISS_SCANN) {
+        if (name == knowhere::IndexEnum::INDEX_FAISS_SCANN || name == knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN) {
             // need to check cpu model for scann
             if (!faiss::support_pq_fast_scan) {
                 REQUIRE(idx_expected.error() == knowhere::Status::invalid_index_error);
@@ -301,7 +348,8 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         bool scann_without_raw_data =
             (name == knowhere::IndexEnum::INDEX_FAISS_SCANN && scann_gen2().dump() == cfg_json);
         if (name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ && name != knowhere::IndexEnum::INDEX_FAISS_SCANN &&
-            name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC && name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ) {
+            name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC && name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ &&
+            name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN) {
             for (int i = 0; i < nq; ++i) {
                 CHECK(ids[lims[i]] == i);
             }
@@ -310,7 +358,8 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         if (metric == knowhere::metric::COSINE) {
             if (name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ8 && name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ &&
                 name != knowhere::IndexEnum::INDEX_HNSW_SQ && name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC &&
-                name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ && !scann_without_raw_data) {
+                name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ && !scann_without_raw_data &&
+                name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN) {
                 REQUIRE(CheckDistanceInScope(*results.value(), -1.00001, 1.00001));
             }
         }
@@ -441,6 +490,322 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         }
     }
 
+    SECTION("Test IVF Search with Lists Split Across Threads") {
+        using std::make_tuple;
+        auto split_gen = [base_gen]() {
+            knowhere::Json json = base_gen();
+            json[knowhere::indexparam::NLIST] = 32;
+            json[knowhere::indexparam::NPROBE] = 16;
+            return json;
+        };
+        auto split_pq_gen = [split_gen]() {
+            knowhere::Json json = split_gen();
+            json[knowhere::indexparam::M] = 4;
+            json[knowhere::indexparam::NBITS] = 8;
+            return json;
+        };
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, split_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, split_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, split_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, split_pq_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        // enough queries to keep the search pool busy are searched one by one, while a couple of them have their
+        // probed lists split across the threads, which is expected to find the same neighbors
+        const int64_t nq_batch = knowhere::KnowhereConfig::GetSearchThreadPoolSize() * 8;
+        auto batch_ds = GenDataSet(nq_batch, dim, (uint64_t)123);
+        auto few_ds = CopyDataSet(batch_ds, 2);
+        auto batch_results = idx.Search(batch_ds, json, nullptr);
+        auto few_results = idx.Search(few_ds, json, nullptr);
+        REQUIRE(batch_results.has_value());
+        REQUIRE(few_results.has_value());
+        auto batch_ids = batch_results.value()->GetIds();
+        auto batch_dists = batch_results.value()->GetDistance();
+        auto few_ids = few_results.value()->GetIds();
+        auto few_dists = few_results.value()->GetDistance();
+        for (int64_t i = 0; i < 2 * topk; ++i) {
+            // ties may be ordered differently
+            REQUIRE((few_ids[i] == -1) == (batch_ids[i] == -1));
+            REQUIRE(few_dists[i] == Approx(batch_dists[i]));
+        }
+    }
+
+    SECTION("Test IVF Search with HNSW Coarse Quantizer") {
+        using std::make_tuple;
+        auto flat_qzr_gen = [base_gen]() {
+            knowhere::Json json = base_gen();
+            json[knowhere::indexparam::NLIST] = 32;
+            json[knowhere::indexparam::NPROBE] = 16;
+            json[knowhere::indexparam::ENSURE_TOPK_FULL] = false;
+            return json;
+        };
+        auto flat_qzr_pq_gen = [flat_qzr_gen]() {
+            knowhere::Json json = flat_qzr_gen();
+            json[knowhere::indexparam::M] = 4;
+            json[knowhere::indexparam::NBITS] = 8;
+            return json;
+        };
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, flat_qzr_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, flat_qzr_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, flat_qzr_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, flat_qzr_pq_gen),
+        }));
+        knowhere::Json flat_json = gen();
+        knowhere::Json graph_json = gen();
+        graph_json[knowhere::indexparam::QUANTIZER_TYPE] = "hnsw";
+        graph_json[knowhere::indexparam::QUANTIZER_HNSW_M] = 8;
+        // an ef of nlist probes the same lists as the flat quantizer
+        graph_json[knowhere::indexparam::QUANTIZER_EF] = 32;
+        CAPTURE(name, graph_json.dump());
+
+        auto flat_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(flat_idx.Build(train_ds, flat_json) == knowhere::Status::success);
+        auto graph_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(graph_idx.Build(train_ds, graph_json) == knowhere::Status::success);
+        REQUIRE(graph_idx.Count() == nb);
+
+        // the quantizer is serialized with the index
+        knowhere::BinarySet bs;
+        REQUIRE(graph_idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, graph_json) == knowhere::Status::success);
+
+        auto flat_results = flat_idx.Search(query_ds, flat_json, nullptr);
+        auto graph_results = loaded_idx.Search(query_ds, graph_json, nullptr);
+        REQUIRE(flat_results.has_value());
+        REQUIRE(graph_results.has_value());
+        auto flat_dists = flat_results.value()->GetDistance();
+        auto graph_dists = graph_results.value()->GetDistance();
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(graph_dists[i] == Approx(flat_dists[i]));
+        }
+
+        graph_json[knowhere::indexparam::QUANTIZER_TYPE] = "graph";
+        auto invalid_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(invalid_idx.Build(train_ds, graph_json) == knowhere::Status::invalid_args);
+    }
+
+    SECTION("Test IVF Search with Adaptive Nprobe") {
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IVFFLAT,
+                             knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC);
+        knowhere::Json json = base_gen();
+        json[knowhere::indexparam::NLIST] = 32;
+        json[knowhere::indexparam::NPROBE] = 32;
+        json[knowhere::indexparam::ENSURE_TOPK_FULL] = false;
+        json[knowhere::indexparam::SSIZE] = 48;
+        CAPTURE(name, json.dump());
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto full_results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(full_results.has_value());
+
+        // a ratio of 1 only skips the lists that can not hold a better result, the distances are exact
+        json[knowhere::indexparam::ADAPTIVE_NPROBE_RATIO] = 1.0;
+        auto adaptive_results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(adaptive_results.has_value());
+        auto full_dists = full_results.value()->GetDistance();
+        auto adaptive_dists = adaptive_results.value()->GetDistance();
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(adaptive_dists[i] == Approx(full_dists[i]));
+        }
+
+        json[knowhere::indexparam::ADAPTIVE_NPROBE_RATIO] = -1.0;
+        REQUIRE(idx.Search(query_ds, json, nullptr).error() == knowhere::Status::out_of_range_in_json);
+    }
+
+    SECTION("Test IVF Train with Hierarchical Kmeans") {
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IVFFLAT,
+                             knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, knowhere::IndexEnum::INDEX_FAISS_IVFSQ8);
+        knowhere::Json json = base_gen();
+        json[knowhere::indexparam::NLIST] = 32;
+        json[knowhere::indexparam::NPROBE] = 32;
+        json[knowhere::indexparam::SSIZE] = 48;
+        json[knowhere::indexparam::HIERARCHICAL_KMEANS] = true;
+        CAPTURE(name, json.dump());
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        // all the lists are probed
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9f);
+
+        json[knowhere::indexparam::KMEANS_MAX_BALANCE] = 0.5f;
+        auto invalid_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(invalid_idx.Build(train_ds, json) == knowhere::Status::out_of_range_in_json);
+    }
+
+    SECTION("Test IVF Search Skipping Filtered Out Lists") {
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IVFFLAT,
+                             knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, knowhere::IndexEnum::INDEX_FAISS_IVFSQ8);
+        knowhere::Json json = base_gen();
+        json[knowhere::indexparam::NLIST] = 32;
+        json[knowhere::indexparam::NPROBE] = 2;
+        json[knowhere::indexparam::ENSURE_TOPK_FULL] = false;
+        json[knowhere::indexparam::SSIZE] = 48;
+        CAPTURE(name, json.dump());
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        // the few vectors left are in a handful of lists, the ones probed in place of the filtered out lists still
+        // hold at least one of them each
+        const int64_t n_unfiltered = 10;
+        auto bitset_data = GenerateBitsetWithFirstTbitsSet(nb, nb - n_unfiltered);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto results = idx.Search(query_ds, json, bitset);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq; ++i) {
+            int64_t n_found = 0;
+            for (int64_t j = 0; j < topk; ++j) {
+                const int64_t id = ids[i * topk + j];
+                if (id != -1) {
+                    REQUIRE(id >= nb - n_unfiltered);
+                    n_found++;
+                }
+            }
+            REQUIRE(n_found >= std::min<int64_t>(topk, 2));
+        }
+    }
+
+    SECTION("Test Search with Caller-Provided Buffers") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>(
+            {make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP_SQ, flat_sq_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen)}));
+        knowhere::Json json = gen();
+        CAPTURE(name, json.dump());
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        std::vector<int64_t> ids(nq * topk);
+        std::vector<float> distances(nq * topk);
+        auto buf_results = idx.SearchWithBuf(query_ds, json, nullptr, ids.data(), distances.data());
+        REQUIRE(buf_results.has_value());
+        REQUIRE(buf_results.value()->GetIds() == ids.data());
+        REQUIRE(buf_results.value()->GetDistance() == distances.data());
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(ids[i] == results.value()->GetIds()[i]);
+            REQUIRE(distances[i] == Approx(results.value()->GetDistance()[i]));
+        }
+    }
+
+    SECTION("Test Cancelled Search") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>(
+            {make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen)}));
+        knowhere::Json json = gen();
+        CAPTURE(name, json.dump());
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        knowhere::SearchDeadline deadline;
+        deadline.cancelled = std::make_shared<std::atomic<bool>>(true);
+        {
+            knowhere::ScopedSearchDeadline deadline_setter(deadline);
+            auto results = idx.Search(query_ds, json, nullptr);
+            REQUIRE(results.error() == knowhere::Status::timeout);
+            REQUIRE(results.has_value());
+            for (int64_t i = 0; i < nq * topk; ++i) {
+                REQUIRE(results.value()->GetIds()[i] == -1);
+            }
+        }
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.error() == knowhere::Status::success);
+    }
+
+    SECTION("Test IVF Build with Mini-batch Kmeans") {
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IVFFLAT,
+                             knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC);
+        knowhere::Json json = ivfflat_gen();
+        json[knowhere::indexparam::SSIZE] = 48;
+        CAPTURE(name, json.dump());
+        knowhere::KnowhereConfig::SetClusteringMiniBatchSize(nb / 4);
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto status = idx.Build(train_ds, json);
+        knowhere::KnowhereConfig::SetClusteringMiniBatchSize(0);
+        REQUIRE(status == knowhere::Status::success);
+
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        float recall = GetKNNRecall(*gt.value(), *results.value());
+        REQUIRE(recall > kKnnRecallThreshold);
+    }
+
+    SECTION("Test IVF Search of Large Batches List by List") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        // a batch large enough for every list to be probed by many queries of a block is scanned list by list, while
+        // a few of its queries are searched one by one, which is expected to find the same neighbors
+        const int64_t nq_batch = 256, nq_few = 4;
+        auto batch_ds = GenDataSet(nq_batch, dim, (uint64_t)123);
+        auto few_ds = CopyDataSet(batch_ds, nq_few);
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 10);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto batch_results = idx.Search(batch_ds, json, bitset);
+        auto few_results = idx.Search(few_ds, json, bitset);
+        REQUIRE(batch_results.has_value());
+        REQUIRE(few_results.has_value());
+        auto batch_ids = batch_results.value()->GetIds();
+        auto batch_dists = batch_results.value()->GetDistance();
+        auto few_ids = few_results.value()->GetIds();
+        auto few_dists = few_results.value()->GetDistance();
+        for (int64_t i = 0; i < nq_few * topk; ++i) {
+            // ties may be ordered differently
+            REQUIRE((few_ids[i] == -1) == (batch_ids[i] == -1));
+            REQUIRE(few_dists[i] == Approx(batch_dists[i]));
+            if (batch_ids[i] != -1) {
+                REQUIRE(!bitset.test(batch_ids[i]));
+            }
+        }
+    }
+
+    SECTION("Test IVF_SQ8 Search with Quantized Queries") {
+        auto idx = knowhere::IndexFactory::Instance()
+                       .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, version)
+                       .value();
+        knowhere::Json json = ivfsq_gen();
+        json[knowhere::indexparam::NPROBE] = 16;
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        // the L2 searches ignore the option, the others score the codes against the int8 queries, which is expected
+        // to find about the same neighbors
+        auto results = idx.Search(query_ds, json, nullptr);
+        json[knowhere::indexparam::SQ_QUANTIZED_QUERY] = true;
+        auto quantized_results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(quantized_results.has_value());
+        float recall = GetKNNRecall(*results.value(), *quantized_results.value());
+        if (knowhere::IsMetricType(metric, knowhere::metric::L2)) {
+            REQUIRE(recall == 1.0f);
+        } else {
+            REQUIRE(recall > 0.9f);
+        }
+    }
+
     SECTION("Test Search with Bitset") {
         using std::make_tuple;
         auto [name, gen, threshold] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>, float>({
@@ -555,6 +920,1146 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
     }
 }
 
+TEST_CASE("Test Search Fan Out", "[float metrics]") {
+    using Catch::Approx;
+
+    const int64_t nq = 10;
+    const int64_t dim = 32;
+    // the rows of every index start at a byte of the bitset
+    const std::vector<int64_t> segment_rows = {400, 8, 304, 296};
+    const int64_t nb = std::accumulate(segment_rows.begin(), segment_rows.end(), int64_t(0));
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP);
+    auto topk = GENERATE(as<int64_t>{}, 5, 100);
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    std::vector<uint8_t> bitset_data((nb + 7) / 8);
+    for (int64_t i = 0; i < nb; i += 3) {
+        bitset_data[i >> 3] |= (1 << (i & 0x7));
+    }
+    knowhere::BitsetView bitset(bitset_data.data(), nb);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, bitset);
+    REQUIRE(gt.has_value());
+
+    std::vector<knowhere::Index<knowhere::IndexNode>::SearchTarget> targets;
+    int64_t offset = 0;
+    for (auto rows : segment_rows) {
+        auto idx_expected =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IDMAP, version);
+        auto idx = idx_expected.value();
+        auto segment_ds = knowhere::GenDataSet(rows, dim, (const float*)train_ds->GetTensor() + offset * dim);
+        REQUIRE(idx.Build(segment_ds, json) == knowhere::Status::success);
+        int64_t filtered_out = 0;
+        for (int64_t i = offset; i < offset + rows; i++) {
+            filtered_out += bitset.test(i);
+        }
+        targets.push_back({idx, knowhere::BitsetView(bitset_data.data() + offset / 8, rows, filtered_out), offset});
+        offset += rows;
+    }
+
+    auto results = knowhere::Index<knowhere::IndexNode>::SearchFanOut(targets, query_ds, json);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) == Approx(1.0f));
+    for (int64_t i = 0; i < nq * topk; i++) {
+        REQUIRE(results.value()->GetDistance()[i] == Approx(gt.value()->GetDistance()[i]));
+    }
+
+    // an error of any index fails the search
+    targets.back().bitset = knowhere::BitsetView(bitset_data.data(), nb);
+    auto failed = knowhere::Index<knowhere::IndexNode>::SearchFanOut(targets, query_ds, json);
+    REQUIRE(failed.error() == knowhere::Status::invalid_args);
+}
+
+TEST_CASE("Test Prepared Search Config", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 32;
+    const int64_t topk = 10;
+    auto version = GenTestVersionList();
+
+    auto index_type = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                               knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 4;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 100;
+    json[knowhere::indexparam::EF] = 32;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+    auto prepared = idx.PrepareSearchConfig(json);
+    REQUIRE(prepared.has_value());
+    REQUIRE(prepared.value()->IndexType() == index_type);
+
+    std::vector<uint8_t> bitset_data((nb + 7) / 8, 0x0F);
+    const knowhere::BitsetView bitset(bitset_data.data(), nb);
+    const auto expected_results = idx.Search(query_ds, json, bitset);
+    REQUIRE(expected_results.has_value());
+
+    // the prepared config is reused across the searches, with their own bitsets
+    for (int i = 0; i < 2; i++) {
+        auto results = idx.Search(query_ds, *prepared.value(), bitset);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        auto expected_ids = expected_results.value()->GetIds();
+        REQUIRE(std::equal(ids, ids + nq * topk, expected_ids));
+    }
+    auto results = idx.Search(query_ds, *prepared.value(), nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(results.value()->GetDim() == topk);
+
+    SECTION("search with buffers") {
+        std::vector<int64_t> ids(nq * topk);
+        std::vector<float> distances(nq * topk);
+        auto buf_results = idx.SearchWithBuf(query_ds, *prepared.value(), bitset, ids.data(), distances.data());
+        REQUIRE(buf_results.has_value());
+        REQUIRE(std::equal(ids.begin(), ids.end(), expected_results.value()->GetIds()));
+    }
+
+    SECTION("k override") {
+        results = idx.Search(query_ds, *prepared.value(), bitset, topk / 2);
+        REQUIRE(results.has_value());
+        REQUIRE(results.value()->GetDim() == topk / 2);
+        // the params checked against the prepared k do not hold for a larger k
+        results = idx.Search(query_ds, *prepared.value(), bitset, topk + 1);
+        REQUIRE(results.error() == knowhere::Status::invalid_args);
+    }
+
+    SECTION("index type mismatch") {
+        const auto other_type = index_type == knowhere::IndexEnum::INDEX_HNSW ? knowhere::IndexEnum::INDEX_FAISS_IDMAP
+                                                                               : knowhere::IndexEnum::INDEX_HNSW;
+        auto other = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(other_type, version).value();
+        REQUIRE(other.Build(train_ds, json) == knowhere::Status::success);
+        results = other.Search(query_ds, *prepared.value(), bitset);
+        REQUIRE(results.error() == knowhere::Status::invalid_args);
+    }
+
+    SECTION("invalid params") {
+        json[knowhere::meta::TOPK] = -1;
+        REQUIRE(idx.PrepareSearchConfig(json).error() != knowhere::Status::success);
+    }
+}
+
+TEST_CASE("Test Search Stats", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 32;
+    auto version = GenTestVersionList();
+
+    auto index_type = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                               knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = 10;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 4;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 100;
+    json[knowhere::indexparam::EF] = 32;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+    // the stats are returned only when asked for
+    auto results = idx.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(results.value()->GetSearchStats() == nullptr);
+
+    json[knowhere::meta::SEARCH_STATS] = true;
+    results = idx.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    auto stats = results.value()->GetSearchStats();
+    REQUIRE(stats != nullptr);
+    REQUIRE(stats->size() == static_cast<size_t>(nq));
+    for (const auto& query_stats : *stats) {
+        REQUIRE(query_stats.distance_computations > 0);
+        if (index_type == knowhere::IndexEnum::INDEX_FAISS_IDMAP) {
+            REQUIRE(query_stats.distance_computations == static_cast<uint64_t>(nb));
+        } else if (index_type == knowhere::IndexEnum::INDEX_FAISS_IVFFLAT) {
+            // the empty lists are not scanned
+            REQUIRE(query_stats.lists_probed > 0);
+            REQUIRE(query_stats.lists_probed <= 4);
+            REQUIRE(query_stats.distance_computations < static_cast<uint64_t>(nb));
+        } else {
+            REQUIRE(query_stats.graph_hops > 0);
+            REQUIRE((query_stats.strategies & static_cast<uint32_t>(knowhere::SearchStrategy::GRAPH)) != 0);
+            REQUIRE(query_stats.estimated_cost > 0);
+        }
+    }
+
+    // the filtered out vectors are not computed by the brute force
+    std::vector<uint8_t> bitset_data((nb + 7) / 8, 0x0F);
+    results = idx.Search(query_ds, json, knowhere::BitsetView(bitset_data.data(), nb));
+    REQUIRE(results.has_value());
+    stats = results.value()->GetSearchStats();
+    REQUIRE(stats != nullptr);
+    if (index_type == knowhere::IndexEnum::INDEX_FAISS_IDMAP) {
+        for (const auto& query_stats : *stats) {
+            REQUIRE(query_stats.distance_computations == static_cast<uint64_t>(nb / 2));
+        }
+    }
+}
+
+TEST_CASE("Test Group By Search", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 32;
+    const int64_t n_groups = 20;
+    const int32_t topk = 5, group_size = 3;
+    auto version = GenTestVersionList();
+
+    auto index_type = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IVFFLAT,
+                               knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, knowhere::IndexEnum::INDEX_HNSW);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::meta::GROUP_SIZE] = group_size;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 4;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 100;
+    json[knowhere::indexparam::EF] = 64;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+    std::vector<int64_t> group_ids(nb);
+    for (int64_t i = 0; i < nb; i++) {
+        group_ids[i] = (i * 7) % n_groups;
+    }
+    const knowhere::GroupByColumn column(group_ids.data(), nb);
+
+    // the exact groups of a query, from the nearest one
+    const auto* xb = static_cast<const float*>(train_ds->GetTensor());
+    const auto* xq = static_cast<const float*>(query_ds->GetTensor());
+    auto exact_groups = [&](const int64_t q) {
+        std::vector<float> nearest(n_groups, std::numeric_limits<float>::max());
+        for (int64_t i = 0; i < nb; i++) {
+            float dis = 0.0f;
+            for (int64_t d = 0; d < dim; d++) {
+                const float diff = xq[q * dim + d] - xb[i * dim + d];
+                dis += diff * diff;
+            }
+            nearest[group_ids[i]] = std::min(nearest[group_ids[i]], dis);
+        }
+        std::vector<int64_t> order(n_groups);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) { return nearest[a] < nearest[b]; });
+        order.resize(topk);
+        return order;
+    };
+
+    SECTION("groups of the results") {
+        auto results = idx.GroupBySearch(query_ds, column, json, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(results.value()->GetDim() == topk * group_size);
+        const auto* ids = results.value()->GetIds();
+        const auto* distances = results.value()->GetDistance();
+        int64_t matched_groups = 0;
+        for (int64_t q = 0; q < nq; q++) {
+            std::vector<int64_t> groups;
+            float prev_nearest = 0.0f;
+            for (int32_t g = 0; g < topk; g++) {
+                const auto offset = q * topk * group_size + g * group_size;
+                // every group holds more than group_size rows
+                for (int32_t j = 0; j < group_size; j++) {
+                    REQUIRE(ids[offset + j] >= 0);
+                    REQUIRE(group_ids[ids[offset + j]] == group_ids[ids[offset]]);
+                    if (j > 0) {
+                        REQUIRE(distances[offset + j] >= distances[offset + j - 1]);
+                    }
+                }
+                REQUIRE(distances[offset] >= prev_nearest);
+                prev_nearest = distances[offset];
+                groups.push_back(group_ids[ids[offset]]);
+            }
+            std::sort(groups.begin(), groups.end());
+            REQUIRE(std::unique(groups.begin(), groups.end()) == groups.end());
+
+            auto expected_groups = exact_groups(q);
+            for (const auto group : expected_groups) {
+                matched_groups += std::binary_search(groups.begin(), groups.end(), group);
+            }
+        }
+        REQUIRE(matched_groups >= kKnnRecallThreshold * nq * topk);
+    }
+
+    SECTION("filtered rows are not returned") {
+        std::vector<uint8_t> bitset_data((nb + 7) / 8, 0x0F);
+        const knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto results = idx.GroupBySearch(query_ds, column, json, bitset);
+        REQUIRE(results.has_value());
+        const auto* ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq * topk * group_size; i++) {
+            if (ids[i] >= 0) {
+                REQUIRE(!bitset.test(ids[i]));
+            }
+        }
+    }
+
+    SECTION("the column has to cover the rows") {
+        const knowhere::GroupByColumn short_column(group_ids.data(), nb / 2);
+        auto results = idx.GroupBySearch(query_ds, short_column, json, nullptr);
+        REQUIRE(results.error() == knowhere::Status::invalid_args);
+    }
+}
+
+TEST_CASE("Test Search Result Cache", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 32;
+    const int64_t topk = 10;
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = topk;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto idx = knowhere::IndexFactory::Instance()
+                   .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IDMAP, version)
+                   .value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+    auto expected = idx.Search(query_ds, json, nullptr);
+    REQUIRE(expected.has_value());
+
+    auto require_same_results = [&](const knowhere::DataSetPtr& res, const knowhere::DataSetPtr& ref,
+                                    const int64_t ref_offset) {
+        for (int64_t i = 0; i < res->GetRows() * topk; i++) {
+            REQUIRE(res->GetIds()[i] == ref->GetIds()[ref_offset * topk + i]);
+            REQUIRE(res->GetDistance()[i] == ref->GetDistance()[ref_offset * topk + i]);
+        }
+    };
+
+    REQUIRE(idx.EnableResultCache<knowhere::fp32>(4) == knowhere::Status::success);
+    auto cache = idx.Node()->ResultCache();
+    REQUIRE(cache != nullptr);
+
+    SECTION("cached results") {
+        // the cache keeps the 4 most recent queries
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        require_same_results(results.value(), expected.value(), 0);
+        REQUIRE(cache->Size() == 4);
+        results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        require_same_results(results.value(), expected.value(), 0);
+
+        // a batch partly cached
+        const auto* xq = static_cast<const float*>(query_ds->GetTensor());
+        const auto tail_ds = knowhere::GenDataSet(3, dim, xq + (nq - 3) * dim);
+        results = idx.Search(tail_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        require_same_results(results.value(), expected.value(), nq - 3);
+
+        // the trace and the deadline of a search are not part of its key, the bitset and the k are
+        auto traced_json = json;
+        traced_json[knowhere::meta::SEARCH_TIMEOUT_MS] = 10000;
+        results = idx.Search(tail_ds, traced_json, nullptr);
+        REQUIRE(results.has_value());
+        require_same_results(results.value(), expected.value(), nq - 3);
+
+        std::vector<uint8_t> bitset_data((nb + 7) / 8, 0xFF);
+        results = idx.Search(tail_ds, json, knowhere::BitsetView(bitset_data.data(), nb));
+        REQUIRE(results.has_value());
+        for (int64_t i = 0; i < 3 * topk; i++) {
+            REQUIRE(results.value()->GetIds()[i] == -1);
+        }
+    }
+
+    SECTION("colliding keys") {
+        // an entry is returned only to its own query, whatever its key
+        const auto* xq = static_cast<const float*>(query_ds->GetTensor());
+        const auto query = cache->QueryBytes(xq, 0, dim);
+        const auto other = cache->QueryBytes(xq, 1, dim);
+        REQUIRE(query != other);
+        const uint64_t key = cache->QueryKey(xq, 0, dim, 0);
+        cache->Insert(key, query, topk, expected.value()->GetIds(), expected.value()->GetDistance());
+        std::vector<int64_t> ids(topk);
+        std::vector<float> distances(topk);
+        REQUIRE(cache->Lookup(key, query, topk, ids.data(), distances.data()));
+        REQUIRE(ids[0] == expected.value()->GetIds()[0]);
+        REQUIRE(!cache->Lookup(key, other, topk, ids.data(), distances.data()));
+    }
+
+    SECTION("dropped on add") {
+        REQUIRE(idx.Search(query_ds, json, nullptr).has_value());
+        REQUIRE(idx.Add(query_ds, json) == knowhere::Status::success);
+        REQUIRE(cache->Size() == 0);
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        for (int64_t i = 0; i < nq; i++) {
+            REQUIRE(results.value()->GetIds()[i * topk] == nb + i);
+        }
+    }
+
+    SECTION("quantized keys") {
+        const float step = 1e-2f;
+        REQUIRE(idx.EnableResultCache<knowhere::fp32>(nq, step) == knowhere::Status::success);
+
+        // queries on the steps, and the same queries moved by a tenth of a step, which share their keys
+        const auto* xq = static_cast<const float*>(query_ds->GetTensor());
+        std::vector<float> centered(xq, xq + nq * dim);
+        std::vector<float> moved(nq * dim);
+        for (int64_t i = 0; i < nq * dim; i++) {
+            centered[i] = std::round(centered[i] / step) * step;
+            moved[i] = centered[i] + 0.1f * step;
+        }
+        auto results = idx.Search(knowhere::GenDataSet(nq, dim, centered.data()), json, nullptr);
+        REQUIRE(results.has_value());
+        auto moved_results = idx.Search(knowhere::GenDataSet(nq, dim, moved.data()), json, nullptr);
+        REQUIRE(moved_results.has_value());
+        require_same_results(moved_results.value(), results.value(), 0);
+
+        REQUIRE(idx.EnableResultCache<knowhere::fp32>(0) == knowhere::Status::success);
+        REQUIRE(idx.Node()->ResultCache() == nullptr);
+    }
+}
+
+TEST_CASE("Test IVF_RABITQ Extended Codes", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 128;
+    const int64_t topk = 10;
+    const auto index_type = knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ;
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto bits_query = GENERATE(as<int32_t>{}, 0, 8);
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    // every list is scanned, so that the recall is that of the codes
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 16;
+    json[knowhere::indexparam::RABITQ_QUERY_BITS] = bits_query;
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, nullptr);
+    REQUIRE(gt.has_value());
+
+    auto build = [&](int32_t bits_data) {
+        auto conf = json;
+        conf[knowhere::indexparam::RABITQ_DATA_BITS] = bits_data;
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+        REQUIRE(idx.Build(train_ds, conf) == knowhere::Status::success);
+        return idx;
+    };
+
+    auto idx_1bit = build(1);
+    auto results_1bit = idx_1bit.Search(query_ds, json, nullptr);
+    REQUIRE(results_1bit.has_value());
+    const float recall_1bit = GetKNNRecall(*gt.value(), *results_1bit.value());
+
+    // more bits give more accurate codes, and reach the recall without a refine
+    auto idx_4bit = build(4);
+    REQUIRE(idx_4bit.Size() > idx_1bit.Size());
+    auto results_4bit = idx_4bit.Search(query_ds, json, nullptr);
+    REQUIRE(results_4bit.has_value());
+    const float recall_4bit = GetKNNRecall(*gt.value(), *results_4bit.value());
+    REQUIRE(recall_4bit >= recall_1bit);
+    REQUIRE(recall_4bit > 0.8f);
+
+    auto idx_8bit = build(8);
+    auto results_8bit = idx_8bit.Search(query_ds, json, nullptr);
+    REQUIRE(results_8bit.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results_8bit.value()) > kKnnRecallThreshold);
+
+    // the bits of the codes follow from their size after a deserialization
+    knowhere::BinarySet bs;
+    REQUIRE(idx_4bit.Serialize(bs) == knowhere::Status::success);
+    auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(loaded_idx.Deserialize(bs, json) == knowhere::Status::success);
+    auto loaded_results = loaded_idx.Search(query_ds, json, nullptr);
+    REQUIRE(loaded_results.has_value());
+    for (int64_t i = 0; i < nq * topk; i++) {
+        REQUIRE(loaded_results.value()->GetIds()[i] == results_4bit.value()->GetIds()[i]);
+    }
+
+    auto invalid_conf = json;
+    invalid_conf[knowhere::indexparam::RABITQ_DATA_BITS] = 9;
+    auto invalid_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(invalid_idx.Build(train_ds, invalid_conf) != knowhere::Status::success);
+}
+
+template <typename DataType>
+void
+check_flat_half_storage(const std::string& metric) {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 64;
+    const int64_t topk = 10;
+    const auto index_type = knowhere::IndexEnum::INDEX_FAISS_IDMAP;
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+
+    const auto train_ds = knowhere::ConvertToDataTypeIfNeeded<DataType>(GenDataSet(nb, dim));
+    const auto query_ds = knowhere::ConvertToDataTypeIfNeeded<DataType>(GenDataSet(nq, dim, 43));
+    auto gt = knowhere::BruteForce::Search<DataType>(train_ds, query_ds, json, nullptr);
+    REQUIRE(gt.has_value());
+
+    auto idx = knowhere::IndexFactory::Instance().Create<DataType>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+    // the vectors are kept in half precision
+    REQUIRE(idx.Size() == nb * dim * (int64_t)sizeof(DataType));
+
+    // the same typed kernels as the brute force
+    auto results = idx.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.99f);
+
+    auto range_json = json;
+    range_json[knowhere::meta::RADIUS] = results.value()->GetDistance()[topk / 2];
+    auto range_results = idx.RangeSearch(query_ds, range_json, nullptr);
+    REQUIRE(range_results.has_value());
+    REQUIRE(range_results.value()->GetLims()[1] > 0);
+
+    std::vector<int64_t> ids = {0, 17, nb - 1};
+    auto ids_ds = GenIdsDataSet(ids.size(), ids);
+    auto vectors = idx.GetVectorByIds(ids_ds);
+    REQUIRE(vectors.has_value());
+    auto data = (const DataType*)vectors.value()->GetTensor();
+    auto train_data = (const DataType*)train_ds->GetTensor();
+    for (size_t i = 0; i < ids.size(); i++) {
+        REQUIRE(std::memcmp(data + i * dim, train_data + ids[i] * dim, dim * sizeof(DataType)) == 0);
+    }
+
+    knowhere::BinarySet bs;
+    REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+    auto loaded_idx = knowhere::IndexFactory::Instance().Create<DataType>(index_type, version).value();
+    REQUIRE(loaded_idx.Deserialize(bs, json) == knowhere::Status::success);
+    auto loaded_results = loaded_idx.Search(query_ds, json, nullptr);
+    REQUIRE(loaded_results.has_value());
+    for (int64_t i = 0; i < nq * topk; i++) {
+        REQUIRE(loaded_results.value()->GetIds()[i] == results.value()->GetIds()[i]);
+    }
+}
+
+TEST_CASE("Test FLAT Half Precision Storage", "[float metrics]") {
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    check_flat_half_storage<knowhere::fp16>(metric);
+    check_flat_half_storage<knowhere::bf16>(metric);
+}
+
+TEST_CASE("Test Prefix Dimension Search", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 128, prefix_dim = 32;
+    const int64_t topk = 10;
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP);
+    auto version = GenTestVersionList();
+
+    // Matryoshka-like vectors, the trailing dimensions carry little of the signal
+    auto matryoshka = [&](knowhere::DataSetPtr ds) {
+        auto data = (float*)ds->GetTensor();
+        for (int64_t i = 0; i < ds->GetRows(); i++) {
+            for (int64_t j = prefix_dim; j < dim; j++) {
+                data[i * dim + j] *= 0.1f;
+            }
+        }
+        return ds;
+    };
+    const auto train_ds = matryoshka(GenDataSet(nb, dim));
+    const auto query_ds = matryoshka(GenDataSet(nq, dim, 43));
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    json["refine"] = true;
+    json["refine_type"] = "FLAT";
+    json["refine_k"] = 8;
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, nullptr);
+    REQUIRE(gt.has_value());
+
+    auto [index_type, index_json] = GENERATE_REF(table<std::string, knowhere::Json>({
+        make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP_SQ, knowhere::Json{{"sq_type", "SQ8"}}),
+        make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ,
+                   knowhere::Json{{knowhere::indexparam::NLIST, 16}, {knowhere::indexparam::NPROBE, 16}}),
+        make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ,
+                   knowhere::Json{{"sq_type", "SQ8"},
+                                  {knowhere::indexparam::HNSW_M, 16},
+                                  {knowhere::indexparam::EFCONSTRUCTION, 96},
+                                  {knowhere::indexparam::EF, 64}}),
+    }));
+    json.update(index_json);
+    json[knowhere::indexparam::PREFIX_DIM] = prefix_dim;
+
+    // the base index ranks the candidates with the leading dimensions, the refine with all of them
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+    REQUIRE(idx.Dim() == dim);
+    auto results = idx.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+
+    knowhere::BinarySet bs;
+    REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+    auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(loaded_idx.Deserialize(bs, json) == knowhere::Status::success);
+    auto loaded_results = loaded_idx.Search(query_ds, json, nullptr);
+    REQUIRE(loaded_results.has_value());
+    for (int64_t i = 0; i < nq * topk; i++) {
+        REQUIRE(loaded_results.value()->GetIds()[i] == results.value()->GetIds()[i]);
+    }
+
+    // the prefix needs a refine over all the dimensions, and fewer dimensions than the vectors
+    auto no_refine_json = json;
+    no_refine_json["refine"] = false;
+    auto no_refine_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(no_refine_idx.Build(train_ds, no_refine_json) != knowhere::Status::success);
+    auto full_prefix_json = json;
+    full_prefix_json[knowhere::indexparam::PREFIX_DIM] = dim;
+    auto full_prefix_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type, version).value();
+    REQUIRE(full_prefix_idx.Build(train_ds, full_prefix_json) != knowhere::Status::success);
+}
+
+TEST_CASE("Test Search Batcher", "[float metrics]") {
+    const int64_t nb = 1000, nq = 16;
+    const int64_t dim = 32;
+    const int64_t topk = 10;
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = topk;
+
+    auto idx = knowhere::IndexFactory::Instance()
+                   .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IDMAP, version)
+                   .value();
+    REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    const auto queries = static_cast<const float*>(query_ds->GetTensor());
+    auto direct = idx.Search(query_ds, json, nullptr);
+    REQUIRE(direct.has_value());
+
+    // the concurrent single-query searches are batched, and each gets its own rows
+    knowhere::SearchBatcher<knowhere::fp32> batcher(idx, std::chrono::milliseconds(5));
+    std::vector<folly::SemiFuture<knowhere::expected<knowhere::DataSetPtr>>> futs;
+    for (int64_t i = 0; i < nq; i++) {
+        futs.push_back(batcher.SearchAsync(knowhere::GenDataSet(1, dim, queries + i * dim), json, nullptr));
+    }
+    for (int64_t i = 0; i < nq; i++) {
+        auto res = std::move(futs[i]).get();
+        REQUIRE(res.has_value());
+        REQUIRE(res.value()->GetRows() == 1);
+        for (int64_t j = 0; j < topk; j++) {
+            REQUIRE(res.value()->GetIds()[j] == direct.value()->GetIds()[i * topk + j]);
+        }
+    }
+
+    // a search of its own is not batched
+    auto res = batcher.Search(query_ds, json, nullptr);
+    REQUIRE(res.has_value());
+    REQUIRE(res.value()->GetRows() == nq);
+
+    // an error fails every search of the batch
+    std::vector<uint8_t> bitset_data((nb + 8 + 7) / 8);
+    knowhere::BitsetView too_large(bitset_data.data(), nb + 8);
+    auto bad = batcher.SearchAsync(knowhere::GenDataSet(1, dim, queries), json, too_large);
+    auto bad_too = batcher.SearchAsync(knowhere::GenDataSet(1, dim, queries + dim), json, too_large);
+    REQUIRE(std::move(bad).get().error() == knowhere::Status::invalid_args);
+    REQUIRE(std::move(bad_too).get().error() == knowhere::Status::invalid_args);
+}
+
+TEST_CASE("Test Zero Copy Deserialize", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 32;
+    auto version = GenTestVersionList();
+    auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                         knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = 10;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 4;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    json[knowhere::indexparam::EF] = 32;
+
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto copied = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    auto borrowing = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    {
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        REQUIRE(copied.Deserialize(bs, json) == knowhere::Status::success);
+        auto zero_copy_json = json;
+        zero_copy_json["enable_zero_copy"] = true;
+        REQUIRE(borrowing.Deserialize(bs, zero_copy_json) == knowhere::Status::success);
+    }
+
+    // the borrowed data outlives the binary set
+    auto expected_res = copied.Search(query_ds, json, nullptr);
+    auto res = borrowing.Search(query_ds, json, nullptr);
+    REQUIRE(res.has_value());
+    REQUIRE(borrowing.Count() == nb);
+    for (int64_t i = 0; i < nq * 10; i++) {
+        REQUIRE(res.value()->GetIds()[i] == expected_res.value()->GetIds()[i]);
+    }
+}
+
+TEST_CASE("Test Compressed Serialize", "[float metrics]") {
+    SECTION("chunked round trip") {
+        std::vector<uint8_t> raw(10000);
+        for (size_t i = 0; i < raw.size(); i++) {
+            raw[i] = static_cast<uint8_t>(i % 251);
+        }
+        knowhere::CompressedIOWriter writer(3, 1024);
+        // writes that straddle the chunks, and one of several whole chunks
+        writer(raw.data(), 1, 100);
+        writer(raw.data() + 100, 1, 3000);
+        writer(raw.data() + 3100, 1, raw.size() - 3100);
+        writer.Finish();
+        std::shared_ptr<uint8_t[]> data(writer.data());
+        REQUIRE(knowhere::IsCompressedBinary(data.get(), writer.tellg()));
+        REQUIRE(writer.tellg() < raw.size());
+
+        knowhere::CompressedIOReader reader(data.get(), writer.tellg());
+        std::vector<uint8_t> read(raw.size());
+        REQUIRE(reader(read.data(), 1, 7) == 7);
+        REQUIRE(reader(read.data() + 7, 1, 5000) == 5000);
+        REQUIRE(reader(read.data() + 5007, 1, raw.size()) == raw.size() - 5007);
+        REQUIRE(read == raw);
+        REQUIRE(reader(read.data(), 1, 1) == 0);
+
+        // a corrupted chunk is detected by its checksum or by zstd
+        data[writer.tellg() - 2] ^= 0xff;
+        knowhere::CompressedIOReader corrupted(data.get(), writer.tellg());
+        REQUIRE_THROWS(corrupted(read.data(), 1, raw.size()));
+    }
+
+    SECTION("index binaries") {
+        const int64_t nb = 1000, nq = 10;
+        const int64_t dim = 32;
+        // the compressed data is the data section of a container, see "Test Index Container"
+        auto version = knowhere::kContainerMinVersion;
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                             knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+
+        knowhere::Json json;
+        json[knowhere::meta::DIM] = dim;
+        json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+        json[knowhere::meta::TOPK] = 10;
+        json[knowhere::indexparam::NLIST] = 16;
+        json[knowhere::indexparam::NPROBE] = 4;
+        json[knowhere::indexparam::HNSW_M] = 16;
+        json[knowhere::indexparam::EFCONSTRUCTION] = 96;
+        json[knowhere::indexparam::EF] = 32;
+
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+        knowhere::BinarySet plain_bs;
+        REQUIRE(idx.Serialize(plain_bs) == knowhere::Status::success);
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(3);
+        knowhere::BinarySet bs;
+        auto status = idx.Serialize(bs);
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(0);
+        REQUIRE(status == knowhere::Status::success);
+        auto binary = bs.GetByName(idx.Type());
+        knowhere::ContainerReader container(binary->data.get(), binary->size);
+        const auto& section = container.Get(knowhere::SectionType::INDEX_DATA);
+        REQUIRE(knowhere::IsCompressedBinary(binary->data.get() + section.offset, section.size));
+        auto plain_binary = plain_bs.GetByName(idx.Type());
+        knowhere::ContainerReader plain_container(plain_binary->data.get(), plain_binary->size);
+        const auto& plain_section = plain_container.Get(knowhere::SectionType::INDEX_DATA);
+        REQUIRE(!knowhere::IsCompressedBinary(plain_binary->data.get() + plain_section.offset, plain_section.size));
+
+        const auto query_ds = GenDataSet(nq, dim, 43);
+        auto expected_res = idx.Search(query_ds, json, nullptr);
+        // the zero-copy load falls back to decompressing
+        auto zero_copy = GENERATE(as<bool>{}, false, true);
+        auto load_json = json;
+        load_json["enable_zero_copy"] = zero_copy;
+        auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(loaded.Deserialize(bs, load_json) == knowhere::Status::success);
+        REQUIRE(loaded.Count() == nb);
+        auto res = loaded.Search(query_ds, json, nullptr);
+        REQUIRE(res.has_value());
+        for (int64_t i = 0; i < nq * 10; i++) {
+            REQUIRE(res.value()->GetIds()[i] == expected_res.value()->GetIds()[i]);
+        }
+
+        // the indexes of older versions stay uncompressed, and without a container
+        auto old_version = knowhere::kContainerMinVersion - 1;
+        auto old_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, old_version).value();
+        REQUIRE(old_idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(3);
+        knowhere::BinarySet old_bs;
+        status = old_idx.Serialize(old_bs);
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(0);
+        REQUIRE(status == knowhere::Status::success);
+        auto old_binary = old_bs.GetByName(old_idx.Type());
+        REQUIRE(!knowhere::ContainerReader::IsContainer(old_binary->data.get(), old_binary->size));
+        REQUIRE(!knowhere::IsCompressedBinary(old_binary->data.get(), old_binary->size));
+    }
+}
+
+TEST_CASE("Test Index Container", "[float metrics]") {
+    SECTION("sections") {
+        std::vector<uint8_t> raw(10000);
+        for (size_t i = 0; i < raw.size(); i++) {
+            raw[i] = static_cast<uint8_t>(i % 251);
+        }
+        knowhere::ContainerWriter writer;
+        writer.AddIndexHeader(knowhere::IndexEnum::INDEX_HNSW, knowhere::Version::GetCurrentVersion().VersionNumber());
+        writer.AddSection(knowhere::SectionType::INDEX_DATA, 0, raw.data(), raw.size());
+        auto [data, size] = writer.Finish();
+        REQUIRE(size % knowhere::kContainerAlignment == 0);
+        REQUIRE(knowhere::ContainerReader::IsContainer(data.get(), size));
+        REQUIRE(!knowhere::ContainerReader::IsContainer(raw.data(), raw.size()));
+
+        knowhere::ContainerReader reader(data.get(), size);
+        const auto& section = reader.Get(knowhere::SectionType::INDEX_DATA);
+        REQUIRE(section.offset % knowhere::kContainerAlignment == 0);
+        REQUIRE(section.size == raw.size());
+        REQUIRE(std::memcmp(data.get() + section.offset, raw.data(), raw.size()) == 0);
+        REQUIRE_NOTHROW(knowhere::ContainerReader::Verify(section, data.get()));
+        REQUIRE_NOTHROW(reader.CheckIndexHeader(data.get(), knowhere::IndexEnum::INDEX_HNSW));
+        REQUIRE_THROWS(reader.CheckIndexHeader(data.get(), knowhere::IndexEnum::INDEX_FAISS_IDMAP));
+
+        // a corrupted section is detected by its checksum, a corrupted table when it is read
+        data[section.offset + 10] ^= 0xff;
+        REQUIRE_THROWS(knowhere::ContainerReader::Verify(section, data.get()));
+        data[sizeof(knowhere::ContainerHeader) + 8] ^= 0xff;
+        REQUIRE_THROWS(knowhere::ContainerReader(data.get(), size));
+    }
+
+    SECTION("index binaries and files") {
+        const int64_t nb = 1000, nq = 10;
+        const int64_t dim = 32;
+        auto version = GenTestVersionList();
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                             knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+        auto level = GENERATE(as<int>{}, 0, 3);
+
+        knowhere::Json json;
+        json[knowhere::meta::DIM] = dim;
+        json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+        json[knowhere::meta::TOPK] = 10;
+        json[knowhere::indexparam::NLIST] = 16;
+        json[knowhere::indexparam::NPROBE] = 4;
+        json[knowhere::indexparam::HNSW_M] = 16;
+        json[knowhere::indexparam::EFCONSTRUCTION] = 96;
+        json[knowhere::indexparam::EF] = 32;
+
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(level);
+        knowhere::BinarySet bs;
+        auto status = idx.Serialize(bs);
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(0);
+        REQUIRE(status == knowhere::Status::success);
+        auto binary = bs.GetByName(idx.Type());
+        REQUIRE(knowhere::ContainerReader::IsContainer(binary->data.get(), binary->size));
+        knowhere::ContainerReader container(binary->data.get(), binary->size);
+        const auto& section = container.Get(knowhere::SectionType::INDEX_DATA);
+        REQUIRE(((section.flags & knowhere::kSectionCompressed) != 0) == (level != 0));
+
+        const auto query_ds = GenDataSet(nq, dim, 43);
+        auto expected_res = idx.Search(query_ds, json, nullptr);
+        auto check = [&](knowhere::Index<knowhere::IndexNode>& loaded) {
+            REQUIRE(loaded.Count() == nb);
+            auto res = loaded.Search(query_ds, json, nullptr);
+            REQUIRE(res.has_value());
+            for (int64_t i = 0; i < nq * 10; i++) {
+                REQUIRE(res.value()->GetIds()[i] == expected_res.value()->GetIds()[i]);
+            }
+        };
+
+        auto zero_copy = GENERATE(as<bool>{}, false, true);
+        auto load_json = json;
+        load_json["enable_zero_copy"] = zero_copy;
+        auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(loaded.Deserialize(bs, load_json) == knowhere::Status::success);
+        check(loaded);
+
+        // the file of the binary is read, or mapped from its data section
+        std::remove(kMmapIndexPath);
+        std::ofstream out(kMmapIndexPath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(binary->data.get()), binary->size);
+        out.close();
+        auto mmap = GENERATE(as<bool>{}, false, true);
+        auto file_json = json;
+        file_json["enable_mmap"] = mmap;
+        auto file_loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(file_loaded.DeserializeFromFile(kMmapIndexPath, file_json) == knowhere::Status::success);
+        check(file_loaded);
+        std::remove(kMmapIndexPath);
+
+        // the index streamed to a file is the binary
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(level);
+        status = idx.SerializeToFile(kMmapIndexPath);
+        knowhere::KnowhereConfig::SetBinaryCompressionLevel(0);
+        REQUIRE(status == knowhere::Status::success);
+        std::ifstream in(kMmapIndexPath, std::ios::binary);
+        std::vector<char> streamed((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        REQUIRE(streamed.size() == binary->size);
+        REQUIRE(std::memcmp(streamed.data(), binary->data.get(), binary->size) == 0);
+        auto streamed_loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(streamed_loaded.DeserializeFromFile(kMmapIndexPath, file_json) == knowhere::Status::success);
+        check(streamed_loaded);
+        std::remove(kMmapIndexPath);
+
+        // a corrupted binary fails to load
+        if (level == 0) {
+            binary->data[section.offset + section.size / 2] ^= 0xff;
+            auto corrupted = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+            REQUIRE(corrupted.Deserialize(bs, json) != knowhere::Status::success);
+        }
+    }
+}
+
+TEST_CASE("Test Index Huge Pages", "[float metrics]") {
+    // large enough for the codes to take more than a huge page
+    const int64_t nb = 5000, nq = 10;
+    const int64_t dim = 128;
+    auto version = GenTestVersionList();
+    auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                         knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+    auto policy = GENERATE(knowhere::HugePagePolicy::TRANSPARENT, knowhere::HugePagePolicy::EXPLICIT);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = 10;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 4;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    json[knowhere::indexparam::EF] = 32;
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+    knowhere::BinarySet bs;
+    REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto expected_res = idx.Search(query_ds, json, nullptr);
+    REQUIRE(expected_res.has_value());
+
+    // the index is moved to huge pages when loaded, or advised to them when mapped
+    auto mmap = GENERATE(as<bool>{}, false, true);
+    knowhere::SetHugePagePolicy(policy);
+    auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    knowhere::Status status;
+    if (mmap) {
+        std::remove(kMmapIndexPath);
+        REQUIRE(idx.SerializeToFile(kMmapIndexPath) == knowhere::Status::success);
+        auto file_json = json;
+        file_json["enable_mmap"] = true;
+        status = loaded.DeserializeFromFile(kMmapIndexPath, file_json);
+    } else {
+        status = loaded.Deserialize(bs, json);
+    }
+    knowhere::SetHugePagePolicy(knowhere::HugePagePolicy::NONE);
+    REQUIRE(status == knowhere::Status::success);
+    REQUIRE(loaded.Count() == nb);
+    auto res = loaded.Search(query_ds, json, nullptr);
+    REQUIRE(res.has_value());
+    for (int64_t i = 0; i < nq * 10; i++) {
+        REQUIRE(res.value()->GetIds()[i] == expected_res.value()->GetIds()[i]);
+    }
+    std::remove(kMmapIndexPath);
+}
+
+TEST_CASE("Test Index Warmup", "[float metrics]") {
+    const int64_t nb = 2000, nq = 10;
+    const int64_t dim = 64;
+    auto version = GenTestVersionList();
+    auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                         knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = 10;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 4;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    json[knowhere::indexparam::EF] = 32;
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto expected_res = idx.Search(query_ds, json, nullptr);
+    REQUIRE(expected_res.has_value());
+
+    // called by the threads of the build pool
+    size_t done = 0, total = 0;
+    bool in_order = true;
+    auto progress = [&](size_t d, size_t t) {
+        in_order = in_order && d >= done && d <= t;
+        done = d;
+        total = t;
+    };
+
+    SECTION("in memory") {
+        // nothing is mapped, so nothing is warmed up nor cooled down
+        REQUIRE(idx.Warmup(knowhere::WarmupLevel::FULL, progress) == knowhere::Status::success);
+        REQUIRE(total == 0);
+        REQUIRE(idx.Cooldown() == knowhere::Status::success);
+    }
+
+    SECTION("mmap") {
+        std::remove(kMmapIndexPath);
+        REQUIRE(idx.SerializeToFile(kMmapIndexPath) == knowhere::Status::success);
+        auto file_json = json;
+        file_json["enable_mmap"] = true;
+        auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(loaded.DeserializeFromFile(kMmapIndexPath, file_json) == knowhere::Status::success);
+
+        REQUIRE(loaded.Warmup(knowhere::WarmupLevel::FULL, progress) == knowhere::Status::success);
+        REQUIRE(in_order);
+        REQUIRE(total >= nb * dim * sizeof(knowhere::fp32));
+        REQUIRE(done == total);
+        const size_t full_total = total;
+        REQUIRE(loaded.Cooldown() == knowhere::Status::success);
+        done = 0;
+        REQUIRE(loaded.Warmup(knowhere::WarmupLevel::HOT, progress) == knowhere::Status::success);
+        REQUIRE(in_order);
+        REQUIRE(total <= full_total);
+
+        auto res = loaded.Search(query_ds, json, nullptr);
+        REQUIRE(res.has_value());
+        for (int64_t i = 0; i < nq * 10; i++) {
+            REQUIRE(res.value()->GetIds()[i] == expected_res.value()->GetIds()[i]);
+        }
+        std::remove(kMmapIndexPath);
+    }
+}
+
+TEST_CASE("Test Index Memory Report", "[float metrics]") {
+    const int64_t nb = 2000;
+    const int64_t dim = 64;
+    auto version = GenTestVersionList();
+    auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                         knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_HNSW);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = 10;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 96;
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+    const size_t data_bytes = nb * dim * sizeof(knowhere::fp32);
+
+    auto check_components = [&](const knowhere::MemoryReport& report) {
+        const auto& raw = report.Get(knowhere::MemoryComponent::RAW_DATA);
+        REQUIRE(raw.heap_bytes + raw.mapped_bytes == data_bytes);
+        if (name == knowhere::IndexEnum::INDEX_HNSW) {
+            const auto& graph = report.Get(knowhere::MemoryComponent::GRAPH);
+            REQUIRE(graph.heap_bytes + graph.mapped_bytes > 0);
+        }
+        if (name == knowhere::IndexEnum::INDEX_FAISS_IVFFLAT) {
+            REQUIRE(report.Get(knowhere::MemoryComponent::CENTROIDS).heap_bytes == 16 * dim * sizeof(knowhere::fp32));
+            const auto& ids = report.Get(knowhere::MemoryComponent::ID_MAP);
+            REQUIRE(ids.heap_bytes + ids.mapped_bytes == nb * sizeof(int64_t));
+        }
+    };
+
+    SECTION("in memory") {
+        auto report = idx.GetMemoryReport();
+        REQUIRE(report.has_value());
+        check_components(report.value());
+        REQUIRE(report.value().Total().mapped_bytes == 0);
+        REQUIRE(idx.ExportMemoryReport("test_index_memory_report") == knowhere::Status::success);
+        knowhere::RemoveMemoryReport("test_index_memory_report");
+    }
+
+    SECTION("mmap") {
+        std::remove(kMmapIndexPath);
+        REQUIRE(idx.SerializeToFile(kMmapIndexPath) == knowhere::Status::success);
+        auto file_json = json;
+        file_json["enable_mmap"] = true;
+        auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(loaded.DeserializeFromFile(kMmapIndexPath, file_json) == knowhere::Status::success);
+        REQUIRE(loaded.Warmup(knowhere::WarmupLevel::FULL, nullptr) == knowhere::Status::success);
+
+        auto report = loaded.GetMemoryReport();
+        REQUIRE(report.has_value());
+        check_components(report.value());
+        const auto total = report.value().Total();
+        REQUIRE(total.mapped_bytes >= data_bytes);
+        REQUIRE(total.mapped_resident_bytes <= total.mapped_bytes);
+        std::remove(kMmapIndexPath);
+    }
+}
+
+TEST_CASE("Test Mmap Access Profiles", "[float metrics]") {
+    const int64_t nb = 2000, nq = 10;
+    const int64_t dim = 64;
+    auto version = GenTestVersionList();
+    auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                         knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, knowhere::IndexEnum::INDEX_FAISS_IVFSQ8,
+                         knowhere::IndexEnum::INDEX_HNSW);
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = 10;
+    json[knowhere::indexparam::NLIST] = 16;
+    json[knowhere::indexparam::NPROBE] = 4;
+    json[knowhere::indexparam::HNSW_M] = 16;
+    json[knowhere::indexparam::EFCONSTRUCTION] = 96;
+    json[knowhere::indexparam::EF] = 32;
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    REQUIRE(idx.Build(GenDataSet(nb, dim), json) == knowhere::Status::success);
+    const auto query_ds = GenDataSet(nq, dim, 43);
+    auto expected_res = idx.Search(query_ds, json, nullptr);
+    REQUIRE(expected_res.has_value());
+
+    // the mapped index is advised of its access pattern on load, which must not change the results
+    std::remove(kMmapIndexPath);
+    REQUIRE(idx.SerializeToFile(kMmapIndexPath) == knowhere::Status::success);
+    auto file_json = json;
+    file_json["enable_mmap"] = true;
+    auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    REQUIRE(loaded.DeserializeFromFile(kMmapIndexPath, file_json) == knowhere::Status::success);
+    auto res = loaded.Search(query_ds, json, nullptr);
+    REQUIRE(res.has_value());
+    for (int64_t i = 0; i < nq * 10; i++) {
+        REQUIRE(res.value()->GetIds()[i] == expected_res.value()->GetIds()[i]);
+    }
+    std::remove(kMmapIndexPath);
+}
+
 TEST_CASE("Test Mem Index With Binary Vector", "[float metrics]") {
     using Catch::Approx;
 
@@ -603,6 +2108,7 @@ TEST_CASE("Test Mem Index With Binary Vector", "[float metrics]") {
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_BIN_IDMAP, flat_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_BIN_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_BIN_HNSW, hnsw_gen),
 #ifdef KNOWHERE_WITH_CARDINAL
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
 #endif
@@ -647,6 +2153,7 @@ TEST_CASE("Test Mem Index With Binary Vector", "[float metrics]") {
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_BIN_IDMAP, flat_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_BIN_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_BIN_HNSW, hnsw_gen),
         }));
 
         auto idx = knowhere::IndexFactory::Instance().Create<knowhere::bin1>(name, version).value();
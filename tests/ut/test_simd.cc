@@ -90,7 +90,198 @@ TEST_CASE("Test minhash function") {
         CHECK_EQ(res_dis[2], gt_ids[2]);
         CHECK_EQ(res_dis[3], gt_ids[3]);
     }
+    SECTION("test minhash batch_16 distance") {
+        auto dim = GENERATE(as<size_t>{}, 1, 2, 7, 8, 9, 15, 16, 17, 31, 64, 100, 256);
+        auto u64_x = GenRandomVector<uint64_t>(dim, 16, seed);
+        auto u64_y = GenRandomVector<uint64_t>(dim, 1, seed + 222);
+        auto u32_x = GenRandomVector<uint32_t>(dim, 16, seed);
+        auto u32_y = GenRandomVector<uint32_t>(dim, 1, seed + 222);
+        // element i of the query matches the signature i % 16
+        for (size_t i = 0; i < dim; i++) {
+            u64_y[i] = u64_x[(i % 16) * dim + i];
+            u32_y[i] = u32_x[(i % 16) * dim + i];
+        }
+        const char* u64_rows[16];
+        const char* u32_rows[16];
+        for (size_t j = 0; j < 16; j++) {
+            u64_rows[j] = (const char*)(u64_x.get() + j * dim);
+            u32_rows[j] = (const char*)(u32_x.get() + j * dim);
+        }
+        float res_dis[16], gt_dis[16];
+        faiss::u64_jaccard_distance_batch_16((const char*)u64_y.get(), u64_rows, dim, 8, res_dis);
+        faiss::u64_jaccard_distance_batch_16_ref((const char*)u64_y.get(), u64_rows, dim, 8, gt_dis);
+        for (size_t j = 0; j < 16; j++) {
+            CHECK_EQ(res_dis[j], gt_dis[j]);
+        }
+        faiss::u32_jaccard_distance_batch_16((const char*)u32_y.get(), u32_rows, dim, 4, res_dis);
+        faiss::u32_jaccard_distance_batch_16_ref((const char*)u32_y.get(), u32_rows, dim, 4, gt_dis);
+        for (size_t j = 0; j < 16; j++) {
+            CHECK_EQ(res_dis[j], gt_dis[j]);
+        }
+    }
 }
+
+TEST_CASE("Test sparse scatter madd") {
+    auto simd_type = knowhere::KnowhereConfig::SimdType::AVX512;
+    knowhere::KnowhereConfig::SetSimdType(simd_type);
+    auto n = GENERATE(as<size_t>{}, 1, 15, 16, 17, 100, 1000);
+    const uint32_t base = 100;
+    const size_t acc_size = 4 * n;
+    const float q = 0.7f;
+
+    // sorted unique doc ids in [base, base + acc_size), as in a posting list
+    std::mt19937 rng(42);
+    std::vector<uint32_t> ids;
+    for (uint32_t id = base; id < base + acc_size && ids.size() < n; ++id) {
+        if (rng() % 4 == 0 || base + acc_size - id == n - ids.size()) {
+            ids.push_back(id);
+        }
+    }
+    auto vals = GenRandomVector<float>(n, 1, 111);
+
+    std::vector<float> acc(acc_size, 1.0f), ref_acc(acc_size, 1.0f);
+    faiss::fvec_scatter_madd(acc.data(), ids.data(), vals.get(), n, q, base);
+    faiss::fvec_scatter_madd_ref(ref_acc.data(), ids.data(), vals.get(), n, q, base);
+    for (size_t i = 0; i < acc_size; ++i) {
+        REQUIRE_THAT(acc[i], Catch::Matchers::WithinAbs(ref_acc[i], 0.001));
+    }
+}
+
+TEST_CASE("Test sparse lower bound") {
+    auto simd_type = knowhere::KnowhereConfig::SimdType::AVX512;
+    knowhere::KnowhereConfig::SetSimdType(simd_type);
+    auto n = GENERATE(as<size_t>{}, 0, 1, 15, 16, 17, 64, 100);
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> data(n);
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<uint32_t>(rng() % 1000) + (1U << 31);
+    }
+    std::sort(data.begin(), data.end());
+    for (uint32_t key : {0U, 1U << 31, (1U << 31) + 500, (1U << 31) + 1000, 0xFFFFFFFFU}) {
+        CHECK(faiss::u32_lower_bound(data.data(), n, key) == faiss::u32_lower_bound_ref(data.data(), n, key));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        CHECK(faiss::u32_lower_bound(data.data(), n, data[i]) == faiss::u32_lower_bound_ref(data.data(), n, data[i]));
+    }
+}
+
+TEST_CASE("Test sparse ip") {
+    auto simd_type = knowhere::KnowhereConfig::SimdType::AVX512;
+    knowhere::KnowhereConfig::SetSimdType(simd_type);
+    auto nx = GENERATE(as<size_t>{}, 0, 1, 7, 8, 9, 30, 100);
+    auto ny = GENERATE(as<size_t>{}, 0, 1, 8, 17, 150);
+
+    // sorted unique ids out of a small vocabulary, so that the rows share many of them
+    std::mt19937 rng(42);
+    auto gen_row = [&](size_t n) {
+        std::vector<std::pair<uint32_t, float>> row;
+        for (uint32_t id = 0; row.size() < n; ++id) {
+            if (rng() % 3 == 0 || 4 * n - id == n - row.size()) {
+                row.emplace_back(id, (float)(rng() % 100) / 10.0f);
+            }
+        }
+        return row;
+    };
+    const auto x = gen_row(nx);
+    const auto y = gen_row(ny);
+    CHECK(faiss::sparse_ip(x.data(), nx, y.data(), ny) ==
+          Catch::Approx(faiss::sparse_ip_ref(x.data(), nx, y.data(), ny)).epsilon(0.0001));
+}
+
+TEST_CASE("Test sparse dense ip") {
+    auto simd_type = knowhere::KnowhereConfig::SimdType::AVX512;
+    knowhere::KnowhereConfig::SetSimdType(simd_type);
+    auto nx = GENERATE(as<size_t>{}, 0, 1, 7, 8, 9, 16, 17, 30, 100);
+    auto dim = GENERATE(as<size_t>{}, 1, 50, 1000);
+
+    // ids beyond dim count as zeros of the dense vector
+    std::mt19937 rng(42);
+    std::vector<std::pair<uint32_t, float>> x;
+    for (uint32_t id = 0; x.size() < nx; id += 1 + rng() % 20) {
+        x.emplace_back(id, (float)(rng() % 100) / 10.0f);
+    }
+    std::vector<float> y(dim);
+    for (auto& v : y) {
+        v = (float)(rng() % 100) / 10.0f;
+    }
+    CHECK(faiss::sparse_dense_ip(x.data(), nx, y.data(), dim) ==
+          Catch::Approx(faiss::sparse_dense_ip_ref(x.data(), nx, y.data(), dim)).epsilon(0.0001));
+}
+
+TEST_CASE("Test binary distance") {
+    auto simd_type = GENERATE(as<knowhere::KnowhereConfig::SimdType>{}, knowhere::KnowhereConfig::SimdType::AVX512,
+                              knowhere::KnowhereConfig::SimdType::AVX2, knowhere::KnowhereConfig::SimdType::SSE4_2,
+                              knowhere::KnowhereConfig::SimdType::GENERIC, knowhere::KnowhereConfig::SimdType::AUTO);
+    auto code_size = GENERATE(as<size_t>{}, 1, 7, 8, 16, 20, 31, 32, 33, 64, 65, 100, 128, 256, 512, 515);
+    knowhere::KnowhereConfig::SetSimdType(simd_type);
+
+    std::mt19937 rng(42);
+    std::vector<uint8_t> x(code_size), y(4 * code_size);
+    for (auto& v : x) {
+        v = (uint8_t)rng();
+    }
+    for (auto& v : y) {
+        v = (uint8_t)rng();
+    }
+    const uint8_t* y0 = y.data();
+    const uint8_t* y1 = y0 + code_size;
+    const uint8_t* y2 = y1 + code_size;
+    const uint8_t* y3 = y2 + code_size;
+
+    CHECK_EQ(faiss::bvec_hamming_distance(x.data(), x.data(), code_size), 0);
+    CHECK_EQ(faiss::bvec_hamming_distance(x.data(), y0, code_size),
+             faiss::bvec_hamming_distance_ref(x.data(), y0, code_size));
+    CHECK_EQ(faiss::bvec_jaccard_distance(x.data(), x.data(), code_size), 0.0f);
+    CHECK_EQ(faiss::bvec_jaccard_distance(x.data(), y0, code_size),
+             faiss::bvec_jaccard_distance_ref(x.data(), y0, code_size));
+
+    int res_ham[4], gt_ham[4];
+    faiss::bvec_hamming_distance_batch_4(x.data(), y0, y1, y2, y3, code_size, res_ham[0], res_ham[1], res_ham[2],
+                                         res_ham[3]);
+    faiss::bvec_hamming_distance_batch_4_ref(x.data(), y0, y1, y2, y3, code_size, gt_ham[0], gt_ham[1], gt_ham[2],
+                                             gt_ham[3]);
+    float res_jac[4], gt_jac[4];
+    faiss::bvec_jaccard_distance_batch_4(x.data(), y0, y1, y2, y3, code_size, res_jac[0], res_jac[1], res_jac[2],
+                                         res_jac[3]);
+    faiss::bvec_jaccard_distance_batch_4_ref(x.data(), y0, y1, y2, y3, code_size, gt_jac[0], gt_jac[1], gt_jac[2],
+                                             gt_jac[3]);
+    for (size_t i = 0; i < 4; i++) {
+        CHECK_EQ(res_ham[i], gt_ham[i]);
+        CHECK_EQ(res_jac[i], gt_jac[i]);
+    }
+}
+
+TEST_CASE("Test int8 by uint8 inner product") {
+    auto simd_type = GENERATE(as<knowhere::KnowhereConfig::SimdType>{}, knowhere::KnowhereConfig::SimdType::AVX512,
+                              knowhere::KnowhereConfig::SimdType::AVX2, knowhere::KnowhereConfig::SimdType::SSE4_2,
+                              knowhere::KnowhereConfig::SimdType::GENERIC, knowhere::KnowhereConfig::SimdType::AUTO);
+    auto dim = GENERATE(as<size_t>{}, 1, 7, 8, 16, 31, 63, 64, 65, 128, 200, 960);
+    knowhere::KnowhereConfig::SetSimdType(simd_type);
+
+    // the ends of both ranges are included, the products must stay exact for them
+    std::mt19937 rng(42);
+    std::vector<int8_t> x(dim);
+    std::vector<uint8_t> y(4 * dim);
+    for (auto& v : x) {
+        v = (int8_t)rng();
+    }
+    for (auto& v : y) {
+        v = (uint8_t)rng();
+    }
+    x[0] = -128;
+    y[0] = 255;
+    const uint8_t* y0 = y.data();
+
+    CHECK_EQ(faiss::s8u8_inner_product(x.data(), y0, dim), faiss::s8u8_inner_product_ref(x.data(), y0, dim));
+    int32_t res[4];
+    faiss::s8u8_inner_product_batch_4(x.data(), y0, y0 + dim, y0 + 2 * dim, y0 + 3 * dim, dim, res[0], res[1], res[2],
+                                      res[3]);
+    for (size_t i = 0; i < 4; i++) {
+        CHECK_EQ(res[i], faiss::s8u8_inner_product_ref(x.data(), y0 + i * dim, dim));
+    }
+}
+
 TEST_CASE("Test distance") {
     using Catch::Approx;
     auto simd_type = GENERATE(as<knowhere::KnowhereConfig::SimdType>{}, knowhere::KnowhereConfig::SimdType::AVX512,
@@ -101,7 +292,7 @@ TEST_CASE("Test distance") {
     LOG_KNOWHERE_INFO_ << "simd type: " << simd_type << ", dim: " << dim;
     knowhere::KnowhereConfig::SetSimdType(simd_type);
 
-    const size_t nx = 1, ny = 4;
+    const size_t nx = 1, ny = 8;
 
     // fp32's accuracy is 0.000001, consider the accumulation of precision loss
     const float tolerance = 0.000005f;
@@ -150,6 +341,26 @@ TEST_CASE("Test distance") {
             REQUIRE_THAT(faiss::fvec_L1(x_data, y_data, dim), Catch::Matchers::WithinRel(ref_L1[i], tolerance));
             REQUIRE_THAT(faiss::fvec_Linf(x_data, y_data, dim), Catch::Matchers::WithinRel(ref_Linf[i], tolerance));
             REQUIRE_THAT(faiss::fvec_norm_L2sqr(y_data, dim), Catch::Matchers::WithinRel(ref_norm_L2sqr[i], tolerance));
+            REQUIRE_THAT(faiss::fvec_inner_product_for_dim(dim)(x_data, y_data, dim),
+                         Catch::Matchers::WithinRel(ref_ip[i], tolerance));
+            REQUIRE_THAT(faiss::fvec_L2sqr_for_dim(dim)(x_data, y_data, dim),
+                         Catch::Matchers::WithinRel(ref_L2sqr[i], tolerance));
+        }
+
+        // float, by ids
+        std::vector<int32_t> ids(ny);
+        for (size_t i = 0; i < ny; i++) {
+            ids[i] = ny - 1 - i;
+        }
+        std::vector<float> ip_by_ids(ny), L2sqr_by_ids(ny);
+        faiss::fvec_inner_product_by_ids_for_dim(dim)(x.get(), y.get(), dim, ids.data(), ny, 2, ip_by_ids.data());
+        faiss::fvec_L2sqr_by_ids_for_dim(dim)(x.get(), y.get(), dim, ids.data(), ny, 2, L2sqr_by_ids.data());
+        for (size_t i = 0; i < ny; i++) {
+            const float* y_data = y.get() + ids[i] * dim;
+            REQUIRE_THAT(ip_by_ids[i],
+                         Catch::Matchers::WithinRel(faiss::fvec_inner_product_ref(x.get(), y_data, dim), tolerance));
+            REQUIRE_THAT(L2sqr_by_ids[i],
+                         Catch::Matchers::WithinRel(faiss::fvec_L2sqr_ref(x.get(), y_data, dim), tolerance));
         }
 
         // fp16
@@ -201,6 +412,35 @@ TEST_CASE("Test distance") {
         }
     }
 
+    SECTION("test int8 distance calculation at the ends of the range") {
+        // the vnni kernels shift the values by 128, which must stay exact for -128 and 127
+        const std::vector<std::pair<int8_t, int8_t>> values{{-128, -128}, {-128, 127}, {127, 127}};
+        for (const auto& [x_value, y_value] : values) {
+            const std::vector<knowhere::int8> x_data(dim, x_value);
+            std::vector<knowhere::int8> y_data(4 * dim, y_value);
+            y_data[dim / 2] = 0;
+            const knowhere::int8* y0 = y_data.data();
+
+            CHECK(faiss::int8_vec_inner_product(x_data.data(), y0, dim) ==
+                  faiss::int8_vec_inner_product_ref(x_data.data(), y0, dim));
+            CHECK(faiss::int8_vec_L2sqr(x_data.data(), y0, dim) == faiss::int8_vec_L2sqr_ref(x_data.data(), y0, dim));
+            CHECK(faiss::int8_vec_norm_L2sqr(y0, dim) == faiss::int8_vec_norm_L2sqr_ref(y0, dim));
+            CHECK(faiss::ivec_inner_product(x_data.data(), y0, dim) ==
+                  faiss::ivec_inner_product_ref(x_data.data(), y0, dim));
+            CHECK(faiss::ivec_L2sqr(x_data.data(), y0, dim) == faiss::ivec_L2sqr_ref(x_data.data(), y0, dim));
+
+            std::vector<float> ip_batch_4(4), l2_batch_4(4);
+            faiss::int8_vec_inner_product_batch_4(x_data.data(), y0, y0 + dim, y0 + 2 * dim, y0 + 3 * dim, dim,
+                                                  ip_batch_4[0], ip_batch_4[1], ip_batch_4[2], ip_batch_4[3]);
+            faiss::int8_vec_L2sqr_batch_4(x_data.data(), y0, y0 + dim, y0 + 2 * dim, y0 + 3 * dim, dim, l2_batch_4[0],
+                                          l2_batch_4[1], l2_batch_4[2], l2_batch_4[3]);
+            for (size_t i = 0; i < 4; i++) {
+                CHECK(ip_batch_4[i] == faiss::int8_vec_inner_product_ref(x_data.data(), y0 + i * dim, dim));
+                CHECK(l2_batch_4[i] == faiss::int8_vec_L2sqr_ref(x_data.data(), y0 + i * dim, dim));
+            }
+        }
+    }
+
     // obsolete
     SECTION("test single distance calculation for hnsw sq") {
         // calculate the int32 result ref
@@ -351,6 +591,32 @@ TEST_CASE("Test distance") {
         }
     }
 
+    SECTION("test batch_8 distance calculation") {
+        const float* x_data = x.get();
+        std::vector<const float*> y_data;
+        for (size_t i = 0; i < 8; i++) {
+            y_data.push_back(y.get() + i * dim);
+        }
+
+        // calculate the float result ref
+        std::vector<float> ref_ip_batch_8(8);
+        faiss::fvec_inner_product_batch_8_ref(x_data, y_data[0], y_data[1], y_data[2], y_data[3], y_data[4], y_data[5],
+                                              y_data[6], y_data[7], dim, ref_ip_batch_8[0], ref_ip_batch_8[1],
+                                              ref_ip_batch_8[2], ref_ip_batch_8[3], ref_ip_batch_8[4],
+                                              ref_ip_batch_8[5], ref_ip_batch_8[6], ref_ip_batch_8[7]);
+
+        std::vector<float> ip_batch_8(8);
+        faiss::fvec_inner_product_batch_8(x_data, y_data[0], y_data[1], y_data[2], y_data[3], y_data[4], y_data[5],
+                                          y_data[6], y_data[7], dim, ip_batch_8[0], ip_batch_8[1], ip_batch_8[2],
+                                          ip_batch_8[3], ip_batch_8[4], ip_batch_8[5], ip_batch_8[6], ip_batch_8[7]);
+
+        for (size_t i = 0; i < 8; i++) {
+            REQUIRE_THAT(ip_batch_8[i], Catch::Matchers::WithinRel(ref_ip_batch_8[i], tolerance));
+            REQUIRE_THAT(ip_batch_8[i],
+                         Catch::Matchers::WithinRel(faiss::fvec_inner_product_ref(x_data, y_data[i], dim), tolerance));
+        }
+    }
+
     SECTION("test ny distance calculation") {
         // calculate the float result ref
         auto ref_ip = std::make_unique<float[]>(ny);
@@ -436,3 +702,38 @@ TEST_CASE("Test distance") {
         run_test();
     }
 }
+
+TEST_CASE("Test simd kernel calibration") {
+    auto simd_type = GENERATE(as<knowhere::KnowhereConfig::SimdType>{}, knowhere::KnowhereConfig::SimdType::AVX2,
+                              knowhere::KnowhereConfig::SimdType::AUTO);
+    knowhere::KnowhereConfig::SetSimdType(simd_type);
+    const auto choices = knowhere::KnowhereConfig::CalibrateSimdKernels();
+    LOG_KNOWHERE_INFO_ << "simd type: " << simd_type << ", calibrated: " << choices;
+    if (simd_type == knowhere::KnowhereConfig::SimdType::AVX2) {
+        REQUIRE(choices.find("avx512") == std::string::npos);
+    }
+
+    // the dims fall in every bucket, on both sides of the bounds
+    for (const size_t dim : {1, 7, 32, 33, 100, 128, 129, 512, 513, 2048, 3000}) {
+        const auto x = GenRandomVector<float>(dim, 1, 314);
+        const auto y = GenRandomVector<float>(dim, 1, 271);
+        const auto x_int8 = ConvertVector<knowhere::int8>(x.get(), 1, dim);
+        const auto y_int8 = ConvertVector<knowhere::int8>(y.get(), 1, dim);
+        const auto x_fp16 = ConvertVector<knowhere::fp16>(x.get(), 1, dim);
+        const auto y_fp16 = ConvertVector<knowhere::fp16>(y.get(), 1, dim);
+
+        REQUIRE_THAT(faiss::fvec_inner_product(x.get(), y.get(), dim),
+                     Catch::Matchers::WithinRel(faiss::fvec_inner_product_ref(x.get(), y.get(), dim), 0.00001f));
+        REQUIRE_THAT(faiss::fvec_L2sqr(x.get(), y.get(), dim),
+                     Catch::Matchers::WithinRel(faiss::fvec_L2sqr_ref(x.get(), y.get(), dim), 0.00001f));
+        REQUIRE_THAT(faiss::fp16_vec_L2sqr(x_fp16.get(), y_fp16.get(), dim),
+                     Catch::Matchers::WithinRel(faiss::fp16_vec_L2sqr_ref(x_fp16.get(), y_fp16.get(), dim), 0.004f));
+        CHECK(faiss::int8_vec_inner_product(x_int8.get(), y_int8.get(), dim) ==
+              faiss::int8_vec_inner_product_ref(x_int8.get(), y_int8.get(), dim));
+        CHECK(faiss::int8_vec_L2sqr(x_int8.get(), y_int8.get(), dim) ==
+              faiss::int8_vec_L2sqr_ref(x_int8.get(), y_int8.get(), dim));
+        CHECK(faiss::int8_vec_norm_L2sqr(x_int8.get(), dim) == faiss::int8_vec_norm_L2sqr_ref(x_int8.get(), dim));
+    }
+
+    knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO);
+}
@@ -9,17 +9,23 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <cmath>
+#include <cstring>
 #include <future>
 #include <thread>
+#include <unordered_map>
 
+#include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "index/sparse/sparse_dim_map.h"
 #include "knowhere/bitsetview.h"
 #include "knowhere/comp/brute_force.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/comp/knowhere_check.h"
 #include "knowhere/comp/knowhere_config.h"
 #include "knowhere/index/index_factory.h"
+#include "knowhere/sparse_utils.h"
 #include "utils.h"
 
 void
@@ -47,7 +53,11 @@ TEST_CASE("Test Mem Sparse Index With Float Vector", "[float metrics]") {
 
     auto metric = GENERATE(knowhere::metric::IP, knowhere::metric::BM25);
 
-    auto inverted_index_algo = GENERATE("TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE");
+    auto inverted_index_algo = GENERATE("TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE", "DAAT_BMW");
+
+    auto posting_list_compression = GENERATE(false, true);
+
+    auto doc_id_reordering = GENERATE(false, true);
 
     auto drop_ratio_search = metric == knowhere::metric::BM25 ? GENERATE(0.0, 0.1) : GENERATE(0.0, 0.3);
 
@@ -65,10 +75,14 @@ TEST_CASE("Test Mem Sparse Index With Float Vector", "[float metrics]") {
     };
 
     auto sparse_inverted_index_gen = [base_gen, drop_ratio_search = drop_ratio_search,
-                                      inverted_index_algo = inverted_index_algo]() {
+                                      inverted_index_algo = inverted_index_algo,
+                                      posting_list_compression = posting_list_compression,
+                                      doc_id_reordering = doc_id_reordering]() {
         knowhere::Json json = base_gen();
         json[knowhere::indexparam::DROP_RATIO_SEARCH] = drop_ratio_search;
         json[knowhere::indexparam::INVERTED_INDEX_ALGO] = inverted_index_algo;
+        json[knowhere::indexparam::POSTING_LIST_COMPRESSION] = posting_list_compression;
+        json[knowhere::indexparam::DOC_ID_REORDERING] = doc_id_reordering;
         return json;
     };
 
@@ -321,6 +335,466 @@ TEST_CASE("Test Mem Sparse Index With Float Vector", "[float metrics]") {
         // most above 0.95, only a few between 0.9 and 0.83
         REQUIRE(actual_count * 1.0f / gt_count >= 0.83);
     }
+
+    SECTION("Test Sparse Range Search with Bitset") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, sparse_inverted_index_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_inverted_index_gen),
+        }));
+
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        json[knowhere::meta::RADIUS] = metric == knowhere::metric::BM25 ? 80.0 : 0.5;
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+
+        auto results = idx.RangeSearch(query_ds, json, bitset);
+        REQUIRE(results.has_value());
+        auto gt =
+            knowhere::BruteForce::RangeSearch<knowhere::sparse::SparseRow<float>>(train_ds, query_ds, json, bitset);
+        REQUIRE(gt.has_value());
+
+        auto ids = results.value()->GetIds();
+        auto lims = results.value()->GetLims();
+        auto ids_gt = gt.value()->GetIds();
+        auto lims_gt = gt.value()->GetLims();
+        size_t actual_count = 0;
+        for (int i = 0; i < nq; ++i) {
+            std::unordered_set<int64_t> gt_ids(ids_gt + lims_gt[i], ids_gt + lims_gt[i + 1]);
+            for (size_t j = lims[i]; j < lims[i + 1]; ++j) {
+                REQUIRE(!bitset.test(ids[j]));
+                actual_count += gt_ids.count(ids[j]);
+            }
+        }
+        // the radius prunes the posting lists without losing any result unless the query itself is pruned
+        auto drop_ratio_search = json[knowhere::indexparam::DROP_RATIO_SEARCH].get<float>();
+        if (drop_ratio_search == 0) {
+            REQUIRE(actual_count >= lims_gt[nq] * 0.99);
+        } else {
+            REQUIRE(actual_count >= lims_gt[nq] * 0.8);
+        }
+    }
+}
+
+TEST_CASE("Test Mem Sparse Index Batch Search", "[float metrics]") {
+    auto nb = 2000;
+    auto dim = 300;
+    auto topk = 5;
+    // enough queries per search thread for the queries to be searched in batches.
+    int64_t nq = knowhere::KnowhereConfig::GetSearchThreadPoolSize() * 8;
+
+    auto metric = GENERATE(knowhere::metric::IP, knowhere::metric::BM25);
+    auto posting_list_compression = GENERATE(false, true);
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::meta::BM25_K1] = 1.2;
+    json[knowhere::meta::BM25_B] = 0.75;
+    json[knowhere::meta::BM25_AVGDL] = 100;
+    json[knowhere::indexparam::INVERTED_INDEX_ALGO] = "TAAT_NAIVE";
+    json[knowhere::indexparam::POSTING_LIST_COMPRESSION] = posting_list_compression;
+
+    auto sparse_dataset_gen = [&](int nr, int dim, float sparsity) -> knowhere::DataSetPtr {
+        if (metric == knowhere::metric::BM25) {
+            return GenSparseDataSetWithMaxVal(nr, dim, sparsity, 256, true);
+        } else {
+            return GenSparseDataSet(nr, dim, sparsity);
+        }
+    };
+    auto train_ds = sparse_dataset_gen(nb, dim, 0.95);
+    auto query_ds = sparse_dataset_gen(nq, dim, 0.97);
+
+    auto idx = knowhere::IndexFactory::Instance()
+                   .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, version)
+                   .value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+    knowhere::BinarySet bs;
+    REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+    REQUIRE(idx.Deserialize(bs, json) == knowhere::Status::success);
+
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+    knowhere::BitsetView bitset(bitset_data.data(), nb);
+    auto filtered = GENERATE(false, true);
+
+    auto gt = knowhere::BruteForce::SearchSparse(train_ds, query_ds, json, filtered ? bitset : nullptr);
+    auto results = idx.Search(query_ds, json, filtered ? bitset : nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) == 1);
+}
+
+TEST_CASE("Test Mem Sparse Index BM25 Impacts", "[float metrics]") {
+    auto nb = 2000;
+    auto nq = 20;
+    auto dim = 300;
+    auto topk = 10;
+
+    auto inverted_index_algo = GENERATE("TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE", "DAAT_BMW");
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::BM25;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::meta::BM25_K1] = 1.2;
+    json[knowhere::meta::BM25_B] = 0.75;
+    json[knowhere::meta::BM25_AVGDL] = 100;
+    json[knowhere::indexparam::INVERTED_INDEX_ALGO] = inverted_index_algo;
+    json[knowhere::indexparam::BM25_PRECOMPUTE_IMPACTS] = true;
+
+    auto train_ds = GenSparseDataSetWithMaxVal(nb, dim, 0.95, 256, true);
+    auto query_ds = GenSparseDataSetWithMaxVal(nq, dim, 0.97, 256, true);
+
+    auto idx = knowhere::IndexFactory::Instance()
+                   .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, version)
+                   .value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+    knowhere::BinarySet bs;
+    REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+    REQUIRE(idx.Deserialize(bs, json) == knowhere::Status::success);
+
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+    knowhere::BitsetView bitset(bitset_data.data(), nb);
+    auto filtered = GENERATE(false, true);
+
+    // the impacts are quantized, so only the order of the docs with nearly equal scores may change.
+    auto gt = knowhere::BruteForce::SearchSparse(train_ds, query_ds, json, filtered ? bitset : nullptr);
+    auto results = idx.Search(query_ds, json, filtered ? bitset : nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.9);
+    auto ids = results.value()->GetIds();
+    for (int64_t i = 0; i < nq * topk; ++i) {
+        REQUIRE((ids[i] < 0 || !filtered || !bitset.test(ids[i])));
+    }
+
+    // the impacts were computed with the load time k1 and b.
+    json[knowhere::meta::BM25_K1] = 1.5;
+    REQUIRE_FALSE(idx.Search(query_ds, json, nullptr).has_value());
+}
+
+TEST_CASE("Test Mem Sparse Index Term Pruning", "[float metrics]") {
+    // long queries, most of whose terms hardly change the top-k.
+    auto nb = 2000;
+    auto nq = 20;
+    auto dim = 3000;
+    auto topk = 10;
+
+    auto metric = GENERATE(knowhere::metric::IP, knowhere::metric::BM25);
+    auto inverted_index_algo = GENERATE("TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE", "DAAT_BMW");
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::meta::BM25_K1] = 1.2;
+    json[knowhere::meta::BM25_B] = 0.75;
+    json[knowhere::meta::BM25_AVGDL] = 100;
+    json[knowhere::indexparam::INVERTED_INDEX_ALGO] = inverted_index_algo;
+
+    auto sparse_dataset_gen = [&](int nr, int dim, float sparsity) -> knowhere::DataSetPtr {
+        if (metric == knowhere::metric::BM25) {
+            return GenSparseDataSetWithMaxVal(nr, dim, sparsity, 256, true);
+        } else {
+            return GenSparseDataSet(nr, dim, sparsity);
+        }
+    };
+    auto train_ds = sparse_dataset_gen(nb, dim, 0.97);
+    auto query_ds = sparse_dataset_gen(nq, dim, 0.9);
+
+    auto idx = knowhere::IndexFactory::Instance()
+                   .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, version)
+                   .value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+    auto gt = knowhere::BruteForce::SearchSparse(train_ds, query_ds, json, nullptr);
+
+    json[knowhere::indexparam::TERM_PRUNING_RATIO] = 0.0;
+    auto results = idx.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    REQUIRE(GetKNNRecall(*gt.value(), *results.value()) == 1);
+
+    // TAAT_NAIVE does not prune the terms.
+    json[knowhere::indexparam::TERM_PRUNING_RATIO] = 0.05;
+    results = idx.Search(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    auto recall = GetKNNRecall(*gt.value(), *results.value());
+    if (std::string(inverted_index_algo) == "TAAT_NAIVE") {
+        REQUIRE(recall == 1);
+    } else {
+        REQUIRE(recall >= 0.8);
+    }
+
+    json[knowhere::indexparam::TERM_PRUNING_RATIO] = 1.0;
+    REQUIRE_FALSE(idx.Search(query_ds, json, nullptr).has_value());
+}
+
+TEST_CASE("Test Mem Sparse Index Parallel Build", "[float metrics]") {
+    // enough rows for Add() to build the posting lists in parallel.
+    auto nb = 20000;
+    auto dim = 1000;
+    auto batch_size = 1000;
+
+    auto metric = GENERATE(knowhere::metric::IP, knowhere::metric::BM25);
+    auto inverted_index_algo = GENERATE("TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE", "DAAT_BMW");
+    auto version = GenTestVersionList();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = metric;
+    json[knowhere::meta::BM25_K1] = 1.2;
+    json[knowhere::meta::BM25_B] = 0.75;
+    json[knowhere::meta::BM25_AVGDL] = 100;
+    json[knowhere::indexparam::INVERTED_INDEX_ALGO] = inverted_index_algo;
+
+    auto train_ds = metric == knowhere::metric::BM25 ? GenSparseDataSetWithMaxVal(nb, dim, 0.99, 256, true)
+                                                     : GenSparseDataSet(nb, dim, 0.99);
+    auto rows = static_cast<const knowhere::sparse::SparseRow<float>*>(train_ds->GetTensor());
+    auto batch_ds = [&](int64_t begin) {
+        auto ds = knowhere::GenDataSet(std::min<int64_t>(batch_size, nb - begin), dim, rows + begin);
+        ds->SetIsOwner(false);
+        ds->SetIsSparse(true);
+        return ds;
+    };
+
+    auto parallel_idx = knowhere::IndexFactory::Instance()
+                            .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, version)
+                            .value();
+    REQUIRE(parallel_idx.Build(train_ds, json) == knowhere::Status::success);
+
+    // batches too small to be built in parallel
+    auto serial_idx = knowhere::IndexFactory::Instance()
+                          .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, version)
+                          .value();
+    REQUIRE(serial_idx.Build(batch_ds(0), json) == knowhere::Status::success);
+    for (int64_t begin = batch_size; begin < nb; begin += batch_size) {
+        REQUIRE(serial_idx.Add(batch_ds(begin), json) == knowhere::Status::success);
+    }
+    REQUIRE(serial_idx.Count() == nb);
+
+    knowhere::BinarySet parallel_bs, serial_bs;
+    REQUIRE(parallel_idx.Serialize(parallel_bs) == knowhere::Status::success);
+    REQUIRE(serial_idx.Serialize(serial_bs) == knowhere::Status::success);
+    auto parallel_binary = parallel_bs.GetByName(parallel_idx.Type());
+    auto serial_binary = serial_bs.GetByName(serial_idx.Type());
+    REQUIRE(parallel_binary->size == serial_binary->size);
+    REQUIRE(std::memcmp(parallel_binary->data.get(), serial_binary->data.get(), parallel_binary->size) == 0);
+}
+
+TEST_CASE("Test Sparse ChunkedGrowableVector", "[float metrics]") {
+    auto chunk_elements = GENERATE(1, 1000, 1024);
+    knowhere::sparse::ChunkedGrowableVector<uint32_t> vec("/tmp/knowhere_sparse_chunked_growable_vector_test",
+                                                          chunk_elements);
+    const uint32_t n = 5000;
+    std::vector<const uint32_t*> addrs;
+    for (uint32_t i = 0; i < n; ++i) {
+        addrs.push_back(&vec.emplace_back(i));
+    }
+    REQUIRE(vec.size() == n);
+    REQUIRE(vec.capacity() >= n);
+    REQUIRE(vec.num_chunks() == (n + vec.chunk_size() - 1) / vec.chunk_size());
+
+    // the elements do not move as the vector grows.
+    for (uint32_t i = 0; i < n; ++i) {
+        REQUIRE(&vec[i] == addrs[i]);
+        REQUIRE(vec.at(i) == i);
+    }
+    REQUIRE_THROWS_AS(vec.at(n), std::out_of_range);
+
+    uint32_t expected = 0;
+    for (auto val : vec) {
+        REQUIRE(val == expected++);
+    }
+    REQUIRE(expected == n);
+    REQUIRE(std::distance(vec.begin(), vec.end()) == static_cast<std::ptrdiff_t>(n));
+    REQUIRE(*(vec.begin() + (n - 1)) == n - 1);
+
+    expected = 0;
+    vec.for_each_chunk([&](const uint32_t* data, size_t count) {
+        for (size_t j = 0; j < count; ++j) {
+            REQUIRE(data[j] == expected++);
+        }
+    });
+    REQUIRE(expected == n);
+}
+
+TEST_CASE("Test Hybrid Search", "[float metrics]") {
+    const int64_t nb = 2000, nq = 10;
+    const int64_t dense_dim = 32, sparse_dim = 300;
+    const int64_t topk = 10, candidates = 50;
+    auto version = GenTestVersionList();
+    auto fusion = GENERATE(as<std::string>{}, "RRF", "WEIGHTED");
+
+    knowhere::Json dense_json;
+    dense_json[knowhere::meta::DIM] = dense_dim;
+    dense_json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    dense_json[knowhere::meta::TOPK] = candidates;
+    knowhere::Json sparse_json;
+    sparse_json[knowhere::meta::DIM] = sparse_dim;
+    sparse_json[knowhere::meta::METRIC_TYPE] = knowhere::metric::IP;
+    sparse_json[knowhere::meta::TOPK] = candidates;
+
+    auto dense_idx = knowhere::IndexFactory::Instance()
+                         .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IDMAP, version)
+                         .value();
+    REQUIRE(dense_idx.Build(GenDataSet(nb, dense_dim), dense_json) == knowhere::Status::success);
+    auto sparse_idx = knowhere::IndexFactory::Instance()
+                          .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_WAND, version)
+                          .value();
+    REQUIRE(sparse_idx.Build(GenSparseDataSet(nb, sparse_dim, 0.95), sparse_json) == knowhere::Status::success);
+
+    const auto dense_query = GenDataSet(nq, dense_dim, 43);
+    const auto sparse_query = GenSparseDataSet(nq, sparse_dim, 0.97, 43);
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 4);
+    knowhere::BitsetView bitset(bitset_data.data(), nb);
+
+    knowhere::Json json;
+    json[knowhere::meta::TOPK] = topk;
+    json[knowhere::meta::HYBRID_FUSION] = fusion;
+    json[knowhere::meta::HYBRID_CANDIDATES] = candidates;
+    json[knowhere::meta::SPARSE_WEIGHT] = 2.0f;
+    using Index = knowhere::Index<knowhere::IndexNode>;
+    auto results = Index::HybridSearch({dense_idx, dense_query, dense_json}, {sparse_idx, sparse_query, sparse_json},
+                                       json, bitset);
+    REQUIRE(results.has_value());
+    REQUIRE(results.value()->GetRows() == nq);
+    REQUIRE(results.value()->GetDim() == topk);
+
+    // the fusion of the results of the searches one by one
+    auto dense_results = dense_idx.Search(dense_query, dense_json, bitset);
+    auto sparse_results = sparse_idx.Search(sparse_query, sparse_json, bitset);
+    REQUIRE(dense_results.has_value());
+    REQUIRE(sparse_results.has_value());
+    for (int64_t i = 0; i < nq; i++) {
+        std::unordered_map<int64_t, float> fused;
+        for (int64_t j = 0; j < candidates; j++) {
+            const auto dense_id = dense_results.value()->GetIds()[i * candidates + j];
+            const auto dense_dis = dense_results.value()->GetDistance()[i * candidates + j];
+            const auto sparse_id = sparse_results.value()->GetIds()[i * candidates + j];
+            const auto sparse_dis = sparse_results.value()->GetDistance()[i * candidates + j];
+            if (dense_id >= 0) {
+                fused[dense_id] += fusion == "RRF" ? 1.0f / (60 + j + 1) : 1.0f - 2.0f * std::atan(dense_dis) / M_PI;
+            }
+            if (sparse_id >= 0) {
+                fused[sparse_id] +=
+                    2.0f * (fusion == "RRF" ? 1.0f / (60 + j + 1) : 0.5f + std::atan(sparse_dis) / M_PI);
+            }
+        }
+        std::vector<float> expected_scores;
+        for (const auto& [id, score] : fused) {
+            expected_scores.push_back(score);
+        }
+        std::sort(expected_scores.begin(), expected_scores.end(), std::greater<float>());
+        for (int64_t j = 0; j < topk; j++) {
+            const auto id = results.value()->GetIds()[i * topk + j];
+            const auto score = results.value()->GetDistance()[i * topk + j];
+            REQUIRE(id >= 0);
+            REQUIRE(!bitset.test(id));
+            REQUIRE(fused.count(id) == 1);
+            REQUIRE(score == Catch::Approx(fused[id]));
+            REQUIRE(score == Catch::Approx(expected_scores[j]));
+        }
+    }
+
+    SECTION("invalid params") {
+        json[knowhere::meta::HYBRID_FUSION] = "MAX";
+        results = Index::HybridSearch({dense_idx, dense_query, dense_json}, {sparse_idx, sparse_query, sparse_json},
+                                      json, bitset);
+        REQUIRE(results.error() == knowhere::Status::invalid_args);
+
+        json[knowhere::meta::HYBRID_FUSION] = fusion;
+        // the dense and sparse queries are not as many
+        results = Index::HybridSearch({dense_idx, GenDataSet(nq + 1, dense_dim), dense_json},
+                                      {sparse_idx, sparse_query, sparse_json}, json, bitset);
+        REQUIRE(results.error() == knowhere::Status::invalid_args);
+    }
+}
+
+TEST_CASE("Test Mem Sparse Clustered Index", "[float metrics]") {
+    auto nb = 2000;
+    auto dim = 300;
+    auto topk = 5;
+    int64_t nq = 10;
+    auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::IP;
+    json[knowhere::meta::TOPK] = topk;
+
+    auto train_ds = GenSparseDataSet(nb, dim, 0.95);
+    auto query_ds = GenSparseDataSet(nq, dim, 0.97, 43);
+
+    SECTION("Test Search") {
+        auto idx = knowhere::IndexFactory::Instance()
+                       .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_CLUSTERED, version)
+                       .value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto idx2 = knowhere::IndexFactory::Instance()
+                        .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_CLUSTERED, version)
+                        .value();
+        REQUIRE(idx2.Deserialize(bs, json) == knowhere::Status::success);
+        REQUIRE(idx2.Count() == nb);
+
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto filtered = GENERATE(false, true);
+
+        auto gt = knowhere::BruteForce::SearchSparse(train_ds, query_ds, json, filtered ? bitset : nullptr);
+        auto results = idx.Search(query_ds, json, filtered ? bitset : nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= 0.8);
+
+        auto results2 = idx2.Search(query_ds, json, filtered ? bitset : nullptr);
+        REQUIRE(results2.has_value());
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(results.value()->GetIds()[i] == results2.value()->GetIds()[i]);
+            if (filtered && results.value()->GetIds()[i] != -1) {
+                REQUIRE(!bitset.test(results.value()->GetIds()[i]));
+            }
+        }
+    }
+
+    SECTION("Test Search Budget") {
+        auto idx = knowhere::IndexFactory::Instance()
+                       .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_CLUSTERED, version)
+                       .value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+        auto gt = knowhere::BruteForce::SearchSparse(train_ds, query_ds, json, nullptr);
+
+        // visiting a single block per query can not find all the neighbors.
+        json[knowhere::indexparam::BLOCK_BUDGET] = 1;
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        auto small_budget_recall = GetKNNRecall(*gt.value(), *results.value());
+
+        json[knowhere::indexparam::BLOCK_BUDGET] = 0;
+        json[knowhere::indexparam::HEAP_FACTOR] = 1.0;
+        json[knowhere::indexparam::QUERY_CUT] = dim;
+        results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > small_budget_recall);
+    }
+
+    SECTION("Test Unsupported Metric") {
+        auto idx = knowhere::IndexFactory::Instance()
+                       .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_CLUSTERED, version)
+                       .value();
+        json[knowhere::meta::METRIC_TYPE] = knowhere::metric::BM25;
+        json[knowhere::meta::BM25_K1] = 1.2;
+        json[knowhere::meta::BM25_B] = 0.75;
+        json[knowhere::meta::BM25_AVGDL] = 100;
+        REQUIRE(idx.Build(train_ds, json) != knowhere::Status::success);
+    }
 }
 
 TEST_CASE("Test Mem Sparse Index Handle Empty Vector", "[float metrics]") {
@@ -468,7 +942,7 @@ TEST_CASE("Test Mem Sparse Index CC", "[float metrics]") {
 
     auto query_ds = doc_vector_gen(nq, dim);
 
-    auto inverted_index_algo = GENERATE("TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE");
+    auto inverted_index_algo = GENERATE("TAAT_NAIVE", "DAAT_WAND", "DAAT_MAXSCORE", "DAAT_BMW");
 
     auto drop_ratio_search = GENERATE(0.0, 0.3);
 
@@ -579,3 +1053,27 @@ TEST_CASE("Test Mem Sparse Index CC", "[float metrics]") {
         }
     }
 }
+
+TEST_CASE("Test Sparse Dim Map", "[sparse]") {
+    knowhere::sparse::DimMap dim_map;
+    std::vector<knowhere::sparse::table_t> dims;
+    // dims far beyond the dense range are inserted first, then more dims let the dense range grow past some of them.
+    for (knowhere::sparse::table_t dim : {4000000000u, 1000000u, 5u, 70000u}) {
+        dims.push_back(dim);
+    }
+    for (knowhere::sparse::table_t dim = 0; dim < 2000000; dim += 17) {
+        dims.push_back(dim);
+    }
+    std::unordered_map<knowhere::sparse::table_t, uint32_t> expected;
+    for (auto dim : dims) {
+        auto [it, inserted] = expected.try_emplace(dim, expected.size());
+        REQUIRE(dim_map.insert(dim) == it->second);
+    }
+    REQUIRE(dim_map.size() == expected.size());
+    for (const auto& [dim, id] : expected) {
+        REQUIRE(dim_map.find(dim) == id);
+        REQUIRE(dim_map.dim(id) == dim);
+    }
+    REQUIRE(dim_map.find(1) == knowhere::sparse::DimMap::npos);
+    REQUIRE(dim_map.find(3999999999u) == knowhere::sparse::DimMap::npos);
+}
@@ -10,13 +10,26 @@
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
 #include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators.hpp"
+#include "knowhere/bitset_builder.h"
+#include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/build_scheduler.h"
+#include "knowhere/comp/huge_page.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/result_buffer_pool.h"
+#include "knowhere/comp/search_planner.h"
+#include "knowhere/comp/search_stage.h"
 #include "knowhere/comp/task.h"
 #include "knowhere/comp/time_recorder.h"
+#include "knowhere/comp/workspace.h"
 #include "knowhere/expected.h"
 #include "knowhere/heap.h"
 #include "knowhere/utils.h"
@@ -111,6 +124,186 @@ TEST_CASE("Test Bitset Generation", "[utils]") {
             }
         }
     }
+
+    SECTION("Next Valid Index") {
+        for (const auto size : kBitsetSizes) {
+            for (size_t i = 0; i <= size; ++i) {
+                auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, i);
+                knowhere::BitsetView bitset(bitset_data.data(), size);
+                size_t expected = size;
+                for (size_t j = size; j-- > 0;) {
+                    if (!bitset.test(j)) {
+                        expected = j;
+                    }
+                    REQUIRE(bitset.get_next_valid_index(j) == expected);
+                }
+                REQUIRE(bitset.get_next_valid_index(size) == size);
+
+                // with an id offset, the ids past the end of the bitset are filtered out.
+                const size_t offset = size / 3;
+                bitset.set_id_offset(offset);
+                expected = size - offset;
+                for (size_t j = size - offset; j-- > 0;) {
+                    if (!bitset.test(j)) {
+                        expected = j;
+                    }
+                    REQUIRE(std::min(bitset.get_next_valid_index(j), size - offset) == expected);
+                }
+            }
+        }
+    }
+
+    SECTION("Valid Ids") {
+        for (const auto size : kBitsetSizes) {
+            for (size_t i = 0; i <= size; ++i) {
+                auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, i);
+                knowhere::BitsetView bitmap(bitset_data.data(), size, i);
+                std::vector<uint32_t> valid_ids;
+                for (size_t j = 0; j < size; ++j) {
+                    if (!bitmap.test(j)) {
+                        valid_ids.push_back(j);
+                    }
+                }
+                auto bitset = knowhere::BitsetView::from_valid_ids(valid_ids.data(), valid_ids.size(), size);
+                REQUIRE(bitset.has_valid_ids());
+                REQUIRE(bitset.data() == nullptr);
+                REQUIRE(bitset.size() == size);
+                REQUIRE(bitset.count() == i);
+                REQUIRE(bitset.get_filtered_out_num_() == i);
+                REQUIRE(bitset.get_first_valid_index() == bitmap.get_first_valid_index());
+                for (size_t j = 0; j <= size; ++j) {
+                    REQUIRE(bitset.test(j) == bitmap.test(j));
+                    REQUIRE(bitset.get_next_valid_index(j) == bitmap.get_next_valid_index(j));
+                }
+
+                std::vector<uint8_t> bits(bitset.byte_size());
+                bitset.copy_bits_to(bits.data());
+                knowhere::BitsetView copied(bits.data(), size);
+                REQUIRE(copied.get_filtered_out_num_() == i);
+                for (size_t j = 0; j < size; ++j) {
+                    REQUIRE(copied.test(j) == bitmap.test(j));
+                }
+
+                // the id list of a brute force search is the valid ids past the id offset
+                const size_t offset = size / 3;
+                bitset.set_id_offset(offset);
+                bitmap.set_id_offset(offset);
+                knowhere::BitsetViewIDList list(bitset, size - offset);
+                knowhere::BitsetViewIDList expected(bitmap, size - offset);
+                REQUIRE(list.ids == expected.ids);
+            }
+        }
+    }
+
+    SECTION("Builder") {
+        std::mt19937 rng(42);
+        for (const auto size : kBitsetSizes) {
+            for (size_t i = 0; i <= size; ++i) {
+                auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, i);
+                knowhere::BitsetView bitmap(bitset_data.data(), size, i);
+                std::vector<uint32_t> filtered_out_ids, valid_ids;
+                for (size_t j = 0; j < size; ++j) {
+                    (bitmap.test(j) ? filtered_out_ids : valid_ids).push_back(j);
+                }
+                auto filtered_out =
+                    knowhere::BitsetBuilder::FromFilteredOutIds(filtered_out_ids.data(), filtered_out_ids.size(), size);
+                auto valid = knowhere::BitsetBuilder::FromValidIds(valid_ids.data(), valid_ids.size(), size);
+                for (const auto& bitset : {filtered_out.view(), valid.view()}) {
+                    REQUIRE(bitset.count() == i);
+                    REQUIRE(bitset.get_filtered_out_num_() == i);
+                    for (size_t j = 0; j < size; ++j) {
+                        REQUIRE(bitset.test(j) == bitmap.test(j));
+                    }
+                }
+
+                // overlapping ranges
+                std::uniform_int_distribution<uint32_t> dist(0, size);
+                std::vector<knowhere::BitsetBuilder::Range> ranges;
+                std::vector<bool> in_ranges(size);
+                for (size_t r = 0; r < 3; ++r) {
+                    auto first = dist(rng);
+                    auto second = dist(rng);
+                    ranges.emplace_back(std::min(first, second), std::max(first, second));
+                    std::fill(in_ranges.begin() + ranges.back().first, in_ranges.begin() + ranges.back().second, true);
+                }
+                auto range_bitset = knowhere::BitsetBuilder::FromFilteredOutRanges(ranges.data(), ranges.size(), size);
+                auto valid_range_bitset = knowhere::BitsetBuilder::FromValidRanges(ranges.data(), ranges.size(), size);
+                REQUIRE(range_bitset.view().count() == range_bitset.view().get_filtered_out_num_());
+                REQUIRE(valid_range_bitset.view().count() == size - range_bitset.view().count());
+                for (size_t j = 0; j < size; ++j) {
+                    REQUIRE(range_bitset.view().test(j) == in_ranges[j]);
+                    REQUIRE(valid_range_bitset.view().test(j) == !in_ranges[j]);
+                }
+
+                // the combinators take the bitsets given by their valid ids as well
+                auto by_valid_ids = knowhere::BitsetView::from_valid_ids(valid_ids.data(), valid_ids.size(), size);
+                auto and_bitset = knowhere::BitsetBuilder::And(by_valid_ids, range_bitset.view());
+                auto or_bitset = knowhere::BitsetBuilder::Or(bitmap, range_bitset.view());
+                auto not_bitset = knowhere::BitsetBuilder::Not(by_valid_ids);
+                for (const auto& bitset : {and_bitset.view(), or_bitset.view(), not_bitset.view()}) {
+                    REQUIRE(bitset.count() == bitset.get_filtered_out_num_());
+                }
+                for (size_t j = 0; j < size; ++j) {
+                    REQUIRE(and_bitset.view().test(j) == (bitmap.test(j) && in_ranges[j]));
+                    REQUIRE(or_bitset.view().test(j) == (bitmap.test(j) || in_ranges[j]));
+                    REQUIRE(not_bitset.view().test(j) == !bitmap.test(j));
+                }
+            }
+        }
+    }
+
+    SECTION("Batch Test") {
+        std::mt19937 rng(42);
+        for (const auto size : kBitsetSizes) {
+            auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, size / 2);
+            knowhere::BitsetView bitset(bitset_data.data(), size);
+            bitset.set_id_offset(size / 4);
+            // the ids past the end of the bitset are filtered out too
+            std::uniform_int_distribution<int64_t> dist(0, size);
+            std::vector<faiss::idx_t> ids(150);
+            for (auto& id : ids) {
+                id = dist(rng);
+            }
+            for (size_t n = 0; n <= 64; ++n) {
+                const uint64_t mask = bitset.test_batch(ids.data(), n);
+                for (size_t j = 0; j < 64; ++j) {
+                    REQUIRE(((mask >> j) & 1) == (j < n && bitset.test(ids[j])));
+                }
+            }
+
+            // the scans test their ids through a cursor over the batches
+            knowhere::BitsetViewIDSelector selector(bitset);
+            faiss::IDSelectorBatchCursor<faiss::IDSelector, faiss::idx_t> members(&selector, ids.data(), ids.size());
+            for (size_t j = 0; j < ids.size(); ++j) {
+                REQUIRE(members.is_member(j) == !bitset.test(ids[j]));
+            }
+        }
+    }
+
+    SECTION("Internal Bits") {
+        std::mt19937 rng(42);
+        for (const auto size : kBitsetSizes) {
+            auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, size / 2);
+            knowhere::BitsetView bitset(bitset_data.data(), size);
+            // several internal ids map to the same bit
+            const size_t num_internal_ids = size * 2;
+            std::uniform_int_distribution<uint32_t> dist(0, size - 1);
+            std::vector<uint32_t> out_ids(num_internal_ids);
+            for (auto& id : out_ids) {
+                id = dist(rng);
+            }
+            bitset.set_id_offset(size / 4);
+            bitset.set_out_ids(out_ids.data(), num_internal_ids - size / 4);
+
+            std::vector<uint8_t> bits((bitset.size() + 7) / 8);
+            bitset.copy_internal_bits_to(bits.data());
+            knowhere::BitsetView internal(bits.data(), bitset.size());
+            REQUIRE(internal.get_filtered_out_num_() == bitset.count());
+            for (size_t j = 0; j < bitset.size(); ++j) {
+                REQUIRE(internal.test(j) == bitset.test(j));
+            }
+        }
+    }
 }
 
 namespace {
@@ -166,6 +359,87 @@ TEST_CASE("Test DiskLoad") {
 #endif
 }
 
+TEST_CASE("Test Search Planner") {
+    using knowhere::SearchStrategy;
+
+    knowhere::SearchProfile profile;
+    profile.num_rows = 1000000;
+    profile.num_valid_rows = profile.num_rows;
+    profile.k = 10;
+    profile.ef = 64;
+    profile.code_size = 512;
+    profile.graph_degree = 32;
+
+    SECTION("without a filter") {
+        auto plan = knowhere::PlanSearch(profile);
+        REQUIRE(plan.strategy == SearchStrategy::GRAPH);
+        REQUIRE(plan.cost == plan.graph_cost);
+
+        // a topk of a large fraction of the rows
+        profile.num_rows = profile.num_valid_rows = 1000;
+        profile.k = 600;
+        plan = knowhere::PlanSearch(profile);
+        REQUIRE(plan.strategy == SearchStrategy::BRUTE_FORCE);
+        REQUIRE(plan.cost == plan.brute_force_cost);
+    }
+
+    SECTION("with a filter") {
+        // the graph goes through the filtered out nodes until it finds ef ones that pass
+        profile.num_valid_rows = profile.num_rows / 2;
+        REQUIRE(knowhere::PlanSearch(profile).strategy == SearchStrategy::GRAPH);
+
+        // a restrictive filter disconnects the graph, the two-hop traversal gets through
+        profile.num_valid_rows = profile.num_rows / 10;
+        REQUIRE(knowhere::PlanSearch(profile).strategy == SearchStrategy::GRAPH_TWO_HOP);
+
+        // the few rows that pass are cheaper to scan
+        profile.num_valid_rows = 1000;
+        auto plan = knowhere::PlanSearch(profile);
+        REQUIRE(plan.strategy == SearchStrategy::BRUTE_FORCE);
+        REQUIRE(plan.brute_force_cost < plan.two_hop_cost);
+        REQUIRE(plan.two_hop_cost < plan.graph_cost);
+
+        // unless the strategy is forced
+        const uint32_t graph_only =
+            static_cast<uint32_t>(SearchStrategy::GRAPH) | static_cast<uint32_t>(SearchStrategy::GRAPH_TWO_HOP);
+        plan = knowhere::PlanSearch(profile, graph_only);
+        REQUIRE(plan.strategy == SearchStrategy::GRAPH_TWO_HOP);
+        REQUIRE(plan.cost == plan.two_hop_cost);
+    }
+
+    SECTION("mmapped") {
+        // the page faults of the graph traversal tip the plan to the brute force
+        profile.num_valid_rows = 15000;
+        REQUIRE(knowhere::PlanSearch(profile).strategy == SearchStrategy::GRAPH_TWO_HOP);
+        profile.mmapped = true;
+        REQUIRE(knowhere::PlanSearch(profile).strategy == SearchStrategy::BRUTE_FORCE);
+    }
+}
+
+TEST_CASE("Test Huge Page Buffer") {
+    const size_t page = knowhere::HugePageSize();
+    REQUIRE(page >= 4096);
+    REQUIRE(knowhere::HugePageBuffer::Allocate(4 * page) == nullptr);
+
+    auto policy = GENERATE(knowhere::HugePagePolicy::TRANSPARENT, knowhere::HugePagePolicy::EXPLICIT);
+    knowhere::SetHugePagePolicy(policy);
+    // too small for a huge page
+    REQUIRE(knowhere::HugePageBuffer::Allocate(page - 1) == nullptr);
+    // the hugetlb pool is usually not reserved, the buffer is then of transparent huge pages
+    auto buffer = knowhere::HugePageBuffer::Allocate(3 * page + 17);
+    REQUIRE(buffer != nullptr);
+    REQUIRE(buffer->size() == 3 * page + 17);
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer->data()) % page == 0);
+    REQUIRE((!buffer->explicit_pages() || policy == knowhere::HugePagePolicy::EXPLICIT));
+    std::memset(buffer->data(), 0x5a, buffer->size());
+    REQUIRE(static_cast<const uint8_t*>(buffer->data())[buffer->size() - 1] == 0x5a);
+
+    std::vector<uint8_t> heap(4 * page, 1);
+    knowhere::AdviseHugePages(heap.data(), heap.size());
+    REQUIRE(heap.back() == 1);
+    knowhere::SetHugePagePolicy(knowhere::HugePagePolicy::NONE);
+}
+
 TEST_CASE("Test ThreadPool") {
     SECTION("Build thread pool") {
         knowhere::ThreadPool::InitGlobalBuildThreadPool(0);
@@ -228,6 +502,254 @@ TEST_CASE("Test ThreadPool") {
         auto thread_num_2 = omp_get_max_threads();
         REQUIRE(thread_num_2 == prev_num_threads);
     }
+
+    SECTION("ScopedSearchPriority") {
+        REQUIRE(knowhere::GetSearchPriority() == knowhere::SearchPriority::NORMAL);
+        {
+            knowhere::ScopedSearchPriority setter(knowhere::SearchPriority::HIGH);
+            REQUIRE(knowhere::GetSearchPriority() == knowhere::SearchPriority::HIGH);
+
+            std::atomic<int> inherited{0};
+            std::vector<std::function<void()>> tasks;
+            for (int i = 0; i < 8; ++i) {
+                tasks.emplace_back([&]() {
+                    if (knowhere::GetSearchPriority() == knowhere::SearchPriority::HIGH) {
+                        inherited++;
+                    }
+                });
+            }
+            knowhere::ExecOverSearchThreadPool(tasks);
+            REQUIRE(inherited.load() == 8);
+        }
+        REQUIRE(knowhere::GetSearchPriority() == knowhere::SearchPriority::NORMAL);
+    }
+
+    SECTION("ParallelForOverSearchThreadPool") {
+        for (const size_t n : {0, 1, 7, 1000, 100000}) {
+            for (const size_t item_cost : {1, 1000, 1 << 20}) {
+                std::vector<std::atomic<int>> visits(n);
+                knowhere::ParallelForOverSearchThreadPool(n, item_cost, [&](size_t begin, size_t end) {
+                    REQUIRE(begin < end);
+                    for (size_t i = begin; i < end; ++i) {
+                        visits[i]++;
+                    }
+                });
+                for (size_t i = 0; i < n; ++i) {
+                    REQUIRE(visits[i].load() == 1);
+                }
+            }
+        }
+    }
+
+    SECTION("Nested search thread pool tasks") {
+        REQUIRE_FALSE(knowhere::IsSearchThreadPoolTask());
+        // every task runs its nested task inline, which does not need a free thread of the pool
+        const size_t n = 4 * knowhere::GetSearchThreadPoolSize();
+        std::atomic<size_t> inline_runs{0};
+        std::vector<folly::SemiFuture<folly::Unit>> futs;
+        for (size_t i = 0; i < n; ++i) {
+            futs.emplace_back(knowhere::SubmitToSearchThreadPool([&]() {
+                const auto outer_thread = std::this_thread::get_id();
+                knowhere::RunOnSearchThreadPool([&]() {
+                    if (knowhere::IsSearchThreadPoolTask() && std::this_thread::get_id() == outer_thread) {
+                        inline_runs++;
+                    }
+                });
+            }));
+        }
+        folly::collectAll(futs.begin(), futs.end()).get();
+        REQUIRE(inline_runs.load() == n);
+        REQUIRE_FALSE(knowhere::IsSearchThreadPoolTask());
+    }
+
+    SECTION("Search admission control") {
+        knowhere::SetSearchQueueLimit(knowhere::SearchPriority::LOW, 1);
+        std::atomic<bool> release{false};
+        std::vector<folly::SemiFuture<folly::Unit>> futs;
+        {
+            knowhere::ScopedSearchPriority priority_setter(knowhere::SearchPriority::LOW);
+            // more blocked tasks than threads, the ones left over wait in the queue
+            for (size_t i = 0; i < knowhere::GetSearchThreadPoolSize() + 2; ++i) {
+                futs.emplace_back(knowhere::SubmitToSearchThreadPool([&]() {
+                    while (!release.load()) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }));
+            }
+            REQUIRE(knowhere::GetSearchQueueDepth(knowhere::SearchPriority::LOW) >= 2);
+            REQUIRE(knowhere::AdmitSearch() == knowhere::Status::resource_exhausted);
+        }
+        // the other priorities have queues of their own
+        REQUIRE(knowhere::AdmitSearch() == knowhere::Status::success);
+        release = true;
+        folly::collectAll(futs.begin(), futs.end()).get();
+        REQUIRE(knowhere::GetSearchQueueDepth(knowhere::SearchPriority::LOW) == 0);
+        {
+            knowhere::ScopedSearchPriority priority_setter(knowhere::SearchPriority::LOW);
+            REQUIRE(knowhere::AdmitSearch() == knowhere::Status::success);
+        }
+        knowhere::SetSearchQueueLimit(knowhere::SearchPriority::LOW, 0);
+    }
+
+    SECTION("Build scheduler") {
+        auto& scheduler = knowhere::BuildScheduler::GetInstance();
+        scheduler.SetMemoryBudget(100);
+        auto first = scheduler.Admit(60);
+        REQUIRE(first->NumThreads() == static_cast<int32_t>(knowhere::ThreadPool::GetGlobalBuildThreadPoolSize()));
+        // the builds are admitted in order, so the small one waits behind the one that does not fit
+        auto large = scheduler.AdmitAsync(50);
+        auto small = scheduler.AdmitAsync(10);
+        REQUIRE_FALSE(large.isReady());
+        REQUIRE_FALSE(small.isReady());
+        first.reset();
+        REQUIRE(large.isReady());
+        REQUIRE(small.isReady());
+        auto second = std::move(large).get();
+        auto third = std::move(small).get();
+        REQUIRE(scheduler.GetReservedMemory() == 60);
+        REQUIRE(scheduler.GetRunningBuilds() == 2);
+        REQUIRE(third->NumThreads() ==
+                std::max<int32_t>(1, knowhere::ThreadPool::GetGlobalBuildThreadPoolSize() / 2));
+        // a build larger than the budget runs alone
+        auto huge = scheduler.AdmitAsync(200);
+        second.reset();
+        third.reset();
+        REQUIRE(huge.isReady());
+        REQUIRE(scheduler.GetReservedMemory() == 200);
+        std::move(huge).get();
+        REQUIRE(scheduler.GetReservedMemory() == 0);
+        REQUIRE(scheduler.GetRunningBuilds() == 0);
+        scheduler.SetMemoryBudget(0);
+    }
+
+    SECTION("Search workspace") {
+        auto& workspace = knowhere::SearchWorkspace::ThreadLocal();
+        REQUIRE(&workspace == &knowhere::SearchWorkspace::ThreadLocal());
+        {
+            knowhere::SearchWorkspace::Scope scope;
+            auto scores = scope.AllocZeroed<float>(1000);
+            REQUIRE(reinterpret_cast<uintptr_t>(scores) % knowhere::SearchWorkspace::kAlignment == 0);
+            REQUIRE(scores[999] == 0.0f);
+            {
+                // a nested scope stacks on the buffers of the outer one
+                knowhere::SearchWorkspace::Scope nested;
+                auto ids = nested.Alloc<int64_t>(1000);
+                ids[999] = 1;
+                REQUIRE(static_cast<void*>(ids) != static_cast<void*>(scores));
+            }
+        }
+        // the buffer is grown to the high-water mark once no scope is open
+        REQUIRE(workspace.HighWater() >= 1000 * (sizeof(float) + sizeof(int64_t)));
+        REQUIRE(workspace.Capacity() >= workspace.HighWater());
+        const size_t capacity = workspace.Capacity();
+        for (int i = 0; i < 3; ++i) {
+            knowhere::SearchWorkspace::Scope scope;
+            auto scores = scope.Alloc<float>(1000);
+            auto ids = scope.Alloc<int64_t>(1000);
+            REQUIRE(static_cast<void*>(ids) != static_cast<void*>(scores));
+        }
+        REQUIRE(workspace.Capacity() == capacity);
+    }
+
+    SECTION("Result buffer pool") {
+        const size_t cached = knowhere::ResultBufferPool::CachedBytes();
+        const void* first = nullptr;
+        {
+            auto ids = knowhere::AllocateResultBuffer<int64_t>(1000);
+            auto distances = knowhere::AllocateResultBuffer<float>(1000);
+            ids[999] = 1;
+            distances[999] = 1.0f;
+            first = ids.get();
+            auto ds = knowhere::GenResultDataSet(10, 100, std::move(ids), std::move(distances));
+            REQUIRE(ds->GetIds()[999] == 1);
+            REQUIRE(ds->GetDistance()[999] == 1.0f);
+        }
+        // the buffers of the dataset went back to the free lists of the thread
+        REQUIRE(knowhere::ResultBufferPool::CachedBytes() >= cached + 1000 * (sizeof(int64_t) + sizeof(float)));
+        auto ids = knowhere::AllocateResultBuffer<int64_t>(900);
+        REQUIRE(static_cast<const void*>(ids.get()) == first);
+        // the buffers larger than the size classes are not cached
+        auto huge = knowhere::AllocateResultBuffer<char>(knowhere::ResultBufferPool::kMaxBytes + 1);
+        const size_t before = knowhere::ResultBufferPool::CachedBytes();
+        huge.reset();
+        REQUIRE(knowhere::ResultBufferPool::CachedBytes() == before);
+
+        // the buffers of a dataset that does not own its results are handed over to the caller
+        int64_t* kept_ids = nullptr;
+        {
+            auto owned_ids = knowhere::AllocateResultBuffer<int64_t>(1000);
+            auto owned_distances = knowhere::AllocateResultBuffer<float>(1000);
+            owned_ids[999] = 2;
+            auto ds = knowhere::GenResultDataSet(10, 100, std::move(owned_ids), std::move(owned_distances));
+            ds->SetIsOwner(false);
+            kept_ids = const_cast<int64_t*>(ds->GetIds());
+            delete[] ds->GetDistance();
+        }
+        REQUIRE(kept_ids[999] == 2);
+        delete[] kept_ids;
+
+        // the free lists of a thread stay within their total, whatever the buffers released to it
+        std::vector<knowhere::ResultBuffer<char>> buffers;
+        for (size_t bytes = knowhere::ResultBufferPool::kMinBytes; bytes <= knowhere::ResultBufferPool::kMaxBytes;
+             bytes *= 2) {
+            for (int i = 0; i < 4; ++i) {
+                buffers.push_back(knowhere::AllocateResultBuffer<char>(bytes));
+            }
+        }
+        buffers.clear();
+        REQUIRE(knowhere::ResultBufferPool::CachedBytes() <= knowhere::ResultBufferPool::kMaxCachedBytes);
+    }
+
+    SECTION("Search stage times") {
+        auto times = std::make_shared<knowhere::SearchStageTimes>();
+        {
+            knowhere::ScopedSearchStageTimes setter(times);
+            knowhere::RecordSearchStage(knowhere::SearchStage::IO_WAIT, 2.5);
+            {
+                knowhere::ScopedSearchStage stage(knowhere::SearchStage::GRAPH_TRAVERSAL);
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            // the tasks of the search pool collect into the times of the submitter
+            std::vector<std::function<void()>> tasks;
+            for (int i = 0; i < 4; ++i) {
+                tasks.emplace_back([]() { knowhere::RecordSearchStage(knowhere::SearchStage::REFINE, 1.0); });
+            }
+            knowhere::ExecOverSearchThreadPool(tasks);
+        }
+        REQUIRE(knowhere::GetSearchStageTimes() == nullptr);
+        REQUIRE(times->Ms(knowhere::SearchStage::IO_WAIT) == Catch::Approx(2.5));
+        REQUIRE(times->Ms(knowhere::SearchStage::GRAPH_TRAVERSAL) >= 2.0);
+        REQUIRE(times->Ms(knowhere::SearchStage::REFINE) == Catch::Approx(4.0));
+        REQUIRE(times->Ms(knowhere::SearchStage::CONFIG_PARSE) == 0.0);
+        REQUIRE(std::string(knowhere::SearchStageName(knowhere::SearchStage::QUEUE_WAIT)) == "queue_wait");
+    }
+
+    SECTION("NUMA search thread pools") {
+        REQUIRE(knowhere::NumaNodeCount() >= 1);
+        REQUIRE(knowhere::GetNumaSearchThreadPool(knowhere::NumaNodeCount()) ==
+                knowhere::ThreadPool::GetGlobalSearchThreadPool());
+
+        knowhere::SetNumaMode(true);
+        {
+            knowhere::ScopedNumaNode numa_setter(0);
+            std::atomic<int> on_node{0};
+            std::vector<std::function<void()>> tasks;
+            for (int i = 0; i < 8; ++i) {
+                tasks.emplace_back([&]() {
+                    if (knowhere::GetCurrentNumaNode() == 0) {
+                        on_node++;
+                    }
+                });
+            }
+            knowhere::ExecOverSearchThreadPool(tasks);
+            REQUIRE(on_node.load() == 8);
+            auto fut = knowhere::PushSearchTask(knowhere::ThreadPool::GetGlobalSearchThreadPool(),
+                                                []() { return knowhere::GetCurrentNumaNode(); });
+            REQUIRE(std::move(fut).get() == 0);
+        }
+        knowhere::SetNumaMode(false);
+        REQUIRE(knowhere::GetCurrentNumaNode() == -1);
+    }
 }
 
 TEST_CASE("Test WaitAllSuccess with folly::Unit futures") {
@@ -73,7 +73,9 @@ class AioContextPool {
         return true;
   }
 
-  static std::shared_ptr<AioContextPool> GetGlobalAioPool() {
+  // the number of contexts of the global pool, which is sized with the
+  // defaults if it has not been initialized yet
+  static size_t GetGlobalAioPoolSize() {
     if (global_aio_pool_size == 0) {
       std::scoped_lock lk(global_aio_pool_mut);
       if (global_aio_pool_size == 0) {
@@ -85,6 +87,11 @@ class AioContextPool {
             << global_aio_pool_size;
       }
     }
+    return global_aio_pool_size;
+  }
+
+  static std::shared_ptr<AioContextPool> GetGlobalAioPool() {
+    GetGlobalAioPoolSize();
     static auto pool = std::shared_ptr<AioContextPool>(
         new AioContextPool(global_aio_pool_size, global_aio_max_events));
     return pool;
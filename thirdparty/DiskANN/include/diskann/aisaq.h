@@ -57,6 +57,7 @@ namespace diskann {
         enum aisaq_pq_io_engine pq_io_engine;
         uint64_t pq_cache_size;
         uint64_t pq_read_page_cache_size;
+        uint32_t speculative_reads;
     };
 
     struct aisaq_rearranged_pq_compressed_vectors_file_header {
@@ -3,6 +3,7 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -131,6 +132,13 @@ namespace diskann {
     uint32_t inline_pq = 0;
     bool rearrange = false;
     int num_entry_points = 0;
+    // the number of shards built at once when the index does not fit in
+    // index_mem_gb, which they share
+    unsigned shard_parallelism = 1;
+    // pack the nodes into the sectors of the disk index by the graph
+    bool optimize_layout = false;
+    // optional, the build is given up between its phases once it is set
+    const std::atomic_bool* cancelled = nullptr;
   };
 
   template<typename T>
@@ -147,10 +155,13 @@ namespace diskann {
   void aisaq_calc_inline_layout(int inline_pq, uint32_t pq_compressed_nbytes, uint32_t max_degree, bool rearrange,
                                 uint32_t &inline_pq_vectors, uint64_t &max_node_len);
 
+  // optimize_layout packs the nodes into the sectors by the graph instead of
+  // by id, the layout is saved next to output_file
   template<typename T>
   void create_disk_layout(
       const std::string base_file, const std::string mem_index_file,
       const std::string output_file,
-      const std::string reorder_data_file = std::string(""));
+      const std::string reorder_data_file = std::string(""),
+      const bool        optimize_layout = false);
 
 }  // namespace diskann
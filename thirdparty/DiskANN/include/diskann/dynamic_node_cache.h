@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "utils.h"
+
+namespace diskann {
+
+  // A fixed-size cache of graph nodes that is filled at query time, in the
+  // layout of the nodes on disk ([COORD(T)][NNBRS][NBRS]). Eviction follows
+  // CLOCK and admission follows TinyLFU: the reads of each node are counted
+  // in a count-min sketch that is halved every few reads, and a node read
+  // from disk only replaces the victim of the clock hand if it was read more
+  // often. No lock is taken, each slot is guarded by a seqlock so that a
+  // lookup racing with a replacement of the slot misses instead of blocking.
+  class DynamicNodeCache {
+   public:
+    // node_len bytes per node, num_slots nodes at most
+    DynamicNodeCache(_u64 num_points, _u64 node_len, _u64 num_slots);
+
+    // the number of slots that fit in budget_bytes, including the id to slot
+    // table, 0 if not a single one does
+    static _u64 get_num_slots(_u64 num_points, _u64 node_len,
+                              _u64 budget_bytes);
+
+    // copies the node into buf, of node_len bytes, if it is cached
+    bool lookup(_u32 id, char *buf);
+
+    // counts a read of the node from disk, node_buf holding it, and caches
+    // the node if TinyLFU admits it
+    void record(_u32 id, const char *node_buf);
+
+    _u64 get_num_slots() const noexcept {
+      return num_slots;
+    }
+
+    _u64 cal_size() const noexcept;
+
+   private:
+    static constexpr _u32 empty_slot = std::numeric_limits<_u32>::max();
+    // the rows of the sketch
+    static constexpr _u32 sketch_depth = 4;
+    // the slots the clock hand passes at most to find a victim
+    static constexpr _u32 max_clock_scan = 16;
+
+    struct Slot {
+      std::atomic<_u32> id{empty_slot};
+      // odd while the slot is written
+      std::atomic<_u32> version{0};
+      // set by the hits, cleared by the clock hand
+      std::atomic<bool> referenced{false};
+    };
+
+    _u32 increment_frequency(_u32 id);
+    _u32 estimate_frequency(_u32 id) const;
+    _u64 sketch_index(_u32 id, _u32 row) const;
+    void age_sketch();
+
+    _u64 num_points;
+    _u64 node_len;
+    _u64 num_slots;
+
+    std::unique_ptr<Slot[]>              slots;
+    std::unique_ptr<char[]>              slot_data;
+    std::unique_ptr<std::atomic<_u32>[]> id_to_slot;
+    std::atomic<_u64>                    clock_hand{0};
+
+    // sketch_depth rows of sketch_width saturating counters
+    _u64                                sketch_width;
+    std::unique_ptr<std::atomic<_u8>[]> sketch;
+    // the counters are halved after sample_size reads
+    _u64              sample_size;
+    std::atomic<_u64> num_samples{0};
+    std::atomic<bool> aging{false};
+  };
+}  // namespace diskann
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "aio_context_pool.h"
+
+// Schedules the IO contexts of the process among the disk indexes: an index
+// takes a slot before it takes an aio context or an io_uring ring and gives it
+// back with the context. There are as many slots as contexts in the global
+// AioContextPool, so that all the disk indexes share one bound on the reads in
+// flight whatever their engine. A free slot goes to the waiting index of the
+// highest priority and, among those, to the one holding the fewest slots. An
+// index never holds more slots than the quota, 0 for no quota.
+class IOScheduler {
+ public:
+  // a disk index, registered for as long as it is shared
+  class Client {
+   public:
+    explicit Client(int priority) : priority_(priority) {
+    }
+
+    int priority() const noexcept {
+      return priority_;
+    }
+
+   private:
+    friend class IOScheduler;
+
+    int    priority_;
+    size_t in_use_ = 0;
+    size_t waiting_ = 0;
+    size_t granted_ = 0;
+    // guarded by the mutex of the scheduler
+    std::condition_variable cv_;
+  };
+
+  IOScheduler(const IOScheduler&) = delete;
+
+  IOScheduler& operator=(const IOScheduler&) = delete;
+
+  std::shared_ptr<Client> register_client(int priority) {
+    return std::make_shared<Client>(priority);
+  }
+
+  // blocks until the client is granted a slot
+  void acquire(Client& client) {
+    std::unique_lock lk(mtx_);
+    if (client.waiting_++ == 0) {
+      waiting_clients_.push_back(&client);
+    }
+    dispatch();
+    client.cv_.wait(lk, [&client] { return client.granted_ > 0; });
+    client.granted_--;
+  }
+
+  void release(Client& client) {
+    std::scoped_lock lk(mtx_);
+    client.in_use_--;
+    free_slots_++;
+    dispatch();
+  }
+
+  size_t num_slots() const noexcept {
+    return num_slots_;
+  }
+
+  static void SetQuota(size_t quota) {
+    global_quota.store(quota);
+  }
+
+  static size_t GetQuota() {
+    return global_quota.load();
+  }
+
+  static std::shared_ptr<IOScheduler> GetGlobalIOScheduler() {
+    static auto scheduler = std::shared_ptr<IOScheduler>(
+        new IOScheduler(AioContextPool::GetGlobalAioPoolSize()));
+    return scheduler;
+  }
+
+ private:
+  std::mutex            mtx_;
+  std::vector<Client *> waiting_clients_;
+  size_t                num_slots_;
+  size_t                free_slots_;
+  inline static std::atomic<size_t> global_quota = 0;
+
+  explicit IOScheduler(size_t num_slots)
+      : num_slots_(num_slots), free_slots_(num_slots) {
+  }
+
+  // hands the free slots out, the caller holds mtx_
+  void dispatch() {
+    const size_t quota = global_quota.load();
+    while (free_slots_ > 0) {
+      auto next = waiting_clients_.end();
+      for (auto it = waiting_clients_.begin(); it != waiting_clients_.end();
+           ++it) {
+        Client *client = *it;
+        if (quota != 0 && client->in_use_ >= quota) {
+          continue;
+        }
+        if (next == waiting_clients_.end() ||
+            client->priority_ > (*next)->priority_ ||
+            (client->priority_ == (*next)->priority_ &&
+             client->in_use_ < (*next)->in_use_)) {
+          next = it;
+        }
+      }
+      if (next == waiting_clients_.end()) {
+        return;
+      }
+      Client *client = *next;
+      free_slots_--;
+      client->in_use_++;
+      client->granted_++;
+      if (--client->waiting_ == 0) {
+        waiting_clients_.erase(next);
+      }
+      client->cv_.notify_one();
+    }
+  }
+};
@@ -5,24 +5,30 @@
 
 #include "aligned_file_reader.h"
 #include "aio_context_pool.h"
+#include "io_scheduler.h"
 
 class LinuxAlignedFileReader : public AlignedFileReader {
  private:
   uint64_t     file_sz;
   FileHandle   file_desc;
   io_context_t bad_ctx = (io_context_t) -1;
-  std::shared_ptr<AioContextPool> ctx_pool_;
+  std::shared_ptr<AioContextPool>      ctx_pool_;
+  std::shared_ptr<IOScheduler>         io_scheduler_;
+  std::shared_ptr<IOScheduler::Client> io_client_;
 
  public:
-  LinuxAlignedFileReader();
+  // the contexts of the readers with a higher io_priority are handed out first
+  explicit LinuxAlignedFileReader(int io_priority = 0);
   ~LinuxAlignedFileReader();
 
   io_context_t get_ctx() override {
+    io_scheduler_->acquire(*io_client_);
     return ctx_pool_->pop();
   }
 
   void put_ctx(io_context_t ctx) override {
     ctx_pool_->push(ctx);
+    io_scheduler_->release(*io_client_);
   }
 
   // Open & close ops
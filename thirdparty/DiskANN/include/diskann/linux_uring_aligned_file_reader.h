@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#ifdef KNOWHERE_WITH_IO_URING
+
+#include <liburing.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "aligned_file_reader.h"
+#include "defaults.h"
+#include "io_scheduler.h"
+
+// An AlignedFileReader on io_uring. The contexts handed out by get_ctx() are
+// rings of this reader, not libaio contexts, and must only be given back to
+// it. Each ring has the file registered so that the reads skip the file
+// lookup. The rings are created on demand and reused, and are only handed out
+// with a slot of the global IOScheduler, so that the rings in use count
+// against the same bound as the aio contexts of the other indexes. With
+// sqpoll, the rings share a kernel thread that polls their submission queues
+// and the reads are submitted without a system call.
+class LinuxUringAlignedFileReader : public AlignedFileReader {
+ private:
+  FileHandle file_desc;
+  bool       sqpoll_;
+
+  std::shared_ptr<IOScheduler>         io_scheduler_;
+  std::shared_ptr<IOScheduler::Client> io_client_;
+
+  std::vector<std::unique_ptr<struct io_uring>> rings_;
+  std::vector<struct io_uring *>                free_rings_;
+  std::mutex                                    rings_mut_;
+
+  // the caller holds rings_mut_
+  struct io_uring *create_ring();
+  void             destroy_rings();
+
+ public:
+  // the number of reads a ring has in flight at most
+  static constexpr unsigned ring_entries =
+      diskann::defaults::MAX_N_SECTOR_READS / 2;
+
+  explicit LinuxUringAlignedFileReader(bool sqpoll = false,
+                                       int  io_priority = 0);
+  ~LinuxUringAlignedFileReader();
+
+  IOContext get_ctx() override;
+
+  void put_ctx(IOContext ctx) override;
+
+  // Open & close ops
+  // Blocking calls
+  void open(const std::string &fname) override;
+  void close() override;
+
+  // process batch of aligned requests in parallel
+  // NOTE :: blocking call
+  void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx,
+            bool async = false) override;
+
+  // async reads
+  void get_submitted_req(io_context_t &ctx, size_t n_ops) override;
+  void submit_req(io_context_t &ctx, std::vector<AlignedRead> &read_reqs) override;
+};
+
+#endif
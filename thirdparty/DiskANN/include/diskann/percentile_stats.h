@@ -27,6 +27,8 @@ namespace diskann {
     unsigned n_cmps = 0;        // # cmps
     unsigned n_cache_hits = 0;  // # cache_hits
     unsigned n_hops = 0;        // # search hops
+    unsigned n_speculative_reads = 0;  // # speculative node reads
+    unsigned n_speculative_hits = 0;   // # speculative reads expanded
     unsigned n_iters = 0;       // # range search iterations
   };
 
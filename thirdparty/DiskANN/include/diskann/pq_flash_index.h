@@ -18,6 +18,7 @@
 
 #include "aligned_file_reader.h"
 #include "concurrent_queue.h"
+#include "dynamic_node_cache.h"
 #include "neighbor.h"
 #include "parameters.h"
 #include "percentile_stats.h"
@@ -48,6 +49,20 @@ namespace diskann {
     std::condition_variable cond;
     std::mutex              status_mtx;
   };
+
+  // the memory of a PQFlashIndex by part, cal_size() being their sum
+  struct PQFlashIndexMemory {
+    _u64 scratch = 0;     // the scratch of the search threads
+    _u64 node_cache = 0;  // the cached coordinates and neighbors, the dynamic cache
+    _u64 pq_codes = 0;    // the compressed vectors
+    _u64 pq_pivots = 0;   // the PQ table and the medoids
+    _u64 id_map = 0;      // the slots of the nodes in the disk layout
+    _u64 other = 0;       // the index itself, the norms of the base vectors
+
+    _u64 total() const {
+      return scratch + node_cache + pq_codes + pq_pivots + id_map + other;
+    }
+  };
   template<typename T>
   struct QueryScratch {
     T *coord_scratch = nullptr;  // MUST BE AT LEAST [sizeof(T) * data_dim]
@@ -182,6 +197,10 @@ namespace diskann {
 	virtual ~PQDataGetter() {}
   };
 
+  // the precision of the in-memory copy of the vectors used to rerank the
+  // candidates of the searches (@see PQFlashIndex::load_rerank_tier)
+  enum class RerankTierType { NONE, SQ8, FP16 };
+
   template<typename T>
   class PQFlashIndex: public PQDataGetter {
    public:
@@ -203,13 +222,26 @@ namespace diskann {
     virtual void cache_bfs_levels(_u64                   num_nodes_to_cache,
                           std::vector<uint32_t> &node_list);
 
+    // cache the nodes read most often by the searches in up to budget_bytes,
+    // next to the static cache; returns the number of nodes it holds at most
+    _u64 setup_dynamic_cache(_u64 budget_bytes);
+
+    // keep a copy of all the vectors of the given precision in memory, to
+    // rerank the PQ candidates of the searches without reading their sectors;
+    // returns false, and keeps none, if the copy is larger than budget_bytes
+    // or the nodes on disk do not hold full precision vectors
+    bool load_rerank_tier(RerankTierType type, _u64 budget_bytes);
+
     void cached_beam_search(
         const T *query, const _u64 k_search, const _u64 l_search, _s64 *res_ids,
         float *res_dists, const _u64 beam_width,
         const bool use_reorder_data = false, QueryStats *stats = nullptr,
         const knowhere::feder::diskann::FederResultUniq &feder = nullptr,
         knowhere::BitsetView                             bitset_view = nullptr,
-        const float                                      filter_ratio = -1.0f);
+        const float                                      filter_ratio = -1.0f,
+        const _u64                                       min_beam_width = 0,
+        const float skip_filtered_reads_ratio = 1.0f,
+        const bool  exact_rerank = false);
 
     void get_vector_by_ids(const int64_t *ids, const int64_t n,
                            T *const output_data);
@@ -228,6 +260,10 @@ namespace diskann {
 
     diskann::Metric get_metric() const noexcept;
 
+    // whether the nodes on disk hold the vectors in full precision rather
+    // than their disk PQ codes
+    bool has_full_precision_vectors() const noexcept;
+
     void getIteratorNextBatch(IteratorWorkspace<T> *workspace);
 
     std::unique_ptr<IteratorWorkspace<T>> getIteratorWorkspace(
@@ -236,6 +272,8 @@ namespace diskann {
 
     _u64 cal_size();
 
+    PQFlashIndexMemory cal_memory();
+
     // for async cache making task
     void destroy_cache_async_task();
 
@@ -258,17 +296,26 @@ namespace diskann {
    //private:
     // sector # on disk where node_id is present with in the graph part
     virtual _u64 get_node_sector_offset(_u64 node_id) {
-      return long_node ? (node_id * nsectors_per_node + 1) * diskann::defaults::SECTOR_LEN
-                       : (node_id / nnodes_per_sector + 1) * diskann::defaults::SECTOR_LEN;
+      _u64 slot = get_node_slot(node_id);
+      return long_node ? (slot * nsectors_per_node + 1) * diskann::defaults::SECTOR_LEN
+                       : (slot / nnodes_per_sector + 1) * diskann::defaults::SECTOR_LEN;
     }
 
     // obtains region of sector containing node
     char *get_offset_to_node(char *sector_buf, _u64 node_id) {
-      return long_node
-                 ? sector_buf
-                 : sector_buf + (node_id % nnodes_per_sector) * max_node_len;
+      return long_node ? sector_buf
+                       : sector_buf + (get_node_slot(node_id) % nnodes_per_sector) *
+                                          max_node_len;
     }
 
+    // position of the node in the graph part, its id unless the layout of the
+    // index was optimized
+    _u64 get_node_slot(_u64 node_id) const {
+      return layout_slots == nullptr ? node_id : layout_slots[node_id];
+    }
+
+    void load_layout(const std::string &layout_file);
+
     inline void copy_vec_base_data(T *des, const int64_t des_idx, void *src);
 
     // Init thread data and returns query norm if avaialble.
@@ -285,7 +332,10 @@ namespace diskann {
         IOContext &ctx, QueryStats *stats,
         const knowhere::feder::diskann::FederResultUniq &feder,
         knowhere::BitsetView                             bitset_view,
-		PQDataGetter* pq_data_getter);
+		PQDataGetter* pq_data_getter, const bool exact_rerank = false);
+
+    // writes the vector of the rerank tier of node_id to coords
+    void decode_rerank_tier(_u64 node_id, T *coords) const;
 
     // Assign the index of ids to its corresponding sector and if it is in
     // cache, write to the output_data
@@ -294,12 +344,17 @@ namespace diskann {
                                                  T *output_data);
 
     // index info
-    // nhood of node `i` is in sector: [i / nnodes_per_sector]
-    // offset in sector: [(i % nnodes_per_sector) * max_node_len]
+    // nhood of node `i` is in sector: [slot(i) / nnodes_per_sector]
+    // offset in sector: [(slot(i) % nnodes_per_sector) * max_node_len]
     // nnbrs of node `i`: *(unsigned*) (buf)
     // nbrs of node `i`: ((unsigned*)buf) + 1
     _u64 max_node_len = 0, nnodes_per_sector = 0, max_degree = 0;
 
+    // set if the nodes were packed into the sectors by the graph instead of
+    // by id: the slot of each node and the node of each slot
+    std::unique_ptr<_u32[]> layout_slots = nullptr;
+    std::unique_ptr<_u32[]> layout_ids = nullptr;
+
     // Data used for searching with re-order vectors
     _u64 ndims_reorder_vecs = 0, reorder_data_start_sector = 0,
          nvecs_per_sector = 0;
@@ -394,6 +449,15 @@ namespace diskann {
     T                        *coord_cache_buf = nullptr;
     tsl::robin_map<_u32, T *> coord_cache;
 
+    // filled by cached_beam_search, nullptr unless set up
+    std::unique_ptr<DynamicNodeCache> dynamic_cache = nullptr;
+
+    // rerank tier: the vectors of all the nodes, as fp16 or as uint8 codes
+    // followed by the float min and scale of their vector
+    RerankTierType         rerank_tier_type = RerankTierType::NONE;
+    _u64                   rerank_tier_code_size = 0;
+    std::unique_ptr<_u8[]> rerank_tier_codes = nullptr;
+
     // thread-specific scratch
     ConcurrentQueue<ThreadData<T>> thread_data;
     _u64                           max_nthreads;
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "utils.h"
+#include "simd/hook.h"
 #include "concurrent_queue.h"
 
 namespace diskann {
@@ -29,21 +30,7 @@ namespace diskann {
     _mm_prefetch((char*) (pq_ids + 64), _MM_HINT_T0);
     _mm_prefetch((char*) (pq_ids + 128), _MM_HINT_T0);
 #endif
-    memset(dists_out, 0, n_pts * sizeof(float));
-    for (_u64 chunk = 0; chunk < pq_nchunks; chunk++) {
-      const float* chunk_dists = pq_dists + 256 * chunk;
-      if (chunk < pq_nchunks - 1) {
-#if defined(__ARM_NEON) && defined(__aarch64__)
-        __builtin_prefetch((char*) (chunk_dists + 256), 0, 3);
-#else
-        _mm_prefetch((char*) (chunk_dists + 256), _MM_HINT_T0);
-#endif
-      }
-      for (_u64 idx = 0; idx < n_pts; idx++) {
-        _u8 pq_centerid = pq_ids[pq_nchunks * idx + chunk];
-        dists_out[idx] += chunk_dists[pq_centerid];
-      }
-    }
+    faiss::pq8_lut_sum(pq_ids, n_pts, pq_nchunks, pq_dists, dists_out);
   }
 
   class FixedChunkPQTable {
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Reads byte ranges of the index files from where they are stored, typically
+// an object store, so that a disk index can be searched before its files are
+// fully downloaded. The files are named by the local path the file manager
+// would load them to, the implementation maps them to its own keys.
+class RangeReader {
+ public:
+  virtual ~RangeReader() = default;
+
+  // the size of the file in bytes
+  virtual uint64_t size(const std::string &fname) = 0;
+
+  // reads len bytes of the file at offset into buf, throws on failure
+  virtual void read(const std::string &fname, uint64_t offset, uint64_t len,
+                    void *buf) = 0;
+
+  // the reader the disk indexes load their files through, nullptr for none
+  static void SetGlobalRangeReader(std::shared_ptr<RangeReader> reader) {
+    std::scoped_lock lk(global_mtx);
+    global_reader = std::move(reader);
+  }
+
+  static std::shared_ptr<RangeReader> GetGlobalRangeReader() {
+    std::scoped_lock lk(global_mtx);
+    return global_reader;
+  }
+
+ private:
+  inline static std::mutex                   global_mtx;
+  inline static std::shared_ptr<RangeReader> global_reader;
+};
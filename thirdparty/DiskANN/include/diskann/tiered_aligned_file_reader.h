@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "aligned_file_reader.h"
+#include "range_reader.h"
+
+// An AlignedFileReader that serves a file before it is downloaded. The local
+// file is created sparse at the size of the stored one and acts as a block
+// cache in front of the RangeReader: the reads go to the local reader once
+// the blocks they cover have been fetched, the missing ones are fetched first
+// with ranged reads. A background thread fetches the other blocks in order
+// until the whole file is local, after which the reads cost the local ones.
+class TieredAlignedFileReader : public AlignedFileReader {
+ public:
+  // the blocks are the unit of the ranged reads
+  static constexpr uint64_t default_block_size = 1 << 20;
+
+  TieredAlignedFileReader(std::shared_ptr<AlignedFileReader> local,
+                          std::shared_ptr<RangeReader>       remote,
+                          uint64_t block_size = default_block_size);
+  ~TieredAlignedFileReader();
+
+  // creates the local file and fetches its first block, which holds the
+  // metadata the index reads before it opens the file, no-op if done
+  void prepare(const std::string &fname);
+
+  IOContext get_ctx() override {
+    return local_->get_ctx();
+  }
+
+  void put_ctx(IOContext ctx) override {
+    local_->put_ctx(ctx);
+  }
+
+  // Open & close ops
+  // Blocking calls
+  void open(const std::string &fname) override;
+  void close() override;
+
+  // process batch of aligned requests in parallel
+  // NOTE :: blocking call
+  void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx,
+            bool async = false) override;
+
+  // async reads
+  void get_submitted_req(io_context_t &ctx, size_t n_ops) override;
+  void submit_req(io_context_t &ctx, std::vector<AlignedRead> &read_reqs) override;
+
+  bool fully_fetched() const noexcept {
+    return num_fetched_.load(std::memory_order_acquire) == num_blocks_;
+  }
+
+ private:
+  enum BlockState : uint8_t { absent = 0, fetching = 1, present = 2 };
+
+  void fetch_range(uint64_t offset, uint64_t len);
+  void fetch_block(uint64_t block);
+  void prefetch();
+  void stop_prefetch();
+
+  std::shared_ptr<AlignedFileReader> local_;
+  std::shared_ptr<RangeReader>       remote_;
+  uint64_t                           block_size_;
+
+  std::string fname_;
+  FileHandle  write_fd_ = -1;
+  uint64_t    file_size_ = 0;
+  uint64_t    num_blocks_ = 0;
+
+  std::unique_ptr<std::atomic<uint8_t>[]> block_states_;
+  std::atomic<uint64_t>                   num_fetched_{0};
+  // wakes up the readers waiting for a block fetched by another thread
+  std::mutex              fetch_mtx_;
+  std::condition_variable fetch_cv_;
+
+  std::thread       prefetcher_;
+  std::atomic<bool> stop_prefetch_{false};
+};
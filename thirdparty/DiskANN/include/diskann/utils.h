@@ -863,6 +863,11 @@ namespace diskann {
         return disk_index_filename + "_centroids.bin";
     }
 
+    inline std::string get_disk_index_layout_filename(
+        const std::string& disk_index_filename) {
+        return disk_index_filename + "_layout.bin";
+    }
+
     inline std::string get_sample_data_filename(const std::string& prefix) {
         return prefix + "_sample_data.bin";
     }
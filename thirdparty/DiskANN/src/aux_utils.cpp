@@ -4,7 +4,9 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <deque>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <set>
 #include <string>
@@ -475,7 +477,7 @@ namespace diskann {
       std::string base_file, bool ip_prepared, diskann::Metric compareMetric,
       unsigned L, unsigned R, bool accelerate_build, bool shuffle_build, double sampling_rate,
       double ram_budget, std::string mem_index_path, std::string medoids_file,
-      std::string centroids_file) {
+      std::string centroids_file, unsigned shard_parallelism) {
     size_t base_num, base_dim;
     diskann::get_bin_metadata(base_file, base_num, base_dim);
 
@@ -507,15 +509,17 @@ namespace diskann {
       std::remove(centroids_file.c_str());
       return _pvamanaIndex;
     }
+    // the shards built at once share the budget
+    shard_parallelism = std::max(shard_parallelism, 1u);
     std::string merged_index_prefix = mem_index_path + "_tempFiles";
-    int         num_parts =
-        partition_with_ram_budget<T>(base_file, sampling_rate, ram_budget,
-                                     2 * R / 3, merged_index_prefix, 2);
+    int         num_parts = partition_with_ram_budget<T>(
+        base_file, sampling_rate, ram_budget / shard_parallelism, 2 * R / 3,
+        merged_index_prefix, 2);
 
     std::string cur_centroid_filepath = merged_index_prefix + "_centroids.bin";
     std::rename(cur_centroid_filepath.c_str(), centroids_file.c_str());
 
-    for (int p = 0; p < num_parts; p++) {
+    auto build_shard = [&](int p) {
       std::string shard_base_file =
           merged_index_prefix + "_subshard-" + std::to_string(p) + ".bin";
 
@@ -547,6 +551,30 @@ namespace diskann {
       _pvamanaIndex->build(shard_base_file.c_str(), shard_base_pts, paras);
       _pvamanaIndex->save(shard_index_file.c_str());
       std::remove(shard_base_file.c_str());
+    };
+
+    if (shard_parallelism == 1 || num_parts == 1) {
+      for (int p = 0; p < num_parts; p++) {
+        build_shard(p);
+      }
+    } else {
+      // the workers are not tasks of the build pool, as the building of a
+      // shard waits for its own tasks on that pool
+      LOG_KNOWHERE_INFO_ << "Building " << num_parts << " shards, "
+                         << shard_parallelism << " at a time";
+      std::atomic<int>               next_part = 0;
+      std::vector<std::future<void>> workers;
+      for (unsigned w = 0; w < std::min<unsigned>(shard_parallelism, num_parts);
+           w++) {
+        workers.emplace_back(std::async(std::launch::async, [&]() {
+          for (int p = next_part++; p < num_parts; p = next_part++) {
+            build_shard(p);
+          }
+        }));
+      }
+      for (auto &worker : workers) {
+        worker.get();
+      }
     }
 
     diskann::merge_shards(merged_index_prefix + "_subshard-", "_mem.index",
@@ -818,11 +846,91 @@ namespace diskann {
     return best_bw;
   }
 
+  // Packs the nodes into sectors of nnodes_per_sector by the graph rather
+  // than by id: a sector is filled with a node and then with the nodes it
+  // links to, breadth first, so that the read of a node during a search also
+  // brings the nodes the search likely visits next. The sectors are started
+  // from the medoid outwards. Returns the node of each slot of the layout.
+  static std::vector<_u32> get_graph_layout(std::ifstream           &vamana_reader,
+                                            const std::vector<_u64> &node_pos,
+                                            _u64 medoid, _u64 nnodes_per_sector,
+                                            unsigned width) {
+    const _u64              npts = node_pos.size();
+    std::vector<_u32>       layout;
+    std::vector<_u32>       members;
+    std::vector<unsigned>   nbrs(width);
+    std::deque<_u32>        seeds;
+    boost::dynamic_bitset<> placed(npts), queued(npts);
+    _u64                    next_unplaced = 0;
+    layout.reserve(npts);
+    members.reserve(nnodes_per_sector);
+
+    seeds.push_back((_u32) medoid);
+    queued.set(medoid);
+    auto next_seed = [&]() -> _u32 {
+      while (!seeds.empty() && placed.test(seeds.front())) {
+        seeds.pop_front();
+      }
+      if (!seeds.empty()) {
+        _u32 seed = seeds.front();
+        seeds.pop_front();
+        return seed;
+      }
+      // the nodes that the medoid does not reach
+      while (placed.test(next_unplaced)) {
+        next_unplaced++;
+      }
+      return (_u32) next_unplaced;
+    };
+    // adds the neighbors of the node to the sector while it has room, and
+    // keeps the others to start the next sectors
+    auto expand = [&](_u32 node_id) {
+      unsigned nnbrs;
+      vamana_reader.seekg(node_pos[node_id], vamana_reader.beg);
+      vamana_reader.read((char *) &nnbrs, sizeof(unsigned));
+      vamana_reader.read((char *) nbrs.data(), nnbrs * sizeof(unsigned));
+      for (unsigned i = 0; i < nnbrs; i++) {
+        _u32 id = nbrs[i];
+        if (placed.test(id)) {
+          continue;
+        }
+        if (members.size() < nnodes_per_sector &&
+            layout.size() + members.size() < npts) {
+          placed.set(id);
+          members.push_back(id);
+        } else if (!queued.test(id)) {
+          queued.set(id);
+          seeds.push_back(id);
+        }
+      }
+    };
+
+    while (layout.size() < npts) {
+      members.clear();
+      size_t next_member = 0;
+      while (members.size() < nnodes_per_sector &&
+             layout.size() + members.size() < npts) {
+        if (next_member == members.size()) {
+          _u32 seed = next_seed();
+          placed.set(seed);
+          members.push_back(seed);
+        }
+        expand(members[next_member++]);
+      }
+      for (; next_member < members.size(); next_member++) {
+        expand(members[next_member]);
+      }
+      layout.insert(layout.end(), members.begin(), members.end());
+    }
+    return layout;
+  }
+
   template<typename T>
   void create_disk_layout(const std::string base_file,
                           const std::string mem_index_file,
                           const std::string output_file,
-                          const std::string reorder_data_file) {
+                          const std::string reorder_data_file,
+                          const bool        optimize_layout) {
     unsigned npts, ndims;
 
     // amount to read or write in one shot
@@ -940,6 +1048,33 @@ namespace diskann {
     _u64 disk_index_file_size =
         (n_sectors + n_reorder_sectors + 1) * diskann::defaults::SECTOR_LEN;
 
+    // a layout only matters when a sector holds several nodes
+    const bool        graph_layout = optimize_layout && !long_node &&
+                              nnodes_per_sector > 1 && npts_64 > 1;
+    std::vector<_u32> layout;
+    std::vector<_u64> vamana_node_pos;
+    if (graph_layout) {
+      // offset of each node in the vamana index file
+      vamana_node_pos.resize(npts_64);
+      _u64 offset = vamana_reader.tellg();
+      for (_u64 i = 0; i < npts_64; i++) {
+        unsigned nnbrs;
+        vamana_node_pos[i] = offset;
+        vamana_reader.read((char *) &nnbrs, sizeof(unsigned));
+        vamana_reader.seekg(nnbrs * sizeof(unsigned), vamana_reader.cur);
+        offset += (nnbrs + 1) * sizeof(unsigned);
+      }
+      layout = get_graph_layout(vamana_reader, vamana_node_pos, medoid,
+                                nnodes_per_sector, width_u32);
+      save_bin<_u32>(get_disk_index_layout_filename(output_file),
+                     layout.data(), npts_64, 1);
+      // the base data is no longer read sequentially
+      base_reader.set_cache_size(
+          ROUND_UP(sizeof(T) * ndims_64, diskann::defaults::SECTOR_LEN));
+      LOG_KNOWHERE_INFO_ << "Packed " << npts_64 << " nodes into sectors of "
+                         << nnodes_per_sector << " by the graph";
+    }
+
     // SECTOR_LEN buffer for each sector
     _u64 sector_buf_size =
         long_node ? nsector_per_node * diskann::defaults::SECTOR_LEN : diskann::defaults::SECTOR_LEN;
@@ -961,6 +1096,7 @@ namespace diskann {
       *(_u64 *) (sector_buf.get() + 10 * sizeof(_u64)) =
           n_data_nodes_per_sector;
     }
+    *(_u64 *) (sector_buf.get() + 11 * sizeof(_u64)) = graph_layout;
 
     diskann_writer.write(sector_buf.get(), diskann::defaults::SECTOR_LEN);
 
@@ -1006,6 +1142,13 @@ namespace diskann {
         char *nhood_buf =
             sector_node_buf + (ndims_64 * sizeof(T)) + sizeof(unsigned);
 
+        if (graph_layout) {
+          _u64 node_id = layout[cur_node_id];
+          vamana_reader.seekg(vamana_node_pos[node_id], vamana_reader.beg);
+          base_reader.seek(2 * sizeof(uint32_t) +
+                           node_id * sizeof(T) * ndims_64);
+        }
+
         // read cur node's nnbrs
         vamana_reader.read(nnbrs, sizeof(unsigned));
 
@@ -1835,6 +1978,22 @@ template<typename T>
     auto pq_e = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> pq_diff = pq_e - pq_s;
     LOG_KNOWHERE_INFO_ << "Training PQ codes cost: " << pq_diff.count() << "s";
+
+    // gives up the build, removing the intermediate files, if it is cancelled
+    auto cancelled = [&]() {
+      if (config.cancelled == nullptr || !config.cancelled->load()) {
+        return false;
+      }
+      LOG_KNOWHERE_INFO_ << "Index build cancelled";
+      if (config.compare_metric == diskann::Metric::INNER_PRODUCT) {
+        std::remove(data_file_to_use.c_str());
+      }
+      std::remove(mem_index_path.c_str());
+      return true;
+    };
+    if (cancelled()) {
+      return -1;
+    }
 // Gopal. Splitting diskann_dll into separate DLLs for search and build.
 // This code should only be available in the "build" DLL.
 #if defined(RELEASE_UNUSED_TCMALLOC_MEMORY_AT_CHECKPOINTS) && \
@@ -1846,10 +2005,13 @@ template<typename T>
     auto vamana_index = diskann::build_merged_vamana_index<T>(
         data_file_to_use.c_str(), ip_prepared, diskann::Metric::L2, L, R,
         config.accelerate_build, config.shuffle_build, p_val, indexing_ram_budget, mem_index_path,
-        medoids_path, centroids_path);
+        medoids_path, centroids_path, config.shard_parallelism);
     auto graph_e = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> graph_diff = graph_e - graph_s;
     LOG_KNOWHERE_INFO_ << "Training graph cost: " << graph_diff.count() << "s";
+    if (cancelled()) {
+      return -1;
+    }
     if (config.aisaq_mode) {
         bool rearrange = config.rearrange;
         int inline_pq = config.inline_pq;
@@ -1902,15 +2064,19 @@ template<typename T>
     {
         if (!use_disk_pq) {
           diskann::create_disk_layout<T>(data_file_to_save.c_str(), mem_index_path,
-                                         disk_index_path);
+                                         disk_index_path, std::string(""),
+                                         config.optimize_layout);
         } else {
           if (!reorder_data)
             diskann::create_disk_layout<_u8>(disk_pq_compressed_vectors_path,
-                                             mem_index_path, disk_index_path);
+                                             mem_index_path, disk_index_path,
+                                             std::string(""),
+                                             config.optimize_layout);
           else
             diskann::create_disk_layout<_u8>(disk_pq_compressed_vectors_path,
                                              mem_index_path, disk_index_path,
-                                             data_file_to_save.c_str());
+                                             data_file_to_save.c_str(),
+                                             config.optimize_layout);
         }
     }
     double ten_percent_points = std::ceil(points_num * 0.1);
@@ -1956,20 +2122,25 @@ template<typename T>
   template void create_disk_layout<int8_t>(const std::string base_file,
                                            const std::string mem_index_file,
                                            const std::string output_file,
-                                           const std::string reorder_data_file);
+                                           const std::string reorder_data_file,
+                                           const bool        optimize_layout);
   template void create_disk_layout<uint8_t>(
       const std::string base_file, const std::string mem_index_file,
-      const std::string output_file, const std::string reorder_data_file);
+      const std::string output_file, const std::string reorder_data_file,
+      const bool optimize_layout);
   template void create_disk_layout<float>(const std::string base_file,
                                           const std::string mem_index_file,
                                           const std::string output_file,
-                                          const std::string reorder_data_file);
+                                          const std::string reorder_data_file,
+                                          const bool        optimize_layout);
   template void create_disk_layout<knowhere::fp16>(
       const std::string base_file, const std::string mem_index_file,
-      const std::string output_file, const std::string reorder_data_file);
+      const std::string output_file, const std::string reorder_data_file,
+      const bool optimize_layout);
   template void create_disk_layout<knowhere::bf16>(
       const std::string base_file, const std::string mem_index_file,
-      const std::string output_file, const std::string reorder_data_file);
+      const std::string output_file, const std::string reorder_data_file,
+      const bool optimize_layout);
 
   template int8_t  *load_warmup<int8_t>(const std::string &cache_warmup_file,
                                        uint64_t          &warmup_num,
@@ -2028,31 +2199,36 @@ template<typename T>
       std::string base_file, bool ip_prepared, diskann::Metric compareMetric,
       unsigned L, unsigned R, bool accelerate_build, bool shuffle_build,
       double sampling_rate, double ram_budget, std::string mem_index_path,
-      std::string medoids_path, std::string centroids_file);
+      std::string medoids_path, std::string centroids_file,
+      unsigned shard_parallelism);
   template std::unique_ptr<diskann::Index<float>>
   build_merged_vamana_index<float>(
       std::string base_file, bool ip_prepared, diskann::Metric compareMetric,
       unsigned L, unsigned R, bool accelerate_build, bool shuffle_build,
       double sampling_rate, double ram_budget, std::string mem_index_path,
-      std::string medoids_path, std::string centroids_file);
+      std::string medoids_path, std::string centroids_file,
+      unsigned shard_parallelism);
   template std::unique_ptr<diskann::Index<uint8_t>>
   build_merged_vamana_index<uint8_t>(
       std::string base_file, bool ip_prepared, diskann::Metric compareMetric,
       unsigned L, unsigned R, bool accelerate_build, bool shuffle_build,
       double sampling_rate, double ram_budget, std::string mem_index_path,
-      std::string medoids_path, std::string centroids_file);
+      std::string medoids_path, std::string centroids_file,
+      unsigned shard_parallelism);
   template std::unique_ptr<diskann::Index<knowhere::fp16>>
   build_merged_vamana_index<knowhere::fp16>(
       std::string base_file, bool ip_prepared, diskann::Metric compareMetric,
       unsigned L, unsigned R, bool accelerate_build, bool shuffle_build,
       double sampling_rate, double ram_budget, std::string mem_index_path,
-      std::string medoids_path, std::string centroids_file);
+      std::string medoids_path, std::string centroids_file,
+      unsigned shard_parallelism);
   template std::unique_ptr<diskann::Index<knowhere::bf16>>
   build_merged_vamana_index<knowhere::bf16>(
       std::string base_file, bool ip_prepared, diskann::Metric compareMetric,
       unsigned L, unsigned R, bool accelerate_build, bool shuffle_build,
       double sampling_rate, double ram_budget, std::string mem_index_path,
-      std::string medoids_path, std::string centroids_file);
+      std::string medoids_path, std::string centroids_file,
+      unsigned shard_parallelism);
 
   template void generate_cache_list_from_graph_with_pq<int8_t>(
       _u64 num_nodes_to_cache, unsigned R, const diskann::Metric compare_metric,
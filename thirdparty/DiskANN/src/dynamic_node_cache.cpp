@@ -0,0 +1,180 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/dynamic_node_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+  // the sketch has at least this many counters per row
+  static constexpr _u64 min_sketch_width = 64;
+  // the sketch is halved after this many reads per counter of a row
+  static constexpr _u64 sample_factor = 10;
+
+  _u64 get_sketch_width(_u64 num_slots) {
+    _u64 width = min_sketch_width;
+    while (width < num_slots) {
+      width <<= 1;
+    }
+    return width;
+  }
+}  // namespace
+
+namespace diskann {
+
+  DynamicNodeCache::DynamicNodeCache(_u64 num_points, _u64 node_len,
+                                     _u64 num_slots)
+      : num_points(num_points), node_len(node_len), num_slots(num_slots) {
+    slots = std::make_unique<Slot[]>(num_slots);
+    slot_data = std::make_unique<char[]>(num_slots * node_len);
+    id_to_slot = std::make_unique<std::atomic<_u32>[]>(num_points);
+    for (_u64 i = 0; i < num_points; i++) {
+      id_to_slot[i].store(empty_slot, std::memory_order_relaxed);
+    }
+    sketch_width = get_sketch_width(num_slots);
+    sketch = std::make_unique<std::atomic<_u8>[]>(sketch_depth * sketch_width);
+    for (_u64 i = 0; i < sketch_depth * sketch_width; i++) {
+      sketch[i].store(0, std::memory_order_relaxed);
+    }
+    sample_size = sample_factor * sketch_width;
+  }
+
+  _u64 DynamicNodeCache::get_num_slots(_u64 num_points, _u64 node_len,
+                                       _u64 budget_bytes) {
+    _u64 table_bytes = num_points * sizeof(std::atomic<_u32>);
+    if (budget_bytes <= table_bytes) {
+      return 0;
+    }
+    // a row of the sketch has less than two counters per slot
+    _u64 slot_bytes = node_len + sizeof(Slot) + 2 * sketch_depth;
+    return std::min((budget_bytes - table_bytes) / slot_bytes, num_points);
+  }
+
+  _u64 DynamicNodeCache::cal_size() const noexcept {
+    return num_slots * (node_len + sizeof(Slot)) +
+           num_points * sizeof(std::atomic<_u32>) + sketch_depth * sketch_width;
+  }
+
+  _u64 DynamicNodeCache::sketch_index(_u32 id, _u32 row) const {
+    // splitmix64 finalizer, seeded by the row
+    _u64 h = ((_u64) id << 2 | row) + 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return row * sketch_width + (h & (sketch_width - 1));
+  }
+
+  _u32 DynamicNodeCache::estimate_frequency(_u32 id) const {
+    _u32 freq = std::numeric_limits<_u8>::max();
+    for (_u32 row = 0; row < sketch_depth; row++) {
+      freq = std::min<_u32>(
+          freq, sketch[sketch_index(id, row)].load(std::memory_order_relaxed));
+    }
+    return freq;
+  }
+
+  _u32 DynamicNodeCache::increment_frequency(_u32 id) {
+    _u64 indices[sketch_depth];
+    _u8  counts[sketch_depth];
+    _u8  freq = std::numeric_limits<_u8>::max();
+    for (_u32 row = 0; row < sketch_depth; row++) {
+      indices[row] = sketch_index(id, row);
+      counts[row] = sketch[indices[row]].load(std::memory_order_relaxed);
+      freq = std::min(freq, counts[row]);
+    }
+    // conservative update: only the smallest counters are raised, a lost
+    // race only loses a count
+    if (freq < std::numeric_limits<_u8>::max()) {
+      for (_u32 row = 0; row < sketch_depth; row++) {
+        if (counts[row] == freq) {
+          sketch[indices[row]].compare_exchange_weak(
+              counts[row], freq + 1, std::memory_order_relaxed);
+        }
+      }
+      freq++;
+    }
+    if (num_samples.fetch_add(1, std::memory_order_relaxed) + 1 >=
+        sample_size) {
+      age_sketch();
+    }
+    return freq;
+  }
+
+  void DynamicNodeCache::age_sketch() {
+    if (aging.exchange(true, std::memory_order_acquire)) {
+      return;
+    }
+    for (_u64 i = 0; i < sketch_depth * sketch_width; i++) {
+      sketch[i].store(sketch[i].load(std::memory_order_relaxed) >> 1,
+                      std::memory_order_relaxed);
+    }
+    num_samples.store(0, std::memory_order_relaxed);
+    aging.store(false, std::memory_order_release);
+  }
+
+  bool DynamicNodeCache::lookup(_u32 id, char *buf) {
+    _u32 s = id_to_slot[id].load(std::memory_order_acquire);
+    if (s == empty_slot) {
+      return false;
+    }
+    Slot &slot = slots[s];
+    _u32  version = slot.version.load(std::memory_order_acquire);
+    if ((version & 1) != 0 ||
+        slot.id.load(std::memory_order_relaxed) != id) {
+      return false;
+    }
+    std::memcpy(buf, slot_data.get() + s * node_len, node_len);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != version) {
+      return false;
+    }
+    if (!slot.referenced.load(std::memory_order_relaxed)) {
+      slot.referenced.store(true, std::memory_order_relaxed);
+    }
+    increment_frequency(id);
+    return true;
+  }
+
+  void DynamicNodeCache::record(_u32 id, const char *node_buf) {
+    _u32 freq = increment_frequency(id);
+    if (id_to_slot[id].load(std::memory_order_relaxed) != empty_slot) {
+      return;
+    }
+    for (_u32 i = 0; i < max_clock_scan; i++) {
+      _u64  s = clock_hand.fetch_add(1, std::memory_order_relaxed) % num_slots;
+      Slot &slot = slots[s];
+      // second chance for the slots hit since the hand last passed
+      if (slot.referenced.exchange(false, std::memory_order_relaxed)) {
+        continue;
+      }
+      _u32 version = slot.version.load(std::memory_order_acquire);
+      if ((version & 1) != 0) {
+        continue;
+      }
+      _u32 victim = slot.id.load(std::memory_order_relaxed);
+      if (victim != empty_slot && estimate_frequency(victim) >= freq) {
+        return;
+      }
+      if (!slot.version.compare_exchange_strong(version, version + 1,
+                                                std::memory_order_acq_rel)) {
+        continue;
+      }
+      std::atomic_thread_fence(std::memory_order_release);
+      if (victim != empty_slot) {
+        _u32 expected = (_u32) s;
+        id_to_slot[victim].compare_exchange_strong(expected, empty_slot,
+                                                   std::memory_order_relaxed);
+      }
+      std::memcpy(slot_data.get() + s * node_len, node_buf, node_len);
+      // another thread may have cached the node meanwhile, the slot is left
+      // empty then
+      _u32 expected = empty_slot;
+      bool owned = id_to_slot[id].compare_exchange_strong(
+          expected, (_u32) s, std::memory_order_relaxed);
+      slot.id.store(owned ? id : empty_slot, std::memory_order_relaxed);
+      slot.version.store(version + 2, std::memory_order_release);
+      return;
+    }
+  }
+}  // namespace diskann
@@ -120,9 +120,11 @@ namespace {
   }
 }  // namespace
 
-LinuxAlignedFileReader::LinuxAlignedFileReader() {
+LinuxAlignedFileReader::LinuxAlignedFileReader(int io_priority) {
   this->file_desc = -1;
   this->ctx_pool_ = AioContextPool::GetGlobalAioPool();
+  this->io_scheduler_ = IOScheduler::GetGlobalIOScheduler();
+  this->io_client_ = this->io_scheduler_->register_client(io_priority);
 }
 
 LinuxAlignedFileReader::~LinuxAlignedFileReader() {
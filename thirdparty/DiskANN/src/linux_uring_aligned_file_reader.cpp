@@ -0,0 +1,229 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#ifdef KNOWHERE_WITH_IO_URING
+
+#include "diskann/linux_uring_aligned_file_reader.h"
+
+#include <cassert>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include "diskann/ann_exception.h"
+#include "diskann/utils.h"
+
+namespace {
+  // how long the kernel thread of a sqpoll ring spins before sleeping
+  static constexpr unsigned sq_thread_idle_ms = 2000;
+
+  struct io_uring *to_ring(IOContext ctx) {
+    return reinterpret_cast<struct io_uring *>(ctx);
+  }
+
+  [[noreturn]] void throw_uring_error(const char *call, int err) {
+    std::stringstream msg;
+    msg << "Unknown error occur in " << call << ", errno: " << err << ", "
+        << strerror(err);
+    throw diskann::ANNException(msg.str(), -1, __FUNCSIG__, __FILE__,
+                                __LINE__);
+  }
+
+  // queues the reads on the registered file of the ring and submits them,
+  // n_ops must not exceed the free entries of the submission queue
+  void submit_reads(struct io_uring *ring, const AlignedRead *reqs,
+                    size_t n_ops) {
+    for (size_t j = 0; j < n_ops; j++) {
+      struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+      assert(sqe != nullptr);
+      io_uring_prep_read(sqe, 0, reqs[j].buf, reqs[j].len, reqs[j].offset);
+      sqe->flags |= IOSQE_FIXED_FILE;
+    }
+
+    // the entries not taken by the kernel stay queued for the next submit
+    size_t num_submitted = 0;
+    while (num_submitted < n_ops) {
+      int ret = io_uring_submit(ring);
+      if (ret < 0) {
+        if (-ret != EINTR && -ret != EAGAIN && -ret != EBUSY) {
+          throw_uring_error("io_uring_submit", -ret);
+        }
+        continue;
+      }
+      num_submitted += ret;
+    }
+  }
+
+  // waits for n_ops completions of the ring, at most ring_entries
+  void reap_reads(struct io_uring *ring, size_t n_ops) {
+    struct io_uring_cqe *cqes[LinuxUringAlignedFileReader::ring_entries];
+    size_t               num_read = 0;
+    while (num_read < n_ops) {
+      struct io_uring_cqe *cqe = nullptr;
+      int ret = io_uring_wait_cqe_nr(ring, &cqe, n_ops - num_read);
+      if (ret < 0) {
+        if (-ret == EINTR || -ret == EAGAIN) {
+          continue;
+        }
+        throw_uring_error("io_uring_wait_cqe_nr", -ret);
+      }
+      unsigned n = io_uring_peek_batch_cqe(ring, cqes, n_ops - num_read);
+      int      err = 0;
+      for (unsigned i = 0; i < n; i++) {
+        if (cqes[i]->res < 0 && err == 0) {
+          err = -cqes[i]->res;
+        }
+      }
+      io_uring_cq_advance(ring, n);
+      num_read += n;
+      if (err != 0) {
+        // reap the rest first so that the ring can be reused
+        reap_reads(ring, n_ops - num_read);
+        throw_uring_error("io_uring read", err);
+      }
+    }
+  }
+}  // namespace
+
+LinuxUringAlignedFileReader::LinuxUringAlignedFileReader(bool sqpoll,
+                                                         int  io_priority)
+    : file_desc(-1), sqpoll_(sqpoll),
+      io_scheduler_(IOScheduler::GetGlobalIOScheduler()),
+      io_client_(io_scheduler_->register_client(io_priority)) {
+}
+
+LinuxUringAlignedFileReader::~LinuxUringAlignedFileReader() {
+  destroy_rings();
+  if (this->file_desc != -1) {
+    ::close(this->file_desc);
+  }
+}
+
+struct io_uring *LinuxUringAlignedFileReader::create_ring() {
+  auto                   ring = std::make_unique<struct io_uring>();
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  if (sqpoll_) {
+    params.flags |= IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = sq_thread_idle_ms;
+    if (!rings_.empty()) {
+      // share the polling thread of the first ring
+      params.flags |= IORING_SETUP_ATTACH_WQ;
+      params.wq_fd = rings_.front()->ring_fd;
+    }
+  }
+  int ret = io_uring_queue_init_params(ring_entries, ring.get(), &params);
+  if (ret < 0) {
+    throw_uring_error("io_uring_queue_init_params", -ret);
+  }
+  ret = io_uring_register_files(ring.get(), &this->file_desc, 1);
+  if (ret < 0) {
+    io_uring_queue_exit(ring.get());
+    throw_uring_error("io_uring_register_files", -ret);
+  }
+  rings_.push_back(std::move(ring));
+  return rings_.back().get();
+}
+
+void LinuxUringAlignedFileReader::destroy_rings() {
+  std::scoped_lock lk(rings_mut_);
+  for (auto &ring : rings_) {
+    io_uring_queue_exit(ring.get());
+  }
+  rings_.clear();
+  free_rings_.clear();
+}
+
+IOContext LinuxUringAlignedFileReader::get_ctx() {
+  io_scheduler_->acquire(*io_client_);
+  std::scoped_lock lk(rings_mut_);
+  struct io_uring *ring;
+  if (free_rings_.empty()) {
+    try {
+      ring = create_ring();
+    } catch (...) {
+      io_scheduler_->release(*io_client_);
+      throw;
+    }
+  } else {
+    ring = free_rings_.back();
+    free_rings_.pop_back();
+  }
+  return reinterpret_cast<IOContext>(ring);
+}
+
+void LinuxUringAlignedFileReader::put_ctx(IOContext ctx) {
+  if (ctx == nullptr) {
+    return;
+  }
+  {
+    std::scoped_lock lk(rings_mut_);
+    free_rings_.push_back(to_ring(ctx));
+  }
+  io_scheduler_->release(*io_client_);
+}
+
+void LinuxUringAlignedFileReader::open(const std::string &fname) {
+  int flags = O_DIRECT | O_RDONLY | O_LARGEFILE;
+  this->file_desc = ::open(fname.c_str(), flags);
+  if (this->file_desc == -1) {
+    std::stringstream err;
+    err << "Failed to open " << fname << ", errno: " << errno << ", "
+        << strerror(errno);
+    throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__,
+                                __LINE__);
+  }
+  // set up a first ring now so that a kernel without io_uring support fails
+  // the load instead of the first search
+  std::scoped_lock lk(rings_mut_);
+  free_rings_.push_back(create_ring());
+  LOG_KNOWHERE_DEBUG_ << "Opened file : " << fname << " with io_uring"
+                      << (sqpoll_ ? " sqpoll" : "");
+}
+
+void LinuxUringAlignedFileReader::close() {
+  destroy_rings();
+  if (this->file_desc != -1) {
+    ::close(this->file_desc);
+    this->file_desc = -1;
+  }
+}
+
+void LinuxUringAlignedFileReader::read(std::vector<AlignedRead> &read_reqs,
+                                       IOContext &ctx, bool async) {
+  if (async == true) {
+    diskann::cout << "Async currently not supported in linux." << std::endl;
+  }
+  assert(this->file_desc != -1);
+
+  auto ring = to_ring(ctx);
+  for (size_t i = 0; i < read_reqs.size(); i += ring_entries) {
+    size_t n_ops = std::min<size_t>(read_reqs.size() - i, ring_entries);
+    submit_reads(ring, read_reqs.data() + i, n_ops);
+    reap_reads(ring, n_ops);
+  }
+}
+
+void LinuxUringAlignedFileReader::submit_req(
+    io_context_t &ctx, std::vector<AlignedRead> &read_reqs) {
+  if (read_reqs.size() > ring_entries) {
+    std::stringstream err;
+    err << "Async does not support number of read requests ("
+        << read_reqs.size() << ") exceeds the number of ring entries ("
+        << ring_entries << ")";
+    throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+  }
+  submit_reads(to_ring(ctx), read_reqs.data(), read_reqs.size());
+}
+
+void LinuxUringAlignedFileReader::get_submitted_req(io_context_t &ctx,
+                                                    size_t        n_ops) {
+  if (n_ops > ring_entries) {
+    std::stringstream err;
+    err << "Async does not support getting number of read requests (" << n_ops
+        << ") exceeds the number of ring entries (" << ring_entries << ")";
+    throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+  }
+  reap_reads(to_ring(ctx), n_ops);
+}
+
+#endif
@@ -181,6 +181,7 @@ void PQFlashAisaqIndex<T>::aisaq_async_generate_cache_list_from_sample_queries(
             aisaq_search_config.pq_cache_size = 0;
             aisaq_search_config.pq_read_page_cache_size = 0;
             aisaq_search_config.vector_beamwidth = 1;
+            aisaq_search_config.speculative_reads = 0;
             while (this->search_counter.load() < sample_num && id < sample_num) {
                 {
                     std::unique_lock<std::mutex> guard(state_controller->status_mtx);
@@ -1427,9 +1428,11 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
 
     uint32_t bv = diskann::defaults::DEFAULT_AISAQ_VECTORS_BEAMWIDTH;
     uint64_t pq_read_page_cache_size = 0;
+    uint64_t speculative_reads = 0;
     if (aisaq_search_config != nullptr) {
         bv = aisaq_search_config->vector_beamwidth;
         pq_read_page_cache_size = aisaq_search_config->pq_read_page_cache_size;
+        speculative_reads = aisaq_search_config->speculative_reads;
     }
     // query <-> neighbor list
     float *dist_scratch = query_scratch->aligned_dist_scratch;
@@ -1485,6 +1488,9 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
     };
     auto ctx_pool = AioContextPool::GetGlobalAioPool();
     auto max_ios = ctx_pool->max_events_per_ctx();
+    /* the speculative reads are in flight along the reads of a hop */
+    speculative_reads = std::min<uint64_t>(
+        speculative_reads, max_ios > beam_width ? max_ios - beam_width : 0);
 
     Timer query_timer, io_timer, cpu_timer;
     if (aisaq_data.aisaq_pq_reader_ctx != nullptr) 
@@ -1540,6 +1546,24 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
         {agg_node_nbrs, agg_dist_scratch, agg_nnbrs},
         {agg_node_nbrs_inline, agg_dist_scratch_inline, agg_nnbrs_inline},
     };
+
+    /* speculative reads: the sectors of the best neighbours scored by a hop
+     * are read while the hop completes, and waited for along the reads of
+     * the next hop, whose frontier then holds them without reading them */
+    std::vector<AlignedRead> speculative_read_reqs;
+    speculative_read_reqs.reserve(speculative_reads);
+    std::vector<std::pair<float, uint32_t>> speculative_candidates;
+    /* the nodes read speculatively and not expanded yet */
+    tsl::robin_set<uint32_t> speculative_items;
+    /* the nodes freed while their speculative reads are in flight */
+    std::vector<uint32_t> deferred_free_ids;
+    uint64_t n_in_flight = 0;
+    auto wait_speculative_reads = [&]() {
+        if (n_in_flight > 0) {
+            this->reader->get_submitted_req(ctx, n_in_flight);
+            n_in_flight = 0;
+        }
+    };
     /* initialize free nodes pool */
     cpu_timer.reset();
     while (retset.has_unexpanded_node()) {
@@ -1575,6 +1599,7 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
                     if (frontier_iter == frontier_items.end()) {
                         /* Not in frontier map. Needs to be read */
                         if (aisaq_data.aisaq_scratch_mem_offset.empty()) {
+                            wait_speculative_reads();
                         	release_data();
                             throw ANNException("No free nodes, increase "
                                                "defaults::MAX_N_SECTOR_READS.",
@@ -1600,6 +1625,10 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
                         np[bv_count].is_in_cache = false;
                         np[bv_count].ptr = buf;
                         bv_count++;
+                        if (speculative_items.erase(id) > 0 &&
+                            stats != nullptr) {
+                            stats->n_speculative_hits++;
+                        }
                     }
                 }
                 if (bv_count <= bv) {
@@ -1630,14 +1659,29 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
         }
         /* #read frontier from disk */
         /* If frontier_read_req is not empty */
-        if (!frontier_read_reqs.empty()) {
+        if (!frontier_read_reqs.empty() || n_in_flight > 0) {
             io_timer.reset();
-            this->reader->read(frontier_read_reqs, ctx); // synchronous IO linux
+            if (n_in_flight == 0) {
+                this->reader->read(frontier_read_reqs, ctx); // synchronous IO linux
+            } else {
+                /* the speculative reads complete along the frontier */
+                if (!frontier_read_reqs.empty()) {
+                    this->reader->submit_req(ctx, frontier_read_reqs);
+                }
+                this->reader->get_submitted_req(
+                    ctx, n_in_flight + frontier_read_reqs.size());
+                n_in_flight = 0;
+                free_ids.insert(free_ids.end(), deferred_free_ids.begin(),
+                                deferred_free_ids.end());
+                deferred_free_ids.clear();
+            }
 
             if (stats != nullptr) {
                 stats->io_us += (float)io_timer.elapsed();
-                stats->n_hops++;
-                updata_io_stats(*stats, frontier_read_reqs.size(), num_sectors_per_node);
+                if (!frontier_read_reqs.empty()) {
+                    stats->n_hops++;
+                    updata_io_stats(*stats, frontier_read_reqs.size(), num_sectors_per_node);
+                }
             }
 
             frontier_read_reqs.clear();
@@ -1794,6 +1838,59 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
         }
         //}
         cpu_timer.reset();
+        /* #speculate on the best neighbours that enter retset, the PQ reads
+         * above share the IO context so they are issued after them */
+        if (speculative_reads > 0) {
+            const float worst = retset.size() == retset.capacity()
+                                    ? retset[retset.size() - 1].distance
+                                    : std::numeric_limits<float>::max();
+            speculative_candidates.clear();
+            for (uint32_t nl = 0;
+                nl < sizeof(agg_nbrs_lists) / sizeof(agg_nbrs_lists[0]); nl++) {
+                for (uint32_t m = 0; m < agg_nbrs_lists[nl].size; m++) {
+                    if (agg_nbrs_lists[nl].dist_list[m] < worst) {
+                        speculative_candidates.emplace_back(
+                            agg_nbrs_lists[nl].dist_list[m],
+                            agg_nbrs_lists[nl].nbrs_list[m]);
+                    }
+                }
+            }
+            std::sort(speculative_candidates.begin(),
+                      speculative_candidates.end());
+            for (const auto &candidate : speculative_candidates) {
+                /* the buffers of the next frontier are kept free */
+                if (speculative_read_reqs.size() == speculative_reads ||
+                    aisaq_data.aisaq_scratch_mem_offset.size() <= beam_width) {
+                    break;
+                }
+                id = candidate.second;
+                if (frontier_items.find(id) != frontier_items.end()) {
+                    continue;
+                }
+                {
+                    std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
+                    if (this->nhood_cache.find(id) != this->nhood_cache.end()) {
+                        continue;
+                    }
+                }
+                buf = sector_scratch + aisaq_data.aisaq_scratch_mem_offset.back();
+                aisaq_data.aisaq_scratch_mem_offset.pop_back();
+                speculative_read_reqs.emplace_back(
+                    get_node_sector((size_t)id) * defaults::SECTOR_LEN,
+                    num_sectors_per_node * defaults::SECTOR_LEN, buf);
+                frontier_items[id] = buf;
+                speculative_items.insert(id);
+            }
+            if (!speculative_read_reqs.empty()) {
+                this->reader->submit_req(ctx, speculative_read_reqs);
+                n_in_flight = speculative_read_reqs.size();
+                if (stats != nullptr) {
+                    stats->n_speculative_reads += n_in_flight;
+                    updata_io_stats(*stats, n_in_flight, num_sectors_per_node);
+                }
+                speculative_read_reqs.clear();
+            }
+        }
         // process prefetched nhood
         for (uint32_t nl = 0;
             nl < sizeof(agg_nbrs_lists) / sizeof(agg_nbrs_lists[0]); nl++) {
@@ -1812,6 +1909,12 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
         for (uint32_t free_it = 0; free_it < free_ids.size(); free_it++) {
             auto it = frontier_items.find(free_ids[free_it]);
             if (it != frontier_items.end()) {
+                if (speculative_items.erase(free_ids[free_it]) > 0 &&
+                    n_in_flight > 0) {
+                    /* its read may still be in flight */
+                    deferred_free_ids.push_back(free_ids[free_it]);
+                    continue;
+                }
                 aisaq_data.aisaq_scratch_mem_offset.push_back(it.value() -
                                                         sector_scratch);
                 frontier_items.erase(it);
@@ -1823,6 +1926,7 @@ void PQFlashAisaqIndex<T>::aisaq_cached_beam_search(
         }
         // hops++;
     }
+    wait_speculative_reads();
     /* clear page cache between queries */
     // PqVectorsOnDisk::getInstance()->clear_page_cache(&data->pq_ctx);
 
@@ -53,6 +53,9 @@ namespace {
 
   constexpr _u64  kRefineBeamWidthFactor = 2;
   constexpr _u64  kBruteForceTopkRefineExpansionFactor = 2;
+  // the rerank tier is in memory, it reranks more PQ candidates than the disk
+  constexpr _u64  kRerankTierExpansionFactor = 8;
+  constexpr _u64  kRerankTierReadsPerBatch = 32;
   constexpr float kFilterThreshold = 0.93f;
   constexpr float kAlpha = 0.15f;
 }  // namespace
@@ -516,6 +519,121 @@ namespace diskann {
     return;
   }
 
+  template<typename T>
+  _u64 PQFlashIndex<T>::setup_dynamic_cache(_u64 budget_bytes) {
+    _u64 num_slots = DynamicNodeCache::get_num_slots(
+        this->num_points, this->max_node_len, budget_bytes);
+    if (num_slots == 0) {
+      this->dynamic_cache.reset();
+      return 0;
+    }
+    this->dynamic_cache = std::make_unique<DynamicNodeCache>(
+        this->num_points, this->max_node_len, num_slots);
+    LOG_KNOWHERE_INFO_ << "Dynamic node cache set up for " << num_slots
+                       << " nodes";
+    return num_slots;
+  }
+
+  template<typename T>
+  bool PQFlashIndex<T>::load_rerank_tier(RerankTierType type,
+                                         _u64           budget_bytes) {
+    this->rerank_tier_type = RerankTierType::NONE;
+    this->rerank_tier_code_size = 0;
+    this->rerank_tier_codes.reset();
+    if (type == RerankTierType::NONE) {
+      return true;
+    }
+    if (use_disk_index_pq) {
+      LOG_KNOWHERE_WARNING_ << "The nodes hold disk PQ codes, no rerank tier";
+      return false;
+    }
+    const _u64 code_size = type == RerankTierType::SQ8
+                               ? data_dim + 2 * sizeof(float)
+                               : data_dim * sizeof(knowhere::fp16);
+    if (code_size * num_points > budget_bytes) {
+      return false;
+    }
+    auto codes = std::make_unique<_u8[]>(code_size * num_points);
+
+    // the nodes are read in the order of their slots, a sector of nodes or a
+    // node of several sectors per read
+    const _u64 nodes_per_read = long_node ? 1 : nnodes_per_sector;
+    const _u64 sectors_per_read = long_node ? nsectors_per_node : 1;
+    const _u64 num_reads = DIV_ROUND_UP(num_points, nodes_per_read);
+    char      *buf = nullptr;
+    alloc_aligned((void **) &buf, kRerankTierReadsPerBatch * read_len_for_node,
+                  diskann::defaults::SECTOR_LEN);
+    auto                     ctx = this->reader->get_ctx();
+    std::vector<AlignedRead> read_reqs;
+    read_reqs.reserve(kRerankTierReadsPerBatch);
+    std::vector<float> vec(data_dim);
+    for (_u64 first = 0; first < num_reads; first += kRerankTierReadsPerBatch) {
+      const _u64 last = std::min(num_reads, first + kRerankTierReadsPerBatch);
+      read_reqs.clear();
+      for (_u64 r = first; r < last; r++) {
+        read_reqs.emplace_back(
+            (r * sectors_per_read + 1) * diskann::defaults::SECTOR_LEN,
+            read_len_for_node, buf + (r - first) * read_len_for_node);
+      }
+      reader->read(read_reqs, ctx);
+
+      const _u64 last_slot = std::min(num_points, last * nodes_per_read);
+      for (_u64 slot = first * nodes_per_read; slot < last_slot; slot++) {
+        const _u64 id = layout_ids == nullptr ? slot : layout_ids[slot];
+        const T   *coords = OFFSET_TO_NODE_COORDS(
+            buf + (slot / nodes_per_read - first) * read_len_for_node +
+            (slot % nodes_per_read) * max_node_len);
+        _u8 *code = codes.get() + id * code_size;
+        if (type == RerankTierType::FP16) {
+          auto *h = reinterpret_cast<knowhere::fp16 *>(code);
+          for (_u64 i = 0; i < data_dim; i++) {
+            h[i] = knowhere::fp16((float) coords[i]);
+          }
+          continue;
+        }
+        for (_u64 i = 0; i < data_dim; i++) {
+          vec[i] = (float) coords[i];
+        }
+        const auto [vmin, vmax] = std::minmax_element(vec.begin(), vec.end());
+        const float lo = *vmin;
+        const float scale = (*vmax - lo) / 255.0f;
+        for (_u64 i = 0; i < data_dim; i++) {
+          code[i] = scale > 0 ? (_u8) std::lround((vec[i] - lo) / scale) : 0;
+        }
+        memcpy(code + data_dim, &lo, sizeof(float));
+        memcpy(code + data_dim + sizeof(float), &scale, sizeof(float));
+      }
+    }
+    this->reader->put_ctx(ctx);
+    aligned_free(buf);
+
+    this->rerank_tier_codes = std::move(codes);
+    this->rerank_tier_code_size = code_size;
+    this->rerank_tier_type = type;
+    LOG_KNOWHERE_INFO_ << "Rerank tier loaded for " << num_points
+                       << " nodes in " << code_size * num_points << " bytes";
+    return true;
+  }
+
+  template<typename T>
+  void PQFlashIndex<T>::decode_rerank_tier(_u64 node_id, T *coords) const {
+    const _u8 *code =
+        rerank_tier_codes.get() + node_id * rerank_tier_code_size;
+    if (rerank_tier_type == RerankTierType::FP16) {
+      const auto *h = reinterpret_cast<const knowhere::fp16 *>(code);
+      for (_u64 i = 0; i < data_dim; i++) {
+        coords[i] = (T) (float) h[i];
+      }
+      return;
+    }
+    float lo, scale;
+    memcpy(&lo, code + data_dim, sizeof(float));
+    memcpy(&scale, code + data_dim + sizeof(float), sizeof(float));
+    for (_u64 i = 0; i < data_dim; i++) {
+      coords[i] = (T) (lo + scale * code[i]);
+    }
+  }
+
   template<typename T>
   void PQFlashIndex<T>::cache_bfs_levels(_u64 num_nodes_to_cache,
                                          std::vector<uint32_t> &node_list) {
@@ -641,6 +759,25 @@ namespace diskann {
     LOG(INFO) << "done";
   }
 
+  template<typename T>
+  void PQFlashIndex<T>::load_layout(const std::string &layout_file) {
+    size_t npts, dim;
+    diskann::load_bin<_u32>(layout_file, layout_ids, npts, dim);
+    if (npts != num_points || dim != 1) {
+      std::stringstream stream;
+      stream << "Mismatch in #points for layout file and disk index file: "
+             << npts << " vs " << num_points;
+      throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+    layout_slots = std::make_unique<_u32[]>(num_points);
+    for (_u64 slot = 0; slot < num_points; slot++) {
+      layout_slots[layout_ids[slot]] = (_u32) slot;
+    }
+    LOG_KNOWHERE_INFO_ << "Loaded the optimized layout of " << num_points
+                       << " nodes from " << layout_file;
+  }
+
   template<typename T>
   void PQFlashIndex<T>::use_medoids_data_as_centroids() {
     if (centroid_data != nullptr)
@@ -820,13 +957,21 @@ namespace diskann {
       READ_U64(index_metadata, this->ndims_reorder_vecs);
       READ_U64(index_metadata, this->nvecs_per_sector);
     }
+    _u64 layout_optimized;
+    index_metadata.seekg(11 * sizeof(_u64), index_metadata.beg);
+    READ_U64(index_metadata, layout_optimized);
     LOG(INFO) << "Disk-Index File Meta-data: "
               << "# nodes per sector: " << nnodes_per_sector
               << ", max node len (bytes): " << max_node_len
-              << ", max node degree: " << max_degree;
+              << ", max node degree: " << max_degree
+              << ", optimized layout: " << layout_optimized;
 
     index_metadata.close();
 
+    if (layout_optimized) {
+      load_layout(get_disk_index_layout_filename(disk_index_file));
+    }
+
     // open AlignedFileReader handle to index_file
     std::string index_fname(disk_index_file);
     reader->open(index_fname);
@@ -941,7 +1086,7 @@ namespace diskann {
       IOContext &ctx, QueryStats *stats,
       const knowhere::feder::diskann::FederResultUniq &feder,
       knowhere::BitsetView                             bitset_view,
-	  PQDataGetter* pq_data_getter) {
+	  PQDataGetter* pq_data_getter, const bool exact_rerank) {
     auto         query_scratch = &(data.scratch);
     const T     *query = data.scratch.aligned_query_T;
     auto         beam_width = beam_width_param * kRefineBeamWidthFactor;
@@ -953,7 +1098,10 @@ namespace diskann {
     constexpr _u32 pq_batch_size = diskann::defaults::MAX_GRAPH_DEGREE;
     std::vector<unsigned> pq_batch_ids;
     pq_batch_ids.reserve(pq_batch_size);
-    const _u64 pq_topk = k_search * kBruteForceTopkRefineExpansionFactor;
+    const bool use_rerank_tier = rerank_tier_type != RerankTierType::NONE;
+    const _u64 pq_topk =
+        k_search * (use_rerank_tier ? kRerankTierExpansionFactor
+                                    : kBruteForceTopkRefineExpansionFactor);
     knowhere::ResultMaxHeap<float, int64_t> pq_max_heap(pq_topk);
     T *data_buf = query_scratch->coord_scratch;
     std::unordered_map<_u64, std::vector<_u64>> nodes_in_sectors_to_visit;
@@ -987,10 +1135,37 @@ namespace diskann {
       }
     }
     pq_data_getter->release_pq_data();
+    // the rerank tier gives the distances of the PQ candidates without IO,
+    // its top candidates are read from disk only for exact distances
+    std::vector<_u64> refine_ids;
+    refine_ids.reserve(pq_topk);
+    if (use_rerank_tier) {
+      knowhere::ResultMaxHeap<float, _u64> tier_heap(
+          k_search * kBruteForceTopkRefineExpansionFactor);
+      while (const auto opt = pq_max_heap.Pop()) {
+        const _u64 id = opt.value().second;
+        decode_rerank_tier(id, data_buf);
+        float dist = dist_cmp_wrap(query, data_buf, (size_t) aligned_dim, id);
+        if (exact_rerank) {
+          tier_heap.Push(dist, id);
+          continue;
+        }
+        max_heap.Push(dist, id);
+        if (feder != nullptr) {
+          feder->visit_info_.AddTopCandidateInfo(id, dist);
+          feder->id_set_.insert(id);
+        }
+      }
+      while (const auto opt = tier_heap.Pop()) {
+        refine_ids.push_back(opt.value().second);
+      }
+    } else {
+      while (const auto opt = pq_max_heap.Pop()) {
+        refine_ids.push_back(opt.value().second);
+      }
+    }
     // deduplicate sectors by ids
-    while (const auto opt = pq_max_heap.Pop()) {
-      const auto [dist, id] = opt.value();
-
+    for (const auto id : refine_ids) {
       // check if in cache
       {
         std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
@@ -1087,7 +1262,9 @@ namespace diskann {
       const T *query1, const _u64 k_search, const _u64 l_search, _s64 *indices,
       float *distances, const _u64 beam_width, const bool use_reorder_data,
       QueryStats *stats, const knowhere::feder::diskann::FederResultUniq &feder,
-      knowhere::BitsetView bitset_view, const float filter_ratio_in) {
+      knowhere::BitsetView bitset_view, const float filter_ratio_in,
+      const _u64 min_beam_width, const float skip_filtered_reads_ratio,
+      const bool exact_rerank) {
     if (beam_width > defaults::MAX_N_SECTOR_READS)
       throw ANNException("Beamwidth can not be higher than MAX_N_SECTOR_READS",
                          -1, __FUNCSIG__, __FILE__, __LINE__);
@@ -1108,6 +1285,7 @@ namespace diskann {
     auto  ctx = this->reader->get_ctx();
 
     size_t bv_cnt = 0;
+    bool   skip_filtered_reads = false;
 
     if (!bitset_view.empty()) {
       const auto filter_threshold =
@@ -1127,9 +1305,13 @@ namespace diskann {
         return;
       }
 
+      skip_filtered_reads =
+          bv_cnt >= bitset_view.size() * skip_filtered_reads_ratio;
+
       if (bv_cnt >= bitset_view.size() * filter_threshold) {
         brute_force_beam_search(data, query_norm, k_search, indices, distances,
-                                beam_width, ctx, stats, feder, bitset_view, this);
+                                beam_width, ctx, stats, feder, bitset_view, this,
+                                exact_rerank);
         this->thread_data.push(data);
         this->thread_data.push_notify_all();
         this->reader->put_ctx(ctx);
@@ -1140,7 +1322,8 @@ namespace diskann {
     // Turn to BF is k_search is too large
     if (k_search > 0.5 * (num_points - bv_cnt)) {
       brute_force_beam_search(data, query_norm, k_search, indices, distances,
-                              beam_width, ctx, stats, feder, bitset_view, this);
+                              beam_width, ctx, stats, feder, bitset_view, this,
+                              exact_rerank);
       this->thread_data.push(data);
       this->thread_data.push_notify_all();
       this->reader->put_ctx(ctx);
@@ -1169,6 +1352,9 @@ namespace diskann {
     std::vector<std::pair<unsigned, std::pair<unsigned, unsigned *>>>
         cached_nhoods;
     cached_nhoods.reserve(2 * beam_width);
+    // nodes of the dynamic cache, in the disk layout
+    std::vector<std::pair<unsigned, char *>> dynamic_nhoods;
+    dynamic_nhoods.reserve(2 * beam_width);
 
     // query <-> PQ chunk centers distances
     float *pq_dists = query_scratch->aligned_pqtable_dist_scratch;
@@ -1250,6 +1436,14 @@ namespace diskann {
       return {filtered_nbrs.size(), filtered_nbrs.data()};
     };
 
+    // an adaptive beam starts narrow and is halved while an iteration still
+    // improves the candidates ahead of k, since the reads of a wide beam are
+    // then mostly superseded by the next hop. It is doubled once the search
+    // converges, to read the remaining candidates in fewer round trips.
+    const bool adaptive_beam =
+        min_beam_width > 0 && min_beam_width < beam_width;
+    _u64 cur_beam_width = adaptive_beam ? min_beam_width : beam_width;
+
     while (k < cur_list_size) {
       auto nk = cur_list_size;
       // clear iteration state
@@ -1257,27 +1451,55 @@ namespace diskann {
       frontier_nhoods.clear();
       frontier_read_reqs.clear();
       cached_nhoods.clear();
+      dynamic_nhoods.clear();
       sector_scratch_idx = 0;
       // find new beam
       _u32 marker = k;
       _u32 num_seen = 0;
-      while (marker < cur_list_size && frontier.size() < beam_width &&
-             num_seen < beam_width) {
+      bool beam_has_unfiltered = false;
+      while (marker < cur_list_size && frontier.size() < cur_beam_width &&
+             num_seen < cur_beam_width) {
         if (retset[marker].flag) {
-          num_seen++;
+          bool cached = false;
           {
             std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
             auto iter = nhood_cache.find(retset[marker].id);
             if (iter != nhood_cache.end()) {
               cached_nhoods.push_back(
                   std::make_pair(retset[marker].id, iter->second));
-              if (stats != nullptr) {
-                stats->n_cache_hits++;
-              }
-            } else {
-              frontier.push_back(retset[marker].id);
+              cached = true;
+            }
+          }
+          if (!cached && dynamic_cache != nullptr) {
+            // the hits take the scratch slots that the reads would take
+            char *node_disk_buf =
+                sector_scratch + sector_scratch_idx * read_len_for_node;
+            if (dynamic_cache->lookup(retset[marker].id, node_disk_buf)) {
+              dynamic_nhoods.push_back(
+                  std::make_pair(retset[marker].id, node_disk_buf));
+              sector_scratch_idx++;
+              cached = true;
             }
           }
+          const bool filtered =
+              !bitset_view.empty() && bitset_view.test(retset[marker].id);
+          if (!cached && filtered && skip_filtered_reads &&
+              beam_has_unfiltered) {
+            // a filtered node is only read for its neighbors, which the
+            // unfiltered nodes closer to the query in the beam likely reach
+            // as well. It stays a candidate for the next iterations.
+            marker++;
+            continue;
+          }
+          num_seen++;
+          if (cached) {
+            if (stats != nullptr) {
+              stats->n_cache_hits++;
+            }
+          } else {
+            frontier.push_back(retset[marker].id);
+          }
+          beam_has_unfiltered |= !filtered;
           retset[marker].flag = false;
           {
             std::shared_lock<std::shared_mutex> lock(
@@ -1286,7 +1508,7 @@ namespace diskann {
               this->node_visit_counter[retset[marker].id].second->fetch_add(1);
             }
           }
-          if (!bitset_view.empty() && bitset_view.test(retset[marker].id)) {
+          if (filtered) {
             std::memmove(&retset[marker], &retset[marker + 1],
                          (cur_list_size - marker - 1) * sizeof(Neighbor));
             cur_list_size--;
@@ -1394,6 +1616,38 @@ namespace diskann {
         }
       };
 
+      // with an optimized layout the sector of a node mostly holds nodes it
+      // is co-visited with: the candidates among them are expanded from the
+      // sector already read instead of by a read of a later hop
+      auto expand_colocated = [&](_u32 node_id, char *sector_buf) {
+        const _u64 first_slot =
+            get_node_slot(node_id) / nnodes_per_sector * nnodes_per_sector;
+        const _u64 last_slot =
+            std::min(first_slot + nnodes_per_sector, num_points);
+        for (_u64 slot = first_slot; slot < last_slot; slot++) {
+          const _u32 id = layout_ids[slot];
+          if (id == node_id ||
+              (!bitset_view.empty() && bitset_view.test(id))) {
+            continue;
+          }
+          for (unsigned pos = 0; pos < cur_list_size; pos++) {
+            if (retset[pos].id != id) {
+              continue;
+            }
+            if (retset[pos].flag) {
+              retset[pos].flag = false;
+              char     *node_disk_buf = get_offset_to_node(sector_buf, id);
+              unsigned *node_buf = OFFSET_TO_NODE_NHOOD(node_disk_buf);
+              T        *node_fp_coords_copy = data_buf;
+              memcpy(node_fp_coords_copy, OFFSET_TO_NODE_COORDS(node_disk_buf),
+                     disk_bytes_per_point);
+              process_node(node_fp_coords_copy, id, *node_buf, node_buf + 1);
+            }
+            break;
+          }
+        }
+      };
+
       // process cached nhoods
       for (auto &cached_nhood : cached_nhoods) {
         if (stats != nullptr) {
@@ -1409,15 +1663,38 @@ namespace diskann {
                      cached_nhood.second.first, cached_nhood.second.second);
       }
 
+      for (auto &dynamic_nhood : dynamic_nhoods) {
+        if (stats != nullptr) {
+          stats->n_hops++;
+        }
+        unsigned *node_buf = OFFSET_TO_NODE_NHOOD(dynamic_nhood.second);
+        T        *node_fp_coords = OFFSET_TO_NODE_COORDS(dynamic_nhood.second);
+        T        *node_fp_coords_copy = data_buf;
+        memcpy(node_fp_coords_copy, node_fp_coords, disk_bytes_per_point);
+        process_node(node_fp_coords_copy, dynamic_nhood.first, *node_buf,
+                     node_buf + 1);
+      }
+
       for (auto &frontier_nhood : frontier_nhoods) {
         char *node_disk_buf =
             get_offset_to_node(frontier_nhood.second, frontier_nhood.first);
+        if (dynamic_cache != nullptr) {
+          dynamic_cache->record(frontier_nhood.first, node_disk_buf);
+        }
         unsigned *node_buf = OFFSET_TO_NODE_NHOOD(node_disk_buf);
         T        *node_fp_coords = OFFSET_TO_NODE_COORDS(node_disk_buf);
         T        *node_fp_coords_copy = data_buf;
         memcpy(node_fp_coords_copy, node_fp_coords, disk_bytes_per_point);
         process_node(node_fp_coords_copy, frontier_nhood.first, *node_buf,
                      node_buf + 1);
+        if (layout_ids != nullptr && !long_node) {
+          expand_colocated(frontier_nhood.first, frontier_nhood.second);
+        }
+      }
+
+      if (adaptive_beam) {
+        cur_beam_width = nk <= k ? std::max(min_beam_width, cur_beam_width / 2)
+                                 : std::min(beam_width, cur_beam_width * 2);
       }
 
       // update best inserted position
@@ -1657,6 +1934,11 @@ namespace diskann {
     return metric;
   }
 
+  template<typename T>
+  bool PQFlashIndex<T>::has_full_precision_vectors() const noexcept {
+    return !use_disk_index_pq;
+  }
+
   template<typename T>
   void PQFlashIndex<T>::getIteratorNextBatch(IteratorWorkspace<T> *workspace) {
     if (workspace->beam_width > defaults::MAX_N_SECTOR_READS)
@@ -1892,33 +2174,45 @@ namespace diskann {
 
   template<typename T>
   _u64 PQFlashIndex<T>::cal_size() {
-    _u64 index_mem_size = 0;
-    index_mem_size += sizeof(*this);
+    return cal_memory().total();
+  }
+
+  template<typename T>
+  PQFlashIndexMemory PQFlashIndex<T>::cal_memory() {
+    PQFlashIndexMemory mem;
+    mem.other += sizeof(*this);
     // thread data size:
-    index_mem_size += (_u64) this->thread_data.size() * get_thread_data_size();
+    mem.scratch += (_u64) this->thread_data.size() * get_thread_data_size();
     // get cache size:
     auto num_cached_nodes = coord_cache.size();
-    index_mem_size +=
+    mem.node_cache +=
         ROUND_UP(num_cached_nodes * aligned_dim * sizeof(T), 8 * sizeof(T));
-    index_mem_size += num_cached_nodes * (max_degree + 1) * sizeof(unsigned);
-    index_mem_size += coord_cache.size() * sizeof(std::pair<_u32, T *>);
-    index_mem_size +=
+    mem.node_cache += num_cached_nodes * (max_degree + 1) * sizeof(unsigned);
+    mem.node_cache += coord_cache.size() * sizeof(std::pair<_u32, T *>);
+    mem.node_cache +=
         nhood_cache.size() * sizeof(std::pair<_u32, std::pair<_u32, _u32 *>>);
+    if (this->dynamic_cache != nullptr) {
+      mem.node_cache += this->dynamic_cache->cal_size();
+    }
+    mem.node_cache += this->num_points * this->rerank_tier_code_size;
     // get entry points:
-    index_mem_size += ROUND_UP(num_medoids * aligned_dim * sizeof(float), 32);
-    index_mem_size += num_medoids * aligned_dim * sizeof(uint32_t);
+    mem.pq_pivots += ROUND_UP(num_medoids * aligned_dim * sizeof(float), 32);
+    mem.pq_pivots += num_medoids * aligned_dim * sizeof(uint32_t);
     // get pq data and pq_table:
-    index_mem_size += this->num_points * this->n_chunks * sizeof(uint8_t);
-    index_mem_size += this->pq_table.get_total_dims() * 256 * sizeof(float) * 2;
-    index_mem_size +=
+    mem.pq_codes += this->num_points * this->n_chunks * sizeof(uint8_t);
+    mem.pq_pivots += this->pq_table.get_total_dims() * 256 * sizeof(float) * 2;
+    mem.pq_pivots +=
         this->pq_table.get_total_dims() * (sizeof(uint32_t) + sizeof(float));
-    index_mem_size += (this->pq_table.get_num_chunks() + 1) * sizeof(uint32_t);
+    mem.pq_pivots += (this->pq_table.get_num_chunks() + 1) * sizeof(uint32_t);
     // base norms:
     if (this->metric == diskann::Metric::COSINE) {
-      index_mem_size += sizeof(float) * this->num_points;
+      mem.other += sizeof(float) * this->num_points;
+    }
+    if (this->layout_slots != nullptr) {
+      mem.id_map += 2 * sizeof(_u32) * this->num_points;
     }
 
-    return index_mem_size;
+    return mem;
   }
 
   template<typename T>
@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/tiered_aligned_file_reader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include "diskann/ann_exception.h"
+#include "diskann/defaults.h"
+#include "diskann/utils.h"
+
+namespace {
+  [[noreturn]] void throw_file_error(const char *call, const std::string &fname,
+                                     int err) {
+    std::stringstream msg;
+    msg << "Failed to " << call << " " << fname << ", errno: " << err << ", "
+        << strerror(err);
+    throw diskann::ANNException(msg.str(), -1, __FUNCSIG__, __FILE__,
+                                __LINE__);
+  }
+}  // namespace
+
+TieredAlignedFileReader::TieredAlignedFileReader(
+    std::shared_ptr<AlignedFileReader> local,
+    std::shared_ptr<RangeReader> remote, uint64_t block_size)
+    : local_(std::move(local)), remote_(std::move(remote)),
+      block_size_(block_size) {
+  assert(IS_ALIGNED(block_size_, diskann::defaults::SECTOR_LEN));
+}
+
+TieredAlignedFileReader::~TieredAlignedFileReader() {
+  stop_prefetch();
+  if (write_fd_ != -1) {
+    ::close(write_fd_);
+  }
+}
+
+void TieredAlignedFileReader::prepare(const std::string &fname) {
+  if (write_fd_ != -1) {
+    return;
+  }
+  file_size_ = remote_->size(fname);
+  // a leftover of an earlier load may miss any block, it is fetched again
+  write_fd_ = ::open(fname.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+  if (write_fd_ == -1) {
+    throw_file_error("create", fname, errno);
+  }
+  if (::ftruncate(write_fd_, file_size_) != 0) {
+    int err = errno;
+    ::close(write_fd_);
+    write_fd_ = -1;
+    throw_file_error("truncate", fname, err);
+  }
+  fname_ = fname;
+  num_blocks_ = DIV_ROUND_UP(file_size_, block_size_);
+  block_states_ = std::make_unique<std::atomic<uint8_t>[]>(num_blocks_);
+  for (uint64_t i = 0; i < num_blocks_; i++) {
+    block_states_[i].store(absent, std::memory_order_relaxed);
+  }
+  num_fetched_.store(0);
+  if (num_blocks_ > 0) {
+    fetch_block(0);
+  }
+  LOG_KNOWHERE_INFO_ << "Prepared " << fname << " of " << file_size_
+                     << " bytes for a tiered load in " << num_blocks_
+                     << " blocks";
+}
+
+void TieredAlignedFileReader::open(const std::string &fname) {
+  prepare(fname);
+  local_->open(fname);
+  stop_prefetch_.store(false);
+  prefetcher_ = std::thread([this] { prefetch(); });
+}
+
+void TieredAlignedFileReader::close() {
+  stop_prefetch();
+  local_->close();
+  if (write_fd_ != -1) {
+    ::close(write_fd_);
+    write_fd_ = -1;
+  }
+}
+
+void TieredAlignedFileReader::stop_prefetch() {
+  stop_prefetch_.store(true);
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+}
+
+void TieredAlignedFileReader::prefetch() {
+  try {
+    for (uint64_t block = 0;
+         block < num_blocks_ && !stop_prefetch_.load(std::memory_order_relaxed);
+         block++) {
+      fetch_block(block);
+    }
+  } catch (const std::exception &e) {
+    // the reads still fetch the blocks they need
+    LOG_KNOWHERE_WARNING_ << "Stopped prefetching " << fname_ << ": "
+                          << e.what();
+    return;
+  }
+  if (fully_fetched()) {
+    LOG_KNOWHERE_INFO_ << "Fetched all of " << fname_;
+  }
+}
+
+void TieredAlignedFileReader::fetch_range(uint64_t offset, uint64_t len) {
+  if (fully_fetched() || len == 0) {
+    return;
+  }
+  uint64_t end = std::min(offset + len, file_size_);
+  for (uint64_t block = offset / block_size_; block * block_size_ < end;
+       block++) {
+    fetch_block(block);
+  }
+}
+
+void TieredAlignedFileReader::fetch_block(uint64_t block) {
+  auto &state = block_states_[block];
+  while (true) {
+    uint8_t expected = absent;
+    if (state.load(std::memory_order_acquire) == present) {
+      return;
+    }
+    if (state.compare_exchange_strong(expected, fetching,
+                                      std::memory_order_acq_rel)) {
+      break;
+    }
+    // another thread fetches the block, it is retried if that fails
+    std::unique_lock lk(fetch_mtx_);
+    fetch_cv_.wait(lk, [&state] {
+      return state.load(std::memory_order_acquire) != fetching;
+    });
+  }
+
+  try {
+    uint64_t          offset = block * block_size_;
+    uint64_t          len = std::min(block_size_, file_size_ - offset);
+    std::vector<char> buf(len);
+    remote_->read(fname_, offset, len, buf.data());
+    for (uint64_t written = 0; written < len;) {
+      ssize_t ret =
+          ::pwrite(write_fd_, buf.data() + written, len - written,
+                   offset + written);
+      if (ret < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw_file_error("write", fname_, errno);
+      }
+      written += ret;
+    }
+  } catch (...) {
+    {
+      std::scoped_lock lk(fetch_mtx_);
+      state.store(absent, std::memory_order_release);
+    }
+    fetch_cv_.notify_all();
+    throw;
+  }
+  // the direct reads of the local reader write the page cache back first
+  {
+    std::scoped_lock lk(fetch_mtx_);
+    state.store(present, std::memory_order_release);
+  }
+  num_fetched_.fetch_add(1, std::memory_order_acq_rel);
+  fetch_cv_.notify_all();
+}
+
+void TieredAlignedFileReader::read(std::vector<AlignedRead> &read_reqs,
+                                   IOContext &ctx, bool async) {
+  for (auto &req : read_reqs) {
+    fetch_range(req.offset, req.len);
+  }
+  local_->read(read_reqs, ctx, async);
+}
+
+void TieredAlignedFileReader::submit_req(io_context_t             &ctx,
+                                         std::vector<AlignedRead> &read_reqs) {
+  for (auto &req : read_reqs) {
+    fetch_range(req.offset, req.len);
+  }
+  local_->submit_req(ctx, read_reqs);
+}
+
+void TieredAlignedFileReader::get_submitted_req(io_context_t &ctx,
+                                                size_t        n_ops) {
+  local_->get_submitted_req(ctx, n_ops);
+}
@@ -11,11 +11,13 @@
 #include <faiss/VectorTransform.h>
 #include <faiss/impl/AuxIndexStructures.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cinttypes>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <numeric>
 
 #include <omp.h>
 
@@ -279,10 +281,66 @@ int split_clusters(
     return nsplit;
 }
 
+/** mini-batch update of the centroids (Sculley, "Web-scale k-means
+ * clustering", WWW'10): each centroid moves towards the points of the batch
+ * assigned to it with a learning rate that decays as 1 / (points seen).
+ *
+ * @param batch      ids of the batch vectors in x, size nb
+ * @param assign     nearest centroid for each batch vector, size nb
+ * @param counts     (weighted) nb of points seen by each centroid so far,
+ *                   size k, updated
+ */
+void update_centroids_minibatch(
+        size_t d,
+        size_t k,
+        size_t nb,
+        size_t k_frozen,
+        const float* x,
+        const idx_t* batch,
+        const int64_t* assign,
+        const float* weights,
+        double* counts,
+        float* centroids) {
+    // bucket the batch by centroid so that each centroid is updated by a
+    // single thread, in the order of the batch
+    std::vector<size_t> lims(k + 1, 0);
+    for (size_t i = 0; i < nb; i++) {
+        lims[assign[i] + 1]++;
+    }
+    for (size_t ci = 0; ci < k; ci++) {
+        lims[ci + 1] += lims[ci];
+    }
+    std::vector<size_t> order(nb);
+    std::vector<size_t> pos(lims.begin(), lims.end() - 1);
+    for (size_t i = 0; i < nb; i++) {
+        order[pos[assign[i]]++] = i;
+    }
+
+#pragma omp parallel for schedule(dynamic, 64)
+    for (idx_t ci = k_frozen; ci < k; ci++) {
+        float* c = centroids + ci * d;
+        for (size_t o = lims[ci]; o < lims[ci + 1]; o++) {
+            idx_t i = batch[order[o]];
+            double w = weights ? weights[i] : 1.0;
+            counts[ci] += w;
+            if (counts[ci] <= 0) {
+                continue;
+            }
+            float eta = w / counts[ci];
+            const float* xi = x + i * d;
+            for (size_t j = 0; j < d; j++) {
+                c[j] += eta * (xi[j] - c[j]);
+            }
+        }
+    }
+}
+
 } // namespace
 
 ClusteringType clustering_type = ClusteringType::K_MEANS;
 double early_stop_threshold = 0.0;
+size_t kmeans_minibatch_size = 0;
+double kmeans_time_budget = 0.0;
 
 void Clustering::kmeans_algorithm(
         std::vector<int>& centroids_index,
@@ -582,12 +640,45 @@ void Clustering::train_encoded(
 
         // k-means iterations
 
+        // mini-batch iterations each assign the next batch of a random
+        // permutation of the training set, so that successive batches cover
+        // fresh points
+        const bool minibatch = !codec && kmeans_minibatch_size > 0 &&
+                kmeans_minibatch_size < nx;
+        const size_t nb = minibatch ? kmeans_minibatch_size : nx;
+        std::vector<idx_t> perm;
+        std::vector<idx_t> batch;
+        std::vector<float> batch_x;
+        std::vector<double> counts;
+        size_t perm_offset = 0;
+        if (minibatch) {
+            std::vector<int> perm_int(nx);
+            rand_perm(perm_int.data(), nx, actual_seed + 2 + redo * 15486557L);
+            perm.assign(perm_int.begin(), perm_int.end());
+            batch.resize(nb);
+            batch_x.resize(nb * d);
+            counts.assign(k, 0);
+        }
+
         float obj = 0;
         float prev_objective = 0;
         for (int i = 0; i < niter; i++) {
             double t0s = getmillisecs();
 
-            if (!codec) {
+            if (minibatch) {
+                const float* xf = reinterpret_cast<const float*>(x);
+                for (size_t j = 0; j < nb; j++) {
+                    batch[j] = perm[perm_offset];
+                    perm_offset = (perm_offset + 1) % nx;
+                }
+#pragma omp parallel for if (nb > 1000)
+                for (idx_t j = 0; j < nb; j++) {
+                    memcpy(batch_x.data() + j * d,
+                           xf + batch[j] * d,
+                           sizeof(float) * d);
+                }
+                index.search(nb, batch_x.data(), 1, dis.get(), assign.get());
+            } else if (!codec) {
                 index.search(
                         nx,
                         reinterpret_cast<const float*>(x),
@@ -616,37 +707,55 @@ void Clustering::train_encoded(
             InterruptCallback::check();
             t_search_tot += getmillisecs() - t0s;
 
-            // accumulate objective
+            // accumulate objective, extrapolated to the training set for
+            // a mini-batch
             obj = 0;
-            for (int j = 0; j < nx; j++) {
+            for (size_t j = 0; j < nb; j++) {
                 obj += dis[j];
             }
+            obj *= float(nx) / nb;
 
             // update the centroids
-            std::vector<float> hassign(k);
-
             size_t k_frozen = frozen_centroids ? n_input_centroids : 0;
-            compute_centroids(
-                    d,
-                    k,
-                    nx,
-                    k_frozen,
-                    x,
-                    codec,
-                    assign.get(),
-                    weights,
-                    hassign.data(),
-                    centroids.data());
-
-            int nsplit = split_clusters(
-                    d, k, nx, k_frozen, hassign.data(), centroids.data());
+            int nsplit = 0;
+            if (minibatch) {
+                // the centroids that no batch reached yet stay on their
+                // initial training point, they do not need to be split
+                update_centroids_minibatch(
+                        d,
+                        k,
+                        nb,
+                        k_frozen,
+                        reinterpret_cast<const float*>(x),
+                        batch.data(),
+                        assign.get(),
+                        weights,
+                        counts.data(),
+                        centroids.data());
+            } else {
+                std::vector<float> hassign(k);
+                compute_centroids(
+                        d,
+                        k,
+                        nx,
+                        k_frozen,
+                        x,
+                        codec,
+                        assign.get(),
+                        weights,
+                        hassign.data(),
+                        centroids.data());
+
+                nsplit = split_clusters(
+                        d, k, nx, k_frozen, hassign.data(), centroids.data());
+            }
 
             // collect statistics
             ClusteringIterationStats stats = {
                     obj,
                     (getmillisecs() - t0) / 1000.0,
                     t_search_tot / 1000,
-                    imbalance_factor(nx, k, assign.get()),
+                    imbalance_factor(nb, k, assign.get()),
                     nsplit};
             iteration_stats.push_back(stats);
 
@@ -673,13 +782,19 @@ void Clustering::train_encoded(
 
             index.add(k, centroids.data());
 
-            // Early stop strategy
-            float diff = (prev_objective == 0) ? std::numeric_limits<float>::max()
-                                               : (prev_objective - stats.obj) / prev_objective;
+            // Early stop strategy, the objective of a mini-batch is too noisy
+            // to compare two iterations
+            float diff = (prev_objective == 0 || minibatch)
+                    ? std::numeric_limits<float>::max()
+                    : (prev_objective - stats.obj) / prev_objective;
             prev_objective = stats.obj;
             if (diff < early_stop_threshold / 100.) {
                 break;
             }
+            if (kmeans_time_budget > 0 &&
+                stats.time >= kmeans_time_budget * (redo + 1) / nredo) {
+                break;
+            }
 
             InterruptCallback::check();
         }
@@ -753,6 +868,235 @@ float kmeans_clustering(
     return clus.iteration_stats.back().obj;
 }
 
+/******************************************************************************
+ * hierarchical_balanced_kmeans implementation
+ ******************************************************************************/
+
+namespace {
+
+// splits the k fine clusters among the coarse clusters proportionally to
+// their sizes, at least one for a non-empty coarse cluster and at most its
+// size, by largest remainder
+std::vector<size_t> split_fine_clusters(
+        const std::vector<size_t>& sizes,
+        size_t n,
+        size_t k) {
+    const size_t nc = sizes.size();
+    std::vector<size_t> ks(nc, 0);
+    std::vector<double> ideal(nc);
+    size_t total = 0;
+    for (size_t i = 0; i < nc; i++) {
+        ideal[i] = double(k) * sizes[i] / n;
+        if (sizes[i] > 0) {
+            ks[i] = std::min(sizes[i], std::max(size_t(1), size_t(ideal[i])));
+        }
+        total += ks[i];
+    }
+    while (total < k) {
+        size_t best = nc;
+        for (size_t i = 0; i < nc; i++) {
+            if (ks[i] < sizes[i] &&
+                (best == nc || ideal[i] - ks[i] > ideal[best] - ks[best])) {
+                best = i;
+            }
+        }
+        FAISS_THROW_IF_NOT(best < nc);
+        ks[best]++;
+        total++;
+    }
+    while (total > k) {
+        size_t best = nc;
+        for (size_t i = 0; i < nc; i++) {
+            if (ks[i] > 1 &&
+                (best == nc || ideal[i] - ks[i] < ideal[best] - ks[best])) {
+                best = i;
+            }
+        }
+        FAISS_THROW_IF_NOT(best < nc);
+        ks[best]--;
+        total--;
+    }
+    return ks;
+}
+
+// assigns the vectors, closest first, to their nearest cluster that is not
+// full, and recomputes the centroids from these assignments. Returns the sum
+// of the distances of the assignments.
+float balance_clusters(
+        size_t d,
+        size_t n,
+        size_t k,
+        const float* x,
+        float* centroids,
+        float max_balance,
+        idx_t* assign) {
+    const size_t capacity = std::max(
+            size_t(1), size_t(std::ceil(double(max_balance) * n / k)));
+    const size_t m = std::min(k, size_t(8));
+
+    std::vector<float> dis(n * m);
+    std::vector<idx_t> labels(n * m);
+    IndexFlatL2 index(d);
+    index.add(k, centroids);
+    index.search(n, x, m, dis.data(), labels.data());
+
+    std::vector<idx_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](idx_t a, idx_t b) {
+        return dis[a * m] < dis[b * m];
+    });
+
+    std::vector<size_t> counts(k, 0);
+    float obj = 0;
+    for (const idx_t i : order) {
+        idx_t c = -1;
+        float dc = 0;
+        for (size_t j = 0; j < m; j++) {
+            const idx_t l = labels[i * m + j];
+            if (l >= 0 && counts[l] < capacity) {
+                c = l;
+                dc = dis[i * m + j];
+                break;
+            }
+        }
+        if (c < 0) {
+            // the m nearest clusters are full, capacity * k >= n ensures that
+            // another one is not
+            for (size_t l = 0; l < k; l++) {
+                if (counts[l] < capacity) {
+                    const float dl =
+                            fvec_L2sqr(x + i * d, centroids + l * d, d);
+                    if (c < 0 || dl < dc) {
+                        c = l;
+                        dc = dl;
+                    }
+                }
+            }
+        }
+        counts[c]++;
+        assign[i] = c;
+        obj += dc;
+    }
+
+    std::vector<float> sums(k * d, 0);
+    for (size_t i = 0; i < n; i++) {
+        float* sum = sums.data() + assign[i] * d;
+        for (size_t j = 0; j < d; j++) {
+            sum[j] += x[i * d + j];
+        }
+    }
+    for (size_t c = 0; c < k; c++) {
+        if (counts[c] == 0) {
+            continue;
+        }
+        for (size_t j = 0; j < d; j++) {
+            centroids[c * d + j] = sums[c * d + j] / counts[c];
+        }
+    }
+    return obj;
+}
+
+} // namespace
+
+float hierarchical_balanced_kmeans(
+        size_t d,
+        size_t n,
+        size_t k,
+        const float* x,
+        float* centroids,
+        const ClusteringParameters& cp,
+        float max_balance,
+        idx_t* assign) {
+    FAISS_THROW_IF_NOT_FMT(
+            n >= k,
+            "Number of training points (%zd) should be at least "
+            "as large as number of clusters (%zd)",
+            n,
+            k);
+    FAISS_THROW_IF_NOT(k > 0 && max_balance >= 1);
+
+    // coarse level
+    const size_t k1 = std::min(
+            k, std::max(size_t(1), size_t(std::lround(std::sqrt(double(k))))));
+    Clustering coarse(d, k1, cp);
+    {
+        IndexFlatL2 index(d);
+        coarse.train(n, x, index);
+    }
+    std::vector<idx_t> coarse_assign(n);
+    {
+        std::vector<float> coarse_dis(n);
+        IndexFlatL2 index(d);
+        index.add(k1, coarse.centroids.data());
+        index.search(n, x, 1, coarse_dis.data(), coarse_assign.data());
+    }
+
+    // the vectors grouped by coarse cluster
+    std::vector<size_t> sizes(k1, 0);
+    for (size_t i = 0; i < n; i++) {
+        sizes[coarse_assign[i]]++;
+    }
+    std::vector<size_t> offsets(k1 + 1, 0);
+    for (size_t c = 0; c < k1; c++) {
+        offsets[c + 1] = offsets[c] + sizes[c];
+    }
+    std::vector<idx_t> perm(n);
+    {
+        std::vector<size_t> pos(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < n; i++) {
+            perm[pos[coarse_assign[i]]++] = i;
+        }
+    }
+    const std::vector<size_t> ks = split_fine_clusters(sizes, n, k);
+
+    // fine level, the clusters have about n / k vectors as at the coarse
+    // level, the warning of Clustering is not repeated for each of them
+    ClusteringParameters fine_cp = cp;
+    fine_cp.min_points_per_centroid = 1;
+    float obj = 0;
+    size_t k_begin = 0;
+    std::vector<float> xc;
+    std::vector<idx_t> fine_assign;
+    for (size_t c = 0; c < k1; c++) {
+        const size_t nc = sizes[c];
+        const size_t kc = ks[c];
+        if (kc == 0) {
+            continue;
+        }
+        const idx_t* ids = perm.data() + offsets[c];
+        xc.resize(nc * d);
+        for (size_t i = 0; i < nc; i++) {
+            memcpy(xc.data() + i * d, x + ids[i] * d, sizeof(float) * d);
+        }
+        if (cp.seed >= 0) {
+            fine_cp.seed = cp.seed + c + 1;
+        }
+        Clustering fine(d, kc, fine_cp);
+        IndexFlatL2 index(d);
+        fine.train(nc, xc.data(), index);
+
+        float* fine_centroids = centroids + k_begin * d;
+        memcpy(fine_centroids, fine.centroids.data(), sizeof(float) * kc * d);
+        fine_assign.resize(nc);
+        obj += balance_clusters(
+                d,
+                nc,
+                kc,
+                xc.data(),
+                fine_centroids,
+                max_balance,
+                fine_assign.data());
+        if (assign != nullptr) {
+            for (size_t i = 0; i < nc; i++) {
+                assign[ids[i]] = k_begin + fine_assign[i];
+            }
+        }
+        k_begin += kc;
+    }
+    FAISS_ASSERT(k_begin == k);
+    return obj;
+}
+
 /******************************************************************************
  * ProgressiveDimClustering implementation
  ******************************************************************************/
@@ -31,6 +31,17 @@ extern ClusteringType clustering_type;
 // K-Means Early Stop Threshold; defaults to 0.0
 extern double early_stop_threshold;
 
+// K-Means mini-batch size; defaults to 0, full batch. When set below the
+// (subsampled) training set size, each iteration assigns only the next batch
+// of a random permutation of the training set and moves the centroids towards
+// it with a decaying per-centroid learning rate, instead of assigning the whole
+// training set. Vectors given through a codec are always clustered in full.
+extern size_t kmeans_minibatch_size;
+
+// K-Means time budget in seconds, shared by the redos; defaults to 0.0, no
+// limit. The iterations stop once it is spent, after at least one of them.
+extern double kmeans_time_budget;
+
 /** Class for the clustering parameters. Can be passed to the
  * constructor of the Clustering object.
  */
@@ -253,6 +264,40 @@ float kmeans_clustering(
         const float* x,
         float* centroids);
 
+/** Hierarchical balanced k-means, for a large k.
+ *
+ * The training set is clustered into about sqrt(k) coarse clusters, and every
+ * coarse cluster into a number of fine clusters proportional to its size, so
+ * that an iteration costs O(n * sqrt(k)) distances instead of O(n * k).
+ *
+ * The vectors of a coarse cluster are then assigned, closest first, to the
+ * nearest of its fine clusters that holds fewer than
+ * ceil(max_balance * n_coarse / k_coarse) vectors, and the fine centroids are
+ * recomputed from these assignments, which bounds the sizes of the clusters.
+ *
+ * The clustering is in L2.
+ *
+ * @param d           dimension of the data
+ * @param n           nb of training vectors
+ * @param k           nb of output centroids
+ * @param x           training set (size n * d)
+ * @param centroids   output centroids (size k * d)
+ * @param cp          parameters of the coarse and fine clusterings
+ * @param max_balance bound on the size of a cluster over the mean size of the
+ *                    clusters of its coarse cluster, >= 1
+ * @param assign      output cluster of every training vector, NULL or size n
+ * @return final quantization error
+ */
+float hierarchical_balanced_kmeans(
+        size_t d,
+        size_t n,
+        size_t k,
+        const float* x,
+        float* centroids,
+        const ClusteringParameters& cp = ClusteringParameters(),
+        float max_balance = 1.2f,
+        idx_t* assign = nullptr);
+
 } // namespace faiss
 
 #endif
@@ -1000,9 +1000,7 @@ BinaryInvertedListScanner* select_IVFBinaryScannerJaccard(
         HANDLE_CS(16)
         HANDLE_CS(32)
         HANDLE_CS(64)
-        HANDLE_CS(128)
-        HANDLE_CS(256)
-        HANDLE_CS(512)
+        // the simd hook beats the unrolled computers from 128 bytes on
         default:
             return new IVFBinaryScannerJaccard<
                     JaccardComputerDefault>(code_size, store_pairs, sel);
@@ -17,6 +17,8 @@
 #include <memory>
 
 #include <faiss/FaissHook.h>
+#include <faiss/IndexPreTransform.h>
+#include <faiss/VectorTransform.h>
 #include <faiss/impl/DistanceComputer.h>
 #include <faiss/impl/FaissAssert.h>
 #include <faiss/utils/prefetch.h>
@@ -215,6 +217,11 @@ float WithCosineNormDistanceComputer::symmetric_dis(idx_t i, idx_t j) {
     return v;
 }
 
+void WithCosineNormDistanceComputer::prefetch(idx_t i) {
+    prefetch_L1(inverse_l2_norms + i);
+    basedis->prefetch(i);
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////
 
@@ -346,6 +353,47 @@ DistanceComputer* IndexScalarQuantizerCosine::get_distance_computer() const {
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////
+
+//
+IndexNonUniformSQCosine::IndexNonUniformSQCosine(int d, size_t nbits) :
+    IndexNonUniformSQ(d, nbits, MetricType::METRIC_INNER_PRODUCT) {
+    is_cosine = true;
+}
+
+IndexNonUniformSQCosine::IndexNonUniformSQCosine() : IndexNonUniformSQ() {
+    metric_type = MetricType::METRIC_INNER_PRODUCT;
+    is_cosine = true;
+}
+
+void IndexNonUniformSQCosine::add(idx_t n, const float* x) {
+    FAISS_THROW_IF_NOT(is_trained);
+    if (n == 0) {
+        return;
+    }
+
+    IndexNonUniformSQ::add(n, x);
+    inverse_norms_storage.add(x, n, d);
+}
+
+void IndexNonUniformSQCosine::reset() {
+    IndexNonUniformSQ::reset();
+    inverse_norms_storage.reset();
+}
+
+const float* IndexNonUniformSQCosine::get_inverse_l2_norms() const {
+    return inverse_norms_storage.inverse_l2_norms.data();
+}
+
+DistanceComputer* IndexNonUniformSQCosine::get_distance_computer() const {
+    return new WithCosineNormDistanceComputer(
+        this->get_inverse_l2_norms(),
+        this->d,
+        std::unique_ptr<faiss::DistanceComputer>(IndexNonUniformSQ::get_FlatCodesDistanceComputer())
+    );
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////
 
 //
@@ -442,6 +490,46 @@ DistanceComputer* IndexProductResidualQuantizerCosine::get_distance_computer() c
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////
+
+IndexRaBitQCosine::IndexRaBitQCosine(idx_t d) :
+    IndexRaBitQ(d, MetricType::METRIC_INNER_PRODUCT) {
+    is_cosine = true;
+}
+
+IndexRaBitQCosine::IndexRaBitQCosine() : IndexRaBitQ() {
+    metric_type = MetricType::METRIC_INNER_PRODUCT;
+    is_cosine = true;
+}
+
+void IndexRaBitQCosine::add(idx_t n, const float* x) {
+    FAISS_THROW_IF_NOT(is_trained);
+    if (n == 0) {
+        return;
+    }
+
+    IndexRaBitQ::add(n, x);
+    inverse_norms_storage.add(x, n, d);
+}
+
+void IndexRaBitQCosine::reset() {
+    IndexRaBitQ::reset();
+    inverse_norms_storage.reset();
+}
+
+const float* IndexRaBitQCosine::get_inverse_l2_norms() const {
+    return inverse_norms_storage.inverse_l2_norms.data();
+}
+
+DistanceComputer* IndexRaBitQCosine::get_distance_computer() const {
+    return new WithCosineNormDistanceComputer(
+        this->get_inverse_l2_norms(),
+        this->d,
+        std::unique_ptr<faiss::DistanceComputer>(IndexRaBitQ::get_FlatCodesDistanceComputer())
+    );
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////
 
 //
@@ -478,6 +566,19 @@ IndexHNSWSQCosine::IndexHNSWSQCosine(
 }
 
 
+//
+IndexHNSWNonUniformSQCosine::IndexHNSWNonUniformSQCosine() {
+    is_cosine = true;
+}
+
+IndexHNSWNonUniformSQCosine::IndexHNSWNonUniformSQCosine(int d, size_t nbits, int M) :
+    IndexHNSW(new IndexNonUniformSQCosine(d, nbits), M)
+{
+    is_trained = this->storage->is_trained;
+    own_fields = true;
+    is_cosine = true;
+}
+
 //
 IndexHNSWPQCosine::IndexHNSWPQCosine() {
     is_cosine = true;
@@ -524,6 +625,72 @@ IndexHNSWProductResidualQuantizerCosine::IndexHNSWProductResidualQuantizerCosine
     is_cosine = true;
 }
 
+//
+IndexPreTransform* make_rotated_rabitq_storage(
+        int d,
+        MetricType metric,
+        bool is_cosine) {
+    IndexRaBitQ* index_rabitq = is_cosine ? new IndexRaBitQCosine(d) : new IndexRaBitQ(d, metric);
+    IndexPreTransform* storage = new IndexPreTransform(
+        new RandomRotationMatrix(d, d), index_rabitq);
+    storage->own_fields = true;
+    // the rotation preserves the norms
+    storage->is_cosine = is_cosine;
+    return storage;
+}
+
+IndexPreTransform* make_rotated_pq_storage(
+        int d,
+        size_t M,
+        size_t nbits,
+        MetricType metric,
+        bool is_cosine,
+        bool opq) {
+    IndexPQ* index_pq = is_cosine ? new IndexPQCosine(d, M, nbits) : new IndexPQ(d, M, nbits, metric);
+    VectorTransform* rotation = opq ? static_cast<VectorTransform*>(new OPQMatrix(d, M))
+                                    : new RandomRotationMatrix(d, d);
+    IndexPreTransform* storage = new IndexPreTransform(rotation, index_pq);
+    storage->own_fields = true;
+    // the rotation preserves the norms
+    storage->is_cosine = is_cosine;
+    return storage;
+}
+
+IndexPQ* get_storage_pq(Index* storage) {
+    if (auto* index_pt = dynamic_cast<IndexPreTransform*>(storage); index_pt != nullptr) {
+        storage = index_pt->index;
+    }
+    return dynamic_cast<IndexPQ*>(storage);
+}
 
+const HasInverseL2Norms* get_storage_inverse_l2_norms(const Index* storage) {
+    if (const auto* index_pt = dynamic_cast<const IndexPreTransform*>(storage); index_pt != nullptr) {
+        storage = index_pt->index;
+    }
+    return dynamic_cast<const HasInverseL2Norms*>(storage);
 }
 
+//
+IndexHNSWRaBitQ::IndexHNSWRaBitQ() = default;
+
+IndexHNSWRaBitQ::IndexHNSWRaBitQ(int d, int M, MetricType metric) :
+    IndexHNSW(make_rotated_rabitq_storage(d, metric, false), M)
+{
+    own_fields = true;
+    is_trained = false;
+}
+
+//
+IndexHNSWRaBitQCosine::IndexHNSWRaBitQCosine() {
+    is_cosine = true;
+}
+
+IndexHNSWRaBitQCosine::IndexHNSWRaBitQCosine(int d, int M) :
+    IndexHNSW(make_rotated_rabitq_storage(d, MetricType::METRIC_INNER_PRODUCT, true), M)
+{
+    own_fields = true;
+    is_trained = false;
+    is_cosine = true;
+}
+
+}
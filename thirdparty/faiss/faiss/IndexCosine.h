@@ -19,13 +19,17 @@
 #include <faiss/IndexAdditiveQuantizer.h>
 #include <faiss/IndexFlat.h>
 #include <faiss/IndexHNSW.h>
+#include <faiss/IndexNonUniformSQ.h>
 #include <faiss/IndexScalarQuantizer.h>
 #include <faiss/IndexPQ.h>
+#include <faiss/IndexRaBitQ.h>
 #include <faiss/impl/DistanceComputer.h>
 
 
 namespace faiss {
 
+struct IndexPreTransform;
+
 // a distance computer wrapper that normalizes the distance over a query
 struct WithCosineNormDistanceComputer : DistanceComputer {
     /// owned by this
@@ -62,6 +66,8 @@ struct WithCosineNormDistanceComputer : DistanceComputer {
 
     /// compute distance between two stored vectors
     float symmetric_dis(idx_t i, idx_t j) override;
+
+    void prefetch(idx_t i) override;
 };
 
 struct HasInverseL2Norms {
@@ -123,6 +129,22 @@ struct IndexScalarQuantizerCosine : IndexScalarQuantizer, HasInverseL2Norms {
     const float* get_inverse_l2_norms() const override;
 };
 
+//
+struct IndexNonUniformSQCosine : IndexNonUniformSQ, HasInverseL2Norms {
+    L2NormsStorage inverse_norms_storage;
+
+    IndexNonUniformSQCosine(int d, size_t nbits);
+
+    IndexNonUniformSQCosine();
+
+    void add(idx_t n, const float* x) override;
+    void reset() override;
+
+    DistanceComputer* get_distance_computer() const override;
+
+    const float* get_inverse_l2_norms() const override;
+};
+
 //
 struct IndexPQCosine : IndexPQ, HasInverseL2Norms {
     L2NormsStorage inverse_norms_storage;
@@ -160,6 +182,22 @@ struct IndexProductResidualQuantizerCosine : IndexProductResidualQuantizer, HasI
     const float* get_inverse_l2_norms() const override;
 };
 
+//
+struct IndexRaBitQCosine : IndexRaBitQ, HasInverseL2Norms {
+    L2NormsStorage inverse_norms_storage;
+
+    IndexRaBitQCosine(idx_t d);
+
+    IndexRaBitQCosine();
+
+    void add(idx_t n, const float* x) override;
+    void reset() override;
+
+    DistanceComputer* get_distance_computer() const override;
+
+    const float* get_inverse_l2_norms() const override;
+};
+
 //
 struct IndexHNSWFlatCosine : IndexHNSW {
     IndexHNSWFlatCosine();
@@ -175,6 +213,12 @@ struct IndexHNSWSQCosine : IndexHNSW {
             int M);
 };
 
+//
+struct IndexHNSWNonUniformSQCosine : IndexHNSW {
+    IndexHNSWNonUniformSQCosine();
+    IndexHNSWNonUniformSQCosine(int d, size_t nbits, int M);
+};
+
 //
 struct IndexHNSWPQCosine : IndexHNSW {
     IndexHNSWPQCosine();
@@ -213,5 +257,46 @@ struct IndexHNSWProductResidualQuantizerCosine : IndexHNSW {
     );
 };
 
+// a random rotation followed by RaBitQ codes (IndexRaBitQ, or
+//   IndexRaBitQCosine if is_cosine), the storage of the HNSW RaBitQ indices.
+//   RaBitQ expects randomly rotated vectors.
+IndexPreTransform* make_rotated_rabitq_storage(
+        int d,
+        MetricType metric,
+        bool is_cosine);
+
+// a rotation followed by PQ codes (IndexPQ, or IndexPQCosine if is_cosine),
+//   an optional storage of the HNSW PQ indices. The rotation is an OPQMatrix
+//   if opq, which is trained along with the codes, and a RandomRotationMatrix
+//   otherwise.
+IndexPreTransform* make_rotated_pq_storage(
+        int d,
+        size_t M,
+        size_t nbits,
+        MetricType metric,
+        bool is_cosine,
+        bool opq);
+
+// the PQ codes of a storage, including the ones behind an IndexPreTransform,
+//   or nullptr if the storage has none.
+IndexPQ* get_storage_pq(Index* storage);
+
+// the inverse L2 norms of a cosine storage, including the ones behind an
+//   IndexPreTransform, or nullptr if the storage has none.
+const HasInverseL2Norms* get_storage_inverse_l2_norms(const Index* storage);
+
+// RaBitQ codes topped with a HNSW structure.
+//   The storage is made by make_rotated_rabitq_storage().
+struct IndexHNSWRaBitQ : IndexHNSW {
+    IndexHNSWRaBitQ();
+    IndexHNSWRaBitQ(int d, int M, MetricType metric = METRIC_L2);
+};
+
+// same as IndexHNSWRaBitQ, over an IndexRaBitQCosine
+struct IndexHNSWRaBitQCosine : IndexHNSW {
+    IndexHNSWRaBitQCosine();
+    IndexHNSWRaBitQCosine(int d, int M);
+};
+
 
 }
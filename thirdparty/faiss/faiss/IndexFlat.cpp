@@ -39,10 +39,23 @@ void IndexFlat::add(idx_t n, const float* x) {
         auto norms = knowhere::NormalizeVecs(x_normalized.get(), n, d);
         code_norms.resize(ntotal + n);
         std::memcpy(&code_norms[ntotal], norms.data(), sizeof(float) * n);
+        code_inverse_norms.resize(ntotal + n);
+        for (idx_t i = 0; i < n; i++) {
+            code_inverse_norms[ntotal + i] =
+                    (norms[i] == 0.0f) ? 1.0f : (1.0f / norms[i]);
+        }
     }
     ntotal += n;
 }
 
+void IndexFlat::update_inverse_norms() {
+    code_inverse_norms.resize(code_norms.size());
+    for (size_t i = 0; i < code_norms.size(); i++) {
+        code_inverse_norms[i] =
+                (code_norms[i] == 0.0f) ? 1.0f : (1.0f / code_norms[i]);
+    }
+}
+
 void IndexFlat::search(
         idx_t n,
         const float* x,
@@ -57,7 +70,7 @@ void IndexFlat::search(
     if (metric_type == METRIC_INNER_PRODUCT) {
         float_minheap_array_t res = {size_t(n), size_t(k), labels, distances};
         if (is_cosine) {
-            knn_cosine(x, get_xb(), get_norms(), d, n, ntotal, &res, sel);
+            knn_cosine(x, get_xb(), get_inverse_norms(), d, n, ntotal, &res, sel);
         } else {
             knn_inner_product(x, get_xb(), d, n, ntotal, &res, sel);
         }
@@ -100,7 +113,7 @@ void IndexFlat::range_search(
     switch (metric_type) {
         case METRIC_INNER_PRODUCT:
             if (is_cosine) {
-                range_search_cosine(x, get_xb(), get_norms(), d, n, ntotal,
+                range_search_cosine(x, get_xb(), get_inverse_norms(), d, n, ntotal,
                                     radius, result, sel);
             } else {
                 range_search_inner_product(
@@ -145,14 +158,18 @@ struct FlatL2Dis : FlatCodesDistanceComputer {
     const float* q;
     const float* b;
     size_t ndis;
+    // resolved for d once, a graph search calls it for every neighbor
+    decltype(fvec_L2sqr) dis_func;
+    // the same, for the neighbors of a node at once
+    fvec_by_ids_func by_ids_func;
 
     float distance_to_code(const uint8_t* code) final {
         ndis++;
-        return fvec_L2sqr(q, (float*)code, d);
+        return dis_func(q, (float*)code, d);
     }
 
     float symmetric_dis(idx_t i, idx_t j) override {
-        return fvec_L2sqr(b + j * d, b + i * d, d);
+        return dis_func(b + j * d, b + i * d, d);
     }
 
     explicit FlatL2Dis(const IndexFlat& storage, const float* q = nullptr)
@@ -163,7 +180,9 @@ struct FlatL2Dis : FlatCodesDistanceComputer {
               nb(storage.ntotal),
               q(q),
               b(storage.get_xb()),
-              ndis(0) {}
+              ndis(0),
+              dis_func(fvec_L2sqr_for_dim(storage.d)),
+              by_ids_func(fvec_L2sqr_by_ids_for_dim(storage.d)) {}
 
     void set_query(const float* x) override {
         q = x;
@@ -201,6 +220,22 @@ struct FlatL2Dis : FlatCodesDistanceComputer {
         dis2 = dp2;
         dis3 = dp3;
     }
+
+    void distances_by_ids(
+            const int32_t* ids,
+            size_t n,
+            size_t prefetch_distance,
+            float* dis) final override {
+        ndis += n;
+        by_ids_func(
+                q,
+                reinterpret_cast<const float*>(codes),
+                d,
+                ids,
+                n,
+                prefetch_distance,
+                dis);
+    }
 };
 
 struct FlatIPDis : FlatCodesDistanceComputer {
@@ -209,14 +244,16 @@ struct FlatIPDis : FlatCodesDistanceComputer {
     const float* q;
     const float* b;
     size_t ndis;
+    decltype(fvec_inner_product) dis_func;
+    fvec_by_ids_func by_ids_func;
 
     float symmetric_dis(idx_t i, idx_t j) final override {
-        return fvec_inner_product(b + j * d, b + i * d, d);
+        return dis_func(b + j * d, b + i * d, d);
     }
 
     float distance_to_code(const uint8_t* code) final override {
         ndis++;
-        return fvec_inner_product(q, (const float*)code, d);
+        return dis_func(q, (const float*)code, d);
     }
 
     explicit FlatIPDis(const IndexFlat& storage, const float* q = nullptr)
@@ -227,7 +264,9 @@ struct FlatIPDis : FlatCodesDistanceComputer {
               nb(storage.ntotal),
               q(q),
               b(storage.get_xb()),
-              ndis(0) {}
+              ndis(0),
+              dis_func(fvec_inner_product_for_dim(storage.d)),
+              by_ids_func(fvec_inner_product_by_ids_for_dim(storage.d)) {}
 
     void set_query(const float* x) override {
         q = x;
@@ -265,6 +304,22 @@ struct FlatIPDis : FlatCodesDistanceComputer {
         dis2 = dp2;
         dis3 = dp3;
     }
+
+    void distances_by_ids(
+            const int32_t* ids,
+            size_t n,
+            size_t prefetch_distance,
+            float* dis) final override {
+        ndis += n;
+        by_ids_func(
+                q,
+                reinterpret_cast<const float*>(codes),
+                d,
+                ids,
+                n,
+                prefetch_distance,
+                dis);
+    }
 };
 
 } // namespace
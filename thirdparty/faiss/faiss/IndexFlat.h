@@ -75,6 +75,18 @@ struct IndexFlat : IndexFlatCodes {
         return (const float*)code_norms.data();
     }
 
+    // the inverses of code_norms, which the cosine search multiplies the
+    // inner products with. Not serialized, see update_inverse_norms().
+    std::vector<float> code_inverse_norms;
+
+    const float* get_inverse_norms() const {
+        return code_inverse_norms.empty() ? nullptr
+                                          : code_inverse_norms.data();
+    }
+
+    // recomputes code_inverse_norms from code_norms, once they are read
+    void update_inverse_norms();
+
     IndexFlat() {}
 
     FlatCodesDistanceComputer* get_FlatCodesDistanceComputer() const override;
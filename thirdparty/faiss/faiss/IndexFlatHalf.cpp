@@ -0,0 +1,330 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <faiss/IndexFlatHalf.h>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <faiss/FaissHook.h>
+#include <faiss/impl/AuxIndexStructures.h>
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/utils/distances_typed.h>
+
+#include "knowhere/operands.h"
+
+namespace faiss {
+
+namespace {
+
+template <typename T>
+void half_norms(const T* x, idx_t n, idx_t d, float* norms) {
+    for (idx_t i = 0; i < n; i++) {
+        float norm_sqr = 0;
+        if constexpr (std::is_same_v<T, knowhere::fp16>) {
+            norm_sqr = fp16_vec_norm_L2sqr(x + i * d, d);
+        } else {
+            norm_sqr = bf16_vec_norm_L2sqr(x + i * d, d);
+        }
+        norms[i] = std::sqrt(norm_sqr);
+    }
+}
+
+template <typename T>
+void half_search(
+        const IndexFlatHalf& index,
+        idx_t n,
+        const T* x,
+        idx_t k,
+        float* distances,
+        idx_t* labels,
+        const IDSelector* sel) {
+    const T* xb = (const T*)index.codes.data();
+    if (index.metric_type == METRIC_INNER_PRODUCT) {
+        if (index.is_cosine) {
+            // the typed cosine divides by the query norms, the queries are
+            // not normalized
+            knn_cosine_typed(
+                    x,
+                    xb,
+                    index.get_inverse_norms(),
+                    index.d,
+                    n,
+                    index.ntotal,
+                    k,
+                    distances,
+                    labels,
+                    sel);
+        } else {
+            knn_inner_product_typed(
+                    x, xb, index.d, n, index.ntotal, k, distances, labels, sel);
+        }
+    } else if (index.metric_type == METRIC_L2) {
+        knn_L2sqr_typed(
+                x,
+                xb,
+                index.d,
+                n,
+                index.ntotal,
+                k,
+                distances,
+                labels,
+                nullptr,
+                sel);
+    } else {
+        FAISS_THROW_MSG("metric type not supported");
+    }
+}
+
+template <typename T>
+void half_range_search(
+        const IndexFlatHalf& index,
+        idx_t n,
+        const T* x,
+        float radius,
+        RangeSearchResult* result,
+        const IDSelector* sel) {
+    const T* xb = (const T*)index.codes.data();
+    if (index.metric_type == METRIC_INNER_PRODUCT) {
+        if (index.is_cosine) {
+            range_search_cosine_typed(
+                    x,
+                    xb,
+                    index.get_inverse_norms(),
+                    index.d,
+                    n,
+                    index.ntotal,
+                    radius,
+                    result,
+                    sel);
+        } else {
+            range_search_inner_product_typed(
+                    x, xb, index.d, n, index.ntotal, radius, result, sel);
+        }
+    } else if (index.metric_type == METRIC_L2) {
+        range_search_L2sqr_typed(
+                x, xb, index.d, n, index.ntotal, radius, result, sel);
+    } else {
+        FAISS_THROW_MSG("metric type not supported");
+    }
+}
+
+template <typename T>
+void encode_half(idx_t n, idx_t d, const float* x, uint8_t* bytes) {
+    T* out = (T*)bytes;
+    for (idx_t i = 0; i < n * d; i++) {
+        out[i] = T(x[i]);
+    }
+}
+
+template <typename T>
+void decode_half(idx_t n, idx_t d, const uint8_t* bytes, float* x) {
+    const T* in = (const T*)bytes;
+    for (idx_t i = 0; i < n * d; i++) {
+        x[i] = float(in[i]);
+    }
+}
+
+template <typename T>
+float half_distance(MetricType metric, const T* x, const T* y, size_t d) {
+    if constexpr (std::is_same_v<T, knowhere::fp16>) {
+        return metric == METRIC_L2 ? fp16_vec_L2sqr(x, y, d)
+                                   : fp16_vec_inner_product(x, y, d);
+    } else {
+        return metric == METRIC_L2 ? bf16_vec_L2sqr(x, y, d)
+                                   : bf16_vec_inner_product(x, y, d);
+    }
+}
+
+// the query is kept in the format of the codes, for the distances to be
+// computed by the typed kernels
+template <typename T>
+struct FlatHalfDis : FlatCodesDistanceComputer {
+    size_t d;
+    MetricType metric;
+    const float* inverse_norms;
+    std::vector<T> query;
+    float inverse_query_norm = 1.0f;
+
+    explicit FlatHalfDis(const IndexFlatHalf& index)
+            : FlatCodesDistanceComputer(index.codes.data(), index.code_size),
+              d(index.d),
+              metric(index.metric_type),
+              inverse_norms(index.get_inverse_norms()),
+              query(index.d) {}
+
+    void set_query(const float* x) override {
+        encode_half<T>(1, d, x, (uint8_t*)query.data());
+        if (inverse_norms != nullptr) {
+            float norm;
+            half_norms(query.data(), 1, d, &norm);
+            inverse_query_norm = (norm == 0.0f) ? 1.0f : 1.0f / norm;
+        }
+    }
+
+    float distance_to_code(const uint8_t* code) override {
+        const float dis =
+                half_distance(metric, query.data(), (const T*)code, d);
+        if (inverse_norms != nullptr) {
+            const idx_t i = (code - codes) / code_size;
+            return dis * inverse_norms[i] * inverse_query_norm;
+        }
+        return dis;
+    }
+
+    float symmetric_dis(idx_t i, idx_t j) override {
+        const float dis = half_distance(
+                metric,
+                (const T*)(codes + i * code_size),
+                (const T*)(codes + j * code_size),
+                d);
+        if (inverse_norms != nullptr) {
+            return dis * inverse_norms[i] * inverse_norms[j];
+        }
+        return dis;
+    }
+};
+
+} // namespace
+
+IndexFlatHalf::IndexFlatHalf(
+        idx_t d,
+        MetricType metric,
+        bool is_bf16,
+        bool is_cosine)
+        : IndexFlatCodes(sizeof(uint16_t) * d, d, metric), is_bf16(is_bf16) {
+    this->is_cosine = is_cosine;
+}
+
+IndexFlatHalf::IndexFlatHalf() = default;
+
+void IndexFlatHalf::add_typed(idx_t n, const void* x) {
+    FAISS_THROW_IF_NOT(is_trained);
+    if (n == 0) {
+        return;
+    }
+    codes.resize((ntotal + n) * code_size);
+    std::memcpy(&codes[ntotal * code_size], x, n * code_size);
+    if (is_cosine) {
+        std::vector<float> norms(n);
+        if (is_bf16) {
+            half_norms((const knowhere::bf16*)x, n, d, norms.data());
+        } else {
+            half_norms((const knowhere::fp16*)x, n, d, norms.data());
+        }
+        inverse_norms_storage.add_l2_norms(norms.data(), n);
+    }
+    ntotal += n;
+}
+
+void IndexFlatHalf::add(idx_t n, const float* x) {
+    std::unique_ptr<uint8_t[]> x_half(new uint8_t[n * code_size]);
+    sa_encode(n, x, x_half.get());
+    add_typed(n, x_half.get());
+}
+
+void IndexFlatHalf::reset() {
+    IndexFlatCodes::reset();
+    inverse_norms_storage.reset();
+}
+
+void IndexFlatHalf::search_typed(
+        idx_t n,
+        const void* x,
+        idx_t k,
+        float* distances,
+        idx_t* labels,
+        const SearchParameters* params) const {
+    FAISS_THROW_IF_NOT(k > 0);
+    const IDSelector* sel = params ? params->sel : nullptr;
+    if (is_bf16) {
+        half_search(
+                *this, n, (const knowhere::bf16*)x, k, distances, labels, sel);
+    } else {
+        half_search(
+                *this, n, (const knowhere::fp16*)x, k, distances, labels, sel);
+    }
+}
+
+void IndexFlatHalf::range_search_typed(
+        idx_t n,
+        const void* x,
+        float radius,
+        RangeSearchResult* result,
+        const SearchParameters* params) const {
+    const IDSelector* sel = params ? params->sel : nullptr;
+    if (is_bf16) {
+        half_range_search(
+                *this, n, (const knowhere::bf16*)x, radius, result, sel);
+    } else {
+        half_range_search(
+                *this, n, (const knowhere::fp16*)x, radius, result, sel);
+    }
+}
+
+void IndexFlatHalf::search(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        float* distances,
+        idx_t* labels,
+        const SearchParameters* params) const {
+    std::unique_ptr<uint8_t[]> x_half(new uint8_t[n * code_size]);
+    sa_encode(n, x, x_half.get());
+    search_typed(n, x_half.get(), k, distances, labels, params);
+}
+
+void IndexFlatHalf::range_search(
+        idx_t n,
+        const float* x,
+        float radius,
+        RangeSearchResult* result,
+        const SearchParameters* params) const {
+    std::unique_ptr<uint8_t[]> x_half(new uint8_t[n * code_size]);
+    sa_encode(n, x, x_half.get());
+    range_search_typed(n, x_half.get(), radius, result, params);
+}
+
+void IndexFlatHalf::sa_encode(idx_t n, const float* x, uint8_t* bytes) const {
+    if (is_bf16) {
+        encode_half<knowhere::bf16>(n, d, x, bytes);
+    } else {
+        encode_half<knowhere::fp16>(n, d, x, bytes);
+    }
+}
+
+void IndexFlatHalf::sa_decode(idx_t n, const uint8_t* bytes, float* x) const {
+    if (is_bf16) {
+        decode_half<knowhere::bf16>(n, d, bytes, x);
+    } else {
+        decode_half<knowhere::fp16>(n, d, bytes, x);
+    }
+}
+
+FlatCodesDistanceComputer* IndexFlatHalf::get_FlatCodesDistanceComputer()
+        const {
+    FAISS_THROW_IF_NOT(
+            metric_type == METRIC_L2 || metric_type == METRIC_INNER_PRODUCT);
+    if (is_bf16) {
+        return new FlatHalfDis<knowhere::bf16>(*this);
+    }
+    return new FlatHalfDis<knowhere::fp16>(*this);
+}
+
+size_t IndexFlatHalf::cal_size() const {
+    return ntotal * code_size +
+            inverse_norms_storage.inverse_l2_norms.size() * sizeof(float);
+}
+
+} // namespace faiss
@@ -0,0 +1,99 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+// knowhere-specific indices
+
+#pragma once
+
+#include <cstdint>
+
+#include <faiss/IndexCosine.h>
+#include <faiss/IndexFlatCodes.h>
+
+namespace faiss {
+
+/** Index that stores the full vectors in half precision, fp16 or bf16, and
+ * performs exhaustive search.
+ *
+ * The vectors are added and searched as they are given, through add_typed()
+ * and search_typed(), and their distances are computed by the typed
+ * distance functions, so that neither the data nor the queries are
+ * converted to fp32. The float interface of Index converts the vectors.
+ */
+struct IndexFlatHalf : IndexFlatCodes {
+    /// the codes are bf16 if set, fp16 otherwise
+    bool is_bf16 = false;
+
+    /// the inverse L2 norms of the vectors, for the cosine search
+    L2NormsStorage inverse_norms_storage;
+
+    IndexFlatHalf(
+            idx_t d,
+            MetricType metric,
+            bool is_bf16,
+            bool is_cosine = false);
+
+    IndexFlatHalf();
+
+    /// adds n vectors that are in the format of the codes
+    void add_typed(idx_t n, const void* x);
+
+    /// searches n queries that are in the format of the codes
+    void search_typed(
+            idx_t n,
+            const void* x,
+            idx_t k,
+            float* distances,
+            idx_t* labels,
+            const SearchParameters* params = nullptr) const;
+
+    /// range searches n queries that are in the format of the codes
+    void range_search_typed(
+            idx_t n,
+            const void* x,
+            float radius,
+            RangeSearchResult* result,
+            const SearchParameters* params = nullptr) const;
+
+    void add(idx_t n, const float* x) override;
+
+    void reset() override;
+
+    void search(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            float* distances,
+            idx_t* labels,
+            const SearchParameters* params = nullptr) const override;
+
+    void range_search(
+            idx_t n,
+            const float* x,
+            float radius,
+            RangeSearchResult* result,
+            const SearchParameters* params = nullptr) const override;
+
+    void sa_encode(idx_t n, const float* x, uint8_t* bytes) const override;
+
+    void sa_decode(idx_t n, const uint8_t* bytes, float* x) const override;
+
+    FlatCodesDistanceComputer* get_FlatCodesDistanceComputer() const override;
+
+    const float* get_inverse_norms() const {
+        return is_cosine ? inverse_norms_storage.inverse_l2_norms.data()
+                         : nullptr;
+    }
+
+    size_t cal_size() const;
+};
+
+} // namespace faiss
@@ -15,6 +15,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cmath>
 #include <cstdio>
 #include <limits>
 #include <memory>
@@ -23,6 +24,7 @@
 #include <faiss/utils/hamming.h>
 #include <faiss/utils/utils.h>
 
+#include <faiss/FaissHook.h>
 #include <faiss/IndexFlat.h>
 #include <faiss/impl/AuxIndexStructures.h>
 #include <faiss/impl/CodePacker.h>
@@ -411,11 +413,19 @@ void IndexIVF::search(
         // collect stats
         for (idx_t slice = 0; slice < nt; slice++) {
             indexIVF_stats.add(stats[slice]);
+            if (params && params->stats) {
+                params->stats->add(stats[slice]);
+            }
         }
     } else {
         // handle parallelization at level below (or don't run in parallel at
         // all)
-        sub_search_func(n, x, distances, labels, &indexIVF_stats);
+        IndexIVFStats stats;
+        sub_search_func(n, x, distances, labels, &stats);
+        indexIVF_stats.add(stats);
+        if (params && params->stats) {
+            params->stats->add(stats);
+        }
     }
 }
 
@@ -439,6 +449,11 @@ void IndexIVF::search_preassigned(
     const idx_t unlimited_list_size = std::numeric_limits<idx_t>::max();
     idx_t max_codes = params ? params->max_codes : this->max_codes;
     bool ensure_topk_full = params ? params->ensure_topk_full : false;
+    size_t max_lists_num = params ? params->max_lists_num : 0;
+    if (max_lists_num == 0) {
+        max_lists_num = nlist;
+    }
+    float adaptive_nprobe_ratio = params ? params->adaptive_nprobe_ratio : 0;
     IDSelector* sel = params ? params->sel : nullptr;
     const IDSelectorRange* selr = dynamic_cast<const IDSelectorRange*>(sel);
     if (selr) {
@@ -610,10 +625,75 @@ void IndexIVF::search_preassigned(
             }
         };
 
+        // whether the list holds an id accepted by the selector. The ids are
+        // only read up to the first accepted one, so that a list filtered out
+        // entirely is skipped before the scanner prepares it
+        auto has_selected_ids = [&](idx_t key) {
+            if (sel == nullptr || key < 0 || invlists->use_iterator) {
+                return true;
+            }
+            size_t segment_num = invlists->get_segment_num(key);
+            for (size_t segment_idx = 0; segment_idx < segment_num;
+                 segment_idx++) {
+                size_t segment_size =
+                        invlists->get_segment_size(key, segment_idx);
+                size_t segment_offset =
+                        invlists->get_segment_offset(key, segment_idx);
+                InvertedLists::ScopedIds sids(invlists, key, segment_offset);
+                const idx_t* ids = sids.get();
+                for (size_t j = 0; j < segment_size; j++) {
+                    if (sel->is_member(ids[j])) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+
         /****************************************************
          * Actual loops, depending on parallel_mode
          ****************************************************/
 
+        // whether the vectors of the probe ik of the query i can not beat
+        // the k-th result in simi[0], see adaptive_nprobe_ratio
+        std::vector<float> nearest_centroid, centroid;
+        idx_t nearest_centroid_query = -1;
+        if (adaptive_nprobe_ratio > 0) {
+            nearest_centroid.resize(d);
+            centroid.resize(d);
+        }
+        auto is_pruned = [&](idx_t i, size_t ik, const float* simi) {
+            const idx_t key0 = keys[i * nprobe];
+            const idx_t key = keys[i * nprobe + ik];
+            if (adaptive_nprobe_ratio <= 0 || ik == 0 || key0 < 0 ||
+                key < 0) {
+                return false;
+            }
+            if (nearest_centroid_query != i) {
+                quantizer->reconstruct(key0, nearest_centroid.data());
+                nearest_centroid_query = i;
+            }
+            quantizer->reconstruct(key, centroid.data());
+            const float gap = std::sqrt(fvec_L2sqr(
+                    nearest_centroid.data(), centroid.data(), d));
+            if (gap <= 0) {
+                return false;
+            }
+            const float dis0 = coarse_dis[i * nprobe];
+            const float dis = coarse_dis[i * nprobe + ik];
+            if (metric_type == METRIC_INNER_PRODUCT) {
+                // the lists are the half-spaces x . (c - c0) >= 0
+                const float bound =
+                        adaptive_nprobe_ratio * (dis0 - dis) / gap;
+                return 1 - bound * bound / 2 <= simi[0];
+            } else {
+                // the lists are the Voronoi cells, the distances are squared
+                const float bound =
+                        adaptive_nprobe_ratio * (dis - dis0) / (2 * gap);
+                return bound * bound >= simi[0];
+            }
+        };
+
         if (pmode == 0 || pmode == 3) {
 #pragma omp for
             for (idx_t i = 0; i < n; i++) {
@@ -629,20 +709,29 @@ void IndexIVF::search_preassigned(
                 init_result(simi, idxi);
 
                 idx_t nscan = 0;
+                size_t nlists_scanned = 0;
 
                 // loop over probes
                 for (size_t ik = 0; ik < nprobe; ik++) {
+                    if (is_pruned(i, ik, simi) ||
+                        !has_selected_ids(keys[i * nprobe + ik])) {
+                        continue;
+                    }
                     nscan += scan_one_list(
                             keys[i * nprobe + ik],
                             coarse_dis[i * nprobe + ik],
                             simi,
                             idxi,
                             max_codes - nscan);
+                    nlists_scanned++;
 
                     // if ensure_topk_full enabled, also make sure nscan >= k, then stop search further
                     if (nscan >= max_codes && (!ensure_topk_full || nscan >= k)) {
                         break;
                     }
+                    if (nlists_scanned >= max_lists_num) {
+                        break;
+                    }
                 }
 
                 ndis += nscan;
@@ -1301,25 +1390,33 @@ void IndexIVF::getIteratorNextBatch(
         size_t current_backup_count) const {
     workspace->dists.clear();
 
+    void* inverted_list_context = workspace->search_params
+            ? workspace->search_params->inverted_list_context
+            : nullptr;
+
+    if (!workspace->scanner) {
+        IDSelector* sel = workspace->search_params
+                ? workspace->search_params->sel
+                : nullptr;
+        workspace->scanner.reset(
+                get_InvertedListScanner(false, sel, workspace->search_params));
+        workspace->scanner->set_query(workspace->query_data.data());
+    }
+    InvertedListScanner* scanner = workspace->scanner.get();
+    size_t& list_offset = workspace->next_visit_list_offset;
+    const size_t min_batch_codes = std::max<size_t>(
+            workspace->backup_count_threshold /
+                    std::max<size_t>(workspace->nprobe, 1),
+            1);
+
     while (current_backup_count + workspace->dists.size() <
                    workspace->backup_count_threshold &&
            workspace->next_visit_coarse_list_idx < nlist) {
-        auto next_list_idx = workspace->next_visit_coarse_list_idx;
-        workspace->next_visit_coarse_list_idx++;
-
-        invlists->prefetch_lists(
-                workspace->coarse_idx.get() + next_list_idx, 1);
+        const auto next_list_idx = workspace->next_visit_coarse_list_idx;
         const auto list_no = workspace->coarse_idx[next_list_idx];
-        const auto coarse_list_centroid_dist =
-                workspace->coarse_dis[next_list_idx];
-
-        // max_codes is the size of the list when we started the
-        // iteration so that we won't search vectors added during the
-        // iteration(for IVFCC).
-        const auto max_codes = workspace->coarse_list_sizes
-                                       [workspace->coarse_idx[next_list_idx]];
         if (list_no < 0) {
             // not enough centroids for multiprobe
+            workspace->next_visit_coarse_list_idx++;
             continue;
         }
         FAISS_THROW_IF_NOT_FMT(
@@ -1328,37 +1425,48 @@ void IndexIVF::getIteratorNextBatch(
                 list_no,
                 nlist);
 
-        // don't waste time on empty lists
-        void* inverted_list_context = workspace->search_params
-                ? workspace->search_params->inverted_list_context
-                : nullptr;
+        // max_codes is the size of the list when we started the
+        // iteration so that we won't search vectors added during the
+        // iteration(for IVFCC).
+        const size_t max_codes = workspace->coarse_list_sizes[list_no];
 
-        if (invlists->is_empty(list_no, inverted_list_context)) {
+        // don't waste time on empty lists
+        if (list_offset >= max_codes ||
+            invlists->is_empty(list_no, inverted_list_context)) {
+            workspace->next_visit_coarse_list_idx++;
+            list_offset = 0;
             continue;
         }
 
-        // get scanner
-        IDSelector* sel = workspace->search_params
-                ? workspace->search_params->sel
-                : nullptr;
-        std::unique_ptr<InvertedListScanner> scanner(
-                get_InvertedListScanner(false, sel, workspace->search_params));
-        scanner->set_query(workspace->query_data.data());
-        scanner->set_list(list_no, coarse_list_centroid_dist);
+        if (list_offset == 0) {
+            invlists->prefetch_lists(&list_no, 1);
+            scanner->set_list(list_no, workspace->coarse_dis[next_list_idx]);
+        }
+
+        // the pool is refilled by at least the average size of the probed
+        // lists, so that a large list is scanned over several batches, the
+        // rest of it being left to the following ones
+        const size_t missing = workspace->backup_count_threshold -
+                current_backup_count - workspace->dists.size();
+        const size_t scan_end = std::min(
+                max_codes, list_offset + std::max(missing, min_batch_codes));
 
         size_t segment_num = invlists->get_segment_num(list_no);
-        size_t scan_cnt = 0;
         for (size_t segment_idx = 0; segment_idx < segment_num; segment_idx++) {
-            size_t segment_size =
+            size_t segment_offset =
+                    invlists->get_segment_offset(list_no, segment_idx);
+            size_t segment_end = segment_offset +
                     invlists->get_segment_size(list_no, segment_idx);
-            size_t should_scan_size =
-                    std::min(segment_size, max_codes - scan_cnt);
-            scan_cnt += should_scan_size;
-            if (should_scan_size <= 0) {
+            if (segment_end <= list_offset) {
+                continue;
+            }
+            if (segment_offset >= scan_end) {
                 break;
             }
-            size_t segment_offset =
-                    invlists->get_segment_offset(list_no, segment_idx);
+            const size_t begin = std::max(list_offset, segment_offset);
+            const size_t end = std::min(scan_end, segment_end);
+            const size_t skip = begin - segment_offset;
+
             InvertedLists::ScopedCodes scodes(
                     invlists, list_no, segment_offset);
             InvertedLists::ScopedCodeNorms scode_norms(
@@ -1366,12 +1474,13 @@ void IndexIVF::getIteratorNextBatch(
             InvertedLists::ScopedIds sids(invlists, list_no, segment_offset);
 
             scanner->scan_codes_and_return(
-                    should_scan_size,
-                    scodes.get(),
-                    scode_norms.get(),
-                    sids.get(),
+                    end - begin,
+                    scodes.get() + skip * code_size,
+                    scode_norms.get() ? scode_norms.get() + skip : nullptr,
+                    sids.get() + skip,
                     workspace->dists);
         }
+        list_offset = scan_end;
     }
 }
 
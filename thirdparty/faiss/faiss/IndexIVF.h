@@ -70,6 +70,8 @@ struct Level1Quantizer {
     ~Level1Quantizer();
 };
 
+struct IndexIVFStats;
+
 struct SearchParametersIVF : SearchParameters {
     size_t nprobe = 1;    ///< number of probes at query time
     size_t max_codes = 0; ///< max nb of codes to visit to do a query
@@ -79,23 +81,39 @@ struct SearchParametersIVF : SearchParameters {
     ///< therefore to make sure we get topk results, use nprobe=nlist and use max_codes to narrow down the search range
     size_t max_lists_num = 0; ///< select min{scanned number of (max_codes),
     ///< scanned number of (max_lists_num) to return.}
+    ///< IndexIVF does not count the probed lists whose ids are all rejected
+    ///< by sel, they are skipped without being scanned: with a larger nprobe,
+    ///< the search then probes further lists in their place.
     bool ensure_topk_full = false;
 
     ///< during IVF range search, if reach 'max_empty_result_buckets' num of
     ///< continuous buckets with no valid results, terminate range search
     size_t max_empty_result_buckets = 0;
 
+    ///< adaptive probing: skip the probed lists that the current k-th result
+    ///< makes useless. The vectors of a list lie beyond the bisector between
+    ///< its centroid and the nearest probed one, which bounds their distance
+    ///< to the query. The bound is multiplied by this ratio, 0 disables the
+    ///< pruning, 1 keeps it exact and larger values skip more lists. Only
+    ///< valid for L2, and for inner products on normalized vectors.
+    float adaptive_nprobe_ratio = 0;
+
     SearchParameters* quantizer_params = nullptr;
 
     /// context object to pass to InvertedLists
     void* inverted_list_context = nullptr;
 
+    ///< if set, the stats of a search() are added to it as well as to the
+    ///< global indexIVF_stats, e.g. to get the stats of a single query
+    IndexIVFStats* stats = nullptr;
+
     virtual ~SearchParametersIVF() {}
 };
 
 // the new convention puts the index type after SearchParameters
 using IVFSearchParameters = SearchParametersIVF;
 struct DistanceComputer;
+struct InvertedListScanner;
 struct IVFIteratorWorkspace {
     IVFIteratorWorkspace() = default;
     IVFIteratorWorkspace(
@@ -110,6 +128,10 @@ struct IVFIteratorWorkspace {
     size_t backup_count_threshold = 0;   // count * nprobe / nlist
     std::vector<knowhere::DistId> dists; // should be cleared after each use
     size_t next_visit_coarse_list_idx = 0;
+    // cursor in the list being visited, the next batch resumes there
+    size_t next_visit_list_offset = 0;
+    // set to the query at the first batch, then kept across the lists
+    std::unique_ptr<InvertedListScanner> scanner;
     std::unique_ptr<float[]> coarse_dis =
             nullptr; // backup coarse centroids distances (heap)
     std::unique_ptr<idx_t[]> coarse_idx =
@@ -117,9 +139,10 @@ struct IVFIteratorWorkspace {
     std::unique_ptr<size_t[]> coarse_list_sizes =
             nullptr; // snapshot of the list_size
     std::unique_ptr<DistanceComputer> dis_refine;
+    // the query of dis_refine, if it differs from query_data
+    std::vector<float> refine_query_data;
 };
 
-struct InvertedListScanner;
 struct IndexIVFStats;
 struct CodePacker;
 
@@ -259,7 +282,8 @@ struct IndexIVF : Index, IndexIVFInterface {
     //   The iterator will maintain a heap of at least (nprobe/nlist) nodes for
     //   iterator `Next()` operation.
     //   When there are not enough nodes in the heap, iterator will scan the
-    //   next coarse list.
+    //   codes missing from it, resuming at the cursor of the current coarse
+    //   list and moving on to the next coarse lists in centroid order.
     virtual void getIteratorNextBatch(
             IVFIteratorWorkspace* workspace,
             size_t current_backup_count) const;
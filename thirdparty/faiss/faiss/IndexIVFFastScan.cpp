@@ -718,6 +718,11 @@ void IndexIVFFastScan::search_dispatch_implem(
         indexIVF_stats.nq += n;
         indexIVF_stats.ndis += ndis;
         indexIVF_stats.nlist += nlist_visited;
+        if (params && params->stats) {
+            params->stats->nq += n;
+            params->stats->ndis += ndis;
+            params->stats->nlist += nlist_visited;
+        }
     } else {
         FAISS_THROW_FMT("implem %d does not exist", implem);
     }
@@ -930,6 +935,11 @@ void IndexIVFFastScan::search_implem_1(
     indexIVF_stats.nq += n;
     indexIVF_stats.ndis += ndis;
     indexIVF_stats.nlist += nlist_visited;
+    if (params && params->stats) {
+        params->stats->nq += n;
+        params->stats->ndis += ndis;
+        params->stats->nlist += nlist_visited;
+    }
 }
 
 template <class C>
@@ -1020,6 +1030,11 @@ void IndexIVFFastScan::search_implem_2(
     indexIVF_stats.nq += n;
     indexIVF_stats.ndis += ndis;
     indexIVF_stats.nlist += nlist_visited;
+    if (params && params->stats) {
+        params->stats->nq += n;
+        params->stats->ndis += ndis;
+        params->stats->nlist += nlist_visited;
+    }
 }
 
 void IndexIVFFastScan::search_implem_10(
@@ -1724,6 +1739,11 @@ void IndexIVFFastScan::search_implem_14(
     indexIVF_stats.nq += n;
     indexIVF_stats.ndis += ndis;
     indexIVF_stats.nlist += nlist_visited;
+    if (params && params->stats) {
+        params->stats->nq += n;
+        params->stats->ndis += ndis;
+        params->stats->nlist += nlist_visited;
+    }
 }
 
 void IndexIVFFastScan::reconstruct_from_offset(
@@ -253,9 +253,16 @@ struct IVFFlatScanner : InvertedListScanner {
 template <MetricType metric, class C, bool use_sel>
 struct IVFFlatScanner : InvertedListScanner {
     size_t d;
+    // resolved for d once, the scans of the lists call it per vector
+    decltype(fvec_L2sqr) dis_func;
 
     IVFFlatScanner(size_t d, bool store_pairs, const IDSelector* sel)
-            : InvertedListScanner(store_pairs, sel), d(d) {
+            : InvertedListScanner(store_pairs, sel),
+              d(d),
+              dis_func(
+                      metric == METRIC_INNER_PRODUCT
+                              ? fvec_inner_product_for_dim(d)
+                              : fvec_L2sqr_for_dim(d)) {
         keep_max = is_similarity_metric(metric);
     }
 
@@ -270,10 +277,7 @@ struct IVFFlatScanner : InvertedListScanner {
 
     float distance_to_code(const uint8_t* code) const override {
         const float* yj = (float*)code;
-        float dis = metric == METRIC_INNER_PRODUCT
-                ? fvec_inner_product(xi, yj, d)
-                : fvec_L2sqr(xi, yj, d);
-        return dis;
+        return dis_func(xi, yj, d);
     }
 
     size_t scan_codes(
@@ -288,9 +292,10 @@ struct IVFFlatScanner : InvertedListScanner {
         const float* list_vecs = (const float*)codes;
         size_t nup = 0;
 
-        // the lambda that filters acceptable elements.
+        // the lambda that filters acceptable elements, 64 ids at a time.
+        IDSelectorBatchCursor<IDSelector, idx_t> members(sel, ids, list_size);
         auto filter =
-            [&](const size_t j) { return (!use_sel || sel->is_member(ids[j])); };
+            [&](const size_t j) { return (!use_sel || members.is_member(j)); };
 
         // the lambda that applies a valid element.
         auto apply =
@@ -324,9 +329,10 @@ struct IVFFlatScanner : InvertedListScanner {
             std::vector<knowhere::DistId>& out) const override {
         const float* list_vecs = (const float*)codes;
 
-        // the lambda that filters acceptable elements.
+        // the lambda that filters acceptable elements, 64 ids at a time.
+        IDSelectorBatchCursor<IDSelector, idx_t> members(sel, ids, list_size);
         auto filter = [&](const size_t j) {
-            return (!use_sel || sel->is_member(ids[j]));
+            return (!use_sel || members.is_member(j));
         };
         // the lambda that applies a valid element.
         auto apply = [&](const float dis_in, const size_t j) {
@@ -351,9 +357,10 @@ struct IVFFlatScanner : InvertedListScanner {
             RangeQueryResult& res) const override {
         const float* list_vecs = (const float*)codes;
 
-        // the lambda that filters acceptable elements.
+        // the lambda that filters acceptable elements, 64 ids at a time.
+        IDSelectorBatchCursor<IDSelector, idx_t> members(sel, ids, list_size);
         auto filter =
-            [&](const size_t j) { return (!use_sel || sel->is_member(ids[j])); };
+            [&](const size_t j) { return (!use_sel || members.is_member(j)); };
 
         // the lambda that applies a filtered element.
         auto apply =
@@ -380,10 +387,16 @@ struct IVFFlatScanner : InvertedListScanner {
 template <MetricType metric, class C, bool use_sel>
 struct IVFFlatBitsetViewScanner : InvertedListScanner {
     size_t d;
+    decltype(fvec_L2sqr) dis_func;
     knowhere::BitsetView bitset;
 
     IVFFlatBitsetViewScanner(size_t d, bool store_pairs, const IDSelector* sel)
-            : InvertedListScanner(store_pairs, sel), d(d) {
+            : InvertedListScanner(store_pairs, sel),
+              d(d),
+              dis_func(
+                      metric == METRIC_INNER_PRODUCT
+                              ? fvec_inner_product_for_dim(d)
+                              : fvec_L2sqr_for_dim(d)) {
         const auto* bitsetview_sel = dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel);
         FAISS_ASSERT_MSG((bitsetview_sel != nullptr), "Unsupported scanner for IVFFlatBitsetViewScanner");
 
@@ -401,10 +414,7 @@ struct IVFFlatBitsetViewScanner : InvertedListScanner {
 
     float distance_to_code(const uint8_t* code) const override {
         const float* yj = (float*)code;
-        float dis = metric == METRIC_INNER_PRODUCT
-                ? fvec_inner_product(xi, yj, d)
-                : fvec_L2sqr(xi, yj, d);
-        return dis;
+        return dis_func(xi, yj, d);
     }
 
     size_t scan_codes(
@@ -17,8 +17,9 @@ IndexIVFRaBitQ::IndexIVFRaBitQ(
         Index* quantizer,
         const size_t d,
         const size_t nlist,
-        MetricType metric)
-        : IndexIVF(quantizer, d, nlist, 0, metric), rabitq(d, metric) {
+        MetricType metric,
+        const size_t nb_bits)
+        : IndexIVF(quantizer, d, nlist, 0, metric), rabitq(d, metric, nb_bits) {
     code_size = rabitq.code_size;
     invlists->code_size = code_size;
     is_trained = false;
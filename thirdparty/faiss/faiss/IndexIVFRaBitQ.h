@@ -22,11 +22,13 @@ struct IndexIVFRaBitQ : IndexIVF {
     // use '0' to disable quantization and use raw fp32 values.
     uint8_t qb = 0;
 
+    // nb_bits > 1 selects the extended RaBitQ codes, see RaBitQuantizer
     IndexIVFRaBitQ(
             Index* quantizer,
             const size_t d,
             const size_t nlist,
-            MetricType metric = METRIC_L2);
+            MetricType metric = METRIC_L2,
+            const size_t nb_bits = 1);
 
     IndexIVFRaBitQ();
 
@@ -0,0 +1,367 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <faiss/IndexNonUniformSQ.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include <faiss/FaissHook.h>
+#include <faiss/impl/DistanceComputer.h>
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/impl/ResultHandler.h>
+
+namespace faiss {
+
+namespace {
+
+// the training rows that the levels are learned from, at most
+constexpr size_t kMaxTrainRows = 65536;
+
+// the Lloyd iterations of the 1D k-means of a dimension
+constexpr int kTrainIterations = 16;
+
+} // namespace
+
+/*******************************************************************
+ * NonUniformScalarQuantizer
+ *******************************************************************/
+
+NonUniformScalarQuantizer::NonUniformScalarQuantizer(size_t d, size_t nbits)
+        : d(d), nbits(nbits) {
+    FAISS_THROW_IF_NOT_MSG(
+            nbits == 4 || nbits == 6,
+            "non-uniform scalar quantizer supports 4 or 6 bits");
+    code_size = padded_d() * nbits / 8;
+}
+
+size_t NonUniformScalarQuantizer::padded_d() const {
+    // 2 dimensions per byte for 4 bits, 4 dimensions per 3 bytes for 6 bits
+    const size_t group = nbits == 4 ? 2 : 4;
+    return (d + group - 1) / group * group;
+}
+
+void NonUniformScalarQuantizer::train(size_t n, const float* x) {
+    FAISS_THROW_IF_NOT(n > 0);
+    const size_t k = ksub();
+    const size_t n_train = std::min(n, kMaxTrainRows);
+    codebooks.resize(d * k);
+
+#pragma omp parallel for
+    for (int64_t j = 0; j < (int64_t)d; j++) {
+        std::vector<float> values(n_train);
+        for (size_t i = 0; i < n_train; i++) {
+            // evenly spaced rows over the training set
+            values[i] = x[(i * n / n_train) * d + j];
+        }
+        std::sort(values.begin(), values.end());
+
+        float* levels = codebooks.data() + j * k;
+        for (size_t l = 0; l < k; l++) {
+            levels[l] = values[std::min(
+                    n_train - 1, (size_t)((l + 0.5) * n_train / k))];
+        }
+
+        // Lloyd over the sorted values: the cells of the levels are the
+        // ranges between the midpoints of the neighbouring levels
+        std::vector<double> sums(k);
+        std::vector<size_t> counts(k);
+        for (int iter = 0; iter < kTrainIterations; iter++) {
+            std::fill(sums.begin(), sums.end(), 0.0);
+            std::fill(counts.begin(), counts.end(), 0);
+            size_t l = 0;
+            for (const float v : values) {
+                while (l + 1 < k && v > 0.5f * (levels[l] + levels[l + 1])) {
+                    l++;
+                }
+                sums[l] += v;
+                counts[l]++;
+            }
+            bool changed = false;
+            for (size_t c = 0; c < k; c++) {
+                if (counts[c] == 0) {
+                    continue;
+                }
+                const float level = (float)(sums[c] / counts[c]);
+                changed |= level != levels[c];
+                levels[c] = level;
+            }
+            if (!changed) {
+                break;
+            }
+        }
+    }
+}
+
+void NonUniformScalarQuantizer::compute_codes(
+        const float* x,
+        uint8_t* codes,
+        size_t n) const {
+    const size_t k = ksub();
+    const size_t pd = padded_d();
+
+#pragma omp parallel for if (n > 1000)
+    for (int64_t i = 0; i < (int64_t)n; i++) {
+        std::vector<uint8_t> ids(pd, 0);
+        const float* xi = x + i * d;
+        for (size_t j = 0; j < d; j++) {
+            const float* levels = codebooks.data() + j * k;
+            size_t l = std::lower_bound(levels, levels + k, xi[j]) - levels;
+            if (l == k) {
+                l = k - 1;
+            } else if (l > 0 && xi[j] - levels[l - 1] < levels[l] - xi[j]) {
+                l--;
+            }
+            ids[j] = (uint8_t)l;
+        }
+
+        uint8_t* code = codes + i * code_size;
+        if (nbits == 4) {
+            for (size_t b = 0; b < code_size; b++) {
+                code[b] = ids[2 * b] | (ids[2 * b + 1] << 4);
+            }
+        } else {
+            for (size_t g = 0; g < pd / 4; g++) {
+                const uint32_t v = ids[4 * g] | (ids[4 * g + 1] << 6) |
+                        (ids[4 * g + 2] << 12) | (ids[4 * g + 3] << 18);
+                code[3 * g] = v & 0xff;
+                code[3 * g + 1] = (v >> 8) & 0xff;
+                code[3 * g + 2] = (v >> 16) & 0xff;
+            }
+        }
+    }
+}
+
+void NonUniformScalarQuantizer::unpack(const uint8_t* code, uint8_t* levels)
+        const {
+    if (nbits == 4) {
+        for (size_t b = 0; b < code_size; b++) {
+            levels[2 * b] = code[b] & 15;
+            levels[2 * b + 1] = code[b] >> 4;
+        }
+    } else {
+        for (size_t g = 0; g < code_size / 3; g++) {
+            const uint32_t v = code[3 * g] | (code[3 * g + 1] << 8) |
+                    (code[3 * g + 2] << 16);
+            levels[4 * g] = v & 63;
+            levels[4 * g + 1] = (v >> 6) & 63;
+            levels[4 * g + 2] = (v >> 12) & 63;
+            levels[4 * g + 3] = v >> 18;
+        }
+    }
+}
+
+void NonUniformScalarQuantizer::decode(
+        const uint8_t* codes,
+        float* x,
+        size_t n) const {
+    const size_t k = ksub();
+    std::vector<uint8_t> ids(padded_d());
+    for (size_t i = 0; i < n; i++) {
+        unpack(codes + i * code_size, ids.data());
+        for (size_t j = 0; j < d; j++) {
+            x[i * d + j] = codebooks[j * k + ids[j]];
+        }
+    }
+}
+
+/*******************************************************************
+ * the distance computer
+ *******************************************************************/
+
+namespace {
+
+// the sum of the lookup table entries of the levels of a code, with an
+// entry per level of every padded dimension
+template <size_t NBITS>
+float lut_distance(const float* lut, const uint8_t* code, size_t code_size) {
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    if constexpr (NBITS == 4) {
+        size_t b = 0;
+        for (; b + 2 <= code_size; b += 2, lut += 4 * 16) {
+            s0 += lut[code[b] & 15];
+            s1 += lut[16 + (code[b] >> 4)];
+            s2 += lut[32 + (code[b + 1] & 15)];
+            s3 += lut[48 + (code[b + 1] >> 4)];
+        }
+        if (b < code_size) {
+            s0 += lut[code[b] & 15];
+            s1 += lut[16 + (code[b] >> 4)];
+        }
+    } else {
+        for (size_t b = 0; b < code_size; b += 3, lut += 4 * 64) {
+            const uint32_t v =
+                    code[b] | (code[b + 1] << 8) | (code[b + 2] << 16);
+            s0 += lut[v & 63];
+            s1 += lut[64 + ((v >> 6) & 63)];
+            s2 += lut[128 + ((v >> 12) & 63)];
+            s3 += lut[192 + (v >> 18)];
+        }
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+template <size_t NBITS>
+struct NonUniformSQDistanceComputer : FlatCodesDistanceComputer {
+    const NonUniformScalarQuantizer& nusq;
+    const bool is_ip;
+
+    // padded_d x 2^NBITS, zero for the padding
+    std::vector<float> lut;
+    std::vector<float> tmp_i, tmp_j;
+
+    NonUniformSQDistanceComputer(
+            const NonUniformScalarQuantizer& nusq,
+            const uint8_t* codes,
+            MetricType metric)
+            : FlatCodesDistanceComputer(codes, nusq.code_size),
+              nusq(nusq),
+              is_ip(metric == METRIC_INNER_PRODUCT),
+              lut(nusq.padded_d() << NBITS, 0.0f),
+              tmp_i(nusq.d),
+              tmp_j(nusq.d) {}
+
+    void set_query(const float* x) override {
+        constexpr size_t k = size_t(1) << NBITS;
+        for (size_t j = 0; j < nusq.d; j++) {
+            const float* levels = nusq.codebooks.data() + j * k;
+            float* t = lut.data() + j * k;
+            for (size_t l = 0; l < k; l++) {
+                const float diff = x[j] - levels[l];
+                t[l] = is_ip ? x[j] * levels[l] : diff * diff;
+            }
+        }
+    }
+
+    float distance_to_code(const uint8_t* code) final {
+        return lut_distance<NBITS>(lut.data(), code, code_size);
+    }
+
+    float symmetric_dis(idx_t i, idx_t j) override {
+        nusq.decode(codes + i * code_size, tmp_i.data(), 1);
+        nusq.decode(codes + j * code_size, tmp_j.data(), 1);
+        return is_ip ? fvec_inner_product(tmp_i.data(), tmp_j.data(), nusq.d)
+                     : fvec_L2sqr(tmp_i.data(), tmp_j.data(), nusq.d);
+    }
+};
+
+struct Run_search_with_dc_res {
+    using T = void;
+
+    template <class BlockResultHandler>
+    void f(BlockResultHandler& res,
+           const IndexNonUniformSQ* index,
+           const float* xq) {
+        size_t ntotal = index->ntotal;
+        using SingleResultHandler =
+                typename BlockResultHandler::SingleResultHandler;
+        const int d = index->d;
+
+#pragma omp parallel
+        {
+            std::unique_ptr<FlatCodesDistanceComputer> dc(
+                    index->get_FlatCodesDistanceComputer());
+            SingleResultHandler resi(res);
+#pragma omp for
+            for (int64_t q = 0; q < res.nq; q++) {
+                resi.begin(q);
+                dc->set_query(xq + d * q);
+                for (size_t i = 0; i < ntotal; i++) {
+                    if (res.is_in_selection(i)) {
+                        float dis = (*dc)(i);
+                        resi.add_result(dis, i);
+                    }
+                }
+                resi.end();
+            }
+        }
+    }
+};
+
+} // namespace
+
+/*******************************************************************
+ * IndexNonUniformSQ
+ *******************************************************************/
+
+IndexNonUniformSQ::IndexNonUniformSQ(int d, size_t nbits, MetricType metric)
+        : IndexFlatCodes(0, d, metric), nusq(d, nbits) {
+    FAISS_THROW_IF_NOT(
+            metric == METRIC_L2 || metric == METRIC_INNER_PRODUCT);
+    code_size = nusq.code_size;
+    is_trained = false;
+}
+
+IndexNonUniformSQ::IndexNonUniformSQ() = default;
+
+void IndexNonUniformSQ::train(idx_t n, const float* x) {
+    nusq.train(n, x);
+    is_trained = true;
+}
+
+void IndexNonUniformSQ::search(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        float* distances,
+        idx_t* labels,
+        const SearchParameters* params) const {
+    FAISS_THROW_IF_NOT(k > 0);
+    FAISS_THROW_IF_NOT(is_trained);
+    const IDSelector* sel = params ? params->sel : nullptr;
+    Run_search_with_dc_res r;
+    dispatch_knn_ResultHandler(
+            n, distances, labels, k, metric_type, sel, r, this, x);
+}
+
+void IndexNonUniformSQ::sa_encode(idx_t n, const float* x, uint8_t* bytes)
+        const {
+    FAISS_THROW_IF_NOT(is_trained);
+    nusq.compute_codes(x, bytes, n);
+}
+
+void IndexNonUniformSQ::sa_decode(idx_t n, const uint8_t* bytes, float* x)
+        const {
+    FAISS_THROW_IF_NOT(is_trained);
+    nusq.decode(bytes, x, n);
+}
+
+FlatCodesDistanceComputer* IndexNonUniformSQ::get_FlatCodesDistanceComputer()
+        const {
+    if (nusq.nbits == 4) {
+        return new NonUniformSQDistanceComputer<4>(
+                nusq, codes.data(), metric_type);
+    }
+    return new NonUniformSQDistanceComputer<6>(nusq, codes.data(), metric_type);
+}
+
+size_t IndexNonUniformSQ::cal_size() const {
+    return codes.size() * sizeof(uint8_t) + sizeof(size_t) + nusq.cal_size();
+}
+
+/*******************************************************************
+ * IndexHNSWNonUniformSQ
+ *******************************************************************/
+
+IndexHNSWNonUniformSQ::IndexHNSWNonUniformSQ() = default;
+
+IndexHNSWNonUniformSQ::IndexHNSWNonUniformSQ(
+        int d,
+        size_t nbits,
+        int M,
+        MetricType metric)
+        : IndexHNSW(new IndexNonUniformSQ(d, nbits, metric), M) {
+    is_trained = this->storage->is_trained;
+    own_fields = true;
+}
+
+} // namespace faiss
@@ -0,0 +1,111 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+// knowhere-specific indices
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <faiss/IndexFlatCodes.h>
+#include <faiss/IndexHNSW.h>
+
+namespace faiss {
+
+/** A scalar quantizer with a learned codebook of 2^nbits levels per
+ * dimension, instead of the uniform grid of ScalarQuantizer.
+ *
+ * The levels of a dimension are a 1D k-means of its training values,
+ * initialized at their quantiles, so that the dense parts of a skewed
+ * distribution get more levels. A value is encoded as the index of its
+ * nearest level.
+ *
+ * The codes are 4 bits (2 dimensions per byte) or 6 bits (4 dimensions
+ * per 3 bytes) per dimension, the dimensions are padded to a whole number
+ * of bytes.
+ */
+struct NonUniformScalarQuantizer {
+    size_t d = 0;
+    size_t nbits = 0;
+    size_t code_size = 0;
+
+    /// d x 2^nbits levels, sorted per dimension
+    std::vector<float> codebooks;
+
+    NonUniformScalarQuantizer() = default;
+
+    NonUniformScalarQuantizer(size_t d, size_t nbits);
+
+    size_t ksub() const {
+        return size_t(1) << nbits;
+    }
+
+    /// the number of dimensions that the codes hold, d padded
+    size_t padded_d() const;
+
+    void train(size_t n, const float* x);
+
+    void compute_codes(const float* x, uint8_t* codes, size_t n) const;
+
+    void decode(const uint8_t* codes, float* x, size_t n) const;
+
+    /// the level index of every padded dimension of a code
+    void unpack(const uint8_t* code, uint8_t* levels) const;
+
+    size_t cal_size() const {
+        return sizeof(*this) + codebooks.size() * sizeof(float);
+    }
+};
+
+/** Flat storage of NonUniformScalarQuantizer codes.
+ *
+ * The distance computer builds a lookup table of the query with an entry
+ * per level of every dimension, and sums the entries of the levels of a
+ * code, without decoding it.
+ */
+struct IndexNonUniformSQ : IndexFlatCodes {
+    NonUniformScalarQuantizer nusq;
+
+    IndexNonUniformSQ(int d, size_t nbits, MetricType metric = METRIC_L2);
+
+    IndexNonUniformSQ();
+
+    void train(idx_t n, const float* x) override;
+
+    void search(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            float* distances,
+            idx_t* labels,
+            const SearchParameters* params = nullptr) const override;
+
+    void sa_encode(idx_t n, const float* x, uint8_t* bytes) const override;
+
+    void sa_decode(idx_t n, const uint8_t* bytes, float* x) const override;
+
+    FlatCodesDistanceComputer* get_FlatCodesDistanceComputer() const override;
+
+    size_t cal_size() const;
+};
+
+struct IndexHNSWNonUniformSQ : IndexHNSW {
+    IndexHNSWNonUniformSQ();
+    IndexHNSWNonUniformSQ(
+            int d,
+            size_t nbits,
+            int M,
+            MetricType metric = METRIC_L2);
+};
+
+} // namespace faiss
@@ -86,6 +86,36 @@ static void reorder_2_heaps(
     }
 }
 
+/// computes the distances of the n queries to their k labels with the refine
+/// index, which holds the raw data or a reduced-precision copy of it
+void compute_refine_distances(
+        const Index* refine_index,
+        idx_t n,
+        const float* x,
+        idx_t k,
+        float* distances,
+        const idx_t* labels) {
+    if (auto rf = dynamic_cast<const IndexFlat*>(refine_index)) {
+        rf->compute_distance_subset(n, x, k, distances, labels);
+        return;
+    }
+
+#pragma omp parallel if (n > 1)
+    {
+        std::unique_ptr<DistanceComputer> dc(
+                refine_index->get_distance_computer());
+#pragma omp for
+        for (idx_t i = 0; i < n; i++) {
+            dc->set_query(x + i * refine_index->d);
+            for (idx_t j = i * k; j < (i + 1) * k; j++) {
+                if (labels[j] >= 0) {
+                    distances[j] = (*dc)(labels[j]);
+                }
+            }
+        }
+    }
+}
+
 } // anonymous namespace
 
 int64_t IndexScaNN::size() {
@@ -103,7 +133,9 @@ int64_t IndexScaNN::size() {
     auto centroid_table = pq.M * pq.ksub * pq.dsub * sizeof(float);
     auto precomputed_table = nlist * pq.M * pq.ksub * sizeof(float);
 
-    auto raw_data = (refine_index ? index_->ntotal * d * sizeof(float) : 0);
+    auto refine_codes = dynamic_cast<const IndexFlatCodes*>(refine_index);
+    auto raw_data = (refine_codes ? index_->ntotal * refine_codes->code_size
+                                  : 0);
     return (capacity + centroid_table + precomputed_table + raw_data);
 }
 
@@ -167,10 +199,8 @@ void IndexScaNN::search(
         assert(base_labels[i] >= -1 && base_labels[i] < ntotal);
 
     // compute refined distances
-    auto rf = dynamic_cast<const IndexFlat*>(refine_index);
-    FAISS_THROW_IF_NOT(rf);
-
-    rf->compute_distance_subset(n, x, k_base, base_distances, base_labels);
+    compute_refine_distances(
+            refine_index, n, x, k_base, base_distances, base_labels);
 
     if (base->is_cosine) {
         for (idx_t i = 0; i < n * k_base; i++) {
@@ -227,10 +257,13 @@ void IndexScaNN::range_search(
     }
 
     // compute refined distances
-    auto rf = dynamic_cast<const IndexFlat*>(refine_index);
-    FAISS_THROW_IF_NOT(rf);
-
-    rf->compute_distance_subset(n, x, result->lims[1], result->distances, result->labels);
+    compute_refine_distances(
+            refine_index,
+            n,
+            x,
+            result->lims[1],
+            result->distances,
+            result->labels);
 
     idx_t current = 0;
     for (idx_t i = 0; i < result->lims[1]; ++i) {
@@ -263,17 +296,16 @@ std::unique_ptr<IVFIteratorWorkspace> IndexScaNN::getIteratorWorkspace(
     auto base = dynamic_cast<const IndexIVFPQFastScan*>(base_index);
     auto iterator = base->getIteratorWorkspace(query_data, ivfsearchParams);
     if (refine_index) {
-        auto refine = dynamic_cast<const IndexFlat*>(refine_index);
         if (base->is_cosine) {
             iterator->dis_refine = std::unique_ptr<faiss::DistanceComputer>(
                     new faiss::WithCosineNormDistanceComputer(
                             base->inverse_norms.data(),
                             base->d,
                             std::unique_ptr<faiss::DistanceComputer>(
-                                    refine->get_distance_computer())));
+                                    refine_index->get_distance_computer())));
         } else {
             iterator->dis_refine = std::unique_ptr<faiss::DistanceComputer>(
-                    refine->get_FlatCodesDistanceComputer());
+                    refine_index->get_distance_computer());
         }
         iterator->dis_refine->set_query(query_data);
     } else {
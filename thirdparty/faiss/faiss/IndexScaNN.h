@@ -12,6 +12,13 @@ struct IndexScaNNSearchParameters : SearchParameters {
     virtual ~IndexScaNNSearchParameters() = default;
 };
 
+/** A fast scan IVF index whose candidates are refined against the raw data.
+ *
+ * The refine index is an IndexFlat over the raw vectors by default. Any
+ * IndexFlatCodes can take its place, an IndexScalarQuantizer for instance
+ * keeps a fp16, bf16 or SQ8 copy of the data to refine at a lower memory
+ * cost, in which case reconstruct() returns the decoded vectors.
+ */
 struct IndexScaNN : IndexRefine {
     explicit IndexScaNN(Index* base_index);
     IndexScaNN(Index* base_index, const float* xb);
@@ -18,6 +18,7 @@
 #include <faiss/impl/FaissAssert.h>
 #include <faiss/impl/IDSelector.h>
 #include <faiss/impl/ScalarQuantizer.h>
+#include <faiss/impl/ScalarQuantizerScanner.h>
 #include <faiss/utils/utils.h>
 
 namespace faiss {
@@ -262,7 +263,19 @@ void IndexIVFScalarQuantizer::add_core(
 InvertedListScanner* IndexIVFScalarQuantizer::get_InvertedListScanner(
         bool store_pairs,
         const IDSelector* sel,
-        const IVFSearchParameters*) const {
+        const IVFSearchParameters* search_params_in) const {
+    auto params = dynamic_cast<const IVFScalarQuantizerSearchParameters*>(
+            search_params_in);
+    if (params && params->quantized_query &&
+        metric_type == METRIC_INNER_PRODUCT) {
+        if (sq.qtype == ScalarQuantizer::QT_8bit) {
+            return sel_sq8_quantized_query_scanner_ip<false>(
+                    &sq, store_pairs, sel, by_residual);
+        } else if (sq.qtype == ScalarQuantizer::QT_8bit_uniform) {
+            return sel_sq8_quantized_query_scanner_ip<true>(
+                    &sq, store_pairs, sel, by_residual);
+        }
+    }
     return sq.select_InvertedListScanner(
             metric_type, quantizer, store_pairs, sel, by_residual);
 }
@@ -60,6 +60,14 @@ struct IndexScalarQuantizer : IndexFlatCodes {
     size_t cal_size() const;
 };
 
+struct IVFScalarQuantizerSearchParameters : IVFSearchParameters {
+    /// score the QT_8bit and QT_8bit_uniform codes of an inner product
+    /// index against the query quantized to int8, with integer dot
+    /// products on the codes (see SQ8QuantizedQueryDCIP). Ignored by the
+    /// other quantizers and metrics.
+    bool quantized_query = false;
+};
+
 /** An IVF implementation where the components of the residuals are
  * encoded with a scalar quantizer. All distance computations
  * are asymmetric, so the encoded vectors are decoded and approximate
@@ -47,6 +47,7 @@
 #include <faiss/impl/ScalarQuantizer.h>
 #include <faiss/impl/pq4_fast_scan.h>
 
+#include <faiss/invlists/ArenaInvertedLists.h>
 #include <faiss/invlists/BlockInvertedLists.h>
 
 namespace faiss {
@@ -251,6 +252,9 @@ InvertedLists* clone_InvertedLists(const InvertedLists* invlists) {
         }
         return bils2;
     }
+    if (auto* aails = dynamic_cast<const ArenaInvertedLists*>(invlists)) {
+        return new ArenaInvertedLists(*aails);
+    }
     FAISS_THROW_FMT(
             "clone not supported for this type of inverted lists %s",
             typeid(*invlists).name());
@@ -19,8 +19,11 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <queue>
+#include <utility>
+#include <vector>
 
 // Faiss-specific headers
 #include <faiss/Index.h>
@@ -29,11 +32,14 @@
 #include <faiss/impl/DistanceComputer.h>
 #include <faiss/impl/FaissException.h>
 #include <faiss/impl/HNSW.h>
+#include <faiss/impl/IDSelector.h>
 #include <faiss/impl/ResultHandler.h>
 #include <faiss/utils/ordered_key_value.h>
+#include <faiss/utils/prefetch.h>
 
 // Knowhere-specific headers
 #include <faiss/cppcontrib/knowhere/impl/Neighbor.h>
+#include <faiss/cppcontrib/knowhere/utils/GroupByCollector.h>
 
 namespace faiss {
 namespace cppcontrib {
@@ -46,10 +52,57 @@ constexpr bool track_hnsw_stats = true;
 
 } // namespace
 
+// Adaptive termination of a level 0 search: the search stops once
+//   `patience` consecutive node expansions did not bring a filter-passing
+//   candidate closer than the k-th nearest filter-passing one found so far,
+//   so that efSearch bounds the expansions of the hard queries only.
+//   0 disables it.
+struct StalledSearchTracker {
+    const size_t patience;
+    const size_t k;
+
+    // the k nearest filter-passing distances seen, the farthest on top
+    std::priority_queue<float> nearest;
+    // the expansions since the last improvement of the k nearest
+    size_t n_stalled = 0;
+    bool improved = false;
+
+    StalledSearchTracker(const size_t patience_, const size_t k_)
+            : patience{patience_}, k{k_} {}
+
+    bool enabled() const {
+        return patience > 0;
+    }
+
+    void add(const knowhere::Neighbor& n) {
+        if (patience == 0 || n.status != knowhere::Neighbor::kValid) {
+            return;
+        }
+        if (nearest.size() < k) {
+            nearest.push(n.distance);
+            improved = true;
+        } else if (n.distance < nearest.top()) {
+            nearest.pop();
+            nearest.push(n.distance);
+            improved = true;
+        }
+    }
+
+    // called once a node is expanded, returns whether the search stalled
+    bool stalled() {
+        if (patience == 0) {
+            return false;
+        }
+        n_stalled = improved ? 0 : n_stalled + 1;
+        improved = false;
+        return n_stalled >= patience;
+    }
+};
+
 // Accomodates all the search logic and variables.
 /// * DistanceComputerT is responsible for computing distances
 /// * GraphVisitorT records visited edges
-/// * VisitedT is responsible for tracking visited nodes
+/// * VisitedT is responsible for tracking visited nodes (get / set / clear)
 /// * FilterT is resposible for filtering unneeded nodes
 /// Interfaces of all templates are tweaked to accept standard Faiss structures
 ///   with dynamic dispatching. Custom Knowhere structures are also accepted.
@@ -89,6 +142,57 @@ struct v2_hnsw_searcher {
     // the pointer is not owned.
     const faiss::SearchParametersHNSW* params;
 
+    // pipelined expansion of the neighbors of a node: the data of the
+    // candidate that is prefetch_distance positions ahead is prefetched
+    // while the distances of the current batch are computed, and so is
+    // the neighbor list of the next node to be expanded.
+    // 0 disables it.
+    const size_t prefetch_distance;
+
+    // filter-aware traversal: if the fraction of the neighbors of an
+    // expanded node that pass the filter is below this value, the neighbors
+    // of its filtered-out neighbors are evaluated as well (two-hop), so that
+    // the search does not get stuck in the regions where the filter is
+    // restrictive.
+    // 0 disables it.
+    const float two_hop_connectivity;
+
+    // an alternative copy of the level 0 neighbor lists, with a fixed
+    // distance of level0_stride elements between the lists of consecutive
+    // nodes, such as a layout that stores every list next to the code of
+    // its node. nullptr uses the lists of hnsw.
+    // the pointer is not owned.
+    const storage_idx_t* const level0_neighbors;
+    const size_t level0_stride;
+    const size_t level0_size;
+
+    // the patience of the adaptive termination of search(), see
+    //   StalledSearchTracker. 0 disables it.
+    const size_t early_termination_patience;
+
+    // the entry points of the graph that search() scans to start its level 0
+    //   search from the max_entry_point_seeds ones nearest to the query,
+    //   instead of descending the upper levels. nullptr disables it.
+    // the pointer is not owned.
+    const storage_idx_t* const entry_points;
+    const size_t n_entry_points;
+    static constexpr size_t max_entry_point_seeds = 4;
+
+    // unvisited neighbors of the node being expanded, their statuses and
+    //   distances
+    std::vector<storage_idx_t> candidate_ids;
+    std::vector<int> candidate_statuses;
+    std::vector<float> candidate_dis;
+
+    // the neighbors of the expanded nodes, and how many of them pass the
+    // filter. only tracked by the filter-aware traversal.
+    size_t n_listed_neighbors = 0;
+    size_t n_member_neighbors = 0;
+    // the filtered-out neighbors that were gone through, and how many of
+    //   them led to filter-passing nodes.
+    size_t n_bridge_attempts = 0;
+    size_t n_bridges = 0;
+
     //
     v2_hnsw_searcher(
             const faiss::HNSW& hnsw_,
@@ -97,20 +201,64 @@ struct v2_hnsw_searcher {
             VisitedT& visited_nodes_,
             const FilterT& filter_,
             const float kAlpha_,
-            const faiss::SearchParametersHNSW* params_)
+            const faiss::SearchParametersHNSW* params_,
+            const size_t prefetch_distance_ = 0,
+            const float two_hop_connectivity_ = 0.0f,
+            const storage_idx_t* level0_neighbors_ = nullptr,
+            const size_t level0_stride_ = 0,
+            const size_t early_termination_patience_ = 0,
+            const storage_idx_t* entry_points_ = nullptr,
+            const size_t n_entry_points_ = 0)
             : hnsw{hnsw_},
               qdis{qdis_},
               graph_visitor{graph_visitor_},
               visited_nodes{visited_nodes_},
               filter{filter_},
               kAlpha{kAlpha_},
-              params{params_} {}
+              params{params_},
+              prefetch_distance{prefetch_distance_},
+              two_hop_connectivity{two_hop_connectivity_},
+              level0_neighbors{level0_neighbors_},
+              level0_stride{level0_stride_},
+              level0_size{(size_t)hnsw.nb_neighbors(0)},
+              early_termination_patience{early_termination_patience_},
+              entry_points{entry_points_},
+              n_entry_points{entry_points_ == nullptr ? 0 : n_entry_points_} {
+        const size_t max_neighbors = level0_size;
+        if (two_hop_connectivity > 0) {
+            // every filtered-out neighbor may bring its own neighbors
+            candidate_ids.resize(max_neighbors * (max_neighbors + 1));
+            candidate_statuses.resize(max_neighbors * (max_neighbors + 1));
+            candidate_dis.resize(max_neighbors * (max_neighbors + 1));
+        } else {
+            candidate_ids.resize(max_neighbors);
+            candidate_statuses.resize(max_neighbors);
+            candidate_dis.resize(max_neighbors);
+        }
+    }
 
     v2_hnsw_searcher(const v2_hnsw_searcher&) = delete;
     v2_hnsw_searcher(v2_hnsw_searcher&&) = delete;
     v2_hnsw_searcher& operator=(const v2_hnsw_searcher&) = delete;
     v2_hnsw_searcher& operator=(v2_hnsw_searcher&&) = delete;
 
+    // the neighbor list of a node at a given level, which spans
+    //   [begin, end) of the returned array.
+    const storage_idx_t* neighbor_list(
+            const idx_t node_id,
+            const int level,
+            size_t& begin,
+            size_t& end) const {
+        if (level == 0 && level0_neighbors != nullptr) {
+            begin = node_id * level0_stride;
+            end = begin + level0_size;
+            return level0_neighbors;
+        }
+
+        hnsw.neighbor_range(node_id, level, &begin, &end);
+        return hnsw.neighbors.data();
+    }
+
     // greedily update a nearest vector at a given level.
     // * the update starts from the value in 'nearest'.
     faiss::HNSWStats greedy_update_nearest(
@@ -124,23 +272,26 @@ struct v2_hnsw_searcher {
 
             size_t begin = 0;
             size_t end = 0;
-            hnsw.neighbor_range(nearest, level, &begin, &end);
+            const storage_idx_t* const neighbors =
+                    neighbor_list(nearest, level, begin, end);
 
             // prefetch and eval the size
             size_t count = 0;
             for (size_t i = begin; i < end; i++) {
-                storage_idx_t v = hnsw.neighbors[i];
+                storage_idx_t v = neighbors[i];
                 if (v < 0) {
                     break;
                 }
 
-                // qdis.prefetch(v);
+                if (prefetch_distance > 0) {
+                    qdis.prefetch(v);
+                }
                 count += 1;
             }
 
             // visit neighbors
             for (size_t i = begin; i < begin + count; i++) {
-                storage_idx_t v = hnsw.neighbors[i];
+                storage_idx_t v = neighbors[i];
 
                 // compute the distance
                 const float dis = qdis(v);
@@ -179,20 +330,34 @@ struct v2_hnsw_searcher {
         // bool do_dis_check = params ? params->check_relative_distance
         //                            : hnsw.check_relative_distance;
 
+        if (two_hop_connectivity > 0 && level == 0) {
+            return evaluate_single_node_two_hop(
+                    node_id, level, accumulated_alpha, func_add_candidate);
+        }
+
+        if (prefetch_distance > 0) {
+            return evaluate_single_node_pipelined(
+                    node_id, level, accumulated_alpha, func_add_candidate);
+        }
+
         faiss::HNSWStats stats;
 
         size_t begin = 0;
         size_t end = 0;
-        hnsw.neighbor_range(node_id, level, &begin, &end);
+        const storage_idx_t* const neighbors =
+                neighbor_list(node_id, level, begin, end);
 
-        // todo: add prefetch
         size_t counter = 0;
         size_t saved_indices[4];
         int saved_statuses[4];
 
+        // the neighbors are tested against the filter 64 at a time
+        IDSelectorBatchCursor<FilterT, storage_idx_t> members(
+                &filter, neighbors + begin, end - begin);
+
         size_t ndis = 0;
         for (size_t j = begin; j < end; j++) {
-            const storage_idx_t v1 = hnsw.neighbors[j];
+            const storage_idx_t v1 = neighbors[j];
 
             if (v1 < 0) {
                 // no more neighbors
@@ -211,7 +376,7 @@ struct v2_hnsw_searcher {
 
             // is the node disabled?
             int status = knowhere::Neighbor::kValid;
-            if (!filter.is_member(v1)) {
+            if (!members.is_member(j - begin)) {
                 // yes, disabled
                 status = knowhere::Neighbor::kInvalid;
 
@@ -291,13 +456,327 @@ struct v2_hnsw_searcher {
         return stats;
     }
 
+    // same as evaluate_single_node(), but the unvisited neighbors are
+    // collected first, so that the data of the candidates can be prefetched
+    // prefetch_distance positions ahead of the distance computations.
+    template <typename FuncAddCandidate>
+    faiss::HNSWStats evaluate_single_node_pipelined(
+            const idx_t node_id,
+            const int level,
+            float& accumulated_alpha,
+            FuncAddCandidate func_add_candidate) {
+        faiss::HNSWStats stats;
+
+        // collect the candidates, prefetching the first ones right away
+        const size_t n_candidates = collect_candidates(
+                node_id, level, accumulated_alpha, prefetch_distance);
+
+        evaluate_candidates(node_id, level, n_candidates, func_add_candidate);
+
+        // update stats
+        if (track_hnsw_stats) {
+            stats.ndis = n_candidates;
+            stats.nhops = 1;
+        }
+
+        // done
+        return stats;
+    }
+
+    // marks the unvisited neighbors of a node as visited and stores the ones
+    //   to be evaluated to candidate_ids, prefetching the first n_prefetch
+    //   of them. Returns the number of candidates.
+    size_t collect_candidates(
+            const idx_t node_id,
+            const int level,
+            float& accumulated_alpha,
+            const size_t n_prefetch) {
+        size_t begin = 0;
+        size_t end = 0;
+        const storage_idx_t* const neighbors =
+                neighbor_list(node_id, level, begin, end);
+
+        // the neighbors are tested against the filter 64 at a time
+        IDSelectorBatchCursor<FilterT, storage_idx_t> members(
+                &filter, neighbors + begin, end - begin);
+
+        size_t n_candidates = 0;
+        for (size_t j = begin; j < end; j++) {
+            const storage_idx_t v1 = neighbors[j];
+
+            if (v1 < 0) {
+                // no more neighbors
+                break;
+            }
+
+            // already visited?
+            if (visited_nodes.get(v1)) {
+                // yes, visited.
+                graph_visitor.visit_edge(level, node_id, v1, -1);
+                continue;
+            }
+
+            // not visited. mark as visited.
+            visited_nodes.set(v1);
+
+            // is the node disabled?
+            int status = knowhere::Neighbor::kValid;
+            if (!members.is_member(j - begin)) {
+                // yes, disabled
+                status = knowhere::Neighbor::kInvalid;
+
+                // sometimes, disabled nodes are allowed to be used
+                accumulated_alpha += kAlpha;
+                if (accumulated_alpha < 1.0f) {
+                    continue;
+                }
+
+                accumulated_alpha -= 1.0f;
+            }
+
+            if (n_candidates < n_prefetch) {
+                qdis.prefetch(v1);
+            }
+
+            candidate_ids[n_candidates] = v1;
+            candidate_statuses[n_candidates] = status;
+            n_candidates += 1;
+        }
+
+        return n_candidates;
+    }
+
+    // same as evaluate_single_node_pipelined(), but if few neighbors of the
+    //   node pass the filter, the filter-passing neighbors of its
+    //   filtered-out neighbors are evaluated too, which crosses the regions
+    //   of the graph that the filter disconnects (ACORN-style).
+    template <typename FuncAddCandidate>
+    faiss::HNSWStats evaluate_single_node_two_hop(
+            const idx_t node_id,
+            const int level,
+            float& accumulated_alpha,
+            FuncAddCandidate func_add_candidate) {
+        faiss::HNSWStats stats;
+
+        size_t begin = 0;
+        size_t end = 0;
+        const storage_idx_t* const neighbors =
+                neighbor_list(node_id, level, begin, end);
+
+        // measure the local connectivity under the filter, the neighbors are
+        //   tested 64 at a time
+        IDSelectorBatchCursor<FilterT, storage_idx_t> members(
+                &filter, neighbors + begin, end - begin);
+        size_t n_listed = 0;
+        size_t n_members = 0;
+        for (size_t j = begin; j < end; j++) {
+            const storage_idx_t v1 = neighbors[j];
+            if (v1 < 0) {
+                break;
+            }
+
+            n_listed += 1;
+            n_members += members.is_member(j - begin) ? 1 : 0;
+        }
+
+        n_listed_neighbors += n_listed;
+        n_member_neighbors += n_members;
+
+        // nodes without a single neighbor that passes the filter are most
+        //   likely far from the filtered set, where the second hop only
+        //   pays off as long as it keeps finding filter-passing nodes.
+        const bool two_hop = n_members < two_hop_connectivity * n_listed &&
+                (n_members > 0 || 2 * n_bridges >= n_bridge_attempts);
+
+        // collect the candidates
+        size_t n_candidates = 0;
+        auto collect_candidate = [&](const storage_idx_t v, const int status) {
+            if (n_candidates < prefetch_distance) {
+                qdis.prefetch(v);
+            }
+
+            candidate_ids[n_candidates] = v;
+            candidate_statuses[n_candidates] = status;
+            n_candidates += 1;
+        };
+
+        for (size_t j = begin; j < begin + n_listed; j++) {
+            const storage_idx_t v1 = neighbors[j];
+
+            // already visited?
+            if (visited_nodes.get(v1)) {
+                // yes, visited.
+                graph_visitor.visit_edge(level, node_id, v1, -1);
+                continue;
+            }
+
+            // not visited. mark as visited.
+            visited_nodes.set(v1);
+
+            if (members.is_member(j - begin)) {
+                collect_candidate(v1, knowhere::Neighbor::kValid);
+                continue;
+            }
+
+            // go through the disabled node without evaluating it
+            size_t n_bridged = 0;
+            if (two_hop) {
+                n_bridge_attempts += 1;
+
+                size_t begin2 = 0;
+                size_t end2 = 0;
+                const storage_idx_t* const neighbors2 =
+                        neighbor_list(v1, level, begin2, end2);
+
+                for (size_t j2 = begin2; j2 < end2; j2++) {
+                    const storage_idx_t v2 = neighbors2[j2];
+                    if (v2 < 0) {
+                        break;
+                    }
+
+                    if (!filter.is_member(v2)) {
+                        continue;
+                    }
+
+                    n_bridged += 1;
+                    if (!visited_nodes.get(v2)) {
+                        visited_nodes.set(v2);
+                        collect_candidate(v2, knowhere::Neighbor::kValid);
+                    }
+                }
+            }
+
+            if (n_bridged > 0) {
+                n_bridges += 1;
+                continue;
+            }
+
+            // sometimes, disabled nodes are allowed to be used,
+            //   this keeps the search going where nothing passes the filter
+            accumulated_alpha += kAlpha;
+            if (accumulated_alpha >= 1.0f) {
+                accumulated_alpha -= 1.0f;
+                collect_candidate(v1, knowhere::Neighbor::kInvalid);
+            }
+        }
+
+        evaluate_candidates(node_id, level, n_candidates, func_add_candidate);
+
+        // update stats
+        if (track_hnsw_stats) {
+            stats.ndis = n_candidates;
+            stats.nhops = 1;
+        }
+
+        // done
+        return stats;
+    }
+
+    // computes the distances to the collected candidates of a node and adds
+    //   them, the first prefetch_distance of them are expected to be
+    //   prefetched already.
+    template <typename FuncAddCandidate>
+    void evaluate_candidates(
+            const idx_t node_id,
+            const int level,
+            const size_t n_candidates,
+            FuncAddCandidate func_add_candidate) {
+        auto add_candidate = [&](const size_t idx, const float dis) {
+            // record a traversed edge
+            graph_visitor.visit_edge(level, node_id, candidate_ids[idx], dis);
+
+            // add a record of visited nodes
+            knowhere::Neighbor nn(
+                    candidate_ids[idx], dis, candidate_statuses[idx]);
+            func_add_candidate(nn);
+        };
+
+        // evaluate all the distances in one call, the flat storages run it
+        //   as a loop with the kernel of the instruction set and the dim
+        //   inlined, while the data of the candidates that are
+        //   prefetch_distance positions ahead is being fetched
+        qdis.distances_by_ids(
+                candidate_ids.data(),
+                n_candidates,
+                prefetch_distance,
+                candidate_dis.data());
+
+        for (size_t idx = 0; idx < n_candidates; idx++) {
+            add_candidate(idx, candidate_dis[idx]);
+        }
+    }
+
+    // the fraction of the neighbors of the expanded nodes that pass the
+    //   filter, as measured by the filter-aware traversal.
+    float connectivity_ratio() const {
+        return (n_listed_neighbors == 0)
+                ? 1.0f
+                : (float)n_member_neighbors / (float)n_listed_neighbors;
+    }
+
+    // scans the entry points and adds the max_entry_point_seeds ones nearest
+    //   to the query as visited candidates, returns the number of distances
+    //   computed.
+    template <typename FuncAddCandidate>
+    size_t seed_from_entry_points(FuncAddCandidate func_add_candidate) {
+        std::vector<std::pair<float, storage_idx_t>> scanned(n_entry_points);
+        size_t idx = 0;
+        for (; idx + 4 <= n_entry_points; idx += 4) {
+            float dis[4] = {0, 0, 0, 0};
+            qdis.distances_batch_4(
+                    entry_points[idx],
+                    entry_points[idx + 1],
+                    entry_points[idx + 2],
+                    entry_points[idx + 3],
+                    dis[0],
+                    dis[1],
+                    dis[2],
+                    dis[3]);
+            for (size_t id4 = 0; id4 < 4; id4++) {
+                scanned[idx + id4] = {dis[id4], entry_points[idx + id4]};
+            }
+        }
+        for (; idx < n_entry_points; idx++) {
+            scanned[idx] = {qdis(entry_points[idx]), entry_points[idx]};
+        }
+
+        const size_t n_seeds = std::min(n_entry_points, max_entry_point_seeds);
+        std::partial_sort(
+                scanned.begin(), scanned.begin() + n_seeds, scanned.end());
+        for (size_t i = 0; i < n_seeds; i++) {
+            const storage_idx_t id = scanned[i].second;
+            func_add_candidate(knowhere::Neighbor(
+                    id,
+                    scanned[i].first,
+                    filter.is_member(id) ? knowhere::Neighbor::kValid
+                                         : knowhere::Neighbor::kInvalid));
+            visited_nodes.set(id);
+        }
+        return n_entry_points;
+    }
+
+    // brings the neighbor list of a node to the cache
+    void prefetch_neighbor_list(const idx_t node_id, const int level) const {
+        size_t begin = 0;
+        size_t end = 0;
+        const storage_idx_t* const neighbors =
+                neighbor_list(node_id, level, begin, end);
+
+        constexpr size_t ids_per_line = 64 / sizeof(storage_idx_t);
+        for (size_t j = begin; j < end; j += ids_per_line) {
+            prefetch_L1(neighbors + j);
+        }
+    }
+
     // perform the search on a given level.
     // it is assumed that retset is initialized and contains the initial nodes.
+    // the search stops early once tracker (if any) reports it stalled.
     faiss::HNSWStats search_on_a_level(
             knowhere::NeighborSetDoublePopList& retset,
             const int level,
             knowhere::IteratorMinHeap* const __restrict disqualified = nullptr,
-            const float initial_accumulated_alpha = 1.0f) {
+            const float initial_accumulated_alpha = 1.0f,
+            StalledSearchTracker* const tracker = nullptr) {
         faiss::HNSWStats stats;
 
         //
@@ -305,6 +784,9 @@ struct v2_hnsw_searcher {
 
         // what to do with a accepted candidate
         auto add_search_candidate = [&](const knowhere::Neighbor n) {
+            if (tracker != nullptr) {
+                tracker->add(n);
+            }
             return retset.insert(n, disqualified);
         };
 
@@ -313,6 +795,12 @@ struct v2_hnsw_searcher {
             // get a node to be processed
             const knowhere::Neighbor neighbor = retset.pop();
 
+            // the next node is likely to be the current best candidate,
+            //   fetch its neighbors while this one is expanded
+            if (prefetch_distance > 0 && retset.has_next()) {
+                prefetch_neighbor_list(retset.peek().id, level);
+            }
+
             // analyze its neighbors
             faiss::HNSWStats local_stats = evaluate_single_node(
                     neighbor.id,
@@ -324,6 +812,10 @@ struct v2_hnsw_searcher {
             if (track_hnsw_stats) {
                 stats.combine(local_stats);
             }
+
+            if (tracker != nullptr && tracker->stalled()) {
+                break;
+            }
         }
 
         // done
@@ -375,45 +867,63 @@ struct v2_hnsw_searcher {
             return stats;
         }
 
-        // yes.
-        // greedy search on upper levels.
-
-        // initialize the starting point.
-        storage_idx_t nearest = hnsw.entry_point;
-        float d_nearest = qdis(nearest);
+        // initialize the container for candidates
+        const idx_t n_candidates = std::max((idx_t)efSearch, k);
+        knowhere::NeighborSetDoublePopList retset(n_candidates);
 
-        // iterate through upper levels
-        auto bottom_levels_stats = greedy_search_top_levels(nearest, d_nearest);
+        // efSearch is a ceiling of the search with an adaptive termination
+        StalledSearchTracker tracker(early_termination_patience, k);
 
-        // update stats
-        if (track_hnsw_stats) {
-            stats.combine(bottom_levels_stats);
-        }
+        auto add_starting_point = [&](const knowhere::Neighbor nn) {
+            tracker.add(nn);
+            retset.insert(nn);
+        };
 
-        // level 0 search
+        if (n_entry_points > 0) {
+            // the level 0 search starts from the entry points nearest to
+            //   the query, the upper levels are skipped
+            graph_visitor.visit_level(0);
+            const size_t ndis = seed_from_entry_points(add_starting_point);
+            if (track_hnsw_stats) {
+                stats.ndis += ndis;
+            }
+        } else {
+            // greedy search on upper levels.
 
-        // update the visitor
-        graph_visitor.visit_level(0);
+            // initialize the starting point.
+            storage_idx_t nearest = hnsw.entry_point;
+            float d_nearest = qdis(nearest);
 
-        // initialize the container for candidates
-        const idx_t n_candidates = std::max((idx_t)efSearch, k);
-        knowhere::NeighborSetDoublePopList retset(n_candidates);
+            // iterate through upper levels
+            auto bottom_levels_stats =
+                    greedy_search_top_levels(nearest, d_nearest);
 
-        // initialize retset with a single 'nearest' point
-        {
-            if (!filter.is_member(nearest)) {
-                retset.insert(knowhere::Neighbor(
-                        nearest, d_nearest, knowhere::Neighbor::kInvalid));
-            } else {
-                retset.insert(knowhere::Neighbor(
-                        nearest, d_nearest, knowhere::Neighbor::kValid));
+            // update stats
+            if (track_hnsw_stats) {
+                stats.combine(bottom_levels_stats);
             }
 
-            visited_nodes[nearest] = true;
+            // level 0 search
+
+            // update the visitor
+            graph_visitor.visit_level(0);
+
+            // initialize retset with a single 'nearest' point
+            add_starting_point(knowhere::Neighbor(
+                    nearest,
+                    d_nearest,
+                    filter.is_member(nearest) ? knowhere::Neighbor::kValid
+                                              : knowhere::Neighbor::kInvalid));
+            visited_nodes.set(nearest);
         }
 
         // perform the search of the level 0.
-        faiss::HNSWStats local_stats = search_on_a_level(retset, 0);
+        faiss::HNSWStats local_stats = search_on_a_level(
+                retset,
+                0,
+                nullptr,
+                1.0f,
+                tracker.enabled() ? &tracker : nullptr);
 
         // todo: switch to brute-force in case of (retset.size() < k)
 
@@ -438,6 +948,126 @@ struct v2_hnsw_searcher {
         return stats;
     }
 
+    // perform a group-by search: the k groups with the nearest hits, with up
+    //   to group_size nearest hits each, see GroupByCollector. group_id(id)
+    //   returns the group of a node.
+    // The level 0 is expanded from the nearest candidate as long as the
+    //   candidate may still change the result: until the k nearest groups are
+    //   full, and then while it is closer than both their farthest hit and
+    //   the efSearch-th nearest node seen, which bounds the expansions as in
+    //   search(). Filtered out nodes are expanded as in search(), but never
+    //   collected.
+    // Writes k * group_size results to distances and labels.
+    template <typename GroupIdT>
+    faiss::HNSWStats search_group_by(
+            const idx_t k,
+            const idx_t group_size,
+            const GroupIdT& group_id,
+            float* __restrict distances,
+            idx_t* __restrict labels) {
+        faiss::HNSWStats stats;
+
+        GroupByCollector collector(k, group_size);
+
+        // is the graph empty?
+        if (hnsw.entry_point == -1) {
+            collector.get_result(distances, labels);
+            return stats;
+        }
+
+        // grab some needed parameters
+        const size_t efSearch = params ? params->efSearch : hnsw.efSearch;
+
+        // greedy search on upper levels?
+        if (hnsw.upper_beam != 1) {
+            FAISS_THROW_MSG("Not implemented");
+            return stats;
+        }
+
+        // initialize the starting point.
+        storage_idx_t nearest = hnsw.entry_point;
+        float d_nearest = qdis(nearest);
+
+        // iterate through upper levels
+        auto bottom_levels_stats = greedy_search_top_levels(nearest, d_nearest);
+
+        // update stats
+        if (track_hnsw_stats) {
+            stats.combine(bottom_levels_stats);
+        }
+
+        // level 0 search
+        graph_visitor.visit_level(0);
+
+        // the candidates to be expanded, the nearest on top
+        knowhere::IteratorMinHeap candidates;
+        // the efSearch nearest distances seen, the farthest on top
+        std::priority_queue<float> nearest_distances;
+
+        // the distance that a candidate has to be below to be expanded
+        auto expansion_bound = [&]() {
+            if (nearest_distances.size() < efSearch || !collector.full()) {
+                return std::numeric_limits<float>::max();
+            }
+            return std::max(nearest_distances.top(), collector.threshold());
+        };
+
+        auto add_group_by_candidate = [&](const knowhere::Neighbor n) {
+            if (n.distance >= expansion_bound()) {
+                return false;
+            }
+
+            candidates.push(n);
+            nearest_distances.push(n.distance);
+            if (nearest_distances.size() > efSearch) {
+                nearest_distances.pop();
+            }
+
+            if (n.status == knowhere::Neighbor::kValid) {
+                collector.add(n.distance, n.id, group_id(n.id));
+            }
+            return true;
+        };
+
+        // start with a single 'nearest' point
+        visited_nodes.set(nearest);
+        add_group_by_candidate(knowhere::Neighbor(
+                nearest,
+                d_nearest,
+                filter.is_member(nearest) ? knowhere::Neighbor::kValid
+                                          : knowhere::Neighbor::kInvalid));
+
+        float accumulated_alpha = 1.0f;
+        while (!candidates.empty()) {
+            const knowhere::Neighbor neighbor = candidates.top();
+            if (neighbor.distance >= expansion_bound()) {
+                // no better candidates can come in
+                break;
+            }
+            candidates.pop();
+
+            // the next node is likely to be the current best candidate,
+            //   fetch its neighbors while this one is expanded
+            if (prefetch_distance > 0 && !candidates.empty()) {
+                prefetch_neighbor_list(candidates.top().id, 0);
+            }
+
+            faiss::HNSWStats local_stats = evaluate_single_node(
+                    neighbor.id, 0, accumulated_alpha, add_group_by_candidate);
+
+            // update stats
+            if (track_hnsw_stats) {
+                stats.combine(local_stats);
+            }
+        }
+
+        // populate the result
+        collector.get_result(distances, labels);
+
+        // done
+        return stats;
+    }
+
     faiss::HNSWStats range_search(
             const float radius,
             typename faiss::RangeSearchBlockResultHandler<
@@ -493,7 +1123,7 @@ struct v2_hnsw_searcher {
                         nearest, d_nearest, knowhere::Neighbor::kValid));
             }
 
-            visited_nodes[nearest] = true;
+            visited_nodes.set(nearest);
         }
 
         // perform the search of the level 0.
@@ -516,7 +1146,7 @@ struct v2_hnsw_searcher {
                 radius_queue.push({candidate.distance, candidate.id});
                 rres->add_result(candidate.distance, candidate.id);
 
-                visited_nodes[candidate.id] = true;
+                visited_nodes.set(candidate.id);
             }
         }
 
@@ -526,19 +1156,20 @@ struct v2_hnsw_searcher {
 
             size_t id_begin = 0;
             size_t id_end = 0;
-            hnsw.neighbor_range(current.second, 0, &id_begin, &id_end);
+            const storage_idx_t* const neighbors =
+                    neighbor_list(current.second, 0, id_begin, id_end);
 
             for (size_t id = id_begin; id < id_end; id++) {
-                const auto ngb = hnsw.neighbors[id];
+                const auto ngb = neighbors[id];
                 if (ngb == -1) {
                     break;
                 }
 
-                if (visited_nodes[ngb]) {
+                if (visited_nodes.get(ngb)) {
                     continue;
                 }
 
-                visited_nodes[ngb] = true;
+                visited_nodes.set(ngb);
 
                 if (filter.is_member(ngb)) {
                     const float dis = qdis(ngb);
@@ -563,6 +1194,220 @@ struct v2_hnsw_searcher {
     }
 };
 
+// Performs the searches of a block of queries on the calling thread, every
+//   query with its own searcher (distance computer and visited nodes).
+// The upper levels are descended level by level for all the queries, which
+//   keeps the neighbor lists of a level in the cache. Then the expansions of
+//   the level 0 nodes of the queries are interleaved: in turns, every query
+//   moves its next expansion one stage forward (pick the node and fetch its
+//   neighbor list, collect its unvisited neighbors and fetch their data,
+//   compute their distances), so that the memory accesses of a query are
+//   served while the other queries compute. The results of a query are the
+//   ones of searcher.search().
+// The results of the query i are written to distances + i * k and
+//   labels + i * k, its statistics to query_stats[i].
+template <typename SearcherT>
+void search_interleaved(
+        SearcherT* const* searchers,
+        const size_t nq,
+        const faiss::idx_t k,
+        float* __restrict distances,
+        faiss::idx_t* __restrict labels,
+        faiss::HNSWStats* __restrict query_stats) {
+    using storage_idx_t = typename SearcherT::storage_idx_t;
+    using idx_t = faiss::idx_t;
+
+    if (nq == 0) {
+        return;
+    }
+
+    const faiss::HNSW& hnsw = searchers[0]->hnsw;
+
+    // is the graph empty?
+    if (hnsw.entry_point == -1) {
+        return;
+    }
+
+    // greedy search on upper levels?
+    if (hnsw.upper_beam != 1) {
+        FAISS_THROW_MSG("Not implemented");
+    }
+
+    // the stages of the expansion of a node
+    enum class Stage { Pick, Collect, Evaluate, Done };
+
+    struct QueryState {
+        storage_idx_t nearest = -1;
+        float d_nearest = 0;
+        knowhere::NeighborSetDoublePopList retset;
+        Stage stage = Stage::Pick;
+        idx_t node_id = -1;
+        size_t n_candidates = 0;
+        float accumulated_alpha = 1.0f;
+        std::unique_ptr<StalledSearchTracker> tracker;
+    };
+
+    std::vector<QueryState> states(nq);
+
+    // descend the upper levels
+    for (size_t q = 0; q < nq; q++) {
+        query_stats[q] = faiss::HNSWStats();
+        states[q].nearest = hnsw.entry_point;
+        if (searchers[q]->n_entry_points == 0) {
+            states[q].d_nearest = searchers[q]->qdis(hnsw.entry_point);
+        }
+    }
+
+    for (int level = hnsw.max_level; level >= 1; level--) {
+        for (size_t q = 0; q < nq; q++) {
+            if (searchers[q]->n_entry_points > 0) {
+                // starts from the entry points instead
+                continue;
+            }
+            searchers[q]->graph_visitor.visit_level(level);
+
+            faiss::HNSWStats local_stats = searchers[q]->greedy_update_nearest(
+                    level, states[q].nearest, states[q].d_nearest);
+            if (track_hnsw_stats) {
+                query_stats[q].combine(local_stats);
+            }
+        }
+    }
+
+    // initialize the level 0 searches with the nearest nodes
+    for (size_t q = 0; q < nq; q++) {
+        SearcherT& searcher = *searchers[q];
+        QueryState& state = states[q];
+
+        searcher.graph_visitor.visit_level(0);
+
+        const int efSearch =
+                searcher.params ? searcher.params->efSearch : hnsw.efSearch;
+        state.retset = knowhere::NeighborSetDoublePopList(
+                std::max((idx_t)efSearch, k));
+        if (searcher.early_termination_patience > 0) {
+            state.tracker = std::make_unique<StalledSearchTracker>(
+                    searcher.early_termination_patience, k);
+        }
+        auto add_starting_point = [&](const knowhere::Neighbor nn) {
+            if (state.tracker != nullptr) {
+                state.tracker->add(nn);
+            }
+            state.retset.insert(nn);
+        };
+
+        if (searcher.n_entry_points > 0) {
+            const size_t ndis =
+                    searcher.seed_from_entry_points(add_starting_point);
+            if (track_hnsw_stats) {
+                query_stats[q].ndis += ndis;
+            }
+            continue;
+        }
+        add_starting_point(knowhere::Neighbor(
+                state.nearest,
+                state.d_nearest,
+                searcher.filter.is_member(state.nearest)
+                        ? knowhere::Neighbor::kValid
+                        : knowhere::Neighbor::kInvalid));
+        searcher.visited_nodes.set(state.nearest);
+    }
+
+    // expand the level 0 nodes of the queries in turns
+    for (size_t n_active = nq; n_active > 0;) {
+        for (size_t q = 0; q < nq; q++) {
+            SearcherT& searcher = *searchers[q];
+            QueryState& state = states[q];
+
+            auto add_search_candidate = [&](const knowhere::Neighbor n) {
+                if (state.tracker != nullptr) {
+                    state.tracker->add(n);
+                }
+                return state.retset.insert(n);
+            };
+            // the next stage once a node is expanded
+            auto expanded = [&]() {
+                if (state.tracker != nullptr && state.tracker->stalled()) {
+                    state.stage = Stage::Done;
+                    n_active -= 1;
+                } else {
+                    state.stage = Stage::Pick;
+                }
+            };
+
+            switch (state.stage) {
+                case Stage::Pick:
+                    if (!state.retset.has_next()) {
+                        state.stage = Stage::Done;
+                        n_active -= 1;
+                        break;
+                    }
+                    state.node_id = state.retset.pop().id;
+                    searcher.prefetch_neighbor_list(state.node_id, 0);
+                    state.stage = Stage::Collect;
+                    break;
+
+                case Stage::Collect:
+                    if (searcher.two_hop_connectivity > 0) {
+                        // the two-hop traversal reads lists it can not
+                        //   prefetch, the node is expanded at once
+                        faiss::HNSWStats local_stats =
+                                searcher.evaluate_single_node(
+                                        state.node_id,
+                                        0,
+                                        state.accumulated_alpha,
+                                        add_search_candidate);
+                        if (track_hnsw_stats) {
+                            query_stats[q].combine(local_stats);
+                        }
+                        expanded();
+                        break;
+                    }
+                    state.n_candidates = searcher.collect_candidates(
+                            state.node_id,
+                            0,
+                            state.accumulated_alpha,
+                            searcher.level0_size);
+                    state.stage = Stage::Evaluate;
+                    break;
+
+                case Stage::Evaluate:
+                    searcher.evaluate_candidates(
+                            state.node_id,
+                            0,
+                            state.n_candidates,
+                            add_search_candidate);
+                    if (track_hnsw_stats) {
+                        query_stats[q].ndis += state.n_candidates;
+                        query_stats[q].nhops += 1;
+                    }
+                    expanded();
+                    break;
+
+                case Stage::Done:
+                    break;
+            }
+        }
+    }
+
+    // populate the results
+    for (size_t q = 0; q < nq; q++) {
+        knowhere::NeighborSetDoublePopList& retset = states[q].retset;
+        float* const __restrict local_distances = distances + q * k;
+        idx_t* const __restrict local_labels = labels + q * k;
+
+        const idx_t len = std::min((idx_t)retset.size(), k);
+        for (idx_t i = 0; i < len; i++) {
+            local_distances[i] = retset[i].distance;
+            local_labels[i] = (idx_t)retset[i].id;
+        }
+        for (idx_t i = len; i < k; i++) {
+            local_labels[i] = -1;
+            local_distances[i] = std::numeric_limits<float>::max();
+        }
+    }
+}
+
 } // namespace knowhere
 } // namespace cppcontrib
 } // namespace faiss
@@ -187,6 +187,18 @@ class NeighborSetDoublePopList {
                (invalid_ns_->has_next() && invalid_ns_->cur().distance < valid_ns_->at_search_back_dist());
     }
 
+    // the neighbor that would be returned by pop(), without removing it. Requires has_next().
+    auto
+    peek() const -> const Neighbor& {
+        bool hasCandNext = invalid_ns_->has_next();
+        bool hasResNext = valid_ns_->has_next();
+
+        if (hasCandNext && hasResNext) {
+            return invalid_ns_->cur().distance < valid_ns_->cur().distance ? invalid_ns_->cur() : valid_ns_->cur();
+        }
+        return hasCandNext ? invalid_ns_->cur() : valid_ns_->cur();
+    }
+
     inline const Neighbor&
     operator[](size_t i) {
         return (*valid_ns_)[i];
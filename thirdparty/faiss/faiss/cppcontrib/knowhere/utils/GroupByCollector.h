@@ -0,0 +1,164 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace faiss {
+namespace cppcontrib {
+namespace knowhere {
+
+// Collects the results of a group-by search of a single query: the k groups
+//   with the nearest hits, and up to group_size nearest hits of each of them.
+//   The distances are the smaller the closer.
+// Every group keeps its hits in a max-heap bounded by group_size, and the
+//   groups are ranked by their nearest hit. Once the k nearest groups hold
+//   group_size hits each, a hit has to be closer than the farthest hit of
+//   those groups to change the result (@see threshold()), which is the bound
+//   that lets a search stop once no better candidates can come in.
+struct GroupByCollector final {
+    using idx_t = int64_t;
+
+    GroupByCollector(const size_t k_in, const size_t group_size_in)
+            : k{k_in}, group_size{group_size_in} {}
+
+    GroupByCollector(const GroupByCollector&) = delete;
+    GroupByCollector& operator=(const GroupByCollector&) = delete;
+
+    // adds the hit id of the group group_id, returns whether it was kept
+    inline bool add(const float dis, const idx_t id, const int64_t group_id) {
+        if (dis >= threshold()) {
+            return false;
+        }
+
+        auto [it, inserted] = group_of.try_emplace(group_id, groups.size());
+        if (inserted) {
+            groups.emplace_back();
+            groups.back().hits.reserve(group_size);
+        }
+        Group& group = groups[it->second];
+
+        if (group.hits.size() < group_size) {
+            group.hits.emplace_back(dis, id);
+            std::push_heap(group.hits.begin(), group.hits.end());
+        } else if (dis < group.hits.front().first) {
+            std::pop_heap(group.hits.begin(), group.hits.end());
+            group.hits.back() = {dis, id};
+            std::push_heap(group.hits.begin(), group.hits.end());
+        } else {
+            return false;
+        }
+
+        if (inserted || dis < group.nearest) {
+            if (!inserted) {
+                ranking.erase({group.nearest, group_id});
+            }
+            group.nearest = dis;
+            ranking.emplace(dis, group_id);
+        }
+
+        threshold_valid = false;
+        return true;
+    }
+
+    // whether the k nearest groups hold group_size hits each
+    inline bool full() {
+        return threshold() < std::numeric_limits<float>::max();
+    }
+
+    // the distance that a hit has to be below to change the result, the
+    //   largest float until the k nearest groups are full
+    inline float threshold() {
+        if (!threshold_valid) {
+            cached_threshold = compute_threshold();
+            threshold_valid = true;
+        }
+        return cached_threshold;
+    }
+
+    // the number of groups with at least a hit
+    inline size_t size() const {
+        return groups.size();
+    }
+
+    // writes k * group_size results: the groups from the nearest one, each
+    //   with its hits from the nearest one, the missing ones as -1 with the
+    //   largest float.
+    inline void get_result(float* distances, idx_t* labels) const {
+        size_t pos = 0;
+        size_t n_groups = 0;
+        std::vector<std::pair<float, idx_t>> hits;
+        for (auto it = ranking.begin(); it != ranking.end() && n_groups < k;
+             ++it, n_groups++) {
+            hits = groups[group_of.at(it->second)].hits;
+            std::sort_heap(hits.begin(), hits.end());
+            for (size_t i = 0; i < group_size; i++, pos++) {
+                distances[pos] = (i < hits.size())
+                        ? hits[i].first
+                        : std::numeric_limits<float>::max();
+                labels[pos] = (i < hits.size()) ? hits[i].second : -1;
+            }
+        }
+        for (; pos < k * group_size; pos++) {
+            distances[pos] = std::numeric_limits<float>::max();
+            labels[pos] = -1;
+        }
+    }
+
+   private:
+    struct Group {
+        // max-heap of (distance, id)
+        std::vector<std::pair<float, idx_t>> hits;
+        float nearest = std::numeric_limits<float>::max();
+    };
+
+    const size_t k;
+    const size_t group_size;
+
+    std::vector<Group> groups;
+    std::unordered_map<int64_t, size_t> group_of;
+    // (nearest hit, group id) of all the groups, the nearest first
+    std::set<std::pair<float, int64_t>> ranking;
+
+    float cached_threshold = std::numeric_limits<float>::max();
+    bool threshold_valid = true;
+
+    inline float compute_threshold() const {
+        if (ranking.size() < k) {
+            return std::numeric_limits<float>::max();
+        }
+
+        float farthest = 0;
+        size_t n_groups = 0;
+        for (auto it = ranking.begin(); n_groups < k; ++it, n_groups++) {
+            const Group& group = groups[group_of.at(it->second)];
+            if (group.hits.size() < group_size) {
+                return std::numeric_limits<float>::max();
+            }
+            farthest = (n_groups == 0)
+                    ? group.hits.front().first
+                    : std::max(farthest, group.hits.front().first);
+        }
+        return farthest;
+    }
+};
+
+} // namespace knowhere
+} // namespace cppcontrib
+} // namespace faiss
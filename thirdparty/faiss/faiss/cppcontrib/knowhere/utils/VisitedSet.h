@@ -0,0 +1,265 @@
+// Copyright (C) 2019-2025 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace faiss {
+namespace cppcontrib {
+namespace knowhere {
+
+// Tracks the nodes visited by a graph search, with an implementation that is
+//   picked for every query, so that preparing the set does not cost O(ntotal)
+//   when the query only visits a few nodes of a large graph:
+// * a dense bitset, cleared for every query, for the queries that visit a
+//   large fraction of the nodes.
+// * an array of epoch tags, one per node, where a node is visited if its tag
+//   is the current epoch. Moving to a new query increments the epoch, the
+//   array is only cleared when the epoch wraps around.
+// * an open-addressing hash set of the visited ids, sized from the expected
+//   number of visits. It is moved to a bitset if it grows larger than one.
+// The buffers are kept across queries, so a set is meant to be reused, for
+//   example once per search thread.
+struct VisitedSet final {
+    enum class Kind : uint8_t { Bitset, Epoch, Hash };
+
+    // a hash set is used if its buffer is at least this many times smaller
+    //   than a bitset over all the nodes
+    static constexpr size_t kHashToBitsetRatio = 4;
+    // epoch tags are used up to this many nodes, bitsets above
+    static constexpr size_t kMaxEpochNodes = size_t(1) << 24;
+    // the smallest number of slots of a hash set
+    static constexpr size_t kMinHashCapacity = 256;
+
+    inline VisitedSet() {}
+
+    VisitedSet(const VisitedSet&) = delete;
+    VisitedSet(VisitedSet&&) = default;
+    VisitedSet& operator=(const VisitedSet&) = delete;
+    VisitedSet& operator=(VisitedSet&&) = default;
+
+    // prepares an empty set for a query over the nodes [0, ntotal), which is
+    //   expected to visit about expected_visits of them.
+    inline void reset(const size_t ntotal_in, const size_t expected_visits) {
+        ntotal = ntotal_in;
+
+        const size_t hash_capacity = hash_capacity_for(expected_visits);
+        if (hash_capacity * sizeof(uint32_t) * kHashToBitsetRatio <=
+            bitset_bytes()) {
+            reset_hash(hash_capacity);
+        } else if (ntotal <= kMaxEpochNodes) {
+            reset_epoch();
+        } else {
+            reset_bitset();
+        }
+    }
+
+    // empties the set, keeping its implementation
+    inline void clear() {
+        switch (kind) {
+            case Kind::Bitset:
+                reset_bitset();
+                break;
+            case Kind::Epoch:
+                reset_epoch();
+                break;
+            case Kind::Hash:
+                reset_hash(hash_mask + 1);
+                break;
+        }
+    }
+
+    inline bool get(const size_t index) const {
+        switch (kind) {
+            case Kind::Bitset:
+                return (bits[index >> 3] & (0x1 << (index & 0x7)));
+            case Kind::Epoch:
+                return (epochs[index] == epoch);
+            case Kind::Hash:
+                return hash_contains(index);
+        }
+        return false;
+    }
+
+    inline void set(const size_t index) {
+        switch (kind) {
+            case Kind::Bitset:
+                bits[index >> 3] |= uint8_t(0x1 << (index & 0x7));
+                break;
+            case Kind::Epoch:
+                epochs[index] = epoch;
+                break;
+            case Kind::Hash:
+                hash_insert(index);
+                break;
+        }
+    }
+
+    inline bool operator[](const size_t index) const {
+        return get(index);
+    }
+
+    inline Kind get_kind() const {
+        return kind;
+    }
+
+    // the bytes allocated by the set
+    inline size_t allocated_bytes() const {
+        return bits_capacity + epochs_capacity * sizeof(uint16_t) +
+                hash_capacity * sizeof(uint32_t);
+    }
+
+   private:
+    static constexpr uint32_t kEmptySlot = 0xFFFFFFFF;
+
+    Kind kind = Kind::Bitset;
+    size_t ntotal = 0;
+
+    // Kind::Bitset
+    std::unique_ptr<uint8_t[]> bits;
+    size_t bits_capacity = 0;
+
+    // Kind::Epoch
+    std::unique_ptr<uint16_t[]> epochs;
+    size_t epochs_capacity = 0;
+    uint16_t epoch = 0;
+
+    // Kind::Hash
+    std::unique_ptr<uint32_t[]> slots;
+    size_t hash_capacity = 0;
+    size_t hash_mask = 0;
+    size_t hash_size = 0;
+
+    inline size_t bitset_bytes() const {
+        return (ntotal + 7) / 8;
+    }
+
+    // a power of 2 that keeps the load factor below 1/2
+    static inline size_t hash_capacity_for(const size_t n_elements) {
+        size_t capacity = kMinHashCapacity;
+        while (capacity < n_elements * 2) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    static inline size_t hash_of(const size_t index) {
+        // fibonacci hashing, the high bits are the well mixed ones
+        return (uint64_t(index) * 0x9E3779B97F4A7C15ULL) >> 32;
+    }
+
+    inline void reset_bitset() {
+        kind = Kind::Bitset;
+
+        const size_t nbytes = bitset_bytes();
+        if (bits_capacity < nbytes) {
+            bits = std::make_unique<uint8_t[]>(nbytes);
+            bits_capacity = nbytes;
+        } else {
+            std::memset(bits.get(), 0, nbytes);
+        }
+    }
+
+    inline void reset_epoch() {
+        if (epochs_capacity < ntotal) {
+            epochs = std::make_unique<uint16_t[]>(ntotal);
+            epochs_capacity = ntotal;
+            epoch = 0;
+        }
+
+        // the tags are only ever set to the current epoch, so none of them
+        //   matches a new one until the counter wraps around
+        epoch += 1;
+        if (epoch == 0) {
+            std::memset(epochs.get(), 0, epochs_capacity * sizeof(uint16_t));
+            epoch = 1;
+        }
+
+        kind = Kind::Epoch;
+    }
+
+    inline void reset_hash(const size_t capacity) {
+        kind = Kind::Hash;
+
+        if (hash_capacity < capacity) {
+            slots = std::make_unique<uint32_t[]>(capacity);
+            hash_capacity = capacity;
+        }
+        std::fill(slots.get(), slots.get() + capacity, kEmptySlot);
+        hash_mask = capacity - 1;
+        hash_size = 0;
+    }
+
+    inline bool hash_contains(const size_t index) const {
+        for (size_t pos = hash_of(index) & hash_mask;;
+             pos = (pos + 1) & hash_mask) {
+            const uint32_t slot = slots[pos];
+            if (slot == uint32_t(index)) {
+                return true;
+            }
+            if (slot == kEmptySlot) {
+                return false;
+            }
+        }
+    }
+
+    inline void hash_insert(const size_t index) {
+        size_t pos = hash_of(index) & hash_mask;
+        for (; slots[pos] != kEmptySlot; pos = (pos + 1) & hash_mask) {
+            if (slots[pos] == uint32_t(index)) {
+                return;
+            }
+        }
+        slots[pos] = uint32_t(index);
+        hash_size += 1;
+
+        if (hash_size * 2 > hash_mask + 1) {
+            grow_hash();
+        }
+    }
+
+    // doubles the hash set, or moves its elements to a bitset if the set
+    //   visits more nodes than expected
+    inline void grow_hash() {
+        const size_t old_capacity = hash_mask + 1;
+        const size_t new_capacity = old_capacity * 2;
+
+        if (new_capacity * sizeof(uint32_t) * kHashToBitsetRatio >
+            bitset_bytes()) {
+            // the buffer of the hash set is kept for the next queries
+            reset_bitset();
+            for (size_t i = 0; i < old_capacity; i++) {
+                if (slots[i] != kEmptySlot) {
+                    set(slots[i]);
+                }
+            }
+            return;
+        }
+
+        std::unique_ptr<uint32_t[]> old_slots = std::move(slots);
+        hash_capacity = 0;
+        reset_hash(new_capacity);
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_slots[i] != kEmptySlot) {
+                hash_insert(old_slots[i]);
+            }
+        }
+    }
+};
+
+}
+}
+}
@@ -8,6 +8,9 @@
 #pragma once
 
 #include <faiss/Index.h>
+#include <faiss/utils/prefetch.h>
+
+#include <algorithm>
 
 namespace faiss {
 
@@ -56,6 +59,44 @@ struct DistanceComputer {
     /// compute distance between two stored vectors
     virtual float symmetric_dis(idx_t i, idx_t j) = 0;
 
+    /// hint that the distance to vector i is about to be computed, so
+    /// that its data can be brought to the cache in the meantime
+    virtual void prefetch(idx_t /* i */) {}
+
+    /// compute the distances of current query to the stored vectors ids[0..n)
+    /// of a graph, the vectors prefetch_distance positions ahead being
+    /// prefetched meanwhile. the first prefetch_distance ones are expected to
+    /// be prefetched already.
+    virtual void distances_by_ids(
+            const int32_t* ids,
+            size_t n,
+            size_t prefetch_distance,
+            float* dis) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            if (prefetch_distance > 0) {
+                const size_t prefetch_end =
+                        std::min(n, i + 4 + prefetch_distance);
+                for (size_t p = i + prefetch_distance; p < prefetch_end; p++) {
+                    prefetch(ids[p]);
+                }
+            }
+            distances_batch_4(
+                    ids[i],
+                    ids[i + 1],
+                    ids[i + 2],
+                    ids[i + 3],
+                    dis[i],
+                    dis[i + 1],
+                    dis[i + 2],
+                    dis[i + 3]);
+        }
+        // the leftovers have been prefetched already
+        for (; i < n; i++) {
+            dis[i] = this->operator()(ids[i]);
+        }
+    }
+
     virtual ~DistanceComputer() {}
 };
 
@@ -100,6 +141,21 @@ struct NegativeDistanceComputer : DistanceComputer {
         return -basedis->symmetric_dis(i, j);
     }
 
+    void prefetch(idx_t i) override {
+        basedis->prefetch(i);
+    }
+
+    void distances_by_ids(
+            const int32_t* ids,
+            size_t n,
+            size_t prefetch_distance,
+            float* dis) override {
+        basedis->distances_by_ids(ids, n, prefetch_distance, dis);
+        for (size_t i = 0; i < n; i++) {
+            dis[i] = -dis[i];
+        }
+    }
+
     virtual ~NegativeDistanceComputer() {
         delete basedis;
     }
@@ -113,6 +169,10 @@ struct FlatCodesDistanceComputer : DistanceComputer {
     const uint8_t* codes;
     size_t code_size;
 
+    /// max number of bytes of a code brought to the cache by prefetch(),
+    /// the hardware prefetcher is expected to follow for longer codes
+    size_t prefetch_bytes = 256;
+
     FlatCodesDistanceComputer(const uint8_t* codes, size_t code_size)
             : codes(codes), code_size(code_size) {}
 
@@ -122,6 +182,14 @@ struct FlatCodesDistanceComputer : DistanceComputer {
         return distance_to_code(codes + i * code_size);
     }
 
+    void prefetch(idx_t i) override {
+        const uint8_t* code = codes + i * code_size;
+        const size_t nbytes = std::min(code_size, prefetch_bytes);
+        for (size_t offset = 0; offset < nbytes; offset += 64) {
+            prefetch_L1(code + offset);
+        }
+    }
+
     /// compute distance of current query to an encoded vector
     virtual float distance_to_code(const uint8_t* code) = 0;
 
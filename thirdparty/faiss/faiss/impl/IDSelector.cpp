@@ -10,6 +10,18 @@
 
 namespace faiss {
 
+/***********************************************************************
+ * IDSelector
+ ***********************************************************************/
+
+uint64_t IDSelector::is_member_batch(size_t n, const idx_t* ids) const {
+    uint64_t mask = 0;
+    for (size_t j = 0; j < n; j++) {
+        mask |= uint64_t(is_member(ids[j])) << j;
+    }
+    return mask;
+}
+
 /***********************************************************************
  * IDSelectorRange
  ***********************************************************************/
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <unordered_set>
 #include <vector>
 
@@ -20,9 +22,47 @@ namespace faiss {
 /** Encapsulates a set of ids to handle. */
 struct IDSelector {
     virtual bool is_member(idx_t id) const = 0;
+
+    /** returns a mask with bit j set if ids[j] is a member, for n <= 64 ids.
+     * The scans test their candidates with one call per 64 of them rather
+     * than with one call per id. */
+    virtual uint64_t is_member_batch(size_t n, const idx_t* ids) const;
+
     virtual ~IDSelector() {}
 };
 
+/** Tests the ids of a scan 64 at a time with is_member_batch. The ids are
+ * best visited in increasing order. A negative id ends the ids, as in the
+ * neighbor lists of HNSW. */
+template <typename SelectorT, typename IdT>
+struct IDSelectorBatchCursor {
+    const SelectorT* sel;
+    const IdT* ids;
+    size_t n;
+    // the ids [begin, end) are tested by mask
+    size_t begin = 0;
+    size_t end = 0;
+    uint64_t mask = 0;
+
+    IDSelectorBatchCursor(const SelectorT* sel, const IdT* ids, size_t n)
+            : sel(sel), ids(ids), n(n) {}
+
+    bool is_member(size_t j) {
+        if (j < begin || j >= end) {
+            begin = j & ~size_t(63);
+            end = begin;
+            const size_t limit = std::min(begin + 64, n);
+            idx_t batch[64];
+            while (end < limit && ids[end] >= 0) {
+                batch[end - begin] = ids[end];
+                end++;
+            }
+            mask = sel->is_member_batch(end - begin, batch);
+        }
+        return (mask >> (j - begin)) & 1;
+    }
+};
+
 /** ids between [imin, imax) */
 struct IDSelectorRange : IDSelector {
     idx_t imin, imax;
@@ -128,6 +168,9 @@ struct IDSelectorAll : IDSelector {
     inline bool is_member(idx_t id) const final {
         return true;
     }
+    inline uint64_t is_member_batch(size_t n, const idx_t* ids) const final {
+        return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+    }
     virtual ~IDSelectorAll() {}
 };
 
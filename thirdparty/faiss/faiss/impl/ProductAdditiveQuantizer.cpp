@@ -92,23 +92,28 @@ void ProductAdditiveQuantizer::train(size_t n, const float* x) {
         return;
     }
 
-    // copy the subvectors into contiguous memory
-    size_t offset_d = 0;
-    std::vector<float> xt;
+    std::vector<size_t> offsets_d(nsplits + 1, 0);
     for (size_t s = 0; s < nsplits; s++) {
+        offsets_d[s + 1] = offsets_d[s] + quantizers[s]->d;
+    }
+
+    // the splits are independent, so their quantizers (e.g. the k-means and
+    //   the beam searches of the residual ones) are trained in parallel
+    parallel_for_nested(nsplits, [&](size_t s) {
         auto q = quantizers[s];
-        xt.resize(q->d * n);
+
+        // copy the subvectors into contiguous memory
+        std::vector<float> xt(q->d * n);
 
 #pragma omp parallel for if (n > 1000)
         for (idx_t i = 0; i < n; i++) {
             memcpy(xt.data() + i * q->d,
-                   x + i * d + offset_d,
+                   x + i * d + offsets_d[s],
                    q->d * sizeof(*x));
         }
 
         q->train(n, xt.data());
-        offset_d += q->d;
-    }
+    });
 
     // compute codebook size
     size_t codebook_size = 0;
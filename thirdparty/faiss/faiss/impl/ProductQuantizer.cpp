@@ -21,6 +21,8 @@
 #include <faiss/VectorTransform.h>
 #include <faiss/impl/FaissAssert.h>
 #include <faiss/utils/distances.h>
+#include <faiss/utils/random.h>
+#include <faiss/utils/utils.h>
 
 extern "C" {
 
@@ -136,12 +138,28 @@ void ProductQuantizer::train(size_t n, const float* x) {
             }
         }
 
-        std::unique_ptr<float[]> xslice(new float[n * dsub]);
-        for (int m = 0; m < M; m++) {
-            for (int j = 0; j < n; j++)
+        // the k-means of a slice would subsample its training set, so the
+        //   rows are subsampled once for all the slices instead, and only
+        //   the sampled rows are sliced
+        std::vector<int> rows;
+        const size_t max_train = ksub * cp.max_points_per_centroid;
+        if (n > max_train) {
+            rows.resize(n);
+            rand_perm(rows.data(), n, cp.seed);
+            rows.resize(max_train);
+            n = max_train;
+        }
+
+        // the slices are independent k-means, trained in parallel. An
+        //   external assignment index is shared, so it keeps them serial.
+        auto train_slice = [&](size_t m) {
+            std::unique_ptr<float[]> xslice(new float[n * dsub]);
+            for (size_t j = 0; j < n; j++) {
+                const size_t row = rows.empty() ? j : rows[j];
                 memcpy(xslice.get() + j * dsub,
-                       x + j * d + m * dsub,
+                       x + row * d + m * dsub,
                        dsub * sizeof(float));
+            }
 
             Clustering clus(dsub, ksub, cp);
 
@@ -177,11 +195,19 @@ void ProductQuantizer::train(size_t n, const float* x) {
 
             if (verbose) {
                 clus.verbose = true;
-                printf("Training PQ slice %d/%zd\n", m, M);
+                printf("Training PQ slice %zd/%zd\n", m, M);
             }
             IndexFlatL2 index(dsub);
             clus.train(n, xslice.get(), assign_index ? *assign_index : index);
             set_params(clus.centroids.data(), m);
+        };
+
+        if (assign_index) {
+            for (size_t m = 0; m < M; m++) {
+                train_slice(m);
+            }
+        } else {
+            parallel_for_nested(M, train_slice);
         }
 
     } else {
@@ -19,7 +19,7 @@ struct FactorsData {
     float or_minus_c_l2sqr = 0;
     float dp_multiplier = 0;
     // unlike the baseline Faiss version, this code caches 
-    //   the sum of binary values
+    //   the sum of binary values (of the nb_bits values for the extended codes)
     float sum_xb = 0;
 };
 
@@ -32,12 +32,80 @@ struct QueryFactorsData {
     float qr_norm_L2sqr = 0;
 };
 
-static size_t get_code_size(const size_t d) {
-    return (d + 7) / 8 + sizeof(FactorsData);
+// the number of candidate rescaling factors that an extended code is
+//   picked from
+static constexpr size_t kExScaleCandidates = 32;
+
+static size_t get_code_size(const size_t d, const size_t nb_bits) {
+    return nb_bits * ((d + 7) / 8) + sizeof(FactorsData);
+}
+
+RaBitQuantizer::RaBitQuantizer(size_t d, MetricType metric, size_t nb_bits)
+        : Quantizer(d, get_code_size(d, nb_bits)),
+          metric_type{metric},
+          nb_bits{nb_bits} {
+    FAISS_THROW_IF_NOT_MSG(
+            nb_bits >= 1 && nb_bits <= 8, "RaBitQ supports 1 to 8 bits");
 }
 
-RaBitQuantizer::RaBitQuantizer(size_t d, MetricType metric)
-        : Quantizer(d, get_code_size(d)), metric_type{metric} {}
+size_t RaBitQuantizer::get_nb_bits(size_t d, size_t code_size) {
+    const size_t plane_size = (d + 7) / 8;
+    if (plane_size == 0 || code_size < sizeof(FactorsData)) {
+        return 1;
+    }
+    return (code_size - sizeof(FactorsData)) / plane_size;
+}
+
+// picks the nb_bits values of the extended code of the residual r: the
+//   values u_j = clamp(round(t * r_j + M / 2), 0, M) for M = 2^nb_bits - 1,
+//   with the rescaling factor t that maximizes the cosine between r and
+//   the grid point u - M / 2.
+static void compute_ex_values(
+        const float* r,
+        const size_t d,
+        const size_t nb_bits,
+        uint8_t* u) {
+    const int max_u = (1 << nb_bits) - 1;
+    const float half = 0.5f * max_u;
+
+    float r_max = 0;
+    for (size_t j = 0; j < d; j++) {
+        r_max = std::max(r_max, std::abs(r[j]));
+    }
+    if (r_max < std::numeric_limits<float>::epsilon()) {
+        std::fill(u, u + d, (uint8_t)(max_u / 2));
+        return;
+    }
+
+    // the factor that maps the largest residual to the end of the grid,
+    //   larger ones clip the largest residuals for a finer grid
+    const float t_no_clip = half / r_max;
+
+    float best_t = t_no_clip;
+    float best_cos = std::numeric_limits<float>::lowest();
+    for (size_t k = 0; k < kExScaleCandidates; k++) {
+        const float t = t_no_clip * (0.5f + 3.5f * k / kExScaleCandidates);
+        float dp = 0;
+        float norm_sqr = 0;
+        for (size_t j = 0; j < d; j++) {
+            const int v = std::min(
+                    max_u, std::max(0, (int)std::round(t * r[j] + half)));
+            const float o = v - half;
+            dp += o * r[j];
+            norm_sqr += o * o;
+        }
+        const float cos = dp / std::sqrt(norm_sqr);
+        if (cos > best_cos) {
+            best_cos = cos;
+            best_t = t;
+        }
+    }
+
+    for (size_t j = 0; j < d; j++) {
+        u[j] = (uint8_t)std::min(
+                max_u, std::max(0, (int)std::round(best_t * r[j] + half)));
+    }
+}
 
 void RaBitQuantizer::train(size_t n, const float* x) {
     // does nothing
@@ -65,70 +133,90 @@ void RaBitQuantizer::compute_codes_core(
 
     // compute some helper constants
     const float inv_d_sqrt = (d == 0) ? 1.0f : (1.0f / std::sqrt((float)d));
+    const size_t plane_size = (d + 7) / 8;
+    // the largest value of a dimension
+    const int max_u = (1 << nb_bits) - 1;
 
     // compute codes
-#pragma omp parallel for if (n > 1000)
-    for (int64_t i = 0; i < n; i++) {
-        // ||or - c||^2
-        float norm_L2sqr = 0;
-        // ||or||^2, which is equal to ||P(or)||^2 and ||P^(-1)(or)||^2
-        float or_L2sqr = 0;
-        // sum of bits
-        size_t sum_xb = 0;
-        // dot product
-        float dp_oO = 0;
-
-        // the code
-        uint8_t* code = codes + i * code_size;
-        FactorsData* fac = reinterpret_cast<FactorsData*>(code + (d + 7) / 8);
-
-        // cleanup it
-        if (code != nullptr) {
+#pragma omp parallel if (n > 1000)
+    {
+        std::vector<float> or_minus_c(d);
+        std::vector<uint8_t> u(d);
+
+#pragma omp for
+        for (int64_t i = 0; i < n; i++) {
+            // ||or - c||^2
+            float norm_L2sqr = 0;
+            // ||or||^2, which is equal to ||P(or)||^2 and ||P^(-1)(or)||^2
+            float or_L2sqr = 0;
+            // sum of values
+            size_t sum_xb = 0;
+            // dot product
+            float dp_oO = 0;
+
+            // the code
+            uint8_t* code = codes + i * code_size;
+            FactorsData* fac = reinterpret_cast<FactorsData*>(
+                    code + nb_bits * plane_size);
+
+            // cleanup it
             memset(code, 0, code_size);
-        }
 
-        for (size_t j = 0; j < d; j++) {
-            const float or_minus_c = x[i * d + j] -
-                    ((centroid_in == nullptr) ? 0 : centroid_in[j]);
-            norm_L2sqr += or_minus_c * or_minus_c;
-            or_L2sqr += x[i * d + j] * x[i * d + j];
-
-            const bool xb = (or_minus_c > 0);
-            sum_xb += xb ? 1 : 0;
-
-            dp_oO += xb ? or_minus_c : (-or_minus_c);
+            for (size_t j = 0; j < d; j++) {
+                or_minus_c[j] = x[i * d + j] -
+                        ((centroid_in == nullptr) ? 0 : centroid_in[j]);
+                norm_L2sqr += or_minus_c[j] * or_minus_c[j];
+                or_L2sqr += x[i * d + j] * x[i * d + j];
+            }
 
-            // store the output data
-            if (code != nullptr) {
-                if (xb) {
-                    // enable a particular bit
-                    code[j / 8] |= (1 << (j % 8));
+            if (nb_bits == 1) {
+                for (size_t j = 0; j < d; j++) {
+                    u[j] = (or_minus_c[j] > 0) ? 1 : 0;
                 }
+            } else {
+                compute_ex_values(or_minus_c.data(), d, nb_bits, u.data());
             }
-        }
 
-        // compute factors
+            for (size_t j = 0; j < d; j++) {
+                sum_xb += u[j];
 
-        // compute the inverse norm
-        const float inv_norm_L2 =
-                (std::abs(norm_L2sqr) < std::numeric_limits<float>::epsilon())
-                ? 1.0f
-                : (1.0f / std::sqrt(norm_L2sqr));
-        dp_oO *= inv_norm_L2;
-        dp_oO *= inv_d_sqrt;
+                // the reconstructed dimension is (2 * u - M) / M / sqrt(d),
+                //   the sign of the residual for a single bit
+                dp_oO += (2 * u[j] - max_u) * or_minus_c[j];
 
-        const float inv_dp_oO =
-                (std::abs(dp_oO) < std::numeric_limits<float>::epsilon())
-                ? 1.0f
-                : (1.0f / dp_oO);
+                // store the output data, bit b of the value to the plane b
+                for (size_t b = 0; b < nb_bits; b++) {
+                    if (u[j] & (1 << b)) {
+                        // enable a particular bit
+                        code[b * plane_size + j / 8] |= (1 << (j % 8));
+                    }
+                }
+            }
 
-        fac->or_minus_c_l2sqr = norm_L2sqr;
-        if (metric_type == MetricType::METRIC_INNER_PRODUCT) {
-            fac->or_minus_c_l2sqr -= or_L2sqr;
-        }
+            // compute factors
+
+            // compute the inverse norm
+            const float inv_norm_L2 =
+                    (std::abs(norm_L2sqr) <
+                     std::numeric_limits<float>::epsilon())
+                    ? 1.0f
+                    : (1.0f / std::sqrt(norm_L2sqr));
+            dp_oO *= inv_norm_L2;
+            dp_oO *= inv_d_sqrt / max_u;
+
+            const float inv_dp_oO =
+                    (std::abs(dp_oO) < std::numeric_limits<float>::epsilon())
+                    ? 1.0f
+                    : (1.0f / dp_oO);
+
+            fac->or_minus_c_l2sqr = norm_L2sqr;
+            if (metric_type == MetricType::METRIC_INNER_PRODUCT) {
+                fac->or_minus_c_l2sqr -= or_L2sqr;
+            }
 
-        fac->dp_multiplier = inv_dp_oO * std::sqrt(norm_L2sqr);
-        fac->sum_xb = sum_xb;
+            fac->dp_multiplier = inv_dp_oO * std::sqrt(norm_L2sqr);
+            fac->sum_xb = sum_xb;
+        }
     }
 }
 
@@ -145,6 +233,8 @@ void RaBitQuantizer::decode_core(
     FAISS_ASSERT(x != nullptr);
 
     const float inv_d_sqrt = (d == 0) ? 1.0f : (1.0f / std::sqrt((float)d));
+    const size_t plane_size = (d + 7) / 8;
+    const float max_u = (1 << nb_bits) - 1;
 
 #pragma omp parallel for if (n > 1000)
     for (int64_t i = 0; i < n; i++) {
@@ -152,17 +242,23 @@ void RaBitQuantizer::decode_core(
 
         // split the code into parts
         const uint8_t* binary_data = code;
-        const FactorsData* fac =
-                reinterpret_cast<const FactorsData*>(code + (d + 7) / 8);
+        const FactorsData* fac = reinterpret_cast<const FactorsData*>(
+                code + nb_bits * plane_size);
 
         //
         for (size_t j = 0; j < d; j++) {
-            // extract i-th bit
+            // extract j-th value, a bit per plane
             const uint8_t masker = (1 << (j % 8));
-            const float bit = ((binary_data[j / 8] & masker) == masker) ? 1 : 0;
+            uint32_t value = 0;
+            for (size_t b = 0; b < nb_bits; b++) {
+                if ((binary_data[b * plane_size + j / 8] & masker) == masker) {
+                    value |= (1 << b);
+                }
+            }
 
             // compute the output code
-            x[i * d + j] = (bit - 0.5f) * fac->dp_multiplier * 2 * inv_d_sqrt +
+            x[i * d + j] = (value - 0.5f * max_u) / max_u * fac->dp_multiplier *
+                            2 * inv_d_sqrt +
                     ((centroid_in == nullptr) ? 0 : centroid_in[j]);
         }
     }
@@ -177,8 +273,16 @@ struct RaBitDistanceComputer : FlatCodesDistanceComputer {
     // the metric
     MetricType metric_type = MetricType::METRIC_L2;
 
+    // the bits per dimension of the codes
+    size_t nb_bits = 1;
+
     RaBitDistanceComputer();
 
+    // the size of a bit plane of a code
+    size_t plane_size() const {
+        return (d + 7) / 8;
+    }
+
     float symmetric_dis(idx_t i, idx_t j) override;
 };
 
@@ -211,8 +315,8 @@ float RaBitDistanceComputerNotQ::distance_to_code(const uint8_t* code) {
 
     // split the code into parts
     const uint8_t* binary_data = code;
-    const FactorsData* fac =
-            reinterpret_cast<const FactorsData*>(code + (d + 7) / 8);
+    const FactorsData* fac = reinterpret_cast<const FactorsData*>(
+            code + nb_bits * plane_size());
     __builtin_prefetch(fac, 0);
 
     // this is the baseline code
@@ -227,7 +331,14 @@ float RaBitDistanceComputerNotQ::distance_to_code(const uint8_t* code) {
     // Current implementation:
     // 
     // Sum of all bits is cached.
+    //
+    // The extended codes sum the planes, weighted by their bits.
     dot_qo = fvec_masked_sum(rotated_q.data(), binary_data, d);
+    for (size_t b = 1; b < nb_bits; b++) {
+        dot_qo += (1 << b) *
+                fvec_masked_sum(
+                          rotated_q.data(), binary_data + b * plane_size(), d);
+    }
 
     float sum_q = fac->sum_xb;
 
@@ -288,7 +399,10 @@ void RaBitDistanceComputerNotQ::set_query(const float* x) {
         sum_q += rotated_q[i];
     }
 
-    query_fac.c1 = 2 * inv_d;
+    // the values of the extended codes are in [0, 2^nb_bits - 1]
+    const float max_u = (1 << nb_bits) - 1;
+
+    query_fac.c1 = 2 * inv_d / max_u;
     query_fac.c2 = 0;
     query_fac.c34 = sum_q * inv_d;
 
@@ -330,8 +444,8 @@ float RaBitDistanceComputerQ::distance_to_code(const uint8_t* code) {
 
     // split the code into parts
     const uint8_t* binary_data = code;
-    const FactorsData* fac =
-            reinterpret_cast<const FactorsData*>(code + (d + 7) / 8);
+    const FactorsData* fac = reinterpret_cast<const FactorsData*>(
+            code + nb_bits * plane_size());
 
     // // this is the baseline code
     // //
@@ -349,6 +463,15 @@ float RaBitDistanceComputerQ::distance_to_code(const uint8_t* code) {
 
     // this is the scheme for popcount
     float dot_qo = rabitq_dp_popcnt(rearranged_rotated_qq.data(), binary_data, d, qb);
+    // the extended codes sum the planes, weighted by their bits
+    for (size_t b = 1; b < nb_bits; b++) {
+        dot_qo += (1 << b) *
+                rabitq_dp_popcnt(
+                          rearranged_rotated_qq.data(),
+                          binary_data + b * plane_size(),
+                          d,
+                          qb);
+    }
 
     // Baseline FAISS:
     //
@@ -465,8 +588,11 @@ void RaBitDistanceComputerQ::set_query(const float* x) {
         }
     }
 
-    query_fac.c1 = 2 * delta * inv_d;
-    query_fac.c2 = 2 * v_min * inv_d;
+    // the values of the extended codes are in [0, 2^nb_bits - 1]
+    const float max_u = (1 << nb_bits) - 1;
+
+    query_fac.c1 = 2 * delta * inv_d / max_u;
+    query_fac.c2 = 2 * v_min * inv_d / max_u;
     query_fac.c34 = inv_d * (delta * sum_qq + d * v_min);
 
     if (metric_type == MetricType::METRIC_INNER_PRODUCT) {
@@ -482,6 +608,7 @@ FlatCodesDistanceComputer* RaBitQuantizer::get_distance_computer(
         auto dc = std::make_unique<RaBitDistanceComputerNotQ>();
         dc->metric_type = metric_type;
         dc->d = d;
+        dc->nb_bits = nb_bits;
         dc->centroid = centroid_in;
 
         return dc.release();
@@ -489,6 +616,7 @@ FlatCodesDistanceComputer* RaBitQuantizer::get_distance_computer(
         auto dc = std::make_unique<RaBitDistanceComputerQ>();
         dc->metric_type = metric_type;
         dc->d = d;
+        dc->nb_bits = nb_bits;
         dc->centroid = centroid_in;
         dc->qb = qb;
 
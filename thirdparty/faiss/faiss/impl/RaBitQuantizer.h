@@ -15,6 +15,16 @@ namespace faiss {
 //   with a Theoretical Error Bound for Approximate Nearest Neighbor Search".
 //
 // It is assumed that the Random Matrix Rotation is performed externally.
+//
+// With nb_bits > 1, the codes are the extended RaBitQ ones of
+//   https://arxiv.org/abs/2409.09913 (Jianyang Gao et al., "Practical and
+//   Asymptotically Optimal Quantization of High-Dimensional Vectors in
+//   Euclidean Space for Approximate Nearest Neighbor Search"): every
+//   dimension is an unsigned nb_bits value on a uniform grid, rescaled per
+//   vector to best match its direction. The values are stored as nb_bits
+//   bit planes of (d + 7) / 8 bytes, lowest bit first, so that a dot product
+//   with a code is a weighted sum of the 1-bit kernels over its planes. The
+//   single plane of nb_bits = 1 is the original RaBitQ code.
 struct RaBitQuantizer : Quantizer {
     // all RaBitQ operations are provided against a centroid, which needs
     //   to be provided Externally (!). Nullptr value implies that the centroid
@@ -31,11 +41,22 @@ struct RaBitQuantizer : Quantizer {
     //   possible. Thus, a quantizer has to introduce a metric.
     MetricType metric_type = MetricType::METRIC_L2;
 
-    RaBitQuantizer(size_t d = 0, MetricType metric = MetricType::METRIC_L2);
+    // the bits per dimension of a code, 1 to 8.
+    // This is not serialized, but follows from d and code_size.
+    size_t nb_bits = 1;
+
+    RaBitQuantizer(
+            size_t d = 0,
+            MetricType metric = MetricType::METRIC_L2,
+            size_t nb_bits = 1);
+
+    // the bits per dimension of the codes of the given size
+    static size_t get_nb_bits(size_t d, size_t code_size);
 
     void train(size_t n, const float* x) override;
 
-    // every vector is expected to take (d + 7) / 8 + sizeof(FactorsData) bytes,
+    // every vector is expected to take
+    //   nb_bits * (d + 7) / 8 + sizeof(FactorsData) bytes,
     void compute_codes(const float* x, uint8_t* codes, size_t n) const override;
 
     void compute_codes_core(
@@ -233,13 +233,20 @@ struct HeapBlockResultHandler : BlockResultHandler<C, use_sel> {
         /// add one result for query i
         bool add_result(T dis, TI idx) final {
             if (C::cmp(threshold, dis)) {
-                heap_replace_top<C>(k, heap_dis, heap_ids, dis, idx);
-                threshold = heap_dis[0];
+                replace_top(dis, idx);
                 return true;
             }
             return false;
         }
 
+        /// out of line, so that the scan loops that inline add_result keep
+        /// only the threshold compare, the replacements are rare once the
+        /// heap holds good results
+        FAISS_NOINLINE void replace_top(T dis, TI idx) {
+            heap_replace_top<C>(k, heap_dis, heap_ids, dis, idx);
+            threshold = heap_dis[0];
+        }
+
         /// series of results for query i is done
         void end() {
             heap_reorder<C>(k, heap_dis, heap_ids);
@@ -8,6 +8,11 @@
 
 #include <faiss/utils/distances_if.h>
 
+#include <cmath>
+#include <vector>
+
+#include "simd/hook.h"
+
 namespace faiss {
 
 /*******************************************************************
@@ -336,4 +341,95 @@ struct IVFSQScannerL2 : InvertedListScanner {
     }
 };
 
-}
\ No newline at end of file
+/*******************************************************************
+ * Quantized queries for the 8-bit codes, inner product only
+ *
+ * The QT_8bit and QT_8bit_uniform codes decode to
+ *   x[i] = vmin[i] + (c[i] + 0.5) * vdiff[i] / 255,
+ * so that with w[i] = q[i] * vdiff[i] / 255
+ *   <q, x> = sum(q[i] * vmin[i] + 0.5 * w[i]) + sum(w[i] * c[i]).
+ * The first sum is computed once per query. w is quantized to int8
+ * with one scale per query, which turns the second sum into an int8 x
+ * uint8 dot product on the codes as they are stored. The rounding of w
+ * is the only approximation, its first order term is corrected for the
+ * codes in the middle of their range.
+ ********************************************************************/
+
+template <bool uniform>
+struct SQ8QuantizedQueryDCIP {
+    size_t d;
+    const float* vmin;
+    const float* vdiff;
+
+    std::vector<int8_t> qw;
+    float scale = 0;
+    float bias = 0;
+
+    SQ8QuantizedQueryDCIP(size_t d, const std::vector<float>& trained)
+            : d(d),
+              vmin(trained.data()),
+              vdiff(trained.data() + (uniform ? 1 : d)),
+              qw(d) {}
+
+    void set_query(const float* x) {
+        std::vector<float> w(d);
+        float wmax = 0;
+        bias = 0;
+        for (size_t i = 0; i < d; i++) {
+            const size_t j = uniform ? 0 : i;
+            w[i] = x[i] * vdiff[j] / 255.0f;
+            bias += x[i] * vmin[j] + 0.5f * w[i];
+            wmax = std::max(wmax, std::abs(w[i]));
+        }
+        scale = wmax / 127.0f;
+        for (size_t i = 0; i < d; i++) {
+            qw[i] = scale > 0 ? (int8_t)std::lrint(w[i] / scale) : 0;
+            bias += (w[i] - scale * qw[i]) * 127.5f;
+        }
+    }
+
+    float query_to_code(const uint8_t* code) const {
+        return bias + scale * s8u8_inner_product(qw.data(), code, d);
+    }
+
+    void query_to_codes_batch_4(
+            const uint8_t* __restrict code_0,
+            const uint8_t* __restrict code_1,
+            const uint8_t* __restrict code_2,
+            const uint8_t* __restrict code_3,
+            float& dis0,
+            float& dis1,
+            float& dis2,
+            float& dis3) const {
+        int32_t dp0, dp1, dp2, dp3;
+        s8u8_inner_product_batch_4(
+                qw.data(), code_0, code_1, code_2, code_3, d, dp0, dp1, dp2, dp3);
+        dis0 = bias + scale * dp0;
+        dis1 = bias + scale * dp1;
+        dis2 = bias + scale * dp2;
+        dis3 = bias + scale * dp3;
+    }
+};
+
+template <bool uniform>
+InvertedListScanner* sel_sq8_quantized_query_scanner_ip(
+        const ScalarQuantizer* sq,
+        bool store_pairs,
+        const IDSelector* sel,
+        bool r) {
+    using DCClass = SQ8QuantizedQueryDCIP<uniform>;
+    if (sel) {
+        if (store_pairs) {
+            return new IVFSQScannerIP<DCClass, 2>(
+                    sq->d, sq->trained, sq->code_size, store_pairs, sel, r);
+        } else {
+            return new IVFSQScannerIP<DCClass, 1>(
+                    sq->d, sq->trained, sq->code_size, store_pairs, sel, r);
+        }
+    } else {
+        return new IVFSQScannerIP<DCClass, 0>(
+                sq->d, sq->trained, sq->code_size, store_pairs, sel, r);
+    }
+}
+
+}
@@ -30,6 +30,7 @@
 #include <faiss/IndexAdditiveQuantizerFastScan.h>
 #include <faiss/IndexCosine.h>
 #include <faiss/IndexFlat.h>
+#include <faiss/IndexFlatHalf.h>
 #include <faiss/IndexHNSW.h>
 #include <faiss/IndexIVF.h>
 #include <faiss/IndexIVFAdditiveQuantizer.h>
@@ -173,7 +174,8 @@ bool read_vector_base(
                     size_t(size),
                     strerror(errno));
 
-            VectorT view = VectorT::create_view(address, nread, nullptr);
+            VectorT view =
+                    VectorT::create_view(address, nread, zr->data_owner);
             target = std::move(view);
 
             return true;
@@ -403,11 +405,11 @@ InvertedLists* read_InvertedLists(IOReader* f, int io_flags) {
                 size_t seg_num = lca->get_segment_num(i);
                 for (size_t j = 0; j < seg_num; j++) {
                     size_t seg_size = lca->get_segment_size(i , j);
-                    size_t seg_off = lca->get_segment_offset(i, j);
-                    READANDCHECK(lca->codes[i][j].data_.data(), seg_size * lca->code_size);
-                    READANDCHECK(lca->ids[i][j].data_.data(), seg_size);
+                    const auto& segment = lca->get_segment(i, j);
+                    READANDCHECK(segment.codes, seg_size * lca->code_size);
+                    READANDCHECK(segment.ids, seg_size);
                     if (save_norm) {
-                        READANDCHECK(lca->code_norms[i][j].data_.data(), seg_size);
+                        READANDCHECK(segment.code_norms, seg_size);
                     }
                 }
             }
@@ -674,6 +676,8 @@ static void read_RaBitQuantizer(RaBitQuantizer* rabitq, IOReader* f) {
     READ1(rabitq->d);
     READ1(rabitq->code_size);
     READ1(rabitq->metric_type);
+    // the bits of the extended codes are not stored
+    rabitq->nb_bits = RaBitQuantizer::get_nb_bits(rabitq->d, rabitq->code_size);
 }
 
 static void read_direct_map(DirectMap* dm, IOReader* f) {
@@ -799,6 +803,22 @@ Index* read_index(IOReader* f, int io_flags) {
                 idxf->codes.size() == idxf->ntotal * idxf->code_size);
         // leak!
         idx = idxf;
+    } else if (h == fourcc("IxFH")) {
+        IndexFlatHalf* idxf = new IndexFlatHalf();
+        read_index_header(idxf, f);
+        uint8_t is_bf16;
+        READ1(is_bf16);
+        idxf->is_bf16 = is_bf16;
+        idxf->code_size = idxf->d * sizeof(uint16_t);
+        read_vector(idxf->codes, f);
+        if (idxf->is_cosine) {
+            std::vector<float> l2_norms;
+            READVECTOR(l2_norms);
+            idxf->inverse_norms_storage = L2NormsStorage::from_l2_norms(l2_norms);
+        }
+        FAISS_THROW_IF_NOT(
+                idxf->codes.size() == idxf->ntotal * idxf->code_size);
+        idx = idxf;
     } else if (
             h == fourcc("IxFI") || h == fourcc("IxF2") || h == fourcc("IxFl")) {
         IndexFlat* idxf;
@@ -814,6 +834,7 @@ Index* read_index(IOReader* f, int io_flags) {
         read_xb_vector(idxf->codes, f);
         if (idxf->is_cosine) {
             READVECTOR(idxf->code_norms);
+            idxf->update_inverse_norms();
         }
         FAISS_THROW_IF_NOT(
                 idxf->codes.size() == idxf->ntotal * idxf->code_size);
@@ -1099,6 +1120,27 @@ Index* read_index(IOReader* f, int io_flags) {
         }
         read_InvertedLists(ivfl, f, io_flags);
         idx = ivfl;
+    } else if (h == fourcc("IxNU") || h == fourcc("IxNC")) {
+        IndexNonUniformSQCosine* idxnc = nullptr;
+        IndexNonUniformSQ* idxnu = nullptr;
+        if (h == fourcc("IxNC")) {
+            idxnc = new IndexNonUniformSQCosine();
+            idxnu = idxnc;
+        } else {
+            idxnu = new IndexNonUniformSQ();
+        }
+        read_index_header(idxnu, f);
+        READ1(idxnu->nusq.d);
+        READ1(idxnu->nusq.nbits);
+        READ1(idxnu->nusq.code_size);
+        READVECTOR(idxnu->nusq.codebooks);
+        read_vector(idxnu->codes, f);
+        idxnu->code_size = idxnu->nusq.code_size;
+        if (idxnc) {
+            // reconstruct inverse norms
+            READVECTOR(idxnc->inverse_norms_storage.inverse_l2_norms);
+        }
+        idx = idxnu;
     } else if (h == fourcc("IxS8")) {
         IndexScalarQuantizerCosine* idxs = new IndexScalarQuantizerCosine();
         read_index_header(idxs, f);
@@ -1294,7 +1336,8 @@ Index* read_index(IOReader* f, int io_flags) {
             h == fourcc("IHNf") || h == fourcc("IHNp") || h == fourcc("IHNs") ||
             h == fourcc("IHN2") || h == fourcc("IHNc") || h == fourcc("IHN9") ||
             h == fourcc("IHN8") || h == fourcc("IHN7") || h == fourcc("IHN6") ||
-            h == fourcc("IHN5")) {
+            h == fourcc("IHN5") || h == fourcc("IHN4") || h == fourcc("IHN3") ||
+            h == fourcc("IHN1") || h == fourcc("IHN0")) {
         IndexHNSW* idxhnsw = nullptr;
         if (h == fourcc("IHNf"))
             idxhnsw = new IndexHNSWFlat();
@@ -1316,6 +1359,14 @@ Index* read_index(IOReader* f, int io_flags) {
             idxhnsw = new IndexHNSWProductResidualQuantizer();
         if (h == fourcc("IHN5"))
             idxhnsw = new IndexHNSWProductResidualQuantizerCosine();
+        if (h == fourcc("IHN4"))
+            idxhnsw = new IndexHNSWRaBitQ();
+        if (h == fourcc("IHN3"))
+            idxhnsw = new IndexHNSWRaBitQCosine();
+        if (h == fourcc("IHN1"))
+            idxhnsw = new IndexHNSWNonUniformSQ();
+        if (h == fourcc("IHN0"))
+            idxhnsw = new IndexHNSWNonUniformSQCosine();
         read_index_header(idxhnsw, f);
         if (h == fourcc("IHNc")) {
             READ1(idxhnsw->keep_max_size_level0);
@@ -1327,7 +1378,8 @@ Index* read_index(IOReader* f, int io_flags) {
         idxhnsw->storage = read_index(f, io_flags);
         idxhnsw->own_fields = idxhnsw->storage != nullptr;
         if (h == fourcc("IHNp") && !(io_flags & IO_FLAG_PQ_SKIP_SDC_TABLE)) {
-            dynamic_cast<IndexPQ*>(idxhnsw->storage)->pq.compute_sdc_table();
+            // the codes may be behind the rotation of make_rotated_pq_storage()
+            get_storage_pq(idxhnsw->storage)->pq.compute_sdc_table();
         }
         idx = idxhnsw;
     } else if (
@@ -1418,6 +1470,17 @@ Index* read_index(IOReader* f, int io_flags) {
         imm->own_fields = true;
 
         idx = imm;
+    } else if (h == fourcc("IxrC")) {
+        IndexRaBitQCosine* idxq = new IndexRaBitQCosine();
+        read_index_header(idxq, f);
+        read_RaBitQuantizer(&idxq->rabitq, f);
+        read_vector(idxq->codes, f);
+        READVECTOR(idxq->center);
+        READ1(idxq->qb);
+        idxq->code_size = idxq->rabitq.code_size;
+        // read inverse norms
+        READVECTOR(idxq->inverse_norms_storage.inverse_l2_norms);
+        idx = idxq;
     } else if (h == fourcc("IxrQ")) {
         // using 'IxrQ' instead of baseline's 'Ixrq'
         IndexRaBitQ* idxq = new IndexRaBitQ();
@@ -10,12 +10,14 @@
 #include <faiss/impl/io.h>
 #include <faiss/impl/io_macros.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <faiss/invlists/ArenaInvertedLists.h>
 #include <faiss/invlists/InvertedListsIOHook.h>
 #include <faiss/invlists/OnDiskInvertedLists.h>
 
@@ -29,6 +31,7 @@
 #include <faiss/IndexAdditiveQuantizerFastScan.h>
 #include <faiss/IndexCosine.h>
 #include <faiss/IndexFlat.h>
+#include <faiss/IndexFlatHalf.h>
 #include <faiss/IndexHNSW.h>
 #include <faiss/IndexIVF.h>
 #include <faiss/IndexIVFAdditiveQuantizer.h>
@@ -257,10 +260,18 @@ static void write_ScalarQuantizer(const ScalarQuantizer* ivsc, IOWriter* f) {
     WRITEVECTOR(ivsc->trained);
 }
 
-void write_InvertedLists(const InvertedLists* ils, IOWriter* f) {
+void write_InvertedLists(
+        const InvertedLists* ils,
+        IOWriter* f,
+        int io_flags) {
     if (ils == nullptr) {
         uint32_t h = fourcc("il00");
         WRITE1(h);
+    } else if (
+            (io_flags & IO_FLAG_ARENA_INVLISTS) &&
+            typeid(*ils) == typeid(ArrayInvertedLists) &&
+            !dynamic_cast<const ArrayInvertedLists*>(ils)->with_norm) {
+        write_ArenaInvertedLists(ils, f);
     } else if (
             const auto& ails = dynamic_cast<const ArrayInvertedLists*>(ils)) {
         uint32_t h = fourcc("ilar");
@@ -317,10 +328,16 @@ void write_InvertedLists(const InvertedLists* ils, IOWriter* f) {
         // don't serialize 'save_norm'
         // WRITE1(lca->save_norm);
 
+        // the lists may grow while they are written, take their sizes once
+        std::vector<size_t> list_sizes(lca->nlist);
+        for (size_t i = 0; i < lca->nlist; i++) {
+            list_sizes[i] = lca->list_size(i);
+        }
+
         // here we store either as a full or a sparse data buffer
         size_t n_non0 = 0;
         for (size_t i = 0; i < lca->nlist; i++) {
-            if (lca->list_size(i) > 0) {
+            if (list_sizes[i] > 0) {
                 n_non0++;
             }
         }
@@ -329,7 +346,7 @@ void write_InvertedLists(const InvertedLists* ils, IOWriter* f) {
             WRITE1(list_type);
             std::vector<size_t> sizes;
             for (size_t i = 0; i < lca->nlist; i++) {
-                sizes.push_back(lca->list_size(i));
+                sizes.push_back(list_sizes[i]);
             }
             WRITEVECTOR(sizes);
         } else {
@@ -337,7 +354,7 @@ void write_InvertedLists(const InvertedLists* ils, IOWriter* f) {
             WRITE1(list_type);
             std::vector<size_t> sizes;
             for (size_t i = 0; i < lca->nlist; i++) {
-                size_t n = lca->list_size(i);
+                size_t n = list_sizes[i];
                 if (n > 0) {
                     sizes.push_back(i);
                     sizes.push_back(n);
@@ -347,15 +364,17 @@ void write_InvertedLists(const InvertedLists* ils, IOWriter* f) {
         }
         // make a single contiguous data buffer (useful for mmapping)
         for (size_t i = 0; i < lca->nlist; i++) {
-            size_t n = lca->list_size(i);
+            size_t n = list_sizes[i];
             if (n > 0) {
-                size_t seg_num = lca->get_segment_num(i);
+                size_t seg_num = lca->cal_segment_num(n);
                 for (size_t j = 0; j < seg_num; j++) {
-                    size_t seg_size = lca->get_segment_size(i, j);
-                    WRITEANDCHECK(lca->codes[i][j].data_.data(), seg_size * lca->code_size);
-                    WRITEANDCHECK(lca->ids[i][j].data_.data(), seg_size);
+                    size_t seg_size = std::min(
+                            lca->segment_size, n - j * lca->segment_size);
+                    const auto& segment = lca->get_segment(i, j);
+                    WRITEANDCHECK(segment.codes, seg_size * lca->code_size);
+                    WRITEANDCHECK(segment.ids, seg_size);
                     if (lca->save_norm) {
-                        WRITEANDCHECK(lca->code_norms[i][j].data_.data(), seg_size);
+                        WRITEANDCHECK(segment.code_norms, seg_size);
                     }
                 }
             }
@@ -523,6 +542,18 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         // we're storing real l2 norms, because of
         //   backward compatibility issues. 
         WRITEVECTOR(idxf->inverse_norms_storage.as_l2_norms());
+    } else if (
+            const IndexFlatHalf* idxf =
+                    dynamic_cast<const IndexFlatHalf*>(idx)) {
+        uint32_t h = fourcc("IxFH");
+        WRITE1(h);
+        write_index_header(idx, f);
+        uint8_t is_bf16 = idxf->is_bf16;
+        WRITE1(is_bf16);
+        WRITEVECTOR(idxf->codes);
+        if (idx->is_cosine) {
+            WRITEVECTOR(idxf->inverse_norms_storage.as_l2_norms());
+        }
     } else if (const IndexFlat* idxf = dynamic_cast<const IndexFlat*>(idx)) {
         uint32_t h =
                 fourcc(idxf->metric_type == METRIC_INNER_PRODUCT ? "IxFI"
@@ -727,7 +758,7 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         WRITE1(ivaqfs->norm_scale);
         WRITE1(ivaqfs->max_train_points);
 
-        write_InvertedLists(ivaqfs->invlists, f);
+        write_InvertedLists(ivaqfs->invlists, f, io_flags);
     } else if (
             const ResidualCoarseQuantizer* idxr_2 =
                     dynamic_cast<const ResidualCoarseQuantizer*>(idx)) {
@@ -749,6 +780,23 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         WRITE1(idxp_2->code_size_2);
         WRITE1(idxp_2->code_size);
         WRITEVECTOR(idxp_2->codes);
+    } else if (
+            const IndexNonUniformSQ* idxnu =
+                    dynamic_cast<const IndexNonUniformSQ*>(idx)) {
+        const IndexNonUniformSQCosine* idxnc =
+                dynamic_cast<const IndexNonUniformSQCosine*>(idx);
+        uint32_t h = idxnc ? fourcc("IxNC") : fourcc("IxNU");
+        WRITE1(h);
+        write_index_header(idx, f);
+        WRITE1(idxnu->nusq.d);
+        WRITE1(idxnu->nusq.nbits);
+        WRITE1(idxnu->nusq.code_size);
+        WRITEVECTOR(idxnu->nusq.codebooks);
+        WRITEVECTOR(idxnu->codes);
+        if (idxnc) {
+            // inverse norms
+            WRITEVECTOR(idxnc->inverse_norms_storage.inverse_l2_norms);
+        }
     } else if (
             const IndexScalarQuantizerCosine* idxs =
                     dynamic_cast<const IndexScalarQuantizerCosine*>(idx)) {
@@ -794,19 +842,19 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
             }
             WRITEVECTOR(tab);
         }
-        write_InvertedLists(ivfl->invlists, f);
+        write_InvertedLists(ivfl->invlists, f, io_flags);
     } else if (const IndexIVFFlat* ivfl = dynamic_cast<const IndexIVFFlatCC*>(idx)) {
         uint32_t h = fourcc("IwFc");
         WRITE1(h);
         write_ivf_header(ivfl, f);
-        write_InvertedLists(ivfl->invlists, f);
+        write_InvertedLists(ivfl->invlists, f, io_flags);
     } else if (
             const IndexIVFFlat* ivfl_2 =
                     dynamic_cast<const IndexIVFFlat*>(idx)) {
         uint32_t h = fourcc("IwFl");
         WRITE1(h);
         write_ivf_header(ivfl_2, f);
-        write_InvertedLists(ivfl_2->invlists, f);
+        write_InvertedLists(ivfl_2->invlists, f, io_flags);
     } else if (
             const IndexIVFScalarQuantizer* ivsc =
                     dynamic_cast<const IndexIVFScalarQuantizer*>(idx)) {
@@ -816,7 +864,7 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         write_ScalarQuantizer(&ivsc->sq, f);
         WRITE1(ivsc->code_size);
         WRITE1(ivsc->by_residual);
-        write_InvertedLists(ivsc->invlists, f);
+        write_InvertedLists(ivsc->invlists, f, io_flags);
     } else if (auto iva = dynamic_cast<const IndexIVFAdditiveQuantizer*>(idx)) {
         bool is_LSQ = dynamic_cast<const IndexIVFLocalSearchQuantizer*>(iva);
         bool is_RQ = dynamic_cast<const IndexIVFResidualQuantizer*>(iva);
@@ -849,7 +897,7 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         }
         WRITE1(iva->by_residual);
         WRITE1(iva->use_precomputed_table);
-        write_InvertedLists(iva->invlists, f);
+        write_InvertedLists(iva->invlists, f, io_flags);
     } else if (
             const IndexIVFSpectralHash* ivsp =
                     dynamic_cast<const IndexIVFSpectralHash*>(idx)) {
@@ -861,7 +909,7 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         WRITE1(ivsp->period);
         WRITE1(ivsp->threshold_type);
         WRITEVECTOR(ivsp->trained);
-        write_InvertedLists(ivsp->invlists, f);
+        write_InvertedLists(ivsp->invlists, f, io_flags);
     } else if (const IndexIVFPQ* ivpq = dynamic_cast<const IndexIVFPQ*>(idx)) {
         const IndexIVFPQR* ivfpqr = dynamic_cast<const IndexIVFPQR*>(idx);
 
@@ -871,7 +919,7 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         WRITE1(ivpq->by_residual);
         WRITE1(ivpq->code_size);
         write_ProductQuantizer(&ivpq->pq, f);
-        write_InvertedLists(ivpq->invlists, f);
+        write_InvertedLists(ivpq->invlists, f, io_flags);
         if (ivfpqr) {
             write_ProductQuantizer(&ivfpqr->refine_pq, f);
             WRITEVECTOR(ivfpqr->refine_codes);
@@ -950,6 +998,10 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
                 : dynamic_cast<const IndexHNSWPQCosine*>(idx)   ? fourcc("IHN7")
                 : dynamic_cast<const IndexHNSWProductResidualQuantizer*>(idx)   ? fourcc("IHN6")
                 : dynamic_cast<const IndexHNSWProductResidualQuantizerCosine*>(idx)   ? fourcc("IHN5")
+                : dynamic_cast<const IndexHNSWRaBitQ*>(idx)     ? fourcc("IHN4")
+                : dynamic_cast<const IndexHNSWRaBitQCosine*>(idx)   ? fourcc("IHN3")
+                : dynamic_cast<const IndexHNSWNonUniformSQ*>(idx)   ? fourcc("IHN1")
+                : dynamic_cast<const IndexHNSWNonUniformSQCosine*>(idx)   ? fourcc("IHN0")
                                                                 : 0;
         FAISS_THROW_IF_NOT(h != 0);
         WRITE1(h);
@@ -1024,7 +1076,7 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
             WRITEVECTOR(ivpq_2->inverse_norms);
         }
         write_ProductQuantizer(&ivpq_2->pq, f);
-        write_InvertedLists(ivpq_2->invlists, f);
+        write_InvertedLists(ivpq_2->invlists, f, io_flags);
     } else if (
             const IndexRowwiseMinMax* imm =
                     dynamic_cast<const IndexRowwiseMinMax*>(idx)) {
@@ -1041,6 +1093,16 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         WRITE1(h);
         write_index_header(imm_2, f);
         write_index(imm_2->index, f);
+    } else if (const IndexRaBitQCosine* idxq = dynamic_cast<const IndexRaBitQCosine*>(idx)) {
+        uint32_t h = fourcc("IxrC");
+        WRITE1(h);
+        write_index_header(idx, f);
+        write_RaBitQuantizer(&idxq->rabitq, f);
+        WRITEVECTOR(idxq->codes);
+        WRITEVECTOR(idxq->center);
+        WRITE1(idxq->qb);
+        // inverse norms
+        WRITEVECTOR(idxq->inverse_norms_storage.inverse_l2_norms);
     } else if (const IndexRaBitQ* idxq = dynamic_cast<const IndexRaBitQ*>(idx)) {
         // using 'IxrQ' instead of baseline's 'Ixrq'
         uint32_t h = fourcc("IxrQ");
@@ -1061,7 +1123,7 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         WRITE1(ivrq->code_size);
         WRITE1(ivrq->by_residual);
         WRITE1(ivrq->qb);
-        write_InvertedLists(ivrq->invlists, f);
+        write_InvertedLists(ivrq->invlists, f, io_flags);
     } else {
         FAISS_THROW_MSG("don't know how to serialize this type of index");
     }
@@ -92,6 +92,7 @@ inline int __builtin_clzll(uint64_t x) {
 #endif
 
 #define FAISS_ALWAYS_INLINE __forceinline
+#define FAISS_NOINLINE __declspec(noinline)
 
 #else
 /*******************************************************
@@ -110,6 +111,7 @@ inline int __builtin_clzll(uint64_t x) {
 #endif
 
 #define FAISS_ALWAYS_INLINE __attribute__((always_inline)) inline
+#define FAISS_NOINLINE __attribute__((noinline))
 
 #endif
 
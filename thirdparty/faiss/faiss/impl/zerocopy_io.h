@@ -8,8 +8,10 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 
 #include <faiss/impl/io.h>
+#include <faiss/impl/maybe_owned_vector.h>
 
 namespace faiss {
 
@@ -19,6 +21,9 @@ struct ZeroCopyIOReader : public faiss::IOReader {
     size_t rp_ = 0;
     size_t total_ = 0;
 
+    // if set, the views of the data handed to the read index keep it alive
+    std::shared_ptr<MaybeOwnedVectorOwner> data_owner;
+
     ZeroCopyIOReader(uint8_t* data, size_t size);
     ~ZeroCopyIOReader();
 
@@ -70,6 +70,9 @@ const int IO_FLAG_MMAP = IO_FLAG_SKIP_IVF_DATA | 0x646f0000;
 // this is a temporary solution, it is expected to be merged with IO_FLAG_MMAP
 //   after OnDiskInvertedLists get properly updated.
 const int IO_FLAG_MMAP_IFC = 1 << 9;
+// write the ArrayInvertedLists as ArenaInvertedLists, that are loaded with a
+//   single read, or mapped when the file is mmapped
+const int IO_FLAG_ARENA_INVLISTS = 1 << 10;
 
 Index* read_index(const char* fname, int io_flags = 0);
 Index* read_index(FILE* f, int io_flags = 0);
@@ -91,7 +94,10 @@ ProductQuantizer* read_ProductQuantizer(IOReader* reader);
 void write_ProductQuantizer(const ProductQuantizer* pq, const char* fname);
 void write_ProductQuantizer(const ProductQuantizer* pq, IOWriter* f);
 
-void write_InvertedLists(const InvertedLists* ils, IOWriter* f);
+void write_InvertedLists(
+        const InvertedLists* ils,
+        IOWriter* f,
+        int io_flags = 0);
 InvertedLists* read_InvertedLists(IOReader* reader, int io_flags = 0);
 
 // additional helper function for knowhere
@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <faiss/invlists/ArenaInvertedLists.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/impl/io.h>
+#include <faiss/impl/io_macros.h>
+#include <faiss/impl/mapped_io.h>
+#include <faiss/impl/zerocopy_io.h>
+#include <faiss/index_io.h>
+
+namespace faiss {
+
+namespace {
+
+/// owns an arena allocated by ArenaInvertedLists
+struct ArenaOwner : MaybeOwnedVectorOwner {
+    static constexpr size_t alignment = 64;
+
+    uint8_t* data = nullptr;
+
+    explicit ArenaOwner(size_t n)
+            : data((uint8_t*)::operator new[](
+                      n,
+                      std::align_val_t(alignment))) {}
+
+    ~ArenaOwner() override {
+        ::operator delete[](data, std::align_val_t(alignment));
+    }
+};
+
+/// points the ids and codes of ails to the arena at data
+void view_arena(
+        ArenaInvertedLists& ails,
+        uint8_t* data,
+        const std::shared_ptr<MaybeOwnedVectorOwner>& owner) {
+    const size_t n = ails.total_size();
+    ails.codes = MaybeOwnedVector<uint8_t>::create_view(
+            data + n * sizeof(idx_t), n * ails.code_size, owner);
+    if ((uintptr_t)data % alignof(idx_t) == 0) {
+        ails.ids = MaybeOwnedVector<idx_t>::create_view(data, n, owner);
+    } else {
+        std::vector<idx_t> ids(n);
+        memcpy(ids.data(), data, n * sizeof(idx_t));
+        ails.ids = MaybeOwnedVector<idx_t>(std::move(ids));
+    }
+}
+
+} // namespace
+
+ArenaInvertedLists::ArenaInvertedLists(size_t nlist, size_t code_size)
+        : ReadOnlyInvertedLists(nlist, code_size), offsets(nlist + 1, 0) {}
+
+ArenaInvertedLists::ArenaInvertedLists(const InvertedLists& other)
+        : ArenaInvertedLists(other.nlist, other.code_size) {
+    FAISS_THROW_IF_NOT(code_size != INVALID_CODE_SIZE);
+    for (size_t i = 0; i < nlist; i++) {
+        offsets[i + 1] = offsets[i] + other.list_size(i);
+    }
+    auto owner =
+            std::make_shared<ArenaOwner>(arena_size(total_size(), code_size));
+    view_arena(*this, owner->data, owner);
+
+    for (size_t i = 0; i < nlist; i++) {
+        size_t n = offsets[i + 1] - offsets[i];
+        if (n == 0) {
+            continue;
+        }
+        FAISS_THROW_IF_NOT_MSG(
+                other.get_code_norms(i, 0) == nullptr,
+                "arena inverted lists do not store the norms");
+        ScopedIds sids(&other, i);
+        ScopedCodes scodes(&other, i);
+        memcpy(ids.data() + offsets[i], sids.get(), n * sizeof(idx_t));
+        memcpy(codes.data() + offsets[i] * code_size,
+               scodes.get(),
+               n * code_size);
+    }
+}
+
+size_t ArenaInvertedLists::total_size() const {
+    return offsets.back();
+}
+
+size_t ArenaInvertedLists::arena_size(size_t n, size_t code_size) {
+    return n * (sizeof(idx_t) + code_size);
+}
+
+size_t ArenaInvertedLists::list_size(size_t list_no) const {
+    assert(list_no < nlist);
+    return offsets[list_no + 1] - offsets[list_no];
+}
+
+const uint8_t* ArenaInvertedLists::get_codes(size_t list_no) const {
+    assert(list_no < nlist);
+    return codes.data() + offsets[list_no] * code_size;
+}
+
+const idx_t* ArenaInvertedLists::get_ids(size_t list_no) const {
+    assert(list_no < nlist);
+    return ids.data() + offsets[list_no];
+}
+
+idx_t ArenaInvertedLists::get_single_id(size_t list_no, size_t offset)
+        const {
+    assert(offset < list_size(list_no));
+    return get_ids(list_no)[offset];
+}
+
+const uint8_t* ArenaInvertedLists::get_single_code(
+        size_t list_no,
+        size_t offset) const {
+    assert(offset < list_size(list_no));
+    return get_codes(list_no) + offset * code_size;
+}
+
+bool ArenaInvertedLists::is_readonly() const {
+    return true;
+}
+
+void write_ArenaInvertedLists(const InvertedLists* ils, IOWriter* f) {
+    FAISS_THROW_IF_NOT(ils->code_size != InvertedLists::INVALID_CODE_SIZE);
+    uint32_t h = fourcc("ilae");
+    WRITE1(h);
+    WRITE1(ils->nlist);
+    WRITE1(ils->code_size);
+    std::vector<size_t> offsets(ils->nlist + 1, 0);
+    for (size_t i = 0; i < ils->nlist; i++) {
+        offsets[i + 1] = offsets[i] + ils->list_size(i);
+    }
+    WRITEVECTOR(offsets);
+
+    // the lists are streamed in the arena layout: all the ids, then all the
+    // codes, so that the arena never has to be built in memory
+    for (size_t i = 0; i < ils->nlist; i++) {
+        size_t n = ils->list_size(i);
+        if (n > 0) {
+            InvertedLists::ScopedIds sids(ils, i);
+            WRITEANDCHECK(sids.get(), n);
+        }
+    }
+    for (size_t i = 0; i < ils->nlist; i++) {
+        size_t n = ils->list_size(i);
+        if (n > 0) {
+            FAISS_THROW_IF_NOT_MSG(
+                    ils->get_code_norms(i, 0) == nullptr,
+                    "arena inverted lists do not store the norms");
+            InvertedLists::ScopedCodes scodes(ils, i);
+            WRITEANDCHECK(scodes.get(), n * ils->code_size);
+        }
+    }
+}
+
+/*******************************************************
+ * I/O support via callbacks
+ *******************************************************/
+
+namespace {
+
+// a view of n bytes at the current position of f when it can be mapped,
+// nullptr otherwise
+uint8_t* map_arena(
+        IOReader* f,
+        int io_flags,
+        size_t n,
+        std::shared_ptr<MaybeOwnedVectorOwner>& owner) {
+    if (auto mf = dynamic_cast<MappedFileIOReader*>(f)) {
+        uint8_t* address = nullptr;
+        size_t nread = mf->mmap((void**)&address, 1, n);
+        FAISS_THROW_IF_NOT_FMT(
+                nread == n,
+                "read error in %s: %zd != %zd",
+                f->name.c_str(),
+                nread,
+                n);
+        owner = mf->mmap_owner;
+        return address;
+    }
+    if (auto zr = dynamic_cast<ZeroCopyIOReader*>(f)) {
+        uint8_t* address = nullptr;
+        size_t nread = zr->get_data_view((void**)&address, 1, n);
+        FAISS_THROW_IF_NOT_FMT(
+                nread == n,
+                "read error in %s: the arena is truncated",
+                f->name.c_str());
+        owner = zr->data_owner;
+        return address;
+    }
+    if ((io_flags & IO_FLAG_MMAP) == IO_FLAG_MMAP) {
+        if (auto ff = dynamic_cast<FileIOReader*>(f)) {
+            long pos = ftell(ff->f);
+            FAISS_THROW_IF_NOT_FMT(
+                    pos >= 0, "ftell() failed: %s", strerror(errno));
+            auto mapping = std::make_shared<MmappedFileMappingOwner>(ff->f);
+            FAISS_THROW_IF_NOT_FMT(
+                    pos + n <= mapping->size(),
+                    "read error in %s: the arena is truncated",
+                    f->name.c_str());
+            FAISS_THROW_IF_NOT_FMT(
+                    fseek(ff->f, n, SEEK_CUR) == 0,
+                    "fseek() failed: %s",
+                    strerror(errno));
+            owner = mapping;
+            return (uint8_t*)mapping->data() + pos;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+ArenaInvertedListsIOHook::ArenaInvertedListsIOHook()
+        : InvertedListsIOHook("ilae", typeid(ArenaInvertedLists).name()) {}
+
+void ArenaInvertedListsIOHook::write(const InvertedLists* ils, IOWriter* f)
+        const {
+    write_ArenaInvertedLists(ils, f);
+}
+
+InvertedLists* ArenaInvertedListsIOHook::read(IOReader* f, int io_flags)
+        const {
+    size_t nlist, code_size;
+    READ1(nlist);
+    READ1(code_size);
+    auto ails = std::make_unique<ArenaInvertedLists>(nlist, code_size);
+    READVECTOR(ails->offsets);
+    FAISS_THROW_IF_NOT(ails->offsets.size() == nlist + 1);
+    const size_t n =
+            ArenaInvertedLists::arena_size(ails->total_size(), code_size);
+    if (n == 0) {
+        return ails.release();
+    }
+
+    std::shared_ptr<MaybeOwnedVectorOwner> owner;
+    uint8_t* address = map_arena(f, io_flags, n, owner);
+    if (address == nullptr) {
+        auto arena = std::make_shared<ArenaOwner>(n);
+        READANDCHECK(arena->data, n);
+        address = arena->data;
+        owner = arena;
+    }
+    view_arena(*ails, address, owner);
+    return ails.release();
+}
+
+} // namespace faiss
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <faiss/impl/maybe_owned_vector.h>
+#include <faiss/invlists/InvertedLists.h>
+#include <faiss/invlists/InvertedListsIOHook.h>
+
+namespace faiss {
+
+/** Read-only inverted lists that keep all the ids and codes in one arena.
+ *
+ * The arena holds the ids of all the lists, then the codes of all the lists,
+ * list i spanning the entries [offsets[i], offsets[i + 1]). The serialized
+ * form ("ilae") is the same arena written as-is, so that loading it takes a
+ * single read into a single 64-byte aligned allocation, or no copy at all
+ * when the file is mmapped: ids and codes are then views of the mapping. The
+ * ids are copied out of the mapping only if it does not align them.
+ */
+struct ArenaInvertedLists : ReadOnlyInvertedLists {
+    /// size nlist + 1, in entries
+    std::vector<size_t> offsets;
+
+    /// the ids and codes of all the lists, slices of the same arena unless the
+    /// ids had to be copied out of an unaligned mapping
+    MaybeOwnedVector<idx_t> ids;
+    MaybeOwnedVector<uint8_t> codes;
+
+    ArenaInvertedLists(size_t nlist, size_t code_size);
+
+    /// copies the content of other, the lists may not have norms
+    explicit ArenaInvertedLists(const InvertedLists& other);
+
+    size_t total_size() const;
+
+    size_t list_size(size_t list_no) const override;
+    const uint8_t* get_codes(size_t list_no) const override;
+    const idx_t* get_ids(size_t list_no) const override;
+
+    idx_t get_single_id(size_t list_no, size_t offset) const override;
+    const uint8_t* get_single_code(size_t list_no, size_t offset)
+            const override;
+
+    bool is_readonly() const override;
+
+    /// size in bytes of an arena with n entries
+    static size_t arena_size(size_t n, size_t code_size);
+};
+
+/// writes any inverted lists without norms in the "ilae" format
+void write_ArenaInvertedLists(const InvertedLists* ils, IOWriter* f);
+
+struct ArenaInvertedListsIOHook : InvertedListsIOHook {
+    ArenaInvertedListsIOHook();
+    void write(const InvertedLists* ils, IOWriter* f) const override;
+
+    /// maps the arena if f is a MappedFileIOReader or a ZeroCopyIOReader, or
+    /// if io_flags contains IO_FLAG_MMAP and f is a FileIOReader; reads it at
+    /// once otherwise
+    InvertedLists* read(IOReader* f, int io_flags) const override;
+};
+
+} // namespace faiss
@@ -469,20 +469,28 @@ void ArrayInvertedLists::permute_invlists(const idx_t* map) {
 
 ArrayInvertedLists::~ArrayInvertedLists() {}
 
+namespace {
+
+// the bucket of a segment and its index in the bucket, bucket b holding the
+// segments [2^b - 1, 2^(b + 1) - 1)
+inline void locate_segment(size_t segment_no, size_t& bucket, size_t& index) {
+    const size_t k = segment_no + 1;
+    bucket = 63 - __builtin_clzll(k);
+    index = k - (size_t(1) << bucket);
+}
+
+} // namespace
+
 ConcurrentArrayInvertedLists::ConcurrentArrayInvertedLists(
         size_t nlist,
         size_t code_size,
         size_t segment_size,
         bool snorm)
-        : InvertedLists(nlist, code_size), segment_size(segment_size), save_norm(snorm), list_cur(nlist) {
-    ids.resize(nlist);
-    if (save_norm) {
-        code_norms.resize(nlist);
-    }
-    codes.resize(nlist);
-    for (int i = 0; i < nlist; i++) {
-        list_cur[i].store(0);
-    }
+        : InvertedLists(nlist, code_size),
+          segment_size(segment_size),
+          save_norm(snorm),
+          lists(new List[nlist]) {
+    FAISS_THROW_IF_NOT(segment_size > 0);
 }
 
 size_t ConcurrentArrayInvertedLists::cal_segment_num(size_t capacity) const {
@@ -490,37 +498,59 @@ size_t ConcurrentArrayInvertedLists::cal_segment_num(size_t capacity) const {
 }
 
 void ConcurrentArrayInvertedLists::reserve(size_t list_no, size_t capacity) {
-    size_t cur_segment_no = ids[list_no].size();
+    List& l = lists[list_no];
     size_t target_segment_no = cal_segment_num(capacity);
 
-    for (size_t idx = cur_segment_no; idx < target_segment_no; idx++) {
-        Segment<uint8_t> segment_codes(segment_size, code_size);
-        Segment<idx_t> segment_ids(segment_size, 1);
-        Segment<float> segment_code_norms(segment_size, 1);
-        codes[list_no].emplace_back(std::move(segment_codes));
+    const size_t entry_size =
+            sizeof(idx_t) + (save_norm ? sizeof(float) : 0) + code_size;
+    for (; l.n_segments < target_segment_no; l.n_segments++) {
+        size_t bucket_no, index;
+        locate_segment(l.n_segments, bucket_no, index);
+        FAISS_THROW_IF_NOT(bucket_no < max_buckets);
+        Segment* bucket = l.buckets[bucket_no].load(std::memory_order_relaxed);
+        if (bucket == nullptr) {
+            bucket = new Segment[size_t(1) << bucket_no];
+            l.buckets[bucket_no].store(bucket, std::memory_order_release);
+        }
+
+        // ids first, to keep them aligned
+        Segment& segment = bucket[index];
+        uint8_t* data = new uint8_t[segment_size * entry_size];
+        segment.ids = (idx_t*)data;
+        data += segment_size * sizeof(idx_t);
         if (save_norm) {
-            code_norms[list_no].emplace_back(std::move(segment_code_norms));
+            segment.code_norms = (float*)data;
+            data += segment_size * sizeof(float);
         }
-        ids[list_no].emplace_back(std::move(segment_ids));
+        segment.codes = data;
     }
 }
 
 void ConcurrentArrayInvertedLists::shrink_to_fit(size_t list_no, size_t capacity) {
-    size_t cur_segment_no = ids[list_no].size();
+    List& l = lists[list_no];
     size_t target_segment_no = cal_segment_num(capacity);
 
-    for (size_t idx = cur_segment_no; idx > target_segment_no; idx--) {
-        ids[list_no].pop_back();
-        if (save_norm) {
-            code_norms[list_no].pop_back();
-        }
-        codes[list_no].pop_back();
+    for (; l.n_segments > target_segment_no; l.n_segments--) {
+        size_t bucket_no, index;
+        locate_segment(l.n_segments - 1, bucket_no, index);
+        Segment& segment =
+                l.buckets[bucket_no].load(std::memory_order_relaxed)[index];
+        delete[] (uint8_t*)segment.ids;
+        segment = Segment();
     }
 }
 
+const ConcurrentArrayInvertedLists::Segment& ConcurrentArrayInvertedLists::
+        get_segment(size_t list_no, size_t segment_no) const {
+    assert(list_no < nlist);
+    size_t bucket_no, index;
+    locate_segment(segment_no, bucket_no, index);
+    return lists[list_no].buckets[bucket_no].load(std::memory_order_acquire)[index];
+}
+
 size_t ConcurrentArrayInvertedLists::list_size(size_t list_no) const {
     assert(list_no < nlist);
-    return list_cur[list_no].load();
+    return lists[list_no].size.load(std::memory_order_acquire);
 }
 
 const uint8_t* ConcurrentArrayInvertedLists::get_codes(size_t list_no) const {
@@ -530,6 +560,7 @@ const uint8_t* ConcurrentArrayInvertedLists::get_codes(size_t list_no) const {
 const idx_t* ConcurrentArrayInvertedLists::get_ids(size_t list_no) const {
     FAISS_THROW_MSG("not implemented get_ids for non-continuous storage");
 }
+
 size_t ConcurrentArrayInvertedLists::add_entries(
         size_t list_no,
         size_t n_entry,
@@ -540,83 +571,31 @@ size_t ConcurrentArrayInvertedLists::add_entries(
         return 0;
 
     assert(list_no < nlist);
-    size_t o = list_size(list_no);
+    List& l = lists[list_no];
+    // the adds to a list are serialized, no one else writes the size
+    size_t o = l.size.load(std::memory_order_relaxed);
 
     reserve(list_no, o + n_entry);
 
-    int64_t first_id  = o / segment_size;
-    int64_t first_cur = o % segment_size;
-
-    if (first_cur + n_entry <= segment_size) {
-        std::memcpy(&ids[list_no][first_id][first_cur], ids_in, n_entry * sizeof(ids_in[0]));
+    for (size_t entry_cur = 0; entry_cur < n_entry;) {
+        const size_t offset = o + entry_cur;
+        const Segment& segment = get_segment(list_no, offset / segment_size);
+        const size_t segment_off = offset % segment_size;
+        const size_t n = std::min(segment_size - segment_off, n_entry - entry_cur);
+        memcpy(segment.ids + segment_off, ids_in + entry_cur, n * sizeof(idx_t));
         if (save_norm) {
-            std::memcpy(
-                    &code_norms[list_no][first_id][first_cur],
-                    code_norms_in,
-                    n_entry * sizeof(float));
+            memcpy(segment.code_norms + segment_off,
+                   code_norms_in + entry_cur,
+                   n * sizeof(float));
         }
-        std::memcpy(&codes[list_no][first_id][first_cur], codes_in, n_entry * code_size);
-        list_cur[list_no].fetch_add(n_entry);
-        return o;
-    }
-
-    //process first segment
-    int64_t first_rest = segment_size - first_cur;
-    memcpy(&ids[list_no][first_id][first_cur],
-           ids_in,
-           first_rest * sizeof(ids_in[0]));
-    if (save_norm) {
-        memcpy(&code_norms[list_no][first_id][first_cur],
-           code_norms_in,
-           first_rest * sizeof(float));
+        memcpy(segment.codes + segment_off * code_size,
+               codes_in + entry_cur * code_size,
+               n * code_size);
+        entry_cur += n;
     }
-    memcpy(&codes[list_no][first_id][first_cur],
-           codes_in,
-           first_rest * code_size);
-    list_cur[list_no].fetch_add(first_rest);
-
-    auto rest_entry = n_entry - first_rest;
-    auto entry_cur  = first_rest;
-    auto segment_id = first_id;
-    //process rest segment
-    while (rest_entry > 0) {
-        segment_id = segment_id + 1;
-        if (rest_entry >= segment_size) {
-            memcpy(&codes[list_no][segment_id][0],
-                   codes_in + entry_cur * code_size,
-                   segment_size * code_size);
-            if (save_norm) {
-                memcpy(&code_norms[list_no][segment_id][0],
-                       code_norms_in + entry_cur,
-                       segment_size * sizeof(code_norms_in[0]));
-            }
-            memcpy(&ids[list_no][segment_id][0],
-                   ids_in + entry_cur,
-                   segment_size * sizeof(ids_in[0]));
-            list_cur[list_no].fetch_add(segment_size);
-
-            entry_cur += segment_size;
-            rest_entry -= segment_size;
-        } else {
-            memcpy(&codes[list_no][segment_id][0],
-                   codes_in + entry_cur * code_size,
-                   rest_entry * code_size);
-            if (save_norm) {
-                memcpy(&code_norms[list_no][segment_id][0],
-                       code_norms_in + entry_cur,
-                       rest_entry * sizeof(float));
-            }
-            memcpy(&ids[list_no][segment_id][0],
-                   ids_in + entry_cur,
-                   rest_entry * sizeof(ids_in[0]));
-            list_cur[list_no].fetch_add(rest_entry);
 
-            entry_cur += rest_entry;
-            rest_entry -= rest_entry;
-        }
-    }
-    assert(entry_cur == n_entry);
-    assert(rest_entry == 0);
+    // publish the entries at once
+    l.size.store(o + n_entry, std::memory_order_release);
     return o;
 }
 
@@ -633,53 +612,17 @@ void ConcurrentArrayInvertedLists::update_entries(
     assert(list_no < nlist);
     assert(n_entry + offset <= list_size(list_no));
 
-    size_t  first_id  = offset / segment_size;
-    int64_t first_cur = offset % segment_size;
-    int64_t first_rest = segment_size - first_cur;
-
-    if (n_entry <= first_rest) {
-        memcpy(&ids[list_no][first_id][first_cur], ids_in, n_entry * sizeof(ids_in[0]));
-        memcpy(&codes[list_no][first_id][first_cur], codes_in, n_entry * code_size);
-        return ;
-    }
-
-    // update first segment
-    memcpy(&ids[list_no][first_id][first_cur],
-           ids_in,
-           first_rest * sizeof(ids_in[0]));
-    memcpy(&codes[list_no][first_id][first_cur],
-           codes_in,
-           first_rest * code_size);
-
-    auto rest_entry = n_entry - first_rest;
-    auto entry_cur = first_rest;
-    auto segment_id = first_id;
-    while (rest_entry > 0) {
-        segment_id = segment_id + 1;
-        if (rest_entry >= segment_size) {
-            memcpy(&codes[list_no][segment_id][0],
-                   codes_in + entry_cur * code_size,
-                   segment_size * code_size);
-            memcpy(&ids[list_no][segment_id][0],
-                   ids_in + entry_cur,
-                   segment_size * sizeof(ids_in[0]));
-
-            entry_cur += segment_size;
-            rest_entry -= segment_size;
-        } else {
-            memcpy(&codes[list_no][segment_id][0],
-                   codes_in + entry_cur * code_size,
-                   rest_entry * code_size);
-            memcpy(&ids[list_no][segment_id][0],
-                   ids_in + entry_cur,
-                   rest_entry * sizeof(ids_in[0]));
-
-            entry_cur += rest_entry;
-            rest_entry -= rest_entry;
-        }
+    for (size_t entry_cur = 0; entry_cur < n_entry;) {
+        const size_t entry_off = offset + entry_cur;
+        const Segment& segment = get_segment(list_no, entry_off / segment_size);
+        const size_t segment_off = entry_off % segment_size;
+        const size_t n = std::min(segment_size - segment_off, n_entry - entry_cur);
+        memcpy(segment.ids + segment_off, ids_in + entry_cur, n * sizeof(idx_t));
+        memcpy(segment.codes + segment_off * code_size,
+               codes_in + entry_cur * code_size,
+               n * code_size);
+        entry_cur += n;
     }
-    assert(entry_cur == n_entry);
-    assert(rest_entry == 0);
 }
 
 InvertedLists* ConcurrentArrayInvertedLists::to_readonly() {
@@ -687,6 +630,12 @@ InvertedLists* ConcurrentArrayInvertedLists::to_readonly() {
 }
 
 ConcurrentArrayInvertedLists::~ConcurrentArrayInvertedLists() {
+    for (size_t i = 0; i < nlist; i++) {
+        shrink_to_fit(i, 0);
+        for (auto& bucket : lists[i].buckets) {
+            delete[] bucket.load(std::memory_order_relaxed);
+        }
+    }
 }
 
 void ConcurrentArrayInvertedLists::resize(size_t list_no, size_t new_size) {
@@ -694,23 +643,20 @@ void ConcurrentArrayInvertedLists::resize(size_t list_no, size_t new_size) {
 
     if (new_size >= o) {
         reserve(list_no, new_size);
-        list_cur[list_no].store(new_size);
+        lists[list_no].size.store(new_size, std::memory_order_release);
     } else {
-        list_cur[list_no].store(new_size);
+        lists[list_no].size.store(new_size, std::memory_order_release);
         shrink_to_fit(list_no, new_size);
     }
 
 }
 size_t ConcurrentArrayInvertedLists::get_segment_num(size_t list_no) const {
-    assert(list_no < nlist);
-    auto o = list_cur[list_no].load();
-    return (o / segment_size) + (o % segment_size != 0);
+    return cal_segment_num(list_size(list_no));
 }
 size_t ConcurrentArrayInvertedLists::get_segment_size(
         size_t list_no,
         size_t segment_no) const {
-    assert(list_no < nlist);
-    auto o = list_cur[list_no].load();
+    auto o = list_size(list_no);
     if (segment_no == 0 && o == 0) {
         return 0;
     }
@@ -726,30 +672,23 @@ size_t ConcurrentArrayInvertedLists::get_segment_size(
 size_t ConcurrentArrayInvertedLists::get_segment_offset(
         size_t list_no,
         size_t segment_no) const {
-    assert(list_no < nlist);
-    auto o = list_cur[list_no].load();
-    auto seg_o = cal_segment_num(o);
-    assert(segment_no < seg_o);
+    assert(segment_no < get_segment_num(list_no));
     return segment_size * segment_no;
 }
 const uint8_t* ConcurrentArrayInvertedLists::get_codes(
         size_t list_no,
         size_t offset) const {
-    assert(list_no < nlist);
     assert(offset < list_size(list_no));
-    auto segment_no = offset / segment_size;
-    auto segment_off = offset % segment_size;
-    return reinterpret_cast<const uint8_t *>(&(codes[list_no][segment_no][segment_off]));
+    const Segment& segment = get_segment(list_no, offset / segment_size);
+    return segment.codes + (offset % segment_size) * code_size;
 }
 
 const idx_t* ConcurrentArrayInvertedLists::get_ids(
         size_t list_no,
         size_t offset) const {
-    assert(list_no < nlist);
     assert(offset < list_size(list_no));
-    auto segment_no = offset / segment_size;
-    auto segment_off = offset % segment_size;
-    return reinterpret_cast<const idx_t *>(&(ids[list_no][segment_no][segment_off]));
+    const Segment& segment = get_segment(list_no, offset / segment_size);
+    return segment.ids + offset % segment_size;
 }
 
 
@@ -771,11 +710,9 @@ const float* ConcurrentArrayInvertedLists::get_code_norms(
     if (!save_norm) {
         return nullptr;
     } else {
-        assert(list_no < nlist);
         assert(offset < list_size(list_no));
-        auto segment_no = offset / segment_size;
-        auto segment_off = offset % segment_size;
-        return &(code_norms[list_no][segment_no][segment_off]);
+        const Segment& segment = get_segment(list_no, offset / segment_size);
+        return segment.code_norms + offset % segment_size;
     }
 }
 void ConcurrentArrayInvertedLists::release_code_norms(
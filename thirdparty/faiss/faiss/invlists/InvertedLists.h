@@ -381,24 +381,38 @@ struct ArrayInvertedLists : InvertedLists {
     ~ArrayInvertedLists() override;
 };
 
-// A Concurrent implementation for inverted lists
+/** A Concurrent implementation for inverted lists, for indexes that are
+ * searched while they grow.
+ *
+ * Each list is an append-only chain of fixed-size segments of segment_size
+ * entries. A segment is allocated once and never moved, and the list size is
+ * published with a release store after the entries and segments it covers are
+ * written, so that a search that reads it with an acquire load never blocks
+ * and never sees a partial entry. The segments of a list are found in O(1)
+ * through a directory of buckets, bucket b holding the addresses of 2^b
+ * segments, which never moves either.
+ *
+ * The adds to different lists can run in parallel, the adds to the same list
+ * must be serialized by the caller, as IndexIVF::add_core does. Shrinking a
+ * list, update_entries and the destruction are not safe against concurrent
+ * searches.
+ */
 struct ConcurrentArrayInvertedLists : InvertedLists {
-    template <typename T>
+    /// the entries of one segment, in a single allocation
     struct Segment {
-        Segment(size_t segment_size, size_t code_size) : segment_size_(segment_size), code_size_(code_size) {
-            data_.reserve(segment_size_ * code_size_);
-        }
-        T& operator[](idx_t idx) {
-            assert(idx < segment_size_);
-            return data_[idx * code_size_];
-        }
-        const T& operator[](idx_t idx) const {
-            assert(idx < segment_size_);
-            return data_[idx * code_size_];
-        }
-        size_t segment_size_;
-        size_t code_size_;
-        std::vector<T> data_;
+        idx_t* ids = nullptr;
+        float* code_norms = nullptr; ///< nullptr if the norms are not saved
+        uint8_t* codes = nullptr;
+    };
+
+    /// 2^max_buckets - 1 segments per list at most
+    static constexpr size_t max_buckets = 32;
+
+    struct List {
+        std::atomic<size_t> size{0};
+        /// the number of allocated segments, only used by the writers
+        size_t n_segments = 0;
+        std::atomic<Segment*> buckets[max_buckets] = {};
     };
 
     ConcurrentArrayInvertedLists(size_t nlist, size_t code_size, size_t segment_size, bool save_normal);
@@ -407,6 +421,9 @@ struct ConcurrentArrayInvertedLists : InvertedLists {
     void reserve(size_t list_no, size_t capacity);
     void shrink_to_fit(size_t list_no, size_t capacity);
 
+    /// the segment segment_no of a list, that must have been reserved
+    const Segment& get_segment(size_t list_no, size_t segment_no) const;
+
     size_t list_size(size_t list_no) const override;
     const uint8_t* get_codes(size_t list_no) const override;
     const idx_t* get_ids(size_t list_no) const override;
@@ -447,10 +464,7 @@ struct ConcurrentArrayInvertedLists : InvertedLists {
 
     size_t segment_size;
     bool save_norm;
-    std::vector<std::atomic<size_t>> list_cur;
-    std::vector<std::deque<Segment<uint8_t>>> codes;
-    std::vector<std::deque<Segment<idx_t>>> ids;
-    std::vector<std::deque<Segment<float>>> code_norms;
+    std::unique_ptr<List[]> lists;
 };
 
 struct ReadOnlyArrayInvertedLists: InvertedLists {
@@ -11,6 +11,7 @@
 #include <faiss/impl/io.h>
 #include <faiss/impl/io_macros.h>
 
+#include <faiss/invlists/ArenaInvertedLists.h>
 #include <faiss/invlists/BlockInvertedLists.h>
 
 #ifndef _MSC_VER
@@ -37,6 +38,7 @@ struct IOHookTable : std::vector<InvertedListsIOHook*> {
         push_back(new OnDiskInvertedListsIOHook());
 #endif
         push_back(new BlockInvertedListsIOHook());
+        push_back(new ArenaInvertedListsIOHook());
     }
 
     ~IOHookTable() {
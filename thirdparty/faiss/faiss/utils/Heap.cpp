@@ -9,8 +9,12 @@
 
 /* Function for soft heap */
 
+#include <algorithm>
+#include <vector>
+
 #include <faiss/impl/FaissAssert.h>
 #include <faiss/utils/Heap.h>
+#include <faiss/utils/partitioning.h>
 
 namespace faiss {
 
@@ -250,6 +254,15 @@ INSTANTIATE(CMax, int32_t);
 /**********************************************************
  * reorder_2_heaps
  **********************************************************/
+
+namespace {
+
+// from this k on, the k best of the k_base results are selected with a
+// partition rather than pushed one by one into a heap of size k
+constexpr size_t reorder_2_heaps_min_k_partition = 256;
+
+} // namespace
+
 /** reduce two results: k_base result<base_labels, base_distances> and
  * k result<labels, distances> to k result<labels, distances>
  */
@@ -262,18 +275,51 @@ void reorder_2_heaps(
         size_t k_base,
         const typename C::TI* __restrict base_labels,
         const float* __restrict base_distances) {
+    if (k < reorder_2_heaps_min_k_partition || k_base < k) {
 #pragma omp parallel for if (n > 1)
-    for (size_t i = 0; i < n; i++) {
-        typename C::TI* idxo = labels + i * k;
-        float* diso = distances + i * k;
-        const typename C::TI* idxi = base_labels + i * k_base;
-        const float* disi = base_distances + i * k_base;
-
-        heap_heapify<C>(k, diso, idxo, disi, idxi, k);
-        if (k_base != k) { // add remaining elements
-            heap_addn<C>(k, diso, idxo, disi + k, idxi + k, k_base - k);
+        for (size_t i = 0; i < n; i++) {
+            typename C::TI* idxo = labels + i * k;
+            float* diso = distances + i * k;
+            const typename C::TI* idxi = base_labels + i * k_base;
+            const float* disi = base_distances + i * k_base;
+
+            heap_heapify<C>(k, diso, idxo, disi, idxi, k);
+            if (k_base != k) { // add remaining elements
+                heap_addn<C>(k, diso, idxo, disi + k, idxi + k, k_base - k);
+            }
+            heap_reorder<C>(k, diso, idxo);
+        }
+        return;
+    }
+
+#pragma omp parallel if (n > 1)
+    {
+        // the partition overwrites its input
+        std::vector<float> dis_buf(k_base);
+        std::vector<typename C::TI> ids_buf(k_base);
+        std::vector<size_t> order(k);
+#pragma omp for
+        for (size_t i = 0; i < n; i++) {
+            typename C::TI* idxo = labels + i * k;
+            float* diso = distances + i * k;
+            std::copy_n(base_distances + i * k_base, k_base, dis_buf.data());
+            std::copy_n(base_labels + i * k_base, k_base, ids_buf.data());
+            if (k_base > k) {
+                partition<C>(dis_buf.data(), ids_buf.data(), k_base, k);
+            }
+            // the best first, as heap_reorder leaves them
+            for (size_t j = 0; j < k; j++) {
+                order[j] = j;
+            }
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return C::cmp2(
+                        dis_buf[b], dis_buf[a], ids_buf[b], ids_buf[a]);
+            });
+            for (size_t j = 0; j < k; j++) {
+                diso[j] = dis_buf[order[j]];
+                idxo[j] = ids_buf[order[j]];
+            }
         }
-        heap_reorder<C>(k, diso, idxo);
     }
 }
 template void reorder_2_heaps<CMax<float, int64_t>>(
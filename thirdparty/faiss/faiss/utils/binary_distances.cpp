@@ -103,6 +103,10 @@ int xor_popcnt(
         const uint8_t* data1,
         const uint8_t* data2,
         const size_t code_size) {
+    // see bvec_jaccard
+    if (code_size >= 32) {
+        return bvec_hamming_distance(data1, data2, code_size);
+    }
     // todo aguzhva: improve this code, maybe reuse the code from hamming.h
 #define fun_u64 accu += popcount64(a[i] ^ b[i]);
 #define fun_u8(i) accu += lookup8bit[a[i] ^ b[i]];
@@ -164,6 +168,11 @@ float bvec_jaccard(
         const uint8_t* data1,
         const uint8_t* data2,
         const size_t code_size) {
+    // the short codes are faster on the unrolled loop, which has no vector
+    // reduction to pay for
+    if (code_size >= 32) {
+        return bvec_jaccard_distance(data1, data2, code_size);
+    }
     // todo aguzhva: improve this code, maybe reuse the code from hamming.h
 #define fun_u64                          \
     accu_num += popcount64(a[i] & b[i]); \
@@ -360,6 +369,16 @@ void binary_knn_mc(
     }
 }
 
+// the computers on the simd hooks take four codes at a time
+template <class MetricComputer, class = void>
+struct has_compute_batch_4 : std::false_type {};
+
+template <class MetricComputer>
+struct has_compute_batch_4<
+        MetricComputer,
+        std::void_t<decltype(&MetricComputer::compute_batch_4)>>
+        : std::true_type {};
+
 template <class C, class MetricComputer>
 void binary_knn_hc(
         int bytes_per_code,
@@ -462,16 +481,52 @@ void binary_knn_hc(
             for (size_t i = 0; i < ha->nh; i++) {
                 MetricComputer hc(bs1 + i * bytes_per_code, bytes_per_code);
 
-                const uint8_t* bs2_ = bs2 + j0 * bytes_per_code;
-                T dis;
                 T* __restrict bh_val_ = ha->val + i * k;
                 int64_t* __restrict bh_ids_ = ha->ids + i * k;
-                for (size_t j = j0; j < j1; j++, bs2_ += bytes_per_code) {
-                    if (!sel || sel->is_member(j)) {
-                        dis = hc.compute(bs2_);
-                        if (C::cmp(bh_val_[0], dis)) {
+                if constexpr (has_compute_batch_4<MetricComputer>::value) {
+                    auto add = [&](const size_t j, const T dis_j) {
+                        if (C::cmp(bh_val_[0], dis_j)) {
                             faiss::heap_replace_top<C>(
-                                    k, bh_val_, bh_ids_, dis, j);
+                                    k, bh_val_, bh_ids_, dis_j, j);
+                        }
+                    };
+                    // the codes the selector lets through, four at a time
+                    size_t ids[4];
+                    size_t n_ids = 0;
+                    for (size_t j = j0; j < j1; j++) {
+                        if (!sel || sel->is_member(j)) {
+                            ids[n_ids++] = j;
+                            if (n_ids == 4) {
+                                decltype(hc.compute(bs2)) dis_4[4];
+                                hc.compute_batch_4(
+                                        bs2 + ids[0] * bytes_per_code,
+                                        bs2 + ids[1] * bytes_per_code,
+                                        bs2 + ids[2] * bytes_per_code,
+                                        bs2 + ids[3] * bytes_per_code,
+                                        dis_4[0],
+                                        dis_4[1],
+                                        dis_4[2],
+                                        dis_4[3]);
+                                for (size_t t = 0; t < 4; t++) {
+                                    add(ids[t], dis_4[t]);
+                                }
+                                n_ids = 0;
+                            }
+                        }
+                    }
+                    for (size_t t = 0; t < n_ids; t++) {
+                        add(ids[t], hc.compute(bs2 + ids[t] * bytes_per_code));
+                    }
+                } else {
+                    const uint8_t* bs2_ = bs2 + j0 * bytes_per_code;
+                    T dis;
+                    for (size_t j = j0; j < j1; j++, bs2_ += bytes_per_code) {
+                        if (!sel || sel->is_member(j)) {
+                            dis = hc.compute(bs2_);
+                            if (C::cmp(bh_val_[0], dis)) {
+                                faiss::heap_replace_top<C>(
+                                        k, bh_val_, bh_ids_, dis, j);
+                            }
                         }
                     }
                 }
@@ -503,10 +558,9 @@ void binary_knn_hc(
                     binary_knn_hc_jaccard(16);
                     binary_knn_hc_jaccard(32);
                     binary_knn_hc_jaccard(64);
-                    binary_knn_hc_jaccard(128);
-                    binary_knn_hc_jaccard(256);
-                    binary_knn_hc_jaccard(512);
 #undef binary_knn_hc_jaccard
+                    // the simd hook beats the unrolled computers from 128
+                    // bytes on
                     default:
                         binary_knn_hc<C, faiss::JaccardComputerDefault>(
                                 ncodes, ha, a, b, nb, sel);
@@ -532,8 +586,13 @@ void binary_knn_hc(
                     binary_knn_hc_hamming(64);
 #undef binary_knn_hc_hamming
                     default:
-                        binary_knn_hc<C, faiss::HammingComputerDefault>(
-                                ncodes, ha, a, b, nb, sel);
+                        if (ncodes > 64) {
+                            binary_knn_hc<C, faiss::HammingComputerHook>(
+                                    ncodes, ha, a, b, nb, sel);
+                        } else {
+                            binary_knn_hc<C, faiss::HammingComputerDefault>(
+                                    ncodes, ha, a, b, nb, sel);
+                        }
                         break;
                 }
             }
@@ -617,9 +676,6 @@ void binary_range_search(
                     binary_range_search_jaccard(16);
                     binary_range_search_jaccard(32);
                     binary_range_search_jaccard(64);
-                    binary_range_search_jaccard(128);
-                    binary_range_search_jaccard(256);
-                    binary_range_search_jaccard(512);
 #undef binary_range_search_jaccard
                     default:
                         binary_range_search<
@@ -649,11 +705,19 @@ void binary_range_search(
                     binary_range_search_hamming(64);
 #undef binary_range_search_hamming
                     default:
-                        binary_range_search<
-                                C,
-                                T,
-                                faiss::HammingComputerDefault>(
-                                a, b, na, nb, radius, code_size, res, sel);
+                        if (code_size > 64) {
+                            binary_range_search<
+                                    C,
+                                    T,
+                                    faiss::HammingComputerHook>(
+                                    a, b, na, nb, radius, code_size, res, sel);
+                        } else {
+                            binary_range_search<
+                                    C,
+                                    T,
+                                    faiss::HammingComputerDefault>(
+                                    a, b, na, nb, radius, code_size, res, sel);
+                        }
                         break;
                 }
             }
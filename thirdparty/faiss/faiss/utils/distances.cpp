@@ -79,6 +79,22 @@ void fvec_norms_L2sqr(
         nr[i] = fvec_norm_L2sqr(x + i * d, d);
 }
 
+float fvec_inverse_norm_L2(const float* x, size_t d) {
+    const float norm = sqrtf(fvec_norm_L2sqr(x, d));
+    return (norm == 0.0f) ? 1.0f : (1.0f / norm);
+}
+
+void fvec_inverse_norms_L2(
+        float* __restrict nr,
+        const float* __restrict x,
+        size_t d,
+        size_t nx) {
+#pragma omp parallel for if (nx > 10000)
+    for (int64_t i = 0; i < nx; i++) {
+        nr[i] = fvec_inverse_norm_L2(x + i * d, d);
+    }
+}
+
 // The following is a workaround to a problem
 // in OpenMP in fbcode. The crash occurs
 // inside OMP when IndexIVFSpectralHash::set_query()
@@ -393,7 +409,7 @@ template <class BlockResultHandler>
 void exhaustive_cosine_seq(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -412,11 +428,10 @@ void exhaustive_cosine_seq(
             resi.begin(i);
             for (size_t j = 0; j < ny; j++) {
                 if (!sel || sel->is_member(j)) {
-                    // todo aguzhva: what if a norm == 0 ?
-                    float norm =
-                        (y_norms != nullptr) ? y_norms[j]
-                                             : sqrtf(fvec_norm_L2sqr(y_j, d));
-                    float disij = fvec_inner_product(x_i, y_j, d) / norm;
+                    float inverse_norm = (y_inverse_norms != nullptr)
+                            ? y_inverse_norms[j]
+                            : fvec_inverse_norm_L2(y_j, d);
+                    float disij = fvec_inner_product(x_i, y_j, d) * inverse_norm;
                     resi.add_result(disij, j);
                 }
                 y_j += d;
@@ -434,7 +449,7 @@ template <class BlockResultHandler, class SelectorHelper>
 void exhaustive_cosine_seq_impl(
         const float* __restrict x,
         const float* __restrict y,
-        const float* __restrict y_norms,
+        const float* __restrict y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -457,13 +472,11 @@ void exhaustive_cosine_seq_impl(
             };
 
             // the lambda that applies a filtered element.
-            auto apply = [&resi, y, y_norms, d](const float ip, const idx_t j) {
-                float norm =
-                    (y_norms != nullptr) ? 
-                        y_norms[j] : 
-                        sqrtf(fvec_norm_L2sqr(y + j * d, d));
-                norm = (norm == 0.0 ? 1.0 : norm);
-                resi.add_result(ip / norm, j);
+            auto apply = [&resi, y, y_inverse_norms, d](const float ip, const idx_t j) {
+                const float inverse_norm = (y_inverse_norms != nullptr)
+                        ? y_inverse_norms[j]
+                        : fvec_inverse_norm_L2(y + j * d, d);
+                resi.add_result(ip * inverse_norm, j);
             };
 
             // compute distances
@@ -478,7 +491,7 @@ template <class BlockResultHandler>
 void exhaustive_cosine_seq(
         const float* __restrict x,
         const float* __restrict y,
-        const float* __restrict y_norms,
+        const float* __restrict y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -494,7 +507,7 @@ void exhaustive_cosine_seq(
         if (!bitset.empty()) {
             BitsetViewSelectorHelper bitset_helper{bitset};
             exhaustive_cosine_seq_impl<BlockResultHandler, BitsetViewSelectorHelper>(
-                x, y, y_norms, d, nx, ny, res, bitset_helper);
+                x, y, y_inverse_norms, d, nx, ny, res, bitset_helper);
             return;
         }
     }
@@ -502,14 +515,14 @@ void exhaustive_cosine_seq(
         // default Faiss case if sel is defined
         IDSelectorHelper ids_helper{res.sel};
         exhaustive_cosine_seq_impl<BlockResultHandler, IDSelectorHelper>(
-            x, y, y_norms, d, nx, ny, res, ids_helper);
+            x, y, y_inverse_norms, d, nx, ny, res, ids_helper);
         return;
     }
 
     // default case if no filter is needed or if it is empty
     IDSelectorAll helper;
     exhaustive_cosine_seq_impl<BlockResultHandler, IDSelectorAll>(
-        x, y, y_norms, d, nx, ny, res, helper);
+        x, y, y_inverse_norms, d, nx, ny, res, helper);
 }
 
 
@@ -657,7 +670,7 @@ template <class BlockResultHandler>
 void exhaustive_cosine_blas(
         const float* x,
         const float* y,
-        const float* y_norms_in,
+        const float* y_inverse_norms_in,
         size_t d,
         size_t nx,
         size_t ny,
@@ -671,11 +684,13 @@ void exhaustive_cosine_blas(
     const size_t bs_y = distance_compute_blas_database_bs;
     // const size_t bs_x = 16, bs_y = 16;
     std::unique_ptr<float[]> ip_block(new float[bs_x * bs_y]);
-    std::unique_ptr<float[]> y_norms(new float[ny]);
     std::unique_ptr<float[]> del2;
+    const float* y_inverse_norms = y_inverse_norms_in;
 
-    if (y_norms_in == nullptr) {
-        fvec_norms_L2(y_norms.get(), y, d, ny);
+    if (y_inverse_norms == nullptr) {
+        del2.reset(new float[ny]);
+        fvec_inverse_norms_L2(del2.get(), y, d, ny);
+        y_inverse_norms = del2.get();
     }
 
     for (size_t i0 = 0; i0 < nx; i0 += bs_x) {
@@ -712,11 +727,7 @@ void exhaustive_cosine_blas(
                 float* ip_line = ip_block.get() + (i - i0) * (j1 - j0);
 
                 for (size_t j = j0; j < j1; j++) {
-                    float ip = *ip_line;
-                    float norm = (y_norms_in != nullptr) ? y_norms_in[j]
-                                                         : y_norms[j];
-                    norm = (norm == 0.0 ? 1.0 : norm);
-                    *ip_line = ip / norm;
+                    *ip_line *= y_inverse_norms[j];
                     ip_line++;
                 }
             }
@@ -844,15 +855,15 @@ template <class BlockResultHandler>
 void knn_cosine_select(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
         BlockResultHandler& res) {
     if (res.sel || nx < distance_compute_blas_threshold) {
-        exhaustive_cosine_seq<BlockResultHandler>(x, y, y_norms, d, nx, ny, res);
+        exhaustive_cosine_seq<BlockResultHandler>(x, y, y_inverse_norms, d, nx, ny, res);
     } else {
-        exhaustive_cosine_blas<BlockResultHandler>(x, y, y_norms, d, nx, ny, res);
+        exhaustive_cosine_blas<BlockResultHandler>(x, y, y_inverse_norms, d, nx, ny, res);
     }
 }
 
@@ -1104,6 +1115,30 @@ void knn_L2sqr(
     knn_L2sqr(x, y, d, nx, ny, res->k, res->val, res->ids, y_norm2, sel);
 }
 
+void knn_L2sqr_blas(
+        const float* x,
+        const float* y,
+        size_t d,
+        size_t nx,
+        size_t ny,
+        size_t k,
+        float* vals,
+        int64_t* ids,
+        const float* y_norm2) {
+    if (k == 1) {
+        Top1BlockResultHandler<CMax<float, int64_t>, false> res(nx, vals, ids);
+        exhaustive_L2sqr_blas(x, y, d, nx, ny, res, y_norm2);
+    } else if (k < distance_compute_min_k_reservoir) {
+        HeapBlockResultHandler<CMax<float, int64_t>, false> res(
+                nx, vals, ids, k);
+        exhaustive_L2sqr_blas(x, y, d, nx, ny, res, y_norm2);
+    } else {
+        ReservoirBlockResultHandler<CMax<float, int64_t>, false> res(
+                nx, vals, ids, k);
+        exhaustive_L2sqr_blas(x, y, d, nx, ny, res, y_norm2);
+    }
+}
+
 // computes and stores all L2 distances into output. Output should be
 // preallocated of size nx * ny, each element should be initialized to
 // {lowest distance, -1}.
@@ -1136,7 +1171,7 @@ void all_L2sqr(
 void knn_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -1150,11 +1185,14 @@ void knn_cosine(
         int64_t imax = std::min(selr->imax, int64_t(ny));
         ny = imax - imin;
         y += d * imin;
+        if (y_inverse_norms != nullptr) {
+            y_inverse_norms += imin;
+        }
         sel = nullptr;
     }
     if (auto sela = dynamic_cast<const IDSelectorArray*>(sel)) {
         knn_cosine_by_idx(
-                x, y, y_norms, sela->ids, d, nx, ny, sela->n, k, vals, ids, 0);
+                x, y, y_inverse_norms, sela->ids, d, nx, ny, sela->n, k, vals, ids, 0);
         return;
     }
 
@@ -1162,23 +1200,23 @@ void knn_cosine(
     // //   some dynamic kernel dispatching.
     // if (k == 1) {
     //     Top1BlockResultHandler<CMin<float, int64_t>> res(nx, vals, ids);
-    //     knn_cosine_select(x, y, y_norms, d, nx, ny, res, sel);
+    //     knn_cosine_select(x, y, y_inverse_norms, d, nx, ny, res, sel);
     // } else 
     if (k < distance_compute_min_k_reservoir) {
         if (sel == nullptr) {
             HeapBlockResultHandler<CMin<float, int64_t>, false> res(nx, vals, ids, k);
-            knn_cosine_select(x, y, y_norms, d, nx, ny, res);
+            knn_cosine_select(x, y, y_inverse_norms, d, nx, ny, res);
         } else {
             HeapBlockResultHandler<CMin<float, int64_t>, true> res(nx, vals, ids, k, sel);
-            knn_cosine_select(x, y, y_norms, d, nx, ny, res);
+            knn_cosine_select(x, y, y_inverse_norms, d, nx, ny, res);
         }
     } else {
         if (sel == nullptr) {
             ReservoirBlockResultHandler<CMin<float, int64_t>, false> res(nx, vals, ids, k);
-            knn_cosine_select(x, y, y_norms, d, nx, ny, res);
+            knn_cosine_select(x, y, y_inverse_norms, d, nx, ny, res);
         } else {
             ReservoirBlockResultHandler<CMin<float, int64_t>, true> res(nx, vals, ids, k, sel);
-            knn_cosine_select(x, y, y_norms, d, nx, ny, res);
+            knn_cosine_select(x, y, y_inverse_norms, d, nx, ny, res);
         }
     }
 
@@ -1194,14 +1232,14 @@ void knn_cosine(
 void knn_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
         float_minheap_array_t* res,
         const IDSelector* sel) {
     FAISS_THROW_IF_NOT(nx == res->nh);
-    knn_cosine(x, y, y_norms, d, nx, ny, res->k, res->val, res->ids, sel);
+    knn_cosine(x, y, y_inverse_norms, d, nx, ny, res->k, res->val, res->ids, sel);
 }
 
 // computes and stores all cosine distances into output. Output should be
@@ -1210,7 +1248,7 @@ void knn_cosine(
 void all_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -1219,16 +1257,16 @@ void all_cosine(
     if (sel == nullptr) {
         CollectAllResultHandler<CMax<float, int64_t>, false> res(nx, ny, output);
         if (nx < distance_compute_blas_threshold) {
-            exhaustive_cosine_seq(x, y, y_norms, d, nx, ny, res);
+            exhaustive_cosine_seq(x, y, y_inverse_norms, d, nx, ny, res);
         } else {
-            exhaustive_cosine_blas(x, y, y_norms, d, nx, ny, res);
+            exhaustive_cosine_blas(x, y, y_inverse_norms, d, nx, ny, res);
         }
     } else {
         CollectAllResultHandler<CMax<float, int64_t>, true> res(nx, ny, output, sel);
         if (nx < distance_compute_blas_threshold) {
-            exhaustive_cosine_seq(x, y, y_norms, d, nx, ny, res);
+            exhaustive_cosine_seq(x, y, y_inverse_norms, d, nx, ny, res);
         } else {
-            exhaustive_cosine_blas(x, y, y_norms, d, nx, ny, res);
+            exhaustive_cosine_blas(x, y, y_inverse_norms, d, nx, ny, res);
         }
     }
 }
@@ -1323,7 +1361,7 @@ void range_search_inner_product(
 void range_search_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -1333,16 +1371,16 @@ void range_search_cosine(
     if (sel == nullptr) {
         RangeSearchBlockResultHandler<CMin<float, int64_t>, false> resh(res, radius);
         if (nx < distance_compute_blas_threshold) {
-            exhaustive_cosine_seq(x, y, y_norms, d, nx, ny, resh);
+            exhaustive_cosine_seq(x, y, y_inverse_norms, d, nx, ny, resh);
         } else {
-            exhaustive_cosine_blas(x, y, y_norms, d, nx, ny, resh);
+            exhaustive_cosine_blas(x, y, y_inverse_norms, d, nx, ny, resh);
         }
     } else {
         RangeSearchBlockResultHandler<CMin<float, int64_t>, true> resh(res, radius, sel);
         if (nx < distance_compute_blas_threshold) {
-            exhaustive_cosine_seq(x, y, y_norms, d, nx, ny, resh);
+            exhaustive_cosine_seq(x, y, y_inverse_norms, d, nx, ny, resh);
         } else {
-            exhaustive_cosine_blas(x, y, y_norms, d, nx, ny, resh);
+            exhaustive_cosine_blas(x, y, y_inverse_norms, d, nx, ny, resh);
         }
     }
 }
@@ -1507,21 +1545,25 @@ void knn_inner_products_by_idx(
     for (int64_t i = 0; i < nx; i++) {
         const float* x_ = x + i * d;
         const int64_t* idsi = ids + i * ld_ids;
-        size_t j;
         float* __restrict simi = res_vals + i * k;
         int64_t* __restrict idxi = res_ids + i * k;
         minheap_heapify(k, simi, idxi);
 
-        for (j = 0; j < nsubset; j++) {
+        // the kernels pass the position in idsi, the batches of them share
+        // the loads of x_
+        auto filter = [idsi, ny](const size_t j) -> std::optional<bool> {
             if (idsi[j] < 0 || idsi[j] >= ny) {
-                break;
+                return std::nullopt;
             }
-            float ip = fvec_inner_product(x_, y + d * idsi[j], d);
-
+            return true;
+        };
+        auto apply = [simi, idxi, idsi, k](const float ip, const size_t j) {
             if (ip > simi[0]) {
                 minheap_replace_top(k, simi, idxi, ip, idsi[j]);
             }
-        }
+        };
+        fvec_inner_products_ny_by_idx_if(
+                x_, y, idsi, d, nsubset, filter, apply);
         minheap_reorder(k, simi, idxi);
     }
 }
@@ -1548,16 +1590,18 @@ void knn_L2sqr_by_idx(
         float* __restrict simi = res_vals + i * k;
         int64_t* __restrict idxi = res_ids + i * k;
         maxheap_heapify(k, simi, idxi);
-        for (size_t j = 0; j < nsubset; j++) {
+        auto filter = [idsi, ny](const size_t j) -> std::optional<bool> {
             if (idsi[j] < 0 || idsi[j] >= ny) {
-                break;
+                return std::nullopt;
             }
-            float disij = fvec_L2sqr(x_, y + d * idsi[j], d);
-
+            return true;
+        };
+        auto apply = [simi, idxi, idsi, k](const float disij, const size_t j) {
             if (disij < simi[0]) {
                 maxheap_replace_top(k, simi, idxi, disij, idsi[j]);
             }
-        }
+        };
+        fvec_L2sqr_ny_by_idx_if(x_, y, idsi, d, nsubset, filter, apply);
         maxheap_reorder(k, simi, idxi);
     }
 }
@@ -1565,7 +1609,7 @@ void knn_L2sqr_by_idx(
 void knn_cosine_by_idx(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         const int64_t* ids,
         size_t d,
         size_t nx,
@@ -1583,27 +1627,28 @@ void knn_cosine_by_idx(
     for (int64_t i = 0; i < nx; i++) {
         const float* x_ = x + i * d;
         const int64_t* idsi = ids + i * ld_ids;
-        size_t j;
         float* __restrict simi = res_vals + i * k;
         int64_t* __restrict idxi = res_ids + i * k;
         minheap_heapify(k, simi, idxi);
 
-        for (size_t j = 0; j < nsubset; j++) {
+        auto filter = [idsi, ny](const size_t j) -> std::optional<bool> {
             if (idsi[j] < 0 || idsi[j] >= ny) {
-                break;
+                return std::nullopt;
             }
-            float ip = fvec_inner_product(x_, y + d * idsi[j], d);
-            float norm =
-                (y_norms != nullptr) ? 
-                    y_norms[idsi[j]] : 
-                    sqrtf(fvec_norm_L2sqr(y + d * idsi[j], d));
-            norm = (norm == 0.0 ? 1.0 : norm);
-            ip /= norm;
+            return true;
+        };
+        auto apply = [simi, idxi, idsi, k, y, y_inverse_norms, d](
+                             float ip, const size_t j) {
+            ip *= (y_inverse_norms != nullptr)
+                    ? y_inverse_norms[idsi[j]]
+                    : fvec_inverse_norm_L2(y + d * idsi[j], d);
 
             if (ip > simi[0]) {
                 minheap_replace_top(k, simi, idxi, ip, idsi[j]);
             }
-        }
+        };
+        fvec_inner_products_ny_by_idx_if(
+                x_, y, idsi, d, nsubset, filter, apply);
         minheap_reorder(k, simi, idxi);
     }
 }
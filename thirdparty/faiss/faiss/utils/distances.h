@@ -58,6 +58,17 @@ void fvec_norms_L2(float* norms, const float* x, size_t d, size_t nx);
 /// same as fvec_norms_L2, but computes squared norms
 void fvec_norms_L2sqr(float* norms, const float* x, size_t d, size_t nx);
 
+/// inverse of the L2 norm of a vector, 1 for a 0-normed vector. The cosine
+/// functions take the inverse norms of the database vectors.
+float fvec_inverse_norm_L2(const float* x, size_t d);
+
+/// same as fvec_norms_L2, but computes inverse norms like fvec_inverse_norm_L2
+void fvec_inverse_norms_L2(
+        float* inverse_norms,
+        const float* x,
+        size_t d,
+        size_t nx);
+
 /* L2-renormalize a set of vector. Nothing done if the vector is 0-normed */
 void fvec_renorm_L2(size_t d, size_t nx, float* x);
 
@@ -297,6 +308,21 @@ void knn_L2sqr(
         const float* y_norm2 = nullptr,
         const IDSelector* sel = nullptr);
 
+/** Same as knn_L2sqr, but the distances are always computed with BLAS,
+ * including for k = 1, which knn_L2sqr computes a query at a time. Used to
+ * assign a large number of vectors to many centroids.
+ */
+void knn_L2sqr_blas(
+        const float* x,
+        const float* y,
+        size_t d,
+        size_t nx,
+        size_t ny,
+        size_t k,
+        float* distances,
+        int64_t* indexes,
+        const float* y_norm2 = nullptr);
+
 void all_L2sqr(
         const float* x,
         const float* y,
@@ -307,11 +333,12 @@ void all_L2sqr(
         const float* y_norms,
         const IDSelector* sel);
 
-// Knowhere-specific function
+// Knowhere-specific function. The cosine functions take the inverse norms of
+// the y vectors (see fvec_inverse_norms_L2), computed on the fly if nullptr.
 void knn_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -321,7 +348,7 @@ void knn_cosine(
 void knn_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -333,7 +360,7 @@ void knn_cosine(
 void all_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -399,7 +426,7 @@ void knn_L2sqr_by_idx(
 void knn_cosine_by_idx(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         const int64_t* subset,
         size_t d,
         size_t nx,
@@ -450,7 +477,7 @@ void range_search_inner_product(
 void range_search_cosine(
         const float* x,
         const float* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
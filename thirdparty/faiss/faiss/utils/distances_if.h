@@ -12,6 +12,7 @@
 
 #include <faiss/impl/DistanceComputer.h>
 #include <faiss/utils/distances.h>
+#include <faiss/utils/prefetch.h>
 #include "simd/hook.h"
 
 namespace faiss {
@@ -145,6 +146,30 @@ struct ByIdxRemapping {
     }    
 };
 
+// the number of indices by which ByIdxPrefetchRemapping prefetches ahead
+constexpr size_t BY_IDX_PREFETCH_DISTANCE = 16;
+
+// maps idx to indices[idx] like ByIdxRemapping and prefetches the vector
+//   BY_IDX_PREFETCH_DISTANCE indices ahead, because the gathered vectors
+//   are rarely in the cache.
+template<typename IdxT>
+struct ByIdxPrefetchRemapping {
+    const IdxT* const mapping;
+    const size_t n;
+    const char* const data;
+    const size_t code_size;
+    inline IdxT operator()(const size_t idx) const {
+        if (idx + BY_IDX_PREFETCH_DISTANCE < n) {
+            const char* code = data + 
+                mapping[idx + BY_IDX_PREFETCH_DISTANCE] * code_size;
+            for (size_t offset = 0; offset < code_size; offset += 64) {
+                prefetch_L1(code + offset);
+            }
+        }
+        return mapping[idx];
+    }
+};
+
 } // namespace
 
 /***************************************************************************
@@ -249,27 +274,36 @@ void internal_fvec_inner_products_ny_if(
         return fvec_inner_product(x, y + idx * d, d);
     };
 
-    // compute distances from the query to 4 elements
-    auto distance4 = [x, y, d](const std::array<idx_type, 4> indices, std::array<float, 4>& dis) { 
-        fvec_inner_product_batch_4(
+    // compute distances from the query to 8 elements, x is loaded once
+    //   for all of them
+    auto distance8 = [x, y, d](const std::array<idx_type, 8> indices, std::array<float, 8>& dis) { 
+        fvec_inner_product_batch_8(
             x,
             y + indices[0] * d,
             y + indices[1] * d,
             y + indices[2] * d,
             y + indices[3] * d,
+            y + indices[4] * d,
+            y + indices[5] * d,
+            y + indices[6] * d,
+            y + indices[7] * d,
             d,
             dis[0],
             dis[1],
             dis[2],
-            dis[3]
+            dis[3],
+            dis[4],
+            dis[5],
+            dis[6],
+            dis[7]
         );
     };
 
-    fvec_distance_ny_if<Pred, decltype(distance1), decltype(distance4), IndexRemapper, Apply, 4, DEFAULT_BUFFER_SIZE>(
+    fvec_distance_ny_if<Pred, decltype(distance1), decltype(distance8), IndexRemapper, Apply, 8, DEFAULT_BUFFER_SIZE>(
         ny,
         pred,
         distance1,
-        distance4,
+        distance8,
         remapper,
         apply
     );
@@ -453,7 +487,8 @@ void fvec_inner_products_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_fvec_inner_products_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -477,7 +512,8 @@ void fvec_L2sqr_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {    
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_fvec_L2sqr_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -805,7 +841,8 @@ void fp16_vec_inner_products_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_fp16_vec_inner_products_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -831,7 +868,8 @@ void fp16_vec_L2sqr_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_fp16_vec_L2sqr_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -1020,7 +1058,8 @@ void bf16_vec_inner_products_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_bf16_vec_inner_products_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -1046,7 +1085,8 @@ void bf16_vec_L2sqr_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_bf16_vec_L2sqr_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -1235,7 +1275,8 @@ void int8_vec_inner_products_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_int8_vec_inner_products_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -1261,7 +1302,8 @@ void int8_vec_L2sqr_ny_by_idx_if(
         const size_t ny,
         Pred pred,
         Apply apply) {
-    ByIdxRemapping<int64_t> remapper{ids};
+    ByIdxPrefetchRemapping<int64_t> remapper{
+            ids, ny, (const char*)y, d * sizeof(*y)};
     internal_int8_vec_L2sqr_ny_if(x, y, d, ny, pred, remapper, apply);
 }
 
@@ -13,7 +13,10 @@
 // the License
 
 #include <algorithm>
+#include <cmath>
+#include <memory>
 
+#include <faiss/impl/AuxIndexStructures.h>
 #include <faiss/impl/IDSelector.h>
 #include <faiss/impl/ResultHandler.h>
 #include <faiss/utils/distances.h>
@@ -22,7 +25,35 @@
 #include "knowhere/bitsetview_idselector.h"
 #include "knowhere/operands.h"
 #include "simd/hook.h"
+
+#ifndef FINTEGER
+#define FINTEGER long
+#endif
+
+extern "C" {
+
+/* declare BLAS functions, see http://www.netlib.org/clapack/cblas/ */
+
+int sgemm_(
+        const char* transa,
+        const char* transb,
+        FINTEGER* m,
+        FINTEGER* n,
+        FINTEGER* k,
+        const float* alpha,
+        const float* a,
+        FINTEGER* lda,
+        const float* b,
+        FINTEGER* ldb,
+        float* beta,
+        float* c,
+        FINTEGER* ldc);
+}
+
 namespace faiss {
+
+int distance_compute_typed_blas_threshold = 32;
+
 namespace {
 template <typename DataType, class BlockResultHandler, class IDSelector>
 void exhaustive_inner_product_impl_typed(
@@ -46,17 +77,21 @@ void exhaustive_inner_product_impl_typed(
             resi.add_result(ip, j);
         };
         if constexpr (std::is_same_v<IDSelector, IDSelectorArray>) {
-            // todo: need more tests about this branch
+            // the kernels pass the position in ids rather than the id
             auto filter = [](const size_t j) { return true; };
+            auto apply_by_idx = [&apply, &selector](
+                                        const float dis, const idx_t j) {
+                apply(dis, selector.ids[j]);
+            };
             if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
                 fp16_vec_inner_products_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector.n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
                 bf16_vec_inner_products_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector.n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             } else if constexpr (std::is_same_v<DataType, knowhere::int8>) {
                 int8_vec_inner_products_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector.n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             }
         } else {
             // the lambda that filters acceptable elements.
@@ -97,17 +132,21 @@ void exhaustive_L2sqr_seq_impl_typed(
             resi.add_result(ip, j);
         };
         if constexpr (std::is_same_v<IDSelector, IDSelectorArray>) {
-            // todo: need more tests about this branch
+            // the kernels pass the position in ids rather than the id
             auto filter = [](const size_t j) { return true; };
+            auto apply_by_idx = [&apply, &selector](
+                                        const float dis, const idx_t j) {
+                apply(dis, selector.ids[j]);
+            };
             if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
                 fp16_vec_L2sqr_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector->n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
                 bf16_vec_L2sqr_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector->n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             } else if constexpr (std::is_same_v<DataType, knowhere::int8>) {
                 int8_vec_L2sqr_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector->n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             }
         } else {
             // the lambda that filters acceptable elements.
@@ -130,7 +169,7 @@ template <typename DataType, class BlockResultHandler, class IDSelector>
 void exhaustive_cosine_seq_impl_typed(
         const DataType* __restrict x,
         const DataType* __restrict y,
-        const float* __restrict y_norms,
+        const float* __restrict y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -153,29 +192,35 @@ void exhaustive_cosine_seq_impl_typed(
         // distance div x_norm before pushing into the heap
         auto x_norm = sqrtf(norm_computer(x_i, d));
         x_norm = (x_norm == 0.0 ? 1.0 : x_norm);
-        auto apply = [&resi, x_norm, y, y_norms, d, norm_computer](
+        auto apply = [&resi, x_norm, y, y_inverse_norms, d, norm_computer](
                              const float ip, const idx_t j) {
-            float y_norm = (y_norms != nullptr)
-                    ? y_norms[j]
-                    : sqrtf(norm_computer(y + j * d, d));
-
-            y_norm = (y_norm == 0.0 ? 1.0 : y_norm);
-            resi.add_result(ip / (x_norm * y_norm), j);
+            float y_inverse_norm;
+            if (y_inverse_norms != nullptr) {
+                y_inverse_norm = y_inverse_norms[j];
+            } else {
+                const float y_norm = sqrtf(norm_computer(y + j * d, d));
+                y_inverse_norm = (y_norm == 0.0f) ? 1.0f : (1.0f / y_norm);
+            }
+            resi.add_result(ip * y_inverse_norm / x_norm, j);
         };
         resi.begin(i);
         // the lambda that applies a filtered element
         if constexpr (std::is_same_v<IDSelector, IDSelectorArray>) {
-            // todo: need more tests about this branch
+            // the kernels pass the position in ids rather than the id
             auto filter = [](const size_t j) { return true; };
+            auto apply_by_idx = [&apply, &selector](
+                                        const float dis, const idx_t j) {
+                apply(dis, selector.ids[j]);
+            };
             if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
                 fp16_vec_inner_products_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector->n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
                 bf16_vec_inner_products_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector->n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             } else if constexpr (std::is_same_v<DataType, knowhere::int8>) {
                 int8_vec_inner_products_ny_by_idx_if(
-                        x_i, y, selector.ids, d, selector->n, filter, apply);
+                        x_i, y, selector.ids, d, selector.n, filter, apply_by_idx);
             }
         } else {
             // the lambda that filters acceptable elements.
@@ -193,6 +238,214 @@ void exhaustive_cosine_seq_impl_typed(
         resi.end();
     }
 }
+
+template <typename DataType>
+void convert_to_fp32(const DataType* x, size_t n, float* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (float)x[i];
+    }
+}
+
+template <typename DataType>
+float typed_norm_L2sqr(const DataType* x, size_t d) {
+    if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
+        return fp16_vec_norm_L2sqr(x, d);
+    } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
+        return bf16_vec_norm_L2sqr(x, d);
+    } else {
+        return int8_vec_norm_L2sqr(x, d);
+    }
+}
+
+template <class BlockResultHandler>
+struct handler_comparator;
+
+template <template <class, bool> class Handler, class C, bool use_sel>
+struct handler_comparator<Handler<C, use_sel>> {
+    using type = C;
+};
+
+/** The blocked counterpart of the functions above for a large nx. The tiles
+ * of x and y are converted to fp32 and their inner products computed with
+ * sgemm, as exhaustive_inner_product_blas does for fp32. finalize turns the
+ * inner products of query i with the vectors j0..j1 into distances, the ones
+ * the selector rejects get the neutral value, which no result handler keeps.
+ */
+template <typename DataType, class BlockResultHandler, class Finalize>
+void exhaustive_blas_impl_typed(
+        const DataType* x,
+        const DataType* y,
+        size_t d,
+        size_t nx,
+        size_t ny,
+        BlockResultHandler& res,
+        const IDSelector* sel,
+        Finalize finalize) {
+    using C = typename handler_comparator<BlockResultHandler>::type;
+
+    // BLAS does not like empty matrices
+    if (nx == 0 || ny == 0)
+        return;
+
+    /* block sizes */
+    const size_t bs_x = std::min<size_t>(distance_compute_blas_query_bs, nx);
+    const size_t bs_y = std::min<size_t>(distance_compute_blas_database_bs, ny);
+    std::unique_ptr<float[]> ip_block(new float[bs_x * bs_y]);
+    std::unique_ptr<float[]> x_block(new float[bs_x * d]);
+    std::unique_ptr<float[]> y_block(new float[bs_y * d]);
+    std::unique_ptr<bool[]> y_member(new bool[bs_y]);
+
+    for (size_t i0 = 0; i0 < nx; i0 += bs_x) {
+        size_t i1 = i0 + bs_x;
+        if (i1 > nx)
+            i1 = nx;
+
+        res.begin_multiple(i0, i1);
+        convert_to_fp32(x + i0 * d, (i1 - i0) * d, x_block.get());
+
+        for (size_t j0 = 0; j0 < ny; j0 += bs_y) {
+            size_t j1 = j0 + bs_y;
+            if (j1 > ny)
+                j1 = ny;
+
+            size_t n_member = j1 - j0;
+            if (sel != nullptr) {
+                n_member = 0;
+                for (size_t j = j0; j < j1; j++) {
+                    y_member[j - j0] = sel->is_member(j);
+                    n_member += y_member[j - j0];
+                }
+                // nothing to add from a fully filtered tile
+                if (n_member == 0)
+                    continue;
+            }
+            convert_to_fp32(y + j0 * d, (j1 - j0) * d, y_block.get());
+
+            /* compute the actual dot products */
+            {
+                float one = 1, zero = 0;
+                FINTEGER nyi = j1 - j0, nxi = i1 - i0, di = d;
+                sgemm_("Transpose",
+                       "Not transpose",
+                       &nyi,
+                       &nxi,
+                       &di,
+                       &one,
+                       y_block.get(),
+                       &di,
+                       x_block.get(),
+                       &di,
+                       &zero,
+                       ip_block.get(),
+                       &nyi);
+            }
+#pragma omp parallel for
+            for (int64_t i = i0; i < i1; i++) {
+                float* ip_line = ip_block.get() + (i - i0) * (j1 - j0);
+                finalize(i, j0, j1, ip_line);
+                if (n_member < j1 - j0) {
+                    for (size_t j = j0; j < j1; j++) {
+                        if (!y_member[j - j0]) {
+                            ip_line[j - j0] = C::neutral();
+                        }
+                    }
+                }
+            }
+            res.add_results(j0, j1, ip_block.get());
+        }
+        res.end_multiple();
+        InterruptCallback::check();
+    }
+}
+
+template <typename DataType, class BlockResultHandler>
+void exhaustive_inner_product_blas_typed(
+        const DataType* x,
+        const DataType* y,
+        size_t d,
+        size_t nx,
+        size_t ny,
+        BlockResultHandler& res,
+        const IDSelector* sel) {
+    exhaustive_blas_impl_typed(
+            x, y, d, nx, ny, res, sel, [](size_t, size_t, size_t, float*) {});
+}
+
+template <typename DataType, class BlockResultHandler>
+void exhaustive_L2sqr_blas_typed(
+        const DataType* x,
+        const DataType* y,
+        const float* y_norms,
+        size_t d,
+        size_t nx,
+        size_t ny,
+        BlockResultHandler& res,
+        const IDSelector* sel) {
+    std::unique_ptr<float[]> x_norms(new float[nx]);
+    for (size_t i = 0; i < nx; i++) {
+        x_norms[i] = typed_norm_L2sqr(x + i * d, d);
+    }
+    std::unique_ptr<float[]> del2;
+    if (y_norms == nullptr) {
+        del2.reset(new float[ny]);
+        for (size_t j = 0; j < ny; j++) {
+            del2[j] = typed_norm_L2sqr(y + j * d, d);
+        }
+        y_norms = del2.get();
+    }
+    auto finalize = [&x_norms, y_norms](
+                            size_t i, size_t j0, size_t j1, float* ip_line) {
+        for (size_t j = j0; j < j1; j++) {
+            float dis = x_norms[i] + y_norms[j] - 2 * ip_line[j - j0];
+            // negative values can occur for identical vectors
+            // due to roundoff errors
+            ip_line[j - j0] = dis < 0 ? 0 : dis;
+        }
+    };
+    exhaustive_blas_impl_typed(x, y, d, nx, ny, res, sel, finalize);
+}
+
+// y_inverse_norms are the inverse norms, like in the sequential version
+template <typename DataType, class BlockResultHandler>
+void exhaustive_cosine_blas_typed(
+        const DataType* x,
+        const DataType* y,
+        const float* y_inverse_norms,
+        size_t d,
+        size_t nx,
+        size_t ny,
+        BlockResultHandler& res,
+        const IDSelector* sel) {
+    std::unique_ptr<float[]> x_norms(new float[nx]);
+    for (size_t i = 0; i < nx; i++) {
+        float x_norm = sqrtf(typed_norm_L2sqr(x + i * d, d));
+        x_norms[i] = (x_norm == 0.0 ? 1.0 : x_norm);
+    }
+    std::unique_ptr<float[]> del2;
+    if (y_inverse_norms == nullptr) {
+        del2.reset(new float[ny]);
+        for (size_t j = 0; j < ny; j++) {
+            const float y_norm = sqrtf(typed_norm_L2sqr(y + j * d, d));
+            del2[j] = (y_norm == 0.0f) ? 1.0f : (1.0f / y_norm);
+        }
+        y_inverse_norms = del2.get();
+    }
+    auto finalize = [&x_norms, y_inverse_norms](
+                            size_t i, size_t j0, size_t j1, float* ip_line) {
+        const float x_inverse_norm = 1.0f / x_norms[i];
+        for (size_t j = j0; j < j1; j++) {
+            ip_line[j - j0] *= x_inverse_norm * y_inverse_norms[j];
+        }
+    };
+    exhaustive_blas_impl_typed(x, y, d, nx, ny, res, sel, finalize);
+}
+
+// the blocked path takes the selectors that answer is_member in constant time
+bool use_blas_typed(size_t nx, const IDSelector* sel) {
+    return nx >= (size_t)distance_compute_typed_blas_threshold &&
+            (sel == nullptr ||
+             dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel));
+}
 } // namespace
 
 template <typename DataType>
@@ -214,7 +467,16 @@ void knn_inner_product_typed(
         y += d * imin;
         sel = nullptr;
     }
-    if (k < distance_compute_min_k_reservoir) {
+    if (use_blas_typed(nx, sel)) {
+        if (k < distance_compute_min_k_reservoir) {
+            HeapBlockResultHandler<CMin<float, int64_t>> res(nx, vals, ids, k);
+            exhaustive_inner_product_blas_typed(x, y, d, nx, ny, res, sel);
+        } else {
+            ReservoirBlockResultHandler<CMin<float, int64_t>> res(
+                    nx, vals, ids, k);
+            exhaustive_inner_product_blas_typed(x, y, d, nx, ny, res, sel);
+        }
+    } else if (k < distance_compute_min_k_reservoir) {
         HeapBlockResultHandler<CMin<float, int64_t>> res(nx, vals, ids, k);
         if (const auto* sel_bs =
                     dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
@@ -222,6 +484,10 @@ void knn_inner_product_typed(
         } else if (sel == nullptr) {
             exhaustive_inner_product_impl_typed(
                     x, y, d, nx, ny, res, IDSelectorAll());
+        } else if (const auto* sel_arr =
+                           dynamic_cast<const IDSelectorArray*>(sel)) {
+            exhaustive_inner_product_impl_typed(
+                    x, y, d, nx, ny, res, *sel_arr);
         } else {
             exhaustive_inner_product_impl_typed(x, y, d, nx, ny, res, *sel);
         }
@@ -233,6 +499,10 @@ void knn_inner_product_typed(
         } else if (sel == nullptr) {
             exhaustive_inner_product_impl_typed(
                     x, y, d, nx, ny, res, IDSelectorAll());
+        } else if (const auto* sel_arr =
+                           dynamic_cast<const IDSelectorArray*>(sel)) {
+            exhaustive_inner_product_impl_typed(
+                    x, y, d, nx, ny, res, *sel_arr);
         } else {
             exhaustive_inner_product_impl_typed(x, y, d, nx, ny, res, *sel);
         }
@@ -312,7 +582,18 @@ void knn_L2sqr_typed(
         y += d * imin;
         sel = nullptr;
     }
-    if (k < distance_compute_min_k_reservoir) {
+    if (use_blas_typed(nx, sel)) {
+        if (k < distance_compute_min_k_reservoir) {
+            HeapBlockResultHandler<CMax<float, int64_t>> res(nx, vals, ids, k);
+            exhaustive_L2sqr_blas_typed(
+                    x, y, y_norm2, d, nx, ny, res, sel);
+        } else {
+            ReservoirBlockResultHandler<CMax<float, int64_t>> res(
+                    nx, vals, ids, k);
+            exhaustive_L2sqr_blas_typed(
+                    x, y, y_norm2, d, nx, ny, res, sel);
+        }
+    } else if (k < distance_compute_min_k_reservoir) {
         HeapBlockResultHandler<CMax<float, int64_t>> res(nx, vals, ids, k);
         if (const auto* sel_bs =
                     dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
@@ -320,6 +601,9 @@ void knn_L2sqr_typed(
         } else if (sel == nullptr) {
             exhaustive_L2sqr_seq_impl_typed(
                     x, y, d, nx, ny, res, IDSelectorAll());
+        } else if (const auto* sel_arr =
+                           dynamic_cast<const IDSelectorArray*>(sel)) {
+            exhaustive_L2sqr_seq_impl_typed(x, y, d, nx, ny, res, *sel_arr);
         } else {
             exhaustive_L2sqr_seq_impl_typed(x, y, d, nx, ny, res, *sel);
         }
@@ -331,6 +615,9 @@ void knn_L2sqr_typed(
         } else if (sel == nullptr) {
             exhaustive_L2sqr_seq_impl_typed(
                     x, y, d, nx, ny, res, IDSelectorAll());
+        } else if (const auto* sel_arr =
+                           dynamic_cast<const IDSelectorArray*>(sel)) {
+            exhaustive_L2sqr_seq_impl_typed(x, y, d, nx, ny, res, *sel_arr);
         } else {
             exhaustive_L2sqr_seq_impl_typed(x, y, d, nx, ny, res, *sel);
         }
@@ -371,7 +658,7 @@ template <typename DataType>
 void knn_cosine_typed(
         const DataType* x,
         const DataType* y,
-        const float* y_norm2,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -385,33 +672,55 @@ void knn_cosine_typed(
         int64_t imax = std::min(selr->imax, int64_t(ny));
         ny = imax - imin;
         y += d * imin;
+        if (y_inverse_norms != nullptr) {
+            y_inverse_norms += imin;
+        }
         sel = nullptr;
     }
-    if (k < distance_compute_min_k_reservoir) {
+    if (use_blas_typed(nx, sel)) {
+        if (k < distance_compute_min_k_reservoir) {
+            HeapBlockResultHandler<CMin<float, int64_t>> res(nx, vals, ids, k);
+            exhaustive_cosine_blas_typed(
+                    x, y, y_inverse_norms, d, nx, ny, res, sel);
+        } else {
+            ReservoirBlockResultHandler<CMin<float, int64_t>> res(
+                    nx, vals, ids, k);
+            exhaustive_cosine_blas_typed(
+                    x, y, y_inverse_norms, d, nx, ny, res, sel);
+        }
+    } else if (k < distance_compute_min_k_reservoir) {
         HeapBlockResultHandler<CMin<float, int64_t>> res(nx, vals, ids, k);
         if (const auto* sel_bs =
                     dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
             exhaustive_cosine_seq_impl_typed(
-                    x, y, y_norm2, d, nx, ny, res, *sel_bs);
+                    x, y, y_inverse_norms, d, nx, ny, res, *sel_bs);
         } else if (sel == nullptr) {
             exhaustive_cosine_seq_impl_typed(
-                    x, y, y_norm2, d, nx, ny, res, IDSelectorAll());
+                    x, y, y_inverse_norms, d, nx, ny, res, IDSelectorAll());
+        } else if (const auto* sel_arr =
+                           dynamic_cast<const IDSelectorArray*>(sel)) {
+            exhaustive_cosine_seq_impl_typed(
+                    x, y, y_inverse_norms, d, nx, ny, res, *sel_arr);
         } else {
             exhaustive_cosine_seq_impl_typed(
-                    x, y, y_norm2, d, nx, ny, res, *sel);
+                    x, y, y_inverse_norms, d, nx, ny, res, *sel);
         }
     } else {
         ReservoirBlockResultHandler<CMin<float, int64_t>> res(nx, vals, ids, k);
         if (const auto* sel_bs =
                     dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
             exhaustive_cosine_seq_impl_typed(
-                    x, y, y_norm2, d, nx, ny, res, *sel_bs);
+                    x, y, y_inverse_norms, d, nx, ny, res, *sel_bs);
         } else if (sel == nullptr) {
             exhaustive_cosine_seq_impl_typed(
-                    x, y, y_norm2, d, nx, ny, res, IDSelectorAll());
+                    x, y, y_inverse_norms, d, nx, ny, res, IDSelectorAll());
+        } else if (const auto* sel_arr =
+                           dynamic_cast<const IDSelectorArray*>(sel)) {
+            exhaustive_cosine_seq_impl_typed(
+                    x, y, y_inverse_norms, d, nx, ny, res, *sel_arr);
         } else {
             exhaustive_cosine_seq_impl_typed(
-                    x, y, y_norm2, d, nx, ny, res, *sel);
+                    x, y, y_inverse_norms, d, nx, ny, res, *sel);
         }
     }
     if (imin != 0) {
@@ -428,7 +737,7 @@ template <typename DataType>
 void all_cosine_typed(
         const DataType* x,
         const DataType* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -438,12 +747,12 @@ void all_cosine_typed(
     if (const auto* sel_bs =
                 dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
         exhaustive_cosine_seq_impl_typed(
-                x, y, y_norms, d, nx, ny, res, *sel_bs);
+                x, y, y_inverse_norms, d, nx, ny, res, *sel_bs);
     } else if (sel == nullptr) {
         exhaustive_cosine_seq_impl_typed(
-                x, y, y_norms, d, nx, ny, res, IDSelectorAll());
+                x, y, y_inverse_norms, d, nx, ny, res, IDSelectorAll());
     } else {
-        exhaustive_cosine_seq_impl_typed(x, y, y_norms, d, nx, ny, res, *sel);
+        exhaustive_cosine_seq_impl_typed(x, y, y_inverse_norms, d, nx, ny, res, *sel);
     }
     return;
 }
@@ -503,7 +812,7 @@ template <typename DataType>
 void range_search_cosine_typed(
         const DataType* x,
         const DataType* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -514,12 +823,12 @@ void range_search_cosine_typed(
     if (const auto* sel_bs =
                 dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
         exhaustive_cosine_seq_impl_typed(
-                x, y, y_norms, d, nx, ny, resh, *sel_bs);
+                x, y, y_inverse_norms, d, nx, ny, resh, *sel_bs);
     } else if (sel == nullptr) {
         exhaustive_cosine_seq_impl_typed(
-                x, y, y_norms, d, nx, ny, resh, IDSelectorAll());
+                x, y, y_inverse_norms, d, nx, ny, resh, IDSelectorAll());
     } else {
-        exhaustive_cosine_seq_impl_typed(x, y, y_norms, d, nx, ny, resh, *sel);
+        exhaustive_cosine_seq_impl_typed(x, y, y_inverse_norms, d, nx, ny, resh, *sel);
     }
     return;
 }
@@ -15,12 +15,18 @@
 #ifndef FAISS_HALF_PRECISION_FLOATING_POINT_DISTANCES_H
 #define FAISS_HALF_PRECISION_FLOATING_POINT_DISTANCES_H
 #pragma once
+#include <faiss/impl/platform_macros.h>
 #include <faiss/utils/Heap.h>
 #include <stdint.h>
 #include <vector>
 #include "knowhere/object.h"
 namespace faiss {
 struct IDSelector;
+
+// threshold on nx above which the typed knn functions convert blocks of the
+// vectors to fp32 and compute them with BLAS
+FAISS_API extern int distance_compute_typed_blas_threshold;
+
 /***************************************************************************
  * KNN functions
  ***************************************************************************/
@@ -85,7 +91,7 @@ template <typename DataType>
 void knn_cosine_typed(
         const DataType* x,
         const DataType* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -98,7 +104,7 @@ template <typename DataType>
 void all_cosine_typed(
         const DataType* x,
         const DataType* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
@@ -137,7 +143,7 @@ template <typename DataType>
 void range_search_cosine_typed(
         const DataType* x,
         const DataType* y,
-        const float* y_norms,
+        const float* y_inverse_norms,
         size_t d,
         size_t nx,
         size_t ny,
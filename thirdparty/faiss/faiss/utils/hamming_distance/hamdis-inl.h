@@ -23,8 +23,52 @@
 #include <faiss/utils/hamming_distance/generic-inl.h>
 #endif
 
+#include "simd/hook.h"
+
 namespace faiss {
 
+/***************************************************************************
+ * Hamming computer on the bvec_hamming_distance hook, which is faster than
+ * HammingComputerDefault for the codes beyond the specialized sizes
+ **************************************************************************/
+
+struct HammingComputerHook {
+    const uint8_t* a8;
+    int code_size;
+
+    HammingComputerHook() {}
+
+    HammingComputerHook(const uint8_t* a8, int code_size) {
+        set(a8, code_size);
+    }
+
+    void set(const uint8_t* a8_2, int code_size_2) {
+        a8 = a8_2;
+        code_size = code_size_2;
+    }
+
+    int compute(const uint8_t* b8) const {
+        return bvec_hamming_distance(a8, b8, code_size);
+    }
+
+    void compute_batch_4(
+            const uint8_t* b0,
+            const uint8_t* b1,
+            const uint8_t* b2,
+            const uint8_t* b3,
+            int& dis0,
+            int& dis1,
+            int& dis2,
+            int& dis3) const {
+        bvec_hamming_distance_batch_4(
+                a8, b0, b1, b2, b3, code_size, dis0, dis1, dis2, dis3);
+    }
+
+    inline int get_code_size() const {
+        return code_size;
+    }
+};
+
 /***************************************************************************
  * Equivalence with a template class when code size is known at compile time
  **************************************************************************/
@@ -74,6 +118,9 @@ typename Consumer::T dispatch_HammingComputer(
         DISPATCH_HC(32);
         DISPATCH_HC(64);
         default:
+            if (code_size > 64) {
+                return consumer.template f<HammingComputerHook>(args...);
+            }
             return consumer.template f<HammingComputerDefault>(args...);
     }
 }
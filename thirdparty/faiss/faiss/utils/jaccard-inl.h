@@ -18,6 +18,7 @@
 #include <faiss/utils/binary_distances.h>
 
 #include <faiss/utils/hamming_distance/common.h>
+#include "simd/hook.h"
 
 namespace faiss {
 
@@ -457,6 +458,19 @@ struct JaccardComputerDefault {
     float compute(const uint8_t* b8) const {
         return bvec_jaccard(a, b8, n);
     }
+
+    void compute_batch_4(
+            const uint8_t* b0,
+            const uint8_t* b1,
+            const uint8_t* b2,
+            const uint8_t* b3,
+            float& dis0,
+            float& dis1,
+            float& dis2,
+            float& dis3) const {
+        bvec_jaccard_distance_batch_4(
+                a, b0, b1, b2, b3, n, dis0, dis1, dis2, dis3);
+    }
 };
 
 // default template
@@ -29,6 +29,8 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <exception>
+#include <mutex>
 #include <set>
 #include <type_traits>
 #include <vector>
@@ -658,4 +660,41 @@ void CodeSet::insert(size_t n, const uint8_t* codes, bool* inserted) {
     }
 }
 
+void parallel_for_nested(size_t n, const std::function<void(size_t)>& task) {
+    if (n == 0) {
+        return;
+    }
+    const int n_threads = omp_get_max_threads();
+    if (n == 1 || n_threads == 1) {
+        for (size_t i = 0; i < n; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    const int n_outer = std::min<int>(n, n_threads);
+    const int n_inner = std::max(1, n_threads / n_outer);
+
+    // the nested loops run serially unless the second level is active
+    const int prev_max_active_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(prev_max_active_levels, 2));
+
+    std::mutex exceptions_mutex;
+    std::vector<std::pair<int, std::exception_ptr>> exceptions;
+
+#pragma omp parallel for num_threads(n_outer) schedule(dynamic, 1)
+    for (int64_t i = 0; i < (int64_t)n; i++) {
+        omp_set_num_threads(n_inner);
+        try {
+            task(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(exceptions_mutex);
+            exceptions.emplace_back((int)i, std::current_exception());
+        }
+    }
+
+    omp_set_max_active_levels(prev_max_active_levels);
+    handleExceptions(exceptions);
+}
+
 } // namespace faiss
@@ -17,6 +17,7 @@
 #define FAISS_utils_h
 
 #include <stdint.h>
+#include <functional>
 #include <set>
 #include <string>
 #include <vector>
@@ -224,6 +225,14 @@ struct CodeSet {
     void insert(size_t n, const uint8_t* codes, bool* inserted);
 };
 
+/** Runs task(i) for i in [0, n) in parallel, one task per thread at a time.
+ * Every task gets its share of the OpenMP threads for the parallel loops it
+ * nests, so that n independent tasks of a few threads each (e.g. the
+ * k-means of the subquantizers) keep all the threads busy. The exceptions
+ * of the tasks are rethrown after all of them are done.
+ */
+void parallel_for_nested(size_t n, const std::function<void(size_t)>& task);
+
 } // namespace faiss
 
 #endif /* FAISS_utils_h */
@@ -337,6 +337,69 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         }
     }
 
+    // whether calcDistanceBatch4 evaluates the 4 vectors with a single batched kernel
+    static constexpr bool has_batch4_kernel =
+        !sq_enabled && (knowhere::KnowhereFloatTypeCheck<data_t>::value || std::is_same_v<data_t, knowhere::bin1>);
+
+    // the distances between vec and the vectors of ids[0..3], loading vec once for the 4 of them
+    inline void
+    calcDistanceBatch4(const void* vec, const tableint* ids, dist_t* dis) const {
+        if constexpr (has_batch4_kernel && std::is_same_v<data_t, knowhere::bin1>) {
+            // the dim of the binary spaces is in bits
+            const size_t code_size = *(size_t*)dist_func_param_ / 8;
+            const auto* x = (const uint8_t*)vec;
+            const auto* y0 = (const uint8_t*)getDataByInternalId(ids[0]);
+            const auto* y1 = (const uint8_t*)getDataByInternalId(ids[1]);
+            const auto* y2 = (const uint8_t*)getDataByInternalId(ids[2]);
+            const auto* y3 = (const uint8_t*)getDataByInternalId(ids[3]);
+            if (metric_type_ == Metric::HAMMING) {
+                int hamming[4];
+                faiss::bvec_hamming_distance_batch_4(x, y0, y1, y2, y3, code_size, hamming[0], hamming[1], hamming[2],
+                                                     hamming[3]);
+                for (size_t i = 0; i < 4; ++i) {
+                    dis[i] = hamming[i];
+                }
+            } else {
+                faiss::bvec_jaccard_distance_batch_4(x, y0, y1, y2, y3, code_size, dis[0], dis[1], dis[2], dis[3]);
+            }
+        } else if constexpr (has_batch4_kernel) {
+            const size_t dim = *(size_t*)dist_func_param_;
+            const auto* x = (const data_t*)vec;
+            const auto* y0 = (const data_t*)getDataByInternalId(ids[0]);
+            const auto* y1 = (const data_t*)getDataByInternalId(ids[1]);
+            const auto* y2 = (const data_t*)getDataByInternalId(ids[2]);
+            const auto* y3 = (const data_t*)getDataByInternalId(ids[3]);
+            if (metric_type_ == Metric::L2) {
+                if constexpr (std::is_same_v<data_t, knowhere::fp32>) {
+                    faiss::fvec_L2sqr_batch_4(x, y0, y1, y2, y3, dim, dis[0], dis[1], dis[2], dis[3]);
+                } else if constexpr (std::is_same_v<data_t, knowhere::fp16>) {
+                    faiss::fp16_vec_L2sqr_batch_4(x, y0, y1, y2, y3, dim, dis[0], dis[1], dis[2], dis[3]);
+                } else {
+                    faiss::bf16_vec_L2sqr_batch_4(x, y0, y1, y2, y3, dim, dis[0], dis[1], dis[2], dis[3]);
+                }
+                return;
+            }
+            if constexpr (std::is_same_v<data_t, knowhere::fp32>) {
+                faiss::fvec_inner_product_batch_4(x, y0, y1, y2, y3, dim, dis[0], dis[1], dis[2], dis[3]);
+            } else if constexpr (std::is_same_v<data_t, knowhere::fp16>) {
+                faiss::fp16_vec_inner_product_batch_4(x, y0, y1, y2, y3, dim, dis[0], dis[1], dis[2], dis[3]);
+            } else {
+                faiss::bf16_vec_inner_product_batch_4(x, y0, y1, y2, y3, dim, dis[0], dis[1], dis[2], dis[3]);
+            }
+            // the IP and COSINE distances are the negated inner products, the query is already normalized
+            for (size_t i = 0; i < 4; ++i) {
+                dis[i] = -dis[i];
+                if (metric_type_ == Metric::COSINE) {
+                    dis[i] /= data_norm_l2_[ids[i]];
+                }
+            }
+        } else {
+            for (size_t i = 0; i < 4; ++i) {
+                dis[i] = calcDistance(vec, ids[i]);
+            }
+        }
+    }
+
     inline dist_t
     calcRefineDistance(const void* vec, const tableint id) const {
         dist_t dist = fstdistfunc_(vec, getDataByInternalId(id), dist_func_param_);
@@ -440,6 +503,34 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             metric_distance_computations += size;
         }
         float kAlpha = bitset.filter_ratio() * 0.7f;
+        // the neighbors to evaluate are buffered to compute their distances 4 at a time
+        tableint batch_ids[4];
+        int batch_status[4];
+        dist_t batch_dis[4];
+        size_t batch_size = 0;
+        auto flush = [&](size_t n) {
+            if (n == 4) {
+                calcDistanceBatch4(data_point, batch_ids, batch_dis);
+            } else {
+                for (size_t j = 0; j < n; ++j) {
+                    batch_dis[j] = calcDistance(data_point, batch_ids[j]);
+                }
+            }
+            for (size_t j = 0; j < n; ++j) {
+                tableint v = batch_ids[j];
+                if (feder_result != nullptr) {
+                    feder_result->visit_info_.AddVisitRecord(0, u, v, batch_dis[j]);
+                    feder_result->id_set_.insert(u);
+                    feder_result->id_set_.insert(v);
+                }
+                Neighbor nn(v, batch_dis[j], batch_status[j]);
+                if (add_search_candidate(nn)) {
+#if defined(USE_PREFETCH)
+                    _mm_prefetch(get_linklist0(v), _MM_HINT_T0);
+#endif
+                }
+            }
+        };
         for (size_t i = 1; i <= size; ++i) {
             if (i + 1 <= size) {
                 prefetchData(list[i + 1]);
@@ -464,20 +555,14 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 }
                 accumulative_alpha -= 1.0f;
             }
-            dist_t dist = calcDistance(data_point, v);
-            if (feder_result != nullptr) {
-                feder_result->visit_info_.AddVisitRecord(0, u, v, dist);
-                feder_result->id_set_.insert(u);
-                feder_result->id_set_.insert(v);
-            }
-
-            Neighbor nn(v, dist, status);
-            if (add_search_candidate(nn)) {
-#if defined(USE_PREFETCH)
-                _mm_prefetch(get_linklist0(v), _MM_HINT_T0);
-#endif
+            batch_ids[batch_size] = v;
+            batch_status[batch_size] = status;
+            if (++batch_size == 4) {
+                flush(batch_size);
+                batch_size = 0;
             }
         }
+        flush(batch_size);
     }
 
     // accumulative_alpha: when searching on graph with filter, we want to keep some filtered nodes in the search path